@@ -0,0 +1,25 @@
+#!/usr/bin/env python3
+#
+# This file is part of WarpX.
+#
+# License: BSD-3-Clause-LBNL
+#
+# This script checks the reflection of the convolutional PML with the input file inputs_3d.
+# A pulse of amplitude 1 propagating along +z enters the PML at the end of the domain: at
+# the end of the run, the pulse is absorbed and the domain only holds its reflection, whose
+# amplitude is the reflection coefficient of the PML at normal incidence.
+import sys
+
+import numpy as np
+import yt
+
+yt.funcs.mylog.setLevel(50)
+
+incident = 1.
+
+ds = yt.load(sys.argv[1])
+data = ds.covering_grid(level=0, left_edge=ds.domain_left_edge, dims=ds.domain_dimensions)
+reflected = np.max(np.abs(data[('boxlib', 'Ey')].to_ndarray()))
+R = reflected / incident
+print('incident amplitude = {}, reflected amplitude = {}, R = {}'.format(incident, reflected, R))
+assert R < 1.e-2
@@ -0,0 +1,45 @@
+#!/usr/bin/env python3
+#
+# This file is part of WarpX.
+#
+# License: BSD-3-Clause-LBNL
+#
+# This script checks the Drude dispersion with the input file inputs_3d. A pulse propagating
+# along +z in vacuum passes the probe and is partly reflected by the Drude half-space z > 0.
+# The ratio of the spectra of the reflected and of the incident pulses is compared, over the
+# band of the pulse, with the Fresnel coefficient at normal incidence
+#     r = (1 - n)/(1 + n), n^2 = 1 - omega_p^2/(omega^2 + i gamma omega).
+import numpy as np
+from scipy.constants import c
+
+omega_p = 1.2e14
+gamma = 1.e13
+z0 = -32.e-6
+
+# step, time, Ey
+data = np.loadtxt('diags/reducedfiles/Ey_probe.txt')
+t = data[:, 1]
+Ey = data[:, 2]
+
+# the incident pulse has passed the probe, and its reflection has not come back yet, when the
+# center of the pulse reaches the metal; the transmitted pulse, reflected by the upper PML,
+# comes back after the end of the run
+t_split = -z0 / c
+incident = np.where(t < t_split, Ey, 0.)
+reflected = np.where(t >= t_split, Ey, 0.)
+
+n_fft = 8 * len(t)
+omega = 2.*np.pi*np.fft.rfftfreq(n_fft, t[1] - t[0])
+spectrum_incident = np.abs(np.fft.rfft(incident, n_fft))
+spectrum_reflected = np.abs(np.fft.rfft(reflected, n_fft))
+# above omega_p, away from the fast variation of r around omega_p
+band = spectrum_incident > 0.5*np.max(spectrum_incident)
+
+n = np.sqrt(1. - omega_p**2 / (omega[band]**2 + 1j*gamma*omega[band]))
+r_th = np.abs((1. - n) / (1. + n))
+r = spectrum_reflected[band] / spectrum_incident[band]
+
+error = np.max(np.abs(r - r_th))
+print('band: {} to {} rad/s'.format(omega[band][0], omega[band][-1]))
+print('|r| from {} to {}, max error = {}'.format(np.min(r_th), np.max(r_th), error))
+assert error < 0.03
@@ -0,0 +1,44 @@
+#!/usr/bin/env python3
+#
+# This file is part of WarpX.
+#
+# License: BSD-3-Clause-LBNL
+#
+# This script checks the spin spiral of the interfacial DMI with the input file inputs_3d.
+# For a cycloid Mz + i Mx = Ms exp(i theta(x)), the energy density A theta'^2 + D theta' is
+# lowest for theta' = -D/(2A), i.e. a period of 4 pi A / D, with the sense of rotation set by
+# the sign of D. The domain is two periods long, so that M must wind twice, clockwise in the
+# x-z plane for D > 0, uniformly along x and with M in the x-z plane.
+import sys
+
+import numpy as np
+import yt
+
+yt.funcs.mylog.setLevel(50)
+
+Ms = 1.e6
+A = 1.e-11
+D = 2.e-3
+
+ds = yt.load(sys.argv[1])
+data = ds.covering_grid(level=0, left_edge=ds.domain_left_edge, dims=ds.domain_dimensions)
+# M is uniform along y and z
+mx, my, mz = [np.mean(data[('boxlib', field)].to_ndarray(), axis=(1, 2)) / Ms
+              for field in ['Mx_xface', 'My_xface', 'Mz_xface']]
+
+# winding number of M in the x-z plane over the periodic domain
+theta = np.unwrap(np.angle(np.append(mz + 1j*mx, mz[0] + 1j*mx[0])))
+winding = (theta[-1] - theta[0]) / (2.*np.pi)
+L = float(ds.domain_width[0])
+winding_th = -np.sign(D) * L / (4.*np.pi*A / abs(D))
+
+# a spiral without anisotropy rotates at a uniform rate
+dtheta = np.diff(theta)
+nonuniformity = np.std(dtheta) / abs(np.mean(dtheta))
+my_max = np.max(np.abs(my))
+
+print('winding = {}, expected = {}'.format(winding, winding_th))
+print('non-uniformity of the rotation = {}, max |My|/Ms = {}'.format(nonuniformity, my_max))
+assert abs(winding - winding_th) < 0.1
+assert nonuniformity < 0.05
+assert my_max < 0.05
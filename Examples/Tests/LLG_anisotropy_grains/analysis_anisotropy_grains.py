@@ -0,0 +1,32 @@
+#!/usr/bin/env python3
+#
+# This file is part of WarpX.
+#
+# License: BSD-3-Clause-LBNL
+#
+# This script checks the cubic anisotropy and the anisotropy axes of the grains with the input
+# file inputs_3d. With K > 0, the easy axes are the cube axes of each grain; M starts at 20 degrees
+# from x in the plane xy, i.e. at 25 degrees from the cube axis (1,1,0)/sqrt(2) of the grain x < 0
+# and at 20 degrees from the cube axis x of the grain x > 0, within their basins of attraction,
+# and relaxes after about five relaxation times 1/(alpha |gamma| mu0 H_K/(1 + alpha^2)),
+# with H_K = 2 K/(mu0 Ms), to these axes. The y faces, inside the cells, have the axes of their grain.
+import sys
+
+import numpy as np
+import yt
+
+yt.funcs.mylog.setLevel(50)
+
+Ms = 1.e6
+
+ds = yt.load(sys.argv[1])
+data = ds.covering_grid(level=0, left_edge=ds.domain_left_edge, dims=ds.domain_dimensions)
+m = np.stack([data[('boxlib', field)].to_ndarray() for field in ['Mx_yface', 'My_yface', 'Mz_yface']], axis=-1) / Ms
+nx = m.shape[0]
+
+easy_axes = {'x < 0': (m[:nx//2], np.array([1., 1., 0.]) / np.sqrt(2.)),
+             'x > 0': (m[nx//2:], np.array([1., 0., 0.]))}
+for grain, (m_grain, axis) in easy_axes.items():
+    error = np.max(np.linalg.norm(m_grain - axis, axis=-1))
+    print('grain {}: easy axis {}, max |m - axis| = {}'.format(grain, axis, error))
+    assert error < 1.e-2
@@ -0,0 +1,45 @@
+#!/usr/bin/env python3
+#
+# This file is part of WarpX.
+#
+# License: BSD-3-Clause-LBNL
+#
+# This script checks the interlayer exchange coupling with the input file inputs_3d. Each layer
+# sees the field H = J M'/(mu0 Ms^2 dz) of the other one, so that, without damping, M_lo and M_hi
+# precess about their sum S = Ms (1, 1, 0), at omega = |gamma| J |S| / (Ms^2 dz), with
+#     M_lo/Ms = (1 + cos(omega t), 1 - cos(omega t), -sqrt(2) sin(omega t)) / 2
+# and M_hi = S - M_lo. The sense of the precession, given by the sign of J, is checked on Mz of the
+# lower layer at the end of the run.
+import sys
+
+import numpy as np
+import yt
+
+yt.funcs.mylog.setLevel(50)
+
+Ms = 1.e6
+gamma = 1.759e11
+J = 1.e-4
+dz = 3.75e-9
+omega = gamma * J * np.sqrt(2.) / (Ms * dz)
+
+# step, time, Mx and My of the lower layer, Mx and My of the upper layer
+data = np.loadtxt('diags/reducedfiles/M_layers.txt')
+t = data[:, 1]
+M = data[:, 2:6] / Ms
+c = np.cos(omega*t)
+M_th = 0.5 * np.column_stack((1. + c, 1. - c, 1. - c, 1. + c))
+error = np.max(np.abs(M - M_th))
+
+ds = yt.load(sys.argv[1])
+data = ds.covering_grid(level=0, left_edge=ds.domain_left_edge, dims=ds.domain_dimensions)
+mz = data[('boxlib', 'Mz_xface')].to_ndarray() / Ms
+z = np.linspace(ds.domain_left_edge[2], ds.domain_right_edge[2], mz.shape[2], endpoint=False) + 0.5*dz
+mz_lo = np.mean(mz[:, :, np.argmin(np.abs(z + 5.625e-9))])
+mz_lo_th = -np.sqrt(0.5) * np.sin(omega * float(ds.current_time))
+
+print('omega = {} rad/s, {} periods'.format(omega, omega * t[-1] / (2.*np.pi)))
+print('max error of Mx/Ms and My/Ms = {}'.format(error))
+print('Mz/Ms of the lower layer at the end = {}, expected = {}'.format(mz_lo, mz_lo_th))
+assert error < 1.e-2
+assert abs(mz_lo - mz_lo_th) < 1.e-2
@@ -0,0 +1,84 @@
+#!/usr/bin/env python3
+#
+# This file is part of WarpX.
+#
+# License: BSD-3-Clause-LBNL
+#
+# This script checks the LLG schemes against the analytic solution of a macrospin,
+# with the input file inputs_3d. M is uniform, initially along x, in a uniform H_bias
+# along z and without coupling to the Maxwell fields, so that, with
+# omega = |gamma| mu0 H_bias / (1 + alpha^2),
+#     M/Ms = (cos(omega t)/cosh(alpha omega t), sin(omega t)/cosh(alpha omega t), tanh(alpha omega t)).
+# With inputs_3d_spin_torque, the spin torques of a uniform current density J with the
+# polarization p along z add the damping-like field a_J M x p / Ms, which changes the
+# relaxation rate to omega_L (alpha H_bias + a_J) and the precession frequency to
+# omega_L (H_bias - alpha a_J),
+# with omega_L = |gamma| mu0 / (1 + alpha^2) and a_J = hbar eta J / (2 e mu0 Ms d).
+# M is compared with this solution at the end of the run, after more than one precession
+# period. The tolerance depends on the order of the scheme, read from the inputs of the run.
+import os
+import re
+import sys
+
+import numpy as np
+from scipy.constants import e, hbar
+from scipy.constants import mu_0 as mu0
+import yt
+
+yt.funcs.mylog.setLevel(50)
+
+
+def read_parameter(plotfile, name, default):
+    """Value of an input parameter of the run, from the job info of the plotfile"""
+    with open(os.path.join(plotfile, 'warpx_job_info')) as f:
+        for line in f:
+            match = re.match(r'\s*' + re.escape(name) + r'\s*=\s*(\S+)', line)
+            if match:
+                return match.group(1)
+    return default
+
+def read_float(plotfile, name, default):
+    return float(str(read_parameter(plotfile, name, default)).strip('"'))
+
+plotfile = sys.argv[1]
+order = int(read_parameter(plotfile, 'warpx.mag_time_scheme_order', 1))
+implicit = int(read_parameter(plotfile, 'warpx.mag_LLG_implicit', 0))
+collocated = int(read_parameter(plotfile, 'warpx.mag_M_collocated', 0))
+spin_torque = int(read_parameter(plotfile, 'warpx.mag_LLG_spin_torque_coupling', 0))
+
+Ms = 1.4e5
+alpha = 0.1
+gamma = 1.759e11
+H_bias = 3.e4
+omega_L = gamma * mu0 / (1. + alpha**2)
+a_J = 0.
+if spin_torque == 1:
+    eta = read_float(plotfile, 'macroscopic.mag_spin_torque_efficiency', 0.)
+    d = read_float(plotfile, 'macroscopic.mag_spin_torque_thickness', 1.)
+    J = read_float(plotfile, 'macroscopic.mag_spin_torque_J_function(x,y,z,t)', 0.)
+    a_J = hbar * eta * J / (2. * e * mu0 * Ms * d)
+omega = omega_L * (H_bias - alpha * a_J)
+rate = omega_L * (alpha * H_bias + a_J)
+
+# M is uniform
+ds = yt.load(plotfile)
+data = ds.covering_grid(level=0, left_edge=ds.domain_left_edge, dims=ds.domain_dimensions)
+M = np.array([np.mean(data[('boxlib', field)].to_ndarray()) for field in ['Mx_xface', 'My_xface', 'Mz_xface']]) / Ms
+t = float(ds.current_time)
+
+M_th = np.array([np.cos(omega*t) / np.cosh(rate*t),
+                 np.sin(omega*t) / np.cosh(rate*t),
+                 np.tanh(rate*t)])
+
+error = np.max(np.abs(M - M_th))
+# forward Euler is first order in dt, the trapezoidal scheme and the implicit midpoint rule
+# are second order, and the Runge-Kutta scheme is adaptive with a tolerance of 1e-6
+if order == 5:
+    tolerance = 1.e-4
+elif order == 2 or implicit == 1:
+    tolerance = 2.e-3
+else:
+    tolerance = 2.e-2
+print('scheme order = {}, implicit = {}, collocated = {}, a_J = {}'.format(order, implicit, collocated, a_J))
+print('max error of M/Ms = {}, tolerance = {}'.format(error, tolerance))
+assert error < tolerance
@@ -0,0 +1,35 @@
+#!/usr/bin/env python3
+#
+# This file is part of WarpX.
+#
+# License: BSD-3-Clause-LBNL
+#
+# This script checks the thermal field of the LLG equation with the input file inputs_3d.
+# The faces of the grid carry independent macrospins of volume V (the volume of a cell)
+# in a uniform H_bias along z, so that at equilibrium <Mz>/Ms = coth(xi) - 1/xi,
+# with xi = mu0 Ms V H_bias / (kB T). The average is taken over the z-component of M
+# on the three faces of all the cells, after about five relaxation times.
+import sys
+
+import numpy as np
+from scipy.constants import k as kB
+from scipy.constants import mu_0 as mu0
+import yt
+
+yt.funcs.mylog.setLevel(50)
+
+Ms = 1.4e5
+H_bias = 3.e4
+T = 300.
+dx = 1.2e-8
+xi = mu0 * Ms * dx**3 * H_bias / (kB * T)
+mz_th = 1. / np.tanh(xi) - 1. / xi
+
+ds = yt.load(sys.argv[1])
+data = ds.covering_grid(level=0, left_edge=ds.domain_left_edge, dims=ds.domain_dimensions)
+mz = np.mean([np.mean(data[('boxlib', field)].to_ndarray()) for field in ['Mz_xface', 'Mz_yface', 'Mz_zface']]) / Ms
+
+# the standard deviation of the average over the 3*16^3 macrospins is about 4e-3
+tolerance = 0.02
+print('xi = {}, <Mz>/Ms = {}, Langevin function = {}'.format(xi, mz, mz_th))
+assert abs(mz - mz_th) < tolerance
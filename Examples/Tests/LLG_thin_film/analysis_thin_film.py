@@ -0,0 +1,34 @@
+#!/usr/bin/env python3
+#
+# This file is part of WarpX.
+#
+# License: BSD-3-Clause-LBNL
+#
+# This script checks the magnetic thin film with the input file inputs_3d. The film is
+# magnetized in-plane along x by H_bias, and its small precession about x has the Kittel
+# frequency of an in-plane film, with the out-of-plane demagnetizing field -Mz:
+#     omega = |gamma| mu0 sqrt(H_bias (H_bias + Ms)).
+# The frequency is measured from the zero crossings of By in the film cells, which holds mu0 My.
+import numpy as np
+from scipy.constants import mu_0 as mu0
+
+Ms = 1.4e5
+gamma = 1.759e11
+H_bias = 3.e4
+f_th = gamma * mu0 * np.sqrt(H_bias * (H_bias + Ms)) / (2.*np.pi)
+
+# step, time, By
+data = np.loadtxt('diags/reducedfiles/B_film.txt')
+t = data[:, 1]
+By = data[:, 2]
+
+# times of the zero crossings, interpolated linearly, half a period apart
+crossing = np.where(np.sign(By[:-1]) * np.sign(By[1:]) < 0)[0]
+t_cross = t[crossing] - By[crossing] * (t[crossing+1] - t[crossing]) / (By[crossing+1] - By[crossing])
+half_period = np.polyfit(np.arange(len(t_cross)), t_cross, 1)[0]
+f = 0.5 / half_period
+
+error = abs(f - f_th) / f_th
+print('{} zero crossings, f = {} Hz, Kittel frequency = {} Hz, relative error = {}'.format(len(t_cross), f, f_th, error))
+assert len(t_cross) >= 6
+assert error < 1.e-2
@@ -0,0 +1,26 @@
+#!/usr/bin/env python3
+#
+# This file is part of WarpX.
+#
+# License: BSD-3-Clause-LBNL
+#
+# This script checks the lumped elements with the input file inputs_3d. The voltage of the edge
+# of the element, V_e = Ez dz, charges through R into C, with the capacitance of the grid around
+# the edge negligible, so that V_e = V (1 - exp(-t/(R C))).
+import numpy as np
+
+V = 1.
+R = 50.
+C = 1.e-11
+dz = 1.e-3
+
+# step, time, Ez
+data = np.loadtxt('diags/reducedfiles/Ez_edge.txt')
+t = data[:, 1]
+V_e = data[:, 2] * dz
+V_th = V * (1. - np.exp(-t / (R*C)))
+
+# the capacitance of the grid, about 1e-3 C, changes R C by about as much
+error = np.max(np.abs(V_e - V_th)) / V
+print('t = {} R C, V_e = {} V, max error = {}'.format(t[-1] / (R*C), V_e[-1], error))
+assert error < 1.e-2
@@ -0,0 +1,42 @@
+#!/usr/bin/env python3
+#
+# This file is part of WarpX.
+#
+# License: BSD-3-Clause-LBNL
+#
+# This script checks the surface impedance boundary with the input file inputs_3d. A pulse
+# propagating along +z in vacuum passes the probe and is reflected by the conductor z > 0,
+# of surface resistance Rs = sqrt(pi f mu0 / sigma). The ratio of the spectra of the reflected
+# and of the incident pulses is compared, over the band of the pulse, with the reflection
+# coefficient of a resistive surface at normal incidence, |r| = (Z0 - Rs)/(Z0 + Rs).
+import numpy as np
+from scipy.constants import c
+from scipy.constants import mu_0 as mu0
+
+sigma = 1.04e5
+frequency = 3.75e13
+z0 = -32.e-6
+Z0 = mu0 * c
+Rs = np.sqrt(np.pi * frequency * mu0 / sigma)
+r_th = (Z0 - Rs) / (Z0 + Rs)
+
+# step, time, Ey
+data = np.loadtxt('diags/reducedfiles/Ey_probe.txt')
+t = data[:, 1]
+Ey = data[:, 2]
+
+# the incident pulse has passed the probe, and its reflection has not come back yet, when the
+# center of the pulse reaches the conductor
+t_split = -z0 / c
+incident = np.where(t < t_split, Ey, 0.)
+reflected = np.where(t >= t_split, Ey, 0.)
+
+n_fft = 8 * len(t)
+spectrum_incident = np.abs(np.fft.rfft(incident, n_fft))
+spectrum_reflected = np.abs(np.fft.rfft(reflected, n_fft))
+band = spectrum_incident > 0.5*np.max(spectrum_incident)
+r = spectrum_reflected[band] / spectrum_incident[band]
+
+error = np.max(np.abs(r - r_th))
+print('Rs = {} Ohm, |r| = {}, from {} to {} over the band, max error = {}'.format(Rs, r_th, np.min(r), np.max(r), error))
+assert error < 0.03
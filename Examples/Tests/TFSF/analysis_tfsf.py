@@ -0,0 +1,45 @@
+#!/usr/bin/env python3
+#
+# This file is part of WarpX.
+#
+# License: BSD-3-Clause-LBNL
+#
+# This script checks the total-field/scattered-field source with the input file inputs_3d.
+# A Gaussian pulse of amplitude A is injected along +z in vacuum, without any scatterer:
+# when its center is in the middle of the total-field box (first plotfile), its peak must
+# be A and the field in the scattered-field region before the box must vanish; once it has
+# left the box through its upper face (last plotfile), the field must vanish everywhere.
+import glob
+import sys
+
+import numpy as np
+import yt
+
+yt.funcs.mylog.setLevel(50)
+
+A = 1.
+z_box = 3.2e-6
+
+def Ex_along_z(plotfile):
+    """Ex on the axis of the domain, and z of the cells"""
+    ds = yt.load(plotfile)
+    data = ds.covering_grid(level=0, left_edge=ds.domain_left_edge, dims=ds.domain_dimensions)
+    Ex = np.mean(data[('boxlib', 'Ex')].to_ndarray(), axis=(0, 1))
+    z = data[('index', 'z')].to_ndarray()[0, 0, :]
+    return z, Ex
+
+last = sys.argv[1].rstrip('/')
+first = sorted(glob.glob(last[:-6] + '[0-9]' * 6))[0]
+
+z, Ex = Ex_along_z(first)
+peak_error = abs(np.max(Ex) - A) / A
+leakage_before = np.max(np.abs(Ex[z < -z_box])) / A
+z, Ex = Ex_along_z(last)
+leakage_after = np.max(np.abs(Ex)) / A
+
+print('relative error of the injected amplitude = {}'.format(peak_error))
+print('field before the box, relative to A = {}'.format(leakage_before))
+print('field after the pulse has left the box, relative to A = {}'.format(leakage_after))
+assert peak_error < 2.e-2
+assert leakage_before < 1.e-2
+assert leakage_after < 1.e-2
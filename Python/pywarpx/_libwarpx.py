@@ -41,6 +41,33 @@ _LP_c_int = ctypes.POINTER(ctypes.c_int)
 _LP_c_char = ctypes.c_char_p
 
 
+class _DeviceArray():
+    '''
+    View of the data of a FAB, exposed through the CUDA array interface, so that it can be
+    wrapped without a copy, e.g. with cupy.asarray, when the data is in device memory.
+    The data is in Fortran order.
+    '''
+    def __init__(self, address, shape, itemsize, typestr, ngrow=None):
+        strides = []
+        stride = itemsize
+        for n in shape:
+            strides.append(stride)
+            stride *= n
+        shape = list(shape)
+        if ngrow is not None:
+            # --- Skip the guard cells, along the spatial directions
+            for d, ng in enumerate(ngrow):
+                address += ng*strides[d]
+                shape[d] -= 2*ng
+        self.shape = tuple(shape)
+        self.strides = tuple(strides)
+        self.__cuda_array_interface__ = {'shape': self.shape,
+                                         'typestr': typestr,
+                                         'data': (address, False),
+                                         'strides': self.strides,
+                                         'version': 3}
+
+
 class LibWarpX():
 
     """This class manages the warpx shared object, the library from the compiled C++ code.
@@ -52,6 +79,8 @@ class LibWarpX():
     def __init__(self):
         # Track whether amrex and warpx have been initialized
         self.initialized = False
+        # Arrays fetched during a batch, see begin_batch
+        self._batch_cache = None
         atexit.register(self.finalize)
 
     def __getattr__(self, attribute):
@@ -223,6 +252,28 @@ class LibWarpX():
         self.libwarpx_so.warpx_getEdgeLengthsLoVects.restype = _LP_c_int
         self.libwarpx_so.warpx_getFaceAreas.restype = _LP_LP_c_real
         self.libwarpx_so.warpx_getFaceAreasLoVects.restype = _LP_c_int
+        self.libwarpx_so.warpx_getHfieldFP.restype = _LP_LP_c_real
+        self.libwarpx_so.warpx_getHfieldFPLoVects.restype = _LP_c_int
+        self.libwarpx_so.warpx_getMfieldFP.restype = _LP_LP_c_real
+        self.libwarpx_so.warpx_getMfieldFPLoVects.restype = _LP_c_int
+        self.libwarpx_so.warpx_getH_biasfieldFP.restype = _LP_LP_c_real
+        self.libwarpx_so.warpx_getH_biasfieldFPLoVects.restype = _LP_c_int
+        self.libwarpx_so.warpx_getMagMs.restype = _LP_LP_c_real
+        self.libwarpx_so.warpx_getMagMsLoVects.restype = _LP_c_int
+        self.libwarpx_so.warpx_getMagAlpha.restype = _LP_LP_c_real
+        self.libwarpx_so.warpx_getMagAlphaLoVects.restype = _LP_c_int
+        self.libwarpx_so.warpx_getMagGamma.restype = _LP_LP_c_real
+        self.libwarpx_so.warpx_getMagGammaLoVects.restype = _LP_c_int
+        self.libwarpx_so.warpx_getMagExchange.restype = _LP_LP_c_real
+        self.libwarpx_so.warpx_getMagExchangeLoVects.restype = _LP_c_int
+        self.libwarpx_so.warpx_getMagAnisotropy.restype = _LP_LP_c_real
+        self.libwarpx_so.warpx_getMagAnisotropyLoVects.restype = _LP_c_int
+        self.libwarpx_so.warpx_getSigma.restype = _LP_LP_c_real
+        self.libwarpx_so.warpx_getSigmaLoVects.restype = _LP_c_int
+        self.libwarpx_so.warpx_getEpsilon.restype = _LP_LP_c_real
+        self.libwarpx_so.warpx_getEpsilonLoVects.restype = _LP_c_int
+        self.libwarpx_so.warpx_getMu.restype = _LP_LP_c_real
+        self.libwarpx_so.warpx_getMuLoVects.restype = _LP_c_int
 
         self.libwarpx_so.warpx_sumParticleCharge.restype = c_real
         self.libwarpx_so.warpx_getParticleBoundaryBufferSize.restype = ctypes.c_int
@@ -252,6 +303,15 @@ class LibWarpX():
         self.libwarpx_so.warpx_get_face_areas_x_nodal_flag.restype = _LP_c_int
         self.libwarpx_so.warpx_get_face_areas_y_nodal_flag.restype = _LP_c_int
         self.libwarpx_so.warpx_get_face_areas_z_nodal_flag.restype = _LP_c_int
+        self.libwarpx_so.warpx_getHx_nodal_flag.restype = _LP_c_int
+        self.libwarpx_so.warpx_getHy_nodal_flag.restype = _LP_c_int
+        self.libwarpx_so.warpx_getHz_nodal_flag.restype = _LP_c_int
+        self.libwarpx_so.warpx_getMx_nodal_flag.restype = _LP_c_int
+        self.libwarpx_so.warpx_getMy_nodal_flag.restype = _LP_c_int
+        self.libwarpx_so.warpx_getMz_nodal_flag.restype = _LP_c_int
+        self.libwarpx_so.warpx_getSigma_nodal_flag.restype = _LP_c_int
+        self.libwarpx_so.warpx_getEpsilon_nodal_flag.restype = _LP_c_int
+        self.libwarpx_so.warpx_getMu_nodal_flag.restype = _LP_c_int
 
         #self.libwarpx_so.warpx_getPMLSigma.restype = _LP_c_real
         #self.libwarpx_so.warpx_getPMLSigmaStar.restype = _LP_c_real
@@ -278,11 +338,24 @@ class LibWarpX():
         self.libwarpx_so.warpx_finestLevel.restype = ctypes.c_int
         self.libwarpx_so.warpx_getMyProc.restype = ctypes.c_int
         self.libwarpx_so.warpx_getNProcs.restype = ctypes.c_int
+        self.libwarpx_so.warpx_getNumStepPhases.restype = ctypes.c_int
+        self.libwarpx_so.warpx_getStepPhaseName.restype = ctypes.c_char_p
+        self.libwarpx_so.warpx_getStepPhaseTime.restype = c_real
+        self.libwarpx_so.warpx_getStepWallTime.restype = c_real
+        self.libwarpx_so.warpx_getNumMemoryFamilies.restype = ctypes.c_int
+        self.libwarpx_so.warpx_getMemoryFamilyName.restype = ctypes.c_char_p
+        self.libwarpx_so.warpx_getMemoryBytes.restype = ctypes.c_double
 
         self.libwarpx_so.warpx_EvolveE.argtypes = [c_real]
         self.libwarpx_so.warpx_EvolveB.argtypes = [c_real]
         self.libwarpx_so.warpx_FillBoundaryE.argtypes = []
         self.libwarpx_so.warpx_FillBoundaryB.argtypes = []
+        self.libwarpx_so.warpx_MacroscopicEvolveE.argtypes = [c_real]
+        self.libwarpx_so.warpx_MacroscopicEvolveHM.argtypes = [c_real, ctypes.c_int]
+        self.libwarpx_so.warpx_MacroscopicEvolveHM_2nd.argtypes = [c_real, ctypes.c_int]
+        self.libwarpx_so.warpx_FillBoundaryH.argtypes = []
+        self.libwarpx_so.warpx_FillBoundaryM.argtypes = []
+        self.libwarpx_so.warpx_ApplyExternalFieldExcitation.argtypes = [ctypes.c_int, ctypes.c_int]
         self.libwarpx_so.warpx_UpdateAuxilaryData.argtypes = []
         self.libwarpx_so.warpx_SyncCurrent.argtypes = []
         self.libwarpx_so.warpx_PushParticlesandDepose.argtypes = [c_real]
@@ -294,6 +367,10 @@ class LibWarpX():
         self.libwarpx_so.warpx_gett_new.argtypes = [ctypes.c_int]
         self.libwarpx_so.warpx_sett_new.argtypes = [ctypes.c_int, c_real]
         self.libwarpx_so.warpx_getdt.argtypes = [ctypes.c_int]
+        self.libwarpx_so.warpx_getStepPhaseName.argtypes = [ctypes.c_int]
+        self.libwarpx_so.warpx_getStepPhaseTime.argtypes = [ctypes.c_int]
+        self.libwarpx_so.warpx_getMemoryFamilyName.argtypes = [ctypes.c_int]
+        self.libwarpx_so.warpx_getMemoryBytes.argtypes = [ctypes.c_int, ctypes.c_int]
 
     def get_boundary_number(self, boundary):
         '''
@@ -369,6 +446,50 @@ class LibWarpX():
         '''
         return self.libwarpx_so.warpx_getNProcs()
 
+    def get_step_phase_times(self):
+        '''
+
+        Get the wall-clock time of each phase of the last completed step on this
+        processor, as a dictionary from the name of the phase (e.g. 'HM_update')
+        to the time in seconds; 'other' is the rest of the step and 'step' the
+        whole step. The times are recorded unless warpx.step_phase_timers = 0.
+
+        '''
+        times = {}
+        for phase in range(self.libwarpx_so.warpx_getNumStepPhases()):
+            name = self.libwarpx_so.warpx_getStepPhaseName(phase).decode()
+            times[name] = self.libwarpx_so.warpx_getStepPhaseTime(phase)
+        times['step'] = self.libwarpx_so.warpx_getStepWallTime()
+        times['other'] = times['step'] - sum(t for n, t in times.items() if n != 'step')
+        return times
+
+    def get_memory_footprint(self, level=0):
+        '''
+
+        Get the bytes of the arrays of a level allocated on this processor, as a
+        dictionary from the name of the family of arrays (e.g. 'H_fp',
+        'LLG_scratch' or 'particles') to the number of bytes.
+
+        Parameters
+        ----------
+
+            level          : refinement level
+
+        '''
+        return {self.libwarpx_so.warpx_getMemoryFamilyName(f).decode():
+                self.libwarpx_so.warpx_getMemoryBytes(level, f)
+                for f in range(self.libwarpx_so.warpx_getNumMemoryFamilies())}
+
+    def print_memory_report(self):
+        '''
+
+        Print the memory footprint of each family of arrays on each level,
+        maximum and mean over the processors. This must be called by all the
+        processors.
+
+        '''
+        self.libwarpx_so.warpx_printMemoryReport()
+
     def getMyProc(self):
         '''
 
@@ -443,6 +564,38 @@ class LibWarpX():
             self.libwarpx_so.warpx_finalize()
             self.libwarpx_so.amrex_finalize(finalize_mpi)
 
+    def begin_batch(self):
+        '''
+
+        Start a batch of accesses to the data, e.g. during a callback: until end_batch,
+        the lists of arrays of the fields and particles, and their lower corners, are
+        fetched from WarpX once and reused by the following requests. The data must
+        not be reallocated during the batch (adding particles ends the reuse of the
+        particle arrays).
+
+        '''
+        self._batch_cache = {}
+
+    def end_batch(self):
+        '''
+
+        End the batch of accesses started by begin_batch
+
+        '''
+        self._batch_cache = None
+
+    def _batched(self, key, fetch):
+        '''
+
+        Result of fetch(), fetched once per batch for the key
+
+        '''
+        if self._batch_cache is None:
+            return fetch()
+        if key not in self._batch_cache:
+            self._batch_cache[key] = fetch()
+        return self._batch_cache[key]
+
     def getistep(self, level=0):
         '''
 
@@ -479,6 +632,72 @@ class LibWarpX():
 
         self.libwarpx_so.warpx_evolve(num_steps);
 
+    # Values of DtType and ExternalFieldType, as defined in WarpXDtType.H and
+    # WarpXAlgorithmSelection.H
+    dt_types = {'full': 0, 'first_half': 1, 'second_half': 2}
+    excitation_field_types = {'all': 0, 'E': 1, 'B': 2, 'H': 3, 'H_bias': 4, 'E_pml': 5}
+
+    def macroscopic_evolve_E(self, dt):
+        '''
+
+        Advance E by dt in the macroscopic medium (the E update of the field solver).
+
+        '''
+        self.libwarpx_so.warpx_MacroscopicEvolveE(dt)
+
+    def macroscopic_evolve_HM(self, dt, dt_type='full', second_order=False):
+        '''
+
+        Advance H and M by dt with the LLG solver (requires the build with MAG_LLG).
+
+        Parameters
+        ----------
+
+            dt             : the time step of this update
+            dt_type        : 'full', 'first_half' or 'second_half', the part of the
+                             step that is advanced
+            second_order   : whether to use the second order scheme
+                             (macroscopic.mag_time_scheme_order = 2)
+
+        '''
+        if second_order:
+            self.libwarpx_so.warpx_MacroscopicEvolveHM_2nd(dt, self.dt_types[dt_type])
+        else:
+            self.libwarpx_so.warpx_MacroscopicEvolveHM(dt, self.dt_types[dt_type])
+
+    def fill_boundary_H(self):
+        '''
+
+        Fill the guard cells of H (requires the build with MAG_LLG).
+
+        '''
+        self.libwarpx_so.warpx_FillBoundaryH()
+
+    def fill_boundary_M(self):
+        '''
+
+        Fill the guard cells of M (requires the build with MAG_LLG).
+
+        '''
+        self.libwarpx_so.warpx_FillBoundaryM()
+
+    def apply_external_field_excitation(self, field_type, dt_type='full'):
+        '''
+
+        Apply the external excitation of the fields from the input parameters.
+
+        Parameters
+        ----------
+
+            field_type     : the excited field, one of 'all', 'E', 'B', 'H', 'H_bias' and
+                             'E_pml' (excitation of E in the PML)
+            dt_type        : 'full', 'first_half' or 'second_half', the part of the
+                             step for which the soft sources are applied
+
+        '''
+        self.libwarpx_so.warpx_ApplyExternalFieldExcitation(
+            self.excitation_field_types[field_type], self.dt_types[dt_type])
+
     def getProbLo(self, direction):
         assert 0 <= direction < self.dim, 'Inappropriate direction specified'
         return self.libwarpx_so.warpx_getProbLo(direction)
@@ -624,6 +843,10 @@ class LibWarpX():
             ctypes.c_char_p(species_name.encode('utf-8')), x.size,
             x, y, z, ux, uy, uz, nattr, attr, unique_particles
         )
+        # the particle arrays of a batch may have been reallocated
+        if self._batch_cache is not None:
+            self._batch_cache = {key: value for key, value in self._batch_cache.items()
+                                 if key[0] not in ('particle_structs', 'particle_arrays')}
 
     def get_particle_count(self, species_name, local=False):
         '''
@@ -670,6 +893,10 @@ class LibWarpX():
 
         '''
 
+        return self._batched(('particle_structs', species_name, level),
+                             lambda: self._get_particle_structs(species_name, level))
+
+    def _get_particle_structs(self, species_name, level):
         particles_per_tile = _LP_c_int()
         num_tiles = ctypes.c_int(0)
         data = self.libwarpx_so.warpx_getParticleStructs(
@@ -710,6 +937,10 @@ class LibWarpX():
 
         '''
 
+        return self._batched(('particle_arrays', species_name, comp_name, level),
+                             lambda: self._get_particle_arrays(species_name, comp_name, level))
+
+    def _get_particle_arrays(self, species_name, comp_name, level):
         particles_per_tile = _LP_c_int()
         num_tiles = ctypes.c_int(0)
         data = self.libwarpx_so.warpx_getParticleArrays(
@@ -1087,10 +1318,17 @@ class LibWarpX():
         if sync_rho:
             self.libwarpx_so.warpx_SyncRho()
 
-    def _get_mesh_field_list(self, warpx_func, level, direction, include_ghosts):
+    def _get_mesh_field_list(self, warpx_func, level, direction, include_ghosts, device=False):
         """
         Generic routine to fetch the list of field data arrays.
+        With device=True, the arrays are returned as views that expose the
+        CUDA array interface instead of numpy arrays, for data in device memory.
         """
+        return self._batched((warpx_func, level, direction, include_ghosts, device),
+                             lambda: self._fetch_mesh_field_list(warpx_func, level, direction,
+                                                                 include_ghosts, device))
+
+    def _fetch_mesh_field_list(self, warpx_func, level, direction, include_ghosts, device):
         shapes = _LP_c_int()
         size = ctypes.c_int(0)
         ncomps = ctypes.c_int(0)
@@ -1118,6 +1356,12 @@ class LibWarpX():
                 continue
             if not data[i]:
                 raise Exception(f'get_particle_arrays: data[i] for i={i} was not initialized')
+            if device:
+                grid_data.append(_DeviceArray(ctypes.cast(data[i], ctypes.c_void_p).value, shape,
+                                              np.dtype(self._numpy_real_dtype).itemsize,
+                                              np.dtype(self._numpy_real_dtype).str,
+                                              None if include_ghosts else ngvect))
+                continue
             arr = np.ctypeslib.as_array(data[i], shape[::-1]).T
             try:
                 # This fails on some versions of numpy
@@ -1876,45 +2120,16 @@ class LibWarpX():
 
         return self._get_mesh_field_list(self.libwarpx_so.warpx_getFaceAreas, level, direction, include_ghosts)
 
-    def _get_mesh_array_lovects(self, level, direction, include_ghosts=True, getlovectsfunc=None):
-        assert(0 <= level and level <= self.libwarpx_so.warpx_finestLevel())
-
-        size = ctypes.c_int(0)
-        ngrowvect = _LP_c_int()
-        if direction is None:
-            data = getlovectsfunc(level, ctypes.byref(size), ctypes.byref(ngrowvect))
-        else:
-            data = getlovectsfunc(level, direction, ctypes.byref(size), ctypes.byref(ngrowvect))
-
-        if not data:
-            raise Exception('object was not initialized')
-
-        lovects_ref = np.ctypeslib.as_array(data, (size.value, self.dim))
-
-        # --- Make a copy of the data to avoid memory problems
-        # --- Also, take the transpose to give shape (dims, number of grids)
-        lovects = lovects_ref.copy().T
-
-        ng = []
-        if include_ghosts:
-            for d in range(self.dim):
-                ng.append(ngrowvect[d])
-        else:
-            for d in range(self.dim):
-                ng.append(0)
-                lovects[d,:] += ngrowvect[d]
-
-        del lovects_ref
-        _libc.free(data)
-        return lovects, ng
-
-    def get_mesh_electric_field_lovects(self, level, direction, include_ghosts=True):
+    def get_mesh_H_field_fp(self, level, direction, include_ghosts=True, device=False):
         '''
 
-        This returns a list of the lo vectors of the arrays containing the mesh electric field
-        data on each grid for this process.
+        This returns a list of numpy arrays containing the mesh H field
+        data on each grid for this process. This version returns the data on
+        the fine patch for the given level. This requires WarpX built with
+        the magnetization solver (WarpX_MAG_LLG).
 
-        This version is for the full "auxiliary" solution on the given level.
+        The data for the numpy arrays are not copied, but share the underlying
+        memory buffer with WarpX. The numpy arrays are fully writeable.
 
         Parameters
         ----------
@@ -1922,41 +2137,59 @@ class LibWarpX():
             level          : the AMR level to get the data for
             direction      : the component of the data you want
             include_ghosts : whether to include ghost zones or not
+            device         : whether to return views exposing the CUDA array interface
+                             (e.g. for cupy.asarray) instead of numpy arrays, for data in
+                             device memory
 
         Returns
         -------
 
-            A 2d numpy array of the lo vector for each grid with the shape (dims, number of grids)
+            A List of numpy arrays (or of views with the CUDA array interface).
 
         '''
-        return self._get_mesh_array_lovects(level, direction, include_ghosts, self.libwarpx_so.warpx_getEfieldLoVects)
 
-    def get_mesh_electric_field_cp_lovects(self, level, direction, include_ghosts=True):
+        return self._get_mesh_field_list(self.libwarpx_so.warpx_getHfieldFP, level, direction, include_ghosts, device)
+
+    def get_mesh_M_field_fp(self, level, direction, include_ghosts=True, device=False):
         '''
 
-        This returns a list of the lo vectors of the arrays containing the mesh electric field
-        data on each grid for this process.
+        This returns a list of numpy arrays containing the mesh magnetization M
+        data on each grid for this process. This version returns the data on
+        the fine patch for the given level. This requires WarpX built with
+        the magnetization solver (WarpX_MAG_LLG).
+
+        The data for the numpy arrays are not copied, but share the underlying
+        memory buffer with WarpX. The numpy arrays are fully writeable.
 
         Parameters
         ----------
 
             level          : the AMR level to get the data for
-            direction      : the component of the data you want
+            direction      : the face of the data you want (each face holds the 3 components of M)
             include_ghosts : whether to include ghost zones or not
+            device         : whether to return views exposing the CUDA array interface
+                             (e.g. for cupy.asarray) instead of numpy arrays, for data in
+                             device memory
 
         Returns
         -------
 
-            A 2d numpy array of the lo vector for each grid with the shape (dims, number of grids)
+            A List of numpy arrays (or of views with the CUDA array interface).
 
         '''
-        return self._get_mesh_array_lovects(level, direction, include_ghosts, self.libwarpx_so.warpx_getEfieldCPLoVects)
 
-    def get_mesh_electric_field_fp_lovects(self, level, direction, include_ghosts=True):
+        return self._get_mesh_field_list(self.libwarpx_so.warpx_getMfieldFP, level, direction, include_ghosts, device)
+
+    def get_mesh_H_bias_field_fp(self, level, direction, include_ghosts=True, device=False):
         '''
 
-        This returns a list of the lo vectors of the arrays containing the mesh electric field
-        data on each grid for this process.
+        This returns a list of numpy arrays containing the mesh bias field H_bias
+        data on each grid for this process. This version returns the data on
+        the fine patch for the given level. This requires WarpX built with
+        the magnetization solver (WarpX_MAG_LLG).
+
+        The data for the numpy arrays are not copied, but share the underlying
+        memory buffer with WarpX. The numpy arrays are fully writeable.
 
         Parameters
         ----------
@@ -1964,163 +2197,208 @@ class LibWarpX():
             level          : the AMR level to get the data for
             direction      : the component of the data you want
             include_ghosts : whether to include ghost zones or not
+            device         : whether to return views exposing the CUDA array interface
+                             (e.g. for cupy.asarray) instead of numpy arrays, for data in
+                             device memory
 
         Returns
         -------
 
-            A 2d numpy array of the lo vector for each grid with the shape (dims, number of grids)
+            A List of numpy arrays (or of views with the CUDA array interface).
 
         '''
-        return self._get_mesh_array_lovects(level, direction, include_ghosts, self.libwarpx_so.warpx_getEfieldFPLoVects)
 
-    def get_mesh_electric_field_cp_lovects_pml(self, level, direction, include_ghosts=True):
+        return self._get_mesh_field_list(self.libwarpx_so.warpx_getH_biasfieldFP, level, direction, include_ghosts, device)
+
+    def get_mesh_mag_Ms(self, level, direction, include_ghosts=True, device=False):
         '''
 
-        This returns a list of the lo vectors of the arrays containing the mesh electric field
-        data on each PML grid for this process.
+        This returns a list of numpy arrays containing the saturation magnetization Ms
+        data on each grid for this process. This version returns the data on
+        the fine patch for the given level. This requires WarpX built with
+        the magnetization solver (WarpX_MAG_LLG).
+
+        The data for the numpy arrays are not copied, but share the underlying
+        memory buffer with WarpX. The numpy arrays are fully writeable.
 
         Parameters
         ----------
 
             level          : the AMR level to get the data for
-            direction      : the component of the data you want
+            direction      : the face of the data you want
             include_ghosts : whether to include ghost zones or not
+            device         : whether to return views exposing the CUDA array interface
+                             (e.g. for cupy.asarray) instead of numpy arrays, for data in
+                             device memory
 
         Returns
         -------
 
-            A 2d numpy array of the lo vector for each grid with the shape (dims, number of grids)
+            A List of numpy arrays (or of views with the CUDA array interface).
 
         '''
-        try:
-            return self._get_mesh_array_lovects(level, direction, include_ghosts, self.libwarpx_so.warpx_getEfieldCPLoVects_PML)
-        except ValueError:
-            raise Exception('PML not initialized')
 
-    def get_mesh_electric_field_fp_lovects_pml(self, level, direction, include_ghosts=True):
+        return self._get_mesh_field_list(self.libwarpx_so.warpx_getMagMs, level, direction, include_ghosts, device)
+
+    def get_mesh_mag_alpha(self, level, direction, include_ghosts=True, device=False):
         '''
 
-        This returns a list of the lo vectors of the arrays containing the mesh electric field
-        data on each PML grid for this process.
+        This returns a list of numpy arrays containing the Gilbert damping factor alpha
+        data on each grid for this process. This version returns the data on
+        the fine patch for the given level. This requires WarpX built with
+        the magnetization solver (WarpX_MAG_LLG).
+
+        The data for the numpy arrays are not copied, but share the underlying
+        memory buffer with WarpX. The numpy arrays are fully writeable.
 
         Parameters
         ----------
 
             level          : the AMR level to get the data for
-            direction      : the component of the data you want
+            direction      : the face of the data you want
             include_ghosts : whether to include ghost zones or not
+            device         : whether to return views exposing the CUDA array interface
+                             (e.g. for cupy.asarray) instead of numpy arrays, for data in
+                             device memory
 
         Returns
         -------
 
-            A 2d numpy array of the lo vector for each grid with the shape (dims, number of grids)
+            A List of numpy arrays (or of views with the CUDA array interface).
 
         '''
-        try:
-            return self._get_mesh_array_lovects(level, direction, include_ghosts, self.libwarpx_so.warpx_getEfieldFPLoVects_PML)
-        except ValueError:
-            raise Exception('PML not initialized')
 
-    def get_mesh_magnetic_field_lovects(self, level, direction, include_ghosts=True):
+        return self._get_mesh_field_list(self.libwarpx_so.warpx_getMagAlpha, level, direction, include_ghosts, device)
+
+    def get_mesh_mag_gamma(self, level, direction, include_ghosts=True, device=False):
         '''
 
-        This returns a list of the lo vectors of the arrays containing the mesh electric field
-        data on each grid for this process.
+        This returns a list of numpy arrays containing the gyromagnetic ratio gamma
+        data on each grid for this process. This version returns the data on
+        the fine patch for the given level. This requires WarpX built with
+        the magnetization solver (WarpX_MAG_LLG).
 
-        This version is for the full "auxiliary" solution on the given level.
+        The data for the numpy arrays are not copied, but share the underlying
+        memory buffer with WarpX. The numpy arrays are fully writeable.
 
         Parameters
         ----------
 
             level          : the AMR level to get the data for
-            direction      : the component of the data you want
+            direction      : the face of the data you want
             include_ghosts : whether to include ghost zones or not
+            device         : whether to return views exposing the CUDA array interface
+                             (e.g. for cupy.asarray) instead of numpy arrays, for data in
+                             device memory
 
         Returns
         -------
 
-            A 2d numpy array of the lo vector for each grid with the shape (dims, number of grids)
+            A List of numpy arrays (or of views with the CUDA array interface).
 
         '''
-        return self._get_mesh_array_lovects(level, direction, include_ghosts, self.libwarpx_so.warpx_getBfieldLoVects)
 
-    def get_mesh_magnetic_field_cp_lovects(self, level, direction, include_ghosts=True):
+        return self._get_mesh_field_list(self.libwarpx_so.warpx_getMagGamma, level, direction, include_ghosts, device)
+
+    def get_mesh_mag_exchange(self, level, direction, include_ghosts=True, device=False):
         '''
 
-        This returns a list of the lo vectors of the arrays containing the mesh electric field
-        data on each grid for this process.
+        This returns a list of numpy arrays containing the exchange coupling constant
+        data on each grid for this process. This version returns the data on
+        the fine patch for the given level. This requires WarpX built with
+        the magnetization solver (WarpX_MAG_LLG).
+
+        The data for the numpy arrays are not copied, but share the underlying
+        memory buffer with WarpX. The numpy arrays are fully writeable.
 
         Parameters
         ----------
 
             level          : the AMR level to get the data for
-            direction      : the component of the data you want
+            direction      : the face of the data you want
             include_ghosts : whether to include ghost zones or not
+            device         : whether to return views exposing the CUDA array interface
+                             (e.g. for cupy.asarray) instead of numpy arrays, for data in
+                             device memory
 
         Returns
         -------
 
-            A 2d numpy array of the lo vector for each grid with the shape (dims, number of grids)
+            A List of numpy arrays (or of views with the CUDA array interface).
 
         '''
-        return self._get_mesh_array_lovects(level, direction, include_ghosts, self.libwarpx_so.warpx_getBfieldCPLoVects)
 
-    def get_mesh_magnetic_field_fp_lovects(self, level, direction, include_ghosts=True):
+        return self._get_mesh_field_list(self.libwarpx_so.warpx_getMagExchange, level, direction, include_ghosts, device)
+
+    def get_mesh_mag_anisotropy(self, level, direction, include_ghosts=True, device=False):
         '''
 
-        This returns a list of the lo vectors of the arrays containing the mesh electric field
-        data on each grid for this process.
+        This returns a list of numpy arrays containing the anisotropy constant
+        data on each grid for this process. This version returns the data on
+        the fine patch for the given level. This requires WarpX built with
+        the magnetization solver (WarpX_MAG_LLG).
+
+        The data for the numpy arrays are not copied, but share the underlying
+        memory buffer with WarpX. The numpy arrays are fully writeable.
 
         Parameters
         ----------
 
             level          : the AMR level to get the data for
-            direction      : the component of the data you want
+            direction      : the face of the data you want
             include_ghosts : whether to include ghost zones or not
+            device         : whether to return views exposing the CUDA array interface
+                             (e.g. for cupy.asarray) instead of numpy arrays, for data in
+                             device memory
 
         Returns
         -------
 
-            A 2d numpy array of the lo vector for each grid with the shape (dims, number of grids)
+            A List of numpy arrays (or of views with the CUDA array interface).
 
         '''
-        return self._get_mesh_array_lovects(level, direction, include_ghosts, self.libwarpx_so.warpx_getBfieldFPLoVects)
 
-    def get_mesh_magnetic_field_cp_lovects_pml(self, level, direction, include_ghosts=True):
+        return self._get_mesh_field_list(self.libwarpx_so.warpx_getMagAnisotropy, level, direction, include_ghosts, device)
+
+    def get_mesh_sigma(self, level, include_ghosts=True, device=False):
         '''
 
-        This returns a list of the lo vectors of the arrays containing the mesh electric field
-        data on each PML grid for this process.
+        This returns a list of numpy arrays containing the conductivity sigma
+        data on each grid for this process. This requires
+        algo.em_solver_medium = macroscopic.
+
+        The data for the numpy arrays are not copied, but share the underlying
+        memory buffer with WarpX. The numpy arrays are fully writeable: after
+        modifying them, call material_properties_modified.
 
         Parameters
         ----------
 
             level          : the AMR level to get the data for
-            direction      : the component of the data you want
             include_ghosts : whether to include ghost zones or not
+            device         : whether to return views exposing the CUDA array interface
+                             (e.g. for cupy.asarray) instead of numpy arrays, for data in
+                             device memory
 
         Returns
         -------
 
-            A 2d numpy array of the lo vector for each grid with the shape (dims, number of grids)
+            A List of numpy arrays (or of views with the CUDA array interface).
 
         '''
-        try:
-            return self._get_mesh_array_lovects(level, direction, include_ghosts, self.libwarpx_so.warpx_getBfieldCPLoVects_PML)
-        except ValueError:
-            raise Exception('PML not initialized')
 
-    def get_mesh_magnetic_field_fp_lovects_pml(self, level, direction, include_ghosts=True):
+        return self._get_mesh_field_list(self.libwarpx_so.warpx_getSigma, level, None, include_ghosts, device)
+
+    def get_mesh_sigma_lovects(self, level, include_ghosts=True):
         '''
 
-        This returns a list of the lo vectors of the arrays containing the mesh electric field
-        data on each PML grid for this process.
+        This returns a list of the lo vectors of the arrays containing the conductivity sigma
+        data on each grid for this process.
 
         Parameters
         ----------
 
             level          : the AMR level to get the data for
-            direction      : the component of the data you want
             include_ghosts : whether to include ghost zones or not
 
         Returns
@@ -2129,43 +2407,47 @@ class LibWarpX():
             A 2d numpy array of the lo vector for each grid with the shape (dims, number of grids)
 
         '''
-        try:
-            return self._get_mesh_array_lovects(level, direction, include_ghosts, self.libwarpx_so.warpx_getBfieldFPLoVects_PML)
-        except ValueError:
-            raise Exception('PML not initialized')
+        return self._get_mesh_array_lovects(level, None, include_ghosts, self.libwarpx_so.warpx_getSigmaLoVects)
 
-    def get_mesh_current_density_lovects(self, level, direction, include_ghosts=True):
+    def get_mesh_epsilon(self, level, include_ghosts=True, device=False):
         '''
 
-        This returns a list of the lo vectors of the arrays containing the mesh electric field
-        data on each grid for this process.
+        This returns a list of numpy arrays containing the permittivity epsilon
+        data on each grid for this process. This requires
+        algo.em_solver_medium = macroscopic.
+
+        The data for the numpy arrays are not copied, but share the underlying
+        memory buffer with WarpX. The numpy arrays are fully writeable: after
+        modifying them, call material_properties_modified.
 
         Parameters
         ----------
 
             level          : the AMR level to get the data for
-            direction      : the component of the data you want
             include_ghosts : whether to include ghost zones or not
+            device         : whether to return views exposing the CUDA array interface
+                             (e.g. for cupy.asarray) instead of numpy arrays, for data in
+                             device memory
 
         Returns
         -------
 
-            A 2d numpy array of the lo vector for each grid with the shape (dims, number of grids)
+            A List of numpy arrays (or of views with the CUDA array interface).
 
         '''
-        return self._get_mesh_array_lovects(level, direction, include_ghosts, self.libwarpx_so.warpx_getCurrentDensityLoVects)
 
-    def get_mesh_current_density_cp_lovects(self, level, direction, include_ghosts=True):
+        return self._get_mesh_field_list(self.libwarpx_so.warpx_getEpsilon, level, None, include_ghosts, device)
+
+    def get_mesh_epsilon_lovects(self, level, include_ghosts=True):
         '''
 
-        This returns a list of the lo vectors of the arrays containing the mesh electric field
+        This returns a list of the lo vectors of the arrays containing the permittivity epsilon
         data on each grid for this process.
 
         Parameters
         ----------
 
             level          : the AMR level to get the data for
-            direction      : the component of the data you want
             include_ghosts : whether to include ghost zones or not
 
         Returns
@@ -2174,40 +2456,47 @@ class LibWarpX():
             A 2d numpy array of the lo vector for each grid with the shape (dims, number of grids)
 
         '''
-        return self._get_mesh_array_lovects(level, direction, include_ghosts, self.libwarpx_so.warpx_getCurrentDensityCPLoVects)
+        return self._get_mesh_array_lovects(level, None, include_ghosts, self.libwarpx_so.warpx_getEpsilonLoVects)
 
-    def get_mesh_current_density_fp_lovects(self, level, direction, include_ghosts=True):
+    def get_mesh_mu(self, level, include_ghosts=True, device=False):
         '''
 
-        This returns a list of the lo vectors of the arrays containing the mesh electric field
-        data on each grid for this process.
+        This returns a list of numpy arrays containing the permeability mu
+        data on each grid for this process. This requires
+        algo.em_solver_medium = macroscopic.
+
+        The data for the numpy arrays are not copied, but share the underlying
+        memory buffer with WarpX. The numpy arrays are fully writeable: after
+        modifying them, call material_properties_modified.
 
         Parameters
         ----------
 
             level          : the AMR level to get the data for
-            direction      : the component of the data you want
             include_ghosts : whether to include ghost zones or not
+            device         : whether to return views exposing the CUDA array interface
+                             (e.g. for cupy.asarray) instead of numpy arrays, for data in
+                             device memory
 
         Returns
         -------
 
-            A 2d numpy array of the lo vector for each grid with the shape (dims, number of grids)
+            A List of numpy arrays (or of views with the CUDA array interface).
 
         '''
-        return self._get_mesh_array_lovects(level, direction, include_ghosts, self.libwarpx_so.warpx_getCurrentDensityFPLoVects)
 
-    def get_mesh_current_density_cp_lovects_pml(self, level, direction, include_ghosts=True):
+        return self._get_mesh_field_list(self.libwarpx_so.warpx_getMu, level, None, include_ghosts, device)
+
+    def get_mesh_mu_lovects(self, level, include_ghosts=True):
         '''
 
-        This returns a list of the lo vectors of the arrays containing the mesh electric field
-        data on each PML grid for this process.
+        This returns a list of the lo vectors of the arrays containing the permeability mu
+        data on each grid for this process.
 
         Parameters
         ----------
 
             level          : the AMR level to get the data for
-            direction      : the component of the data you want
             include_ghosts : whether to include ghost zones or not
 
         Returns
@@ -2216,32 +2505,427 @@ class LibWarpX():
             A 2d numpy array of the lo vector for each grid with the shape (dims, number of grids)
 
         '''
-        try:
-            return self._get_mesh_array_lovects(level, direction, include_ghosts, self.libwarpx_so.warpx_getCurrentDensityCPLoVects_PML)
-        except ValueError:
-            raise Exception('PML not initialized')
+        return self._get_mesh_array_lovects(level, None, include_ghosts, self.libwarpx_so.warpx_getMuLoVects)
 
-    def get_mesh_current_density_fp_lovects_pml(self, level, direction, include_ghosts=True):
+    def material_properties_modified(self, level=0):
         '''
 
-        This returns a list of the lo vectors of the arrays containing the mesh electric field
-        data on each PML grid for this process.
+        Update the quantities derived from the material properties (sigma, epsilon, mu
+        and the mag_* properties) after they were modified in place, through the arrays
+        returned by get_mesh_sigma, get_mesh_mag_Ms, etc. The medium is then no longer
+        treated as uniform.
 
         Parameters
         ----------
 
-            level          : the AMR level to get the data for
-            direction      : the component of the data you want
-            include_ghosts : whether to include ghost zones or not
-
-        Returns
-        -------
+            level          : the AMR level of the modified properties
 
-            A 2d numpy array of the lo vector for each grid with the shape (dims, number of grids)
+        '''
+        self.libwarpx_so.warpx_materialPropertiesModified(level)
 
+    def reset_material_properties(self, level=0):
         '''
-        try:
-            return self._get_mesh_array_lovects(level, direction, include_ghosts, self.libwarpx_so.warpx_getCurrentDensityFPLoVects_PML)
+
+        Evaluate the material properties from the input parameters again (constants,
+        parsers or material indices), discarding the modifications made in place.
+        The arrays are allocated again: those obtained before must be fetched again.
+
+        Parameters
+        ----------
+
+            level          : the AMR level of the properties
+
+        '''
+        self.libwarpx_so.warpx_resetMaterialProperties(level)
+
+    def rewind_fields(self, init_values=True):
+        '''
+
+        Rewind the simulation to step 0, to run another simulation in the same process
+        without initializing WarpX again: the fields, the sources and the PML fields are
+        set to zero, then to their initial values from the input if init_values, and the
+        step and the time are reset to 0. The particles, the material properties and the
+        diagnostics are not modified.
+
+        Parameters
+        ----------
+
+            init_values    : whether to set the fields to their initial values, or to zero
+
+        '''
+        self.libwarpx_so.warpx_rewindFields(1 if init_values else 0)
+
+    def _get_mesh_array_lovects(self, level, direction, include_ghosts=True, getlovectsfunc=None):
+        return self._batched((getlovectsfunc, level, direction, include_ghosts),
+                             lambda: self._fetch_mesh_array_lovects(level, direction,
+                                                                    include_ghosts, getlovectsfunc))
+
+    def _fetch_mesh_array_lovects(self, level, direction, include_ghosts, getlovectsfunc):
+        assert(0 <= level and level <= self.libwarpx_so.warpx_finestLevel())
+
+        size = ctypes.c_int(0)
+        ngrowvect = _LP_c_int()
+        if direction is None:
+            data = getlovectsfunc(level, ctypes.byref(size), ctypes.byref(ngrowvect))
+        else:
+            data = getlovectsfunc(level, direction, ctypes.byref(size), ctypes.byref(ngrowvect))
+
+        if not data:
+            raise Exception('object was not initialized')
+
+        lovects_ref = np.ctypeslib.as_array(data, (size.value, self.dim))
+
+        # --- Make a copy of the data to avoid memory problems
+        # --- Also, take the transpose to give shape (dims, number of grids)
+        lovects = lovects_ref.copy().T
+
+        ng = []
+        if include_ghosts:
+            for d in range(self.dim):
+                ng.append(ngrowvect[d])
+        else:
+            for d in range(self.dim):
+                ng.append(0)
+                lovects[d,:] += ngrowvect[d]
+
+        del lovects_ref
+        _libc.free(data)
+        return lovects, ng
+
+    def get_mesh_electric_field_lovects(self, level, direction, include_ghosts=True):
+        '''
+
+        This returns a list of the lo vectors of the arrays containing the mesh electric field
+        data on each grid for this process.
+
+        This version is for the full "auxiliary" solution on the given level.
+
+        Parameters
+        ----------
+
+            level          : the AMR level to get the data for
+            direction      : the component of the data you want
+            include_ghosts : whether to include ghost zones or not
+
+        Returns
+        -------
+
+            A 2d numpy array of the lo vector for each grid with the shape (dims, number of grids)
+
+        '''
+        return self._get_mesh_array_lovects(level, direction, include_ghosts, self.libwarpx_so.warpx_getEfieldLoVects)
+
+    def get_mesh_electric_field_cp_lovects(self, level, direction, include_ghosts=True):
+        '''
+
+        This returns a list of the lo vectors of the arrays containing the mesh electric field
+        data on each grid for this process.
+
+        Parameters
+        ----------
+
+            level          : the AMR level to get the data for
+            direction      : the component of the data you want
+            include_ghosts : whether to include ghost zones or not
+
+        Returns
+        -------
+
+            A 2d numpy array of the lo vector for each grid with the shape (dims, number of grids)
+
+        '''
+        return self._get_mesh_array_lovects(level, direction, include_ghosts, self.libwarpx_so.warpx_getEfieldCPLoVects)
+
+    def get_mesh_electric_field_fp_lovects(self, level, direction, include_ghosts=True):
+        '''
+
+        This returns a list of the lo vectors of the arrays containing the mesh electric field
+        data on each grid for this process.
+
+        Parameters
+        ----------
+
+            level          : the AMR level to get the data for
+            direction      : the component of the data you want
+            include_ghosts : whether to include ghost zones or not
+
+        Returns
+        -------
+
+            A 2d numpy array of the lo vector for each grid with the shape (dims, number of grids)
+
+        '''
+        return self._get_mesh_array_lovects(level, direction, include_ghosts, self.libwarpx_so.warpx_getEfieldFPLoVects)
+
+    def get_mesh_electric_field_cp_lovects_pml(self, level, direction, include_ghosts=True):
+        '''
+
+        This returns a list of the lo vectors of the arrays containing the mesh electric field
+        data on each PML grid for this process.
+
+        Parameters
+        ----------
+
+            level          : the AMR level to get the data for
+            direction      : the component of the data you want
+            include_ghosts : whether to include ghost zones or not
+
+        Returns
+        -------
+
+            A 2d numpy array of the lo vector for each grid with the shape (dims, number of grids)
+
+        '''
+        try:
+            return self._get_mesh_array_lovects(level, direction, include_ghosts, self.libwarpx_so.warpx_getEfieldCPLoVects_PML)
+        except ValueError:
+            raise Exception('PML not initialized')
+
+    def get_mesh_electric_field_fp_lovects_pml(self, level, direction, include_ghosts=True):
+        '''
+
+        This returns a list of the lo vectors of the arrays containing the mesh electric field
+        data on each PML grid for this process.
+
+        Parameters
+        ----------
+
+            level          : the AMR level to get the data for
+            direction      : the component of the data you want
+            include_ghosts : whether to include ghost zones or not
+
+        Returns
+        -------
+
+            A 2d numpy array of the lo vector for each grid with the shape (dims, number of grids)
+
+        '''
+        try:
+            return self._get_mesh_array_lovects(level, direction, include_ghosts, self.libwarpx_so.warpx_getEfieldFPLoVects_PML)
+        except ValueError:
+            raise Exception('PML not initialized')
+
+    def get_mesh_magnetic_field_lovects(self, level, direction, include_ghosts=True):
+        '''
+
+        This returns a list of the lo vectors of the arrays containing the mesh electric field
+        data on each grid for this process.
+
+        This version is for the full "auxiliary" solution on the given level.
+
+        Parameters
+        ----------
+
+            level          : the AMR level to get the data for
+            direction      : the component of the data you want
+            include_ghosts : whether to include ghost zones or not
+
+        Returns
+        -------
+
+            A 2d numpy array of the lo vector for each grid with the shape (dims, number of grids)
+
+        '''
+        return self._get_mesh_array_lovects(level, direction, include_ghosts, self.libwarpx_so.warpx_getBfieldLoVects)
+
+    def get_mesh_magnetic_field_cp_lovects(self, level, direction, include_ghosts=True):
+        '''
+
+        This returns a list of the lo vectors of the arrays containing the mesh electric field
+        data on each grid for this process.
+
+        Parameters
+        ----------
+
+            level          : the AMR level to get the data for
+            direction      : the component of the data you want
+            include_ghosts : whether to include ghost zones or not
+
+        Returns
+        -------
+
+            A 2d numpy array of the lo vector for each grid with the shape (dims, number of grids)
+
+        '''
+        return self._get_mesh_array_lovects(level, direction, include_ghosts, self.libwarpx_so.warpx_getBfieldCPLoVects)
+
+    def get_mesh_magnetic_field_fp_lovects(self, level, direction, include_ghosts=True):
+        '''
+
+        This returns a list of the lo vectors of the arrays containing the mesh electric field
+        data on each grid for this process.
+
+        Parameters
+        ----------
+
+            level          : the AMR level to get the data for
+            direction      : the component of the data you want
+            include_ghosts : whether to include ghost zones or not
+
+        Returns
+        -------
+
+            A 2d numpy array of the lo vector for each grid with the shape (dims, number of grids)
+
+        '''
+        return self._get_mesh_array_lovects(level, direction, include_ghosts, self.libwarpx_so.warpx_getBfieldFPLoVects)
+
+    def get_mesh_magnetic_field_cp_lovects_pml(self, level, direction, include_ghosts=True):
+        '''
+
+        This returns a list of the lo vectors of the arrays containing the mesh electric field
+        data on each PML grid for this process.
+
+        Parameters
+        ----------
+
+            level          : the AMR level to get the data for
+            direction      : the component of the data you want
+            include_ghosts : whether to include ghost zones or not
+
+        Returns
+        -------
+
+            A 2d numpy array of the lo vector for each grid with the shape (dims, number of grids)
+
+        '''
+        try:
+            return self._get_mesh_array_lovects(level, direction, include_ghosts, self.libwarpx_so.warpx_getBfieldCPLoVects_PML)
+        except ValueError:
+            raise Exception('PML not initialized')
+
+    def get_mesh_magnetic_field_fp_lovects_pml(self, level, direction, include_ghosts=True):
+        '''
+
+        This returns a list of the lo vectors of the arrays containing the mesh electric field
+        data on each PML grid for this process.
+
+        Parameters
+        ----------
+
+            level          : the AMR level to get the data for
+            direction      : the component of the data you want
+            include_ghosts : whether to include ghost zones or not
+
+        Returns
+        -------
+
+            A 2d numpy array of the lo vector for each grid with the shape (dims, number of grids)
+
+        '''
+        try:
+            return self._get_mesh_array_lovects(level, direction, include_ghosts, self.libwarpx_so.warpx_getBfieldFPLoVects_PML)
+        except ValueError:
+            raise Exception('PML not initialized')
+
+    def get_mesh_current_density_lovects(self, level, direction, include_ghosts=True):
+        '''
+
+        This returns a list of the lo vectors of the arrays containing the mesh electric field
+        data on each grid for this process.
+
+        Parameters
+        ----------
+
+            level          : the AMR level to get the data for
+            direction      : the component of the data you want
+            include_ghosts : whether to include ghost zones or not
+
+        Returns
+        -------
+
+            A 2d numpy array of the lo vector for each grid with the shape (dims, number of grids)
+
+        '''
+        return self._get_mesh_array_lovects(level, direction, include_ghosts, self.libwarpx_so.warpx_getCurrentDensityLoVects)
+
+    def get_mesh_current_density_cp_lovects(self, level, direction, include_ghosts=True):
+        '''
+
+        This returns a list of the lo vectors of the arrays containing the mesh electric field
+        data on each grid for this process.
+
+        Parameters
+        ----------
+
+            level          : the AMR level to get the data for
+            direction      : the component of the data you want
+            include_ghosts : whether to include ghost zones or not
+
+        Returns
+        -------
+
+            A 2d numpy array of the lo vector for each grid with the shape (dims, number of grids)
+
+        '''
+        return self._get_mesh_array_lovects(level, direction, include_ghosts, self.libwarpx_so.warpx_getCurrentDensityCPLoVects)
+
+    def get_mesh_current_density_fp_lovects(self, level, direction, include_ghosts=True):
+        '''
+
+        This returns a list of the lo vectors of the arrays containing the mesh electric field
+        data on each grid for this process.
+
+        Parameters
+        ----------
+
+            level          : the AMR level to get the data for
+            direction      : the component of the data you want
+            include_ghosts : whether to include ghost zones or not
+
+        Returns
+        -------
+
+            A 2d numpy array of the lo vector for each grid with the shape (dims, number of grids)
+
+        '''
+        return self._get_mesh_array_lovects(level, direction, include_ghosts, self.libwarpx_so.warpx_getCurrentDensityFPLoVects)
+
+    def get_mesh_current_density_cp_lovects_pml(self, level, direction, include_ghosts=True):
+        '''
+
+        This returns a list of the lo vectors of the arrays containing the mesh electric field
+        data on each PML grid for this process.
+
+        Parameters
+        ----------
+
+            level          : the AMR level to get the data for
+            direction      : the component of the data you want
+            include_ghosts : whether to include ghost zones or not
+
+        Returns
+        -------
+
+            A 2d numpy array of the lo vector for each grid with the shape (dims, number of grids)
+
+        '''
+        try:
+            return self._get_mesh_array_lovects(level, direction, include_ghosts, self.libwarpx_so.warpx_getCurrentDensityCPLoVects_PML)
+        except ValueError:
+            raise Exception('PML not initialized')
+
+    def get_mesh_current_density_fp_lovects_pml(self, level, direction, include_ghosts=True):
+        '''
+
+        This returns a list of the lo vectors of the arrays containing the mesh electric field
+        data on each PML grid for this process.
+
+        Parameters
+        ----------
+
+            level          : the AMR level to get the data for
+            direction      : the component of the data you want
+            include_ghosts : whether to include ghost zones or not
+
+        Returns
+        -------
+
+            A 2d numpy array of the lo vector for each grid with the shape (dims, number of grids)
+
+        '''
+        try:
+            return self._get_mesh_array_lovects(level, direction, include_ghosts, self.libwarpx_so.warpx_getCurrentDensityFPLoVects_PML)
         except ValueError:
             raise Exception('PML not initialized')
 
@@ -2519,6 +3203,174 @@ class LibWarpX():
         '''
         return self._get_mesh_array_lovects(level, direction, include_ghosts, self.libwarpx_so.warpx_getFaceAreasLoVects)
 
+    def get_mesh_H_field_fp_lovects(self, level, direction, include_ghosts=True):
+        '''
+
+        This returns a list of the lo vectors of the arrays containing the mesh H field
+        data on each grid for this process.
+
+        Parameters
+        ----------
+
+            level          : the AMR level to get the data for
+            direction      : the component of the data you want
+            include_ghosts : whether to include ghost zones or not
+
+        Returns
+        -------
+
+            A 2d numpy array of the lo vector for each grid with the shape (dims, number of grids)
+
+        '''
+        return self._get_mesh_array_lovects(level, direction, include_ghosts, self.libwarpx_so.warpx_getHfieldFPLoVects)
+
+    def get_mesh_M_field_fp_lovects(self, level, direction, include_ghosts=True):
+        '''
+
+        This returns a list of the lo vectors of the arrays containing the mesh magnetization M
+        data on each grid for this process.
+
+        Parameters
+        ----------
+
+            level          : the AMR level to get the data for
+            direction      : the face of the data you want (each face holds the 3 components of M)
+            include_ghosts : whether to include ghost zones or not
+
+        Returns
+        -------
+
+            A 2d numpy array of the lo vector for each grid with the shape (dims, number of grids)
+
+        '''
+        return self._get_mesh_array_lovects(level, direction, include_ghosts, self.libwarpx_so.warpx_getMfieldFPLoVects)
+
+    def get_mesh_H_bias_field_fp_lovects(self, level, direction, include_ghosts=True):
+        '''
+
+        This returns a list of the lo vectors of the arrays containing the mesh bias field H_bias
+        data on each grid for this process.
+
+        Parameters
+        ----------
+
+            level          : the AMR level to get the data for
+            direction      : the component of the data you want
+            include_ghosts : whether to include ghost zones or not
+
+        Returns
+        -------
+
+            A 2d numpy array of the lo vector for each grid with the shape (dims, number of grids)
+
+        '''
+        return self._get_mesh_array_lovects(level, direction, include_ghosts, self.libwarpx_so.warpx_getH_biasfieldFPLoVects)
+
+    def get_mesh_mag_Ms_lovects(self, level, direction, include_ghosts=True):
+        '''
+
+        This returns a list of the lo vectors of the arrays containing the saturation magnetization Ms
+        data on each grid for this process.
+
+        Parameters
+        ----------
+
+            level          : the AMR level to get the data for
+            direction      : the face of the data you want
+            include_ghosts : whether to include ghost zones or not
+
+        Returns
+        -------
+
+            A 2d numpy array of the lo vector for each grid with the shape (dims, number of grids)
+
+        '''
+        return self._get_mesh_array_lovects(level, direction, include_ghosts, self.libwarpx_so.warpx_getMagMsLoVects)
+
+    def get_mesh_mag_alpha_lovects(self, level, direction, include_ghosts=True):
+        '''
+
+        This returns a list of the lo vectors of the arrays containing the Gilbert damping factor alpha
+        data on each grid for this process.
+
+        Parameters
+        ----------
+
+            level          : the AMR level to get the data for
+            direction      : the face of the data you want
+            include_ghosts : whether to include ghost zones or not
+
+        Returns
+        -------
+
+            A 2d numpy array of the lo vector for each grid with the shape (dims, number of grids)
+
+        '''
+        return self._get_mesh_array_lovects(level, direction, include_ghosts, self.libwarpx_so.warpx_getMagAlphaLoVects)
+
+    def get_mesh_mag_gamma_lovects(self, level, direction, include_ghosts=True):
+        '''
+
+        This returns a list of the lo vectors of the arrays containing the gyromagnetic ratio gamma
+        data on each grid for this process.
+
+        Parameters
+        ----------
+
+            level          : the AMR level to get the data for
+            direction      : the face of the data you want
+            include_ghosts : whether to include ghost zones or not
+
+        Returns
+        -------
+
+            A 2d numpy array of the lo vector for each grid with the shape (dims, number of grids)
+
+        '''
+        return self._get_mesh_array_lovects(level, direction, include_ghosts, self.libwarpx_so.warpx_getMagGammaLoVects)
+
+    def get_mesh_mag_exchange_lovects(self, level, direction, include_ghosts=True):
+        '''
+
+        This returns a list of the lo vectors of the arrays containing the exchange coupling constant
+        data on each grid for this process.
+
+        Parameters
+        ----------
+
+            level          : the AMR level to get the data for
+            direction      : the face of the data you want
+            include_ghosts : whether to include ghost zones or not
+
+        Returns
+        -------
+
+            A 2d numpy array of the lo vector for each grid with the shape (dims, number of grids)
+
+        '''
+        return self._get_mesh_array_lovects(level, direction, include_ghosts, self.libwarpx_so.warpx_getMagExchangeLoVects)
+
+    def get_mesh_mag_anisotropy_lovects(self, level, direction, include_ghosts=True):
+        '''
+
+        This returns a list of the lo vectors of the arrays containing the anisotropy constant
+        data on each grid for this process.
+
+        Parameters
+        ----------
+
+            level          : the AMR level to get the data for
+            direction      : the face of the data you want
+            include_ghosts : whether to include ghost zones or not
+
+        Returns
+        -------
+
+            A 2d numpy array of the lo vector for each grid with the shape (dims, number of grids)
+
+        '''
+        return self._get_mesh_array_lovects(level, direction, include_ghosts, self.libwarpx_so.warpx_getMagAnisotropyLoVects)
+
     def _get_nodal_flag(self, getdatafunc):
         data = getdatafunc()
         if not data:
@@ -2647,6 +3499,60 @@ class LibWarpX():
         '''
         return self._get_nodal_flag(self.libwarpx_so.warpx_get_face_areas_z_nodal_flag)
 
+    def get_Hx_nodal_flag(self):
+        '''
+        This returns a 1d array of the nodal flags for Hx along each direction. A 1 means node centered, and 0 cell centered.
+        '''
+        return self._get_nodal_flag(self.libwarpx_so.warpx_getHx_nodal_flag)
+
+    def get_Hy_nodal_flag(self):
+        '''
+        This returns a 1d array of the nodal flags for Hy along each direction. A 1 means node centered, and 0 cell centered.
+        '''
+        return self._get_nodal_flag(self.libwarpx_so.warpx_getHy_nodal_flag)
+
+    def get_Hz_nodal_flag(self):
+        '''
+        This returns a 1d array of the nodal flags for Hz along each direction. A 1 means node centered, and 0 cell centered.
+        '''
+        return self._get_nodal_flag(self.libwarpx_so.warpx_getHz_nodal_flag)
+
+    def get_Mx_nodal_flag(self):
+        '''
+        This returns a 1d array of the nodal flags for M on the x faces (which holds the 3 components of M) along each direction. A 1 means node centered, and 0 cell centered.
+        '''
+        return self._get_nodal_flag(self.libwarpx_so.warpx_getMx_nodal_flag)
+
+    def get_My_nodal_flag(self):
+        '''
+        This returns a 1d array of the nodal flags for M on the y faces (which holds the 3 components of M) along each direction. A 1 means node centered, and 0 cell centered.
+        '''
+        return self._get_nodal_flag(self.libwarpx_so.warpx_getMy_nodal_flag)
+
+    def get_Mz_nodal_flag(self):
+        '''
+        This returns a 1d array of the nodal flags for M on the z faces (which holds the 3 components of M) along each direction. A 1 means node centered, and 0 cell centered.
+        '''
+        return self._get_nodal_flag(self.libwarpx_so.warpx_getMz_nodal_flag)
+
+    def get_Sigma_nodal_flag(self):
+        '''
+        This returns a 1d array of the nodal flags for sigma along each direction. A 1 means node centered, and 0 cell centered.
+        '''
+        return self._get_nodal_flag(self.libwarpx_so.warpx_getSigma_nodal_flag)
+
+    def get_Epsilon_nodal_flag(self):
+        '''
+        This returns a 1d array of the nodal flags for epsilon along each direction. A 1 means node centered, and 0 cell centered.
+        '''
+        return self._get_nodal_flag(self.libwarpx_so.warpx_getEpsilon_nodal_flag)
+
+    def get_Mu_nodal_flag(self):
+        '''
+        This returns a 1d array of the nodal flags for mu along each direction. A 1 means node centered, and 0 cell centered.
+        '''
+        return self._get_nodal_flag(self.libwarpx_so.warpx_getMu_nodal_flag)
+
     def get_F_pml_nodal_flag(self):
         '''
         This returns a 1d array of the nodal flags for F in the PML along each direction. A 1 means node centered, and 0 cell centered.
@@ -39,6 +39,17 @@ Functions can be called at the following times:
  - appliedfields <installappliedfields>: allows directly specifying any fields to be applied to the particles
                                          during the advance
 
+By default, the functions are called at every step. The functions of a callback point can instead be called at
+intervals of steps, with the syntax of the diagnostics intervals, which are checked in C++ against the step of
+level 0 when the point is reached, so that the skipped steps do not go through Python:
+
+setcallbackintervals('afterstep', '100,1000:2000:10')
+
+In batch mode, the lists of field and particle arrays (e.g. of the fields wrappers) are fetched from WarpX once
+per call of the callback point and shared by all its functions, instead of at every access:
+
+setcallbackbatch('afterstep')
+
 To use a decorator, the syntax is as follows. This will install the function myplots to be called after each step.
 
 @callfromafterstep
@@ -85,13 +96,26 @@ class CallbackFunctions(object):
         self.timers = {}
         self.name = name
         self.lcallonce = lcallonce
+        self.batch = False
 
     def __call__(self,*args,**kw):
         """Call all of the functions in the list"""
-        tt = self.callfuncsinlist(*args,**kw)
+        if self.batch: libwarpx.begin_batch()
+        try:
+            tt = self.callfuncsinlist(*args,**kw)
+        finally:
+            if self.batch: libwarpx.end_batch()
         self.time = self.time + tt
         if self.lcallonce: self.funcs = []
 
+    def setintervals(self,intervals):
+        """Call the functions at the steps of intervals (a string with the syntax of the
+        diagnostics intervals, e.g. '100' or '0:1000:10,5000:'), or at every step if None"""
+        libwarpx.libwarpx_so.warpx_set_callback_py_intervals(
+            ctypes.c_char_p(self.name.encode('utf-8')),
+            ctypes.c_char_p(('' if intervals is None else str(intervals)).encode('utf-8'))
+        )
+
     def clearlist(self):
         """Unregister/clear out all registered C callbacks"""
         self.funcs = []
@@ -268,6 +292,23 @@ _particleinjection = CallbackFunctions('particleinjection')
 _appliedfields = CallbackFunctions('appliedfields')
 
 
+_callbacks = {c.name: c for c in [_afterinit, _beforecollisions, _aftercollisions, _beforeEsolve,
+                                  _poissonsolver, _afterEsolve, _beforedeposition, _afterdeposition,
+                                  _particlescraper, _particleloader, _beforestep, _afterstep,
+                                  _afterdiagnostics, _afterrestart, _particleinjection, _appliedfields]}
+
+def setcallbackintervals(name, intervals):
+    """Call the functions of the callback point name (e.g. 'afterstep') only at the steps of
+    intervals, with the syntax of the diagnostics intervals, e.g. '100' or '0:1000:10,5000:'.
+    The intervals are checked in C++ against the step of level 0. With None, the functions
+    are called at every step again."""
+    _callbacks[name].setintervals(intervals)
+
+def setcallbackbatch(name, batch=True):
+    """In batch mode, the lists of field and particle arrays are fetched from WarpX once per call
+    of the callback point name and shared by all its functions, see libwarpx.begin_batch"""
+    _callbacks[name].batch = batch
+
 #=============================================================================
 def printcallbacktimers(tmin=1.,lminmax=False,ff=None):
     """Prints timings of installed functions.
@@ -683,6 +683,90 @@ def GFPWrapper(level=0, include_ghosts=False):
                             get_nodal_flag=libwarpx.get_G_nodal_flag,
                             level=level, include_ghosts=include_ghosts)
 
+def HxFPWrapper(level=0, include_ghosts=False):
+    return _MultiFABWrapper(direction=0,
+                            get_lovects=libwarpx.get_mesh_H_field_fp_lovects,
+                            get_fabs=libwarpx.get_mesh_H_field_fp,
+                            get_nodal_flag=libwarpx.get_Hx_nodal_flag,
+                            level=level, include_ghosts=include_ghosts)
+
+def HyFPWrapper(level=0, include_ghosts=False):
+    return _MultiFABWrapper(direction=1,
+                            get_lovects=libwarpx.get_mesh_H_field_fp_lovects,
+                            get_fabs=libwarpx.get_mesh_H_field_fp,
+                            get_nodal_flag=libwarpx.get_Hy_nodal_flag,
+                            level=level, include_ghosts=include_ghosts)
+
+def HzFPWrapper(level=0, include_ghosts=False):
+    return _MultiFABWrapper(direction=2,
+                            get_lovects=libwarpx.get_mesh_H_field_fp_lovects,
+                            get_fabs=libwarpx.get_mesh_H_field_fp,
+                            get_nodal_flag=libwarpx.get_Hz_nodal_flag,
+                            level=level, include_ghosts=include_ghosts)
+
+def H_biasxFPWrapper(level=0, include_ghosts=False):
+    return _MultiFABWrapper(direction=0,
+                            get_lovects=libwarpx.get_mesh_H_bias_field_fp_lovects,
+                            get_fabs=libwarpx.get_mesh_H_bias_field_fp,
+                            get_nodal_flag=libwarpx.get_Hx_nodal_flag,
+                            level=level, include_ghosts=include_ghosts)
+
+def H_biasyFPWrapper(level=0, include_ghosts=False):
+    return _MultiFABWrapper(direction=1,
+                            get_lovects=libwarpx.get_mesh_H_bias_field_fp_lovects,
+                            get_fabs=libwarpx.get_mesh_H_bias_field_fp,
+                            get_nodal_flag=libwarpx.get_Hy_nodal_flag,
+                            level=level, include_ghosts=include_ghosts)
+
+def H_biaszFPWrapper(level=0, include_ghosts=False):
+    return _MultiFABWrapper(direction=2,
+                            get_lovects=libwarpx.get_mesh_H_bias_field_fp_lovects,
+                            get_fabs=libwarpx.get_mesh_H_bias_field_fp,
+                            get_nodal_flag=libwarpx.get_Hz_nodal_flag,
+                            level=level, include_ghosts=include_ghosts)
+
+def MxFPWrapper(level=0, include_ghosts=False):
+    return _MultiFABWrapper(direction=0,
+                            get_lovects=libwarpx.get_mesh_M_field_fp_lovects,
+                            get_fabs=libwarpx.get_mesh_M_field_fp,
+                            get_nodal_flag=libwarpx.get_Mx_nodal_flag,
+                            level=level, include_ghosts=include_ghosts)
+
+def MyFPWrapper(level=0, include_ghosts=False):
+    return _MultiFABWrapper(direction=1,
+                            get_lovects=libwarpx.get_mesh_M_field_fp_lovects,
+                            get_fabs=libwarpx.get_mesh_M_field_fp,
+                            get_nodal_flag=libwarpx.get_My_nodal_flag,
+                            level=level, include_ghosts=include_ghosts)
+
+def MzFPWrapper(level=0, include_ghosts=False):
+    return _MultiFABWrapper(direction=2,
+                            get_lovects=libwarpx.get_mesh_M_field_fp_lovects,
+                            get_fabs=libwarpx.get_mesh_M_field_fp,
+                            get_nodal_flag=libwarpx.get_Mz_nodal_flag,
+                            level=level, include_ghosts=include_ghosts)
+
+def SigmaWrapper(level=0, include_ghosts=False):
+    return _MultiFABWrapper(direction=None,
+                            get_lovects=libwarpx.get_mesh_sigma_lovects,
+                            get_fabs=libwarpx.get_mesh_sigma,
+                            get_nodal_flag=libwarpx.get_Sigma_nodal_flag,
+                            level=level, include_ghosts=include_ghosts)
+
+def EpsilonWrapper(level=0, include_ghosts=False):
+    return _MultiFABWrapper(direction=None,
+                            get_lovects=libwarpx.get_mesh_epsilon_lovects,
+                            get_fabs=libwarpx.get_mesh_epsilon,
+                            get_nodal_flag=libwarpx.get_Epsilon_nodal_flag,
+                            level=level, include_ghosts=include_ghosts)
+
+def MuWrapper(level=0, include_ghosts=False):
+    return _MultiFABWrapper(direction=None,
+                            get_lovects=libwarpx.get_mesh_mu_lovects,
+                            get_fabs=libwarpx.get_mesh_mu,
+                            get_nodal_flag=libwarpx.get_Mu_nodal_flag,
+                            level=level, include_ghosts=include_ghosts)
+
 def EdgeLengthsxWrapper(level=0, include_ghosts=False):
     return _MultiFABWrapper(direction=0,
                             get_lovects=libwarpx.get_mesh_edge_lengths_lovects,
@@ -17,6 +17,12 @@ from . import callbacks, libwarpx
 
 class TimeStepper(object):
 
+    def __init__(self, llg=False, mag_time_scheme_order=1):
+        # With llg, the fields are advanced with the macroscopic solver and the LLG
+        # update of H and M instead of the B update, as in WarpX::OneStep_nosub
+        self.llg = llg
+        self.mag_time_scheme_order = mag_time_scheme_order
+
     def step(self, nsteps=1):
         for i in range(nsteps):
             self.onestep()
@@ -38,10 +44,11 @@ class TimeStepper(object):
 
         # --- At the beginning, we have B^{n-1/2} and E^{n}.
         # --- Particles have p^{n-1/2} and x^{n}.
-        libwarpx.libwarpx_so.warpx_FillBoundaryE()
-        libwarpx.libwarpx_so.warpx_EvolveB(0.5*dt,1) # We now B^{n}
+        if not self.llg:
+            libwarpx.libwarpx_so.warpx_FillBoundaryE()
+            libwarpx.libwarpx_so.warpx_EvolveB(0.5*dt,1) # We now B^{n}
 
-        libwarpx.libwarpx_so.warpx_FillBoundaryB()
+            libwarpx.libwarpx_so.warpx_FillBoundaryB()
         libwarpx.libwarpx_so.warpx_UpdateAuxilaryData()
 
         # --- Evolve particles to p^{n+1/2} and x^{n+1}
@@ -54,15 +61,19 @@ class TimeStepper(object):
 
         libwarpx.libwarpx_so.mypc_Redistribute() # Redistribute particles
 
-        libwarpx.libwarpx_so.warpx_FillBoundaryE()
-        libwarpx.libwarpx_so.warpx_EvolveB(0.5*dt,2) # We now B^{n+1/2}
+        if self.llg:
+            libwarpx.libwarpx_so.warpx_SyncCurrent()
+            self.llg_field_step(dt)
+        else:
+            libwarpx.libwarpx_so.warpx_FillBoundaryE()
+            libwarpx.libwarpx_so.warpx_EvolveB(0.5*dt,2) # We now B^{n+1/2}
 
-        libwarpx.libwarpx_so.warpx_SyncCurrent()
+            libwarpx.libwarpx_so.warpx_SyncCurrent()
 
-        libwarpx.libwarpx_so.warpx_FillBoundaryB()
-        callbacks._beforeEsolve()
-        libwarpx.libwarpx_so.warpx_EvolveE(dt,0) # We now have E^{n+1}
-        callbacks._afterEsolve()
+            libwarpx.libwarpx_so.warpx_FillBoundaryB()
+            callbacks._beforeEsolve()
+            libwarpx.libwarpx_so.warpx_EvolveE(dt,0) # We now have E^{n+1}
+            callbacks._afterEsolve()
 
         self.istep += 1
 
@@ -79,3 +90,25 @@ class TimeStepper(object):
             libwarpx.libwarpx_so.warpx_setistep(i, self.istep)
 
         callbacks._afterstep()
+
+    def llg_field_step(self, dt):
+        # --- Advance E, H and M by dt, in the same order as WarpX::OneStep_nosub
+        # --- with the LLG solver (the PML and the TF/SF source are not handled here)
+        second_order = (self.mag_time_scheme_order == 2)
+        libwarpx.macroscopic_evolve_HM(0.5*dt, 'first_half', second_order) # We now have H^{n+1/2}, M^{n+1/2}
+        libwarpx.fill_boundary_H()
+        libwarpx.fill_boundary_M()
+        libwarpx.apply_external_field_excitation('H', 'first_half')
+        libwarpx.apply_external_field_excitation('H_bias', 'first_half')
+
+        callbacks._beforeEsolve()
+        libwarpx.macroscopic_evolve_E(dt) # We now have E^{n+1}
+        libwarpx.libwarpx_so.warpx_FillBoundaryE()
+        libwarpx.apply_external_field_excitation('E')
+        callbacks._afterEsolve()
+
+        libwarpx.macroscopic_evolve_HM(0.5*dt, 'second_half', second_order) # We now have H^{n+1}, M^{n+1}
+        libwarpx.fill_boundary_H()
+        libwarpx.fill_boundary_M()
+        libwarpx.apply_external_field_excitation('H', 'second_half')
+        libwarpx.apply_external_field_excitation('H_bias', 'second_half')
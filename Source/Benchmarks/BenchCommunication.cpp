@@ -0,0 +1,284 @@
+/* This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+
+/* Micro-benchmark of the guard-cell exchanges.
+ *
+ * The driver initializes a single-level simulation from a regular WarpX inputs file, whose
+ * domain decomposition (amr.max_grid_size, amr.blocking_factor, number of ranks) is the one
+ * benchmarked, then times the exchanges of level 0 in isolation: FillBoundaryE, FillBoundaryH
+ * and FillBoundaryM (all the guard cells of the fine patch), the exchanges of E and H between
+ * the domain and the PML, SyncCurrent and the nodal synchronization of E (as NodalSync).
+ * For each exchange, it reports the time per call, which is the latency of the exchange, the
+ * number of messages and bytes sent per call, from the communication metadata of AMReX, and
+ * the achieved bandwidth. The messages of SumBoundary (SyncCurrent) and OverrideSync (NodalSync)
+ * are counted as those of the guard-cell fill they reverse.
+ *
+ * typical use: warpx_bench_comm <inputs> amr.max_grid_size = 64 bench.repetitions = 50
+ */
+#include "WarpX.H"
+
+#include "BoundaryConditions/PML.H"
+#include "Initialization/WarpXAMReXInit.H"
+#include "Parallelization/WarpXCommUtil.H"
+#include "Utils/MPIInitHelpers.H"
+#include "Utils/TextMsg.H"
+#include "Utils/WarpXUtil.H"
+
+#include <AMReX.H>
+#include <AMReX_FabArrayBase.H>
+#include <AMReX_GpuDevice.H>
+#include <AMReX_IntVect.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Periodicity.H>
+#include <AMReX_Print.H>
+#include <AMReX_REAL.H>
+#include <AMReX_Utility.H>
+
+#if defined(AMREX_USE_MPI)
+#  include <mpi.h>
+#endif
+
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <iomanip>
+#include <string>
+
+namespace
+{
+    /** Maximum over the ranks of the mean wall time of one call of f, after a warm-up */
+    amrex::Real TimeExchange (std::function<void()> const& f, int warmup, int repetitions)
+    {
+        for (int n = 0; n < warmup; ++n) f();
+        amrex::Gpu::synchronize();
+        amrex::ParallelDescriptor::Barrier();
+        amrex::Real t = amrex::second();
+        for (int n = 0; n < repetitions; ++n) f();
+        amrex::Gpu::synchronize();
+        t = (amrex::second() - t) / repetitions;
+        amrex::ParallelDescriptor::ReduceRealMax(t);
+        return t;
+    }
+
+    /** Messages and bytes sent by this rank in one exchange */
+    struct CommVolume
+    {
+        amrex::Long messages = 0;
+        amrex::Long bytes = 0;
+
+        /** add the messages to the other ranks of the send tags of a communication pattern */
+        void Add (amrex::FabArrayBase::MapOfCopyComTagContainers const* snd_tags, int ncomp)
+        {
+            if (!snd_tags) return;
+            const amrex::Long bytes_per_value = WarpX::do_single_precision_comms
+                ? sizeof(float) : sizeof(amrex::Real);
+            for (auto const& kv : *snd_tags) {
+                ++messages;
+                for (auto const& tag : kv.second) {
+                    bytes += tag.dbox.numPts() * ncomp * bytes_per_value;
+                }
+            }
+        }
+
+        /** guard-cell fill of ng guard cells of mf (or its reverse, SumBoundary) */
+        void AddFillBoundary (amrex::MultiFab const& mf, amrex::IntVect const& ng,
+                              amrex::Periodicity const& period)
+        {
+            Add(mf.getFB(ng, period).m_SndTags.get(), mf.nComp());
+        }
+
+        /** synchronization of the nodal points shared by several boxes of mf (OverrideSync) */
+        void AddOverrideSync (amrex::MultiFab const& mf, amrex::Periodicity const& period)
+        {
+            if (mf.is_cell_centered()) return;
+            Add(mf.getFB(amrex::IntVect(0), period, false, false, true).m_SndTags.get(), mf.nComp());
+        }
+
+        /** ParallelCopy of ncomp components of src to dst and its dstng guard cells */
+        void AddParallelCopy (amrex::MultiFab const& dst, amrex::MultiFab const& src, int ncomp,
+                              amrex::IntVect const& dstng, amrex::Periodicity const& period)
+        {
+            Add(dst.getCPC(dstng, src, amrex::IntVect(0), period).m_SndTags.get(), ncomp);
+        }
+    };
+
+    /** Volume of PML::Exchange of the fields mf and of the PML fields mf_pml, followed by the
+     *  guard-cell fill of the PML, see PML::Exchange */
+    CommVolume PMLExchangeVolume (std::array<amrex::MultiFab*, 3> const& mf_pml,
+                                  std::array<amrex::MultiFab*, 3> const& mf,
+                                  amrex::Periodicity const& period, int do_pml_in_domain)
+    {
+        CommVolume v;
+        for (int i = 0; i < 3; ++i) {
+            amrex::MultiFab const& pml = *mf_pml[i];
+            amrex::MultiFab const& reg = *mf[i];
+            const int ncp = pml.nComp();
+            // sum of the split PML fields to the regular grid
+            v.AddParallelCopy(reg, pml, 1, do_pml_in_domain ? amrex::IntVect(0) : reg.nGrowVect(), period);
+            // regular grid to the PML
+            if (do_pml_in_domain) v.AddParallelCopy(reg, pml, ncp, amrex::IntVect(0), period);
+            v.AddParallelCopy(pml, reg, ncp, pml.nGrowVect(), period);
+            v.AddFillBoundary(pml, pml.nGrowVect(), period);
+        }
+        return v;
+    }
+
+    void PrintResult (std::string const& name, amrex::Real t, CommVolume const& local_volume)
+    {
+        amrex::Long messages = local_volume.messages;
+        amrex::Long max_messages = local_volume.messages;
+        amrex::Long bytes = local_volume.bytes;
+        amrex::ParallelDescriptor::ReduceLongSum(messages);
+        amrex::ParallelDescriptor::ReduceLongMax(max_messages);
+        amrex::ParallelDescriptor::ReduceLongSum(bytes);
+        amrex::Print() << std::left << std::setw(22) << name << std::right
+                       << std::scientific << std::setprecision(3)
+                       << std::setw(12) << t
+                       << std::setw(10) << messages
+                       << std::setw(10) << max_messages
+                       << std::fixed << std::setprecision(3)
+                       << std::setw(12) << bytes * 1.e-6
+                       << std::setw(10) << bytes / t * 1.e-9
+                       << std::setw(12) << ((messages > 0) ? 1.e6 * t / max_messages : 0.) << "\n";
+    }
+}
+
+int main (int argc, char* argv[])
+{
+    using namespace amrex;
+
+    utils::warpx_mpi_init(argc, argv);
+
+    warpx_amrex_init(argc, argv);
+
+    ParseGeometryInput();
+
+    ConvertLabParamsToBoost();
+    ReadBCParams();
+
+    {
+        int warmup = 2;
+        int repetitions = 20;
+        ParmParse pp_bench("bench");
+        queryWithParser(pp_bench, "warmup", warmup);
+        queryWithParser(pp_bench, "repetitions", repetitions);
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(repetitions > 0 && warmup >= 0,
+            "bench.repetitions must be positive and bench.warmup must not be negative");
+
+        WarpX warpx;
+        warpx.InitData();
+
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(warpx.finestLevel() == 0,
+            "the communication benchmark only supports a single level (amr.max_level = 0)");
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(WarpX::deep_halo_steps <= 1,
+            "the communication benchmark does not support warpx.deep_halo_steps > 1");
+
+        constexpr int lev = 0;
+        Periodicity const period = warpx.Geom(lev).periodicity();
+        BoxArray const& ba = warpx.boxArray(lev);
+
+        Long max_box_cells = 0;
+        for (int i = 0; i < ba.size(); ++i) max_box_cells = std::max(max_box_cells, ba[i].numPts());
+
+        Print() << "\nExchanges of level 0: " << ba.numPts() << " cells, " << ba.size()
+                << " boxes of at most " << max_box_cells << " cells, " << ParallelDescriptor::NProcs()
+                << " ranks, " << repetitions << " repetitions\n"
+                << "messages and bytes per call, from the communication metadata of AMReX\n"
+                << "(with PML boundaries, FillBoundaryE/H include the PML exchange, also timed alone)\n\n";
+        Print() << std::left << std::setw(22) << "exchange" << std::right
+                << std::setw(12) << "s/call" << std::setw(10) << "messages" << std::setw(10) << "max/rank"
+                << std::setw(12) << "MB" << std::setw(10) << "GB/s" << std::setw(12) << "us/message" << "\n";
+
+        std::array<MultiFab*, 3> const E = {warpx.get_pointer_Efield_fp(lev, 0),
+                                            warpx.get_pointer_Efield_fp(lev, 1),
+                                            warpx.get_pointer_Efield_fp(lev, 2)};
+        PML* const pml = (warpx.DoPML() && warpx.GetPML(lev) && warpx.GetPML(lev)->ok())
+                       ? warpx.GetPML(lev) : nullptr;
+
+        // all the guard cells of E are exchanged, the fields being marked as modified each time
+        {
+            IntVect const ng = E[0]->nGrowVect();
+            CommVolume v;
+            for (auto const* mf : E) v.AddFillBoundary(*mf, ng, period);
+            if (pml) {
+                CommVolume const v_pml = PMLExchangeVolume(pml->GetE_fp(), E, period, warpx.DoPMLInDomain());
+                v.messages += v_pml.messages;
+                v.bytes += v_pml.bytes;
+            }
+            PrintResult("FillBoundaryE", TimeExchange([&] () {
+                warpx.MarkAllFieldsModified();
+                warpx.FillBoundaryE(lev, ng); }, warmup, repetitions), v);
+        }
+
+#ifdef WARPX_MAG_LLG
+        if (WarpX::mag_LLG) {
+            std::array<MultiFab*, 3> const H = {warpx.get_pointer_Hfield_fp(lev, 0),
+                                                warpx.get_pointer_Hfield_fp(lev, 1),
+                                                warpx.get_pointer_Hfield_fp(lev, 2)};
+            IntVect const ng_H = H[0]->nGrowVect();
+            CommVolume v_H;
+            for (auto const* mf : H) v_H.AddFillBoundary(*mf, ng_H, period);
+            if (pml) {
+                CommVolume const v_pml = PMLExchangeVolume(pml->GetH_fp(), H, period, warpx.DoPMLInDomain());
+                v_H.messages += v_pml.messages;
+                v_H.bytes += v_pml.bytes;
+            }
+            PrintResult("FillBoundaryH", TimeExchange([&] () {
+                warpx.MarkAllFieldsModified();
+                warpx.FillBoundaryH(lev, ng_H); }, warmup, repetitions), v_H);
+
+            // with collocated M, the three MultiFabs alias the same data
+            const int nM = (warpx.mag_M_collocated == 1) ? 1 : 3;
+            IntVect const ng_M = warpx.get_pointer_Mfield_fp(lev, 0)->nGrowVect();
+            CommVolume v_M;
+            for (int i = 0; i < nM; ++i) v_M.AddFillBoundary(*warpx.get_pointer_Mfield_fp(lev, i), ng_M, period);
+            PrintResult("FillBoundaryM", TimeExchange([&] () {
+                warpx.MarkAllFieldsModified();
+                warpx.FillBoundaryM(lev, ng_M); }, warmup, repetitions), v_M);
+
+            if (pml) {
+                PrintResult("PML::ExchangeH", TimeExchange([&] () {
+                    pml->Exchange(pml->GetH_fp(), H, PatchType::fine, warpx.DoPMLInDomain());
+                    pml->FillBoundaryH(PatchType::fine); }, warmup, repetitions),
+                    PMLExchangeVolume(pml->GetH_fp(), H, period, warpx.DoPMLInDomain()));
+            }
+        }
+#endif
+
+        if (pml) {
+            PrintResult("PML::ExchangeE", TimeExchange([&] () {
+                pml->Exchange(pml->GetE_fp(), E, PatchType::fine, warpx.DoPMLInDomain());
+                pml->FillBoundaryE(PatchType::fine); }, warmup, repetitions),
+                PMLExchangeVolume(pml->GetE_fp(), E, period, warpx.DoPMLInDomain()));
+        }
+
+        // sum of the guard cells of J (with the filter and the centering, if used)
+        {
+            CommVolume v;
+            for (int i = 0; i < 3; ++i) {
+                MultiFab const& J = *warpx.get_pointer_current_fp(lev, i);
+                v.AddFillBoundary(J, J.nGrowVect(), period);
+            }
+            PrintResult("SyncCurrent", TimeExchange([&] () {
+                warpx.SyncCurrent(); }, warmup, repetitions), v);
+        }
+
+        // nodal synchronization of E, as in NodalSync
+        {
+            CommVolume v;
+            for (auto const* mf : E) v.AddOverrideSync(*mf, period);
+            PrintResult("NodalSync (E)", TimeExchange([&] () {
+                for (auto* mf : E) WarpXCommUtil::OverrideSync(*mf, period); }, warmup, repetitions), v);
+        }
+        Print() << "\n";
+    }
+
+    Finalize();
+#if defined(AMREX_USE_MPI)
+    MPI_Finalize();
+#endif
+}
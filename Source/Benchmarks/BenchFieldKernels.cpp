@@ -0,0 +1,244 @@
+/* This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+
+/* Micro-benchmark of the field kernels.
+ *
+ * The driver initializes a single-level simulation from a regular WarpX inputs file, then times
+ * the field updates of level 0 in isolation (without particles, diagnostics or guard-cell
+ * exchanges): EvolveE, EvolveB, MacroscopicEvolveE, MacroscopicEvolveHM, MacroscopicEvolveHM_2nd
+ * and the PML updates. It reports the cells updated per second and the achieved bandwidth, from
+ * a model of the bytes moved per cell (each field component read or written once per cell),
+ * compared to the bandwidth of a STREAM-like triad on MultiFabs with the same layout.
+ *
+ * typical use: warpx_bench_field_kernels <inputs> bench.repetitions = 20
+ */
+#include "WarpX.H"
+
+#include "BoundaryConditions/PML.H"
+#include "Evolve/WarpXDtType.H"
+#include "FieldSolver/FiniteDifferenceSolver/FiniteDifferenceSolver.H"
+#include "Initialization/WarpXAMReXInit.H"
+#include "Utils/MPIInitHelpers.H"
+#include "Utils/TextMsg.H"
+#include "Utils/WarpXAlgorithmSelection.H"
+#include "Utils/WarpXUtil.H"
+
+#include <AMReX.H>
+#include <AMReX_Array4.H>
+#include <AMReX_BoxArray.H>
+#include <AMReX_GpuLaunch.H>
+#include <AMReX_GpuQualifiers.H>
+#include <AMReX_MFIter.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Print.H>
+#include <AMReX_REAL.H>
+#include <AMReX_Utility.H>
+
+#if defined(AMREX_USE_MPI)
+#  include <mpi.h>
+#endif
+
+#include <algorithm>
+#include <functional>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    /** Maximum over the ranks of the mean wall time of one call of f, after a warm-up */
+    amrex::Real TimeKernel (std::function<void()> const& f, int warmup, int repetitions)
+    {
+        for (int n = 0; n < warmup; ++n) f();
+        amrex::Gpu::synchronize();
+        amrex::ParallelDescriptor::Barrier();
+        amrex::Real t = amrex::second();
+        for (int n = 0; n < repetitions; ++n) f();
+        amrex::Gpu::synchronize();
+        t = (amrex::second() - t) / repetitions;
+        amrex::ParallelDescriptor::ReduceRealMax(t);
+        return t;
+    }
+
+    /** Bandwidth (bytes/s) of the triad a = b + s*c on cell-centered MultiFabs of the grids of ba */
+    amrex::Real TriadBandwidth (amrex::BoxArray const& ba, amrex::DistributionMapping const& dm,
+                                int warmup, int repetitions)
+    {
+        using namespace amrex;
+        MultiFab a(ba, dm, 1, 0);
+        MultiFab b(ba, dm, 1, 0);
+        MultiFab c(ba, dm, 1, 0);
+        b.setVal(1._rt);
+        c.setVal(2._rt);
+        Real const s = 3._rt;
+
+        auto const triad = [&] () {
+            for (MFIter mfi(a, TilingIfNotGPU()); mfi.isValid(); ++mfi) {
+                Box const& bx = mfi.tilebox();
+                Array4<Real> const& a_arr = a.array(mfi);
+                Array4<Real const> const& b_arr = b.const_array(mfi);
+                Array4<Real const> const& c_arr = c.const_array(mfi);
+                amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) {
+                    a_arr(i,j,k) = b_arr(i,j,k) + s*c_arr(i,j,k);
+                });
+            }
+        };
+        Real const t = TimeKernel(triad, warmup, repetitions);
+        return 3._rt * sizeof(Real) * static_cast<Real>(ba.numPts()) / t;
+    }
+
+    void PrintResult (std::string const& name, amrex::Real t, amrex::Real ncells,
+                      amrex::Real bytes_per_cell, amrex::Real triad_bw,
+                      std::string const& note = "")
+    {
+        amrex::Real const bw = bytes_per_cell * ncells / t;
+        amrex::Print() << std::left << std::setw(26) << name << std::right
+                       << std::scientific << std::setprecision(3)
+                       << std::setw(12) << t
+                       << std::setw(12) << ncells / t
+                       << std::fixed << std::setprecision(1)
+                       << std::setw(10) << bw * 1.e-9
+                       << std::setw(10) << 100. * bw / triad_bw << " %"
+                       << "  " << note << "\n";
+    }
+}
+
+int main (int argc, char* argv[])
+{
+    using namespace amrex;
+
+    utils::warpx_mpi_init(argc, argv);
+
+    warpx_amrex_init(argc, argv);
+
+    ParseGeometryInput();
+
+    ConvertLabParamsToBoost();
+    ReadBCParams();
+
+    {
+        int warmup = 2;
+        int repetitions = 20;
+        ParmParse pp_bench("bench");
+        queryWithParser(pp_bench, "warmup", warmup);
+        queryWithParser(pp_bench, "repetitions", repetitions);
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(repetitions > 0 && warmup >= 0,
+            "bench.repetitions must be positive and bench.warmup must not be negative");
+
+        WarpX warpx;
+        warpx.InitData();
+
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(warpx.finestLevel() == 0,
+            "the field-kernel benchmark only supports a single level (amr.max_level = 0)");
+
+        constexpr int lev = 0;
+        Real const dt = warpx.getdt(lev);
+        Real const ncells = static_cast<Real>(warpx.Geom(lev).Domain().numPts());
+        constexpr Real r = sizeof(Real);
+
+        Real const triad_bw = TriadBandwidth(warpx.boxArray(lev), warpx.DistributionMap(lev),
+                                             warmup, repetitions);
+
+        Print() << "\nField kernels of level 0: " << static_cast<long>(ncells) << " cells, "
+                << warpx.boxArray(lev).size() << " boxes, " << ParallelDescriptor::NProcs()
+                << " ranks, " << repetitions << " repetitions\n"
+                << "STREAM triad bandwidth: " << std::fixed << std::setprecision(1)
+                << triad_bw * 1.e-9 << " GB/s\n"
+                << "bandwidth model: each field component read or written once per cell\n"
+                << "(the PML updates are included in EvolveE/EvolveB if PML boundaries are set)\n\n";
+        Print() << std::left << std::setw(26) << "kernel" << std::right
+                << std::setw(12) << "s/call" << std::setw(12) << "cells/s"
+                << std::setw(10) << "GB/s" << std::setw(12) << "of triad" << "\n";
+
+        // E: read and write 3 components, read 3 of B (or H) and 3 of J
+        PrintResult("EvolveE", TimeKernel([&] () {
+            warpx.EvolveE(lev, PatchType::fine, dt); }, warmup, repetitions),
+            ncells, 12._rt*r, triad_bw);
+        // B: read and write 3 components, read 3 of E
+        PrintResult("EvolveB", TimeKernel([&] () {
+            warpx.EvolveB(lev, PatchType::fine, dt, DtType::Full); }, warmup, repetitions),
+            ncells, 9._rt*r, triad_bw);
+
+        if (WarpX::em_solver_medium == MediumForEM::Macroscopic) {
+            // E: as EvolveE, plus sigma and epsilon
+            PrintResult("MacroscopicEvolveE", TimeKernel([&] () {
+                warpx.MacroscopicEvolveE(lev, PatchType::fine, dt); }, warmup, repetitions),
+                ncells, 14._rt*r, triad_bw);
+
+#if !(defined WARPX_DIM_RZ) && (defined WARPX_MAG_LLG)
+            if (WarpX::mag_LLG) {
+                // H: read and write 3 components; M: read and write 3 components on each of the
+                // 3 faces; read 3 of E, 3 of H_bias, Ms, alpha and gamma on the 3 faces, and mu
+                constexpr Real bytes_HM = 40._rt*r;
+                PrintResult("MacroscopicEvolveHM", TimeKernel([&] () {
+                    warpx.MacroscopicEvolveHM(lev, PatchType::fine, dt, dt, DtType::Full); },
+                    warmup, repetitions), ncells, bytes_HM, triad_bw);
+
+                // the second-order solver moves the same data once per iteration
+                FiniteDifferenceSolver const& fdtd_solver = warpx.GetFiniteDifferenceSolver(lev);
+                long const iter_start = fdtd_solver.GetLLGTotalIterations();
+                Real const t_2nd = TimeKernel([&] () {
+                    warpx.MacroscopicEvolveHM_2nd(lev, PatchType::fine, dt, dt, DtType::Full); },
+                    warmup, repetitions);
+                Real const iter_per_call = std::max(1._rt,
+                    static_cast<Real>(fdtd_solver.GetLLGTotalIterations() - iter_start)
+                    / (warmup + repetitions));
+                std::ostringstream note;
+                note << std::fixed << std::setprecision(2) << iter_per_call << " iterations/call";
+                PrintResult("MacroscopicEvolveHM_2nd", t_2nd, ncells, bytes_HM*iter_per_call,
+                            triad_bw, note.str());
+            }
+#endif
+        }
+
+#ifndef WARPX_DIM_RZ
+        if (warpx.DoPML() && warpx.GetPML(lev) && warpx.GetPML(lev)->ok()) {
+            PML* const pml = warpx.GetPML(lev);
+            FiniteDifferenceSolver& fdtd_solver = warpx.GetFiniteDifferenceSolver(lev);
+            // the split fields of the PML have 3 components per direction
+            Real const npml = static_cast<Real>(pml->GetE_fp()[0]->boxArray().numPts());
+
+            // E: read and write 9 components, read 9 of B (or H)
+            PrintResult("EvolveEPML", TimeKernel([&] () {
+                fdtd_solver.EvolveEPML(
+                    pml->GetE_fp(),
+#ifdef WARPX_MAG_LLG
+                    (WarpX::mag_LLG) ? pml->GetH_fp() :
+#endif
+                    pml->GetB_fp(),
+                    pml->Getj_fp(), pml->Get_edge_lengths(), pml->GetF_fp(),
+                    pml->GetMultiSigmaBox_fp(), dt, false); }, warmup, repetitions),
+                npml, 27._rt*r, triad_bw, "cells of the PML");
+#ifdef WARPX_MAG_LLG
+            if (WarpX::mag_LLG) {
+                PrintResult("EvolveHPML", TimeKernel([&] () {
+                    fdtd_solver.EvolveHPML(pml->GetH_fp(), pml->GetE_fp(), dt,
+                        WarpX::do_dive_cleaning, pml->GetMultiSigmaBox_fp()); }, warmup, repetitions),
+                    npml, 27._rt*r, triad_bw, "cells of the PML");
+            } else
+#endif
+            {
+                PrintResult("EvolveBPML", TimeKernel([&] () {
+                    fdtd_solver.EvolveBPML(pml->GetB_fp(), pml->GetE_fp(), dt,
+                        WarpX::do_dive_cleaning); }, warmup, repetitions),
+                    npml, 27._rt*r, triad_bw, "cells of the PML");
+            }
+            // read and write the 9 components of E and of B (or H)
+            PrintResult("DampPML", TimeKernel([&] () {
+                warpx.DampPML(lev, PatchType::fine); }, warmup, repetitions),
+                npml, 36._rt*r, triad_bw, "cells of the PML");
+        }
+#endif
+        Print() << "\n";
+    }
+
+    Finalize();
+#if defined(AMREX_USE_MPI)
+    MPI_Finalize();
+#endif
+}
@@ -0,0 +1,132 @@
+/* This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+
+/* Micro-benchmark of the warning logging.
+ *
+ * Times the recording of a warning in the WarnManager, as WarpX::RecordWarning does inside the
+ * time loop: on the main thread, from all the OpenMP threads without lock (the per-thread buffers
+ * of the WarnManager), and from all the threads in a critical section for comparison. Then times
+ * the printing of the warning list of the rank, and of all the ranks (a collective gather), which
+ * only takes place at the steps of warpx.print_warnings_intervals, the first and the last one.
+ *
+ * typical use: mpiexec -n 4 warpx_bench_warnings bench.records = 1000000 bench.repetitions = 10
+ */
+#include "Initialization/WarpXAMReXInit.H"
+#include "Utils/MPIInitHelpers.H"
+#include "Utils/MsgLogger/MsgLogger.H"
+#include "Utils/TextMsg.H"
+#include "Utils/WarnManager.H"
+#include "Utils/WarpXUtil.H"
+
+#include <AMReX.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Print.H>
+#include <AMReX_REAL.H>
+
+#if defined(AMREX_USE_MPI)
+#  include <mpi.h>
+#endif
+#ifdef AMREX_USE_OMP
+#  include <omp.h>
+#endif
+
+#include <functional>
+#include <iomanip>
+#include <string>
+
+namespace
+{
+    /** Maximum over the ranks of the mean wall time of one call of f */
+    amrex::Real TimeCall (std::function<void()> const& f, int repetitions)
+    {
+        amrex::ParallelDescriptor::Barrier();
+        amrex::Real t = amrex::second();
+        for (int n = 0; n < repetitions; ++n) f();
+        t = (amrex::second() - t) / repetitions;
+        amrex::ParallelDescriptor::ReduceRealMax(t);
+        return t;
+    }
+
+    void PrintResult (std::string const& name, amrex::Real t, amrex::Real ncalls,
+                      std::string const& note = "")
+    {
+        amrex::Print() << std::left << std::setw(30) << name << std::right
+                       << std::scientific << std::setprecision(3)
+                       << std::setw(12) << t / ncalls
+                       << std::setw(12) << ncalls / t
+                       << "  " << note << "\n";
+    }
+}
+
+int main (int argc, char* argv[])
+{
+    using namespace amrex;
+
+    utils::warpx_mpi_init(argc, argv);
+
+    warpx_amrex_init(argc, argv);
+
+    {
+        int records = 1000000;
+        int repetitions = 10;
+        ParmParse pp_bench("bench");
+        queryWithParser(pp_bench, "records", records);
+        queryWithParser(pp_bench, "repetitions", repetitions);
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(records > 0 && repetitions > 0,
+            "bench.records and bench.repetitions must be positive");
+
+        int nthreads = 1;
+#ifdef AMREX_USE_OMP
+        nthreads = omp_get_max_threads();
+#endif
+        Utils::WarnManager warn_manager;
+        auto const record = [&] () {
+            warn_manager.record_warning("bench", "a warning raised in the time loop",
+                                        Utils::MsgLogger::Priority::low);
+        };
+
+        Print() << "\n" << ParallelDescriptor::NProcs() << " ranks, " << nthreads << " threads\n"
+                << std::left << std::setw(30) << "operation" << std::right
+                << std::setw(12) << "s/call" << std::setw(12) << "calls/s" << "\n";
+
+        PrintResult("record (main thread)", TimeCall([&] () {
+            for (int n = 0; n < records; ++n) record();
+        }, repetitions), records);
+
+        PrintResult("record (threads, lock-free)", TimeCall([&] () {
+#ifdef AMREX_USE_OMP
+#pragma omp parallel for
+#endif
+            for (int n = 0; n < records; ++n) record();
+        }, repetitions), records, "per call, all threads");
+
+        PrintResult("record (threads, critical)", TimeCall([&] () {
+#ifdef AMREX_USE_OMP
+#pragma omp parallel for
+#endif
+            for (int n = 0; n < records; ++n) {
+#ifdef AMREX_USE_OMP
+#pragma omp critical (bench_warnings)
+#endif
+                record();
+            }
+        }, repetitions), records, "per call, all threads");
+
+        // the lists of the rank and of all the ranks, which also merge the thread buffers
+        PrintResult("print_local_warnings", TimeCall([&] () {
+            warn_manager.print_local_warnings("BENCH");
+        }, repetitions), 1);
+        PrintResult("print_global_warnings", TimeCall([&] () {
+            warn_manager.print_global_warnings("BENCH");
+        }, repetitions), 1, "collective");
+        Print() << "\n";
+    }
+
+    Finalize();
+#if defined(AMREX_USE_MPI)
+    MPI_Finalize();
+#endif
+}
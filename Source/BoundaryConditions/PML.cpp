@@ -14,6 +14,7 @@
 #   include "FieldSolver/SpectralSolver/SpectralFieldData.H"
 #endif
 #include "FieldSolver/FiniteDifferenceSolver/MacroscopicProperties/MacroscopicProperties.H"
+#include "Utils/MemoryFootprint.H"
 #include "Utils/TextMsg.H"
 #include "Utils/WarpXAlgorithmSelection.H"
 #include "Utils/WarpXConst.H"
@@ -38,7 +39,9 @@
 #include <AMReX_GpuLaunch.H>
 #include <AMReX_GpuQualifiers.H>
 #include <AMReX_IndexType.H>
+#include <AMReX_LayoutData.H>
 #include <AMReX_MFIter.H>
+#include <AMReX_ParallelDescriptor.H>
 #include <AMReX_ParmParse.H>
 #include <AMReX_RealVect.H>
 #include <AMReX_SPACE.H>
@@ -547,7 +550,7 @@ PML::PML (const int lev, const BoxArray& grid_ba, const DistributionMapping& gri
           const Geometry* geom, const Geometry* cgeom,
           int ncell, int delta, amrex::IntVect ref_ratio,
           Real dt, int nox_fft, int noy_fft, int noz_fft, bool do_nodal,
-          int do_moving_window, int /*pml_has_particles*/, int do_pml_in_domain,
+          int do_moving_window, int pml_has_particles, int do_pml_in_domain,
           const bool do_multi_J,
           const bool do_pml_dive_cleaning, const bool do_pml_divb_cleaning,
           int max_guard_EB, const amrex::Real v_sigma_sb,
@@ -580,6 +583,11 @@ PML::PML (const int lev, const BoxArray& grid_ba, const DistributionMapping& gri
         BoxArray(grid_ba.boxList().intersect(domain0)) : grid_ba;
 
     bool is_single_box_domain = domain0.numPts() == grid_ba_reduced.numPts();
+    if (WarpX::do_pml_slabs && !is_single_box_domain) {
+        WarpX::GetInstance().RecordWarning("PML",
+            "warpx.do_pml_slabs = 1 is only used when the union of the grids is a single box; "
+            "the PML boxes of level " + std::to_string(lev) + " follow the grids instead.");
+    }
     const BoxArray& ba = MakeBoxArray(is_single_box_domain, domain0, *geom, grid_ba_reduced,
                                       IntVect(ncell), do_pml_in_domain, do_pml_Lo, do_pml_Hi);
 
@@ -590,6 +598,24 @@ PML::PML (const int lev, const BoxArray& grid_ba, const DistributionMapping& gri
         m_ok = true;
     }
 
+    m_cpml = WarpX::do_cpml;
+    if (m_cpml) {
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(is_single_box_domain,
+            "warpx.do_cpml = 1 requires the union of the grids to be a single box");
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(cgeom == nullptr && !do_moving_window,
+            "warpx.do_cpml = 1 is not implemented with mesh refinement or the moving window");
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(
+            !do_nodal && (WarpX::maxwell_solver_id == MaxwellSolverAlgo::Yee
+                          || WarpX::maxwell_solver_id == MaxwellSolverAlgo::CKC),
+            "warpx.do_cpml = 1 requires the staggered Yee or CKC solver");
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(
+            WarpX::em_solver_medium == MediumForEM::Macroscopic,
+            "warpx.do_cpml = 1 requires warpx.em_solver_medium = macroscopic");
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(
+            !do_pml_dive_cleaning && !do_pml_divb_cleaning && !pml_has_particles,
+            "warpx.do_cpml = 1 is not implemented with divergence cleaning or particles in the PML");
+    }
+
     // Define the number of guard cells in each direction, for E, B, and F
     IntVect nge = IntVect(AMREX_D_DECL(2, 2, 2));
     IntVect ngb = IntVect(AMREX_D_DECL(2, 2, 2));
@@ -637,13 +663,18 @@ PML::PML (const int lev, const BoxArray& grid_ba, const DistributionMapping& gri
     }
 
     DistributionMapping dm;
+    auto ng_similar = amrex::elemwiseMax(amrex::elemwiseMax(nge, ngb), ngf);
     if (WarpX::do_similar_dm_pml) {
-        auto ng_sim = amrex::elemwiseMax(amrex::elemwiseMax(nge, ngb), ngf);
-        dm = amrex::MakeSimilarDM(ba, grid_ba, grid_dm, ng_sim);
+        dm = amrex::MakeSimilarDM(ba, grid_ba, grid_dm, ng_similar);
     } else {
         dm.define(ba);
     }
 
+    // the costs of a PML box are attributed to the box of the level it overlaps the most,
+    // which is also the box whose owner it is given by MakeSimilarDM
+    m_ng_similar = ng_similar;
+    MapToGridBoxes(ba, grid_ba);
+
 #ifdef AMREX_USE_EB
     pml_field_factory = amrex::makeEBFabFactory(*geom, ba, dm,
                                               {max_guard_EB, max_guard_EB, max_guard_EB},
@@ -653,9 +684,13 @@ PML::PML (const int lev, const BoxArray& grid_ba, const DistributionMapping& gri
     pml_field_factory = std::make_unique<FArrayBoxFactory>();
 #endif
 
-    // Allocate diagonal components (xx,yy,zz) only with divergence cleaning
-    const int ncompe = (m_dive_cleaning) ? 3 : 2;
-    const int ncompb = (m_divb_cleaning) ? 3 : 2;
+    // Allocate diagonal components (xx,yy,zz) only with divergence cleaning,
+    // and a single component for the unsplit fields of the CPML
+    const int ncompe = m_cpml ? 1 : ((m_dive_cleaning) ? 3 : 2);
+    const int ncompb = m_cpml ? 1 : ((m_divb_cleaning) ? 3 : 2);
+#ifdef WARPX_MAG_LLG
+    const int ncomph = m_cpml ? 1 : 2;
+#endif
 
     pml_E_fp[0] = std::make_unique<MultiFab>(amrex::convert( ba,
         WarpX::GetInstance().getEfield_fp(0,0).ixType().toIntVect() ), dm, ncompe, nge );
@@ -671,12 +706,14 @@ PML::PML (const int lev, const BoxArray& grid_ba, const DistributionMapping& gri
     pml_B_fp[2] = std::make_unique<MultiFab>(amrex::convert( ba,
         WarpX::GetInstance().getBfield_fp(0,2).ixType().toIntVect() ), dm, ncompb, ngb );
 #ifdef WARPX_MAG_LLG
-    pml_H_fp[0] = std::make_unique<MultiFab>(amrex::convert( ba,
-        WarpX::GetInstance().getHfield_fp(0,0).ixType().toIntVect() ), dm, 2, ngb );
-    pml_H_fp[1] = std::make_unique<MultiFab>(amrex::convert( ba,
-        WarpX::GetInstance().getHfield_fp(0,1).ixType().toIntVect() ), dm, 2, ngb );
-    pml_H_fp[2] = std::make_unique<MultiFab>(amrex::convert( ba,
-        WarpX::GetInstance().getHfield_fp(0,2).ixType().toIntVect() ), dm, 2, ngb );
+    if (WarpX::mag_LLG) {
+        pml_H_fp[0] = std::make_unique<MultiFab>(amrex::convert( ba,
+            WarpX::GetInstance().getHfield_fp(0,0).ixType().toIntVect() ), dm, ncomph, ngb );
+        pml_H_fp[1] = std::make_unique<MultiFab>(amrex::convert( ba,
+            WarpX::GetInstance().getHfield_fp(0,1).ixType().toIntVect() ), dm, ncomph, ngb );
+        pml_H_fp[2] = std::make_unique<MultiFab>(amrex::convert( ba,
+            WarpX::GetInstance().getHfield_fp(0,2).ixType().toIntVect() ), dm, ncomph, ngb );
+    }
 #endif
 
     if (WarpX::em_solver_medium == MediumForEM::Macroscopic) {
@@ -687,7 +724,7 @@ PML::PML (const int lev, const BoxArray& grid_ba, const DistributionMapping& gri
 
         // Initializing macroparameter multifab //
         auto& warpx = WarpX::GetInstance();
-        auto& macroscopic_properties = warpx.m_macroscopic_properties;
+        auto& macroscopic_properties = warpx.m_macroscopic_properties[0];
 
         // Initialize sigma, conductivity
         if (macroscopic_properties->m_sigma_s == "constant") {
@@ -695,6 +732,10 @@ PML::PML (const int lev, const BoxArray& grid_ba, const DistributionMapping& gri
         } else if (macroscopic_properties->m_sigma_s == "parse_sigma_function") {
             macroscopic_properties->InitializeMacroMultiFabUsingParser(pml_sigma_fp.get(),
                 macroscopic_properties->m_sigma_parser->compile<3>(), lev);
+        } else if (macroscopic_properties->m_sigma_s == "parse_sigma_function_t") {
+            // the properties of the PML are not updated in time
+            macroscopic_properties->InitializeMacroMultiFabUsingParser(pml_sigma_fp.get(),
+                macroscopic_properties->m_sigma_parser->compile<4>(), warpx.gett_new(lev), lev);
         }
 
         // Initialize epsilon, permittivity
@@ -703,6 +744,10 @@ PML::PML (const int lev, const BoxArray& grid_ba, const DistributionMapping& gri
         } else if (macroscopic_properties->m_epsilon_s == "parse_epsilon_function") {
             macroscopic_properties->InitializeMacroMultiFabUsingParser(pml_eps_fp.get(),
                 macroscopic_properties->m_epsilon_parser->compile<3>(), lev);
+        } else if (macroscopic_properties->m_epsilon_s == "parse_epsilon_function_t") {
+            // the properties of the PML are not updated in time
+            macroscopic_properties->InitializeMacroMultiFabUsingParser(pml_eps_fp.get(),
+                macroscopic_properties->m_epsilon_parser->compile<4>(), warpx.gett_new(lev), lev);
         }
 
         // Initialize mu, permeability
@@ -711,6 +756,10 @@ PML::PML (const int lev, const BoxArray& grid_ba, const DistributionMapping& gri
         } else if (macroscopic_properties->m_mu_s == "parse_mu_function") {
             macroscopic_properties->InitializeMacroMultiFabUsingParser(pml_mu_fp.get(),
                 macroscopic_properties->m_mu_parser->compile<3>(), lev);
+        } else if (macroscopic_properties->m_mu_s == "parse_mu_function_t") {
+            // the properties of the PML are not updated in time
+            macroscopic_properties->InitializeMacroMultiFabUsingParser(pml_mu_fp.get(),
+                macroscopic_properties->m_mu_parser->compile<4>(), warpx.gett_new(lev), lev);
         }
 
     }
@@ -722,11 +771,22 @@ PML::PML (const int lev, const BoxArray& grid_ba, const DistributionMapping& gri
     pml_B_fp[1]->setVal(0.0);
     pml_B_fp[2]->setVal(0.0);
 #ifdef WARPX_MAG_LLG
-    pml_H_fp[0]->setVal(0.0);
-    pml_H_fp[1]->setVal(0.0);
-    pml_H_fp[2]->setVal(0.0);
+    if (WarpX::mag_LLG) {
+        pml_H_fp[0]->setVal(0.0);
+        pml_H_fp[1]->setVal(0.0);
+        pml_H_fp[2]->setVal(0.0);
+    }
 #endif
 
+    if (m_cpml) {
+        DefineCPMLPsi(m_psi_E_fp, pml_E_fp, ba, dm, domain0);
+#ifdef WARPX_MAG_LLG
+        if (WarpX::mag_LLG) {
+            DefineCPMLPsi(m_psi_H_fp, pml_H_fp, ba, dm, domain0);
+        }
+#endif
+    }
+
     pml_j_fp[0] = std::make_unique<MultiFab>(amrex::convert( ba,
         WarpX::GetInstance().getcurrent_fp(0,0).ixType().toIntVect() ), dm, 1, ngb );
     pml_j_fp[1] = std::make_unique<MultiFab>(amrex::convert( ba,
@@ -794,6 +854,7 @@ PML::PML (const int lev, const BoxArray& grid_ba, const DistributionMapping& gri
         const amrex::IntVect fill_guards = amrex::IntVect(0);
         const bool in_pml = true;
         const bool periodic_single_box = false;
+        const bool global_fft = false;
         const bool update_with_rho = false;
         const bool fft_do_time_averaging = false;
         const RealVect dx{AMREX_D_DECL(geom->CellSize(0), geom->CellSize(1), geom->CellSize(2))};
@@ -804,8 +865,9 @@ PML::PML (const int lev, const BoxArray& grid_ba, const DistributionMapping& gri
         realspace_ba.enclosedCells().grow(nge); // cell-centered + guard cells
         spectral_solver_fp = std::make_unique<SpectralSolver>(lev, realspace_ba, dm,
             nox_fft, noy_fft, noz_fft, do_nodal, fill_guards, v_galilean_zero,
-            v_comoving_zero, dx, dt, in_pml, periodic_single_box, update_with_rho,
-            fft_do_time_averaging, do_multi_J, m_dive_cleaning, m_divb_cleaning);
+            v_comoving_zero, dx, dt, in_pml, periodic_single_box, global_fft, update_with_rho,
+            fft_do_time_averaging, do_multi_J, m_dive_cleaning, m_divb_cleaning,
+            WarpX::GetInstance().PSATDLightSpeed(), WarpX::GetInstance().PSATDPermittivity());
 #endif
     }
 
@@ -866,12 +928,14 @@ PML::PML (const int lev, const BoxArray& grid_ba, const DistributionMapping& gri
         pml_B_cp[2] = std::make_unique<MultiFab>(amrex::convert( cba,
             WarpX::GetInstance().getBfield_cp(1,2).ixType().toIntVect() ), cdm, ncompb, ngb );
 #ifdef WARPX_MAG_LLG
-        pml_H_cp[0] = std::make_unique<MultiFab>(amrex::convert( cba,
-            WarpX::GetInstance().getHfield_cp(1,0).ixType().toIntVect() ), cdm, 2, ngb );
-        pml_H_cp[1] = std::make_unique<MultiFab>(amrex::convert( cba,
-            WarpX::GetInstance().getHfield_cp(1,1).ixType().toIntVect() ), cdm, 2, ngb );
-        pml_H_cp[2] = std::make_unique<MultiFab>(amrex::convert( cba,
-            WarpX::GetInstance().getHfield_cp(1,2).ixType().toIntVect() ), cdm, 2, ngb );
+        if (WarpX::mag_LLG) {
+            pml_H_cp[0] = std::make_unique<MultiFab>(amrex::convert( cba,
+                WarpX::GetInstance().getHfield_cp(1,0).ixType().toIntVect() ), cdm, ncomph, ngb );
+            pml_H_cp[1] = std::make_unique<MultiFab>(amrex::convert( cba,
+                WarpX::GetInstance().getHfield_cp(1,1).ixType().toIntVect() ), cdm, ncomph, ngb );
+            pml_H_cp[2] = std::make_unique<MultiFab>(amrex::convert( cba,
+                WarpX::GetInstance().getHfield_cp(1,2).ixType().toIntVect() ), cdm, ncomph, ngb );
+        }
 #endif
 
 
@@ -883,7 +947,7 @@ PML::PML (const int lev, const BoxArray& grid_ba, const DistributionMapping& gri
 
             // Initializing macroparameter multifab //
             auto& warpx = WarpX::GetInstance();
-            auto& macroscopic_properties = warpx.m_macroscopic_properties;
+            auto& macroscopic_properties = warpx.m_macroscopic_properties[0];
 
             // Initialize sigma, conductivity
             if (macroscopic_properties->m_sigma_s == "constant") {
@@ -891,6 +955,10 @@ PML::PML (const int lev, const BoxArray& grid_ba, const DistributionMapping& gri
             } else if (macroscopic_properties->m_sigma_s == "parse_sigma_function") {
                 macroscopic_properties->InitializeMacroMultiFabUsingParser(pml_sigma_cp.get(),
                     macroscopic_properties->m_sigma_parser->compile<3>(), lev);
+            } else if (macroscopic_properties->m_sigma_s == "parse_sigma_function_t") {
+                // the properties of the PML are not updated in time
+                macroscopic_properties->InitializeMacroMultiFabUsingParser(pml_sigma_cp.get(),
+                    macroscopic_properties->m_sigma_parser->compile<4>(), warpx.gett_new(lev), lev);
             }
 
             // Initialize epsilon, permittivity
@@ -899,6 +967,10 @@ PML::PML (const int lev, const BoxArray& grid_ba, const DistributionMapping& gri
             } else if (macroscopic_properties->m_epsilon_s == "parse_epsilon_function") {
                 macroscopic_properties->InitializeMacroMultiFabUsingParser(pml_eps_cp.get(),
                     macroscopic_properties->m_epsilon_parser->compile<3>(), lev);
+            } else if (macroscopic_properties->m_epsilon_s == "parse_epsilon_function_t") {
+                // the properties of the PML are not updated in time
+                macroscopic_properties->InitializeMacroMultiFabUsingParser(pml_eps_cp.get(),
+                    macroscopic_properties->m_epsilon_parser->compile<4>(), warpx.gett_new(lev), lev);
             }
 
             // Initialize mu, permeability
@@ -907,6 +979,10 @@ PML::PML (const int lev, const BoxArray& grid_ba, const DistributionMapping& gri
             } else if (macroscopic_properties->m_sigma_s == "parse_mu_function") {
                 macroscopic_properties->InitializeMacroMultiFabUsingParser(pml_mu_cp.get(),
                     macroscopic_properties->m_mu_parser->compile<3>(), lev);
+            } else if (macroscopic_properties->m_mu_s == "parse_mu_function_t") {
+                // the properties of the PML are not updated in time
+                macroscopic_properties->InitializeMacroMultiFabUsingParser(pml_mu_cp.get(),
+                    macroscopic_properties->m_mu_parser->compile<4>(), warpx.gett_new(lev), lev);
             }
 
 
@@ -919,9 +995,11 @@ PML::PML (const int lev, const BoxArray& grid_ba, const DistributionMapping& gri
         pml_B_cp[1]->setVal(0.0);
         pml_B_cp[2]->setVal(0.0);
 #ifdef WARPX_MAG_LLG
-        pml_H_cp[0]->setVal(0.0);
-        pml_H_cp[1]->setVal(0.0);
-        pml_H_cp[2]->setVal(0.0);
+        if (WarpX::mag_LLG) {
+            pml_H_cp[0]->setVal(0.0);
+            pml_H_cp[1]->setVal(0.0);
+            pml_H_cp[2]->setVal(0.0);
+        }
 #endif
 
         if (m_dive_cleaning)
@@ -965,6 +1043,7 @@ PML::PML (const int lev, const BoxArray& grid_ba, const DistributionMapping& gri
             const amrex::IntVect fill_guards = amrex::IntVect(0);
             const bool in_pml = true;
             const bool periodic_single_box = false;
+            const bool global_fft = false;
             const bool update_with_rho = false;
             const bool fft_do_time_averaging = false;
             const RealVect cdx{AMREX_D_DECL(cgeom->CellSize(0), cgeom->CellSize(1), cgeom->CellSize(2))};
@@ -975,8 +1054,9 @@ PML::PML (const int lev, const BoxArray& grid_ba, const DistributionMapping& gri
             realspace_cba.enclosedCells().grow(nge); // cell-centered + guard cells
             spectral_solver_cp = std::make_unique<SpectralSolver>(lev, realspace_cba, cdm,
                 nox_fft, noy_fft, noz_fft, do_nodal, fill_guards, v_galilean_zero,
-                v_comoving_zero, cdx, dt, in_pml, periodic_single_box, update_with_rho,
-                fft_do_time_averaging, do_multi_J, m_dive_cleaning, m_divb_cleaning);
+                v_comoving_zero, cdx, dt, in_pml, periodic_single_box, global_fft, update_with_rho,
+                fft_do_time_averaging, do_multi_J, m_dive_cleaning, m_divb_cleaning,
+                WarpX::GetInstance().PSATDLightSpeed(), WarpX::GetInstance().PSATDPermittivity());
 #endif
         }
     }
@@ -988,7 +1068,10 @@ PML::MakeBoxArray (bool is_single_box_domain, const amrex::Box& regular_domain,
                    const amrex::IntVect& ncell, int do_pml_in_domain,
                    const amrex::IntVect& do_pml_Lo, const amrex::IntVect& do_pml_Hi)
 {
-    if (is_single_box_domain) {
+    if (is_single_box_domain && WarpX::do_pml_slabs) {
+        return MakeBoxArray_slabs(regular_domain, ncell, do_pml_Lo, do_pml_Hi,
+                                  WarpX::pml_slab_max_size);
+    } else if (is_single_box_domain) {
         return MakeBoxArray_single(regular_domain, grid_ba, ncell, do_pml_Lo, do_pml_Hi);
     } else { // the union of the regular grids is *not* a single rectangular domain
         return MakeBoxArray_multiple(geom, grid_ba, ncell, do_pml_in_domain, do_pml_Lo, do_pml_Hi);
@@ -1035,6 +1118,53 @@ PML::MakeBoxArray_single (const amrex::Box& regular_domain, const amrex::BoxArra
     return BoxArray(std::move(bl));
 }
 
+BoxArray
+PML::MakeBoxArray_slabs (const amrex::Box& regular_domain, const amrex::IntVect& ncell,
+                         const amrex::IntVect& do_pml_Lo, const amrex::IntVect& do_pml_Hi,
+                         int max_size)
+{
+    BoxList bl;
+    for (OrientationIter oit; oit.isValid(); ++oit) {
+        const Orientation ori = oit();
+        const int idim = ori.coordDir();
+        if (ori.isLow() ? !do_pml_Lo[idim] : !do_pml_Hi[idim]) continue;
+
+        // The slab covers the whole face, and the edges and corners shared with the
+        // slabs normal to the lower directions (same convention as MakeBoxArray_single)
+        Box slab = amrex::adjCell(regular_domain, ori, ncell[idim]);
+        for (int jdim = 0; jdim < idim; ++jdim) {
+            if (do_pml_Lo[jdim]) slab.growLo(jdim, ncell[jdim]);
+            if (do_pml_Hi[jdim]) slab.growHi(jdim, ncell[jdim]);
+        }
+
+        // Chop the slab along the tangential directions into nearly equal pieces,
+        // rounded up to a multiple of the default tile size (8) when larger than it
+        BoxList pieces(slab);
+        for (int jdim = 0; jdim < AMREX_SPACEDIM; ++jdim) {
+            if (jdim == idim) continue;
+            const int len = slab.length(jdim);
+            const int npieces = (len + max_size - 1) / max_size;
+            int piece_len = (len + npieces - 1) / npieces;
+            if (piece_len > 8) piece_len = std::min(((piece_len + 7) / 8) * 8, max_size);
+
+            BoxList chopped;
+            for (Box const& b : pieces) {
+                Box rest = b;
+                while (rest.length(jdim) > piece_len) {
+                    const Box hi = rest.chop(jdim, rest.smallEnd(jdim) + piece_len);
+                    chopped.push_back(rest);
+                    rest = hi;
+                }
+                chopped.push_back(rest);
+            }
+            pieces = std::move(chopped);
+        }
+        bl.join(pieces);
+    }
+
+    return BoxArray(std::move(bl));
+}
+
 BoxArray
 PML::MakeBoxArray_multiple (const amrex::Geometry& geom, const amrex::BoxArray& grid_ba,
                             const amrex::IntVect& ncell, int do_pml_in_domain,
@@ -1110,6 +1240,67 @@ PML::MakeBoxArray_multiple (const amrex::Geometry& geom, const amrex::BoxArray&
     return ba;
 }
 
+void
+PML::AddCosts (amrex::LayoutData<amrex::Real>& cost, amrex::Real wt) const
+{
+    if (!m_ok) return;
+
+    DistributionMapping const& grid_dm = cost.DistributionMap();
+    const int myproc = ParallelDescriptor::MyProc();
+
+    amrex::Long npts_total = 0;
+    for (int ibox : pml_E_fp[0]->IndexArray()) {
+        const int igrid = m_grid_box_fp[ibox];
+        if (igrid >= 0 && grid_dm[igrid] == myproc) npts_total += pml_E_fp[0]->boxArray()[ibox].numPts();
+    }
+    if (npts_total == 0) return;
+
+    for (int ibox : pml_E_fp[0]->IndexArray()) {
+        const int igrid = m_grid_box_fp[ibox];
+        if (igrid >= 0 && grid_dm[igrid] == myproc) {
+            cost[igrid] += wt * static_cast<amrex::Real>(pml_E_fp[0]->boxArray()[ibox].numPts())
+                / static_cast<amrex::Real>(npts_total);
+        }
+    }
+}
+
+void
+PML::MapToGridBoxes (const BoxArray& pml_ba, const BoxArray& grid_ba)
+{
+    m_grid_box_fp.assign(pml_ba.size(), -1);
+    for (int ibox = 0; ibox < static_cast<int>(pml_ba.size()); ++ibox) {
+        amrex::Long max_overlap = 0;
+        for (auto const& isect : grid_ba.intersections(amrex::grow(pml_ba[ibox], m_ng_similar))) {
+            const amrex::Long overlap = isect.second.numPts();
+            if (overlap > max_overlap) {
+                max_overlap = overlap;
+                m_grid_box_fp[ibox] = isect.first;
+            }
+        }
+    }
+}
+
+void
+PML::RemakeGridBoxMap (const BoxArray& grid_ba)
+{
+    if (!m_ok) return;
+    MapToGridBoxes(amrex::convert(pml_E_fp[0]->boxArray(), IntVect::TheCellVector()), grid_ba);
+}
+
+amrex::Vector<amrex::Real>
+PML::CellsPerGridBox (int nboxes) const
+{
+    amrex::Vector<amrex::Real> ncells(nboxes, 0._rt);
+    if (!m_ok) return ncells;
+
+    BoxArray const& ba = pml_E_fp[0]->boxArray();
+    for (int ibox = 0; ibox < static_cast<int>(ba.size()); ++ibox) {
+        const int igrid = m_grid_box_fp[ibox];
+        if (igrid >= 0 && igrid < nboxes) ncells[igrid] += static_cast<amrex::Real>(ba[ibox].numPts());
+    }
+    return ncells;
+}
+
 void
 PML::ComputePMLFactors (amrex::Real dt)
 {
@@ -1123,6 +1314,43 @@ PML::ComputePMLFactors (amrex::Real dt)
     }
 }
 
+void
+PML::ResetFields ()
+{
+    auto zero = [] (auto const& mfs) {
+        for (auto const& mf : mfs) { if (mf) mf->setVal(0.0); }
+    };
+    zero(pml_E_fp); zero(pml_B_fp); zero(pml_j_fp);
+    zero(pml_E_cp); zero(pml_B_cp); zero(pml_j_cp);
+    if (pml_F_fp) pml_F_fp->setVal(0.0);
+    if (pml_F_cp) pml_F_cp->setVal(0.0);
+    if (pml_G_fp) pml_G_fp->setVal(0.0);
+    if (pml_G_cp) pml_G_cp->setVal(0.0);
+    for (auto const& psi_d : m_psi_E_fp.psi) zero(psi_d);
+#ifdef WARPX_MAG_LLG
+    zero(pml_H_fp); zero(pml_H_cp);
+    for (auto const& psi_d : m_psi_H_fp.psi) zero(psi_d);
+#endif
+}
+
+double
+PML::MemoryBytes () const
+{
+    double bytes = LocalMemoryBytes(pml_E_fp) + LocalMemoryBytes(pml_B_fp) + LocalMemoryBytes(pml_j_fp)
+                 + LocalMemoryBytes(pml_edge_lengths)
+                 + LocalMemoryBytes(pml_E_cp) + LocalMemoryBytes(pml_B_cp) + LocalMemoryBytes(pml_j_cp)
+                 + LocalMemoryBytes(pml_F_fp.get()) + LocalMemoryBytes(pml_F_cp.get())
+                 + LocalMemoryBytes(pml_G_fp.get()) + LocalMemoryBytes(pml_G_cp.get())
+                 + LocalMemoryBytes(pml_eps_fp.get()) + LocalMemoryBytes(pml_mu_fp.get())
+                 + LocalMemoryBytes(pml_sigma_fp.get()) + LocalMemoryBytes(pml_eps_cp.get())
+                 + LocalMemoryBytes(pml_mu_cp.get()) + LocalMemoryBytes(pml_sigma_cp.get());
+#ifdef WARPX_MAG_LLG
+    bytes += LocalMemoryBytes(pml_H_fp) + LocalMemoryBytes(pml_H_cp);
+    for (auto const& psi_d : m_psi_H_fp.psi) bytes += LocalMemoryBytes(psi_d);
+#endif
+    return bytes;
+}
+
 std::array<MultiFab*,3>
 PML::GetE_fp ()
 {
@@ -1368,8 +1596,13 @@ PML::Exchange (MultiFab& pml, MultiFab& reg, const Geometry& geom,
     tmpregmf.setVal(0.0);
 
     // Create the sum of the split fields, in the PML
+    // (the fields of the CPML are not split and have a single component)
     MultiFab totpmlmf(pml.boxArray(), pml.DistributionMap(), 1, 0); // Allocate
-    MultiFab::LinComb(totpmlmf, 1.0, pml, 0, 1.0, pml, 1, 0, 1, 0); // Sum
+    if (ncp == 1) {
+        MultiFab::Copy(totpmlmf, pml, 0, 0, 1, 0);
+    } else {
+        MultiFab::LinComb(totpmlmf, 1.0, pml, 0, 1.0, pml, 1, 0, 1, 0); // Sum
+    }
     if (ncp == 3) {
         MultiFab::Add(totpmlmf,pml,2,0,1,0); // Sum the third split component
     }
@@ -1414,7 +1647,9 @@ PML::Exchange (MultiFab& pml, MultiFab& reg, const Geometry& geom,
     // More specifically, copy from regular data to PML's first component
     // Zero out the second (and third) component
     MultiFab::Copy(tmpregmf,reg,0,0,1,0); // Fill first component of tmpregmf
-    tmpregmf.setVal(0.0, 1, ncp-1, 0); // Zero out the second (and third) component
+    if (ncp > 1) {
+        tmpregmf.setVal(0.0, 1, ncp-1, 0); // Zero out the second (and third) component
+    }
     if (do_pml_in_domain){
         // Where valid cells of tmpregmf overlap with PML valid cells,
         // copy the PML (this is order to avoid overwriting PML valid cells,
@@ -1434,6 +1669,75 @@ PML::CopyToPML (MultiFab& pml, MultiFab& reg, const Geometry& geom)
   WarpXCommUtil::ParallelCopy(pml, reg, 0, 0, 1, IntVect(0), ngp, period);
 }
 
+void
+PML::DefineCPMLPsi (CPMLPsi& cpml_psi, const std::array<std::unique_ptr<MultiFab>,3>& field,
+                    const BoxArray& ba, const DistributionMapping& dm, const Box& regular_domain)
+{
+    // dimension of the index space of each direction x, y, z (-1 if not simulated)
+#if defined(WARPX_DIM_3D)
+    const int dims[3] = {0, 1, 2};
+#elif defined(WARPX_DIM_XZ) || defined(WARPX_DIM_RZ)
+    const int dims[3] = {0, -1, 1};
+#else
+    const int dims[3] = {-1, -1, 0};
+#endif
+
+    for (int d = 0; d < 3; ++d) {
+        cpml_psi.box_index[d].assign(ba.size(), -1);
+        const int idim = dims[d];
+        if (idim < 0) continue;
+
+        // sigma is only non-zero along d in the boxes that extend beyond the regular domain along d
+        BoxList bl;
+        Vector<int> pmap;
+        for (int i = 0; i < static_cast<int>(ba.size()); ++i) {
+            const Box& bx = ba[i];
+            if (bx.smallEnd(idim) < regular_domain.smallEnd(idim) ||
+                bx.bigEnd(idim) > regular_domain.bigEnd(idim)) {
+                cpml_psi.box_index[d][i] = static_cast<int>(pmap.size());
+                bl.push_back(bx);
+                pmap.push_back(dm[i]);
+            }
+        }
+        if (pmap.empty()) continue;
+
+        const BoxArray psi_ba(std::move(bl));
+        const DistributionMapping psi_dm(std::move(pmap));
+        for (int c = 0; c < 3; ++c) {
+            if (c == d) continue;
+            cpml_psi.psi[d][c] = std::make_unique<MultiFab>(
+                amrex::convert(psi_ba, field[c]->ixType().toIntVect()), psi_dm, 1, 0);
+            cpml_psi.psi[d][c]->setVal(0.0);
+        }
+    }
+}
+
+void
+PML::CheckPointCPMLPsi (const CPMLPsi& cpml_psi, const std::string& name)
+{
+    const char* dirs = "xyz";
+    for (int d = 0; d < 3; ++d) {
+        for (int c = 0; c < 3; ++c) {
+            if (cpml_psi.psi[d][c]) {
+                VisMF::AsyncWrite(*cpml_psi.psi[d][c], name + dirs[c] + dirs[d]);
+            }
+        }
+    }
+}
+
+void
+PML::RestartCPMLPsi (CPMLPsi& cpml_psi, const std::string& name)
+{
+    const char* dirs = "xyz";
+    for (int d = 0; d < 3; ++d) {
+        for (int c = 0; c < 3; ++c) {
+            if (cpml_psi.psi[d][c]) {
+                VisMF::Read(*cpml_psi.psi[d][c], name + dirs[c] + dirs[d]);
+            }
+        }
+    }
+}
+
 void
 PML::FillBoundary ()
 {
@@ -1573,10 +1877,20 @@ PML::CheckPoint (const std::string& dir) const
         VisMF::AsyncWrite(*pml_B_fp[1], dir+"_By_fp");
         VisMF::AsyncWrite(*pml_B_fp[2], dir+"_Bz_fp");
 #ifdef WARPX_MAG_LLG
-        VisMF::AsyncWrite(*pml_H_fp[0], dir+"_Hx_fp");
-        VisMF::AsyncWrite(*pml_H_fp[1], dir+"_Hy_fp");
-        VisMF::AsyncWrite(*pml_H_fp[2], dir+"_Hz_fp");
+        if (pml_H_fp[0]) {
+            VisMF::AsyncWrite(*pml_H_fp[0], dir+"_Hx_fp");
+            VisMF::AsyncWrite(*pml_H_fp[1], dir+"_Hy_fp");
+            VisMF::AsyncWrite(*pml_H_fp[2], dir+"_Hz_fp");
+        }
 #endif
+        if (m_cpml) {
+            CheckPointCPMLPsi(m_psi_E_fp, dir+"_psiE_fp_");
+#ifdef WARPX_MAG_LLG
+            if (pml_H_fp[0]) {
+                CheckPointCPMLPsi(m_psi_H_fp, dir+"_psiH_fp_");
+            }
+#endif
+        }
     }
 
     if (pml_E_cp[0])
@@ -1588,9 +1902,11 @@ PML::CheckPoint (const std::string& dir) const
         VisMF::AsyncWrite(*pml_B_cp[1], dir+"_By_cp");
         VisMF::AsyncWrite(*pml_B_cp[2], dir+"_Bz_cp");
 #ifdef WARPX_MAG_LLG
-        VisMF::AsyncWrite(*pml_H_cp[0], dir+"_Hx_cp");
-        VisMF::AsyncWrite(*pml_H_cp[1], dir+"_Hy_cp");
-        VisMF::AsyncWrite(*pml_H_cp[2], dir+"_Hz_cp");
+        if (pml_H_cp[0]) {
+            VisMF::AsyncWrite(*pml_H_cp[0], dir+"_Hx_cp");
+            VisMF::AsyncWrite(*pml_H_cp[1], dir+"_Hy_cp");
+            VisMF::AsyncWrite(*pml_H_cp[2], dir+"_Hz_cp");
+        }
 #endif
     }
 }
@@ -1607,10 +1923,20 @@ PML::Restart (const std::string& dir)
         VisMF::Read(*pml_B_fp[1], dir+"_By_fp");
         VisMF::Read(*pml_B_fp[2], dir+"_Bz_fp");
 #ifdef WARPX_MAG_LLG
-        VisMF::Read(*pml_H_fp[0], dir+"_Hx_fp");
-        VisMF::Read(*pml_H_fp[1], dir+"_Hy_fp");
-        VisMF::Read(*pml_H_fp[2], dir+"_Hz_fp");
+        if (pml_H_fp[0]) {
+            VisMF::Read(*pml_H_fp[0], dir+"_Hx_fp");
+            VisMF::Read(*pml_H_fp[1], dir+"_Hy_fp");
+            VisMF::Read(*pml_H_fp[2], dir+"_Hz_fp");
+        }
 #endif
+        if (m_cpml) {
+            RestartCPMLPsi(m_psi_E_fp, dir+"_psiE_fp_");
+#ifdef WARPX_MAG_LLG
+            if (pml_H_fp[0]) {
+                RestartCPMLPsi(m_psi_H_fp, dir+"_psiH_fp_");
+            }
+#endif
+        }
     }
 
     if (pml_E_cp[0])
@@ -1622,9 +1948,11 @@ PML::Restart (const std::string& dir)
         VisMF::Read(*pml_B_cp[1], dir+"_By_cp");
         VisMF::Read(*pml_B_cp[2], dir+"_Bz_cp");
 #ifdef WARPX_MAG_LLG
-        VisMF::Read(*pml_H_cp[0], dir+"_Hx_cp");
-        VisMF::Read(*pml_H_cp[1], dir+"_Hy_cp");
-        VisMF::Read(*pml_H_cp[2], dir+"_Hz_cp");
+        if (pml_H_cp[0]) {
+            VisMF::Read(*pml_H_cp[0], dir+"_Hx_cp");
+            VisMF::Read(*pml_H_cp[1], dir+"_Hy_cp");
+            VisMF::Read(*pml_H_cp[2], dir+"_Hz_cp");
+        }
 #endif
     }
 }
@@ -3,6 +3,7 @@
 #include "FieldSolver/FiniteDifferenceSolver/FiniteDifferenceSolver.H"
 #include "Evolve/WarpXDtType.H"
 #include "WarpX_PEC.H"
+#include "Utils/WarpXConst.H"
 
 #include <AMReX.H>
 #include <AMReX_Geometry.H>
@@ -40,6 +41,19 @@ void WarpX::ApplyEfieldBoundary(const int lev, PatchType patch_type)
             }
         }
     }
+#ifdef WARPX_MAG_LLG
+    if (PEC::isAnyBoundaryPMC()) {
+        if (patch_type == PatchType::fine) {
+            PEC::ApplyPMCtoEfield( { get_pointer_Efield_fp(lev, 0),
+                                     get_pointer_Efield_fp(lev, 1),
+                                     get_pointer_Efield_fp(lev, 2) }, lev, patch_type);
+        } else {
+            PEC::ApplyPMCtoEfield( { get_pointer_Efield_cp(lev, 0),
+                                     get_pointer_Efield_cp(lev, 1),
+                                     get_pointer_Efield_cp(lev, 2) }, lev, patch_type);
+        }
+    }
+#endif
 }
 
 void WarpX::ApplyBfieldBoundary (const int lev, PatchType patch_type, DtType a_dt_type)
@@ -76,3 +90,32 @@ void WarpX::ApplyBfieldBoundary (const int lev, PatchType patch_type, DtType a_d
         }
     }
 }
+
+#ifdef WARPX_MAG_LLG
+void WarpX::ApplyHfieldBoundary (const int lev, PatchType patch_type, DtType a_dt_type)
+{
+    if (PEC::isAnyBoundaryPMC() && patch_type == PatchType::fine) {
+        PEC::ApplyPMCtoHfield( { get_pointer_Hfield_fp(lev, 0),
+                                 get_pointer_Hfield_fp(lev, 1),
+                                 get_pointer_Hfield_fp(lev, 2) }, lev, patch_type);
+    }
+
+    // As for B, Silver-Mueller boundaries are only applied on the first half-push of H,
+    // on the fine patch of level 0. H is updated from E with B = mu0 H at the boundary.
+    if (lev == 0 && patch_type == PatchType::fine && a_dt_type == DtType::FirstHalf) {
+        bool applySilverMueller = false;
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+            if ( (WarpX::field_boundary_lo[idim] == FieldBoundaryType::Absorbing_SilverMueller) ||
+               (WarpX::field_boundary_hi[idim] == FieldBoundaryType::Absorbing_SilverMueller) ) {
+                applySilverMueller = true;
+            }
+        }
+        if(applySilverMueller) m_fdtd_solver_fp[0]->ApplySilverMuellerBoundary(
+                                     Efield_fp[lev], Hfield_fp[lev],
+                                     Geom(lev).Domain(), dt[lev],
+                                     WarpX::field_boundary_lo,
+                                     WarpX::field_boundary_hi,
+                                     1._rt/PhysConst::mu0);
+    }
+}
+#endif
@@ -12,6 +12,9 @@
 #include <AMReX_SPACE.H>
 #include <AMReX_Vector.H>
 
+#include <algorithm>
+#include <array>
+
 using namespace amrex::literals;
 
 bool
@@ -23,191 +26,196 @@ PEC::isAnyBoundaryPEC() {
     return false;
 }
 
-void
-PEC::ApplyPECtoEfield (std::array<amrex::MultiFab*, 3> Efield, const int lev,
-                       PatchType patch_type, const bool split_pml_field)
-{
-    auto& warpx = WarpX::GetInstance();
-    amrex::Box domain_box = warpx.Geom(lev).Domain();
-    if (patch_type == PatchType::coarse) {
-        amrex::IntVect ref_ratio = ( (lev > 0) ? WarpX::RefRatio(lev-1) : amrex::IntVect(1) );
-        domain_box.coarsen(ref_ratio);
+#ifdef WARPX_MAG_LLG
+bool
+PEC::isAnyBoundaryPMC() {
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        if ( WarpX::field_boundary_lo[idim] == FieldBoundaryType::PMC) return true;
+        if ( WarpX::field_boundary_hi[idim] == FieldBoundaryType::PMC) return true;
     }
-    amrex::IntVect domain_lo = domain_box.smallEnd();
-    amrex::IntVect domain_hi = domain_box.bigEnd();
-    amrex::GpuArray<int, 3> fbndry_lo;
-    amrex::GpuArray<int, 3> fbndry_hi;
-    for (int idim=0; idim < AMREX_SPACEDIM; ++idim) {
-        fbndry_lo[idim] = WarpX::field_boundary_lo[idim];
-        fbndry_hi[idim] = WarpX::field_boundary_hi[idim];
+    return false;
+}
+#endif
+
+namespace
+{
+    /**
+     * \brief Parts of the tilebox tb that lie on or outside the domain faces flagged as PEC in
+     *        fbndry_lo and fbndry_hi, i.e. the only cells that SetEfieldOnPEC and
+     *        SetBfieldOnPEC can modify. Slabs of adjacent faces overlap at the corners,
+     *        where the update is idempotent since the mirror cells are in the interior.
+     *
+     * \param[in]  tb          tilebox, with the index type of the field
+     * \param[in]  domain_box  cell-centered domain box
+     * \param[out] slabs       boundary slabs of tb, one per face at most
+     *
+     * \return number of slabs, 0 if tb does not reach any PEC face
+     */
+    int GetPECBoundarySlabs (amrex::Box const& tb, amrex::Box const& domain_box,
+                             amrex::GpuArray<int, 3> const& fbndry_lo,
+                             amrex::GpuArray<int, 3> const& fbndry_hi,
+                             std::array<amrex::Box, 2*AMREX_SPACEDIM>& slabs)
+    {
+        const amrex::Box dom = amrex::convert(domain_box, tb.ixType());
+        int nslabs = 0;
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+            if (fbndry_lo[idim] == FieldBoundaryType::PEC && tb.smallEnd(idim) <= dom.smallEnd(idim)) {
+                amrex::Box slab = tb;
+                slab.setBig(idim, std::min(tb.bigEnd(idim), dom.smallEnd(idim)));
+                slabs[nslabs++] = slab;
+            }
+            if (fbndry_hi[idim] == FieldBoundaryType::PEC && tb.bigEnd(idim) >= dom.bigEnd(idim)) {
+                amrex::Box slab = tb;
+                slab.setSmall(idim, std::max(tb.smallEnd(idim), dom.bigEnd(idim)));
+                slabs[nslabs++] = slab;
+            }
+        }
+        return nslabs;
     }
-    amrex::IntVect Ex_nodal = Efield[0]->ixType().toIntVect();
-    amrex::IntVect Ey_nodal = Efield[1]->ixType().toIntVect();
-    amrex::IntVect Ez_nodal = Efield[2]->ixType().toIntVect();
-    amrex::IntVect ng_fieldgather = warpx.get_ng_fieldgather();
-    // For each Efield multifab, apply PEC boundary condition to ncomponents
-    // If not split E-field, the PEC is applied to the regular Efield used in Maxwell's eq.
-    // If split_pml_field is true, then PEC is applied to all the split field components of the tangential field.
-    int nComp_x = Efield[0]->nComp();
-    int nComp_y = Efield[1]->nComp();
-    int nComp_z = Efield[2]->nComp();
+
+    /**
+     * \brief Applies the mirror conditions of SetEfieldOnPEC (tangential_odd = true) or
+     *        SetBfieldOnPEC (tangential_odd = false) to field, on the faces flagged as PEC in
+     *        fbndry_lo and fbndry_hi. Only the boundary slabs of the tiles are swept.
+     *
+     * \param[in,out] field           field components to update
+     * \param[in]     lev             level of the Multifab
+     * \param[in]     patch_type      coarse or fine
+     * \param[in]     ng              guard cells of the tileboxes that are updated
+     * \param[in]     tangential_odd  whether the tangential (true) or normal (false)
+     *                                components are zero on the boundary
+     * \param[in]     fbndry_lo       faces at the lower boundaries where the condition applies
+     * \param[in]     fbndry_hi       faces at the upper boundaries where the condition applies
+     */
+    void ApplyMirrorConditionOnBoundary (std::array<amrex::MultiFab*, 3> field, const int lev,
+                                         PatchType patch_type, amrex::IntVect const& ng,
+                                         const bool tangential_odd,
+                                         amrex::GpuArray<int, 3> const& fbndry_lo,
+                                         amrex::GpuArray<int, 3> const& fbndry_hi)
+    {
+        auto& warpx = WarpX::GetInstance();
+        amrex::Box domain_box = warpx.Geom(lev).Domain();
+        if (patch_type == PatchType::coarse) {
+            amrex::IntVect ref_ratio = ( (lev > 0) ? WarpX::RefRatio(lev-1) : amrex::IntVect(1) );
+            domain_box.coarsen(ref_ratio);
+        }
+        amrex::IntVect domain_lo = domain_box.smallEnd();
+        amrex::IntVect domain_hi = domain_box.bigEnd();
+
 #ifdef AMREX_USE_OMP
 #pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
 #endif
-    for (amrex::MFIter mfi(*Efield[0], amrex::TilingIfNotGPU()); mfi.isValid(); ++mfi) {
-        // Extract field data
-        amrex::Array4<amrex::Real> const& Ex = Efield[0]->array(mfi);
-        amrex::Array4<amrex::Real> const& Ey = Efield[1]->array(mfi);
-        amrex::Array4<amrex::Real> const& Ez = Efield[2]->array(mfi);
-
-        // Extract tileboxes for which to loop
-        // if split field, the box includes nodal flag
-        // For E-field used in Maxwell's update, nodal flag plus cells that particles
-        // gather fields from in the guard-cell region are included.
-        // Note that for simulations without particles or laser, ng_field_gather is 0
-        // and the guard-cell values of the E-field multifab will not be modified.
-        amrex::Box const& tex = (split_pml_field) ? mfi.tilebox(Efield[0]->ixType().toIntVect())
-                                                  : mfi.tilebox(Efield[0]->ixType().toIntVect(), ng_fieldgather);
-        amrex::Box const& tey = (split_pml_field) ? mfi.tilebox(Efield[1]->ixType().toIntVect())
-                                                  : mfi.tilebox(Efield[1]->ixType().toIntVect(), ng_fieldgather);
-        amrex::Box const& tez = (split_pml_field) ? mfi.tilebox(Efield[2]->ixType().toIntVect())
-                                                  : mfi.tilebox(Efield[2]->ixType().toIntVect(), ng_fieldgather);
-
-        // loop over cells and update fields
-        amrex::ParallelFor(
-            tex, nComp_x,
-            [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) {
-#if (defined WARPX_DIM_XZ) || (defined WARPX_DIM_RZ)
-                amrex::ignore_unused(k);
-#endif
-#if (defined WARPX_DIM_1D_Z)
-                amrex::ignore_unused(j,k);
-#endif
-                amrex::IntVect iv(AMREX_D_DECL(i,j,k));
-                const int icomp = 0;
-                PEC::SetEfieldOnPEC(icomp, domain_lo, domain_hi, iv, n,
-                                           Ex, Ex_nodal, fbndry_lo, fbndry_hi);
-            },
-            tey, nComp_y,
-            [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) {
-#if (defined WARPX_DIM_XZ) || (defined WARPX_DIM_RZ)
-                amrex::ignore_unused(k);
-#endif
-#if (defined WARPX_DIM_1D_Z)
-                amrex::ignore_unused(j,k);
-#endif
-                amrex::IntVect iv(AMREX_D_DECL(i,j,k));
-                const int icomp = 1;
-                PEC::SetEfieldOnPEC(icomp, domain_lo, domain_hi, iv, n,
-                                           Ey, Ey_nodal, fbndry_lo, fbndry_hi);
-            },
-            tez, nComp_z,
-            [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) {
+        for (amrex::MFIter mfi(*field[0], amrex::TilingIfNotGPU()); mfi.isValid(); ++mfi) {
+            for (int icomp = 0; icomp < 3; ++icomp) {
+                amrex::Array4<amrex::Real> const& F = field[icomp]->array(mfi);
+                const amrex::IntVect F_nodal = field[icomp]->ixType().toIntVect();
+                const int nComp = field[icomp]->nComp();
+
+                // Tiles that do not reach a flagged face are skipped, and only the
+                // cells on or outside the boundary are swept in the others
+                std::array<amrex::Box, 2*AMREX_SPACEDIM> slabs;
+                const int nslabs = GetPECBoundarySlabs(mfi.tilebox(F_nodal, ng), domain_box,
+                                                       fbndry_lo, fbndry_hi, slabs);
+                for (int islab = 0; islab < nslabs; ++islab) {
+                    amrex::ParallelFor(slabs[islab], nComp,
+                        [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) {
 #if (defined WARPX_DIM_XZ) || (defined WARPX_DIM_RZ)
-                amrex::ignore_unused(k);
+                            amrex::ignore_unused(k);
 #endif
 #if (defined WARPX_DIM_1D_Z)
-                amrex::ignore_unused(j,k);
+                            amrex::ignore_unused(j,k);
 #endif
-                amrex::IntVect iv(AMREX_D_DECL(i,j,k));
-                const int icomp = 2;
-                PEC::SetEfieldOnPEC(icomp, domain_lo, domain_hi, iv, n,
-                                           Ez, Ez_nodal, fbndry_lo, fbndry_hi);
+                            amrex::IntVect iv(AMREX_D_DECL(i,j,k));
+                            if (tangential_odd) {
+                                PEC::SetEfieldOnPEC(icomp, domain_lo, domain_hi, iv, n,
+                                                    F, F_nodal, fbndry_lo, fbndry_hi);
+                            } else {
+                                PEC::SetBfieldOnPEC(icomp, domain_lo, domain_hi, iv, n,
+                                                    F, F_nodal, fbndry_lo, fbndry_hi);
+                            }
+                        });
+                }
             }
-        );
+        }
+    }
 
+    /** Field boundary types, with the faces of type bc_type flagged as PEC and the others as None */
+    void GetFlaggedBoundaries (const int bc_type, amrex::GpuArray<int, 3>& fbndry_lo,
+                               amrex::GpuArray<int, 3>& fbndry_hi)
+    {
+        for (int idim = 0; idim < 3; ++idim) {
+            fbndry_lo[idim] = FieldBoundaryType::None;
+            fbndry_hi[idim] = FieldBoundaryType::None;
+        }
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+            if (WarpX::field_boundary_lo[idim] == bc_type) fbndry_lo[idim] = FieldBoundaryType::PEC;
+            if (WarpX::field_boundary_hi[idim] == bc_type) fbndry_hi[idim] = FieldBoundaryType::PEC;
+        }
     }
 }
 
+void
+PEC::ApplyPECtoEfield (std::array<amrex::MultiFab*, 3> Efield, const int lev,
+                       PatchType patch_type, const bool split_pml_field)
+{
+    amrex::GpuArray<int, 3> fbndry_lo;
+    amrex::GpuArray<int, 3> fbndry_hi;
+    GetFlaggedBoundaries(FieldBoundaryType::PEC, fbndry_lo, fbndry_hi);
+    // If not split E-field, the PEC is applied to the regular Efield used in Maxwell's eq.,
+    // including the cells that particles gather fields from in the guard-cell region.
+    // Note that for simulations without particles or laser, ng_field_gather is 0
+    // and the guard-cell values of the E-field multifab will not be modified.
+    // If split_pml_field is true, then PEC is applied to all the split field components
+    // of the tangential field, in the valid and nodal cells only.
+    const amrex::IntVect ng = (split_pml_field) ? amrex::IntVect(0)
+                                                : WarpX::GetInstance().get_ng_fieldgather();
+    const bool tangential_odd = true;
+    ApplyMirrorConditionOnBoundary(Efield, lev, patch_type, ng, tangential_odd,
+                                   fbndry_lo, fbndry_hi);
+}
+
 
 void
 PEC::ApplyPECtoBfield (std::array<amrex::MultiFab*, 3> Bfield, const int lev,
                        PatchType patch_type)
 {
-    auto& warpx = WarpX::GetInstance();
-    amrex::Box domain_box = warpx.Geom(lev).Domain();
-    if (patch_type == PatchType::coarse) {
-        amrex::IntVect ref_ratio = ( (lev > 0) ? WarpX::RefRatio(lev-1) : amrex::IntVect(1) );
-        domain_box.coarsen(ref_ratio);
-    }
-    amrex::IntVect domain_lo = domain_box.smallEnd();
-    amrex::IntVect domain_hi = domain_box.bigEnd();
     amrex::GpuArray<int, 3> fbndry_lo;
     amrex::GpuArray<int, 3> fbndry_hi;
-    for (int idim=0; idim < AMREX_SPACEDIM; ++idim) {
-        fbndry_lo[idim] = WarpX::field_boundary_lo[idim];
-        fbndry_hi[idim] = WarpX::field_boundary_hi[idim];
-    }
-    amrex::IntVect Bx_nodal = Bfield[0]->ixType().toIntVect();
-    amrex::IntVect By_nodal = Bfield[1]->ixType().toIntVect();
-    amrex::IntVect Bz_nodal = Bfield[2]->ixType().toIntVect();
-    amrex::IntVect ng_fieldgather = warpx.get_ng_fieldgather();
-    const int nComp_x = Bfield[0]->nComp();
-    const int nComp_y = Bfield[1]->nComp();
-    const int nComp_z = Bfield[2]->nComp();
-
-#ifdef AMREX_USE_OMP
-#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
-#endif
-    for (amrex::MFIter mfi(*Bfield[0], amrex::TilingIfNotGPU()); mfi.isValid(); ++mfi) {
-
-        // Extract field data
-        amrex::Array4<amrex::Real> const& Bx = Bfield[0]->array(mfi);
-        amrex::Array4<amrex::Real> const& By = Bfield[1]->array(mfi);
-        amrex::Array4<amrex::Real> const& Bz = Bfield[2]->array(mfi);
-
-        // Extract tileboxes for which to loop
-        // For B-field used in Maxwell's update, nodal flag plus cells that particles
-        // gather fields from in the guard-cell region are included.
-        // Note that for simulations without particles or laser, ng_field_gather is 0
-        // and the guard-cell values of the B-field multifab will not be modified.
-        amrex::Box const& tbx = mfi.tilebox(Bfield[0]->ixType().toIntVect(), ng_fieldgather);
-        amrex::Box const& tby = mfi.tilebox(Bfield[1]->ixType().toIntVect(), ng_fieldgather);
-        amrex::Box const& tbz = mfi.tilebox(Bfield[2]->ixType().toIntVect(), ng_fieldgather);
-
-        // loop over cells and update fields
-        amrex::ParallelFor(
-            tbx, nComp_x,
-            [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) {
-#if (defined WARPX_DIM_XZ) || (defined WARPX_DIM_RZ)
-                amrex::ignore_unused(k);
-#endif
-#if (defined WARPX_DIM_1D_Z)
-                amrex::ignore_unused(j,k);
-#endif
-                amrex::IntVect iv(AMREX_D_DECL(i,j,k));
-                const int icomp = 0;
-                PEC::SetBfieldOnPEC(icomp, domain_lo, domain_hi, iv, n,
-                                     Bx, Bx_nodal, fbndry_lo, fbndry_hi);
-            },
-            tby, nComp_y,
-            [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) {
-#if (defined WARPX_DIM_XZ) || (defined WARPX_DIM_RZ)
-                amrex::ignore_unused(k);
-#endif
-#if (defined WARPX_DIM_1D_Z)
-                amrex::ignore_unused(j,k);
-#endif
-                amrex::IntVect iv(AMREX_D_DECL(i,j,k));
-                const int icomp = 1;
-                PEC::SetBfieldOnPEC(icomp, domain_lo, domain_hi, iv, n,
-                                     By, By_nodal, fbndry_lo, fbndry_hi);
-            },
-            tbz, nComp_z,
-            [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) {
-#if (defined WARPX_DIM_XZ) || (defined WARPX_DIM_RZ)
-                amrex::ignore_unused(k);
-#endif
-#if (defined WARPX_DIM_1D_Z)
-                amrex::ignore_unused(j,k);
-#endif
-                amrex::IntVect iv(AMREX_D_DECL(i,j,k));
-                const int icomp = 2;
-                PEC::SetBfieldOnPEC(icomp, domain_lo, domain_hi, iv, n,
-                                     Bz, Bz_nodal, fbndry_lo, fbndry_hi);
-            }
-        );
+    GetFlaggedBoundaries(FieldBoundaryType::PEC, fbndry_lo, fbndry_hi);
+    // For B-field used in Maxwell's update, nodal flag plus cells that particles
+    // gather fields from in the guard-cell region are included.
+    const amrex::IntVect ng = WarpX::GetInstance().get_ng_fieldgather();
+    const bool tangential_odd = false;
+    ApplyMirrorConditionOnBoundary(Bfield, lev, patch_type, ng, tangential_odd,
+                                   fbndry_lo, fbndry_hi);
+}
 
-    }
+#ifdef WARPX_MAG_LLG
+void
+PEC::ApplyPMCtoHfield (std::array<amrex::MultiFab*, 3> Hfield, const int lev,
+                       PatchType patch_type)
+{
+    // PMC is the dual of PEC: H is mirrored as E at a PEC boundary
+    amrex::GpuArray<int, 3> fbndry_lo;
+    amrex::GpuArray<int, 3> fbndry_hi;
+    GetFlaggedBoundaries(FieldBoundaryType::PMC, fbndry_lo, fbndry_hi);
+    const amrex::IntVect ng = WarpX::GetInstance().get_ng_fieldgather();
+    const bool tangential_odd = true;
+    ApplyMirrorConditionOnBoundary(Hfield, lev, patch_type, ng, tangential_odd,
+                                   fbndry_lo, fbndry_hi);
+}
 
+void
+PEC::ApplyPMCtoEfield (std::array<amrex::MultiFab*, 3> Efield, const int lev,
+                       PatchType patch_type)
+{
+    // PMC is the dual of PEC: E is mirrored as B at a PEC boundary
+    amrex::GpuArray<int, 3> fbndry_lo;
+    amrex::GpuArray<int, 3> fbndry_hi;
+    GetFlaggedBoundaries(FieldBoundaryType::PMC, fbndry_lo, fbndry_hi);
+    const amrex::IntVect ng = WarpX::GetInstance().get_ng_fieldgather();
+    const bool tangential_odd = false;
+    ApplyMirrorConditionOnBoundary(Efield, lev, patch_type, ng, tangential_odd,
+                                   fbndry_lo, fbndry_hi);
 }
+#endif
@@ -169,6 +169,7 @@ BTDiagnostics::ReadParameters ()
     if (queryWithParser(pp_diag_name, "buffer_size", m_buffer_size)) {
         if(m_max_box_size < m_buffer_size) m_max_box_size = m_buffer_size;
     }
+    pp_diag_name.query("buffer_in_host_memory", m_buffer_in_host_memory);
 
 
     amrex::Vector< std::string > BTD_varnames_supported = {"Ex", "Ey", "Ez",
@@ -601,8 +602,10 @@ BTDiagnostics::DefineFieldBufferMultiFab (const int i_buffer, const int lev)
         // Number of guard cells for the output buffer is zero.
         // Unlike FullDiagnostics, "m_format == sensei" option is not included here.
         int ngrow = 0;
+        amrex::MFInfo info;
+        if (m_buffer_in_host_memory) info.SetArena(amrex::The_Pinned_Arena());
         m_mf_output[i_buffer][lev] = amrex::MultiFab ( buffer_ba, buffer_dmap,
-                                                  m_varnames.size(), ngrow ) ;
+                                                  m_varnames.size(), ngrow, info ) ;
         m_mf_output[i_buffer][lev].setVal(0.);
 
         amrex::IntVect ref_ratio = amrex::IntVect(1);
@@ -713,6 +716,35 @@ BTDiagnostics::GetZSliceInDomainFlag (const int i_buffer, const int lev)
 
 void
 BTDiagnostics::Flush (int i_buffer)
+{
+    FlushBuffers({i_buffer});
+}
+
+void
+BTDiagnostics::FlushBuffers (const amrex::Vector<int>& buffers)
+{
+    for (const int i_buffer : buffers) {
+        WriteBuffer(i_buffer);
+    }
+
+    if (m_format == "plotfile") {
+        // Make sure all MPI ranks wrote their files and closed them
+        // Note: additionally, since a Barrier does not guarantee a FS sync
+        //       on a parallel FS, we might need to add timeouts and retries
+        //       to the open calls below when running at scale.
+        amrex::ParallelDescriptor::Barrier();
+        for (const int i_buffer : buffers) {
+            MergeBuffersForPlotfile(i_buffer);
+        }
+    }
+
+    for (const int i_buffer : buffers) {
+        ResetFlushedBuffer(i_buffer);
+    }
+}
+
+void
+BTDiagnostics::WriteBuffer (int i_buffer)
 {
     auto & warpx = WarpX::GetInstance();
     std::string file_name = m_file_prefix;
@@ -734,11 +766,11 @@ BTDiagnostics::Flush (int i_buffer)
         m_plot_raw_fields, m_plot_raw_fields_guards,
         isBTD, i_buffer, m_geom_snapshot[i_buffer][0], isLastBTDFlush,
         m_totalParticles_flushed_already[i_buffer]);
+}
 
-    if (m_format == "plotfile") {
-        MergeBuffersForPlotfile(i_buffer);
-    }
-
+void
+BTDiagnostics::ResetFlushedBuffer (int i_buffer)
+{
     // Reset the buffer counter to zero after flushing out data stored in the buffer.
     ResetBufferCounter(i_buffer);
     IncrementBufferFlushCounter(i_buffer);
@@ -759,12 +791,6 @@ void BTDiagnostics::RedistributeParticleBuffer (const int i_buffer)
 
 void BTDiagnostics::MergeBuffersForPlotfile (int i_snapshot)
 {
-    // Make sure all MPI ranks wrote their files and closed it
-    // Note: additionally, since a Barrier does not guarantee a FS sync
-    //       on a parallel FS, we might need to add timeouts and retries
-    //       to the open calls below when running at scale.
-    amrex::ParallelDescriptor::Barrier();
-
     auto & warpx = WarpX::GetInstance();
     const amrex::Vector<int> iteration = warpx.getistep();
     // number of digits for plotfile containing multifab data (Cell_D_XXXXX)
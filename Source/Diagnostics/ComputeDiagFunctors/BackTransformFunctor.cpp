@@ -22,11 +22,11 @@
 #include <AMReX_GpuQualifiers.H>
 #include <AMReX_MFIter.H>
 #include <AMReX_MultiFab.H>
-#include <AMReX_MultiFabUtil.H>
 
 #include <cmath>
 #include <map>
 #include <memory>
+#include <utility>
 
 using namespace amrex;
 
@@ -44,50 +44,28 @@ BackTransformFunctor::operator ()(amrex::MultiFab& mf_dst, int /*dcomp*/, const
 {
     // Perform back-transformation only if z slice is within the domain stored as 0/1
     // in m_perform_backtransform[i_buffer]
-    if ( m_perform_backtransform[i_buffer] == 1) {
+    if ( m_perform_backtransform[i_buffer] == 1 && m_slices != nullptr) {
         auto& warpx = WarpX::GetInstance();
-        auto geom = warpx.Geom(m_lev);
-        amrex::Real gamma_boost = warpx.gamma_boost;
         int moving_window_dir = warpx.moving_window_dir;
-        amrex::Real beta_boost = std::sqrt( 1._rt - 1._rt/( gamma_boost * gamma_boost) );
-        const bool interpolate = true;
-        std::unique_ptr< amrex::MultiFab > slice = nullptr;
-        int scomp = 0;
-        // Generate slice of the cell-centered multifab containing boosted-frame field-data
-        // at current z-boost location for the ith buffer
-        slice = amrex::get_slice_data(moving_window_dir,
-                                     m_current_z_boost[i_buffer],
-                                     *m_mf_src,
-                                     geom,
-                                     scomp,
-                                     m_mf_src->nComp(),
-                                     interpolate);
-        // Perform in-place Lorentz-transform of all the fields stored in the slice.
-        LorentzTransformZ( *slice, gamma_boost, beta_boost);
-
-        // Create a 2D box for the slice in the boosted frame
-        amrex::Real dx = geom.CellSize(moving_window_dir);
-        // index corresponding to z_boost location in the boost-frame
-        int i_boost = static_cast<int> ( ( m_current_z_boost[i_buffer]
-                                            - geom.ProbLo(moving_window_dir) ) / dx );
-        // z-Slice at i_boost with x,y indices same as buffer_box
+        // The lab-frame slice of the ith buffer, transformed by BackTransformAllSlices,
+        // is stored at the index i_buffer along the moving window direction in m_slices,
+        // with x,y indices same as buffer_box
         amrex::Box slice_box = m_buffer_box[i_buffer];
-        slice_box.setSmall(moving_window_dir, i_boost);
-        slice_box.setBig(moving_window_dir, i_boost);
+        slice_box.setRange(moving_window_dir, i_buffer);
 
         // Make it a BoxArray
         amrex::BoxArray slice_ba(slice_box);
         slice_ba.maxSize( m_max_box_size );
         // Define MultiFab with the distribution map of the destination multifab and
-        // containing all ten components that were in the slice generated from m_mf_src.
+        // containing all ten components of the transformed slices.
         std::unique_ptr< amrex::MultiFab > tmp_slice_ptr = nullptr;
         tmp_slice_ptr = std::make_unique<MultiFab> ( slice_ba, mf_dst.DistributionMap(),
-                                                     slice->nComp(), 0 );
+                                                     m_slices->nComp(), 0 );
         tmp_slice_ptr->setVal(0.0);
-        // Parallel copy the lab-frame data from "slice" MultiFab with
+        // Parallel copy the lab-frame data from "m_slices" MultiFab with
         // ncomp=10 and boosted-frame dmap to "tmp_slice_ptr" MultiFab with
         // ncomp=10 and dmap of the destination Multifab, which will store the final data
-        WarpXCommUtil::ParallelCopy(*tmp_slice_ptr, *slice, 0, 0, slice->nComp(),
+        WarpXCommUtil::ParallelCopy(*tmp_slice_ptr, *m_slices, 0, 0, m_slices->nComp(),
                                     IntVect(AMREX_D_DECL(0, 0, 0)), IntVect(AMREX_D_DECL(0, 0, 0)));
         // Now we will cherry pick only the user-defined fields from
         // tmp_slice_ptr to dst_mf
@@ -121,8 +99,7 @@ BackTransformFunctor::operator ()(amrex::MultiFab& mf_dst, int /*dcomp*/, const
                 } );
         }
 
-        // Reset the temporary MultiFabs generated
-        slice = nullptr;
+        // Reset the temporary MultiFab generated
         tmp_slice_ptr = nullptr;
     }
 
@@ -140,6 +117,9 @@ BackTransformFunctor::PrepareFunctorData (int i_buffer,
     m_perform_backtransform[i_buffer] = 0;
     if (z_slice_in_domain == true and snapshot_full == 0) m_perform_backtransform[i_buffer] = 1;
     m_max_box_size = max_box_size;
+    // The buffers are prepared in order: once all of them are, their slices are
+    // back-transformed together
+    if (i_buffer == m_num_buffers - 1) BackTransformAllSlices();
 }
 
 void
@@ -173,54 +153,115 @@ BackTransformFunctor::InitData ()
 }
 
 void
-BackTransformFunctor::LorentzTransformZ (amrex::MultiFab& data, amrex::Real gamma_boost,
-                                         amrex::Real beta_boost) const
+BackTransformFunctor::BackTransformAllSlices ()
 {
+    m_slices = nullptr;
+
+    auto& warpx = WarpX::GetInstance();
+    const auto geom = warpx.Geom(m_lev);
+    const int moving_window_dir = warpx.moving_window_dir;
+    const amrex::Real gamma_boost = warpx.gamma_boost;
+    const amrex::Real beta_boost = std::sqrt( 1._rt - 1._rt/( gamma_boost * gamma_boost) );
+    const amrex::Real dz = geom.CellSize(moving_window_dir);
+    const amrex::Real zmin = geom.ProbLo(moving_window_dir);
+
+    // For each buffer to back-transform, the boxes of m_mf_src that contain its z-boost
+    // location are collapsed to the index i_buffer along the moving window direction,
+    // so that the slices of all the buffers are disjoint boxes of a single MultiFab,
+    // on the same processes as the source boxes.
+    const amrex::BoxArray& src_ba = m_mf_src->boxArray();
+    const amrex::DistributionMapping& src_dm = m_mf_src->DistributionMap();
+    const amrex::Box src_domain = src_ba.minimalBox();
+    const amrex::IntVect src_ngrow = m_mf_src->nGrowVect();
+    amrex::BoxList slices_bl;
+    amrex::Vector<int> slices_procs;
+    // For each slice box: index of the source box, and the two cells along the moving
+    // window direction (with the weight of the second) interpolated at the z-boost location
+    amrex::Vector<int> slices_src;
+    amrex::Vector<int> slices_klo;
+    amrex::Vector<int> slices_khi;
+    amrex::Vector<amrex::Real> slices_weight;
+    for (int i_buffer = 0; i_buffer < m_num_buffers; ++i_buffer) {
+        if (m_perform_backtransform[i_buffer] == 0) continue;
+        // index corresponding to z_boost location in the boost-frame
+        const int i_boost = static_cast<int> ( ( m_current_z_boost[i_buffer] - zmin ) / dz );
+        // position of the z_boost location relative to the cell centers
+        const amrex::Real z_cc = ( m_current_z_boost[i_buffer] - zmin ) / dz - 0.5_rt;
+        const int k_cc = static_cast<int>( std::floor(z_cc) );
+        for (int isrc = 0; isrc < src_ba.size(); ++isrc) {
+            amrex::Box bx = src_ba[isrc];
+            if (i_boost < bx.smallEnd(moving_window_dir) ||
+                i_boost > bx.bigEnd(moving_window_dir)) continue;
+            // cells available for the interpolation: valid and guard cells within the domain
+            const amrex::Box avail = amrex::grow(bx, src_ngrow) & src_domain;
+            bx.setRange(moving_window_dir, i_buffer);
+            slices_bl.push_back(bx);
+            slices_procs.push_back(src_dm[isrc]);
+            slices_src.push_back(isrc);
+            slices_klo.push_back(amrex::max(k_cc, avail.smallEnd(moving_window_dir)));
+            slices_khi.push_back(amrex::min(k_cc + 1, avail.bigEnd(moving_window_dir)));
+            slices_weight.push_back(z_cc - k_cc);
+        }
+    }
+    if (slices_bl.isEmpty()) return;
+
+    m_slices = std::make_unique<amrex::MultiFab>(amrex::BoxArray(std::move(slices_bl)),
+                                                 amrex::DistributionMapping(slices_procs),
+                                                 m_mf_src->nComp(), 0);
+
+    // Interpolate the source at the z-boost location of each buffer and Lorentz-transform
+    // the result, for all the buffers in one pass over the slices
+    const int ncomp = m_mf_src->nComp();
+    const amrex::Real clight = PhysConst::c;
+    const amrex::Real inv_clight = 1.0_rt/clight;
 #ifdef AMREX_USE_OMP
 #pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
 #endif
-    for (amrex::MFIter mfi(data, TilingIfNotGPU()); mfi.isValid(); ++mfi) {
+    for (amrex::MFIter mfi(*m_slices, TilingIfNotGPU()); mfi.isValid(); ++mfi) {
         const amrex::Box& tbx = mfi.tilebox();
-        amrex::Array4< amrex::Real > arr = data[mfi].array();
-        amrex::Real clight = PhysConst::c;
-        amrex::Real inv_clight = 1.0_rt/clight;
+        const int islice = mfi.index();
+        amrex::Array4< amrex::Real const > const src = m_mf_src->const_array(slices_src[islice]);
+        amrex::Array4< amrex::Real > const arr = m_slices->array(mfi);
+        const int klo = slices_klo[islice];
+        const int khi = slices_khi[islice];
+        const amrex::Real w = slices_weight[islice];
+        const int dir = moving_window_dir;
         // arr(x,y,z,comp) has ten-components namely,
         // Ex Ey Ez Bx By Bz jx jy jz rho in that order.
         amrex::ParallelFor( tbx,
             [=] AMREX_GPU_DEVICE (int i, int j, int k)
             {
+                const amrex::IntVect iv(AMREX_D_DECL(i, j, k));
+                amrex::IntVect iv_lo = iv;
+                amrex::IntVect iv_hi = iv;
+                iv_lo[dir] = klo;
+                iv_hi[dir] = khi;
+                for (int n = 0; n < ncomp; ++n) {
+                    arr(iv, n) = (1._rt - w) * src(iv_lo, n) + w * src(iv_hi, n);
+                }
+
                 // Back-transform the transverse electric and magnetic fields.
                 // Note that the z-components, Ez, Bz, are not changed by the transform.
                 amrex::Real e_lab, b_lab, j_lab, rho_lab;
                 // Transform Ex_boost (ncomp=0) & By_boost (ncomp=4) to lab-frame
-                e_lab = gamma_boost * ( arr(i, j, k, 0)
-                                        + beta_boost * clight * arr(i, j, k, 4) );
-                b_lab = gamma_boost * ( arr(i, j, k, 4)
-                                        + beta_boost * inv_clight * arr(i, j, k, 0) );
-                // Store lab-frame data in-place
-                arr(i, j, k, 0) = e_lab;
-                arr(i, j, k, 4) = b_lab;
+                e_lab = gamma_boost * ( arr(iv, 0) + beta_boost * clight * arr(iv, 4) );
+                b_lab = gamma_boost * ( arr(iv, 4) + beta_boost * inv_clight * arr(iv, 0) );
+                arr(iv, 0) = e_lab;
+                arr(iv, 4) = b_lab;
 
                 // Transform Ey_boost (ncomp=1) & Bx_boost (ncomp=3) to lab-frame
-                e_lab = gamma_boost * ( arr(i, j, k, 1)
-                                        - beta_boost * clight * arr(i, j, k, 3) );
-                b_lab = gamma_boost * ( arr(i, j, k, 3)
-                                        - beta_boost * inv_clight * arr(i, j, k, 1) );
-                // Store lab-frame data in-place
-                arr(i, j, k, 1) = e_lab;
-                arr(i, j, k, 3) = b_lab;
+                e_lab = gamma_boost * ( arr(iv, 1) - beta_boost * clight * arr(iv, 3) );
+                b_lab = gamma_boost * ( arr(iv, 3) - beta_boost * inv_clight * arr(iv, 1) );
+                arr(iv, 1) = e_lab;
+                arr(iv, 3) = b_lab;
 
                 // Transform charge density (ncomp=9)
                 // and z-component of current density (ncomp=8)
-                j_lab = gamma_boost * ( arr(i, j, k, 8)
-                                        + beta_boost * clight * arr(i, j, k, 9) );
-                rho_lab = gamma_boost * ( arr(i, j, k, 9)
-                                          + beta_boost * inv_clight * arr(i, j, k, 8) );
-                // Store lab-frame jz and rho in-place
-                arr(i, j, k, 8) = j_lab;
-                arr(i, j, k, 9) = rho_lab;
+                j_lab = gamma_boost * ( arr(iv, 8) + beta_boost * clight * arr(iv, 9) );
+                rho_lab = gamma_boost * ( arr(iv, 9) + beta_boost * inv_clight * arr(iv, 8) );
+                arr(iv, 8) = j_lab;
+                arr(iv, 9) = rho_lab;
             }
         );
     }
-
 }
@@ -29,7 +29,9 @@ CellCenterFunctor::operator()(amrex::MultiFab& mf_dst, int dcomp, const int /*i_
             nComp()==1,
             "The RZ averaging over modes must write into 1 single component");
         auto& warpx = WarpX::GetInstance();
-        amrex::MultiFab mf_dst_stag(m_mf_src->boxArray(), warpx.DistributionMap(m_lev), 1, m_mf_src->nGrowVect());
+        amrex::MultiFab& mf_dst_stag = warpx.GetScratchMultiFabs().Get(
+            "cell_center_modes", m_lev, m_mf_src->boxArray(), warpx.DistributionMap(m_lev), 1,
+            m_mf_src->nGrowVect());
         // Mode 0
         amrex::MultiFab::Copy(mf_dst_stag, *m_mf_src, 0, 0, 1, m_mf_src->nGrowVect());
         for (int ic=1 ; ic < m_mf_src->nComp() ; ic += 2) {
@@ -0,0 +1,281 @@
+/* This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+#include "DFTDiagnostics.H"
+
+#include "ComputeDiagFunctors/CellCenterFunctor.H"
+#include "Diagnostics/Diagnostics.H"
+#include "FlushFormats/FlushFormat.H"
+#include "Utils/TextMsg.H"
+#include "Utils/WarpXConst.H"
+#include "Utils/WarpXUtil.H"
+#include "WarpX.H"
+
+#include <AMReX.H>
+#include <AMReX_Array4.H>
+#include <AMReX_Box.H>
+#include <AMReX_BoxArray.H>
+#include <AMReX_CoordSys.H>
+#include <AMReX_DistributionMapping.H>
+#include <AMReX_Geometry.H>
+#include <AMReX_GpuLaunch.H>
+#include <AMReX_IntVect.H>
+#include <AMReX_MFIter.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Print.H>
+#include <AMReX_REAL.H>
+#include <AMReX_RealBox.H>
+#include <AMReX_Vector.H>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace amrex::literals;
+
+DFTDiagnostics::DFTDiagnostics (int i, std::string name)
+    : Diagnostics(i, name)
+{
+    ReadParameters();
+}
+
+void
+DFTDiagnostics::ReadParameters ()
+{
+    BaseReadParameters();
+    amrex::ParmParse pp_diag_name(m_diag_name);
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(
+        m_format == "plotfile" || m_format == "openpmd",
+        "<diag>.format must be plotfile or openpmd for DFT diagnostics");
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(m_pfield_varnames.empty(),
+        "<diag>.particle_fields_to_plot is not supported by DFT diagnostics");
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(m_dump_last_timestep,
+        "DFT diagnostics are only written at the last timestep: <diag>.dump_last_timestep must be 1");
+
+    // the default fields are E and H (B without LLG)
+    if (!pp_diag_name.contains("fields_to_plot")) {
+#ifdef WARPX_MAG_LLG
+        m_varnames_fields = {"Ex", "Ey", "Ez", "Hx", "Hy", "Hz"};
+#else
+        m_varnames_fields = {"Ex", "Ey", "Ez", "Bx", "By", "Bz"};
+#endif
+        m_varnames = m_varnames_fields;
+    }
+
+    // sample the fields at every step by default
+    std::vector<std::string> intervals_string_vec = {"1"};
+    pp_diag_name.queryarr("intervals", intervals_string_vec);
+    m_intervals = IntervalsParser(intervals_string_vec);
+
+    getArrWithParser(pp_diag_name, "frequencies", m_frequencies);
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(!m_frequencies.empty(),
+        m_diag_name + ".frequencies must contain at least one frequency");
+
+    // real and imaginary parts of each field at each frequency
+    for (int ifreq = 0; ifreq < static_cast<int>(m_frequencies.size()); ++ifreq) {
+        for (auto const& var : m_varnames) {
+            m_dft_varnames.push_back(var + "_f" + std::to_string(ifreq) + "_real");
+            m_dft_varnames.push_back(var + "_f" + std::to_string(ifreq) + "_imag");
+        }
+    }
+
+    // Number of buffers = 1 for DFTDiagnostics.
+    m_num_buffers = 1;
+}
+
+void
+DFTDiagnostics::DerivedInitData ()
+{
+    // the running transforms are accumulated on the coarsest level only
+    nlev_output = 1;
+    m_mf_dft.resize(nlev_output);
+    m_t_last_sample = WarpX::GetInstance().gett_new(0);
+    m_last_sampled_step = WarpX::GetInstance().getistep(0);
+
+    for (int ifreq = 0; ifreq < static_cast<int>(m_frequencies.size()); ++ifreq) {
+        amrex::Print() << Utils::TextMsg::Info(
+            m_diag_name + ": components _f" + std::to_string(ifreq) + " are the Fourier transforms at "
+            + std::to_string(m_frequencies[ifreq]) + " Hz");
+    }
+}
+
+void
+DFTDiagnostics::InitializeBufferData (int i_buffer, int lev)
+{
+    auto & warpx = WarpX::GetInstance();
+    amrex::Geometry const& geom = warpx.Geom(lev);
+
+    // Find if user-defined physical dimensions are different from the simulation domain.
+    bool use_warpxba = true;
+    amrex::RealBox diag_dom;
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        diag_dom.setLo(idim, std::max(m_lo[idim], geom.ProbLo(idim)));
+        diag_dom.setHi(idim, std::min(m_hi[idim], geom.ProbHi(idim)));
+        if (std::abs(geom.ProbLo(idim) - diag_dom.lo(idim)) > geom.CellSize(idim)) use_warpxba = false;
+        if (std::abs(geom.ProbHi(idim) - diag_dom.hi(idim)) > geom.CellSize(idim)) use_warpxba = false;
+    }
+
+    amrex::BoxArray ba = warpx.boxArray(lev);
+    amrex::DistributionMapping dmap = warpx.DistributionMap(lev);
+    if (use_warpxba == false) {
+        // index box of the cells covering the user-defined physical co-ordinates
+        amrex::IntVect lo(0);
+        amrex::IntVect hi(1);
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+            lo[idim] = std::max(static_cast<int>(std::floor(
+                (diag_dom.lo(idim) - geom.ProbLo(idim)) / geom.CellSize(idim))), 0);
+            hi[idim] = std::max(static_cast<int>(std::ceil(
+                (diag_dom.hi(idim) - geom.ProbLo(idim)) / geom.CellSize(idim))), 0) - 1;
+            if (hi[idim] < lo[idim]) hi[idim] = lo[idim];
+        }
+        ba = amrex::BoxArray(amrex::Box(lo, hi));
+        ba.maxSize(warpx.maxGridSize(lev));
+        // Coarsen and refine so that the new BoxArray is coarsenable.
+        ba.coarsen(m_crse_ratio).refine(m_crse_ratio);
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+            diag_dom.setLo(idim, geom.ProbLo(idim) + ba.minimalBox().smallEnd(idim) * geom.CellSize(idim));
+            diag_dom.setHi(idim, geom.ProbLo(idim) + (ba.minimalBox().bigEnd(idim) + 1) * geom.CellSize(idim));
+        }
+    }
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(
+        m_crse_ratio.min() > 0 && ba.coarsenable(m_crse_ratio),
+        "Invalid coarsening ratio for DFT diagnostics: it must be an integer divisor of the blocking factor.");
+    ba.coarsen(m_crse_ratio);
+    if (use_warpxba == false) dmap = amrex::DistributionMapping{ba};
+
+    // sampled fields, and their running transforms
+    m_mf_output[i_buffer][lev] = amrex::MultiFab(ba, dmap, static_cast<int>(m_varnames.size()), 0);
+    m_mf_dft[lev] = amrex::MultiFab(ba, dmap, static_cast<int>(m_dft_varnames.size()), 0);
+    m_mf_dft[lev].setVal(0._rt);
+
+    amrex::Vector<int> diag_periodicity(AMREX_SPACEDIM, 0);
+    m_geom_output[i_buffer][lev].define(ba.minimalBox(), &diag_dom, amrex::CoordSys::cartesian,
+                                        diag_periodicity.data());
+}
+
+void
+DFTDiagnostics::InitializeFieldFunctors (int lev)
+{
+    auto & warpx = WarpX::GetInstance();
+
+    // Clear any pre-existing vector to release stored data.
+    m_all_field_functors[lev].clear();
+
+    const auto nvar = static_cast<int>(m_varnames.size());
+    m_all_field_functors[lev].resize(nvar);
+    for (int comp = 0; comp < nvar; comp++) {
+        if        ( m_varnames[comp] == "Ex" ){
+            m_all_field_functors[lev][comp] = std::make_unique<CellCenterFunctor>(warpx.get_pointer_Efield_aux(lev, 0), lev, m_crse_ratio);
+        } else if ( m_varnames[comp] == "Ey" ){
+            m_all_field_functors[lev][comp] = std::make_unique<CellCenterFunctor>(warpx.get_pointer_Efield_aux(lev, 1), lev, m_crse_ratio);
+        } else if ( m_varnames[comp] == "Ez" ){
+            m_all_field_functors[lev][comp] = std::make_unique<CellCenterFunctor>(warpx.get_pointer_Efield_aux(lev, 2), lev, m_crse_ratio);
+        } else if ( m_varnames[comp] == "Bx" ){
+            m_all_field_functors[lev][comp] = std::make_unique<CellCenterFunctor>(warpx.get_pointer_Bfield_aux(lev, 0), lev, m_crse_ratio);
+        } else if ( m_varnames[comp] == "By" ){
+            m_all_field_functors[lev][comp] = std::make_unique<CellCenterFunctor>(warpx.get_pointer_Bfield_aux(lev, 1), lev, m_crse_ratio);
+        } else if ( m_varnames[comp] == "Bz" ){
+            m_all_field_functors[lev][comp] = std::make_unique<CellCenterFunctor>(warpx.get_pointer_Bfield_aux(lev, 2), lev, m_crse_ratio);
+#ifdef WARPX_MAG_LLG
+        } else if ( m_varnames[comp] == "Hx" ){
+            m_all_field_functors[lev][comp] = std::make_unique<CellCenterFunctor>(warpx.get_pointer_Hfield_aux(lev, 0), lev, m_crse_ratio);
+        } else if ( m_varnames[comp] == "Hy" ){
+            m_all_field_functors[lev][comp] = std::make_unique<CellCenterFunctor>(warpx.get_pointer_Hfield_aux(lev, 1), lev, m_crse_ratio);
+        } else if ( m_varnames[comp] == "Hz" ){
+            m_all_field_functors[lev][comp] = std::make_unique<CellCenterFunctor>(warpx.get_pointer_Hfield_aux(lev, 2), lev, m_crse_ratio);
+        } else if ( m_varnames[comp].size() == 8 && m_varnames[comp].rfind("M", 0) == 0
+                    && m_varnames[comp].compare(4, 4, "face") == 0 ){
+            // Mx_xface, ..., Mz_zface: component of M (0=Mx, 1=My, 2=Mz) stored on the given face
+            const std::string xyz = "xyz";
+            const auto mcomp = xyz.find(m_varnames[comp][1]);
+            const auto face = xyz.find(m_varnames[comp][3]);
+            WARPX_ALWAYS_ASSERT_WITH_MESSAGE(
+                m_varnames[comp][2] == '_' && mcomp != std::string::npos && face != std::string::npos,
+                m_varnames[comp] + " is not a known field output type for DFT diagnostics");
+            m_all_field_functors[lev][comp] = std::make_unique<CellCenterFunctor>(
+                warpx.get_pointer_Mfield_aux(lev, static_cast<int>(face)), lev, m_crse_ratio,
+                true, 1, static_cast<int>(mcomp));
+#endif
+        } else if ( m_varnames[comp] == "jx" ){
+            m_all_field_functors[lev][comp] = std::make_unique<CellCenterFunctor>(warpx.get_pointer_current_fp(lev, 0), lev, m_crse_ratio);
+        } else if ( m_varnames[comp] == "jy" ){
+            m_all_field_functors[lev][comp] = std::make_unique<CellCenterFunctor>(warpx.get_pointer_current_fp(lev, 1), lev, m_crse_ratio);
+        } else if ( m_varnames[comp] == "jz" ){
+            m_all_field_functors[lev][comp] = std::make_unique<CellCenterFunctor>(warpx.get_pointer_current_fp(lev, 2), lev, m_crse_ratio);
+        } else {
+            amrex::Abort(Utils::TextMsg::Err(m_varnames[comp] + " is not a known field output type for DFT diagnostics"));
+        }
+    }
+}
+
+bool
+DFTDiagnostics::DoComputeAndPack (int step, bool force_flush)
+{
+    return (force_flush || m_intervals.contains(step+1));
+}
+
+bool
+DFTDiagnostics::DoDump (int /*step*/, int /*i_buffer*/, bool force_flush)
+{
+    if (m_already_done) return false;
+    if (force_flush) {
+        m_already_done = true;
+        return true;
+    }
+    return false;
+}
+
+void
+DFTDiagnostics::UpdateBufferData ()
+{
+    auto & warpx = WarpX::GetInstance();
+    const int step = warpx.getistep(0);
+    // the last timestep is packed again when the spectra are flushed
+    if (step == m_last_sampled_step) return;
+
+    const amrex::Real t = warpx.gett_new(0);
+    const amrex::Real weight = t - m_t_last_sample;
+    m_last_sampled_step = step;
+    m_t_last_sample = t;
+
+    const int nvar = static_cast<int>(m_varnames.size());
+    for (int lev = 0; lev < nlev_output; ++lev) {
+        amrex::MultiFab const& mf_fields = m_mf_output[0][lev];
+        amrex::MultiFab& mf_dft = m_mf_dft[lev];
+        for (int ifreq = 0; ifreq < static_cast<int>(m_frequencies.size()); ++ifreq) {
+            const amrex::Real phase = 2._rt * MathConst::pi * m_frequencies[ifreq] * t;
+            const amrex::Real wcos = weight * std::cos(phase);
+            const amrex::Real wsin = weight * std::sin(phase);
+            const int dcomp = 2 * ifreq * nvar;
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#endif
+            for (amrex::MFIter mfi(mf_dft, amrex::TilingIfNotGPU()); mfi.isValid(); ++mfi) {
+                const amrex::Box& bx = mfi.tilebox();
+                amrex::Array4<amrex::Real const> const& f = mf_fields.const_array(mfi);
+                amrex::Array4<amrex::Real> const& dft = mf_dft.array(mfi);
+                // exp(-i omega t) = cos(omega t) - i sin(omega t)
+                amrex::ParallelFor(bx, nvar,
+                    [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) {
+                        dft(i, j, k, dcomp + 2*n) += wcos * f(i, j, k, n);
+                        dft(i, j, k, dcomp + 2*n + 1) -= wsin * f(i, j, k, n);
+                    });
+            }
+        }
+    }
+}
+
+void
+DFTDiagnostics::Flush (int i_buffer)
+{
+    auto & warpx = WarpX::GetInstance();
+
+    m_flush_format->WriteToFile(
+        m_dft_varnames, m_mf_dft, m_geom_output[i_buffer], warpx.getistep(),
+        warpx.gett_new(0), m_output_species[i_buffer], nlev_output, m_file_prefix,
+        m_file_min_digits, false, false);
+}
@@ -47,8 +47,15 @@ Diagnostics::BaseReadParameters ()
     auto & warpx = WarpX::GetInstance();
 
     amrex::ParmParse pp_diag_name(m_diag_name);
+    // Parameters specific to the output window, if any
+    const bool is_window = !m_window_name.empty();
+    amrex::ParmParse pp_window(m_diag_name + "." + m_window_name);
     m_file_prefix = "diags/" + m_diag_name;
     pp_diag_name.query("file_prefix", m_file_prefix);
+    if (is_window) {
+        m_file_prefix += "_" + m_window_name;
+        pp_window.query("file_prefix", m_file_prefix);
+    }
     queryWithParser(pp_diag_name, "file_min_digits", m_file_min_digits);
     pp_diag_name.query("format", m_format);
     pp_diag_name.query("dump_last_timestep", m_dump_last_timestep);
@@ -64,6 +71,7 @@ Diagnostics::BaseReadParameters ()
 
     // Query list of grid fields to write to output
     bool varnames_specified = pp_diag_name.queryarr("fields_to_plot", m_varnames_fields);
+    if (is_window && pp_window.queryarr("fields_to_plot", m_varnames_fields)) varnames_specified = true;
     if (!varnames_specified){
         if( dims == "RZ" and m_format == "openpmd" ) {
             m_varnames_fields = {"Er", "Et", "Ez", "Br", "Bt", "Bz", "jr", "jt", "jz"};
@@ -119,6 +127,15 @@ Diagnostics::BaseReadParameters ()
     }
 
 #ifdef WARPX_MAG_LLG
+    // H, M and the magnetic properties are only defined with the LLG solver
+    for (const auto& var : m_varnames) {
+        const bool is_llg_field = var == "Hx" || var == "Hy" || var == "Hz"
+            || (var.rfind("M", 0) == 0 && var.find("face") != std::string::npos)
+            || var.rfind("mag_", 0) == 0;
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
+            !is_llg_field || WarpX::mag_LLG,
+            var + " in plotfiles only works with the LLG solver (warpx.mag_LLG = 1)");
+    }
     // mag_Ms can be written to file only if WarpX::em_solver_medium == MediumForEM::Macroscopic
     if (WarpXUtilStr::is_in(m_varnames, "mag_Ms_xface") || WarpXUtilStr::is_in(m_varnames, "mag_Ms_yface") || WarpXUtilStr::is_in(m_varnames, "mag_Ms_zface"))
     {
@@ -249,6 +266,7 @@ Diagnostics::BaseReadParameters ()
     m_hi.resize(AMREX_SPACEDIM);
 
     bool lo_specified = queryArrWithParser(pp_diag_name, "diag_lo", m_lo, 0, AMREX_SPACEDIM);
+    if (is_window && queryArrWithParser(pp_window, "diag_lo", m_lo, 0, AMREX_SPACEDIM)) lo_specified = true;
 
     if (!lo_specified) {
        for (int idim=0; idim < AMREX_SPACEDIM; ++idim) {
@@ -256,6 +274,7 @@ Diagnostics::BaseReadParameters ()
        }
     }
     bool hi_specified = queryArrWithParser(pp_diag_name, "diag_hi", m_hi, 0, AMREX_SPACEDIM);
+    if (is_window && queryArrWithParser(pp_window, "diag_hi", m_hi, 0, AMREX_SPACEDIM)) hi_specified = true;
     if (!hi_specified) {
        for (int idim =0; idim < AMREX_SPACEDIM; ++idim) {
             m_hi[idim] = warpx.Geom(0).ProbHi(idim);
@@ -284,6 +303,7 @@ Diagnostics::BaseReadParameters ()
     amrex::Vector<int> cr_ratio(AMREX_SPACEDIM, 1);
     // Read user-defined coarsening ratio for the output MultiFab.
     bool cr_specified = queryArrWithParser(pp_diag_name, "coarsening_ratio", cr_ratio, 0, AMREX_SPACEDIM);
+    if (is_window && queryArrWithParser(pp_window, "coarsening_ratio", cr_ratio, 0, AMREX_SPACEDIM)) cr_specified = true;
     if (cr_specified) {
        for (int idim =0; idim < AMREX_SPACEDIM; ++idim) {
            m_crse_ratio[idim] = cr_ratio[idim];
@@ -291,7 +311,9 @@ Diagnostics::BaseReadParameters ()
     }
 
     // Names of species to write to output
-    bool species_specified = pp_diag_name.queryarr("species", m_output_species_names);
+    // (only those of the window itself for an output window, which writes no particle by default)
+    bool species_specified = is_window ? pp_window.queryarr("species", m_output_species_names)
+                                       : pp_diag_name.queryarr("species", m_output_species_names);
 
 
     // Auxiliary variables
@@ -367,9 +389,15 @@ Diagnostics::InitData ()
     }
 
     amrex::ParmParse pp_diag_name(m_diag_name);
-    // default for writing species output is 1
+    // default for writing species output is 1, and 0 for an output window
     int write_species = 1;
-    pp_diag_name.query("write_species", write_species);
+    if (m_window_name.empty()) {
+        pp_diag_name.query("write_species", write_species);
+    } else {
+        write_species = 0;
+        amrex::ParmParse pp_window(m_diag_name + "." + m_window_name);
+        pp_window.query("write_species", write_species);
+    }
     if (write_species == 1) {
         // When particle buffers, m_particle_boundary_buffer are included,
         // they will be initialized here
@@ -389,7 +417,8 @@ Diagnostics::InitData ()
         m_output_species_names.clear();
     } else {
         amrex::Vector <amrex::Real> dummy_val(AMREX_SPACEDIM);
-        if ( queryArrWithParser(pp_diag_name, "diag_lo", dummy_val, 0, AMREX_SPACEDIM) ||
+        if ( !m_window_name.empty() ||
+             queryArrWithParser(pp_diag_name, "diag_lo", dummy_val, 0, AMREX_SPACEDIM) ||
              queryArrWithParser(pp_diag_name, "diag_hi", dummy_val, 0, AMREX_SPACEDIM) ) {
             // set geometry filter for particle-diags to true when the diagnostic domain-extent
             // is specified by the user.
@@ -435,12 +464,12 @@ Diagnostics::InitBaseData ()
     }
     // Construct Flush class.
     if        (m_format == "plotfile"){
-        m_flush_format = std::make_unique<FlushFormatPlotfile>() ;
+        m_flush_format = std::make_unique<FlushFormatPlotfile>(m_diag_name);
     } else if (m_format == "checkpoint"){
         // creating checkpoint format
-        m_flush_format = std::make_unique<FlushFormatCheckpoint>() ;
+        m_flush_format = std::make_unique<FlushFormatCheckpoint>(m_diag_name);
     } else if (m_format == "ascent"){
-        m_flush_format = std::make_unique<FlushFormatAscent>();
+        m_flush_format = std::make_unique<FlushFormatAscent>(m_diag_name);
     } else if (m_format == "sensei"){
 #ifdef AMREX_USE_SENSEI_INSITU
         m_flush_format = std::make_unique<FlushFormatSensei>(
@@ -529,13 +558,30 @@ Diagnostics::FilterComputePackFlush (int step, bool force_flush)
     MovingWindowAndGalileanDomainShift (step);
 
     if ( DoComputeAndPack (step, force_flush) ) {
+#ifdef WARPX_MAG_LLG
+        // B is computed from H and M only when it is output
+        WarpX::GetInstance().ComputeBfieldFromHM();
+#endif
         ComputeAndPack();
     }
 
+    amrex::Vector<int> buffers_to_flush;
     for (int i_buffer = 0; i_buffer < m_num_buffers; ++i_buffer) {
-        if ( !DoDump (step, i_buffer, force_flush) ) continue;
-        Flush(i_buffer);
+        if ( DoDump (step, i_buffer, force_flush) ) buffers_to_flush.push_back(i_buffer);
     }
+    if (!buffers_to_flush.empty()) {
+#ifdef WARPX_MAG_LLG
+        // the checkpoints write B
+        WarpX::GetInstance().ComputeBfieldFromHM();
+#endif
+        FlushBuffers(buffers_to_flush);
+    }
+}
 
-
+void
+Diagnostics::FlushBuffers (const amrex::Vector<int>& buffers)
+{
+    for (const int i_buffer : buffers) {
+        Flush(i_buffer);
+    }
 }
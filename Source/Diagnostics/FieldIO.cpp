@@ -12,7 +12,10 @@
 
 #include <AMReX.H>
 #include <AMReX_IntVect.H>
+#include <AMReX_MFIter.H>
 #include <AMReX_MultiFab.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_Reduce.H>
 #include <AMReX_SPACE.H>
 
 #include <algorithm>
@@ -20,6 +23,7 @@
 #include <memory>
 
 using namespace amrex;
+using namespace amrex::literals;
 
 /** \brief
  * Convert an IntVect to a std::vector<std::uint64_t>
@@ -70,6 +74,36 @@ getVec( const Real* v , bool reverse)
   return u;
 }
 
+std::vector<Real>
+FindConstantBoxes( const MultiFab& mf, const IntVect ngrow )
+{
+    const int ncomp = mf.nComp();
+    std::vector<Real> consts(2*mf.size()*ncomp, 0._rt);
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+        const Box bx = amrex::grow(mfi.validbox(), ngrow);
+        Array4<Real const> const& a = mf.const_array(mfi);
+        for (int n = 0; n < ncomp; ++n) {
+            ReduceOps<ReduceOpMin, ReduceOpMax> reduce_op;
+            ReduceData<Real, Real> reduce_data(reduce_op);
+            using ReduceTuple = typename decltype(reduce_data)::Type;
+            reduce_op.eval(bx, reduce_data,
+                [=] AMREX_GPU_DEVICE (int i, int j, int k) -> ReduceTuple
+                {
+                    return {a(i,j,k,n), a(i,j,k,n)};
+                });
+            ReduceTuple const r = reduce_data.value();
+            if (amrex::get<0>(r) == amrex::get<1>(r)) {
+                const int idx = 2*(mfi.index()*ncomp + n);
+                consts[idx] = 1._rt;
+                consts[idx+1] = amrex::get<0>(r);
+            }
+        }
+    }
+    // each box is owned by one rank, so that the sum gathers the result on all ranks
+    ParallelDescriptor::ReduceRealSum(consts.data(), static_cast<int>(consts.size()));
+    return consts;
+}
+
 /** \brief
  * Convert an IntVect to a std::vector<std::uint64_t>
  * and reverse the order of the elements
@@ -1,14 +1,105 @@
 #include "FlushFormatAscent.H"
 
 #include "WarpX.H"
+#ifdef WARPX_MAG_LLG
+#   include "FieldSolver/FiniteDifferenceSolver/MacroscopicProperties/MacroscopicProperties.H"
+#endif
 #include "Utils/TextMsg.H"
 #include "Utils/WarpXProfilerWrapper.H"
 
 #include <AMReX.H>
+#include <AMReX_MFIter.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_ParmParse.H>
 #include <AMReX_REAL.H>
+#include <AMReX_Reduce.H>
+
+#include <limits>
 
 using namespace amrex;
 
+#ifdef AMREX_USE_ASCENT
+namespace
+{
+    /**
+     * \brief Add the boxes of mf to the Blueprint mesh, one domain per box, without copy.
+     *
+     * The cells of the uniform topology topo_name of a domain are centered on the points of the
+     * fab (including its guard cells, flagged in the field ghosts), so that the
+     * staggered fields are published at their own positions.
+     *
+     * \param[in] varnames names of the components of mf
+     * \param[in,out] domain_id id of the next domain, the same on all ranks
+     * \param[in] region if not null, only the boxes that intersect it are published
+     * \param[in,out] ghosts storage of the ghost fields, which must live until the publication
+     */
+    void AddToBlueprint (conduit::Node& bp_mesh, MultiFab const& mf,
+                         Vector<std::string> const& varnames, std::string const& topo_name,
+                         Geometry const& geom, int lev, int iteration, double time,
+                         RealBox const* region, int& domain_id, Vector<Vector<int>>& ghosts)
+    {
+        IntVect const ix = mf.ixType().toIntVect();
+        for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+            Box const& vbx = mfi.validbox();
+            if (region && !region->intersects(RealBox(vbx, geom.CellSize(), geom.ProbLo()))) continue;
+
+            Box const& fbx = mf[mfi].box();
+            std::string const dom_name = "domain_" + std::to_string(domain_id + mfi.index());
+            conduit::Node& dom = bp_mesh[dom_name];
+            dom["state/domain_id"] = domain_id + mfi.index();
+            dom["state/cycle"] = iteration;
+            dom["state/time"] = time;
+            dom["state/level"] = lev;
+
+            std::string const coords_name = "coords_" + topo_name;
+            conduit::Node& coords = dom["coordsets/" + coords_name];
+            coords["type"] = "uniform";
+            char const* const dims[3] = {"dims/i", "dims/j", "dims/k"};
+            char const* const origin[3] = {"origin/x", "origin/y", "origin/z"};
+            char const* const spacing[3] = {"spacing/dx", "spacing/dy", "spacing/dz"};
+            for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+                coords[dims[idim]] = fbx.length(idim) + 1;
+                coords[origin[idim]] = geom.ProbLo(idim)
+                    + (fbx.smallEnd(idim) - 0.5_rt*ix[idim]) * geom.CellSize(idim);
+                coords[spacing[idim]] = geom.CellSize(idim);
+            }
+            dom["topologies/" + topo_name + "/type"] = "uniform";
+            dom["topologies/" + topo_name + "/coordset"] = coords_name;
+
+            auto const npts = static_cast<conduit::index_t>(fbx.numPts());
+            for (int comp = 0; comp < mf.nComp(); ++comp) {
+                conduit::Node& field = dom["fields/" + varnames[comp]];
+                field["association"] = "element";
+                field["topology"] = topo_name;
+                field["values"].set_external(const_cast<Real*>(mf[mfi].dataPtr(comp)), npts);
+            }
+
+            // 1 in the guard cells, 0 in the valid box
+            Vector<int>& ghost = ghosts.emplace_back(fbx.numPts(), 1);
+            Long n = 0;
+            for (BoxIterator bit(fbx); bit.ok(); ++bit, ++n) {
+                if (vbx.contains(bit())) ghost[n] = 0;
+            }
+            conduit::Node& ghost_field = dom["fields/ghosts"];
+            ghost_field["association"] = "element";
+            ghost_field["topology"] = topo_name;
+            ghost_field["values"].set_external(ghost.data(), npts);
+        }
+        domain_id += mf.size();
+    }
+}
+#endif // AMREX_USE_ASCENT
+
+FlushFormatAscent::FlushFormatAscent (const std::string& diag_name)
+{
+    ParmParse pp_diag_name(diag_name);
+    pp_diag_name.query("ascent_magnetic_region_only", m_magnetic_region_only);
+#ifndef WARPX_MAG_LLG
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(!m_magnetic_region_only,
+        "<diag>.ascent_magnetic_region_only requires USE_LLG=TRUE");
+#endif
+}
+
 void
 FlushFormatAscent::WriteToFile (
     const amrex::Vector<std::string> varnames,
@@ -26,11 +117,60 @@ FlushFormatAscent::WriteToFile (
 
     auto & warpx = WarpX::GetInstance();
 
+    // boxes published with ascent_magnetic_region_only
+    RealBox mag_region;
+    RealBox const* region = nullptr;
+    if (m_magnetic_region_only) {
+        mag_region = MagneticRegion();
+        region = &mag_region;
+    }
+
     // wrap mesh data
     WARPX_PROFILE_VAR("FlushFormatAscent::WriteToFile::MultiLevelToBlueprint", prof_ascent_mesh_blueprint);
     conduit::Node bp_mesh;
-    amrex::MultiLevelToBlueprint(
-        nlev, amrex::GetVecOfConstPtrs(mf), varnames, geom, time, iteration, warpx.refRatio(), bp_mesh);
+    // the ghost fields of the domains, published without copy like the field data
+    Vector<Vector<int>> ghosts;
+    int domain_id = 0;
+    if (!varnames.empty()) {
+        if (region) {
+            for (int lev = 0; lev < nlev; ++lev) {
+                AddToBlueprint(bp_mesh, mf[lev], varnames, "topo", geom[lev], lev, iteration[lev],
+                               time, region, domain_id, ghosts);
+            }
+        } else {
+            amrex::MultiLevelToBlueprint(
+                nlev, amrex::GetVecOfConstPtrs(mf), varnames, geom, time, iteration, warpx.refRatio(), bp_mesh);
+        }
+    }
+    if (plot_raw_fields) {
+        // the staggered fields of the fine patch, at their own positions
+        for (int lev = 0; lev < nlev; ++lev) {
+            Geometry const& raw_geom = warpx.Geom(lev);
+            auto add_raw = [&] (MultiFab const& raw_mf, Vector<std::string> const& names,
+                                std::string const& topo_name) {
+                AddToBlueprint(bp_mesh, raw_mf, names, topo_name, raw_geom, lev, iteration[lev],
+                               time, region, domain_id, ghosts);
+            };
+            char const* const dir_names[3] = {"x", "y", "z"};
+            for (int dir = 0; dir < 3; ++dir) {
+                std::string const d = dir_names[dir];
+                add_raw(warpx.getEfield_fp(lev, dir), {"E" + d + "_fp"}, "topo_E" + d);
+                add_raw(warpx.getBfield_fp(lev, dir), {"B" + d + "_fp"}, "topo_B" + d);
+#ifdef WARPX_MAG_LLG
+                if (WarpX::mag_LLG) {
+                    add_raw(warpx.getHfield_fp(lev, dir), {"H" + d + "_fp"}, "topo_H" + d);
+                    // M and the magnetic properties live on the faces of direction dir
+                    std::string const face = d + "face";
+                    add_raw(warpx.getMfield_fp(lev, dir),
+                            {"M_" + face + "_x_fp", "M_" + face + "_y_fp", "M_" + face + "_z_fp"},
+                            "topo_M_" + face);
+                    add_raw(warpx.GetMacroscopicProperties(lev).getmag_Ms_mf(dir),
+                            {"mag_Ms_" + face}, "topo_M_" + face);
+                }
+#endif
+            }
+        }
+    }
     WARPX_PROFILE_VAR_STOP(prof_ascent_mesh_blueprint);
 
     WARPX_PROFILE_VAR("FlushFormatAscent::WriteToFile::WriteParticles", prof_ascent_particles);
@@ -47,6 +187,7 @@ FlushFormatAscent::WriteToFile (
     conduit::Node opts;
     opts["exceptions"] = "catch";
     opts["mpi_comm"] = MPI_Comm_c2f(ParallelDescriptor::Communicator());
+    if (!ghosts.empty()) opts["ghost_field_name"] = "ghosts";
     ascent.open(opts);
     ascent.publish(bp_mesh);
     WARPX_PROFILE_VAR_STOP(prof_ascent_publish);
@@ -59,9 +200,9 @@ FlushFormatAscent::WriteToFile (
 
 #else
     amrex::ignore_unused(varnames, mf, geom, iteration, time,
-        particle_diags, nlev);
+        particle_diags, nlev, plot_raw_fields);
 #endif // AMREX_USE_ASCENT
-    amrex::ignore_unused(prefix, plot_raw_fields, plot_raw_fields_guards);
+    amrex::ignore_unused(prefix, plot_raw_fields_guards);
 }
 
 #ifdef AMREX_USE_ASCENT
@@ -115,4 +256,41 @@ FlushFormatAscent::WriteParticles(const amrex::Vector<ParticleDiag>& particle_di
                                             prefix);
     }
 }
+
+RealBox
+FlushFormatAscent::MagneticRegion ()
+{
+    RealBox region;
+#ifdef WARPX_MAG_LLG
+    auto & warpx = WarpX::GetInstance();
+    MultiFab const& Ms = warpx.GetMacroscopicProperties(0).getmag_Ms_mf(0);
+    Geometry const& geom = warpx.Geom(0);
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        // lowest and highest index of the magnetic x faces along idim
+        ReduceOps<ReduceOpMin, ReduceOpMax> reduce_op;
+        ReduceData<int, int> reduce_data(reduce_op);
+        using ReduceTuple = typename decltype(reduce_data)::Type;
+        for (MFIter mfi(Ms); mfi.isValid(); ++mfi) {
+            Array4<Real const> const& Ms_arr = Ms.const_array(mfi);
+            reduce_op.eval(mfi.validbox(), reduce_data,
+                [=] AMREX_GPU_DEVICE (int i, int j, int k) -> ReduceTuple
+                {
+                    bool const magnetic = Ms_arr(i, j, k) > 0._rt;
+                    int const ind = IntVect(AMREX_D_DECL(i, j, k))[idim];
+                    return {magnetic ? ind : std::numeric_limits<int>::max(),
+                            magnetic ? ind : std::numeric_limits<int>::lowest()};
+                });
+        }
+        ReduceTuple const hv = reduce_data.value(reduce_op);
+        int lo = amrex::get<0>(hv);
+        int hi = amrex::get<1>(hv);
+        ParallelDescriptor::ReduceIntMin(lo);
+        ParallelDescriptor::ReduceIntMax(hi);
+        // lo > hi (an empty region) if there is no magnetic cell
+        region.setLo(idim, geom.ProbLo(idim) + lo * geom.CellSize(idim));
+        region.setHi(idim, geom.ProbLo(idim) + (hi + 1) * geom.CellSize(idim));
+    }
+#endif
+    return region;
+}
 #endif // AMREX_USE_ASCENT
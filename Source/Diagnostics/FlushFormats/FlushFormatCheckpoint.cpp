@@ -5,12 +5,20 @@
 #   include "BoundaryConditions/PML_RZ.H"
 #endif
 #include "Diagnostics/ParticleDiag/ParticleDiag.H"
+#include "FieldSolver/FiniteDifferenceSolver/MacroscopicProperties/MacroscopicProperties.H"
 #include "Particles/WarpXParticleContainer.H"
 #include "Utils/TextMsg.H"
+#include "Utils/WarpXAlgorithmSelection.H"
 #include "Utils/WarpXProfilerWrapper.H"
+#include "Utils/WarpXUtil.H"
 #include "WarpX.H"
 
+#include <AMReX_AsyncOut.H>
+#include <AMReX_FabConv.H>
+#include <AMReX_FArrayBox.H>
 #include <AMReX_MultiFab.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_ParmParse.H>
 #include <AMReX_ParticleIO.H>
 #include <AMReX_PlotFileUtil.H>
 #include <AMReX_Print.H>
@@ -18,11 +26,98 @@
 #include <AMReX_Utility.H>
 #include <AMReX_VisMF.H>
 
+#include <array>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <memory>
+
 using namespace amrex;
 
 namespace
 {
     const std::string default_level_prefix {"Level_"};
+
+    /** Whether this rank handles the node-local files of its node (the first rank of each node) */
+    bool IsNodeLeader ()
+    {
+#ifdef AMREX_USE_MPI
+        static const bool is_node_leader = [] {
+            MPI_Comm node_comm;
+            MPI_Comm_split_type(ParallelDescriptor::Communicator(), MPI_COMM_TYPE_SHARED, 0,
+                                MPI_INFO_NULL, &node_comm);
+            int node_rank = 0;
+            MPI_Comm_rank(node_comm, &node_rank);
+            MPI_Comm_free(&node_comm);
+            return node_rank == 0;
+        }();
+        return is_node_leader;
+#else
+        return true;
+#endif
+    }
+
+    /** Write mf to name, staged in a host buffer and written by the I/O thread if async.
+     *  In single precision, mf is converted while it is written, synchronously, and converted
+     *  back to amrex::Real by VisMF::Read at restart. */
+    void WriteCheckpointMF (const MultiFab& mf, const std::string& name, bool async,
+                            bool single_precision = false)
+    {
+        if (single_precision) {
+            const FABio::Format format = FArrayBox::getFormat();
+            FArrayBox::setFormat(FABio::FAB_NATIVE_32);
+            VisMF::Write(mf, name);
+            FArrayBox::setFormat(format);
+        } else if (async) {
+            VisMF::AsyncWrite(mf, name);
+        } else {
+            VisMF::Write(mf, name);
+        }
+    }
+
+    /** Copy the files of the node-local checkpoint local_dir to global_dir, except the
+     *  WarpXHeader. Called by a background thread, without MPI communication. */
+    void CopyCheckpointFiles (const std::string& local_dir, const std::string& global_dir)
+    {
+        namespace fs = std::filesystem;
+        const fs::path local_path(local_dir);
+        for (const auto& entry : fs::recursive_directory_iterator(local_path)) {
+            const fs::path target = fs::path(global_dir) / fs::relative(entry.path(), local_path);
+            if (entry.is_directory()) {
+                fs::create_directories(target);
+            } else if (entry.path() != local_path / "WarpXHeader") {
+                fs::create_directories(target.parent_path());
+                fs::copy_file(entry.path(), target, fs::copy_options::overwrite_existing);
+            }
+        }
+    }
+}
+
+FlushFormatCheckpoint::FlushFormatCheckpoint (const std::string& diag_name)
+{
+    ParmParse pp_diag_name(diag_name);
+    pp_diag_name.query("incremental", m_incremental);
+    pp_diag_name.query("local_path", m_local_path);
+    queryWithParser(pp_diag_name, "local_keep", m_local_keep);
+    pp_diag_name.query("single_precision_M", m_single_precision_M);
+    pp_diag_name.query("single_precision_properties", m_single_precision_properties);
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(m_local_keep >= 1,
+        diag_name + ".local_keep must be at least 1");
+    if (!m_local_path.empty()) {
+        // one particle file per rank, as for the fields, see WriteToFile
+        ParmParse pp_particles("particles");
+        pp_particles.add("particles_nfiles", -1);
+    }
+    // the moving window shifts the material properties and H_bias, which are then not static
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(!m_incremental || !WarpX::do_moving_window,
+        diag_name + ".incremental is not supported with the moving window");
+}
+
+FlushFormatCheckpoint::~FlushFormatCheckpoint ()
+{
+    FinishAsync();
+    FinishDrain();
 }
 
 void
@@ -46,142 +141,206 @@ FlushFormatCheckpoint::WriteToFile (
     VisMF::Header::Version current_version = VisMF::GetHeaderVersion();
     VisMF::SetHeaderVersion(amrex::VisMF::Header::NoFabHeader_v1);
 
-    const std::string& checkpointname = amrex::Concatenate(prefix, iteration[0], file_min_digits);
+    const std::string global_checkpointname = amrex::Concatenate(prefix, iteration[0], file_min_digits);
+
+    // With a node-local path, the checkpoint is written there and copied to the global path
+    // in the background, after the copy of the previous checkpoint is complete
+    const bool write_local = !m_local_path.empty();
+    if (write_local) FinishDrain();
+    // The node-local files of all the nodes are copied to the same global directory, so that
+    // a file must not be shared by ranks of different nodes: each rank writes its own files
+    const int current_nfiles = VisMF::GetNOutFiles();
+    if (write_local) VisMF::SetNOutFiles(ParallelDescriptor::NProcs());
+    const std::string checkpointname = write_local ?
+        m_local_path + "/" + global_checkpointname.substr(global_checkpointname.find_last_of('/') + 1) :
+        global_checkpointname;
+
+    // With asynchronous output (amrex.async_out = 1), the fields are staged in host memory and
+    // written by the I/O thread while the simulation continues, after the previous checkpoint.
+    // Written on node-local storage, they are not staged: that write is short, and complete
+    // before the copy to the global path.
+    const bool use_async_out = AsyncOut::UseAsyncOut();
+    FinishAsync();
+    const bool write_async = use_async_out && !write_local;
+
+    // In incremental mode, the fields that do not change in time are only written in a full
+    // checkpoint (the first one, and the first one after a regrid), and read from it at restart
+    bool write_static = true;
+    if (m_incremental) {
+        write_static = m_base_checkpoint.empty() || static_cast<int>(m_base_grids.size()) != nlev;
+        for (int lev = 0; lev < nlev && !write_static; ++lev) {
+            write_static = (m_base_grids[lev] != warpx.boxArray(lev));
+        }
+    }
+#ifdef WARPX_MAG_LLG
+    // a uniform H_bias (warpx.mag_H_bias_uniform = 1) has no MultiFab, and is given by the input
+    const bool write_H_bias = warpx.get_pointer_H_biasfield_fp(0, 0) != nullptr && (write_static ||
+        WarpX::H_bias_excitation_grid_s == "parse_h_bias_excitation_grid_function");
+#endif
 
     amrex::Print() << Utils::TextMsg::Info(
-        "Writing checkpoint " + checkpointname);
+        "Writing checkpoint " + global_checkpointname
+        + (write_local ? " via " + checkpointname : "")
+        + (write_async ? " in the background" : "")
+        + (write_static ? "" : " (static fields in " + m_base_checkpoint + ")"));
 
     // const int nlevels = finestLevel()+1;
-    amrex::PreBuildDirectorHierarchy(checkpointname, default_level_prefix, nlev, true);
+    if (write_local) {
+        PrebuildLocalDirectories(checkpointname, nlev, particle_diags);
+    } else {
+        amrex::PreBuildDirectorHierarchy(checkpointname, default_level_prefix, nlev, true);
+    }
 
     WriteWarpXHeader(checkpointname, geom);
+    // The WarpXHeader marks a complete checkpoint: with asynchronous output, it is renamed
+    // once all the ranks have written their data
+    if (use_async_out && ParallelDescriptor::IOProcessor()) {
+        std::filesystem::rename(checkpointname + "/WarpXHeader", checkpointname + "/WarpXHeader.staged");
+    }
 
     WriteJobInfo(checkpointname);
+#ifdef WARPX_MAG_LLG
+    if (WarpX::mag_LLG) warpx.WriteLLGState(checkpointname);
+#endif
 
     for (int lev = 0; lev < nlev; ++lev)
     {
-        VisMF::Write(warpx.getEfield_fp(lev, 0),
-                     amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Ex_fp"));
-        VisMF::Write(warpx.getEfield_fp(lev, 1),
-                     amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Ey_fp"));
-        VisMF::Write(warpx.getEfield_fp(lev, 2),
-                     amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Ez_fp"));
-        VisMF::Write(warpx.getBfield_fp(lev, 0),
-                     amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Bx_fp"));
-        VisMF::Write(warpx.getBfield_fp(lev, 1),
-                     amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "By_fp"));
-        VisMF::Write(warpx.getBfield_fp(lev, 2),
-                     amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Bz_fp"));
+        WriteCheckpointMF(warpx.getEfield_fp(lev, 0),
+                          amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Ex_fp"), write_async);
+        WriteCheckpointMF(warpx.getEfield_fp(lev, 1),
+                          amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Ey_fp"), write_async);
+        WriteCheckpointMF(warpx.getEfield_fp(lev, 2),
+                          amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Ez_fp"), write_async);
+        WriteCheckpointMF(warpx.getBfield_fp(lev, 0),
+                          amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Bx_fp"), write_async);
+        WriteCheckpointMF(warpx.getBfield_fp(lev, 1),
+                          amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "By_fp"), write_async);
+        WriteCheckpointMF(warpx.getBfield_fp(lev, 2),
+                          amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Bz_fp"), write_async);
 
 #ifdef WARPX_MAG_LLG
-        VisMF::Write(warpx.getHfield_fp(lev, 0),
-                     amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Hx_fp"));
-        VisMF::Write(warpx.getHfield_fp(lev, 1),
-                     amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Hy_fp"));
-        VisMF::Write(warpx.getHfield_fp(lev, 2),
-                     amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Hz_fp"));
-        VisMF::Write(warpx.getMfield_fp(lev, 0),
-                     amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Mx_fp"));
-        VisMF::Write(warpx.getMfield_fp(lev, 1),
-                     amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "My_fp"));
-        VisMF::Write(warpx.getMfield_fp(lev, 2),
-                     amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Mz_fp"));
-        VisMF::Write(warpx.getH_biasfield_fp(lev, 0),
-                     amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Hxbias_fp"));
-        VisMF::Write(warpx.getH_biasfield_fp(lev, 1),
-                     amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Hybias_fp"));
-        VisMF::Write(warpx.getH_biasfield_fp(lev, 2),
-                     amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Hzbias_fp"));
+        if (WarpX::mag_LLG) {
+            WriteCheckpointMF(warpx.getHfield_fp(lev, 0),
+                              amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Hx_fp"), write_async);
+            WriteCheckpointMF(warpx.getHfield_fp(lev, 1),
+                              amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Hy_fp"), write_async);
+            WriteCheckpointMF(warpx.getHfield_fp(lev, 2),
+                              amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Hz_fp"), write_async);
+            WriteCheckpointMF(warpx.getMfield_fp(lev, 0),
+                              amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Mx_fp"), write_async, m_single_precision_M);
+            WriteCheckpointMF(warpx.getMfield_fp(lev, 1),
+                              amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "My_fp"), write_async, m_single_precision_M);
+            WriteCheckpointMF(warpx.getMfield_fp(lev, 2),
+                              amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Mz_fp"), write_async, m_single_precision_M);
+            if (write_H_bias) {
+                WriteCheckpointMF(warpx.getH_biasfield_fp(lev, 0),
+                                  amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Hxbias_fp"), write_async,
+                                  m_single_precision_properties);
+                WriteCheckpointMF(warpx.getH_biasfield_fp(lev, 1),
+                                  amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Hybias_fp"), write_async,
+                                  m_single_precision_properties);
+                WriteCheckpointMF(warpx.getH_biasfield_fp(lev, 2),
+                                  amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Hzbias_fp"), write_async,
+                                  m_single_precision_properties);
+            }
+        }
 #endif
 
         if (WarpX::fft_do_time_averaging)
         {
-            VisMF::Write(warpx.getEfield_avg_fp(lev, 0),
-                         amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Ex_avg_fp"));
-            VisMF::Write(warpx.getEfield_avg_fp(lev, 1),
-                         amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Ey_avg_fp"));
-            VisMF::Write(warpx.getEfield_avg_fp(lev, 2),
-                         amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Ez_avg_fp"));
-
-            VisMF::Write(warpx.getBfield_avg_fp(lev, 0),
-                         amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Bx_avg_fp"));
-            VisMF::Write(warpx.getBfield_avg_fp(lev, 1),
-                         amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "By_avg_fp"));
-            VisMF::Write(warpx.getBfield_avg_fp(lev, 2),
-                         amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Bz_avg_fp"));
+            WriteCheckpointMF(warpx.getEfield_avg_fp(lev, 0),
+                              amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Ex_avg_fp"), write_async);
+            WriteCheckpointMF(warpx.getEfield_avg_fp(lev, 1),
+                              amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Ey_avg_fp"), write_async);
+            WriteCheckpointMF(warpx.getEfield_avg_fp(lev, 2),
+                              amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Ez_avg_fp"), write_async);
+
+            WriteCheckpointMF(warpx.getBfield_avg_fp(lev, 0),
+                              amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Bx_avg_fp"), write_async);
+            WriteCheckpointMF(warpx.getBfield_avg_fp(lev, 1),
+                              amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "By_avg_fp"), write_async);
+            WriteCheckpointMF(warpx.getBfield_avg_fp(lev, 2),
+                              amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Bz_avg_fp"), write_async);
         }
 
         if (warpx.getis_synchronized()) {
             // Need to save j if synchronized because after restart we need j to evolve E by dt/2.
-            VisMF::Write(warpx.getcurrent_fp(lev, 0),
-                         amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "jx_fp"));
-            VisMF::Write(warpx.getcurrent_fp(lev, 1),
-                         amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "jy_fp"));
-            VisMF::Write(warpx.getcurrent_fp(lev, 2),
-                         amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "jz_fp"));
+            WriteCheckpointMF(warpx.getcurrent_fp(lev, 0),
+                              amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "jx_fp"), write_async);
+            WriteCheckpointMF(warpx.getcurrent_fp(lev, 1),
+                              amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "jy_fp"), write_async);
+            WriteCheckpointMF(warpx.getcurrent_fp(lev, 2),
+                              amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "jz_fp"), write_async);
         }
 
         if (lev > 0)
         {
-            VisMF::Write(warpx.getEfield_cp(lev, 0),
-                         amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Ex_cp"));
-            VisMF::Write(warpx.getEfield_cp(lev, 1),
-                         amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Ey_cp"));
-            VisMF::Write(warpx.getEfield_cp(lev, 2),
-                         amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Ez_cp"));
-            VisMF::Write(warpx.getBfield_cp(lev, 0),
-                         amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Bx_cp"));
-            VisMF::Write(warpx.getBfield_cp(lev, 1),
-                         amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "By_cp"));
-            VisMF::Write(warpx.getBfield_cp(lev, 2),
-                         amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Bz_cp"));
+            WriteCheckpointMF(warpx.getEfield_cp(lev, 0),
+                              amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Ex_cp"), write_async);
+            WriteCheckpointMF(warpx.getEfield_cp(lev, 1),
+                              amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Ey_cp"), write_async);
+            WriteCheckpointMF(warpx.getEfield_cp(lev, 2),
+                              amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Ez_cp"), write_async);
+            WriteCheckpointMF(warpx.getBfield_cp(lev, 0),
+                              amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Bx_cp"), write_async);
+            WriteCheckpointMF(warpx.getBfield_cp(lev, 1),
+                              amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "By_cp"), write_async);
+            WriteCheckpointMF(warpx.getBfield_cp(lev, 2),
+                              amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Bz_cp"), write_async);
 
 #ifdef WARPX_MAG_LLG
-            VisMF::Write(warpx.getHfield_cp(lev, 0),
-                         amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Hx_cp"));
-            VisMF::Write(warpx.getHfield_cp(lev, 1),
-                         amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Hy_cp"));
-            VisMF::Write(warpx.getHfield_cp(lev, 2),
-                         amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Hz_cp"));
-            VisMF::Write(warpx.getMfield_cp(lev, 0),
-                         amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Mx_cp"));
-            VisMF::Write(warpx.getMfield_cp(lev, 1),
-                         amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "My_cp"));
-            VisMF::Write(warpx.getMfield_cp(lev, 2),
-                         amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Mz_cp"));
-            VisMF::Write(warpx.getH_biasfield_cp(lev, 0),
-                         amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Hxbias_fp"));
-            VisMF::Write(warpx.getH_biasfield_cp(lev, 1),
-                         amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Hybias_fp"));
-            VisMF::Write(warpx.getH_biasfield_cp(lev, 2),
-                         amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Hzbias_fp"));
+            if (WarpX::mag_LLG) {
+                WriteCheckpointMF(warpx.getHfield_cp(lev, 0),
+                                  amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Hx_cp"), write_async);
+                WriteCheckpointMF(warpx.getHfield_cp(lev, 1),
+                                  amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Hy_cp"), write_async);
+                WriteCheckpointMF(warpx.getHfield_cp(lev, 2),
+                                  amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Hz_cp"), write_async);
+                WriteCheckpointMF(warpx.getMfield_cp(lev, 0),
+                                  amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Mx_cp"), write_async, m_single_precision_M);
+                WriteCheckpointMF(warpx.getMfield_cp(lev, 1),
+                                  amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "My_cp"), write_async, m_single_precision_M);
+                WriteCheckpointMF(warpx.getMfield_cp(lev, 2),
+                                  amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Mz_cp"), write_async, m_single_precision_M);
+                if (write_H_bias) {
+                    WriteCheckpointMF(warpx.getH_biasfield_cp(lev, 0),
+                                      amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Hxbias_cp"), write_async,
+                                      m_single_precision_properties);
+                    WriteCheckpointMF(warpx.getH_biasfield_cp(lev, 1),
+                                      amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Hybias_cp"), write_async,
+                                      m_single_precision_properties);
+                    WriteCheckpointMF(warpx.getH_biasfield_cp(lev, 2),
+                                      amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Hzbias_cp"), write_async,
+                                      m_single_precision_properties);
+                }
+            }
 #endif
 
             if (WarpX::fft_do_time_averaging)
             {
-                VisMF::Write(warpx.getEfield_avg_cp(lev, 0),
-                             amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Ex_avg_cp"));
-                VisMF::Write(warpx.getEfield_avg_cp(lev, 1),
-                             amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Ey_avg_cp"));
-                VisMF::Write(warpx.getEfield_avg_cp(lev, 2),
-                             amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Ez_avg_cp"));
-
-                VisMF::Write(warpx.getBfield_avg_cp(lev, 0),
-                             amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Bx_avg_cp"));
-                VisMF::Write(warpx.getBfield_avg_cp(lev, 1),
-                             amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "By_avg_cp"));
-                VisMF::Write(warpx.getBfield_avg_cp(lev, 2),
-                             amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Bz_avg_cp"));
+                WriteCheckpointMF(warpx.getEfield_avg_cp(lev, 0),
+                                  amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Ex_avg_cp"), write_async);
+                WriteCheckpointMF(warpx.getEfield_avg_cp(lev, 1),
+                                  amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Ey_avg_cp"), write_async);
+                WriteCheckpointMF(warpx.getEfield_avg_cp(lev, 2),
+                                  amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Ez_avg_cp"), write_async);
+
+                WriteCheckpointMF(warpx.getBfield_avg_cp(lev, 0),
+                                  amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Bx_avg_cp"), write_async);
+                WriteCheckpointMF(warpx.getBfield_avg_cp(lev, 1),
+                                  amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "By_avg_cp"), write_async);
+                WriteCheckpointMF(warpx.getBfield_avg_cp(lev, 2),
+                                  amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Bz_avg_cp"), write_async);
             }
 
             if (warpx.getis_synchronized()) {
                 // Need to save j if synchronized because after restart we need j to evolve E by dt/2.
-                VisMF::Write(warpx.getcurrent_cp(lev, 0),
-                             amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "jx_cp"));
-                VisMF::Write(warpx.getcurrent_cp(lev, 1),
-                             amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "jy_cp"));
-                VisMF::Write(warpx.getcurrent_cp(lev, 2),
-                             amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "jz_cp"));
+                WriteCheckpointMF(warpx.getcurrent_cp(lev, 0),
+                                  amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "jx_cp"), write_async);
+                WriteCheckpointMF(warpx.getcurrent_cp(lev, 1),
+                                  amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "jy_cp"), write_async);
+                WriteCheckpointMF(warpx.getcurrent_cp(lev, 2),
+                                  amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "jz_cp"), write_async);
             }
         }
 
@@ -199,11 +358,54 @@ FlushFormatCheckpoint::WriteToFile (
         }
     }
 
+    if (write_static && WarpX::em_solver_medium == MediumForEM::Macroscopic) {
+        WriteMaterialProperties(checkpointname, write_async);
+    }
+
     CheckpointParticles(checkpointname, particle_diags);
 
     WriteDMaps(checkpointname, nlev);
 
+    if (m_incremental) {
+        if (write_static) {
+            // This checkpoint becomes the base of the next ones, which are in the same directory
+            m_base_checkpoint = checkpointname.substr(checkpointname.find_last_of('/') + 1);
+            m_base_grids.resize(nlev);
+            for (int lev = 0; lev < nlev; ++lev) m_base_grids[lev] = warpx.boxArray(lev);
+        } else if (ParallelDescriptor::IOProcessor()) {
+            std::ofstream base_file(checkpointname + "/BaseCheckpoint");
+            base_file << m_base_checkpoint << "\n";
+        }
+    }
+
     VisMF::SetHeaderVersion(current_version);
+    VisMF::SetNOutFiles(current_nfiles);
+
+    if (use_async_out) {
+        // The I/O thread runs its tasks in order, so this one completes
+        // once all the data staged above (also by the PML and particles) are written
+        auto done = std::make_shared<std::promise<void>>();
+        m_async_written = done->get_future();
+        m_async_name = checkpointname;
+        AsyncOut::Submit([done] () { done->set_value(); });
+        if (write_local) FinishAsync();
+    }
+
+    if (write_local) {
+        // All the ranks of a node have written their files before they are copied
+        ParallelDescriptor::Barrier();
+        if (ParallelDescriptor::IOProcessor()) {
+            amrex::UtilCreateCleanDirectory(global_checkpointname, false);
+        }
+        ParallelDescriptor::Barrier();
+        m_drain_global = global_checkpointname;
+        m_drain_local = checkpointname;
+        m_local_checkpoints.push_back(checkpointname);
+        if (IsNodeLeader()) {
+            m_drain_done = std::async(std::launch::async, CopyCheckpointFiles,
+                                      checkpointname, global_checkpointname);
+        }
+    }
 
 }
 
@@ -245,6 +447,106 @@ FlushFormatCheckpoint::CheckpointParticles (
     }
 }
 
+void
+FlushFormatCheckpoint::PrebuildLocalDirectories (
+    const std::string& dir, int nlev,
+    const amrex::Vector<ParticleDiag>& particle_diags) const
+{
+    // The directories are only created by the I/O rank with the global path,
+    // and on the node-local storage all nodes need them
+    if (IsNodeLeader()) {
+        namespace fs = std::filesystem;
+        fs::remove_all(dir);
+        for (int lev = 0; lev < nlev; ++lev) {
+            const std::string level_dir = amrex::Concatenate(default_level_prefix, lev, 1);
+            fs::create_directories(fs::path(dir) / level_dir);
+            for (const auto& part_diag : particle_diags) {
+                fs::create_directories(fs::path(dir) / part_diag.getSpeciesName() / level_dir);
+            }
+        }
+    }
+    ParallelDescriptor::Barrier();
+}
+
+void
+FlushFormatCheckpoint::FinishAsync () const
+{
+    if (m_async_name.empty()) return;
+    WARPX_PROFILE("FlushFormatCheckpoint::FinishAsync()");
+    m_async_written.wait();
+    ParallelDescriptor::Barrier();
+    if (ParallelDescriptor::IOProcessor()) {
+        std::filesystem::rename(m_async_name + "/WarpXHeader.staged", m_async_name + "/WarpXHeader");
+    }
+    m_async_name.clear();
+}
+
+void
+FlushFormatCheckpoint::FinishDrain () const
+{
+    if (m_drain_global.empty()) return;
+    if (m_drain_done.valid()) {
+        try {
+            m_drain_done.get();
+        } catch (const std::exception& e) {
+            amrex::Abort(Utils::TextMsg::Err(
+                "copy of checkpoint " + m_drain_local + " to " + m_drain_global + " failed: " + e.what()));
+        }
+    }
+    ParallelDescriptor::Barrier();
+    // The WarpXHeader is copied last: a global checkpoint without it is incomplete
+    if (ParallelDescriptor::IOProcessor()) {
+        std::filesystem::copy_file(m_drain_local + "/WarpXHeader", m_drain_global + "/WarpXHeader",
+                                   std::filesystem::copy_options::overwrite_existing);
+    }
+    m_drain_global.clear();
+    m_drain_local.clear();
+
+    // Only the last m_local_keep node-local checkpoints are kept
+    while (static_cast<int>(m_local_checkpoints.size()) > m_local_keep) {
+        if (IsNodeLeader()) std::filesystem::remove_all(m_local_checkpoints.front());
+        m_local_checkpoints.pop_front();
+    }
+}
+
+void
+FlushFormatCheckpoint::WriteMaterialProperties (const std::string& dir, bool async) const
+{
+    // The properties are only defined on level 0
+    MacroscopicProperties& macroscopic = WarpX::GetInstance().GetMacroscopicProperties();
+    WriteCheckpointMF(*macroscopic.get_pointer_sigma(),
+                      amrex::MultiFabFileFullPrefix(0, dir, default_level_prefix, "sigma"), async, m_single_precision_properties);
+    WriteCheckpointMF(*macroscopic.get_pointer_eps(),
+                      amrex::MultiFabFileFullPrefix(0, dir, default_level_prefix, "epsilon"), async, m_single_precision_properties);
+    WriteCheckpointMF(*macroscopic.get_pointer_mu(),
+                      amrex::MultiFabFileFullPrefix(0, dir, default_level_prefix, "mu"), async, m_single_precision_properties);
+#ifdef WARPX_MAG_LLG
+    if (WarpX::mag_LLG) {
+        const std::array<std::string, 3> faces = {"xface", "yface", "zface"};
+        for (int i = 0; i < 3; ++i) {
+            WriteCheckpointMF(*macroscopic.getmag_pointer_Ms(i),
+                              amrex::MultiFabFileFullPrefix(0, dir, default_level_prefix, "mag_Ms_" + faces[i]), async,
+                              m_single_precision_properties);
+            WriteCheckpointMF(*macroscopic.getmag_pointer_alpha(i),
+                              amrex::MultiFabFileFullPrefix(0, dir, default_level_prefix, "mag_alpha_" + faces[i]), async,
+                              m_single_precision_properties);
+            WriteCheckpointMF(*macroscopic.getmag_pointer_gamma(i),
+                              amrex::MultiFabFileFullPrefix(0, dir, default_level_prefix, "mag_gamma_" + faces[i]), async,
+                              m_single_precision_properties);
+            WriteCheckpointMF(*macroscopic.getmag_pointer_exchange(i),
+                              amrex::MultiFabFileFullPrefix(0, dir, default_level_prefix, "mag_exchange_" + faces[i]), async,
+                              m_single_precision_properties);
+            WriteCheckpointMF(*macroscopic.getmag_pointer_anisotropy(i),
+                              amrex::MultiFabFileFullPrefix(0, dir, default_level_prefix, "mag_anisotropy_" + faces[i]), async,
+                              m_single_precision_properties);
+            WriteCheckpointMF(*macroscopic.getmag_pointer_DMI(i),
+                              amrex::MultiFabFileFullPrefix(0, dir, default_level_prefix, "mag_DMI_" + faces[i]), async,
+                              m_single_precision_properties);
+        }
+    }
+#endif
+}
+
 void
 FlushFormatCheckpoint::WriteDMaps (const std::string& dir, int nlev) const
 {
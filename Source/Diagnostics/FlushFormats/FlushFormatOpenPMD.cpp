@@ -2,17 +2,24 @@
 
 #include "Utils/TextMsg.H"
 #include "Utils/WarpXProfilerWrapper.H"
+#include "Utils/WarpXUtil.H"
 #include "WarpX.H"
 
 #include <AMReX.H>
 #include <AMReX_BLassert.H>
+#include <AMReX_ParallelDescriptor.H>
 #include <AMReX_ParmParse.H>
+#include <AMReX_Print.H>
 #include <AMReX_REAL.H>
 
+#include <cctype>
+#include <iomanip>
 #include <map>
 #include <memory>
 #include <set>
+#include <sstream>
 #include <string>
+#include <utility>
 
 using namespace amrex;
 
@@ -93,11 +100,86 @@ FlushFormatOpenPMD::FlushFormatOpenPMD (const std::string& diag_name)
     engine_parameters.insert({k, v});
   }
 
+  // Streaming (SST) to a separate analysis application: each output is one ADIOS2 step
+  // that the writer does not wait for, steps are dropped when the consumer lags
+  std::transform(engine_type.begin(), engine_type.end(), engine_type.begin(), ::tolower);
+  if (engine_type == "sst") {
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(diag_type_str != "BackTransformed",
+      diag_name + ": the sst engine is not supported with the back-transformed diagnostics");
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(openpmd_backend == "default" || openpmd_backend == "bp",
+      diag_name + ": the sst engine requires openpmd_backend = bp");
+    if (encoding == openPMD::IterationEncoding::fileBased) {
+      // one stream for all the outputs, one step per output
+      if (encodingDefined) {
+        WarpX::GetInstance().RecordWarning("Diagnostics",
+          diag_name + ": file-based encoding is not supported with the sst engine. Using group-based");
+      }
+      encoding = openPMD::IterationEncoding::groupBased;
+    }
+
+    std::string stream_policy {"discard"};
+    pp_diag_name.query("stream_policy", stream_policy);
+    std::transform(stream_policy.begin(), stream_policy.end(), stream_policy.begin(), ::tolower);
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(stream_policy == "discard" || stream_policy == "block",
+      diag_name + ".stream_policy must be discard or block");
+    int stream_queue_limit = 1;
+    queryWithParser(pp_diag_name, "stream_queue_limit", stream_queue_limit);
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(stream_queue_limit >= 1,
+      diag_name + ".stream_queue_limit must be at least 1");
+    int stream_wait_for_reader = 0;
+    pp_diag_name.query("stream_wait_for_reader", stream_wait_for_reader);
+
+    // the explicit <diag>.adios2_engine.parameters.* take precedence (insert keeps them)
+    engine_parameters.insert({"QueueLimit", std::to_string(stream_queue_limit)});
+    engine_parameters.insert({"QueueFullPolicy", stream_policy == "discard" ? "Discard" : "Block"});
+    engine_parameters.insert({"RendezvousReaderCount", stream_wait_for_reader ? "1" : "0"});
+  }
+
+  // Compression of the field records (ADIOS2 operators)
+  OpenPMDFieldCompression field_compression;
+  pp_diag_name.query("field_compression", field_compression.mode);
+  WARPX_ALWAYS_ASSERT_WITH_MESSAGE(
+    field_compression.mode == "none" || field_compression.mode == "lossless" ||
+    field_compression.mode == "lossy",
+    diag_name + ".field_compression must be none, lossless or lossy");
+  if (field_compression.mode == "lossy") {
+    getWithParser(pp_diag_name, "field_compression_error_bound", field_compression.error_bound);
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(field_compression.error_bound > 0.,
+      diag_name + ".field_compression_error_bound must be positive");
+  }
+
+  // Operators set for specific records: <diag>.adios2_operator.<record>.type
+  // and <diag>.adios2_operator.<record>.parameters.<key>
+  std::string const record_prefix = diag_name + ".adios2_operator.";
+  ParmParse ppr;
+  for (std::string const & k : ppr.getEntries(diag_name + ".adios2_operator")) {
+    if (k.rfind(record_prefix, 0) != 0) continue;
+    std::string const key = k.substr(record_prefix.size());
+    auto const dot = key.find('.');
+    // skip the series-wide operator
+    if (dot == std::string::npos || key.rfind("parameters.", 0) == 0) continue;
+    std::string const record = key.substr(0, dot);
+    std::string const name = key.substr(dot + 1);
+    std::string v;
+    ppr.get(k.c_str(), v);
+    if (name == "type") {
+      field_compression.records[record].first = v;
+    } else if (name.rfind("parameters.", 0) == 0) {
+      field_compression.records[record].second.insert({name.substr(11), v});
+    }
+  }
+
+  // Chunks where a field is constant are stored as attributes only
+  bool sparse_output = false;
+  pp_diag_name.query("sparse_output", sparse_output);
+
   auto & warpx = WarpX::GetInstance();
   m_OpenPMDPlotWriter = std::make_unique<WarpXOpenPMDPlot>(
     encoding, openpmd_backend,
     operator_type, operator_parameters,
     engine_type, engine_parameters,
+    field_compression,
+    sparse_output,
     warpx.getPMLdirections()
   );
 }
@@ -130,6 +212,13 @@ FlushFormatOpenPMD::WriteToFile (
     // Set step and output directory name.
     m_OpenPMDPlotWriter->SetStep(output_iteration, prefix, file_min_digits, isBTD);
 
+    // The compression of the fields is reported from the size on disk of this write
+    bool const report_compression = m_OpenPMDPlotWriter->FieldCompressionEnabled();
+    amrex::Real t_start = 0.;
+    if (report_compression) {
+        t_start = static_cast<amrex::Real>(amrex::second());
+    }
+
     // fields: only dumped for coarse level
     m_OpenPMDPlotWriter->WriteOpenPMDFieldsAll(
         varnames, mf, geom, output_levels, output_iteration, time, isBTD, full_BTD_snapshot);
@@ -139,4 +228,26 @@ FlushFormatOpenPMD::WriteToFile (
 
     // signal that no further updates will be written to this iteration
     m_OpenPMDPlotWriter->CloseStep(isBTD, isLastBTDFlush);
+
+    if (report_compression) {
+        amrex::Real t_write = static_cast<amrex::Real>(amrex::second()) - t_start;
+        amrex::ParallelDescriptor::ReduceRealMax(t_write);
+        double field_bytes = 0.;
+        for (int lev = 0; lev < output_levels; ++lev) {
+            field_bytes += static_cast<double>(mf[lev].boxArray().numPts()) *
+                mf[lev].nComp() * sizeof(amrex::Real);
+        }
+        // only known on the I/O processor, which prints the report
+        double const disk_bytes = static_cast<double>(m_OpenPMDPlotWriter->DiskBytesWritten());
+
+        std::stringstream ss;
+        ss << std::setprecision(3) << "openPMD fields: " << field_bytes/1.e6
+           << " MB uncompressed, " << disk_bytes/1.e6 << " MB written to disk in "
+           << t_write << " s";
+        // the particles are written uncompressed to the same files
+        if (particle_diags.empty() && disk_bytes > 0.) {
+            ss << " (compression ratio " << field_bytes/disk_bytes << ")";
+        }
+        amrex::Print() << Utils::TextMsg::Info(ss.str());
+    }
 }
@@ -1,5 +1,6 @@
 #include "FlushFormatPlotfile.H"
 
+#include "Diagnostics/FieldIO.H"
 #include "Diagnostics/ParticleDiag/ParticleDiag.H"
 #include "Particles/Filter/FilterFunctors.H"
 #include "Particles/WarpXParticleContainer.H"
@@ -7,12 +8,16 @@
 #include "Utils/Interpolate.H"
 #include "Utils/TextMsg.H"
 #include "Utils/WarpXProfilerWrapper.H"
+#include "Utils/WarpXUtil.H"
 #include "WarpX.H"
 
 #include <AMReX.H>
+#include <AMReX_AsyncOut.H>
 #include <AMReX_Box.H>
 #include <AMReX_BoxArray.H>
+#include <AMReX_BoxList.H>
 #include <AMReX_Config.H>
+#include <AMReX_DistributionMapping.H>
 #include <AMReX_GpuAllocators.H>
 #include <AMReX_GpuQualifiers.H>
 #include <AMReX_IntVect.H>
@@ -38,18 +43,43 @@
 #include <array>
 #include <cstring>
 #include <fstream>
+#include <future>
+#include <iomanip>
 #include <map>
 #include <memory>
 #include <utility>
 #include <vector>
 
 using namespace amrex;
+using namespace amrex::literals;
 
 namespace
 {
     const std::string default_level_prefix {"Level_"};
 }
 
+FlushFormatPlotfile::FlushFormatPlotfile (const std::string& diag_name)
+{
+    ParmParse pp_diag_name(diag_name);
+    pp_diag_name.query("sparse_output", m_sparse_output);
+
+    queryWithParser(pp_diag_name, "field_io_nfiles", m_field_io_nfiles);
+    int writers_per_node = 0;
+    queryWithParser(pp_diag_name, "io_writers_per_node", writers_per_node);
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(m_field_io_nfiles >= 0 && writers_per_node >= 0,
+        "<diag>.field_io_nfiles and <diag>.io_writers_per_node must be non-negative");
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(m_field_io_nfiles == 0 || writers_per_node == 0,
+        "<diag>.field_io_nfiles and <diag>.io_writers_per_node cannot be used together");
+    if (writers_per_node > 0) {
+        // The NFiles writers of a file take turns, so the ranks of a node, which are
+        // consecutive with the usual placement, gather their data in the files of the node
+        int const nprocs_per_node = std::max(ParallelDescriptor::NProcsPerNode(), 1);
+        int const nnodes = (ParallelDescriptor::NProcs() + nprocs_per_node - 1) / nprocs_per_node;
+        m_field_io_nfiles = nnodes * std::min(writers_per_node, nprocs_per_node);
+        m_group_sets = true;
+    }
+}
+
 void
 FlushFormatPlotfile::WriteToFile (
     const amrex::Vector<std::string> varnames,
@@ -67,19 +97,39 @@ FlushFormatPlotfile::WriteToFile (
     const std::string& filename = amrex::Concatenate(prefix, iteration[0], file_min_digits);
     amrex::Print() << Utils::TextMsg::Info("Writing plotfile " + filename);
 
+    // Back-pressure: the previous dump must have been drained by the I/O thread
+    // before the data of this one are staged
+    if (AsyncOut::UseAsyncOut() && m_async_done.valid()) {
+        WARPX_PROFILE("FlushFormatPlotfile::WaitAsyncOut()");
+        m_async_done.wait();
+    }
+
     Vector<std::string> rfs;
     VisMF::Header::Version current_version = VisMF::GetHeaderVersion();
     VisMF::SetHeaderVersion(amrex::VisMF::Header::Version_v1);
+    // The file layout of this diagnostics, restored below for the other outputs
+    int const current_nfiles = VisMF::GetNOutFiles();
+    bool const current_group_sets = VisMF::GetGroupSets();
+    if (m_field_io_nfiles > 0) {
+        VisMF::SetNOutFiles(m_field_io_nfiles);
+        VisMF::SetGroupSets(m_group_sets);
+    }
     if (plot_raw_fields) rfs.emplace_back("raw_fields");
-    amrex::WriteMultiLevelPlotfile(filename, nlev,
-                                   amrex::GetVecOfConstPtrs(mf),
-                                   varnames, geom,
-                                   static_cast<Real>(time), iteration, warpx.refRatio(),
-                                   "HyperCLaw-V1.1",
-                                   "Level_",
-                                   "Cell",
-                                   rfs
-                                   );
+    if (varnames.empty() && plot_raw_fields) {
+        // Raw-only output: there is no cell-centered data, so only create the
+        // directories where the raw fields are written
+        amrex::PreBuildDirectorHierarchy(filename + "/raw_fields", default_level_prefix, nlev, true);
+    } else {
+        amrex::WriteMultiLevelPlotfile(filename, nlev,
+                                       amrex::GetVecOfConstPtrs(mf),
+                                       varnames, geom,
+                                       static_cast<Real>(time), iteration, warpx.refRatio(),
+                                       "HyperCLaw-V1.1",
+                                       "Level_",
+                                       "Cell",
+                                       rfs
+                                       );
+    }
 
     WriteAllRawFields(plot_raw_fields, nlev, filename, plot_raw_fields_guards);
 
@@ -90,6 +140,16 @@ FlushFormatPlotfile::WriteToFile (
     WriteWarpXHeader(filename, geom);
 
     VisMF::SetHeaderVersion(current_version);
+    VisMF::SetNOutFiles(current_nfiles);
+    VisMF::SetGroupSets(current_group_sets);
+
+    if (AsyncOut::UseAsyncOut()) {
+        // The I/O thread runs its tasks in order, so this one completes
+        // once all the data staged above are written
+        auto done = std::make_shared<std::promise<void>>();
+        m_async_done = done->get_future();
+        AsyncOut::Submit([done] () { done->set_value(); });
+    }
 }
 
 void
@@ -380,21 +440,92 @@ FlushFormatPlotfile::WriteParticles(const std::string& dir,
     }
 }
 
+/** \brief Write the boxes of MultiFab `F` in which a component varies into the
+ *  file `prefix`, and list the other boxes, where all the components are constant,
+ *  with the values of the components in the text file `prefix`_sparse.
+ *  Write guard cells if `plot_guards` is True.
+ */
+void
+WriteSparseRawMF ( const MultiFab& F, const std::string& prefix, const bool plot_guards )
+{
+    const IntVect ng = plot_guards ? F.nGrowVect() : IntVect::TheZeroVector();
+    const int ncomp = F.nComp();
+    const std::vector<Real> consts = FindConstantBoxes(F, ng);
+    const auto box_is_constant = [&consts, ncomp] (int ibox) {
+        for (int n = 0; n < ncomp; ++n) {
+            if (consts[2*(ibox*ncomp + n)] == 0._rt) return false;
+        }
+        return true;
+    };
+
+    // Boxes written as data, with the same owners as in F
+    BoxList bl(F.ixType());
+    Vector<int> pmap;
+    Vector<int> src_index;
+    for (int ibox = 0; ibox < F.size(); ++ibox) {
+        if (box_is_constant(ibox)) continue;
+        bl.push_back(F.boxArray()[ibox]);
+        pmap.push_back(F.DistributionMap()[ibox]);
+        src_index.push_back(ibox);
+    }
+    if (!src_index.empty()) {
+        MultiFab tmpF(BoxArray(std::move(bl)), DistributionMapping(std::move(pmap)), ncomp, ng);
+        for (MFIter mfi(tmpF); mfi.isValid(); ++mfi) {
+            Array4<Real> const& dst = tmpF.array(mfi);
+            Array4<Real const> const& src = F.const_array(src_index[mfi.index()]);
+            amrex::ParallelFor(mfi.fabbox(), ncomp,
+                [=] AMREX_GPU_DEVICE (int i, int j, int k, int n)
+                {
+                    dst(i,j,k,n) = src(i,j,k,n);
+                });
+        }
+        if (AsyncOut::UseAsyncOut()) {
+            VisMF::AsyncWrite(tmpF, prefix);
+        } else {
+            VisMF::Write(tmpF, prefix);
+        }
+    }
+
+    // Constant boxes, written as their valid box followed by the value of each component
+    if (ParallelDescriptor::IOProcessor()) {
+        std::ofstream sparse_file(prefix + "_sparse");
+        sparse_file << ncomp << " " << ng << "\n";
+        sparse_file << std::setprecision(17);
+        for (int ibox = 0; ibox < F.size(); ++ibox) {
+            if (!box_is_constant(ibox)) continue;
+            sparse_file << F.boxArray()[ibox];
+            for (int n = 0; n < ncomp; ++n) {
+                sparse_file << " " << consts[2*(ibox*ncomp + n) + 1];
+            }
+            sparse_file << "\n";
+        }
+    }
+}
+
 /** \brief Write the data from MultiFab `F` into the file `filename`
  *  as a raw field (i.e. no interpolation to cell centers).
  *  Write guard cells if `plot_guards` is True.
+ *  If `sparse` is True, the boxes where `F` is constant are not written as data
+ *  (see WriteSparseRawMF).
  */
 void
 WriteRawMF ( const MultiFab& F, const DistributionMapping& dm,
              const std::string& filename,
              const std::string& level_prefix,
              const std::string& field_name,
-             const int lev, const bool plot_guards )
+             const int lev, const bool plot_guards,
+             const bool sparse = false )
 {
     std::string prefix = amrex::MultiFabFileFullPrefix(lev,
                             filename, level_prefix, field_name);
-    if (plot_guards) {
-        // Dump original MultiFab F
+    if (sparse) {
+        WriteSparseRawMF(F, prefix, plot_guards);
+    } else if (AsyncOut::UseAsyncOut()) {
+        // Stage F into a host buffer (without its guard cells unless requested),
+        // written to file by the I/O thread
+        VisMF::AsyncWrite(F, prefix, !plot_guards);
+    } else if (plot_guards || F.nGrowVect() == IntVect::TheZeroVector()) {
+        // Dump original MultiFab F, without an intermediate copy
         VisMF::Write(F, prefix);
     } else {
         // Copy original MultiFab into one that does not have guard cells
@@ -514,66 +645,68 @@ FlushFormatPlotfile::WriteAllRawFields(
 
         // Auxiliary patch
 
-        WriteRawMF( warpx.getEfield(lev, 0), dm, raw_pltname, default_level_prefix, "Ex_aux", lev, plot_raw_fields_guards);
-        WriteRawMF( warpx.getEfield(lev, 1), dm, raw_pltname, default_level_prefix, "Ey_aux", lev, plot_raw_fields_guards);
-        WriteRawMF( warpx.getEfield(lev, 2), dm, raw_pltname, default_level_prefix, "Ez_aux", lev, plot_raw_fields_guards);
-        WriteRawMF( warpx.getBfield(lev, 0), dm, raw_pltname, default_level_prefix, "Bx_aux", lev, plot_raw_fields_guards);
-        WriteRawMF( warpx.getBfield(lev, 1), dm, raw_pltname, default_level_prefix, "By_aux", lev, plot_raw_fields_guards);
-        WriteRawMF( warpx.getBfield(lev, 2), dm, raw_pltname, default_level_prefix, "Bz_aux", lev, plot_raw_fields_guards);
+        WriteRawMF( warpx.getEfield(lev, 0), dm, raw_pltname, default_level_prefix, "Ex_aux", lev, plot_raw_fields_guards, m_sparse_output);
+        WriteRawMF( warpx.getEfield(lev, 1), dm, raw_pltname, default_level_prefix, "Ey_aux", lev, plot_raw_fields_guards, m_sparse_output);
+        WriteRawMF( warpx.getEfield(lev, 2), dm, raw_pltname, default_level_prefix, "Ez_aux", lev, plot_raw_fields_guards, m_sparse_output);
+        WriteRawMF( warpx.getBfield(lev, 0), dm, raw_pltname, default_level_prefix, "Bx_aux", lev, plot_raw_fields_guards, m_sparse_output);
+        WriteRawMF( warpx.getBfield(lev, 1), dm, raw_pltname, default_level_prefix, "By_aux", lev, plot_raw_fields_guards, m_sparse_output);
+        WriteRawMF( warpx.getBfield(lev, 2), dm, raw_pltname, default_level_prefix, "Bz_aux", lev, plot_raw_fields_guards, m_sparse_output);
 
         // fine patch
-        WriteRawMF( warpx.getEfield_fp(lev, 0), dm, raw_pltname, default_level_prefix, "Ex_fp", lev, plot_raw_fields_guards);
-        WriteRawMF( warpx.getEfield_fp(lev, 1), dm, raw_pltname, default_level_prefix, "Ey_fp", lev, plot_raw_fields_guards);
-        WriteRawMF( warpx.getEfield_fp(lev, 2), dm, raw_pltname, default_level_prefix, "Ez_fp", lev, plot_raw_fields_guards);
-        WriteRawMF( warpx.getcurrent_fp(lev, 0), dm, raw_pltname, default_level_prefix, "jx_fp", lev, plot_raw_fields_guards);
-        WriteRawMF( warpx.getcurrent_fp(lev, 1), dm, raw_pltname, default_level_prefix, "jy_fp", lev, plot_raw_fields_guards);
-        WriteRawMF( warpx.getcurrent_fp(lev, 2), dm, raw_pltname, default_level_prefix, "jz_fp", lev, plot_raw_fields_guards);
-        WriteRawMF( warpx.getBfield_fp(lev, 0), dm, raw_pltname, default_level_prefix, "Bx_fp", lev, plot_raw_fields_guards);
-        WriteRawMF( warpx.getBfield_fp(lev, 1), dm, raw_pltname, default_level_prefix, "By_fp", lev, plot_raw_fields_guards);
-        WriteRawMF( warpx.getBfield_fp(lev, 2), dm, raw_pltname, default_level_prefix, "Bz_fp", lev, plot_raw_fields_guards);
+        WriteRawMF( warpx.getEfield_fp(lev, 0), dm, raw_pltname, default_level_prefix, "Ex_fp", lev, plot_raw_fields_guards, m_sparse_output);
+        WriteRawMF( warpx.getEfield_fp(lev, 1), dm, raw_pltname, default_level_prefix, "Ey_fp", lev, plot_raw_fields_guards, m_sparse_output);
+        WriteRawMF( warpx.getEfield_fp(lev, 2), dm, raw_pltname, default_level_prefix, "Ez_fp", lev, plot_raw_fields_guards, m_sparse_output);
+        WriteRawMF( warpx.getcurrent_fp(lev, 0), dm, raw_pltname, default_level_prefix, "jx_fp", lev, plot_raw_fields_guards, m_sparse_output);
+        WriteRawMF( warpx.getcurrent_fp(lev, 1), dm, raw_pltname, default_level_prefix, "jy_fp", lev, plot_raw_fields_guards, m_sparse_output);
+        WriteRawMF( warpx.getcurrent_fp(lev, 2), dm, raw_pltname, default_level_prefix, "jz_fp", lev, plot_raw_fields_guards, m_sparse_output);
+        WriteRawMF( warpx.getBfield_fp(lev, 0), dm, raw_pltname, default_level_prefix, "Bx_fp", lev, plot_raw_fields_guards, m_sparse_output);
+        WriteRawMF( warpx.getBfield_fp(lev, 1), dm, raw_pltname, default_level_prefix, "By_fp", lev, plot_raw_fields_guards, m_sparse_output);
+        WriteRawMF( warpx.getBfield_fp(lev, 2), dm, raw_pltname, default_level_prefix, "Bz_fp", lev, plot_raw_fields_guards, m_sparse_output);
 #ifdef WARPX_MAG_LLG
-        WriteRawMF( warpx.getHfield_fp(lev, 0), dm, raw_pltname, default_level_prefix, "Hx_fp", lev, plot_raw_fields_guards);
-        WriteRawMF( warpx.getHfield_fp(lev, 1), dm, raw_pltname, default_level_prefix, "Hy_fp", lev, plot_raw_fields_guards);
-        WriteRawMF( warpx.getHfield_fp(lev, 2), dm, raw_pltname, default_level_prefix, "Hz_fp", lev, plot_raw_fields_guards);
-        WriteRawMF( warpx.getMfield_fp(lev, 0), dm, raw_pltname, default_level_prefix, "M_xface_fp", lev, plot_raw_fields_guards);
-        WriteRawMF( warpx.getMfield_fp(lev, 1), dm, raw_pltname, default_level_prefix, "M_yface_fp", lev, plot_raw_fields_guards);
-        WriteRawMF( warpx.getMfield_fp(lev, 2), dm, raw_pltname, default_level_prefix, "M_zface_fp", lev, plot_raw_fields_guards);
+        if (WarpX::mag_LLG) {
+            WriteRawMF( warpx.getHfield_fp(lev, 0), dm, raw_pltname, default_level_prefix, "Hx_fp", lev, plot_raw_fields_guards, m_sparse_output);
+            WriteRawMF( warpx.getHfield_fp(lev, 1), dm, raw_pltname, default_level_prefix, "Hy_fp", lev, plot_raw_fields_guards, m_sparse_output);
+            WriteRawMF( warpx.getHfield_fp(lev, 2), dm, raw_pltname, default_level_prefix, "Hz_fp", lev, plot_raw_fields_guards, m_sparse_output);
+            WriteRawMF( warpx.getMfield_fp(lev, 0), dm, raw_pltname, default_level_prefix, "M_xface_fp", lev, plot_raw_fields_guards, m_sparse_output);
+            WriteRawMF( warpx.getMfield_fp(lev, 1), dm, raw_pltname, default_level_prefix, "M_yface_fp", lev, plot_raw_fields_guards, m_sparse_output);
+            WriteRawMF( warpx.getMfield_fp(lev, 2), dm, raw_pltname, default_level_prefix, "M_zface_fp", lev, plot_raw_fields_guards, m_sparse_output);
+        }
 #endif
         if (warpx.get_pointer_F_fp(lev))
         {
-            WriteRawMF(warpx.getF_fp(lev), dm, raw_pltname, default_level_prefix, "F_fp", lev, plot_raw_fields_guards);
+            WriteRawMF(warpx.getF_fp(lev), dm, raw_pltname, default_level_prefix, "F_fp", lev, plot_raw_fields_guards, m_sparse_output);
         }
         if (warpx.get_pointer_rho_fp(lev))
         {
             // Use the component 1 of `rho_fp`, i.e. rho_new for time synchronization
             // If nComp > 1, this is the upper half of the list of components.
             MultiFab rho_new(warpx.getrho_fp(lev), amrex::make_alias, warpx.getrho_fp(lev).nComp()/2, warpx.getrho_fp(lev).nComp()/2);
-            WriteRawMF(rho_new, dm, raw_pltname, default_level_prefix, "rho_fp", lev, plot_raw_fields_guards);
+            WriteRawMF(rho_new, dm, raw_pltname, default_level_prefix, "rho_fp", lev, plot_raw_fields_guards, m_sparse_output);
         }
         if (warpx.get_pointer_phi_fp(lev) != nullptr) {
-            WriteRawMF(warpx.getphi_fp(lev), dm, raw_pltname, default_level_prefix, "phi_fp", lev, plot_raw_fields_guards);
+            WriteRawMF(warpx.getphi_fp(lev), dm, raw_pltname, default_level_prefix, "phi_fp", lev, plot_raw_fields_guards, m_sparse_output);
         }
 
         // Averaged fields on fine patch
         if (warpx.fft_do_time_averaging)
         {
             WriteRawMF(warpx.getEfield_avg_fp(lev, 0) , dm, raw_pltname, default_level_prefix,
-                       "Ex_avg_fp", lev, plot_raw_fields_guards);
+                       "Ex_avg_fp", lev, plot_raw_fields_guards, m_sparse_output);
 
             WriteRawMF(warpx.getEfield_avg_fp(lev, 1) , dm, raw_pltname, default_level_prefix,
-                       "Ey_avg_fp", lev, plot_raw_fields_guards);
+                       "Ey_avg_fp", lev, plot_raw_fields_guards, m_sparse_output);
 
             WriteRawMF(warpx.getEfield_avg_fp(lev, 2) , dm, raw_pltname, default_level_prefix,
-                       "Ez_avg_fp", lev, plot_raw_fields_guards);
+                       "Ez_avg_fp", lev, plot_raw_fields_guards, m_sparse_output);
 
             WriteRawMF(warpx.getBfield_avg_fp(lev, 0) , dm, raw_pltname, default_level_prefix,
-                       "Bx_avg_fp", lev, plot_raw_fields_guards);
+                       "Bx_avg_fp", lev, plot_raw_fields_guards, m_sparse_output);
 
             WriteRawMF(warpx.getBfield_avg_fp(lev, 1) , dm, raw_pltname, default_level_prefix,
-                       "By_avg_fp", lev, plot_raw_fields_guards);
+                       "By_avg_fp", lev, plot_raw_fields_guards, m_sparse_output);
 
             WriteRawMF(warpx.getBfield_avg_fp(lev, 2) , dm, raw_pltname, default_level_prefix,
-                       "Bz_avg_fp", lev, plot_raw_fields_guards);
+                       "Bz_avg_fp", lev, plot_raw_fields_guards, m_sparse_output);
         }
 
         // Coarse path
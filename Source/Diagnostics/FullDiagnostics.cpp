@@ -1,6 +1,7 @@
 #include "FullDiagnostics.H"
 
 #include "ComputeDiagFunctors/CellCenterFunctor.H"
+#include "ComputeDiagFunctors/ComputeDiagFunctor.H"
 #include "ComputeDiagFunctors/DivBFunctor.H"
 #include "ComputeDiagFunctors/DivEFunctor.H"
 #include "ComputeDiagFunctors/PartPerCellFunctor.H"
@@ -9,7 +10,12 @@
 #include "ComputeDiagFunctors/RhoFunctor.H"
 #include "Diagnostics/Diagnostics.H"
 #include "Diagnostics/ParticleDiag/ParticleDiag.H"
+#include "Diagnostics/ReducedDiags/MultiReducedDiags.H"
 #include "FlushFormats/FlushFormat.H"
+#include "FlushFormats/FlushFormatPlotfile.H"
+#ifdef WARPX_USE_OPENPMD
+#   include "FlushFormats/FlushFormatOpenPMD.H"
+#endif
 #include "Particles/MultiParticleContainer.H"
 #include "Utils/TextMsg.H"
 #include "Utils/WarpXAlgorithmSelection.H"
@@ -21,6 +27,7 @@
 #include <AMReX_BLassert.H>
 #include <AMReX_Box.H>
 #include <AMReX_BoxArray.H>
+#include <AMReX_BoxList.H>
 #include <AMReX_Config.H>
 #include <AMReX_CoordSys.H>
 #include <AMReX_DistributionMapping.H>
@@ -28,21 +35,41 @@
 #include <AMReX_IntVect.H>
 #include <AMReX_MakeType.H>
 #include <AMReX_MultiFab.H>
+#include <AMReX_ParallelDescriptor.H>
 #include <AMReX_ParmParse.H>
 #include <AMReX_REAL.H>
 #include <AMReX_RealBox.H>
+#include <AMReX_Utility.H>
 #include <AMReX_Vector.H>
 
 #include <algorithm>
 #include <cmath>
+#include <fstream>
 #include <memory>
+#include <utility>
 #include <vector>
 
 using namespace amrex::literals;
 
-FullDiagnostics::FullDiagnostics (int i, std::string name)
+namespace
+{
+    /** Whether the field output varname is a material property, constant in time */
+    bool IsStaticField (const std::string& varname)
+    {
+        if (varname == "sigma" || varname == "epsilon" || varname == "mu") return true;
+#ifdef WARPX_MAG_LLG
+        for (const std::string prefix : {"mag_Ms_", "mag_alpha_", "mag_exchange_", "mag_anisotropy_"}) {
+            if (varname.rfind(prefix, 0) == 0) return true;
+        }
+#endif
+        return false;
+    }
+}
+
+FullDiagnostics::FullDiagnostics (int i, std::string name, std::string window_name)
     : Diagnostics(i, name)
 {
+    m_window_name = std::move(window_name);
     ReadParameters();
     BackwardCompatibility();
 }
@@ -86,10 +113,57 @@ FullDiagnostics::ReadParameters ()
         "<diag>.format must be plotfile or openpmd or checkpoint or ascent or sensei");
     std::vector<std::string> intervals_string_vec = {"0"};
     pp_diag_name.getarr("intervals", intervals_string_vec);
+    if (!m_window_name.empty()) {
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(
+            m_format == "plotfile" || m_format == "openpmd",
+            "<diag>.windows is only supported with <diag>.format = plotfile or openpmd");
+        // An output window may be written at its own intervals
+        amrex::ParmParse pp_window(m_diag_name + "." + m_window_name);
+        pp_window.queryarr("intervals", intervals_string_vec);
+    }
     m_intervals = IntervalsParser(intervals_string_vec);
     bool plot_raw_fields_specified = pp_diag_name.query("plot_raw_fields", m_plot_raw_fields);
     bool plot_raw_fields_guards_specified = pp_diag_name.query("plot_raw_fields_guards", m_plot_raw_fields_guards);
-    bool raw_specified = plot_raw_fields_specified || plot_raw_fields_guards_specified;
+    pp_diag_name.query("raw_fields_only", m_raw_fields_only);
+    bool raw_specified = plot_raw_fields_specified || plot_raw_fields_guards_specified
+                         || m_raw_fields_only;
+
+    if (m_raw_fields_only) {
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(
+            m_format == "plotfile" || m_format == "ascent",
+            "<diag>.raw_fields_only is only supported with <diag>.format = plotfile or ascent");
+        m_plot_raw_fields = true;
+        // No cell-centered field is computed: the staggered MultiFabs are written as is
+        m_varnames_fields.clear();
+        m_pfield_varnames.clear();
+        m_pfield_species.clear();
+        m_varnames.clear();
+    }
+
+    pp_diag_name.query("static_fields_once", m_static_fields_once);
+    if (m_static_fields_once) {
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(
+            m_format == "plotfile" || m_format == "openpmd",
+            "<diag>.static_fields_once is only supported with <diag>.format = plotfile or openpmd");
+        // the moving window shifts the material properties, which are then not static
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(!WarpX::do_moving_window,
+            "<diag>.static_fields_once is not supported with the moving window");
+        // The material properties are moved to the static output
+        for (const auto& varname : m_varnames_fields) {
+            if (IsStaticField(varname)) m_static_varnames.push_back(varname);
+        }
+        m_varnames_fields.erase(std::remove_if(m_varnames_fields.begin(), m_varnames_fields.end(),
+                                               IsStaticField), m_varnames_fields.end());
+        m_varnames.erase(std::remove_if(m_varnames.begin(), m_varnames.end(), IsStaticField),
+                         m_varnames.end());
+#ifdef WARPX_DIM_RZ
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(m_format != "openpmd",
+            "<diag>.static_fields_once is not supported with openPMD in RZ");
+#endif
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(
+            !m_varnames.empty() || m_static_varnames.empty() || m_raw_fields_only,
+            "<diag>.static_fields_once requires at least one time-dependent field in <diag>.fields_to_plot");
+    }
 
 #ifdef WARPX_DIM_RZ
     pp_diag_name.query("dump_rz_modes", m_dump_rz_modes);
@@ -128,14 +202,83 @@ FullDiagnostics::Flush ( int i_buffer )
     // is supported for BackTransformed Diagnostics, in BTDiagnostics class.
     auto & warpx = WarpX::GetInstance();
 
+    // A checkpoint holds the reduced diags outputs up to its step, so that a restart
+    // appends to complete files
+    if (m_format == "checkpoint" && warpx.reduced_diags) warpx.reduced_diags->FlushBuffers();
+
+    // ComputeAndPack is skipped in raw mode, but the guard cells of the raw fields
+    // and the particle diagnostic domain must still be up to date
+    if (m_raw_fields_only) PrepareFieldDataForOutput();
+
+    // The static fields are only written at the first dump and after a regrid
+    if (m_write_static && !m_static_varnames.empty()) FlushStaticFields();
+
     m_flush_format->WriteToFile(
         m_varnames, m_mf_output[i_buffer], m_geom_output[i_buffer], warpx.getistep(),
         warpx.gett_new(0), m_output_species[i_buffer], nlev_output, m_file_prefix,
         m_file_min_digits, m_plot_raw_fields, m_plot_raw_fields_guards);
 
+    if (!m_static_varnames.empty()) WriteStaticFieldsReference();
+
     FlushRaw();
 }
 
+void
+FullDiagnostics::FlushStaticFields ()
+{
+    auto & warpx = WarpX::GetInstance();
+    for (int lev = 0; lev < nlev_output; ++lev) {
+        int icomp_dst = 0;
+        for (const auto& functor : m_static_field_functors[lev]) {
+            functor->operator()(m_mf_static[lev], icomp_dst, 0);
+            icomp_dst += functor->nComp();
+        }
+    }
+
+    // The static fields are written as a separate output of the same format,
+    // labelled with the step of the dump where they were written
+    if (!m_static_flush_format) {
+        if (m_format == "plotfile") {
+            m_static_flush_format = std::make_unique<FlushFormatPlotfile>(m_diag_name);
+        } else {
+#ifdef WARPX_USE_OPENPMD
+            m_static_flush_format = std::make_unique<FlushFormatOpenPMD>(m_diag_name);
+#endif
+        }
+    }
+    const std::string static_prefix = m_file_prefix + "_static";
+    const amrex::Vector<ParticleDiag> no_particles;
+    m_static_flush_format->WriteToFile(
+        m_static_varnames, m_mf_static, m_geom_output[0], warpx.getistep(),
+        warpx.gett_new(0), no_particles, nlev_output, static_prefix,
+        m_file_min_digits, false, false);
+
+    if (m_format == "plotfile") {
+        m_static_file_name = amrex::Concatenate(static_prefix, warpx.getistep(0), m_file_min_digits);
+    } else {
+        m_static_file_name = static_prefix + " " + std::to_string(warpx.getistep(0));
+    }
+    m_write_static = false;
+}
+
+void
+FullDiagnostics::WriteStaticFieldsReference () const
+{
+    if (!amrex::ParallelDescriptor::IOProcessor()) return;
+    auto & warpx = WarpX::GetInstance();
+    if (m_format == "plotfile") {
+        // Each plotfile references the static plotfile
+        const std::string filename = amrex::Concatenate(m_file_prefix, warpx.getistep(0), m_file_min_digits);
+        std::ofstream reference_file(filename + "/static_fields");
+        reference_file << m_static_file_name << "\n";
+    } else {
+        // All the iterations of the openPMD series are listed, with the
+        // directory and iteration of the static openPMD series they use
+        std::ofstream reference_file(m_file_prefix + "/static_fields", std::ios::app);
+        reference_file << warpx.getistep(0) << " " << m_static_file_name << "\n";
+    }
+}
+
 void
 FullDiagnostics::FlushRaw () {}
 
@@ -154,6 +297,8 @@ FullDiagnostics::DoDump (int step, int /*i_buffer*/, bool force_flush)
 bool
 FullDiagnostics::DoComputeAndPack (int step, bool force_flush)
 {
+    // In raw mode, the staggered fields are written directly in Flush
+    if (m_raw_fields_only) return false;
     // Data must be computed and packed for full diagnostics
     // whenever the data needs to be flushed.
     if (force_flush || m_intervals.contains(step+1) ){
@@ -510,24 +655,38 @@ FullDiagnostics::InitializeBufferData (int i_buffer, int lev ) {
             }
         }
 
-        // Box for the output MultiFab corresponding to the user-defined physical co-ordinates at lev.
+        // Box for the output MultiFab corresponding to the user-defined physical co-ordinates at lev,
+        // extended so that it is coarsenable with the coarsening ratio.
         amrex::Box diag_box( lo, hi );
-        // Define box array
-        amrex::BoxArray diag_ba;
-        diag_ba.define(diag_box);
-        ba = diag_ba.maxSize( warpx.maxGridSize( lev ) );
+        diag_box.coarsen(m_crse_ratio).refine(m_crse_ratio);
+        diag_box &= warpx.Geom(lev).Domain();
+        // The output boxes are the intersections of the simulation boxes with diag_box, kept
+        // on the ranks that own them: only these ranks compute and write the output, and
+        // the fields are not communicated to gather the output.
         // At this point in the code, the BoxArray, ba, is defined with the same index space and
         // resolution as the simulation, at level, lev.
-        // Coarsen and refine so that the new BoxArray is coarsenable.
-        ba.coarsen(m_crse_ratio).refine(m_crse_ratio);
+        amrex::BoxList diag_bl;
+        amrex::Vector<int> diag_pmap;
+        for (int ibox = 0; ibox < static_cast<int>(ba.size()); ++ibox) {
+            const amrex::Box isect = ba[ibox] & diag_box;
+            if (isect.ok()) {
+                diag_bl.push_back(isect);
+                diag_pmap.push_back(dmap[ibox]);
+            }
+        }
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(!diag_bl.isEmpty(),
+            "The domain of diagnostics " + m_diag_name + " does not intersect the simulation domain");
+        ba = amrex::BoxArray(diag_bl);
+        dmap = amrex::DistributionMapping(std::move(diag_pmap));
 
         // Update the physical co-ordinates m_lo and m_hi using the final index values
         // from the coarsenable, cell-centered BoxArray, ba.
+        const amrex::Box diag_domain = ba.minimalBox();
         for ( int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
             diag_dom.setLo( idim, warpx.Geom(lev).ProbLo(idim) +
-                ba.getCellCenteredBox(0).smallEnd(idim) * warpx.Geom(lev).CellSize(idim));
+                diag_domain.smallEnd(idim) * warpx.Geom(lev).CellSize(idim));
             diag_dom.setHi( idim, warpx.Geom(lev).ProbLo(idim) +
-                (ba.getCellCenteredBox( static_cast<int>(ba.size())-1 ).bigEnd(idim) + 1) * warpx.Geom(lev).CellSize(idim));
+                (diag_domain.bigEnd(idim) + 1) * warpx.Geom(lev).CellSize(idim));
         }
     }
 
@@ -535,13 +694,17 @@ FullDiagnostics::InitializeBufferData (int i_buffer, int lev ) {
         m_crse_ratio.min() > 0, "Coarsening ratio must be non-zero.");
     // The BoxArray is coarsened based on the user-defined coarsening ratio.
     ba.coarsen(m_crse_ratio);
-    // Generate a new distribution map if the physical m_lo and m_hi for the output
-    // is different from the lo and hi physical co-ordinates of the simulation domain.
-    if (use_warpxba == false) dmap = amrex::DistributionMapping{ba};
     // Allocate output MultiFab for diagnostics. The data will be stored at cell-centers.
     int ngrow = (m_format == "sensei" || m_format == "ascent") ? 1 : 0;
     // The zero is hard-coded since the number of output buffers = 1 for FullDiagnostics
-    m_mf_output[i_buffer][lev] = amrex::MultiFab(ba, dmap, static_cast<int>(m_varnames.size()), ngrow);
+    // In raw mode, no cell-centered output is allocated.
+    if (!m_raw_fields_only) {
+        m_mf_output[i_buffer][lev] = amrex::MultiFab(ba, dmap, static_cast<int>(m_varnames.size()), ngrow);
+    }
+    if (!m_static_varnames.empty()) {
+        m_mf_static.resize(nmax_lev);
+        m_mf_static[lev] = amrex::MultiFab(ba, dmap, static_cast<int>(m_static_varnames.size()), ngrow);
+    }
 
 
     if (lev == 0) {
@@ -578,6 +741,16 @@ FullDiagnostics::InitializeFieldFunctors (int lev)
     // Clear any pre-existing vector to release stored data.
     m_all_field_functors[lev].clear();
 
+    // The static fields are (re)written at the next dump, e.g. after a regrid
+    if (!m_static_varnames.empty()) {
+        m_static_field_functors.resize(nmax_lev);
+        m_static_field_functors[lev].clear();
+        for (const auto& varname : m_static_varnames) {
+            m_static_field_functors[lev].push_back(StaticFieldFunctor(varname, lev));
+        }
+        m_write_static = true;
+    }
+
     // Species index to loop over species that dump rho per species
     int i = 0;
 
@@ -657,53 +830,8 @@ FullDiagnostics::InitializeFieldFunctors (int lev)
             m_all_field_functors[lev][comp] = std::make_unique<DivBFunctor>(warpx.get_array_Bfield_aux(lev), lev, m_crse_ratio);
         } else if ( m_varnames[comp] == "divE" ){
             m_all_field_functors[lev][comp] = std::make_unique<DivEFunctor>(warpx.get_array_Efield_aux(lev), lev, m_crse_ratio);
-        } else if ( m_varnames[comp] == "sigma" ){
-            MacroscopicProperties& macroscopic = warpx.GetMacroscopicProperties();
-            m_all_field_functors[lev][comp] = std::make_unique<CellCenterFunctor>(macroscopic.get_pointer_sigma(), lev, m_crse_ratio);
-        } else if ( m_varnames[comp] == "epsilon" ){
-            MacroscopicProperties& macroscopic = warpx.GetMacroscopicProperties();
-            m_all_field_functors[lev][comp] = std::make_unique<CellCenterFunctor>(macroscopic.get_pointer_eps(), lev, m_crse_ratio);
-        } else if ( m_varnames[comp] == "mu" ){
-            MacroscopicProperties& macroscopic = warpx.GetMacroscopicProperties();
-            m_all_field_functors[lev][comp] = std::make_unique<CellCenterFunctor>(macroscopic.get_pointer_mu(), lev, m_crse_ratio);
-#ifdef WARPX_MAG_LLG
-        } else if (m_varnames[comp] == "mag_Ms_xface" ){
-            MacroscopicProperties& macroscopic = warpx.GetMacroscopicProperties();
-            m_all_field_functors[lev][comp] = std::make_unique<CellCenterFunctor>(macroscopic.getmag_pointer_Ms(0), lev, m_crse_ratio);
-        } else if (m_varnames[comp] == "mag_Ms_yface" ){
-            MacroscopicProperties& macroscopic = warpx.GetMacroscopicProperties();
-            m_all_field_functors[lev][comp] = std::make_unique<CellCenterFunctor>(macroscopic.getmag_pointer_Ms(1), lev, m_crse_ratio);
-        } else if (m_varnames[comp] == "mag_Ms_zface" ){
-            MacroscopicProperties& macroscopic = warpx.GetMacroscopicProperties();
-            m_all_field_functors[lev][comp] = std::make_unique<CellCenterFunctor>(macroscopic.getmag_pointer_Ms(2), lev, m_crse_ratio);
-        } else if (m_varnames[comp] == "mag_alpha_xface" ){
-            MacroscopicProperties& macroscopic = warpx.GetMacroscopicProperties();
-            m_all_field_functors[lev][comp] = std::make_unique<CellCenterFunctor>(macroscopic.getmag_pointer_alpha(0), lev, m_crse_ratio);
-        } else if (m_varnames[comp] == "mag_alpha_yface" ){
-            MacroscopicProperties& macroscopic = warpx.GetMacroscopicProperties();
-            m_all_field_functors[lev][comp] = std::make_unique<CellCenterFunctor>(macroscopic.getmag_pointer_alpha(1), lev, m_crse_ratio);
-        } else if (m_varnames[comp] == "mag_alpha_zface" ){
-            MacroscopicProperties& macroscopic = warpx.GetMacroscopicProperties();
-            m_all_field_functors[lev][comp] = std::make_unique<CellCenterFunctor>(macroscopic.getmag_pointer_alpha(2), lev, m_crse_ratio);
-        } else if (m_varnames[comp] == "mag_exchange_xface" ){
-            MacroscopicProperties& macroscopic = warpx.GetMacroscopicProperties();
-            m_all_field_functors[lev][comp] = std::make_unique<CellCenterFunctor>(macroscopic.getmag_pointer_exchange(0), lev, m_crse_ratio);
-        } else if (m_varnames[comp] == "mag_exchange_yface" ){
-            MacroscopicProperties& macroscopic = warpx.GetMacroscopicProperties();
-            m_all_field_functors[lev][comp] = std::make_unique<CellCenterFunctor>(macroscopic.getmag_pointer_exchange(1), lev, m_crse_ratio);
-        } else if (m_varnames[comp] == "mag_exchange_zface" ){
-            MacroscopicProperties& macroscopic = warpx.GetMacroscopicProperties();
-            m_all_field_functors[lev][comp] = std::make_unique<CellCenterFunctor>(macroscopic.getmag_pointer_exchange(2), lev, m_crse_ratio);
-        } else if (m_varnames[comp] == "mag_anisotropy_xface" ){
-            MacroscopicProperties& macroscopic = warpx.GetMacroscopicProperties();
-            m_all_field_functors[lev][comp] = std::make_unique<CellCenterFunctor>(macroscopic.getmag_pointer_anisotropy(0), lev, m_crse_ratio);
-        } else if (m_varnames[comp] == "mag_anisotropy_yface" ){
-            MacroscopicProperties& macroscopic = warpx.GetMacroscopicProperties();
-            m_all_field_functors[lev][comp] = std::make_unique<CellCenterFunctor>(macroscopic.getmag_pointer_anisotropy(1), lev, m_crse_ratio);
-        } else if (m_varnames[comp] == "mag_anisotropy_zface" ){
-            MacroscopicProperties& macroscopic = warpx.GetMacroscopicProperties();
-            m_all_field_functors[lev][comp] = std::make_unique<CellCenterFunctor>(macroscopic.getmag_pointer_anisotropy(2), lev, m_crse_ratio);
-#endif
+        } else if ( IsStaticField(m_varnames[comp]) ){
+            m_all_field_functors[lev][comp] = StaticFieldFunctor(m_varnames[comp], lev);
         }
         else {
             amrex::Abort(Utils::TextMsg::Err(m_varnames[comp] + " is not a known field output type"));
@@ -722,6 +850,48 @@ FullDiagnostics::InitializeFieldFunctors (int lev)
 }
 
 
+std::unique_ptr<ComputeDiagFunctor>
+FullDiagnostics::StaticFieldFunctor (const std::string& varname, int lev)
+{
+    auto & warpx = WarpX::GetInstance();
+    MacroscopicProperties& macroscopic = warpx.GetMacroscopicProperties(lev);
+    if ( varname == "sigma" ){
+        return std::make_unique<CellCenterFunctor>(macroscopic.get_pointer_sigma(), lev, m_crse_ratio);
+    } else if ( varname == "epsilon" ){
+        return std::make_unique<CellCenterFunctor>(macroscopic.get_pointer_eps(), lev, m_crse_ratio);
+    } else if ( varname == "mu" ){
+        return std::make_unique<CellCenterFunctor>(macroscopic.get_pointer_mu(), lev, m_crse_ratio);
+#ifdef WARPX_MAG_LLG
+    } else if (varname == "mag_Ms_xface" ){
+        return std::make_unique<CellCenterFunctor>(macroscopic.getmag_pointer_Ms(0), lev, m_crse_ratio);
+    } else if (varname == "mag_Ms_yface" ){
+        return std::make_unique<CellCenterFunctor>(macroscopic.getmag_pointer_Ms(1), lev, m_crse_ratio);
+    } else if (varname == "mag_Ms_zface" ){
+        return std::make_unique<CellCenterFunctor>(macroscopic.getmag_pointer_Ms(2), lev, m_crse_ratio);
+    } else if (varname == "mag_alpha_xface" ){
+        return std::make_unique<CellCenterFunctor>(macroscopic.getmag_pointer_alpha(0), lev, m_crse_ratio);
+    } else if (varname == "mag_alpha_yface" ){
+        return std::make_unique<CellCenterFunctor>(macroscopic.getmag_pointer_alpha(1), lev, m_crse_ratio);
+    } else if (varname == "mag_alpha_zface" ){
+        return std::make_unique<CellCenterFunctor>(macroscopic.getmag_pointer_alpha(2), lev, m_crse_ratio);
+    } else if (varname == "mag_exchange_xface" ){
+        return std::make_unique<CellCenterFunctor>(macroscopic.getmag_pointer_exchange(0), lev, m_crse_ratio);
+    } else if (varname == "mag_exchange_yface" ){
+        return std::make_unique<CellCenterFunctor>(macroscopic.getmag_pointer_exchange(1), lev, m_crse_ratio);
+    } else if (varname == "mag_exchange_zface" ){
+        return std::make_unique<CellCenterFunctor>(macroscopic.getmag_pointer_exchange(2), lev, m_crse_ratio);
+    } else if (varname == "mag_anisotropy_xface" ){
+        return std::make_unique<CellCenterFunctor>(macroscopic.getmag_pointer_anisotropy(0), lev, m_crse_ratio);
+    } else if (varname == "mag_anisotropy_yface" ){
+        return std::make_unique<CellCenterFunctor>(macroscopic.getmag_pointer_anisotropy(1), lev, m_crse_ratio);
+    } else if (varname == "mag_anisotropy_zface" ){
+        return std::make_unique<CellCenterFunctor>(macroscopic.getmag_pointer_anisotropy(2), lev, m_crse_ratio);
+#endif
+    }
+    amrex::Abort(Utils::TextMsg::Err(varname + " is not a static field output type"));
+    return nullptr;
+}
+
 void
 FullDiagnostics::PrepareFieldDataForOutput ()
 {
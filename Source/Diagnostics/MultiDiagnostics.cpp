@@ -1,6 +1,7 @@
 #include "MultiDiagnostics.H"
 
 #include "Diagnostics/BTDiagnostics.H"
+#include "Diagnostics/DFTDiagnostics.H"
 #include "Diagnostics/FullDiagnostics.H"
 #include "Utils/TextMsg.H"
 
@@ -21,12 +22,18 @@ MultiDiagnostics::MultiDiagnostics ()
     alldiags.resize( ndiags );
     for (int i=0; i<ndiags; i++){
         if ( diags_types[i] == DiagTypes::Full ){
-            alldiags[i] = std::make_unique<FullDiagnostics>(i, diags_names[i]);
+            alldiags[i] = std::make_unique<FullDiagnostics>(i, diags_names[i], diags_windows[i]);
         } else if ( diags_types[i] == DiagTypes::BackTransformed ){
 #ifdef WARPX_DIM_RZ
             amrex::Abort(Utils::TextMsg::Err("BackTransformed diagnostics is currently not supported for RZ"));
 #else
             alldiags[i] = std::make_unique<BTDiagnostics>(i, diags_names[i]);
+#endif
+        } else if ( diags_types[i] == DiagTypes::DFT ){
+#ifdef WARPX_DIM_RZ
+            amrex::Abort(Utils::TextMsg::Err("DFT diagnostics is currently not supported for RZ"));
+#else
+            alldiags[i] = std::make_unique<DFTDiagnostics>(i, diags_names[i]);
 #endif
         } else {
             amrex::Abort(Utils::TextMsg::Err("Unknown diagnostic type"));
@@ -37,6 +44,7 @@ MultiDiagnostics::MultiDiagnostics ()
 void
 MultiDiagnostics::InitData ()
 {
+    m_initialized = true;
     for( auto& diag : alldiags ){
         diag->InitData();
     }
@@ -45,6 +53,8 @@ MultiDiagnostics::InitData ()
 void
 MultiDiagnostics::InitializeFieldFunctors ( int lev )
 {
+    // The functors are initialized by InitData, e.g. when a level is remade at restart before
+    if (!m_initialized) return;
     for( auto& diag : alldiags ){
         // Initialize functors to store pointers to fields.
         diag->InitializeFieldFunctors( lev );
@@ -70,7 +80,27 @@ MultiDiagnostics::ReadParameters ()
         pp_diag_name.get("diag_type", diag_type_str);
         if (diag_type_str == "Full") diags_types[i] = DiagTypes::Full;
         if (diag_type_str == "BackTransformed") diags_types[i] = DiagTypes::BackTransformed;
+        if (diag_type_str == "DFT") diags_types[i] = DiagTypes::DFT;
+    }
+
+    // Each named output window of a full diagnostics is an additional full diagnostics,
+    // with the same name and the window-specific parameters <diag>.<window>.*
+    diags_windows.resize( ndiags );
+    const int ndiags_main = ndiags;
+    for (int i=0; i<ndiags_main; i++){
+        ParmParse pp_diag_name(diags_names[i]);
+        std::vector<std::string> windows;
+        if (!pp_diag_name.queryarr("windows", windows)) continue;
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(
+            diags_types[i] == DiagTypes::Full,
+            "<diag>.windows is only supported for Full diagnostics");
+        for (const auto& window : windows) {
+            diags_names.push_back(diags_names[i]);
+            diags_types.push_back(DiagTypes::Full);
+            diags_windows.push_back(window);
+        }
     }
+    ndiags = static_cast<int>(diags_names.size());
 }
 
 void
@@ -11,17 +11,30 @@
 #include "Utils/IntervalsParser.H"
 #include "Utils/TextMsg.H"
 #include "Utils/WarpXConst.H"
+#include "Utils/WarpXUtil.H"
 #include "WarpX.H"
 
+#include <AMReX_Array4.H>
+#include <AMReX_Box.H>
 #include <AMReX_Config.H>
 #include <AMReX_Geometry.H>
+#include <AMReX_GpuControl.H>
+#include <AMReX_GpuQualifiers.H>
+#include <AMReX_IntVect.H>
+#include <AMReX_MFIter.H>
 #include <AMReX_MultiFab.H>
 #include <AMReX_ParallelDescriptor.H>
 #include <AMReX_ParmParse.H>
+#include <AMReX_Print.H>
 #include <AMReX_REAL.H>
+#include <AMReX_Reduce.H>
+#include <AMReX_Tuple.H>
+#include <AMReX_iMultiFab.H>
 
 #include <algorithm>
+#include <cmath>
 #include <fstream>
+#include <string>
 #include <vector>
 
 using namespace amrex;
@@ -46,6 +59,16 @@ FieldEnergy::FieldEnergy (std::string rd_name)
     // resize data array
     m_data.resize(noutputs*nLevel, 0.0_rt);
 
+    // read the optional stopping criterion on the decay of the field energy
+    ParmParse pp_rd_name(m_rd_name);
+    queryWithParser(pp_rd_name, "stop_energy_decay_db", m_stop_energy_decay_db);
+    queryWithParser(pp_rd_name, "stop_min_time", m_stop_min_time);
+    pp_rd_name.query("stop_window", m_stop_window);
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(m_stop_energy_decay_db >= 0._rt,
+        m_rd_name + ".stop_energy_decay_db must be non-negative");
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(m_stop_window >= 1,
+        m_rd_name + ".stop_window must be at least 1");
+
     if (ParallelDescriptor::IOProcessor())
     {
         if ( m_IsNotRestart )
@@ -108,24 +131,18 @@ void FieldEnergy::ComputeDiags (int step)
         auto dV = geom.CellSize(0) * geom.CellSize(1) * geom.CellSize(2);
 #endif
 
-        // compute E squared
-        Real const tmpEx = Ex.norm2(0,geom.periodicity());
-        Real const tmpEy = Ey.norm2(0,geom.periodicity());
-        Real const tmpEz = Ez.norm2(0,geom.periodicity());
-        Real const Es = tmpEx*tmpEx + tmpEy*tmpEy + tmpEz*tmpEz;
-
-        // compute B squared
-        Real const tmpBx = Bx.norm2(0,geom.periodicity());
-        Real const tmpBy = By.norm2(0,geom.periodicity());
-        Real const tmpBz = Bz.norm2(0,geom.periodicity());
-        Real const Bs = tmpBx*tmpBx + tmpBy*tmpBy + tmpBz*tmpBz;
+        // compute E squared and B squared in a single pass over the fields
+        amrex::GpuArray<MultiFab const*, 6> const fields{&Ex, &Ey, &Ez, &Bx, &By, &Bz};
+        auto const squares = SumSquares(lev, fields, geom.periodicity());
+        Real const Es = squares[0];
+        Real const Bs = squares[1];
 
         constexpr int noutputs = 3; // total energy, E-field energy and B-field energy
         constexpr int index_total = 0;
         constexpr int index_E = 1;
         constexpr int index_B = 2;
 
-        // save data
+        // save data (local to this rank until the MPI reduction below)
         m_data[lev*noutputs+index_E] = 0.5_rt * Es * PhysConst::ep0 * dV;
         m_data[lev*noutputs+index_B] = 0.5_rt * Bs / PhysConst::mu0 * dV;
         m_data[lev*noutputs+index_total] = m_data[lev*noutputs+index_E] +
@@ -133,13 +150,98 @@ void FieldEnergy::ComputeDiags (int step)
     }
     // end loop over refinement levels
 
-    /* m_data now contains up-to-date values for:
-     *  [total field energy at level 0,
-     *   electric field energy at level 0,
-     *   magnetic field energy at level 0,
-     *   total field energy at level 1,
-     *   electric field energy at level 1,
-     *   magnetic field energy at level 1,
-     *   ......] */
+    // MPI reduce of all the levels at once
+    constexpr int noutputs = 3;
+    ParallelReduce(ReductionBatch::Op::Sum, m_data.data(), noutputs*nLevel, [this, nLevel] ()
+    {
+        /* m_data now contains up-to-date values for:
+         *  [total field energy at level 0,
+         *   electric field energy at level 0,
+         *   magnetic field energy at level 0,
+         *   total field energy at level 1,
+         *   electric field energy at level 1,
+         *   magnetic field energy at level 1,
+         *   ......] */
+
+        if (m_stop_energy_decay_db > 0._rt)
+        {
+            Real total = 0._rt;
+            for (int lev = 0; lev < nLevel; ++lev) {
+                total += m_data[lev*noutputs];
+            }
+            m_peak_energy = std::max(m_peak_energy, total);
+
+            // the energy has rung down when it is below peak * 10^(-dB/10)
+            const Real threshold = m_peak_energy * std::pow(10._rt, -m_stop_energy_decay_db/10._rt);
+            const bool decayed = WarpX::GetInstance().gett_new(0) >= m_stop_min_time && m_peak_energy > 0._rt
+                                 && total <= threshold;
+            m_num_decayed = decayed ? m_num_decayed + 1 : 0;
+            if (m_num_decayed >= m_stop_window) {
+                amrex::Print() << Utils::TextMsg::Info(
+                    m_rd_name + ": the field energy has decayed by "
+                    + std::to_string(m_stop_energy_decay_db) + " dB, stopping the simulation");
+                WarpX::GetInstance().RequestEarlyStop();
+            }
+        }
+    });
 }
 // end void FieldEnergy::ComputeDiags
+
+amrex::GpuArray<Real, 2>
+FieldEnergy::SumSquares (int lev, amrex::GpuArray<MultiFab const*, 6> const& fields,
+                         Periodicity const& period)
+{
+    if (static_cast<int>(m_owner_masks.size()) <= lev) m_owner_masks.resize(lev+1);
+
+    // the points shared by several boxes are only counted by their owner,
+    // the masks are rebuilt when the grids change
+    amrex::GpuArray<amrex::IntVect, 6> ixtype;
+    for (int c = 0; c < 6; ++c) {
+        MultiFab const& mf = *fields[c];
+        ixtype[c] = mf.ixType().toIntVect();
+        auto& mask = m_owner_masks[lev][c];
+        if (mf.ixType().cellCentered()) {
+            mask.reset();
+        } else if (!mask || mask->boxArray() != mf.boxArray() ||
+                   mask->DistributionMap() != mf.DistributionMap()) {
+            mask = mf.OwnerMask(period);
+        }
+    }
+
+    ReduceOps<ReduceOpSum, ReduceOpSum> reduce_op;
+    ReduceData<Real, Real> reduce_data(reduce_op);
+    using ReduceTuple = typename decltype(reduce_data)::Type;
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#endif
+    for ( MFIter mfi(*fields[0], TilingIfNotGPU()); mfi.isValid(); ++mfi )
+    {
+        amrex::GpuArray<amrex::Box, 6> tbx;
+        amrex::GpuArray<amrex::Array4<Real const>, 6> arr;
+        amrex::GpuArray<amrex::Array4<int const>, 6> msk;
+        for (int c = 0; c < 6; ++c) {
+            tbx[c] = mfi.tilebox(ixtype[c]);
+            arr[c] = fields[c]->const_array(mfi);
+            auto const& mask = m_owner_masks[lev][c];
+            msk[c] = mask ? mask->const_array(mfi) : amrex::Array4<int const>();
+        }
+        const Box& box = mfi.tilebox(amrex::IntVect::TheNodeVector());
+
+        reduce_op.eval(box, reduce_data,
+        [=] AMREX_GPU_DEVICE (int i, int j, int k) -> ReduceTuple
+        {
+            Real sq[2] = {0._rt, 0._rt};
+            for (int c = 0; c < 6; ++c) {
+                if (!tbx[c].contains(i,j,k)) continue;
+                if (msk[c].p != nullptr && !msk[c](i,j,k)) continue;
+                const Real f = arr[c](i,j,k);
+                sq[c/3] += f*f;
+            }
+            return {sq[0], sq[1]};
+        });
+    }
+
+    auto const r = reduce_data.value();
+    return {amrex::get<0>(r), amrex::get<1>(r)};
+}
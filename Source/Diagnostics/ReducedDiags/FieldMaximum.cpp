@@ -110,6 +110,16 @@ void FieldMaximum::ComputeDiags (int step)
     // get number of level
     const auto nLevel = warpx.finestLevel() + 1;
 
+    constexpr int noutputs = 8; // max of Ex,Ey,Ez,|E|,Bx,By,Bz and |B|
+    constexpr int index_Ex = 0;
+    constexpr int index_Ey = 1;
+    constexpr int index_Ez = 2;
+    constexpr int index_absE = 3;
+    constexpr int index_Bx = 4;
+    constexpr int index_By = 5;
+    constexpr int index_Bz = 6;
+    constexpr int index_absB = 7;
+
     // loop over refinement levels
     for (int lev = 0; lev < nLevel; ++lev)
     {
@@ -121,40 +131,17 @@ void FieldMaximum::ComputeDiags (int step)
         const MultiFab & By = warpx.getBfield(lev,1);
         const MultiFab & Bz = warpx.getBfield(lev,2);
 
-        constexpr int noutputs = 8; // max of Ex,Ey,Ez,|E|,Bx,By,Bz and |B|
-        constexpr int index_Ex = 0;
-        constexpr int index_Ey = 1;
-        constexpr int index_Ez = 2;
-        constexpr int index_absE = 3;
-        constexpr int index_Bx = 4;
-        constexpr int index_By = 5;
-        constexpr int index_Bz = 6;
-        constexpr int index_absB = 7;
-
         // General preparation of interpolation and reduction operations
         const GpuArray<int,3> cellCenteredtype{0,0,0};
         const GpuArray<int,3> reduction_coarsening_ratio{1,1,1};
         constexpr int reduction_comp = 0;
 
-        ReduceOps<ReduceOpMax> reduceEx_op;
-        ReduceOps<ReduceOpMax> reduceEy_op;
-        ReduceOps<ReduceOpMax> reduceEz_op;
-        ReduceOps<ReduceOpMax> reduceBx_op;
-        ReduceOps<ReduceOpMax> reduceBy_op;
-        ReduceOps<ReduceOpMax> reduceBz_op;
-        ReduceOps<ReduceOpMax> reduceE_op;
-        ReduceOps<ReduceOpMax> reduceB_op;
-
-        ReduceData<Real> reduceEx_data(reduceEx_op);
-        ReduceData<Real> reduceEy_data(reduceEy_op);
-        ReduceData<Real> reduceEz_data(reduceEz_op);
-        ReduceData<Real> reduceBx_data(reduceBx_op);
-        ReduceData<Real> reduceBy_data(reduceBy_op);
-        ReduceData<Real> reduceBz_data(reduceBz_op);
-        ReduceData<Real> reduceE_data(reduceE_op);
-        ReduceData<Real> reduceB_data(reduceB_op);
+        // all the maxima are computed in a single pass over the fields
+        ReduceOps<ReduceOpMax, ReduceOpMax, ReduceOpMax, ReduceOpMax,
+                  ReduceOpMax, ReduceOpMax, ReduceOpMax, ReduceOpMax> reduce_op;
+        ReduceData<Real, Real, Real, Real, Real, Real, Real, Real> reduce_data(reduce_op);
 
-        using ReduceTuple = typename decltype(reduceEx_data)::Type;
+        using ReduceTuple = typename decltype(reduce_data)::Type;
 
         // Prepare interpolation of field components to cell center
         // The arrays below store the index type (staggering) of each MultiFab, with the third
@@ -190,49 +177,7 @@ void FieldMaximum::ComputeDiags (int step)
             const auto& arrBy = By[mfi].array();
             const auto& arrBz = Bz[mfi].array();
 
-            reduceEx_op.eval(box, reduceEx_data,
-            [=] AMREX_GPU_DEVICE (int i, int j, int k) -> ReduceTuple
-            {
-                const Real Ex_interp = CoarsenIO::Interp(arrEx, Extype, cellCenteredtype,
-                                        reduction_coarsening_ratio, i, j, k, reduction_comp);
-                return amrex::Math::abs(Ex_interp);
-            });
-            reduceEy_op.eval(box, reduceEy_data,
-            [=] AMREX_GPU_DEVICE (int i, int j, int k) -> ReduceTuple
-            {
-                const Real Ey_interp = CoarsenIO::Interp(arrEy, Eytype, cellCenteredtype,
-                                        reduction_coarsening_ratio, i, j, k, reduction_comp);
-                return amrex::Math::abs(Ey_interp);
-            });
-            reduceEz_op.eval(box, reduceEz_data,
-            [=] AMREX_GPU_DEVICE (int i, int j, int k) -> ReduceTuple
-            {
-                const Real Ez_interp = CoarsenIO::Interp(arrEz, Eztype, cellCenteredtype,
-                                        reduction_coarsening_ratio, i, j, k, reduction_comp);
-                return amrex::Math::abs(Ez_interp);
-            });
-            reduceBx_op.eval(box, reduceBx_data,
-            [=] AMREX_GPU_DEVICE (int i, int j, int k) -> ReduceTuple
-            {
-                const Real Bx_interp = CoarsenIO::Interp(arrBx, Bxtype, cellCenteredtype,
-                                        reduction_coarsening_ratio, i, j, k, reduction_comp);
-                return amrex::Math::abs(Bx_interp);
-            });
-            reduceBy_op.eval(box, reduceBy_data,
-            [=] AMREX_GPU_DEVICE (int i, int j, int k) -> ReduceTuple
-            {
-                const Real By_interp = CoarsenIO::Interp(arrBy, Bytype, cellCenteredtype,
-                                        reduction_coarsening_ratio, i, j, k, reduction_comp);
-                return amrex::Math::abs(By_interp);
-            });
-            reduceBz_op.eval(box, reduceBz_data,
-            [=] AMREX_GPU_DEVICE (int i, int j, int k) -> ReduceTuple
-            {
-                const Real Bz_interp = CoarsenIO::Interp(arrBz, Bztype, cellCenteredtype,
-                                        reduction_coarsening_ratio, i, j, k, reduction_comp);
-                return amrex::Math::abs(Bz_interp);
-            });
-            reduceE_op.eval(box, reduceE_data,
+            reduce_op.eval(box, reduce_data,
             [=] AMREX_GPU_DEVICE (int i, int j, int k) -> ReduceTuple
             {
                 const Real Ex_interp = CoarsenIO::Interp(arrEx, Extype, cellCenteredtype,
@@ -241,54 +186,48 @@ void FieldMaximum::ComputeDiags (int step)
                                         reduction_coarsening_ratio, i, j, k, reduction_comp);
                 const Real Ez_interp = CoarsenIO::Interp(arrEz, Eztype, cellCenteredtype,
                                         reduction_coarsening_ratio, i, j, k, reduction_comp);
-                return Ex_interp*Ex_interp + Ey_interp*Ey_interp + Ez_interp*Ez_interp;
-            });
-            reduceB_op.eval(box, reduceB_data,
-            [=] AMREX_GPU_DEVICE (int i, int j, int k) -> ReduceTuple
-            {
                 const Real Bx_interp = CoarsenIO::Interp(arrBx, Bxtype, cellCenteredtype,
                                         reduction_coarsening_ratio, i, j, k, reduction_comp);
                 const Real By_interp = CoarsenIO::Interp(arrBy, Bytype, cellCenteredtype,
                                         reduction_coarsening_ratio, i, j, k, reduction_comp);
                 const Real Bz_interp = CoarsenIO::Interp(arrBz, Bztype, cellCenteredtype,
                                         reduction_coarsening_ratio, i, j, k, reduction_comp);
-                return Bx_interp*Bx_interp + By_interp*By_interp + Bz_interp*Bz_interp;
+                return {amrex::Math::abs(Ex_interp),
+                        amrex::Math::abs(Ey_interp),
+                        amrex::Math::abs(Ez_interp),
+                        Ex_interp*Ex_interp + Ey_interp*Ey_interp + Ez_interp*Ez_interp,
+                        amrex::Math::abs(Bx_interp),
+                        amrex::Math::abs(By_interp),
+                        amrex::Math::abs(Bz_interp),
+                        Bx_interp*Bx_interp + By_interp*By_interp + Bz_interp*Bz_interp};
             });
         }
 
-        Real hv_Ex = amrex::get<0>(reduceEx_data.value()); // highest value of |Ex|
-        Real hv_Ey = amrex::get<0>(reduceEy_data.value()); // highest value of |Ey|
-        Real hv_Ez = amrex::get<0>(reduceEz_data.value()); // highest value of |Ez|
-        Real hv_Bx = amrex::get<0>(reduceBx_data.value()); // highest value of |Bx|
-        Real hv_By = amrex::get<0>(reduceBy_data.value()); // highest value of |By|
-        Real hv_Bz = amrex::get<0>(reduceBz_data.value()); // highest value of |Bz|
-        Real hv_E = amrex::get<0>(reduceE_data.value()); // highest value of |E|**2
-        Real hv_B = amrex::get<0>(reduceB_data.value()); // highest value of |B|**2
-
-        // MPI reduce
-        ParallelDescriptor::ReduceRealMax(hv_Ex);
-        ParallelDescriptor::ReduceRealMax(hv_Ey);
-        ParallelDescriptor::ReduceRealMax(hv_Ez);
-        ParallelDescriptor::ReduceRealMax(hv_Bx);
-        ParallelDescriptor::ReduceRealMax(hv_By);
-        ParallelDescriptor::ReduceRealMax(hv_Bz);
-        ParallelDescriptor::ReduceRealMax(hv_E);
-        ParallelDescriptor::ReduceRealMax(hv_B);
-
-        // Fill output array
-        m_data[lev*noutputs+index_Ex] = hv_Ex;
-        m_data[lev*noutputs+index_Ey] = hv_Ey;
-        m_data[lev*noutputs+index_Ez] = hv_Ez;
-        m_data[lev*noutputs+index_Bx] = hv_Bx;
-        m_data[lev*noutputs+index_By] = hv_By;
-        m_data[lev*noutputs+index_Bz] = hv_Bz;
-        m_data[lev*noutputs+index_absE] = std::sqrt(hv_E);
-        m_data[lev*noutputs+index_absB] = std::sqrt(hv_B);
+        // Fill output array, with |E|**2 and |B|**2 at index_absE and index_absB
+        auto hv = reduce_data.value();
+        m_data[lev*noutputs+index_Ex] = amrex::get<index_Ex>(hv);
+        m_data[lev*noutputs+index_Ey] = amrex::get<index_Ey>(hv);
+        m_data[lev*noutputs+index_Ez] = amrex::get<index_Ez>(hv);
+        m_data[lev*noutputs+index_absE] = amrex::get<index_absE>(hv);
+        m_data[lev*noutputs+index_Bx] = amrex::get<index_Bx>(hv);
+        m_data[lev*noutputs+index_By] = amrex::get<index_By>(hv);
+        m_data[lev*noutputs+index_Bz] = amrex::get<index_Bz>(hv);
+        m_data[lev*noutputs+index_absB] = amrex::get<index_absB>(hv);
     }
     // end loop over refinement levels
 
-    /* m_data now contains up-to-date values for:
-     *  [max(Ex),max(Ey),max(Ez),max(|E|),
-     *   max(Bx),max(By),max(Bz),max(|B|)] */
+    // MPI reduce of all the levels at once
+    ParallelReduce(ReductionBatch::Op::Max, m_data.data(), noutputs*nLevel, [this, nLevel] ()
+    {
+        for (int lev = 0; lev < nLevel; ++lev)
+        {
+            m_data[lev*noutputs+index_absE] = std::sqrt(m_data[lev*noutputs+index_absE]);
+            m_data[lev*noutputs+index_absB] = std::sqrt(m_data[lev*noutputs+index_absB]);
+        }
+
+        /* m_data now contains up-to-date values for:
+         *  [max(Ex),max(Ey),max(Ez),max(|E|),
+         *   max(Bx),max(By),max(Bz),max(|B|)] */
+    });
 }
 // end void FieldMaximum::ComputeDiags
@@ -177,14 +177,11 @@ void FieldMomentum::ComputeDiags (int step)
                 });
         }
 
-        // MPI reduce
+        // local sums, reduced over MPI ranks below
         auto r = reduce_data.value();
         amrex::Real ExB_x = amrex::get<0>(r);
         amrex::Real ExB_y = amrex::get<1>(r);
         amrex::Real ExB_z = amrex::get<2>(r);
-        amrex::ParallelDescriptor::ReduceRealSum(ExB_x);
-        amrex::ParallelDescriptor::ReduceRealSum(ExB_y);
-        amrex::ParallelDescriptor::ReduceRealSum(ExB_z);
 
         // Get cell size
         amrex::Geometry const & geom = warpx.Geom(lev);
@@ -202,4 +199,7 @@ void FieldMomentum::ComputeDiags (int step)
         m_data[offset+1] = PhysConst::ep0 * ExB_y * dV;
         m_data[offset+2] = PhysConst::ep0 * ExB_z * dV;
     }
+
+    // MPI reduce of all the levels at once
+    ParallelReduce(ReductionBatch::Op::Sum, m_data.data(), 3*nLevel);
 }
@@ -30,12 +30,15 @@
 #include <AMReX_RealVect.H>
 #include <AMReX_Reduce.H>
 #include <AMReX_Geometry.H>
+#include <AMReX_GpuContainers.H>
 #include <AMReX_StructOfArrays.H>
 #include <AMReX_Vector.H>
 
 #include <cmath>
 #include <cstddef>
 #include <cstdlib>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
 #include <ostream>
 #include <string>
@@ -44,6 +47,88 @@
 
 using namespace amrex;
 
+namespace
+{
+    /** Read the geometry of a probe from <prefix>.probe_geometry, <prefix>.x_probe, ... */
+    FieldProbeGeometry ReadProbeGeometry (std::string const& prefix)
+    {
+        FieldProbeGeometry g;
+
+        /* Obtain input data from parsing inputs file.
+         * For the case of a single particle:
+         *     Define x, y, and z of particle
+         * For the case of a line detector:
+         *     Define x, y, and z of end of line point 1
+         *     Define x, y, and z of end of line point 2
+         *     Define resolution to determine number of particles
+         * For the case of a plane detector:
+         *     Define a vector normal to the detector plane
+         *     Define a vector in the "up" direction of the plane
+         *     Define the size of the plane (width of half square)
+         *     Define resolution to determine number of particles
+         */
+        amrex::ParmParse pp_prefix(prefix);
+        std::string probe_geometry_str = "Point";
+        pp_prefix.query("probe_geometry", probe_geometry_str);
+
+        if (probe_geometry_str == "Point")
+        {
+            g.geometry = DetectorGeometry::Point;
+#if !defined(WARPX_DIM_1D_Z)
+            getWithParser(pp_prefix, "x_probe", g.x_probe);
+#endif
+#if defined(WARPX_DIM_3D)
+            getWithParser(pp_prefix, "y_probe", g.y_probe);
+#endif
+            getWithParser(pp_prefix, "z_probe", g.z_probe);
+        }
+        else if (probe_geometry_str == "Line")
+        {
+            g.geometry = DetectorGeometry::Line;
+#if !defined(WARPX_DIM_1D_Z)
+            getWithParser(pp_prefix, "x_probe", g.x_probe);
+            getWithParser(pp_prefix, "x1_probe", g.x1_probe);
+#endif
+#if defined(WARPX_DIM_3D)
+            getWithParser(pp_prefix, "y_probe", g.y_probe);
+            getWithParser(pp_prefix, "y1_probe", g.y1_probe);
+#endif
+            getWithParser(pp_prefix, "z_probe", g.z_probe);
+            getWithParser(pp_prefix, "z1_probe", g.z1_probe);
+            getWithParser(pp_prefix, "resolution", g.resolution);
+        }
+        else if (probe_geometry_str == "Plane")
+        {
+#if defined(WARPX_DIM_1D_Z)
+            amrex::Abort(Utils::TextMsg::Err(
+                "ERROR: Plane probe should be used in a 2D or 3D simulation only"));
+#endif
+            g.geometry = DetectorGeometry::Plane;
+#if defined(WARPX_DIM_3D)
+            getWithParser(pp_prefix, "y_probe", g.y_probe);
+            getWithParser(pp_prefix, "target_normal_x", g.target_normal_x);
+            getWithParser(pp_prefix, "target_normal_y", g.target_normal_y);
+            getWithParser(pp_prefix, "target_normal_z", g.target_normal_z);
+            getWithParser(pp_prefix, "target_up_y", g.target_up_y);
+#endif
+            getWithParser(pp_prefix, "x_probe", g.x_probe);
+            getWithParser(pp_prefix, "z_probe", g.z_probe);
+            getWithParser(pp_prefix, "target_up_x", g.target_up_x);
+            getWithParser(pp_prefix, "target_up_z", g.target_up_z);
+            getWithParser(pp_prefix, "detector_radius", g.detector_radius);
+            getWithParser(pp_prefix, "resolution", g.resolution);
+        }
+        else
+        {
+            amrex::Abort(Utils::TextMsg::Err(
+                "ERROR: Invalid probe geometry '" + probe_geometry_str
+                + "' for " + prefix + ". Valid geometries are Point, Line or Plane."
+            ));
+        }
+        return g;
+    }
+}
+
 // constructor
 
 FieldProbe::FieldProbe (std::string rd_name)
@@ -62,91 +147,24 @@ FieldProbe::FieldProbe (std::string rd_name)
     pp_amr.query("max_level", nLevel);
     nLevel += 1;
 
-    /* Obtain input data from parsing inputs file.
-     * For the case of a single particle:
-     *     Define x, y, and z of particle
-     *     Define whether or not to integrate fields
-     * For the case of a line detector:
-     *     Define x, y, and z of end of line point 1
-     *     Define x, y, and z of end of line point 2
-     *     Define resolution to determine number of particles
-     *     Define whether ot not to integrate fields
-     * For the case of a plane detector:
-     *     Define a vector normal to the detector plane
-     *     Define a vector in the "up" direction of the plane
-     *     Define the size of the plane (width of half square)
-     *     Define resolution to determine number of particles
-     *     Define whether ot not to integrate fields
-     */
     amrex::ParmParse pp_rd_name(rd_name);
-    std::string m_probe_geometry_str = "Point";
-    pp_rd_name.query("probe_geometry", m_probe_geometry_str);
-
-    if (m_probe_geometry_str == "Point")
+    // A batch of probes, whose geometries are read from <rd_name>.<probe_name>, shares one
+    // particle container, field gather and output file. Otherwise the geometry of the single
+    // probe is read from <rd_name>.
+    pp_rd_name.queryarr("probes", m_probe_names);
+    if (m_probe_names.empty())
     {
-        m_probe_geometry = DetectorGeometry::Point;
-        x_probe = 0._rt;
-        y_probe = 0._rt;
-#if !defined(WARPX_DIM_1D_Z)
-        getWithParser(pp_rd_name, "x_probe", x_probe);
-#endif
-#if defined(WARPX_DIM_3D)
-        getWithParser(pp_rd_name, "y_probe", y_probe);
-#endif
-        getWithParser(pp_rd_name, "z_probe", z_probe);
-    }
-    else if (m_probe_geometry_str == "Line")
-    {
-        m_probe_geometry = DetectorGeometry::Line;
-        x_probe = 0._rt;
-        x1_probe = 0._rt;
-        y_probe = 0._rt;
-        y1_probe = 0._rt;
-#if !defined(WARPX_DIM_1D_Z)
-        getWithParser(pp_rd_name, "x_probe", x_probe);
-        getWithParser(pp_rd_name, "x1_probe", x1_probe);
-#endif
-#if defined(WARPX_DIM_3D)
-        getWithParser(pp_rd_name, "y_probe", y_probe);
-        getWithParser(pp_rd_name, "y1_probe", y1_probe);
-#endif
-        getWithParser(pp_rd_name, "z_probe", z_probe);
-        getWithParser(pp_rd_name, "z1_probe", z1_probe);
-        getWithParser(pp_rd_name, "resolution", m_resolution);
-    }
-    else if (m_probe_geometry_str == "Plane")
-    {
-#if defined(WARPX_DIM_1D_Z)
-        amrex::Abort(Utils::TextMsg::Err(
-            "ERROR: Plane probe should be used in a 2D or 3D simulation only"));
-#endif
-        m_probe_geometry = DetectorGeometry::Plane;
-        y_probe = 0._rt;
-        target_normal_x = 0._rt;
-        target_normal_y = 1._rt;
-        target_normal_z = 0._rt;
-        target_up_y = 0._rt;
-#if defined(WARPX_DIM_3D)
-        getWithParser(pp_rd_name, "y_probe", y_probe);
-        getWithParser(pp_rd_name, "target_normal_x", target_normal_x);
-        getWithParser(pp_rd_name, "target_normal_y", target_normal_y);
-        getWithParser(pp_rd_name, "target_normal_z", target_normal_z);
-        getWithParser(pp_rd_name, "target_up_y", target_up_y);
-#endif
-        getWithParser(pp_rd_name, "x_probe", x_probe);
-        getWithParser(pp_rd_name, "z_probe", z_probe);
-        getWithParser(pp_rd_name, "target_up_x", target_up_x);
-        getWithParser(pp_rd_name, "target_up_z", target_up_z);
-        getWithParser(pp_rd_name, "detector_radius", detector_radius);
-        getWithParser(pp_rd_name, "resolution", m_resolution);
+        m_geometries.push_back(ReadProbeGeometry(rd_name));
     }
     else
     {
-        amrex::Abort(Utils::TextMsg::Err(
-            "ERROR: Invalid probe geometry '" + m_probe_geometry_str
-            + "'. Valid geometries are Point, Line or Plane."
-        ));
+        for (auto const& probe_name : m_probe_names)
+        {
+            m_geometries.push_back(ReadProbeGeometry(rd_name + "." + probe_name));
+        }
     }
+
+    // options shared by all the probes
     pp_rd_name.query("integrate", m_field_probe_integrate);
     pp_rd_name.query("raw_fields", raw_fields);
     pp_rd_name.query("interp_order", interp_order);
@@ -174,6 +192,12 @@ FieldProbe::FieldProbe (std::string rd_name)
             ofs << "[" << c++ << "]step()";
             ofs << m_sep;
             ofs << "[" << c++ << "]time(s)";
+            if (!m_probe_names.empty())
+            {
+                // index of the probe in <rd_name>.probes
+                ofs << m_sep;
+                ofs << "[" << c++ << "]probe()";
+            }
             // maps FieldProbe observables to units
             std::unordered_map< int, std::string > u_map;
 
@@ -234,110 +258,109 @@ FieldProbe::FieldProbe (std::string rd_name)
     }
 } // end constructor
 
-void FieldProbe::InitData ()
+FieldProbe::~FieldProbe ()
 {
-    if (m_probe_geometry == DetectorGeometry::Point)
-    {
-
-        // create 1D vector for X, Y, and Z of particles
-        amrex::Vector<amrex::ParticleReal> xpos;
-        amrex::Vector<amrex::ParticleReal> ypos;
-        amrex::Vector<amrex::ParticleReal> zpos;
+    // write the outputs left in the buffer at the end of the simulation
+    FlushBuffer();
+}
 
-        // for now, only one MPI rank adds a probe particle
-        if (ParallelDescriptor::IOProcessor())
-        {
-            xpos.push_back(x_probe);
-            ypos.push_back(y_probe);
-            zpos.push_back(z_probe);
-        }
+void FieldProbe::InitData ()
+{
+    // create 1D vector for X, Y, and Z of particles, and for the index of their probe
+    amrex::Vector<amrex::ParticleReal> xpos;
+    amrex::Vector<amrex::ParticleReal> ypos;
+    amrex::Vector<amrex::ParticleReal> zpos;
+    amrex::Vector<int> probe_index;
 
-        // add particles on lev 0 to m_probe
-        m_probe.AddNParticles(0, xpos, ypos, zpos);
-    }
-    else if (m_probe_geometry == DetectorGeometry::Line)
+    // for now, only one MPI rank adds the probe particles
+    if (ParallelDescriptor::IOProcessor())
     {
-        amrex::Vector<amrex::ParticleReal> xpos;
-        amrex::Vector<amrex::ParticleReal> ypos;
-        amrex::Vector<amrex::ParticleReal> zpos;
-        if (ParallelDescriptor::IOProcessor())
+        for (int iprobe = 0; iprobe < static_cast<int>(m_geometries.size()); ++iprobe)
         {
-            xpos.reserve(m_resolution);
-            ypos.reserve(m_resolution);
-            zpos.reserve(m_resolution);
-
-            // Final - initial / steps. Array contains dx, dy, dz
-            amrex::Real DetLineStepSize[3]{
-                    (x1_probe - x_probe) / (m_resolution - 1),
-                    (y1_probe - y_probe) / (m_resolution - 1),
-                    (z1_probe - z_probe) / (m_resolution - 1)};
-            for ( int step = 0; step < m_resolution; step++)
+            FieldProbeGeometry const& g = m_geometries[iprobe];
+            std::size_t const np_before = xpos.size();
+
+            if (g.geometry == DetectorGeometry::Point)
             {
-                xpos.push_back(x_probe + (DetLineStepSize[0] * step));
-                ypos.push_back(y_probe + (DetLineStepSize[1] * step));
-                zpos.push_back(z_probe + (DetLineStepSize[2] * step));
+                xpos.push_back(g.x_probe);
+                ypos.push_back(g.y_probe);
+                zpos.push_back(g.z_probe);
             }
-        }
-        m_probe.AddNParticles(0, xpos, ypos, zpos);
-    }
-    else if (m_probe_geometry == DetectorGeometry::Plane)
-    {
-        amrex::Vector<amrex::ParticleReal> xpos;
-        amrex::Vector<amrex::ParticleReal> ypos;
-        amrex::Vector<amrex::ParticleReal> zpos;
-        if (ParallelDescriptor::IOProcessor())
-        {
-            std::size_t const res2 = std::size_t(m_resolution) * std::size_t(m_resolution);
-            xpos.reserve(res2);
-            ypos.reserve(res2);
-            zpos.reserve(res2);
-
-            // create vector orthonormal to input vectors
-            amrex::Real orthotarget[3]{
-                target_normal_y * target_up_z - target_normal_z * target_up_y,
-                target_normal_z * target_up_x - target_normal_x * target_up_z,
-                target_normal_x * target_up_y - target_normal_y * target_up_x};
-            // find upper left and lower right bounds of detector
-            amrex::Real direction[3]{
-                orthotarget[0] - target_up_x,
-                orthotarget[1] - target_up_y,
-                orthotarget[2] - target_up_z};
-            amrex::Real upperleft[3]{
-                x_probe - (direction[0] * detector_radius),
-                y_probe - (direction[1] * detector_radius),
-                z_probe - (direction[2] * detector_radius)};
-            amrex::Real lowerright[3]{
-                x_probe + (direction[0] * detector_radius),
-                y_probe + (direction[1] * detector_radius),
-                z_probe + (direction[2] * detector_radius)};
-            // create array containing point-to-point step size
-            amrex::Real DetPlaneStepSize[3]{
-                (lowerright[0] - upperleft[0]) / (m_resolution - 1),
-                (lowerright[1] - upperleft[1]) / (m_resolution - 1),
-                (lowerright[2] - upperleft[2]) / (m_resolution - 1)};
-            amrex::Real temp_pos[3]{};
-            // Target point on top of plane (arbitrarily top of plane perpendicular to yz)
-            // For each point along top of plane, fill in YZ's beneath, then push back
-            for ( int step = 0; step < m_resolution; step++)
+            else if (g.geometry == DetectorGeometry::Line)
             {
-                temp_pos[0] = upperleft[0] + (DetPlaneStepSize[0] * step);
-                for ( int yzstep = 0; yzstep < m_resolution; yzstep++)
+                xpos.reserve(np_before + g.resolution);
+                ypos.reserve(np_before + g.resolution);
+                zpos.reserve(np_before + g.resolution);
+
+                // Final - initial / steps. Array contains dx, dy, dz
+                amrex::Real DetLineStepSize[3]{
+                        (g.x1_probe - g.x_probe) / (g.resolution - 1),
+                        (g.y1_probe - g.y_probe) / (g.resolution - 1),
+                        (g.z1_probe - g.z_probe) / (g.resolution - 1)};
+                for ( int step = 0; step < g.resolution; step++)
                 {
-                    temp_pos[1] = upperleft[1] + (DetPlaneStepSize[1] * yzstep);
-                    temp_pos[2] = upperleft[2] + (DetPlaneStepSize[2] * yzstep);
-                    xpos.push_back(temp_pos[0]);
-                    ypos.push_back(temp_pos[1]);
-                    zpos.push_back(temp_pos[2]);
+                    xpos.push_back(g.x_probe + (DetLineStepSize[0] * step));
+                    ypos.push_back(g.y_probe + (DetLineStepSize[1] * step));
+                    zpos.push_back(g.z_probe + (DetLineStepSize[2] * step));
                 }
             }
+            else if (g.geometry == DetectorGeometry::Plane)
+            {
+                std::size_t const res2 = std::size_t(g.resolution) * std::size_t(g.resolution);
+                xpos.reserve(np_before + res2);
+                ypos.reserve(np_before + res2);
+                zpos.reserve(np_before + res2);
+
+                // create vector orthonormal to input vectors
+                amrex::Real orthotarget[3]{
+                    g.target_normal_y * g.target_up_z - g.target_normal_z * g.target_up_y,
+                    g.target_normal_z * g.target_up_x - g.target_normal_x * g.target_up_z,
+                    g.target_normal_x * g.target_up_y - g.target_normal_y * g.target_up_x};
+                // find upper left and lower right bounds of detector
+                amrex::Real direction[3]{
+                    orthotarget[0] - g.target_up_x,
+                    orthotarget[1] - g.target_up_y,
+                    orthotarget[2] - g.target_up_z};
+                amrex::Real upperleft[3]{
+                    g.x_probe - (direction[0] * g.detector_radius),
+                    g.y_probe - (direction[1] * g.detector_radius),
+                    g.z_probe - (direction[2] * g.detector_radius)};
+                amrex::Real lowerright[3]{
+                    g.x_probe + (direction[0] * g.detector_radius),
+                    g.y_probe + (direction[1] * g.detector_radius),
+                    g.z_probe + (direction[2] * g.detector_radius)};
+                // create array containing point-to-point step size
+                amrex::Real DetPlaneStepSize[3]{
+                    (lowerright[0] - upperleft[0]) / (g.resolution - 1),
+                    (lowerright[1] - upperleft[1]) / (g.resolution - 1),
+                    (lowerright[2] - upperleft[2]) / (g.resolution - 1)};
+                amrex::Real temp_pos[3]{};
+                // Target point on top of plane (arbitrarily top of plane perpendicular to yz)
+                // For each point along top of plane, fill in YZ's beneath, then push back
+                for ( int step = 0; step < g.resolution; step++)
+                {
+                    temp_pos[0] = upperleft[0] + (DetPlaneStepSize[0] * step);
+                    for ( int yzstep = 0; yzstep < g.resolution; yzstep++)
+                    {
+                        temp_pos[1] = upperleft[1] + (DetPlaneStepSize[1] * yzstep);
+                        temp_pos[2] = upperleft[2] + (DetPlaneStepSize[2] * yzstep);
+                        xpos.push_back(temp_pos[0]);
+                        ypos.push_back(temp_pos[1]);
+                        zpos.push_back(temp_pos[2]);
+                    }
+                }
+            }
+            else
+            {
+                amrex::Abort(Utils::TextMsg::Err(
+                    "Invalid probe geometry. Valid geometries are Point, Line, and Plane."));
+            }
+            probe_index.resize(xpos.size(), iprobe);
         }
-        m_probe.AddNParticles(0, xpos, ypos, zpos);
-    }
-    else
-    {
-        amrex::Abort(Utils::TextMsg::Err(
-            "Invalid probe geometry. Valid geometries are Point, Line, and Plane."));
     }
+
+    // add the particles of all the probes on lev 0 to m_probe
+    m_probe.AddNParticles(0, xpos, ypos, zpos, probe_index);
 }
 
 void FieldProbe::LoadBalance ()
@@ -345,8 +368,12 @@ void FieldProbe::LoadBalance ()
     m_probe.Redistribute();
 }
 
-bool FieldProbe::ProbeInDomain () const
+bool FieldProbe::ProbeInDomain (int iprobe) const
 {
+    amrex::Real const x_probe = m_geometries[iprobe].x_probe;
+    amrex::Real const y_probe = m_geometries[iprobe].y_probe;
+    amrex::Real const z_probe = m_geometries[iprobe].z_probe;
+
     // get a reference to WarpX instance
     auto & warpx = WarpX::GetInstance();
     int const lev = 0;
@@ -361,8 +388,10 @@ bool FieldProbe::ProbeInDomain () const
      * and prob_hi[1] refer to z. This is a result of warpx.Geom(lev).
      */
 #if defined(WARPX_DIM_1D_Z)
+    amrex::ignore_unused(x_probe, y_probe);
     return z_probe >= prob_lo[1] && z_probe < prob_hi[1];
 #elif defined(WARPX_DIM_XZ) || defined(WARPX_DIM_RZ)
+    amrex::ignore_unused(y_probe);
     return x_probe >= prob_lo[0] && x_probe < prob_hi[0] &&
            z_probe >= prob_lo[1] && z_probe < prob_hi[1];
 #else
@@ -385,11 +414,25 @@ void FieldProbe::ComputeDiags (int step)
     // get number of mesh-refinement levels
     const auto nLevel = warpx.finestLevel() + 1;
 
+    // the probes outside of the domain are neither gathered nor written
+    int const nprobes = static_cast<int>(m_geometries.size());
+    amrex::Vector<int> h_in_domain(nprobes);
+    bool any_in_domain = false;
+    for (int iprobe = 0; iprobe < nprobes; ++iprobe)
+    {
+        h_in_domain[iprobe] = ProbeInDomain(iprobe);
+        any_in_domain = any_in_domain || h_in_domain[iprobe];
+    }
+    amrex::Gpu::DeviceVector<int> in_domain(nprobes);
+    amrex::Gpu::copyAsync(amrex::Gpu::hostToDevice, h_in_domain.begin(), h_in_domain.end(),
+                          in_domain.begin());
+    amrex::Gpu::synchronize();
+    int const* const AMREX_RESTRICT in_domain_ptr = in_domain.dataPtr();
+
     // loop over refinement levels
     for (int lev = 0; lev < nLevel; ++lev)
     {
         const amrex::Geometry& gm = warpx.Geom(lev);
-        const auto prob_lo = gm.ProbLo();
         amrex::Real const dt = WarpX::GetInstance().getdt(lev);
         // Calculates particle movement in moving window sims
         amrex::Real move_dist = 0.0;
@@ -467,20 +510,10 @@ void FieldProbe::ComputeDiags (int step)
                     }
                 });
             }
-            if( ProbeInDomain() )
+            if( any_in_domain )
             {
                 const auto cell_size = gm.CellSizeArray();
-                const int i_probe = static_cast<int>(amrex::Math::floor((x_probe - prob_lo[0]) / cell_size[0]));
-#if defined(WARPX_DIM_1D_Z)
-                const int j_probe = 0;
-                const int k_probe = 0;
-#elif defined(WARPX_DIM_XZ) || defined(WARPX_DIM_RZ)
-                const int j_probe = static_cast<int>(amrex::Math::floor((z_probe - prob_lo[1]) / cell_size[1]));
-                const int k_probe = 0;
-#elif defined(WARPX_DIM_3D)
-                const int j_probe = static_cast<int>(amrex::Math::floor((y_probe - prob_lo[1]) / cell_size[1]));
-                const int k_probe = static_cast<int>(amrex::Math::floor((z_probe - prob_lo[2]) / cell_size[2]));
-#endif
+                const auto prob_lo = gm.ProbLoArray();
                 const auto &arrEx = Ex[pti].array();
                 const auto &arrEy = Ey[pti].array();
                 const auto &arrEz = Ez[pti].array();
@@ -504,6 +537,8 @@ void FieldProbe::ComputeDiags (int step)
                 ParticleReal* const AMREX_RESTRICT part_By = attribs[FieldProbePIdx::By].dataPtr();
                 ParticleReal* const AMREX_RESTRICT part_Bz = attribs[FieldProbePIdx::Bz].dataPtr();
                 ParticleReal* const AMREX_RESTRICT part_S = attribs[FieldProbePIdx::S].dataPtr();
+                int const* const AMREX_RESTRICT part_probe =
+                    pti.GetStructOfArrays().GetIntData(FieldProbePIdxInt::probe).dataPtr();
 
                 const auto &xyzmin = WarpX::LowerCorner(box, lev, 0._rt);
                 const std::array<Real, 3> &dx = WarpX::CellSize(lev);
@@ -521,6 +556,8 @@ void FieldProbe::ComputeDiags (int step)
                 // Interpolating to the probe positions for each particle
                 amrex::ParallelFor( np, [=] AMREX_GPU_DEVICE (long ip)
                 {
+                    if (!in_domain_ptr[part_probe[ip]]) return;
+
                     amrex::ParticleReal xp, yp, zp;
                     getPosition(ip, xp, yp, zp);
 
@@ -530,6 +567,20 @@ void FieldProbe::ComputeDiags (int step)
                     // first gather E and B to the particle positions
                     if (temp_raw_fields)
                     {
+                        // cell containing the particle
+#if defined(WARPX_DIM_1D_Z)
+                        const int i_probe = static_cast<int>(amrex::Math::floor((zp - prob_lo[0]) / cell_size[0]));
+                        const int j_probe = 0;
+                        const int k_probe = 0;
+#elif defined(WARPX_DIM_XZ) || defined(WARPX_DIM_RZ)
+                        const int i_probe = static_cast<int>(amrex::Math::floor((xp - prob_lo[0]) / cell_size[0]));
+                        const int j_probe = static_cast<int>(amrex::Math::floor((zp - prob_lo[1]) / cell_size[1]));
+                        const int k_probe = 0;
+#elif defined(WARPX_DIM_3D)
+                        const int i_probe = static_cast<int>(amrex::Math::floor((xp - prob_lo[0]) / cell_size[0]));
+                        const int j_probe = static_cast<int>(amrex::Math::floor((yp - prob_lo[1]) / cell_size[1]));
+                        const int k_probe = static_cast<int>(amrex::Math::floor((zp - prob_lo[2]) / cell_size[2]));
+#endif
                         Exp = arrEx(i_probe, j_probe, k_probe);
                         Eyp = arrEy(i_probe, j_probe, k_probe);
                         Ezp = arrEz(i_probe, j_probe, k_probe);
@@ -584,10 +635,13 @@ void FieldProbe::ComputeDiags (int step)
                 {
                     for (auto ip=0; ip < np; ip++)
                     {
+                        if (!h_in_domain[part_probe[ip]]) continue;
+
                         amrex::ParticleReal xp, yp, zp;
                         getPosition(ip, xp, yp, zp);
 
                         // push to output vector
+                        m_data.push_back(part_probe[ip]);
                         m_data.push_back(xp);
                         m_data.push_back(yp);
                         m_data.push_back(zp);
@@ -600,7 +654,7 @@ void FieldProbe::ComputeDiags (int step)
                         m_data.push_back(part_S[ip]);
                     }
                 /* m_data now contains up-to-date values for:
-                 *  [x, y, z, Ex, Ey, Ez, Bx, By, Bz, and S] */
+                 *  [probe, x, y, z, Ex, Ey, Ez, Bx, By, Bz, and S] */
                 }
             }
         } // end particle iterator loop
@@ -656,30 +710,79 @@ void FieldProbe::ComputeDiags (int step)
 
 void FieldProbe::WriteToFile (int step) const
 {
-    if (ProbeInDomain() && amrex::ParallelDescriptor::IOProcessor())
+    if (amrex::ParallelDescriptor::IOProcessor())
+    {
+        // each row holds step, time, [probe,] x, y, z, Ex, Ey, Ez, Bx, By, Bz and S
+        bool const write_probe = !m_probe_names.empty();
+        m_write_buffer.reserve(m_write_buffer.size()
+                               + m_valid_particles * (noutputs + 1 + write_probe));
+        amrex::Real const time = WarpX::GetInstance().gett_new(0);
+
+        for (int i = 0; i < m_valid_particles; i++)
+        {
+            m_write_buffer.push_back(step + 1);
+            m_write_buffer.push_back(time);
+            // the probe index (k = 0) is only written for a batch of probes
+            for (int k = write_probe ? 0 : 1; k < noutputs; k++)
+            {
+                m_write_buffer.push_back(m_data_out[i * noutputs + k]);
+            }
+        }
+        ++m_buffered_outputs;
+
+        if (m_buffered_outputs >= m_flush_interval) FlushBuffer();
+    }
+}
+
+void FieldProbe::FlushBuffer () const
+{
+    if (m_buffered_outputs == 0 || !amrex::ParallelDescriptor::IOProcessor()) return;
+
+    if (m_output_format == "binary")
+    {
+        // the rows are written in double precision, in the order of the header row
+        std::ofstream ofs{BinaryFileName(),
+                          std::ofstream::out | std::ofstream::app | std::ofstream::binary};
+        ofs.write(reinterpret_cast<char const*>(m_write_buffer.data()),
+                  static_cast<std::streamsize>(m_write_buffer.size() * sizeof(double)));
+        ofs.close();
+    }
+    else
     {
         // open file
         std::ofstream ofs{m_path + m_rd_name + "." + m_extension,
                           std::ofstream::out | std::ofstream::app};
 
-        // loop over num valid particles and write
-        for (int i = 0; i < m_valid_particles; i++)
+        // number of columns of a row
+        int const ncols = noutputs + 1 + !m_probe_names.empty();
+        int const nint = 1 + !m_probe_names.empty();
+
+        // loop over the buffered rows and write
+        for (std::size_t i = 0; i < m_write_buffer.size(); i += ncols)
         {
             ofs << std::fixed << std::defaultfloat;
-            ofs << step + 1;
+            ofs << static_cast<int>(m_write_buffer[i]);
             ofs << m_sep;
             ofs << std::fixed << std::setprecision(14) << std::scientific;
             // write time
-            ofs << WarpX::GetInstance().gett_new(0);
+            ofs << m_write_buffer[i + 1];
+            if (nint == 2)
+            {
+                ofs << m_sep;
+                ofs << static_cast<int>(m_write_buffer[i + 2]);
+            }
 
-            for (int k = 0; k < noutputs; k++)
+            for (int k = nint + 1; k < ncols; k++)
             {
                 ofs << m_sep;
-                ofs << m_data_out[i * noutputs + k];
+                ofs << m_write_buffer[i + k];
             }
-            ofs << std::endl;
+            ofs << '\n';
         } // end loop over data size
-    // close file
-    ofs.close();
+        // close file
+        ofs.close();
     }
+
+    m_write_buffer.clear();
+    m_buffered_outputs = 0;
 }
@@ -61,7 +61,7 @@
 using namespace amrex;
 
 FieldProbeParticleContainer::FieldProbeParticleContainer (AmrCore* amr_core)
-    : ParticleContainer<0, 0, FieldProbePIdx::nattribs>(amr_core->GetParGDB())
+    : ParticleContainer<0, 0, FieldProbePIdx::nattribs, FieldProbePIdxInt::nattribs>(amr_core->GetParGDB())
 {
     SetParticleSize();
 }
@@ -70,11 +70,13 @@ void
 FieldProbeParticleContainer::AddNParticles (int lev,
                                             amrex::Vector<amrex::ParticleReal> const & x,
                                             amrex::Vector<amrex::ParticleReal> const & y,
-                                            amrex::Vector<amrex::ParticleReal> const & z)
+                                            amrex::Vector<amrex::ParticleReal> const & z,
+                                            amrex::Vector<int> const & probe)
 {
     WARPX_ALWAYS_ASSERT_WITH_MESSAGE(lev == 0, "AddNParticles: only lev=0 is supported yet.");
     AMREX_ALWAYS_ASSERT(x.size() == y.size());
     AMREX_ALWAYS_ASSERT(x.size() == z.size());
+    AMREX_ALWAYS_ASSERT(x.size() == probe.size());
 
     // number of particles to add
     int const np = x.size();
@@ -125,6 +127,7 @@ FieldProbeParticleContainer::AddNParticles (int lev,
     pinned_tile.push_back_real(FieldProbePIdx::By, np, 0.0);
     pinned_tile.push_back_real(FieldProbePIdx::Bz, np, 0.0);
     pinned_tile.push_back_real(FieldProbePIdx::S, np, 0.0);
+    pinned_tile.push_back_int(FieldProbePIdxInt::probe, probe.data(), probe.data() + np);
 
     /*
      * Redistributes particles to their appropriate tiles if the box
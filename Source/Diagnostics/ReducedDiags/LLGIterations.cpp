@@ -0,0 +1,102 @@
+/* This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+
+#include "LLGIterations.H"
+
+#include "FieldSolver/FiniteDifferenceSolver/FiniteDifferenceSolver.H"
+#include "Utils/IntervalsParser.H"
+#include "Utils/TextMsg.H"
+#include "WarpX.H"
+
+#include <AMReX.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_REAL.H>
+
+#include <fstream>
+#include <ostream>
+#include <vector>
+
+using namespace amrex::literals;
+
+// constructor
+LLGIterations::LLGIterations (std::string rd_name)
+: ReducedDiags{rd_name}
+{
+#if (defined WARPX_DIM_RZ) || !(defined WARPX_MAG_LLG)
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(false,
+        "LLGIterations reduced diagnostics requires USE_LLG=TRUE and does not work for RZ coordinate.");
+#endif
+#ifdef WARPX_MAG_LLG
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(WarpX::mag_LLG,
+        "LLGIterations reduced diagnostics requires warpx.mag_LLG = 1.");
+#endif
+
+    // number of solves, total and maximum number of iterations, average number of iterations,
+    // final error, time and deviation of |M| from Ms
+    constexpr int noutputs = 7;
+    // resize data array
+    m_data.resize(noutputs, 0.0_rt);
+
+    if (amrex::ParallelDescriptor::IOProcessor())
+    {
+        if ( m_IsNotRestart )
+        {
+            // open file
+            std::ofstream ofs{m_path + m_rd_name + "." + m_extension, std::ofstream::out};
+            // write header row
+            int c = 0;
+            ofs << "#";
+            ofs << "[" << c++ << "]step()";
+            ofs << m_sep;
+            ofs << "[" << c++ << "]time(s)";
+            ofs << m_sep;
+            ofs << "[" << c++ << "]num_solves()";
+            ofs << m_sep;
+            ofs << "[" << c++ << "]iter_total()";
+            ofs << m_sep;
+            ofs << "[" << c++ << "]iter_max()";
+            ofs << m_sep;
+            ofs << "[" << c++ << "]iter_avg()";
+            ofs << m_sep;
+            ofs << "[" << c++ << "]M_iter_maxerror()";
+            ofs << m_sep;
+            ofs << "[" << c++ << "]iter_walltime(s)";
+            ofs << m_sep;
+            ofs << "[" << c++ << "]max_|1-|M|/Ms|()";
+            ofs << std::endl;
+            // close file
+            ofs.close();
+        }
+    }
+}
+// end constructor
+
+// function that reads the statistics of the LLG solver
+void LLGIterations::ComputeDiags (int step)
+{
+#if !(defined WARPX_DIM_RZ) && (defined WARPX_MAG_LLG)
+    // get a reference to the LLG solver of level 0, the only level on which M is evolved
+    auto & fdtd_solver = WarpX::GetInstance().GetFiniteDifferenceSolver(0);
+
+    // the statistics are reset every step, so that each output covers one step only
+    if (m_intervals.contains(step+1))
+    {
+        auto const& stats = fdtd_solver.GetLLGStats();
+
+        m_data[0] = stats.num_solves;
+        m_data[1] = stats.iter_total;
+        m_data[2] = stats.iter_max;
+        m_data[3] = (stats.num_solves > 0) ? static_cast<amrex::Real>(stats.iter_total) / stats.num_solves : 0._rt;
+        m_data[4] = stats.maxerror;
+        // the slowest rank determines the time of the iterations
+        m_data[5] = stats.time;
+        ParallelReduce(ReductionBatch::Op::Max, &m_data[5], 1);
+        m_data[6] = stats.norm_deviation;
+    }
+    fdtd_solver.ResetLLGStats();
+#else
+    amrex::ignore_unused(step);
+#endif
+}
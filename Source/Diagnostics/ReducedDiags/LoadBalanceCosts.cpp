@@ -7,6 +7,8 @@
 #include "LoadBalanceCosts.H"
 
 #include "Diagnostics/ReducedDiags/ReducedDiags.H"
+#include "FieldSolver/FiniteDifferenceSolver/FiniteDifferenceSolver.H"
+#include "Parallelization/CostsBreakdown.H"
 #include "Particles/MultiParticleContainer.H"
 #include "Utils/IntervalsParser.H"
 #include "Utils/TextMsg.H"
@@ -20,6 +22,7 @@
 #include <AMReX_MFIter.H>
 #include <AMReX_MultiFab.H>
 #include <AMReX_ParallelDescriptor.H>
+#include <AMReX_ParmParse.H>
 #include <AMReX_REAL.H>
 #include <AMReX_Utility.H>
 
@@ -32,6 +35,7 @@
 #include <iomanip>
 #include <istream>
 #include <memory>
+#include <string>
 #include <utility>
 
 using namespace amrex;
@@ -69,6 +73,18 @@ namespace
 LoadBalanceCosts::LoadBalanceCosts (std::string rd_name)
     : ReducedDiags{rd_name}
 {
+    // the rows have a variable number of columns, and are rewritten at the final step
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(m_output_format != "binary",
+        rd_name + ".output_format = binary is not supported by LoadBalanceCosts");
+
+    // read whether the costs are broken down by phase of the step
+    ParmParse pp_rd_name(rd_name);
+    pp_rd_name.query("breakdown", m_breakdown);
+    if (m_breakdown)
+    {
+        m_nDataFields += m_nBreakdownFields;
+        WarpX::GetInstance().EnableCostsBreakdown();
+    }
 }
 
 // function that gathers costs
@@ -118,6 +134,18 @@ void LoadBalanceCosts::ComputeDiags (int step)
         warpx.ComputeCostsHeuristic(costs);
     }
 
+    // iterations of the second-order LLG solver since the previous output, done by all the
+    // boxes with magnetic material
+    amrex::Real llg_iterations = 0.0_rt;
+#ifdef WARPX_MAG_LLG
+    if (m_breakdown && WarpX::em_solver_medium == MediumForEM::Macroscopic)
+    {
+        const long llg_iter_total = warpx.GetFiniteDifferenceSolver(0).GetLLGTotalIterations();
+        llg_iterations = static_cast<amrex::Real>(llg_iter_total - m_llg_iter_prev);
+        m_llg_iter_prev = llg_iter_total;
+    }
+#endif
+
     // keep track of correct index in array over all boxes on all levels
     // shift index for m_data
     int shift_m_data = 0;
@@ -127,6 +155,8 @@ void LoadBalanceCosts::ComputeDiags (int step)
     {
         const amrex::DistributionMapping& dm = warpx.DistributionMap(lev);
         const MultiFab & Ex = warpx.getEfield(lev,0);
+        const amrex::Vector<amrex::Real> n_mag = (m_breakdown) ?
+            warpx.MagneticFacesPerBox(lev) : amrex::Vector<amrex::Real>{};
         for (MFIter mfi(Ex, false); mfi.isValid(); ++mfi)
         {
             const Box& tbx = mfi.tilebox();
@@ -149,6 +179,17 @@ void LoadBalanceCosts::ComputeDiags (int step)
 #ifdef AMREX_USE_GPU
             m_data[shift_m_data + mfi.index()*m_nDataFields + 8] = amrex::Gpu::Device::deviceId();
 #endif
+            if (m_breakdown)
+            {
+                const int ib = shift_m_data + mfi.index()*m_nDataFields + m_nDataFields - m_nBreakdownFields;
+                for (int phase = 0; phase < CostPhase::NumPhases; ++phase)
+                {
+                    const amrex::LayoutData<amrex::Real>* breakdown = warpx.getCostsBreakdown(lev, phase);
+                    m_data[ib + phase] = (breakdown) ? (*breakdown)[mfi.index()] : 0.0_rt;
+                }
+                m_data[ib + CostPhase::NumPhases] = n_mag[mfi.index()];
+                m_data[ib + CostPhase::NumPhases + 1] = (n_mag[mfi.index()] > 0.0_rt) ? llg_iterations : 0.0_rt;
+            }
             // ...
         }
 
@@ -156,6 +197,9 @@ void LoadBalanceCosts::ComputeDiags (int step)
         shift_m_data += m_nDataFields*(costs[lev]->size());
     }
 
+    // the breakdown of each output covers the steps since the previous output
+    if (m_breakdown) warpx.ResetCostsBreakdown();
+
     // parallel reduce to IO proc and get data over all procs
     ParallelDescriptor::ReduceRealSum(m_data.data(),
                                       m_data.size(),
@@ -230,6 +274,9 @@ void LoadBalanceCosts::ComputeDiags (int step)
      *   [cost, proc, lev, i_low, j_low, k_low, num_cells, num_macro_particles(, gpu_ID [if GPU run]) ] of box 1 at level 1,
      *   [cost, proc, lev, i_low, j_low, k_low, num_cells, num_macro_particles(, gpu_ID [if GPU run]) ] of box 2 at level 1,
      *   ...]
+     * followed in each box, if breakdown, by
+     *  [cost_EB_update, cost_HM_update, cost_PML, cost_excitation, cost_particles, cost_exchange,
+     *   num_mag_faces, llg_iterations]
      * and m_data_string contains:
      *  [hostname of box 0 at level 0,
      *   hostname of box 1 at level 0,
@@ -293,7 +340,7 @@ void LoadBalanceCosts::WriteToFile (int step) const
 
         // write header row
         // for each box on each level we saved 9(10) data fields:
-        //   [cost, proc, lev, i_low, j_low, k_low, num_cells, num_macro_particles(, gpu_ID_box), hostname]
+        //   [cost, proc, lev, i_low, j_low, k_low, num_cells, num_macro_particles(, gpu_ID_box)(, breakdown), hostname]
         // nDataFieldsToWrite = below accounts for the Real data fields (m_nDataFields), then 1 string output to write
         int nDataFieldsToWrite = m_nDataFields + 1;
 
@@ -325,6 +372,18 @@ void LoadBalanceCosts::WriteToFile (int step) const
             ofstmp << m_sep;
             ofstmp << "[" << c++ << "]gpu_ID_box_" + std::to_string(boxNumber) + "()";
 #endif
+            if (m_breakdown)
+            {
+                for (int phase = 0; phase < CostPhase::NumPhases; ++phase)
+                {
+                    ofstmp << m_sep;
+                    ofstmp << "[" << c++ << "]cost_" + std::string(CostPhaseName(phase)) + "_box_" + std::to_string(boxNumber) + "(s)";
+                }
+                ofstmp << m_sep;
+                ofstmp << "[" << c++ << "]num_mag_faces_" + std::to_string(boxNumber) + "()";
+                ofstmp << m_sep;
+                ofstmp << "[" << c++ << "]llg_iterations_" + std::to_string(boxNumber) + "()";
+            }
             ofstmp << m_sep;
             ofstmp << "[" << c++ << "]hostname_box_" + std::to_string(boxNumber) + "()";
         }
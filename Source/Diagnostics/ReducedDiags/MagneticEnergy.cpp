@@ -0,0 +1,297 @@
+/* This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+
+#include "MagneticEnergy.H"
+
+#include "FieldSolver/FiniteDifferenceSolver/FiniteDifferenceAlgorithms/CartesianYeeAlgorithm.H"
+#include "FieldSolver/FiniteDifferenceSolver/MacroscopicProperties/MacroscopicProperties.H"
+#include "Utils/IntervalsParser.H"
+#include "Utils/TextMsg.H"
+#include "Utils/WarpXConst.H"
+#include "WarpX.H"
+
+#include <AMReX.H>
+#include <AMReX_Array.H>
+#include <AMReX_Array4.H>
+#include <AMReX_Box.H>
+#include <AMReX_GpuControl.H>
+#include <AMReX_GpuDevice.H>
+#include <AMReX_GpuQualifiers.H>
+#include <AMReX_IntVect.H>
+#include <AMReX_MFIter.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_REAL.H>
+#include <AMReX_Reduce.H>
+#include <AMReX_Tuple.H>
+#include <AMReX_Vector.H>
+
+#include <cmath>
+#include <fstream>
+#include <ostream>
+#include <vector>
+
+using namespace amrex;
+
+// constructor
+MagneticEnergy::MagneticEnergy (std::string rd_name)
+: ReducedDiags{rd_name}
+{
+#if (defined WARPX_DIM_RZ) || !(defined WARPX_MAG_LLG)
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(false,
+        "MagneticEnergy reduced diagnostics requires USE_LLG=TRUE and does not work for RZ coordinate.");
+#endif
+#ifdef WARPX_MAG_LLG
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(WarpX::mag_LLG,
+        "MagneticEnergy reduced diagnostics requires warpx.mag_LLG = 1.");
+#endif
+
+    // volume of the material, average |M|, Mx, My and Mz,
+    // Zeeman, exchange, anisotropy and total energies
+    constexpr int noutputs = 9;
+    // resize data array
+    m_data.resize(noutputs, 0.0_rt);
+
+    if (ParallelDescriptor::IOProcessor())
+    {
+        if ( m_IsNotRestart )
+        {
+            // open file
+            std::ofstream ofs{m_path + m_rd_name + "." + m_extension, std::ofstream::out};
+            // write header row
+            int c = 0;
+            ofs << "#";
+            ofs << "[" << c++ << "]step()";
+            ofs << m_sep;
+            ofs << "[" << c++ << "]time(s)";
+            ofs << m_sep;
+            ofs << "[" << c++ << "]volume(m^3)";
+            ofs << m_sep;
+            ofs << "[" << c++ << "]avg_|M|(A/m)";
+            ofs << m_sep;
+            ofs << "[" << c++ << "]avg_Mx(A/m)";
+            ofs << m_sep;
+            ofs << "[" << c++ << "]avg_My(A/m)";
+            ofs << m_sep;
+            ofs << "[" << c++ << "]avg_Mz(A/m)";
+            ofs << m_sep;
+            ofs << "[" << c++ << "]zeeman(J)";
+            ofs << m_sep;
+            ofs << "[" << c++ << "]exchange(J)";
+            ofs << m_sep;
+            ofs << "[" << c++ << "]anisotropy(J)";
+            ofs << m_sep;
+            ofs << "[" << c++ << "]total(J)";
+            ofs << std::endl;
+            // close file
+            ofs.close();
+        }
+    }
+}
+// end constructor
+
+// function that computes the micromagnetic energies
+void MagneticEnergy::ComputeDiags (int step)
+{
+#if !(defined WARPX_DIM_RZ) && (defined WARPX_MAG_LLG)
+    // Judge if the diags should be done
+    if (!m_intervals.contains(step+1)) { return; }
+
+    auto & warpx = WarpX::GetInstance();
+    auto & macroscopic_properties = warpx.GetMacroscopicProperties();
+    // level 0, onto which the finer levels of the LLG solver are averaged down
+    constexpr int lev = 0;
+
+    std::array<MultiFab*, 3> const Mfield{warpx.get_pointer_Mfield_fp(lev,0),
+                                          warpx.get_pointer_Mfield_fp(lev,1),
+                                          warpx.get_pointer_Mfield_fp(lev,2)};
+    std::array<MultiFab*, 3> const H_biasfield{warpx.get_pointer_H_biasfield_fp(lev,0),
+                                               warpx.get_pointer_H_biasfield_fp(lev,1),
+                                               warpx.get_pointer_H_biasfield_fp(lev,2)};
+
+    // same stencil as the exchange field of the LLG solver
+    std::array<Real,3> cell_size = WarpX::CellSize(lev);
+    if (m_stencil_coefs_x.empty()) {
+        Vector<Real> h_coefs_x, h_coefs_y, h_coefs_z;
+        CartesianYeeAlgorithm::InitializeStencilCoefficients(cell_size, h_coefs_x, h_coefs_y, h_coefs_z,
+            warpx.GetGradedMesh().IsGraded() ? &warpx.GetGradedMesh() : nullptr);
+        m_stencil_coefs_x.resize(h_coefs_x.size());
+        m_stencil_coefs_y.resize(h_coefs_y.size());
+        m_stencil_coefs_z.resize(h_coefs_z.size());
+        Gpu::copyAsync(Gpu::hostToDevice, h_coefs_x.begin(), h_coefs_x.end(), m_stencil_coefs_x.begin());
+        Gpu::copyAsync(Gpu::hostToDevice, h_coefs_y.begin(), h_coefs_y.end(), m_stencil_coefs_y.begin());
+        Gpu::copyAsync(Gpu::hostToDevice, h_coefs_z.begin(), h_coefs_z.end(), m_stencil_coefs_z.begin());
+        Gpu::synchronize();
+    }
+    Real const *const AMREX_RESTRICT coefs_x = m_stencil_coefs_x.dataPtr();
+    int const n_coefs_x = m_stencil_coefs_x.size();
+    Real const *const AMREX_RESTRICT coefs_y = m_stencil_coefs_y.dataPtr();
+    int const n_coefs_y = m_stencil_coefs_y.size();
+    Real const *const AMREX_RESTRICT coefs_z = m_stencil_coefs_z.dataPtr();
+    int const n_coefs_z = m_stencil_coefs_z.size();
+
+    // the faces shared by several boxes are only counted by their owner
+    Periodicity const period = warpx.Geom(lev).periodicity();
+    for (int d = 0; d < 3; ++d) {
+        auto& mask = m_owner_masks[d];
+        if (!mask || mask->boxArray() != Mfield[d]->boxArray() ||
+            mask->DistributionMap() != Mfield[d]->DistributionMap()) {
+            mask = Mfield[d]->OwnerMask(period);
+        }
+    }
+
+    bool const graded = warpx.GetGradedMesh().IsGraded();
+    bool const exchange_coupling = warpx.mag_LLG_exchange_coupling == 1;
+    bool const anisotropy_coupling = warpx.mag_LLG_anisotropy_coupling == 1;
+    Real const* const anisotropy_axes = macroscopic_properties.getmag_anisotropy_axes();
+    int const anisotropy_type = macroscopic_properties.getmag_anisotropy_type();
+    GpuArray<IntVect, 3> const M_stag{Mfield[0]->ixType().toIntVect(),
+                                      Mfield[1]->ixType().toIntVect(),
+                                      Mfield[2]->ixType().toIntVect()};
+    // H_bias is either stored on the faces, or uniform (warpx.mag_H_bias_uniform = 1)
+    bool const H_bias_uniform = (H_biasfield[0] == nullptr);
+    GpuArray<Real, 3> const H_bias_value = H_bias_uniform
+        ? warpx.getH_bias_uniform(lev) : GpuArray<Real, 3>{0._rt, 0._rt, 0._rt};
+    GpuArray<IntVect, 3> const H_bias_stag = H_bias_uniform ? M_stag
+        : GpuArray<IntVect, 3>{H_biasfield[0]->ixType().toIntVect(),
+                               H_biasfield[1]->ixType().toIntVect(),
+                               H_biasfield[2]->ixType().toIntVect()};
+
+    // number of faces, |M|, Mx, My, Mz, then the Zeeman, exchange and anisotropy energy densities
+    ReduceOps<ReduceOpSum, ReduceOpSum, ReduceOpSum, ReduceOpSum,
+              ReduceOpSum, ReduceOpSum, ReduceOpSum, ReduceOpSum> reduce_op;
+    ReduceData<Real, Real, Real, Real, Real, Real, Real, Real> reduce_data(reduce_op);
+    using ReduceTuple = typename decltype(reduce_data)::Type;
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi(*Mfield[0], TilingIfNotGPU()); mfi.isValid(); ++mfi)
+    {
+        // skip the boxes that do not contain any magnetic material
+        if (!macroscopic_properties.has_magnetic_material(mfi.index())) continue;
+
+        Array4<Real> const Hx_bias = H_bias_uniform ? Array4<Real>{} : H_biasfield[0]->array(mfi);
+        Array4<Real> const Hy_bias = H_bias_uniform ? Array4<Real>{} : H_biasfield[1]->array(mfi);
+        Array4<Real> const Hz_bias = H_bias_uniform ? Array4<Real>{} : H_biasfield[2]->array(mfi);
+
+        for (int d = 0; d < 3; ++d)
+        {
+            Array4<Real> const& M_face = Mfield[d]->array(mfi);
+            Array4<Real> const& Ms_arr = macroscopic_properties.getmag_Ms_mf(d).array(mfi);
+            Array4<MacroscopicProperties::MagCoefReal const> const& coefs_arr =
+                macroscopic_properties.getmag_coefs_mf(d).const_array(mfi);
+            Array4<int const> const grain_arr = macroscopic_properties.getmag_grain_array(d, mfi);
+            Array4<int const> const& owner = m_owner_masks[d]->const_array(mfi);
+            IntVect const stag = M_stag[d];
+            Box const& tb = mfi.tilebox(stag);
+
+            reduce_op.eval(tb, reduce_data,
+            [=] AMREX_GPU_DEVICE (int i, int j, int k) -> ReduceTuple
+            {
+                Real const Ms = Ms_arr(i,j,k);
+                if (Ms <= 0._rt || !owner(i,j,k)) {
+                    return {0._rt, 0._rt, 0._rt, 0._rt, 0._rt, 0._rt, 0._rt, 0._rt};
+                }
+                Real const Mx = M_face(i,j,k,0);
+                Real const My = M_face(i,j,k,1);
+                Real const Mz = M_face(i,j,k,2);
+
+                // on a graded mesh, each face counts for its volume relative to the uniform cells
+                Real rel_vol = 1._rt;
+#if defined(WARPX_DIM_3D)
+                if (graded) {
+                    using Algo = CartesianYeeAlgorithm;
+                    rel_vol = coefs_x[0] / (stag[0] ? Algo::InvNodeSize(coefs_x, n_coefs_x, i)
+                                                    : Algo::InvCellSize(coefs_x, n_coefs_x, i))
+                            * coefs_y[0] / (stag[1] ? Algo::InvNodeSize(coefs_y, n_coefs_y, j)
+                                                    : Algo::InvCellSize(coefs_y, n_coefs_y, j))
+                            * coefs_z[0] / (stag[2] ? Algo::InvNodeSize(coefs_z, n_coefs_z, k)
+                                                    : Algo::InvCellSize(coefs_z, n_coefs_z, k));
+                }
+#else
+                amrex::ignore_unused(graded);
+#endif
+
+                // H_bias interpolated to the face, as in the LLG solver
+                Real const Hbx = MacroscopicProperties::getH_bias(i, j, k, H_bias_stag[0], stag, Hx_bias, H_bias_uniform, H_bias_value[0]);
+                Real const Hby = MacroscopicProperties::getH_bias(i, j, k, H_bias_stag[1], stag, Hy_bias, H_bias_uniform, H_bias_value[1]);
+                Real const Hbz = MacroscopicProperties::getH_bias(i, j, k, H_bias_stag[2], stag, Hz_bias, H_bias_uniform, H_bias_value[2]);
+                Real const e_zeeman = - PhysConst::mu0 * (Mx*Hbx + My*Hby + Mz*Hbz);
+
+                Real e_exchange = 0._rt;
+                if (exchange_coupling) {
+                    Real const H_exchange_coeff = coefs_arr(i,j,k,MacroscopicProperties::mag_coef_exchange);
+                    Real const Ms_lo_x = Ms_arr(i-1, j, k);
+                    Real const Ms_hi_x = Ms_arr(i+1, j, k);
+                    Real const Ms_lo_y = Ms_arr(i, j-1, k);
+                    Real const Ms_hi_y = Ms_arr(i, j+1, k);
+                    Real const Ms_lo_z = Ms_arr(i, j, k-1);
+                    Real const Ms_hi_z = Ms_arr(i, j, k+1);
+                    Real M_dot_H_exchange = 0._rt;
+                    for (int comp = 0; comp < 3; ++comp) {
+                        M_dot_H_exchange += M_face(i,j,k,comp) * H_exchange_coeff *
+                            CartesianYeeAlgorithm::Laplacian_Mag(M_face, coefs_x, coefs_y, coefs_z,
+                                n_coefs_x, n_coefs_y, n_coefs_z, Ms_lo_x, Ms_hi_x, Ms_lo_y, Ms_hi_y,
+                                Ms_lo_z, Ms_hi_z, i, j, k, comp, d);
+                    }
+                    e_exchange = - 0.5_rt * PhysConst::mu0 * M_dot_H_exchange;
+                }
+
+                Real e_anisotropy = 0._rt;
+                if (anisotropy_coupling) {
+                    Real const H_anisotropy_coeff = coefs_arr(i,j,k,MacroscopicProperties::mag_coef_anisotropy);
+                    Real Hx_anisotropy = 0._rt, Hy_anisotropy = 0._rt, Hz_anisotropy = 0._rt;
+                    MacroscopicProperties::addH_anisotropy(i, j, k, grain_arr, anisotropy_axes, anisotropy_type,
+                        H_anisotropy_coeff, Mx, My, Mz, Hx_anisotropy, Hy_anisotropy, Hz_anisotropy);
+                    // the uniaxial energy is quadratic in M, the cubic one quartic
+                    Real const order = (anisotropy_type == 0) ? 2._rt : 4._rt;
+                    e_anisotropy = - PhysConst::mu0 / order
+                                   * (Mx*Hx_anisotropy + My*Hy_anisotropy + Mz*Hz_anisotropy);
+                }
+
+                return {rel_vol, rel_vol*std::sqrt(Mx*Mx + My*My + Mz*Mz), rel_vol*Mx, rel_vol*My,
+                        rel_vol*Mz, rel_vol*e_zeeman, rel_vol*e_exchange, rel_vol*e_anisotropy};
+            });
+        }
+    }
+
+    auto const r = reduce_data.value();
+    m_data[0] = amrex::get<0>(r);
+    m_data[1] = amrex::get<1>(r);
+    m_data[2] = amrex::get<2>(r);
+    m_data[3] = amrex::get<3>(r);
+    m_data[4] = amrex::get<4>(r);
+    m_data[5] = amrex::get<5>(r);
+    m_data[6] = amrex::get<6>(r);
+    m_data[7] = amrex::get<7>(r);
+
+    // each of the three face grids of M covers the material
+#if defined(WARPX_DIM_1D_Z)
+    Real const dV = cell_size[2];
+#elif defined(WARPX_DIM_XZ)
+    Real const dV = cell_size[0] * cell_size[2];
+#else
+    Real const dV = cell_size[0] * cell_size[1] * cell_size[2];
+#endif
+
+    // MPI reduce of all the sums at once
+    ParallelReduce(ReductionBatch::Op::Sum, m_data.data(), 8, [this, dV] ()
+    {
+        Real const w = dV / 3._rt;
+        Real const inv_count = (m_data[0] > 0._rt) ? 1._rt / m_data[0] : 0._rt;
+
+        m_data[0] *= w;
+        for (int n = 1; n <= 4; ++n) m_data[n] *= inv_count;
+        for (int n = 5; n <= 7; ++n) m_data[n] *= w;
+        m_data[8] = m_data[5] + m_data[6] + m_data[7];
+        /* m_data now contains up-to-date values for:
+         *  [volume, avg(|M|), avg(Mx), avg(My), avg(Mz), zeeman, exchange, anisotropy, total] */
+    });
+#else
+    amrex::ignore_unused(step);
+#endif
+}
+// end void MagneticEnergy::ComputeDiags
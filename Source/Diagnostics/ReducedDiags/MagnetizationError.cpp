@@ -0,0 +1,189 @@
+/* This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+
+#include "MagnetizationError.H"
+
+#include "FieldSolver/FiniteDifferenceSolver/MacroscopicProperties/MacroscopicProperties.H"
+#include "Utils/IntervalsParser.H"
+#include "Utils/TextMsg.H"
+#include "Utils/WarpXUtil.H"
+#include "WarpX.H"
+
+#include <AMReX.H>
+#include <AMReX_Array4.H>
+#include <AMReX_Box.H>
+#include <AMReX_GpuAtomic.H>
+#include <AMReX_GpuContainers.H>
+#include <AMReX_GpuControl.H>
+#include <AMReX_GpuQualifiers.H>
+#include <AMReX_IntVect.H>
+#include <AMReX_MFIter.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_REAL.H>
+#include <AMReX_Reduce.H>
+#include <AMReX_Tuple.H>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <ostream>
+#include <vector>
+
+using namespace amrex;
+
+// constructor
+MagnetizationError::MagnetizationError (std::string rd_name)
+: ReducedDiags{rd_name}
+{
+#if (defined WARPX_DIM_RZ) || !(defined WARPX_MAG_LLG)
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(false,
+        "MagnetizationError reduced diagnostics requires USE_LLG=TRUE and does not work for RZ coordinate.");
+#endif
+#ifdef WARPX_MAG_LLG
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(WarpX::mag_LLG,
+        "MagnetizationError reduced diagnostics requires warpx.mag_LLG = 1.");
+#endif
+
+    ParmParse pp_rd_name(rd_name);
+
+    // read bin parameters
+    queryWithParser(pp_rd_name, "bin_number", m_bin_num);
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(m_bin_num >= 1, rd_name + ".bin_number must be at least 1");
+    // by default, the histogram spans the error that aborts the simulation
+    m_bin_max = WarpX::GetInstance().GetMacroscopicProperties().getmag_normalized_error();
+    queryWithParser(pp_rd_name, "bin_max", m_bin_max);
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(m_bin_max > 0._rt, rd_name + ".bin_max must be positive");
+    m_bin_size = m_bin_max / m_bin_num;
+
+    // number of magnetic faces, maximum and mean error, then the fraction of faces per bin
+    m_data.resize(3 + m_bin_num, 0.0_rt);
+
+    if (ParallelDescriptor::IOProcessor())
+    {
+        if ( m_IsNotRestart )
+        {
+            // open file
+            std::ofstream ofs{m_path + m_rd_name + "." + m_extension, std::ofstream::out};
+            // write header row
+            int c = 0;
+            ofs << "#";
+            ofs << "[" << c++ << "]step()";
+            ofs << m_sep;
+            ofs << "[" << c++ << "]time(s)";
+            ofs << m_sep;
+            ofs << "[" << c++ << "]faces()";
+            ofs << m_sep;
+            ofs << "[" << c++ << "]max_error()";
+            ofs << m_sep;
+            ofs << "[" << c++ << "]mean_error()";
+            for (int i = 0; i < m_bin_num; ++i)
+            {
+                ofs << m_sep;
+                ofs << "[" << c++ << "]";
+                Real b = m_bin_size*(Real(i)+0.5_rt);
+                ofs << "bin" + std::to_string(1+i)
+                             + "=" + std::to_string(b) + "()";
+            }
+            ofs << std::endl;
+            // close file
+            ofs.close();
+        }
+    }
+}
+// end constructor
+
+// function that computes the distribution of the normalization error of M
+void MagnetizationError::ComputeDiags (int step)
+{
+#if !(defined WARPX_DIM_RZ) && (defined WARPX_MAG_LLG)
+    // Judge if the diags should be done
+    if (!m_intervals.contains(step+1)) { return; }
+
+    auto & warpx = WarpX::GetInstance();
+    auto & macroscopic_properties = warpx.GetMacroscopicProperties();
+    // level 0, onto which the finer levels of the LLG solver are averaged down
+    constexpr int lev = 0;
+
+    std::array<MultiFab*, 3> Mfield;
+    for (int d = 0; d < 3; ++d) {
+        Mfield[d] = warpx.get_pointer_Mfield_fp(lev, d);
+    }
+
+    // the faces shared by several boxes are only counted by their owner
+    Periodicity const period = warpx.Geom(lev).periodicity();
+    for (int d = 0; d < 3; ++d) {
+        auto& mask = m_owner_masks[d];
+        if (!mask || mask->boxArray() != Mfield[d]->boxArray() ||
+            mask->DistributionMap() != Mfield[d]->DistributionMap()) {
+            mask = Mfield[d]->OwnerMask(period);
+        }
+    }
+
+    int const num_bins = m_bin_num;
+    Real const bin_size = m_bin_size;
+    Gpu::DeviceVector<Real> d_bins(num_bins, 0.0_rt);
+    Real* const AMREX_RESTRICT dptr_bins = d_bins.dataPtr();
+
+    // number of faces, sum and maximum of the error
+    ReduceOps<ReduceOpSum, ReduceOpSum, ReduceOpMax> reduce_op;
+    ReduceData<Real, Real, Real> reduce_data(reduce_op);
+    using ReduceTuple = typename decltype(reduce_data)::Type;
+
+    for (MFIter mfi(*Mfield[0], TilingIfNotGPU()); mfi.isValid(); ++mfi)
+    {
+        // skip the boxes that do not contain any magnetic material
+        if (!macroscopic_properties.has_magnetic_material(mfi.index())) continue;
+
+        for (int d = 0; d < 3; ++d)
+        {
+            Array4<Real const> const& M_face = Mfield[d]->const_array(mfi);
+            Array4<Real const> const& Ms_arr = macroscopic_properties.getmag_Ms_mf(d).const_array(mfi);
+            Array4<int const> const& owner = m_owner_masks[d]->const_array(mfi);
+            Box const& tb = mfi.tilebox(Mfield[d]->ixType().toIntVect());
+
+            reduce_op.eval(tb, reduce_data,
+            [=] AMREX_GPU_DEVICE (int i, int j, int k) -> ReduceTuple
+            {
+                Real const Ms = Ms_arr(i,j,k);
+                if (Ms <= 0._rt || !owner(i,j,k)) return {0._rt, 0._rt, 0._rt};
+
+                Real M_norm2 = 0._rt;
+                for (int comp = 0; comp < 3; ++comp) {
+                    M_norm2 += M_face(i,j,k,comp) * M_face(i,j,k,comp);
+                }
+                Real const error = std::abs(std::sqrt(M_norm2) / Ms - 1._rt);
+
+                // the errors beyond bin_max are added to the last bin
+                int const bin = std::min(static_cast<int>(error / bin_size), num_bins - 1);
+                amrex::HostDevice::Atomic::Add(&dptr_bins[bin], 1.0_rt);
+
+                return {1._rt, error, error};
+            });
+        }
+    }
+
+    auto const r = reduce_data.value();
+    m_data[0] = amrex::get<0>(r);
+    m_data[1] = amrex::get<2>(r);
+    m_data[2] = amrex::get<1>(r);
+    Gpu::copy(Gpu::deviceToHost, d_bins.begin(), d_bins.end(), m_data.begin() + 3);
+
+    // MPI reduce of the maximum, then of the sums and the histogram
+    ParallelReduce(ReductionBatch::Op::Max, &m_data[1], 1);
+    ParallelReduce(ReductionBatch::Op::Sum, m_data.data(), 1);
+    ParallelReduce(ReductionBatch::Op::Sum, &m_data[2], 1 + num_bins, [this] ()
+    {
+        Real const inv_count = (m_data[0] > 0._rt) ? 1._rt / m_data[0] : 0._rt;
+        for (std::size_t n = 2; n < m_data.size(); ++n) m_data[n] *= inv_count;
+        /* m_data now contains up-to-date values for:
+         *  [faces, max error, mean error, fraction of faces in each bin] */
+    });
+#else
+    amrex::ignore_unused(step);
+#endif
+}
+// end void MagnetizationError::ComputeDiags
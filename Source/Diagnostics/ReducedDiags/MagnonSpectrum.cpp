@@ -0,0 +1,336 @@
+/* This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+
+#include "MagnonSpectrum.H"
+
+#include "Utils/IntervalsParser.H"
+#include "Utils/TextMsg.H"
+#include "Utils/WarpXConst.H"
+#include "Utils/WarpXProfilerWrapper.H"
+#include "Utils/WarpXUtil.H"
+#include "WarpX.H"
+
+#include <AMReX.H>
+#include <AMReX_Array4.H>
+#include <AMReX_Box.H>
+#include <AMReX_BoxArray.H>
+#include <AMReX_Geometry.H>
+#include <AMReX_GpuContainers.H>
+#include <AMReX_GpuLaunch.H>
+#include <AMReX_GpuQualifiers.H>
+#include <AMReX_IndexType.H>
+#include <AMReX_IntVect.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_REAL.H>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <ostream>
+#include <vector>
+
+using namespace amrex;
+
+#if (defined WARPX_USE_PSATD) && (defined WARPX_MAG_LLG) && \
+    ((defined WARPX_DIM_3D) || (defined WARPX_DIM_XZ))
+#   define WARPX_MAGNON_SPECTRUM 1
+#endif
+
+// constructor
+MagnonSpectrum::MagnonSpectrum (std::string rd_name)
+: ReducedDiags{rd_name}
+{
+#ifndef WARPX_MAGNON_SPECTRUM
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(false,
+        "MagnonSpectrum reduced diagnostics requires USE_LLG=TRUE and USE_PSATD=TRUE, "
+        "and only works in 2D and 3D Cartesian geometry.");
+#endif
+#ifdef WARPX_MAG_LLG
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(WarpX::mag_LLG,
+        "MagnonSpectrum reduced diagnostics requires warpx.mag_LLG = 1.");
+#endif
+
+    ParmParse pp_rd_name(rd_name);
+
+    m_fields = {"Mx", "My", "Mz"};
+    pp_rd_name.queryarr("fields", m_fields);
+    for (auto const& field : m_fields) {
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(field == "Mx" || field == "My" || field == "Mz",
+            rd_name + ".fields: " + field + " is not a component of M");
+    }
+
+    std::string direction;
+    pp_rd_name.get("direction", direction);
+#if (defined WARPX_DIM_XZ)
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(direction == "x" || direction == "z",
+        rd_name + ".direction must be x or z");
+    m_dir = (direction == "x") ? 0 : 1;
+#else
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(direction == "x" || direction == "y" || direction == "z",
+        rd_name + ".direction must be x, y or z");
+    m_dir = direction[0] - 'x';
+#endif
+
+    getArrWithParser(pp_rd_name, "origin", m_origin, 0, AMREX_SPACEDIM);
+
+    getWithParser(pp_rd_name, "window_size", m_window_size);
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(m_window_size >= 2,
+        rd_name + ".window_size must be at least 2");
+
+    m_nx = WarpX::GetInstance().Geom(0).Domain().length(m_dir);
+
+    int const nfields = static_cast<int>(m_fields.size());
+    m_index_ba.resize(nfields);
+    m_index_dm.resize(nfields);
+    m_sample_fab.resize(nfields);
+    m_sample_i.resize(nfields);
+    m_sample_j.resize(nfields);
+    m_sample_k.resize(nfields);
+    m_sample_pos.resize(nfields);
+
+    // dk, df and the power of each (k, f): k from -nx/2 dk, f from 0 to window_size/2 df
+    int const nf = m_window_size / 2 + 1;
+    m_data.resize(2 + m_nx * nf, 0.0_rt);
+
+    if (ParallelDescriptor::IOProcessor())
+    {
+        if ( m_IsNotRestart )
+        {
+            // open file
+            std::ofstream ofs{m_path + m_rd_name + "." + m_extension, std::ofstream::out};
+            // write header row
+            int c = 0;
+            ofs << "#";
+            ofs << "[" << c++ << "]step()";
+            ofs << m_sep;
+            ofs << "[" << c++ << "]time(s)";
+            ofs << m_sep;
+            ofs << "[" << c++ << "]dk(1/m)";
+            ofs << m_sep;
+            ofs << "[" << c++ << "]df(Hz)";
+            for (int i = 0; i < m_nx; ++i) {
+                for (int j = 0; j < nf; ++j) {
+                    ofs << m_sep;
+                    ofs << "[" << c++ << "]P_k" << i - m_nx/2 << "_f" << j << "((A/m)^2)";
+                }
+            }
+            ofs << std::endl;
+            // close file
+            ofs.close();
+        }
+    }
+}
+// end constructor
+
+MagnonSpectrum::~MagnonSpectrum ()
+{
+#ifdef WARPX_MAGNON_SPECTRUM
+    if (m_plan_created) AnyFFT::DestroyPlan(m_plan);
+#endif
+}
+
+void MagnonSpectrum::UpdateIndices (int f)
+{
+#ifdef WARPX_MAGNON_SPECTRUM
+    // the component dir of M lives on the faces normal to dir
+    int const comp = m_fields[f][1] - 'x';
+    MultiFab const* mf = WarpX::GetInstance().get_pointer_Mfield_fp(0, comp);
+    BoxArray const& ba = mf->boxArray();
+    DistributionMapping const& dm = mf->DistributionMap();
+    if (ba == m_index_ba[f] && dm == m_index_dm[f]) return;
+    m_index_ba[f] = ba;
+    m_index_dm[f] = dm;
+
+    auto const& geom = WarpX::GetInstance().Geom(0);
+    IndexType const ixtype = ba.ixType();
+
+    // grid point of the component nearest to the line, in the directions normal to it
+    IntVect iv;
+    for (int d = 0; d < AMREX_SPACEDIM; ++d) {
+        Real const s = (m_origin[d] - geom.ProbLo(d)) / geom.CellSize(d);
+        iv[d] = ixtype.nodeCentered(d) ? static_cast<int>(std::round(s))
+                                       : static_cast<int>(std::floor(s));
+    }
+
+    Vector<int> h_fab, h_i, h_j, h_k, h_pos;
+    int const lo = geom.Domain().smallEnd(m_dir);
+    for (int ix = 0; ix < m_nx; ++ix) {
+        iv[m_dir] = lo + ix;
+        // the sample is read by the rank owning the first box that contains it
+        auto const isects = ba.intersections(Box(iv, iv, ixtype), true, 0);
+        if (isects.empty() || dm[isects[0].first] != ParallelDescriptor::MyProc()) continue;
+
+        h_fab.push_back(mf->localindex(isects[0].first));
+        h_i.push_back(iv[0]);
+        h_j.push_back(iv[1]);
+#if (defined WARPX_DIM_3D)
+        h_k.push_back(iv[2]);
+#else
+        h_k.push_back(0);
+#endif
+        h_pos.push_back(ix);
+    }
+
+    auto const copy_to_device = [] (Vector<int> const& h, Gpu::DeviceVector<int>& d) {
+        d.resize(h.size());
+        Gpu::copyAsync(Gpu::hostToDevice, h.begin(), h.end(), d.begin());
+    };
+    copy_to_device(h_fab, m_sample_fab[f]);
+    copy_to_device(h_i, m_sample_i[f]);
+    copy_to_device(h_j, m_sample_j[f]);
+    copy_to_device(h_k, m_sample_k[f]);
+    copy_to_device(h_pos, m_sample_pos[f]);
+    Gpu::synchronize();
+#else
+    amrex::ignore_unused(f);
+#endif
+}
+
+// function that samples M along the line
+void MagnonSpectrum::ComputeDiags (int step)
+{
+#ifdef WARPX_MAGNON_SPECTRUM
+    // Judge if the diags should be done
+    if (!m_intervals.contains(step+1)) { return; }
+
+    WARPX_PROFILE("MagnonSpectrum::ComputeDiags()");
+
+    int const nfields = static_cast<int>(m_fields.size());
+    int const nt = m_window_size;
+    int const nx = m_nx;
+
+    if (m_samples.empty()) {
+        m_samples.resize(nfields * nx * nt);
+        Real* const AMREX_RESTRICT samples = m_samples.dataPtr();
+        amrex::ParallelFor(nfields * nx * nt, [=] AMREX_GPU_DEVICE (int n) noexcept {
+            samples[n] = 0.0_rt;
+        });
+    }
+
+    int const it = m_nsamples;
+    for (int f = 0; f < nfields; ++f) {
+        UpdateIndices(f);
+        int const nsamples = static_cast<int>(m_sample_fab[f].size());
+        if (nsamples == 0) continue;
+
+        int const comp = m_fields[f][1] - 'x';
+        auto const M_arrays = WarpX::GetInstance().get_pointer_Mfield_fp(0, comp)->const_arrays();
+        Real* const AMREX_RESTRICT samples = m_samples.dataPtr() + f * nx * nt;
+        int const* const AMREX_RESTRICT fab = m_sample_fab[f].dataPtr();
+        int const* const AMREX_RESTRICT ii = m_sample_i[f].dataPtr();
+        int const* const AMREX_RESTRICT jj = m_sample_j[f].dataPtr();
+        int const* const AMREX_RESTRICT kk = m_sample_k[f].dataPtr();
+        int const* const AMREX_RESTRICT pos = m_sample_pos[f].dataPtr();
+        amrex::ParallelFor(nsamples, [=] AMREX_GPU_DEVICE (int s) noexcept {
+            samples[it + nt * pos[s]] = M_arrays[fab[s]](ii[s], jj[s], kk[s], comp);
+        });
+    }
+
+    Real const time = WarpX::GetInstance().gett_new(0);
+    if (m_nsamples == 0) m_t_first = time;
+    m_t_last = time;
+    ++m_nsamples;
+
+    if (m_nsamples == m_window_size) {
+        ComputeSpectrum();
+        m_nsamples = 0;
+        m_spectrum_ready = true;
+    }
+#else
+    amrex::ignore_unused(step);
+#endif
+}
+// end void MagnonSpectrum::ComputeDiags
+
+void MagnonSpectrum::ComputeSpectrum ()
+{
+#ifdef WARPX_MAGNON_SPECTRUM
+    int const nfields = static_cast<int>(m_fields.size());
+    int const nt = m_window_size;
+    int const nx = m_nx;
+    int const nf = nt / 2 + 1;
+    int const n = nfields * nx * nt;
+
+    // each sample is read by one rank only: the sum gathers the window on the I/O processor
+    std::vector<Real> h_samples(n);
+    Gpu::copy(Gpu::deviceToHost, m_samples.begin(), m_samples.end(), h_samples.begin());
+    ParallelDescriptor::ReduceRealSum(h_samples.data(), n, ParallelDescriptor::IOProcessorNumber());
+
+    Real* const AMREX_RESTRICT samples = m_samples.dataPtr();
+    if (!ParallelDescriptor::IOProcessor()) {
+        amrex::ParallelFor(n, [=] AMREX_GPU_DEVICE (int i) noexcept {
+            samples[i] = 0.0_rt;
+        });
+        return;
+    }
+    Gpu::copy(Gpu::hostToDevice, h_samples.begin(), h_samples.end(), m_samples.begin());
+
+    if (!m_plan_created) {
+        m_fft_real.resize(nx * nt);
+        m_fft_complex.resize(nx * nf);
+        m_power.resize(nx * nf);
+        // time is the fastest index of the real array, so that f >= 0 is kept by the R2C FFT
+        IntVect fft_size = IntVect::TheUnitVector();
+        fft_size[0] = nt;
+        fft_size[1] = nx;
+        m_plan = AnyFFT::CreatePlan(fft_size, m_fft_real.dataPtr(),
+                                    reinterpret_cast<AnyFFT::Complex*>(m_fft_complex.dataPtr()),
+                                    AnyFFT::direction::R2C, 2);
+        m_plan_created = true;
+    }
+
+    Real* const AMREX_RESTRICT fft_real = m_fft_real.dataPtr();
+    Complex const* const AMREX_RESTRICT fft_complex = m_fft_complex.dataPtr();
+    Real* const AMREX_RESTRICT power = m_power.dataPtr();
+    amrex::ParallelFor(nx * nf, [=] AMREX_GPU_DEVICE (int i) noexcept {
+        power[i] = 0.0_rt;
+    });
+
+    // |M(k,f)|^2 normalized by (nx nt)^2
+    Real const norm = 1.0_rt / (Real(nx) * Real(nx) * Real(nt) * Real(nt));
+    for (int f = 0; f < nfields; ++f) {
+        Real const* const AMREX_RESTRICT field = samples + f * nx * nt;
+        // remove the time average (ground state) and apply a Hann window in time
+        amrex::ParallelFor(nx, [=] AMREX_GPU_DEVICE (int ix) noexcept {
+            Real avg = 0.0_rt;
+            for (int it = 0; it < nt; ++it) avg += field[it + nt * ix];
+            avg /= nt;
+            for (int it = 0; it < nt; ++it) {
+                Real const hann = 0.5_rt * (1.0_rt - std::cos(2.0_rt * MathConst::pi * it / (nt - 1)));
+                fft_real[it + nt * ix] = (field[it + nt * ix] - avg) * hann;
+            }
+        });
+        Gpu::synchronize();
+        AnyFFT::Execute(m_plan);
+        // shift k so that the first row is k = -nx/2 dk
+        amrex::ParallelFor(nx * nf, [=] AMREX_GPU_DEVICE (int n_kf) noexcept {
+            int const i = n_kf / nf;
+            int const j = n_kf - i * nf;
+            int const ix = (i - nx / 2 + nx) % nx;
+            power[n_kf] += amrex::norm(fft_complex[j + nf * ix]) * norm;
+        });
+    }
+
+    auto const& geom = WarpX::GetInstance().Geom(0);
+    m_data[0] = 2.0_rt * MathConst::pi / (nx * geom.CellSize(m_dir));
+    // the outputs of a window are assumed evenly spaced in time
+    Real const dt_sample = (m_t_last - m_t_first) / (nt - 1);
+    m_data[1] = (dt_sample > 0.0_rt) ? 1.0_rt / (nt * dt_sample) : 0.0_rt;
+    Gpu::copy(Gpu::deviceToHost, m_power.begin(), m_power.end(), m_data.begin() + 2);
+
+    amrex::ParallelFor(n, [=] AMREX_GPU_DEVICE (int i) noexcept {
+        samples[i] = 0.0_rt;
+    });
+#endif
+}
+
+void MagnonSpectrum::WriteToFile (int step) const
+{
+    if (!m_spectrum_ready) return;
+    ReducedDiags::WriteToFile(step);
+    m_spectrum_ready = false;
+}
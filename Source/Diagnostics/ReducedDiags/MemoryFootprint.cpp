@@ -0,0 +1,94 @@
+/* This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+
+#include "MemoryFootprint.H"
+
+#include "Utils/IntervalsParser.H"
+#include "Utils/MemoryFootprint.H"
+#include "WarpX.H"
+
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_REAL.H>
+
+#include <algorithm>
+#include <fstream>
+#include <ostream>
+#include <vector>
+
+using namespace amrex::literals;
+
+// constructor
+MemoryFootprint::MemoryFootprint (std::string rd_name)
+: ReducedDiags{rd_name}
+{
+    // maximum and mean of each family, then of the total
+    m_data.resize(2*(MemoryFamily::NumFamilies + 1), 0.0_rt);
+
+    if (amrex::ParallelDescriptor::IOProcessor())
+    {
+        if ( m_IsNotRestart )
+        {
+            // open file
+            std::ofstream ofs{m_path + m_rd_name + "." + m_extension, std::ofstream::out};
+            // write header row
+            int c = 0;
+            ofs << "#";
+            ofs << "[" << c++ << "]step()";
+            ofs << m_sep;
+            ofs << "[" << c++ << "]time(s)";
+            for (int family = 0; family < MemoryFamily::NumFamilies; ++family)
+            {
+                ofs << m_sep;
+                ofs << "[" << c++ << "]" << MemoryFamilyName(family) << "_max(B)";
+            }
+            ofs << m_sep;
+            ofs << "[" << c++ << "]total_max(B)";
+            for (int family = 0; family < MemoryFamily::NumFamilies; ++family)
+            {
+                ofs << m_sep;
+                ofs << "[" << c++ << "]" << MemoryFamilyName(family) << "_mean(B)";
+            }
+            ofs << m_sep;
+            ofs << "[" << c++ << "]total_mean(B)";
+            ofs << std::endl;
+            // close file
+            ofs.close();
+        }
+    }
+}
+// end constructor
+
+// function that computes the bytes of each family of arrays
+void MemoryFootprint::ComputeDiags (int step)
+{
+    // Judge if the diags should be done
+    if (!m_intervals.contains(step+1)) { return; }
+
+    auto & warpx = WarpX::GetInstance();
+    int const nfam = MemoryFamily::NumFamilies;
+
+    std::fill(m_data.begin(), m_data.end(), 0.0_rt);
+    for (int lev = 0; lev <= warpx.finestLevel(); ++lev)
+    {
+        auto const bytes = warpx.MemoryFootprint(lev);
+        for (int family = 0; family < nfam; ++family)
+        {
+            m_data[family] += static_cast<amrex::Real>(bytes[family]);
+            m_data[nfam] += static_cast<amrex::Real>(bytes[family]);
+        }
+    }
+    for (int i = 0; i <= nfam; ++i) m_data[nfam + 1 + i] = m_data[i];
+
+    // MPI reduce of the maxima, then of the sums, which are divided by the number of ranks
+    ParallelReduce(ReductionBatch::Op::Max, m_data.data(), nfam + 1);
+    ParallelReduce(ReductionBatch::Op::Sum, &m_data[nfam + 1], nfam + 1, [this, nfam] ()
+    {
+        amrex::Real const inv_nprocs = 1._rt / amrex::ParallelDescriptor::NProcs();
+        for (int i = nfam + 1; i < 2*(nfam + 1); ++i) m_data[i] *= inv_nprocs;
+        /* m_data now contains up-to-date values for:
+         *  [max of each family, max of the total, mean of each family, mean of the total] */
+    });
+}
+// end void MemoryFootprint::ComputeDiags
@@ -12,6 +12,12 @@
 #include "FieldProbe.H"
 #include "FieldMomentum.H"
 #include "FieldReduction.H"
+#include "LLGIterations.H"
+#include "MagneticEnergy.H"
+#include "MagnetizationError.H"
+#include "MagnonSpectrum.H"
+#include "MemoryFootprint.H"
+#include "NearToFarField.H"
 #include "LoadBalanceCosts.H"
 #include "LoadBalanceEfficiency.H"
 #include "ParticleEnergy.H"
@@ -19,12 +25,19 @@
 #include "ParticleHistogram.H"
 #include "ParticleMomentum.H"
 #include "ParticleNumber.H"
+#include "PointMonitor.H"
+#include "PortSParameters.H"
+#include "PoyntingFlux.H"
 #include "RhoMaximum.H"
+#include "ResamplingStatistics.H"
+#include "StepPhaseTimes.H"
+#include "Throughput.H"
 #include "RawEFieldReduction.H"
 #include "RawBFieldReduction.H"
 #include "Utils/IntervalsParser.H"
 #include "Utils/TextMsg.H"
 #include "Utils/WarpXProfilerWrapper.H"
+#include "WarpX.H"
 
 #include <AMReX.H>
 #include <AMReX_ParallelDescriptor.H>
@@ -48,6 +61,9 @@ MultiReducedDiags::MultiReducedDiags ()
     // if names are not given, reduced diags will not be done
     if ( m_plot_rd == 0 ) { return; }
 
+    // gather the MPI reductions of all the reduced diags in one allreduce
+    pp_warpx.query("reduced_diags_batch_reductions", m_batch_reductions);
+
     using CS = const std::string& ;
     const auto reduced_diags_dictionary =
         std::map<std::string, std::function<std::unique_ptr<ReducedDiags>(CS)>>{
@@ -60,13 +76,25 @@ MultiReducedDiags::MultiReducedDiags ()
             {"FieldReduction",        [](CS s){return std::make_unique<FieldReduction>(s);}},
             {"RhoMaximum",            [](CS s){return std::make_unique<RhoMaximum>(s);}},
             {"BeamRelevant",          [](CS s){return std::make_unique<BeamRelevant>(s);}},
+            {"LLGIterations",         [](CS s){return std::make_unique<LLGIterations>(s);}},
+            {"MagneticEnergy",        [](CS s){return std::make_unique<MagneticEnergy>(s);}},
+            {"MagnetizationError",    [](CS s){return std::make_unique<MagnetizationError>(s);}},
+            {"MagnonSpectrum",        [](CS s){return std::make_unique<MagnonSpectrum>(s);}},
+            {"MemoryFootprint",       [](CS s){return std::make_unique<MemoryFootprint>(s);}},
+            {"NearToFarField",        [](CS s){return std::make_unique<NearToFarField>(s);}},
             {"LoadBalanceCosts",      [](CS s){return std::make_unique<LoadBalanceCosts>(s);}},
             {"LoadBalanceEfficiency", [](CS s){return std::make_unique<LoadBalanceEfficiency>(s);}},
             {"ParticleHistogram",     [](CS s){return std::make_unique<ParticleHistogram>(s);}},
             {"ParticleNumber",        [](CS s){return std::make_unique<ParticleNumber>(s);}},
             {"ParticleExtrema",       [](CS s){return std::make_unique<ParticleExtrema>(s);}},
             {"RawEFieldReduction",    [](CS s){return std::make_unique<RawEFieldReduction>(s);}},
-            {"RawBFieldReduction",    [](CS s){return std::make_unique<RawBFieldReduction>(s);}}
+            {"RawBFieldReduction",    [](CS s){return std::make_unique<RawBFieldReduction>(s);}},
+            {"PointMonitor",          [](CS s){return std::make_unique<PointMonitor>(s);}},
+            {"PortSParameters",       [](CS s){return std::make_unique<PortSParameters>(s);}},
+            {"PoyntingFlux",          [](CS s){return std::make_unique<PoyntingFlux>(s);}},
+            {"ResamplingStatistics",  [](CS s){return std::make_unique<ResamplingStatistics>(s);}},
+            {"StepPhaseTimes",        [](CS s){return std::make_unique<StepPhaseTimes>(s);}},
+            {"Throughput",            [](CS s){return std::make_unique<Throughput>(s);}}
         };
     // loop over all reduced diags and fill m_multi_rd with requested reduced diags
     std::transform(m_rd_names.begin(), m_rd_names.end(), std::back_inserter(m_multi_rd),
@@ -85,6 +113,10 @@ MultiReducedDiags::MultiReducedDiags ()
             return reduced_diags_dictionary.at(rd_type)(rd_name);
         });
     // end loop over all reduced diags
+
+    if (m_batch_reductions) {
+        for (auto& rd : m_multi_rd) rd->m_reduction_batch = &m_reduction_batch;
+    }
 }
 // end constructor
 
@@ -110,12 +142,25 @@ void MultiReducedDiags::ComputeDiags (int step)
 {
     WARPX_PROFILE("MultiReducedDiags::ComputeDiags()");
 
+#ifdef WARPX_MAG_LLG
+    // B is computed from H and M only when it may be read
+    for (auto const& rd : m_multi_rd) {
+        if (rd->ReadsFields(step)) {
+            WarpX::GetInstance().ComputeBfieldFromHM();
+            break;
+        }
+    }
+#endif
+
     // loop over all reduced diags
     for (int i_rd = 0; i_rd < static_cast<int>(m_rd_names.size()); ++i_rd)
     {
         m_multi_rd[i_rd] -> ComputeDiags(step);
     }
     // end loop over all reduced diags
+
+    // reduce the partial results of all the reduced diags at once and finish their outputs
+    m_reduction_batch.Flush();
 }
 // end void MultiReducedDiags::ComputeDiags
 
@@ -137,3 +182,15 @@ void MultiReducedDiags::WriteToFile (int step)
     // end loop over all reduced diags
 }
 // end void MultiReducedDiags::WriteToFile
+
+// function to write the buffered data
+void MultiReducedDiags::FlushBuffers ()
+{
+    // collective: the outputs kept on the device or on all the ranks are gathered first
+    for (auto const& rd : m_multi_rd) rd->GatherBuffer();
+
+    // Only the I/O rank writes
+    if ( !ParallelDescriptor::IOProcessor() ) { return; }
+
+    for (auto const& rd : m_multi_rd) rd->FlushBuffer();
+}
@@ -0,0 +1,382 @@
+/* This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+
+#include "NearToFarField.H"
+
+#include "Utils/IntervalsParser.H"
+#include "Utils/TextMsg.H"
+#include "Utils/WarpXConst.H"
+#include "Utils/WarpXUtil.H"
+#include "WarpX.H"
+
+#include <AMReX.H>
+#include <AMReX_Array4.H>
+#include <AMReX_Box.H>
+#include <AMReX_BoxList.H>
+#include <AMReX_GpuLaunch.H>
+#include <AMReX_GpuQualifiers.H>
+#include <AMReX_IntVect.H>
+#include <AMReX_Loop.H>
+#include <AMReX_MFIter.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_ParmParse.H>
+
+#include <cmath>
+#include <complex>
+#include <fstream>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+using namespace amrex::literals;
+
+namespace
+{
+    /** Trilinear interpolation of a staggered field at the position xi, in cells from prob_lo */
+    AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
+    amrex::Real InterpolateField (amrex::Array4<amrex::Real const> const& F,
+                                  amrex::GpuArray<int, 3> const& stag,
+                                  amrex::GpuArray<amrex::Real, 3> const& xi)
+    {
+        int i0[3];
+        amrex::Real w[3];
+        for (int idim = 0; idim < 3; ++idim) {
+            amrex::Real const s = xi[idim] - 0.5_rt * (1 - stag[idim]);
+            i0[idim] = static_cast<int>(std::floor(s));
+            w[idim] = s - i0[idim];
+        }
+        amrex::Real f = 0._rt;
+        for (int c = 0; c < 8; ++c) {
+            int const di = c & 1;
+            int const dj = (c >> 1) & 1;
+            int const dk = (c >> 2) & 1;
+            amrex::Real const weight = (di ? w[0] : 1._rt - w[0]) * (dj ? w[1] : 1._rt - w[1])
+                                     * (dk ? w[2] : 1._rt - w[2]);
+            // the points of zero weight may be outside of the guard cells
+            if (weight == 0._rt) continue;
+            f += weight * F(i0[0] + di, i0[1] + dj, i0[2] + dk);
+        }
+        return f;
+    }
+}
+
+// constructor
+NearToFarField::NearToFarField (std::string rd_name)
+: ReducedDiags{rd_name}
+{
+#if !(defined WARPX_DIM_3D)
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(false,
+        "NearToFarField reduced diagnostics is only implemented in 3D.");
+#endif
+    int nLevel = 0;
+    amrex::ParmParse pp_amr("amr");
+    pp_amr.query("max_level", nLevel);
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(nLevel == 0,
+        "NearToFarField reduced diagnostics does not work with mesh refinement.");
+
+    amrex::ParmParse pp_rd_name(rd_name);
+
+    // the Huygens box, moved to the closest nodes of level 0
+    amrex::Vector<amrex::Real> lo, hi;
+    getArrWithParser(pp_rd_name, "lo", lo, 0, 3);
+    getArrWithParser(pp_rd_name, "hi", hi, 0, 3);
+    amrex::Geometry const& geom = WarpX::GetInstance().Geom(0);
+    amrex::Box const& domain = geom.Domain();
+    for (int idim = 0; idim < 3; ++idim) {
+        m_node_lo[idim] = static_cast<int>(std::round((lo[idim] - geom.ProbLo(idim)) / geom.CellSize(idim)));
+        m_node_hi[idim] = static_cast<int>(std::round((hi[idim] - geom.ProbLo(idim)) / geom.CellSize(idim)));
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(m_node_hi[idim] > m_node_lo[idim],
+            rd_name + ".hi must be at least one cell above " + rd_name + ".lo");
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(
+            m_node_lo[idim] > domain.smallEnd(idim) && m_node_hi[idim] <= domain.bigEnd(idim),
+            "the Huygens box of " + rd_name + " must be inside the domain");
+    }
+
+    getArrWithParser(pp_rd_name, "frequencies", m_frequencies);
+    pp_rd_name.query("n_theta", m_n_theta);
+    pp_rd_name.query("n_phi", m_n_phi);
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(m_n_theta >= 2 && m_n_phi >= 1,
+        rd_name + ".n_theta must be at least 2 and " + rd_name + ".n_phi at least 1");
+
+    const int nfreq = m_frequencies.size();
+    amrex::Vector<amrex::Real> omega(nfreq);
+    for (int ifreq = 0; ifreq < nfreq; ++ifreq) {
+        omega[ifreq] = 2._rt * MathConst::pi * m_frequencies[ifreq];
+    }
+    m_omega.resize(nfreq);
+    amrex::Gpu::copyAsync(amrex::Gpu::hostToDevice, omega.begin(), omega.end(), m_omega.begin());
+    amrex::Gpu::streamSynchronize();
+
+    // energy per unit solid angle and angular frequency for each frequency and direction
+    m_data.resize(nfreq * m_n_theta * m_n_phi, 0.0_rt);
+
+    if (amrex::ParallelDescriptor::IOProcessor())
+    {
+        if ( m_IsNotRestart )
+        {
+            // open file
+            std::ofstream ofs{m_path + m_rd_name + "." + m_extension, std::ofstream::out};
+            // write header row
+            int c = 0;
+            ofs << "#";
+            ofs << "[" << c++ << "]step()";
+            ofs << m_sep;
+            ofs << "[" << c++ << "]time(s)";
+            for (int ifreq = 0; ifreq < nfreq; ++ifreq) {
+                for (int it = 0; it < m_n_theta; ++it) {
+                    for (int ip = 0; ip < m_n_phi; ++ip) {
+                        const amrex::Real theta = 180._rt * it / (m_n_theta - 1);
+                        const amrex::Real phi = 360._rt * ip / m_n_phi;
+                        ofs << m_sep;
+                        ofs << "[" << c++ << "]dW_dOmega_domega(f=" + std::to_string(m_frequencies[ifreq])
+                               + "Hz,theta=" + std::to_string(theta) + "deg,phi=" + std::to_string(phi)
+                               + "deg)(J*s/sr)";
+                    }
+                }
+            }
+            ofs << std::endl;
+            // close file
+            ofs.close();
+        }
+    }
+}
+// end constructor
+
+#if (defined WARPX_DIM_3D)
+void
+NearToFarField::DefineLayout (amrex::BoxArray const& ba, amrex::DistributionMapping const& dm)
+{
+    m_ba = ba;
+    m_dm = dm;
+    const int ncomp = 12 * static_cast<int>(m_frequencies.size());
+    // the transforms keep the owner of the box that contains their cells
+    std::array<std::unique_ptr<amrex::MultiFab>, 6> old_dft = std::move(m_dft);
+    for (int d = 0; d < 3; ++d) {
+        for (int s = 0; s < 2; ++s) {
+            const int face = 2 * d + s;
+            // the cells of the Huygens box along the face
+            amrex::Box plane(amrex::IntVect(m_node_lo[0], m_node_lo[1], m_node_lo[2]),
+                             amrex::IntVect(m_node_hi[0] - 1, m_node_hi[1] - 1, m_node_hi[2] - 1));
+            const int c = (s == 0) ? m_node_lo[d] : m_node_hi[d] - 1;
+            plane.setSmall(d, c);
+            plane.setBig(d, c);
+            amrex::BoxList plane_bl;
+            amrex::Vector<int> pmap;
+            m_plane_box[face].clear();
+            for (int ibox = 0; ibox < static_cast<int>(ba.size()); ++ibox) {
+                const amrex::Box b = ba[ibox] & plane;
+                if (!b.ok()) continue;
+                m_plane_box[face].push_back(ibox);
+                plane_bl.push_back(b);
+                pmap.push_back(dm[ibox]);
+            }
+            m_dft[face] = std::make_unique<amrex::MultiFab>(
+                amrex::BoxArray(std::move(plane_bl)), amrex::DistributionMapping(pmap), ncomp, 0);
+            m_dft[face]->setVal(0._rt);
+            if (old_dft[face]) m_dft[face]->ParallelCopy(*old_dft[face], 0, 0, ncomp);
+        }
+    }
+}
+
+void
+NearToFarField::AccumulateDFT (amrex::Real t, amrex::Real dt)
+{
+    auto & warpx = WarpX::GetInstance();
+    const int lev = 0;
+    const int nfreq = m_frequencies.size();
+    amrex::Real const* const AMREX_RESTRICT omega = m_omega.dataPtr();
+
+    // H in the vacuum around the sources
+    std::array<amrex::MultiFab const*, 3> E, H;
+    for (int idim = 0; idim < 3; ++idim) {
+        E[idim] = &warpx.getEfield(lev, idim);
+#ifdef WARPX_MAG_LLG
+        H[idim] = WarpX::mag_LLG ? &warpx.getHfield(lev, idim) : &warpx.getBfield(lev, idim);
+#else
+        H[idim] = &warpx.getBfield(lev, idim);
+#endif
+    }
+#ifdef WARPX_MAG_LLG
+    const amrex::Real H_factor = WarpX::mag_LLG ? 1._rt : 1._rt / PhysConst::mu0;
+#else
+    const amrex::Real H_factor = 1._rt / PhysConst::mu0;
+#endif
+    amrex::GpuArray<amrex::GpuArray<int, 3>, 3> E_stag, H_stag;
+    for (int comp = 0; comp < 3; ++comp) {
+        for (int idim = 0; idim < 3; ++idim) {
+            E_stag[comp][idim] = E[comp]->ixType()[idim];
+            H_stag[comp][idim] = H[comp]->ixType()[idim];
+        }
+    }
+
+    for (int d = 0; d < 3; ++d) {
+        for (int s = 0; s < 2; ++s) {
+            const int face = 2 * d + s;
+            // outward normal
+            amrex::GpuArray<amrex::Real, 3> normal = {0._rt, 0._rt, 0._rt};
+            normal[d] = (s == 0) ? -1._rt : 1._rt;
+            amrex::MultiFab& dft = *m_dft[face];
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#endif
+            for (amrex::MFIter mfi(dft); mfi.isValid(); ++mfi) {
+                const int ibox = m_plane_box[face][mfi.index()];
+                amrex::Array4<amrex::Real> const& D = dft.array(mfi);
+                amrex::GpuArray<amrex::Array4<amrex::Real const>, 3> E_arr, H_arr;
+                for (int comp = 0; comp < 3; ++comp) {
+                    E_arr[comp] = E[comp]->const_array(ibox);
+                    H_arr[comp] = H[comp]->const_array(ibox);
+                }
+                amrex::ParallelFor(mfi.validbox(), [=] AMREX_GPU_DEVICE (int i, int j, int k) {
+                    // the center of the face of the cell on the surface of the Huygens box
+                    amrex::GpuArray<amrex::Real, 3> xi = {i + 0.5_rt, j + 0.5_rt, k + 0.5_rt};
+                    xi[d] += (s == 0) ? -0.5_rt : 0.5_rt;
+                    amrex::Real Ev[3], Hv[3];
+                    for (int comp = 0; comp < 3; ++comp) {
+                        Ev[comp] = InterpolateField(E_arr[comp], E_stag[comp], xi);
+                        Hv[comp] = H_factor * InterpolateField(H_arr[comp], H_stag[comp], xi);
+                    }
+                    // J_s = n x H and M_s = -n x E
+                    amrex::Real JM[6];
+                    for (int comp = 0; comp < 3; ++comp) {
+                        const int c1 = (comp + 1) % 3;
+                        const int c2 = (comp + 2) % 3;
+                        JM[comp] = normal[c1] * Hv[c2] - normal[c2] * Hv[c1];
+                        JM[3 + comp] = -(normal[c1] * Ev[c2] - normal[c2] * Ev[c1]);
+                    }
+                    for (int ifreq = 0; ifreq < nfreq; ++ifreq) {
+                        const amrex::Real omega_t = omega[ifreq] * t;
+                        const amrex::Real kr = dt * std::cos(omega_t);
+                        const amrex::Real ki = -dt * std::sin(omega_t);
+                        for (int comp = 0; comp < 6; ++comp) {
+                            D(i, j, k, 12 * ifreq + 2 * comp) += JM[comp] * kr;
+                            D(i, j, k, 12 * ifreq + 2 * comp + 1) += JM[comp] * ki;
+                        }
+                    }
+                });
+            }
+        }
+    }
+}
+
+void
+NearToFarField::ComputeFarField ()
+{
+    auto & warpx = WarpX::GetInstance();
+    const int lev = 0;
+    const auto problo = warpx.Geom(lev).ProbLoArray();
+    const auto dx = warpx.Geom(lev).CellSizeArray();
+    const int nfreq = m_frequencies.size();
+    const int n_theta = m_n_theta;
+    const int n_phi = m_n_phi;
+    const int ndir = n_theta * n_phi;
+    const int nout = nfreq * ndir;
+    amrex::Real const* const AMREX_RESTRICT omega = m_omega.dataPtr();
+
+    // the phases are taken from the center of the Huygens box
+    amrex::GpuArray<amrex::Real, 3> center;
+    for (int idim = 0; idim < 3; ++idim) {
+        center[idim] = problo[idim] + 0.5_rt * (m_node_lo[idim] + m_node_hi[idim]) * dx[idim];
+    }
+
+    // real and imaginary parts of the components of N and L for each frequency and direction
+    amrex::Gpu::DeviceVector<amrex::Real> NL(12 * nout, 0._rt);
+    amrex::Real* const AMREX_RESTRICT NL_ptr = NL.dataPtr();
+    for (int d = 0; d < 3; ++d) {
+        for (int s = 0; s < 2; ++s) {
+            const int face = 2 * d + s;
+            const int a = (d + 1) % 3;
+            const int b = (d + 2) % 3;
+            const amrex::Real dS = dx[a] * dx[b];
+            amrex::MultiFab const& dft = *m_dft[face];
+            for (amrex::MFIter mfi(dft); mfi.isValid(); ++mfi) {
+                const amrex::Box bx = mfi.validbox();
+                amrex::Array4<amrex::Real const> const& D = dft.const_array(mfi);
+                // each thread integrates one frequency and direction over the cells of the box
+                amrex::ParallelFor(nout, [=] AMREX_GPU_DEVICE (int n) {
+                    const int ifreq = n / ndir;
+                    const int idir = n - ifreq * ndir;
+                    const amrex::Real theta = MathConst::pi * (idir / n_phi) / (n_theta - 1);
+                    const amrex::Real phi = 2._rt * MathConst::pi * (idir % n_phi) / n_phi;
+                    const amrex::Real rhat[3] = {std::sin(theta) * std::cos(phi),
+                                                 std::sin(theta) * std::sin(phi), std::cos(theta)};
+                    const amrex::Real wavenumber = omega[ifreq] / PhysConst::c;
+                    amrex::Real acc[12] = {0._rt};
+                    amrex::Loop(bx, [&] (int i, int j, int k) {
+                        amrex::Real pos[3] = {i + 0.5_rt, j + 0.5_rt, k + 0.5_rt};
+                        pos[d] += (s == 0) ? -0.5_rt : 0.5_rt;
+                        amrex::Real rdot = 0._rt;
+                        for (int idim = 0; idim < 3; ++idim) {
+                            rdot += rhat[idim] * (problo[idim] + pos[idim] * dx[idim] - center[idim]);
+                        }
+                        // exp(i k r.r')
+                        const amrex::Real cp = std::cos(wavenumber * rdot) * dS;
+                        const amrex::Real sp = std::sin(wavenumber * rdot) * dS;
+                        for (int comp = 0; comp < 6; ++comp) {
+                            const amrex::Real re = D(i, j, k, 12 * ifreq + 2 * comp);
+                            const amrex::Real im = D(i, j, k, 12 * ifreq + 2 * comp + 1);
+                            acc[2 * comp] += re * cp - im * sp;
+                            acc[2 * comp + 1] += re * sp + im * cp;
+                        }
+                    });
+                    for (int c = 0; c < 12; ++c) NL_ptr[12 * n + c] += acc[c];
+                });
+            }
+        }
+    }
+
+    amrex::Vector<amrex::Real> h_NL(12 * nout);
+    amrex::Gpu::copyAsync(amrex::Gpu::deviceToHost, NL.begin(), NL.end(), h_NL.begin());
+    amrex::Gpu::streamSynchronize();
+    amrex::ParallelDescriptor::ReduceRealSum(h_NL.data(), h_NL.size(),
+                                             amrex::ParallelDescriptor::IOProcessorNumber());
+
+    // dW / (dOmega domega) = k^2 / (16 pi^3 eta0) (|L_phi + eta0 N_theta|^2 + |L_theta - eta0 N_phi|^2)
+    const amrex::Real eta0 = PhysConst::mu0 * PhysConst::c;
+    for (int n = 0; n < nout; ++n) {
+        const int ifreq = n / ndir;
+        const int idir = n - ifreq * ndir;
+        const amrex::Real theta = MathConst::pi * (idir / n_phi) / (n_theta - 1);
+        const amrex::Real phi = 2._rt * MathConst::pi * (idir % n_phi) / n_phi;
+        const amrex::Real theta_hat[3] = {std::cos(theta) * std::cos(phi),
+                                          std::cos(theta) * std::sin(phi), -std::sin(theta)};
+        const amrex::Real phi_hat[3] = {-std::sin(phi), std::cos(phi), 0._rt};
+        std::complex<amrex::Real> N_theta = 0._rt, N_phi = 0._rt, L_theta = 0._rt, L_phi = 0._rt;
+        for (int comp = 0; comp < 3; ++comp) {
+            const std::complex<amrex::Real> N(h_NL[12 * n + 2 * comp], h_NL[12 * n + 2 * comp + 1]);
+            const std::complex<amrex::Real> L(h_NL[12 * n + 6 + 2 * comp], h_NL[12 * n + 6 + 2 * comp + 1]);
+            N_theta += N * theta_hat[comp];
+            N_phi += N * phi_hat[comp];
+            L_theta += L * theta_hat[comp];
+            L_phi += L * phi_hat[comp];
+        }
+        const amrex::Real wavenumber = 2._rt * MathConst::pi * m_frequencies[ifreq] / PhysConst::c;
+        m_data[n] = wavenumber * wavenumber / (16._rt * MathConst::pi * MathConst::pi * MathConst::pi * eta0)
+                    * (std::norm(L_phi + eta0 * N_theta) + std::norm(L_theta - eta0 * N_phi));
+    }
+}
+#endif
+
+// function that accumulates the Fourier transforms of the surface currents
+void NearToFarField::ComputeDiags (int step)
+{
+#if (defined WARPX_DIM_3D)
+    auto & warpx = WarpX::GetInstance();
+    const int lev = 0;
+
+    // the planes follow the boxes of level 0, e.g. after load balancing
+    if (!m_dft[0] || warpx.boxArray(lev) != m_ba || warpx.DistributionMap(lev) != m_dm) {
+        DefineLayout(warpx.boxArray(lev), warpx.DistributionMap(lev));
+    }
+
+    AccumulateDFT(warpx.gett_new(lev), warpx.getdt(lev));
+
+    if (!m_intervals.contains(step+1)) { return; }
+
+    ComputeFarField();
+#else
+    amrex::ignore_unused(step);
+#endif
+}
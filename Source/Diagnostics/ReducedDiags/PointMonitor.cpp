@@ -0,0 +1,294 @@
+/* This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+
+#include "PointMonitor.H"
+
+#include "Utils/IntervalsParser.H"
+#include "Utils/TextMsg.H"
+#include "Utils/WarpXUtil.H"
+#include "WarpX.H"
+
+#include <AMReX.H>
+#include <AMReX_Array4.H>
+#include <AMReX_Box.H>
+#include <AMReX_BoxArray.H>
+#include <AMReX_Geometry.H>
+#include <AMReX_GpuContainers.H>
+#include <AMReX_GpuLaunch.H>
+#include <AMReX_GpuQualifiers.H>
+#include <AMReX_IndexType.H>
+#include <AMReX_IntVect.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_REAL.H>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <fstream>
+#include <ostream>
+#include <vector>
+
+using namespace amrex;
+
+// constructor
+PointMonitor::PointMonitor (std::string rd_name)
+: ReducedDiags{rd_name}
+{
+#if (defined WARPX_DIM_RZ)
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(false,
+        "PointMonitor reduced diagnostics does not work for RZ coordinate.");
+#endif
+
+    ParmParse pp_rd_name(rd_name);
+
+    // field components sampled at each point
+    m_fields = {"Ex", "Ey", "Ez", "Bx", "By", "Bz"};
+#ifdef WARPX_MAG_LLG
+    if (WarpX::mag_LLG) m_fields = {"Hx", "Hy", "Hz", "Mx", "My", "Mz"};
+#endif
+    pp_rd_name.queryarr("fields", m_fields);
+    std::vector<std::string> valid_fields = {"Ex", "Ey", "Ez", "Bx", "By", "Bz"};
+#ifdef WARPX_MAG_LLG
+    // H and M are only defined with the LLG solver
+    if (WarpX::mag_LLG) valid_fields.insert(valid_fields.end(), {"Hx", "Hy", "Hz", "Mx", "My", "Mz"});
+#endif
+    for (auto const& field : m_fields) {
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(
+            std::find(valid_fields.begin(), valid_fields.end(), field) != valid_fields.end(),
+            rd_name + ".fields: " + field + " is not a valid field component");
+    }
+
+    // coordinates of the points (the unused ones in 1D and 2D default to 0)
+    getArrWithParser(pp_rd_name, "z_points", m_z);
+    m_x.assign(m_z.size(), 0.0_rt);
+    m_y.assign(m_z.size(), 0.0_rt);
+#if !(defined WARPX_DIM_1D_Z)
+    getArrWithParser(pp_rd_name, "x_points", m_x);
+#endif
+#if (defined WARPX_DIM_3D)
+    getArrWithParser(pp_rd_name, "y_points", m_y);
+#endif
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(m_x.size() == m_z.size() && m_y.size() == m_z.size(),
+        rd_name + ": x_points, y_points and z_points must have the same number of points");
+
+    auto const& geom = WarpX::GetInstance().Geom(0);
+    for (std::size_t p = 0; p < m_z.size(); ++p) {
+        std::array<Real, AMREX_SPACEDIM> const pos = {
+#if (defined WARPX_DIM_3D)
+            m_x[p], m_y[p], m_z[p]
+#elif (defined WARPX_DIM_XZ)
+            m_x[p], m_z[p]
+#else
+            m_z[p]
+#endif
+        };
+        for (int d = 0; d < AMREX_SPACEDIM; ++d) {
+            WARPX_ALWAYS_ASSERT_WITH_MESSAGE(
+                pos[d] >= geom.ProbLo(d) && pos[d] <= geom.ProbHi(d),
+                rd_name + ": point " + std::to_string(p) + " is outside of the domain");
+        }
+    }
+
+    int const nfields = static_cast<int>(m_fields.size());
+    m_index_ba.resize(nfields);
+    m_index_dm.resize(nfields);
+    m_sample_fab.resize(nfields);
+    m_sample_i.resize(nfields);
+    m_sample_j.resize(nfields);
+    m_sample_k.resize(nfields);
+    m_sample_col.resize(nfields);
+
+    if (ParallelDescriptor::IOProcessor())
+    {
+        if ( m_IsNotRestart )
+        {
+            // open file
+            std::ofstream ofs{m_path + m_rd_name + "." + m_extension, std::ofstream::out};
+            // write header row
+            int c = 0;
+            ofs << "#";
+            ofs << "[" << c++ << "]step()";
+            ofs << m_sep;
+            ofs << "[" << c++ << "]time(s)";
+            for (std::size_t p = 0; p < m_z.size(); ++p) {
+                for (auto const& field : m_fields) {
+                    std::string const unit = field[0] == 'E' ? "(V/m)" : field[0] == 'B' ? "(T)" : "(A/m)";
+                    ofs << m_sep;
+                    ofs << "[" << c++ << "]" << field << "_p" << p << unit;
+                }
+            }
+            ofs << std::endl;
+            // close file
+            ofs.close();
+        }
+    }
+}
+// end constructor
+
+MultiFab const* PointMonitor::FieldMultiFab (int f, int& comp) const
+{
+    auto & warpx = WarpX::GetInstance();
+    std::string const& field = m_fields[f];
+    int const dir = field[1] - 'x';
+    comp = 0;
+    if (field[0] == 'E') return warpx.get_pointer_Efield_fp(0, dir);
+    if (field[0] == 'B') return warpx.get_pointer_Bfield_fp(0, dir);
+#ifdef WARPX_MAG_LLG
+    if (field[0] == 'H') return warpx.get_pointer_Hfield_fp(0, dir);
+    // the component dir of M lives on the faces normal to dir
+    comp = dir;
+    return warpx.get_pointer_Mfield_fp(0, dir);
+#else
+    return nullptr;
+#endif
+}
+
+void PointMonitor::UpdateIndices (int f)
+{
+    int comp = 0;
+    MultiFab const* mf = FieldMultiFab(f, comp);
+    BoxArray const& ba = mf->boxArray();
+    DistributionMapping const& dm = mf->DistributionMap();
+    if (ba == m_index_ba[f] && dm == m_index_dm[f]) return;
+    m_index_ba[f] = ba;
+    m_index_dm[f] = dm;
+
+    auto const& geom = WarpX::GetInstance().Geom(0);
+    IndexType const ixtype = ba.ixType();
+    Box const domain = amrex::convert(geom.Domain(), ixtype);
+    int const nfields = static_cast<int>(m_fields.size());
+
+    Vector<int> h_fab, h_i, h_j, h_k, h_col;
+    for (int p = 0; p < static_cast<int>(m_z.size()); ++p) {
+        std::array<Real, AMREX_SPACEDIM> const pos = {
+#if (defined WARPX_DIM_3D)
+            m_x[p], m_y[p], m_z[p]
+#elif (defined WARPX_DIM_XZ)
+            m_x[p], m_z[p]
+#else
+            m_z[p]
+#endif
+        };
+        // grid point of the component nearest to the point
+        IntVect iv;
+        for (int d = 0; d < AMREX_SPACEDIM; ++d) {
+            Real const s = (pos[d] - geom.ProbLo(d)) / geom.CellSize(d);
+            iv[d] = ixtype.nodeCentered(d) ? static_cast<int>(std::round(s))
+                                           : static_cast<int>(std::floor(s));
+            // a point on the upper boundary is read in the last cell of the domain
+            iv[d] = std::clamp(iv[d], domain.smallEnd(d), domain.bigEnd(d));
+        }
+        // the point is read by the rank owning the first box that contains it
+        auto const isects = ba.intersections(Box(iv, iv, ixtype), true, 0);
+        if (isects.empty() || dm[isects[0].first] != ParallelDescriptor::MyProc()) continue;
+
+        h_fab.push_back(mf->localindex(isects[0].first));
+        h_i.push_back(iv[0]);
+#if (AMREX_SPACEDIM >= 2)
+        h_j.push_back(iv[1]);
+#else
+        h_j.push_back(0);
+#endif
+#if (AMREX_SPACEDIM == 3)
+        h_k.push_back(iv[2]);
+#else
+        h_k.push_back(0);
+#endif
+        h_col.push_back(p * nfields + f);
+    }
+
+    auto const copy_to_device = [] (Vector<int> const& h, Gpu::DeviceVector<int>& d) {
+        d.resize(h.size());
+        Gpu::copyAsync(Gpu::hostToDevice, h.begin(), h.end(), d.begin());
+    };
+    copy_to_device(h_fab, m_sample_fab[f]);
+    copy_to_device(h_i, m_sample_i[f]);
+    copy_to_device(h_j, m_sample_j[f]);
+    copy_to_device(h_k, m_sample_k[f]);
+    copy_to_device(h_col, m_sample_col[f]);
+    Gpu::synchronize();
+}
+
+// function that samples the fields at the points
+void PointMonitor::ComputeDiags (int step)
+{
+    // Judge if the diags should be done
+    if (!m_intervals.contains(step+1)) { return; }
+
+    int const nfields = static_cast<int>(m_fields.size());
+    int const ncols = static_cast<int>(m_z.size()) * nfields;
+
+    if (m_samples.empty()) {
+        m_samples.resize(m_flush_interval * ncols);
+        Real* const AMREX_RESTRICT samples = m_samples.dataPtr();
+        amrex::ParallelFor(m_flush_interval * ncols, [=] AMREX_GPU_DEVICE (int n) noexcept {
+            samples[n] = 0.0_rt;
+        });
+    }
+
+    int const row = static_cast<int>(m_sample_steps.size());
+    Real* const AMREX_RESTRICT samples = m_samples.dataPtr() + row * ncols;
+
+    for (int f = 0; f < nfields; ++f) {
+        UpdateIndices(f);
+        int const nsamples = static_cast<int>(m_sample_fab[f].size());
+        if (nsamples == 0) continue;
+
+        int comp = 0;
+        auto const field_arrays = FieldMultiFab(f, comp)->const_arrays();
+        int const* const AMREX_RESTRICT fab = m_sample_fab[f].dataPtr();
+        int const* const AMREX_RESTRICT ii = m_sample_i[f].dataPtr();
+        int const* const AMREX_RESTRICT jj = m_sample_j[f].dataPtr();
+        int const* const AMREX_RESTRICT kk = m_sample_k[f].dataPtr();
+        int const* const AMREX_RESTRICT col = m_sample_col[f].dataPtr();
+        amrex::ParallelFor(nsamples, [=] AMREX_GPU_DEVICE (int s) noexcept {
+            samples[col[s]] = field_arrays[fab[s]](ii[s], jj[s], kk[s], comp);
+        });
+    }
+
+    m_sample_steps.push_back(step + 1);
+    m_sample_times.push_back(WarpX::GetInstance().gett_new(0));
+
+    if (static_cast<int>(m_sample_steps.size()) >= m_flush_interval) GatherBuffer();
+}
+// end void PointMonitor::ComputeDiags
+
+void PointMonitor::WriteToFile (int /*step*/) const {}
+
+void PointMonitor::GatherBuffer ()
+{
+    int const nrows = static_cast<int>(m_sample_steps.size());
+    if (nrows == 0) return;
+    int const ncols = static_cast<int>(m_z.size() * m_fields.size());
+    int const n = nrows * ncols;
+
+    std::vector<Real> h_samples(n);
+    Gpu::copy(Gpu::deviceToHost, m_samples.begin(), m_samples.begin() + n, h_samples.begin());
+    ParallelDescriptor::ReduceRealSum(h_samples.data(), n, ParallelDescriptor::IOProcessorNumber());
+
+    Real* const AMREX_RESTRICT samples = m_samples.dataPtr();
+    amrex::ParallelFor(n, [=] AMREX_GPU_DEVICE (int i) noexcept {
+        samples[i] = 0.0_rt;
+    });
+
+    if (ParallelDescriptor::IOProcessor())
+    {
+        // each row holds step, time and the samples of all the points
+        m_write_buffer.reserve(m_write_buffer.size() + nrows * (ncols + 2));
+        for (int r = 0; r < nrows; ++r) {
+            m_write_buffer.push_back(m_sample_steps[r]);
+            m_write_buffer.push_back(m_sample_times[r]);
+            m_write_buffer.insert(m_write_buffer.end(), h_samples.begin() + r * ncols,
+                                  h_samples.begin() + (r + 1) * ncols);
+            ++m_buffered_outputs;
+        }
+        FlushBuffer();
+    }
+
+    m_sample_steps.clear();
+    m_sample_times.clear();
+}
@@ -0,0 +1,294 @@
+/* This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+
+#include "PortSParameters.H"
+
+#include "Utils/IntervalsParser.H"
+#include "Utils/TextMsg.H"
+#include "Utils/WarpXConst.H"
+#include "Utils/WarpXUtil.H"
+#include "WarpX.H"
+
+#include <AMReX.H>
+#include <AMReX_Array4.H>
+#include <AMReX_Box.H>
+#include <AMReX_GpuQualifiers.H>
+#include <AMReX_MFIter.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Print.H>
+#include <AMReX_Reduce.H>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <ostream>
+#include <vector>
+
+using namespace amrex::literals;
+
+// constructor
+PortSParameters::PortSParameters (std::string rd_name)
+: ReducedDiags{rd_name}
+{
+#if !(defined WARPX_DIM_3D)
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(false,
+        "PortSParameters reduced diagnostics is only implemented in 3D.");
+#endif
+    int nLevel = 0;
+    amrex::ParmParse pp_amr("amr");
+    pp_amr.query("max_level", nLevel);
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(nLevel == 0,
+        "PortSParameters reduced diagnostics does not work with mesh refinement.");
+
+    amrex::ParmParse pp_rd_name(rd_name);
+
+    // read the ports
+    amrex::Vector<std::string> port_names;
+    pp_rd_name.getarr("port_names", port_names);
+    for (auto const& port_name : port_names) {
+        amrex::ParmParse pp_port(rd_name + "." + port_name);
+        Port port;
+        port.name = port_name;
+        amrex::Vector<amrex::Real> lo, hi;
+        getArrWithParser(pp_port, "lo", lo, 0, 3);
+        getArrWithParser(pp_port, "hi", hi, 0, 3);
+        for (int idim = 0; idim < 3; ++idim) {
+            port.lo[idim] = lo[idim];
+            port.hi[idim] = hi[idim];
+        }
+        std::string direction;
+        pp_port.get("direction", direction);
+        if (direction == "x" || direction == "X") {
+            port.direction = 0;
+        } else if (direction == "y" || direction == "Y") {
+            port.direction = 1;
+        } else if (direction == "z" || direction == "Z") {
+            port.direction = 2;
+        } else {
+            amrex::Abort(Utils::TextMsg::Err(
+                rd_name + "." + port_name + ".direction must be x, y or z"));
+        }
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(port.hi[port.direction] > port.lo[port.direction],
+            "the gap of port " + port_name + " must have a non-zero length");
+        port.impedance = 50._rt;
+        queryWithParser(pp_port, "impedance", port.impedance);
+        m_ports.push_back(port);
+    }
+
+    std::string driven_port = port_names[0];
+    pp_rd_name.query("driven_port", driven_port);
+    auto const it = std::find(port_names.begin(), port_names.end(), driven_port);
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(it != port_names.end(),
+        rd_name + ".driven_port must be one of " + rd_name + ".port_names");
+    m_driven_port = static_cast<int>(it - port_names.begin());
+
+    getArrWithParser(pp_rd_name, "frequencies", m_frequencies);
+    queryWithParser(pp_rd_name, "convergence_tolerance", m_convergence_tolerance);
+    queryWithParser(pp_rd_name, "convergence_min_time", m_convergence_min_time);
+    pp_rd_name.query("convergence_window", m_convergence_window);
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(m_convergence_window >= 1,
+        rd_name + ".convergence_window must be at least 1");
+
+    const int nports = m_ports.size();
+    const int nfreq = m_frequencies.size();
+    m_V_dft.resize(nports * nfreq, 0._rt);
+    m_I_dft.resize(nports * nfreq, 0._rt);
+    m_S_prev.resize(nports * nfreq, 0._rt);
+
+    // real and imaginary parts of S_{p,d} for each frequency and port
+    m_data.resize(2 * nports * nfreq, 0.0_rt);
+
+    if (amrex::ParallelDescriptor::IOProcessor())
+    {
+        if ( m_IsNotRestart )
+        {
+            // open file
+            std::ofstream ofs{m_path + m_rd_name + "." + m_extension, std::ofstream::out};
+            // write header row
+            int c = 0;
+            ofs << "#";
+            ofs << "[" << c++ << "]step()";
+            ofs << m_sep;
+            ofs << "[" << c++ << "]time(s)";
+            for (int ifreq = 0; ifreq < nfreq; ++ifreq) {
+                for (int p = 0; p < nports; ++p) {
+                    std::string const S_name = "S_" + port_names[p] + "_" + driven_port
+                                             + "(f=" + std::to_string(m_frequencies[ifreq]) + "Hz)";
+                    ofs << m_sep;
+                    ofs << "[" << c++ << "]Re_" + S_name + "()";
+                    ofs << m_sep;
+                    ofs << "[" << c++ << "]Im_" + S_name + "()";
+                }
+            }
+            ofs << std::endl;
+            // close file
+            ofs.close();
+        }
+    }
+}
+// end constructor
+
+void
+PortSParameters::PortSums (Port const& port, amrex::Real& sum_E, amrex::Real& num_E, amrex::Real& circ_H) const
+{
+    auto & warpx = WarpX::GetInstance();
+    const int lev = 0;
+    const auto problo = warpx.Geom(lev).ProbLoArray();
+    const auto dx = warpx.Geom(lev).CellSizeArray();
+
+    // the gap is along d, and (a, b, d) is right-handed
+    const int d = port.direction;
+    const int a = (d + 1) % 3;
+    const int b = (d + 2) % 3;
+    amrex::GpuArray<amrex::Real, 3> const lo = port.lo;
+    amrex::GpuArray<amrex::Real, 3> const hi = port.hi;
+    // tolerance of the comparisons of the positions
+    amrex::GpuArray<amrex::Real, 3> const eps = {1.e-6_rt * dx[0], 1.e-6_rt * dx[1], 1.e-6_rt * dx[2]};
+    // the transverse plane of the circulation of H, at the middle of the gap
+    const amrex::Real d_mid = 0.5_rt * (lo[d] + hi[d]);
+
+    amrex::MultiFab const& Ed = warpx.getEfield(lev, d);
+    // H in the vacuum around the port
+#ifdef WARPX_MAG_LLG
+    amrex::MultiFab const& Ha = WarpX::mag_LLG ? warpx.getHfield(lev, a) : warpx.getBfield(lev, a);
+    amrex::MultiFab const& Hb = WarpX::mag_LLG ? warpx.getHfield(lev, b) : warpx.getBfield(lev, b);
+    const amrex::Real H_factor = WarpX::mag_LLG ? 1._rt : 1._rt / PhysConst::mu0;
+#else
+    amrex::MultiFab const& Ha = warpx.getBfield(lev, a);
+    amrex::MultiFab const& Hb = warpx.getBfield(lev, b);
+    const amrex::Real H_factor = 1._rt / PhysConst::mu0;
+#endif
+    amrex::GpuArray<int, 3> Ed_stag, Ha_stag, Hb_stag;
+    for (int idim = 0; idim < 3; ++idim) {
+        Ed_stag[idim] = Ed.ixType()[idim];
+        Ha_stag[idim] = Ha.ixType()[idim];
+        Hb_stag[idim] = Hb.ixType()[idim];
+    }
+
+    amrex::ReduceOps<amrex::ReduceOpSum, amrex::ReduceOpSum, amrex::ReduceOpSum> reduce_op;
+    amrex::ReduceData<amrex::Real, amrex::Real, amrex::Real> reduce_data(reduce_op);
+    using ReduceTuple = typename decltype(reduce_data)::Type;
+
+    for ( amrex::MFIter mfi(Ed, false); mfi.isValid(); ++mfi)
+    {
+        amrex::Array4<amrex::Real const> const& Ed_arr = Ed.const_array(mfi);
+        amrex::Array4<amrex::Real const> const& Ha_arr = Ha.const_array(mfi);
+        amrex::Array4<amrex::Real const> const& Hb_arr = Hb.const_array(mfi);
+
+        // samples of E_d inside the port
+        reduce_op.eval(mfi.tilebox(Ed.ixType().toIntVect()), reduce_data,
+            [=] AMREX_GPU_DEVICE (int i, int j, int k) -> ReduceTuple {
+                amrex::GpuArray<amrex::Real, 3> pos;
+                WarpXUtilAlgo::getCellCoordinates(i, j, k, Ed_stag, problo, dx, pos[0], pos[1], pos[2]);
+                for (int idim = 0; idim < 3; ++idim) {
+                    if (pos[idim] < lo[idim] - eps[idim] || pos[idim] > hi[idim] + eps[idim]) return {0._rt, 0._rt, 0._rt};
+                }
+                return {Ed_arr(i, j, k), 1._rt, 0._rt};
+        });
+        // the loop around the port goes along +a at b below the port, and along -a at b above
+        reduce_op.eval(mfi.tilebox(Ha.ixType().toIntVect()), reduce_data,
+            [=] AMREX_GPU_DEVICE (int i, int j, int k) -> ReduceTuple {
+                amrex::GpuArray<amrex::Real, 3> pos;
+                WarpXUtilAlgo::getCellCoordinates(i, j, k, Ha_stag, problo, dx, pos[0], pos[1], pos[2]);
+                if (pos[d] < d_mid - 0.5_rt * dx[d] - eps[d] || pos[d] >= d_mid + 0.5_rt * dx[d] - eps[d]) return {0._rt, 0._rt, 0._rt};
+                if (pos[a] < lo[a] - 0.5_rt * dx[a] - eps[a] || pos[a] >= hi[a] + 0.5_rt * dx[a] - eps[a]) return {0._rt, 0._rt, 0._rt};
+                amrex::Real weight = 0._rt;
+                if (pos[b] >= lo[b] - dx[b] - eps[b] && pos[b] < lo[b] - eps[b]) weight = 1._rt;
+                if (pos[b] > hi[b] + eps[b] && pos[b] <= hi[b] + dx[b] + eps[b]) weight = -1._rt;
+                return {0._rt, 0._rt, weight * Ha_arr(i, j, k) * dx[a]};
+        });
+        // and along +b at a after the port, and along -b at a before
+        reduce_op.eval(mfi.tilebox(Hb.ixType().toIntVect()), reduce_data,
+            [=] AMREX_GPU_DEVICE (int i, int j, int k) -> ReduceTuple {
+                amrex::GpuArray<amrex::Real, 3> pos;
+                WarpXUtilAlgo::getCellCoordinates(i, j, k, Hb_stag, problo, dx, pos[0], pos[1], pos[2]);
+                if (pos[d] < d_mid - 0.5_rt * dx[d] - eps[d] || pos[d] >= d_mid + 0.5_rt * dx[d] - eps[d]) return {0._rt, 0._rt, 0._rt};
+                if (pos[b] < lo[b] - 0.5_rt * dx[b] - eps[b] || pos[b] >= hi[b] + 0.5_rt * dx[b] - eps[b]) return {0._rt, 0._rt, 0._rt};
+                amrex::Real weight = 0._rt;
+                if (pos[a] > hi[a] + eps[a] && pos[a] <= hi[a] + dx[a] + eps[a]) weight = 1._rt;
+                if (pos[a] >= lo[a] - dx[a] - eps[a] && pos[a] < lo[a] - eps[a]) weight = -1._rt;
+                return {0._rt, 0._rt, weight * Hb_arr(i, j, k) * dx[b]};
+        });
+    }
+
+    auto const hv = reduce_data.value();
+    sum_E = amrex::get<0>(hv);
+    num_E = amrex::get<1>(hv);
+    circ_H = H_factor * amrex::get<2>(hv);
+}
+
+// function that accumulates the Fourier transforms of the port voltages and currents
+void PortSParameters::ComputeDiags (int step)
+{
+#if (defined WARPX_DIM_3D)
+    auto & warpx = WarpX::GetInstance();
+    const int lev = 0;
+    const amrex::Real t = warpx.gett_new(lev);
+    const amrex::Real dt = warpx.getdt(lev);
+    const int nports = m_ports.size();
+    const int nfreq = m_frequencies.size();
+
+    // voltage and current of each port
+    amrex::Vector<amrex::Real> sums(3 * nports, 0._rt);
+    for (int p = 0; p < nports; ++p) {
+        PortSums(m_ports[p], sums[3*p], sums[3*p+1], sums[3*p+2]);
+    }
+    amrex::ParallelDescriptor::ReduceRealSum(sums.data(), sums.size());
+
+    for (int p = 0; p < nports; ++p) {
+        Port const& port = m_ports[p];
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(sums[3*p+1] > 0._rt,
+            "no E sample inside port " + port.name);
+        const amrex::Real gap = port.hi[port.direction] - port.lo[port.direction];
+        const amrex::Real V = -sums[3*p] / sums[3*p+1] * gap;
+        const amrex::Real I = sums[3*p+2];
+        for (int ifreq = 0; ifreq < nfreq; ++ifreq) {
+            const amrex::Real omega_t = 2._rt * MathConst::pi * m_frequencies[ifreq] * t;
+            const std::complex<amrex::Real> kernel = std::polar(dt, -omega_t);
+            m_V_dft[p * nfreq + ifreq] += V * kernel;
+            m_I_dft[p * nfreq + ifreq] += I * kernel;
+        }
+    }
+
+    if (!m_intervals.contains(step+1)) { return; }
+
+    // S_{p,d} = b_p / a_d, with a = (V + Z I) / (2 sqrt(Z)) and b = (V - Z I) / (2 sqrt(Z))
+    amrex::Real max_change = 0._rt;
+    amrex::Real max_S = 0._rt;
+    const int d = m_driven_port;
+    const amrex::Real Zd = m_ports[d].impedance;
+    for (int ifreq = 0; ifreq < nfreq; ++ifreq) {
+        const std::complex<amrex::Real> a_d = (m_V_dft[d * nfreq + ifreq] + Zd * m_I_dft[d * nfreq + ifreq])
+                                            / (2._rt * std::sqrt(Zd));
+        for (int p = 0; p < nports; ++p) {
+            const amrex::Real Zp = m_ports[p].impedance;
+            const std::complex<amrex::Real> b_p = (m_V_dft[p * nfreq + ifreq] - Zp * m_I_dft[p * nfreq + ifreq])
+                                                / (2._rt * std::sqrt(Zp));
+            const std::complex<amrex::Real> S = (std::abs(a_d) > 0._rt) ? b_p / a_d : 0._rt;
+            const int idx = ifreq * nports + p;
+            m_data[2*idx] = S.real();
+            m_data[2*idx+1] = S.imag();
+            max_change = std::max(max_change, std::abs(S - m_S_prev[p * nfreq + ifreq]));
+            max_S = std::max(max_S, std::abs(S));
+            m_S_prev[p * nfreq + ifreq] = S;
+        }
+    }
+
+    // the DFTs have converged when the S-parameters no longer change over
+    // m_convergence_window consecutive outputs
+    const bool converged = m_convergence_tolerance > 0._rt && t >= m_convergence_min_time
+                           && max_S > 0._rt && max_change <= m_convergence_tolerance;
+    m_num_converged = converged ? m_num_converged + 1 : 0;
+    if (m_num_converged >= m_convergence_window) {
+        amrex::Print() << Utils::TextMsg::Info(
+            m_rd_name + ": the S-parameters have converged, stopping the simulation");
+        warpx.RequestEarlyStop();
+    }
+#else
+    amrex::ignore_unused(step);
+#endif
+}
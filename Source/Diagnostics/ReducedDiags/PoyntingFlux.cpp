@@ -0,0 +1,255 @@
+/* This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+
+#include "PoyntingFlux.H"
+
+#include "Utils/IntervalsParser.H"
+#include "Utils/TextMsg.H"
+#include "Utils/WarpXConst.H"
+#include "Utils/WarpXUtil.H"
+#include "WarpX.H"
+
+#include <AMReX.H>
+#include <AMReX_Array4.H>
+#include <AMReX_Box.H>
+#include <AMReX_GpuQualifiers.H>
+#include <AMReX_MFIter.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Reduce.H>
+
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <ostream>
+
+using namespace amrex::literals;
+
+namespace
+{
+    /** Average of the Yee component F around the point (i,j,k) of index type point_stag:
+     *  along a direction where the types differ, the two neighbouring samples are averaged */
+    AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
+    amrex::Real ColocatedValue (amrex::Array4<amrex::Real const> const& F,
+                                amrex::GpuArray<int, 3> const& stag,
+                                amrex::GpuArray<int, 3> const& point_stag,
+                                int i, int j, int k)
+    {
+        int lo[3], hi[3];
+        for (int idim = 0; idim < 3; ++idim) {
+            lo[idim] = (stag[idim] == point_stag[idim] || stag[idim] == 1) ? 0 : -1;
+            hi[idim] = (stag[idim] == point_stag[idim] || stag[idim] == 0) ? 0 : 1;
+        }
+        amrex::Real f = 0._rt;
+        for (int c = 0; c < 8; ++c) {
+            int const di = (c & 1) ? hi[0] : lo[0];
+            int const dj = ((c >> 1) & 1) ? hi[1] : lo[1];
+            int const dk = ((c >> 2) & 1) ? hi[2] : lo[2];
+            f += 0.125_rt * F(i + di, j + dj, k + dk);
+        }
+        return f;
+    }
+}
+
+// constructor
+PoyntingFlux::PoyntingFlux (std::string rd_name)
+: ReducedDiags{rd_name}
+{
+#if !(defined WARPX_DIM_3D)
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(false,
+        "PoyntingFlux reduced diagnostics is only implemented in 3D.");
+#endif
+    int nLevel = 0;
+    amrex::ParmParse pp_amr("amr");
+    pp_amr.query("max_level", nLevel);
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(nLevel == 0,
+        "PoyntingFlux reduced diagnostics does not work with mesh refinement.");
+
+    amrex::ParmParse pp_rd_name(rd_name);
+    amrex::Geometry const& geom = WarpX::GetInstance().Geom(0);
+
+    // read the planes
+    amrex::Vector<std::string> plane_names;
+    pp_rd_name.getarr("plane_names", plane_names);
+    for (auto const& plane_name : plane_names) {
+        amrex::ParmParse pp_plane(rd_name + "." + plane_name);
+        Plane plane;
+        plane.name = plane_name;
+        std::string normal;
+        pp_plane.get("normal", normal);
+        if (normal == "x" || normal == "X") {
+            plane.normal = 0;
+        } else if (normal == "y" || normal == "Y") {
+            plane.normal = 1;
+        } else if (normal == "z" || normal == "Z") {
+            plane.normal = 2;
+        } else {
+            amrex::Abort(Utils::TextMsg::Err(
+                rd_name + "." + plane_name + ".normal must be x, y or z"));
+        }
+        const int d = plane.normal;
+        amrex::Real position = 0._rt;
+        getWithParser(pp_plane, "position", position);
+        // the plane is moved to the closest node plane
+        plane.node = static_cast<int>(std::round((position - geom.ProbLo(d)) / geom.CellSize(d)));
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(
+            plane.node > geom.Domain().smallEnd(d) && plane.node <= geom.Domain().bigEnd(d),
+            "plane " + plane_name + " of " + rd_name + " must be inside the domain");
+        // the whole plane by default
+        for (int idim = 0; idim < 3; ++idim) {
+            plane.lo[idim] = std::numeric_limits<amrex::Real>::lowest();
+            plane.hi[idim] = std::numeric_limits<amrex::Real>::max();
+        }
+        amrex::Vector<amrex::Real> lo, hi;
+        if (queryArrWithParser(pp_plane, "lo", lo, 0, 3)) {
+            for (int idim = 0; idim < 3; ++idim) plane.lo[idim] = lo[idim];
+        }
+        if (queryArrWithParser(pp_plane, "hi", hi, 0, 3)) {
+            for (int idim = 0; idim < 3; ++idim) plane.hi[idim] = hi[idim];
+        }
+        m_planes.push_back(plane);
+    }
+
+    pp_rd_name.query("average_window", m_average_window);
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(m_average_window >= 0,
+        rd_name + ".average_window must be non-negative");
+
+    const int nplanes = m_planes.size();
+    m_energy.resize(nplanes, 0._rt);
+    // average power through each plane
+    m_data.resize(nplanes, 0.0_rt);
+
+    if (amrex::ParallelDescriptor::IOProcessor())
+    {
+        if ( m_IsNotRestart )
+        {
+            // open file
+            std::ofstream ofs{m_path + m_rd_name + "." + m_extension, std::ofstream::out};
+            // write header row
+            int c = 0;
+            ofs << "#";
+            ofs << "[" << c++ << "]step()";
+            ofs << m_sep;
+            ofs << "[" << c++ << "]time(s)";
+            for (int p = 0; p < nplanes; ++p) {
+                ofs << m_sep;
+                ofs << "[" << c++ << "]P_" + plane_names[p] + "(W)";
+            }
+            ofs << std::endl;
+            // close file
+            ofs.close();
+        }
+    }
+}
+// end constructor
+
+amrex::Real
+PoyntingFlux::LocalPower (Plane const& plane) const
+{
+    auto & warpx = WarpX::GetInstance();
+    const int lev = 0;
+    const auto problo = warpx.Geom(lev).ProbLoArray();
+    const auto dx = warpx.Geom(lev).CellSizeArray();
+
+    // S_d = E_a H_b - E_b H_a, with (a, b, d) right-handed
+    const int d = plane.normal;
+    const int a = (d + 1) % 3;
+    const int b = (d + 2) % 3;
+    const int node = plane.node;
+    amrex::GpuArray<amrex::Real, 3> const lo = plane.lo;
+    amrex::GpuArray<amrex::Real, 3> const hi = plane.hi;
+    const amrex::Real dS = dx[a] * dx[b];
+
+    amrex::MultiFab const& Ea = warpx.getEfield(lev, a);
+    amrex::MultiFab const& Eb = warpx.getEfield(lev, b);
+#ifdef WARPX_MAG_LLG
+    amrex::MultiFab const& Ha = WarpX::mag_LLG ? warpx.getHfield(lev, a) : warpx.getBfield(lev, a);
+    amrex::MultiFab const& Hb = WarpX::mag_LLG ? warpx.getHfield(lev, b) : warpx.getBfield(lev, b);
+    const amrex::Real H_factor = WarpX::mag_LLG ? 1._rt : 1._rt / PhysConst::mu0;
+#else
+    amrex::MultiFab const& Ha = warpx.getBfield(lev, a);
+    amrex::MultiFab const& Hb = warpx.getBfield(lev, b);
+    const amrex::Real H_factor = 1._rt / PhysConst::mu0;
+#endif
+    amrex::GpuArray<int, 3> Ea_stag, Eb_stag, Ha_stag, Hb_stag;
+    for (int idim = 0; idim < 3; ++idim) {
+        Ea_stag[idim] = Ea.ixType()[idim];
+        Eb_stag[idim] = Eb.ixType()[idim];
+        Ha_stag[idim] = Ha.ixType()[idim];
+        Hb_stag[idim] = Hb.ixType()[idim];
+    }
+    // the centers of the faces of the plane, nodal along the normal
+    amrex::GpuArray<int, 3> point_stag = {0, 0, 0};
+    point_stag[d] = 1;
+
+    amrex::ReduceOps<amrex::ReduceOpSum> reduce_op;
+    amrex::ReduceData<amrex::Real> reduce_data(reduce_op);
+    using ReduceTuple = typename decltype(reduce_data)::Type;
+
+    // each face belongs to the box that holds the cell above it
+    amrex::Box plane_box = warpx.Geom(lev).Domain();
+    plane_box.setSmall(d, node);
+    plane_box.setBig(d, node);
+    for ( amrex::MFIter mfi(warpx.boxArray(lev), warpx.DistributionMap(lev), false); mfi.isValid(); ++mfi)
+    {
+        const amrex::Box bx = mfi.validbox() & plane_box;
+        if (!bx.ok()) continue;
+        amrex::Array4<amrex::Real const> const& Ea_arr = Ea.const_array(mfi);
+        amrex::Array4<amrex::Real const> const& Eb_arr = Eb.const_array(mfi);
+        amrex::Array4<amrex::Real const> const& Ha_arr = Ha.const_array(mfi);
+        amrex::Array4<amrex::Real const> const& Hb_arr = Hb.const_array(mfi);
+
+        reduce_op.eval(bx, reduce_data,
+            [=] AMREX_GPU_DEVICE (int i, int j, int k) -> ReduceTuple {
+                const int iv[3] = {i, j, k};
+                for (int idim = 0; idim < 3; ++idim) {
+                    if (idim == d) continue;
+                    const amrex::Real pos = problo[idim] + (iv[idim] + 0.5_rt) * dx[idim];
+                    if (pos < lo[idim] || pos > hi[idim]) return {0._rt};
+                }
+                const amrex::Real Ea_f = ColocatedValue(Ea_arr, Ea_stag, point_stag, i, j, k);
+                const amrex::Real Eb_f = ColocatedValue(Eb_arr, Eb_stag, point_stag, i, j, k);
+                const amrex::Real Ha_f = ColocatedValue(Ha_arr, Ha_stag, point_stag, i, j, k);
+                const amrex::Real Hb_f = ColocatedValue(Hb_arr, Hb_stag, point_stag, i, j, k);
+                return {(Ea_f * Hb_f - Eb_f * Ha_f) * dS};
+        });
+    }
+
+    return H_factor * amrex::get<0>(reduce_data.value());
+}
+
+// function that accumulates the energies flowing through the planes
+void PoyntingFlux::ComputeDiags (int step)
+{
+#if (defined WARPX_DIM_3D)
+    auto & warpx = WarpX::GetInstance();
+    const int lev = 0;
+    const int nplanes = m_planes.size();
+
+    // the fields of the end of this step are accumulated if the next output is in the window
+    const int next_output = m_intervals.nextContains(step);
+    if (m_average_window == 0 || next_output - (step + 1) < m_average_window) {
+        const amrex::Real dt = warpx.getdt(lev);
+        for (int p = 0; p < nplanes; ++p) {
+            m_energy[p] += LocalPower(m_planes[p]) * dt;
+        }
+        m_duration += dt;
+    }
+
+    if (!m_intervals.contains(step+1)) { return; }
+
+    amrex::Vector<amrex::Real> energy = m_energy;
+    amrex::ParallelDescriptor::ReduceRealSum(energy.data(), energy.size(),
+                                             amrex::ParallelDescriptor::IOProcessorNumber());
+    for (int p = 0; p < nplanes; ++p) {
+        m_data[p] = (m_duration > 0._rt) ? energy[p] / m_duration : 0._rt;
+        m_energy[p] = 0._rt;
+    }
+    m_duration = 0._rt;
+#else
+    amrex::ignore_unused(step);
+#endif
+}
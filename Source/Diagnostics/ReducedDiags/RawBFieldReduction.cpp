@@ -19,7 +19,6 @@
 #include <algorithm>
 #include <ostream>
 
-#include <regex>
 
 //constructor
 RawBFieldReduction::RawBFieldReduction (std::string rd_name)
@@ -46,14 +45,9 @@ RawBFieldReduction::RawBFieldReduction (std::string rd_name)
 
     amrex::ParmParse pp_rd_name(rd_name);
 
-    // read reduced function with parser
+    // read reduced function (built-in or parser)
     std::string parser_string = "";
-    Store_parserString(pp_rd_name,"reduced_function(x,y,z)", parser_string);
-    m_parser = std::make_unique<amrex::Parser>(makeParser(parser_string,{"x","y","z"}));
-
-    // Replace all newlines and possible following whitespaces with a single whitespace. This
-    // should avoid weird formatting when the string is written in the header of the output file.
-    parser_string = std::regex_replace(parser_string, std::regex("\n\\s*"), " ");
+    m_reduced_function = ReadReducedFunction(pp_rd_name, m_parser, parser_string);
 
     // read reduction type
     std::string reduction_type_string;
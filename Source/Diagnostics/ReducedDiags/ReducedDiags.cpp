@@ -9,17 +9,93 @@
 
 #include "WarpX.H"
 #include "Utils/TextMsg.H"
+#include "Utils/WarpXUtil.H"
 
 #include <AMReX.H>
 #include <AMReX_ParallelDescriptor.H>
 #include <AMReX_ParmParse.H>
 #include <AMReX_Utility.H>
 
+#include <algorithm>
 #include <fstream>
 #include <iomanip>
+#include <utility>
+#include <vector>
 
 using namespace amrex;
 
+#ifdef AMREX_USE_MPI
+namespace
+{
+    /** Element of the batched allreduce: a value and the code of its operation, so that
+     *  the segments of different operations are reduced in one call (MPI may split the
+     *  buffer anywhere, the operation must then be known from each element) */
+    struct BatchValue
+    {
+        Real value;
+        Real op;
+    };
+
+    void BatchReduceOp (void* invec, void* inoutvec, int* len, MPI_Datatype* /*datatype*/)
+    {
+        auto const* in = static_cast<BatchValue const*>(invec);
+        auto* inout = static_cast<BatchValue*>(inoutvec);
+        for (int i = 0; i < *len; ++i) {
+            auto const op = static_cast<ReductionBatch::Op>(static_cast<int>(inout[i].op));
+            if (op == ReductionBatch::Op::Sum) {
+                inout[i].value += in[i].value;
+            } else if (op == ReductionBatch::Op::Max) {
+                inout[i].value = std::max(inout[i].value, in[i].value);
+            } else {
+                inout[i].value = std::min(inout[i].value, in[i].value);
+            }
+        }
+    }
+}
+#endif
+
+void ReductionBatch::Add (Op op, Real* data, int n, std::function<void()> dispatch)
+{
+    if (n > 0) m_segments.push_back({op, data, n});
+    if (dispatch) m_dispatch.push_back(std::move(dispatch));
+}
+
+void ReductionBatch::Flush ()
+{
+#ifdef AMREX_USE_MPI
+    if (!m_segments.empty() && ParallelDescriptor::NProcs() > 1) {
+        std::vector<BatchValue> buffer;
+        for (auto const& seg : m_segments) {
+            for (int i = 0; i < seg.n; ++i) {
+                buffer.push_back({seg.data[i], static_cast<Real>(static_cast<int>(seg.op))});
+            }
+        }
+
+        MPI_Datatype batch_type;
+        MPI_Type_contiguous(2, ParallelDescriptor::Mpi_typemap<Real>::type(), &batch_type);
+        MPI_Type_commit(&batch_type);
+        MPI_Op batch_op;
+        MPI_Op_create(&BatchReduceOp, 1, &batch_op);
+        MPI_Allreduce(MPI_IN_PLACE, buffer.data(), static_cast<int>(buffer.size()), batch_type,
+                      batch_op, ParallelDescriptor::Communicator());
+        MPI_Op_free(&batch_op);
+        MPI_Type_free(&batch_type);
+
+        std::size_t ib = 0;
+        for (auto const& seg : m_segments) {
+            for (int i = 0; i < seg.n; ++i) seg.data[i] = buffer[ib++].value;
+        }
+    }
+#endif
+    m_segments.clear();
+
+    // the dispatch functions may add new segments, e.g. for a second reduction
+    auto dispatch = std::move(m_dispatch);
+    m_dispatch.clear();
+    for (auto const& f : dispatch) f();
+    if (!m_segments.empty()) Flush();
+}
+
 // constructor
 ReducedDiags::ReducedDiags (std::string rd_name)
 {
@@ -62,9 +138,39 @@ ReducedDiags::ReducedDiags (std::string rd_name)
 
     // read separator
     pp_rd_name.query("separator", m_sep);
+
+    // the outputs are buffered and written every flush_interval outputs
+    pp_rd_name.query("output_format", m_output_format);
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(
+        m_output_format == "text" || m_output_format == "csv" || m_output_format == "binary",
+        m_rd_name + ".output_format must be text, csv or binary");
+    queryWithParser(pp_rd_name, "flush_interval", m_flush_interval);
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(m_flush_interval >= 1,
+        m_rd_name + ".flush_interval must be at least 1");
+
+    // the csv format is the text format with a comma separator (the header row is
+    // written by the derived classes with m_sep)
+    if (m_output_format == "csv") m_sep = ",";
+
+    // with the binary format, the text file only holds the header row
+    if (m_output_format == "binary" && m_IsNotRestart && ParallelDescriptor::IOProcessor())
+    {
+        std::ofstream ofs_bin{BinaryFileName(), std::ios::trunc | std::ios::binary};
+        ofs_bin.close();
+    }
 }
 // end constructor
 
+ReducedDiags::~ReducedDiags ()
+{
+    FlushBuffer();
+}
+
+std::string ReducedDiags::BinaryFileName () const
+{
+    return m_path + m_rd_name + ".bin";
+}
+
 void ReducedDiags::InitData ()
 {
     // Defines an empty function InitData() to be overwritten if needed.
@@ -93,30 +199,82 @@ void ReducedDiags::BackwardCompatibility ()
 // write to file function
 void ReducedDiags::WriteToFile (int step) const
 {
-    // open file
-    std::ofstream ofs{m_path + m_rd_name + "." + m_extension,
-        std::ofstream::out | std::ofstream::app};
+    // each row holds step, time and m_data
+    m_write_buffer.reserve(m_write_buffer.size() + m_data.size() + 2);
+    m_write_buffer.push_back(step + 1);
+    m_write_buffer.push_back(WarpX::GetInstance().gett_new(0));
+    m_write_buffer.insert(m_write_buffer.end(), m_data.begin(), m_data.end());
+    ++m_buffered_outputs;
 
-    // write step
-    ofs << step+1;
+    if (m_buffered_outputs >= m_flush_interval) FlushBuffer();
+}
+// end ReducedDiags::WriteToFile
 
-    ofs << m_sep;
+void ReducedDiags::FlushBuffer () const
+{
+    if (m_buffered_outputs == 0 || !ParallelDescriptor::IOProcessor()) return;
 
-    // set precision
-    ofs << std::fixed << std::setprecision(14) << std::scientific;
+    if (m_output_format == "binary")
+    {
+        // the rows are written in double precision, in the order of the header row
+        std::ofstream ofs{BinaryFileName(),
+                          std::ofstream::out | std::ofstream::app | std::ofstream::binary};
+        ofs.write(reinterpret_cast<char const*>(m_write_buffer.data()),
+                  static_cast<std::streamsize>(m_write_buffer.size() * sizeof(double)));
+        ofs.close();
+    }
+    else
+    {
+        // open file
+        std::ofstream ofs{m_path + m_rd_name + "." + m_extension,
+            std::ofstream::out | std::ofstream::app};
 
-    // write time
-    ofs << WarpX::GetInstance().gett_new(0);
+        // all the rows of a diagnostic have the same number of columns
+        std::size_t const ncols = m_write_buffer.size() / m_buffered_outputs;
 
-    // loop over data size and write
-    for (const auto& item : m_data) ofs << m_sep << item;
+        // loop over the buffered rows and write
+        for (std::size_t i = 0; i < m_write_buffer.size(); i += ncols)
+        {
+            // write step
+            ofs << static_cast<int>(m_write_buffer[i]);
+
+            ofs << m_sep;
+
+            // set precision
+            ofs << std::fixed << std::setprecision(14) << std::scientific;
 
-    // end loop over data size
+            // write time
+            ofs << m_write_buffer[i + 1];
+
+            // loop over data size and write
+            for (std::size_t k = 2; k < ncols; ++k) ofs << m_sep << m_write_buffer[i + k];
+
+            // end line
+            ofs << "\n";
+        }
 
-    // end line
-    ofs << std::endl;
+        // close file
+        ofs.close();
+    }
 
-    // close file
-    ofs.close();
+    m_write_buffer.clear();
+    m_buffered_outputs = 0;
 }
 // end ReducedDiags::WriteToFile
+
+void ReducedDiags::ParallelReduce (ReductionBatch::Op op, Real* data, int n,
+                                   std::function<void()> dispatch)
+{
+    if (m_reduction_batch) {
+        m_reduction_batch->Add(op, data, n, std::move(dispatch));
+        return;
+    }
+    if (op == ReductionBatch::Op::Sum) {
+        ParallelDescriptor::ReduceRealSum(data, n);
+    } else if (op == ReductionBatch::Op::Max) {
+        ParallelDescriptor::ReduceRealMax(data, n);
+    } else {
+        ParallelDescriptor::ReduceRealMin(data, n);
+    }
+    if (dispatch) dispatch();
+}
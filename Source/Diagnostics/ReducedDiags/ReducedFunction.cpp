@@ -0,0 +1,64 @@
+/* This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+
+#include "ReducedFunction.H"
+
+#include "Utils/TextMsg.H"
+#include "Utils/WarpXUtil.H"
+
+#include <limits>
+#include <regex>
+#include <sstream>
+#include <vector>
+
+ReducedFunction ReadReducedFunction (amrex::ParmParse const& pp_rd_name,
+                                     std::unique_ptr<amrex::Parser>& parser,
+                                     std::string& description)
+{
+    ReducedFunction f;
+
+    std::string type = "parser";
+    pp_rd_name.query("reduced_function_type", type);
+
+    if (type == "parser") {
+        f.type = ReducedFunction::Parser;
+        std::string parser_string = "";
+        Store_parserString(pp_rd_name,"reduced_function(x,y,z)", parser_string);
+        parser = std::make_unique<amrex::Parser>(makeParser(parser_string,{"x","y","z"}));
+        f.parser = parser->compile<3>();
+
+        // Replace all newlines and possible following whitespaces with a single whitespace. This
+        // should avoid weird formatting when the string is written in the header of the output file.
+        description = std::regex_replace(parser_string, std::regex("\n\\s*"), " ");
+    } else if (type == "one") {
+        f.type = ReducedFunction::One;
+        description = "1";
+    } else if (type == "box") {
+        f.type = ReducedFunction::Box;
+        std::vector<amrex::Real> lo, hi;
+        getArrWithParser(pp_rd_name, "box_lo", lo, 0, AMREX_SPACEDIM);
+        getArrWithParser(pp_rd_name, "box_hi", hi, 0, AMREX_SPACEDIM);
+        // the corners are given in the coordinates of the simulation (x, z in 2D)
+        constexpr amrex::Real inf = std::numeric_limits<amrex::Real>::max();
+#if (AMREX_SPACEDIM==2)
+        f.lo = {lo[0], -inf, lo[1]};
+        f.hi = {hi[0], inf, hi[1]};
+#else
+        f.lo = {lo[0], lo[1], lo[2]};
+        f.hi = {hi[0], hi[1], hi[2]};
+#endif
+        std::stringstream ss;
+        ss << "box(";
+        for (int d = 0; d < AMREX_SPACEDIM; ++d) ss << (d ? "," : "") << lo[d];
+        ss << ";";
+        for (int d = 0; d < AMREX_SPACEDIM; ++d) ss << (d ? "," : "") << hi[d];
+        ss << ")";
+        description = ss.str();
+    } else {
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(false,
+            "reduced_function_type must be parser, one or box");
+    }
+    return f;
+}
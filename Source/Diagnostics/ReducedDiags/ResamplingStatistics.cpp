@@ -0,0 +1,124 @@
+/* This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+
+#include "ResamplingStatistics.H"
+
+#include "Parallelization/CostsBreakdown.H"
+#include "Particles/MultiParticleContainer.H"
+#include "Particles/WarpXParticleContainer.H"
+#include "Utils/IntervalsParser.H"
+#include "Utils/TextMsg.H"
+#include "WarpX.H"
+
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_REAL.H>
+
+#include <fstream>
+#include <ostream>
+#include <vector>
+
+using namespace amrex::literals;
+
+// constructor
+ResamplingStatistics::ResamplingStatistics (std::string rd_name)
+: ReducedDiags{rd_name}
+{
+    bool step_phase_timers = true;
+    amrex::ParmParse pp_warpx("warpx");
+    pp_warpx.query("step_phase_timers", step_phase_timers);
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(step_phase_timers,
+        "ResamplingStatistics reduced diagnostics requires warpx.step_phase_timers = 1");
+
+    const auto & mypc = WarpX::GetInstance().GetPartContainer();
+    const auto species_names = mypc.GetSpeciesNames();
+    for (int i_s = 0; i_s < mypc.nSpecies(); ++i_s)
+    {
+        if (mypc.GetParticleContainer(i_s).doResampling()) { m_species.push_back(i_s); }
+    }
+    const int n_species = static_cast<int>(m_species.size());
+
+    m_sums.resize(2*n_species + 1, 0.0_rt);
+    // tiles, removed macroparticles and time saved of each species, then total time saved
+    m_data.resize(3*n_species + 1, 0.0_rt);
+
+    if (amrex::ParallelDescriptor::IOProcessor())
+    {
+        if ( m_IsNotRestart )
+        {
+            // open file
+            std::ofstream ofs{m_path + m_rd_name + "." + m_extension, std::ofstream::out};
+            // write header row
+            int c = 0;
+            ofs << "#";
+            ofs << "[" << c++ << "]step()";
+            ofs << m_sep;
+            ofs << "[" << c++ << "]time(s)";
+            for (const int i_s : m_species)
+            {
+                ofs << m_sep;
+                ofs << "[" << c++ << "]" << species_names[i_s] + " tiles resampled()";
+                ofs << m_sep;
+                ofs << "[" << c++ << "]" << species_names[i_s] + " macroparticles removed()";
+                ofs << m_sep;
+                ofs << "[" << c++ << "]" << species_names[i_s] + " time saved(s)";
+            }
+            ofs << m_sep;
+            ofs << "[" << c++ << "]total time saved(s)";
+            ofs << std::endl;
+            // close file
+            ofs.close();
+        }
+    }
+}
+// end constructor
+
+// function that gathers the resampling statistics
+void ResamplingStatistics::ComputeDiags (int step)
+{
+    // Judge if the diags should be done
+    if (!m_intervals.contains(step+1)) { return; }
+
+    auto & warpx = WarpX::GetInstance();
+    const auto & mypc = warpx.GetPartContainer();
+    const int n_species = static_cast<int>(m_species.size());
+
+    for (int k = 0; k < n_species; ++k)
+    {
+        const auto & myspc = mypc.GetParticleContainer(m_species[k]);
+        m_sums[2*k] = static_cast<amrex::Real>(myspc.getResamplingNumTiles());
+        m_sums[2*k+1] = static_cast<amrex::Real>(myspc.getResamplingNumRemoved());
+    }
+    amrex::Real numparts = 0.0_rt;
+    for (int i_s = 0; i_s < mypc.nSpecies(); ++i_s)
+    {
+        numparts += static_cast<amrex::Real>(
+            mypc.GetParticleContainer(i_s).TotalNumberOfParticles(true, true));
+    }
+    m_sums[2*n_species] = numparts;
+    m_particles_time = warpx.getStepPhaseTimes()[CostPhase::Particles];
+
+    ParallelReduce(ReductionBatch::Op::Max, &m_particles_time, 1);
+    ParallelReduce(ReductionBatch::Op::Sum, m_sums.data(), static_cast<int>(m_sums.size()),
+        [this, n_species] ()
+        {
+            // the cost of the particles phase is assumed proportional to the number of
+            // macroparticles, so that each removed macroparticle saves the time of one
+            // remaining macroparticle
+            const amrex::Real numparts_all = m_sums[2*n_species];
+            const amrex::Real time_per_particle =
+                (numparts_all > 0.0_rt) ? m_particles_time/numparts_all : 0.0_rt;
+            amrex::Real total_saved = 0.0_rt;
+            for (int k = 0; k < n_species; ++k)
+            {
+                m_data[3*k] = m_sums[2*k];
+                m_data[3*k+1] = m_sums[2*k+1];
+                m_data[3*k+2] = m_sums[2*k+1]*time_per_particle;
+                total_saved += m_data[3*k+2];
+            }
+            m_data[3*n_species] = total_saved;
+        });
+}
+// end void ResamplingStatistics::ComputeDiags
@@ -0,0 +1,87 @@
+/* This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+
+#include "StepPhaseTimes.H"
+
+#include "Parallelization/CostsBreakdown.H"
+#include "Utils/IntervalsParser.H"
+#include "Utils/TextMsg.H"
+#include "WarpX.H"
+
+#include <AMReX.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_REAL.H>
+
+#include <fstream>
+#include <ostream>
+#include <vector>
+
+using namespace amrex::literals;
+
+// constructor
+StepPhaseTimes::StepPhaseTimes (std::string rd_name)
+: ReducedDiags{rd_name}
+{
+    bool step_phase_timers = true;
+    amrex::ParmParse pp_warpx("warpx");
+    pp_warpx.query("step_phase_timers", step_phase_timers);
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(step_phase_timers,
+        "StepPhaseTimes reduced diagnostics requires warpx.step_phase_timers = 1");
+
+    // time of each phase, of the rest of the step and of the whole step
+    m_data.resize(CostPhase::NumStepPhases + 2, 0.0_rt);
+
+    if (amrex::ParallelDescriptor::IOProcessor())
+    {
+        if ( m_IsNotRestart )
+        {
+            // open file
+            std::ofstream ofs{m_path + m_rd_name + "." + m_extension, std::ofstream::out};
+            // write header row
+            int c = 0;
+            ofs << "#";
+            ofs << "[" << c++ << "]step()";
+            ofs << m_sep;
+            ofs << "[" << c++ << "]time(s)";
+            for (int phase = 0; phase < CostPhase::NumStepPhases; ++phase)
+            {
+                ofs << m_sep;
+                ofs << "[" << c++ << "]" << CostPhaseName(phase) << "(s)";
+            }
+            ofs << m_sep;
+            ofs << "[" << c++ << "]other(s)";
+            ofs << m_sep;
+            ofs << "[" << c++ << "]step(s)";
+            ofs << std::endl;
+            // close file
+            ofs.close();
+        }
+    }
+}
+// end constructor
+
+// function that reads the wall-clock times of the phases of the last step
+void StepPhaseTimes::ComputeDiags (int step)
+{
+    // Judge if the diags should be done
+    if (!m_intervals.contains(step+1)) { return; }
+
+    auto & warpx = WarpX::GetInstance();
+    auto const& phase_times = warpx.getStepPhaseTimes();
+
+    amrex::Real timed = 0._rt;
+    for (int phase = 0; phase < CostPhase::NumStepPhases; ++phase)
+    {
+        m_data[phase] = phase_times[phase];
+        timed += phase_times[phase];
+    }
+    m_data[CostPhase::NumStepPhases] = warpx.getStepWallTime() - timed;
+    m_data[CostPhase::NumStepPhases + 1] = warpx.getStepWallTime();
+
+    // the slowest rank determines the time of each phase
+    ParallelReduce(ReductionBatch::Op::Max, m_data.data(), static_cast<int>(m_data.size()));
+}
+// end void StepPhaseTimes::ComputeDiags
@@ -0,0 +1,121 @@
+/* This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+
+#include "SurfaceFaceList.H"
+
+#include <AMReX_Arena.H>
+#include <AMReX_Array4.H>
+#include <AMReX_Box.H>
+#include <AMReX_FArrayBox.H>
+#include <AMReX_GpuControl.H>
+#include <AMReX_GpuDevice.H>
+#include <AMReX_GpuLaunch.H>
+#include <AMReX_GpuQualifiers.H>
+#include <AMReX_IntVect.H>
+#include <AMReX_MFIter.H>
+#include <AMReX_Reduce.H>
+#include <AMReX_RealBox.H>
+#include <AMReX_Tuple.H>
+#include <AMReX_Vector.H>
+
+using namespace amrex;
+
+bool SurfaceFaceList::IsValid (MultiFab const& mf) const
+{
+    return mf.boxArray() == m_ba && mf.DistributionMap() == m_dm;
+}
+
+void SurfaceFaceList::Build (MultiFab const& mf, ReducedFunction const& reduced_function,
+                             Geometry const& geom)
+{
+    m_ba = mf.boxArray();
+    m_dm = mf.DistributionMap();
+
+    auto const reduction_function_parser = reduced_function;
+    IntVect const nodal_type = mf.ixType().toIntVect();
+    RealBox const& real_box = geom.ProbDomain();
+    auto const dx = geom.CellSizeArray();
+
+    Vector<int> h_fab, h_i, h_j, h_k;
+    Vector<Real> h_weight;
+
+    // the weights are computed on the device into pinned memory, and compacted on the host
+    for (MFIter mfi(mf, false); mfi.isValid(); ++mfi)
+    {
+        Box const& bx = mfi.tilebox(nodal_type);
+        IntVect const lo = bx.smallEnd();
+        IntVect const hi = bx.bigEnd();
+        FArrayBox wfab(bx, 1, The_Pinned_Arena());
+        Array4<Real> const& w = wfab.array();
+
+        ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+        {
+            // Shift x, y, z position based on index type
+            Real const x = i * dx[0] + real_box.lo(0) + (1._rt - nodal_type[0]) * dx[0] * 0.5_rt;
+#if (AMREX_SPACEDIM==2)
+            Real const y = 0._rt;
+            Real const z = j * dx[1] + real_box.lo(1) + (1._rt - nodal_type[1]) * dx[1] * 0.5_rt;
+            IntVect const iv(i, j);
+#else
+            Real const y = j * dx[1] + real_box.lo(1) + (1._rt - nodal_type[1]) * dx[1] * 0.5_rt;
+            Real const z = k * dx[2] + real_box.lo(2) + (1._rt - nodal_type[2]) * dx[2] * 0.5_rt;
+            IntVect const iv(i, j, k);
+#endif
+            // the points on the box faces in the nodal directions are shared with the
+            // neighbouring boxes and weigh 0.5 in each of these directions
+            Real weight = 1.0_rt;
+            for (int d = 0; d < AMREX_SPACEDIM; ++d) {
+                if (nodal_type[d] == 1 && (iv[d] == lo[d] || iv[d] == hi[d])) weight *= 0.5_rt;
+            }
+            w(i,j,k) = weight * reduction_function_parser(x,y,z);
+        });
+        Gpu::streamSynchronize();
+
+        int const local_index = mfi.LocalIndex();
+        amrex::LoopOnCpu(bx, [&] (int i, int j, int k)
+        {
+            if (w(i,j,k) == 0._rt) return;
+            h_fab.push_back(local_index);
+            h_i.push_back(i);
+            h_j.push_back(j);
+            h_k.push_back(k);
+            h_weight.push_back(w(i,j,k));
+        });
+    }
+
+    auto const copy_to_device = [] (auto const& h, auto& d) {
+        d.resize(h.size());
+        Gpu::copyAsync(Gpu::hostToDevice, h.begin(), h.end(), d.begin());
+    };
+    copy_to_device(h_fab, m_fab);
+    copy_to_device(h_i, m_i);
+    copy_to_device(h_j, m_j);
+    copy_to_device(h_k, m_k);
+    copy_to_device(h_weight, m_weight);
+    Gpu::synchronize();
+}
+
+Real SurfaceFaceList::Sum (MultiFab const& mf) const
+{
+    int const n = static_cast<int>(m_weight.size());
+    if (n == 0) return 0._rt;
+
+    auto const field_arrays = mf.const_arrays();
+    int const* const AMREX_RESTRICT fab = m_fab.dataPtr();
+    int const* const AMREX_RESTRICT ii = m_i.dataPtr();
+    int const* const AMREX_RESTRICT jj = m_j.dataPtr();
+    int const* const AMREX_RESTRICT kk = m_k.dataPtr();
+    Real const* const AMREX_RESTRICT weight = m_weight.dataPtr();
+
+    ReduceOps<ReduceOpSum> reduce_op;
+    ReduceData<Real> reduce_data(reduce_op);
+    using ReduceTuple = typename decltype(reduce_data)::Type;
+    reduce_op.eval(n, reduce_data,
+        [=] AMREX_GPU_DEVICE (int s) -> ReduceTuple
+        {
+            return {weight[s] * field_arrays[fab[s]](ii[s], jj[s], kk[s])};
+        });
+    return amrex::get<0>(reduce_data.value());
+}
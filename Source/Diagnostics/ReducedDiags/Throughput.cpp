@@ -0,0 +1,97 @@
+/* This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+
+#include "Throughput.H"
+
+#include "Parallelization/CostsBreakdown.H"
+#include "Utils/IntervalsParser.H"
+#include "Utils/StepCostModel.H"
+#include "WarpX.H"
+
+#include <AMReX.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_REAL.H>
+
+#include <fstream>
+#include <ostream>
+#include <vector>
+
+using namespace amrex::literals;
+
+namespace
+{
+    // steps in the window, steps/s, cell updates/s, LLG iterations/s, remaining steps,
+    // projected wall-clock time to the end, and time of the step
+    constexpr int NumRates = 7;
+}
+
+// constructor
+Throughput::Throughput (std::string rd_name)
+: ReducedDiags{rd_name}
+{
+    // rates and projection, followed by the average time of each phase
+    m_data.resize(NumRates + CostPhase::NumStepPhases, 0.0_rt);
+
+    if (amrex::ParallelDescriptor::IOProcessor())
+    {
+        if ( m_IsNotRestart )
+        {
+            // open file
+            std::ofstream ofs{m_path + m_rd_name + "." + m_extension, std::ofstream::out};
+            // write header row
+            int c = 0;
+            ofs << "#";
+            ofs << "[" << c++ << "]step()";
+            ofs << m_sep;
+            ofs << "[" << c++ << "]time(s)";
+            ofs << m_sep;
+            ofs << "[" << c++ << "]window_steps()";
+            ofs << m_sep;
+            ofs << "[" << c++ << "]steps_per_second(1/s)";
+            ofs << m_sep;
+            ofs << "[" << c++ << "]cell_updates_per_second(1/s)";
+            ofs << m_sep;
+            ofs << "[" << c++ << "]LLG_iterations_per_second(1/s)";
+            ofs << m_sep;
+            ofs << "[" << c++ << "]remaining_steps()";
+            ofs << m_sep;
+            ofs << "[" << c++ << "]projected_walltime(s)";
+            ofs << m_sep;
+            ofs << "[" << c++ << "]step(s)";
+            for (int phase = 0; phase < CostPhase::NumStepPhases; ++phase)
+            {
+                ofs << m_sep;
+                ofs << "[" << c++ << "]" << CostPhaseName(phase) << "(s)";
+            }
+            ofs << std::endl;
+            // close file
+            ofs.close();
+        }
+    }
+}
+// end constructor
+
+// function that reads the throughput over the last steps
+void Throughput::ComputeDiags (int step)
+{
+    // Judge if the diags should be done
+    if (!m_intervals.contains(step+1)) { return; }
+
+    // collective: the times of the slowest rank are used
+    const StepCostModel::Summary s = WarpX::GetInstance().getThroughput();
+
+    m_data[0] = s.num_steps;
+    m_data[1] = s.steps_per_second;
+    m_data[2] = s.cell_updates_per_second;
+    m_data[3] = s.llg_iterations_per_second;
+    m_data[4] = static_cast<amrex::Real>(s.remaining_steps);
+    m_data[5] = s.projected_time;
+    m_data[6] = s.step_time;
+    for (int phase = 0; phase < CostPhase::NumStepPhases; ++phase)
+    {
+        m_data[NumRates + phase] = (phase < static_cast<int>(s.phase_times.size())) ? s.phase_times[phase] : 0._rt;
+    }
+}
+// end void Throughput::ComputeDiags
@@ -37,6 +37,7 @@
 #include <cmath>
 #include <memory>
 #include <sstream>
+#include <utility>
 
 using namespace amrex;
 
@@ -56,16 +57,23 @@ using namespace amrex;
  *  CellSize of the underlying grid.
  *  \param slice_realbox defines the extent of the slice
  *  \param slice_cr_ratio provides the coarsening ratio for diagnostics
+ *  This allocates a new slice: the outputs at a high rate use a PersistentSlice instead.
  */
 
 std::unique_ptr<MultiFab>
 CreateSlice( const MultiFab& mf, const Vector<Geometry> &dom_geom,
              RealBox &slice_realbox, IntVect &slice_cr_ratio )
 {
-    std::unique_ptr<MultiFab> smf;
-    std::unique_ptr<MultiFab> cs_mf;
+    PersistentSlice slice;
+    slice(mf, dom_geom, slice_realbox, slice_cr_ratio);
+    return slice.release();
+}
+
 
-    Vector<int> slice_ncells(AMREX_SPACEDIM);
+const MultiFab&
+PersistentSlice::operator() ( const MultiFab& mf, const Vector<Geometry> &dom_geom,
+                              RealBox &slice_realbox, IntVect &slice_cr_ratio )
+{
     int nghost = 1;
     auto nlevels = static_cast<int>(dom_geom.size());
     int ncomp = (mf).nComp();
@@ -81,37 +89,136 @@ CreateSlice( const MultiFab& mf, const Vector<Geometry> &dom_geom,
     }
 
     const RealBox& real_box = dom_geom[0].ProbDomain();
-    RealBox slice_cc_nd_box;
+
+    // The slice is rebuilt after a regrid of mf, or if the input of the slice changed //
+    bool same_input = (m_smf != nullptr) && m_smf->nComp() == ncomp
+        && m_smf->ixType() == conversionType
+        && m_src_ba == mf.boxArray() && m_src_dm == mf.DistributionMap()
+        && m_input_cr_ratio == slice_cr_ratio;
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        same_input = same_input && m_input_realbox.lo(idim) == slice_realbox.lo(idim)
+                                && m_input_realbox.hi(idim) == slice_realbox.hi(idim);
+    }
+    if (!same_input) {
+        m_input_realbox = slice_realbox;
+        m_input_cr_ratio = slice_cr_ratio;
+        Define(mf, dom_geom, slice_realbox, slice_cr_ratio, SliceType);
+    }
+    // Return the slice parameters modified to comply with the domain and coarsening //
+    slice_realbox = m_slice_realbox;
+    slice_cr_ratio = m_slice_cr_ratio;
+
+    // Copy data from domain to slice that has same cell size as that of //
+    // the domain mf. src and dst have the same number of ghost cells    //
+    amrex::IntVect nghost_vect(AMREX_D_DECL(nghost, nghost, nghost));
+    WarpXCommUtil::ParallelCopy(*m_smf, mf, 0, 0, ncomp,nghost_vect,nghost_vect);
+
+    // inteprolate if required on refined slice //
+    if (m_interpolate) {
+       InterpolateSliceValues( *m_smf, m_interp_lo, m_slice_cc_nd_box, dom_geom,
+                               ncomp, nghost, m_slice_lo, m_slice_hi, SliceType, real_box);
+    }
+
+    if (m_cs_mf == nullptr) {
+       return *m_smf;
+    }
+
+    MultiFab& mfSrc = *m_smf;
+    MultiFab& mfDst = *m_cs_mf;
+
+    MFIter mfi_dst(mfDst);
+    for (MFIter mfi(mfSrc); mfi.isValid(); ++mfi) {
+
+        Array4<Real const> const& Src_fabox = mfSrc.const_array(mfi);
+
+        const Box& Dst_bx = mfi_dst.validbox();
+        Array4<Real> const& Dst_fabox = mfDst.array(mfi_dst);
+
+        int scomp = 0;
+        int dcomp = 0;
+
+        IntVect cctype(AMREX_D_DECL(0,0,0));
+        if( SliceType==cctype ) {
+           amrex::amrex_avgdown(Dst_bx, Dst_fabox, Src_fabox, dcomp, scomp,
+                                ncomp, m_slice_cr_ratio);
+        }
+        IntVect ndtype(AMREX_D_DECL(1,1,1));
+        if( SliceType == ndtype ) {
+           amrex::amrex_avgdown_nodes(Dst_bx, Dst_fabox, Src_fabox, dcomp,
+                                      scomp, ncomp, m_slice_cr_ratio);
+        }
+        if( SliceType == WarpX::GetInstance().getEfield(0,0).ixType().toIntVect() ) {
+           amrex::amrex_avgdown_edges(Dst_bx, Dst_fabox, Src_fabox, dcomp,
+                                      scomp, ncomp, m_slice_cr_ratio, 0);
+        }
+        if( SliceType == WarpX::GetInstance().getEfield(0,1).ixType().toIntVect() ) {
+           amrex::amrex_avgdown_edges(Dst_bx, Dst_fabox, Src_fabox, dcomp,
+                                      scomp, ncomp, m_slice_cr_ratio, 1);
+        }
+        if( SliceType == WarpX::GetInstance().getEfield(0,2).ixType().toIntVect() ) {
+           amrex::amrex_avgdown_edges(Dst_bx, Dst_fabox, Src_fabox, dcomp,
+                                      scomp, ncomp, m_slice_cr_ratio, 2);
+        }
+        if( SliceType == WarpX::GetInstance().getBfield(0,0).ixType().toIntVect() ) {
+           amrex::amrex_avgdown_faces(Dst_bx, Dst_fabox, Src_fabox, dcomp,
+                                      scomp, ncomp, m_slice_cr_ratio, 0);
+        }
+        if( SliceType == WarpX::GetInstance().getBfield(0,1).ixType().toIntVect() ) {
+           amrex::amrex_avgdown_faces(Dst_bx, Dst_fabox, Src_fabox, dcomp,
+                                      scomp, ncomp, m_slice_cr_ratio, 1);
+        }
+        if( SliceType == WarpX::GetInstance().getBfield(0,2).ixType().toIntVect() ) {
+           amrex::amrex_avgdown_faces(Dst_bx, Dst_fabox, Src_fabox, dcomp,
+                                      scomp, ncomp, m_slice_cr_ratio, 2);
+        }
+
+        if ( mfi_dst.isValid() ) {
+           ++mfi_dst;
+        }
+
+    }
+    return *m_cs_mf;
+}
+
+
+void
+PersistentSlice::Define ( const MultiFab& mf, const Vector<Geometry> &dom_geom,
+                          RealBox slice_realbox, IntVect slice_cr_ratio,
+                          const IntVect SliceType )
+{
+    m_smf = nullptr;
+    m_cs_mf = nullptr;
+    m_src_ba = mf.boxArray();
+    m_src_dm = mf.DistributionMap();
+
+    int nghost = 1;
+    int ncomp = (mf).nComp();
+    const RealBox& real_box = dom_geom[0].ProbDomain();
     int slice_grid_size = 32;
 
-    bool interpolate = false;
     bool coarsen = false;
 
     // same index space as domain //
     IntVect slice_lo(AMREX_D_DECL(0,0,0));
     IntVect slice_hi(AMREX_D_DECL(1,1,1));
     IntVect interp_lo(AMREX_D_DECL(0,0,0));
+    RealBox slice_cc_nd_box;
 
     CheckSliceInput(real_box, slice_cc_nd_box, slice_realbox, slice_cr_ratio,
                     dom_geom, SliceType, slice_lo,
                     slice_hi, interp_lo);
+    m_interpolate = false;
     int configuration_dim = 0;
     // Determine if interpolation is required and number of cells in slice //
     for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
 
        // Flag for interpolation if required //
        if ( interp_lo[idim] == 1) {
-          interpolate = 1;
+          m_interpolate = true;
        }
 
        // For the case when a dimension is reduced //
-       if ( ( slice_hi[idim] - slice_lo[idim]) == 1) {
-          slice_ncells[idim] = 1;
-       }
-       else {
-          slice_ncells[idim] = ( slice_hi[idim] - slice_lo[idim] + 1 )
-                                / slice_cr_ratio[idim];
-
+       if ( ( slice_hi[idim] - slice_lo[idim]) != 1) {
           int refined_ncells = slice_hi[idim] - slice_lo[idim] + 1 ;
           if ( slice_cr_ratio[idim] > 1) {
              coarsen = true;
@@ -133,104 +240,59 @@ CreateSlice( const MultiFab& mf, const Vector<Geometry> &dom_geom,
     // Slice generation with index type inheritance //
     Box slice(slice_lo, slice_hi);
 
-    Vector<BoxArray> sba(1);
-    sba[0].define(slice);
-    sba[0].maxSize(slice_grid_size);
-
-    // Distribution mapping for slice can be different from that of domain //
-    Vector<DistributionMapping> sdmap(1);
-    sdmap[0] = DistributionMapping{sba[0]};
-
-    smf = std::make_unique<MultiFab>(amrex::convert(sba[0],SliceType), sdmap[0],
-                           ncomp, nghost);
-
-    // Copy data from domain to slice that has same cell size as that of //
-    // the domain mf. src and dst have the same number of ghost cells    //
-    amrex::IntVect nghost_vect(AMREX_D_DECL(nghost, nghost, nghost));
-    WarpXCommUtil::ParallelCopy(*smf, mf, 0, 0, ncomp,nghost_vect,nghost_vect);
-
-    // inteprolate if required on refined slice //
-    if (interpolate == 1 ) {
-       InterpolateSliceValues( *smf, interp_lo, slice_cc_nd_box, dom_geom,
-                               ncomp, nghost, slice_lo, slice_hi, SliceType, real_box);
+    // The slice is split along the boxes of mf that it intersects, and each part is owned //
+    // by the process that owns the box of mf, so that only these processes take part in  //
+    // the copy, and that most of the copy is local                                       //
+    const BoxArray src_cc_ba = amrex::convert(m_src_ba, IntVect::TheCellVector());
+    BoxList slice_bl;
+    Vector<int> slice_procs;
+    for (int isrc = 0; isrc < src_cc_ba.size(); ++isrc) {
+        const Box bx = src_cc_ba[isrc] & slice;
+        if (bx.ok()) {
+            slice_bl.push_back(bx);
+            slice_procs.push_back(m_src_dm[isrc]);
+        }
     }
-
-
-    if (coarsen == false) {
-       return smf;
+    BoxArray sba(std::move(slice_bl));
+    DistributionMapping sdmap(slice_procs);
+    // The parts of the slice must be coarsenable to be averaged down, //
+    // otherwise the slice is split in boxes of slice_grid_size        //
+    if (coarsen && !sba.coarsenable(slice_cr_ratio)) {
+        sba.define(slice);
+        sba.maxSize(slice_grid_size);
+        sdmap = DistributionMapping{sba};
     }
-    else if ( coarsen == true ) {
-       Vector<BoxArray> crse_ba(1);
-       crse_ba[0] = sba[0];
-       crse_ba[0].coarsen(slice_cr_ratio);
-
-       AMREX_ALWAYS_ASSERT(crse_ba[0].size() == sba[0].size());
 
-       cs_mf = std::make_unique<MultiFab>(amrex::convert(crse_ba[0],SliceType),
-                    sdmap[0], ncomp,nghost);
+    m_smf = std::make_unique<MultiFab>(amrex::convert(sba,SliceType), sdmap,
+                                       ncomp, nghost);
 
-       MultiFab& mfSrc = *smf;
-       MultiFab& mfDst = *cs_mf;
+    if (coarsen) {
+       BoxArray crse_ba = sba;
+       crse_ba.coarsen(slice_cr_ratio);
 
-       MFIter mfi_dst(mfDst);
-       for (MFIter mfi(mfSrc); mfi.isValid(); ++mfi) {
+       AMREX_ALWAYS_ASSERT(crse_ba.size() == sba.size());
 
-           Array4<Real const> const& Src_fabox = mfSrc.const_array(mfi);
-
-           const Box& Dst_bx = mfi_dst.validbox();
-           Array4<Real> const& Dst_fabox = mfDst.array(mfi_dst);
-
-           int scomp = 0;
-           int dcomp = 0;
-
-           IntVect cctype(AMREX_D_DECL(0,0,0));
-           if( SliceType==cctype ) {
-              amrex::amrex_avgdown(Dst_bx, Dst_fabox, Src_fabox, dcomp, scomp,
-                                   ncomp, slice_cr_ratio);
-           }
-           IntVect ndtype(AMREX_D_DECL(1,1,1));
-           if( SliceType == ndtype ) {
-              amrex::amrex_avgdown_nodes(Dst_bx, Dst_fabox, Src_fabox, dcomp,
-                                         scomp, ncomp, slice_cr_ratio);
-           }
-           if( SliceType == WarpX::GetInstance().getEfield(0,0).ixType().toIntVect() ) {
-              amrex::amrex_avgdown_edges(Dst_bx, Dst_fabox, Src_fabox, dcomp,
-                                         scomp, ncomp, slice_cr_ratio, 0);
-           }
-           if( SliceType == WarpX::GetInstance().getEfield(0,1).ixType().toIntVect() ) {
-              amrex::amrex_avgdown_edges(Dst_bx, Dst_fabox, Src_fabox, dcomp,
-                                         scomp, ncomp, slice_cr_ratio, 1);
-           }
-           if( SliceType == WarpX::GetInstance().getEfield(0,2).ixType().toIntVect() ) {
-              amrex::amrex_avgdown_edges(Dst_bx, Dst_fabox, Src_fabox, dcomp,
-                                         scomp, ncomp, slice_cr_ratio, 2);
-           }
-           if( SliceType == WarpX::GetInstance().getBfield(0,0).ixType().toIntVect() ) {
-              amrex::amrex_avgdown_faces(Dst_bx, Dst_fabox, Src_fabox, dcomp,
-                                         scomp, ncomp, slice_cr_ratio, 0);
-           }
-           if( SliceType == WarpX::GetInstance().getBfield(0,1).ixType().toIntVect() ) {
-              amrex::amrex_avgdown_faces(Dst_bx, Dst_fabox, Src_fabox, dcomp,
-                                         scomp, ncomp, slice_cr_ratio, 1);
-           }
-           if( SliceType == WarpX::GetInstance().getBfield(0,2).ixType().toIntVect() ) {
-              amrex::amrex_avgdown_faces(Dst_bx, Dst_fabox, Src_fabox, dcomp,
-                                         scomp, ncomp, slice_cr_ratio, 2);
-           }
+       m_cs_mf = std::make_unique<MultiFab>(amrex::convert(crse_ba,SliceType),
+                    sdmap, ncomp,nghost);
+    }
 
-           if ( mfi_dst.isValid() ) {
-              ++mfi_dst;
-           }
+    m_slice_realbox = slice_realbox;
+    m_slice_cr_ratio = slice_cr_ratio;
+    m_slice_cc_nd_box = slice_cc_nd_box;
+    m_slice_lo = slice_lo;
+    m_slice_hi = slice_hi;
+    m_interp_lo = interp_lo;
+}
 
-       }
-       return cs_mf;
 
+std::unique_ptr<MultiFab>
+PersistentSlice::release ()
+{
+    if (m_cs_mf != nullptr) {
+        m_smf = nullptr;
+        return std::move(m_cs_mf);
     }
-
-    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(
-       false, "Should not hit this return statement.");
-
-    return smf;
+    return std::move(m_smf);
 }
 
 
@@ -12,10 +12,12 @@
 #    include "BoundaryConditions/PML_RZ.H"
 #endif
 #include "FieldIO.H"
+#include "FieldSolver/FiniteDifferenceSolver/MacroscopicProperties/MacroscopicProperties.H"
 #include "Particles/MultiParticleContainer.H"
 #include "Parallelization/WarpXCommUtil.H"
 #include "Utils/CoarsenIO.H"
 #include "Utils/TextMsg.H"
+#include "Utils/WarpXAlgorithmSelection.H"
 #include "Utils/WarpXProfilerWrapper.H"
 #include "WarpX.H"
 
@@ -33,12 +35,16 @@
 #include <AMReX_Print.H>
 #include <AMReX_REAL.H>
 #include <AMReX_RealBox.H>
+#include <AMReX_Utility.H>
 #include <AMReX_Vector.H>
 #include <AMReX_VisMF.H>
 
 #include <array>
+#include <fstream>
 #include <istream>
+#include <limits>
 #include <memory>
+#include <sstream>
 #include <string>
 #include <utility>
 
@@ -47,6 +53,33 @@ using namespace amrex;
 namespace
 {
     const std::string level_prefix {"Level_"};
+
+    /** Checkpoint holding the static fields (material properties, H_bias) of the checkpoint chkfile: the base
+     *  checkpoint referenced by an incremental checkpoint, or chkfile itself */
+    std::string StaticFieldsCheckpoint (const std::string& chkfile)
+    {
+        const std::string base_file_name = chkfile + "/BaseCheckpoint";
+        if (!amrex::FileExists(base_file_name)) return chkfile;
+
+        Vector<char> fileCharPtr;
+        ParallelDescriptor::ReadAndBcastFile(base_file_name, fileCharPtr);
+        std::string fileCharPtrString(fileCharPtr.dataPtr());
+        std::istringstream is(fileCharPtrString, std::istringstream::in);
+        std::string base_name;
+        is >> base_name;
+
+        // The base checkpoint is in the same directory as chkfile
+        std::string dir = chkfile;
+        while (dir.size() > 1 && dir.back() == '/') dir.pop_back();
+        const auto slash = dir.find_last_of('/');
+        const std::string base_chkfile =
+            (slash == std::string::npos ? "" : dir.substr(0, slash + 1)) + base_name;
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(
+            amrex::FileExists(base_chkfile + "/WarpXHeader"),
+            "Base checkpoint " + base_chkfile + " of the incremental checkpoint "
+            + chkfile + " not found");
+        return base_chkfile;
+    }
 }
 
 void
@@ -56,6 +89,34 @@ WarpX::GotoNextLine (std::istream& is)
     is.ignore(bl_ignore_max, '\n');
 }
 
+#ifdef WARPX_MAG_LLG
+void
+WarpX::WriteLLGState (const std::string& chkfile) const
+{
+    if (!ParallelDescriptor::IOProcessor()) return;
+    std::ofstream ofs(chkfile + "/LLGState");
+    ofs.precision(std::numeric_limits<amrex::Real>::max_digits10);
+    ofs << m_llg_subcycle_n << ' ' << m_llg_subcycle_count << ' ' << m_llg_subcycle_dt << '\n';
+}
+
+void
+WarpX::ReadLLGState (const std::string& chkfile)
+{
+    // checkpoints written before the LLG state was saved restart with a new sub-cycle
+    const std::string file_name = chkfile + "/LLGState";
+    int exists = 0;
+    if (ParallelDescriptor::IOProcessor()) exists = amrex::FileExists(file_name);
+    ParallelDescriptor::Bcast(&exists, 1, ParallelDescriptor::IOProcessorNumber());
+    if (!exists) return;
+
+    Vector<char> fileCharPtr;
+    ParallelDescriptor::ReadAndBcastFile(file_name, fileCharPtr);
+    std::istringstream is(fileCharPtr.dataPtr(), std::istringstream::in);
+    is.exceptions(std::ios_base::failbit | std::ios_base::badbit);
+    is >> m_llg_subcycle_n >> m_llg_subcycle_count >> m_llg_subcycle_dt;
+}
+#endif
+
 amrex::DistributionMapping
 WarpX::GetRestartDMap (const std::string& chkfile, const amrex::BoxArray& ba, int lev) const {
     std::string DMFileName = chkfile;
@@ -94,6 +155,22 @@ WarpX::InitFromCheckpoint ()
 {
     WARPX_PROFILE("WarpX::InitFromCheckpoint()");
 
+    // The copy of a checkpoint written on node-local storage to the global path may not be
+    // complete (its WarpXHeader is copied last): restart from the node-local copy then
+    if (!restart_local_path.empty()) {
+        std::string name = restart_chkfile;
+        while (name.size() > 1 && name.back() == '/') name.pop_back();
+        const std::string local_chkfile =
+            restart_local_path + "/" + name.substr(name.find_last_of('/') + 1);
+        int use_local = 0;
+        if (ParallelDescriptor::IOProcessor()) {
+            use_local = !amrex::FileExists(restart_chkfile + "/WarpXHeader") &&
+                amrex::FileExists(local_chkfile + "/WarpXHeader");
+        }
+        ParallelDescriptor::Bcast(&use_local, 1, ParallelDescriptor::IOProcessorNumber());
+        if (use_local) restart_chkfile = local_chkfile;
+    }
+
     amrex::Print()<< Utils::TextMsg::Info(
         "restart from checkpoint " + restart_chkfile);
 
@@ -225,8 +302,23 @@ WarpX::InitFromCheckpoint ()
         GotoNextLine(is);
     }
 
+#ifdef WARPX_MAG_LLG
+    if (mag_LLG) ReadLLGState(restart_chkfile);
+#endif
+
     const int nlevs = finestLevel()+1;
 
+    // An incremental checkpoint reads the static fields from its base checkpoint
+    const std::string static_chkfile = StaticFieldsCheckpoint(restart_chkfile);
+    if (static_chkfile != restart_chkfile) {
+        amrex::Print() << Utils::TextMsg::Info(
+            "reading the static fields from base checkpoint " + static_chkfile);
+    }
+    // The material properties are read from the checkpoint, if written, by MacroscopicProperties::InitData
+    if (WarpX::em_solver_medium == MediumForEM::Macroscopic) {
+        for (auto& macroscopic : m_macroscopic_properties) macroscopic->SetRestartCheckpoint(static_chkfile);
+    }
+
     // Initialize the field data
     for (int lev = 0; lev < nlevs; ++lev)
     {
@@ -235,7 +327,7 @@ WarpX::InitFromCheckpoint ()
             Efield_fp[lev][i]->setVal(0.0);
             Bfield_fp[lev][i]->setVal(0.0);
 #ifdef WARPX_MAG_LLG
-            Mfield_fp[lev][i]->setVal(0.0);
+            if (mag_LLG) Mfield_fp[lev][i]->setVal(0.0);
 #endif
         }
 
@@ -244,13 +336,13 @@ WarpX::InitFromCheckpoint ()
                 Efield_aux[lev][i]->setVal(0.0);
                 Bfield_aux[lev][i]->setVal(0.0);
 #ifdef WARPX_MAG_LLG
-                Mfield_aux[lev][i]->setVal(0.0);
+                if (mag_LLG) Mfield_aux[lev][i]->setVal(0.0);
 #endif
                 current_cp[lev][i]->setVal(0.0);
                 Efield_cp[lev][i]->setVal(0.0);
                 Bfield_cp[lev][i]->setVal(0.0);
 #ifdef WARPX_MAG_LLG
-                Mfield_cp[lev][i]->setVal(0.0);
+                if (mag_LLG) Mfield_cp[lev][i]->setVal(0.0);
 #endif
             }
         }
@@ -270,24 +362,28 @@ WarpX::InitFromCheckpoint ()
                     amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "Bz_fp"));
 
 #ifdef WARPX_MAG_LLG
-        VisMF::Read(*Hfield_fp[lev][0],
-                    amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "Hx_fp"));
-        VisMF::Read(*Hfield_fp[lev][1],
-                    amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "Hy_fp"));
-        VisMF::Read(*Hfield_fp[lev][2],
-                    amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "Hz_fp"));
-        VisMF::Read(*Mfield_fp[lev][0],
-                    amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "Mx_fp"));
-        VisMF::Read(*Mfield_fp[lev][1],
-                    amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "My_fp"));
-        VisMF::Read(*Mfield_fp[lev][2],
-                    amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "Mz_fp"));
-        VisMF::Read(*H_biasfield_fp[lev][0],
-                    amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "Hxbias_fp"));
-        VisMF::Read(*H_biasfield_fp[lev][1],
-                    amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "Hybias_fp"));
-        VisMF::Read(*H_biasfield_fp[lev][2],
-                    amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "Hzbias_fp"));
+        if (mag_LLG) {
+            VisMF::Read(*Hfield_fp[lev][0],
+                        amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "Hx_fp"));
+            VisMF::Read(*Hfield_fp[lev][1],
+                        amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "Hy_fp"));
+            VisMF::Read(*Hfield_fp[lev][2],
+                        amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "Hz_fp"));
+            VisMF::Read(*Mfield_fp[lev][0],
+                        amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "Mx_fp"));
+            VisMF::Read(*Mfield_fp[lev][1],
+                        amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "My_fp"));
+            VisMF::Read(*Mfield_fp[lev][2],
+                        amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "Mz_fp"));
+            if (H_biasfield_fp[lev][0]) {
+                VisMF::Read(*H_biasfield_fp[lev][0],
+                            amrex::MultiFabFileFullPrefix(lev, static_chkfile, level_prefix, "Hxbias_fp"));
+                VisMF::Read(*H_biasfield_fp[lev][1],
+                            amrex::MultiFabFileFullPrefix(lev, static_chkfile, level_prefix, "Hybias_fp"));
+                VisMF::Read(*H_biasfield_fp[lev][2],
+                            amrex::MultiFabFileFullPrefix(lev, static_chkfile, level_prefix, "Hzbias_fp"));
+            }
+        }
 #endif
         if (WarpX::fft_do_time_averaging)
         {
@@ -332,26 +428,30 @@ WarpX::InitFromCheckpoint ()
                         amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "Bz_cp"));
 
 #ifdef WARPX_MAG_LLG
-            VisMF::Read(*Hfield_cp[lev][0],
-                        amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "Hx_cp"));
-            VisMF::Read(*Hfield_cp[lev][1],
-                        amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "Hy_cp"));
-            VisMF::Read(*Hfield_cp[lev][2],
-                        amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "Hz_cp"));
-
-            VisMF::Read(*Mfield_cp[lev][0],
-                        amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "Mx_cp"));
-            VisMF::Read(*Mfield_cp[lev][1],
-                        amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "My_cp"));
-            VisMF::Read(*Mfield_cp[lev][2],
-                        amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "Mz_cp"));
-
-            VisMF::Read(*H_biasfield_cp[lev][0],
-                        amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "Hxbias_cp"));
-            VisMF::Read(*H_biasfield_cp[lev][1],
-                        amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "Hybias_cp"));
-            VisMF::Read(*H_biasfield_cp[lev][2],
-                        amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "Hzbias_cp"));
+            if (mag_LLG) {
+                VisMF::Read(*Hfield_cp[lev][0],
+                            amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "Hx_cp"));
+                VisMF::Read(*Hfield_cp[lev][1],
+                            amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "Hy_cp"));
+                VisMF::Read(*Hfield_cp[lev][2],
+                            amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "Hz_cp"));
+
+                VisMF::Read(*Mfield_cp[lev][0],
+                            amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "Mx_cp"));
+                VisMF::Read(*Mfield_cp[lev][1],
+                            amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "My_cp"));
+                VisMF::Read(*Mfield_cp[lev][2],
+                            amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "Mz_cp"));
+
+                if (H_biasfield_cp[lev][0]) {
+                    VisMF::Read(*H_biasfield_cp[lev][0],
+                                amrex::MultiFabFileFullPrefix(lev, static_chkfile, level_prefix, "Hxbias_cp"));
+                    VisMF::Read(*H_biasfield_cp[lev][1],
+                                amrex::MultiFabFileFullPrefix(lev, static_chkfile, level_prefix, "Hybias_cp"));
+                    VisMF::Read(*H_biasfield_cp[lev][2],
+                                amrex::MultiFabFileFullPrefix(lev, static_chkfile, level_prefix, "Hzbias_cp"));
+                }
+            }
 #endif
             if (WarpX::fft_do_time_averaging)
             {
@@ -400,6 +500,21 @@ WarpX::InitFromCheckpoint ()
     mypc->AllocData();
     mypc->Restart(restart_chkfile);
 
+    // The data are read on the boxes of the checkpoint, and redistributed on the boxes
+    // defined by the current amr.max_grid_size and amr.blocking_factor
+    if (restart_regrid) {
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(finest_level == 0,
+            "amr.restart_regrid is only supported without mesh refinement");
+        const BoxArray ba = MakeBaseGrids();
+        if (ba != boxArray(0)) {
+            amrex::Print() << Utils::TextMsg::Info(
+                "restart: redistributing the " + std::to_string(boxArray(0).size())
+                + " boxes of the checkpoint on " + std::to_string(ba.size()) + " boxes");
+            const DistributionMapping dm{ba, ParallelDescriptor::NProcs()};
+            RemakeLevel(0, t_new[0], ba, dm);
+            mypc->Redistribute();
+        }
+    }
 }
 
 
@@ -41,12 +41,16 @@
 #include <algorithm>
 #include <cctype>
 #include <cstdint>
+#include <filesystem>
+#include <iomanip>
 #include <iostream>
 #include <map>
 #include <memory>
 #include <regex>
 #include <set>
+#include <sstream>
 #include <string>
+#include <system_error>
 #include <tuple>
 #include <utility>
 
@@ -387,10 +391,76 @@ namespace detail
                                   });
         }
     }
+    /** Create the option string of a dataset compressed with an ADIOS2 operator
+     *
+     * @return JSON option string for openPMD::Dataset
+     */
+    inline std::string
+    getDatasetOptions (std::string const & operator_type,
+                       std::map< std::string, std::string > const & operator_parameters)
+    {
+        if (operator_type.empty())
+            return "{}";
+
+        std::string op_parameters;
+        for (const auto& kv : operator_parameters) {
+            if (!op_parameters.empty()) op_parameters.append(",\n");
+            op_parameters.append(std::string(14, ' '))         /* just pretty alignment */
+                    .append("\"").append(kv.first).append("\": ")    /* key */
+                    .append("\"").append(kv.second).append("\""); /* value (as string) */
+        }
+
+        std::string options = R"END(
+{
+  "adios2": {
+    "dataset": {
+      "operators": [
+        {
+          "type": ")END";
+        options += operator_type + "\"";
+        if (!op_parameters.empty()) {
+            options += R"END(,
+          "parameters": {
+)END";
+            options += op_parameters + "}";
+        }
+        options += R"END(
+        }
+      ]
+    }
+  }
+})END";
+        return options;
+    }
+
 #endif // WARPX_USE_OPENPMD
 } // namespace detail
 
 #ifdef WARPX_USE_OPENPMD
+std::string
+OpenPMDFieldCompression::DatasetOptions (std::string const & record) const
+{
+    std::string type;
+    std::map< std::string, std::string > parameters;
+    auto const it = records.find(record);
+    if (it != records.end()) {
+        type = it->second.first;
+        parameters = it->second.second;
+    } else if (mode == "lossless" || (mode == "lossy" && record.rfind("M", 0) == 0)) {
+        // The magnetization is zero outside of the magnetic materials and its norm is
+        // fixed inside of them, so it is always compressed losslessly
+        type = "blosc";
+        parameters = {{"compressor", "zstd"}, {"clevel", "1"}, {"doshuffle", "BLOSC_BITSHUFFLE"}};
+    } else if (mode == "lossy") {
+        std::stringstream ss;
+        ss << std::setprecision(17) << error_bound;
+        type = "zfp";
+        parameters = {{"accuracy", ss.str()}};
+    }
+    if (type == "none") type.clear();
+    return detail::getDatasetOptions(type, parameters);
+}
+
 WarpXOpenPMDPlot::WarpXOpenPMDPlot (
     openPMD::IterationEncoding ie,
     std::string openPMDFileType,
@@ -398,10 +468,14 @@ WarpXOpenPMDPlot::WarpXOpenPMDPlot (
     std::map< std::string, std::string > operator_parameters,
     std::string engine_type,
     std::map< std::string, std::string > engine_parameters,
+    OpenPMDFieldCompression field_compression,
+    bool sparse_output,
     std::vector<bool> fieldPMLdirections)
   :m_Series(nullptr),
    m_Encoding(ie),
    m_OpenPMDFileType(std::move(openPMDFileType)),
+   m_field_compression(std::move(field_compression)),
+   m_sparse_output(sparse_output),
    m_fieldPMLdirections(std::move(fieldPMLdirections))
 {
   // pick first available backend if default is chosen
@@ -418,6 +492,49 @@ WarpXOpenPMDPlot::WarpXOpenPMDPlot (
 
     m_OpenPMDoptions = detail::getSeriesOptions(operator_type, operator_parameters,
                                                 engine_type, engine_parameters);
+
+    // the compression of the mesh records uses ADIOS2 operators
+    if (m_field_compression.enabled() && m_OpenPMDFileType != "bp") {
+        WarpX::GetInstance().RecordWarning("Diagnostics",
+            "The compression of the openPMD fields is only supported with the ADIOS2 backend "
+            "and is ignored with the " + m_OpenPMDFileType + " backend.");
+        m_field_compression = OpenPMDFieldCompression();
+    }
+}
+
+std::uintmax_t
+WarpXOpenPMDPlot::DiskBytesWritten ()
+{
+    if (!amrex::ParallelDescriptor::IOProcessor()) return 0;
+
+    // path of the file of the current step, e.g. openpmd_000100.bp with file based encoding
+    std::string filepath = m_dirPrefix;
+    GetFileName(filepath);
+    std::smatch step_pattern;
+    if (std::regex_search(filepath, step_pattern, std::regex("%0([0-9]+)T"))) {
+        std::ostringstream step;
+        step << std::setw(std::stoi(step_pattern[1].str())) << std::setfill('0') << m_CurrentStep;
+        filepath.replace(step_pattern.position(0), step_pattern.length(0), step.str());
+    }
+
+    // the file can be a directory (ADIOS2 BP4 and BP5)
+    std::uintmax_t size = 0;
+    std::error_code ec;
+    if (std::filesystem::is_directory(filepath, ec)) {
+        for (auto const & entry : std::filesystem::recursive_directory_iterator(filepath, ec)) {
+            if (!entry.is_regular_file(ec)) continue;
+            auto const file_size = entry.file_size(ec);
+            if (!ec) size += file_size;
+        }
+    } else {
+        auto const file_size = std::filesystem::file_size(filepath, ec);
+        if (!ec) size = file_size;
+    }
+
+    std::uintmax_t const size_before = (filepath == m_disk_usage_path) ? m_disk_usage : 0;
+    m_disk_usage_path = filepath;
+    m_disk_usage = size;
+    return size - std::min(size_before, size);
 }
 
 WarpXOpenPMDPlot::~WarpXOpenPMDPlot ()
@@ -1192,9 +1309,11 @@ WarpXOpenPMDPlot::SetupMeshComp (openPMD::Mesh& mesh,
     // - AxisLabels
     std::vector<std::string> axis_labels = detail::getFieldAxisLabels(var_in_theta_mode);
 
-    // Prepare the type of dataset that will be written
+    // Prepare the type of dataset that will be written, compressed as set for its record
     openPMD::Datatype const datatype = openPMD::determineDatatype<amrex::Real>();
-    auto const dataset = openPMD::Dataset(datatype, global_size);
+    std::string const record_name = field_name.substr(0, field_name.rfind("_lvl"));
+    auto const dataset = openPMD::Dataset(datatype, global_size,
+                                          m_field_compression.DatasetOptions(record_name));
     mesh.setDataOrder(openPMD::Mesh::DataOrder::C);
     if (var_in_theta_mode) {
         mesh.setGeometry("thetaMode");
@@ -1371,6 +1490,13 @@ WarpXOpenPMDPlot::WriteOpenPMDFieldsAll ( //const std::string& filename,
             }
         } // icomp setup loop
 
+        // In sparse mode, the chunks where a component is constant are not stored:
+        // their offset, extent and value are written as attributes of the component
+        // (BTD writes a snapshot in several flushes and is always dense)
+        bool const sparse = m_sparse_output && !isBTD;
+        std::vector<amrex::Real> consts;
+        if (sparse) consts = FindConstantBoxes(mf[lev], amrex::IntVect(0));
+
         for ( int icomp=0; icomp<ncomp; icomp++ ) {
             std::string const & varname = varnames[icomp];
 
@@ -1385,10 +1511,37 @@ WarpXOpenPMDPlot::WriteOpenPMDFieldsAll ( //const std::string& filename,
             auto mesh = meshes[field_name];
             auto mesh_comp = mesh[comp_name];
 
+            if (sparse) {
+                std::vector<std::uint64_t> sparse_offsets;
+                std::vector<std::uint64_t> sparse_extents;
+                std::vector<double> sparse_values;
+                for (int ibox = 0; ibox < mf[lev].size(); ++ibox) {
+                    int const idx = 2*(ibox*ncomp + icomp);
+                    if (consts[idx] == amrex::Real(0.)) continue;
+                    amrex::Box const local_box = mf[lev].boxArray()[ibox];
+                    auto chunk_offset = getReversedVec( local_box.smallEnd() - global_box.smallEnd() );
+                    auto chunk_size = getReversedVec( local_box.size() );
+                    if (var_in_theta_mode) {
+                        chunk_offset.emplace(chunk_offset.begin(), mode_index);
+                        chunk_size.emplace(chunk_size.begin(), 1);
+                    }
+                    sparse_offsets.insert(sparse_offsets.end(), chunk_offset.begin(), chunk_offset.end());
+                    sparse_extents.insert(sparse_extents.end(), chunk_size.begin(), chunk_size.end());
+                    sparse_values.push_back(static_cast<double>(consts[idx+1]));
+                }
+                if (!sparse_values.empty()) {
+                    mesh_comp.setAttribute("sparseChunkOffsets", sparse_offsets);
+                    mesh_comp.setAttribute("sparseChunkExtents", sparse_extents);
+                    mesh_comp.setAttribute("sparseChunkValues", sparse_values);
+                }
+            }
+
             // Loop through the multifab, and store each box as a chunk,
             // in the openPMD file.
             for( amrex::MFIter mfi(mf[lev]); mfi.isValid(); ++mfi )
             {
+                if (sparse && consts[2*(mfi.index()*ncomp + icomp)] != amrex::Real(0.)) continue;
+
                 amrex::FArrayBox const& fab = mf[lev][mfi];
                 amrex::Box const& local_box = fab.box();
 
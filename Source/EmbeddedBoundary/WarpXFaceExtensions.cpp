@@ -723,3 +723,95 @@ WarpX::ShrinkBorrowing() {
         }
     }
 }
+
+void
+WarpX::RedistributeBorrowing (const int lev, const amrex::DistributionMapping& dm) {
+    // The FaceInfoBoxes are packed face by face into a dense MultiFab with the number of borrowed
+    // faces (component 0), the intruded neighbors (components 1 to 8) and the borrowed areas
+    // (components 9 to 16), which is moved with the boxes and then unpacked into compact vectors
+    constexpr int max_borrow = 8;
+    constexpr int ncomp = 1 + 2*max_borrow;
+
+    for (int idim = 0; idim < 3; ++idim) {
+        auto& old_borrowing = m_borrowing[lev][idim];
+        const amrex::BoxArray& ba = old_borrowing->boxArray();
+
+        amrex::MultiFab packed_old(ba, old_borrowing->DistributionMap(), ncomp, 0);
+        packed_old.setVal(0.);
+        for (amrex::MFIter mfi(packed_old); mfi.isValid(); ++mfi) {
+            auto const& borrowing = (*old_borrowing)[mfi];
+            if (borrowing.size.box().isEmpty()) continue;
+
+            amrex::Box const& box = mfi.validbox();
+            auto const& packed = packed_old.array(mfi);
+            auto const& borrowing_size = borrowing.size.const_array();
+            auto const& borrowing_inds_pointer = borrowing.inds_pointer.const_array();
+            const int* borrowing_inds = borrowing.inds.data();
+            const FaceInfoBox::Neighbours* borrowing_neigh_faces = borrowing.neigh_faces.data();
+            const amrex::Real* borrowing_area = borrowing.area.data();
+
+            amrex::ParallelFor(box, [=] AMREX_GPU_DEVICE (int i, int j, int k) {
+                const int nborrow = borrowing_size(i, j, k);
+                packed(i, j, k, 0) = nborrow;
+                for (int offset = 0; offset < nborrow; ++offset) {
+                    const int ind = borrowing_inds[*borrowing_inds_pointer(i, j, k) + offset];
+                    packed(i, j, k, 1 + offset) = static_cast<int>(borrowing_neigh_faces[ind]);
+                    packed(i, j, k, 1 + max_borrow + offset) = borrowing_area[ind];
+                }
+            });
+        }
+
+        amrex::MultiFab packed_new(ba, dm, ncomp, 0);
+        packed_new.Redistribute(packed_old, 0, 0, ncomp, amrex::IntVect(0));
+
+        old_borrowing = std::make_unique<amrex::LayoutData<FaceInfoBox>>(ba, dm);
+
+        for (amrex::MFIter mfi(packed_new); mfi.isValid(); ++mfi) {
+            amrex::Box const& box = mfi.validbox();
+            auto& borrowing = (*old_borrowing)[mfi];
+            borrowing.inds_pointer.resize(box);
+            borrowing.size.resize(box);
+            amrex::Long ncells = box.numPts();
+            borrowing.inds.resize(max_borrow*ncells);
+            borrowing.neigh_faces.resize(max_borrow*ncells);
+            borrowing.area.resize(max_borrow*ncells);
+
+            auto const& packed = packed_new.const_array(mfi);
+            auto const& borrowing_size = borrowing.size.array();
+            auto const& borrowing_inds_pointer = borrowing.inds_pointer.array();
+            int* borrowing_inds = borrowing.inds.data();
+            FaceInfoBox::Neighbours* borrowing_neigh_faces = borrowing.neigh_faces.data();
+            amrex::Real* borrowing_area = borrowing.area.data();
+
+            borrowing.vecs_size = amrex::Scan::PrefixSum<int>(ncells,
+                [=] AMREX_GPU_DEVICE (int icell) {
+                    const amrex::Dim3 cell = box.atOffset(icell).dim3();
+                    const int nborrow = static_cast<int>(packed(cell.x, cell.y, cell.z, 0));
+                    borrowing_size(cell.x, cell.y, cell.z) = nborrow;
+                    return nborrow;
+                },
+                [=] AMREX_GPU_DEVICE (int icell, int ps) {
+                    const amrex::Dim3 cell = box.atOffset(icell).dim3();
+                    const int i = cell.x;
+                    const int j = cell.y;
+                    const int k = cell.z;
+                    const int nborrow = borrowing_size(i, j, k);
+                    if (nborrow == 0) {
+                        borrowing_inds_pointer(i, j, k) = nullptr;
+                        return;
+                    }
+                    borrowing_inds_pointer(i, j, k) = borrowing_inds + ps;
+                    for (int offset = 0; offset < nborrow; ++offset) {
+                        borrowing_inds[ps + offset] = ps + offset;
+                        borrowing_neigh_faces[ps + offset] = static_cast<FaceInfoBox::Neighbours>(
+                            static_cast<int>(packed(i, j, k, 1 + offset)));
+                        borrowing_area[ps + offset] = packed(i, j, k, 1 + max_borrow + offset);
+                    }
+                }, amrex::Scan::Type::exclusive);
+
+            borrowing.inds.resize(borrowing.vecs_size);
+            borrowing.neigh_faces.resize(borrowing.vecs_size);
+            borrowing.area.resize(borrowing.vecs_size);
+        }
+    }
+}
@@ -25,6 +25,7 @@
 #include <AMReX_Vector.H>
 
 #include <algorithm>
+#include <array>
 #include <memory>
 
 /**
@@ -33,34 +34,41 @@ void
 WarpX::ComputeDt ()
 {
     // Determine
-    const amrex::Real* dx = geom[max_level].CellSize();
+    std::array<amrex::Real, AMREX_SPACEDIM> dx;
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        // on a graded mesh, the time step is limited by the smallest cells
+        dx[idim] = m_graded_mesh.IsGraded(idim) ? m_graded_mesh.MinCellSize(idim)
+                                                : geom[max_level].CellSize(idim);
+    }
     amrex::Real deltat = 0.;
 
     if (maxwell_solver_id == MaxwellSolverAlgo::PSATD) {
         // Computation of dt for spectral algorithm
-        // (determined by the minimum cell size in all directions)
+        // (determined by the minimum cell size in all directions, and the speed of light
+        // in the medium)
+        amrex::Real const c_medium = PSATDLightSpeed();
 #if defined(WARPX_DIM_1D_Z)
-        deltat = cfl * dx[0] / PhysConst::c;
+        deltat = cfl * dx[0] / c_medium;
 #elif defined(WARPX_DIM_XZ) || defined(WARPX_DIM_RZ)
-        deltat = cfl * std::min(dx[0], dx[1]) / PhysConst::c;
+        deltat = cfl * std::min(dx[0], dx[1]) / c_medium;
 #else
-        deltat = cfl * std::min(dx[0], std::min(dx[1], dx[2])) / PhysConst::c;
+        deltat = cfl * std::min(dx[0], std::min(dx[1], dx[2])) / c_medium;
 #endif
     } else {
         // Computation of dt for FDTD algorithm
 #ifdef WARPX_DIM_RZ
         // - In RZ geometry
         if (maxwell_solver_id == MaxwellSolverAlgo::Yee) {
-            deltat = cfl * CylindricalYeeAlgorithm::ComputeMaxDt(dx,  n_rz_azimuthal_modes);
+            deltat = cfl * CylindricalYeeAlgorithm::ComputeMaxDt(dx.data(),  n_rz_azimuthal_modes);
 #else
         // - In Cartesian geometry
         if (do_nodal) {
-            deltat = cfl * CartesianNodalAlgorithm::ComputeMaxDt(dx);
+            deltat = cfl * CartesianNodalAlgorithm::ComputeMaxDt(dx.data());
         } else if (maxwell_solver_id == MaxwellSolverAlgo::Yee
                     || maxwell_solver_id == MaxwellSolverAlgo::ECT) {
-            deltat = cfl * CartesianYeeAlgorithm::ComputeMaxDt(dx);
+            deltat = cfl * CartesianYeeAlgorithm::ComputeMaxDt(dx.data());
         } else if (maxwell_solver_id == MaxwellSolverAlgo::CKC) {
-            deltat = cfl * CartesianCKCAlgorithm::ComputeMaxDt(dx);
+            deltat = cfl * CartesianCKCAlgorithm::ComputeMaxDt(dx.data());
 #endif
         } else {
             amrex::Abort(Utils::TextMsg::Err(
@@ -82,6 +90,14 @@ WarpX::ComputeDt ()
             dt[lev] = const_dt;
         }
     }
+#ifdef WARPX_MAG_LLG
+    // without Maxwell solve, the time step is only limited by the LLG dynamics
+    if (mag_magnetostatic == 1) {
+        for (int lev=0; lev<=max_level; lev++) {
+            dt[lev] = const_dt;
+        }
+    }
+#endif
 }
 
 void
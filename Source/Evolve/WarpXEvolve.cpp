@@ -15,6 +15,8 @@
 #include "Diagnostics/MultiDiagnostics.H"
 #include "Diagnostics/ReducedDiags/MultiReducedDiags.H"
 #include "Evolve/WarpXDtType.H"
+#include "FieldSolver/FiniteDifferenceSolver/MacroscopicProperties/MacroscopicProperties.H"
+#include "FieldSolver/TFSFSource.H"
 #ifdef WARPX_USE_PSATD
 #   ifdef WARPX_DIM_RZ
 #       include "FieldSolver/SpectralSolver/SpectralSolverRZ.H"
@@ -22,6 +24,7 @@
 #       include "FieldSolver/SpectralSolver/SpectralSolver.H"
 #   endif
 #endif
+#include "Parallelization/CostsBreakdown.H"
 #include "Parallelization/GuardCellManager.H"
 #include "Particles/MultiParticleContainer.H"
 #include "Particles/ParticleBoundaryBuffer.H"
@@ -39,6 +42,8 @@
 #include <AMReX_Array.H>
 #include <AMReX_BLassert.H>
 #include <AMReX_Geometry.H>
+#include <AMReX_GpuAtomic.H>
+#include <AMReX_GpuDevice.H>
 #include <AMReX_IntVect.H>
 #include <AMReX_LayoutData.H>
 #include <AMReX_MultiFab.H>
@@ -65,6 +70,9 @@ WarpX::Evolve (int numsteps)
 
     Real cur_time = t_new[0];
 
+    // the fields may have been set since the last call
+    InvalidateDeepHalo();
+
     int numsteps_max;
     if (numsteps < 0) {  // Note that the default argument is numsteps = -1
         numsteps_max = max_step;
@@ -81,6 +89,7 @@ WarpX::Evolve (int numsteps)
     {
         WARPX_PROFILE("WarpX::Evolve::step");
         Real evolve_time_beg_step = amrex::second();
+        StepPhaseStart();
 
         CheckSignals();
 
@@ -118,20 +127,35 @@ WarpX::Evolve (int numsteps)
             }
         }
 
+        // the refined levels follow the cells tagged from the fields (e.g. the domain walls)
+        if (MRLockstep() && regrid_int > 0 && step > step_begin && step % regrid_int == 0) {
+            RegridLevels(cur_time);
+        }
+
+        if (em_solver_medium == MediumForEM::Macroscopic) {
+            // the properties given by functions of (x,y,z,t) are evaluated at the beginning of the step
+            for (int lev = 0; lev <= finest_level; ++lev) {
+                m_macroscopic_properties[lev]->UpdateTimeDependentProperties(step, cur_time);
+            }
+        }
+
         // At the beginning, we have B^{n} and E^{n}.
         // Particles have p^{n} and x^{n}.
         // is_synchronized is true.
         if (is_synchronized) {
             if (do_electrostatic == ElectrostaticSolverAlgo::None) {
                 // Not called at each iteration, so exchange all guard cells
-                FillBoundaryE(guard_cells.ng_alloc_EB);
-#ifndef WARPX_MAG_LLG
-                FillBoundaryB(guard_cells.ng_alloc_EB);
-#endif
 #ifdef WARPX_MAG_LLG
-                FillBoundaryH(guard_cells.ng_alloc_EB);
-                FillBoundaryM(guard_cells.ng_alloc_EB);
+                if (mag_LLG) {
+                    FillBoundaryEHM(guard_cells.ng_alloc_EB);
+                    // the particles gather B, computed from H and M
+                    if (mypc->nSpecies() > 0) ComputeBfieldFromHM();
+                }
 #endif
+                if (!mag_LLG) {
+                    FillBoundaryE(guard_cells.ng_alloc_EB);
+                    FillBoundaryB(guard_cells.ng_alloc_EB);
+                }
                 UpdateAuxilaryData();
                 FillBoundaryAux(guard_cells.ng_UpdateAux);
             }
@@ -149,14 +173,18 @@ WarpX::Evolve (int numsteps)
                 // Particles have p^{n-1/2} and x^{n}.
 
                 // E and B are up-to-date inside the domain only
-                FillBoundaryE(guard_cells.ng_FieldGather);
-#ifndef WARPX_MAG_LLG
-                FillBoundaryB(guard_cells.ng_FieldGather);
-#endif
 #ifdef WARPX_MAG_LLG
-                FillBoundaryH(guard_cells.ng_FieldGather);
-                FillBoundaryM(guard_cells.ng_FieldGather);
+                if (mag_LLG) {
+                    FillBoundaryEHM(guard_cells.ng_FieldGather);
+                    // the particles gather B, computed from H and M, unless they gather it directly
+                    // from H and M
+                    if (mypc->nSpecies() > 0 && !GatherBfromHM()) ComputeBfieldFromHM();
+                }
 #endif
+                if (!mag_LLG) {
+                    FillBoundaryE(guard_cells.ng_FieldGather);
+                    FillBoundaryB(guard_cells.ng_FieldGather);
+                }
                 // E and B: enough guard cells to update Aux or call Field Gather in fp and cp
                 // Need to update Aux on lower levels, to interpolate to higher levels.
                 if (fft_do_time_averaging)
@@ -194,6 +222,20 @@ WarpX::Evolve (int numsteps)
             const bool skip_deposition = true;
             PushParticlesandDepose(cur_time, skip_deposition);
         }
+#ifdef WARPX_MAG_LLG
+        // Magnetostatic case: LLG only, H is the magnetostatic field of M
+        else if (mag_magnetostatic == 1)
+        {
+            OneStep_magnetostatic(cur_time);
+        }
+#ifndef WARPX_DIM_RZ
+        // Magnetic medium with mesh refinement: multirate steps of the levels
+        else if (MRLockstep() && do_subcycling == 1)
+        {
+            OneStep_mag_multirate(cur_time);
+        }
+#endif
+#endif
         // Electromagnetic case: multi-J algorithm
         else if (do_multi_J)
         {
@@ -233,6 +275,9 @@ WarpX::Evolve (int numsteps)
         if (cur_time + dt[0] >= stop_time - 1.e-3*dt[0] || step == numsteps_max-1) {
             // At the end of last step, push p by 0.5*dt to synchronize
             FillBoundaryE(guard_cells.ng_FieldGather);
+#ifdef WARPX_MAG_LLG
+            if (mag_LLG && mypc->nSpecies() > 0) ComputeBfieldFromHM();
+#endif
             FillBoundaryB(guard_cells.ng_FieldGather);
             if (fft_do_time_averaging)
             {
@@ -272,7 +317,10 @@ WarpX::Evolve (int numsteps)
         for (int i = 0; i <= max_level; ++i) {
             t_new[i] = cur_time;
         }
-        multi_diags->FilterComputePackFlush( step, false, true );
+        {
+            CostPhaseTimer diag_phase(CostPhase::Diagnostics);
+            multi_diags->FilterComputePackFlush( step, false, true );
+        }
 
         bool move_j = is_synchronized;
         // If is_synchronized we need to shift j too so that next step we can evolve E by dt/2.
@@ -292,8 +340,13 @@ WarpX::Evolve (int numsteps)
 
         m_particle_boundary_buffer->gatherParticles(*mypc, amrex::GetVecOfConstPtrs(m_distance_to_eb));
 
+        // Particles that stay within one box of their grid are only sent to the neighbor ranks
+        if (redistribute_neighbors_only && max_level == 0)
+        {
+            mypc->RedistributeNeighbors();
+        }
         // Electrostatic solver: particles can move by an arbitrary number of cells
-        if( do_electrostatic != ElectrostaticSolverAlgo::None )
+        else if( do_electrostatic != ElectrostaticSolverAlgo::None )
         {
             mypc->Redistribute();
         } else
@@ -340,14 +393,17 @@ WarpX::Evolve (int numsteps)
         // in the evolve timing.
         ExecutePythonCallback("afterstep");
 
-        /// reduced diags
-        if (reduced_diags->m_plot_rd != 0)
         {
-            reduced_diags->LoadBalance();
-            reduced_diags->ComputeDiags(step);
-            reduced_diags->WriteToFile(step);
+            CostPhaseTimer diag_phase(CostPhase::Diagnostics);
+            /// reduced diags
+            if (reduced_diags->m_plot_rd != 0)
+            {
+                reduced_diags->LoadBalance();
+                reduced_diags->ComputeDiags(step);
+                reduced_diags->WriteToFile(step);
+            }
+            multi_diags->FilterComputePackFlush( step );
         }
-        multi_diags->FilterComputePackFlush( step );
 
         // execute afterdiagnostic callbacks
         ExecutePythonCallback("afterdiagnostics");
@@ -358,11 +414,20 @@ WarpX::Evolve (int numsteps)
             amrex::ParmParse().QueryUnusedInputs();
             this->PrintGlobalWarnings("FIRST STEP"); //Print the warning list right after the first step.
             early_params_checked = true;
+        } else if (m_print_warnings_intervals.contains(step+1)) {
+            // otherwise, the warnings are only gathered across the ranks at the steps of
+            // warpx.print_warnings_intervals and at the end of the simulation
+            this->PrintGlobalWarnings("STEP " + std::to_string(step+1));
         }
 
         // create ending time stamp for calculating elapsed time each iteration
         Real evolve_time_end_step = amrex::second();
         evolve_time += evolve_time_end_step - evolve_time_beg_step;
+        StepPhaseRecord(evolve_time_end_step - evolve_time_beg_step);
+        if (m_throughput_report_intervals.contains(step+1)) PrintThroughputReport(step);
+
+        // the layout of level 0 for the next step, during the auto-tuning
+        AutoTune(step);
 
         HandleSignals();
 
@@ -374,17 +439,29 @@ WarpX::Evolve (int numsteps)
                       << " s; Avg. per step = " << evolve_time/(step-step_begin+1) << " s\n";
         }
 
-        if (cur_time >= stop_time - 1.e-3*dt[0] || SignalHandling::TestAndResetActionRequestFlag(SignalHandling::SIGNAL_REQUESTS_BREAK)) {
+        if (m_early_stop_requested) {
+            amrex::Print() << "STEP " << step+1 << ": stopping criterion reached, ending the simulation\n";
+        }
+        if (cur_time >= stop_time - 1.e-3*dt[0] || m_early_stop_requested
+            || SignalHandling::TestAndResetActionRequestFlag(SignalHandling::SIGNAL_REQUESTS_BREAK)) {
             break;
         }
 
         // End loop on time steps
     }
-    multi_diags->FilterComputePackFlushLastTimestep( istep[0] );
+    // write the reduced diags outputs left in memory, also on a signal or an early stop,
+    // unless a checkpoint signal already did at this step (e.g. followed by a break signal)
+    if (m_signal_flush_step != istep[0]) {
+        reduced_diags->FlushBuffers();
+        multi_diags->FilterComputePackFlushLastTimestep( istep[0] );
+    }
 
     if (do_back_transformed_diagnostics) {
         myBFD->Flush(geom[0]);
     }
+
+    // footprint at the end of the run, with the high-water marks of the temporaries
+    if (m_memory_report) PrintMemoryReport();
 }
 
 /* /brief Perform one PIC iteration, without subcycling
@@ -472,38 +549,46 @@ WarpX::OneStep_nosub (Real cur_time)
         if (do_pml) {
             NodalSyncPML();
         }
+#ifndef WARPX_DIM_RZ
+    } else if (temporal_blocking) {
+        // B^{n+1/2}, E^{n+1} and B^{n+1} in one pass over the tiles, without the exchanges
+        // of the guard cells in between, that are also updated in the deep-halo mode
+        EvolveEBTemporalBlocking(dt[0]);
+
+        NodalSync(Efield_fp, Efield_cp);
+        NodalSync(Bfield_fp, Bfield_cp);
+        if (safe_guard_cells) {
+            FillBoundaryB(guard_cells.ng_alloc_EB);
+        }
+#endif
     } else {
         EvolveF(0.5_rt * dt[0], DtType::FirstHalf);
         EvolveG(0.5_rt * dt[0], DtType::FirstHalf);
         FillBoundaryF(guard_cells.ng_FieldSolverF);
         FillBoundaryG(guard_cells.ng_FieldSolverG);
-#ifndef WARPX_MAG_LLG
-        EvolveB(0.5_rt * dt[0], DtType::FirstHalf); // We now have B^{n+1/2}
-        FillBoundaryB(guard_cells.ng_FieldSolver);
-        // ApplyExternalFieldExcitation
-        ApplyExternalFieldExcitationOnGrid(ExternalFieldType::BfieldExternal, DtType::FirstHalf); // apply B external excitation; soft source to be fixed
-#endif
+        if (!mag_LLG) {
+            EvolveB(0.5_rt * dt[0], DtType::FirstHalf); // We now have B^{n+1/2}
+            if (m_tfsf) m_tfsf->CorrectHAndEvolveIncidentH(Bfield_fp[0], 0.5_rt * dt[0]);
+            FillBoundaryB(guard_cells.ng_FieldSolver);
+            // ApplyExternalFieldExcitation
+            ApplyExternalFieldExcitationOnGrid(ExternalFieldType::BfieldExternal, DtType::FirstHalf); // apply B external excitation; soft source to be fixed
+        }
 
-#ifdef WARPX_MAG_LLG
-#ifndef WARPX_DIM_RZ
-        if (WarpX::em_solver_medium == MediumForEM::Macroscopic) { //evolveM is not applicable to vacuum
-            if (mag_time_scheme_order==1){
-                MacroscopicEvolveHM(0.5*dt[0]); // we now have M^{n+1/2} and H^{n+1/2}
+#if (defined WARPX_MAG_LLG) && !(defined WARPX_DIM_RZ)
+        if (mag_LLG) { // mag_LLG requires a macroscopic medium
+            if (mag_time_scheme_order==1 || mag_time_scheme_order==5){ // order 5 (Runge-Kutta) shares the H and B updates of the first order
+                MacroscopicEvolveHM(0.5*dt[0], DtType::FirstHalf); // we now have M^{n+1/2} and H^{n+1/2}
             } else if (mag_time_scheme_order==2){
-                MacroscopicEvolveHM_2nd(0.5*dt[0]); // we now have M^{n+1/2} and H^{n+1/2}
+                MacroscopicEvolveHM_2nd(0.5*dt[0], DtType::FirstHalf); // we now have M^{n+1/2} and H^{n+1/2}
             } else {
                 amrex::Abort("unsupported mag_time_scheme_order for M field");
             }
-            FillBoundaryH(guard_cells.ng_FieldSolver);
-            FillBoundaryM(guard_cells.ng_FieldSolver);
+            if (m_tfsf) m_tfsf->CorrectHAndEvolveIncidentH(Hfield_fp[0], 0.5_rt * dt[0]);
+            FillBoundaryHM(guard_cells.ng_FieldSolver);
             // ApplyExternalFieldExcitation
             ApplyExternalFieldExcitationOnGrid(ExternalFieldType::HfieldExternal, DtType::FirstHalf); // apply H external excitation; soft source to be fixed
             ApplyExternalFieldExcitationOnGrid(ExternalFieldType::HbiasfieldExternal, DtType::FirstHalf); // apply H external excitation; soft source to be fixed
-
-        } else {
-            amrex::Abort("unsupported em_solver_medium for M field");
         }
-#endif // ifndef WARPX_DIM_RZ
 #endif
         if (WarpX::em_solver_medium == MediumForEM::Vacuum) {
             // vacuum medium
@@ -514,6 +599,7 @@ WarpX::OneStep_nosub (Real cur_time)
         } else {
             amrex::Abort(Utils::TextMsg::Err("Medium for EM is unknown"));
         }
+        if (m_tfsf) m_tfsf->CorrectEAndEvolveIncidentE(Efield_fp[0], dt[0]);
 
         FillBoundaryE(guard_cells.ng_FieldSolver);
         // ApplyExternalFieldExcitation
@@ -525,45 +611,41 @@ WarpX::OneStep_nosub (Real cur_time)
 
         EvolveF(0.5_rt * dt[0], DtType::SecondHalf);
         EvolveG(0.5_rt * dt[0], DtType::SecondHalf);
-#ifndef WARPX_MAG_LLG
-        EvolveB(0.5_rt * dt[0], DtType::SecondHalf); // We now have B^{n+1}
-
-        // Synchronize E and B fields on nodal points
-        NodalSync(Efield_fp, Efield_cp);
-        NodalSync(Bfield_fp, Bfield_cp);
-        // E and B are up-to-date in the domain, but all guard cells are
-        // outdated.
-        if (safe_guard_cells) {
-            FillBoundaryB(guard_cells.ng_alloc_EB);
+        if (!mag_LLG) {
+            EvolveB(0.5_rt * dt[0], DtType::SecondHalf); // We now have B^{n+1}
+            if (m_tfsf) m_tfsf->CorrectHAndEvolveIncidentH(Bfield_fp[0], 0.5_rt * dt[0]);
+
+            // Synchronize E and B fields on nodal points
+            NodalSync(Efield_fp, Efield_cp);
+            NodalSync(Bfield_fp, Bfield_cp);
+            // E and B are up-to-date in the domain, but all guard cells are
+            // outdated.
+            if (safe_guard_cells) {
+                FillBoundaryB(guard_cells.ng_alloc_EB);
+            }
+            // ApplyExternalFieldExcitation
+            ApplyExternalFieldExcitationOnGrid(ExternalFieldType::BfieldExternal, DtType::SecondHalf); // redundant for hs; need to fix the way to increment ss
         }
-        // ApplyExternalFieldExcitation
-        ApplyExternalFieldExcitationOnGrid(ExternalFieldType::BfieldExternal, DtType::SecondHalf); // redundant for hs; need to fix the way to increment ss
-#endif
 
-#ifdef WARPX_MAG_LLG
-#ifndef WARPX_DIM_RZ
-        if (WarpX::em_solver_medium == MediumForEM::Macroscopic) {
-            if (mag_time_scheme_order==1){
-                MacroscopicEvolveHM(0.5*dt[0]); // we now have M^{n+1} and H^{n+1}
+#if (defined WARPX_MAG_LLG) && !(defined WARPX_DIM_RZ)
+        if (mag_LLG) {
+            if (mag_time_scheme_order==1 || mag_time_scheme_order==5){
+                MacroscopicEvolveHM(0.5*dt[0], DtType::SecondHalf); // we now have M^{n+1} and H^{n+1}
             } else if (mag_time_scheme_order==2){
-                MacroscopicEvolveHM_2nd(0.5*dt[0]); // we now have M^{n+1} and H^{n+1}
+                MacroscopicEvolveHM_2nd(0.5*dt[0], DtType::SecondHalf); // we now have M^{n+1} and H^{n+1}
             } else {
                 amrex::Abort("unsupported mag_time_scheme_order for M field");
             }
+            if (m_tfsf) m_tfsf->CorrectHAndEvolveIncidentH(Hfield_fp[0], 0.5_rt * dt[0]);
             // H and M are up-to-date in the domain, but all guard cells are
             // outdated.
             if ( safe_guard_cells ){
-                FillBoundaryH(guard_cells.ng_alloc_EB);
-                FillBoundaryM(guard_cells.ng_alloc_EB);
+                FillBoundaryHM(guard_cells.ng_alloc_EB);
             }
             // ApplyExternalFieldExcitation
             ApplyExternalFieldExcitationOnGrid(ExternalFieldType::HfieldExternal, DtType::SecondHalf); // redundant for hs; need to fix the way to increment ss
             ApplyExternalFieldExcitationOnGrid(ExternalFieldType::HbiasfieldExternal, DtType::SecondHalf); // apply H external excitation; soft source to be fixed
         }
-        else {
-            amrex::Abort("unsupported em_solver_medium for M field");
-        }
-#endif // ifndef WARPX_DIM_RZ
 #endif
         if (do_pml) {
             FillBoundaryF(guard_cells.ng_alloc_F);
@@ -571,17 +653,183 @@ WarpX::OneStep_nosub (Real cur_time)
             NodalSyncPML();
             FillBoundaryE(guard_cells.ng_MovingWindow);
             FillBoundaryF(guard_cells.ng_MovingWindow);
-#ifndef WARPX_MAG_LLG
-            FillBoundaryB(guard_cells.ng_MovingWindow);
-#else
-            FillBoundaryH(guard_cells.ng_MovingWindow);
+#ifdef WARPX_MAG_LLG
+            if (mag_LLG) FillBoundaryH(guard_cells.ng_MovingWindow);
 #endif
+            if (!mag_LLG) FillBoundaryB(guard_cells.ng_MovingWindow);
             }
     } // !PSATD
 
     ExecutePythonCallback("afterEsolve");
 }
 
+#ifdef WARPX_MAG_LLG
+void
+WarpX::OneStep_magnetostatic (Real cur_time)
+{
+    WARPX_PROFILE("WarpX::OneStep_magnetostatic()");
+    amrex::ignore_unused(cur_time);
+
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(WarpX::em_solver_medium == MediumForEM::Macroscopic,
+        "warpx.mag_magnetostatic = 1 requires algo.em_solver_medium = macroscopic");
+
+    ExecutePythonCallback("beforeEsolve");
+
+    // Push M from {n} to {n+1} with the magnetostatic H^{n}. E is not evolved, so that
+    // the H update of the LLG schemes only adds the local response -(M^{n+1} - M^{n})
+    if (mag_time_scheme_order==1 || mag_time_scheme_order==5){
+        MacroscopicEvolveHM(dt[0]); // we now have M^{n+1}
+    } else if (mag_time_scheme_order==2){
+        MacroscopicEvolveHM_2nd(dt[0]); // we now have M^{n+1}
+    } else {
+        amrex::Abort("unsupported mag_time_scheme_order for M field");
+    }
+    FillBoundaryM(guard_cells.ng_alloc_EB);
+    // ApplyExternalFieldExcitation
+    ApplyExternalFieldExcitationOnGrid(ExternalFieldType::HbiasfieldExternal);
+
+    // replace H by the magnetostatic field of M^{n+1}, and update B^{n+1}
+    ComputeMagnetostaticField();
+
+    ExecutePythonCallback("afterEsolve");
+}
+
+#ifndef WARPX_DIM_RZ
+void
+WarpX::OneStep_mag_multirate (Real cur_time)
+{
+    WARPX_PROFILE("WarpX::OneStep_mag_multirate()");
+
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(m_macroscopic_properties[0]->getmag_LLG_subcycle() == 0,
+        "warpx.do_subcycling = 1 with the LLG solver is not implemented with macroscopic.mag_LLG_subcycle = 1");
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(!do_dive_cleaning && !do_divb_cleaning,
+        "warpx.do_subcycling = 1 with the LLG solver is not implemented with the divergence cleaning");
+
+    // the guard cells of the finer levels are interpolated from the end of the coarser step,
+    // unless MagAdvanceLevel sets an intermediate time
+    m_mr_time_fraction.assign(finest_level+1, 1._rt);
+
+    if (cur_time == 0._rt) { // at the first time step, make sure to apply the hard source before fields get evolved
+        // ApplyExternalFieldExcitation
+        ApplyExternalFieldExcitationOnGrid(ExternalFieldType::AllExternal);
+    }
+
+    ExecutePythonCallback("beforeEsolve");
+
+    MagAdvanceLevel(0, cur_time, dt[0]);
+
+    ExecutePythonCallback("afterEsolve");
+}
+
+void
+WarpX::MagAdvanceLevel (int lev, Real cur_time, Real a_dt)
+{
+    // Advance the level first, keeping its state at the beginning of the step for the guard
+    // cells of the finer level at the coarse/fine boundary
+    if (lev < finest_level) SaveMultirateOldFields(lev);
+    MagStepLevel(lev, cur_time, a_dt);
+    if (lev == finest_level) return;
+
+    // Advance the finer level up to the same time, with the steps of its own CFL limit,
+    // see ComputeDt
+    const int nsub = refRatio(lev)[0];
+    const Real dt_fine = a_dt / nsub;
+    for (int isub = 0; isub < nsub; ++isub) {
+        MagAdvanceLevel(lev+1, cur_time + isub*dt_fine, dt_fine);
+    }
+    m_mr_time_fraction[lev+1] = 1._rt;
+
+    // Synchronize: the covered cells of the level take the values of the finer level
+    AverageDownField(Efield_fp, lev+1);
+    AverageDownField(Hfield_fp, lev+1);
+    AverageDownField(Mfield_fp, lev+1, (mag_M_collocated == 1) ? 1 : 3);
+}
+
+void
+WarpX::MagStepLevel (int lev, Real cur_time, Real a_dt)
+{
+    WARPX_PROFILE("WarpX::MagStepLevel()");
+
+    // the excitations of the level are evaluated at its own time
+    t_new[lev] = cur_time;
+    // time of the guard cells of the level at the coarse/fine boundary, as a fraction of the
+    // step of the coarser level
+    auto set_cf_time = [&] (Real t) {
+        if (lev > 0) m_mr_time_fraction[lev] = (t - t_new[lev-1]) / dt[lev-1];
+    };
+    // same sequence as the LLG updates of OneStep_nosub, on one level
+    auto evolve_HM = [&] (DtType dt_type) {
+        if (mag_time_scheme_order==1 || mag_time_scheme_order==5){
+            MacroscopicEvolveHM(lev, 0.5_rt*a_dt, 0.5_rt*a_dt, dt_type);
+        } else if (mag_time_scheme_order==2){
+            MacroscopicEvolveHM_2nd(lev, 0.5_rt*a_dt, 0.5_rt*a_dt, dt_type);
+        } else {
+            amrex::Abort("unsupported mag_time_scheme_order for M field");
+        }
+    };
+
+    evolve_HM(DtType::FirstHalf); // we now have M^{n+1/2} and H^{n+1/2}
+    set_cf_time(cur_time + 0.5_rt*a_dt);
+    FillBoundaryEHM(lev, guard_cells.ng_FieldSolver, false);
+    // ApplyExternalFieldExcitation
+    ApplyExternalFieldExcitationOnGrid(ExternalFieldType::HfieldExternal, DtType::FirstHalf, lev);
+    ApplyExternalFieldExcitationOnGrid(ExternalFieldType::HbiasfieldExternal, DtType::FirstHalf, lev);
+
+    MacroscopicEvolveE(lev, a_dt); // We now have E^{n+1}
+    set_cf_time(cur_time + a_dt);
+    FillBoundaryE(lev, guard_cells.ng_FieldSolver);
+    // ApplyExternalFieldExcitation
+    ApplyExternalFieldExcitationOnGrid(ExternalFieldType::EfieldExternal, DtType::Full, lev);
+    if (WarpX::ApplyExcitationInPML == 1) {
+        // Apply Efiled excitation in the pml region
+        ApplyExternalFieldExcitationOnGrid(ExternalFieldType::EfieldExternalPML, DtType::Full, lev);
+    }
+
+    evolve_HM(DtType::SecondHalf); // we now have M^{n+1} and H^{n+1}
+    // H and M are up-to-date in the domain, but all guard cells are outdated.
+    if (safe_guard_cells) {
+        FillBoundaryEHM(lev, guard_cells.ng_alloc_EB, false);
+    }
+    // ApplyExternalFieldExcitation
+    ApplyExternalFieldExcitationOnGrid(ExternalFieldType::HfieldExternal, DtType::SecondHalf, lev);
+    ApplyExternalFieldExcitationOnGrid(ExternalFieldType::HbiasfieldExternal, DtType::SecondHalf, lev);
+
+    if (do_pml) {
+        DampPML(lev, PatchType::fine);
+        NodalSyncPML(lev, PatchType::fine);
+        FillBoundaryE(lev, guard_cells.ng_MovingWindow);
+        FillBoundaryH(lev, guard_cells.ng_MovingWindow);
+    }
+}
+
+void
+WarpX::SaveMultirateOldFields (int lev)
+{
+    if (static_cast<int>(Efield_mr_old.size()) <= finest_level) {
+        Efield_mr_old.resize(finest_level+1);
+        Hfield_mr_old.resize(finest_level+1);
+        Mfield_mr_old.resize(finest_level+1);
+    }
+    auto save = [&] (const amrex::Vector<std::array<std::unique_ptr<amrex::MultiFab>,3>>& field,
+                     amrex::Vector<std::array<std::unique_ptr<amrex::MultiFab>,3>>& old, int nmf) {
+        for (int i = 0; i < nmf; ++i) {
+            MultiFab const& mf = *field[lev][i];
+            // (re)allocated at the first step and after a load balance
+            if (!old[lev][i] || old[lev][i]->boxArray() != mf.boxArray()
+                || old[lev][i]->DistributionMap() != mf.DistributionMap()) {
+                old[lev][i] = std::make_unique<MultiFab>(mf.boxArray(), mf.DistributionMap(),
+                                                         mf.nComp(), mf.nGrowVect());
+            }
+            MultiFab::Copy(*old[lev][i], mf, 0, 0, mf.nComp(), mf.nGrowVect());
+        }
+    };
+    save(Efield_fp, Efield_mr_old, 3);
+    save(Hfield_fp, Hfield_mr_old, 3);
+    save(Mfield_fp, Mfield_mr_old, (mag_M_collocated == 1) ? 1 : 3);
+}
+#endif // ifndef WARPX_DIM_RZ
+#endif
+
 void
 WarpX::OneStep_multiJ (const amrex::Real cur_time)
 {
@@ -940,6 +1188,7 @@ WarpX::PushParticlesandDepose (amrex::Real cur_time, bool skip_deposition)
 void
 WarpX::PushParticlesandDepose (int lev, amrex::Real cur_time, DtType a_dt_type, bool skip_deposition)
 {
+    CostPhaseTimer cost_phase(CostPhase::Particles);
     amrex::MultiFab* current_x = nullptr;
     amrex::MultiFab* current_y = nullptr;
     amrex::MultiFab* current_z = nullptr;
@@ -1061,6 +1310,122 @@ WarpX::HandleSignals()
     // SIGNAL_REQUESTS_BREAK is handled directly in WarpX::Evolve
 
     if (SignalHandling::TestAndResetActionRequestFlag(SignalHandling::SIGNAL_REQUESTS_CHECKPOINT)) {
+        // With amrex.async_out = 1 or a node-local <diag>.local_path, the checkpoint is only
+        // staged here and written to the global path in the background
+        const Real t_start = amrex::second();
+        reduced_diags->FlushBuffers();
         multi_diags->FilterComputePackFlushLastTimestep( istep[0] );
+        m_signal_flush_step = istep[0];
+        amrex::Print() << Utils::TextMsg::Info(
+            "STEP " + std::to_string(istep[0]) + ": checkpoint requested by a signal, time loop resumed after "
+            + std::to_string(amrex::second() - t_start) + " s");
+    }
+}
+
+CostPhaseTimer::CostPhaseTimer (int phase)
+{
+    auto& warpx = WarpX::GetInstance();
+    m_step_active = warpx.StepPhaseBegin(phase);
+    m_active = warpx.CostPhaseBegin(phase);
+}
+
+CostPhaseTimer::~CostPhaseTimer ()
+{
+    auto& warpx = WarpX::GetInstance();
+    if (m_active) warpx.CostPhaseEnd();
+    if (m_step_active) warpx.StepPhaseEnd();
+}
+
+CostBoxTimer::CostBoxTimer (amrex::LayoutData<amrex::Real>* cost, int box_index)
+    : m_box_index{box_index}
+{
+    if (cost && WarpX::load_balance_costs_update_algo == LoadBalanceCostsUpdateAlgo::Timers)
+    {
+        m_cost = cost;
+        amrex::Gpu::synchronize();
+        m_start_time = amrex::second();
+    }
+}
+
+CostBoxTimer::~CostBoxTimer ()
+{
+    if (m_cost)
+    {
+        amrex::Gpu::synchronize();
+        const amrex::Real wt = amrex::second() - m_start_time;
+        amrex::HostDevice::Atomic::Add( &(*m_cost)[m_box_index], wt);
+    }
+}
+
+bool
+WarpX::CostPhaseBegin (int phase)
+{
+    if (!m_costs_breakdown_enabled || m_cost_phase >= 0 || phase >= CostPhase::NumPhases) return false;
+
+    m_cost_phase = phase;
+    m_cost_phase_start.resize(finest_level+1);
+    for (int lev = 0; lev <= finest_level; ++lev)
+    {
+        auto& start = m_cost_phase_start[lev];
+        start.clear();
+        if (!costs[lev]) continue;
+        for (int i : costs[lev]->IndexArray()) start.push_back((*costs[lev])[i]);
+    }
+    amrex::Gpu::synchronize();
+    m_cost_phase_start_time = amrex::second();
+    return true;
+}
+
+void
+WarpX::CostPhaseEnd ()
+{
+    amrex::Gpu::synchronize();
+    const amrex::Real wt = amrex::second() - m_cost_phase_start_time;
+    const int phase = m_cost_phase;
+    m_cost_phase = -1;
+
+    m_costs_breakdown.resize(std::max(static_cast<int>(m_costs_breakdown.size()), finest_level+1));
+
+    // costs recorded by the timers of the boxes, and cells of the boxes of this rank
+    amrex::Real timed = 0.0;
+    amrex::Real ncells = 0.0;
+    for (int lev = 0; lev <= finest_level; ++lev)
+    {
+        if (!costs[lev]) continue;
+        auto& breakdown = m_costs_breakdown[lev];
+        // the breakdown starts again from zero when the grids change
+        if (breakdown.empty() || breakdown[0]->boxArray() != costs[lev]->boxArray() ||
+            breakdown[0]->DistributionMap() != costs[lev]->DistributionMap())
+        {
+            breakdown.resize(CostPhase::NumPhases);
+            for (auto& bd : breakdown) {
+                bd = std::make_unique<LayoutData<Real>>(costs[lev]->boxArray(), costs[lev]->DistributionMap());
+                for (int i : bd->IndexArray()) (*bd)[i] = 0.0;
+            }
+        }
+
+        const auto& iarr = costs[lev]->IndexArray();
+        const auto& start = m_cost_phase_start[lev];
+        if (start.size() != iarr.size()) continue;
+        for (std::size_t n = 0; n < iarr.size(); ++n)
+        {
+            const amrex::Real delta = (*costs[lev])[iarr[n]] - start[n];
+            (*breakdown[phase])[iarr[n]] += delta;
+            timed += delta;
+            ncells += static_cast<amrex::Real>(costs[lev]->boxArray()[iarr[n]].numPts());
+        }
+    }
+
+    // the rest of the wall-clock time, in proportion to the cells
+    const amrex::Real untimed = wt - timed;
+    if (untimed <= 0.0 || ncells <= 0.0) return;
+    for (int lev = 0; lev <= finest_level; ++lev)
+    {
+        if (!costs[lev] || m_costs_breakdown[lev].empty()) continue;
+        for (int i : costs[lev]->IndexArray())
+        {
+            (*m_costs_breakdown[lev][phase])[i] +=
+                untimed * static_cast<amrex::Real>(costs[lev]->boxArray()[i].numPts()) / ncells;
+        }
     }
 }
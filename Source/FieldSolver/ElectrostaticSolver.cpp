@@ -7,6 +7,7 @@
 #include "WarpX.H"
 
 #include "FieldSolver/ElectrostaticSolver.H"
+#include "FieldSolver/FiniteDifferenceSolver/MacroscopicProperties/MacroscopicProperties.H"
 #include "Parallelization/GuardCellManager.H"
 #include "Particles/MultiParticleContainer.H"
 #include "Particles/WarpXParticleContainer.H"
@@ -36,12 +37,15 @@
 #include <AMReX_LO_BCTYPES.H>
 #include <AMReX_MFIter.H>
 #include <AMReX_MLMG.H>
+#include <AMReX_MLNodeLaplacian.H>
 #include <AMReX_MultiFab.H>
 #include <AMReX_REAL.H>
 #include <AMReX_SPACE.H>
 #include <AMReX_Vector.H>
+#include <AMReX_iMultiFab.H>
 #include <AMReX_MFInterp_C.H>
 
+#include <algorithm>
 #include <array>
 #include <memory>
 #include <string>
@@ -52,6 +56,7 @@ void
 WarpX::ComputeSpaceChargeField (bool const reset_fields)
 {
     WARPX_PROFILE("WarpX::ComputeSpaceChargeField");
+    InvalidateDeepHalo();
     if (reset_fields) {
         // Reset all E and B fields to 0, before calculating space-charge fields
         WARPX_PROFILE("WarpX::ComputeSpaceChargeField::reset_fields");
@@ -226,6 +231,10 @@ WarpX::AddSpaceChargeFieldLabFrame ()
     // Todo: use simpler finite difference form with beta=0
     std::array<Real, 3> beta = {0._rt};
 
+    // start the solve from the extrapolation of the previous solutions
+    bool const warm_start = self_fields_warm_start && !IsPythonCallBackInstalled("poissonsolver");
+    if (warm_start) ExtrapolatePhiInitialGuess();
+
     // set the boundary potentials appropriately
     setPhiBC(phi_fp);
 
@@ -235,6 +244,16 @@ WarpX::AddSpaceChargeFieldLabFrame ()
                      self_fields_absolute_tolerance, self_fields_max_iters,
                      self_fields_verbosity );
 
+    // keep the first solution, for the extrapolation at the next solve
+    if (warm_start) {
+        for (int lev = 0; lev <= finest_level; ++lev) {
+            if (m_phi_prev[lev]) continue;
+            m_phi_prev[lev] = std::make_unique<MultiFab>(phi_fp[lev]->boxArray(),
+                phi_fp[lev]->DistributionMap(), 1, phi_fp[lev]->nGrowVect());
+            MultiFab::Copy(*m_phi_prev[lev], *phi_fp[lev], 0, 0, 1, phi_fp[lev]->nGrowVect());
+        }
+    }
+
     // Compute the electric field. Note that if an EB is used the electric
     // field will be calculated in the computePhi call.
 #ifndef AMREX_USE_EB
@@ -247,6 +266,138 @@ WarpX::AddSpaceChargeFieldLabFrame ()
     computeB( Bfield_fp, phi_fp, beta );
 }
 
+/* Initialize E with the electrostatic field of the boundary potentials, of the electrodes
+   and of the charge of the particles in the dielectric medium of the macroscopic solver, by solving
+   \f[
+       \vec{\nabla}\cdot(\epsilon_r \vec{\nabla} \phi) = -\frac{\rho}{\epsilon_0}
+   \f]
+   with the relative permittivity given by MacroscopicProperties on level 0, and adding
+   \f$ -\vec{\nabla}\phi \f$ to E. Used if warpx.init_static_E = 1, instead of the thousands
+   of steps that the FDTD solver needs to relax the fields to their static distribution.
+   The PEC boundaries have the potentials boundary.potential_*, and the other non-periodic
+   boundaries (e.g. PML) have a zero normal derivative of the potential. The nodes where
+   warpx.static_E_electrode_function(x,y,z) is non-zero are electrodes, at the potential
+   warpx.static_E_potential_function(x,y,z).
+*/
+void
+WarpX::ComputeDielectricStaticField ()
+{
+    WARPX_PROFILE("WarpX::ComputeDielectricStaticField");
+
+#if defined(WARPX_DIM_RZ) || defined(AMREX_USE_EB)
+    amrex::Abort(Utils::TextMsg::Err(
+        "warpx.init_static_E = 1 is not implemented in RZ geometry nor with embedded boundaries"));
+#else
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(em_solver_medium == MediumForEM::Macroscopic,
+        "warpx.init_static_E = 1 requires algo.em_solver_medium = macroscopic");
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(max_level == 0,
+        "warpx.init_static_E = 1 is only implemented without mesh refinement");
+
+    if (!field_boundary_handler.bcs_set) {
+        bool const open_as_neumann = true;
+        field_boundary_handler.definePhiBCs(open_as_neumann);
+    }
+
+    // the macroscopic properties are only defined on level 0
+    int const lev = 0;
+    Vector<std::unique_ptr<MultiFab> > rho(1);
+    Vector<std::unique_ptr<MultiFab> > phi(1);
+    BoxArray nba = boxArray(lev);
+    nba.surroundingNodes();
+    rho[lev] = std::make_unique<MultiFab>(nba, DistributionMap(lev), 1, guard_cells.ng_depos_rho);
+    rho[lev]->setVal(0._rt);
+    phi[lev] = std::make_unique<MultiFab>(nba, DistributionMap(lev), 1, 1);
+    phi[lev]->setVal(0._rt);
+
+    // charge density of all the species
+    bool const local = false;
+    bool const reset = false;
+    bool const do_rz_volume_scaling = false;
+    for (int ispecies = 0; ispecies < mypc->nSpecies(); ispecies++) {
+        mypc->GetParticleContainer(ispecies).DepositCharge(rho, local, reset, do_rz_volume_scaling);
+    }
+    rho[lev]->mult(-1._rt/PhysConst::ep0);
+    Real const max_norm_b = rho[lev]->norm0();
+
+    setPhiBC(phi);
+
+    // the nodes of the electrodes have a fixed potential and are excluded from the solve
+    // (mask 0), the potential being kept from the initial guess
+    std::unique_ptr<iMultiFab> solve_mask;
+    if (m_static_E_electrode_parser) {
+        solve_mask = std::make_unique<iMultiFab>(nba, DistributionMap(lev), 1, 0);
+        auto const electrode = m_static_E_electrode_parser->compile<3>();
+        auto const potential = m_static_E_potential_parser->compile<3>();
+        GpuArray<Real, AMREX_SPACEDIM> const problo = Geom(lev).ProbLoArray();
+        GpuArray<Real, AMREX_SPACEDIM> const dx = Geom(lev).CellSizeArray();
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+        for (MFIter mfi(*solve_mask, TilingIfNotGPU()); mfi.isValid(); ++mfi) {
+            Box const& bx = mfi.tilebox();
+            Array4<int> const& mask_arr = solve_mask->array(mfi);
+            Array4<Real> const& phi_arr = phi[lev]->array(mfi);
+            amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+            {
+#if defined(WARPX_DIM_3D)
+                Real const x = problo[0] + i*dx[0];
+                Real const y = problo[1] + j*dx[1];
+                Real const z = problo[2] + k*dx[2];
+#elif defined(WARPX_DIM_XZ)
+                Real const x = problo[0] + i*dx[0];
+                Real const y = 0._rt;
+                Real const z = problo[1] + j*dx[1];
+                amrex::ignore_unused(k);
+#else
+                Real const x = 0._rt;
+                Real const y = 0._rt;
+                Real const z = problo[0] + i*dx[0];
+                amrex::ignore_unused(j,k);
+#endif
+                bool const is_electrode = (electrode(x,y,z) != 0._rt);
+                mask_arr(i,j,k) = is_electrode ? 0 : 1;
+                if (is_electrode) phi_arr(i,j,k) = potential(x,y,z);
+            });
+        }
+    }
+
+    // relative permittivity of the cells, the coefficient of the nodal operator
+    MultiFab const& eps_mf = m_macroscopic_properties[lev]->getepsilon_mf();
+    MultiFab eps_r(eps_mf.boxArray(), eps_mf.DistributionMap(), 1, 0);
+    MultiFab::Copy(eps_r, eps_mf, 0, 0, 1, 0);
+    eps_r.mult(1._rt/PhysConst::ep0);
+
+    MLNodeLaplacian linop({Geom(lev)}, {boxArray(lev)}, {DistributionMap(lev)});
+    linop.setDomainBC(field_boundary_handler.lobc, field_boundary_handler.hibc);
+    linop.setSigma(lev, eps_r);
+    if (solve_mask) linop.setOversetMask(lev, *solve_mask);
+
+    // without charge, the field is given by the boundary potentials only
+    bool const always_use_bnorm = (max_norm_b > 0._rt);
+    Real absolute_tolerance = self_fields_absolute_tolerance;
+    if (!always_use_bnorm && absolute_tolerance == 0._rt) absolute_tolerance = Real(1e-6);
+
+    MLMG mlmg(linop);
+    mlmg.setVerbose(self_fields_verbosity);
+    mlmg.setMaxIter(self_fields_max_iters);
+    mlmg.setAlwaysUseBNorm(always_use_bnorm);
+    mlmg.solve({phi[lev].get()}, {rho[lev].get()}, self_fields_required_precision,
+               absolute_tolerance);
+    m_poisson_num_iters = mlmg.getNumIters();
+    if (self_fields_verbosity >= 1) {
+        amrex::Print() << Utils::TextMsg::Info(
+            "Static E in the dielectric: " + std::to_string(m_poisson_num_iters)
+            + " MLMG iterations");
+    }
+
+    // add E = -grad(phi) on the Yee grid
+    std::array<Real, 3> const beta = {0._rt};
+    computeE(Efield_fp, phi, beta);
+    MarkFieldModified(tracked_E);
+    FillBoundaryE(guard_cells.ng_alloc_EB);
+#endif
+}
+
 /* Compute the potential `phi` by solving the Poisson equation with `rho` as
    a source, assuming that the source moves at a constant speed \f$\vec{\beta}\f$.
    This uses the amrex solver.
@@ -263,6 +414,9 @@ WarpX::AddSpaceChargeFieldLabFrame ()
    \param[in] absolute_tolerance The absolute convergence threshold for the MLMG solver
    \param[in] max_iters The maximum number of iterations allowed for the MLMG solver
    \param[in] verbosity The verbosity setting for the MLMG solver
+
+   The solve starts from the initial guess in `phi`. The number of iterations is
+   given by WarpX::GetPoissonNumIters.
 */
 void
 WarpX::computePhi (const amrex::Vector<std::unique_ptr<amrex::MultiFab> >& rho,
@@ -271,7 +425,7 @@ WarpX::computePhi (const amrex::Vector<std::unique_ptr<amrex::MultiFab> >& rho,
                    Real const required_precision,
                    Real absolute_tolerance,
                    int const max_iters,
-                   int const verbosity) const
+                   int const verbosity)
 {
 #ifdef WARPX_DIM_RZ
     // Create a new geometry with the z coordinate scaled by gamma
@@ -311,8 +465,28 @@ WarpX::computePhi (const amrex::Vector<std::unique_ptr<amrex::MultiFab> >& rho,
 
     LPInfo info;
 
+    // The operator of the solves with beta = 0 only depends on the grids of the level, so it
+    // is kept with its MLMG solver across the calls and rebuilt when the grids change (see
+    // WarpX::ClearPoissonSolvers). With embedded boundaries, the potential of the boundaries
+    // may depend on time, so the operator is built at each call.
+#ifndef AMREX_USE_EB
+    bool const reuse_solver = (beta[0] == 0._rt && beta[1] == 0._rt && beta[2] == 0._rt);
+#else
+    bool const reuse_solver = false;
+#endif
+    if (reuse_solver && static_cast<int>(m_poisson_mlmg.size()) <= finest_level) {
+        m_poisson_mlmg.resize(finest_level+1);
+        m_poisson_linop.resize(finest_level+1);
+    }
+
     for (int lev=0; lev<=finest_level; lev++) {
 
+        std::unique_ptr<MLLinOp> linop;
+        std::unique_ptr<MLMG> mlmg;
+        if (reuse_solver && m_poisson_mlmg[lev]) {
+            linop = std::move(m_poisson_linop[lev]);
+            mlmg = std::move(m_poisson_mlmg[lev]);
+        } else {
 #ifndef AMREX_USE_EB
 #ifdef WARPX_DIM_RZ
         Real const dx = geom_scaled[lev].CellSize(0);
@@ -332,8 +506,11 @@ WarpX::computePhi (const amrex::Vector<std::unique_ptr<amrex::MultiFab> >& rho,
             info.setSemicoarseningDirection(semicoarsening_direction);
         }
         // Define the linear operator (Poisson operator)
-        MLEBNodeFDLaplacian linop( {geom_scaled[lev]}, {boxArray(lev)}, {DistributionMap(lev)}, info );
-        linop.setSigma({0._rt, 1._rt});
+        auto linop_lev = std::make_unique<MLEBNodeFDLaplacian>(
+            Vector<Geometry>{geom_scaled[lev]}, Vector<BoxArray>{boxArray(lev)},
+            Vector<DistributionMapping>{DistributionMap(lev)}, info );
+        linop_lev->setSigma({0._rt, 1._rt});
+        linop_lev->setRZ(true);
 #else
         // Set the value of beta
         amrex::Array<amrex::Real,AMREX_SPACEDIM> beta_solver =
@@ -364,45 +541,52 @@ WarpX::computePhi (const amrex::Vector<std::unique_ptr<amrex::MultiFab> >& rho,
             info.setMaxSemicoarseningLevel(max_semicoarsening_level);
             info.setSemicoarseningDirection(semicoarsening_direction);
         }
-        MLNodeTensorLaplacian linop( {Geom(lev)}, {boxArray(lev)}, {DistributionMap(lev)}, info );
-        linop.setBeta( beta_solver );
+        auto linop_lev = std::make_unique<MLNodeTensorLaplacian>(
+            Vector<Geometry>{Geom(lev)}, Vector<BoxArray>{boxArray(lev)},
+            Vector<DistributionMapping>{DistributionMap(lev)}, info );
+        linop_lev->setBeta( beta_solver );
 #endif
 #else
         // With embedded boundary: extract EB info
-        MLEBNodeFDLaplacian linop( {Geom(lev)}, {boxArray(lev)}, {DistributionMap(lev)}, info, {&WarpX::fieldEBFactory(lev)});
+        auto linop_lev = std::make_unique<MLEBNodeFDLaplacian>(
+            Vector<Geometry>{Geom(lev)}, Vector<BoxArray>{boxArray(lev)},
+            Vector<DistributionMapping>{DistributionMap(lev)}, info,
+            Vector<EBFArrayBoxFactory const*>{&WarpX::fieldEBFactory(lev)} );
 
 #ifdef WARPX_DIM_RZ
-            linop.setSigma({0._rt, 1._rt});
+            linop_lev->setSigma({0._rt, 1._rt});
+            linop_lev->setRZ(true);
 #else
             // Note: this assumes that the beam is propagating along
             // one of the axes of the grid, i.e. that only *one* of the Cartesian
             // components of `beta` is non-negligible.
-            linop.setSigma({AMREX_D_DECL(
+            linop_lev->setSigma({AMREX_D_DECL(
                 1._rt-beta[0]*beta[0], 1._rt-beta[1]*beta[1], 1._rt-beta[2]*beta[2])});
 #endif
 
         // if the EB potential only depends on time, the potential can be passed
         // as a float instead of a callable
         if (field_boundary_handler.phi_EB_only_t) {
-            linop.setEBDirichlet(field_boundary_handler.potential_eb_t(gett_new(0)));
+            linop_lev->setEBDirichlet(field_boundary_handler.potential_eb_t(gett_new(0)));
         }
-        else linop.setEBDirichlet(field_boundary_handler.getPhiEB(gett_new(0)));
+        else linop_lev->setEBDirichlet(field_boundary_handler.getPhiEB(gett_new(0)));
 
 #endif
+        linop = std::move(linop_lev);
+        linop->setDomainBC( field_boundary_handler.lobc, field_boundary_handler.hibc );
+        mlmg = std::make_unique<MLMG>(*linop);
+        }
 
         // Solve the Poisson equation
-        linop.setDomainBC( field_boundary_handler.lobc, field_boundary_handler.hibc );
-#ifdef WARPX_DIM_RZ
-        linop.setRZ(true);
-#endif
-        MLMG mlmg(linop);
-        mlmg.setVerbose(verbosity);
-        mlmg.setMaxIter(max_iters);
-        mlmg.setAlwaysUseBNorm(always_use_bnorm);
+        mlmg->setVerbose(verbosity);
+        mlmg->setMaxIter(max_iters);
+        mlmg->setAlwaysUseBNorm(always_use_bnorm);
 
         // Solve Poisson equation at lev
-        mlmg.solve( {phi[lev].get()}, {rho[lev].get()},
-                    required_precision, absolute_tolerance );
+        mlmg->solve( {phi[lev].get()}, {rho[lev].get()},
+                     required_precision, absolute_tolerance );
+        m_poisson_num_iters = (lev == 0) ? mlmg->getNumIters()
+                                         : std::max(m_poisson_num_iters, mlmg->getNumIters());
 
         // Interpolation from phi[lev] to phi[lev+1]
         // (This provides both the boundary conditions and initial guess for phi[lev+1])
@@ -412,7 +596,7 @@ WarpX::computePhi (const amrex::Vector<std::unique_ptr<amrex::MultiFab> >& rho,
             BoxArray ba = phi[lev+1]->boxArray();
             const IntVect& refratio = refRatio(lev);
             ba.coarsen(refratio);
-            const int ncomp = linop.getNComp();
+            const int ncomp = linop->getNComp();
             MultiFab phi_cp(ba, phi[lev+1]->DistributionMap(), ncomp, 1);
 
             // Copy from phi[lev] to phi_cp (in parallel)
@@ -445,19 +629,19 @@ WarpX::computePhi (const amrex::Vector<std::unique_ptr<amrex::MultiFab> >& rho,
         if (do_electrostatic == ElectrostaticSolverAlgo::LabFrame)
         {
 #if defined(WARPX_DIM_1D_Z)
-            mlmg.getGradSolution(
+            mlmg->getGradSolution(
                 {amrex::Array<amrex::MultiFab*,1>{
                     get_pointer_Efield_fp(lev, 2)
                     }}
             );
 #elif defined(WARPX_DIM_XZ) || defined(WARPX_DIM_RZ)
-            mlmg.getGradSolution(
+            mlmg->getGradSolution(
                 {amrex::Array<amrex::MultiFab*,2>{
                     get_pointer_Efield_fp(lev, 0),get_pointer_Efield_fp(lev, 2)
                     }}
             );
 #elif defined(WARPX_DIM_3D)
-            mlmg.getGradSolution(
+            mlmg->getGradSolution(
                 {amrex::Array<amrex::MultiFab*,3>{
                     get_pointer_Efield_fp(lev, 0),get_pointer_Efield_fp(lev, 1),
                     get_pointer_Efield_fp(lev, 2)
@@ -470,8 +654,57 @@ WarpX::computePhi (const amrex::Vector<std::unique_ptr<amrex::MultiFab> >& rho,
         }
 #endif
 
+        if (reuse_solver) {
+            m_poisson_mlmg[lev] = std::move(mlmg);
+            m_poisson_linop[lev] = std::move(linop);
+        }
     }
 
+    if (verbosity >= 1) {
+        amrex::Print() << Utils::TextMsg::Info(
+            "Poisson solve: " + std::to_string(m_poisson_num_iters) + " MLMG iterations");
+    }
+}
+
+/* Clear the Poisson operators and MLMG solvers kept across the calls of WarpX::computePhi,
+   and the potential of the previous solves used for the initial guess of the lab-frame solve.
+   Called when the grids of a level change. */
+void
+WarpX::ClearPoissonSolvers ()
+{
+    // the solvers refer to the operators
+    m_poisson_mlmg.clear();
+    m_poisson_linop.clear();
+    m_phi_prev.clear();
+}
+
+/* Replace the potential phi^{n-1} of the previous lab-frame solve by the linear
+   extrapolation 2 phi^{n-1} - phi^{n-2}, used as the initial guess of the solve of phi^n,
+   and store phi^{n-1} in m_phi_prev. The boundary values are then set by setPhiBC.
+   At the first solve, and after a regrid, phi is left unchanged. */
+void
+WarpX::ExtrapolatePhiInitialGuess ()
+{
+    if (static_cast<int>(m_phi_prev.size()) <= finest_level) m_phi_prev.resize(finest_level+1);
+
+    for (int lev = 0; lev <= finest_level; ++lev) {
+        if (!m_phi_prev[lev]) continue;
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#endif
+        for ( MFIter mfi(*phi_fp[lev], TilingIfNotGPU()); mfi.isValid(); ++mfi ) {
+            Array4<Real> const& phi_arr = phi_fp[lev]->array(mfi);
+            Array4<Real> const& phi_prev_arr = m_phi_prev[lev]->array(mfi);
+            Box const& bx = mfi.growntilebox();
+            amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+            {
+                Real const phi_nm1 = phi_arr(i,j,k);
+                phi_arr(i,j,k) = 2._rt*phi_nm1 - phi_prev_arr(i,j,k);
+                phi_prev_arr(i,j,k) = phi_nm1;
+            });
+        }
+    }
 }
 
 
@@ -786,7 +1019,7 @@ WarpX::computeB (amrex::Vector<std::array<std::unique_ptr<amrex::MultiFab>, 3> >
     }
 }
 
-void ElectrostaticSolver::BoundaryHandler::definePhiBCs ( )
+void ElectrostaticSolver::BoundaryHandler::definePhiBCs (bool const open_as_neumann)
 {
     int dim_start = 0;
 #ifdef WARPX_DIM_RZ
@@ -822,7 +1055,8 @@ void ElectrostaticSolver::BoundaryHandler::definePhiBCs ( )
                 lobc[idim] = LinOpBCType::Dirichlet;
                 dirichlet_flag[idim*2] = true;
             }
-            else if ( WarpX::field_boundary_lo[idim] == FieldBoundaryType::None ) {
+            else if ( WarpX::field_boundary_lo[idim] == FieldBoundaryType::None
+                      || open_as_neumann ) {
                 lobc[idim] = LinOpBCType::Neumann;
                 dirichlet_flag[idim*2] = false;
             }
@@ -837,7 +1071,8 @@ void ElectrostaticSolver::BoundaryHandler::definePhiBCs ( )
                 hibc[idim] = LinOpBCType::Dirichlet;
                 dirichlet_flag[idim*2+1] = true;
             }
-            else if ( WarpX::field_boundary_hi[idim] == FieldBoundaryType::None ) {
+            else if ( WarpX::field_boundary_hi[idim] == FieldBoundaryType::None
+                      || open_as_neumann ) {
                 hibc[idim] = LinOpBCType::Neumann;
                 dirichlet_flag[idim*2+1] = false;
             }
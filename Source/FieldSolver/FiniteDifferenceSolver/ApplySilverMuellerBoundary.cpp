@@ -33,6 +33,8 @@ using namespace amrex;
 
 /**
  * \brief Update the B field at the boundary, using the Silver-Mueller condition
+ *
+ * In the LLG build the same update is applied to H, with inv_mu = 1/mu0
  */
 void FiniteDifferenceSolver::ApplySilverMuellerBoundary (
     std::array< std::unique_ptr<amrex::MultiFab>, 3 >& Efield,
@@ -40,7 +42,8 @@ void FiniteDifferenceSolver::ApplySilverMuellerBoundary (
     amrex::Box domain_box,
     amrex::Real const dt,
     amrex::Vector<int> field_boundary_lo,
-    amrex::Vector<int> field_boundary_hi) {
+    amrex::Vector<int> field_boundary_hi,
+    amrex::Real const inv_mu) {
 
     // Ensure that we are using the Yee solver
     WARPX_ALWAYS_ASSERT_WITH_MESSAGE(
@@ -56,11 +59,11 @@ void FiniteDifferenceSolver::ApplySilverMuellerBoundary (
     amrex::Real const cdt = PhysConst::c*dt;
     amrex::Real const cdt_over_dr = cdt*m_h_stencil_coefs_r[0];
     amrex::Real const coef1_r = (1._rt - cdt_over_dr)/(1._rt + cdt_over_dr);
-    amrex::Real const coef2_r = 2._rt*cdt_over_dr/(1._rt + cdt_over_dr) / PhysConst::c;
-    amrex::Real const coef3_r = cdt/(1._rt + cdt_over_dr) / PhysConst::c;
+    amrex::Real const coef2_r = 2._rt*cdt_over_dr/(1._rt + cdt_over_dr) / PhysConst::c * inv_mu;
+    amrex::Real const coef3_r = cdt/(1._rt + cdt_over_dr) / PhysConst::c * inv_mu;
     amrex::Real const cdt_over_dz = cdt*m_h_stencil_coefs_z[0];
     amrex::Real const coef1_z = (1._rt - cdt_over_dz)/(1._rt + cdt_over_dz);
-    amrex::Real const coef2_z = 2._rt*cdt_over_dz/(1._rt + cdt_over_dz) / PhysConst::c;
+    amrex::Real const coef2_z = 2._rt*cdt_over_dz/(1._rt + cdt_over_dz) / PhysConst::c * inv_mu;
 
     // Extract stencil coefficients
     Real const * const AMREX_RESTRICT coefs_z = m_stencil_coefs_z.dataPtr();
@@ -170,16 +173,16 @@ void FiniteDifferenceSolver::ApplySilverMuellerBoundary (
 #if (defined WARPX_DIM_3D || WARPX_DIM_XZ)
     amrex::Real const cdt_over_dx = PhysConst::c*dt*m_h_stencil_coefs_x[0];
     amrex::Real const coef1_x = (1._rt - cdt_over_dx)/(1._rt + cdt_over_dx);
-    amrex::Real const coef2_x = 2._rt*cdt_over_dx/(1._rt + cdt_over_dx) / PhysConst::c;
+    amrex::Real const coef2_x = 2._rt*cdt_over_dx/(1._rt + cdt_over_dx) / PhysConst::c * inv_mu;
 #endif
 #ifdef WARPX_DIM_3D
     amrex::Real const cdt_over_dy = PhysConst::c*dt*m_h_stencil_coefs_y[0];
     amrex::Real const coef1_y = (1._rt - cdt_over_dy)/(1._rt + cdt_over_dy);
-    amrex::Real const coef2_y = 2._rt*cdt_over_dy/(1._rt + cdt_over_dy) / PhysConst::c;
+    amrex::Real const coef2_y = 2._rt*cdt_over_dy/(1._rt + cdt_over_dy) / PhysConst::c * inv_mu;
 #endif
     amrex::Real const cdt_over_dz = PhysConst::c*dt*m_h_stencil_coefs_z[0];
     amrex::Real const coef1_z = (1._rt - cdt_over_dz)/(1._rt + cdt_over_dz);
-    amrex::Real const coef2_z = 2._rt*cdt_over_dz/(1._rt + cdt_over_dz) / PhysConst::c;
+    amrex::Real const coef2_z = 2._rt*cdt_over_dz/(1._rt + cdt_over_dz) / PhysConst::c * inv_mu;
 
 #if (defined WARPX_DIM_3D || WARPX_DIM_XZ)
     bool const apply_lo_x = (field_boundary_lo[0] == FieldBoundaryType::Absorbing_SilverMueller);
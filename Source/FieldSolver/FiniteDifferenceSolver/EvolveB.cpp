@@ -56,7 +56,7 @@ void FiniteDifferenceSolver::EvolveB (
     std::array< std::unique_ptr<amrex::MultiFab>, 3 >& Venl,
     std::array< std::unique_ptr<amrex::iMultiFab>, 3 >& flag_info_cell,
     std::array< std::unique_ptr<amrex::LayoutData<FaceInfoBox> >, 3 >& borrowing,
-    int lev, amrex::Real const dt ) {
+    int lev, amrex::Real const dt, int ng_update ) {
 
 #ifndef AMREX_USE_EB
     amrex::ignore_unused(area_mod, ECTRhofield, Venl, flag_info_cell, borrowing);
@@ -66,7 +66,7 @@ void FiniteDifferenceSolver::EvolveB (
    // but we compile code for each algorithm, using templates)
 #ifdef WARPX_DIM_RZ
     if (m_fdtd_algo == MaxwellSolverAlgo::Yee){
-        ignore_unused(Gfield, face_areas);
+        ignore_unused(Gfield, face_areas, ng_update);
         EvolveBCylindrical <CylindricalYeeAlgorithm> ( Bfield, Efield, lev, dt );
 #else
     if(m_do_nodal or m_fdtd_algo != MaxwellSolverAlgo::ECT){
@@ -75,15 +75,21 @@ void FiniteDifferenceSolver::EvolveB (
 
     if (m_do_nodal) {
 
-        EvolveBCartesian <CartesianNodalAlgorithm> ( Bfield, Efield, Gfield, lev, dt );
+        WithStencilCoefs<CartesianNodalAlgorithm>([&] (auto const& stencil) {
+            EvolveBCartesian <CartesianNodalAlgorithm> ( Bfield, Efield, Gfield, lev, dt, ng_update, stencil );
+        });
 
     } else if (m_fdtd_algo == MaxwellSolverAlgo::Yee) {
 
-        EvolveBCartesian <CartesianYeeAlgorithm> ( Bfield, Efield, Gfield, lev, dt );
+        WithStencilCoefs<CartesianYeeAlgorithm>([&] (auto const& stencil) {
+            EvolveBCartesian <CartesianYeeAlgorithm> ( Bfield, Efield, Gfield, lev, dt, ng_update, stencil );
+        });
 
     } else if (m_fdtd_algo == MaxwellSolverAlgo::CKC) {
 
-        EvolveBCartesian <CartesianCKCAlgorithm> ( Bfield, Efield, Gfield, lev, dt );
+        WithStencilCoefs<CartesianCKCAlgorithm>([&] (auto const& stencil) {
+            EvolveBCartesian <CartesianCKCAlgorithm> ( Bfield, Efield, Gfield, lev, dt, ng_update, stencil );
+        });
 #ifdef AMREX_USE_EB
     } else if (m_fdtd_algo == MaxwellSolverAlgo::ECT) {
 
@@ -99,15 +105,68 @@ void FiniteDifferenceSolver::EvolveB (
 
 #ifndef WARPX_DIM_RZ
 
-template<typename T_Algo>
+template<typename T_Algo, typename T_Coefs>
 void FiniteDifferenceSolver::EvolveBCartesian (
     std::array< std::unique_ptr<amrex::MultiFab>, 3 >& Bfield,
     std::array< std::unique_ptr<amrex::MultiFab>, 3 > const& Efield,
     std::unique_ptr<amrex::MultiFab> const& Gfield,
-    int lev, amrex::Real const dt ) {
+    int lev, amrex::Real const dt, int ng_update,
+    StencilCoefs<T_Coefs> const& stencil ) {
 
     amrex::LayoutData<amrex::Real>* cost = WarpX::getCosts(lev);
 
+    // Extract stencil coefficients, captured by value in the kernels
+    T_Coefs const coefs_x = stencil.coefs[0];
+    int const n_coefs_x = stencil.n_coefs[0];
+    T_Coefs const coefs_y = stencil.coefs[1];
+    int const n_coefs_y = stencil.n_coefs[1];
+    T_Coefs const coefs_z = stencil.coefs[2];
+    int const n_coefs_z = stencil.n_coefs[2];
+
+    // One kernel per component for all the boxes of the level
+    if (FusedBoxLaunch(lev)) {
+        auto const Bx = Bfield[0]->arrays();
+        auto const By = Bfield[1]->arrays();
+        auto const Bz = Bfield[2]->arrays();
+        auto const Ex = Efield[0]->const_arrays();
+        auto const Ey = Efield[1]->const_arrays();
+        auto const Ez = Efield[2]->const_arrays();
+
+        ParallelForUpdateBoxes(*Bfield[0], ng_update, lev,
+            [=] AMREX_GPU_DEVICE (int b, int i, int j, int k){
+                Bx[b](i, j, k) += dt * T_Algo::UpwardDz(Ey[b], coefs_z, n_coefs_z, i, j, k)
+                                - dt * T_Algo::UpwardDy(Ez[b], coefs_y, n_coefs_y, i, j, k);
+            });
+        ParallelForUpdateBoxes(*Bfield[1], ng_update, lev,
+            [=] AMREX_GPU_DEVICE (int b, int i, int j, int k){
+                By[b](i, j, k) += dt * T_Algo::UpwardDx(Ez[b], coefs_x, n_coefs_x, i, j, k)
+                                - dt * T_Algo::UpwardDz(Ex[b], coefs_z, n_coefs_z, i, j, k);
+            });
+        ParallelForUpdateBoxes(*Bfield[2], ng_update, lev,
+            [=] AMREX_GPU_DEVICE (int b, int i, int j, int k){
+                Bz[b](i, j, k) += dt * T_Algo::UpwardDy(Ex[b], coefs_y, n_coefs_y, i, j, k)
+                                - dt * T_Algo::UpwardDx(Ey[b], coefs_x, n_coefs_x, i, j, k);
+            });
+
+        // div(B) cleaning correction for errors in magnetic Gauss law (div(B) = 0)
+        if (Gfield) {
+            auto const G = Gfield->const_arrays();
+            ParallelForUpdateBoxes(*Bfield[0], ng_update, lev,
+                [=] AMREX_GPU_DEVICE (int b, int i, int j, int k){
+                    Bx[b](i,j,k) += dt * T_Algo::DownwardDx(G[b], coefs_x, n_coefs_x, i, j, k);
+                });
+            ParallelForUpdateBoxes(*Bfield[1], ng_update, lev,
+                [=] AMREX_GPU_DEVICE (int b, int i, int j, int k){
+                    By[b](i,j,k) += dt * T_Algo::DownwardDy(G[b], coefs_y, n_coefs_y, i, j, k);
+                });
+            ParallelForUpdateBoxes(*Bfield[2], ng_update, lev,
+                [=] AMREX_GPU_DEVICE (int b, int i, int j, int k){
+                    Bz[b](i,j,k) += dt * T_Algo::DownwardDz(G[b], coefs_z, n_coefs_z, i, j, k);
+                });
+        }
+        return;
+    }
+
     // Loop through the grids, and over the tiles within each grid
 #ifdef AMREX_USE_OMP
 #pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
@@ -127,18 +186,10 @@ void FiniteDifferenceSolver::EvolveBCartesian (
         Array4<Real> const& Ey = Efield[1]->array(mfi);
         Array4<Real> const& Ez = Efield[2]->array(mfi);
 
-        // Extract stencil coefficients
-        Real const * const AMREX_RESTRICT coefs_x = m_stencil_coefs_x.dataPtr();
-        int const n_coefs_x = m_stencil_coefs_x.size();
-        Real const * const AMREX_RESTRICT coefs_y = m_stencil_coefs_y.dataPtr();
-        int const n_coefs_y = m_stencil_coefs_y.size();
-        Real const * const AMREX_RESTRICT coefs_z = m_stencil_coefs_z.dataPtr();
-        int const n_coefs_z = m_stencil_coefs_z.size();
-
         // Extract tileboxes for which to loop
-        Box const& tbx  = mfi.tilebox(Bfield[0]->ixType().toIntVect());
-        Box const& tby  = mfi.tilebox(Bfield[1]->ixType().toIntVect());
-        Box const& tbz  = mfi.tilebox(Bfield[2]->ixType().toIntVect());
+        Box const tbx = UpdateBox(mfi, Bfield[0]->ixType(), ng_update, lev);
+        Box const tby = UpdateBox(mfi, Bfield[1]->ixType(), ng_update, lev);
+        Box const tbz = UpdateBox(mfi, Bfield[2]->ixType(), ng_update, lev);
 
         // Loop over the cells and update the fields
         amrex::ParallelFor(tbx, tby, tbz,
@@ -221,6 +272,8 @@ void FiniteDifferenceSolver::EvolveBCartesianECT (
     Venl[1]->setVal(0.);
     Venl[2]->setVal(0.);
 
+    auto const* eb_flags = EBCellFlags(*Bfield[0], lev);
+
     // Loop through the grids, and over the tiles within each grid
 #ifdef AMREX_USE_OMP
 #pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
@@ -253,6 +306,17 @@ void FiniteDifferenceSolver::EvolveBCartesianECT (
             // Extract tileboxes for which to loop
             Box const &tb = mfi.tilebox(Bfield[idim]->ixType().toIntVect());
 
+            // The faces of the boxes which are all covered are not pushed, and the boxes which
+            // are all regular have neither covered, unstable nor intruded faces
+            amrex::FabType const eb_type = EBTileType(eb_flags, mfi, tb, tb, tb);
+            if (eb_type == amrex::FabType::covered) continue;
+            if (eb_type == amrex::FabType::regular) {
+                amrex::ParallelFor(tb, [=] AMREX_GPU_DEVICE(int i, int j, int k) {
+                    B(i, j, k) = B(i, j, k) - dt * Rho(i, j, k);
+                });
+                continue;
+            }
+
             //Take care of the unstable cells
             amrex::ParallelFor(tb, [=] AMREX_GPU_DEVICE(int i, int j, int k) {
 
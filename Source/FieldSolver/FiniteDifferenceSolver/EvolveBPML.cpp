@@ -7,6 +7,7 @@
 #include "FieldSolver/FiniteDifferenceSolver/FiniteDifferenceSolver.H"
 
 #include "BoundaryConditions/PMLComponent.H"
+#include "BoundaryConditions/WarpX_PML_kernels.H"
 
 #ifndef WARPX_DIM_RZ
 #   include "FieldSolver/FiniteDifferenceSolver/FiniteDifferenceAlgorithms/CartesianYeeAlgorithm.H"
@@ -44,26 +45,27 @@ void FiniteDifferenceSolver::EvolveBPML (
     std::array< amrex::MultiFab*, 3 > Bfield,
     std::array< amrex::MultiFab*, 3 > const Efield,
     amrex::Real const dt,
-    const bool dive_cleaning) {
+    const bool dive_cleaning,
+    MultiSigmaBox const* damp_sigba) {
 
    // Select algorithm (The choice of algorithm is a runtime option,
    // but we compile code for each algorithm, using templates)
 #ifdef WARPX_DIM_RZ
-    amrex::ignore_unused(Bfield, Efield, dt, dive_cleaning);
+    amrex::ignore_unused(Bfield, Efield, dt, dive_cleaning, damp_sigba);
     amrex::Abort(Utils::TextMsg::Err(
         "PML are not implemented in cylindrical geometry."));
 #else
     if (m_do_nodal) {
 
-        EvolveBPMLCartesian <CartesianNodalAlgorithm> (Bfield, Efield, dt, dive_cleaning);
+        EvolveBPMLCartesian <CartesianNodalAlgorithm> (Bfield, Efield, dt, dive_cleaning, damp_sigba);
 
     } else if (m_fdtd_algo == MaxwellSolverAlgo::Yee || m_fdtd_algo == MaxwellSolverAlgo::ECT) {
 
-        EvolveBPMLCartesian <CartesianYeeAlgorithm> (Bfield, Efield, dt, dive_cleaning);
+        EvolveBPMLCartesian <CartesianYeeAlgorithm> (Bfield, Efield, dt, dive_cleaning, damp_sigba);
 
     } else if (m_fdtd_algo == MaxwellSolverAlgo::CKC) {
 
-        EvolveBPMLCartesian <CartesianCKCAlgorithm> (Bfield, Efield, dt, dive_cleaning);
+        EvolveBPMLCartesian <CartesianCKCAlgorithm> (Bfield, Efield, dt, dive_cleaning, damp_sigba);
 
     } else {
         amrex::Abort(Utils::TextMsg::Err(
@@ -80,7 +82,14 @@ void FiniteDifferenceSolver::EvolveBPMLCartesian (
     std::array< amrex::MultiFab*, 3 > Bfield,
     std::array< amrex::MultiFab*, 3 > const Efield,
     amrex::Real const dt,
-    const bool dive_cleaning) {
+    const bool dive_cleaning,
+    MultiSigmaBox const* damp_sigba) {
+
+    // Staggering of the fields, for the damping fused into the update
+    bool const damp = (damp_sigba != nullptr);
+    amrex::IntVect const Bx_stag = Bfield[0]->ixType().toIntVect();
+    amrex::IntVect const By_stag = Bfield[1]->ixType().toIntVect();
+    amrex::IntVect const Bz_stag = Bfield[2]->ixType().toIntVect();
 
     // Loop through the grids, and over the tiles within each grid
 #ifdef AMREX_USE_OMP
@@ -104,6 +113,9 @@ void FiniteDifferenceSolver::EvolveBPMLCartesian (
         Real const * const AMREX_RESTRICT coefs_z = m_stencil_coefs_z.dataPtr();
         int const n_coefs_z = m_stencil_coefs_z.size();
 
+        // Damping factors of this box
+        PMLDampFactors const f = damp ? GetPMLDampFactors((*damp_sigba)[mfi]) : PMLDampFactors{};
+
         // Extract tileboxes for which to loop
         Box const& tbx  = mfi.tilebox(Bfield[0]->ixType().ixType());
         Box const& tby  = mfi.tilebox(Bfield[1]->ixType().ixType());
@@ -131,6 +143,10 @@ void FiniteDifferenceSolver::EvolveBPMLCartesian (
                     T_Algo::UpwardDy(Ez, coefs_y, n_coefs_y, i, j, k, PMLComp::zx)
                   + T_Algo::UpwardDy(Ez, coefs_y, n_coefs_y, i, j, k, PMLComp::zy)
                   + UpwardDy_Ez_zz);
+                if (damp) {
+                    warpx_damp_pml_bx(i, j, k, Bx, Bx_stag, f.sigma_fac_x, f.sigma_fac_y, f.sigma_fac_z,
+                        f.sigma_star_fac_x, f.sigma_star_fac_y, f.sigma_star_fac_z, f.xlo, f.ylo, f.zlo, false);
+                }
             },
 
             [=] AMREX_GPU_DEVICE (int i, int j, int k){
@@ -152,6 +168,10 @@ void FiniteDifferenceSolver::EvolveBPMLCartesian (
                     UpwardDz_Ex_xx
                   + T_Algo::UpwardDz(Ex, coefs_z, n_coefs_z, i, j, k, PMLComp::xy)
                   + T_Algo::UpwardDz(Ex, coefs_z, n_coefs_z, i, j, k, PMLComp::xz));
+                if (damp) {
+                    warpx_damp_pml_by(i, j, k, By, By_stag, f.sigma_fac_x, f.sigma_fac_y, f.sigma_fac_z,
+                        f.sigma_star_fac_x, f.sigma_star_fac_y, f.sigma_star_fac_z, f.xlo, f.ylo, f.zlo, false);
+                }
             },
 
             [=] AMREX_GPU_DEVICE (int i, int j, int k){
@@ -173,6 +193,10 @@ void FiniteDifferenceSolver::EvolveBPMLCartesian (
                     T_Algo::UpwardDx(Ey, coefs_x, n_coefs_x, i, j, k, PMLComp::yx)
                   + T_Algo::UpwardDx(Ey, coefs_x, n_coefs_x, i, j, k, PMLComp::yz)
                   + UpwardDx_Ey_yy);
+                if (damp) {
+                    warpx_damp_pml_bz(i, j, k, Bz, Bz_stag, f.sigma_fac_x, f.sigma_fac_y, f.sigma_fac_z,
+                        f.sigma_star_fac_x, f.sigma_star_fac_y, f.sigma_star_fac_z, f.xlo, f.ylo, f.zlo, false);
+                }
             }
 
         );
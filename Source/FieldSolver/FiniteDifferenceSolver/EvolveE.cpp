@@ -53,7 +53,7 @@ void FiniteDifferenceSolver::EvolveE (
     std::array< std::unique_ptr<amrex::MultiFab>, 3 > const& face_areas,
     std::array< std::unique_ptr<amrex::MultiFab>, 3 >& ECTRhofield,
     std::unique_ptr<amrex::MultiFab> const& Ffield,
-    int lev, amrex::Real const dt ) {
+    int lev, amrex::Real const dt, int ng_update ) {
 
 #ifdef AMREX_USE_EB
     if (m_fdtd_algo != MaxwellSolverAlgo::ECT) {
@@ -67,20 +67,26 @@ void FiniteDifferenceSolver::EvolveE (
     // but we compile code for each algorithm, using templates)
 #ifdef WARPX_DIM_RZ
     if (m_fdtd_algo == MaxwellSolverAlgo::Yee){
-        ignore_unused(edge_lengths);
+        ignore_unused(edge_lengths, ng_update);
         EvolveECylindrical <CylindricalYeeAlgorithm> ( Efield, Bfield, Jfield, Ffield, lev, dt );
 #else
     if (m_do_nodal) {
 
-        EvolveECartesian <CartesianNodalAlgorithm> ( Efield, Bfield, Jfield, edge_lengths, Ffield, lev, dt );
+        WithStencilCoefs<CartesianNodalAlgorithm>([&] (auto const& stencil) {
+            EvolveECartesian <CartesianNodalAlgorithm> ( Efield, Bfield, Jfield, edge_lengths, Ffield, lev, dt, ng_update, stencil );
+        });
 
     } else if (m_fdtd_algo == MaxwellSolverAlgo::Yee || m_fdtd_algo == MaxwellSolverAlgo::ECT) {
 
-        EvolveECartesian <CartesianYeeAlgorithm> ( Efield, Bfield, Jfield, edge_lengths, Ffield, lev, dt );
+        WithStencilCoefs<CartesianYeeAlgorithm>([&] (auto const& stencil) {
+            EvolveECartesian <CartesianYeeAlgorithm> ( Efield, Bfield, Jfield, edge_lengths, Ffield, lev, dt, ng_update, stencil );
+        });
 
     } else if (m_fdtd_algo == MaxwellSolverAlgo::CKC) {
 
-        EvolveECartesian <CartesianCKCAlgorithm> ( Efield, Bfield, Jfield, edge_lengths, Ffield, lev, dt );
+        WithStencilCoefs<CartesianCKCAlgorithm>([&] (auto const& stencil) {
+            EvolveECartesian <CartesianCKCAlgorithm> ( Efield, Bfield, Jfield, edge_lengths, Ffield, lev, dt, ng_update, stencil );
+        });
 
 #endif
     } else {
@@ -92,14 +98,15 @@ void FiniteDifferenceSolver::EvolveE (
 
 #ifndef WARPX_DIM_RZ
 
-template<typename T_Algo>
+template<typename T_Algo, typename T_Coefs>
 void FiniteDifferenceSolver::EvolveECartesian (
     std::array< std::unique_ptr<amrex::MultiFab>, 3 >& Efield,
     std::array< std::unique_ptr<amrex::MultiFab>, 3 > const& Bfield,
     std::array< std::unique_ptr<amrex::MultiFab>, 3 > const& Jfield,
     std::array< std::unique_ptr<amrex::MultiFab>, 3 > const& edge_lengths,
     std::unique_ptr<amrex::MultiFab> const& Ffield,
-    int lev, amrex::Real const dt ) {
+    int lev, amrex::Real const dt, int ng_update,
+    StencilCoefs<T_Coefs> const& stencil ) {
 
 #ifndef AMREX_USE_EB
     amrex::ignore_unused(edge_lengths);
@@ -108,6 +115,71 @@ void FiniteDifferenceSolver::EvolveECartesian (
     amrex::LayoutData<amrex::Real>* cost = WarpX::getCosts(lev);
     Real constexpr c2 = PhysConst::c * PhysConst::c;
 
+    // Extract stencil coefficients, captured by value in the kernels
+    T_Coefs const coefs_x = stencil.coefs[0];
+    int const n_coefs_x = stencil.n_coefs[0];
+    T_Coefs const coefs_y = stencil.coefs[1];
+    int const n_coefs_y = stencil.n_coefs[1];
+    T_Coefs const coefs_z = stencil.coefs[2];
+    int const n_coefs_z = stencil.n_coefs[2];
+
+    // One kernel per component for all the boxes of the level
+    if (FusedBoxLaunch(lev)) {
+        auto const Ex = Efield[0]->arrays();
+        auto const Ey = Efield[1]->arrays();
+        auto const Ez = Efield[2]->arrays();
+        auto const Bx = Bfield[0]->const_arrays();
+        auto const By = Bfield[1]->const_arrays();
+        auto const Bz = Bfield[2]->const_arrays();
+        auto const jx = Jfield[0]->const_arrays();
+        auto const jy = Jfield[1]->const_arrays();
+        auto const jz = Jfield[2]->const_arrays();
+
+        ParallelForUpdateBoxes(*Efield[0], ng_update, lev,
+            [=] AMREX_GPU_DEVICE (int b, int i, int j, int k){
+                Ex[b](i, j, k) += c2 * dt * (
+                    - T_Algo::DownwardDz(By[b], coefs_z, n_coefs_z, i, j, k)
+                    + T_Algo::DownwardDy(Bz[b], coefs_y, n_coefs_y, i, j, k)
+                    - PhysConst::mu0 * jx[b](i, j, k) );
+            });
+        ParallelForUpdateBoxes(*Efield[1], ng_update, lev,
+            [=] AMREX_GPU_DEVICE (int b, int i, int j, int k){
+                Ey[b](i, j, k) += c2 * dt * (
+                    - T_Algo::DownwardDx(Bz[b], coefs_x, n_coefs_x, i, j, k)
+                    + T_Algo::DownwardDz(Bx[b], coefs_z, n_coefs_z, i, j, k)
+                    - PhysConst::mu0 * jy[b](i, j, k) );
+            });
+        ParallelForUpdateBoxes(*Efield[2], ng_update, lev,
+            [=] AMREX_GPU_DEVICE (int b, int i, int j, int k){
+                Ez[b](i, j, k) += c2 * dt * (
+                    - T_Algo::DownwardDy(Bx[b], coefs_y, n_coefs_y, i, j, k)
+                    + T_Algo::DownwardDx(By[b], coefs_x, n_coefs_x, i, j, k)
+                    - PhysConst::mu0 * jz[b](i, j, k) );
+            });
+
+        // hyperbolic correction for errors in charge conservation
+        if (Ffield) {
+            auto const F = Ffield->const_arrays();
+            ParallelForUpdateBoxes(*Efield[0], ng_update, lev,
+                [=] AMREX_GPU_DEVICE (int b, int i, int j, int k){
+                    Ex[b](i, j, k) += c2 * dt * T_Algo::UpwardDx(F[b], coefs_x, n_coefs_x, i, j, k);
+                });
+            ParallelForUpdateBoxes(*Efield[1], ng_update, lev,
+                [=] AMREX_GPU_DEVICE (int b, int i, int j, int k){
+                    Ey[b](i, j, k) += c2 * dt * T_Algo::UpwardDy(F[b], coefs_y, n_coefs_y, i, j, k);
+                });
+            ParallelForUpdateBoxes(*Efield[2], ng_update, lev,
+                [=] AMREX_GPU_DEVICE (int b, int i, int j, int k){
+                    Ez[b](i, j, k) += c2 * dt * T_Algo::UpwardDz(F[b], coefs_z, n_coefs_z, i, j, k);
+                });
+        }
+        return;
+    }
+
+#ifdef AMREX_USE_EB
+    auto const* eb_flags = EBCellFlags(*Efield[0], lev);
+#endif
+
     // Loop through the grids, and over the tiles within each grid
 #ifdef AMREX_USE_OMP
 #pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
@@ -136,58 +208,60 @@ void FiniteDifferenceSolver::EvolveECartesian (
         amrex::Array4<amrex::Real> const& lz = edge_lengths[2]->array(mfi);
 #endif
 
-        // Extract stencil coefficients
-        Real const * const AMREX_RESTRICT coefs_x = m_stencil_coefs_x.dataPtr();
-        int const n_coefs_x = m_stencil_coefs_x.size();
-        Real const * const AMREX_RESTRICT coefs_y = m_stencil_coefs_y.dataPtr();
-        int const n_coefs_y = m_stencil_coefs_y.size();
-        Real const * const AMREX_RESTRICT coefs_z = m_stencil_coefs_z.dataPtr();
-        int const n_coefs_z = m_stencil_coefs_z.size();
-
         // Extract tileboxes for which to loop
-        Box const& tex  = mfi.tilebox(Efield[0]->ixType().toIntVect());
-        Box const& tey  = mfi.tilebox(Efield[1]->ixType().toIntVect());
-        Box const& tez  = mfi.tilebox(Efield[2]->ixType().toIntVect());
+        Box const tex = UpdateBox(mfi, Efield[0]->ixType(), ng_update, lev);
+        Box const tey = UpdateBox(mfi, Efield[1]->ixType(), ng_update, lev);
+        Box const tez = UpdateBox(mfi, Efield[2]->ixType(), ng_update, lev);
 
-        // Loop over the cells and update the fields
-        amrex::ParallelFor(tex, tey, tez,
+        bool push_edges = true;
+#ifdef AMREX_USE_EB
+        // The edges of the tiles which are all covered are not pushed, and the edge lengths
+        // are only checked on the tiles cut by the embedded boundaries
+        amrex::FabType const eb_type = EBTileType(eb_flags, mfi, tex, tey, tez);
+        bool const eb_cut = (eb_type != amrex::FabType::regular);
+        push_edges = (eb_type != amrex::FabType::covered);
+#endif
+        if (push_edges) {
+            // Loop over the cells and update the fields
+            amrex::ParallelFor(tex, tey, tez,
 
-            [=] AMREX_GPU_DEVICE (int i, int j, int k){
+                [=] AMREX_GPU_DEVICE (int i, int j, int k){
 #ifdef AMREX_USE_EB
-                // Skip field push if this cell is fully covered by embedded boundaries
-                if (lx(i, j, k) <= 0) return;
+                    // Skip field push if this cell is fully covered by embedded boundaries
+                    if (eb_cut && lx(i, j, k) <= 0) return;
 #endif
-                Ex(i, j, k) += c2 * dt * (
-                    - T_Algo::DownwardDz(By, coefs_z, n_coefs_z, i, j, k)
-                    + T_Algo::DownwardDy(Bz, coefs_y, n_coefs_y, i, j, k)
-                    - PhysConst::mu0 * jx(i, j, k) );
-            },
+                    Ex(i, j, k) += c2 * dt * (
+                        - T_Algo::DownwardDz(By, coefs_z, n_coefs_z, i, j, k)
+                        + T_Algo::DownwardDy(Bz, coefs_y, n_coefs_y, i, j, k)
+                        - PhysConst::mu0 * jx(i, j, k) );
+                },
 
-            [=] AMREX_GPU_DEVICE (int i, int j, int k){
+                [=] AMREX_GPU_DEVICE (int i, int j, int k){
 #ifdef AMREX_USE_EB
-                // Skip field push if this cell is fully covered by embedded boundaries
-                if (ly(i,j,k) <= 0) return;
+                    // Skip field push if this cell is fully covered by embedded boundaries
+                    if (eb_cut && ly(i,j,k) <= 0) return;
 #endif
 
-                Ey(i, j, k) += c2 * dt * (
-                    - T_Algo::DownwardDx(Bz, coefs_x, n_coefs_x, i, j, k)
-                    + T_Algo::DownwardDz(Bx, coefs_z, n_coefs_z, i, j, k)
-                    - PhysConst::mu0 * jy(i, j, k) );
-            },
+                    Ey(i, j, k) += c2 * dt * (
+                        - T_Algo::DownwardDx(Bz, coefs_x, n_coefs_x, i, j, k)
+                        + T_Algo::DownwardDz(Bx, coefs_z, n_coefs_z, i, j, k)
+                        - PhysConst::mu0 * jy(i, j, k) );
+                },
 
-            [=] AMREX_GPU_DEVICE (int i, int j, int k){
+                [=] AMREX_GPU_DEVICE (int i, int j, int k){
 
 #ifdef AMREX_USE_EB
-                // Skip field push if this cell is fully covered by embedded boundaries
-                if (lz(i,j,k) <= 0) return;
+                    // Skip field push if this cell is fully covered by embedded boundaries
+                    if (eb_cut && lz(i,j,k) <= 0) return;
 #endif
-                Ez(i, j, k) += c2 * dt * (
-                    - T_Algo::DownwardDy(Bx, coefs_y, n_coefs_y, i, j, k)
-                    + T_Algo::DownwardDx(By, coefs_x, n_coefs_x, i, j, k)
-                    - PhysConst::mu0 * jz(i, j, k) );
-            }
+                    Ez(i, j, k) += c2 * dt * (
+                        - T_Algo::DownwardDy(Bx, coefs_y, n_coefs_y, i, j, k)
+                        + T_Algo::DownwardDx(By, coefs_x, n_coefs_x, i, j, k)
+                        - PhysConst::mu0 * jz(i, j, k) );
+                }
 
-        );
+            );
+        }
 
         // If F is not a null pointer, further update E using the grad(F) term
         // (hyperbolic correction for errors in charge conservation)
@@ -0,0 +1,295 @@
+/* This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+#include "FiniteDifferenceSolver.H"
+
+#ifndef WARPX_DIM_RZ
+#   include "FieldSolver/FiniteDifferenceSolver/FiniteDifferenceAlgorithms/CartesianYeeAlgorithm.H"
+#   include "FieldSolver/FiniteDifferenceSolver/FiniteDifferenceAlgorithms/FieldAccessorFunctors.H"
+#endif
+#include "Utils/TextMsg.H"
+#include "Utils/WarpXAlgorithmSelection.H"
+#include "Utils/WarpXConst.H"
+#include "WarpX.H"
+
+#include <AMReX.H>
+#include <AMReX_Array4.H>
+#include <AMReX_Box.H>
+#include <AMReX_BoxList.H>
+#include <AMReX_FArrayBox.H>
+#include <AMReX_GpuAtomic.H>
+#include <AMReX_GpuLaunch.H>
+#include <AMReX_IndexType.H>
+#include <AMReX_LayoutData.H>
+#include <AMReX_Loop.H>
+#include <AMReX_MFIter.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_REAL.H>
+#include <AMReX_Vector.H>
+
+#include <array>
+#include <memory>
+
+using namespace amrex;
+
+#ifndef WARPX_DIM_RZ
+
+namespace
+{
+    /** The regions of the updates of one tile, per component: E in 0-2 and B in 3-5 */
+    struct TemporalBlockingTile
+    {
+        int box = 0;
+        /** the cells written back to the fields, also those of the second B update */
+        std::array<Box, 6> write;
+        /** the cells of the first B update and of the E update */
+        std::array<Box, 3> B1, E;
+        /** the cells of the local copies */
+        std::array<Box, 6> local;
+        /** the cells of the local copies written by other tiles, saved before any tile is written */
+        std::array<Vector<FArrayBox>, 6> halo;
+    };
+
+    /** Smallest cell-centered box that contains the boxes b */
+    Box CellHull (std::array<Box, 3> const& b)
+    {
+        Box hull = amrex::enclosedCells(amrex::convert(b[0], IndexType::TheNodeType()));
+        for (int c = 1; c < 3; ++c) {
+            hull.minBox(amrex::enclosedCells(amrex::convert(b[c], IndexType::TheNodeType())));
+        }
+        return hull;
+    }
+
+    /** Smallest box of the indices of the boxes b, whatever their staggering */
+    Box IndexHull (std::array<Box, 6> const& b)
+    {
+        Box hull(b[0].smallEnd(), b[0].bigEnd());
+        for (int c = 1; c < 6; ++c) hull.minBox(Box(b[c].smallEnd(), b[c].bigEnd()));
+        return hull;
+    }
+
+    /** Copy src into dst in the box b, with dst an Array4 or a FieldAccessorInterleaved */
+    template< typename T_Field >
+    void CopyIn (T_Field const& dst, Array4<Real const> const& src, Box const& b)
+    {
+        amrex::LoopOnCpu(b, [&] (int i, int j, int k) noexcept { dst(i, j, k) = src(i, j, k); });
+    }
+
+    /** Copy src into dst in the box b, with src an Array4 or a FieldAccessorInterleaved */
+    template< typename T_Field >
+    void CopyOut (Array4<Real> const& dst, T_Field const& src, Box const& b)
+    {
+        amrex::LoopOnCpu(b, [&] (int i, int j, int k) noexcept { dst(i, j, k) = src(i, j, k); });
+    }
+}
+
+void FiniteDifferenceSolver::EvolveEBTemporalBlocking (
+    std::array< std::unique_ptr<amrex::MultiFab>, 3 >& Efield,
+    std::array< std::unique_ptr<amrex::MultiFab>, 3 >& Bfield,
+    std::array< std::unique_ptr<amrex::MultiFab>, 3 > const& Jfield,
+    int lev, amrex::Real const dt,
+    int ng_B1, int ng_E, int ng_B2, bool interleaved ) {
+
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(m_fdtd_algo == MaxwellSolverAlgo::Yee,
+        "EvolveEBTemporalBlocking: only implemented for the Yee solver");
+
+    amrex::LayoutData<amrex::Real>* cost = WarpX::getCosts(lev);
+
+    std::array<MultiFab*, 6> const fields = {Efield[0].get(), Efield[1].get(), Efield[2].get(),
+                                             Bfield[0].get(), Bfield[1].get(), Bfield[2].get()};
+
+    // The regions of the tiles, from the last update back to the first: the second B update
+    // is done in the cells of the tile (grown by ng_B2 in the guard cells, as in EvolveB), which
+    // read E one cell further, which reads the first B update one cell further, which reads E one
+    // cell further. The cells beyond the tile are updated redundantly with the neighbor tiles.
+    Vector<TemporalBlockingTile> tiles;
+    for (MFIter mfi(*Efield[0], TilingIfNotGPU()); mfi.isValid(); ++mfi) {
+        TemporalBlockingTile tile;
+        tile.box = mfi.index();
+        Box const tile_cells = UpdateBox(mfi, IndexType::TheCellType(), ng_B2, lev);
+        for (int c = 0; c < 3; ++c) {
+            IndexType const E_type = Efield[c]->ixType();
+            tile.write[c] = UpdateBox(mfi, E_type, ng_E, lev);
+            tile.write[c+3] = UpdateBox(mfi, Bfield[c]->ixType(), ng_B2, lev);
+            Box const E_limit = amrex::grow(amrex::convert(mfi.validbox(), E_type), ng_E)
+                & UpdateDomain(E_type, ng_E, lev);
+            tile.E[c] = amrex::convert(amrex::grow(tile_cells, 1), E_type) & E_limit;
+            tile.E[c].minBox(tile.write[c]);
+        }
+        Box const E_cells = CellHull(tile.E);
+        for (int c = 0; c < 3; ++c) {
+            IndexType const B_type = Bfield[c]->ixType();
+            Box const B_limit = amrex::grow(amrex::convert(mfi.validbox(), B_type), ng_B1)
+                & UpdateDomain(B_type, ng_B1, lev);
+            tile.B1[c] = amrex::convert(amrex::grow(E_cells, 1), B_type) & B_limit;
+        }
+        Box const local_cells = amrex::grow(CellHull(tile.B1), 1);
+        for (int c = 0; c < 6; ++c) {
+            tile.local[c] = amrex::convert(local_cells, fields[c]->ixType())
+                & fields[c]->fabbox(mfi.index());
+        }
+        tiles.push_back(std::move(tile));
+    }
+    int const ntiles = static_cast<int>(tiles.size());
+
+    // Save the cells of the local copies that other tiles write back
+#ifdef AMREX_USE_OMP
+#pragma omp parallel for schedule(dynamic) if (amrex::Gpu::notInLaunchRegion())
+#endif
+    for (int t = 0; t < ntiles; ++t) {
+        TemporalBlockingTile& tile = tiles[t];
+        for (int c = 0; c < 6; ++c) {
+            FArrayBox const& fab = (*fields[c])[tile.box];
+            BoxList const halo_boxes = amrex::boxDiff(tile.local[c], tile.write[c]);
+            for (Box const& b : halo_boxes) {
+                FArrayBox& saved = tile.halo[c].emplace_back(b, 1);
+                saved.copy<RunOn::Host>(fab, b);
+            }
+        }
+    }
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#endif
+    {
+        // the local copies are reused by the tiles of a thread: one FArrayBox per component,
+        // or the six components interleaved per cell
+        std::array<FArrayBox, 6> local;
+        Vector<Real> local_interleaved;
+#ifdef AMREX_USE_OMP
+#pragma omp for schedule(dynamic)
+#endif
+        for (int t = 0; t < ntiles; ++t) {
+            TemporalBlockingTile const& tile = tiles[t];
+            Real wt = amrex::second();
+
+            std::array<Array4<Real const>, 3> const J = {Jfield[0]->const_array(tile.box),
+                                                         Jfield[1]->const_array(tile.box),
+                                                         Jfield[2]->const_array(tile.box)};
+            std::array<Box, 3> const B2 = {tile.write[3], tile.write[4], tile.write[5]};
+
+            // copy the tile in, advance it and copy it out, through the accessors EB
+            auto const advance = [&] (auto const& EB) {
+                for (int c = 0; c < 6; ++c) {
+                    CopyIn(EB[c], fields[c]->const_array(tile.box), tile.write[c]);
+                    for (FArrayBox const& saved : tile.halo[c]) {
+                        CopyIn(EB[c], saved.const_array(), saved.box());
+                    }
+                }
+                WithStencilCoefs<CartesianYeeAlgorithm>([&] (auto const& stencil) {
+                    AdvanceTileEBTemporalBlocking(EB, J, tile.B1, tile.E, B2, dt, stencil);
+                });
+                for (int c = 0; c < 6; ++c) {
+                    CopyOut(fields[c]->array(tile.box), EB[c], tile.write[c]);
+                }
+            };
+
+            if (interleaved) {
+                Box const index_box = IndexHull(tile.local);
+                local_interleaved.resize(6 * index_box.numPts());
+                std::array<FieldAccessorInterleaved, 6> EB;
+                for (int c = 0; c < 6; ++c) {
+                    EB[c] = FieldAccessorInterleaved(local_interleaved.data(), index_box, c, 6);
+                }
+                advance(EB);
+            } else {
+                std::array<Array4<Real>, 6> EB;
+                for (int c = 0; c < 6; ++c) {
+                    local[c].resize(tile.local[c], 1);
+                    EB[c] = local[c].array();
+                }
+                advance(EB);
+            }
+
+            if (cost && WarpX::load_balance_costs_update_algo == LoadBalanceCostsUpdateAlgo::Timers)
+            {
+                wt = amrex::second() - wt;
+                amrex::HostDevice::Atomic::Add( &(*cost)[tile.box], wt);
+            }
+        }
+    }
+}
+
+template<typename T_Field, typename T_Coefs>
+void FiniteDifferenceSolver::AdvanceTileEBTemporalBlocking (
+    std::array< T_Field, 6 > const& EB,
+    std::array< amrex::Array4<amrex::Real const>, 3 > const& J,
+    std::array< amrex::Box, 3 > const& B1, std::array< amrex::Box, 3 > const& E,
+    std::array< amrex::Box, 3 > const& B2, amrex::Real const dt,
+    StencilCoefs<T_Coefs> const& stencil ) {
+
+    Real constexpr c2 = PhysConst::c * PhysConst::c;
+    Real const dt_B = 0.5_rt * dt;
+
+    // Extract stencil coefficients, captured by value in the kernels
+    T_Coefs const coefs_x = stencil.coefs[0];
+    int const n_coefs_x = stencil.n_coefs[0];
+    T_Coefs const coefs_y = stencil.coefs[1];
+    int const n_coefs_y = stencil.n_coefs[1];
+    T_Coefs const coefs_z = stencil.coefs[2];
+    int const n_coefs_z = stencil.n_coefs[2];
+
+    T_Field const Ex = EB[0];
+    T_Field const Ey = EB[1];
+    T_Field const Ez = EB[2];
+    T_Field const Bx = EB[3];
+    T_Field const By = EB[4];
+    T_Field const Bz = EB[5];
+    Array4<Real const> const jx = J[0];
+    Array4<Real const> const jy = J[1];
+    Array4<Real const> const jz = J[2];
+
+    // B^{n+1/2}
+    amrex::ParallelFor(B1[0], B1[1], B1[2],
+            [=] AMREX_GPU_DEVICE (int i, int j, int k){
+                Bx(i, j, k) += dt_B * CartesianYeeAlgorithm::UpwardDz(Ey, coefs_z, n_coefs_z, i, j, k)
+                             - dt_B * CartesianYeeAlgorithm::UpwardDy(Ez, coefs_y, n_coefs_y, i, j, k);
+            },
+            [=] AMREX_GPU_DEVICE (int i, int j, int k){
+                By(i, j, k) += dt_B * CartesianYeeAlgorithm::UpwardDx(Ez, coefs_x, n_coefs_x, i, j, k)
+                             - dt_B * CartesianYeeAlgorithm::UpwardDz(Ex, coefs_z, n_coefs_z, i, j, k);
+            },
+            [=] AMREX_GPU_DEVICE (int i, int j, int k){
+                Bz(i, j, k) += dt_B * CartesianYeeAlgorithm::UpwardDy(Ex, coefs_y, n_coefs_y, i, j, k)
+                             - dt_B * CartesianYeeAlgorithm::UpwardDx(Ey, coefs_x, n_coefs_x, i, j, k);
+            });
+
+    // E^{n+1}
+    amrex::ParallelFor(E[0], E[1], E[2],
+        [=] AMREX_GPU_DEVICE (int i, int j, int k){
+            Ex(i, j, k) += c2 * dt * (
+                - CartesianYeeAlgorithm::DownwardDz(By, coefs_z, n_coefs_z, i, j, k)
+                + CartesianYeeAlgorithm::DownwardDy(Bz, coefs_y, n_coefs_y, i, j, k)
+                - PhysConst::mu0 * jx(i, j, k) );
+        },
+        [=] AMREX_GPU_DEVICE (int i, int j, int k){
+            Ey(i, j, k) += c2 * dt * (
+                - CartesianYeeAlgorithm::DownwardDx(Bz, coefs_x, n_coefs_x, i, j, k)
+                + CartesianYeeAlgorithm::DownwardDz(Bx, coefs_z, n_coefs_z, i, j, k)
+                - PhysConst::mu0 * jy(i, j, k) );
+        },
+        [=] AMREX_GPU_DEVICE (int i, int j, int k){
+            Ez(i, j, k) += c2 * dt * (
+                - CartesianYeeAlgorithm::DownwardDy(Bx, coefs_y, n_coefs_y, i, j, k)
+                + CartesianYeeAlgorithm::DownwardDx(By, coefs_x, n_coefs_x, i, j, k)
+                - PhysConst::mu0 * jz(i, j, k) );
+        });
+
+    // B^{n+1}
+    amrex::ParallelFor(B2[0], B2[1], B2[2],
+            [=] AMREX_GPU_DEVICE (int i, int j, int k){
+                Bx(i, j, k) += dt_B * CartesianYeeAlgorithm::UpwardDz(Ey, coefs_z, n_coefs_z, i, j, k)
+                             - dt_B * CartesianYeeAlgorithm::UpwardDy(Ez, coefs_y, n_coefs_y, i, j, k);
+            },
+            [=] AMREX_GPU_DEVICE (int i, int j, int k){
+                By(i, j, k) += dt_B * CartesianYeeAlgorithm::UpwardDx(Ez, coefs_x, n_coefs_x, i, j, k)
+                             - dt_B * CartesianYeeAlgorithm::UpwardDz(Ex, coefs_z, n_coefs_z, i, j, k);
+            },
+            [=] AMREX_GPU_DEVICE (int i, int j, int k){
+                Bz(i, j, k) += dt_B * CartesianYeeAlgorithm::UpwardDy(Ex, coefs_y, n_coefs_y, i, j, k)
+                             - dt_B * CartesianYeeAlgorithm::UpwardDx(Ey, coefs_x, n_coefs_x, i, j, k);
+            });
+}
+
+#endif // ifndef WARPX_DIM_RZ
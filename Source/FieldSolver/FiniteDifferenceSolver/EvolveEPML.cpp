@@ -9,6 +9,7 @@
 #include "BoundaryConditions/PML.H"
 #include "BoundaryConditions/PMLComponent.H"
 #include "BoundaryConditions/PML_current.H"
+#include "BoundaryConditions/WarpX_PML_kernels.H"
 #ifndef WARPX_DIM_RZ
 #   include "FieldSolver/FiniteDifferenceSolver/FiniteDifferenceAlgorithms/CartesianYeeAlgorithm.H"
 #   include "FieldSolver/FiniteDifferenceSolver/FiniteDifferenceAlgorithms/CartesianCKCAlgorithm.H"
@@ -19,6 +20,7 @@
 #include "Utils/TextMsg.H"
 #include "Utils/WarpXAlgorithmSelection.H"
 #include "Utils/WarpXConst.H"
+#include "WarpX.H"
 
 #include <AMReX.H>
 #include <AMReX_Array4.H>
@@ -50,29 +52,34 @@ void FiniteDifferenceSolver::EvolveEPML (
     std::array< amrex::MultiFab*, 3 > const edge_lengths,
     amrex::MultiFab* const Ffield,
     MultiSigmaBox const& sigba,
-    amrex::Real const dt, bool pml_has_particles ) {
+    amrex::Real const dt, bool pml_has_particles,
+    const bool fused_damping ) {
 
    // Select algorithm (The choice of algorithm is a runtime option,
    // but we compile code for each algorithm, using templates)
 #ifdef WARPX_DIM_RZ
-    amrex::ignore_unused(Efield, Bfield, Jfield, Ffield, sigba, dt, pml_has_particles, edge_lengths);
+    amrex::ignore_unused(Efield, Bfield, Jfield, Ffield, sigba, dt, pml_has_particles, edge_lengths,
+                         fused_damping);
     amrex::Abort(Utils::TextMsg::Err(
         "PML are not implemented in cylindrical geometry."));
 #else
     if (m_do_nodal) {
 
         EvolveEPMLCartesian <CartesianNodalAlgorithm> (
-            Efield, Bfield, Jfield, edge_lengths, Ffield, sigba, dt, pml_has_particles );
+            Efield, Bfield, Jfield, edge_lengths, Ffield, sigba, dt, pml_has_particles,
+            fused_damping );
 
     } else if (m_fdtd_algo == MaxwellSolverAlgo::Yee || m_fdtd_algo == MaxwellSolverAlgo::ECT) {
 
         EvolveEPMLCartesian <CartesianYeeAlgorithm> (
-            Efield, Bfield, Jfield,  edge_lengths, Ffield, sigba, dt, pml_has_particles );
+            Efield, Bfield, Jfield,  edge_lengths, Ffield, sigba, dt, pml_has_particles,
+            fused_damping );
 
     } else if (m_fdtd_algo == MaxwellSolverAlgo::CKC) {
 
         EvolveEPMLCartesian <CartesianCKCAlgorithm> (
-            Efield, Bfield, Jfield,  edge_lengths, Ffield, sigba, dt, pml_has_particles );
+            Efield, Bfield, Jfield,  edge_lengths, Ffield, sigba, dt, pml_has_particles,
+            fused_damping );
 
     } else {
         amrex::Abort(Utils::TextMsg::Err("EvolveEPML: Unknown algorithm"));
@@ -91,14 +98,23 @@ void FiniteDifferenceSolver::EvolveEPMLCartesian (
     std::array< amrex::MultiFab*, 3 > const edge_lengths,
     amrex::MultiFab* const Ffield,
     MultiSigmaBox const& sigba,
-    amrex::Real const dt, bool pml_has_particles ) {
+    amrex::Real const dt, bool pml_has_particles,
+    const bool fused_damping ) {
 
     Real c2 = PhysConst::c * PhysConst::c;
 
 #ifdef WARPX_MAG_LLG
-    c2 *= PhysConst::mu0;
+    // with the LLG solver, Bfield holds H
+    if (WarpX::mag_LLG) c2 *= PhysConst::mu0;
 #endif
 
+    // Staggering of the fields, for the damping fused into the update
+    // (only used without F and without particles in the PML, which update E after this kernel)
+    bool const damp = fused_damping;
+    amrex::IntVect const Ex_stag = Efield[0]->ixType().toIntVect();
+    amrex::IntVect const Ey_stag = Efield[1]->ixType().toIntVect();
+    amrex::IntVect const Ez_stag = Efield[2]->ixType().toIntVect();
+
     // Loop through the grids, and over the tiles within each grid
 #ifdef AMREX_USE_OMP
 #pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
@@ -127,6 +143,9 @@ void FiniteDifferenceSolver::EvolveEPMLCartesian (
         Real const * const AMREX_RESTRICT coefs_z = m_stencil_coefs_z.dataPtr();
         int const n_coefs_z = m_stencil_coefs_z.size();
 
+        // Damping factors of this box
+        PMLDampFactors const f = damp ? GetPMLDampFactors(sigba[mfi]) : PMLDampFactors{};
+
         // Extract tileboxes for which to loop
         Box const& tex  = mfi.tilebox(Efield[0]->ixType().ixType());
         Box const& tey  = mfi.tilebox(Efield[1]->ixType().ixType());
@@ -146,6 +165,10 @@ void FiniteDifferenceSolver::EvolveEPMLCartesian (
                 Ex(i, j, k, PMLComp::xy) += c2 * dt * (
                     T_Algo::DownwardDy(Bz, coefs_y, n_coefs_y, i, j, k, PMLComp::zx)
                   + T_Algo::DownwardDy(Bz, coefs_y, n_coefs_y, i, j, k, PMLComp::zy) );
+                if (damp) {
+                    warpx_damp_pml_ex(i, j, k, Ex, Ex_stag, f.sigma_fac_x, f.sigma_fac_y, f.sigma_fac_z,
+                        f.sigma_star_fac_x, f.sigma_star_fac_y, f.sigma_star_fac_z, f.xlo, f.ylo, f.zlo, false);
+                }
             },
 
             [=] AMREX_GPU_DEVICE (int i, int j, int k){
@@ -159,6 +182,10 @@ void FiniteDifferenceSolver::EvolveEPMLCartesian (
                 Ey(i, j, k, PMLComp::yz) += c2 * dt * (
                     T_Algo::DownwardDz(Bx, coefs_z, n_coefs_z, i, j, k, PMLComp::xy)
                   + T_Algo::DownwardDz(Bx, coefs_z, n_coefs_z, i, j, k, PMLComp::xz) );
+                if (damp) {
+                    warpx_damp_pml_ey(i, j, k, Ey, Ey_stag, f.sigma_fac_x, f.sigma_fac_y, f.sigma_fac_z,
+                        f.sigma_star_fac_x, f.sigma_star_fac_y, f.sigma_star_fac_z, f.xlo, f.ylo, f.zlo, false);
+                }
             },
 
             [=] AMREX_GPU_DEVICE (int i, int j, int k){
@@ -172,6 +199,10 @@ void FiniteDifferenceSolver::EvolveEPMLCartesian (
                 Ez(i, j, k, PMLComp::zx) += c2 * dt * (
                     T_Algo::DownwardDx(By, coefs_x, n_coefs_x, i, j, k, PMLComp::yx)
                   + T_Algo::DownwardDx(By, coefs_x, n_coefs_x, i, j, k, PMLComp::yz) );
+                if (damp) {
+                    warpx_damp_pml_ez(i, j, k, Ez, Ez_stag, f.sigma_fac_x, f.sigma_fac_y, f.sigma_fac_z,
+                        f.sigma_star_fac_x, f.sigma_star_fac_y, f.sigma_star_fac_z, f.xlo, f.ylo, f.zlo, false);
+                }
             }
 
         );
@@ -14,7 +14,11 @@
 #   include "FieldSolver/FiniteDifferenceSolver/FiniteDifferenceAlgorithms/CartesianCKCAlgorithm.H"
 #   include "FieldSolver/FiniteDifferenceSolver/FiniteDifferenceAlgorithms/CartesianNodalAlgorithm.H"
 #endif
+#include "BoundaryConditions/PML.H"
 #include "BoundaryConditions/PMLComponent.H"
+#include "BoundaryConditions/WarpX_CPML_kernels.H"
+#include "BoundaryConditions/WarpX_PML_kernels.H"
+#include "ablastr/profiler/ProfilerWrapper.H"
 #include <AMReX_Gpu.H>
 #include <AMReX_MultiFab.H>
 #include <AMReX.H>
@@ -29,25 +33,40 @@ void FiniteDifferenceSolver::EvolveHPML (
     std::array< amrex::MultiFab*, 3 > Hfield,
     std::array< amrex::MultiFab*, 3 > const Efield,
     amrex::Real const dt,
-    const bool dive_cleaning) {
+    const bool dive_cleaning,
+    MultiSigmaBox const& sigba,
+    CPMLPsi* cpml_psi,
+    const bool fused_damping) {
 
    // Select algorithm (The choice of algorithm is a runtime option,
    // but we compile code for each algorithm, using templates)
 #ifdef WARPX_DIM_RZ
-    amrex::ignore_unused(Hfield, Efield, dt, dive_cleaning);
+    amrex::ignore_unused(Hfield, Efield, dt, dive_cleaning, sigba, cpml_psi, fused_damping);
     amrex::Abort("PML are not implemented in cylindrical geometry.");
 #else
-    if (m_do_nodal) {
+    // Damping of the split fields fused into the update (warpx.do_pml_fused_damping)
+    MultiSigmaBox const* damp_sigba = fused_damping ? &sigba : nullptr;
 
-        EvolveHPMLCartesian <CartesianNodalAlgorithm> (Hfield, Efield, dt, dive_cleaning);
+    if (cpml_psi) {
+
+        // The CPML is only allocated for the staggered Yee and CKC solvers
+        if (m_fdtd_algo == MaxwellSolverAlgo::Yee) {
+            EvolveHCPMLCartesian <CartesianYeeAlgorithm> (Hfield, Efield, sigba, dt, *cpml_psi);
+        } else {
+            EvolveHCPMLCartesian <CartesianCKCAlgorithm> (Hfield, Efield, sigba, dt, *cpml_psi);
+        }
+
+    } else if (m_do_nodal) {
+
+        EvolveHPMLCartesian <CartesianNodalAlgorithm> (Hfield, Efield, dt, dive_cleaning, damp_sigba);
 
     } else if (m_fdtd_algo == MaxwellSolverAlgo::Yee) {
 
-        EvolveHPMLCartesian <CartesianYeeAlgorithm> (Hfield, Efield, dt, dive_cleaning);
+        EvolveHPMLCartesian <CartesianYeeAlgorithm> (Hfield, Efield, dt, dive_cleaning, damp_sigba);
 
     } else if (m_fdtd_algo == MaxwellSolverAlgo::CKC) {
 
-        EvolveHPMLCartesian <CartesianCKCAlgorithm> (Hfield, Efield, dt, dive_cleaning);
+        EvolveHPMLCartesian <CartesianCKCAlgorithm> (Hfield, Efield, dt, dive_cleaning, damp_sigba);
 
     } else {
         amrex::Abort("EvolveHPML: Unknown algorithm");
@@ -61,7 +80,17 @@ void FiniteDifferenceSolver::EvolveHPMLCartesian (
     std::array< amrex::MultiFab*, 3 > Hfield,
     std::array< amrex::MultiFab*, 3 > const Efield,
     amrex::Real const dt,
-    const bool dive_cleaning) {
+    const bool dive_cleaning,
+    MultiSigmaBox const* damp_sigba) {
+
+    // Staggering of the fields, for the damping fused into the update
+    bool const damp = (damp_sigba != nullptr);
+    amrex::IntVect const Hx_stag = Hfield[0]->ixType().toIntVect();
+    amrex::IntVect const Hy_stag = Hfield[1]->ixType().toIntVect();
+    amrex::IntVect const Hz_stag = Hfield[2]->ixType().toIntVect();
+
+    // hardware counters or GPU profiler range of the H update (WarpX_KERNEL_COUNTERS)
+    ABLASTR_KERNEL_RANGE("EvolveHPMLCartesian");
 
     // Loop through the grids, and over the tiles within each grid
 #ifdef AMREX_USE_OMP
@@ -85,6 +114,9 @@ void FiniteDifferenceSolver::EvolveHPMLCartesian (
         Real const * const AMREX_RESTRICT coefs_z = m_stencil_coefs_z.dataPtr();
         int const n_coefs_z = m_stencil_coefs_z.size();
 
+        // Damping factors of this box
+        PMLDampFactors const f = damp ? GetPMLDampFactors((*damp_sigba)[mfi]) : PMLDampFactors{};
+
         // Extract tileboxes for which to loop
         Box const& tbx  = mfi.tilebox(Hfield[0]->ixType().ixType());
         Box const& tby  = mfi.tilebox(Hfield[1]->ixType().ixType());
@@ -114,6 +146,10 @@ void FiniteDifferenceSolver::EvolveHPMLCartesian (
                     T_Algo::UpwardDy(Ez, coefs_y, n_coefs_y, i, j, k, PMLComp::zx)
                   + T_Algo::UpwardDy(Ez, coefs_y, n_coefs_y, i, j, k, PMLComp::zy)
                   + UpwardDy_Ez_zz);
+                if (damp) {
+                    warpx_damp_pml_bx(i, j, k, Hx, Hx_stag, f.sigma_fac_x, f.sigma_fac_y, f.sigma_fac_z,
+                        f.sigma_star_fac_x, f.sigma_star_fac_y, f.sigma_star_fac_z, f.xlo, f.ylo, f.zlo, false);
+                }
             },
 
             [=] AMREX_GPU_DEVICE (int i, int j, int k){
@@ -135,6 +171,10 @@ void FiniteDifferenceSolver::EvolveHPMLCartesian (
                     UpwardDz_Ex_xx
                   + T_Algo::UpwardDz(Ex, coefs_z, n_coefs_z, i, j, k, PMLComp::xy)
                   + T_Algo::UpwardDz(Ex, coefs_z, n_coefs_z, i, j, k, PMLComp::xz));
+                if (damp) {
+                    warpx_damp_pml_by(i, j, k, Hy, Hy_stag, f.sigma_fac_x, f.sigma_fac_y, f.sigma_fac_z,
+                        f.sigma_star_fac_x, f.sigma_star_fac_y, f.sigma_star_fac_z, f.xlo, f.ylo, f.zlo, false);
+                }
             },
 
             [=] AMREX_GPU_DEVICE (int i, int j, int k){
@@ -156,6 +196,95 @@ void FiniteDifferenceSolver::EvolveHPMLCartesian (
                     T_Algo::UpwardDx(Ey, coefs_x, n_coefs_x, i, j, k, PMLComp::yx)
                   + T_Algo::UpwardDx(Ey, coefs_x, n_coefs_x, i, j, k, PMLComp::yz)
                   + UpwardDx_Ey_yy);
+                if (damp) {
+                    warpx_damp_pml_bz(i, j, k, Hz, Hz_stag, f.sigma_fac_x, f.sigma_fac_y, f.sigma_fac_z,
+                        f.sigma_star_fac_x, f.sigma_star_fac_y, f.sigma_star_fac_z, f.xlo, f.ylo, f.zlo, false);
+                }
+            }
+
+        );
+
+    }
+
+}
+
+
+/**
+ * \brief Update the unsplit H field in the CPML, over one timestep: the derivatives of E
+ * along the directions normal to the layers are stretched with their auxiliary variables psi
+ */
+template<typename T_Algo>
+void FiniteDifferenceSolver::EvolveHCPMLCartesian (
+    std::array< amrex::MultiFab*, 3 > Hfield,
+    std::array< amrex::MultiFab*, 3 > const Efield,
+    MultiSigmaBox const& sigba,
+    amrex::Real const dt,
+    CPMLPsi& cpml_psi) {
+
+    amrex::GpuArray<int, 3> const Hx_stag = GetCPMLStaggering(*Hfield[0]);
+    amrex::GpuArray<int, 3> const Hy_stag = GetCPMLStaggering(*Hfield[1]);
+    amrex::GpuArray<int, 3> const Hz_stag = GetCPMLStaggering(*Hfield[2]);
+
+    ABLASTR_KERNEL_RANGE("EvolveHCPMLCartesian");
+
+    // Loop through the grids, and over the tiles within each grid
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#endif
+    for ( MFIter mfi(*Hfield[0], TilingIfNotGPU()); mfi.isValid(); ++mfi ) {
+
+        // Extract field data for this grid/tile
+        Array4<Real> const& Hx = Hfield[0]->array(mfi);
+        Array4<Real> const& Hy = Hfield[1]->array(mfi);
+        Array4<Real> const& Hz = Hfield[2]->array(mfi);
+        Array4<Real> const& Ex = Efield[0]->array(mfi);
+        Array4<Real> const& Ey = Efield[1]->array(mfi);
+        Array4<Real> const& Ez = Efield[2]->array(mfi);
+
+        // Damping coefficients and auxiliary variables of this box
+        CPMLSigma const s = GetCPMLSigma(sigba[mfi]);
+        CPMLPsiArrays const p = GetCPMLPsiArrays(cpml_psi, mfi.index());
+
+        // Extract stencil coefficients
+        Real const * const AMREX_RESTRICT coefs_x = m_stencil_coefs_x.dataPtr();
+        int const n_coefs_x = m_stencil_coefs_x.size();
+        Real const * const AMREX_RESTRICT coefs_y = m_stencil_coefs_y.dataPtr();
+        int const n_coefs_y = m_stencil_coefs_y.size();
+        Real const * const AMREX_RESTRICT coefs_z = m_stencil_coefs_z.dataPtr();
+        int const n_coefs_z = m_stencil_coefs_z.size();
+
+        // Extract tileboxes for which to loop
+        Box const& tbx  = mfi.tilebox(Hfield[0]->ixType().ixType());
+        Box const& tby  = mfi.tilebox(Hfield[1]->ixType().ixType());
+        Box const& tbz  = mfi.tilebox(Hfield[2]->ixType().ixType());
+
+        amrex::Real mu0_inv = 1._rt/PhysConst::mu0;
+
+        // Loop over the cells and update the fields
+        amrex::ParallelFor(tbx, tby, tbz,
+
+            [=] AMREX_GPU_DEVICE (int i, int j, int k){
+                Real const dz_Ey = cpml_derivative(p.psi[2][0], s, 2, Hx_stag[2], i, j, k, dt,
+                    T_Algo::UpwardDz(Ey, coefs_z, n_coefs_z, i, j, k, 0));
+                Real const dy_Ez = cpml_derivative(p.psi[1][0], s, 1, Hx_stag[1], i, j, k, dt,
+                    T_Algo::UpwardDy(Ez, coefs_y, n_coefs_y, i, j, k, 0));
+                Hx(i, j, k) += mu0_inv * dt * (dz_Ey - dy_Ez);
+            },
+
+            [=] AMREX_GPU_DEVICE (int i, int j, int k){
+                Real const dx_Ez = cpml_derivative(p.psi[0][1], s, 0, Hy_stag[0], i, j, k, dt,
+                    T_Algo::UpwardDx(Ez, coefs_x, n_coefs_x, i, j, k, 0));
+                Real const dz_Ex = cpml_derivative(p.psi[2][1], s, 2, Hy_stag[2], i, j, k, dt,
+                    T_Algo::UpwardDz(Ex, coefs_z, n_coefs_z, i, j, k, 0));
+                Hy(i, j, k) += mu0_inv * dt * (dx_Ez - dz_Ex);
+            },
+
+            [=] AMREX_GPU_DEVICE (int i, int j, int k){
+                Real const dy_Ex = cpml_derivative(p.psi[1][2], s, 1, Hz_stag[1], i, j, k, dt,
+                    T_Algo::UpwardDy(Ex, coefs_y, n_coefs_y, i, j, k, 0));
+                Real const dx_Ey = cpml_derivative(p.psi[0][2], s, 0, Hz_stag[0], i, j, k, dt,
+                    T_Algo::UpwardDx(Ey, coefs_x, n_coefs_x, i, j, k, 0));
+                Hz(i, j, k) += mu0_inv * dt * (dy_Ex - dx_Ey);
             }
 
         );
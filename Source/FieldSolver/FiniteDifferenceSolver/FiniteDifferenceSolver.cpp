@@ -15,12 +15,17 @@
 #endif
 #include "Utils/TextMsg.H"
 #include "Utils/WarpXAlgorithmSelection.H"
-#ifdef WARPX_DIM_RZ
-#   include "WarpX.H"
-#endif
+#include "WarpX.H"
 
 #include <AMReX.H>
+#include <AMReX_Box.H>
+#include <AMReX_Geometry.H>
+#include <AMReX_GpuControl.H>
 #include <AMReX_GpuDevice.H>
+#include <AMReX_IndexType.H>
+#include <AMReX_IntVect.H>
+#include <AMReX_LayoutData.H>
+#include <AMReX_MFIter.H>
 #include <AMReX_PODVector.H>
 #include <AMReX_Vector.H>
 
@@ -30,7 +35,8 @@
 FiniteDifferenceSolver::FiniteDifferenceSolver (
     int const fdtd_algo,
     std::array<amrex::Real,3> cell_size,
-    bool do_nodal ) {
+    bool do_nodal,
+    GradedMesh const* graded_mesh ) {
 
     // Register the type of finite-difference algorithm
     m_fdtd_algo = fdtd_algo;
@@ -42,6 +48,7 @@ FiniteDifferenceSolver::FiniteDifferenceSolver (
 
     // Calculate coefficients of finite-difference stencil
 #ifdef WARPX_DIM_RZ
+    amrex::ignore_unused(graded_mesh);
     m_dr = cell_size[0];
     m_nmodes = WarpX::GetInstance().n_rz_azimuthal_modes;
     m_rmin = WarpX::GetInstance().Geom(0).ProbLo(0);
@@ -70,7 +77,7 @@ FiniteDifferenceSolver::FiniteDifferenceSolver (
     } else if (fdtd_algo == MaxwellSolverAlgo::Yee || fdtd_algo == MaxwellSolverAlgo::ECT) {
 
         CartesianYeeAlgorithm::InitializeStencilCoefficients( cell_size,
-            m_h_stencil_coefs_x, m_h_stencil_coefs_y, m_h_stencil_coefs_z );
+            m_h_stencil_coefs_x, m_h_stencil_coefs_y, m_h_stencil_coefs_z, graded_mesh );
 
     } else if (fdtd_algo == MaxwellSolverAlgo::CKC) {
 
@@ -98,3 +105,81 @@ FiniteDifferenceSolver::FiniteDifferenceSolver (
     amrex::Gpu::synchronize();
 #endif
 }
+
+amrex::Box
+FiniteDifferenceSolver::UpdateBox (amrex::MFIter const& mfi, amrex::IndexType ixtype,
+                                   int ng_update, int lev)
+{
+    if (ng_update == 0) return mfi.tilebox(ixtype.toIntVect());
+    return mfi.tilebox(ixtype.toIntVect(), amrex::IntVect(ng_update))
+        & UpdateDomain(ixtype, ng_update, lev);
+}
+
+amrex::Box
+FiniteDifferenceSolver::UpdateDomain (amrex::IndexType ixtype, int ng_update, int lev)
+{
+    // The guard cells beyond the non-periodic boundaries are set by the boundary conditions
+    amrex::Geometry const& geom = WarpX::GetInstance().Geom(lev);
+    amrex::Box domain = amrex::convert(geom.Domain(), ixtype);
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        if (geom.isPeriodic(idim)) domain.grow(idim, ng_update);
+    }
+    return domain;
+}
+
+bool
+FiniteDifferenceSolver::FusedBoxLaunch (int lev)
+{
+#ifdef AMREX_USE_EB
+    // the tiles are classified by their embedded boundaries, see EBTileType
+    amrex::ignore_unused(lev);
+    return false;
+#else
+    amrex::LayoutData<amrex::Real> const* cost = WarpX::getCosts(lev);
+    // static data in managed memory is streamed through the device box by box, see StaticDataPrefetcher
+    return amrex::Gpu::inLaunchRegion()
+        && !(cost && WarpX::load_balance_costs_update_algo == LoadBalanceCostsUpdateAlgo::Timers)
+        && WarpX::static_data_memory != "managed";
+#endif
+}
+
+#ifdef AMREX_USE_EB
+amrex::FabArray<amrex::EBCellFlagFab> const*
+FiniteDifferenceSolver::EBCellFlags (amrex::MultiFab const& mf, int lev)
+{
+    auto const& eb_fact = WarpX::GetInstance().fieldEBFactory(lev);
+    auto const& flags = eb_fact.getMultiEBCellFlagFab();
+    if (!mf.boxArray().CellEqual(flags.boxArray()) ||
+        mf.DistributionMap() != flags.DistributionMap()) return nullptr;
+    return &flags;
+}
+
+amrex::FabType
+FiniteDifferenceSolver::EBTileType (amrex::FabArray<amrex::EBCellFlagFab> const* flags,
+                                    amrex::MFIter const& mfi, amrex::Box const& bx,
+                                    amrex::Box const& by, amrex::Box const& bz)
+{
+    if (flags == nullptr) return amrex::FabType::singlevalued;
+
+    amrex::EBCellFlagFab const& flag_fab = (*flags)[mfi];
+    // The boxes are grown by one cell, so that all the cells touching their edges and faces,
+    // and those of the in-plane neighbors of the faces (which can be intruded by the ECT
+    // extensions), are checked
+    amrex::Box const gbx = amrex::grow(bx, 1);
+    amrex::Box const gby = amrex::grow(by, 1);
+    amrex::Box const gbz = amrex::grow(bz, 1);
+    // the grown boxes can extend into guard cells that the flags do not cover
+    if (!flag_fab.box().contains(amrex::enclosedCells(gbx)) ||
+        !flag_fab.box().contains(amrex::enclosedCells(gby)) ||
+        !flag_fab.box().contains(amrex::enclosedCells(gbz))) {
+        return amrex::FabType::singlevalued;
+    }
+
+    amrex::FabType const tx = flag_fab.getType(gbx);
+    if (tx != amrex::FabType::regular && tx != amrex::FabType::covered) return tx;
+    if (flag_fab.getType(gby) != tx || flag_fab.getType(gbz) != tx) {
+        return amrex::FabType::singlevalued;
+    }
+    return tx;
+}
+#endif
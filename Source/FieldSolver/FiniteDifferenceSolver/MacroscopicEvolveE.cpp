@@ -7,12 +7,17 @@
 #   include "FiniteDifferenceAlgorithms/CartesianCKCAlgorithm.H"
 #   include "FiniteDifferenceAlgorithms/FieldAccessorFunctors.H"
 #endif
+#include "FieldSolver/LumpedElements.H"
 #include "MacroscopicProperties/MacroscopicProperties.H"
+#include "Parallelization/CostsBreakdown.H"
 #include "Utils/CoarsenIO.H"
+#include "Utils/GradedMesh.H"
+#include "Utils/StaticDataMemory.H"
 #include "Utils/TextMsg.H"
 #include "Utils/WarpXAlgorithmSelection.H"
 #include "Utils/WarpXUtil.H"
 #include "WarpX.H"
+#include "ablastr/profiler/ProfilerWrapper.H"
 
 #include <AMReX.H>
 #include <AMReX_Array4.H>
@@ -22,65 +27,152 @@
 #include <AMReX_GpuControl.H>
 #include <AMReX_GpuLaunch.H>
 #include <AMReX_GpuQualifiers.H>
+#include <AMReX_iMultiFab.H>
 #include <AMReX_IndexType.H>
+#include <AMReX_IntVect.H>
+#include <AMReX_LayoutData.H>
 #include <AMReX_MFIter.H>
 #include <AMReX_MultiFab.H>
+#include <AMReX_ParallelDescriptor.H>
 #include <AMReX_REAL.H>
+#include <AMReX_Reduce.H>
 
 #include <AMReX_BaseFwd.H>
 
 #include <array>
+#include <cmath>
 #include <memory>
 
 using namespace amrex;
 
+#ifndef WARPX_DIM_RZ
+namespace
+{
+    /** Advance the polarization of a dispersive material at (i,j,k) from P^n (component 0 of P)
+     *  to P^(n+1) = c0 E^n + c1 P^n + c2 P^(n-1), see FiniteDifferenceSolver::ComputeDispersionCoefs,
+     *  and return the polarization current (P^(n+1) - P^n) / dt */
+    AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
+    amrex::Real AdvancePolarization (int i, int j, int k, amrex::Real E,
+                                     amrex::Array4<amrex::Real> const& P,
+                                     amrex::Array4<amrex::Real const> const& coefs,
+                                     amrex::Real inv_dt)
+    {
+        amrex::Real const P_n = P(i, j, k, 0);
+        amrex::Real const P_new = coefs(i, j, k, 0) * E + coefs(i, j, k, 1) * P_n
+                                + coefs(i, j, k, 2) * P(i, j, k, 1);
+        P(i, j, k, 1) = P_n;
+        P(i, j, k, 0) = P_new;
+        return (P_new - P_n) * inv_dt;
+    }
+
+    /** Index dimension of the direction dir (0, 1 or 2 for x, y, z), -1 if invariant */
+    AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
+    int IndexDim (int dir)
+    {
+#if defined(WARPX_DIM_3D)
+        return dir;
+#elif defined(WARPX_DIM_XZ) || defined(WARPX_DIM_RZ)
+        return (dir == 0) ? 0 : ((dir == 2) ? 1 : -1);
+#else
+        return (dir == 2) ? 0 : -1;
+#endif
+    }
+
+    /** Direction (0, 1 or 2 for x, y, z) of the index dimension idim */
+    AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
+    int PhysicalDim (int idim)
+    {
+#if defined(WARPX_DIM_3D)
+        return idim;
+#elif defined(WARPX_DIM_XZ) || defined(WARPX_DIM_RZ)
+        return (idim == 0) ? 0 : 2;
+#else
+        amrex::ignore_unused(idim);
+        return 2;
+#endif
+    }
+
+    /** E along dir at (i,j,k) on the surface of a surface-impedance conductor, w1 H_d1 + w2 H_d2
+     *  (see FiniteDifferenceSolver::ComputeSurfaceImpedanceCoefs). H_d1 is half a cell away from E
+     *  along d2, and H_d2 along d1: the values on the outer side of the conductor are used. */
+    template <typename T_H1, typename T_H2>
+    AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
+    amrex::Real SurfaceImpedanceE (int i, int j, int k, int dir,
+                                   amrex::Array4<amrex::Real const> const& sibc,
+                                   T_H1 const& H1, T_H2 const& H2)
+    {
+        amrex::Real const w1 = sibc(i, j, k, 1);
+        amrex::Real const w2 = sibc(i, j, k, 2);
+        int const e1 = IndexDim((dir + 1) % 3);
+        int const e2 = IndexDim((dir + 2) % 3);
+        // w1 = Rs n_d2 and w2 = -Rs n_d1, the conductor is on the lower side if n_d < 0
+        int s1[3] = {0, 0, 0};
+        int s2[3] = {0, 0, 0};
+        if (w1 > 0._rt && e2 >= 0) s1[e2] = 1;
+        if (w2 < 0._rt && e1 >= 0) s2[e1] = 1;
+        return w1 * H1(i - s1[0], j - s1[1], k - s1[2], 0) + w2 * H2(i - s2[0], j - s2[1], k - s2[2], 0);
+    }
+}
+#endif
+
 void FiniteDifferenceSolver::MacroscopicEvolveE (
+    int lev,
     std::array< std::unique_ptr<amrex::MultiFab>, 3 >& Efield,
-#ifndef WARPX_MAG_LLG
     std::array< std::unique_ptr<amrex::MultiFab>, 3 > const& Bfield,
-#else
-    std::array< std::unique_ptr<amrex::MultiFab>, 3 > const& Hfield,
-#endif
     std::array< std::unique_ptr<amrex::MultiFab>, 3 > const& Jfield,
     std::array< std::unique_ptr<amrex::MultiFab>, 3 > const& edge_lengths,
     amrex::Real const dt,
-    std::unique_ptr<MacroscopicProperties> const& macroscopic_properties)
+    std::unique_ptr<MacroscopicProperties> const& macroscopic_properties,
+    int ng_update)
 {
 
    // Select algorithm (The choice of algorithm is a runtime option,
    // but we compile code for each algorithm, using templates)
 #ifdef WARPX_DIM_RZ
-#    ifndef WARPX_MAG_LLG
-    amrex::ignore_unused(Efield, Bfield, Jfield, edge_lengths, dt, macroscopic_properties);
-#    else
-    amrex::ignore_unused(Efield, Hfield, Jfield, edge_lengths, dt, macroscopic_properties);
-#endif
+    amrex::ignore_unused(lev, Efield, Bfield, Jfield, edge_lengths, dt, macroscopic_properties, ng_update);
     amrex::Abort(Utils::TextMsg::Err(
         "currently macro E-push does not work for RZ"));
 #else
     WARPX_ALWAYS_ASSERT_WITH_MESSAGE(
         !m_do_nodal, "macro E-push does not work for nodal");
 
+    // with the LLG solver (warpx.mag_LLG), Bfield holds H, which is used as is in the update
+#ifdef WARPX_MAG_LLG
+    bool const H_field = WarpX::mag_LLG;
+#else
+    bool const H_field = false;
+#endif
 
-    if (m_fdtd_algo == MaxwellSolverAlgo::Yee) {
+    // the E update of ECT is the Yee update on the edges that are not covered by the embedded boundary
+    if (m_fdtd_algo == MaxwellSolverAlgo::Yee || m_fdtd_algo == MaxwellSolverAlgo::ECT) {
 
         if (WarpX::macroscopic_solver_algo == MacroscopicSolverAlgo::LaxWendroff) {
 
-            MacroscopicEvolveECartesian <CartesianYeeAlgorithm, LaxWendroffAlgo>
-#ifndef WARPX_MAG_LLG
-                       ( Efield, Bfield, Jfield, edge_lengths, dt, macroscopic_properties);
-#else
-                       ( Efield, Hfield, Jfield, edge_lengths, dt, macroscopic_properties);
-#endif
+            if (H_field) {
+                WithStencilCoefs<CartesianYeeAlgorithm>([&] (auto const& stencil) {
+                    MacroscopicEvolveECartesian <CartesianYeeAlgorithm, LaxWendroffAlgo, true>
+                        ( lev, Efield, Bfield, Jfield, edge_lengths, dt, macroscopic_properties, ng_update, stencil);
+                });
+            } else {
+                WithStencilCoefs<CartesianYeeAlgorithm>([&] (auto const& stencil) {
+                    MacroscopicEvolveECartesian <CartesianYeeAlgorithm, LaxWendroffAlgo, false>
+                        ( lev, Efield, Bfield, Jfield, edge_lengths, dt, macroscopic_properties, ng_update, stencil);
+                });
+            }
         }
         if (WarpX::macroscopic_solver_algo == MacroscopicSolverAlgo::BackwardEuler) {
 
-            MacroscopicEvolveECartesian <CartesianYeeAlgorithm, BackwardEulerAlgo>
-#ifndef WARPX_MAG_LLG
-                       ( Efield, Bfield, Jfield, edge_lengths, dt, macroscopic_properties);
-#else
-                       ( Efield, Hfield, Jfield, edge_lengths, dt, macroscopic_properties);
-#endif
+            if (H_field) {
+                WithStencilCoefs<CartesianYeeAlgorithm>([&] (auto const& stencil) {
+                    MacroscopicEvolveECartesian <CartesianYeeAlgorithm, BackwardEulerAlgo, true>
+                        ( lev, Efield, Bfield, Jfield, edge_lengths, dt, macroscopic_properties, ng_update, stencil);
+                });
+            } else {
+                WithStencilCoefs<CartesianYeeAlgorithm>([&] (auto const& stencil) {
+                    MacroscopicEvolveECartesian <CartesianYeeAlgorithm, BackwardEulerAlgo, false>
+                        ( lev, Efield, Bfield, Jfield, edge_lengths, dt, macroscopic_properties, ng_update, stencil);
+                });
+            }
 
         }
 
@@ -90,20 +182,30 @@ void FiniteDifferenceSolver::MacroscopicEvolveE (
         // In the templated Yee and CKC calls, the core operations for EvolveE is the same.
         if (WarpX::macroscopic_solver_algo == MacroscopicSolverAlgo::LaxWendroff) {
 
-            MacroscopicEvolveECartesian <CartesianCKCAlgorithm, LaxWendroffAlgo>
-#ifndef WARPX_MAG_LLG
-                       ( Efield, Bfield, Jfield, edge_lengths, dt, macroscopic_properties);
-#else
-                       ( Efield, Hfield, Jfield, edge_lengths, dt, macroscopic_properties);
-#endif
+            if (H_field) {
+                WithStencilCoefs<CartesianCKCAlgorithm>([&] (auto const& stencil) {
+                    MacroscopicEvolveECartesian <CartesianCKCAlgorithm, LaxWendroffAlgo, true>
+                        ( lev, Efield, Bfield, Jfield, edge_lengths, dt, macroscopic_properties, ng_update, stencil);
+                });
+            } else {
+                WithStencilCoefs<CartesianCKCAlgorithm>([&] (auto const& stencil) {
+                    MacroscopicEvolveECartesian <CartesianCKCAlgorithm, LaxWendroffAlgo, false>
+                        ( lev, Efield, Bfield, Jfield, edge_lengths, dt, macroscopic_properties, ng_update, stencil);
+                });
+            }
         } else if (WarpX::macroscopic_solver_algo == MacroscopicSolverAlgo::BackwardEuler) {
 
-            MacroscopicEvolveECartesian <CartesianCKCAlgorithm, BackwardEulerAlgo>
-#ifndef WARPX_MAG_LLG
-                       ( Efield, Bfield, Jfield, edge_lengths, dt, macroscopic_properties);
-#else
-                       ( Efield, Hfield, Jfield, edge_lengths, dt, macroscopic_properties);
-#endif
+            if (H_field) {
+                WithStencilCoefs<CartesianCKCAlgorithm>([&] (auto const& stencil) {
+                    MacroscopicEvolveECartesian <CartesianCKCAlgorithm, BackwardEulerAlgo, true>
+                        ( lev, Efield, Bfield, Jfield, edge_lengths, dt, macroscopic_properties, ng_update, stencil);
+                });
+            } else {
+                WithStencilCoefs<CartesianCKCAlgorithm>([&] (auto const& stencil) {
+                    MacroscopicEvolveECartesian <CartesianCKCAlgorithm, BackwardEulerAlgo, false>
+                        ( lev, Efield, Bfield, Jfield, edge_lengths, dt, macroscopic_properties, ng_update, stencil);
+                });
+            }
         }
 
     } else {
@@ -114,46 +216,174 @@ void FiniteDifferenceSolver::MacroscopicEvolveE (
 #endif
 }
 
+void FiniteDifferenceSolver::MacroscopicLumpedElements (
+    std::array< std::unique_ptr<amrex::MultiFab>, 3 > const& Efield,
+    std::array< std::unique_ptr<amrex::MultiFab>, 3 > const& Bfield,
+    std::array< std::unique_ptr<amrex::MultiFab>, 3 > const& Jfield,
+    amrex::Real const dt, amrex::Real const t,
+    std::unique_ptr<MacroscopicProperties> const& macroscopic_properties,
+    LumpedElements& lumped_elements)
+{
+#ifdef WARPX_DIM_RZ
+    amrex::ignore_unused(Efield, Bfield, Jfield, dt, t, macroscopic_properties, lumped_elements);
+    amrex::Abort(Utils::TextMsg::Err(
+        "the lumped elements do not work for RZ"));
+#else
+#ifdef WARPX_MAG_LLG
+    bool const H_field = WarpX::mag_LLG;
+#else
+    bool const H_field = false;
+#endif
+    // the curl of H of the edges is the one of the E update
+    if (m_fdtd_algo == MaxwellSolverAlgo::Yee || m_fdtd_algo == MaxwellSolverAlgo::ECT) {
+        if (H_field) {
+            MacroscopicLumpedElementsCartesian<CartesianYeeAlgorithm, true>(
+                Efield, Bfield, Jfield, dt, t, macroscopic_properties, lumped_elements);
+        } else {
+            MacroscopicLumpedElementsCartesian<CartesianYeeAlgorithm, false>(
+                Efield, Bfield, Jfield, dt, t, macroscopic_properties, lumped_elements);
+        }
+    } else if (m_fdtd_algo == MaxwellSolverAlgo::CKC) {
+        if (H_field) {
+            MacroscopicLumpedElementsCartesian<CartesianCKCAlgorithm, true>(
+                Efield, Bfield, Jfield, dt, t, macroscopic_properties, lumped_elements);
+        } else {
+            MacroscopicLumpedElementsCartesian<CartesianCKCAlgorithm, false>(
+                Efield, Bfield, Jfield, dt, t, macroscopic_properties, lumped_elements);
+        }
+    } else {
+        amrex::Abort(Utils::TextMsg::Err(
+            "MacroscopicLumpedElements: Unknown algorithm"));
+    }
+#endif
+}
+
 
 #ifndef WARPX_DIM_RZ
 
-template<typename T_Algo, typename T_MacroAlgo>
+template<typename T_Algo, typename T_MacroAlgo, bool T_H_field, typename T_Coefs>
 void FiniteDifferenceSolver::MacroscopicEvolveECartesian (
+    int lev,
     std::array< std::unique_ptr<amrex::MultiFab>, 3 >& Efield,
-#ifndef WARPX_MAG_LLG
     std::array< std::unique_ptr<amrex::MultiFab>, 3 > const& Bfield,
-#else
-    std::array< std::unique_ptr<amrex::MultiFab>, 3 > const& Hfield,
-#endif
     std::array< std::unique_ptr<amrex::MultiFab>, 3 > const& Jfield,
     std::array< std::unique_ptr<amrex::MultiFab>, 3 > const& edge_lengths,
     amrex::Real const dt,
-    std::unique_ptr<MacroscopicProperties> const& macroscopic_properties)
+    std::unique_ptr<MacroscopicProperties> const& macroscopic_properties,
+    int ng_update,
+    StencilCoefs<T_Coefs> const& stencil)
 {
 #ifndef AMREX_USE_EB
     amrex::ignore_unused(edge_lengths);
 #endif
 
-    amrex::MultiFab& sigma_mf = macroscopic_properties->getsigma_mf();
-    amrex::MultiFab& epsilon_mf = macroscopic_properties->getepsilon_mf();
-#ifndef WARPX_MAG_LLG
     amrex::MultiFab& mu_mf = macroscopic_properties->getmu_mf();
+
+    // sigma, epsilon and dt are constant between the calls, so that alpha and beta are cached
+    ComputeMacroscopicECoefs<T_MacroAlgo>(Efield, dt, macroscopic_properties, ng_update);
+    bool const dispersion = macroscopic_properties->has_dispersion();
+    if (dispersion) ComputeDispersionCoefs(Efield, dt, macroscopic_properties);
+    bool const surface_impedance = macroscopic_properties->has_surface_impedance();
+    if (surface_impedance) ComputeSurfaceImpedanceCoefs(Efield, macroscopic_properties);
+    amrex::Real const inv_dt = 1._rt / dt;
+
+    amrex::LayoutData<amrex::Real>* cost = WarpX::getCosts(lev);
+
+#ifdef AMREX_USE_EB
+    auto const* eb_flags = EBCellFlags(*Efield[0], lev);
 #endif
 
-    // Index type required for calling CoarsenIO::Interp to interpolate macroscopic
-    // properties from their respective staggering to the Ex, Ey, Ez locations
-    amrex::GpuArray<int, 3> const& sigma_stag = macroscopic_properties->sigma_IndexType;
-    amrex::GpuArray<int, 3> const& epsilon_stag = macroscopic_properties->epsilon_IndexType;
-    amrex::GpuArray<int, 3> const& macro_cr     = macroscopic_properties->macro_cr_ratio;
-    amrex::GpuArray<int, 3> const& Ex_stag = macroscopic_properties->Ex_IndexType;
-    amrex::GpuArray<int, 3> const& Ey_stag = macroscopic_properties->Ey_IndexType;
-    amrex::GpuArray<int, 3> const& Ez_stag = macroscopic_properties->Ez_IndexType;
+    // hardware counters or GPU profiler range of the E update (WarpX_KERNEL_COUNTERS)
+    ABLASTR_KERNEL_RANGE("MacroscopicEvolveECartesian");
+
+    // Extract stencil coefficients, captured by value in the kernels
+    T_Coefs const coefs_x = stencil.coefs[0];
+    int const n_coefs_x = stencil.n_coefs[0];
+    T_Coefs const coefs_y = stencil.coefs[1];
+    int const n_coefs_y = stencil.n_coefs[1];
+    T_Coefs const coefs_z = stencil.coefs[2];
+    int const n_coefs_z = stencil.n_coefs[2];
+
+    // One kernel per component for all the boxes of the level. The polarization of the dispersive
+    // materials and the surface-impedance edges are only defined on some of the boxes, which are
+    // then updated box by box.
+    if (FusedBoxLaunch(lev) && !dispersion && !surface_impedance) {
+        auto const Ex = Efield[0]->arrays();
+        auto const Ey = Efield[1]->arrays();
+        auto const Ez = Efield[2]->arrays();
+        auto const jx = Jfield[0]->const_arrays();
+        auto const jy = Jfield[1]->const_arrays();
+        auto const jz = Jfield[2]->const_arrays();
+        auto const coefs_Ex = m_macro_E_coefs[0]->const_arrays();
+        auto const coefs_Ey = m_macro_E_coefs[1]->const_arrays();
+        auto const coefs_Ez = m_macro_E_coefs[2]->const_arrays();
+        // H = B/mu, or H itself with the LLG solver, see HFieldAccessor
+        auto const Bx = Bfield[0]->const_arrays();
+        auto const By = Bfield[1]->const_arrays();
+        auto const Bz = Bfield[2]->const_arrays();
+        auto const mu = mu_mf.arrays();
+
+        ParallelForUpdateBoxes(*Efield[0], ng_update, lev,
+            [=] AMREX_GPU_DEVICE (int b, int i, int j, int k){
+                auto const Hy = HFieldAccessor<T_H_field>(By[b], mu[b]);
+                auto const Hz = HFieldAccessor<T_H_field>(Bz[b], mu[b]);
+                amrex::Real const alpha = coefs_Ex[b](i, j, k, 0);
+                amrex::Real const beta = coefs_Ex[b](i, j, k, 1);
+                Ex[b](i, j, k) = alpha * Ex[b](i, j, k)
+                                 + beta * ( - T_Algo::DownwardDz(Hy, coefs_z, n_coefs_z, i, j, k,0)
+                                            + T_Algo::DownwardDy(Hz, coefs_y, n_coefs_y, i, j, k,0)
+                                          ) - beta * jx[b](i, j, k);
+            });
+        ParallelForUpdateBoxes(*Efield[1], ng_update, lev,
+            [=] AMREX_GPU_DEVICE (int b, int i, int j, int k){
+                auto const Hz = HFieldAccessor<T_H_field>(Bz[b], mu[b]);
+                auto const Hx = HFieldAccessor<T_H_field>(Bx[b], mu[b]);
+                amrex::Real const alpha = coefs_Ey[b](i, j, k, 0);
+                amrex::Real const beta = coefs_Ey[b](i, j, k, 1);
+                Ey[b](i, j, k) = alpha * Ey[b](i, j, k)
+                                 + beta * ( - T_Algo::DownwardDx(Hz, coefs_x, n_coefs_x, i, j, k,0)
+                                            + T_Algo::DownwardDz(Hx, coefs_z, n_coefs_z, i, j, k,0)
+                                          ) - beta * jy[b](i, j, k);
+            });
+        ParallelForUpdateBoxes(*Efield[2], ng_update, lev,
+            [=] AMREX_GPU_DEVICE (int b, int i, int j, int k){
+                auto const Hx = HFieldAccessor<T_H_field>(Bx[b], mu[b]);
+                auto const Hy = HFieldAccessor<T_H_field>(By[b], mu[b]);
+                amrex::Real const alpha = coefs_Ez[b](i, j, k, 0);
+                amrex::Real const beta = coefs_Ez[b](i, j, k, 1);
+                Ez[b](i, j, k) = alpha * Ez[b](i, j, k)
+                                 + beta * ( - T_Algo::DownwardDy(Hx, coefs_y, n_coefs_y, i, j, k,0)
+                                            + T_Algo::DownwardDx(Hy, coefs_x, n_coefs_x, i, j, k,0)
+                                          ) - beta * jz[b](i, j, k);
+            });
+        return;
+    }
+
+    // static data in managed memory is migrated to the device one box ahead of the loop
+    StaticDataPrefetcher prefetch;
+    for (auto const& coefs : m_macro_E_coefs) prefetch.Add(coefs.get());
+    prefetch.Add(&mu_mf);
 
     // Loop through the grids, and over the tiles within each grid
 #ifdef AMREX_USE_OMP
 #pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
 #endif
     for ( MFIter mfi(*Efield[0], TilingIfNotGPU()); mfi.isValid(); ++mfi ) {
+        prefetch.Next(mfi);
+        // Extract tileboxes for which to loop
+        Box const tex = UpdateBox(mfi, Efield[0]->ixType(), ng_update, lev);
+        Box const tey = UpdateBox(mfi, Efield[1]->ixType(), ng_update, lev);
+        Box const tez = UpdateBox(mfi, Efield[2]->ixType(), ng_update, lev);
+
+#ifdef AMREX_USE_EB
+        // The tiles which are all covered by embedded boundaries are skipped, and the edge
+        // lengths are only checked on the tiles cut by them
+        amrex::FabType const eb_type = EBTileType(eb_flags, mfi, tex, tey, tez);
+        if (eb_type == amrex::FabType::covered) continue;
+        bool const eb_cut = (eb_type != amrex::FabType::regular);
+#endif
+
+        CostBoxTimer cost_box(cost, mfi.index());
 
         // Extract field data for this grid/tile
         Array4<Real> const& Ex = Efield[0]->array(mfi);
@@ -162,11 +392,9 @@ void FiniteDifferenceSolver::MacroscopicEvolveECartesian (
         Array4<Real> const& jx = Jfield[0]->array(mfi);
         Array4<Real> const& jy = Jfield[1]->array(mfi);
         Array4<Real> const& jz = Jfield[2]->array(mfi);
-#ifndef WARPX_MAG_LLG
-        Array4<Real> const& Bx = Bfield[0]->array(mfi);
-        Array4<Real> const& By = Bfield[1]->array(mfi);
-        Array4<Real> const& Bz = Bfield[2]->array(mfi);
-#endif
+        Array4<Real const> const& Bx = Bfield[0]->const_array(mfi);
+        Array4<Real const> const& By = Bfield[1]->const_array(mfi);
+        Array4<Real const> const& Bz = Bfield[2]->const_array(mfi);
 
 #ifdef AMREX_USE_EB
         amrex::Array4<amrex::Real> const& lx = edge_lengths[0]->array(mfi);
@@ -174,100 +402,458 @@ void FiniteDifferenceSolver::MacroscopicEvolveECartesian (
         amrex::Array4<amrex::Real> const& lz = edge_lengths[2]->array(mfi);
 #endif
 
-        // material prop //
-        amrex::Array4<amrex::Real> const& sigma_arr = sigma_mf.array(mfi);
-        amrex::Array4<amrex::Real> const& eps_arr = epsilon_mf.array(mfi);
-#ifndef WARPX_MAG_LLG
+        // coefficients of the update, alpha (component 0) and beta (component 1)
+        amrex::Array4<amrex::Real const> const& coefs_Ex = m_macro_E_coefs[0]->const_array(mfi);
+        amrex::Array4<amrex::Real const> const& coefs_Ey = m_macro_E_coefs[1]->const_array(mfi);
+        amrex::Array4<amrex::Real const> const& coefs_Ez = m_macro_E_coefs[2]->const_array(mfi);
         amrex::Array4<amrex::Real> const& mu_arr = mu_mf.array(mfi);
-#endif
-
-        // Extract stencil coefficients
-        Real const * const AMREX_RESTRICT coefs_x = m_stencil_coefs_x.dataPtr();
-        int const n_coefs_x = m_stencil_coefs_x.size();
-        Real const * const AMREX_RESTRICT coefs_y = m_stencil_coefs_y.dataPtr();
-        int const n_coefs_y = m_stencil_coefs_y.size();
-        Real const * const AMREX_RESTRICT coefs_z = m_stencil_coefs_z.dataPtr();
-        int const n_coefs_z = m_stencil_coefs_z.size();
 
-#ifndef WARPX_MAG_LLG
-        // This functor computes Hx = Bx/mu
+        // This functor computes Hx = Bx/mu, or returns Hx with the LLG solver
         // Note that mu is cell-centered here and will be interpolated/averaged
         // to the location where the B-field and H-field are defined
-        FieldAccessorMacroscopic const Hx(Bx, mu_arr);
-        FieldAccessorMacroscopic const Hy(By, mu_arr);
-        FieldAccessorMacroscopic const Hz(Bz, mu_arr);
-#else
-        Array4<Real> const& Hx = Hfield[0]->array(mfi);
-        Array4<Real> const& Hy = Hfield[1]->array(mfi);
-        Array4<Real> const& Hz = Hfield[2]->array(mfi);
-#endif
+        auto const Hx = HFieldAccessor<T_H_field>(Bx, mu_arr);
+        auto const Hy = HFieldAccessor<T_H_field>(By, mu_arr);
+        auto const Hz = HFieldAccessor<T_H_field>(Bz, mu_arr);
+
+        // polarization of the dispersive materials and coefficients of its update, on the boxes
+        // that contain dispersive material; its current dP/dt is added to J
+        int const idisp = dispersion ? macroscopic_properties->dispersion_index(mfi.index()) : -1;
+        bool const has_P = (idisp >= 0);
+        amrex::Array4<amrex::Real> const Px = has_P ? macroscopic_properties->getdispersion_P_mf(0).array(idisp) : amrex::Array4<amrex::Real>{};
+        amrex::Array4<amrex::Real> const Py = has_P ? macroscopic_properties->getdispersion_P_mf(1).array(idisp) : amrex::Array4<amrex::Real>{};
+        amrex::Array4<amrex::Real> const Pz = has_P ? macroscopic_properties->getdispersion_P_mf(2).array(idisp) : amrex::Array4<amrex::Real>{};
+        amrex::Array4<amrex::Real const> const coefs_Px = has_P ? m_macro_P_coefs[0]->const_array(idisp) : amrex::Array4<amrex::Real const>{};
+        amrex::Array4<amrex::Real const> const coefs_Py = has_P ? m_macro_P_coefs[1]->const_array(idisp) : amrex::Array4<amrex::Real const>{};
+        amrex::Array4<amrex::Real const> const coefs_Pz = has_P ? m_macro_P_coefs[2]->const_array(idisp) : amrex::Array4<amrex::Real const>{};
+
+        // edges inside or on the surface of the surface-impedance conductors
+        int const isibc = surface_impedance ? m_macro_sibc_index[mfi.index()] : -1;
+        bool const has_sibc = (isibc >= 0);
+        amrex::Array4<amrex::Real const> const sibc_Ex = has_sibc ? m_macro_sibc_coefs[0]->const_array(isibc) : amrex::Array4<amrex::Real const>{};
+        amrex::Array4<amrex::Real const> const sibc_Ey = has_sibc ? m_macro_sibc_coefs[1]->const_array(isibc) : amrex::Array4<amrex::Real const>{};
+        amrex::Array4<amrex::Real const> const sibc_Ez = has_sibc ? m_macro_sibc_coefs[2]->const_array(isibc) : amrex::Array4<amrex::Real const>{};
 
-        // Extract tileboxes for which to loop
-        Box const& tex  = mfi.tilebox(Efield[0]->ixType().toIntVect());
-        Box const& tey  = mfi.tilebox(Efield[1]->ixType().toIntVect());
-        Box const& tez  = mfi.tilebox(Efield[2]->ixType().toIntVect());
-        // starting component to interpolate macro properties to Ex, Ey, Ez locations
-        const int scomp = 0;
         // Loop over the cells and update the fields
         amrex::ParallelFor(tex, tey, tez,
             [=] AMREX_GPU_DEVICE (int i, int j, int k){
 #ifdef AMREX_USE_EB
                 // Skip field push if this cell is fully covered by embedded boundaries
-                if (lx(i, j, k) <= 0) return;
+                if (eb_cut && lx(i, j, k) <= 0) return;
 #endif
-                // Interpolate conductivity, sigma, to Ex position on the grid
-                amrex::Real const sigma_interp = CoarsenIO::Interp( sigma_arr, sigma_stag,
-                                           Ex_stag, macro_cr, i, j, k, scomp);
-                // Interpolated permittivity, epsilon, to Ex position on the grid
-                amrex::Real const epsilon_interp = CoarsenIO::Interp( eps_arr, epsilon_stag,
-                                           Ex_stag, macro_cr, i, j, k, scomp);
-                amrex::Real alpha = T_MacroAlgo::alpha( sigma_interp, epsilon_interp, dt);
-                amrex::Real beta = T_MacroAlgo::beta( sigma_interp, epsilon_interp, dt);
+                if (has_sibc && sibc_Ex(i, j, k, 0) != 0._rt) {
+                    Ex(i, j, k) = (sibc_Ex(i, j, k, 0) == 1._rt) ? 0._rt
+                                : SurfaceImpedanceE(i, j, k, 0, sibc_Ex, Hy, Hz);
+                    return;
+                }
+                amrex::Real const alpha = coefs_Ex(i, j, k, 0);
+                amrex::Real const beta = coefs_Ex(i, j, k, 1);
+                amrex::Real const j_P = has_P ? AdvancePolarization(i, j, k, Ex(i, j, k), Px, coefs_Px, inv_dt) : 0._rt;
                 Ex(i, j, k) = alpha * Ex(i, j, k)
                             + beta * ( - T_Algo::DownwardDz(Hy, coefs_z, n_coefs_z, i, j, k,0)
                                        + T_Algo::DownwardDy(Hz, coefs_y, n_coefs_y, i, j, k,0)
-                                     ) - beta * jx(i, j, k);
+                                     ) - beta * (jx(i, j, k) + j_P);
             },
 
             [=] AMREX_GPU_DEVICE (int i, int j, int k){
 #ifdef AMREX_USE_EB
                 // Skip field push if this cell is fully covered by embedded boundaries
-                if (ly(i,j,k) <= 0) return;
+                if (eb_cut && ly(i,j,k) <= 0) return;
 #endif
-                // Interpolate conductivity, sigma, to Ey position on the grid
-                amrex::Real const sigma_interp = CoarsenIO::Interp( sigma_arr, sigma_stag,
-                                           Ey_stag, macro_cr, i, j, k, scomp);
-                // Interpolated permittivity, epsilon, to Ey position on the grid
-                amrex::Real const epsilon_interp = CoarsenIO::Interp( eps_arr, epsilon_stag,
-                                           Ey_stag, macro_cr, i, j, k, scomp);
-                amrex::Real alpha = T_MacroAlgo::alpha( sigma_interp, epsilon_interp, dt);
-                amrex::Real beta = T_MacroAlgo::beta( sigma_interp, epsilon_interp, dt);
+                if (has_sibc && sibc_Ey(i, j, k, 0) != 0._rt) {
+                    Ey(i, j, k) = (sibc_Ey(i, j, k, 0) == 1._rt) ? 0._rt
+                                : SurfaceImpedanceE(i, j, k, 1, sibc_Ey, Hz, Hx);
+                    return;
+                }
+                amrex::Real const alpha = coefs_Ey(i, j, k, 0);
+                amrex::Real const beta = coefs_Ey(i, j, k, 1);
+                amrex::Real const j_P = has_P ? AdvancePolarization(i, j, k, Ey(i, j, k), Py, coefs_Py, inv_dt) : 0._rt;
                 Ey(i, j, k) = alpha * Ey(i, j, k)
                             + beta * ( - T_Algo::DownwardDx(Hz, coefs_x, n_coefs_x, i, j, k,0)
                                        + T_Algo::DownwardDz(Hx, coefs_z, n_coefs_z, i, j, k,0)
-                                     ) - beta * jy(i, j, k);
+                                     ) - beta * (jy(i, j, k) + j_P);
             },
 
             [=] AMREX_GPU_DEVICE (int i, int j, int k){
 #ifdef AMREX_USE_EB
                 // Skip field push if this cell is fully covered by embedded boundaries
-                if (lz(i,j,k) <= 0) return;
+                if (eb_cut && lz(i,j,k) <= 0) return;
 #endif
-                // Interpolate conductivity, sigma, to Ez position on the grid
-                amrex::Real const sigma_interp = CoarsenIO::Interp( sigma_arr, sigma_stag,
-                                           Ez_stag, macro_cr, i, j, k, scomp);
-                // Interpolated permittivity, epsilon, to Ez position on the grid
-                amrex::Real const epsilon_interp = CoarsenIO::Interp( eps_arr, epsilon_stag,
-                                           Ez_stag, macro_cr, i, j, k, scomp);
-                amrex::Real alpha = T_MacroAlgo::alpha( sigma_interp, epsilon_interp, dt);
-                amrex::Real beta = T_MacroAlgo::beta( sigma_interp, epsilon_interp, dt);
+                if (has_sibc && sibc_Ez(i, j, k, 0) != 0._rt) {
+                    Ez(i, j, k) = (sibc_Ez(i, j, k, 0) == 1._rt) ? 0._rt
+                                : SurfaceImpedanceE(i, j, k, 2, sibc_Ez, Hx, Hy);
+                    return;
+                }
+                amrex::Real const alpha = coefs_Ez(i, j, k, 0);
+                amrex::Real const beta = coefs_Ez(i, j, k, 1);
+                amrex::Real const j_P = has_P ? AdvancePolarization(i, j, k, Ez(i, j, k), Pz, coefs_Pz, inv_dt) : 0._rt;
                 Ez(i, j, k) = alpha * Ez(i, j, k)
                             + beta * ( - T_Algo::DownwardDy(Hx, coefs_y, n_coefs_y, i, j, k,0)
                                        + T_Algo::DownwardDx(Hy, coefs_x, n_coefs_x, i, j, k,0)
-                                     ) - beta * jz(i, j, k);
+                                     ) - beta * (jz(i, j, k) + j_P);
             }
         );
     }
 }
 
+template<typename T_Algo, bool T_H_field>
+void FiniteDifferenceSolver::MacroscopicLumpedElementsCartesian (
+    std::array< std::unique_ptr<amrex::MultiFab>, 3 > const& Efield,
+    std::array< std::unique_ptr<amrex::MultiFab>, 3 > const& Bfield,
+    std::array< std::unique_ptr<amrex::MultiFab>, 3 > const& Jfield,
+    amrex::Real const dt, amrex::Real const t,
+    std::unique_ptr<MacroscopicProperties> const& macroscopic_properties,
+    LumpedElements& lumped_elements)
+{
+    int const n_elements = lumped_elements.size();
+    // E^(n+1) and I_L^(n+1/2) of each element, computed on the rank of the box that owns its edge
+    amrex::Vector<amrex::Real> values(2 * n_elements, 0._rt);
+
+    amrex::MultiFab& mu_mf = macroscopic_properties->getmu_mf();
+    amrex::MultiFab& sigma_mf = macroscopic_properties->getsigma_mf();
+    amrex::MultiFab& epsilon_mf = macroscopic_properties->getepsilon_mf();
+    amrex::GpuArray<int, 3> const& sigma_stag = macroscopic_properties->sigma_IndexType;
+    amrex::GpuArray<int, 3> const& epsilon_stag = macroscopic_properties->epsilon_IndexType;
+    amrex::GpuArray<int, 3> const& macro_cr = macroscopic_properties->macro_cr_ratio;
+    std::array<amrex::GpuArray<int, 3>, 3> const E_stag = {macroscopic_properties->Ex_IndexType,
+                                                           macroscopic_properties->Ey_IndexType,
+                                                           macroscopic_properties->Ez_IndexType};
+    MeshCoordinates const coords = WarpX::GetInstance().GetMeshCoordinates(0);
+
+    Real const * const AMREX_RESTRICT coefs_x = m_stencil_coefs_x.dataPtr();
+    int const n_coefs_x = m_stencil_coefs_x.size();
+    Real const * const AMREX_RESTRICT coefs_y = m_stencil_coefs_y.dataPtr();
+    int const n_coefs_y = m_stencil_coefs_y.size();
+    Real const * const AMREX_RESTRICT coefs_z = m_stencil_coefs_z.dataPtr();
+    int const n_coefs_z = m_stencil_coefs_z.size();
+
+    for (int ie = 0; ie < n_elements; ++ie) {
+        LumpedElements::Element const& e = lumped_elements[ie];
+        int const dir = e.dir;
+        int const ibox = LumpedElements::OwnerBox(Efield[dir]->boxArray(), e);
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(ibox >= 0, "The edge of the lumped element " + e.name + " is not in a box");
+        if (Efield[dir]->DistributionMap()[ibox] != amrex::ParallelDescriptor::MyProc()) continue;
+
+        Array4<Real const> const& E = Efield[dir]->const_array(ibox);
+        Array4<Real const> const& J = Jfield[dir]->const_array(ibox);
+        amrex::Array4<amrex::Real> const& mu_arr = mu_mf.array(ibox);
+        auto const Hx = HFieldAccessor<T_H_field>(Bfield[0]->const_array(ibox), mu_arr);
+        auto const Hy = HFieldAccessor<T_H_field>(Bfield[1]->const_array(ibox), mu_arr);
+        auto const Hz = HFieldAccessor<T_H_field>(Bfield[2]->const_array(ibox), mu_arr);
+        amrex::Array4<amrex::Real> const& sigma_arr = sigma_mf.array(ibox);
+        amrex::Array4<amrex::Real> const& eps_arr = epsilon_mf.array(ibox);
+        CoarsenIO::InterpStencil const sigma_stencil(sigma_stag, E_stag[dir], macro_cr);
+        CoarsenIO::InterpStencil const epsilon_stencil(epsilon_stag, E_stag[dir], macro_cr);
+
+        amrex::Real const R = e.R;
+        amrex::Real const L = e.L;
+        amrex::Real const C = e.C;
+        amrex::Real const I_L = e.I_L;
+        // the source at the half step, centered as the update
+        amrex::Real const V = e.voltage_parser ? e.voltage_parser->compileHost<1>()(t + 0.5_rt * dt) : 0._rt;
+
+        amrex::ReduceOps<amrex::ReduceOpSum, amrex::ReduceOpSum> reduce_op;
+        amrex::ReduceData<amrex::Real, amrex::Real> reduce_data(reduce_op);
+        using ReduceTuple = typename decltype(reduce_data)::Type;
+        reduce_op.eval(Box(e.iv, e.iv, Efield[dir]->ixType()), reduce_data,
+            [=] AMREX_GPU_DEVICE (int i, int j, int k) -> ReduceTuple {
+                amrex::Real curl_H = 0._rt;
+                if (dir == 0) {
+                    curl_H = - T_Algo::DownwardDz(Hy, coefs_z, n_coefs_z, i, j, k, 0)
+                             + T_Algo::DownwardDy(Hz, coefs_y, n_coefs_y, i, j, k, 0);
+                } else if (dir == 1) {
+                    curl_H = - T_Algo::DownwardDx(Hz, coefs_x, n_coefs_x, i, j, k, 0)
+                             + T_Algo::DownwardDz(Hx, coefs_z, n_coefs_z, i, j, k, 0);
+                } else {
+                    curl_H = - T_Algo::DownwardDy(Hx, coefs_y, n_coefs_y, i, j, k, 0)
+                             + T_Algo::DownwardDx(Hy, coefs_x, n_coefs_x, i, j, k, 0);
+                }
+                amrex::Real const sigma = sigma_stencil(sigma_arr, i, j, k, 0);
+                amrex::Real const epsilon = epsilon_stencil(eps_arr, i, j, k, 0);
+
+                // length of the edge, and section of the dual cell around it (per unit length
+                // along the invariant directions)
+                int const idx[3] = {i, j, k};
+                amrex::Real dl = 1._rt;
+                amrex::Real area = 1._rt;
+                for (int d = 0; d < 3; ++d) {
+                    int const id = IndexDim(d);
+                    if (id < 0) continue;
+                    if (d == dir) {
+                        dl = coords(id, idx[id] + 1, 1) - coords(id, idx[id], 1);
+                    } else {
+                        area *= coords(id, idx[id], 0) - coords(id, idx[id] - 1, 0);
+                    }
+                }
+
+                // (eps + C dl/A) dE/dt + (sigma + dl/(R A)) E = curl H - J + V/(R A) - I_L/A,
+                // centered at n+1/2, with I_L^(n+1/2) from E^n
+                amrex::Real const E_n = E(i, j, k);
+                amrex::Real const I_L_new = (L > 0._rt) ? I_L + dt * dl * E_n / L : 0._rt;
+                amrex::Real const eps_e = epsilon + C * dl / area;
+                amrex::Real const sigma_e = sigma + ((R > 0._rt) ? dl / (R * area) : 0._rt);
+                amrex::Real const source = ((R > 0._rt) ? V / (R * area) : 0._rt) - I_L_new / area;
+                amrex::Real const E_new = ((eps_e / dt - 0.5_rt * sigma_e) * E_n + curl_H - J(i, j, k) + source)
+                                        / (eps_e / dt + 0.5_rt * sigma_e);
+                return {E_new, I_L_new};
+        });
+        auto const hv = reduce_data.value();
+        values[2 * ie] = amrex::get<0>(hv);
+        values[2 * ie + 1] = amrex::get<1>(hv);
+    }
+
+    // the edges shared by several boxes, possibly on other ranks, all take the same values
+    amrex::ParallelDescriptor::ReduceRealSum(values.data(), static_cast<int>(values.size()));
+    for (int ie = 0; ie < n_elements; ++ie) {
+        lumped_elements[ie].E_new = values[2 * ie];
+        lumped_elements[ie].I_L = values[2 * ie + 1];
+    }
+}
+
+template<typename T_MacroAlgo>
+void FiniteDifferenceSolver::ComputeMacroscopicECoefs (
+    std::array< std::unique_ptr<amrex::MultiFab>, 3 > const& Efield,
+    amrex::Real const dt,
+    std::unique_ptr<MacroscopicProperties> const& macroscopic_properties,
+    int ng_update)
+{
+    bool up_to_date = (dt == m_macro_E_coefs_dt)
+                      && (macroscopic_properties->getproperties_version() == m_macro_E_coefs_version);
+    for (int idim = 0; idim < 3; ++idim) {
+        up_to_date = up_to_date && m_macro_E_coefs[idim]
+                     && m_macro_E_coefs[idim]->boxArray() == Efield[idim]->boxArray()
+                     && m_macro_E_coefs[idim]->DistributionMap() == Efield[idim]->DistributionMap()
+                     && m_macro_E_coefs[idim]->nGrowVect().allGE(amrex::IntVect(ng_update));
+    }
+    if (up_to_date) return;
+
+    amrex::MultiFab& sigma_mf = macroscopic_properties->getsigma_mf();
+    amrex::MultiFab& epsilon_mf = macroscopic_properties->getepsilon_mf();
+
+    // Index type required for building the CoarsenIO::InterpStencil that interpolates macroscopic
+    // properties from their respective staggering to the Ex, Ey, Ez locations
+    amrex::GpuArray<int, 3> const& sigma_stag = macroscopic_properties->sigma_IndexType;
+    amrex::GpuArray<int, 3> const& epsilon_stag = macroscopic_properties->epsilon_IndexType;
+    amrex::GpuArray<int, 3> const& macro_cr     = macroscopic_properties->macro_cr_ratio;
+    std::array<amrex::GpuArray<int, 3>, 3> const E_stag = {macroscopic_properties->Ex_IndexType,
+                                                           macroscopic_properties->Ey_IndexType,
+                                                           macroscopic_properties->Ez_IndexType};
+    // starting component to interpolate macro properties to Ex, Ey, Ez locations
+    const int scomp = 0;
+
+    for (int idim = 0; idim < 3; ++idim) {
+        // the interpolation of the properties reads one more cell than the E location
+        const amrex::IntVect ng_coefs = (ng_update > 0) ?
+            (Efield[idim]->nGrowVect() - amrex::IntVect(1)).max(amrex::IntVect(0)) : amrex::IntVect(0);
+        m_macro_E_coefs[idim] = std::make_unique<MultiFab>(Efield[idim]->boxArray(), Efield[idim]->DistributionMap(), 2, ng_coefs,
+                                                           StaticDataMFInfo());
+        CoarsenIO::InterpStencil const sigma_stencil(sigma_stag, E_stag[idim], macro_cr);
+        CoarsenIO::InterpStencil const epsilon_stencil(epsilon_stag, E_stag[idim], macro_cr);
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#endif
+        for ( MFIter mfi(*m_macro_E_coefs[idim], TilingIfNotGPU()); mfi.isValid(); ++mfi ) {
+            Box const& tb = mfi.growntilebox();
+            amrex::Array4<amrex::Real> const& coefs_arr = m_macro_E_coefs[idim]->array(mfi);
+            amrex::Array4<amrex::Real> const& sigma_arr = sigma_mf.array(mfi);
+            amrex::Array4<amrex::Real> const& eps_arr = epsilon_mf.array(mfi);
+
+            amrex::ParallelFor(tb,
+                [=] AMREX_GPU_DEVICE (int i, int j, int k){
+                    // Interpolate conductivity, sigma, and permittivity, epsilon, to the E position on the grid
+                    amrex::Real const sigma_interp = sigma_stencil(sigma_arr, i, j, k, scomp);
+                    amrex::Real const epsilon_interp = epsilon_stencil(eps_arr, i, j, k, scomp);
+                    coefs_arr(i, j, k, 0) = T_MacroAlgo::alpha( sigma_interp, epsilon_interp, dt);
+                    coefs_arr(i, j, k, 1) = T_MacroAlgo::beta( sigma_interp, epsilon_interp, dt);
+            });
+        }
+    }
+    m_macro_E_coefs_dt = dt;
+    m_macro_E_coefs_version = macroscopic_properties->getproperties_version();
+}
+
+void FiniteDifferenceSolver::ComputeDispersionCoefs (
+    std::array< std::unique_ptr<amrex::MultiFab>, 3 > const& Efield,
+    amrex::Real const dt,
+    std::unique_ptr<MacroscopicProperties> const& macroscopic_properties)
+{
+    bool up_to_date = (dt == m_macro_P_coefs_dt)
+                      && (macroscopic_properties->getproperties_version() == m_macro_P_coefs_version);
+    for (int idim = 0; idim < 3; ++idim) {
+        amrex::MultiFab const& P = macroscopic_properties->getdispersion_P_mf(idim);
+        up_to_date = up_to_date && m_macro_P_coefs[idim]
+                     && m_macro_P_coefs[idim]->boxArray() == P.boxArray()
+                     && m_macro_P_coefs[idim]->DistributionMap() == P.DistributionMap();
+    }
+    if (up_to_date) return;
+
+    amrex::iMultiFab& material_id_mf = macroscopic_properties->getmaterial_id_mf();
+    amrex::Real const * const AMREX_RESTRICT table = macroscopic_properties->material_table();
+    int const nmat = macroscopic_properties->nmaterials();
+    amrex::Real const inv_dt = 1._rt / dt;
+
+    for (int idim = 0; idim < 3; ++idim) {
+        amrex::MultiFab const& P = macroscopic_properties->getdispersion_P_mf(idim);
+        // the coefficients read the materials of the cells around the E location
+        const amrex::IntVect ng_coefs = (P.nGrowVect() - amrex::IntVect(1)).max(amrex::IntVect(0));
+        m_macro_P_coefs[idim] = std::make_unique<MultiFab>(P.boxArray(), P.DistributionMap(), 3, ng_coefs);
+        amrex::IntVect const E_stag = Efield[idim]->ixType().toIntVect();
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#endif
+        for ( MFIter mfi(*m_macro_P_coefs[idim], TilingIfNotGPU()); mfi.isValid(); ++mfi ) {
+            Box const& tb = mfi.growntilebox();
+            amrex::Array4<amrex::Real> const& coefs_arr = m_macro_P_coefs[idim]->array(mfi);
+            amrex::Array4<int const> const& id_arr =
+                material_id_mf.const_array(macroscopic_properties->dispersion_box(mfi.index()));
+
+            amrex::ParallelFor(tb,
+                [=] AMREX_GPU_DEVICE (int i, int j, int k){
+                    // a2 d2P/dt2 + a1 dP/dt + a0 P = b0 E is discretized with centered differences
+                    // and a0 P averaged between n+1 and n-1, which is stable for any dt:
+                    // P^(n+1) = c0 E^n + c1 P^n + c2 P^(n-1). The coefficients of the cells around
+                    // the E location are averaged, with zero for the non-dispersive materials.
+                    amrex::Real c0 = 0._rt, c1 = 0._rt, c2 = 0._rt;
+                    int ncells = 0;
+                    for (int n = 0; n < (1 << AMREX_SPACEDIM); ++n) {
+                        amrex::IntVect cell(AMREX_D_DECL(i, j, k));
+                        bool duplicate = false;
+                        for (int d = 0; d < AMREX_SPACEDIM; ++d) {
+                            if (((n >> d) & 1) == 0) continue;
+                            if (E_stag[d] == 0) duplicate = true;
+                            cell[d] -= 1;
+                        }
+                        if (duplicate) continue;
+                        ++ncells;
+                        int const id = id_arr(cell);
+                        amrex::Real const b0 = table[MacroscopicProperties::mat_disp_b0 * nmat + id];
+                        if (b0 == 0._rt) continue;
+                        amrex::Real const a0 = table[MacroscopicProperties::mat_disp_a0 * nmat + id];
+                        amrex::Real const a1 = table[MacroscopicProperties::mat_disp_a1 * nmat + id];
+                        amrex::Real const a2 = table[MacroscopicProperties::mat_disp_a2 * nmat + id];
+                        amrex::Real const inv_D = 1._rt / (a2 * inv_dt * inv_dt + 0.5_rt * a1 * inv_dt + 0.5_rt * a0);
+                        c0 += b0 * inv_D;
+                        c1 += 2._rt * a2 * inv_dt * inv_dt * inv_D;
+                        c2 += (0.5_rt * a1 * inv_dt - 0.5_rt * a0 - a2 * inv_dt * inv_dt) * inv_D;
+                    }
+                    coefs_arr(i, j, k, 0) = c0 / ncells;
+                    coefs_arr(i, j, k, 1) = c1 / ncells;
+                    coefs_arr(i, j, k, 2) = c2 / ncells;
+            });
+        }
+    }
+    m_macro_P_coefs_dt = dt;
+    m_macro_P_coefs_version = macroscopic_properties->getproperties_version();
+}
+
+void FiniteDifferenceSolver::ComputeSurfaceImpedanceCoefs (
+    std::array< std::unique_ptr<amrex::MultiFab>, 3 > const& Efield,
+    std::unique_ptr<MacroscopicProperties> const& macroscopic_properties)
+{
+    bool up_to_date = (macroscopic_properties->getproperties_version() == m_macro_sibc_version)
+                      && (static_cast<int>(m_macro_sibc_index.size()) == Efield[0]->size());
+    for (int idim = 0; idim < 3; ++idim) {
+        up_to_date = up_to_date && (m_macro_sibc_coefs[idim] == nullptr
+                     || m_macro_sibc_coefs[idim]->ixType() == Efield[idim]->ixType());
+    }
+    if (up_to_date) return;
+
+    amrex::iMultiFab& material_id_mf = macroscopic_properties->getmaterial_id_mf();
+    amrex::Real const * const AMREX_RESTRICT table = macroscopic_properties->material_table();
+    int const nmat = macroscopic_properties->nmaterials();
+
+    // flag the boxes with a conductor in a cell or in the guard cells read by their E locations
+    int const nboxes = Efield[0]->size();
+    amrex::Vector<int> box_has_sibc(nboxes, 0);
+    for ( MFIter mfi(material_id_mf); mfi.isValid(); ++mfi ) {
+        amrex::Array4<int const> const& id_arr = material_id_mf.const_array(mfi);
+        amrex::ReduceOps<amrex::ReduceOpMax> reduce_op;
+        amrex::ReduceData<int> reduce_data(reduce_op);
+        using ReduceTuple = typename decltype(reduce_data)::Type;
+        reduce_op.eval(mfi.fabbox(), reduce_data,
+            [=] AMREX_GPU_DEVICE (int i, int j, int k) -> ReduceTuple {
+                return (table[MacroscopicProperties::mat_sibc_Rs * nmat + id_arr(i,j,k)] > 0._rt) ? 1 : 0;
+        });
+        if (amrex::get<0>(reduce_data.value()) > 0) box_has_sibc[mfi.index()] = 1;
+    }
+    amrex::ParallelDescriptor::ReduceIntMax(box_has_sibc.data(), nboxes);
+
+    // the boxes keep their owner, so that the E update accesses them locally
+    m_macro_sibc_index.assign(nboxes, -1);
+    amrex::Vector<int> sibc_boxes;
+    amrex::Vector<int> pmap;
+    amrex::DistributionMapping const& dm_E = Efield[0]->DistributionMap();
+    for (int ibox = 0; ibox < nboxes; ++ibox) {
+        if (box_has_sibc[ibox] == 0) continue;
+        m_macro_sibc_index[ibox] = static_cast<int>(sibc_boxes.size());
+        sibc_boxes.push_back(ibox);
+        pmap.push_back(dm_E[ibox]);
+    }
+    m_macro_sibc_version = macroscopic_properties->getproperties_version();
+    for (auto& coefs : m_macro_sibc_coefs) coefs.reset();
+    if (sibc_boxes.empty()) return;
+    amrex::DistributionMapping const dm(pmap);
+
+    for (int idim = 0; idim < 3; ++idim) {
+        amrex::BoxList bl(Efield[idim]->ixType());
+        for (int ibox : sibc_boxes) bl.push_back(Efield[idim]->boxArray()[ibox]);
+        // the coefficients read the materials of the cells around the E location
+        const amrex::IntVect ng_coefs = (Efield[idim]->nGrowVect() - amrex::IntVect(1)).max(amrex::IntVect(0));
+        m_macro_sibc_coefs[idim] = std::make_unique<MultiFab>(amrex::BoxArray(std::move(bl)), dm, 3, ng_coefs);
+        amrex::IntVect const E_stag = Efield[idim]->ixType().toIntVect();
+        int const d1 = (idim + 1) % 3;
+        int const d2 = (idim + 2) % 3;
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#endif
+        for ( MFIter mfi(*m_macro_sibc_coefs[idim], TilingIfNotGPU()); mfi.isValid(); ++mfi ) {
+            Box const& tb = mfi.growntilebox();
+            amrex::Array4<amrex::Real> const& coefs_arr = m_macro_sibc_coefs[idim]->array(mfi);
+            amrex::Array4<int const> const& id_arr = material_id_mf.const_array(sibc_boxes[mfi.index()]);
+
+            amrex::ParallelFor(tb,
+                [=] AMREX_GPU_DEVICE (int i, int j, int k){
+                    // the cells around the E location: the conductor ones give the normal into
+                    // the conductor and the average surface resistance
+                    int ncells = 0, nconductor = 0;
+                    amrex::Real Rs = 0._rt;
+                    amrex::Real n[3] = {0._rt, 0._rt, 0._rt};
+                    for (int c = 0; c < (1 << AMREX_SPACEDIM); ++c) {
+                        amrex::IntVect cell(AMREX_D_DECL(i, j, k));
+                        bool duplicate = false;
+                        for (int d = 0; d < AMREX_SPACEDIM; ++d) {
+                            if (((c >> d) & 1) == 0) continue;
+                            if (E_stag[d] == 0) duplicate = true;
+                            cell[d] -= 1;
+                        }
+                        if (duplicate) continue;
+                        ++ncells;
+                        amrex::Real const Rs_cell = table[MacroscopicProperties::mat_sibc_Rs * nmat + id_arr(cell)];
+                        if (Rs_cell <= 0._rt) continue;
+                        ++nconductor;
+                        Rs += Rs_cell;
+                        for (int d = 0; d < AMREX_SPACEDIM; ++d) {
+                            if (E_stag[d] == 1) n[PhysicalDim(d)] += ((c >> d) & 1) ? -1._rt : 1._rt;
+                        }
+                    }
+                    amrex::Real const n_norm = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+                    coefs_arr(i, j, k, 1) = 0._rt;
+                    coefs_arr(i, j, k, 2) = 0._rt;
+                    if (nconductor == 0) {
+                        coefs_arr(i, j, k, 0) = 0._rt;
+                    } else if (nconductor == ncells || n_norm == 0._rt) {
+                        coefs_arr(i, j, k, 0) = 1._rt;
+                    } else {
+                        Rs /= nconductor;
+                        coefs_arr(i, j, k, 0) = 2._rt;
+                        coefs_arr(i, j, k, 1) = Rs * n[d2] / n_norm;
+                        coefs_arr(i, j, k, 2) = -Rs * n[d1] / n_norm;
+                    }
+            });
+        }
+    }
+}
+
 #endif // corresponds to ifndef WARPX_DIM_RZ
@@ -11,8 +11,13 @@
 #include "BoundaryConditions/PML.H"
 #include "BoundaryConditions/PML_current.H"
 #include "BoundaryConditions/PMLComponent.H"
+#include "BoundaryConditions/WarpX_PML_kernels.H"
+#ifdef WARPX_MAG_LLG
+#   include "BoundaryConditions/WarpX_CPML_kernels.H"
+#endif
 #include "Utils/CoarsenIO.H"
 #include "Utils/WarpXConst.H"
+#include "WarpX.H"
 #include <AMReX_Gpu.H>
 #include <AMReX.H>
 
@@ -23,11 +28,7 @@ using namespace amrex;
  */
 void FiniteDifferenceSolver::MacroscopicEvolveEPML (
     std::array< amrex::MultiFab*, 3 > Efield,
-#ifndef WARPX_MAG_LLG
     std::array< amrex::MultiFab*, 3 > const Bfield,
-#else
-    std::array< amrex::MultiFab*, 3 > const Hfield,
-#endif
     std::array< amrex::MultiFab*, 3 > const Jfield,
     amrex::MultiFab* const Ffield,
     MultiSigmaBox const& sigba,
@@ -35,19 +36,24 @@ void FiniteDifferenceSolver::MacroscopicEvolveEPML (
     std::unique_ptr<MacroscopicProperties> const& macroscopic_properties,
     amrex::MultiFab* const eps_mf,
     amrex::MultiFab* const mu_mf,
-    amrex::MultiFab* const sigma_mf)
+    amrex::MultiFab* const sigma_mf,
+    CPMLPsi* cpml_psi,
+    const bool fused_damping)
 {
 
    // Select algorithm (The choice of algorithm is a runtime option,
    // but we compile code for each algorithm, using templates)
 #ifdef WARPX_DIM_RZ
-#    ifndef WARPX_MAG_LLG
-    amrex::ignore_unused(Efield, Bfield, Jfield, Ffield, sigba, dt, pml_has_particles, macroscopic_properties, eps_mf, mu_mf, sigma_mf);
-#    else
-    amrex::ignore_unused(Efield, Hfield, Jfield, Ffield, sigba, dt, pml_has_particles, macroscopic_properties, eps_mf, mu_mf, sigma_mf);
-#    endif
+    amrex::ignore_unused(Efield, Bfield, Jfield, Ffield, sigba, dt, pml_has_particles, macroscopic_properties, eps_mf, mu_mf, sigma_mf, cpml_psi, fused_damping);
     amrex::Abort("PML are not implemented in cylindrical geometry.");
 #else
+    // with the LLG solver (warpx.mag_LLG), Bfield holds H, which is used as is in the update
+#ifdef WARPX_MAG_LLG
+    bool const H_field = WarpX::mag_LLG;
+#else
+    bool const H_field = false;
+#endif
+
     if (m_do_nodal) {
 
         amrex::Abort("Macro E-push is not implemented for nodal, yet.");
@@ -55,51 +61,51 @@ void FiniteDifferenceSolver::MacroscopicEvolveEPML (
     } else if (m_fdtd_algo == MaxwellSolverAlgo::Yee) {
 
         if (WarpX::macroscopic_solver_algo == MacroscopicSolverAlgo::LaxWendroff) {
-            MacroscopicEvolveEPMLCartesian <CartesianYeeAlgorithm, LaxWendroffAlgo> (
-                Efield,
-#ifndef WARPX_MAG_LLG
-                Bfield,
-#else
-                Hfield,
-#endif
-                Jfield, Ffield, sigba, dt, pml_has_particles,
-                macroscopic_properties, eps_mf, mu_mf, sigma_mf);
+            if (H_field) {
+                MacroscopicEvolveEPMLCartesian <CartesianYeeAlgorithm, LaxWendroffAlgo, true> (
+                    Efield, Bfield, Jfield, Ffield, sigba, dt, pml_has_particles,
+                    macroscopic_properties, eps_mf, mu_mf, sigma_mf, cpml_psi, fused_damping);
+            } else {
+                MacroscopicEvolveEPMLCartesian <CartesianYeeAlgorithm, LaxWendroffAlgo, false> (
+                    Efield, Bfield, Jfield, Ffield, sigba, dt, pml_has_particles,
+                    macroscopic_properties, eps_mf, mu_mf, sigma_mf, cpml_psi, fused_damping);
+            }
         }
         else if (WarpX::macroscopic_solver_algo == MacroscopicSolverAlgo::BackwardEuler) {
-            MacroscopicEvolveEPMLCartesian <CartesianYeeAlgorithm, BackwardEulerAlgo> (
-                Efield,
-#ifndef WARPX_MAG_LLG
-                Bfield,
-#else
-                Hfield,
-#endif
-                Jfield, Ffield, sigba, dt, pml_has_particles,
-                macroscopic_properties, eps_mf, mu_mf, sigma_mf);
+            if (H_field) {
+                MacroscopicEvolveEPMLCartesian <CartesianYeeAlgorithm, BackwardEulerAlgo, true> (
+                    Efield, Bfield, Jfield, Ffield, sigba, dt, pml_has_particles,
+                    macroscopic_properties, eps_mf, mu_mf, sigma_mf, cpml_psi, fused_damping);
+            } else {
+                MacroscopicEvolveEPMLCartesian <CartesianYeeAlgorithm, BackwardEulerAlgo, false> (
+                    Efield, Bfield, Jfield, Ffield, sigba, dt, pml_has_particles,
+                    macroscopic_properties, eps_mf, mu_mf, sigma_mf, cpml_psi, fused_damping);
+            }
         }
 
     } else if (m_fdtd_algo == MaxwellSolverAlgo::CKC) {
         // Note :: Macroscopic Evolve E for PML is the same for CKC and Yee
         if (WarpX::macroscopic_solver_algo == MacroscopicSolverAlgo::LaxWendroff) {
-            MacroscopicEvolveEPMLCartesian <CartesianCKCAlgorithm, LaxWendroffAlgo> (
-                Efield,
-#ifndef WARPX_MAG_LLG
-                Bfield,
-#else
-                Hfield,
-#endif
-                Jfield, Ffield, sigba, dt, pml_has_particles,
-                macroscopic_properties, eps_mf, mu_mf, sigma_mf);
+            if (H_field) {
+                MacroscopicEvolveEPMLCartesian <CartesianCKCAlgorithm, LaxWendroffAlgo, true> (
+                    Efield, Bfield, Jfield, Ffield, sigba, dt, pml_has_particles,
+                    macroscopic_properties, eps_mf, mu_mf, sigma_mf, cpml_psi, fused_damping);
+            } else {
+                MacroscopicEvolveEPMLCartesian <CartesianCKCAlgorithm, LaxWendroffAlgo, false> (
+                    Efield, Bfield, Jfield, Ffield, sigba, dt, pml_has_particles,
+                    macroscopic_properties, eps_mf, mu_mf, sigma_mf, cpml_psi, fused_damping);
+            }
         }
         else if (WarpX::macroscopic_solver_algo == MacroscopicSolverAlgo::BackwardEuler) {
-            MacroscopicEvolveEPMLCartesian <CartesianCKCAlgorithm, BackwardEulerAlgo> (
-                Efield,
-#ifndef WARPX_MAG_LLG
-                Bfield,
-#else
-                Hfield,
-#endif
-                Jfield, Ffield, sigba, dt, pml_has_particles,
-                macroscopic_properties, eps_mf, mu_mf, sigma_mf);
+            if (H_field) {
+                MacroscopicEvolveEPMLCartesian <CartesianCKCAlgorithm, BackwardEulerAlgo, true> (
+                    Efield, Bfield, Jfield, Ffield, sigba, dt, pml_has_particles,
+                    macroscopic_properties, eps_mf, mu_mf, sigma_mf, cpml_psi, fused_damping);
+            } else {
+                MacroscopicEvolveEPMLCartesian <CartesianCKCAlgorithm, BackwardEulerAlgo, false> (
+                    Efield, Bfield, Jfield, Ffield, sigba, dt, pml_has_particles,
+                    macroscopic_properties, eps_mf, mu_mf, sigma_mf, cpml_psi, fused_damping);
+            }
         }
 
     } else {
@@ -111,14 +117,10 @@ void FiniteDifferenceSolver::MacroscopicEvolveEPML (
 
 #ifndef WARPX_DIM_RZ
 
-template<typename T_Algo, typename T_MacroAlgo>
+template<typename T_Algo, typename T_MacroAlgo, bool T_H_field>
 void FiniteDifferenceSolver::MacroscopicEvolveEPMLCartesian (
     std::array< amrex::MultiFab*, 3 > Efield,
-#ifndef WARPX_MAG_LLG
     std::array< amrex::MultiFab*, 3 > const Bfield,
-#else
-    std::array< amrex::MultiFab*, 3 > const Hfield,
-#endif
     std::array< amrex::MultiFab*, 3 > const Jfield,
     amrex::MultiFab* const Ffield,
     MultiSigmaBox const& sigba,
@@ -126,15 +128,24 @@ void FiniteDifferenceSolver::MacroscopicEvolveEPMLCartesian (
     std::unique_ptr<MacroscopicProperties> const& macroscopic_properties,
     amrex::MultiFab* const eps_mf,
     amrex::MultiFab* const mu_mf,
-    amrex::MultiFab* const sigma_mf)
+    amrex::MultiFab* const sigma_mf,
+    CPMLPsi* cpml_psi,
+    const bool fused_damping)
 {
 
     amrex::ignore_unused(Ffield);
 #ifdef WARPX_MAG_LLG
-    amrex::ignore_unused(mu_mf);
+    // the CPML (warpx.do_cpml) is only used with the LLG solver
+    if (cpml_psi) {
+        MacroscopicEvolveECPMLCartesian <T_Algo, T_MacroAlgo> (
+            Efield, Bfield, sigba, dt, macroscopic_properties, eps_mf, sigma_mf, *cpml_psi);
+        return;
+    }
+#else
+    amrex::ignore_unused(cpml_psi);
 #endif
 
-    // Index type required for calling CoarsenIO::Interp to interpolate macroscopic
+    // Index type required for building the CoarsenIO::InterpStencil that interpolates macroscopic
     // properties from their respective staggering to the Ex, Ey, Ez locations
     amrex::GpuArray<int, 3> const& sigma_stag = macroscopic_properties->sigma_IndexType;
     amrex::GpuArray<int, 3> const& epsilon_stag = macroscopic_properties->epsilon_IndexType;
@@ -142,6 +153,19 @@ void FiniteDifferenceSolver::MacroscopicEvolveEPMLCartesian (
     amrex::GpuArray<int, 3> const& Ex_stag = macroscopic_properties->Ex_IndexType;
     amrex::GpuArray<int, 3> const& Ey_stag = macroscopic_properties->Ey_IndexType;
     amrex::GpuArray<int, 3> const& Ez_stag = macroscopic_properties->Ez_IndexType;
+    CoarsenIO::InterpStencil const sigma_Ex_stencil(sigma_stag, Ex_stag, macro_cr);
+    CoarsenIO::InterpStencil const sigma_Ey_stencil(sigma_stag, Ey_stag, macro_cr);
+    CoarsenIO::InterpStencil const sigma_Ez_stencil(sigma_stag, Ez_stag, macro_cr);
+    CoarsenIO::InterpStencil const epsilon_Ex_stencil(epsilon_stag, Ex_stag, macro_cr);
+    CoarsenIO::InterpStencil const epsilon_Ey_stencil(epsilon_stag, Ey_stag, macro_cr);
+    CoarsenIO::InterpStencil const epsilon_Ez_stencil(epsilon_stag, Ez_stag, macro_cr);
+
+    // Staggering of the PML fields, for the damping fused into the update
+    // (only used without particles in the PML, which update E after this kernel)
+    bool const damp = fused_damping;
+    amrex::IntVect const Ex_pml_stag = Efield[0]->ixType().toIntVect();
+    amrex::IntVect const Ey_pml_stag = Efield[1]->ixType().toIntVect();
+    amrex::IntVect const Ez_pml_stag = Efield[2]->ixType().toIntVect();
 
     // Loop through the grids, and over the tiles within each grid
 #ifdef AMREX_USE_OMP
@@ -153,17 +177,15 @@ void FiniteDifferenceSolver::MacroscopicEvolveEPMLCartesian (
         Array4<Real> const& Ex = Efield[0]->array(mfi);
         Array4<Real> const& Ey = Efield[1]->array(mfi);
         Array4<Real> const& Ez = Efield[2]->array(mfi);
-#ifndef WARPX_MAG_LLG
-        Array4<Real> const& Bx = Bfield[0]->array(mfi);
-        Array4<Real> const& By = Bfield[1]->array(mfi);
-        Array4<Real> const& Bz = Bfield[2]->array(mfi);
-#endif
+        // Damping factors of this box
+        PMLDampFactors const f = damp ? GetPMLDampFactors(sigba[mfi]) : PMLDampFactors{};
+        Array4<Real const> const& Bx = Bfield[0]->const_array(mfi);
+        Array4<Real const> const& By = Bfield[1]->const_array(mfi);
+        Array4<Real const> const& Bz = Bfield[2]->const_array(mfi);
         // material prop //
         amrex::Array4<amrex::Real> const& sigma_arr = sigma_mf->array(mfi);
         amrex::Array4<amrex::Real> const& eps_arr = eps_mf->array(mfi);
-#ifndef WARPX_MAG_LLG
         amrex::Array4<amrex::Real> const& mu_arr = mu_mf->array(mfi);
-#endif
 
         // Extract stencil coefficients
         Real const * const AMREX_RESTRICT coefs_x = m_stencil_coefs_x.dataPtr();
@@ -173,18 +195,12 @@ void FiniteDifferenceSolver::MacroscopicEvolveEPMLCartesian (
         Real const * const AMREX_RESTRICT coefs_z = m_stencil_coefs_z.dataPtr();
         int const n_coefs_z = m_stencil_coefs_z.size();
 
-#ifndef WARPX_MAG_LLG
-        // This functor computes Hx = Bx/mu
+        // This functor computes Hx = Bx/mu, or returns Hx with the LLG solver
         // Note that mu is cell-centered here and will be interpolated/averaged
         // to the location where the B-field and H-field are defined
-        FieldAccessorMacroscopic const Hx(Bx, mu_arr);
-        FieldAccessorMacroscopic const Hy(By, mu_arr);
-        FieldAccessorMacroscopic const Hz(Bz, mu_arr);
-#else
-        Array4<Real> const& Hx = Hfield[0]->array(mfi);
-        Array4<Real> const& Hy = Hfield[1]->array(mfi);
-        Array4<Real> const& Hz = Hfield[2]->array(mfi);
-#endif
+        auto const Hx = HFieldAccessor<T_H_field>(Bx, mu_arr);
+        auto const Hy = HFieldAccessor<T_H_field>(By, mu_arr);
+        auto const Hz = HFieldAccessor<T_H_field>(Bz, mu_arr);
 
         // Extract tileboxes for which to loop
         Box const& tex  = mfi.tilebox(Efield[0]->ixType().toIntVect());
@@ -197,11 +213,9 @@ void FiniteDifferenceSolver::MacroscopicEvolveEPMLCartesian (
 
             [=] AMREX_GPU_DEVICE (int i, int j, int k){
                 // Interpolate conductivity, sigma, to Ex position on the grid
-                amrex::Real const sigma_interp = CoarsenIO::Interp( sigma_arr, sigma_stag,
-                                           Ex_stag, macro_cr, i, j, k, scomp);
+                amrex::Real const sigma_interp = sigma_Ex_stencil(sigma_arr, i, j, k, scomp);
                 // Interpolated permittivity, epsilon, to Ex position on the grid
-                amrex::Real const epsilon_interp = CoarsenIO::Interp( eps_arr, epsilon_stag,
-                                           Ex_stag, macro_cr, i, j, k, scomp);
+                amrex::Real const epsilon_interp = epsilon_Ex_stencil(eps_arr, i, j, k, scomp);
                 amrex::Real alpha = T_MacroAlgo::alpha( sigma_interp, epsilon_interp, dt);
                 amrex::Real beta = T_MacroAlgo::beta( sigma_interp, epsilon_interp, dt);
 
@@ -211,15 +225,17 @@ void FiniteDifferenceSolver::MacroscopicEvolveEPMLCartesian (
                 Ex(i, j, k, PMLComp::xy) = alpha * Ex(i, j, k, PMLComp::xy) + beta * (
                     T_Algo::DownwardDy(Hz, coefs_y, n_coefs_y, i, j, k, PMLComp::zx)
                   + T_Algo::DownwardDy(Hz, coefs_y, n_coefs_y, i, j, k, PMLComp::zy) );
+                if (damp) {
+                    warpx_damp_pml_ex(i, j, k, Ex, Ex_pml_stag, f.sigma_fac_x, f.sigma_fac_y, f.sigma_fac_z,
+                        f.sigma_star_fac_x, f.sigma_star_fac_y, f.sigma_star_fac_z, f.xlo, f.ylo, f.zlo, false);
+                }
             },
 
             [=] AMREX_GPU_DEVICE (int i, int j, int k){
                 // Interpolate conductivity, sigma, to Ey position on the grid
-                amrex::Real const sigma_interp = CoarsenIO::Interp( sigma_arr, sigma_stag,
-                                           Ey_stag, macro_cr, i, j, k, scomp);
+                amrex::Real const sigma_interp = sigma_Ey_stencil(sigma_arr, i, j, k, scomp);
                 // Interpolated permittivity, epsilon, to Ey position on the grid
-                amrex::Real const epsilon_interp = CoarsenIO::Interp( eps_arr, epsilon_stag,
-                                           Ey_stag, macro_cr, i, j, k, scomp);
+                amrex::Real const epsilon_interp = epsilon_Ey_stencil(eps_arr, i, j, k, scomp);
                 amrex::Real alpha = T_MacroAlgo::alpha( sigma_interp, epsilon_interp, dt);
                 amrex::Real beta = T_MacroAlgo::beta( sigma_interp, epsilon_interp, dt);
 
@@ -229,15 +245,17 @@ void FiniteDifferenceSolver::MacroscopicEvolveEPMLCartesian (
                 Ey(i, j, k, PMLComp::yz) = alpha * Ey(i, j, k, PMLComp::yz) + beta * (
                     T_Algo::DownwardDz(Hx, coefs_z, n_coefs_z, i, j, k, PMLComp::xy)
                   + T_Algo::DownwardDz(Hx, coefs_z, n_coefs_z, i, j, k, PMLComp::xz) );
+                if (damp) {
+                    warpx_damp_pml_ey(i, j, k, Ey, Ey_pml_stag, f.sigma_fac_x, f.sigma_fac_y, f.sigma_fac_z,
+                        f.sigma_star_fac_x, f.sigma_star_fac_y, f.sigma_star_fac_z, f.xlo, f.ylo, f.zlo, false);
+                }
             },
 
             [=] AMREX_GPU_DEVICE (int i, int j, int k){
                 // Interpolate conductivity, sigma, to Ez position on the grid
-                amrex::Real const sigma_interp = CoarsenIO::Interp( sigma_arr, sigma_stag,
-                                           Ez_stag, macro_cr, i, j, k, scomp);
+                amrex::Real const sigma_interp = sigma_Ez_stencil(sigma_arr, i, j, k, scomp);
                 // Interpolated permittivity, epsilon, to Ez position on the grid
-                amrex::Real const epsilon_interp = CoarsenIO::Interp( eps_arr, epsilon_stag,
-                                           Ez_stag, macro_cr, i, j, k, scomp);
+                amrex::Real const epsilon_interp = epsilon_Ez_stencil(eps_arr, i, j, k, scomp);
                 amrex::Real alpha = T_MacroAlgo::alpha( sigma_interp, epsilon_interp, dt);
                 amrex::Real beta = T_MacroAlgo::beta( sigma_interp, epsilon_interp, dt);
 
@@ -247,6 +265,10 @@ void FiniteDifferenceSolver::MacroscopicEvolveEPMLCartesian (
                 Ez(i, j, k, PMLComp::zx) = alpha * Ez(i, j, k, PMLComp::zx) + beta * (
                     T_Algo::DownwardDx(Hy, coefs_x, n_coefs_x, i, j, k, PMLComp::yx)
                   + T_Algo::DownwardDx(Hy, coefs_x, n_coefs_x, i, j, k, PMLComp::yz) );
+                if (damp) {
+                    warpx_damp_pml_ez(i, j, k, Ez, Ez_pml_stag, f.sigma_fac_x, f.sigma_fac_y, f.sigma_fac_z,
+                        f.sigma_star_fac_x, f.sigma_star_fac_y, f.sigma_star_fac_z, f.xlo, f.ylo, f.zlo, false);
+                }
             }
 
         );
@@ -274,11 +296,9 @@ void FiniteDifferenceSolver::MacroscopicEvolveEPMLCartesian (
             amrex::ParallelFor( tex, tey, tez,
                 [=] AMREX_GPU_DEVICE (int i, int j, int k) {
                     // Interpolate conductivity, sigma, to Ex position on the grid
-                    amrex::Real const sigma_interp = CoarsenIO::Interp( sigma_arr, sigma_stag,
-                                               Ex_stag, macro_cr, i, j, k, scomp);
+                    amrex::Real const sigma_interp = sigma_Ex_stencil(sigma_arr, i, j, k, scomp);
                     // Interpolated permittivity, epsilon, to Ex position on the grid
-                    amrex::Real const epsilon_interp = CoarsenIO::Interp( eps_arr, epsilon_stag,
-                                               Ex_stag, macro_cr, i, j, k, scomp);
+                    amrex::Real const epsilon_interp = epsilon_Ex_stencil(eps_arr, i, j, k, scomp);
                     amrex::Real beta = T_MacroAlgo::beta( sigma_interp, epsilon_interp, dt);
 
                     push_ex_pml_current(i, j, k, Ex, Jx,
@@ -286,11 +306,9 @@ void FiniteDifferenceSolver::MacroscopicEvolveEPMLCartesian (
                 },
                 [=] AMREX_GPU_DEVICE (int i, int j, int k) {
                     // Interpolate conductivity, sigma, to Ey position on the grid
-                    amrex::Real const sigma_interp = CoarsenIO::Interp( sigma_arr, sigma_stag,
-                                               Ey_stag, macro_cr, i, j, k, scomp);
+                    amrex::Real const sigma_interp = sigma_Ey_stencil(sigma_arr, i, j, k, scomp);
                     // Interpolated permittivity, epsilon, to Ey position on the grid
-                    amrex::Real const epsilon_interp = CoarsenIO::Interp( eps_arr, epsilon_stag,
-                                               Ey_stag, macro_cr, i, j, k, scomp);
+                    amrex::Real const epsilon_interp = epsilon_Ey_stencil(eps_arr, i, j, k, scomp);
                     amrex::Real beta = T_MacroAlgo::beta( sigma_interp, epsilon_interp, dt);
 
                     push_ey_pml_current(i, j, k, Ey, Jy,
@@ -298,11 +316,9 @@ void FiniteDifferenceSolver::MacroscopicEvolveEPMLCartesian (
                 },
                 [=] AMREX_GPU_DEVICE (int i, int j, int k) {
                     // Interpolate conductivity, sigma, to Ez position on the grid
-                    amrex::Real const sigma_interp = CoarsenIO::Interp( sigma_arr, sigma_stag,
-                                               Ez_stag, macro_cr, i, j, k, scomp);
+                    amrex::Real const sigma_interp = sigma_Ez_stencil(sigma_arr, i, j, k, scomp);
                     // Interpolated permittivity, epsilon, to Ez position on the grid
-                    amrex::Real const epsilon_interp = CoarsenIO::Interp( eps_arr, epsilon_stag,
-                                               Ez_stag, macro_cr, i, j, k, scomp);
+                    amrex::Real const epsilon_interp = epsilon_Ez_stencil(eps_arr, i, j, k, scomp);
                     amrex::Real beta = T_MacroAlgo::beta( sigma_interp, epsilon_interp, dt);
 
                     push_ez_pml_current(i, j, k, Ez, Jz,
@@ -315,4 +331,124 @@ void FiniteDifferenceSolver::MacroscopicEvolveEPMLCartesian (
 
 }
 
+#ifdef WARPX_MAG_LLG
+/**
+ * \brief Update the unsplit E field in the CPML, over one timestep: the derivatives of H
+ * along the directions normal to the layers are stretched with their auxiliary variables psi
+ */
+template<typename T_Algo, typename T_MacroAlgo>
+void FiniteDifferenceSolver::MacroscopicEvolveECPMLCartesian (
+    std::array< amrex::MultiFab*, 3 > Efield,
+    std::array< amrex::MultiFab*, 3 > const Hfield,
+    MultiSigmaBox const& sigba,
+    amrex::Real const dt,
+    std::unique_ptr<MacroscopicProperties> const& macroscopic_properties,
+    amrex::MultiFab* const eps_mf,
+    amrex::MultiFab* const sigma_mf,
+    CPMLPsi& cpml_psi)
+{
+    // Index type required for building the CoarsenIO::InterpStencil that interpolates macroscopic
+    // properties from their respective staggering to the Ex, Ey, Ez locations
+    amrex::GpuArray<int, 3> const& sigma_stag = macroscopic_properties->sigma_IndexType;
+    amrex::GpuArray<int, 3> const& epsilon_stag = macroscopic_properties->epsilon_IndexType;
+    amrex::GpuArray<int, 3> const& macro_cr     = macroscopic_properties->macro_cr_ratio;
+    amrex::GpuArray<int, 3> const& Ex_stag = macroscopic_properties->Ex_IndexType;
+    amrex::GpuArray<int, 3> const& Ey_stag = macroscopic_properties->Ey_IndexType;
+    amrex::GpuArray<int, 3> const& Ez_stag = macroscopic_properties->Ez_IndexType;
+    CoarsenIO::InterpStencil const sigma_Ex_stencil(sigma_stag, Ex_stag, macro_cr);
+    CoarsenIO::InterpStencil const sigma_Ey_stencil(sigma_stag, Ey_stag, macro_cr);
+    CoarsenIO::InterpStencil const sigma_Ez_stencil(sigma_stag, Ez_stag, macro_cr);
+    CoarsenIO::InterpStencil const epsilon_Ex_stencil(epsilon_stag, Ex_stag, macro_cr);
+    CoarsenIO::InterpStencil const epsilon_Ey_stencil(epsilon_stag, Ey_stag, macro_cr);
+    CoarsenIO::InterpStencil const epsilon_Ez_stencil(epsilon_stag, Ez_stag, macro_cr);
+
+    // Staggering of the PML fields along x, y, z, to select sigma or sigma_star
+    amrex::GpuArray<int, 3> const Ex_pml_stag = GetCPMLStaggering(*Efield[0]);
+    amrex::GpuArray<int, 3> const Ey_pml_stag = GetCPMLStaggering(*Efield[1]);
+    amrex::GpuArray<int, 3> const Ez_pml_stag = GetCPMLStaggering(*Efield[2]);
+
+    // Loop through the grids, and over the tiles within each grid
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#endif
+    for ( MFIter mfi(*Efield[0], TilingIfNotGPU()); mfi.isValid(); ++mfi ) {
+
+        // Extract field data for this grid/tile
+        Array4<Real> const& Ex = Efield[0]->array(mfi);
+        Array4<Real> const& Ey = Efield[1]->array(mfi);
+        Array4<Real> const& Ez = Efield[2]->array(mfi);
+        Array4<Real> const& Hx = Hfield[0]->array(mfi);
+        Array4<Real> const& Hy = Hfield[1]->array(mfi);
+        Array4<Real> const& Hz = Hfield[2]->array(mfi);
+        // material prop //
+        amrex::Array4<amrex::Real> const& sigma_arr = sigma_mf->array(mfi);
+        amrex::Array4<amrex::Real> const& eps_arr = eps_mf->array(mfi);
+
+        // Damping coefficients and auxiliary variables of this box
+        CPMLSigma const s = GetCPMLSigma(sigba[mfi]);
+        CPMLPsiArrays const p = GetCPMLPsiArrays(cpml_psi, mfi.index());
+
+        // Extract stencil coefficients
+        Real const * const AMREX_RESTRICT coefs_x = m_stencil_coefs_x.dataPtr();
+        int const n_coefs_x = m_stencil_coefs_x.size();
+        Real const * const AMREX_RESTRICT coefs_y = m_stencil_coefs_y.dataPtr();
+        int const n_coefs_y = m_stencil_coefs_y.size();
+        Real const * const AMREX_RESTRICT coefs_z = m_stencil_coefs_z.dataPtr();
+        int const n_coefs_z = m_stencil_coefs_z.size();
+
+        // Extract tileboxes for which to loop
+        Box const& tex  = mfi.tilebox(Efield[0]->ixType().toIntVect());
+        Box const& tey  = mfi.tilebox(Efield[1]->ixType().toIntVect());
+        Box const& tez  = mfi.tilebox(Efield[2]->ixType().toIntVect());
+        // starting component to interpolate macro properties to Ex, Ey, Ez locations
+        const int scomp = 0;
+        // Loop over the cells and update the fields
+        amrex::ParallelFor(tex, tey, tez,
+
+            [=] AMREX_GPU_DEVICE (int i, int j, int k){
+                amrex::Real const sigma_interp = sigma_Ex_stencil(sigma_arr, i, j, k, scomp);
+                amrex::Real const epsilon_interp = epsilon_Ex_stencil(eps_arr, i, j, k, scomp);
+                amrex::Real alpha = T_MacroAlgo::alpha( sigma_interp, epsilon_interp, dt);
+                amrex::Real beta = T_MacroAlgo::beta( sigma_interp, epsilon_interp, dt);
+
+                Real const dy_Hz = cpml_derivative(p.psi[1][0], s, 1, Ex_pml_stag[1], i, j, k, dt,
+                    T_Algo::DownwardDy(Hz, coefs_y, n_coefs_y, i, j, k, 0));
+                Real const dz_Hy = cpml_derivative(p.psi[2][0], s, 2, Ex_pml_stag[2], i, j, k, dt,
+                    T_Algo::DownwardDz(Hy, coefs_z, n_coefs_z, i, j, k, 0));
+                Ex(i, j, k) = alpha * Ex(i, j, k) + beta * (dy_Hz - dz_Hy);
+            },
+
+            [=] AMREX_GPU_DEVICE (int i, int j, int k){
+                amrex::Real const sigma_interp = sigma_Ey_stencil(sigma_arr, i, j, k, scomp);
+                amrex::Real const epsilon_interp = epsilon_Ey_stencil(eps_arr, i, j, k, scomp);
+                amrex::Real alpha = T_MacroAlgo::alpha( sigma_interp, epsilon_interp, dt);
+                amrex::Real beta = T_MacroAlgo::beta( sigma_interp, epsilon_interp, dt);
+
+                Real const dz_Hx = cpml_derivative(p.psi[2][1], s, 2, Ey_pml_stag[2], i, j, k, dt,
+                    T_Algo::DownwardDz(Hx, coefs_z, n_coefs_z, i, j, k, 0));
+                Real const dx_Hz = cpml_derivative(p.psi[0][1], s, 0, Ey_pml_stag[0], i, j, k, dt,
+                    T_Algo::DownwardDx(Hz, coefs_x, n_coefs_x, i, j, k, 0));
+                Ey(i, j, k) = alpha * Ey(i, j, k) + beta * (dz_Hx - dx_Hz);
+            },
+
+            [=] AMREX_GPU_DEVICE (int i, int j, int k){
+                amrex::Real const sigma_interp = sigma_Ez_stencil(sigma_arr, i, j, k, scomp);
+                amrex::Real const epsilon_interp = epsilon_Ez_stencil(eps_arr, i, j, k, scomp);
+                amrex::Real alpha = T_MacroAlgo::alpha( sigma_interp, epsilon_interp, dt);
+                amrex::Real beta = T_MacroAlgo::beta( sigma_interp, epsilon_interp, dt);
+
+                Real const dx_Hy = cpml_derivative(p.psi[0][2], s, 0, Ez_pml_stag[0], i, j, k, dt,
+                    T_Algo::DownwardDx(Hy, coefs_x, n_coefs_x, i, j, k, 0));
+                Real const dy_Hx = cpml_derivative(p.psi[1][2], s, 1, Ez_pml_stag[1], i, j, k, dt,
+                    T_Algo::DownwardDy(Hx, coefs_y, n_coefs_y, i, j, k, 0));
+                Ez(i, j, k) = alpha * Ez(i, j, k) + beta * (dx_Hy - dy_Hx);
+            }
+
+        );
+
+    }
+
+}
+#endif
+
 #endif // corresponds to ifndef WARPX_DIM_RZ
@@ -2,8 +2,11 @@
  * License: BSD-3-Clause-LBNL
  */
 
+#include "WarpX.H"
+#include "Parallelization/CostsBreakdown.H"
 #include "Utils/WarpXAlgorithmSelection.H"
 #include "FiniteDifferenceSolver.H"
+#include "LLGCompileTimeOptions.H"
 #ifdef WARPX_DIM_RZ
 #include "FiniteDifferenceAlgorithms/CylindricalYeeAlgorithm.H"
 #else
@@ -11,11 +14,21 @@
 #include "FiniteDifferenceAlgorithms/CartesianCKCAlgorithm.H"
 #include "FiniteDifferenceAlgorithms/CartesianNodalAlgorithm.H"
 #include "FieldSolver/FiniteDifferenceSolver/MacroscopicProperties/MacroscopicProperties.H"
+#include "FieldSolver/FiniteDifferenceSolver/MacroscopicProperties/MagSpinTorque.H"
 #endif
 #include "Utils/WarpXConst.H"
 #include "Utils/CoarsenIO.H"
+#include "Utils/StaticDataMemory.H"
 #include "Utils/WarpXUtil.H"
 #include <AMReX_Gpu.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_Reduce.H>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
 
 using namespace amrex;
 
@@ -27,91 +40,1022 @@ using namespace amrex;
 #ifdef WARPX_MAG_LLG
 
 void FiniteDifferenceSolver::MacroscopicEvolveHM(
+    int lev,
     // The MField here is a vector of three multifabs, with M on each face.
     // Each M-multifab has three components, one for each component in x, y, z. (All multifabs are four dimensional, (i,j,k,n)), where, n=1 for E, B, but, n=3 for M_xface, M_yface, M_zface
     std::array<std::unique_ptr<amrex::MultiFab>, 3> &Mfield,
     std::array<std::unique_ptr<amrex::MultiFab>, 3> &Hfield, // H Maxwell
-    std::array<std::unique_ptr<amrex::MultiFab>, 3> &Bfield,
     std::array<std::unique_ptr<amrex::MultiFab>, 3> const &H_biasfield, // H bias
     std::array<std::unique_ptr<amrex::MultiFab>, 3> const &Efield,
+    std::array<std::unique_ptr<amrex::MultiFab>, 3> const &face_areas,
+    std::array<std::unique_ptr<amrex::MultiFab>, 3> const &ect_minus_curlE,
     amrex::Real const dt,
+    amrex::Real const dt_M,
     std::unique_ptr<MacroscopicProperties> const &macroscopic_properties)
 {
 
-    if (m_fdtd_algo == MaxwellSolverAlgo::Yee)
+    // with ECT, the H update takes the conformal circulation of E and the M update is the Yee one
+    if (m_fdtd_algo == MaxwellSolverAlgo::Yee || m_fdtd_algo == MaxwellSolverAlgo::ECT)
     {
-        MacroscopicEvolveHMCartesian<CartesianYeeAlgorithm>(Mfield, Hfield, Bfield, H_biasfield, Efield, dt, macroscopic_properties);
+        // the coupling options are template parameters of the kernels, so that they are compiled without branches on them
+        auto &warpx = WarpX::GetInstance();
+        LLGOptions::DispatchCouplings(warpx.mag_LLG_coupling, warpx.mag_M_normalization,
+                                      warpx.mag_LLG_exchange_coupling, warpx.mag_LLG_anisotropy_coupling,
+            [&] (auto c, auto n, auto e, auto a) {
+                MacroscopicEvolveHMCartesian<CartesianYeeAlgorithm, decltype(c)::value, decltype(n)::value, decltype(e)::value, decltype(a)::value>(lev, Mfield, Hfield, H_biasfield, Efield, face_areas, ect_minus_curlE, dt, dt_M, macroscopic_properties);
+            });
     }
     else
     {
         amrex::Abort("Only yee algorithm is compatible for H and M updates.");
     }
 } // closes function EvolveM
+
+amrex::Real FiniteDifferenceSolver::MaxLLGPrecessionRate (
+    int lev,
+    std::array<std::unique_ptr<amrex::MultiFab>, 3> const &Hfield,
+    std::array<std::unique_ptr<amrex::MultiFab>, 3> const &H_biasfield,
+    std::unique_ptr<MacroscopicProperties> const &macroscopic_properties)
+{
+    amrex::GpuArray<amrex::Real, 3> rate_max;
+
+    // H_bias is either stored on the faces, or uniform (warpx.mag_H_bias_uniform = 1)
+    bool const H_bias_uniform = (H_biasfield[0] == nullptr);
+    amrex::GpuArray<amrex::Real, 3> const H_bias_value = H_bias_uniform
+        ? WarpX::GetInstance().getH_bias_uniform(lev) : amrex::GpuArray<amrex::Real, 3>{0._rt, 0._rt, 0._rt};
+
+    for (int idim = 0; idim < 3; idim++){
+        amrex::ReduceOps<amrex::ReduceOpMax> reduce_op;
+        amrex::ReduceData<amrex::Real> reduce_data(reduce_op);
+        using ReduceTuple = typename decltype(reduce_data)::Type;
+
+        auto& mag_Ms_mf = macroscopic_properties->getmag_Ms_mf(idim);
+        auto& mag_gamma_mf = macroscopic_properties->getmag_gamma_mf(idim);
+
+        // H and M are both face-centered, so that H[idim] is at the same location as Ms[idim]
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#endif
+        for (MFIter mfi(*Hfield[idim], TilingIfNotGPU()); mfi.isValid(); ++mfi){
+            if (!macroscopic_properties->has_magnetic_material(mfi.index())) continue;
+            Box const& tb = mfi.tilebox();
+            Array4<Real const> const& H = Hfield[idim]->const_array(mfi);
+            Array4<Real const> const H_bias = H_bias_uniform ? Array4<Real const>{} : H_biasfield[idim]->const_array(mfi);
+            Real const H_bias_uniform_value = H_bias_value[idim];
+            Array4<Real const> const& Ms = mag_Ms_mf.const_array(mfi);
+            Array4<Real const> const& gamma = mag_gamma_mf.const_array(mfi);
+            reduce_op.eval(tb, reduce_data,
+            [=] AMREX_GPU_DEVICE (int i, int j, int k) -> ReduceTuple
+            {
+                if (Ms(i, j, k) <= 0._rt) return {0._rt};
+                return {amrex::Math::abs(gamma(i, j, k)) * PhysConst::mu0 * amrex::Math::abs(H(i, j, k) + (H_bias_uniform ? H_bias_uniform_value : H_bias(i, j, k)))};
+            });
+        }
+        rate_max[idim] = amrex::max(amrex::get<0>(reduce_data.value()), 0._rt);
+    }
+    amrex::ParallelDescriptor::ReduceRealMax(rate_max.data(), 3);
+
+    return std::sqrt(rate_max[0]*rate_max[0] + rate_max[1]*rate_max[1] + rate_max[2]*rate_max[2]);
+}
+#endif
+
+#ifdef WARPX_MAG_LLG
+namespace {
+    // Dormand-Prince RK5(4) coefficients: a_{sl} of the stages, and the difference e_l between
+    // the fifth- and fourth-order weights, which gives the local error estimate.
+    // The last stage is evaluated at the fifth-order solution, whose weights are a_{6l}.
+    constexpr int llg_rk_nstages = 7;
+    constexpr amrex::Real llg_rk_a[llg_rk_nstages][llg_rk_nstages] = {
+        {0., 0., 0., 0., 0., 0., 0.},
+        {1./5., 0., 0., 0., 0., 0., 0.},
+        {3./40., 9./40., 0., 0., 0., 0., 0.},
+        {44./45., -56./15., 32./9., 0., 0., 0., 0.},
+        {19372./6561., -25360./2187., 64448./6561., -212./729., 0., 0., 0.},
+        {9017./3168., -355./33., 46732./5247., 49./176., -5103./18656., 0., 0.},
+        {35./384., 0., 500./1113., 125./192., -2187./6784., 11./84., 0.}
+    };
+    constexpr amrex::Real llg_rk_e[llg_rk_nstages] = {
+        71./57600., 0., -71./16695., 71./1920., -17253./339200., 22./525., -1./40.
+    };
+
+    // work arrays of the implicit LLG solver: M^n, the Newton iterate, the midpoint, dM/dt at the
+    // midpoint, the residual at the iterate, and the perturbed iterate of the Jacobian-vector products
+    enum LLGImplicitWork {
+        llg_implicit_Mn = 0, llg_implicit_X, llg_implicit_mid, llg_implicit_dMdt, llg_implicit_R,
+        llg_implicit_Xp, llg_implicit_nwork
+    };
+
+    /** \brief Shift the guard cells of the stage Mstage outside of the non-periodic domain boundaries
+     *  by the increment Mstage - M of the nearest face of the valid box, where M is the start of the
+     *  sub-step. FillBoundary does not reach these guard cells, which would otherwise keep M. */
+    void ShiftDomainGuardCells (amrex::MultiFab& Mstage, amrex::MultiFab const& M, amrex::Geometry const& geom)
+    {
+        // the guard cells outside of this box are outside of a non-periodic boundary
+        amrex::Box inside = amrex::convert(geom.Domain(), Mstage.ixType());
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim){
+            if (geom.isPeriodic(idim)) inside.grow(idim, Mstage.nGrow(idim));
+        }
+        amrex::Dim3 const in_lo = amrex::lbound(inside);
+        amrex::Dim3 const in_hi = amrex::ubound(inside);
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#endif
+        for (amrex::MFIter mfi(Mstage); mfi.isValid(); ++mfi)
+        {
+            amrex::Box const& gbx = mfi.fabbox();
+            if (inside.contains(gbx)) continue;
+            amrex::Dim3 const lo = amrex::lbound(mfi.validbox());
+            amrex::Dim3 const hi = amrex::ubound(mfi.validbox());
+            amrex::Array4<amrex::Real> const& M_stage = Mstage.array(mfi);
+            amrex::Array4<amrex::Real const> const& M_start = M.const_array(mfi);
+
+            amrex::ParallelFor(gbx, Mstage.nComp(),
+                [=] AMREX_GPU_DEVICE(int i, int j, int k, int n) {
+                    if (i >= in_lo.x && i <= in_hi.x && j >= in_lo.y && j <= in_hi.y
+                        && k >= in_lo.z && k <= in_hi.z) return;
+                    int const iv = amrex::min(amrex::max(i, lo.x), hi.x);
+                    int const jv = amrex::min(amrex::max(j, lo.y), hi.y);
+                    int const kv = amrex::min(amrex::max(k, lo.z), hi.z);
+                    M_stage(i, j, k, n) = M_start(i, j, k, n) + M_stage(iv, jv, kv, n) - M_start(iv, jv, kv, n);
+            });
+        }
+    }
+}
+
+template <typename T_Algo, int T_coupling, int T_M_normalization, int T_exchange_coupling, int T_anisotropy_coupling>
+void FiniteDifferenceSolver::LLGRightHandSideCartesian (
+    int lev,
+    std::array<std::unique_ptr<amrex::MultiFab>, 3> const &Mfield,
+    std::array<std::unique_ptr<amrex::MultiFab>, 3> const &Hfield,
+    std::array<std::unique_ptr<amrex::MultiFab>, 3> const &H_biasfield,
+    std::array<std::unique_ptr<amrex::MultiFab>, 3> &dMdt,
+    std::unique_ptr<MacroscopicProperties> const &macroscopic_properties)
+{
+    amrex::LayoutData<amrex::Real>* cost = WarpX::getCosts(lev);
+
+    // options of the LLG equation
+    constexpr int coupling = T_coupling;
+    constexpr int M_normalization = T_M_normalization;
+    constexpr int mag_exchange_coupling = T_exchange_coupling;
+    constexpr int mag_anisotropy_coupling = T_anisotropy_coupling;
+    // spin torques (0: off, 1: on), a runtime branch, since they are seldom used
+    int const mag_spin_torque_coupling = WarpX::GetInstance().mag_LLG_spin_torque_coupling;
+    // time at which the current density of the spin torques is evaluated
+    amrex::Real const spin_torque_time = WarpX::GetInstance().gett_new(lev);
+
+    // anisotropy axes of the grains, and type of the anisotropy
+    amrex::Real const* const anisotropy_axes = macroscopic_properties->getmag_anisotropy_axes();
+    int const anisotropy_type = macroscopic_properties->getmag_anisotropy_type();
+
+    amrex::IntVect const Mxface_stag = Mfield[0]->ixType().toIntVect();
+    amrex::IntVect const Myface_stag = Mfield[1]->ixType().toIntVect();
+    amrex::IntVect const Mzface_stag = Mfield[2]->ixType().toIntVect();
+
+    // H_bias is either stored on the faces, or uniform (warpx.mag_H_bias_uniform = 1)
+    bool const H_bias_uniform = (H_biasfield[0] == nullptr);
+    amrex::GpuArray<amrex::Real, 3> const H_bias_value = H_bias_uniform
+        ? WarpX::GetInstance().getH_bias_uniform(lev) : amrex::GpuArray<amrex::Real, 3>{0._rt, 0._rt, 0._rt};
+
+    // Extract stencil coefficients for calculating the exchange field H_exchange
+    amrex::Real const *const AMREX_RESTRICT coefs_x = m_stencil_coefs_x.dataPtr();
+    int const n_coefs_x = m_stencil_coefs_x.size();
+    amrex::Real const *const AMREX_RESTRICT coefs_y = m_stencil_coefs_y.dataPtr();
+    int const n_coefs_y = m_stencil_coefs_y.size();
+    amrex::Real const *const AMREX_RESTRICT coefs_z = m_stencil_coefs_z.dataPtr();
+    int const n_coefs_z = m_stencil_coefs_z.size();
+
+    // static data in managed memory is migrated to the device one box ahead of the loop
+    StaticDataPrefetcher prefetch;
+    macroscopic_properties->AddMagStaticData(prefetch);
+    for (auto const& H_bias : H_biasfield) prefetch.Add(H_bias.get());
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi(*Mfield[0], TilingIfNotGPU()); mfi.isValid(); ++mfi)
+    {
+        prefetch.Next(mfi);
+        if (!macroscopic_properties->has_magnetic_material(mfi.index())) continue;
+        CostBoxTimer cost_box(cost, mfi.index());
+
+        // spin torques of the current density on this box
+        MagSpinTorque const spin_torque = (mag_spin_torque_coupling == 1)
+            ? macroscopic_properties->GetSpinTorque(mfi, lev, spin_torque_time) : MagSpinTorque{};
+
+        Array4<Real> const &Hx = Hfield[0]->array(mfi);
+        Array4<Real> const &Hy = Hfield[1]->array(mfi);
+        Array4<Real> const &Hz = Hfield[2]->array(mfi);
+        Array4<Real> const Hx_bias = H_bias_uniform ? Array4<Real>{} : H_biasfield[0]->array(mfi);
+        Array4<Real> const Hy_bias = H_bias_uniform ? Array4<Real>{} : H_biasfield[1]->array(mfi);
+        Array4<Real> const Hz_bias = H_bias_uniform ? Array4<Real>{} : H_biasfield[2]->array(mfi);
+
+        // the three face types only differ by their arrays and their staggering
+        for (int idim = 0; idim < 3; ++idim)
+        {
+            Array4<Real> const &M_face = Mfield[idim]->array(mfi); // note M_face include x,y,z components at the idim faces
+            Array4<Real> const &dMdt_face = dMdt[idim]->array(mfi);
+            Array4<Real> const &mag_Ms_arr = macroscopic_properties->getmag_Ms_mf(idim).array(mfi);
+            Array4<Real> const &mag_alpha_arr = macroscopic_properties->getmag_alpha_mf(idim).array(mfi);
+            Array4<MacroscopicProperties::MagCoefReal const> const& mag_coefs_arr = macroscopic_properties->getmag_coefs_mf(idim).const_array(mfi);
+            Array4<int const> const grain_arr = macroscopic_properties->getmag_grain_array(idim, mfi);
+            amrex::IntVect const Mface_stag = Mfield[idim]->ixType().toIntVect();
+            int const nodality = idim;
+
+            Box const &tb = mfi.tilebox(Hfield[idim]->ixType().toIntVect());
+
+            amrex::ParallelFor(tb,
+                [=] AMREX_GPU_DEVICE(int i, int j, int k) {
+
+                    // nonmagnetic faces are not advanced
+                    if (mag_Ms_arr(i,j,k) <= 0._rt) {
+                        for (int comp=0; comp<3; ++comp) dMdt_face(i, j, k, comp) = 0._rt;
+                        return;
+                    }
+
+                    // H_bias
+                    amrex::Real Hx_eff = MacroscopicProperties::getH_bias(i, j, k, Mxface_stag, Mface_stag, Hx_bias, H_bias_uniform, H_bias_value[0]);
+                    amrex::Real Hy_eff = MacroscopicProperties::getH_bias(i, j, k, Myface_stag, Mface_stag, Hy_bias, H_bias_uniform, H_bias_value[1]);
+                    amrex::Real Hz_eff = MacroscopicProperties::getH_bias(i, j, k, Mzface_stag, Mface_stag, Hz_bias, H_bias_uniform, H_bias_value[2]);
+                    if (coupling == 1)
+                    {
+                        // H_maxwell - use H^(old_time) at all the stages
+                        Hx_eff += MacroscopicProperties::face_avg_to_face(i, j, k, 0, Mxface_stag, Mface_stag, Hx);
+                        Hy_eff += MacroscopicProperties::face_avg_to_face(i, j, k, 0, Myface_stag, Mface_stag, Hy);
+                        Hz_eff += MacroscopicProperties::face_avg_to_face(i, j, k, 0, Mzface_stag, Mface_stag, Hz);
+                    }
+
+                    if (mag_exchange_coupling == 1){
+
+                        // H_exchange - use M of the stage
+                        amrex::Real const H_exchange_coeff = mag_coefs_arr(i,j,k,MacroscopicProperties::mag_coef_exchange);
+
+                        amrex::Real Ms_lo_x = mag_Ms_arr(i-1, j, k);
+                        amrex::Real Ms_hi_x = mag_Ms_arr(i+1, j, k);
+                        amrex::Real Ms_lo_y = mag_Ms_arr(i, j-1, k);
+                        amrex::Real Ms_hi_y = mag_Ms_arr(i, j+1, k);
+                        amrex::Real Ms_lo_z = mag_Ms_arr(i, j, k-1);
+                        amrex::Real Ms_hi_z = mag_Ms_arr(i, j, k+1);
+
+                        Hx_eff += H_exchange_coeff * T_Algo::Laplacian_Mag(M_face, coefs_x, coefs_y, coefs_z, n_coefs_x, n_coefs_y, n_coefs_z, Ms_lo_x, Ms_hi_x, Ms_lo_y, Ms_hi_y, Ms_lo_z, Ms_hi_z, i, j, k, 0, nodality);
+                        Hy_eff += H_exchange_coeff * T_Algo::Laplacian_Mag(M_face, coefs_x, coefs_y, coefs_z, n_coefs_x, n_coefs_y, n_coefs_z, Ms_lo_x, Ms_hi_x, Ms_lo_y, Ms_hi_y, Ms_lo_z, Ms_hi_z, i, j, k, 1, nodality);
+                        Hz_eff += H_exchange_coeff * T_Algo::Laplacian_Mag(M_face, coefs_x, coefs_y, coefs_z, n_coefs_x, n_coefs_y, n_coefs_z, Ms_lo_x, Ms_hi_x, Ms_lo_y, Ms_hi_y, Ms_lo_z, Ms_hi_z, i, j, k, 2, nodality);
+                    }
+
+                    if (mag_anisotropy_coupling == 1){
+
+                        // H_anisotropy - use M of the stage
+                        amrex::Real const H_anisotropy_coeff = mag_coefs_arr(i,j,k,MacroscopicProperties::mag_coef_anisotropy);
+                        MacroscopicProperties::addH_anisotropy(i, j, k, grain_arr, anisotropy_axes, anisotropy_type, H_anisotropy_coeff,
+                                                               M_face(i, j, k, 0), M_face(i, j, k, 1), M_face(i, j, k, 2), Hx_eff, Hy_eff, Hz_eff);
+                    }
+
+                    if (mag_spin_torque_coupling == 1){
+
+                        // H_spin_torque - use M of the stage
+                        spin_torque.AddEffectiveField(i, j, k, Mface_stag, mag_Ms_arr(i,j,k), M_face(i, j, k, 0), M_face(i, j, k, 1), M_face(i, j, k, 2), Hx_eff, Hy_eff, Hz_eff);
+                    }
+
+                    amrex::Real const Mx = M_face(i, j, k, 0);
+                    amrex::Real const My = M_face(i, j, k, 1);
+                    amrex::Real const Mz = M_face(i, j, k, 2);
+
+                    amrex::Real mag_gammaL = mag_coefs_arr(i,j,k,MacroscopicProperties::mag_coef_gammaL);
+
+                    // 0 = unsaturated; compute |M| locally.  1 = saturated; use M_s
+                    amrex::Real M_magnitude = (M_normalization == 0) ? std::sqrt(Mx*Mx + My*My + Mz*Mz)
+                                                              : mag_Ms_arr(i,j,k);
+                    amrex::Real Gil_damp = PhysConst::mu0 * mag_gammaL * mag_alpha_arr(i,j,k) / M_magnitude;
+
+                    // dM/dt = mu0 gammaL (M x H_eff) + Gil_damp M x (M x H_eff)
+                    amrex::Real const MxH_x = My * Hz_eff - Mz * Hy_eff;
+                    amrex::Real const MxH_y = Mz * Hx_eff - Mx * Hz_eff;
+                    amrex::Real const MxH_z = Mx * Hy_eff - My * Hx_eff;
+
+                    dMdt_face(i, j, k, 0) = (PhysConst::mu0 * mag_gammaL) * MxH_x + Gil_damp * (My * MxH_z - Mz * MxH_y);
+                    dMdt_face(i, j, k, 1) = (PhysConst::mu0 * mag_gammaL) * MxH_y + Gil_damp * (Mz * MxH_x - Mx * MxH_z);
+                    dMdt_face(i, j, k, 2) = (PhysConst::mu0 * mag_gammaL) * MxH_z + Gil_damp * (Mx * MxH_y - My * MxH_x);
+            });
+        }
+    }
+}
+
+template <int T_M_normalization>
+void FiniteDifferenceSolver::NormalizeMCartesian (
+    std::array<std::unique_ptr<amrex::MultiFab>, 3> &Mfield,
+    std::array<std::unique_ptr<amrex::MultiFab>, 3> const &Msource,
+    std::unique_ptr<MacroscopicProperties> const &macroscopic_properties)
+{
+    constexpr int M_normalization = T_M_normalization;
+
+    // obtain the maximum relative amount we let M deviate from Ms before aborting
+    amrex::Real mag_normalized_error = macroscopic_properties->getmag_normalized_error();
+
+    amrex::ReduceOps<amrex::ReduceOpMax> reduce_norm_op;
+    amrex::ReduceData<int> reduce_norm_data(reduce_norm_op);
+    using NormTuple = typename decltype(reduce_norm_data)::Type;
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi(*Mfield[0], TilingIfNotGPU()); mfi.isValid(); ++mfi)
+    {
+        if (!macroscopic_properties->has_magnetic_material(mfi.index())) continue;
+        for (int idim = 0; idim < 3; ++idim)
+        {
+            Array4<Real> const &M_face = Mfield[idim]->array(mfi);
+            Array4<Real const> const &M_source = Msource[idim]->const_array(mfi);
+            Array4<Real const> const &mag_Ms_arr = macroscopic_properties->getmag_Ms_mf(idim).const_array(mfi);
+            Box const &tb = mfi.tilebox(Mfield[idim]->ixType().toIntVect());
+
+            reduce_norm_op.eval(tb, reduce_norm_data,
+                [=] AMREX_GPU_DEVICE(int i, int j, int k) -> NormTuple {
+
+                    int norm_flag = MacroscopicProperties::mag_norm_ok;
+                    if (mag_Ms_arr(i,j,k) <= 0._rt) return {norm_flag};
+
+                    amrex::Real const Mx = M_source(i, j, k, 0);
+                    amrex::Real const My = M_source(i, j, k, 1);
+                    amrex::Real const Mz = M_source(i, j, k, 2);
+                    amrex::Real const M_magnitude_normalized = std::sqrt(Mx*Mx + My*My + Mz*Mz) / mag_Ms_arr(i,j,k);
+
+                    // same normalization as the first-order scheme
+                    amrex::Real scale = 1._rt;
+                    if (M_normalization > 0)
+                    {
+                        if (amrex::Math::abs(1._rt - M_magnitude_normalized) > mag_normalized_error)
+                        {
+                            norm_flag = MacroscopicProperties::mag_norm_exceeded;
+                        }
+                        scale = 1._rt / M_magnitude_normalized;
+                    }
+                    else if (M_normalization == 0)
+                    {
+                        if (M_magnitude_normalized > 1._rt + mag_normalized_error)
+                        {
+                            norm_flag = MacroscopicProperties::mag_norm_unsaturated_exceeded;
+                        }
+                        else if (M_magnitude_normalized > 1._rt)
+                        {
+                            scale = 1._rt / M_magnitude_normalized;
+                        }
+                    }
+                    M_face(i, j, k, 0) = scale * Mx;
+                    M_face(i, j, k, 1) = scale * My;
+                    M_face(i, j, k, 2) = scale * Mz;
+                    return {norm_flag};
+            });
+        }
+    }
+    // abort on the host if |M| violated mag_normalized_error anywhere
+    macroscopic_properties->CheckMagNormalizationFlag(amrex::get<0>(reduce_norm_data.value()));
+}
+
+template <typename T_Algo, int T_coupling, int T_M_normalization, int T_exchange_coupling, int T_anisotropy_coupling>
+void FiniteDifferenceSolver::MacroscopicEvolveMCartesian_RK45 (
+    int lev,
+    std::array<std::unique_ptr<amrex::MultiFab>, 3> &Mfield,
+    std::array<std::unique_ptr<amrex::MultiFab>, 3> const &Hfield,
+    std::array<std::unique_ptr<amrex::MultiFab>, 3> const &H_biasfield,
+    amrex::Real const dt_M,
+    std::unique_ptr<MacroscopicProperties> const &macroscopic_properties)
+{
+    constexpr int M_normalization = T_M_normalization;
+
+    auto &warpx = WarpX::GetInstance();
+    amrex::Real const tolerance = warpx.mag_LLG_rk_tolerance;
+    int const max_substeps = warpx.mag_LLG_rk_max_substeps;
+    const auto& period = warpx.Geom(lev).periodicity();
+
+    // the stages and the stage values of M are kept between calls
+    bool up_to_date = true;
+    for (int i = 0; i < 3; i++){
+        up_to_date = up_to_date && m_llg_rk_Mstage[i]
+            && m_llg_rk_Mstage[i]->boxArray() == Mfield[i]->boxArray()
+            && m_llg_rk_Mstage[i]->DistributionMap() == Mfield[i]->DistributionMap()
+            && m_llg_rk_Mstage[i]->nGrowVect() == Mfield[i]->nGrowVect();
+    }
+    if (!up_to_date){
+        m_llg_rk_k.resize(llg_rk_nstages);
+        for (int i = 0; i < 3; i++){
+            m_llg_rk_Mstage[i] = std::make_unique<MultiFab>(Mfield[i]->boxArray(), Mfield[i]->DistributionMap(), 3, Mfield[i]->nGrowVect());
+            for (int s = 0; s < llg_rk_nstages; ++s){
+                m_llg_rk_k[s][i] = std::make_unique<MultiFab>(Mfield[i]->boxArray(), Mfield[i]->DistributionMap(), 3, 0);
+            }
+        }
+    }
+    auto& Mstage = m_llg_rk_Mstage;
+
+    // the sub-step starts from the last accepted one, so that it does not have to be found again at each call
+    bool const adaptive = (tolerance > 0._rt);
+    amrex::Real h = (adaptive && m_llg_rk_dt_sub > 0._rt) ? std::min(m_llg_rk_dt_sub, dt_M) : dt_M;
+
+    amrex::Real t = 0._rt;
+    int nsubsteps = 0;
+    while (t < dt_M)
+    {
+        // do not overshoot the end of the LLG step
+        bool const last = (t + h >= dt_M);
+        amrex::Real const h_step = last ? dt_M - t : h;
+
+        for (int i = 0; i < 3; i++){
+            MultiFab::Copy(*Mstage[i], *Mfield[i], 0, 0, 3, Mfield[i]->nGrowVect());
+        }
+
+        for (int s = 0; s < llg_rk_nstages; ++s)
+        {
+            if (s > 0){
+                // M of the stage s, MStage = M + h_step sum_l a_{sl} k_l
+                amrex::GpuArray<amrex::Real, llg_rk_nstages> coef;
+                for (int l = 0; l < llg_rk_nstages; ++l) coef[l] = h_step * llg_rk_a[s][l];
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#endif
+                for (MFIter mfi(*Mfield[0], TilingIfNotGPU()); mfi.isValid(); ++mfi)
+                {
+                    if (!macroscopic_properties->has_magnetic_material(mfi.index())) continue;
+                    for (int idim = 0; idim < 3; ++idim)
+                    {
+                        Array4<Real> const &M_stage = Mstage[idim]->array(mfi);
+                        Array4<Real const> const &M_face = Mfield[idim]->const_array(mfi);
+                        amrex::GpuArray<Array4<Real const>, llg_rk_nstages> k_face;
+                        for (int l = 0; l < s; ++l) k_face[l] = m_llg_rk_k[l][idim]->const_array(mfi);
+                        Box const &tb = mfi.tilebox(Mfield[idim]->ixType().toIntVect());
+
+                        amrex::ParallelFor(tb, 3,
+                            [=] AMREX_GPU_DEVICE(int i, int j, int k, int n) {
+                                amrex::Real M_value = M_face(i, j, k, n);
+                                for (int l = 0; l < s; ++l) M_value += coef[l] * k_face[l](i, j, k, n);
+                                M_stage(i, j, k, n) = M_value;
+                        });
+                    }
+                }
+                // the exchange field of the stage reads the neighboring faces, also across the domain boundaries
+                for (int i = 0; i < 3; i++){
+                    Mstage[i]->FillBoundary(period);
+                    ShiftDomainGuardCells(*Mstage[i], *Mfield[i], warpx.Geom(lev));
+                }
+            }
+            LLGRightHandSideCartesian<T_Algo, T_coupling, T_M_normalization, T_exchange_coupling, T_anisotropy_coupling>(
+                lev, Mstage, Hfield, H_biasfield, m_llg_rk_k[s], macroscopic_properties);
+        }
+
+        // local error of the fifth-order solution, relative to Ms
+        amrex::Real error = 0._rt;
+        if (adaptive){
+            amrex::ReduceOps<amrex::ReduceOpMax> reduce_op;
+            amrex::ReduceData<amrex::Real> reduce_data(reduce_op);
+            using ReduceTuple = typename decltype(reduce_data)::Type;
+
+            amrex::GpuArray<amrex::Real, llg_rk_nstages> coef;
+            for (int l = 0; l < llg_rk_nstages; ++l) coef[l] = h_step * llg_rk_e[l];
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#endif
+            for (MFIter mfi(*Mfield[0], TilingIfNotGPU()); mfi.isValid(); ++mfi)
+            {
+                if (!macroscopic_properties->has_magnetic_material(mfi.index())) continue;
+                for (int idim = 0; idim < 3; ++idim)
+                {
+                    Array4<Real const> const &mag_Ms_arr = macroscopic_properties->getmag_Ms_mf(idim).const_array(mfi);
+                    amrex::GpuArray<Array4<Real const>, llg_rk_nstages> k_face;
+                    for (int l = 0; l < llg_rk_nstages; ++l) k_face[l] = m_llg_rk_k[l][idim]->const_array(mfi);
+                    Box const &tb = mfi.tilebox(Mfield[idim]->ixType().toIntVect());
+
+                    reduce_op.eval(tb, reduce_data,
+                        [=] AMREX_GPU_DEVICE(int i, int j, int k) -> ReduceTuple {
+                            if (mag_Ms_arr(i,j,k) <= 0._rt) return {0._rt};
+                            amrex::Real error_max = 0._rt;
+                            for (int n = 0; n < 3; ++n){
+                                amrex::Real error_n = 0._rt;
+                                for (int l = 0; l < llg_rk_nstages; ++l) error_n += coef[l] * k_face[l](i, j, k, n);
+                                error_max = amrex::max(error_max, amrex::Math::abs(error_n));
+                            }
+                            return {error_max / mag_Ms_arr(i,j,k)};
+                    });
+                }
+            }
+            error = amrex::get<0>(reduce_data.value());
+            amrex::ParallelDescriptor::ReduceRealMax(error);
+        }
+
+        ++nsubsteps;
+        if (nsubsteps > max_substeps){
+            amrex::Abort("The Runge-Kutta LLG solver exceeded warpx.mag_LLG_rk_max_substeps = "
+                         + std::to_string(max_substeps) + " sub-steps in one LLG step");
+        }
+
+        bool const accepted = (!adaptive || error <= tolerance);
+        if (accepted)
+        {
+            // the last stage is the fifth-order solution
+            NormalizeMCartesian<T_M_normalization>(Mfield, Mstage, macroscopic_properties);
+            for (int i = 0; i < 3; i++) Mfield[i]->FillBoundary(period);
+            t = last ? dt_M : t + h_step;
+        }
+
+        if (adaptive){
+            // standard step size control of an embedded pair of order 5(4), with a safety factor
+            amrex::Real const factor = (error > 0._rt) ? 0.9_rt * std::pow(tolerance / error, 0.2_rt) : 5._rt;
+            amrex::Real const h_new = h_step * amrex::min(5._rt, amrex::max(0.2_rt, factor));
+            // a shortened last sub-step does not limit the next LLG step
+            if (!(accepted && last && h_step < h)) h = h_new;
+        }
+    }
+    if (adaptive) m_llg_rk_dt_sub = h;
+}
+
+template <typename T_Algo, int T_coupling, int T_M_normalization, int T_exchange_coupling, int T_anisotropy_coupling>
+void FiniteDifferenceSolver::MacroscopicEvolveMCartesian_implicit (
+    int lev,
+    std::array<std::unique_ptr<amrex::MultiFab>, 3> &Mfield,
+    std::array<std::unique_ptr<amrex::MultiFab>, 3> const &Hfield,
+    std::array<std::unique_ptr<amrex::MultiFab>, 3> const &H_biasfield,
+    amrex::Real const dt_M,
+    std::unique_ptr<MacroscopicProperties> const &macroscopic_properties)
+{
+    auto &warpx = WarpX::GetInstance();
+    amrex::Real const tolerance = warpx.mag_LLG_implicit_tolerance;
+    int const max_iter = warpx.mag_LLG_implicit_max_iter;
+    int const krylov_dim = warpx.mag_LLG_implicit_krylov_dim;
+    const auto& period = warpx.Geom(lev).periodicity();
+
+    // relative tolerance of the GMRES solve of each Newton iteration (inexact Newton)
+    constexpr amrex::Real forcing = 0.01_rt;
+
+    // the work arrays and the Krylov basis are kept between calls
+    bool up_to_date = m_llg_implicit_work.size() == llg_implicit_nwork
+        && m_llg_implicit_krylov.size() == krylov_dim + 1;
+    for (int i = 0; i < 3 && up_to_date; i++){
+        up_to_date = m_llg_implicit_work[llg_implicit_mid][i]
+            && m_llg_implicit_work[llg_implicit_mid][i]->boxArray() == Mfield[i]->boxArray()
+            && m_llg_implicit_work[llg_implicit_mid][i]->DistributionMap() == Mfield[i]->DistributionMap()
+            && m_llg_implicit_work[llg_implicit_mid][i]->nGrowVect() == Mfield[i]->nGrowVect();
+    }
+    if (!up_to_date){
+        m_llg_implicit_work.resize(llg_implicit_nwork);
+        m_llg_implicit_krylov.resize(krylov_dim + 1);
+        for (int i = 0; i < 3; i++){
+            for (int w = 0; w < llg_implicit_nwork; ++w){
+                // only the midpoint, whose exchange field reads the neighboring faces, has guard cells
+                amrex::IntVect const ng = (w == llg_implicit_mid) ? Mfield[i]->nGrowVect() : amrex::IntVect(0);
+                m_llg_implicit_work[w][i] = std::make_unique<MultiFab>(Mfield[i]->boxArray(), Mfield[i]->DistributionMap(), 3, ng);
+                // dM/dt is not written on the boxes without magnetic material
+                m_llg_implicit_work[w][i]->setVal(0._rt);
+            }
+            for (auto& v : m_llg_implicit_krylov){
+                v[i] = std::make_unique<MultiFab>(Mfield[i]->boxArray(), Mfield[i]->DistributionMap(), 3, 0);
+            }
+        }
+    }
+    auto& Mn = m_llg_implicit_work[llg_implicit_Mn];
+    auto& X = m_llg_implicit_work[llg_implicit_X];
+    auto& Mmid = m_llg_implicit_work[llg_implicit_mid];
+    auto& dMdt = m_llg_implicit_work[llg_implicit_dMdt];
+    auto& R = m_llg_implicit_work[llg_implicit_R];
+    auto& Xp = m_llg_implicit_work[llg_implicit_Xp];
+    auto& V = m_llg_implicit_krylov;
+
+    // residual of the implicit midpoint rule, R(X) = X - M^n - dt_M f((M^n + X)/2), where f is the
+    // right-hand side of the LLG equation with H_maxwell held at H^(old_time)
+    auto residual = [&] (std::array<std::unique_ptr<amrex::MultiFab>, 3> const& Xin,
+                         std::array<std::unique_ptr<amrex::MultiFab>, 3>& Rout) {
+        for (int i = 0; i < 3; i++){
+            MultiFab::LinComb(*Mmid[i], 0.5_rt, *Mn[i], 0, 0.5_rt, *Xin[i], 0, 0, 3, 0);
+            Mmid[i]->FillBoundary(period);
+        }
+        LLGRightHandSideCartesian<T_Algo, T_coupling, T_M_normalization, T_exchange_coupling, T_anisotropy_coupling>(
+            lev, Mmid, Hfield, H_biasfield, dMdt, macroscopic_properties);
+        for (int i = 0; i < 3; i++){
+            MultiFab::LinComb(*Rout[i], 1._rt, *Xin[i], 0, -1._rt, *Mn[i], 0, 0, 3, 0);
+            MultiFab::Saxpy(*Rout[i], -dt_M, *dMdt[i], 0, 0, 3, 0);
+        }
+    };
+    auto dot = [] (std::array<std::unique_ptr<amrex::MultiFab>, 3> const& a,
+                   std::array<std::unique_ptr<amrex::MultiFab>, 3> const& b) {
+        amrex::Real d = 0._rt;
+        for (int i = 0; i < 3; i++) d += MultiFab::Dot(*a[i], 0, *b[i], 0, 3, 0);
+        return d;
+    };
+
+    for (int i = 0; i < 3; i++){
+        MultiFab::Copy(*Mn[i], *Mfield[i], 0, 0, 3, 0);
+        MultiFab::Copy(*X[i], *Mfield[i], 0, 0, 3, 0);
+        // the guard cells of the midpoint outside of the periodic domain are those of M^n
+        MultiFab::Copy(*Mmid[i], *Mfield[i], 0, 0, 3, Mfield[i]->nGrowVect());
+    }
+
+    // Newton iterations, from X = M^n
+    std::vector<amrex::Real> h((krylov_dim + 1) * krylov_dim), cs(krylov_dim), sn(krylov_dim), g(krylov_dim + 1), y(krylov_dim);
+    for (int iter = 0; ; ++iter)
+    {
+        residual(X, R);
+
+        // largest residual, relative to Ms
+        amrex::ReduceOps<amrex::ReduceOpMax> reduce_op;
+        amrex::ReduceData<amrex::Real> reduce_data(reduce_op);
+        using ReduceTuple = typename decltype(reduce_data)::Type;
+        for (MFIter mfi(*Mfield[0]); mfi.isValid(); ++mfi)
+        {
+            if (!macroscopic_properties->has_magnetic_material(mfi.index())) continue;
+            for (int idim = 0; idim < 3; ++idim)
+            {
+                Array4<Real const> const &R_face = R[idim]->const_array(mfi);
+                Array4<Real const> const &mag_Ms_arr = macroscopic_properties->getmag_Ms_mf(idim).const_array(mfi);
+                reduce_op.eval(mfi.validbox(), reduce_data,
+                    [=] AMREX_GPU_DEVICE(int i, int j, int k) -> ReduceTuple {
+                        if (mag_Ms_arr(i,j,k) <= 0._rt) return {0._rt};
+                        amrex::Real const R_max = amrex::max(amrex::Math::abs(R_face(i, j, k, 0)),
+                            amrex::max(amrex::Math::abs(R_face(i, j, k, 1)), amrex::Math::abs(R_face(i, j, k, 2))));
+                        return {R_max / mag_Ms_arr(i,j,k)};
+                });
+            }
+        }
+        amrex::Real error = amrex::get<0>(reduce_data.value());
+        amrex::ParallelDescriptor::ReduceRealMax(error);
+        if (error <= tolerance) break;
+        if (iter == max_iter){
+            amrex::Abort("The implicit LLG solver did not converge to warpx.mag_LLG_implicit_tolerance in "
+                         "warpx.mag_LLG_implicit_max_iter = " + std::to_string(max_iter) + " Newton iterations");
+        }
+
+        // GMRES solve of J delta = -R, with the Jacobian-vector products J v = (R(X + eps v) - R(X)) / eps
+        // of unit vectors v (Knoll and Keyes, J. Comput. Phys. 193, 2004)
+        amrex::Real const beta = std::sqrt(dot(R, R));
+        amrex::Real const eps = std::sqrt(std::numeric_limits<amrex::Real>::epsilon()) * (1._rt + std::sqrt(dot(X, X)));
+        for (int i = 0; i < 3; i++){
+            MultiFab::Copy(*V[0][i], *R[i], 0, 0, 3, 0);
+            V[0][i]->mult(-1._rt / beta);
+        }
+        std::fill(g.begin(), g.end(), 0._rt);
+        g[0] = beta;
+        auto hess = [&] (int row, int col) -> amrex::Real& { return h[row * krylov_dim + col]; };
+
+        int m = 0;
+        for (int j = 0; j < krylov_dim; ++j)
+        {
+            // V_{j+1} = J V_j, orthogonalized against V_0..V_j (modified Gram-Schmidt)
+            for (int i = 0; i < 3; i++) MultiFab::LinComb(*Xp[i], 1._rt, *X[i], 0, eps, *V[j][i], 0, 0, 3, 0);
+            residual(Xp, V[j+1]);
+            for (int i = 0; i < 3; i++){
+                MultiFab::Subtract(*V[j+1][i], *R[i], 0, 0, 3, 0);
+                V[j+1][i]->mult(1._rt / eps);
+            }
+            for (int l = 0; l <= j; ++l){
+                hess(l, j) = dot(V[j+1], V[l]);
+                for (int i = 0; i < 3; i++) MultiFab::Saxpy(*V[j+1][i], -hess(l, j), *V[l][i], 0, 0, 3, 0);
+            }
+            hess(j+1, j) = std::sqrt(dot(V[j+1], V[j+1]));
+            if (hess(j+1, j) > 0._rt){
+                for (int i = 0; i < 3; i++) V[j+1][i]->mult(1._rt / hess(j+1, j));
+            }
+
+            // least-squares problem of the Hessenberg matrix, by Givens rotations
+            for (int l = 0; l < j; ++l){
+                amrex::Real const t = cs[l] * hess(l, j) + sn[l] * hess(l+1, j);
+                hess(l+1, j) = -sn[l] * hess(l, j) + cs[l] * hess(l+1, j);
+                hess(l, j) = t;
+            }
+            amrex::Real const r = std::sqrt(hess(j, j) * hess(j, j) + hess(j+1, j) * hess(j+1, j));
+            if (r == 0._rt) break;
+            cs[j] = hess(j, j) / r;
+            sn[j] = hess(j+1, j) / r;
+            hess(j, j) = r;
+            hess(j+1, j) = 0._rt;
+            g[j+1] = -sn[j] * g[j];
+            g[j] = cs[j] * g[j];
+
+            m = j + 1;
+            if (amrex::Math::abs(g[j+1]) <= forcing * beta) break;
+        }
+
+        // X += sum_l y_l V_l, with hess y = g
+        for (int l = m - 1; l >= 0; --l){
+            y[l] = g[l];
+            for (int c = l + 1; c < m; ++c) y[l] -= hess(l, c) * y[c];
+            y[l] /= hess(l, l);
+        }
+        for (int l = 0; l < m; ++l){
+            for (int i = 0; i < 3; i++) MultiFab::Saxpy(*X[i], y[l], *V[l][i], 0, 0, 3, 0);
+        }
+    }
+
+    // the implicit midpoint rule conserves |M|, up to the tolerance of the Newton solve
+    NormalizeMCartesian<T_M_normalization>(Mfield, X, macroscopic_properties);
+    for (int i = 0; i < 3; i++) Mfield[i]->FillBoundary(period);
+}
+#endif
+
+#ifdef WARPX_MAG_LLG
+template <typename T_Algo, int T_coupling, int T_M_normalization, int T_exchange_coupling, int T_anisotropy_coupling>
+void FiniteDifferenceSolver::MacroscopicEvolveMCartesian_collocated (
+    int lev,
+    std::array<std::unique_ptr<amrex::MultiFab>, 3> &Mfield,
+    std::array<std::unique_ptr<amrex::MultiFab>, 3> const &Mfield_old,
+    std::array<std::unique_ptr<amrex::MultiFab>, 3> const &Hfield,
+    std::array<std::unique_ptr<amrex::MultiFab>, 3> const &H_biasfield,
+    amrex::Real const dt_M,
+    std::unique_ptr<MacroscopicProperties> const &macroscopic_properties)
+{
+    amrex::LayoutData<amrex::Real>* cost = WarpX::getCosts(lev);
+
+    // options of the LLG equation
+    constexpr int coupling = T_coupling;
+    constexpr int M_normalization = T_M_normalization;
+    constexpr int mag_exchange_coupling = T_exchange_coupling;
+    constexpr int mag_anisotropy_coupling = T_anisotropy_coupling;
+    // spin torques (0: off, 1: on), a runtime branch, since they are seldom used
+    int const mag_spin_torque_coupling = WarpX::GetInstance().mag_LLG_spin_torque_coupling;
+    // time at which the current density of the spin torques is evaluated
+    amrex::Real const spin_torque_time = WarpX::GetInstance().gett_new(lev);
+
+    // anisotropy axes of the grains, and type of the anisotropy
+    amrex::Real const* const anisotropy_axes = macroscopic_properties->getmag_anisotropy_axes();
+    int const anisotropy_type = macroscopic_properties->getmag_anisotropy_type();
+
+    // obtain the maximum relative amount we let M deviate from Ms before aborting
+    amrex::Real mag_normalized_error = macroscopic_properties->getmag_normalized_error();
+
+    // the M updates reduce a MagNormFlag instead of aborting on the device if |M| violates mag_normalized_error
+    amrex::ReduceOps<amrex::ReduceOpMax> reduce_norm_op;
+    amrex::ReduceData<int> reduce_norm_data(reduce_norm_op);
+    using NormTuple = typename decltype(reduce_norm_data)::Type;
+
+    // Extract stencil coefficients for calculating the exchange field H_exchange
+    amrex::Real const *const AMREX_RESTRICT coefs_x = m_stencil_coefs_x.dataPtr();
+    int const n_coefs_x = m_stencil_coefs_x.size();
+    amrex::Real const *const AMREX_RESTRICT coefs_y = m_stencil_coefs_y.dataPtr();
+    int const n_coefs_y = m_stencil_coefs_y.size();
+    amrex::Real const *const AMREX_RESTRICT coefs_z = m_stencil_coefs_z.dataPtr();
+    int const n_coefs_z = m_stencil_coefs_z.size();
+
+    // M is cell-centered in all directions, so that the exchange stencil is the tangential one along all directions
+    int const nodality = 3;
+
+    // H_bias is either stored on the faces, or uniform (warpx.mag_H_bias_uniform = 1)
+    bool const H_bias_uniform = (H_biasfield[0] == nullptr);
+    amrex::GpuArray<amrex::Real, 3> const H_bias_value = H_bias_uniform
+        ? WarpX::GetInstance().getH_bias_uniform(lev) : amrex::GpuArray<amrex::Real, 3>{0._rt, 0._rt, 0._rt};
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi(*Mfield[0], TilingIfNotGPU()); mfi.isValid(); ++mfi)
+    {
+        if (!macroscopic_properties->has_magnetic_material(mfi.index())) continue;
+        CostBoxTimer cost_box(cost, mfi.index());
+
+        // spin torques of the current density on this box
+        MagSpinTorque const spin_torque = (mag_spin_torque_coupling == 1)
+            ? macroscopic_properties->GetSpinTorque(mfi, lev, spin_torque_time) : MagSpinTorque{};
+
+        // the material properties are defined on the x-faces, and are averaged to the cell centers
+        Array4<Real const> const &mag_Ms_xface_arr = macroscopic_properties->getmag_Ms_mf(0).const_array(mfi);
+        Array4<Real const> const &mag_alpha_xface_arr = macroscopic_properties->getmag_alpha_mf(0).const_array(mfi);
+        Array4<MacroscopicProperties::MagCoefReal const> const& mag_coefs_xface_arr = macroscopic_properties->getmag_coefs_mf(0).const_array(mfi);
+        Array4<int const> const grain_xface_arr = macroscopic_properties->getmag_grain_array(0, mfi);
+
+        Array4<Real> const &M_cc = Mfield[0]->array(mfi);             // note M_cc include x,y,z components at the cell centers
+        Array4<Real> const &M_old_cc = Mfield_old[0]->array(mfi);     // note M_old_cc include x,y,z components at the cell centers
+        Array4<Real const> const &Hx = Hfield[0]->const_array(mfi);
+        Array4<Real const> const &Hy = Hfield[1]->const_array(mfi);
+        Array4<Real const> const &Hz = Hfield[2]->const_array(mfi);
+        Array4<Real const> const Hx_bias = H_bias_uniform ? Array4<Real const>{} : H_biasfield[0]->const_array(mfi);
+        Array4<Real const> const Hy_bias = H_bias_uniform ? Array4<Real const>{} : H_biasfield[1]->const_array(mfi);
+        Array4<Real const> const Hz_bias = H_bias_uniform ? Array4<Real const>{} : H_biasfield[2]->const_array(mfi);
+
+        Box const &tb = mfi.tilebox();
+
+        reduce_norm_op.eval(tb, reduce_norm_data,
+            [=] AMREX_GPU_DEVICE(int i, int j, int k) -> NormTuple {
+
+                int norm_flag = MacroscopicProperties::mag_norm_ok;
+
+                // a cell is magnetic if both of its x-faces are
+                auto Ms_cc = [=] (int ii, int jj, int kk) {
+                    amrex::Real const Ms_lo = mag_Ms_xface_arr(ii, jj, kk);
+                    amrex::Real const Ms_hi = mag_Ms_xface_arr(ii+1, jj, kk);
+                    return (Ms_lo > 0._rt && Ms_hi > 0._rt) ? 0.5_rt * (Ms_lo + Ms_hi) : 0._rt;
+                };
+                amrex::Real const mag_Ms = Ms_cc(i, j, k);
+                if (mag_Ms <= 0._rt) return {norm_flag};
+
+                auto coef_cc = [=] (int n) {
+                    return 0.5_rt * (amrex::Real(mag_coefs_xface_arr(i, j, k, n)) + amrex::Real(mag_coefs_xface_arr(i+1, j, k, n)));
+                };
+
+                // H_bias, interpolated from the two faces of each component
+                amrex::Real Hx_eff = H_bias_uniform ? H_bias_value[0] : 0.5_rt * (Hx_bias(i, j, k) + Hx_bias(i+1, j, k));
+                amrex::Real Hy_eff = H_bias_uniform ? H_bias_value[1] : 0.5_rt * (Hy_bias(i, j, k) + Hy_bias(i, j+1, k));
+                amrex::Real Hz_eff = H_bias_uniform ? H_bias_value[2] : 0.5_rt * (Hz_bias(i, j, k) + Hz_bias(i, j, k+1));
+                if (coupling == 1)
+                {
+                    // H_maxwell - use H^(old_time)
+                    Hx_eff += 0.5_rt * (Hx(i, j, k) + Hx(i+1, j, k));
+                    Hy_eff += 0.5_rt * (Hy(i, j, k) + Hy(i, j+1, k));
+                    Hz_eff += 0.5_rt * (Hz(i, j, k) + Hz(i, j, k+1));
+                }
+
+                if (mag_exchange_coupling == 1){
+
+                    // H_exchange - use M^(old_time)
+                    amrex::Real const H_exchange_coeff = coef_cc(MacroscopicProperties::mag_coef_exchange);
+
+                    amrex::Real Ms_lo_x = Ms_cc(i-1, j, k);
+                    amrex::Real Ms_hi_x = Ms_cc(i+1, j, k);
+                    amrex::Real Ms_lo_y = Ms_cc(i, j-1, k);
+                    amrex::Real Ms_hi_y = Ms_cc(i, j+1, k);
+                    amrex::Real Ms_lo_z = Ms_cc(i, j, k-1);
+                    amrex::Real Ms_hi_z = Ms_cc(i, j, k+1);
+
+                    Hx_eff += H_exchange_coeff * T_Algo::Laplacian_Mag(M_old_cc, coefs_x, coefs_y, coefs_z, n_coefs_x, n_coefs_y, n_coefs_z, Ms_lo_x, Ms_hi_x, Ms_lo_y, Ms_hi_y, Ms_lo_z, Ms_hi_z, i, j, k, 0, nodality);
+                    Hy_eff += H_exchange_coeff * T_Algo::Laplacian_Mag(M_old_cc, coefs_x, coefs_y, coefs_z, n_coefs_x, n_coefs_y, n_coefs_z, Ms_lo_x, Ms_hi_x, Ms_lo_y, Ms_hi_y, Ms_lo_z, Ms_hi_z, i, j, k, 1, nodality);
+                    Hz_eff += H_exchange_coeff * T_Algo::Laplacian_Mag(M_old_cc, coefs_x, coefs_y, coefs_z, n_coefs_x, n_coefs_y, n_coefs_z, Ms_lo_x, Ms_hi_x, Ms_lo_y, Ms_hi_y, Ms_lo_z, Ms_hi_z, i, j, k, 2, nodality);
+                }
+
+                if (mag_anisotropy_coupling == 1){
+
+                    // H_anisotropy - use M^(old_time)
+                    amrex::Real const H_anisotropy_coeff = coef_cc(MacroscopicProperties::mag_coef_anisotropy);
+                    MacroscopicProperties::addH_anisotropy(i, j, k, grain_xface_arr, anisotropy_axes, anisotropy_type, H_anisotropy_coeff,
+                                                           M_old_cc(i, j, k, 0), M_old_cc(i, j, k, 1), M_old_cc(i, j, k, 2), Hx_eff, Hy_eff, Hz_eff);
+                }
+
+                if (mag_spin_torque_coupling == 1){
+
+                    // H_spin_torque - use M^(old_time)
+                    spin_torque.AddEffectiveField(i, j, k, amrex::IntVect::TheCellVector(), mag_Ms, M_old_cc(i, j, k, 0), M_old_cc(i, j, k, 1), M_old_cc(i, j, k, 2), Hx_eff, Hy_eff, Hz_eff);
+                }
+
+                amrex::Real const Mx = M_old_cc(i, j, k, 0);
+                amrex::Real const My = M_old_cc(i, j, k, 1);
+                amrex::Real const Mz = M_old_cc(i, j, k, 2);
+
+                amrex::Real const mag_gammaL = coef_cc(MacroscopicProperties::mag_coef_gammaL);
+                amrex::Real const mag_alpha = 0.5_rt * (mag_alpha_xface_arr(i, j, k) + mag_alpha_xface_arr(i+1, j, k));
+
+                // 0 = unsaturated; compute |M| locally.  1 = saturated; use M_s
+                amrex::Real M_magnitude = (M_normalization == 0) ? std::sqrt(M_cc(i, j, k, 0)*M_cc(i, j, k, 0) + M_cc(i, j, k, 1)*M_cc(i, j, k, 1) + M_cc(i, j, k, 2)*M_cc(i, j, k, 2))
+                                                          : mag_Ms;
+                amrex::Real Gil_damp = PhysConst::mu0 * mag_gammaL * mag_alpha / M_magnitude;
+
+                // forward Euler: M += dt_M [mu0 gammaL (M x H_eff) + Gil_damp M x (M x H_eff)]
+                amrex::Real const MxH_x = My * Hz_eff - Mz * Hy_eff;
+                amrex::Real const MxH_y = Mz * Hx_eff - Mx * Hz_eff;
+                amrex::Real const MxH_z = Mx * Hy_eff - My * Hx_eff;
+
+                M_cc(i, j, k, 0) += dt_M * ((PhysConst::mu0 * mag_gammaL) * MxH_x + Gil_damp * (My * MxH_z - Mz * MxH_y));
+                M_cc(i, j, k, 1) += dt_M * ((PhysConst::mu0 * mag_gammaL) * MxH_y + Gil_damp * (Mz * MxH_x - Mx * MxH_z));
+                M_cc(i, j, k, 2) += dt_M * ((PhysConst::mu0 * mag_gammaL) * MxH_z + Gil_damp * (Mx * MxH_y - My * MxH_x));
+
+                amrex::Real M_magnitude_normalized = std::sqrt(M_cc(i, j, k, 0)*M_cc(i, j, k, 0) + M_cc(i, j, k, 1)*M_cc(i, j, k, 1) + M_cc(i, j, k, 2)*M_cc(i, j, k, 2)) / mag_Ms;
+
+                // same normalization as the staggered first-order scheme
+                if (M_normalization > 0)
+                {
+                    if (amrex::Math::abs(1._rt - M_magnitude_normalized) > mag_normalized_error)
+                    {
+                        norm_flag = MacroscopicProperties::mag_norm_exceeded;
+                    }
+                    for (int comp=0; comp<3; ++comp) M_cc(i, j, k, comp) /= M_magnitude_normalized;
+                }
+                else if (M_normalization == 0)
+                {
+                    if (M_magnitude_normalized > 1._rt + mag_normalized_error)
+                    {
+                        norm_flag = MacroscopicProperties::mag_norm_unsaturated_exceeded;
+                    }
+                    else if (M_magnitude_normalized > 1._rt)
+                    {
+                        for (int comp=0; comp<3; ++comp) M_cc(i, j, k, comp) /= M_magnitude_normalized;
+                    }
+                }
+                return {norm_flag};
+        });
+    }
+
+    // abort on the host if |M| violated mag_normalized_error anywhere
+    macroscopic_properties->CheckMagNormalizationFlag(amrex::get<0>(reduce_norm_data.value()));
+
+    // the H and B updates interpolate M(new_time) from the two cells adjacent to each face
+    Mfield[0]->FillBoundary(WarpX::GetInstance().Geom(lev).periodicity());
+}
 #endif
 
 #ifdef WARPX_MAG_LLG
-template <typename T_Algo>
+template <typename T_Algo, int T_coupling, int T_M_normalization, int T_exchange_coupling, int T_anisotropy_coupling>
 void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian(
+    int lev,
     std::array<std::unique_ptr<amrex::MultiFab>, 3> &Mfield,
     std::array<std::unique_ptr<amrex::MultiFab>, 3> &Hfield, // H Maxwell
-    std::array<std::unique_ptr<amrex::MultiFab>, 3> &Bfield,
     std::array<std::unique_ptr<amrex::MultiFab>, 3> const &H_biasfield, // H bias
     std::array<std::unique_ptr<amrex::MultiFab>, 3> const &Efield,
+    std::array<std::unique_ptr<amrex::MultiFab>, 3> const &face_areas,
+    std::array<std::unique_ptr<amrex::MultiFab>, 3> const &ect_minus_curlE,
     amrex::Real const dt,
+    amrex::Real const dt_M,
     std::unique_ptr<MacroscopicProperties> const &macroscopic_properties)
 {
+#ifndef AMREX_USE_EB
+    amrex::ignore_unused(face_areas, ect_minus_curlE);
+#endif
 
-    auto &warpx = WarpX::GetInstance();
-    int coupling = warpx.mag_LLG_coupling;
-    int M_normalization = warpx.mag_M_normalization;
-    int mag_exchange_coupling = warpx.mag_LLG_exchange_coupling;
-    int mag_anisotropy_coupling = warpx.mag_LLG_anisotropy_coupling;
+    amrex::LayoutData<amrex::Real>* cost = WarpX::getCosts(lev);
+
+    // options of the LLG equation
+    constexpr int coupling = T_coupling;
+    constexpr int M_normalization = T_M_normalization;
+    constexpr int mag_exchange_coupling = T_exchange_coupling;
+    constexpr int mag_anisotropy_coupling = T_anisotropy_coupling;
+    // spin torques (0: off, 1: on), a runtime branch, since they are seldom used
+    int const mag_spin_torque_coupling = WarpX::GetInstance().mag_LLG_spin_torque_coupling;
+    // time at which the current density of the spin torques is evaluated
+    amrex::Real const spin_torque_time = WarpX::GetInstance().gett_new(lev);
 
     // temporary Multifab storing M from previous timestep (old_time) before updating to M(new_time)
     std::array<std::unique_ptr<amrex::MultiFab>, 3> Mfield_old; // Mfield_old is M(old_time)
 
-    amrex::GpuArray<int, 3> const& mu_stag = macroscopic_properties->mu_IndexType;
-    amrex::GpuArray<int, 3> const& Hx_stag = macroscopic_properties->Hx_IndexType;
-    amrex::GpuArray<int, 3> const& Hy_stag = macroscopic_properties->Hy_IndexType;
-    amrex::GpuArray<int, 3> const& Hz_stag = macroscopic_properties->Hz_IndexType;
-    amrex::GpuArray<int, 3> const& Bx_stag = macroscopic_properties->Bx_IndexType;
-    amrex::GpuArray<int, 3> const& By_stag = macroscopic_properties->By_IndexType;
-    amrex::GpuArray<int, 3> const& Bz_stag = macroscopic_properties->Bz_IndexType;
-    amrex::GpuArray<int, 3> const& macro_cr= macroscopic_properties->macro_cr_ratio;
-    amrex::GpuArray<amrex::Real, 3> const& anisotropy_axis = macroscopic_properties->mag_LLG_anisotropy_axis;
+    // anisotropy axes of the grains, and type of the anisotropy
+    amrex::Real const* const anisotropy_axes = macroscopic_properties->getmag_anisotropy_axes();
+    int const anisotropy_type = macroscopic_properties->getmag_anisotropy_type();
+
+    // with warpx.mag_M_collocated = 1, M is cell-centered and Mfield[1], Mfield[2] alias Mfield[0]
+    bool const collocated = (WarpX::GetInstance().mag_M_collocated == 1);
+    int const nMfield = collocated ? 1 : 3;
 
-    for (int i = 0; i < 3; i++)
+    for (int i = 0; i < nMfield; i++)
     {
         // Mfield_old is M(n)
         Mfield_old[i].reset(new MultiFab(Mfield[i]->boxArray(), Mfield[i]->DistributionMap(), 3, Mfield[i]->nGrow()));
         // initialize temporary multifab, Mfield_old, with values from Mfield(old_time)
         MultiFab::Copy(*Mfield_old[i], *Mfield[i], 0, 0, 3, Mfield[i]->nGrow());
     }
+    for (int i = nMfield; i < 3; i++)
+    {
+        Mfield_old[i].reset(new MultiFab(*Mfield_old[0], amrex::make_alias, 0, 3));
+    }
 
     // obtain the maximum relative amount we let M deviate from Ms before aborting
     amrex::Real mag_normalized_error = macroscopic_properties->getmag_normalized_error();
 
+    // the M updates reduce a MagNormFlag instead of aborting on the device if |M| violates mag_normalized_error
+    amrex::ReduceOps<amrex::ReduceOpMax> reduce_norm_op;
+    amrex::ReduceData<int> reduce_norm_data(reduce_norm_op);
+    using NormTuple = typename decltype(reduce_norm_data)::Type;
+
+    // with mag_time_scheme_order = 5, M is advanced by the Runge-Kutta scheme instead of forward Euler
+    bool const use_rk45 = (WarpX::GetInstance().getmag_time_scheme_order() == 5);
+    if (use_rk45 && dt_M > 0._rt) {
+        MacroscopicEvolveMCartesian_RK45<T_Algo, T_coupling, T_M_normalization, T_exchange_coupling, T_anisotropy_coupling>(
+            lev, Mfield, Hfield, H_biasfield, dt_M, macroscopic_properties);
+    }
+    // with warpx.mag_LLG_implicit = 1, M is advanced by the implicit midpoint rule instead of forward Euler
+    bool const use_implicit = (WarpX::GetInstance().mag_LLG_implicit == 1);
+    if (use_implicit && dt_M > 0._rt) {
+        MacroscopicEvolveMCartesian_implicit<T_Algo, T_coupling, T_M_normalization, T_exchange_coupling, T_anisotropy_coupling>(
+            lev, Mfield, Hfield, H_biasfield, dt_M, macroscopic_properties);
+    }
+    if (collocated && dt_M > 0._rt) {
+        MacroscopicEvolveMCartesian_collocated<T_Algo, T_coupling, T_M_normalization, T_exchange_coupling, T_anisotropy_coupling>(
+            lev, Mfield, Mfield_old, Hfield, H_biasfield, dt_M, macroscopic_properties);
+    }
+
+    // H_bias is either stored on the faces, or uniform (warpx.mag_H_bias_uniform = 1)
+    bool const H_bias_uniform = (H_biasfield[0] == nullptr);
+    amrex::GpuArray<amrex::Real, 3> const H_bias_value = H_bias_uniform
+        ? WarpX::GetInstance().getH_bias_uniform(lev) : amrex::GpuArray<amrex::Real, 3>{0._rt, 0._rt, 0._rt};
+
+    // static data in managed memory is migrated to the device one box ahead of the loop
+    StaticDataPrefetcher prefetch;
+    if (!(use_rk45 || use_implicit || collocated || dt_M == 0._rt)) {
+        macroscopic_properties->AddMagStaticData(prefetch);
+        for (auto const& H_bias : H_biasfield) prefetch.Add(H_bias.get());
+    }
+
 #ifdef AMREX_USE_OMP
 #pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
 #endif
 
     for (MFIter mfi(*Mfield[0], TilingIfNotGPU()); mfi.isValid(); ++mfi)
     {
+        prefetch.Next(mfi);
+        // skip the boxes that do not contain any magnetic material, and all the boxes if M is not advanced by
+        // the staggered forward Euler update
+        if (use_rk45 || use_implicit || collocated || dt_M == 0._rt || !macroscopic_properties->has_magnetic_material(mfi.index())) continue;
+        CostBoxTimer cost_box(cost, mfi.index());
+
+        // spin torques of the current density on this box
+        MagSpinTorque const spin_torque = (mag_spin_torque_coupling == 1)
+            ? macroscopic_properties->GetSpinTorque(mfi, lev, spin_torque_time) : MagSpinTorque{};
+
         auto& mag_Ms_xface_mf = macroscopic_properties->getmag_Ms_mf(0);
         auto& mag_Ms_yface_mf = macroscopic_properties->getmag_Ms_mf(1);
         auto& mag_Ms_zface_mf = macroscopic_properties->getmag_Ms_mf(2);
         auto& mag_alpha_xface_mf = macroscopic_properties->getmag_alpha_mf(0);
         auto& mag_alpha_yface_mf = macroscopic_properties->getmag_alpha_mf(1);
         auto& mag_alpha_zface_mf = macroscopic_properties->getmag_alpha_mf(2);
-        auto& mag_gamma_xface_mf = macroscopic_properties->getmag_gamma_mf(0);
-        auto& mag_gamma_yface_mf = macroscopic_properties->getmag_gamma_mf(1);
-        auto& mag_gamma_zface_mf = macroscopic_properties->getmag_gamma_mf(2);
-        auto& mag_exchange_xface_mf = macroscopic_properties->getmag_exchange_mf(0);
-        auto& mag_exchange_yface_mf = macroscopic_properties->getmag_exchange_mf(1);
-        auto& mag_exchange_zface_mf = macroscopic_properties->getmag_exchange_mf(2);
-        auto& mag_anisotropy_xface_mf = macroscopic_properties->getmag_anisotropy_mf(0);
-        auto& mag_anisotropy_yface_mf = macroscopic_properties->getmag_anisotropy_mf(1);
-        auto& mag_anisotropy_zface_mf = macroscopic_properties->getmag_anisotropy_mf(2);
 
         // extract material properties
         Array4<Real> const& mag_Ms_xface_arr = mag_Ms_xface_mf.array(mfi);
@@ -120,15 +1064,12 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian(
         Array4<Real> const& mag_alpha_xface_arr = mag_alpha_xface_mf.array(mfi);
         Array4<Real> const& mag_alpha_yface_arr = mag_alpha_yface_mf.array(mfi);
         Array4<Real> const& mag_alpha_zface_arr = mag_alpha_zface_mf.array(mfi);
-        Array4<Real> const& mag_gamma_xface_arr = mag_gamma_xface_mf.array(mfi);
-        Array4<Real> const& mag_gamma_yface_arr = mag_gamma_yface_mf.array(mfi);
-        Array4<Real> const& mag_gamma_zface_arr = mag_gamma_zface_mf.array(mfi);
-        Array4<Real> const& mag_exchange_xface_arr = mag_exchange_xface_mf.array(mfi);
-        Array4<Real> const& mag_exchange_yface_arr = mag_exchange_yface_mf.array(mfi);
-        Array4<Real> const& mag_exchange_zface_arr = mag_exchange_zface_mf.array(mfi);
-        Array4<Real> const& mag_anisotropy_xface_arr = mag_anisotropy_xface_mf.array(mfi);
-        Array4<Real> const& mag_anisotropy_yface_arr = mag_anisotropy_yface_mf.array(mfi);
-        Array4<Real> const& mag_anisotropy_zface_arr = mag_anisotropy_zface_mf.array(mfi);
+        Array4<MacroscopicProperties::MagCoefReal const> const& mag_coefs_xface_arr = macroscopic_properties->getmag_coefs_mf(0).const_array(mfi);
+        Array4<int const> const grain_xface_arr = macroscopic_properties->getmag_grain_array(0, mfi);
+        Array4<MacroscopicProperties::MagCoefReal const> const& mag_coefs_yface_arr = macroscopic_properties->getmag_coefs_mf(1).const_array(mfi);
+        Array4<int const> const grain_yface_arr = macroscopic_properties->getmag_grain_array(1, mfi);
+        Array4<MacroscopicProperties::MagCoefReal const> const& mag_coefs_zface_arr = macroscopic_properties->getmag_coefs_mf(2).const_array(mfi);
+        Array4<int const> const grain_zface_arr = macroscopic_properties->getmag_grain_array(2, mfi);
 
         // extract field data
         Array4<Real> const &Hx = Hfield[0]->array(mfi);
@@ -140,9 +1081,9 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian(
         Array4<Real> const &M_old_xface = Mfield_old[0]->array(mfi); // note M_old_xface include x,y,z components at |_x faces
         Array4<Real> const &M_old_yface = Mfield_old[1]->array(mfi); // note M_old_yface include x,y,z components at |_y faces
         Array4<Real> const &M_old_zface = Mfield_old[2]->array(mfi); // note M_old_zface include x,y,z components at |_z faces
-        Array4<Real> const &Hx_bias = H_biasfield[0]->array(mfi);    // Hx_bias is the x component at |_x faces
-        Array4<Real> const &Hy_bias = H_biasfield[1]->array(mfi);    // Hy_bias is the y component at |_y faces
-        Array4<Real> const &Hz_bias = H_biasfield[2]->array(mfi);    // Hz_bias is the z component at |_z faces
+        Array4<Real> const Hx_bias = H_bias_uniform ? Array4<Real>{} : H_biasfield[0]->array(mfi);    // Hx_bias is the x component at |_x faces
+        Array4<Real> const Hy_bias = H_bias_uniform ? Array4<Real>{} : H_biasfield[1]->array(mfi);    // Hy_bias is the y component at |_y faces
+        Array4<Real> const Hz_bias = H_bias_uniform ? Array4<Real>{} : H_biasfield[2]->array(mfi);    // Hz_bias is the z component at |_z faces
 
         amrex::IntVect Mxface_stag = Mfield[0]->ixType().toIntVect();
         amrex::IntVect Myface_stag = Mfield[1]->ixType().toIntVect();
@@ -162,8 +1103,10 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian(
         int const n_coefs_z = m_stencil_coefs_z.size();
 
         // loop over cells and update fields
-        amrex::ParallelFor(tbx,
-            [=] AMREX_GPU_DEVICE(int i, int j, int k) {
+        reduce_norm_op.eval(tbx, reduce_norm_data,
+            [=] AMREX_GPU_DEVICE(int i, int j, int k) -> NormTuple {
+
+                int norm_flag = MacroscopicProperties::mag_norm_ok;
 
                 // determine if the material is nonmagnetic or not
                 if (mag_Ms_xface_arr(i,j,k) > 0._rt)
@@ -172,9 +1115,9 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian(
                     // Hy and Hz can be acquired by interpolation
 
                     // H_bias
-                    amrex::Real Hx_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, Mxface_stag, Mxface_stag, Hx_bias);
-                    amrex::Real Hy_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, Myface_stag, Mxface_stag, Hy_bias);
-                    amrex::Real Hz_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, Mzface_stag, Mxface_stag, Hz_bias);
+                    amrex::Real Hx_eff = MacroscopicProperties::getH_bias(i, j, k, Mxface_stag, Mxface_stag, Hx_bias, H_bias_uniform, H_bias_value[0]);
+                    amrex::Real Hy_eff = MacroscopicProperties::getH_bias(i, j, k, Myface_stag, Mxface_stag, Hy_bias, H_bias_uniform, H_bias_value[1]);
+                    amrex::Real Hz_eff = MacroscopicProperties::getH_bias(i, j, k, Mzface_stag, Mxface_stag, Hz_bias, H_bias_uniform, H_bias_value[2]);
                     if (coupling == 1)
                     {
                         // H_eff = H_maxwell + H_bias + H_exchange + H_anisotropy ... (only the first two terms are considered here)
@@ -187,10 +1130,8 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian(
 
                     if (mag_exchange_coupling == 1){
 
-                        if (mag_exchange_xface_arr(i,j,k) == 0._rt) amrex::Abort("The mag_exchange_xface_arr(i,j,k) is 0.0 while including the exchange coupling term H_exchange for H_eff");
-
                         // H_exchange - use M^(old_time)
-                        amrex::Real const H_exchange_coeff = 2.0 * mag_exchange_xface_arr(i,j,k) / PhysConst::mu0 / mag_Ms_xface_arr(i,j,k) / mag_Ms_xface_arr(i,j,k);
+                        amrex::Real const H_exchange_coeff = mag_coefs_xface_arr(i,j,k,MacroscopicProperties::mag_coef_exchange);
 
                         amrex::Real Ms_lo_x = mag_Ms_xface_arr(i-1, j, k);
                         amrex::Real Ms_hi_x = mag_Ms_xface_arr(i+1, j, k);
@@ -206,55 +1147,54 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian(
 
                     if (mag_anisotropy_coupling == 1){
 
-                        if (mag_anisotropy_xface_arr(i,j,k) == 0._rt) amrex::Abort("The mag_anisotropy_xface_arr(i,j,k) is 0.0 while including the anisotropy coupling term H_anisotropy for H_eff");
-
                         // H_anisotropy - use M^(old_time)
-                        amrex::Real M_dot_anisotropy_axis = 0.0;
-                        for (int comp=0; comp<3; ++comp) {
-                            M_dot_anisotropy_axis += M_old_xface(i, j, k, comp) * anisotropy_axis[comp];
-                        }
-                        amrex::Real const H_anisotropy_coeff = - 2.0 * mag_anisotropy_xface_arr(i,j,k) / PhysConst::mu0 / mag_Ms_xface_arr(i,j,k) / mag_Ms_xface_arr(i,j,k);
-                        Hx_eff += H_anisotropy_coeff * M_dot_anisotropy_axis * anisotropy_axis[0];
-                        Hy_eff += H_anisotropy_coeff * M_dot_anisotropy_axis * anisotropy_axis[1];
-                        Hz_eff += H_anisotropy_coeff * M_dot_anisotropy_axis * anisotropy_axis[2];
+                        amrex::Real const H_anisotropy_coeff = mag_coefs_xface_arr(i,j,k,MacroscopicProperties::mag_coef_anisotropy);
+                        MacroscopicProperties::addH_anisotropy(i, j, k, grain_xface_arr, anisotropy_axes, anisotropy_type, H_anisotropy_coeff,
+                                                               M_old_xface(i, j, k, 0), M_old_xface(i, j, k, 1), M_old_xface(i, j, k, 2), Hx_eff, Hy_eff, Hz_eff);
+                    }
+
+                    if (mag_spin_torque_coupling == 1){
+
+                        // H_spin_torque - use M^(old_time)
+                        spin_torque.AddEffectiveField(i, j, k, Mxface_stag, mag_Ms_xface_arr(i,j,k), M_old_xface(i, j, k, 0), M_old_xface(i, j, k, 1), M_old_xface(i, j, k, 2), Hx_eff, Hy_eff, Hz_eff);
                     }
 
                     // magnetic material properties mag_alpha and mag_Ms are defined at faces
                     // removed the interpolation from version with cell-nodal material properties
-                    amrex::Real mag_gammaL = mag_gamma_xface_arr(i,j,k) / (1._rt + std::pow(mag_alpha_xface_arr(i,j,k), 2._rt));
+                    amrex::Real mag_gammaL = mag_coefs_xface_arr(i,j,k,MacroscopicProperties::mag_coef_gammaL);
 
                     // 0 = unsaturated; compute |M| locally.  1 = saturated; use M_s
-                    amrex::Real M_magnitude = (M_normalization == 0) ? std::sqrt(std::pow(M_xface(i, j, k, 0), 2._rt) + std::pow(M_xface(i, j, k, 1), 2._rt) + std::pow(M_xface(i, j, k, 2), 2._rt))
+                    amrex::Real M_magnitude = (M_normalization == 0) ? std::sqrt(M_xface(i, j, k, 0)*M_xface(i, j, k, 0) + M_xface(i, j, k, 1)*M_xface(i, j, k, 1) + M_xface(i, j, k, 2)*M_xface(i, j, k, 2))
                                                               : mag_Ms_xface_arr(i,j,k);
                     amrex::Real Gil_damp = PhysConst::mu0 * mag_gammaL * mag_alpha_xface_arr(i,j,k) / M_magnitude;
 
                     // now you have access to use M_old_xface(i,j,k,:), Hx_eff, Hy_eff, and Hz_eff on the RHS of these update lines below
                     // x component on x-faces of grid
-                    M_xface(i, j, k, 0) += dt * (PhysConst::mu0 * mag_gammaL) * (M_old_xface(i, j, k, 1) * Hz_eff - M_old_xface(i, j, k, 2) * Hy_eff)
-                                         + dt * Gil_damp * (M_old_xface(i, j, k, 1) * (M_old_xface(i, j, k, 0) * Hy_eff - M_old_xface(i, j, k, 1) * Hx_eff)
+                    M_xface(i, j, k, 0) += dt_M * (PhysConst::mu0 * mag_gammaL) * (M_old_xface(i, j, k, 1) * Hz_eff - M_old_xface(i, j, k, 2) * Hy_eff)
+                                         + dt_M * Gil_damp * (M_old_xface(i, j, k, 1) * (M_old_xface(i, j, k, 0) * Hy_eff - M_old_xface(i, j, k, 1) * Hx_eff)
                                          - M_old_xface(i, j, k, 2) * (M_old_xface(i, j, k, 2) * Hx_eff - M_old_xface(i, j, k, 0) * Hz_eff));
 
                     // y component on x-faces of grid
-                    M_xface(i, j, k, 1) += dt * (PhysConst::mu0 * mag_gammaL) * (M_old_xface(i, j, k, 2) * Hx_eff - M_old_xface(i, j, k, 0) * Hz_eff)
-                                         + dt * Gil_damp * (M_old_xface(i, j, k, 2) * (M_old_xface(i, j, k, 1) * Hz_eff - M_old_xface(i, j, k, 2) * Hy_eff)
+                    M_xface(i, j, k, 1) += dt_M * (PhysConst::mu0 * mag_gammaL) * (M_old_xface(i, j, k, 2) * Hx_eff - M_old_xface(i, j, k, 0) * Hz_eff)
+                                         + dt_M * Gil_damp * (M_old_xface(i, j, k, 2) * (M_old_xface(i, j, k, 1) * Hz_eff - M_old_xface(i, j, k, 2) * Hy_eff)
                                          - M_old_xface(i, j, k, 0) * (M_old_xface(i, j, k, 0) * Hy_eff - M_old_xface(i, j, k, 1) * Hx_eff));
 
                     // z component on x-faces of grid
-                    M_xface(i, j, k, 2) += dt * (PhysConst::mu0 * mag_gammaL) * (M_old_xface(i, j, k, 0) * Hy_eff - M_old_xface(i, j, k, 1) * Hx_eff)
-                                         + dt * Gil_damp * (M_old_xface(i, j, k, 0) * (M_old_xface(i, j, k, 2) * Hx_eff - M_old_xface(i, j, k, 0) * Hz_eff)
+                    M_xface(i, j, k, 2) += dt_M * (PhysConst::mu0 * mag_gammaL) * (M_old_xface(i, j, k, 0) * Hy_eff - M_old_xface(i, j, k, 1) * Hx_eff)
+                                         + dt_M * Gil_damp * (M_old_xface(i, j, k, 0) * (M_old_xface(i, j, k, 2) * Hx_eff - M_old_xface(i, j, k, 0) * Hz_eff)
                                          - M_old_xface(i, j, k, 1) * (M_old_xface(i, j, k, 1) * Hz_eff - M_old_xface(i, j, k, 2) * Hy_eff));
 
                     // temporary normalized magnitude of M_xface field at the fixed point
                     // re-investigate the way we do Ms interp, in case we encounter the case where Ms changes across two adjacent cells that you are doing interp
-                    amrex::Real M_magnitude_normalized = std::sqrt(std::pow(M_xface(i, j, k, 0), 2._rt) + std::pow(M_xface(i, j, k, 1), 2._rt) + std::pow(M_xface(i, j, k, 2), 2._rt)) / mag_Ms_xface_arr(i,j,k);
+                    amrex::Real M_magnitude_normalized = std::sqrt(M_xface(i, j, k, 0)*M_xface(i, j, k, 0) + M_xface(i, j, k, 1)*M_xface(i, j, k, 1) + M_xface(i, j, k, 2)*M_xface(i, j, k, 2)) / mag_Ms_xface_arr(i,j,k);
 
                     if (M_normalization > 0)
                     {
-                        // saturated case; if |M| has drifted from M_s too much, abort.  Otherwise, normalize
+                        // saturated case; if |M| has drifted from M_s too much, flag it for the check after the update.  Then, normalize
                         // check the normalized error
                         if (amrex::Math::abs(1._rt - M_magnitude_normalized) > mag_normalized_error)
                         {
-                            amrex::Abort("Exceed the normalized error of the M_xface field");
+                            norm_flag = MacroscopicProperties::mag_norm_exceeded;
                         }
                         // normalize the M_xface field
                         M_xface(i, j, k, 0) /= M_magnitude_normalized;
@@ -266,7 +1206,7 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian(
                         // check the normalized error
                         if (M_magnitude_normalized > (1._rt + mag_normalized_error))
                         {
-                            amrex::Abort("Caution: Unsaturated material has M_xface exceeding the saturation magnetization");
+                            norm_flag = MacroscopicProperties::mag_norm_unsaturated_exceeded;
                         }
                         else if (M_magnitude_normalized > 1._rt && M_magnitude_normalized <= (1._rt + mag_normalized_error) )
                         {
@@ -277,10 +1217,13 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian(
                         }
                     }
                 } // end if (mag_Ms_xface_arr(i,j,k)(i,j,k) > 0...
+                return {norm_flag};
             });
 
-        amrex::ParallelFor(tby,
-            [=] AMREX_GPU_DEVICE(int i, int j, int k) {
+        reduce_norm_op.eval(tby, reduce_norm_data,
+            [=] AMREX_GPU_DEVICE(int i, int j, int k) -> NormTuple {
+
+                int norm_flag = MacroscopicProperties::mag_norm_ok;
 
                 // determine if the material is nonmagnetic or not
                 if (mag_Ms_yface_arr(i,j,k) > 0._rt)
@@ -289,9 +1232,9 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian(
                     // Hy and Hz can be acquired by interpolation
 
                     // H_bias
-                    amrex::Real Hx_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, Mxface_stag, Myface_stag, Hx_bias);
-                    amrex::Real Hy_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, Myface_stag, Myface_stag, Hy_bias);
-                    amrex::Real Hz_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, Mzface_stag, Myface_stag, Hz_bias);
+                    amrex::Real Hx_eff = MacroscopicProperties::getH_bias(i, j, k, Mxface_stag, Myface_stag, Hx_bias, H_bias_uniform, H_bias_value[0]);
+                    amrex::Real Hy_eff = MacroscopicProperties::getH_bias(i, j, k, Myface_stag, Myface_stag, Hy_bias, H_bias_uniform, H_bias_value[1]);
+                    amrex::Real Hz_eff = MacroscopicProperties::getH_bias(i, j, k, Mzface_stag, Myface_stag, Hz_bias, H_bias_uniform, H_bias_value[2]);
                     if (coupling == 1)
                     {
                         // H_eff = H_maxwell + H_bias + H_exchange + H_anisotropy ... (only the first two terms are considered here)
@@ -304,10 +1247,8 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian(
 
                     if (mag_exchange_coupling == 1){
 
-                        if (mag_exchange_yface_arr(i,j,k) == 0._rt) amrex::Abort("The mag_exchange_yface_arr(i,j,k) is 0.0 while including the exchange coupling term H_exchange for H_eff");
-
                         // H_exchange - use M^(old_time)
-                        amrex::Real const H_exchange_coeff = 2.0 * mag_exchange_yface_arr(i,j,k) / PhysConst::mu0 / mag_Ms_yface_arr(i,j,k) / mag_Ms_yface_arr(i,j,k);
+                        amrex::Real const H_exchange_coeff = mag_coefs_yface_arr(i,j,k,MacroscopicProperties::mag_coef_exchange);
 
                         amrex::Real Ms_lo_x = mag_Ms_yface_arr(i-1, j, k);
                         amrex::Real Ms_hi_x = mag_Ms_yface_arr(i+1, j, k);
@@ -323,55 +1264,54 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian(
 
                     if (mag_anisotropy_coupling == 1){
 
-                        if (mag_anisotropy_yface_arr(i,j,k) == 0._rt) amrex::Abort("The mag_anisotropy_yface_arr(i,j,k) is 0.0 while including the anisotropy coupling term H_anisotropy for H_eff");
-
                         // H_anisotropy - use M^(old_time)
-                        amrex::Real M_dot_anisotropy_axis = 0.0;
-                        for (int comp=0; comp<3; ++comp) {
-                            M_dot_anisotropy_axis += M_old_yface(i, j, k, comp) * anisotropy_axis[comp];
-                        }
-                        amrex::Real const H_anisotropy_coeff = - 2.0 * mag_anisotropy_yface_arr(i,j,k) / PhysConst::mu0 / mag_Ms_yface_arr(i,j,k) / mag_Ms_yface_arr(i,j,k);
-                        Hx_eff += H_anisotropy_coeff * M_dot_anisotropy_axis * anisotropy_axis[0];
-                        Hy_eff += H_anisotropy_coeff * M_dot_anisotropy_axis * anisotropy_axis[1];
-                        Hz_eff += H_anisotropy_coeff * M_dot_anisotropy_axis * anisotropy_axis[2];
+                        amrex::Real const H_anisotropy_coeff = mag_coefs_yface_arr(i,j,k,MacroscopicProperties::mag_coef_anisotropy);
+                        MacroscopicProperties::addH_anisotropy(i, j, k, grain_yface_arr, anisotropy_axes, anisotropy_type, H_anisotropy_coeff,
+                                                               M_old_yface(i, j, k, 0), M_old_yface(i, j, k, 1), M_old_yface(i, j, k, 2), Hx_eff, Hy_eff, Hz_eff);
+                    }
+
+                    if (mag_spin_torque_coupling == 1){
+
+                        // H_spin_torque - use M^(old_time)
+                        spin_torque.AddEffectiveField(i, j, k, Myface_stag, mag_Ms_yface_arr(i,j,k), M_old_yface(i, j, k, 0), M_old_yface(i, j, k, 1), M_old_yface(i, j, k, 2), Hx_eff, Hy_eff, Hz_eff);
                     }
 
                     // magnetic material properties mag_alpha and mag_Ms are defined at faces
                     // removed the interpolation from version with cell-nodal material properties
-                    amrex::Real mag_gammaL = mag_gamma_yface_arr(i,j,k) / (1._rt + std::pow(mag_alpha_yface_arr(i,j,k), 2._rt));
+                    amrex::Real mag_gammaL = mag_coefs_yface_arr(i,j,k,MacroscopicProperties::mag_coef_gammaL);
 
                     // 0 = unsaturated; compute |M| locally.  1 = saturated; use M_s
-                    amrex::Real M_magnitude = (M_normalization == 0) ? std::sqrt(std::pow(M_yface(i, j, k, 0), 2._rt) + std::pow(M_yface(i, j, k, 1), 2._rt) + std::pow(M_yface(i, j, k, 2), 2._rt))
+                    amrex::Real M_magnitude = (M_normalization == 0) ? std::sqrt(M_yface(i, j, k, 0)*M_yface(i, j, k, 0) + M_yface(i, j, k, 1)*M_yface(i, j, k, 1) + M_yface(i, j, k, 2)*M_yface(i, j, k, 2))
                                                               : mag_Ms_yface_arr(i,j,k);
                     amrex::Real Gil_damp = PhysConst::mu0 * mag_gammaL * mag_alpha_yface_arr(i,j,k) / M_magnitude;
 
                     // now you have access to use M_old_yface(i,j,k,:), Hx_eff, Hy_eff, and Hz_eff on the RHS of these update lines below
                     // x component on y-faces of grid
-                    M_yface(i, j, k, 0) += dt * (PhysConst::mu0 * mag_gammaL) * (M_old_yface(i, j, k, 1) * Hz_eff - M_old_yface(i, j, k, 2) * Hy_eff)
-                                         + dt * Gil_damp * (M_old_yface(i, j, k, 1) * (M_old_yface(i, j, k, 0) * Hy_eff - M_old_yface(i, j, k, 1) * Hx_eff)
+                    M_yface(i, j, k, 0) += dt_M * (PhysConst::mu0 * mag_gammaL) * (M_old_yface(i, j, k, 1) * Hz_eff - M_old_yface(i, j, k, 2) * Hy_eff)
+                                         + dt_M * Gil_damp * (M_old_yface(i, j, k, 1) * (M_old_yface(i, j, k, 0) * Hy_eff - M_old_yface(i, j, k, 1) * Hx_eff)
                                          - M_old_yface(i, j, k, 2) * (M_old_yface(i, j, k, 2) * Hx_eff - M_old_yface(i, j, k, 0) * Hz_eff));
 
                     // y component on y-faces of grid
-                    M_yface(i, j, k, 1) += dt * (PhysConst::mu0 * mag_gammaL) * (M_old_yface(i, j, k, 2) * Hx_eff - M_old_yface(i, j, k, 0) * Hz_eff)
-                                         + dt * Gil_damp * (M_old_yface(i, j, k, 2) * (M_old_yface(i, j, k, 1) * Hz_eff - M_old_yface(i, j, k, 2) * Hy_eff)
+                    M_yface(i, j, k, 1) += dt_M * (PhysConst::mu0 * mag_gammaL) * (M_old_yface(i, j, k, 2) * Hx_eff - M_old_yface(i, j, k, 0) * Hz_eff)
+                                         + dt_M * Gil_damp * (M_old_yface(i, j, k, 2) * (M_old_yface(i, j, k, 1) * Hz_eff - M_old_yface(i, j, k, 2) * Hy_eff)
                                          - M_old_yface(i, j, k, 0) * (M_old_yface(i, j, k, 0) * Hy_eff - M_old_yface(i, j, k, 1) * Hx_eff));
 
                     // z component on y-faces of grid
-                    M_yface(i, j, k, 2) += dt * (PhysConst::mu0 * mag_gammaL) * (M_old_yface(i, j, k, 0) * Hy_eff - M_old_yface(i, j, k, 1) * Hx_eff)
-                                         + dt * Gil_damp * (M_old_yface(i, j, k, 0) * (M_old_yface(i, j, k, 2) * Hx_eff - M_old_yface(i, j, k, 0) * Hz_eff)
+                    M_yface(i, j, k, 2) += dt_M * (PhysConst::mu0 * mag_gammaL) * (M_old_yface(i, j, k, 0) * Hy_eff - M_old_yface(i, j, k, 1) * Hx_eff)
+                                         + dt_M * Gil_damp * (M_old_yface(i, j, k, 0) * (M_old_yface(i, j, k, 2) * Hx_eff - M_old_yface(i, j, k, 0) * Hz_eff)
                                          - M_old_yface(i, j, k, 1) * (M_old_yface(i, j, k, 1) * Hz_eff - M_old_yface(i, j, k, 2) * Hy_eff));
 
                     // temporary normalized magnitude of M_yface field at the fixed point
                     // re-investigate the way we do Ms interp, in case we encounter the case where Ms changes across two adjacent cells that you are doing interp
-                    amrex::Real M_magnitude_normalized = std::sqrt(std::pow(M_yface(i, j, k, 0), 2._rt) + std::pow(M_yface(i, j, k, 1), 2._rt) + std::pow(M_yface(i, j, k, 2), 2._rt)) / mag_Ms_yface_arr(i,j,k);
+                    amrex::Real M_magnitude_normalized = std::sqrt(M_yface(i, j, k, 0)*M_yface(i, j, k, 0) + M_yface(i, j, k, 1)*M_yface(i, j, k, 1) + M_yface(i, j, k, 2)*M_yface(i, j, k, 2)) / mag_Ms_yface_arr(i,j,k);
 
                     if (M_normalization > 0)
                     {
-                        // saturated case; if |M| has drifted from M_s too much, abort.  Otherwise, normalize
+                        // saturated case; if |M| has drifted from M_s too much, flag it for the check after the update.  Then, normalize
                         // check the normalized error
                         if (amrex::Math::abs(1._rt - M_magnitude_normalized) > mag_normalized_error)
                         {
-                            amrex::Abort("Exceed the normalized error of the M_yface field");
+                            norm_flag = MacroscopicProperties::mag_norm_exceeded;
                         }
                         // normalize the M_yface field
                         M_yface(i, j, k, 0) /= M_magnitude_normalized;
@@ -383,7 +1323,7 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian(
                         // check the normalized error
                         if (M_magnitude_normalized > 1._rt + mag_normalized_error)
                         {
-                            amrex::Abort("Caution: Unsaturated material has M_yface exceeding the saturation magnetization");
+                            norm_flag = MacroscopicProperties::mag_norm_unsaturated_exceeded;
                         }
                         else if (M_magnitude_normalized > 1._rt && M_magnitude_normalized <= 1._rt + mag_normalized_error)
                         {
@@ -394,10 +1334,13 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian(
                         }
                     }
                 } // end if (mag_Ms_yface_arr(i,j,k)(i,j,k) > 0...
+                return {norm_flag};
             });
 
-        amrex::ParallelFor(tbz,
-            [=] AMREX_GPU_DEVICE(int i, int j, int k) {
+        reduce_norm_op.eval(tbz, reduce_norm_data,
+            [=] AMREX_GPU_DEVICE(int i, int j, int k) -> NormTuple {
+
+                int norm_flag = MacroscopicProperties::mag_norm_ok;
 
                 // determine if the material is nonmagnetic or not
                 if (mag_Ms_zface_arr(i,j,k) > 0._rt)
@@ -406,9 +1349,9 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian(
                     // Hy and Hz can be acquired by interpolation
 
                     // H_bias
-                    amrex::Real Hx_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, Mxface_stag, Mzface_stag, Hx_bias);
-                    amrex::Real Hy_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, Myface_stag, Mzface_stag, Hy_bias);
-                    amrex::Real Hz_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, Mzface_stag, Mzface_stag, Hz_bias);
+                    amrex::Real Hx_eff = MacroscopicProperties::getH_bias(i, j, k, Mxface_stag, Mzface_stag, Hx_bias, H_bias_uniform, H_bias_value[0]);
+                    amrex::Real Hy_eff = MacroscopicProperties::getH_bias(i, j, k, Myface_stag, Mzface_stag, Hy_bias, H_bias_uniform, H_bias_value[1]);
+                    amrex::Real Hz_eff = MacroscopicProperties::getH_bias(i, j, k, Mzface_stag, Mzface_stag, Hz_bias, H_bias_uniform, H_bias_value[2]);
 
                     if (coupling == 1)
                     {
@@ -422,10 +1365,8 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian(
 
                     if (mag_exchange_coupling == 1){
 
-                        if (mag_exchange_zface_arr(i,j,k) == 0._rt) amrex::Abort("The mag_exchange_zface_arr(i,j,k) is 0.0 while including the exchange coupling term H_exchange for H_eff");
-
                         // H_exchange - use M^(old_time)
-                        amrex::Real const H_exchange_coeff = 2.0 * mag_exchange_zface_arr(i,j,k) / PhysConst::mu0 / mag_Ms_zface_arr(i,j,k) / mag_Ms_zface_arr(i,j,k);
+                        amrex::Real const H_exchange_coeff = mag_coefs_zface_arr(i,j,k,MacroscopicProperties::mag_coef_exchange);
 
                         amrex::Real Ms_lo_x = mag_Ms_zface_arr(i-1, j, k);
                         amrex::Real Ms_hi_x = mag_Ms_zface_arr(i+1, j, k);
@@ -441,55 +1382,54 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian(
 
                     if (mag_anisotropy_coupling == 1){
 
-                        if (mag_anisotropy_zface_arr(i,j,k) == 0._rt) amrex::Abort("The mag_anisotropy_zface_arr(i,j,k) is 0.0 while including the anisotropy coupling term H_anisotropy for H_eff");
-
                         // H_anisotropy - use M^(old_time)
-                        amrex::Real M_dot_anisotropy_axis = 0.0;
-                        for (int comp=0; comp<3; ++comp) {
-                            M_dot_anisotropy_axis += M_old_zface(i, j, k, comp) * anisotropy_axis[comp];
-                        }
-                        amrex::Real const H_anisotropy_coeff = - 2.0 * mag_anisotropy_zface_arr(i,j,k) / PhysConst::mu0 / mag_Ms_zface_arr(i,j,k) / mag_Ms_zface_arr(i,j,k);
-                        Hx_eff += H_anisotropy_coeff * M_dot_anisotropy_axis * anisotropy_axis[0];
-                        Hy_eff += H_anisotropy_coeff * M_dot_anisotropy_axis * anisotropy_axis[1];
-                        Hz_eff += H_anisotropy_coeff * M_dot_anisotropy_axis * anisotropy_axis[2];
+                        amrex::Real const H_anisotropy_coeff = mag_coefs_zface_arr(i,j,k,MacroscopicProperties::mag_coef_anisotropy);
+                        MacroscopicProperties::addH_anisotropy(i, j, k, grain_zface_arr, anisotropy_axes, anisotropy_type, H_anisotropy_coeff,
+                                                               M_old_zface(i, j, k, 0), M_old_zface(i, j, k, 1), M_old_zface(i, j, k, 2), Hx_eff, Hy_eff, Hz_eff);
+                    }
+
+                    if (mag_spin_torque_coupling == 1){
+
+                        // H_spin_torque - use M^(old_time)
+                        spin_torque.AddEffectiveField(i, j, k, Mzface_stag, mag_Ms_zface_arr(i,j,k), M_old_zface(i, j, k, 0), M_old_zface(i, j, k, 1), M_old_zface(i, j, k, 2), Hx_eff, Hy_eff, Hz_eff);
                     }
 
                     // magnetic material properties mag_alpha and mag_Ms are defined at faces
                     // removed the interpolation from version with cell-nodal material properties
-                    amrex::Real mag_gammaL = mag_gamma_zface_arr(i,j,k) / (1._rt + std::pow(mag_alpha_zface_arr(i,j,k), 2._rt));
+                    amrex::Real mag_gammaL = mag_coefs_zface_arr(i,j,k,MacroscopicProperties::mag_coef_gammaL);
 
                     // 0 = unsaturated; compute |M| locally.  1 = saturated; use M_s
-                    amrex::Real M_magnitude = (M_normalization == 0) ? std::sqrt(std::pow(M_zface(i, j, k, 0), 2._rt) + std::pow(M_zface(i, j, k, 1), 2._rt) + std::pow(M_zface(i, j, k, 2), 2._rt))
+                    amrex::Real M_magnitude = (M_normalization == 0) ? std::sqrt(M_zface(i, j, k, 0)*M_zface(i, j, k, 0) + M_zface(i, j, k, 1)*M_zface(i, j, k, 1) + M_zface(i, j, k, 2)*M_zface(i, j, k, 2))
                                                               : mag_Ms_zface_arr(i,j,k);
                     amrex::Real Gil_damp = PhysConst::mu0 * mag_gammaL * mag_alpha_zface_arr(i,j,k) / M_magnitude;
 
                     // now you have access to use M_old_zface(i,j,k,:), Hx_eff, Hy_eff, and Hz_eff on the RHS of these update lines below
                     // x component on z-faces of grid
-                    M_zface(i, j, k, 0) += dt * (PhysConst::mu0 * mag_gammaL) * (M_old_zface(i, j, k, 1) * Hz_eff - M_old_zface(i, j, k, 2) * Hy_eff)
-                                         + dt * Gil_damp * (M_old_zface(i, j, k, 1) * (M_old_zface(i, j, k, 0) * Hy_eff - M_old_zface(i, j, k, 1) * Hx_eff)
+                    M_zface(i, j, k, 0) += dt_M * (PhysConst::mu0 * mag_gammaL) * (M_old_zface(i, j, k, 1) * Hz_eff - M_old_zface(i, j, k, 2) * Hy_eff)
+                                         + dt_M * Gil_damp * (M_old_zface(i, j, k, 1) * (M_old_zface(i, j, k, 0) * Hy_eff - M_old_zface(i, j, k, 1) * Hx_eff)
                                          - M_old_zface(i, j, k, 2) * (M_old_zface(i, j, k, 2) * Hx_eff - M_old_zface(i, j, k, 0) * Hz_eff));
 
                     // y component on z-faces of grid
-                    M_zface(i, j, k, 1) += dt * (PhysConst::mu0 * mag_gammaL) * (M_old_zface(i, j, k, 2) * Hx_eff - M_old_zface(i, j, k, 0) * Hz_eff)
-                                         + dt * Gil_damp * (M_old_zface(i, j, k, 2) * (M_old_zface(i, j, k, 1) * Hz_eff - M_old_zface(i, j, k, 2) * Hy_eff)
+                    M_zface(i, j, k, 1) += dt_M * (PhysConst::mu0 * mag_gammaL) * (M_old_zface(i, j, k, 2) * Hx_eff - M_old_zface(i, j, k, 0) * Hz_eff)
+                                         + dt_M * Gil_damp * (M_old_zface(i, j, k, 2) * (M_old_zface(i, j, k, 1) * Hz_eff - M_old_zface(i, j, k, 2) * Hy_eff)
                                          - M_old_zface(i, j, k, 0) * (M_old_zface(i, j, k, 0) * Hy_eff - M_old_zface(i, j, k, 1) * Hx_eff));
 
                     // z component on z-faces of grid
-                    M_zface(i, j, k, 2) += dt * (PhysConst::mu0 * mag_gammaL) * (M_old_zface(i, j, k, 0) * Hy_eff - M_old_zface(i, j, k, 1) * Hx_eff)
-                                         + dt * Gil_damp * (M_old_zface(i, j, k, 0) * (M_old_zface(i, j, k, 2) * Hx_eff - M_old_zface(i, j, k, 0) * Hz_eff)
+                    M_zface(i, j, k, 2) += dt_M * (PhysConst::mu0 * mag_gammaL) * (M_old_zface(i, j, k, 0) * Hy_eff - M_old_zface(i, j, k, 1) * Hx_eff)
+                                         + dt_M * Gil_damp * (M_old_zface(i, j, k, 0) * (M_old_zface(i, j, k, 2) * Hx_eff - M_old_zface(i, j, k, 0) * Hz_eff)
                                          - M_old_zface(i, j, k, 1) * (M_old_zface(i, j, k, 1) * Hz_eff - M_old_zface(i, j, k, 2) * Hy_eff));
 
                     // temporary normalized magnitude of M_zface field at the fixed point
                     // re-investigate the way we do Ms interp, in case we encounter the case where Ms changes across two adjacent cells that you are doing interp
-                    amrex::Real M_magnitude_normalized = std::sqrt(std::pow(M_zface(i, j, k, 0), 2._rt) + std::pow(M_zface(i, j, k, 1), 2._rt) + std::pow(M_zface(i, j, k, 2), 2._rt)) / mag_Ms_zface_arr(i,j,k);
+                    amrex::Real M_magnitude_normalized = std::sqrt(M_zface(i, j, k, 0)*M_zface(i, j, k, 0) + M_zface(i, j, k, 1)*M_zface(i, j, k, 1) + M_zface(i, j, k, 2)*M_zface(i, j, k, 2)) / mag_Ms_zface_arr(i,j,k);
 
                     if (M_normalization > 0)
                     {
-                        // saturated case; if |M| has drifted from M_s too much, abort.  Otherwise, normalize
+                        // saturated case; if |M| has drifted from M_s too much, flag it for the check after the update.  Then, normalize
                         // check the normalized error
                         if (amrex::Math::abs(1._rt - M_magnitude_normalized) > mag_normalized_error)
                         {
-                            amrex::Abort("Exceed the normalized error of the M_zface field");
+                            norm_flag = MacroscopicProperties::mag_norm_exceeded;
                         }
                         // normalize the M_zface field
                         M_zface(i, j, k, 0) /= M_magnitude_normalized;
@@ -501,7 +1441,7 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian(
                         // check the normalized error
                         if (M_magnitude_normalized > 1._rt + mag_normalized_error)
                         {
-                            amrex::Abort("Caution: Unsaturated material has M_zface exceeding the saturation magnetization");
+                            norm_flag = MacroscopicProperties::mag_norm_unsaturated_exceeded;
                         }
                         else if (M_magnitude_normalized > 1._rt && M_magnitude_normalized <= 1._rt + mag_normalized_error)
                         {
@@ -512,13 +1452,22 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian(
                         }
                     }
                 } // end if (mag_Ms_zface_arr(i,j,k)(i,j,k) > 0...
+                return {norm_flag};
             });
     }
 
-    amrex::MultiFab& mu_mf = macroscopic_properties->getmu_mf();
+    // abort on the host if |M| violated mag_normalized_error anywhere
+    macroscopic_properties->CheckMagNormalizationFlag(amrex::get<0>(reduce_norm_data.value()));
+
     // Update H(new_time) = f(H(old_time), M(new_time), M(old_time), E(old_time))
+    ComputeMacroscopicHInvMu(Hfield, macroscopic_properties);
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#endif
     for (MFIter mfi(*Hfield[0], TilingIfNotGPU()); mfi.isValid(); ++mfi)
     {
+        CostBoxTimer cost_box(cost, mfi.index());
+
         auto& mag_Ms_xface_mf = macroscopic_properties->getmag_Ms_mf(0);
         auto& mag_Ms_yface_mf = macroscopic_properties->getmag_Ms_mf(1);
         auto& mag_Ms_zface_mf = macroscopic_properties->getmag_Ms_mf(2);
@@ -540,8 +1489,12 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian(
         Array4<Real> const &M_old_yface = Mfield_old[1]->array(mfi); // note M_old_yface include x,y,z components at |_y faces
         Array4<Real> const &M_old_zface = Mfield_old[2]->array(mfi); // note M_old_zface include x,y,z components at |_z faces
 
-        // macroscopic parameter
-        amrex::Array4<amrex::Real> const& mu_arr = mu_mf.array(mfi);
+        // 1/mu0 on the magnetic faces and 1/mu elsewhere, see ComputeMacroscopicHInvMu
+        amrex::Array4<amrex::Real const> const& inv_mu_x = m_macro_H_inv_mu[0]->const_array(mfi);
+        amrex::Array4<amrex::Real const> const& inv_mu_y = m_macro_H_inv_mu[1]->const_array(mfi);
+        amrex::Array4<amrex::Real const> const& inv_mu_z = m_macro_H_inv_mu[2]->const_array(mfi);
+        // the M contribution is only added on the boxes that contain magnetic material
+        bool const magnetic_box = macroscopic_properties->has_magnetic_material(mfi.index());
 
         // Extract stencil coefficients
         amrex::Real const *const AMREX_RESTRICT coefs_x = m_stencil_coefs_x.dataPtr();
@@ -559,91 +1512,182 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian(
         Box const &tby = mfi.tilebox(Hynodal);
         Box const &tbz = mfi.tilebox(Hznodal);
 
-        amrex::Real const mu0_inv = 1. / PhysConst::mu0;
+#ifdef AMREX_USE_EB
+        // face areas and conformal circulation of E, null when not allocated
+        amrex::Array4<amrex::Real const> const Sx = face_areas[0] ? face_areas[0]->const_array(mfi) : amrex::Array4<amrex::Real const>();
+        amrex::Array4<amrex::Real const> const Sy = face_areas[1] ? face_areas[1]->const_array(mfi) : amrex::Array4<amrex::Real const>();
+        amrex::Array4<amrex::Real const> const Sz = face_areas[2] ? face_areas[2]->const_array(mfi) : amrex::Array4<amrex::Real const>();
+        amrex::Array4<amrex::Real const> const ect_x = ect_minus_curlE[0] ? ect_minus_curlE[0]->const_array(mfi) : amrex::Array4<amrex::Real const>();
+        amrex::Array4<amrex::Real const> const ect_y = ect_minus_curlE[1] ? ect_minus_curlE[1]->const_array(mfi) : amrex::Array4<amrex::Real const>();
+        amrex::Array4<amrex::Real const> const ect_z = ect_minus_curlE[2] ? ect_minus_curlE[2]->const_array(mfi) : amrex::Array4<amrex::Real const>();
+#endif
 
         // Loop over the cells and update the fields
         amrex::ParallelFor(tbx, tby, tbz,
             [=] AMREX_GPU_DEVICE(int i, int j, int k) {
 
-                if (mag_Ms_xface_arr(i,j,k) == 0._rt){ // nonmagnetic region
-                    amrex::Real mu_arrx = CoarsenIO::Interp( mu_arr, mu_stag, Hx_stag,
-                                                             macro_cr, i, j, k, 0);
-                    Hx(i, j, k) += 1. / mu_arrx * dt * (T_Algo::UpwardDz(Ey, coefs_z, n_coefs_z, i, j, k)
-                                                      - T_Algo::UpwardDy(Ez, coefs_y, n_coefs_y, i, j, k));
-                } else if (mag_Ms_xface_arr(i,j,k) > 0){ // magnetic region
-                    Hx(i, j, k) += mu0_inv * dt * (T_Algo::UpwardDz(Ey, coefs_z, n_coefs_z, i, j, k)
-                                                 - T_Algo::UpwardDy(Ez, coefs_y, n_coefs_y, i, j, k));
-                    if (coupling == 1) {
-                        Hx(i, j, k) += - M_xface(i, j, k, 0) + M_old_xface(i, j, k, 0);
-                    }
+#ifdef AMREX_USE_EB
+                // faces fully covered by the embedded boundary are never stepped
+                if (Sx.p != nullptr && Sx(i, j, k) <= 0) return;
+                // with the ECT solver, the conformal circulation of E replaces the Yee curl
+                amrex::Real const minus_curlE_x = (ect_x.p != nullptr) ? ect_x(i, j, k) :
+#else
+                amrex::Real const minus_curlE_x =
+#endif
+                    T_Algo::UpwardDz(Ey, coefs_z, n_coefs_z, i, j, k) - T_Algo::UpwardDy(Ez, coefs_y, n_coefs_y, i, j, k);
+
+                // 1/mu0 on the magnetic faces (Ms > 0) and 1/mu elsewhere
+                Hx(i, j, k) += inv_mu_x(i, j, k) * dt * minus_curlE_x;
+                if (coupling == 1 && magnetic_box && mag_Ms_xface_arr(i,j,k) > 0._rt){ // magnetic region
+                    // with collocated M, the normal component on the face is the average of the two adjacent cells
+                    amrex::Real const dMx = collocated ? 0.5_rt * (M_xface(i-1, j, k, 0) + M_xface(i, j, k, 0) - M_old_xface(i-1, j, k, 0) - M_old_xface(i, j, k, 0))
+                                                 : M_xface(i, j, k, 0) - M_old_xface(i, j, k, 0);
+                    Hx(i, j, k) += - dMx;
                 }
             },
             [=] AMREX_GPU_DEVICE(int i, int j, int k) {
 
-                if (mag_Ms_yface_arr(i,j,k) == 0._rt){ // nonmagnetic region
-                    amrex::Real mu_arry = CoarsenIO::Interp( mu_arr, mu_stag, Hy_stag,
-                                                             macro_cr, i, j, k, 0);
-                    Hy(i, j, k) += 1. / mu_arry * dt * (T_Algo::UpwardDx(Ez, coefs_x, n_coefs_x, i, j, k)
-                                                      - T_Algo::UpwardDz(Ex, coefs_z, n_coefs_z, i, j, k));
-                } else if (mag_Ms_yface_arr(i,j,k) > 0){ // magnetic region
-                    Hy(i, j, k) += mu0_inv * dt * (T_Algo::UpwardDx(Ez, coefs_x, n_coefs_x, i, j, k)
-                                                 - T_Algo::UpwardDz(Ex, coefs_z, n_coefs_z, i, j, k));
-                    if (coupling == 1){
-                        Hy(i, j, k) += - M_yface(i, j, k, 1) + M_old_yface(i, j, k, 1);
-                    }
+#ifdef AMREX_USE_EB
+                // faces fully covered by the embedded boundary are never stepped
+                if (Sy.p != nullptr && Sy(i, j, k) <= 0) return;
+                // with the ECT solver, the conformal circulation of E replaces the Yee curl
+                amrex::Real const minus_curlE_y = (ect_y.p != nullptr) ? ect_y(i, j, k) :
+#else
+                amrex::Real const minus_curlE_y =
+#endif
+                    T_Algo::UpwardDx(Ez, coefs_x, n_coefs_x, i, j, k) - T_Algo::UpwardDz(Ex, coefs_z, n_coefs_z, i, j, k);
+
+                // 1/mu0 on the magnetic faces (Ms > 0) and 1/mu elsewhere
+                Hy(i, j, k) += inv_mu_y(i, j, k) * dt * minus_curlE_y;
+                if (coupling == 1 && magnetic_box && mag_Ms_yface_arr(i,j,k) > 0._rt){ // magnetic region
+                    // with collocated M, the normal component on the face is the average of the two adjacent cells
+                    amrex::Real const dMy = collocated ? 0.5_rt * (M_yface(i, j-1, k, 1) + M_yface(i, j, k, 1) - M_old_yface(i, j-1, k, 1) - M_old_yface(i, j, k, 1))
+                                                 : M_yface(i, j, k, 1) - M_old_yface(i, j, k, 1);
+                    Hy(i, j, k) += - dMy;
                 }
             },
             [=] AMREX_GPU_DEVICE(int i, int j, int k) {
 
-                if (mag_Ms_zface_arr(i,j,k) == 0._rt){ // nonmagnetic region
-                    amrex::Real mu_arrz = CoarsenIO::Interp( mu_arr, mu_stag, Hz_stag,
-                                                             macro_cr, i, j, k, 0);
-                    Hz(i, j, k) += 1. / mu_arrz * dt * (T_Algo::UpwardDy(Ex, coefs_y, n_coefs_y, i, j, k)
-                                                      - T_Algo::UpwardDx(Ey, coefs_x, n_coefs_x, i, j, k));
-                } else if (mag_Ms_zface_arr(i,j,k) > 0){ // magnetic region
-                    Hz(i, j, k) += mu0_inv * dt * (T_Algo::UpwardDy(Ex, coefs_y, n_coefs_y, i, j, k)
-                                                 - T_Algo::UpwardDx(Ey, coefs_x, n_coefs_x, i, j, k));
-                    if (coupling == 1){
-                        Hz(i, j, k) += - M_zface(i, j, k, 2) + M_old_zface(i, j, k, 2);
-                    }
+#ifdef AMREX_USE_EB
+                // faces fully covered by the embedded boundary are never stepped
+                if (Sz.p != nullptr && Sz(i, j, k) <= 0) return;
+                // with the ECT solver, the conformal circulation of E replaces the Yee curl
+                amrex::Real const minus_curlE_z = (ect_z.p != nullptr) ? ect_z(i, j, k) :
+#else
+                amrex::Real const minus_curlE_z =
+#endif
+                    T_Algo::UpwardDy(Ex, coefs_y, n_coefs_y, i, j, k) - T_Algo::UpwardDx(Ey, coefs_x, n_coefs_x, i, j, k);
+
+                // 1/mu0 on the magnetic faces (Ms > 0) and 1/mu elsewhere
+                Hz(i, j, k) += inv_mu_z(i, j, k) * dt * minus_curlE_z;
+                if (coupling == 1 && magnetic_box && mag_Ms_zface_arr(i,j,k) > 0._rt){ // magnetic region
+                    // with collocated M, the normal component on the face is the average of the two adjacent cells
+                    amrex::Real const dMz = collocated ? 0.5_rt * (M_zface(i, j, k-1, 2) + M_zface(i, j, k, 2) - M_old_zface(i, j, k-1, 2) - M_old_zface(i, j, k, 2))
+                                                 : M_zface(i, j, k, 2) - M_old_zface(i, j, k, 2);
+                    Hz(i, j, k) += - dMz;
                 }
             });
     }
+}
+
+void FiniteDifferenceSolver::ComputeMacroscopicHInvMu (
+    std::array<std::unique_ptr<amrex::MultiFab>, 3> const &Hfield,
+    std::unique_ptr<MacroscopicProperties> const &macroscopic_properties)
+{
+    bool up_to_date = (macroscopic_properties->getproperties_version() == m_macro_H_inv_mu_version);
+    for (int idim = 0; idim < 3; ++idim) {
+        up_to_date = up_to_date && m_macro_H_inv_mu[idim]
+                     && m_macro_H_inv_mu[idim]->boxArray() == Hfield[idim]->boxArray()
+                     && m_macro_H_inv_mu[idim]->DistributionMap() == Hfield[idim]->DistributionMap();
+    }
+    if (up_to_date) return;
+
+    amrex::MultiFab& mu_mf = macroscopic_properties->getmu_mf();
+    amrex::GpuArray<int, 3> const& mu_stag = macroscopic_properties->mu_IndexType;
+    amrex::GpuArray<int, 3> const& macro_cr= macroscopic_properties->macro_cr_ratio;
+    std::array<amrex::GpuArray<int, 3>, 3> const H_stag = {macroscopic_properties->Hx_IndexType,
+                                                           macroscopic_properties->Hy_IndexType,
+                                                           macroscopic_properties->Hz_IndexType};
+    amrex::Real const mu0_inv = 1._rt / PhysConst::mu0;
+
+    for (int idim = 0; idim < 3; ++idim) {
+        // the H updates are done on the tile boxes, without guard cells
+        m_macro_H_inv_mu[idim] = std::make_unique<MultiFab>(Hfield[idim]->boxArray(), Hfield[idim]->DistributionMap(), 1, 0,
+                                                           StaticDataMFInfo());
+        CoarsenIO::InterpStencil const mu_stencil(mu_stag, H_stag[idim], macro_cr);
+        amrex::MultiFab& mag_Ms_mf = macroscopic_properties->getmag_Ms_mf(idim);
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#endif
+        for ( MFIter mfi(*m_macro_H_inv_mu[idim], TilingIfNotGPU()); mfi.isValid(); ++mfi ) {
+            Box const& tb = mfi.tilebox();
+            amrex::Array4<amrex::Real> const& inv_mu_arr = m_macro_H_inv_mu[idim]->array(mfi);
+            amrex::Array4<amrex::Real const> const& mu_arr = mu_mf.const_array(mfi);
+            amrex::Array4<amrex::Real const> const& mag_Ms_arr = mag_Ms_mf.const_array(mfi);
+
+            // Ms is not negative, see MacroscopicProperties::InitData
+            amrex::ParallelFor(tb,
+                [=] AMREX_GPU_DEVICE (int i, int j, int k){
+                    inv_mu_arr(i, j, k) = (mag_Ms_arr(i, j, k) > 0._rt) ? mu0_inv :
+                        1._rt / mu_stencil(mu_arr, i, j, k, 0);
+            });
+        }
+    }
+    m_macro_H_inv_mu_version = macroscopic_properties->getproperties_version();
+}
+
+void FiniteDifferenceSolver::ComputeBfromHM (
+    int lev,
+    std::array<std::unique_ptr<amrex::MultiFab>, 3> &Bfield,
+    std::array<std::unique_ptr<amrex::MultiFab>, 3> const &Hfield,
+    std::array<std::unique_ptr<amrex::MultiFab>, 3> const &Mfield,
+    std::unique_ptr<MacroscopicProperties> const &macroscopic_properties)
+{
+    amrex::LayoutData<amrex::Real>* cost = WarpX::getCosts(lev);
+
+    amrex::GpuArray<int, 3> const& mu_stag = macroscopic_properties->mu_IndexType;
+    amrex::GpuArray<int, 3> const& Bx_stag = macroscopic_properties->Bx_IndexType;
+    amrex::GpuArray<int, 3> const& By_stag = macroscopic_properties->By_IndexType;
+    amrex::GpuArray<int, 3> const& Bz_stag = macroscopic_properties->Bz_IndexType;
+    amrex::GpuArray<int, 3> const& macro_cr= macroscopic_properties->macro_cr_ratio;
+    amrex::MultiFab& mu_mf = macroscopic_properties->getmu_mf();
+    CoarsenIO::InterpStencil const mu_Bx_stencil(mu_stag, Bx_stag, macro_cr);
+    CoarsenIO::InterpStencil const mu_By_stencil(mu_stag, By_stag, macro_cr);
+    CoarsenIO::InterpStencil const mu_Bz_stencil(mu_stag, Bz_stag, macro_cr);
+
+    // with warpx.mag_M_collocated = 1, M is cell-centered and the normal component on a face
+    // is the average of the two adjacent cells
+    bool const collocated = (WarpX::GetInstance().mag_M_collocated == 1);
 
-    // update B
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#endif
     for (MFIter mfi(*Bfield[0], TilingIfNotGPU()); mfi.isValid(); ++mfi)
     {
-
-        auto& mag_Ms_xface_mf = macroscopic_properties->getmag_Ms_mf(0);
-        auto& mag_Ms_yface_mf = macroscopic_properties->getmag_Ms_mf(1);
-        auto& mag_Ms_zface_mf = macroscopic_properties->getmag_Ms_mf(2);
+        CostBoxTimer cost_box(cost, mfi.index());
 
         // extract material properties
-        Array4<Real> const& mag_Ms_xface_arr = mag_Ms_xface_mf.array(mfi);
-        Array4<Real> const& mag_Ms_yface_arr = mag_Ms_yface_mf.array(mfi);
-        Array4<Real> const& mag_Ms_zface_arr = mag_Ms_zface_mf.array(mfi);
+        Array4<Real const> const& mag_Ms_xface_arr = macroscopic_properties->getmag_Ms_mf(0).const_array(mfi);
+        Array4<Real const> const& mag_Ms_yface_arr = macroscopic_properties->getmag_Ms_mf(1).const_array(mfi);
+        Array4<Real const> const& mag_Ms_zface_arr = macroscopic_properties->getmag_Ms_mf(2).const_array(mfi);
+        Array4<Real const> const& mu_arr = mu_mf.const_array(mfi);
 
         // Extract field data for this grid/tile
-        Array4<Real> const &Hx = Hfield[0]->array(mfi);
-        Array4<Real> const &Hy = Hfield[1]->array(mfi);
-        Array4<Real> const &Hz = Hfield[2]->array(mfi);
+        Array4<Real const> const &Hx = Hfield[0]->const_array(mfi);
+        Array4<Real const> const &Hy = Hfield[1]->const_array(mfi);
+        Array4<Real const> const &Hz = Hfield[2]->const_array(mfi);
         Array4<Real> const &Bx = Bfield[0]->array(mfi);
         Array4<Real> const &By = Bfield[1]->array(mfi);
         Array4<Real> const &Bz = Bfield[2]->array(mfi);
-        Array4<Real> const &M_xface = Mfield[0]->array(mfi); // note M_xface include x,y,z components at |_x faces
-        Array4<Real> const &M_yface = Mfield[1]->array(mfi); // note M_yface include x,y,z components at |_y faces
-        Array4<Real> const &M_zface = Mfield[2]->array(mfi); // note M_zface include x,y,z components at |_z faces
+        Array4<Real const> const &M_xface = Mfield[0]->const_array(mfi); // note M_xface include x,y,z components at |_x faces
+        Array4<Real const> const &M_yface = Mfield[1]->const_array(mfi); // note M_yface include x,y,z components at |_y faces
+        Array4<Real const> const &M_zface = Mfield[2]->const_array(mfi); // note M_zface include x,y,z components at |_z faces
 
         // Extract tileboxes for which to loop
-        amrex::IntVect Bxnodal = Bfield[0]->ixType().toIntVect();
-        amrex::IntVect Bynodal = Bfield[1]->ixType().toIntVect();
-        amrex::IntVect Bznodal = Bfield[2]->ixType().toIntVect();
-        Box const &tbx = mfi.tilebox(Bxnodal);
-        Box const &tby = mfi.tilebox(Bynodal);
-        Box const &tbz = mfi.tilebox(Bznodal);
-
-        // macroscopic parameter
-        amrex::Array4<amrex::Real> const& mu_arr = mu_mf.array(mfi);
+        Box const &tbx = mfi.tilebox(Bfield[0]->ixType().toIntVect());
+        Box const &tby = mfi.tilebox(Bfield[1]->ixType().toIntVect());
+        Box const &tbz = mfi.tilebox(Bfield[2]->ixType().toIntVect());
 
         // Loop over the cells and update the fields
         amrex::ParallelFor(tbx, tby, tbz,
@@ -651,33 +1695,33 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian(
             [=] AMREX_GPU_DEVICE(int i, int j, int k) {
 
                 if (mag_Ms_xface_arr(i,j,k) == 0._rt){ // nonmagnetic region
-                    amrex::Real mu_arrx = CoarsenIO::Interp( mu_arr, mu_stag, Bx_stag,
-                                                             macro_cr, i, j, k, 0);
+                    amrex::Real mu_arrx = mu_Bx_stencil(mu_arr, i, j, k, 0);
                     Bx(i, j, k) = mu_arrx * Hx(i, j, k);
                 } else if (mag_Ms_xface_arr(i,j,k) > 0){
-                    Bx(i, j, k) = PhysConst::mu0 * (M_xface(i, j, k, 0) + Hx(i, j, k));
+                    amrex::Real const Mx = collocated ? 0.5_rt * (M_xface(i-1, j, k, 0) + M_xface(i, j, k, 0)) : M_xface(i, j, k, 0);
+                    Bx(i, j, k) = PhysConst::mu0 * (Mx + Hx(i, j, k));
                 }
             },
 
             [=] AMREX_GPU_DEVICE(int i, int j, int k) {
 
                 if (mag_Ms_yface_arr(i,j,k) == 0._rt){ // nonmagnetic region
-                    amrex::Real mu_arry = CoarsenIO::Interp( mu_arr, mu_stag, By_stag,
-                                                             macro_cr, i, j, k, 0);
+                    amrex::Real mu_arry = mu_By_stencil(mu_arr, i, j, k, 0);
                     By(i, j, k) =  mu_arry * Hy(i, j, k);
                 } else if (mag_Ms_yface_arr(i,j,k) > 0){
-                    By(i, j, k) = PhysConst::mu0 * (M_yface(i, j, k, 1) + Hy(i, j, k));
+                    amrex::Real const My = collocated ? 0.5_rt * (M_yface(i, j-1, k, 1) + M_yface(i, j, k, 1)) : M_yface(i, j, k, 1);
+                    By(i, j, k) = PhysConst::mu0 * (My + Hy(i, j, k));
                 }
             },
 
             [=] AMREX_GPU_DEVICE(int i, int j, int k) {
 
                 if (mag_Ms_zface_arr(i,j,k) == 0._rt){ // nonmagnetic region
-                    amrex::Real mu_arrz = CoarsenIO::Interp( mu_arr, mu_stag, Bz_stag,
-                                                             macro_cr, i, j, k, 0);
+                    amrex::Real mu_arrz = mu_Bz_stencil(mu_arr, i, j, k, 0);
                     Bz(i, j, k) = mu_arrz * Hz(i, j, k);
                 } else if (mag_Ms_zface_arr(i,j,k) > 0){
-                    Bz(i, j, k) = PhysConst::mu0 * (M_zface(i, j, k, 2) + Hz(i, j, k));
+                    amrex::Real const Mz = collocated ? 0.5_rt * (M_zface(i, j, k-1, 2) + M_zface(i, j, k, 2)) : M_zface(i, j, k, 2);
+                    Bz(i, j, k) = PhysConst::mu0 * (Mz + Hz(i, j, k));
                 }
             });
     }
@@ -3,19 +3,31 @@ blank
 */
 
 #include "WarpX.H"
+#include "Parallelization/CostsBreakdown.H"
 #include "Utils/WarpXAlgorithmSelection.H"
 #include "FiniteDifferenceSolver.H"
+#include "LLGCompileTimeOptions.H"
 #ifdef WARPX_DIM_RZ
 #include "FiniteDifferenceAlgorithms/CylindricalYeeAlgorithm.H"
 #else
 #include "FiniteDifferenceAlgorithms/CartesianYeeAlgorithm.H"
 #endif
 #include "FieldSolver/FiniteDifferenceSolver/MacroscopicProperties/MacroscopicProperties.H"
+#include "FieldSolver/FiniteDifferenceSolver/MacroscopicProperties/MagInterlayerCoupling.H"
+#include "FieldSolver/FiniteDifferenceSolver/MacroscopicProperties/MagSpinTorque.H"
+#include "FieldSolver/FiniteDifferenceSolver/MacroscopicProperties/MagThermalField.H"
 
 #include "Utils/WarpXConst.H"
 #include "Utils/CoarsenIO.H"
+#include "Utils/MemoryFootprint.H"
 #include "Utils/WarpXUtil.H"
+#include "ablastr/profiler/ProfilerWrapper.H"
 #include <AMReX_Gpu.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_Reduce.H>
+#include <AMReX_Utility.H>
+
+#include <numeric>
 
 using namespace amrex;
 
@@ -32,81 +44,267 @@ void FiniteDifferenceSolver::MacroscopicEvolveHM_2nd(
     int lev,
     std::array<std::unique_ptr<amrex::MultiFab>, 3> &Mfield, // Mfield contains three components MultiFab
     std::array<std::unique_ptr<amrex::MultiFab>, 3> &Hfield,
-    std::array<std::unique_ptr<amrex::MultiFab>, 3> &Bfield,
     std::array<std::unique_ptr<amrex::MultiFab>, 3> const &H_biasfield, // H bias
     std::array<std::unique_ptr<amrex::MultiFab>, 3> const &Efield,
+    std::array<std::unique_ptr<amrex::MultiFab>, 3> const &face_areas,
+    std::array<std::unique_ptr<amrex::MultiFab>, 3> const &ect_minus_curlE,
     amrex::Real const dt,
+    amrex::Real const dt_M,
     std::unique_ptr<MacroscopicProperties> const &macroscopic_properties) {
 
-    if (m_fdtd_algo == MaxwellSolverAlgo::Yee){
-        MacroscopicEvolveHMCartesian_2nd<CartesianYeeAlgorithm>(lev, Mfield, Hfield, Bfield, H_biasfield, Efield, dt, macroscopic_properties);
+    // with ECT, the H update takes the conformal circulation of E and the M update is the Yee one
+    if (m_fdtd_algo == MaxwellSolverAlgo::Yee || m_fdtd_algo == MaxwellSolverAlgo::ECT){
+        // the coupling options are template parameters of the kernels, so that they are compiled without branches on them
+        auto &warpx = WarpX::GetInstance();
+        LLGOptions::DispatchCouplings(warpx.mag_LLG_coupling, warpx.mag_M_normalization,
+                                      warpx.mag_LLG_exchange_coupling, warpx.mag_LLG_anisotropy_coupling,
+            [&] (auto c, auto n, auto e, auto a) {
+                MacroscopicEvolveHMCartesian_2nd<CartesianYeeAlgorithm, decltype(c)::value, decltype(n)::value, decltype(e)::value, decltype(a)::value>(lev, Mfield, Hfield, H_biasfield, Efield, face_areas, ect_minus_curlE, dt, dt_M, macroscopic_properties);
+            });
     } else {
         amrex::Abort("Only yee algorithm is compatible for M updates.");
     }
 } // closes function MacroscopicEvolveHM_2nd
+
+void FiniteDifferenceSolver::AllocateLLGScratch (
+    std::array<std::unique_ptr<amrex::MultiFab>, 3> const &Mfield,
+    std::array<std::unique_ptr<amrex::MultiFab>, 3> const &Hfield,
+    std::unique_ptr<MacroscopicProperties> const &macroscopic_properties) {
+
+    // select the boxes on which the M work arrays are defined: all the boxes of Mfield,
+    // or only those containing magnetic material if macroscopic.mag_subdomain = 1
+    int const nboxes = Mfield[0]->boxArray().size();
+    bool use_subdomain = (macroscopic_properties->getmag_subdomain() == 1);
+    amrex::Vector<int> box_index;
+    for (int ibox = 0; ibox < nboxes; ++ibox){
+        if (!use_subdomain || macroscopic_properties->has_magnetic_material(ibox)){
+            box_index.push_back(ibox);
+        }
+    }
+    // fall back to the full layout if there is no magnetic material at all
+    if (box_index.empty()){
+        use_subdomain = false;
+        box_index.resize(nboxes);
+        std::iota(box_index.begin(), box_index.end(), 0);
+    }
+
+    // nothing to do if the work arrays are still defined on the current layout and on the
+    // current magnetic boxes, which change when the properties are modified or shifted
+    bool up_to_date = (box_index == m_llg_box_index);
+    for (int i = 0; i < 3; i++){
+        up_to_date = up_to_date && m_llg_Hfield_old[i]
+            && m_llg_Hfield_old[i]->boxArray() == Hfield[i]->boxArray()
+            && m_llg_Hfield_old[i]->DistributionMap() == Hfield[i]->DistributionMap()
+            && m_llg_Hfield_old[i]->nGrowVect() == Hfield[i]->nGrowVect();
+    }
+    if (up_to_date) return;
+
+    // H^(old_time) is needed everywhere, for the H update of the non-magnetic region
+    for (int i = 0; i < 3; i++){
+        m_llg_Hfield_old[i] = std::make_unique<MultiFab>(Hfield[i]->boxArray(), Hfield[i]->DistributionMap(), 1, Hfield[i]->nGrowVect());
+    }
+
+    m_llg_box_index = std::move(box_index);
+    m_llg_scratch_index.assign(nboxes, -1);
+    for (int l = 0; l < static_cast<int>(m_llg_box_index.size()); ++l){
+        m_llg_scratch_index[m_llg_box_index[l]] = l;
+    }
+
+    // the boxes of the sub-domain keep their owner, so that no communication is needed
+    // to access the fields of the full layout
+    amrex::DistributionMapping dm = Mfield[0]->DistributionMap();
+    if (use_subdomain){
+        amrex::Vector<int> pmap;
+        for (int ibox : m_llg_box_index) pmap.push_back(dm[ibox]);
+        dm = amrex::DistributionMapping(pmap);
+    }
+
+    for (int i = 0; i < 3; i++){
+        amrex::BoxArray ba = Mfield[i]->boxArray();
+        if (use_subdomain){
+            amrex::BoxList bl(ba.ixType());
+            for (int ibox : m_llg_box_index) bl.push_back(ba[ibox]);
+            ba = amrex::BoxArray(std::move(bl));
+        }
+        amrex::IntVect const ng = Mfield[i]->nGrowVect();
+
+        m_llg_Mfield_old[i] = std::make_unique<MultiFab>(ba, dm, 3, ng);
+        m_llg_Mfield_prev[i] = std::make_unique<MultiFab>(ba, dm, 3, ng);
+        m_llg_Mfield_error[i] = std::make_unique<MultiFab>(ba, dm, 3, ng);
+        m_llg_a_temp[i] = std::make_unique<MultiFab>(ba, dm, 3, ng);
+        m_llg_a_temp_static[i] = std::make_unique<MultiFab>(ba, dm, 3, ng);
+        m_llg_b_temp_static[i] = std::make_unique<MultiFab>(ba, dm, 3, ng);
+    }
+}
+
+void FiniteDifferenceSolver::CopyToLLGScratch (amrex::MultiFab& scratch, amrex::MultiFab const& field) {
+
+    if (scratch.boxArray() == field.boxArray()){
+        MultiFab::Copy(scratch, field, 0, 0, scratch.nComp(), scratch.nGrowVect());
+        return;
+    }
+
+    int const ncomp = scratch.nComp();
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi(scratch); mfi.isValid(); ++mfi){
+        Box const& bx = mfi.fabbox();
+        Array4<Real> const& dst = scratch.array(mfi);
+        Array4<Real const> const& src = field.const_array(m_llg_box_index[mfi.index()]);
+        amrex::ParallelFor(bx, ncomp,
+            [=] AMREX_GPU_DEVICE(int i, int j, int k, int n) {
+                dst(i, j, k, n) = src(i, j, k, n);
+            });
+    }
+}
+
+void FiniteDifferenceSolver::ClearLLGScratch () {
+    for (int i = 0; i < 3; i++){
+        m_llg_Hfield_old[i].reset();
+        m_llg_Mfield_old[i].reset();
+        m_llg_Mfield_prev[i].reset();
+        m_llg_Mfield_error[i].reset();
+        m_llg_a_temp[i].reset();
+        m_llg_a_temp_static[i].reset();
+        m_llg_b_temp_static[i].reset();
+        m_macro_H_inv_mu[i].reset();
+    }
+    m_macro_H_inv_mu_version = -1;
+    m_llg_box_index.clear();
+    m_llg_scratch_index.clear();
+    for (int i = 0; i < 3; i++){
+        m_llg_rk_Mstage[i].reset();
+    }
+    m_llg_rk_k.clear();
+    m_llg_implicit_work.clear();
+    m_llg_implicit_krylov.clear();
+}
+
+double FiniteDifferenceSolver::LLGScratchBytes () const {
+    double bytes = LocalMemoryBytes(m_llg_Hfield_old) + LocalMemoryBytes(m_llg_Mfield_old)
+                 + LocalMemoryBytes(m_llg_Mfield_prev) + LocalMemoryBytes(m_llg_Mfield_error)
+                 + LocalMemoryBytes(m_llg_a_temp) + LocalMemoryBytes(m_llg_a_temp_static)
+                 + LocalMemoryBytes(m_llg_b_temp_static) + LocalMemoryBytes(m_llg_rk_Mstage)
+                 + LocalMemoryBytes(m_macro_H_inv_mu);
+    for (auto const& k : m_llg_rk_k) bytes += LocalMemoryBytes(k);
+    for (auto const& w : m_llg_implicit_work) bytes += LocalMemoryBytes(w);
+    for (auto const& v : m_llg_implicit_krylov) bytes += LocalMemoryBytes(v);
+    return bytes;
+}
 #endif
 #ifdef WARPX_MAG_LLG
-template <typename T_Algo>
+namespace {
+    /** \brief Boxes of tb to be updated in the given pass of an LLG iteration.
+     *  If overlap is true, pass 0 is the part of tb which does not read the ng guard cells
+     *  of the valid box vbx, and pass 1 is the rest of tb. Otherwise it is tb itself. */
+    amrex::BoxList LLGIterationRegions (amrex::Box const& tb, amrex::Box const& vbx,
+                                        amrex::IntVect const& ng, bool overlap, int pass)
+    {
+        if (!overlap) return amrex::BoxList(tb);
+        amrex::Box const interior = tb & amrex::grow(amrex::convert(vbx, tb.ixType()), -ng);
+        if (pass == 0) return interior.ok() ? amrex::BoxList(interior) : amrex::BoxList(tb.ixType());
+        return interior.ok() ? amrex::boxDiff(tb, interior) : amrex::BoxList(tb);
+    }
+}
+
+template <typename T_Algo, int T_coupling, int T_M_normalization, int T_exchange_coupling, int T_anisotropy_coupling>
 void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian_2nd(
     int lev,
     std::array<std::unique_ptr<amrex::MultiFab>, 3> &Mfield,
     std::array<std::unique_ptr<amrex::MultiFab>, 3> &Hfield,
-    std::array<std::unique_ptr<amrex::MultiFab>, 3> &Bfield,
     std::array<std::unique_ptr<amrex::MultiFab>, 3> const &H_biasfield, // H bias
     std::array<std::unique_ptr<amrex::MultiFab>, 3> const &Efield,
+    std::array<std::unique_ptr<amrex::MultiFab>, 3> const &face_areas,
+    std::array<std::unique_ptr<amrex::MultiFab>, 3> const &ect_minus_curlE,
     amrex::Real const dt,
+    amrex::Real const dt_M,
     std::unique_ptr<MacroscopicProperties> const &macroscopic_properties) {
+#ifndef AMREX_USE_EB
+    amrex::ignore_unused(face_areas, ect_minus_curlE);
+#endif
+
+    amrex::LayoutData<amrex::Real>* cost = WarpX::getCosts(lev);
 
     // obtain the maximum relative amount we let M deviate from Ms before aborting
     amrex::Real mag_normalized_error = macroscopic_properties->getmag_normalized_error();
 
     auto &warpx = WarpX::GetInstance();
-    int coupling = warpx.mag_LLG_coupling;
-    int M_normalization = warpx.mag_M_normalization;
-    int mag_exchange_coupling = warpx.mag_LLG_exchange_coupling;
-    int mag_anisotropy_coupling = warpx.mag_LLG_anisotropy_coupling;
-
-    // build temporary vector<multifab,3> Mfield_prev, Mfield_error, a_temp, a_temp_static, b_temp_static
-    std::array<std::unique_ptr<amrex::MultiFab>, 3> Hfield_old;    // H^(old_time) before the current time step
-    std::array<std::unique_ptr<amrex::MultiFab>, 3> Mfield_old;    // M^(old_time) before the current time step
-    std::array<std::unique_ptr<amrex::MultiFab>, 3> Mfield_prev;   // M^(new_time) of the (r-1)th iteration
-    std::array<std::unique_ptr<amrex::MultiFab>, 3> Mfield_error;  // The error of the M field between the two consecutive iterations
-    std::array<std::unique_ptr<amrex::MultiFab>, 3> a_temp;        // right-hand side of vector a, see the documentation
-    std::array<std::unique_ptr<amrex::MultiFab>, 3> a_temp_static; // α M^(old_time)/|M| in the right-hand side of vector a, see the documentation
-    std::array<std::unique_ptr<amrex::MultiFab>, 3> b_temp_static; // right-hand side of vector b, see the documentation
-
-    amrex::GpuArray<int, 3> const& mu_stag  = macroscopic_properties->mu_IndexType;
-    amrex::GpuArray<int, 3> const& Bx_stag  = macroscopic_properties->Bx_IndexType;
-    amrex::GpuArray<int, 3> const& By_stag  = macroscopic_properties->By_IndexType;
-    amrex::GpuArray<int, 3> const& Bz_stag  = macroscopic_properties->Bz_IndexType;
-    amrex::GpuArray<int, 3> const& Hx_stag  = macroscopic_properties->Hx_IndexType;
-    amrex::GpuArray<int, 3> const& Hy_stag  = macroscopic_properties->Hy_IndexType;
-    amrex::GpuArray<int, 3> const& Hz_stag  = macroscopic_properties->Hz_IndexType;
-    amrex::GpuArray<int, 3> const& macro_cr = macroscopic_properties->macro_cr_ratio;
-    amrex::GpuArray<amrex::Real, 3> const& anisotropy_axis = macroscopic_properties->mag_LLG_anisotropy_axis;
+    // options of the LLG equation
+    constexpr int coupling = T_coupling;
+    constexpr int M_normalization = T_M_normalization;
+    constexpr int mag_exchange_coupling = T_exchange_coupling;
+    constexpr int mag_anisotropy_coupling = T_anisotropy_coupling;
+    // spin torques (0: off, 1: on), a runtime branch, since they are seldom used
+    int const mag_spin_torque_coupling = warpx.mag_LLG_spin_torque_coupling;
+    // time at which the current density of the spin torques is evaluated
+    amrex::Real const spin_torque_time = WarpX::GetInstance().gett_new(lev);
+    // thermal field of this LLG update, the same in the static part and in all the iterations
+    bool const thermal_field = (dt_M > 0._rt && macroscopic_properties->HasThermalField());
+    if (thermal_field) macroscopic_properties->AdvanceThermalField(lev);
+    MagThermalField const thermal = thermal_field
+        ? macroscopic_properties->GetThermalField(lev, dt_M) : MagThermalField{};
+
+    // get the persistent vector<multifab,3> Hfield_old, Mfield_old, Mfield_prev, Mfield_error, a_temp, a_temp_static, b_temp_static
+    // (only allocated on the first call, or after the level has been remade)
+    // Except Hfield_old, they may only be defined on the boxes with magnetic material: for a box
+    // of global index K of Mfield, they are accessed with the index LLGScratchIndex(K)
+    AllocateLLGScratch(Mfield, Hfield, macroscopic_properties);
+    auto& Hfield_old = m_llg_Hfield_old;       // H^(old_time) before the current time step
+    auto& Mfield_old = m_llg_Mfield_old;       // M^(old_time) before the current time step
+    auto& Mfield_prev = m_llg_Mfield_prev;     // M^(new_time) of the (r-1)th iteration
+    auto& Mfield_error = m_llg_Mfield_error;   // The error of the M field between the two consecutive iterations
+    auto& a_temp = m_llg_a_temp;               // right-hand side of vector a, see the documentation
+    auto& a_temp_static = m_llg_a_temp_static; // α M^(old_time)/|M| in the right-hand side of vector a, see the documentation
+    auto& b_temp_static = m_llg_b_temp_static; // right-hand side of vector b, see the documentation
+
+    // anisotropy axes of the grains, and type of the anisotropy
+    amrex::Real const* const anisotropy_axes = macroscopic_properties->getmag_anisotropy_axes();
+    int const anisotropy_type = macroscopic_properties->getmag_anisotropy_type();
+    // DMI coupling (0: off, 1: interfacial, 2: bulk), a runtime branch inside the exchange term
+    int const DMI_type = macroscopic_properties->getmag_DMI_type();
+
+    // H_bias is either stored on the faces, or uniform (warpx.mag_H_bias_uniform = 1), in which case
+    // it is not read from memory in the iterations
+    bool const H_bias_uniform = (H_biasfield[0] == nullptr);
+    amrex::GpuArray<amrex::Real, 3> const H_bias_value = H_bias_uniform
+        ? warpx.getH_bias_uniform(lev) : amrex::GpuArray<amrex::Real, 3>{0._rt, 0._rt, 0._rt};
 
     // Initialize Hfield_old (H^(old_time)), Mfield_old (M^(old_time)), Mfield_prev (M^[(new_time),r-1]), Mfield_error
     for (int i = 0; i < 3; i++){
-        Hfield_old[i].reset(new MultiFab(Hfield[i]->boxArray(), Hfield[i]->DistributionMap(), 1, Hfield[i]->nGrow()));
-        Mfield_old[i].reset(new MultiFab(Mfield[i]->boxArray(), Mfield[i]->DistributionMap(), 3, Mfield[i]->nGrow()));
-        Mfield_prev[i].reset(new MultiFab(Mfield[i]->boxArray(), Mfield[i]->DistributionMap(), 3, Mfield[i]->nGrow()));
-        Mfield_error[i].reset(new MultiFab(Mfield[i]->boxArray(), Mfield[i]->DistributionMap(), 3, Mfield[i]->nGrow()));
         Mfield_error[i]->setVal(0.); // reset Mfield_error to zero
         MultiFab::Copy(*Hfield_old[i], *Hfield[i], 0, 0, 1, Hfield[i]->nGrow());
-        MultiFab::Copy(*Mfield_old[i], *Mfield[i], 0, 0, 3, Mfield[i]->nGrow());
-        MultiFab::Copy(*Mfield_prev[i], *Mfield[i], 0, 0, 3, Mfield[i]->nGrow());
-    }
-    // initialize a_temp, a_temp_static, b_temp_static
-    for (int i = 0; i < 3; i++){
-        a_temp[i].reset(new MultiFab(Mfield[i]->boxArray(), Mfield[i]->DistributionMap(), 3, Mfield[i]->nGrow()));
-        a_temp_static[i].reset(new MultiFab(Mfield[i]->boxArray(), Mfield[i]->DistributionMap(), 3, Mfield[i]->nGrow()));
-        b_temp_static[i].reset(new MultiFab(Mfield[i]->boxArray(), Mfield[i]->DistributionMap(), 3, Mfield[i]->nGrow()));
+        CopyToLLGScratch(*Mfield_old[i], *Mfield[i]);
+        CopyToLLGScratch(*Mfield_prev[i], *Mfield[i]);
     }
 
-    amrex::MultiFab& mu_mf = macroscopic_properties->getmu_mf();
+    // 1/mu at the H locations, for the H updates of the iterations
+    ComputeMacroscopicHInvMu(Hfield, macroscopic_properties);
+
+    // interlayer exchange field of M^(old_time)
+    macroscopic_properties->UpdateInterlayerCoupling(Mfield);
 
+    // hardware counters or GPU profiler ranges of the kernels of the iteration (WarpX_KERNEL_COUNTERS)
+    ABLASTR_KERNEL_RANGE_BEGIN("LLG_2nd::Coefficients");
     // calculate the b_temp_static, a_temp_static
-    for (MFIter mfi(*a_temp_static[0], TilingIfNotGPU()); mfi.isValid(); ++mfi) {
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi(*Mfield[0], TilingIfNotGPU()); mfi.isValid(); ++mfi) {
+        // skip the boxes that do not contain any magnetic material, and all the boxes if M is not advanced
+        if (dt_M == 0._rt || !macroscopic_properties->has_magnetic_material(mfi.index())) continue;
+        CostBoxTimer cost_box(cost, mfi.index());
+
+        // spin torques of the current density on this box
+        MagSpinTorque const spin_torque = (mag_spin_torque_coupling == 1)
+            ? macroscopic_properties->GetSpinTorque(mfi, lev, spin_torque_time) : MagSpinTorque{};
+
+        // interlayer exchange field of the interface faces of this box, empty if none
+        MagInterlayerField const interlayer_x = macroscopic_properties->GetInterlayerField(0, mfi);
+        MagInterlayerField const interlayer_y = macroscopic_properties->GetInterlayerField(1, mfi);
+        MagInterlayerField const interlayer_z = macroscopic_properties->GetInterlayerField(2, mfi);
+
+        int const iscratch = LLGScratchIndex(mfi.index());
 
         auto& mag_Ms_xface_mf = macroscopic_properties->getmag_Ms_mf(0);
         auto& mag_Ms_yface_mf = macroscopic_properties->getmag_Ms_mf(1);
@@ -114,15 +312,6 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian_2nd(
         auto& mag_alpha_xface_mf = macroscopic_properties->getmag_alpha_mf(0);
         auto& mag_alpha_yface_mf = macroscopic_properties->getmag_alpha_mf(1);
         auto& mag_alpha_zface_mf = macroscopic_properties->getmag_alpha_mf(2);
-        auto& mag_gamma_xface_mf = macroscopic_properties->getmag_gamma_mf(0);
-        auto& mag_gamma_yface_mf = macroscopic_properties->getmag_gamma_mf(1);
-        auto& mag_gamma_zface_mf = macroscopic_properties->getmag_gamma_mf(2);
-        auto& mag_exchange_xface_mf = macroscopic_properties->getmag_exchange_mf(0);
-        auto& mag_exchange_yface_mf = macroscopic_properties->getmag_exchange_mf(1);
-        auto& mag_exchange_zface_mf = macroscopic_properties->getmag_exchange_mf(2);
-        auto& mag_anisotropy_xface_mf = macroscopic_properties->getmag_anisotropy_mf(0);
-        auto& mag_anisotropy_yface_mf = macroscopic_properties->getmag_anisotropy_mf(1);
-        auto& mag_anisotropy_zface_mf = macroscopic_properties->getmag_anisotropy_mf(2);
 
         // extract material properties
         Array4<Real> const& mag_Ms_xface_arr = mag_Ms_xface_mf.array(mfi);
@@ -131,34 +320,31 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian_2nd(
         Array4<Real> const& mag_alpha_xface_arr = mag_alpha_xface_mf.array(mfi);
         Array4<Real> const& mag_alpha_yface_arr = mag_alpha_yface_mf.array(mfi);
         Array4<Real> const& mag_alpha_zface_arr = mag_alpha_zface_mf.array(mfi);
-        Array4<Real> const& mag_gamma_xface_arr = mag_gamma_xface_mf.array(mfi);
-        Array4<Real> const& mag_gamma_yface_arr = mag_gamma_yface_mf.array(mfi);
-        Array4<Real> const& mag_gamma_zface_arr = mag_gamma_zface_mf.array(mfi);
-        Array4<Real> const& mag_exchange_xface_arr = mag_exchange_xface_mf.array(mfi);
-        Array4<Real> const& mag_exchange_yface_arr = mag_exchange_yface_mf.array(mfi);
-        Array4<Real> const& mag_exchange_zface_arr = mag_exchange_zface_mf.array(mfi);
-        Array4<Real> const& mag_anisotropy_xface_arr = mag_anisotropy_xface_mf.array(mfi);
-        Array4<Real> const& mag_anisotropy_yface_arr = mag_anisotropy_yface_mf.array(mfi);
-        Array4<Real> const& mag_anisotropy_zface_arr = mag_anisotropy_zface_mf.array(mfi);
+        Array4<MacroscopicProperties::MagCoefReal const> const& mag_coefs_xface_arr = macroscopic_properties->getmag_coefs_mf(0).const_array(mfi);
+        Array4<int const> const grain_xface_arr = macroscopic_properties->getmag_grain_array(0, mfi);
+        Array4<MacroscopicProperties::MagCoefReal const> const& mag_coefs_yface_arr = macroscopic_properties->getmag_coefs_mf(1).const_array(mfi);
+        Array4<int const> const grain_yface_arr = macroscopic_properties->getmag_grain_array(1, mfi);
+        Array4<MacroscopicProperties::MagCoefReal const> const& mag_coefs_zface_arr = macroscopic_properties->getmag_coefs_mf(2).const_array(mfi);
+        Array4<int const> const grain_zface_arr = macroscopic_properties->getmag_grain_array(2, mfi);
 
         // extract field data
         Array4<Real> const &M_xface = Mfield[0]->array(mfi);      // note M_xface include x,y,z components at |_x faces
         Array4<Real> const &M_yface = Mfield[1]->array(mfi);      // note M_yface include x,y,z components at |_y faces
         Array4<Real> const &M_zface = Mfield[2]->array(mfi);      // note M_zface include x,y,z components at |_z faces
-        Array4<Real> const &Hx_bias = H_biasfield[0]->array(mfi); // Hx_bias is the x component at |_x faces
-        Array4<Real> const &Hy_bias = H_biasfield[1]->array(mfi); // Hy_bias is the y component at |_y faces
-        Array4<Real> const &Hz_bias = H_biasfield[2]->array(mfi); // Hz_bias is the z component at |_z faces
+        Array4<Real> const Hx_bias = H_bias_uniform ? Array4<Real>{} : H_biasfield[0]->array(mfi); // Hx_bias is the x component at |_x faces
+        Array4<Real> const Hy_bias = H_bias_uniform ? Array4<Real>{} : H_biasfield[1]->array(mfi); // Hy_bias is the y component at |_y faces
+        Array4<Real> const Hz_bias = H_bias_uniform ? Array4<Real>{} : H_biasfield[2]->array(mfi); // Hz_bias is the z component at |_z faces
         Array4<Real> const &Hx_old = Hfield_old[0]->array(mfi);   // Hx_old is the x component at |_x faces
         Array4<Real> const &Hy_old = Hfield_old[1]->array(mfi);   // Hy_old is the y component at |_y faces
         Array4<Real> const &Hz_old = Hfield_old[2]->array(mfi);   // Hz_old is the z component at |_z faces
 
         // extract field data of a_temp_static and b_temp_static
-        Array4<Real> const &a_temp_static_xface = a_temp_static[0]->array(mfi);
-        Array4<Real> const &a_temp_static_yface = a_temp_static[1]->array(mfi);
-        Array4<Real> const &a_temp_static_zface = a_temp_static[2]->array(mfi);
-        Array4<Real> const &b_temp_static_xface = b_temp_static[0]->array(mfi);
-        Array4<Real> const &b_temp_static_yface = b_temp_static[1]->array(mfi);
-        Array4<Real> const &b_temp_static_zface = b_temp_static[2]->array(mfi);
+        Array4<Real> const &a_temp_static_xface = a_temp_static[0]->array(iscratch);
+        Array4<Real> const &a_temp_static_yface = a_temp_static[1]->array(iscratch);
+        Array4<Real> const &a_temp_static_zface = a_temp_static[2]->array(iscratch);
+        Array4<Real> const &b_temp_static_xface = b_temp_static[0]->array(iscratch);
+        Array4<Real> const &b_temp_static_yface = b_temp_static[1]->array(iscratch);
+        Array4<Real> const &b_temp_static_zface = b_temp_static[2]->array(iscratch);
 
         // extract tileboxes for which to loop
         amrex::IntVect Mxface_stag = Mfield[0]->ixType().toIntVect();
@@ -187,9 +373,9 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian_2nd(
                     // Hy and Hz can be acquired by interpolation
 
                     // H_bias
-                    amrex::Real Hx_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, Mxface_stag, Mxface_stag, Hx_bias);
-                    amrex::Real Hy_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, Myface_stag, Mxface_stag, Hy_bias);
-                    amrex::Real Hz_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, Mzface_stag, Mxface_stag, Hz_bias);
+                    amrex::Real Hx_eff = MacroscopicProperties::getH_bias(i, j, k, Mxface_stag, Mxface_stag, Hx_bias, H_bias_uniform, H_bias_value[0]);
+                    amrex::Real Hy_eff = MacroscopicProperties::getH_bias(i, j, k, Myface_stag, Mxface_stag, Hy_bias, H_bias_uniform, H_bias_value[1]);
+                    amrex::Real Hz_eff = MacroscopicProperties::getH_bias(i, j, k, Mzface_stag, Mxface_stag, Hz_bias, H_bias_uniform, H_bias_value[2]);
 
                     if (coupling == 1){
                         // H_eff = H_maxwell + H_bias + H_exchange + H_anisotropy
@@ -202,10 +388,8 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian_2nd(
 
                     if (mag_exchange_coupling == 1){
 
-                        if (mag_exchange_xface_arr(i,j,k) == 0._rt) amrex::Abort("The mag_exchange_xface_arr(i,j,k) is 0.0 while including the exchange coupling term H_exchange for H_eff");
-
                         // H_exchange - use M^(old_time)
-                        amrex::Real const H_exchange_coeff = 2.0 * mag_exchange_xface_arr(i,j,k) / PhysConst::mu0 / mag_Ms_xface_arr(i,j,k) / mag_Ms_xface_arr(i,j,k);
+                        amrex::Real const H_exchange_coeff = mag_coefs_xface_arr(i,j,k,MacroscopicProperties::mag_coef_exchange);
 
                         amrex::Real Ms_lo_x = mag_Ms_xface_arr(i-1, j, k);
                         amrex::Real Ms_hi_x = mag_Ms_xface_arr(i+1, j, k);
@@ -217,32 +401,46 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian_2nd(
                         Hx_eff += H_exchange_coeff * T_Algo::Laplacian_Mag(M_xface, coefs_x, coefs_y, coefs_z, n_coefs_x, n_coefs_y, n_coefs_z, Ms_lo_x, Ms_hi_x, Ms_lo_y, Ms_hi_y, Ms_lo_z, Ms_hi_z, i, j, k, 0, 0); //Last argument is nodality -- xface = 0
                         Hy_eff += H_exchange_coeff * T_Algo::Laplacian_Mag(M_xface, coefs_x, coefs_y, coefs_z, n_coefs_x, n_coefs_y, n_coefs_z, Ms_lo_x, Ms_hi_x, Ms_lo_y, Ms_hi_y, Ms_lo_z, Ms_hi_z, i, j, k, 1, 0); //Last argument is nodality -- xface = 0
                         Hz_eff += H_exchange_coeff * T_Algo::Laplacian_Mag(M_xface, coefs_x, coefs_y, coefs_z, n_coefs_x, n_coefs_y, n_coefs_z, Ms_lo_x, Ms_hi_x, Ms_lo_y, Ms_hi_y, Ms_lo_z, Ms_hi_z, i, j, k, 2, 0); //Last argument is nodality -- xface = 0
+
+                        // H_DMI - same M and neighbor Ms as H_exchange, in the same pass
+                        if (DMI_type != 0){
+                            T_Algo::AddDMIField_Mag(M_xface, coefs_x, coefs_y, coefs_z, n_coefs_x, n_coefs_y, n_coefs_z, Ms_lo_x, Ms_hi_x, Ms_lo_y, Ms_hi_y, Ms_lo_z, Ms_hi_z, i, j, k, 0, DMI_type,
+                                                    mag_coefs_xface_arr(i,j,k,MacroscopicProperties::mag_coef_DMI), Hx_eff, Hy_eff, Hz_eff);
+                        }
                     }
 
                     if (mag_anisotropy_coupling == 1){
 
-                        if (mag_anisotropy_xface_arr(i,j,k) == 0._rt) amrex::Abort("The mag_anisotropy_xface_arr(i,j,k) is 0.0 while including the anisotropy coupling term H_anisotropy for H_eff");
-
                         // H_anisotropy - use M^(old_time)
-                        amrex::Real M_dot_anisotropy_axis = 0.0;
-                        for (int comp=0; comp<3; ++comp) {
-                            M_dot_anisotropy_axis += M_xface(i, j, k, comp) * anisotropy_axis[comp];
-                        }
-                        amrex::Real const H_anisotropy_coeff = - 2.0 * mag_anisotropy_xface_arr(i,j,k) / PhysConst::mu0 / mag_Ms_xface_arr(i,j,k) / mag_Ms_xface_arr(i,j,k);
-                        Hx_eff += H_anisotropy_coeff * M_dot_anisotropy_axis * anisotropy_axis[0];
-                        Hy_eff += H_anisotropy_coeff * M_dot_anisotropy_axis * anisotropy_axis[1];
-                        Hz_eff += H_anisotropy_coeff * M_dot_anisotropy_axis * anisotropy_axis[2];
+                        amrex::Real const H_anisotropy_coeff = mag_coefs_xface_arr(i,j,k,MacroscopicProperties::mag_coef_anisotropy);
+                        MacroscopicProperties::addH_anisotropy(i, j, k, grain_xface_arr, anisotropy_axes, anisotropy_type, H_anisotropy_coeff,
+                                                               M_xface(i, j, k, 0), M_xface(i, j, k, 1), M_xface(i, j, k, 2), Hx_eff, Hy_eff, Hz_eff);
+                    }
+
+                    // H_interlayer - use M^(old_time) of the paired faces across the spacer
+                    interlayer_x.AddEffectiveField(i, j, k, Hx_eff, Hy_eff, Hz_eff);
+
+                    if (mag_spin_torque_coupling == 1){
+
+                        // H_spin_torque - use M^(old_time)
+                        spin_torque.AddEffectiveField(i, j, k, Mxface_stag, mag_Ms_xface_arr(i,j,k), M_xface(i, j, k, 0), M_xface(i, j, k, 1), M_xface(i, j, k, 2), Hx_eff, Hy_eff, Hz_eff);
+                    }
+
+                    if (thermal_field){
+
+                        // H_thermal - the same random field in all the iterations of the update
+                        thermal.AddEffectiveField(i, j, k, Mxface_stag, 0, mag_alpha_xface_arr(i,j,k), mag_Ms_xface_arr(i,j,k), mag_coefs_xface_arr(i,j,k,MacroscopicProperties::mag_coef_gamma), Hx_eff, Hy_eff, Hz_eff);
                     }
 
                     // 0 = unsaturated; compute |M| locally.  1 = saturated; use M_s
-                    amrex::Real M_magnitude = (M_normalization == 0) ? std::sqrt(std::pow(M_xface(i, j, k, 0), 2._rt) + std::pow(M_xface(i, j, k, 1), 2._rt) + std::pow(M_xface(i, j, k, 2), 2._rt))
+                    amrex::Real M_magnitude = (M_normalization == 0) ? std::sqrt(M_xface(i, j, k, 0)*M_xface(i, j, k, 0) + M_xface(i, j, k, 1)*M_xface(i, j, k, 1) + M_xface(i, j, k, 2)*M_xface(i, j, k, 2))
                                                               : mag_Ms_xface_arr(i,j,k);
                     // a_temp_static_coeff does not change in the current step for SATURATED materials; but it does change for UNSATURATED ones
                     amrex::Real a_temp_static_coeff = mag_alpha_xface_arr(i,j,k) / M_magnitude;
 
                     // calculate the b_temp_static_coeff (it is divided by 2.0 because the derivation is based on an interger dt,
                     // while in real simulations, the input dt is actually dt/2.0)
-                    amrex::Real b_temp_static_coeff = - PhysConst::mu0 * amrex::Math::abs(mag_gamma_xface_arr(i,j,k)) / 2._rt;
+                    amrex::Real b_temp_static_coeff = - mag_coefs_xface_arr(i,j,k,MacroscopicProperties::mag_coef_gamma);
 
                     for (int comp=0; comp<3; ++comp) {
                         // calculate a_temp_static_xface
@@ -252,13 +450,13 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian_2nd(
 
                     // calculate b_temp_static_xface
                     // x component on x-faces of grid
-                    b_temp_static_xface(i, j, k, 0) = M_xface(i, j, k, 0) + dt * b_temp_static_coeff * (M_xface(i, j, k, 1) * Hz_eff - M_xface(i, j, k, 2) * Hy_eff);
+                    b_temp_static_xface(i, j, k, 0) = M_xface(i, j, k, 0) + dt_M * b_temp_static_coeff * (M_xface(i, j, k, 1) * Hz_eff - M_xface(i, j, k, 2) * Hy_eff);
 
                     // y component on x-faces of grid
-                    b_temp_static_xface(i, j, k, 1) = M_xface(i, j, k, 1) + dt * b_temp_static_coeff * (M_xface(i, j, k, 2) * Hx_eff - M_xface(i, j, k, 0) * Hz_eff);
+                    b_temp_static_xface(i, j, k, 1) = M_xface(i, j, k, 1) + dt_M * b_temp_static_coeff * (M_xface(i, j, k, 2) * Hx_eff - M_xface(i, j, k, 0) * Hz_eff);
 
                     // z component on x-faces of grid
-                    b_temp_static_xface(i, j, k, 2) = M_xface(i, j, k, 2) + dt * b_temp_static_coeff * (M_xface(i, j, k, 0) * Hy_eff - M_xface(i, j, k, 1) * Hx_eff);
+                    b_temp_static_xface(i, j, k, 2) = M_xface(i, j, k, 2) + dt_M * b_temp_static_coeff * (M_xface(i, j, k, 0) * Hy_eff - M_xface(i, j, k, 1) * Hx_eff);
                 }
             });
 
@@ -272,9 +470,9 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian_2nd(
                     // Hy and Hz can be acquired by interpolation
 
                     // H_bias
-                    amrex::Real Hx_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, Mxface_stag, Myface_stag, Hx_bias);
-                    amrex::Real Hy_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, Myface_stag, Myface_stag, Hy_bias);
-                    amrex::Real Hz_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, Mzface_stag, Myface_stag, Hz_bias);
+                    amrex::Real Hx_eff = MacroscopicProperties::getH_bias(i, j, k, Mxface_stag, Myface_stag, Hx_bias, H_bias_uniform, H_bias_value[0]);
+                    amrex::Real Hy_eff = MacroscopicProperties::getH_bias(i, j, k, Myface_stag, Myface_stag, Hy_bias, H_bias_uniform, H_bias_value[1]);
+                    amrex::Real Hz_eff = MacroscopicProperties::getH_bias(i, j, k, Mzface_stag, Myface_stag, Hz_bias, H_bias_uniform, H_bias_value[2]);
 
                     if (coupling == 1){
                         // H_eff = H_maxwell + H_bias + H_exchange + H_anisotropy
@@ -287,10 +485,8 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian_2nd(
 
                     if (mag_exchange_coupling == 1){
 
-                        if (mag_exchange_yface_arr(i,j,k) == 0._rt) amrex::Abort("The mag_exchange_yface_arr(i,j,k) is 0.0 while including the exchange coupling term H_exchange for H_eff");
-
                         // H_exchange - use M^(old_time)
-                        amrex::Real const H_exchange_coeff = 2.0 * mag_exchange_yface_arr(i,j,k) / PhysConst::mu0 / mag_Ms_yface_arr(i,j,k) / mag_Ms_yface_arr(i,j,k);
+                        amrex::Real const H_exchange_coeff = mag_coefs_yface_arr(i,j,k,MacroscopicProperties::mag_coef_exchange);
 
                         amrex::Real Ms_lo_x = mag_Ms_yface_arr(i-1, j, k);
                         amrex::Real Ms_hi_x = mag_Ms_yface_arr(i+1, j, k);
@@ -302,32 +498,46 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian_2nd(
                         Hx_eff += H_exchange_coeff * T_Algo::Laplacian_Mag(M_yface, coefs_x, coefs_y, coefs_z, n_coefs_x, n_coefs_y, n_coefs_z, Ms_lo_x, Ms_hi_x, Ms_lo_y, Ms_hi_y, Ms_lo_z, Ms_hi_z, i, j, k, 0, 1); //Last argument is nodality -- yface = 1
                         Hy_eff += H_exchange_coeff * T_Algo::Laplacian_Mag(M_yface, coefs_x, coefs_y, coefs_z, n_coefs_x, n_coefs_y, n_coefs_z, Ms_lo_x, Ms_hi_x, Ms_lo_y, Ms_hi_y, Ms_lo_z, Ms_hi_z, i, j, k, 1, 1); //Last argument is nodality -- yface = 1
                         Hz_eff += H_exchange_coeff * T_Algo::Laplacian_Mag(M_yface, coefs_x, coefs_y, coefs_z, n_coefs_x, n_coefs_y, n_coefs_z, Ms_lo_x, Ms_hi_x, Ms_lo_y, Ms_hi_y, Ms_lo_z, Ms_hi_z, i, j, k, 2, 1); //Last argument is nodality -- yface = 1
+
+                        // H_DMI - same M and neighbor Ms as H_exchange, in the same pass
+                        if (DMI_type != 0){
+                            T_Algo::AddDMIField_Mag(M_yface, coefs_x, coefs_y, coefs_z, n_coefs_x, n_coefs_y, n_coefs_z, Ms_lo_x, Ms_hi_x, Ms_lo_y, Ms_hi_y, Ms_lo_z, Ms_hi_z, i, j, k, 1, DMI_type,
+                                                    mag_coefs_yface_arr(i,j,k,MacroscopicProperties::mag_coef_DMI), Hx_eff, Hy_eff, Hz_eff);
+                        }
                     }
 
                     if (mag_anisotropy_coupling == 1){
 
-                        if (mag_anisotropy_yface_arr(i,j,k) == 0._rt) amrex::Abort("The mag_anisotropy_yface_arr(i,j,k) is 0.0 while including the anisotropy coupling term H_anisotropy for H_eff");
-
                         // H_anisotropy - use M^(old_time)
-                        amrex::Real M_dot_anisotropy_axis = 0.0;
-                        for (int comp=0; comp<3; ++comp) {
-                            M_dot_anisotropy_axis += M_yface(i, j, k, comp) * anisotropy_axis[comp];
-                        }
-                        amrex::Real const H_anisotropy_coeff = - 2.0 * mag_anisotropy_yface_arr(i,j,k) / PhysConst::mu0 / mag_Ms_yface_arr(i,j,k) / mag_Ms_yface_arr(i,j,k);
-                        Hx_eff += H_anisotropy_coeff * M_dot_anisotropy_axis * anisotropy_axis[0];
-                        Hy_eff += H_anisotropy_coeff * M_dot_anisotropy_axis * anisotropy_axis[1];
-                        Hz_eff += H_anisotropy_coeff * M_dot_anisotropy_axis * anisotropy_axis[2];
+                        amrex::Real const H_anisotropy_coeff = mag_coefs_yface_arr(i,j,k,MacroscopicProperties::mag_coef_anisotropy);
+                        MacroscopicProperties::addH_anisotropy(i, j, k, grain_yface_arr, anisotropy_axes, anisotropy_type, H_anisotropy_coeff,
+                                                               M_yface(i, j, k, 0), M_yface(i, j, k, 1), M_yface(i, j, k, 2), Hx_eff, Hy_eff, Hz_eff);
+                    }
+
+                    // H_interlayer - use M^(old_time) of the paired faces across the spacer
+                    interlayer_y.AddEffectiveField(i, j, k, Hx_eff, Hy_eff, Hz_eff);
+
+                    if (mag_spin_torque_coupling == 1){
+
+                        // H_spin_torque - use M^(old_time)
+                        spin_torque.AddEffectiveField(i, j, k, Myface_stag, mag_Ms_yface_arr(i,j,k), M_yface(i, j, k, 0), M_yface(i, j, k, 1), M_yface(i, j, k, 2), Hx_eff, Hy_eff, Hz_eff);
+                    }
+
+                    if (thermal_field){
+
+                        // H_thermal - the same random field in all the iterations of the update
+                        thermal.AddEffectiveField(i, j, k, Myface_stag, 1, mag_alpha_yface_arr(i,j,k), mag_Ms_yface_arr(i,j,k), mag_coefs_yface_arr(i,j,k,MacroscopicProperties::mag_coef_gamma), Hx_eff, Hy_eff, Hz_eff);
                     }
 
                     // 0 = unsaturated; compute |M| locally.  1 = saturated; use M_s
                     // note the unsaturated case is less usefull in real devices
-                    amrex::Real M_magnitude = (M_normalization == 0) ? std::sqrt(std::pow(M_yface(i, j, k, 0), 2._rt) + std::pow(M_yface(i, j, k, 1), 2._rt) + std::pow(M_yface(i, j, k, 2), 2._rt))
+                    amrex::Real M_magnitude = (M_normalization == 0) ? std::sqrt(M_yface(i, j, k, 0)*M_yface(i, j, k, 0) + M_yface(i, j, k, 1)*M_yface(i, j, k, 1) + M_yface(i, j, k, 2)*M_yface(i, j, k, 2))
                                                               : mag_Ms_yface_arr(i,j,k);
                     amrex::Real a_temp_static_coeff = mag_alpha_yface_arr(i,j,k) / M_magnitude;
 
                     // calculate the b_temp_static_coeff (it is divided by 2.0 because the derivation is based on an interger dt,
                     // while in real simulations, the input dt is actually dt/2.0)
-                    amrex::Real b_temp_static_coeff = - PhysConst::mu0 * amrex::Math::abs(mag_gamma_yface_arr(i,j,k)) / 2._rt;
+                    amrex::Real b_temp_static_coeff = - mag_coefs_yface_arr(i,j,k,MacroscopicProperties::mag_coef_gamma);
 
                     for (int comp=0; comp<3; ++comp) {
                         // calculate a_temp_static_yface
@@ -337,13 +547,13 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian_2nd(
 
                     // calculate b_temp_static_yface
                     // x component on y-faces of grid
-                    b_temp_static_yface(i, j, k, 0) = M_yface(i, j, k, 0) + dt * b_temp_static_coeff * (M_yface(i, j, k, 1) * Hz_eff - M_yface(i, j, k, 2) * Hy_eff);
+                    b_temp_static_yface(i, j, k, 0) = M_yface(i, j, k, 0) + dt_M * b_temp_static_coeff * (M_yface(i, j, k, 1) * Hz_eff - M_yface(i, j, k, 2) * Hy_eff);
 
                     // y component on y-faces of grid
-                    b_temp_static_yface(i, j, k, 1) = M_yface(i, j, k, 1) + dt * b_temp_static_coeff * (M_yface(i, j, k, 2) * Hx_eff - M_yface(i, j, k, 0) * Hz_eff);
+                    b_temp_static_yface(i, j, k, 1) = M_yface(i, j, k, 1) + dt_M * b_temp_static_coeff * (M_yface(i, j, k, 2) * Hx_eff - M_yface(i, j, k, 0) * Hz_eff);
 
                     // z component on y-faces of grid
-                    b_temp_static_yface(i, j, k, 2) = M_yface(i, j, k, 2) + dt * b_temp_static_coeff * (M_yface(i, j, k, 0) * Hy_eff - M_yface(i, j, k, 1) * Hx_eff);
+                    b_temp_static_yface(i, j, k, 2) = M_yface(i, j, k, 2) + dt_M * b_temp_static_coeff * (M_yface(i, j, k, 0) * Hy_eff - M_yface(i, j, k, 1) * Hx_eff);
                 }
             });
 
@@ -357,9 +567,9 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian_2nd(
                     // Hy and Hz can be acquired by interpolation
 
                     // H_bias
-                    amrex::Real Hx_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, Mxface_stag, Mzface_stag, Hx_bias);
-                    amrex::Real Hy_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, Myface_stag, Mzface_stag, Hy_bias);
-                    amrex::Real Hz_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, Mzface_stag, Mzface_stag, Hz_bias);
+                    amrex::Real Hx_eff = MacroscopicProperties::getH_bias(i, j, k, Mxface_stag, Mzface_stag, Hx_bias, H_bias_uniform, H_bias_value[0]);
+                    amrex::Real Hy_eff = MacroscopicProperties::getH_bias(i, j, k, Myface_stag, Mzface_stag, Hy_bias, H_bias_uniform, H_bias_value[1]);
+                    amrex::Real Hz_eff = MacroscopicProperties::getH_bias(i, j, k, Mzface_stag, Mzface_stag, Hz_bias, H_bias_uniform, H_bias_value[2]);
 
                     if (coupling == 1){
                         // H_eff = H_maxwell + H_bias + H_exchange + H_anisotropy
@@ -372,10 +582,8 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian_2nd(
 
                     if (mag_exchange_coupling == 1){
 
-                        if (mag_exchange_zface_arr(i,j,k) == 0._rt) amrex::Abort("The mag_exchange_zface_arr(i,j,k) is 0.0 while including the exchange coupling term H_exchange for H_eff");
-
                         // H_exchange - use M^(old_time)
-                        amrex::Real const H_exchange_coeff = 2.0 * mag_exchange_zface_arr(i,j,k) / PhysConst::mu0 / mag_Ms_zface_arr(i,j,k) / mag_Ms_zface_arr(i,j,k);
+                        amrex::Real const H_exchange_coeff = mag_coefs_zface_arr(i,j,k,MacroscopicProperties::mag_coef_exchange);
 
                         amrex::Real Ms_lo_x = mag_Ms_zface_arr(i-1, j, k);
                         amrex::Real Ms_hi_x = mag_Ms_zface_arr(i+1, j, k);
@@ -387,31 +595,45 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian_2nd(
                         Hx_eff += H_exchange_coeff * T_Algo::Laplacian_Mag(M_zface, coefs_x, coefs_y, coefs_z, n_coefs_x, n_coefs_y, n_coefs_z, Ms_lo_x, Ms_hi_x, Ms_lo_y, Ms_hi_y, Ms_lo_z, Ms_hi_z, i, j, k, 0, 2); //Last argument is nodality -- zface = 2
                         Hy_eff += H_exchange_coeff * T_Algo::Laplacian_Mag(M_zface, coefs_x, coefs_y, coefs_z, n_coefs_x, n_coefs_y, n_coefs_z, Ms_lo_x, Ms_hi_x, Ms_lo_y, Ms_hi_y, Ms_lo_z, Ms_hi_z, i, j, k, 1, 2); //Last argument is nodality -- zface = 2
                         Hz_eff += H_exchange_coeff * T_Algo::Laplacian_Mag(M_zface, coefs_x, coefs_y, coefs_z, n_coefs_x, n_coefs_y, n_coefs_z, Ms_lo_x, Ms_hi_x, Ms_lo_y, Ms_hi_y, Ms_lo_z, Ms_hi_z, i, j, k, 2, 2); //Last argument is nodality -- zface = 2
+
+                        // H_DMI - same M and neighbor Ms as H_exchange, in the same pass
+                        if (DMI_type != 0){
+                            T_Algo::AddDMIField_Mag(M_zface, coefs_x, coefs_y, coefs_z, n_coefs_x, n_coefs_y, n_coefs_z, Ms_lo_x, Ms_hi_x, Ms_lo_y, Ms_hi_y, Ms_lo_z, Ms_hi_z, i, j, k, 2, DMI_type,
+                                                    mag_coefs_zface_arr(i,j,k,MacroscopicProperties::mag_coef_DMI), Hx_eff, Hy_eff, Hz_eff);
+                        }
                     }
 
                     if (mag_anisotropy_coupling == 1){
 
-                        if (mag_anisotropy_zface_arr(i,j,k) == 0._rt) amrex::Abort("The mag_anisotropy_zface_arr(i,j,k) is 0.0 while including the anisotropy coupling term H_anisotropy for H_eff");
-
                         // H_anisotropy - use M^(old_time)
-                        amrex::Real M_dot_anisotropy_axis = 0.0;
-                        for (int comp=0; comp<3; ++comp) {
-                            M_dot_anisotropy_axis += M_zface(i, j, k, comp) * anisotropy_axis[comp];
-                        }
-                        amrex::Real const H_anisotropy_coeff = - 2.0 * mag_anisotropy_zface_arr(i,j,k) / PhysConst::mu0 / mag_Ms_zface_arr(i,j,k) / mag_Ms_zface_arr(i,j,k);
-                        Hx_eff += H_anisotropy_coeff * M_dot_anisotropy_axis * anisotropy_axis[0];
-                        Hy_eff += H_anisotropy_coeff * M_dot_anisotropy_axis * anisotropy_axis[1];
-                        Hz_eff += H_anisotropy_coeff * M_dot_anisotropy_axis * anisotropy_axis[2];
+                        amrex::Real const H_anisotropy_coeff = mag_coefs_zface_arr(i,j,k,MacroscopicProperties::mag_coef_anisotropy);
+                        MacroscopicProperties::addH_anisotropy(i, j, k, grain_zface_arr, anisotropy_axes, anisotropy_type, H_anisotropy_coeff,
+                                                               M_zface(i, j, k, 0), M_zface(i, j, k, 1), M_zface(i, j, k, 2), Hx_eff, Hy_eff, Hz_eff);
+                    }
+
+                    // H_interlayer - use M^(old_time) of the paired faces across the spacer
+                    interlayer_z.AddEffectiveField(i, j, k, Hx_eff, Hy_eff, Hz_eff);
+
+                    if (mag_spin_torque_coupling == 1){
+
+                        // H_spin_torque - use M^(old_time)
+                        spin_torque.AddEffectiveField(i, j, k, Mzface_stag, mag_Ms_zface_arr(i,j,k), M_zface(i, j, k, 0), M_zface(i, j, k, 1), M_zface(i, j, k, 2), Hx_eff, Hy_eff, Hz_eff);
+                    }
+
+                    if (thermal_field){
+
+                        // H_thermal - the same random field in all the iterations of the update
+                        thermal.AddEffectiveField(i, j, k, Mzface_stag, 2, mag_alpha_zface_arr(i,j,k), mag_Ms_zface_arr(i,j,k), mag_coefs_zface_arr(i,j,k,MacroscopicProperties::mag_coef_gamma), Hx_eff, Hy_eff, Hz_eff);
                     }
 
                     // 0 = unsaturated; compute |M| locally.  1 = saturated; use M_s
-                    amrex::Real M_magnitude = (M_normalization == 0) ? std::sqrt(std::pow(M_zface(i, j, k, 0), 2._rt) + std::pow(M_zface(i, j, k, 1), 2._rt) + std::pow(M_zface(i, j, k, 2), 2._rt))
+                    amrex::Real M_magnitude = (M_normalization == 0) ? std::sqrt(M_zface(i, j, k, 0)*M_zface(i, j, k, 0) + M_zface(i, j, k, 1)*M_zface(i, j, k, 1) + M_zface(i, j, k, 2)*M_zface(i, j, k, 2))
                                                               : mag_Ms_zface_arr(i,j,k);
                     amrex::Real a_temp_static_coeff = mag_alpha_zface_arr(i,j,k) / M_magnitude;
 
                     // calculate the b_temp_static_coeff (it is divided by 2.0 because the derivation is based on an interger dt,
                     // while in real simulations, the input dt is actually dt/2.0)
-                    amrex::Real b_temp_static_coeff = - PhysConst::mu0 * amrex::Math::abs(mag_gamma_zface_arr(i,j,k)) / 2._rt;
+                    amrex::Real b_temp_static_coeff = - mag_coefs_zface_arr(i,j,k,MacroscopicProperties::mag_coef_gamma);
 
                     for (int comp=0; comp<3; ++comp) {
                         // calculate a_temp_static_zface
@@ -421,16 +643,17 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian_2nd(
 
                     // calculate b_temp_static_zface
                     // x component on z-faces of grid
-                    b_temp_static_zface(i, j, k, 0) = M_zface(i, j, k, 0) + dt * b_temp_static_coeff * (M_zface(i, j, k, 1) * Hz_eff - M_zface(i, j, k, 2) * Hy_eff);
+                    b_temp_static_zface(i, j, k, 0) = M_zface(i, j, k, 0) + dt_M * b_temp_static_coeff * (M_zface(i, j, k, 1) * Hz_eff - M_zface(i, j, k, 2) * Hy_eff);
 
                     // y component on z-faces of grid
-                    b_temp_static_zface(i, j, k, 1) = M_zface(i, j, k, 1) + dt * b_temp_static_coeff * (M_zface(i, j, k, 2) * Hx_eff - M_zface(i, j, k, 0) * Hz_eff);
+                    b_temp_static_zface(i, j, k, 1) = M_zface(i, j, k, 1) + dt_M * b_temp_static_coeff * (M_zface(i, j, k, 2) * Hx_eff - M_zface(i, j, k, 0) * Hz_eff);
 
                     // z component on z-faces of grid
-                    b_temp_static_zface(i, j, k, 2) = M_zface(i, j, k, 2) + dt * b_temp_static_coeff * (M_zface(i, j, k, 0) * Hy_eff - M_zface(i, j, k, 1) * Hx_eff);
+                    b_temp_static_zface(i, j, k, 2) = M_zface(i, j, k, 2) + dt_M * b_temp_static_coeff * (M_zface(i, j, k, 0) * Hy_eff - M_zface(i, j, k, 1) * Hx_eff);
                 }
             });
     }
+    ABLASTR_KERNEL_RANGE_END("LLG_2nd::Coefficients");
 
     // initialize M_max_iter, M_iter, M_tol, M_iter_error
     // maximum number of iterations allowed
@@ -439,445 +662,559 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian_2nd(
     // relative tolerance stopping criteria for 2nd-order iterative algorithm
     amrex::Real M_tol = macroscopic_properties->getmag_tol();
     int stop_iter = 0;
+    // whether the iteration error is reduced within the M update kernel, or stored in Mfield_error
+    int const fused_update = macroscopic_properties->getmag_fused_update();
+    // check the convergence only every M_check_interval iterations once the error contracts steadily
+    int const M_check_interval = macroscopic_properties->getmag_check_interval();
+    int n_contraction = 0;
+    amrex::Real M_iter_prev_maxerror = -1._rt;
+    // Aitken extrapolation of the fixed-point iteration, using the ratio of the errors of two consecutive iterations
+    int const iter_acceleration = macroscopic_properties->getmag_iter_acceleration();
+    // the extrapolation is only applied while the iteration contracts at most at this rate
+    amrex::Real const aitken_max_ratio = 0.9_rt;
+    int M_iter_prev_check = -1;
+    // maximum relative deviation of |M| from Ms before the final normalization (M_normalization == 2)
+    amrex::Real M_norm_deviation = 0._rt;
+    amrex::Real M_iter_last_maxerror = 0._rt;
+    amrex::Real const wt_start = static_cast<amrex::Real>(amrex::second());
+
+    // guard cells of H and M read by the M update
+    amrex::IntVect const ng_LLG = warpx.get_ng_LLG();
 
     // begin the iteration
     while (!stop_iter){
 
-        warpx.FillBoundaryH(warpx.getngEB());
+        // interlayer exchange field of M^[(new_time),r-1], which Mfield holds from the end of the previous iteration
+        if (M_iter > 0) macroscopic_properties->UpdateInterlayerCoupling(Mfield);
 
-        for (MFIter mfi(*Mfield[0], TilingIfNotGPU()); mfi.isValid(); ++mfi){
+        // H is only read by the M update, through H_eff, if it is coupled to the LLG equation
+        bool const overlap_comm = (coupling == 1 && macroscopic_properties->getmag_overlap_comm() == 1);
+        int const n_pass = overlap_comm ? 2 : 1;
+        if (overlap_comm) {
+            warpx.FillBoundaryH_nowait(lev, ng_LLG);
+        } else if (coupling == 1) {
+            warpx.FillBoundaryH(ng_LLG);
+        }
 
-            auto& mag_Ms_xface_mf = macroscopic_properties->getmag_Ms_mf(0);
-            auto& mag_Ms_yface_mf = macroscopic_properties->getmag_Ms_mf(1);
-            auto& mag_Ms_zface_mf = macroscopic_properties->getmag_Ms_mf(2);
-            auto& mag_alpha_xface_mf = macroscopic_properties->getmag_alpha_mf(0);
-            auto& mag_alpha_yface_mf = macroscopic_properties->getmag_alpha_mf(1);
-            auto& mag_alpha_zface_mf = macroscopic_properties->getmag_alpha_mf(2);
-            auto& mag_gamma_xface_mf = macroscopic_properties->getmag_gamma_mf(0);
-            auto& mag_gamma_yface_mf = macroscopic_properties->getmag_gamma_mf(1);
-            auto& mag_gamma_zface_mf = macroscopic_properties->getmag_gamma_mf(2);
-            auto& mag_exchange_xface_mf = macroscopic_properties->getmag_exchange_mf(0);
-            auto& mag_exchange_yface_mf = macroscopic_properties->getmag_exchange_mf(1);
-            auto& mag_exchange_zface_mf = macroscopic_properties->getmag_exchange_mf(2);
-            auto& mag_anisotropy_xface_mf = macroscopic_properties->getmag_anisotropy_mf(0);
-            auto& mag_anisotropy_yface_mf = macroscopic_properties->getmag_anisotropy_mf(1);
-            auto& mag_anisotropy_zface_mf = macroscopic_properties->getmag_anisotropy_mf(2);
+        // max-norm of the M change of this iteration, and MagNormFlag of the normalization checks, reduced while M is updated
+        amrex::ReduceOps<amrex::ReduceOpMax, amrex::ReduceOpMax> reduce_op;
+        amrex::ReduceData<amrex::Real, int> reduce_data(reduce_op);
+        using ReduceTuple = typename decltype(reduce_data)::Type;
 
-            // extract material properties
-            Array4<Real> const& mag_Ms_xface_arr = mag_Ms_xface_mf.array(mfi);
-            Array4<Real> const& mag_Ms_yface_arr = mag_Ms_yface_mf.array(mfi);
-            Array4<Real> const& mag_Ms_zface_arr = mag_Ms_zface_mf.array(mfi);
-            Array4<Real> const& mag_alpha_xface_arr = mag_alpha_xface_mf.array(mfi);
-            Array4<Real> const& mag_alpha_yface_arr = mag_alpha_yface_mf.array(mfi);
-            Array4<Real> const& mag_alpha_zface_arr = mag_alpha_zface_mf.array(mfi);
-            Array4<Real> const& mag_gamma_xface_arr = mag_gamma_xface_mf.array(mfi);
-            Array4<Real> const& mag_gamma_yface_arr = mag_gamma_yface_mf.array(mfi);
-            Array4<Real> const& mag_gamma_zface_arr = mag_gamma_zface_mf.array(mfi);
-            Array4<Real> const& mag_exchange_xface_arr = mag_exchange_xface_mf.array(mfi);
-            Array4<Real> const& mag_exchange_yface_arr = mag_exchange_yface_mf.array(mfi);
-            Array4<Real> const& mag_exchange_zface_arr = mag_exchange_zface_mf.array(mfi);
-            Array4<Real> const& mag_anisotropy_xface_arr = mag_anisotropy_xface_mf.array(mfi);
-            Array4<Real> const& mag_anisotropy_yface_arr = mag_anisotropy_yface_mf.array(mfi);
-            Array4<Real> const& mag_anisotropy_zface_arr = mag_anisotropy_zface_mf.array(mfi);
-
-            // extract field data
-            Array4<Real> const &M_xface = Mfield[0]->array(mfi);      // note M_xface include x,y,z components at |_x faces
-            Array4<Real> const &M_yface = Mfield[1]->array(mfi);      // note M_yface include x,y,z components at |_y faces
-            Array4<Real> const &M_zface = Mfield[2]->array(mfi);      // note M_zface include x,y,z components at |_z faces
-            Array4<Real> const &Hx_bias = H_biasfield[0]->array(mfi); // Hx_bias is the x component at |_x faces
-            Array4<Real> const &Hy_bias = H_biasfield[1]->array(mfi); // Hy_bias is the y component at |_y faces
-            Array4<Real> const &Hz_bias = H_biasfield[2]->array(mfi); // Hz_bias is the z component at |_z faces
-            Array4<Real> const &Hx = Hfield[0]->array(mfi);           // Hx is the x component at |_x faces
-            Array4<Real> const &Hy = Hfield[1]->array(mfi);           // Hy is the y component at |_y faces
-            Array4<Real> const &Hz = Hfield[2]->array(mfi);           // Hz is the z component at |_z faces
-
-            // extract field data of Mfield_prev, Mfield_error, a_temp, a_temp_static, and b_temp_static
-            Array4<Real> const &M_prev_xface = Mfield_prev[0]->array(mfi);
-            Array4<Real> const &M_prev_yface = Mfield_prev[1]->array(mfi);
-            Array4<Real> const &M_prev_zface = Mfield_prev[2]->array(mfi);
-            Array4<Real> const &M_old_xface = Mfield_old[0]->array(mfi);
-            Array4<Real> const &M_old_yface = Mfield_old[1]->array(mfi);
-            Array4<Real> const &M_old_zface = Mfield_old[2]->array(mfi);
-            Array4<Real> const &M_error_xface = Mfield_error[0]->array(mfi);
-            Array4<Real> const &M_error_yface = Mfield_error[1]->array(mfi);
-            Array4<Real> const &M_error_zface = Mfield_error[2]->array(mfi);
-            Array4<Real> const &a_temp_xface = a_temp[0]->array(mfi);
-            Array4<Real> const &a_temp_yface = a_temp[1]->array(mfi);
-            Array4<Real> const &a_temp_zface = a_temp[2]->array(mfi);
-            Array4<Real> const &a_temp_static_xface = a_temp_static[0]->array(mfi);
-            Array4<Real> const &a_temp_static_yface = a_temp_static[1]->array(mfi);
-            Array4<Real> const &a_temp_static_zface = a_temp_static[2]->array(mfi);
-            Array4<Real> const &b_temp_static_xface = b_temp_static[0]->array(mfi);
-            Array4<Real> const &b_temp_static_yface = b_temp_static[1]->array(mfi);
-            Array4<Real> const &b_temp_static_zface = b_temp_static[2]->array(mfi);
-
-            // extract tileboxes for which to loop
-            amrex::IntVect Hxnodal = Hfield[0]->ixType().toIntVect();
-            amrex::IntVect Hynodal = Hfield[1]->ixType().toIntVect();
-            amrex::IntVect Hznodal = Hfield[2]->ixType().toIntVect();
-            Box const &tbx = mfi.tilebox(Hxnodal); /* just define which grid type */
-            Box const &tby = mfi.tilebox(Hynodal);
-            Box const &tbz = mfi.tilebox(Hznodal);
+        ABLASTR_KERNEL_RANGE_BEGIN("LLG_2nd::UpdateM");
+        for (int pass = 0; pass < n_pass; ++pass){
+            // the interior of the boxes is updated while the guard cells of H are exchanged,
+            // and the boxes' shell once the exchange is finished
+            if (pass == 1) warpx.FillBoundaryH_finish(lev);
 
-            // Extract stencil coefficients for calculating the exchange field H_exchange and the anisotropy field H_anisotropy
-            amrex::Real const *const AMREX_RESTRICT coefs_x = m_stencil_coefs_x.dataPtr();
-            int const n_coefs_x = m_stencil_coefs_x.size();
-            amrex::Real const *const AMREX_RESTRICT coefs_y = m_stencil_coefs_y.dataPtr();
-            int const n_coefs_y = m_stencil_coefs_y.size();
-            amrex::Real const *const AMREX_RESTRICT coefs_z = m_stencil_coefs_z.dataPtr();
-            int const n_coefs_z = m_stencil_coefs_z.size();
-
-            // loop over cells and update fields
-            amrex::ParallelFor(tbx,
-                [=] AMREX_GPU_DEVICE(int i, int j, int k) {
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#endif
+            for (MFIter mfi(*Mfield[0], TilingIfNotGPU()); mfi.isValid(); ++mfi){
+                // skip the boxes that do not contain any magnetic material, and all the boxes if M is not advanced
+                if (dt_M == 0._rt || !macroscopic_properties->has_magnetic_material(mfi.index())) continue;
+                CostBoxTimer cost_box(cost, mfi.index());
+
+                // spin torques of the current density on this box
+                MagSpinTorque const spin_torque = (mag_spin_torque_coupling == 1)
+                    ? macroscopic_properties->GetSpinTorque(mfi, lev, spin_torque_time) : MagSpinTorque{};
+
+                // interlayer exchange field of the interface faces of this box, empty if none
+                MagInterlayerField const interlayer_x = macroscopic_properties->GetInterlayerField(0, mfi);
+                MagInterlayerField const interlayer_y = macroscopic_properties->GetInterlayerField(1, mfi);
+                MagInterlayerField const interlayer_z = macroscopic_properties->GetInterlayerField(2, mfi);
+
+                int const iscratch = LLGScratchIndex(mfi.index());
+
+                auto& mag_Ms_xface_mf = macroscopic_properties->getmag_Ms_mf(0);
+                auto& mag_Ms_yface_mf = macroscopic_properties->getmag_Ms_mf(1);
+                auto& mag_Ms_zface_mf = macroscopic_properties->getmag_Ms_mf(2);
+                auto& mag_alpha_xface_mf = macroscopic_properties->getmag_alpha_mf(0);
+                auto& mag_alpha_yface_mf = macroscopic_properties->getmag_alpha_mf(1);
+                auto& mag_alpha_zface_mf = macroscopic_properties->getmag_alpha_mf(2);
+
+                // extract material properties
+                Array4<Real> const& mag_Ms_xface_arr = mag_Ms_xface_mf.array(mfi);
+                Array4<Real> const& mag_Ms_yface_arr = mag_Ms_yface_mf.array(mfi);
+                Array4<Real> const& mag_Ms_zface_arr = mag_Ms_zface_mf.array(mfi);
+                Array4<Real> const& mag_alpha_xface_arr = mag_alpha_xface_mf.array(mfi);
+                Array4<Real> const& mag_alpha_yface_arr = mag_alpha_yface_mf.array(mfi);
+                Array4<Real> const& mag_alpha_zface_arr = mag_alpha_zface_mf.array(mfi);
+                Array4<MacroscopicProperties::MagCoefReal const> const& mag_coefs_xface_arr = macroscopic_properties->getmag_coefs_mf(0).const_array(mfi);
+                Array4<int const> const grain_xface_arr = macroscopic_properties->getmag_grain_array(0, mfi);
+                Array4<MacroscopicProperties::MagCoefReal const> const& mag_coefs_yface_arr = macroscopic_properties->getmag_coefs_mf(1).const_array(mfi);
+                Array4<int const> const grain_yface_arr = macroscopic_properties->getmag_grain_array(1, mfi);
+                Array4<MacroscopicProperties::MagCoefReal const> const& mag_coefs_zface_arr = macroscopic_properties->getmag_coefs_mf(2).const_array(mfi);
+                Array4<int const> const grain_zface_arr = macroscopic_properties->getmag_grain_array(2, mfi);
+
+                // extract field data
+                Array4<Real> const &M_xface = Mfield[0]->array(mfi);      // note M_xface include x,y,z components at |_x faces
+                Array4<Real> const &M_yface = Mfield[1]->array(mfi);      // note M_yface include x,y,z components at |_y faces
+                Array4<Real> const &M_zface = Mfield[2]->array(mfi);      // note M_zface include x,y,z components at |_z faces
+                Array4<Real> const Hx_bias = H_bias_uniform ? Array4<Real>{} : H_biasfield[0]->array(mfi); // Hx_bias is the x component at |_x faces
+                Array4<Real> const Hy_bias = H_bias_uniform ? Array4<Real>{} : H_biasfield[1]->array(mfi); // Hy_bias is the y component at |_y faces
+                Array4<Real> const Hz_bias = H_bias_uniform ? Array4<Real>{} : H_biasfield[2]->array(mfi); // Hz_bias is the z component at |_z faces
+                Array4<Real> const &Hx = Hfield[0]->array(mfi);           // Hx is the x component at |_x faces
+                Array4<Real> const &Hy = Hfield[1]->array(mfi);           // Hy is the y component at |_y faces
+                Array4<Real> const &Hz = Hfield[2]->array(mfi);           // Hz is the z component at |_z faces
+
+                // extract field data of Mfield_prev, Mfield_error, a_temp, a_temp_static, and b_temp_static
+                Array4<Real> const &M_prev_xface = Mfield_prev[0]->array(iscratch);
+                Array4<Real> const &M_prev_yface = Mfield_prev[1]->array(iscratch);
+                Array4<Real> const &M_prev_zface = Mfield_prev[2]->array(iscratch);
+                Array4<Real> const &M_old_xface = Mfield_old[0]->array(iscratch);
+                Array4<Real> const &M_old_yface = Mfield_old[1]->array(iscratch);
+                Array4<Real> const &M_old_zface = Mfield_old[2]->array(iscratch);
+                Array4<Real> const &M_error_xface = Mfield_error[0]->array(iscratch);
+                Array4<Real> const &M_error_yface = Mfield_error[1]->array(iscratch);
+                Array4<Real> const &M_error_zface = Mfield_error[2]->array(iscratch);
+                Array4<Real> const &a_temp_xface = a_temp[0]->array(iscratch);
+                Array4<Real> const &a_temp_yface = a_temp[1]->array(iscratch);
+                Array4<Real> const &a_temp_zface = a_temp[2]->array(iscratch);
+                Array4<Real> const &a_temp_static_xface = a_temp_static[0]->array(iscratch);
+                Array4<Real> const &a_temp_static_yface = a_temp_static[1]->array(iscratch);
+                Array4<Real> const &a_temp_static_zface = a_temp_static[2]->array(iscratch);
+                Array4<Real> const &b_temp_static_xface = b_temp_static[0]->array(iscratch);
+                Array4<Real> const &b_temp_static_yface = b_temp_static[1]->array(iscratch);
+                Array4<Real> const &b_temp_static_zface = b_temp_static[2]->array(iscratch);
+
+                // extract tileboxes for which to loop
+                amrex::IntVect Hxnodal = Hfield[0]->ixType().toIntVect();
+                amrex::IntVect Hynodal = Hfield[1]->ixType().toIntVect();
+                amrex::IntVect Hznodal = Hfield[2]->ixType().toIntVect();
+                Box const &tbx = mfi.tilebox(Hxnodal); /* just define which grid type */
+                Box const &tby = mfi.tilebox(Hynodal);
+                Box const &tbz = mfi.tilebox(Hznodal);
+
+                // Extract stencil coefficients for calculating the exchange field H_exchange and the anisotropy field H_anisotropy
+                amrex::Real const *const AMREX_RESTRICT coefs_x = m_stencil_coefs_x.dataPtr();
+                int const n_coefs_x = m_stencil_coefs_x.size();
+                amrex::Real const *const AMREX_RESTRICT coefs_y = m_stencil_coefs_y.dataPtr();
+                int const n_coefs_y = m_stencil_coefs_y.size();
+                amrex::Real const *const AMREX_RESTRICT coefs_z = m_stencil_coefs_z.dataPtr();
+                int const n_coefs_z = m_stencil_coefs_z.size();
+
+                // loop over cells and update fields
+                auto const update_M_xface =
+                    [=] AMREX_GPU_DEVICE(int i, int j, int k) -> ReduceTuple {
+
+                        amrex::Real M_error_max = 0._rt;
+                        int norm_flag = MacroscopicProperties::mag_norm_ok;
+
+                        // determine if the material is nonmagnetic or not
+                        if (mag_Ms_xface_arr(i,j,k) > 0._rt){
+
+                            // when working on M_xface(i,j,k, 0:2) we have direct access to M_xface(i,j,k,0:2) and Hx(i,j,k)
+                            // Hy and Hz can be acquired by interpolation
+
+                            // H_bias
+                            amrex::Real Hx_eff = MacroscopicProperties::getH_bias(i, j, k, Hxnodal, Hxnodal, Hx_bias, H_bias_uniform, H_bias_value[0]);
+                            amrex::Real Hy_eff = MacroscopicProperties::getH_bias(i, j, k, Hynodal, Hxnodal, Hy_bias, H_bias_uniform, H_bias_value[1]);
+                            amrex::Real Hz_eff = MacroscopicProperties::getH_bias(i, j, k, Hznodal, Hxnodal, Hz_bias, H_bias_uniform, H_bias_value[2]);
+
+                            if (coupling == 1){
+                                // H_eff = H_maxwell + H_bias + H_exchange + H_anisotropy
+
+                                // H_maxwell - use H^[(new_time),r-1]
+                                Hx_eff += MacroscopicProperties::face_avg_to_face(i, j, k, 0, Hxnodal, Hxnodal, Hx);
+                                Hy_eff += MacroscopicProperties::face_avg_to_face(i, j, k, 0, Hynodal, Hxnodal, Hy);
+                                Hz_eff += MacroscopicProperties::face_avg_to_face(i, j, k, 0, Hznodal, Hxnodal, Hz);
+                            }
 
-                    // determine if the material is nonmagnetic or not
-                    if (mag_Ms_xface_arr(i,j,k) > 0._rt){
+                            if (mag_exchange_coupling == 1){
 
-                        // when working on M_xface(i,j,k, 0:2) we have direct access to M_xface(i,j,k,0:2) and Hx(i,j,k)
-                        // Hy and Hz can be acquired by interpolation
+                                // H_exchange - use M^[(new_time),r-1]
+                                amrex::Real const H_exchange_coeff = mag_coefs_xface_arr(i,j,k,MacroscopicProperties::mag_coef_exchange);
 
-                        // H_bias
-                        amrex::Real Hx_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, Hxnodal, Hxnodal, Hx_bias);
-                        amrex::Real Hy_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, Hynodal, Hxnodal, Hy_bias);
-                        amrex::Real Hz_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, Hznodal, Hxnodal, Hz_bias);
+                                amrex::Real Ms_lo_x = mag_Ms_xface_arr(i-1, j, k);
+                                amrex::Real Ms_hi_x = mag_Ms_xface_arr(i+1, j, k);
+                                amrex::Real Ms_lo_y = mag_Ms_xface_arr(i, j-1, k);
+                                amrex::Real Ms_hi_y = mag_Ms_xface_arr(i, j+1, k);
+                                amrex::Real Ms_lo_z = mag_Ms_xface_arr(i, j, k-1);
+                                amrex::Real Ms_hi_z = mag_Ms_xface_arr(i, j, k+1);
 
-                        if (coupling == 1){
-                            // H_eff = H_maxwell + H_bias + H_exchange + H_anisotropy
+                                Hx_eff += H_exchange_coeff * T_Algo::Laplacian_Mag(M_prev_xface, coefs_x, coefs_y, coefs_z, n_coefs_x, n_coefs_y, n_coefs_z, Ms_lo_x, Ms_hi_x, Ms_lo_y, Ms_hi_y, Ms_lo_z, Ms_hi_z, i, j, k, 0, 0); //Last argument is nodality -- xface = 0
+                                Hy_eff += H_exchange_coeff * T_Algo::Laplacian_Mag(M_prev_xface, coefs_x, coefs_y, coefs_z, n_coefs_x, n_coefs_y, n_coefs_z, Ms_lo_x, Ms_hi_x, Ms_lo_y, Ms_hi_y, Ms_lo_z, Ms_hi_z, i, j, k, 1, 0); //Last argument is nodality -- xface = 0
+                                Hz_eff += H_exchange_coeff * T_Algo::Laplacian_Mag(M_prev_xface, coefs_x, coefs_y, coefs_z, n_coefs_x, n_coefs_y, n_coefs_z, Ms_lo_x, Ms_hi_x, Ms_lo_y, Ms_hi_y, Ms_lo_z, Ms_hi_z, i, j, k, 2, 0); //Last argument is nodality -- xface = 0
 
-                            // H_maxwell - use H^[(new_time),r-1]
-                            Hx_eff += MacroscopicProperties::face_avg_to_face(i, j, k, 0, Hxnodal, Hxnodal, Hx);
-                            Hy_eff += MacroscopicProperties::face_avg_to_face(i, j, k, 0, Hynodal, Hxnodal, Hy);
-                            Hz_eff += MacroscopicProperties::face_avg_to_face(i, j, k, 0, Hznodal, Hxnodal, Hz);
-                        }
-
-                        if (mag_exchange_coupling == 1){
+                                // H_DMI - same M and neighbor Ms as H_exchange, in the same pass
+                                if (DMI_type != 0){
+                                    T_Algo::AddDMIField_Mag(M_prev_xface, coefs_x, coefs_y, coefs_z, n_coefs_x, n_coefs_y, n_coefs_z, Ms_lo_x, Ms_hi_x, Ms_lo_y, Ms_hi_y, Ms_lo_z, Ms_hi_z, i, j, k, 0, DMI_type,
+                                                            mag_coefs_xface_arr(i,j,k,MacroscopicProperties::mag_coef_DMI), Hx_eff, Hy_eff, Hz_eff);
+                                }
+                            }
 
-                            if (mag_exchange_xface_arr(i,j,k) == 0._rt) amrex::Abort("The mag_exchange_xface_arr(i,j,k) is 0.0 while including the exchange coupling term H_exchange for H_eff");
+                            if (mag_anisotropy_coupling == 1){
 
-                            // H_exchange - use M^[(new_time),r-1]
-                            amrex::Real const H_exchange_coeff = 2.0 * mag_exchange_xface_arr(i,j,k) / PhysConst::mu0 / mag_Ms_xface_arr(i,j,k) / mag_Ms_xface_arr(i,j,k);
+                                // H_anisotropy - use M^[(new_time),r-1]
+                                amrex::Real const H_anisotropy_coeff = mag_coefs_xface_arr(i,j,k,MacroscopicProperties::mag_coef_anisotropy);
+                                MacroscopicProperties::addH_anisotropy(i, j, k, grain_xface_arr, anisotropy_axes, anisotropy_type, H_anisotropy_coeff,
+                                                                       M_xface(i, j, k, 0), M_xface(i, j, k, 1), M_xface(i, j, k, 2), Hx_eff, Hy_eff, Hz_eff);
+                            }
 
-                            amrex::Real Ms_lo_x = mag_Ms_xface_arr(i-1, j, k);
-                            amrex::Real Ms_hi_x = mag_Ms_xface_arr(i+1, j, k);
-                            amrex::Real Ms_lo_y = mag_Ms_xface_arr(i, j-1, k);
-                            amrex::Real Ms_hi_y = mag_Ms_xface_arr(i, j+1, k);
-                            amrex::Real Ms_lo_z = mag_Ms_xface_arr(i, j, k-1);
-                            amrex::Real Ms_hi_z = mag_Ms_xface_arr(i, j, k+1);
+                            // H_interlayer - use M^[(new_time),r-1] of the paired faces across the spacer
+                            interlayer_x.AddEffectiveField(i, j, k, Hx_eff, Hy_eff, Hz_eff);
 
-                            Hx_eff += H_exchange_coeff * T_Algo::Laplacian_Mag(M_prev_xface, coefs_x, coefs_y, coefs_z, n_coefs_x, n_coefs_y, n_coefs_z, Ms_lo_x, Ms_hi_x, Ms_lo_y, Ms_hi_y, Ms_lo_z, Ms_hi_z, i, j, k, 0, 0); //Last argument is nodality -- xface = 0
-                            Hy_eff += H_exchange_coeff * T_Algo::Laplacian_Mag(M_prev_xface, coefs_x, coefs_y, coefs_z, n_coefs_x, n_coefs_y, n_coefs_z, Ms_lo_x, Ms_hi_x, Ms_lo_y, Ms_hi_y, Ms_lo_z, Ms_hi_z, i, j, k, 1, 0); //Last argument is nodality -- xface = 0
-                            Hz_eff += H_exchange_coeff * T_Algo::Laplacian_Mag(M_prev_xface, coefs_x, coefs_y, coefs_z, n_coefs_x, n_coefs_y, n_coefs_z, Ms_lo_x, Ms_hi_x, Ms_lo_y, Ms_hi_y, Ms_lo_z, Ms_hi_z, i, j, k, 2, 0); //Last argument is nodality -- xface = 0
-                        }
+                            if (mag_spin_torque_coupling == 1){
 
-                        if (mag_anisotropy_coupling == 1){
+                                // H_spin_torque - use M^[(new_time),r-1]
+                                spin_torque.AddEffectiveField(i, j, k, Hxnodal, mag_Ms_xface_arr(i,j,k), M_xface(i, j, k, 0), M_xface(i, j, k, 1), M_xface(i, j, k, 2), Hx_eff, Hy_eff, Hz_eff);
+                            }
 
-                            if (mag_anisotropy_xface_arr(i,j,k) == 0._rt) amrex::Abort("The mag_anisotropy_xface_arr(i,j,k) is 0.0 while including the anisotropy coupling term H_anisotropy for H_eff");
+                            if (thermal_field){
 
-                            // H_anisotropy - use M^[(new_time),r-1]
-                            amrex::Real M_dot_anisotropy_axis = 0.0;
-                            for (int comp=0; comp<3; ++comp) {
-                                M_dot_anisotropy_axis += M_xface(i, j, k, comp) * anisotropy_axis[comp];
+                                // H_thermal - the same random field in all the iterations of the update
+                                thermal.AddEffectiveField(i, j, k, Hxnodal, 0, mag_alpha_xface_arr(i,j,k), mag_Ms_xface_arr(i,j,k), mag_coefs_xface_arr(i,j,k,MacroscopicProperties::mag_coef_gamma), Hx_eff, Hy_eff, Hz_eff);
                             }
-                            amrex::Real const H_anisotropy_coeff = - 2.0 * mag_anisotropy_xface_arr(i,j,k) / PhysConst::mu0 / mag_Ms_xface_arr(i,j,k) / mag_Ms_xface_arr(i,j,k);
-                            Hx_eff += H_anisotropy_coeff * M_dot_anisotropy_axis * anisotropy_axis[0];
-                            Hy_eff += H_anisotropy_coeff * M_dot_anisotropy_axis * anisotropy_axis[1];
-                            Hz_eff += H_anisotropy_coeff * M_dot_anisotropy_axis * anisotropy_axis[2];
-                        }
 
-                        // calculate the a_temp_dynamic_coeff (it is divided by 2.0 because the derivation is based on an interger dt,
-                        // while in real simulations, the input dt is actually dt/2.0)
-                        amrex::Real a_temp_dynamic_coeff = PhysConst::mu0 * amrex::Math::abs(mag_gamma_xface_arr(i,j,k)) / 2._rt;
-
-                        amrex::GpuArray<amrex::Real,3> H_eff;
-                        H_eff[0] = Hx_eff;
-                        H_eff[1] = Hy_eff;
-                        H_eff[2] = Hz_eff;
-
-                        for (int comp=0; comp<3; ++comp) {
-                            // calculate a_temp_xface
-                            // all components on x-faces of grid
-                            a_temp_xface(i, j, k, comp) = (M_normalization != 0) ? -(dt * a_temp_dynamic_coeff * H_eff[comp] + a_temp_static_xface(i, j, k, comp))
-                                                                                 : -(dt * a_temp_dynamic_coeff * H_eff[comp] + 0.5 * a_temp_static_xface(i, j, k, comp)
-                                                                                     + 0.5 * mag_alpha_xface_arr(i,j,k) * 1. / std::sqrt(std::pow(M_xface(i, j, k, 0), 2._rt) + std::pow(M_xface(i, j, k, 1), 2._rt) + std::pow(M_xface(i, j, k, 2), 2._rt)) * M_old_xface(i, j, k, comp));
-                        }
+                            // calculate the a_temp_dynamic_coeff (it is divided by 2.0 because the derivation is based on an interger dt,
+                            // while in real simulations, the input dt is actually dt/2.0)
+                            amrex::Real a_temp_dynamic_coeff = mag_coefs_xface_arr(i,j,k,MacroscopicProperties::mag_coef_gamma);
 
-                        for (int comp=0; comp<3; ++comp) {
-                            // update M_xface from a and b using the updateM_field
-                            // all components on x-faces of grid
-                            M_xface(i, j, k, comp) = MacroscopicProperties::updateM_field(i, j, k, comp, a_temp_xface, b_temp_static_xface);
-                        }
+                            amrex::GpuArray<amrex::Real,3> H_eff;
+                            H_eff[0] = Hx_eff;
+                            H_eff[1] = Hy_eff;
+                            H_eff[2] = Hz_eff;
 
-                        // temporary normalized magnitude of M_xface field at the fixed point
-                        // re-investigate the way we do Ms interp, in case we encounter the case where Ms changes across two adjacent cells that you are doing interp
-                        amrex::Real M_magnitude_normalized = std::sqrt(std::pow(M_xface(i, j, k, 0), 2._rt) + std::pow(M_xface(i, j, k, 1), 2._rt) + std::pow(M_xface(i, j, k, 2), 2._rt)) / mag_Ms_xface_arr(i,j,k);
-                        if (M_normalization == 1){
-                            // saturated case; if |M| has drifted from M_s too much, abort.  Otherwise, normalize
-                            // check the normalized error
-                            if (amrex::Math::abs(1._rt - M_magnitude_normalized) > mag_normalized_error){
-                                amrex::Abort("Exceed the normalized error of the M_xface field");
+                            for (int comp=0; comp<3; ++comp) {
+                                // calculate a_temp_xface
+                                // all components on x-faces of grid
+                                a_temp_xface(i, j, k, comp) = (M_normalization != 0) ? -(dt_M * a_temp_dynamic_coeff * H_eff[comp] + a_temp_static_xface(i, j, k, comp))
+                                                                                     : -(dt_M * a_temp_dynamic_coeff * H_eff[comp] + 0.5 * a_temp_static_xface(i, j, k, comp)
+                                                                                         + 0.5 * mag_alpha_xface_arr(i,j,k) * 1. / std::sqrt(M_xface(i, j, k, 0)*M_xface(i, j, k, 0) + M_xface(i, j, k, 1)*M_xface(i, j, k, 1) + M_xface(i, j, k, 2)*M_xface(i, j, k, 2)) * M_old_xface(i, j, k, comp));
                             }
-                            // normalize the M_xface field
-                            M_xface(i, j, k, 0) /= M_magnitude_normalized;
-                            M_xface(i, j, k, 1) /= M_magnitude_normalized;
-                            M_xface(i, j, k, 2) /= M_magnitude_normalized;
-                        }
-                        else if (M_normalization == 0){
-                            // check the normalized error
-                            if (M_magnitude_normalized > (1._rt + mag_normalized_error)){
-                                amrex::Abort("Caution: Unsaturated material has M_xface exceeding the saturation magnetization");
+
+                            for (int comp=0; comp<3; ++comp) {
+                                // update M_xface from a and b using the updateM_field
+                                // all components on x-faces of grid
+                                M_xface(i, j, k, comp) = MacroscopicProperties::updateM_field(i, j, k, comp, a_temp_xface, b_temp_static_xface);
                             }
-                            else if (M_magnitude_normalized > 1._rt && M_magnitude_normalized <= 1._rt + mag_normalized_error){
+
+                            // temporary normalized magnitude of M_xface field at the fixed point
+                            // re-investigate the way we do Ms interp, in case we encounter the case where Ms changes across two adjacent cells that you are doing interp
+                            amrex::Real M_magnitude_normalized = std::sqrt(M_xface(i, j, k, 0)*M_xface(i, j, k, 0) + M_xface(i, j, k, 1)*M_xface(i, j, k, 1) + M_xface(i, j, k, 2)*M_xface(i, j, k, 2)) / mag_Ms_xface_arr(i,j,k);
+                            if (M_normalization == 1){
+                                // saturated case; if |M| has drifted from M_s too much, flag it for the check after the update.  Then, normalize
+                                // check the normalized error
+                                if (amrex::Math::abs(1._rt - M_magnitude_normalized) > mag_normalized_error){
+                                    norm_flag = MacroscopicProperties::mag_norm_exceeded;
+                                }
                                 // normalize the M_xface field
                                 M_xface(i, j, k, 0) /= M_magnitude_normalized;
                                 M_xface(i, j, k, 1) /= M_magnitude_normalized;
                                 M_xface(i, j, k, 2) /= M_magnitude_normalized;
                             }
-                        }
+                            else if (M_normalization == 0){
+                                // check the normalized error
+                                if (M_magnitude_normalized > (1._rt + mag_normalized_error)){
+                                    norm_flag = MacroscopicProperties::mag_norm_unsaturated_exceeded;
+                                }
+                                else if (M_magnitude_normalized > 1._rt && M_magnitude_normalized <= 1._rt + mag_normalized_error){
+                                    // normalize the M_xface field
+                                    M_xface(i, j, k, 0) /= M_magnitude_normalized;
+                                    M_xface(i, j, k, 1) /= M_magnitude_normalized;
+                                    M_xface(i, j, k, 2) /= M_magnitude_normalized;
+                                }
+                            }
 
-                        // calculate M_error_xface
-                        // x,y,z component on M-error on x-faces of grid
-                        for (int icomp = 0; icomp < 3; ++icomp) {
-                            M_error_xface(i, j, k, icomp) = amrex::Math::abs((M_xface(i, j, k, icomp) - M_prev_xface(i, j, k, icomp))) / mag_Ms_xface_arr(i,j,k);
+                            // calculate M_error_xface
+                            // x,y,z component on M-error on x-faces of grid
+                            for (int icomp = 0; icomp < 3; ++icomp) {
+                                amrex::Real const M_error = amrex::Math::abs((M_xface(i, j, k, icomp) - M_prev_xface(i, j, k, icomp))) / mag_Ms_xface_arr(i,j,k);
+                                if (fused_update == 0) M_error_xface(i, j, k, icomp) = M_error;
+                                M_error_max = amrex::max(M_error_max, M_error);
+                            }
                         }
-                    }
-                });
+                        return {M_error_max, norm_flag};
+                    };
+                for (Box const& bx : LLGIterationRegions(tbx, mfi.validbox(), ng_LLG, overlap_comm, pass)) {
+                    reduce_op.eval(bx, reduce_data, update_M_xface);
+                }
 
-            amrex::ParallelFor(tby,
-                [=] AMREX_GPU_DEVICE(int i, int j, int k) {
+                auto const update_M_yface =
+                    [=] AMREX_GPU_DEVICE(int i, int j, int k) -> ReduceTuple {
 
-                    // determine if the material is nonmagnetic or not
-                    if (mag_Ms_yface_arr(i,j,k) > 0._rt){
+                        amrex::Real M_error_max = 0._rt;
+                        int norm_flag = MacroscopicProperties::mag_norm_ok;
 
-                        // when working on M_yface(i,j,k,0:2) we have direct access to M_yface(i,j,k,0:2) and Hy(i,j,k)
-                        // Hy and Hz can be acquired by interpolation
+                        // determine if the material is nonmagnetic or not
+                        if (mag_Ms_yface_arr(i,j,k) > 0._rt){
 
-                        // H_bias
-                        amrex::Real Hx_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, Hxnodal, Hynodal, Hx_bias);
-                        amrex::Real Hy_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, Hynodal, Hynodal, Hy_bias);
-                        amrex::Real Hz_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, Hznodal, Hynodal, Hz_bias);
+                            // when working on M_yface(i,j,k,0:2) we have direct access to M_yface(i,j,k,0:2) and Hy(i,j,k)
+                            // Hy and Hz can be acquired by interpolation
 
-                        if (coupling == 1){
-                            // H_eff = H_maxwell + H_bias + H_exchange + H_anisotropy
+                            // H_bias
+                            amrex::Real Hx_eff = MacroscopicProperties::getH_bias(i, j, k, Hxnodal, Hynodal, Hx_bias, H_bias_uniform, H_bias_value[0]);
+                            amrex::Real Hy_eff = MacroscopicProperties::getH_bias(i, j, k, Hynodal, Hynodal, Hy_bias, H_bias_uniform, H_bias_value[1]);
+                            amrex::Real Hz_eff = MacroscopicProperties::getH_bias(i, j, k, Hznodal, Hynodal, Hz_bias, H_bias_uniform, H_bias_value[2]);
 
-                            // H_maxwell - use H^[(new_time),r-1]
-                            Hx_eff += MacroscopicProperties::face_avg_to_face(i, j, k, 0, Hxnodal, Hynodal, Hx);
-                            Hy_eff += MacroscopicProperties::face_avg_to_face(i, j, k, 0, Hynodal, Hynodal, Hy);
-                            Hz_eff += MacroscopicProperties::face_avg_to_face(i, j, k, 0, Hznodal, Hynodal, Hz);
-                        }
+                            if (coupling == 1){
+                                // H_eff = H_maxwell + H_bias + H_exchange + H_anisotropy
 
-                        if (mag_exchange_coupling == 1){
+                                // H_maxwell - use H^[(new_time),r-1]
+                                Hx_eff += MacroscopicProperties::face_avg_to_face(i, j, k, 0, Hxnodal, Hynodal, Hx);
+                                Hy_eff += MacroscopicProperties::face_avg_to_face(i, j, k, 0, Hynodal, Hynodal, Hy);
+                                Hz_eff += MacroscopicProperties::face_avg_to_face(i, j, k, 0, Hznodal, Hynodal, Hz);
+                            }
 
-                            if (mag_exchange_yface_arr(i,j,k) == 0._rt) amrex::Abort("The mag_exchange_yface_arr(i,j,k) is 0.0 while including the exchange coupling term H_exchange for H_eff");
+                            if (mag_exchange_coupling == 1){
 
-                            // H_exchange - use M^[(new_time),r-1]
-                            amrex::Real const H_exchange_coeff = 2.0 * mag_exchange_yface_arr(i,j,k) / PhysConst::mu0 / mag_Ms_yface_arr(i,j,k) / mag_Ms_yface_arr(i,j,k);
+                                // H_exchange - use M^[(new_time),r-1]
+                                amrex::Real const H_exchange_coeff = mag_coefs_yface_arr(i,j,k,MacroscopicProperties::mag_coef_exchange);
 
-                            amrex::Real Ms_lo_x = mag_Ms_yface_arr(i-1, j, k);
-                            amrex::Real Ms_hi_x = mag_Ms_yface_arr(i+1, j, k);
-                            amrex::Real Ms_lo_y = mag_Ms_yface_arr(i, j-1, k);
-                            amrex::Real Ms_hi_y = mag_Ms_yface_arr(i, j+1, k);
-                            amrex::Real Ms_lo_z = mag_Ms_yface_arr(i, j, k-1);
-                            amrex::Real Ms_hi_z = mag_Ms_yface_arr(i, j, k+1);
+                                amrex::Real Ms_lo_x = mag_Ms_yface_arr(i-1, j, k);
+                                amrex::Real Ms_hi_x = mag_Ms_yface_arr(i+1, j, k);
+                                amrex::Real Ms_lo_y = mag_Ms_yface_arr(i, j-1, k);
+                                amrex::Real Ms_hi_y = mag_Ms_yface_arr(i, j+1, k);
+                                amrex::Real Ms_lo_z = mag_Ms_yface_arr(i, j, k-1);
+                                amrex::Real Ms_hi_z = mag_Ms_yface_arr(i, j, k+1);
 
-                            Hx_eff += H_exchange_coeff * T_Algo::Laplacian_Mag(M_prev_yface, coefs_x, coefs_y, coefs_z, n_coefs_x, n_coefs_y, n_coefs_z, Ms_lo_x, Ms_hi_x, Ms_lo_y, Ms_hi_y, Ms_lo_z, Ms_hi_z, i, j, k, 0, 1); //Last argument is nodality -- yface = 1
-                            Hy_eff += H_exchange_coeff * T_Algo::Laplacian_Mag(M_prev_yface, coefs_x, coefs_y, coefs_z, n_coefs_x, n_coefs_y, n_coefs_z, Ms_lo_x, Ms_hi_x, Ms_lo_y, Ms_hi_y, Ms_lo_z, Ms_hi_z, i, j, k, 1, 1); //Last argument is nodality -- yface = 1
-                            Hz_eff += H_exchange_coeff * T_Algo::Laplacian_Mag(M_prev_yface, coefs_x, coefs_y, coefs_z, n_coefs_x, n_coefs_y, n_coefs_z, Ms_lo_x, Ms_hi_x, Ms_lo_y, Ms_hi_y, Ms_lo_z, Ms_hi_z, i, j, k, 2, 1); //Last argument is nodality -- yface = 1
-                        }
+                                Hx_eff += H_exchange_coeff * T_Algo::Laplacian_Mag(M_prev_yface, coefs_x, coefs_y, coefs_z, n_coefs_x, n_coefs_y, n_coefs_z, Ms_lo_x, Ms_hi_x, Ms_lo_y, Ms_hi_y, Ms_lo_z, Ms_hi_z, i, j, k, 0, 1); //Last argument is nodality -- yface = 1
+                                Hy_eff += H_exchange_coeff * T_Algo::Laplacian_Mag(M_prev_yface, coefs_x, coefs_y, coefs_z, n_coefs_x, n_coefs_y, n_coefs_z, Ms_lo_x, Ms_hi_x, Ms_lo_y, Ms_hi_y, Ms_lo_z, Ms_hi_z, i, j, k, 1, 1); //Last argument is nodality -- yface = 1
+                                Hz_eff += H_exchange_coeff * T_Algo::Laplacian_Mag(M_prev_yface, coefs_x, coefs_y, coefs_z, n_coefs_x, n_coefs_y, n_coefs_z, Ms_lo_x, Ms_hi_x, Ms_lo_y, Ms_hi_y, Ms_lo_z, Ms_hi_z, i, j, k, 2, 1); //Last argument is nodality -- yface = 1
 
-                        if (mag_anisotropy_coupling == 1){
+                                // H_DMI - same M and neighbor Ms as H_exchange, in the same pass
+                                if (DMI_type != 0){
+                                    T_Algo::AddDMIField_Mag(M_prev_yface, coefs_x, coefs_y, coefs_z, n_coefs_x, n_coefs_y, n_coefs_z, Ms_lo_x, Ms_hi_x, Ms_lo_y, Ms_hi_y, Ms_lo_z, Ms_hi_z, i, j, k, 1, DMI_type,
+                                                            mag_coefs_yface_arr(i,j,k,MacroscopicProperties::mag_coef_DMI), Hx_eff, Hy_eff, Hz_eff);
+                                }
+                            }
 
-                            if (mag_anisotropy_yface_arr(i,j,k) == 0._rt) amrex::Abort("The mag_anisotropy_yface_arr(i,j,k) is 0.0 while including the anisotropy coupling term H_anisotropy for H_eff");
+                            if (mag_anisotropy_coupling == 1){
 
-                            // H_anisotropy - use M^[(new_time),r-1]
-                            amrex::Real M_dot_anisotropy_axis = 0.0;
-                            for (int comp=0; comp<3; ++comp) {
-                                M_dot_anisotropy_axis += M_yface(i, j, k, comp) * anisotropy_axis[comp];
+                                // H_anisotropy - use M^[(new_time),r-1]
+                                amrex::Real const H_anisotropy_coeff = mag_coefs_yface_arr(i,j,k,MacroscopicProperties::mag_coef_anisotropy);
+                                MacroscopicProperties::addH_anisotropy(i, j, k, grain_yface_arr, anisotropy_axes, anisotropy_type, H_anisotropy_coeff,
+                                                                       M_yface(i, j, k, 0), M_yface(i, j, k, 1), M_yface(i, j, k, 2), Hx_eff, Hy_eff, Hz_eff);
                             }
-                            amrex::Real const H_anisotropy_coeff = - 2.0 * mag_anisotropy_yface_arr(i,j,k) / PhysConst::mu0 / mag_Ms_yface_arr(i,j,k) / mag_Ms_yface_arr(i,j,k);
-                            Hx_eff += H_anisotropy_coeff * M_dot_anisotropy_axis * anisotropy_axis[0];
-                            Hy_eff += H_anisotropy_coeff * M_dot_anisotropy_axis * anisotropy_axis[1];
-                            Hz_eff += H_anisotropy_coeff * M_dot_anisotropy_axis * anisotropy_axis[2];
-                        }
 
-                        // calculate the a_temp_dynamic_coeff (it is divided by 2.0 because the derivation is based on an interger dt,
-                        // while in real simulations, the input dt is actually dt/2.0)
-                        amrex::Real a_temp_dynamic_coeff = PhysConst::mu0 * amrex::Math::abs(mag_gamma_yface_arr(i,j,k)) / 2._rt;
-
-                        amrex::GpuArray<amrex::Real,3> H_eff;
-                        H_eff[0] = Hx_eff;
-                        H_eff[1] = Hy_eff;
-                        H_eff[2] = Hz_eff;
-
-                        for (int comp=0; comp<3; ++comp) {
-                            // calculate a_temp_yface
-                            // all components on y-faces of grid
-                            a_temp_yface(i, j, k, comp) = (M_normalization != 0) ? -(dt * a_temp_dynamic_coeff * H_eff[comp] + a_temp_static_yface(i, j, k, comp))
-                                                                                 : -(dt * a_temp_dynamic_coeff * H_eff[comp] + 0.5 * a_temp_static_yface(i, j, k, comp)
-                                                                                     + 0.5 * mag_alpha_yface_arr(i,j,k) * 1. / std::sqrt(std::pow(M_yface(i, j, k, 0), 2._rt) + std::pow(M_yface(i, j, k, 1), 2._rt) + std::pow(M_yface(i, j, k, 2), 2._rt)) * M_old_yface(i, j, k, comp));
-                        }
+                            // H_interlayer - use M^[(new_time),r-1] of the paired faces across the spacer
+                            interlayer_y.AddEffectiveField(i, j, k, Hx_eff, Hy_eff, Hz_eff);
 
-                        for (int comp=0; comp<3; ++comp) {
-                            // update M_yface from a and b using the updateM_field
-                            // all components on y-faces of grid
-                            M_yface(i, j, k, comp) = MacroscopicProperties::updateM_field(i, j, k, comp, a_temp_yface, b_temp_static_yface);
-                        }
+                            if (mag_spin_torque_coupling == 1){
+
+                                // H_spin_torque - use M^[(new_time),r-1]
+                                spin_torque.AddEffectiveField(i, j, k, Hynodal, mag_Ms_yface_arr(i,j,k), M_yface(i, j, k, 0), M_yface(i, j, k, 1), M_yface(i, j, k, 2), Hx_eff, Hy_eff, Hz_eff);
+                            }
 
-                        // temporary normalized magnitude of M_yface field at the fixed point
-                        // re-investigate the way we do Ms interp, in case we encounter the case where Ms changes across two adjacent cells that you are doing interp
-                        amrex::Real M_magnitude_normalized = std::sqrt(std::pow(M_yface(i, j, k, 0), 2._rt) + std::pow(M_yface(i, j, k, 1), 2._rt) + std::pow(M_yface(i, j, k, 2), 2._rt)) / mag_Ms_yface_arr(i,j,k);
+                            if (thermal_field){
 
-                        if (M_normalization == 1){
-                            // saturated case; if |M| has drifted from M_s too much, abort.  Otherwise, normalize
-                            // check the normalized error
-                            if (amrex::Math::abs(1._rt - M_magnitude_normalized) > mag_normalized_error){
-                                amrex::Abort("Exceed the normalized error of the M_yface field");
+                                // H_thermal - the same random field in all the iterations of the update
+                                thermal.AddEffectiveField(i, j, k, Hynodal, 1, mag_alpha_yface_arr(i,j,k), mag_Ms_yface_arr(i,j,k), mag_coefs_yface_arr(i,j,k,MacroscopicProperties::mag_coef_gamma), Hx_eff, Hy_eff, Hz_eff);
                             }
-                            // normalize the M_yface field
-                            M_yface(i, j, k, 0) /= M_magnitude_normalized;
-                            M_yface(i, j, k, 1) /= M_magnitude_normalized;
-                            M_yface(i, j, k, 2) /= M_magnitude_normalized;
-                        }
-                        else if (M_normalization == 0){
-                            // check the normalized error
-                            if (M_magnitude_normalized > 1._rt + mag_normalized_error){
-                                amrex::Abort("Caution: Unsaturated material has M_yface exceeding the saturation magnetization");
+
+                            // calculate the a_temp_dynamic_coeff (it is divided by 2.0 because the derivation is based on an interger dt,
+                            // while in real simulations, the input dt is actually dt/2.0)
+                            amrex::Real a_temp_dynamic_coeff = mag_coefs_yface_arr(i,j,k,MacroscopicProperties::mag_coef_gamma);
+
+                            amrex::GpuArray<amrex::Real,3> H_eff;
+                            H_eff[0] = Hx_eff;
+                            H_eff[1] = Hy_eff;
+                            H_eff[2] = Hz_eff;
+
+                            for (int comp=0; comp<3; ++comp) {
+                                // calculate a_temp_yface
+                                // all components on y-faces of grid
+                                a_temp_yface(i, j, k, comp) = (M_normalization != 0) ? -(dt_M * a_temp_dynamic_coeff * H_eff[comp] + a_temp_static_yface(i, j, k, comp))
+                                                                                     : -(dt_M * a_temp_dynamic_coeff * H_eff[comp] + 0.5 * a_temp_static_yface(i, j, k, comp)
+                                                                                         + 0.5 * mag_alpha_yface_arr(i,j,k) * 1. / std::sqrt(M_yface(i, j, k, 0)*M_yface(i, j, k, 0) + M_yface(i, j, k, 1)*M_yface(i, j, k, 1) + M_yface(i, j, k, 2)*M_yface(i, j, k, 2)) * M_old_yface(i, j, k, comp));
+                            }
+
+                            for (int comp=0; comp<3; ++comp) {
+                                // update M_yface from a and b using the updateM_field
+                                // all components on y-faces of grid
+                                M_yface(i, j, k, comp) = MacroscopicProperties::updateM_field(i, j, k, comp, a_temp_yface, b_temp_static_yface);
                             }
-                            else if (M_magnitude_normalized > 1._rt && M_magnitude_normalized <= 1._rt + mag_normalized_error){
+
+                            // temporary normalized magnitude of M_yface field at the fixed point
+                            // re-investigate the way we do Ms interp, in case we encounter the case where Ms changes across two adjacent cells that you are doing interp
+                            amrex::Real M_magnitude_normalized = std::sqrt(M_yface(i, j, k, 0)*M_yface(i, j, k, 0) + M_yface(i, j, k, 1)*M_yface(i, j, k, 1) + M_yface(i, j, k, 2)*M_yface(i, j, k, 2)) / mag_Ms_yface_arr(i,j,k);
+
+                            if (M_normalization == 1){
+                                // saturated case; if |M| has drifted from M_s too much, flag it for the check after the update.  Then, normalize
+                                // check the normalized error
+                                if (amrex::Math::abs(1._rt - M_magnitude_normalized) > mag_normalized_error){
+                                    norm_flag = MacroscopicProperties::mag_norm_exceeded;
+                                }
                                 // normalize the M_yface field
                                 M_yface(i, j, k, 0) /= M_magnitude_normalized;
                                 M_yface(i, j, k, 1) /= M_magnitude_normalized;
                                 M_yface(i, j, k, 2) /= M_magnitude_normalized;
                             }
-                        }
+                            else if (M_normalization == 0){
+                                // check the normalized error
+                                if (M_magnitude_normalized > 1._rt + mag_normalized_error){
+                                    norm_flag = MacroscopicProperties::mag_norm_unsaturated_exceeded;
+                                }
+                                else if (M_magnitude_normalized > 1._rt && M_magnitude_normalized <= 1._rt + mag_normalized_error){
+                                    // normalize the M_yface field
+                                    M_yface(i, j, k, 0) /= M_magnitude_normalized;
+                                    M_yface(i, j, k, 1) /= M_magnitude_normalized;
+                                    M_yface(i, j, k, 2) /= M_magnitude_normalized;
+                                }
+                            }
 
-                        // calculate M_error_yface
-                        // x,y,z component on y-faces of grid
-                        for (int icomp = 0; icomp < 3; ++icomp) {
-                            M_error_yface(i, j, k, icomp) = amrex::Math::abs((M_yface(i, j, k, icomp) - M_prev_yface(i, j, k, icomp))) / mag_Ms_yface_arr(i,j,k);
+                            // calculate M_error_yface
+                            // x,y,z component on y-faces of grid
+                            for (int icomp = 0; icomp < 3; ++icomp) {
+                                amrex::Real const M_error = amrex::Math::abs((M_yface(i, j, k, icomp) - M_prev_yface(i, j, k, icomp))) / mag_Ms_yface_arr(i,j,k);
+                                if (fused_update == 0) M_error_yface(i, j, k, icomp) = M_error;
+                                M_error_max = amrex::max(M_error_max, M_error);
+                            }
                         }
-                    }
-                });
+                        return {M_error_max, norm_flag};
+                    };
+                for (Box const& bx : LLGIterationRegions(tby, mfi.validbox(), ng_LLG, overlap_comm, pass)) {
+                    reduce_op.eval(bx, reduce_data, update_M_yface);
+                }
 
-            amrex::ParallelFor(tbz,
-                [=] AMREX_GPU_DEVICE(int i, int j, int k) {
+                auto const update_M_zface =
+                    [=] AMREX_GPU_DEVICE(int i, int j, int k) -> ReduceTuple {
 
-                    // determine if the material is nonmagnetic or not
-                    if (mag_Ms_zface_arr(i,j,k) > 0._rt){
+                        amrex::Real M_error_max = 0._rt;
+                        int norm_flag = MacroscopicProperties::mag_norm_ok;
 
-                        // when working on M_zface(i,j,k,0:2) we have direct access to M_zface(i,j,k,0:2) and Hz(i,j,k)
-                        // Hy and Hz can be acquired by interpolation
+                        // determine if the material is nonmagnetic or not
+                        if (mag_Ms_zface_arr(i,j,k) > 0._rt){
 
-                        // H_bias
-                        amrex::Real Hx_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, Hxnodal, Hznodal, Hx_bias);
-                        amrex::Real Hy_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, Hynodal, Hznodal, Hy_bias);
-                        amrex::Real Hz_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, Hznodal, Hznodal, Hz_bias);
+                            // when working on M_zface(i,j,k,0:2) we have direct access to M_zface(i,j,k,0:2) and Hz(i,j,k)
+                            // Hy and Hz can be acquired by interpolation
 
-                        if (coupling == 1){
-                            // H_eff = H_maxwell + H_bias + H_exchange + H_anisotropy
+                            // H_bias
+                            amrex::Real Hx_eff = MacroscopicProperties::getH_bias(i, j, k, Hxnodal, Hznodal, Hx_bias, H_bias_uniform, H_bias_value[0]);
+                            amrex::Real Hy_eff = MacroscopicProperties::getH_bias(i, j, k, Hynodal, Hznodal, Hy_bias, H_bias_uniform, H_bias_value[1]);
+                            amrex::Real Hz_eff = MacroscopicProperties::getH_bias(i, j, k, Hznodal, Hznodal, Hz_bias, H_bias_uniform, H_bias_value[2]);
 
-                            // H_maxwell - use H^[(new_time),r-1]
-                            Hx_eff += MacroscopicProperties::face_avg_to_face(i, j, k, 0, Hxnodal, Hznodal, Hx);
-                            Hy_eff += MacroscopicProperties::face_avg_to_face(i, j, k, 0, Hynodal, Hznodal, Hy);
-                            Hz_eff += MacroscopicProperties::face_avg_to_face(i, j, k, 0, Hznodal, Hznodal, Hz);
-                        }
+                            if (coupling == 1){
+                                // H_eff = H_maxwell + H_bias + H_exchange + H_anisotropy
 
-                        if (mag_exchange_coupling == 1){
+                                // H_maxwell - use H^[(new_time),r-1]
+                                Hx_eff += MacroscopicProperties::face_avg_to_face(i, j, k, 0, Hxnodal, Hznodal, Hx);
+                                Hy_eff += MacroscopicProperties::face_avg_to_face(i, j, k, 0, Hynodal, Hznodal, Hy);
+                                Hz_eff += MacroscopicProperties::face_avg_to_face(i, j, k, 0, Hznodal, Hznodal, Hz);
+                            }
 
-                            if (mag_exchange_zface_arr(i,j,k) == 0._rt) amrex::Abort("The mag_exchange_zface_arr(i,j,k) is 0.0 while including the exchange coupling term H_exchange for H_eff");
+                            if (mag_exchange_coupling == 1){
 
-                            // H_exchange - use M^[(new_time),r-1]
-                            amrex::Real const H_exchange_coeff = 2.0 * mag_exchange_zface_arr(i,j,k) / PhysConst::mu0 / mag_Ms_zface_arr(i,j,k) / mag_Ms_zface_arr(i,j,k);
+                                // H_exchange - use M^[(new_time),r-1]
+                                amrex::Real const H_exchange_coeff = mag_coefs_zface_arr(i,j,k,MacroscopicProperties::mag_coef_exchange);
 
-                            amrex::Real Ms_lo_x = mag_Ms_zface_arr(i-1, j, k);
-                            amrex::Real Ms_hi_x = mag_Ms_zface_arr(i+1, j, k);
-                            amrex::Real Ms_lo_y = mag_Ms_zface_arr(i, j-1, k);
-                            amrex::Real Ms_hi_y = mag_Ms_zface_arr(i, j+1, k);
-                            amrex::Real Ms_lo_z = mag_Ms_zface_arr(i, j, k-1);
-                            amrex::Real Ms_hi_z = mag_Ms_zface_arr(i, j, k+1);
+                                amrex::Real Ms_lo_x = mag_Ms_zface_arr(i-1, j, k);
+                                amrex::Real Ms_hi_x = mag_Ms_zface_arr(i+1, j, k);
+                                amrex::Real Ms_lo_y = mag_Ms_zface_arr(i, j-1, k);
+                                amrex::Real Ms_hi_y = mag_Ms_zface_arr(i, j+1, k);
+                                amrex::Real Ms_lo_z = mag_Ms_zface_arr(i, j, k-1);
+                                amrex::Real Ms_hi_z = mag_Ms_zface_arr(i, j, k+1);
 
-                            Hx_eff += H_exchange_coeff * T_Algo::Laplacian_Mag(M_prev_zface, coefs_x, coefs_y, coefs_z, n_coefs_x, n_coefs_y, n_coefs_z, Ms_lo_x, Ms_hi_x, Ms_lo_y, Ms_hi_y, Ms_lo_z, Ms_hi_z, i, j, k, 0, 2); //Last argument is nodality -- zface = 2
-                            Hy_eff += H_exchange_coeff * T_Algo::Laplacian_Mag(M_prev_zface, coefs_x, coefs_y, coefs_z, n_coefs_x, n_coefs_y, n_coefs_z, Ms_lo_x, Ms_hi_x, Ms_lo_y, Ms_hi_y, Ms_lo_z, Ms_hi_z, i, j, k, 1, 2); //Last argument is nodality -- zface = 2
-                            Hz_eff += H_exchange_coeff * T_Algo::Laplacian_Mag(M_prev_zface, coefs_x, coefs_y, coefs_z, n_coefs_x, n_coefs_y, n_coefs_z, Ms_lo_x, Ms_hi_x, Ms_lo_y, Ms_hi_y, Ms_lo_z, Ms_hi_z, i, j, k, 2, 2); //Last argument is nodality -- zface = 2
-                        }
+                                Hx_eff += H_exchange_coeff * T_Algo::Laplacian_Mag(M_prev_zface, coefs_x, coefs_y, coefs_z, n_coefs_x, n_coefs_y, n_coefs_z, Ms_lo_x, Ms_hi_x, Ms_lo_y, Ms_hi_y, Ms_lo_z, Ms_hi_z, i, j, k, 0, 2); //Last argument is nodality -- zface = 2
+                                Hy_eff += H_exchange_coeff * T_Algo::Laplacian_Mag(M_prev_zface, coefs_x, coefs_y, coefs_z, n_coefs_x, n_coefs_y, n_coefs_z, Ms_lo_x, Ms_hi_x, Ms_lo_y, Ms_hi_y, Ms_lo_z, Ms_hi_z, i, j, k, 1, 2); //Last argument is nodality -- zface = 2
+                                Hz_eff += H_exchange_coeff * T_Algo::Laplacian_Mag(M_prev_zface, coefs_x, coefs_y, coefs_z, n_coefs_x, n_coefs_y, n_coefs_z, Ms_lo_x, Ms_hi_x, Ms_lo_y, Ms_hi_y, Ms_lo_z, Ms_hi_z, i, j, k, 2, 2); //Last argument is nodality -- zface = 2
 
-                        if (mag_anisotropy_coupling == 1){
+                                // H_DMI - same M and neighbor Ms as H_exchange, in the same pass
+                                if (DMI_type != 0){
+                                    T_Algo::AddDMIField_Mag(M_prev_zface, coefs_x, coefs_y, coefs_z, n_coefs_x, n_coefs_y, n_coefs_z, Ms_lo_x, Ms_hi_x, Ms_lo_y, Ms_hi_y, Ms_lo_z, Ms_hi_z, i, j, k, 2, DMI_type,
+                                                            mag_coefs_zface_arr(i,j,k,MacroscopicProperties::mag_coef_DMI), Hx_eff, Hy_eff, Hz_eff);
+                                }
+                            }
 
-                            if (mag_anisotropy_zface_arr(i,j,k) == 0._rt) amrex::Abort("The mag_anisotropy_zface_arr(i,j,k) is 0.0 while including the anisotropy coupling term H_anisotropy for H_eff");
+                            if (mag_anisotropy_coupling == 1){
 
-                            // H_anisotropy - use M^[(new_time),r-1]
-                            amrex::Real M_dot_anisotropy_axis = 0.0;
-                            for (int comp=0; comp<3; ++comp) {
-                                M_dot_anisotropy_axis += M_zface(i, j, k, comp) * anisotropy_axis[comp];
+                                // H_anisotropy - use M^[(new_time),r-1]
+                                amrex::Real const H_anisotropy_coeff = mag_coefs_zface_arr(i,j,k,MacroscopicProperties::mag_coef_anisotropy);
+                                MacroscopicProperties::addH_anisotropy(i, j, k, grain_zface_arr, anisotropy_axes, anisotropy_type, H_anisotropy_coeff,
+                                                                       M_zface(i, j, k, 0), M_zface(i, j, k, 1), M_zface(i, j, k, 2), Hx_eff, Hy_eff, Hz_eff);
                             }
-                            amrex::Real const H_anisotropy_coeff = - 2.0 * mag_anisotropy_zface_arr(i,j,k) / PhysConst::mu0 / mag_Ms_zface_arr(i,j,k) / mag_Ms_zface_arr(i,j,k);
-                            Hx_eff += H_anisotropy_coeff * M_dot_anisotropy_axis * anisotropy_axis[0];
-                            Hy_eff += H_anisotropy_coeff * M_dot_anisotropy_axis * anisotropy_axis[1];
-                            Hz_eff += H_anisotropy_coeff * M_dot_anisotropy_axis * anisotropy_axis[2];
-                        }
 
-                        // calculate the a_temp_dynamic_coeff (it is divided by 2.0 because the derivation is based on an interger dt,
-                        // while in real simulations, the input dt is actually dt/2.0)
-                        amrex::Real a_temp_dynamic_coeff = PhysConst::mu0 * amrex::Math::abs(mag_gamma_zface_arr(i,j,k)) / 2._rt;
-
-                        amrex::GpuArray<amrex::Real,3> H_eff;
-                        H_eff[0] = Hx_eff;
-                        H_eff[1] = Hy_eff;
-                        H_eff[2] = Hz_eff;
-
-                        for (int comp=0; comp<3; ++comp) {
-                            // calculate a_temp_zface
-                            // all components on z-faces of grid
-                            a_temp_zface(i, j, k, comp) = (M_normalization != 0) ? -(dt * a_temp_dynamic_coeff * H_eff[comp] + a_temp_static_zface(i, j, k, comp))
-                                                                              : -(dt * a_temp_dynamic_coeff * H_eff[comp] + 0.5 * a_temp_static_zface(i, j, k, comp)
-                                                                                  + 0.5 * mag_alpha_zface_arr(i,j,k) * 1. / std::sqrt(std::pow(M_zface(i, j, k, 0), 2._rt) + std::pow(M_zface(i, j, k, 1), 2._rt) + std::pow(M_zface(i, j, k, 2), 2._rt)) * M_old_zface(i, j, k, comp));
-                        }
+                            // H_interlayer - use M^[(new_time),r-1] of the paired faces across the spacer
+                            interlayer_z.AddEffectiveField(i, j, k, Hx_eff, Hy_eff, Hz_eff);
 
-                        for (int comp=0; comp<3; ++comp) {
-                            // update M_zface from a and b using the updateM_field
-                            // all components on z-faces of grid
-                            M_zface(i, j, k, comp) = MacroscopicProperties::updateM_field(i, j, k, comp, a_temp_zface, b_temp_static_zface);
-                        }
+                            if (mag_spin_torque_coupling == 1){
+
+                                // H_spin_torque - use M^[(new_time),r-1]
+                                spin_torque.AddEffectiveField(i, j, k, Hznodal, mag_Ms_zface_arr(i,j,k), M_zface(i, j, k, 0), M_zface(i, j, k, 1), M_zface(i, j, k, 2), Hx_eff, Hy_eff, Hz_eff);
+                            }
 
-                        // temporary normalized magnitude of M_zface field at the fixed point
-                        // re-investigate the way we do Ms interp, in case we encounter the case where Ms changes across two adjacent cells that you are doing interp
-                        amrex::Real M_magnitude_normalized = std::sqrt(std::pow(M_zface(i, j, k, 0), 2._rt) + std::pow(M_zface(i, j, k, 1), 2._rt) + std::pow(M_zface(i, j, k, 2), 2._rt)) / mag_Ms_zface_arr(i,j,k);
+                            if (thermal_field){
 
-                        if (M_normalization == 1){
-                            // saturated case; if |M| has drifted from M_s too much, abort.  Otherwise, normalize
-                            // check the normalized error
-                            if (amrex::Math::abs(1. - M_magnitude_normalized) > mag_normalized_error){
-                                amrex::Abort("Exceed the normalized error of the M_zface field");
+                                // H_thermal - the same random field in all the iterations of the update
+                                thermal.AddEffectiveField(i, j, k, Hznodal, 2, mag_alpha_zface_arr(i,j,k), mag_Ms_zface_arr(i,j,k), mag_coefs_zface_arr(i,j,k,MacroscopicProperties::mag_coef_gamma), Hx_eff, Hy_eff, Hz_eff);
                             }
-                            // normalize the M_zface field
-                            M_zface(i, j, k, 0) /= M_magnitude_normalized;
-                            M_zface(i, j, k, 1) /= M_magnitude_normalized;
-                            M_zface(i, j, k, 2) /= M_magnitude_normalized;
-                        }
-                        else if (M_normalization == 0){
-                            // check the normalized error
-                            if (M_magnitude_normalized > 1._rt + mag_normalized_error){
-                                amrex::Abort("Caution: Unsaturated material has M_zface exceeding the saturation magnetization");
+
+                            // calculate the a_temp_dynamic_coeff (it is divided by 2.0 because the derivation is based on an interger dt,
+                            // while in real simulations, the input dt is actually dt/2.0)
+                            amrex::Real a_temp_dynamic_coeff = mag_coefs_zface_arr(i,j,k,MacroscopicProperties::mag_coef_gamma);
+
+                            amrex::GpuArray<amrex::Real,3> H_eff;
+                            H_eff[0] = Hx_eff;
+                            H_eff[1] = Hy_eff;
+                            H_eff[2] = Hz_eff;
+
+                            for (int comp=0; comp<3; ++comp) {
+                                // calculate a_temp_zface
+                                // all components on z-faces of grid
+                                a_temp_zface(i, j, k, comp) = (M_normalization != 0) ? -(dt_M * a_temp_dynamic_coeff * H_eff[comp] + a_temp_static_zface(i, j, k, comp))
+                                                                                  : -(dt_M * a_temp_dynamic_coeff * H_eff[comp] + 0.5 * a_temp_static_zface(i, j, k, comp)
+                                                                                      + 0.5 * mag_alpha_zface_arr(i,j,k) * 1. / std::sqrt(M_zface(i, j, k, 0)*M_zface(i, j, k, 0) + M_zface(i, j, k, 1)*M_zface(i, j, k, 1) + M_zface(i, j, k, 2)*M_zface(i, j, k, 2)) * M_old_zface(i, j, k, comp));
                             }
-                            else if (M_magnitude_normalized > 1._rt && M_magnitude_normalized <= 1._rt + mag_normalized_error){
+
+                            for (int comp=0; comp<3; ++comp) {
+                                // update M_zface from a and b using the updateM_field
+                                // all components on z-faces of grid
+                                M_zface(i, j, k, comp) = MacroscopicProperties::updateM_field(i, j, k, comp, a_temp_zface, b_temp_static_zface);
+                            }
+
+                            // temporary normalized magnitude of M_zface field at the fixed point
+                            // re-investigate the way we do Ms interp, in case we encounter the case where Ms changes across two adjacent cells that you are doing interp
+                            amrex::Real M_magnitude_normalized = std::sqrt(M_zface(i, j, k, 0)*M_zface(i, j, k, 0) + M_zface(i, j, k, 1)*M_zface(i, j, k, 1) + M_zface(i, j, k, 2)*M_zface(i, j, k, 2)) / mag_Ms_zface_arr(i,j,k);
+
+                            if (M_normalization == 1){
+                                // saturated case; if |M| has drifted from M_s too much, flag it for the check after the update.  Then, normalize
+                                // check the normalized error
+                                if (amrex::Math::abs(1. - M_magnitude_normalized) > mag_normalized_error){
+                                    norm_flag = MacroscopicProperties::mag_norm_exceeded;
+                                }
                                 // normalize the M_zface field
                                 M_zface(i, j, k, 0) /= M_magnitude_normalized;
                                 M_zface(i, j, k, 1) /= M_magnitude_normalized;
                                 M_zface(i, j, k, 2) /= M_magnitude_normalized;
                             }
-                        }
+                            else if (M_normalization == 0){
+                                // check the normalized error
+                                if (M_magnitude_normalized > 1._rt + mag_normalized_error){
+                                    norm_flag = MacroscopicProperties::mag_norm_unsaturated_exceeded;
+                                }
+                                else if (M_magnitude_normalized > 1._rt && M_magnitude_normalized <= 1._rt + mag_normalized_error){
+                                    // normalize the M_zface field
+                                    M_zface(i, j, k, 0) /= M_magnitude_normalized;
+                                    M_zface(i, j, k, 1) /= M_magnitude_normalized;
+                                    M_zface(i, j, k, 2) /= M_magnitude_normalized;
+                                }
+                            }
 
-                        // calculate M_error_zface
-                        // x,y,z component on z-faces of grid
-                        for (int icomp = 0; icomp < 3; ++icomp) {
-                            M_error_zface(i, j, k, icomp) = amrex::Math::abs((M_zface(i, j, k, icomp) - M_prev_zface(i, j, k, icomp))) / mag_Ms_zface_arr(i,j,k);
+                            // calculate M_error_zface
+                            // x,y,z component on z-faces of grid
+                            for (int icomp = 0; icomp < 3; ++icomp) {
+                                amrex::Real const M_error = amrex::Math::abs((M_zface(i, j, k, icomp) - M_prev_zface(i, j, k, icomp))) / mag_Ms_zface_arr(i,j,k);
+                                if (fused_update == 0) M_error_zface(i, j, k, icomp) = M_error;
+                                M_error_max = amrex::max(M_error_max, M_error);
+                            }
                         }
-                    }
-                });
+                        return {M_error_max, norm_flag};
+                    };
+                for (Box const& bx : LLGIterationRegions(tbz, mfi.validbox(), ng_LLG, overlap_comm, pass)) {
+                    reduce_op.eval(bx, reduce_data, update_M_zface);
+                }
+            }
         }
+        ABLASTR_KERNEL_RANGE_END("LLG_2nd::UpdateM");
 
         // update H
+        ABLASTR_KERNEL_RANGE_BEGIN("LLG_2nd::UpdateH");
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#endif
         for (MFIter mfi(*Hfield[0], TilingIfNotGPU()); mfi.isValid(); ++mfi){
+            CostBoxTimer cost_box(cost, mfi.index());
 
             auto& mag_Ms_xface_mf = macroscopic_properties->getmag_Ms_mf(0);
             auto& mag_Ms_yface_mf = macroscopic_properties->getmag_Ms_mf(1);
@@ -901,9 +1238,12 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian_2nd(
             Array4<Real> const &M_xface = Mfield[0]->array(mfi);         // note M_xface include x,y,z components at |_x faces
             Array4<Real> const &M_yface = Mfield[1]->array(mfi);         // note M_yface include x,y,z components at |_y faces
             Array4<Real> const &M_zface = Mfield[2]->array(mfi);         // note M_zface include x,y,z components at |_z faces
-            Array4<Real> const &M_xface_old = Mfield_old[0]->array(mfi); // note M_xface_old include x,y,z components at |_x faces
-            Array4<Real> const &M_yface_old = Mfield_old[1]->array(mfi); // note M_yface_old include x,y,z components at |_y faces
-            Array4<Real> const &M_zface_old = Mfield_old[2]->array(mfi); // note M_zface_old include x,y,z components at |_z faces
+            // M_old is not defined on the boxes without magnetic material when macroscopic.mag_subdomain = 1,
+            // it is not read there since only the non-magnetic branch of the update below is taken
+            int const iscratch = LLGScratchIndex(mfi.index());
+            Array4<Real> const M_xface_old = (iscratch >= 0) ? Mfield_old[0]->array(iscratch) : Array4<Real>(); // note M_xface_old include x,y,z components at |_x faces
+            Array4<Real> const M_yface_old = (iscratch >= 0) ? Mfield_old[1]->array(iscratch) : Array4<Real>(); // note M_yface_old include x,y,z components at |_y faces
+            Array4<Real> const M_zface_old = (iscratch >= 0) ? Mfield_old[2]->array(iscratch) : Array4<Real>(); // note M_zface_old include x,y,z components at |_z faces
 
             // Extract stencil coefficients
             amrex::Real const *const AMREX_RESTRICT coefs_x = m_stencil_coefs_x.dataPtr();
@@ -921,80 +1261,187 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian_2nd(
             Box const &tby = mfi.tilebox(Hynodal);
             Box const &tbz = mfi.tilebox(Hznodal);
 
-            amrex::Array4<amrex::Real> const& mu_arr = mu_mf.array(mfi);
-
-            amrex::Real const mu0_inv = 1. / PhysConst::mu0;
+            // 1/mu0 on the magnetic faces and 1/mu elsewhere, see ComputeMacroscopicHInvMu
+            amrex::Array4<amrex::Real const> const& inv_mu_x = m_macro_H_inv_mu[0]->const_array(mfi);
+            amrex::Array4<amrex::Real const> const& inv_mu_y = m_macro_H_inv_mu[1]->const_array(mfi);
+            amrex::Array4<amrex::Real const> const& inv_mu_z = m_macro_H_inv_mu[2]->const_array(mfi);
+            // the M contribution is only added on the boxes that contain magnetic material, on which M_old is defined
+            bool const magnetic_box = (iscratch >= 0) && macroscopic_properties->has_magnetic_material(mfi.index());
+
+#ifdef AMREX_USE_EB
+            // face areas and conformal circulation of E, null when not allocated
+            amrex::Array4<amrex::Real const> const Sx = face_areas[0] ? face_areas[0]->const_array(mfi) : amrex::Array4<amrex::Real const>();
+            amrex::Array4<amrex::Real const> const Sy = face_areas[1] ? face_areas[1]->const_array(mfi) : amrex::Array4<amrex::Real const>();
+            amrex::Array4<amrex::Real const> const Sz = face_areas[2] ? face_areas[2]->const_array(mfi) : amrex::Array4<amrex::Real const>();
+            amrex::Array4<amrex::Real const> const ect_x = ect_minus_curlE[0] ? ect_minus_curlE[0]->const_array(mfi) : amrex::Array4<amrex::Real const>();
+            amrex::Array4<amrex::Real const> const ect_y = ect_minus_curlE[1] ? ect_minus_curlE[1]->const_array(mfi) : amrex::Array4<amrex::Real const>();
+            amrex::Array4<amrex::Real const> const ect_z = ect_minus_curlE[2] ? ect_minus_curlE[2]->const_array(mfi) : amrex::Array4<amrex::Real const>();
+#endif
 
             // Loop over the cells and update the fields
             amrex::ParallelFor(tbx, tby, tbz,
 
                 [=] AMREX_GPU_DEVICE(int i, int j, int k) {
 
-                    if (mag_Ms_xface_arr(i,j,k) == 0._rt){ // nonmagnetic region
-                        amrex::Real mu_arrx = CoarsenIO::Interp( mu_arr, mu_stag, Hx_stag, macro_cr, i, j, k, 0);
-                        Hx(i, j, k) = Hx_old(i, j, k) + 1. / mu_arrx * dt * (T_Algo::UpwardDz(Ey, coefs_z, n_coefs_z, i, j, k)
-                                                                           - T_Algo::UpwardDy(Ez, coefs_y, n_coefs_y, i, j, k));
-                    } else if (mag_Ms_xface_arr(i,j,k) > 0){ // magnetic region
-                        Hx(i, j, k) = Hx_old(i, j, k) + mu0_inv * dt * (T_Algo::UpwardDz(Ey, coefs_z, n_coefs_z, i, j, k)
-                                                                      - T_Algo::UpwardDy(Ez, coefs_y, n_coefs_y, i, j, k));
-                        if (coupling == 1) {
-                            Hx(i, j, k) += - M_xface(i, j, k, 0) + M_xface_old(i, j, k, 0);
-                        }
+#ifdef AMREX_USE_EB
+                    // faces fully covered by the embedded boundary are never stepped
+                    if (Sx.p != nullptr && Sx(i, j, k) <= 0) return;
+                    // with the ECT solver, the conformal circulation of E replaces the Yee curl
+                    amrex::Real const minus_curlE_x = (ect_x.p != nullptr) ? ect_x(i, j, k) :
+#else
+                    amrex::Real const minus_curlE_x =
+#endif
+                        T_Algo::UpwardDz(Ey, coefs_z, n_coefs_z, i, j, k) - T_Algo::UpwardDy(Ez, coefs_y, n_coefs_y, i, j, k);
+
+                    // 1/mu0 on the magnetic faces (Ms > 0) and 1/mu elsewhere
+                    Hx(i, j, k) = Hx_old(i, j, k) + inv_mu_x(i, j, k) * dt * minus_curlE_x;
+                    if (coupling == 1 && magnetic_box && mag_Ms_xface_arr(i,j,k) > 0._rt) { // magnetic region
+                        Hx(i, j, k) += - M_xface(i, j, k, 0) + M_xface_old(i, j, k, 0);
                     }
                 },
 
                 [=] AMREX_GPU_DEVICE(int i, int j, int k) {
 
-                    if (mag_Ms_yface_arr(i,j,k) == 0._rt){ // nonmagnetic region
-                        amrex::Real mu_arry = CoarsenIO::Interp( mu_arr, mu_stag, Hy_stag, macro_cr, i, j, k, 0);
-                        Hy(i, j, k) = Hy_old(i, j, k) + 1. / mu_arry * dt * (T_Algo::UpwardDx(Ez, coefs_x, n_coefs_x, i, j, k)
-                                                                           - T_Algo::UpwardDz(Ex, coefs_z, n_coefs_z, i, j, k));
-                    } else if (mag_Ms_yface_arr(i,j,k) > 0){ // magnetic region
-                        Hy(i, j, k) = Hy_old(i, j, k) + mu0_inv * dt * (T_Algo::UpwardDx(Ez, coefs_x, n_coefs_x, i, j, k)
-                                                                      - T_Algo::UpwardDz(Ex, coefs_z, n_coefs_z, i, j, k));
-                        if (coupling == 1){
-                            Hy(i, j, k) += - M_yface(i, j, k, 1) + M_yface_old(i, j, k, 1);
-                        }
+#ifdef AMREX_USE_EB
+                    // faces fully covered by the embedded boundary are never stepped
+                    if (Sy.p != nullptr && Sy(i, j, k) <= 0) return;
+                    // with the ECT solver, the conformal circulation of E replaces the Yee curl
+                    amrex::Real const minus_curlE_y = (ect_y.p != nullptr) ? ect_y(i, j, k) :
+#else
+                    amrex::Real const minus_curlE_y =
+#endif
+                        T_Algo::UpwardDx(Ez, coefs_x, n_coefs_x, i, j, k) - T_Algo::UpwardDz(Ex, coefs_z, n_coefs_z, i, j, k);
+
+                    // 1/mu0 on the magnetic faces (Ms > 0) and 1/mu elsewhere
+                    Hy(i, j, k) = Hy_old(i, j, k) + inv_mu_y(i, j, k) * dt * minus_curlE_y;
+                    if (coupling == 1 && magnetic_box && mag_Ms_yface_arr(i,j,k) > 0._rt) { // magnetic region
+                        Hy(i, j, k) += - M_yface(i, j, k, 1) + M_yface_old(i, j, k, 1);
                     }
                 },
 
                 [=] AMREX_GPU_DEVICE(int i, int j, int k) {
 
-                    if (mag_Ms_zface_arr(i,j,k) == 0._rt){ // nonmagnetic region
-                        amrex::Real mu_arrz = CoarsenIO::Interp( mu_arr, mu_stag, Hz_stag, macro_cr, i, j, k, 0);
-                        Hz(i, j, k) = Hz_old(i, j, k) + 1. / mu_arrz * dt * (T_Algo::UpwardDy(Ex, coefs_y, n_coefs_y, i, j, k)
-                                                                           - T_Algo::UpwardDx(Ey, coefs_x, n_coefs_x, i, j, k));
-                    } else if (mag_Ms_zface_arr(i,j,k) > 0){ // magnetic region
-                        Hz(i, j, k) = Hz_old(i, j, k) + mu0_inv * dt * (T_Algo::UpwardDy(Ex, coefs_y, n_coefs_y, i, j, k)
-                                                                      - T_Algo::UpwardDx(Ey, coefs_x, n_coefs_x, i, j, k));
-                        if (coupling == 1){
-                            Hz(i, j, k) += - M_zface(i, j, k, 2) + M_zface_old(i, j, k, 2);
-                        }
+#ifdef AMREX_USE_EB
+                    // faces fully covered by the embedded boundary are never stepped
+                    if (Sz.p != nullptr && Sz(i, j, k) <= 0) return;
+                    // with the ECT solver, the conformal circulation of E replaces the Yee curl
+                    amrex::Real const minus_curlE_z = (ect_z.p != nullptr) ? ect_z(i, j, k) :
+#else
+                    amrex::Real const minus_curlE_z =
+#endif
+                        T_Algo::UpwardDy(Ex, coefs_y, n_coefs_y, i, j, k) - T_Algo::UpwardDx(Ey, coefs_x, n_coefs_x, i, j, k);
+
+                    // 1/mu0 on the magnetic faces (Ms > 0) and 1/mu elsewhere
+                    Hz(i, j, k) = Hz_old(i, j, k) + inv_mu_z(i, j, k) * dt * minus_curlE_z;
+                    if (coupling == 1 && magnetic_box && mag_Ms_zface_arr(i,j,k) > 0._rt) { // magnetic region
+                        Hz(i, j, k) += - M_zface(i, j, k, 2) + M_zface_old(i, j, k, 2);
                     }
                 }
 
             );
         }
+        ABLASTR_KERNEL_RANGE_END("LLG_2nd::UpdateH");
+        // the guard cells of H must be exchanged again by the next iteration (skip_clean_fill_boundary)
+        warpx.MarkFieldModified(WarpX::tracked_H);
 
         // Check the error between Mfield and Mfield_prev and decide whether another iteration is needed
+        // Once the error has decreased over consecutive checks, it is only checked every M_check_interval iterations
+        bool const check_now = (M_check_interval <= 1) || (n_contraction < 2) || ((M_iter + 1) % M_check_interval == 0);
         amrex::Real M_iter_maxerror = -1._rt;
-        for (int iface = 0; iface < 3; iface++){
-            for (int jcomp = 0; jcomp < 3; jcomp++){
-                Real M_iter_error = Mfield_error[iface]->norm0(jcomp);
-                if (M_iter_error >= M_iter_maxerror){
-                    M_iter_maxerror = M_iter_error;
-                }
+        amrex::Real M_iter_local_maxerror = 0._rt;
+        if (check_now){
+            // local maxima of the M update above (the lowest Real and int if no M was updated on this rank)
+            ReduceTuple const M_iter_local = reduce_data.value();
+            M_iter_local_maxerror = amrex::max(amrex::get<0>(M_iter_local), 0._rt);
+            // abort on the host if |M| violated mag_normalized_error anywhere. The checked iterations
+            // include the last one, so that the converged M is always checked
+            macroscopic_properties->CheckMagNormalizationFlag(amrex::get<1>(M_iter_local));
+        }
+        if (check_now && fused_update == 1){
+            // the local maximum was computed by the M update above, only one MPI reduction is needed
+            M_iter_maxerror = M_iter_local_maxerror;
+            amrex::ParallelDescriptor::ReduceRealMax(M_iter_maxerror);
+        }
+        else if (check_now) {
+            // compute the local maxima of the nine face/component errors in one pass, and reduce them together
+            amrex::ReduceOps<amrex::ReduceOpMax, amrex::ReduceOpMax, amrex::ReduceOpMax> reduce_error_op;
+            amrex::ReduceData<amrex::Real, amrex::Real, amrex::Real> reduce_error_xface(reduce_error_op);
+            amrex::ReduceData<amrex::Real, amrex::Real, amrex::Real> reduce_error_yface(reduce_error_op);
+            amrex::ReduceData<amrex::Real, amrex::Real, amrex::Real> reduce_error_zface(reduce_error_op);
+            using ErrorTuple = typename decltype(reduce_error_xface)::Type;
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#endif
+            for (MFIter mfi(*Mfield[0], TilingIfNotGPU()); mfi.isValid(); ++mfi){
+                // skip the boxes that do not contain any magnetic material
+                if (!macroscopic_properties->has_magnetic_material(mfi.index())) continue;
+                int const iscratch = LLGScratchIndex(mfi.index());
+
+                Array4<Real const> const &M_error_xface = Mfield_error[0]->const_array(iscratch);
+                Array4<Real const> const &M_error_yface = Mfield_error[1]->const_array(iscratch);
+                Array4<Real const> const &M_error_zface = Mfield_error[2]->const_array(iscratch);
+                Box const &tbx = mfi.tilebox(Mfield[0]->ixType().toIntVect());
+                Box const &tby = mfi.tilebox(Mfield[1]->ixType().toIntVect());
+                Box const &tbz = mfi.tilebox(Mfield[2]->ixType().toIntVect());
+
+                reduce_error_op.eval(tbx, reduce_error_xface,
+                    [=] AMREX_GPU_DEVICE(int i, int j, int k) -> ErrorTuple {
+                        return {M_error_xface(i, j, k, 0), M_error_xface(i, j, k, 1), M_error_xface(i, j, k, 2)};
+                    });
+                reduce_error_op.eval(tby, reduce_error_yface,
+                    [=] AMREX_GPU_DEVICE(int i, int j, int k) -> ErrorTuple {
+                        return {M_error_yface(i, j, k, 0), M_error_yface(i, j, k, 1), M_error_yface(i, j, k, 2)};
+                    });
+                reduce_error_op.eval(tbz, reduce_error_zface,
+                    [=] AMREX_GPU_DEVICE(int i, int j, int k) -> ErrorTuple {
+                        return {M_error_zface(i, j, k, 0), M_error_zface(i, j, k, 1), M_error_zface(i, j, k, 2)};
+                    });
+            }
+
+            ErrorTuple const error_xface = reduce_error_xface.value();
+            ErrorTuple const error_yface = reduce_error_yface.value();
+            ErrorTuple const error_zface = reduce_error_zface.value();
+            amrex::Real M_iter_error[9] = {amrex::get<0>(error_xface), amrex::get<1>(error_xface), amrex::get<2>(error_xface),
+                                           amrex::get<0>(error_yface), amrex::get<1>(error_yface), amrex::get<2>(error_yface),
+                                           amrex::get<0>(error_zface), amrex::get<1>(error_zface), amrex::get<2>(error_zface)};
+            amrex::ParallelDescriptor::ReduceRealMax(M_iter_error, 9);
+            for (int n = 0; n < 9; n++){
+                M_iter_maxerror = amrex::max(M_iter_maxerror, M_iter_error[n]);
             }
         }
 
-        if (M_iter_maxerror <= M_tol){
+        // contraction ratio of the error between the previous and this iteration, if both were checked
+        amrex::Real M_iter_ratio = -1._rt;
+        if (check_now){
+            if (M_iter_prev_check == M_iter - 1 && M_iter_prev_maxerror > 0._rt) {
+                M_iter_ratio = M_iter_maxerror / M_iter_prev_maxerror;
+            }
+            // track how many consecutive checks have shown a contraction of the error
+            n_contraction = (M_iter_prev_maxerror >= 0._rt && M_iter_maxerror < M_iter_prev_maxerror) ? n_contraction + 1 : 0;
+            M_iter_prev_maxerror = M_iter_maxerror;
+            M_iter_prev_check = M_iter;
+        }
+
+        if (check_now) M_iter_last_maxerror = M_iter_maxerror;
+
+        if (check_now && M_iter_maxerror <= M_tol){
 
             stop_iter = 1;
 
             // normalize M
             if (M_normalization == 2){
 
+                amrex::ReduceOps<amrex::ReduceOpMax> reduce_norm_op;
+                amrex::ReduceData<amrex::Real> reduce_norm_data(reduce_norm_op);
+                using NormTuple = typename decltype(reduce_norm_data)::Type;
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#endif
                 for (MFIter mfi(*Mfield[0], TilingIfNotGPU()); mfi.isValid(); ++mfi){
+                    // skip the boxes that do not contain any magnetic material
+                    if (!macroscopic_properties->has_magnetic_material(mfi.index())) continue;
 
                     auto& mag_Ms_xface_mf = macroscopic_properties->getmag_Ms_mf(0);
                     auto& mag_Ms_yface_mf = macroscopic_properties->getmag_Ms_mf(1);
@@ -1018,76 +1465,118 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian_2nd(
                     Box const &tby = mfi.tilebox(Myface_stag);
                     Box const &tbz = mfi.tilebox(Mzface_stag);
 
-                    // loop over cells and update fields
-                    amrex::ParallelFor(tbx, tby, tbz,
-                        [=] AMREX_GPU_DEVICE(int i, int j, int k) {
+                    // loop over cells, normalize M and reduce the deviation of |M| from Ms
+                    reduce_norm_op.eval(tbx, reduce_norm_data,
+                        [=] AMREX_GPU_DEVICE(int i, int j, int k) -> NormTuple {
 
+                            amrex::Real deviation = 0._rt;
                             if (mag_Ms_xface_arr(i,j,k) > 0._rt){
                                 // temporary normalized magnitude of M_xface field at the fixed point
                                 // re-investigate the way we do Ms interp, in case we encounter the case where Ms changes across two adjacent cells that you are doing interp
-                                amrex::Real M_magnitude_normalized = std::sqrt(std::pow(M_xface(i, j, k, 0), 2._rt) + std::pow(M_xface(i, j, k, 1), 2._rt) +
-                                                                               std::pow(M_xface(i, j, k, 2), 2._rt)) /
+                                amrex::Real M_magnitude_normalized = std::sqrt(M_xface(i, j, k, 0)*M_xface(i, j, k, 0) + M_xface(i, j, k, 1)*M_xface(i, j, k, 1) +
+                                                                               M_xface(i, j, k, 2)*M_xface(i, j, k, 2)) /
                                                                      mag_Ms_xface_arr(i,j,k);
 
-                                // check the normalized error
-                                if (amrex::Math::abs(1._rt - M_magnitude_normalized) > mag_normalized_error){
-                                    amrex::Abort("Exceed the normalized error of the M_xface field");
-                                }
                                 // normalize the M_xface field
                                 M_xface(i, j, k, 0) /= M_magnitude_normalized;
                                 M_xface(i, j, k, 1) /= M_magnitude_normalized;
                                 M_xface(i, j, k, 2) /= M_magnitude_normalized;
+                                deviation = amrex::Math::abs(1._rt - M_magnitude_normalized);
                             }
-                        },
+                            return {deviation};
+                        });
 
-                        [=] AMREX_GPU_DEVICE(int i, int j, int k) {
+                    reduce_norm_op.eval(tby, reduce_norm_data,
+                        [=] AMREX_GPU_DEVICE(int i, int j, int k) -> NormTuple {
 
+                            amrex::Real deviation = 0._rt;
                             if (mag_Ms_yface_arr(i,j,k) > 0._rt){
                                 // temporary normalized magnitude of M_yface field at the fixed point
                                 // re-investigate the way we do Ms interp, in case we encounter the case where Ms changes across two adjacent cells that you are doing interp
-                                amrex::Real M_magnitude_normalized = std::sqrt(std::pow(M_yface(i, j, k, 0), 2._rt) + std::pow(M_yface(i, j, k, 1), 2._rt) +
-                                                                               std::pow(M_yface(i, j, k, 2), 2._rt)) /
+                                amrex::Real M_magnitude_normalized = std::sqrt(M_yface(i, j, k, 0)*M_yface(i, j, k, 0) + M_yface(i, j, k, 1)*M_yface(i, j, k, 1) +
+                                                                               M_yface(i, j, k, 2)*M_yface(i, j, k, 2)) /
                                                                      mag_Ms_yface_arr(i,j,k);
 
-                                // check the normalized error
-                                if (amrex::Math::abs(1._rt - M_magnitude_normalized) > mag_normalized_error){
-                                    amrex::Abort("Exceed the normalized error of the M_yface field");
-                                }
                                 // normalize the M_yface field
                                 M_yface(i, j, k, 0) /= M_magnitude_normalized;
                                 M_yface(i, j, k, 1) /= M_magnitude_normalized;
                                 M_yface(i, j, k, 2) /= M_magnitude_normalized;
+                                deviation = amrex::Math::abs(1._rt - M_magnitude_normalized);
                             }
-                        },
+                            return {deviation};
+                        });
 
-                        [=] AMREX_GPU_DEVICE(int i, int j, int k) {
+                    reduce_norm_op.eval(tbz, reduce_norm_data,
+                        [=] AMREX_GPU_DEVICE(int i, int j, int k) -> NormTuple {
 
+                            amrex::Real deviation = 0._rt;
                             if (mag_Ms_zface_arr(i,j,k) > 0._rt){
                                 // temporary normalized magnitude of M_zface field at the fixed point
                                 // re-investigate the way we do Ms interp, in case we encounter the case where Ms changes across two adjacent cells that you are doing interp
-                                amrex::Real M_magnitude_normalized = std::sqrt(std::pow(M_zface(i, j, k, 0), 2._rt) + std::pow(M_zface(i, j, k, 1), 2._rt) +
-                                                                               std::pow(M_zface(i, j, k, 2), 2._rt)) /
+                                amrex::Real M_magnitude_normalized = std::sqrt(M_zface(i, j, k, 0)*M_zface(i, j, k, 0) + M_zface(i, j, k, 1)*M_zface(i, j, k, 1) +
+                                                                               M_zface(i, j, k, 2)*M_zface(i, j, k, 2)) /
                                                                      mag_Ms_zface_arr(i,j,k);
 
-                                // check the normalized error
-                                if (amrex::Math::abs(1. - M_magnitude_normalized) > mag_normalized_error){
-                                    amrex::Abort("Exceed the normalized error of the M_zface field");
-                                }
                                 // normalize the M_zface field
                                 M_zface(i, j, k, 0) /= M_magnitude_normalized;
                                 M_zface(i, j, k, 1) /= M_magnitude_normalized;
                                 M_zface(i, j, k, 2) /= M_magnitude_normalized;
+                                deviation = amrex::Math::abs(1._rt - M_magnitude_normalized);
                             }
+                            return {deviation};
                         });
                 }
+                M_norm_deviation = amrex::max(amrex::get<0>(reduce_norm_data.value()), 0._rt);
+                // abort on the host if |M| violated mag_normalized_error anywhere before the normalization
+                macroscopic_properties->CheckMagNormalizationFlag((M_norm_deviation > mag_normalized_error) ?
+                    MacroscopicProperties::mag_norm_exceeded : MacroscopicProperties::mag_norm_ok);
+                amrex::ParallelDescriptor::ReduceRealMax(M_norm_deviation);
             }
         }
         else{
+            // For a linearly converging iteration M_k = M* + rho^k e, the fixed point is
+            // M* = M_k + rho/(1-rho) (M_k - M_(k-1)), with rho estimated from the max-norm errors.
+            // M_(k-1) is still in Mfield_prev, so that no additional work array is needed
+            if (iter_acceleration == 1 && M_iter_ratio > 0._rt && M_iter_ratio < aitken_max_ratio){
+                amrex::Real const aitken_coeff = M_iter_ratio / (1._rt - M_iter_ratio);
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#endif
+                for (MFIter mfi(*Mfield[0], TilingIfNotGPU()); mfi.isValid(); ++mfi){
+                    // skip the boxes that do not contain any magnetic material
+                    if (!macroscopic_properties->has_magnetic_material(mfi.index())) continue;
+                    int const iscratch = LLGScratchIndex(mfi.index());
+
+                    Array4<Real> const& M_xface = Mfield[0]->array(mfi);
+                    Array4<Real> const& M_yface = Mfield[1]->array(mfi);
+                    Array4<Real> const& M_zface = Mfield[2]->array(mfi);
+                    Array4<Real const> const& M_prev_xface = Mfield_prev[0]->const_array(iscratch);
+                    Array4<Real const> const& M_prev_yface = Mfield_prev[1]->const_array(iscratch);
+                    Array4<Real const> const& M_prev_zface = Mfield_prev[2]->const_array(iscratch);
+
+                    Box const &tbx = mfi.tilebox(Mfield[0]->ixType().toIntVect());
+                    Box const &tby = mfi.tilebox(Mfield[1]->ixType().toIntVect());
+                    Box const &tbz = mfi.tilebox(Mfield[2]->ixType().toIntVect());
+
+                    amrex::ParallelFor(tbx, 3, [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) {
+                        M_xface(i, j, k, n) += aitken_coeff * (M_xface(i, j, k, n) - M_prev_xface(i, j, k, n));
+                    });
+                    amrex::ParallelFor(tby, 3, [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) {
+                        M_yface(i, j, k, n) += aitken_coeff * (M_yface(i, j, k, n) - M_prev_yface(i, j, k, n));
+                    });
+                    amrex::ParallelFor(tbz, 3, [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) {
+                        M_zface(i, j, k, n) += aitken_coeff * (M_zface(i, j, k, n) - M_prev_zface(i, j, k, n));
+                    });
+                }
+                // the error of the next iteration is not comparable to this one
+                M_iter_prev_check = -1;
+            }
+
             const auto& period = warpx.Geom(lev).periodicity();
             // Copy Mfield to Mfield_previous and fill periodic/interior ghost cells
             for (int i = 0; i < 3; i++){
-                MultiFab::Copy(*Mfield_prev[i], *Mfield[i], 0, 0, 3, Mfield[i]->nGrow());
-                (*Mfield_prev[i]).FillBoundary(Mfield[i]->nGrowVect(), period);
+                CopyToLLGScratch(*Mfield_prev[i], *Mfield[i]);
+                (*Mfield_prev[i]).FillBoundary(ng_LLG, period);
             }
         }
 
@@ -1097,77 +1586,25 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian_2nd(
         }
         else{
             M_iter++;
-            amrex::Print() << "Finish " << M_iter << " times iteration with M_iter_maxerror = " << M_iter_maxerror << " and M_tol = " << M_tol << std::endl;
+            if (check_now){
+                amrex::Print() << "Finish " << M_iter << " times iteration with M_iter_maxerror = " << M_iter_maxerror << " and M_tol = " << M_tol << std::endl;
+            } else {
+                amrex::Print() << "Finish " << M_iter << " times iteration without convergence check" << std::endl;
+            }
         }
 
     } // end the iteration
 
-    // update B
-    for (MFIter mfi(*Bfield[0], TilingIfNotGPU()); mfi.isValid(); ++mfi){
-
-        auto& mag_Ms_xface_mf = macroscopic_properties->getmag_Ms_mf(0);
-        auto& mag_Ms_yface_mf = macroscopic_properties->getmag_Ms_mf(1);
-        auto& mag_Ms_zface_mf = macroscopic_properties->getmag_Ms_mf(2);
+    amrex::Real const wt = static_cast<amrex::Real>(amrex::second()) - wt_start;
+    m_llg_stats.num_solves++;
+    m_llg_stats.iter_total += M_iter;
+    m_llg_stats.iter_max = amrex::max(m_llg_stats.iter_max, M_iter);
+    m_llg_stats.maxerror = M_iter_last_maxerror;
+    m_llg_stats.time += wt;
+    m_llg_stats.norm_deviation = amrex::max(m_llg_stats.norm_deviation, M_norm_deviation);
 
-        // Extract field data for this grid/tile
-        Array4<Real> const& mag_Ms_xface_arr = mag_Ms_xface_mf.array(mfi);
-        Array4<Real> const& mag_Ms_yface_arr = mag_Ms_yface_mf.array(mfi);
-        Array4<Real> const& mag_Ms_zface_arr = mag_Ms_zface_mf.array(mfi);
-        Array4<Real> const &Hx = Hfield[0]->array(mfi);
-        Array4<Real> const &Hy = Hfield[1]->array(mfi);
-        Array4<Real> const &Hz = Hfield[2]->array(mfi);
-        Array4<Real> const &Bx = Bfield[0]->array(mfi);
-        Array4<Real> const &By = Bfield[1]->array(mfi);
-        Array4<Real> const &Bz = Bfield[2]->array(mfi);
-        Array4<Real> const &M_xface = Mfield[0]->array(mfi); // note M_xface include x,y,z components at |_x faces
-        Array4<Real> const &M_yface = Mfield[1]->array(mfi); // note M_yface include x,y,z components at |_y faces
-        Array4<Real> const &M_zface = Mfield[2]->array(mfi); // note M_zface include x,y,z components at |_z faces
-
-        // Extract tileboxes for which to loop
-        amrex::IntVect Bxnodal = Bfield[0]->ixType().toIntVect();
-        amrex::IntVect Bynodal = Bfield[1]->ixType().toIntVect();
-        amrex::IntVect Bznodal = Bfield[2]->ixType().toIntVect();
-        Box const &tbx = mfi.tilebox(Bxnodal);
-        Box const &tby = mfi.tilebox(Bynodal);
-        Box const &tbz = mfi.tilebox(Bznodal);
-
-        amrex::Array4<amrex::Real> const& mu_arr = mu_mf.array(mfi);
-
-        // Loop over the cells and update the fields
-        amrex::ParallelFor(tbx, tby, tbz,
-
-            [=] AMREX_GPU_DEVICE(int i, int j, int k) {
-
-                if (mag_Ms_xface_arr(i,j,k) == 0._rt){ // nonmagnetic region
-                    amrex::Real mu_arrx = CoarsenIO::Interp( mu_arr, mu_stag, Bx_stag, macro_cr, i, j, k, 0);
-                    Bx(i, j, k) = mu_arrx * Hx(i, j, k);
-                } else if (mag_Ms_xface_arr(i,j,k) > 0){
-                    Bx(i, j, k) = PhysConst::mu0 * (M_xface(i, j, k, 0) + Hx(i, j, k));
-                }
-            },
-
-            [=] AMREX_GPU_DEVICE(int i, int j, int k) {
-
-                if (mag_Ms_yface_arr(i,j,k) == 0._rt){ // nonmagnetic region
-                    amrex::Real mu_arry = CoarsenIO::Interp( mu_arr, mu_stag, By_stag, macro_cr, i, j, k, 0);
-                    By(i, j, k) =  mu_arry * Hy(i, j, k);
-                } else if (mag_Ms_yface_arr(i,j,k) > 0){
-                    By(i, j, k) = PhysConst::mu0 * (M_yface(i, j, k, 1) + Hy(i, j, k));
-                }
-            },
-
-            [=] AMREX_GPU_DEVICE(int i, int j, int k) {
-
-                if (mag_Ms_zface_arr(i,j,k) == 0._rt){ // nonmagnetic region
-                    amrex::Real mu_arrz = CoarsenIO::Interp( mu_arr, mu_stag, Bz_stag, macro_cr, i, j, k, 0);
-                    Bz(i, j, k) = mu_arrz * Hz(i, j, k);
-                } else if (mag_Ms_zface_arr(i,j,k) > 0){
-                    Bz(i, j, k) = PhysConst::mu0 * (M_zface(i, j, k, 2) + Hz(i, j, k));
-                }
-            }
-
-        );
-    }
+    m_llg_iter_total += M_iter;
+    m_llg_num_solves++;
 }
 #endif // ifdef WARPX_MAG_LLG
 #endif // ifndef WARPX_DIM_RZ
@@ -1,6 +1,12 @@
 #include "MacroscopicProperties.H"
+#include "MagInterlayerCoupling.H"
+#include "MagSpinTorque.H"
+#include "MagThermalField.H"
 
+#include "Utils/MemoryFootprint.H"
+#include "Utils/StaticDataMemory.H"
 #include "Utils/TextMsg.H"
+#include "Utils/WarpXConst.H"
 #include "Utils/WarpXUtil.H"
 #include "WarpX.H"
 
@@ -10,26 +16,62 @@
 #include <AMReX_DistributionMapping.H>
 #include <AMReX_Geometry.H>
 #include <AMReX_GpuLaunch.H>
+#include <AMReX_IArrayBox.H>
 #include <AMReX_IndexType.H>
 #include <AMReX_IntVect.H>
 #include <AMReX_MFIter.H>
+#include <AMReX_ParallelDescriptor.H>
 #include <AMReX_ParmParse.H>
 #include <AMReX_Print.H>
 #include <AMReX_RealBox.H>
+#include <AMReX_Reduce.H>
+#include <AMReX_Utility.H>
+#include <AMReX_VisMF.H>
 #include <AMReX_Parser.H>
+#include <AMReX_PlotFileUtil.H>
 
 #include <AMReX_BaseFwd.H>
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
 #include <memory>
 #include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
 
 using namespace amrex;
 
+namespace
+{
+    /** Re-define mf on ba, converted to the index type of mf, and dm, and copy its values,
+     *  including those of the guard cells, in which the properties are also defined */
+    template <typename MF>
+    void RemakeProperty (std::unique_ptr<MF>& mf, amrex::BoxArray const& ba,
+                         amrex::DistributionMapping const& dm)
+    {
+        if (mf == nullptr) return;
+        const amrex::IntVect ng = mf->nGrowVect();
+        auto pmf = std::make_unique<MF>(amrex::convert(ba, mf->ixType()), dm, mf->nComp(), ng,
+                                        amrex::MFInfo().SetArena(mf->arena()));
+        // the guard cells first, then the valid cells, which take precedence where they overlap
+        pmf->ParallelCopy(*mf, 0, 0, mf->nComp(), ng, ng);
+        pmf->ParallelCopy(*mf, 0, 0, mf->nComp(), amrex::IntVect(0), ng);
+        mf = std::move(pmf);
+    }
+}
+
 MacroscopicProperties::MacroscopicProperties ()
 {
     ReadParameters();
 }
 
+// the destructor of the members of forward-declared types is defined here
+MacroscopicProperties::~MacroscopicProperties () = default;
+
 void
 MacroscopicProperties::ReadParameters ()
 {
@@ -39,6 +81,114 @@ MacroscopicProperties::ReadParameters ()
     // The vacuum values are used as default for the macroscopic parameters
     // with a warning message to the user to indicate that no value was specified.
 
+    // material-ID mode: the properties are given for each material of macroscopic.material_names,
+    // and looked up from the material index given by macroscopic.material_id_function(x,y,z)
+    pp_macroscopic.queryarr("material_names", m_material_names);
+    if (use_material_id()) {
+        // the material indices are read from a voxel file, or else given by a parser
+        pp_macroscopic.query("material_id_file", m_material_id_file);
+        if (m_material_id_file.empty()) {
+            Store_parserString(pp_macroscopic, "material_id_function(x,y,z)", m_str_material_id_function);
+            m_material_id_parser = std::make_unique<amrex::Parser>(
+                                     makeParser(m_str_material_id_function,{"x","y","z"}));
+        }
+
+        const int nmat = m_material_names.size();
+        amrex::Vector<amrex::Real> h_material_table(mat_nprops * nmat, 0._rt);
+        for (int id = 0; id < nmat; ++id) {
+            // the properties of each material default to the vacuum, non-magnetic values
+            ParmParse pp_material("macroscopic." + m_material_names[id]);
+            amrex::Real sigma = 0._rt, epsilon = PhysConst::ep0, mu = PhysConst::mu0;
+            queryWithParser(pp_material, "sigma", sigma);
+            queryWithParser(pp_material, "epsilon", epsilon);
+            queryWithParser(pp_material, "mu", mu);
+            h_material_table[mat_sigma * nmat + id] = sigma;
+            h_material_table[mat_epsilon * nmat + id] = epsilon;
+            h_material_table[mat_mu * nmat + id] = mu;
+#ifdef WARPX_MAG_LLG
+            amrex::Real Ms = 0._rt, alpha = 0._rt, gamma = 0._rt, exchange = 0._rt, anisotropy = 0._rt, DMI = 0._rt;
+            queryWithParser(pp_material, "mag_Ms", Ms);
+            queryWithParser(pp_material, "mag_alpha", alpha);
+            queryWithParser(pp_material, "mag_gamma", gamma);
+            queryWithParser(pp_material, "mag_exchange", exchange);
+            queryWithParser(pp_material, "mag_anisotropy", anisotropy);
+            queryWithParser(pp_material, "mag_DMI", DMI);
+            h_material_table[mat_mag_Ms * nmat + id] = Ms;
+            h_material_table[mat_mag_alpha * nmat + id] = alpha;
+            h_material_table[mat_mag_gamma * nmat + id] = gamma;
+            h_material_table[mat_mag_exchange * nmat + id] = exchange;
+            h_material_table[mat_mag_anisotropy * nmat + id] = anisotropy;
+            h_material_table[mat_mag_DMI * nmat + id] = DMI;
+#endif
+            // single-pole dispersion, a2 d2P/dt2 + a1 dP/dt + a0 P = b0 E, solved with the
+            // E update, see FiniteDifferenceSolver::ComputeDispersionCoefs
+            std::string dispersion = "none";
+            pp_material.query("dispersion", dispersion);
+            amrex::Real a0 = 0._rt, a1 = 0._rt, a2 = 0._rt, b0 = 0._rt;
+            if (dispersion == "drude") {
+                amrex::Real omega_p = 0._rt, gamma_d = 0._rt;
+                getWithParser(pp_material, "omega_p", omega_p);
+                queryWithParser(pp_material, "gamma", gamma_d);
+                a1 = gamma_d;
+                a2 = 1._rt;
+                b0 = PhysConst::ep0 * omega_p * omega_p;
+            } else if (dispersion == "lorentz") {
+                amrex::Real delta_epsilon = 0._rt, omega_0 = 0._rt, gamma_d = 0._rt;
+                getWithParser(pp_material, "delta_epsilon", delta_epsilon);
+                getWithParser(pp_material, "omega_0", omega_0);
+                queryWithParser(pp_material, "gamma", gamma_d);
+                a0 = omega_0 * omega_0;
+                a1 = gamma_d;
+                a2 = 1._rt;
+                b0 = PhysConst::ep0 * delta_epsilon * omega_0 * omega_0;
+            } else if (dispersion == "debye") {
+                amrex::Real delta_epsilon = 0._rt, tau = 0._rt;
+                getWithParser(pp_material, "delta_epsilon", delta_epsilon);
+                getWithParser(pp_material, "tau", tau);
+                WARPX_ALWAYS_ASSERT_WITH_MESSAGE(tau > 0._rt,
+                    "macroscopic." + m_material_names[id] + ".tau must be positive");
+                a0 = 1._rt;
+                a1 = tau;
+                b0 = PhysConst::ep0 * delta_epsilon;
+            } else if (dispersion != "none") {
+                amrex::Abort(Utils::TextMsg::Err(
+                    "macroscopic." + m_material_names[id] + ".dispersion must be none, drude, lorentz or debye"));
+            }
+            WARPX_ALWAYS_ASSERT_WITH_MESSAGE(a1 >= 0._rt,
+                "macroscopic." + m_material_names[id] + ".gamma must be non-negative");
+            h_material_table[mat_disp_a0 * nmat + id] = a0;
+            h_material_table[mat_disp_a1 * nmat + id] = a1;
+            h_material_table[mat_disp_a2 * nmat + id] = a2;
+            h_material_table[mat_disp_b0 * nmat + id] = b0;
+            if (b0 != 0._rt) m_has_dispersion = true;
+
+            // surface impedance of a good conductor, whose skin depth is not resolved: the surface
+            // resistance Rs = sqrt(pi f mu / sigma) at the frequency f of interest
+            int surface_impedance = 0;
+            pp_material.query("surface_impedance", surface_impedance);
+            amrex::Real Rs = 0._rt;
+            if (surface_impedance == 1) {
+                amrex::Real frequency = 0._rt;
+                getWithParser(pp_material, "surface_impedance_frequency", frequency);
+                WARPX_ALWAYS_ASSERT_WITH_MESSAGE(sigma > 0._rt && frequency > 0._rt,
+                    "macroscopic." + m_material_names[id] + ".surface_impedance = 1 requires positive "
+                    "sigma and surface_impedance_frequency");
+                WARPX_ALWAYS_ASSERT_WITH_MESSAGE(b0 == 0._rt,
+                    "macroscopic." + m_material_names[id] + " cannot be both dispersive and a surface impedance");
+                Rs = std::sqrt(MathConst::pi * frequency * mu / sigma);
+                m_has_surface_impedance = true;
+            }
+            h_material_table[mat_sibc_Rs * nmat + id] = Rs;
+        }
+        m_material_table.resize(h_material_table.size());
+        amrex::Gpu::copyAsync(amrex::Gpu::hostToDevice, h_material_table.begin(), h_material_table.end(),
+                              m_material_table.begin());
+        amrex::Gpu::streamSynchronize();
+
+        m_sigma_s = "material_id";
+        m_epsilon_s = "material_id";
+        m_mu_s = "material_id";
+    }
 
     // Query input for material conductivity, sigma.
     bool sigma_specified = false;
@@ -50,7 +200,13 @@ MacroscopicProperties::ReadParameters ()
         m_sigma_s = "parse_sigma_function";
         sigma_specified = true;
     }
-    if (!sigma_specified) {
+    if (pp_macroscopic.query("sigma_function(x,y,z,t)", m_str_sigma_function) ) {
+        m_sigma_s = "parse_sigma_function_t";
+        sigma_specified = true;
+    }
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(!(use_material_id() && sigma_specified),
+        "macroscopic.sigma cannot be combined with macroscopic.material_names");
+    if (!sigma_specified && !use_material_id()) {
         std::stringstream warnMsg;
         warnMsg << "Material conductivity is not specified. Using default vacuum value of " <<
             m_sigma << " in the simulation.";
@@ -63,6 +219,12 @@ MacroscopicProperties::ReadParameters ()
         m_sigma_parser = std::make_unique<amrex::Parser>(
                                  makeParser(m_str_sigma_function,{"x","y","z"}));
     }
+    // initialization of sigma with a parser of (x,y,z,t), updated during the simulation
+    if (m_sigma_s == "parse_sigma_function_t") {
+        Store_parserString(pp_macroscopic, "sigma_function(x,y,z,t)", m_str_sigma_function);
+        m_sigma_parser = std::make_unique<amrex::Parser>(
+                                 makeParser(m_str_sigma_function,{"x","y","z","t"}));
+    }
 
     bool epsilon_specified = false;
     if (queryWithParser(pp_macroscopic, "epsilon", m_epsilon)) {
@@ -73,7 +235,13 @@ MacroscopicProperties::ReadParameters ()
         m_epsilon_s = "parse_epsilon_function";
         epsilon_specified = true;
     }
-    if (!epsilon_specified) {
+    if (pp_macroscopic.query("epsilon_function(x,y,z,t)", m_str_epsilon_function) ) {
+        m_epsilon_s = "parse_epsilon_function_t";
+        epsilon_specified = true;
+    }
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(!(use_material_id() && epsilon_specified),
+        "macroscopic.epsilon cannot be combined with macroscopic.material_names");
+    if (!epsilon_specified && !use_material_id()) {
         std::stringstream warnMsg;
         warnMsg << "Material permittivity is not specified. Using default vacuum value of " <<
             m_epsilon << " in the simulation.";
@@ -87,6 +255,12 @@ MacroscopicProperties::ReadParameters ()
         m_epsilon_parser = std::make_unique<amrex::Parser>(
                                  makeParser(m_str_epsilon_function,{"x","y","z"}));
     }
+    // initialization of epsilon with a parser of (x,y,z,t), updated during the simulation
+    if (m_epsilon_s == "parse_epsilon_function_t") {
+        Store_parserString(pp_macroscopic, "epsilon_function(x,y,z,t)", m_str_epsilon_function);
+        m_epsilon_parser = std::make_unique<amrex::Parser>(
+                                 makeParser(m_str_epsilon_function,{"x","y","z","t"}));
+    }
 
     // Query input for material permeability, mu
     bool mu_specified = false;
@@ -98,7 +272,13 @@ MacroscopicProperties::ReadParameters ()
         m_mu_s = "parse_mu_function";
         mu_specified = true;
     }
-    if (!mu_specified) {
+    if (pp_macroscopic.query("mu_function(x,y,z,t)", m_str_mu_function) ) {
+        m_mu_s = "parse_mu_function_t";
+        mu_specified = true;
+    }
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(!(use_material_id() && mu_specified),
+        "macroscopic.mu cannot be combined with macroscopic.material_names");
+    if (!mu_specified && !use_material_id()) {
         std::stringstream warnMsg;
         warnMsg << "Material permittivity is not specified. Using default vacuum value of " <<
             m_mu << " in the simulation.";
@@ -112,224 +292,466 @@ MacroscopicProperties::ReadParameters ()
         m_mu_parser = std::make_unique<amrex::Parser>(
                                  makeParser(m_str_mu_function,{"x","y","z"}));
     }
+    // initialization of mu with a parser of (x,y,z,t), updated during the simulation
+    if (m_mu_s == "parse_mu_function_t") {
+        Store_parserString(pp_macroscopic, "mu_function(x,y,z,t)", m_str_mu_function);
+        m_mu_parser = std::make_unique<amrex::Parser>(
+                                 makeParser(m_str_mu_function,{"x","y","z","t"}));
+    }
+
+    // the properties given by functions of (x,y,z,t) are re-evaluated every properties_update_interval steps
+    queryWithParser(pp_macroscopic, "properties_update_interval", m_properties_update_interval);
+    queryWithParser(pp_macroscopic, "properties_time_probes", m_properties_time_probes);
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(m_properties_update_interval > 0 && m_properties_time_probes > 0,
+        "macroscopic.properties_update_interval and macroscopic.properties_time_probes must be positive");
 
 #ifdef WARPX_MAG_LLG
-    auto &warpx = WarpX::GetInstance();
-    pp_macroscopic.get("mag_Ms_init_style", m_mag_Ms_s);
-    if (m_mag_Ms_s == "constant") pp_macroscopic.get("mag_Ms", m_mag_Ms);
-    // _mag_ such that it's clear the Ms variable is only meaningful for magnetic materials
-    //initialization with parser
-    if (m_mag_Ms_s == "parse_mag_Ms_function") {
-        Store_parserString(pp_macroscopic, "mag_Ms_function(x,y,z)", m_str_mag_Ms_function);
-        m_mag_Ms_parser = std::make_unique<amrex::Parser>(
-                                  makeParser(m_str_mag_Ms_function,{"x","y","z"}));
-    }
-
-    pp_macroscopic.get("mag_alpha_init_style", m_mag_alpha_s);
-    if (m_mag_alpha_s == "constant") pp_macroscopic.get("mag_alpha", m_mag_alpha);
-    // _mag_ such that it's clear the alpha variable is only meaningful for magnetic materials
-    //initialization with parser
-    if (m_mag_alpha_s == "parse_mag_alpha_function") {
-        Store_parserString(pp_macroscopic, "mag_alpha_function(x,y,z)", m_str_mag_alpha_function);
-        m_mag_alpha_parser = std::make_unique<amrex::Parser>(
-                                  makeParser(m_str_mag_alpha_function,{"x","y","z"}));
-    }
-
-    pp_macroscopic.get("mag_gamma_init_style", m_mag_gamma_s);
-    if (m_mag_gamma_s == "constant") pp_macroscopic.get("mag_gamma", m_mag_gamma);
-    // _mag_ such that it's clear the gamma variable parsed here is only meaningful for magnetic materials
-    //initialization with parser
-    if (m_mag_gamma_s == "parse_mag_gamma_function") {
-        Store_parserString(pp_macroscopic, "mag_gamma_function(x,y,z)", m_str_mag_gamma_function);
-        m_mag_gamma_parser = std::make_unique<amrex::Parser>(
-                                  makeParser(m_str_mag_gamma_function,{"x","y","z"}));
-    }
-
-    if (warpx.mag_LLG_exchange_coupling == 1) { // spin exchange coupling turned off by default
-        pp_macroscopic.get("mag_exchange_init_style", m_mag_exchange_s);
-        if (m_mag_exchange_s == "constant") pp_macroscopic.get("mag_exchange", m_mag_exchange);
-        // _mag_ such that it's clear the exch variable is only meaningful for magnetic materials
+    if (WarpX::mag_LLG) {
+        auto &warpx = WarpX::GetInstance();
+        if (use_material_id()) m_mag_Ms_s = "material_id";
+        else pp_macroscopic.get("mag_Ms_init_style", m_mag_Ms_s);
+        if (m_mag_Ms_s == "constant") pp_macroscopic.get("mag_Ms", m_mag_Ms);
+        // _mag_ such that it's clear the Ms variable is only meaningful for magnetic materials
         //initialization with parser
-        if (m_mag_exchange_s == "parse_mag_exchange_function") {
-            Store_parserString(pp_macroscopic, "mag_exchange_function(x,y,z)", m_str_mag_exchange_function);
-            m_mag_exchange_parser = std::make_unique<amrex::Parser>(
-                                      makeParser(m_str_mag_exchange_function,{"x","y","z"}));
+        if (m_mag_Ms_s == "parse_mag_Ms_function") {
+            Store_parserString(pp_macroscopic, "mag_Ms_function(x,y,z)", m_str_mag_Ms_function);
+            m_mag_Ms_parser = std::make_unique<amrex::Parser>(
+                                      makeParser(m_str_mag_Ms_function,{"x","y","z"}));
         }
-    }
 
-    if (warpx.mag_LLG_anisotropy_coupling == 1) { // magnetic crystal is considered as isotropic by default
-        pp_macroscopic.get("mag_anisotropy_init_style", m_mag_anisotropy_s);
-        if (m_mag_anisotropy_s == "constant") pp_macroscopic.get("mag_anisotropy", m_mag_anisotropy);
-        // _mag_ such that it's clear the exch variable is only meaningful for magnetic materials
+        if (use_material_id()) m_mag_alpha_s = "material_id";
+        else pp_macroscopic.get("mag_alpha_init_style", m_mag_alpha_s);
+        if (m_mag_alpha_s == "constant") pp_macroscopic.get("mag_alpha", m_mag_alpha);
+        // _mag_ such that it's clear the alpha variable is only meaningful for magnetic materials
         //initialization with parser
-        if (m_mag_anisotropy_s == "parse_mag_anisotropy_function") {
-            Store_parserString(pp_macroscopic, "mag_anisotropy_function(x,y,z)", m_str_mag_anisotropy_function);
-            m_mag_anisotropy_parser = std::make_unique<amrex::Parser>(
-                                      makeParser(m_str_mag_anisotropy_function,{"x","y","z"}));
+        if (m_mag_alpha_s == "parse_mag_alpha_function") {
+            Store_parserString(pp_macroscopic, "mag_alpha_function(x,y,z)", m_str_mag_alpha_function);
+            m_mag_alpha_parser = std::make_unique<amrex::Parser>(
+                                      makeParser(m_str_mag_alpha_function,{"x","y","z"}));
         }
-    }
 
-    m_mag_normalized_error = 0.1;
-    pp_macroscopic.query("mag_normalized_error",m_mag_normalized_error);
+        if (use_material_id()) m_mag_gamma_s = "material_id";
+        else pp_macroscopic.get("mag_gamma_init_style", m_mag_gamma_s);
+        if (m_mag_gamma_s == "constant") pp_macroscopic.get("mag_gamma", m_mag_gamma);
+        // _mag_ such that it's clear the gamma variable parsed here is only meaningful for magnetic materials
+        //initialization with parser
+        if (m_mag_gamma_s == "parse_mag_gamma_function") {
+            Store_parserString(pp_macroscopic, "mag_gamma_function(x,y,z)", m_str_mag_gamma_function);
+            m_mag_gamma_parser = std::make_unique<amrex::Parser>(
+                                      makeParser(m_str_mag_gamma_function,{"x","y","z"}));
+        }
 
-    m_mag_max_iter = 100;
-    pp_macroscopic.query("mag_max_iter",m_mag_max_iter);
+        if (warpx.mag_LLG_exchange_coupling == 1) { // spin exchange coupling turned off by default
+            if (use_material_id()) m_mag_exchange_s = "material_id";
+            else pp_macroscopic.get("mag_exchange_init_style", m_mag_exchange_s);
+            if (m_mag_exchange_s == "constant") pp_macroscopic.get("mag_exchange", m_mag_exchange);
+            // _mag_ such that it's clear the exch variable is only meaningful for magnetic materials
+            //initialization with parser
+            if (m_mag_exchange_s == "parse_mag_exchange_function") {
+                Store_parserString(pp_macroscopic, "mag_exchange_function(x,y,z)", m_str_mag_exchange_function);
+                m_mag_exchange_parser = std::make_unique<amrex::Parser>(
+                                          makeParser(m_str_mag_exchange_function,{"x","y","z"}));
+            }
+        }
 
-    m_mag_tol = 0.0001;
-    pp_macroscopic.query("mag_tol",m_mag_tol);
+        if (warpx.mag_LLG_DMI_coupling == 1) { // no Dzyaloshinskii-Moriya interaction by default
+            std::string DMI_type = "interfacial";
+            pp_macroscopic.query("mag_DMI_type", DMI_type);
+            if (DMI_type == "interfacial") m_mag_DMI_type = 1;
+            else if (DMI_type == "bulk") m_mag_DMI_type = 2;
+            else amrex::Abort("macroscopic.mag_DMI_type must be interfacial or bulk");
+            if (use_material_id()) m_mag_DMI_s = "material_id";
+            else pp_macroscopic.get("mag_DMI_init_style", m_mag_DMI_s);
+            if (m_mag_DMI_s == "constant") pp_macroscopic.get("mag_DMI", m_mag_DMI);
+            //initialization with parser
+            if (m_mag_DMI_s == "parse_mag_DMI_function") {
+                Store_parserString(pp_macroscopic, "mag_DMI_function(x,y,z)", m_str_mag_DMI_function);
+                m_mag_DMI_parser = std::make_unique<amrex::Parser>(
+                                          makeParser(m_str_mag_DMI_function,{"x","y","z"}));
+            }
+        }
 
-    if (warpx.mag_LLG_anisotropy_coupling == 1) {
-        amrex::Vector<amrex::Real> mag_LLG_anisotropy_axis_parser(3,0.0);
-        // The anisotropy_axis for the anisotropy coupling term H_anisotropy in H_eff
-        pp_macroscopic.getarr("mag_LLG_anisotropy_axis", mag_LLG_anisotropy_axis_parser);
-        for (int i = 0; i < 3; i++) {
-            mag_LLG_anisotropy_axis[i] = mag_LLG_anisotropy_axis_parser[i];
+        if (warpx.mag_LLG_anisotropy_coupling == 1) { // magnetic crystal is considered as isotropic by default
+            if (use_material_id()) m_mag_anisotropy_s = "material_id";
+            else pp_macroscopic.get("mag_anisotropy_init_style", m_mag_anisotropy_s);
+            if (m_mag_anisotropy_s == "constant") pp_macroscopic.get("mag_anisotropy", m_mag_anisotropy);
+            // _mag_ such that it's clear the exch variable is only meaningful for magnetic materials
+            //initialization with parser
+            if (m_mag_anisotropy_s == "parse_mag_anisotropy_function") {
+                Store_parserString(pp_macroscopic, "mag_anisotropy_function(x,y,z)", m_str_mag_anisotropy_function);
+                m_mag_anisotropy_parser = std::make_unique<amrex::Parser>(
+                                          makeParser(m_str_mag_anisotropy_function,{"x","y","z"}));
+            }
         }
-    }
 
+        m_mag_normalized_error = 0.1;
+        pp_macroscopic.query("mag_normalized_error",m_mag_normalized_error);
+
+        m_mag_max_iter = 100;
+        pp_macroscopic.query("mag_max_iter",m_mag_max_iter);
+
+        m_mag_tol = 0.0001;
+        pp_macroscopic.query("mag_tol",m_mag_tol);
+
+        m_mag_fused_update = 1;
+        pp_macroscopic.query("mag_fused_update",m_mag_fused_update);
+
+        m_mag_check_interval = 1;
+        pp_macroscopic.query("mag_check_interval",m_mag_check_interval);
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(m_mag_check_interval >= 1,
+            "macroscopic.mag_check_interval must be at least 1");
+
+        m_mag_subdomain = 0;
+        pp_macroscopic.query("mag_subdomain",m_mag_subdomain);
+
+        m_mag_iter_acceleration = 0;
+        pp_macroscopic.query("mag_iter_acceleration",m_mag_iter_acceleration);
+
+        m_mag_overlap_comm = 0;
+        pp_macroscopic.query("mag_overlap_comm",m_mag_overlap_comm);
+
+        m_mag_LLG_subcycle = 0;
+        pp_macroscopic.query("mag_LLG_subcycle",m_mag_LLG_subcycle);
+        m_mag_LLG_subcycle_max = 10;
+        pp_macroscopic.query("mag_LLG_subcycle_max",m_mag_LLG_subcycle_max);
+        m_mag_LLG_subcycle_max_angle = 0.01;
+        pp_macroscopic.query("mag_LLG_subcycle_max_angle",m_mag_LLG_subcycle_max_angle);
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(m_mag_LLG_subcycle_max >= 1 && m_mag_LLG_subcycle_max_angle > 0._rt,
+            "macroscopic.mag_LLG_subcycle_max must be at least 1 and macroscopic.mag_LLG_subcycle_max_angle must be positive");
+
+        if (warpx.mag_LLG_anisotropy_coupling == 1) {
+            amrex::Vector<amrex::Real> mag_LLG_anisotropy_axis_parser(3,0.0);
+            // The anisotropy_axis for the anisotropy coupling term H_anisotropy in H_eff
+            pp_macroscopic.getarr("mag_LLG_anisotropy_axis", mag_LLG_anisotropy_axis_parser);
+            for (int i = 0; i < 3; i++) {
+                mag_LLG_anisotropy_axis[i] = mag_LLG_anisotropy_axis_parser[i];
+            }
+            std::string anisotropy_type = "uniaxial";
+            pp_macroscopic.query("mag_anisotropy_type", anisotropy_type);
+            if (anisotropy_type == "uniaxial") m_mag_anisotropy_type = 0;
+            else if (anisotropy_type == "cubic") m_mag_anisotropy_type = 1;
+            else amrex::Abort("macroscopic.mag_anisotropy_type must be uniaxial or cubic");
+            amrex::Vector<amrex::Real> axis2 {0., 1., 0.};
+            if (m_mag_anisotropy_type == 1) pp_macroscopic.getarr("mag_LLG_anisotropy_axis2", axis2);
+
+            // the axes of each grain: the materials may have their own (macroscopic.<name>.mag_anisotropy_axis
+            // and mag_anisotropy_axis2), the grain 0 has the global axes when there are no materials
+            const int ngrains = use_material_id() ? nmaterials() : 1;
+            amrex::Vector<amrex::Real> h_axes(9 * ngrains);
+            m_mag_has_grains = false;
+            for (int grain = 0; grain < ngrains; ++grain) {
+                amrex::Vector<amrex::Real> u(mag_LLG_anisotropy_axis_parser.begin(), mag_LLG_anisotropy_axis_parser.end());
+                amrex::Vector<amrex::Real> v = axis2;
+                if (use_material_id()) {
+                    ParmParse pp_material("macroscopic." + m_material_names[grain]);
+                    if (queryArrWithParser(pp_material, "mag_anisotropy_axis", u, 0, 3)) m_mag_has_grains = true;
+                    if (queryArrWithParser(pp_material, "mag_anisotropy_axis2", v, 0, 3)) m_mag_has_grains = true;
+                }
+                // the uniaxial axis is used as given; the cubic axes are made orthonormal,
+                // the third one is u x v
+                if (m_mag_anisotropy_type == 1) {
+                    amrex::Real const u_norm = std::sqrt(u[0]*u[0] + u[1]*u[1] + u[2]*u[2]);
+                    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(u_norm > 0._rt, "the cubic anisotropy axis must not be zero");
+                    for (auto& c : u) c /= u_norm;
+                }
+                if (m_mag_anisotropy_type == 1) {
+                    amrex::Real const u_dot_v = u[0]*v[0] + u[1]*v[1] + u[2]*v[2];
+                    for (int n = 0; n < 3; ++n) v[n] -= u_dot_v * u[n];
+                    amrex::Real const v_norm = std::sqrt(v[0]*v[0] + v[1]*v[1] + v[2]*v[2]);
+                    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(v_norm > 0._rt,
+                        "the second cubic anisotropy axis must not be parallel to the first one");
+                    for (auto& c : v) c /= v_norm;
+                }
+                for (int n = 0; n < 3; ++n) {
+                    h_axes[9*grain + n] = u[n];
+                    h_axes[9*grain + 3 + n] = v[n];
+                    h_axes[9*grain + 6 + n] = u[(n+1)%3] * v[(n+2)%3] - u[(n+2)%3] * v[(n+1)%3];
+                }
+            }
+            m_mag_anisotropy_axes.resize(h_axes.size());
+            amrex::Gpu::copyAsync(amrex::Gpu::hostToDevice, h_axes.begin(), h_axes.end(), m_mag_anisotropy_axes.begin());
+            amrex::Gpu::streamSynchronize();
+        }
+
+        if (warpx.mag_LLG_spin_torque_coupling == 1) {
+            // the spin polarization p, and the efficiency (spin polarization of the current for the
+            // spin-transfer torque, spin Hall angle for the spin-orbit torque) and thickness of the layer
+            amrex::Vector<amrex::Real> polarization(3, 0.0);
+            getArrWithParser(pp_macroscopic, "mag_spin_torque_polarization", polarization, 0, 3);
+            amrex::Real const p_norm = std::sqrt(polarization[0]*polarization[0] + polarization[1]*polarization[1]
+                                                 + polarization[2]*polarization[2]);
+            WARPX_ALWAYS_ASSERT_WITH_MESSAGE(p_norm > 0._rt,
+                "macroscopic.mag_spin_torque_polarization must be a non-zero vector");
+            for (int i = 0; i < 3; i++) m_mag_spin_torque_polarization[i] = polarization[i] / p_norm;
+            amrex::Real efficiency = 0._rt;
+            amrex::Real thickness = 0._rt;
+            getWithParser(pp_macroscopic, "mag_spin_torque_efficiency", efficiency);
+            getWithParser(pp_macroscopic, "mag_spin_torque_thickness", thickness);
+            WARPX_ALWAYS_ASSERT_WITH_MESSAGE(thickness > 0._rt,
+                "macroscopic.mag_spin_torque_thickness must be positive");
+            m_mag_spin_torque_coef = PhysConst::hbar * efficiency / (2._rt * PhysConst::q_e * PhysConst::mu0 * thickness);
+            queryWithParser(pp_macroscopic, "mag_spin_torque_field_like_ratio", m_mag_spin_torque_field_like_ratio);
+
+            // the current density is given by a function, or is the current density of the Maxwell solver
+            std::string current_style = "maxwell";
+            pp_macroscopic.query("mag_spin_torque_current_style", current_style);
+            if (current_style == "parse_mag_spin_torque_J_function") {
+                std::string str_J_function;
+                Store_parserString(pp_macroscopic, "mag_spin_torque_J_function(x,y,z,t)", str_J_function);
+                m_mag_spin_torque_J_parser = std::make_unique<amrex::Parser>(
+                                          makeParser(str_J_function, {"x","y","z","t"}));
+                m_mag_spin_torque_J_exe = m_mag_spin_torque_J_parser->compile<4>();
+            } else {
+                WARPX_ALWAYS_ASSERT_WITH_MESSAGE(current_style == "maxwell",
+                    "macroscopic.mag_spin_torque_current_style must be maxwell or parse_mag_spin_torque_J_function");
+                amrex::Vector<amrex::Real> direction = {0., 0., 1.};
+                queryArrWithParser(pp_macroscopic, "mag_spin_torque_current_direction", direction, 0, 3);
+                amrex::Real const d_norm = std::sqrt(direction[0]*direction[0] + direction[1]*direction[1]
+                                                     + direction[2]*direction[2]);
+                WARPX_ALWAYS_ASSERT_WITH_MESSAGE(d_norm > 0._rt,
+                    "macroscopic.mag_spin_torque_current_direction must be a non-zero vector");
+                for (int i = 0; i < 3; i++) m_mag_spin_torque_J_direction[i] = direction[i] / d_norm;
+            }
+        }
+
+        // stochastic thermal field, only with the 2nd-order scheme
+        queryWithParser(pp_macroscopic, "mag_LLG_temperature", m_mag_LLG_temperature);
+        pp_macroscopic.query("mag_LLG_thermal_seed", m_mag_LLG_thermal_seed);
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(m_mag_LLG_temperature >= 0._rt,
+            "macroscopic.mag_LLG_temperature must be non-negative");
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(m_mag_LLG_temperature == 0._rt || warpx.getmag_time_scheme_order() == 2,
+            "macroscopic.mag_LLG_temperature > 0 is only implemented with warpx.mag_time_scheme_order = 2");
+    }
 #endif
 }
 
 void
-MacroscopicProperties::InitData ()
+MacroscopicProperties::InitData (const int lev)
 {
     amrex::Print() << Utils::TextMsg::Info("we are in init data of macro");
     auto & warpx = WarpX::GetInstance();
     // Get BoxArray and DistributionMap of warpx instance.
-    int lev = 0;
+    m_lev = lev;
+    // the time-dependent properties are initialized at the current time, which is non-zero on restart
+    m_properties_time = warpx.gett_new(lev);
+    // InitData is called again to reset the properties modified in place
+    m_time_dependent_props.clear();
+    m_properties_modified = false;
+    ++m_properties_version;
     amrex::BoxArray ba = warpx.boxArray(lev);
     amrex::DistributionMapping dmap = warpx.DistributionMap(lev);
     const amrex::IntVect ng_EB_alloc = warpx.getngEB();
-    // Define material property multifabs using ba and dmap from WarpX instance
+    // Define material property multifabs using ba and dmap from WarpX instance,
+    // in the memory of the static data (warpx.static_data_memory)
     // sigma is cell-centered MultiFab
-    m_sigma_mf = std::make_unique<amrex::MultiFab>(ba, dmap, 1, ng_EB_alloc);
+    m_sigma_mf = std::make_unique<amrex::MultiFab>(ba, dmap, 1, ng_EB_alloc, StaticDataMFInfo());
     // epsilon is cell-centered MultiFab
-    m_eps_mf = std::make_unique<amrex::MultiFab>(ba, dmap, 1, ng_EB_alloc);
+    m_eps_mf = std::make_unique<amrex::MultiFab>(ba, dmap, 1, ng_EB_alloc, StaticDataMFInfo());
     // mu is cell-centered MultiFab
-    m_mu_mf = std::make_unique<amrex::MultiFab>(ba, dmap, 1, ng_EB_alloc);
+    m_mu_mf = std::make_unique<amrex::MultiFab>(ba, dmap, 1, ng_EB_alloc, StaticDataMFInfo());
+
+    // wall-clock time of the initialization of each spatially varying property, in the startup
+    // report if warpx.startup_report = 2 (otherwise the fills are not synchronized one by one)
+    auto report_init_time = [&warpx] (std::string const& name, amrex::Real t_start) {
+        warpx.StartupPhaseDetail(name, t_start);
+    };
+    amrex::Real t_start = amrex::second();
+
+    if (use_material_id()) {
+        InitializeMaterialID(lev);
+        report_init_time("the material indices", t_start);
+    }
 
     // Initialize sigma
+    t_start = amrex::second();
     if (m_sigma_s == "constant") {
 
         m_sigma_mf->setVal(m_sigma);
 
+    } else if (m_sigma_s != "parse_sigma_function_t" && ReadFromCheckpoint(*m_sigma_mf, "sigma")) {
+
+        // read from the checkpoint of the restart, instead of being evaluated
     } else if (m_sigma_s == "parse_sigma_function") {
 
         InitializeMacroMultiFabUsingParser(m_sigma_mf.get(), m_sigma_parser->compile<3>(), lev);
+    } else if (m_sigma_s == "parse_sigma_function_t") {
+
+        InitializeMacroMultiFabUsingParser(m_sigma_mf.get(), m_sigma_parser->compile<4>(), m_properties_time, lev);
+        m_time_dependent_props.push_back({"sigma", m_sigma_mf.get(), m_sigma_parser.get(),
+            FlagTimeDependentBoxes(m_sigma_mf.get(), m_sigma_parser->compile<4>(), lev)});
+    } else if (m_sigma_s == "material_id") {
+
+        InitializeMacroMultiFabUsingMaterialID(m_sigma_mf.get(), mat_sigma);
     }
+    if (m_sigma_s != "constant") report_init_time("sigma", t_start);
     // Initialize epsilon
+    t_start = amrex::second();
     if (m_epsilon_s == "constant") {
 
         m_eps_mf->setVal(m_epsilon);
 
+    } else if (m_epsilon_s != "parse_epsilon_function_t" && ReadFromCheckpoint(*m_eps_mf, "epsilon")) {
+
+        // read from the checkpoint of the restart, instead of being evaluated
     } else if (m_epsilon_s == "parse_epsilon_function") {
 
         InitializeMacroMultiFabUsingParser(m_eps_mf.get(), m_epsilon_parser->compile<3>(), lev);
+    } else if (m_epsilon_s == "parse_epsilon_function_t") {
+
+        InitializeMacroMultiFabUsingParser(m_eps_mf.get(), m_epsilon_parser->compile<4>(), m_properties_time, lev);
+        m_time_dependent_props.push_back({"epsilon", m_eps_mf.get(), m_epsilon_parser.get(),
+            FlagTimeDependentBoxes(m_eps_mf.get(), m_epsilon_parser->compile<4>(), lev)});
 
+    } else if (m_epsilon_s == "material_id") {
+
+        InitializeMacroMultiFabUsingMaterialID(m_eps_mf.get(), mat_epsilon);
     }
+    if (m_epsilon_s != "constant") report_init_time("epsilon", t_start);
 
     // Initialize mu
+    t_start = amrex::second();
     if (m_mu_s == "constant") {
 
         m_mu_mf->setVal(m_mu);
 
+    } else if (m_mu_s != "parse_mu_function_t" && ReadFromCheckpoint(*m_mu_mf, "mu")) {
+
+        // read from the checkpoint of the restart, instead of being evaluated
     } else if (m_mu_s == "parse_mu_function") {
 
         InitializeMacroMultiFabUsingParser(m_mu_mf.get(), m_mu_parser->compile<3>(), lev);
+    } else if (m_mu_s == "parse_mu_function_t") {
 
-    }
-#ifdef WARPX_MAG_LLG
+        InitializeMacroMultiFabUsingParser(m_mu_mf.get(), m_mu_parser->compile<4>(), m_properties_time, lev);
+        m_time_dependent_props.push_back({"mu", m_mu_mf.get(), m_mu_parser.get(),
+            FlagTimeDependentBoxes(m_mu_mf.get(), m_mu_parser->compile<4>(), lev)});
 
-    // all magnetic macroparameters are stored on faces
-    for (int i=0; i<3; ++i) {
-        m_mag_Ms_mf[i]         = std::make_unique<MultiFab>(amrex::convert(ba,IntVect::TheDimensionVector(i)), dmap, 1, ng_EB_alloc);
-        m_mag_alpha_mf[i]      = std::make_unique<MultiFab>(amrex::convert(ba,IntVect::TheDimensionVector(i)), dmap, 1, ng_EB_alloc);
-        m_mag_gamma_mf[i]      = std::make_unique<MultiFab>(amrex::convert(ba,IntVect::TheDimensionVector(i)), dmap, 1, ng_EB_alloc);
-        m_mag_exchange_mf[i]   = std::make_unique<MultiFab>(amrex::convert(ba,IntVect::TheDimensionVector(i)), dmap, 1, ng_EB_alloc);
-        m_mag_anisotropy_mf[i] = std::make_unique<MultiFab>(amrex::convert(ba,IntVect::TheDimensionVector(i)), dmap, 1, ng_EB_alloc);
-    }
+    } else if (m_mu_s == "material_id") {
 
-    // mag_Ms - defined at cell centers
-    if (m_mag_Ms_s == "constant") {
-        m_mag_Ms_mf[0]->setVal(m_mag_Ms);
-        m_mag_Ms_mf[1]->setVal(m_mag_Ms);
-        m_mag_Ms_mf[2]->setVal(m_mag_Ms);
+        InitializeMacroMultiFabUsingMaterialID(m_mu_mf.get(), mat_mu);
     }
-    else if (m_mag_Ms_s == "parse_mag_Ms_function"){
-        InitializeMacroMultiFabUsingParser(m_mag_Ms_mf[0].get(), m_mag_Ms_parser->compile<3>(), lev);
-        InitializeMacroMultiFabUsingParser(m_mag_Ms_mf[1].get(), m_mag_Ms_parser->compile<3>(), lev);
-        InitializeMacroMultiFabUsingParser(m_mag_Ms_mf[2].get(), m_mag_Ms_parser->compile<3>(), lev);
-    }
-    // if there are regions with Ms=0, the user must provide mur value there
-    for (int i=0; i<3; ++i) {
-        if (m_mag_Ms_mf[i]->min(0,m_mag_Ms_mf[i]->nGrow()) < 0._rt){
-            amrex::Abort("Ms must be non-negative values");
-        }
+    if (m_mu_s != "constant") report_init_time("mu", t_start);
+
+    for (auto const& prop : m_time_dependent_props) {
+        int nvarying = 0;
+        for (int flag : prop.box_is_time_dependent) nvarying += flag;
+        amrex::ParallelDescriptor::ReduceIntSum(nvarying);
+        amrex::Print() << Utils::TextMsg::Info(
+            prop.name + " varies in time on " + std::to_string(nvarying) + " of "
+            + std::to_string(prop.mf->size()) + " boxes, updated every "
+            + std::to_string(m_properties_update_interval) + " steps");
     }
-    for (int i=0; i<3; ++i) {
-        if (m_mag_Ms_mf[i]->min(0,m_mag_Ms_mf[i]->nGrow()) == 0._rt){
-            if (m_mu_s != "constant" && m_mu_s != "parse_mu_function"){
-                amrex::Abort("permeability must be specified since part of the simulation domain is non-magnetic !");
+#ifdef WARPX_MAG_LLG
+    if (WarpX::mag_LLG) {
+
+        // all magnetic macroparameters are stored on faces
+        for (int i=0; i<3; ++i) {
+            m_mag_Ms_mf[i]         = std::make_unique<MultiFab>(amrex::convert(ba,IntVect::TheDimensionVector(i)), dmap, 1, ng_EB_alloc, StaticDataMFInfo());
+            m_mag_alpha_mf[i]      = std::make_unique<MultiFab>(amrex::convert(ba,IntVect::TheDimensionVector(i)), dmap, 1, ng_EB_alloc, StaticDataMFInfo());
+            m_mag_gamma_mf[i]      = std::make_unique<MultiFab>(amrex::convert(ba,IntVect::TheDimensionVector(i)), dmap, 1, ng_EB_alloc, StaticDataMFInfo());
+            m_mag_exchange_mf[i]   = std::make_unique<MultiFab>(amrex::convert(ba,IntVect::TheDimensionVector(i)), dmap, 1, ng_EB_alloc, StaticDataMFInfo());
+            m_mag_anisotropy_mf[i] = std::make_unique<MultiFab>(amrex::convert(ba,IntVect::TheDimensionVector(i)), dmap, 1, ng_EB_alloc, StaticDataMFInfo());
+            m_mag_DMI_mf[i]        = std::make_unique<MultiFab>(amrex::convert(ba,IntVect::TheDimensionVector(i)), dmap, 1, ng_EB_alloc, StaticDataMFInfo());
+            m_mag_coefs_mf[i]      = std::make_unique<MagCoefFab>(amrex::convert(ba,IntVect::TheDimensionVector(i)), dmap, mag_ncoefs, ng_EB_alloc, StaticDataMFInfo());
+            if (m_mag_has_grains) {
+                m_mag_grain_mf[i]  = std::make_unique<iMultiFab>(amrex::convert(ba,IntVect::TheDimensionVector(i)), dmap, 1, ng_EB_alloc, StaticDataMFInfo());
             }
         }
-    }
 
-    // mag_alpha - defined at faces
-    if (m_mag_alpha_s == "constant") {
-        m_mag_alpha_mf[0]->setVal(m_mag_alpha);
-        m_mag_alpha_mf[1]->setVal(m_mag_alpha);
-        m_mag_alpha_mf[2]->setVal(m_mag_alpha);
-    }
-    else if (m_mag_alpha_s == "parse_mag_alpha_function"){
-        InitializeMacroMultiFabUsingParser(m_mag_alpha_mf[0].get(), m_mag_alpha_parser->compile<3>(), lev);
-        InitializeMacroMultiFabUsingParser(m_mag_alpha_mf[1].get(), m_mag_alpha_parser->compile<3>(), lev);
-        InitializeMacroMultiFabUsingParser(m_mag_alpha_mf[2].get(), m_mag_alpha_parser->compile<3>(), lev);
-    }
-    for (int i=0; i<3; ++i) {
-        if (m_mag_alpha_mf[i]->min(0,m_mag_alpha_mf[i]->nGrow()) < 0._rt) {
-            amrex::Abort("alpha should be positive, but the user input has negative values");
+        // The magnetic properties given by a parser are evaluated together after the others, in a
+        // single pass over the boxes: the kernels of the properties are queued on the stream of each
+        // box, without synchronizing between the properties.
+        amrex::Vector<std::array<std::unique_ptr<amrex::MultiFab>, 3> const*> parsed_mf;
+        amrex::Vector<amrex::ParserExecutor<3>> parsed_exe;
+        std::string parsed_names;
+        auto init_face_property = [&] (std::string const& name, std::string const& source,
+                                       amrex::Real value,
+                                       std::array<std::unique_ptr<amrex::MultiFab>, 3> const& mf,
+                                       std::unique_ptr<amrex::Parser> const& parser, int mat_prop)
+        {
+            t_start = amrex::second();
+            if (source == "constant") {
+                for (int i=0; i<3; ++i) mf[i]->setVal(value);
+                return;
+            }
+            else if (ReadFromCheckpoint(mf, name)) {}
+            else if (source == "parse_" + name + "_function") {
+                parsed_mf.push_back(&mf);
+                parsed_exe.push_back(parser->compile<3>());
+                parsed_names += (parsed_names.empty() ? "" : ", ") + name;
+                return;
+            }
+            else if (source == "material_id") {
+                for (int i=0; i<3; ++i) InitializeMacroMultiFabUsingMaterialID(mf[i].get(), mat_prop);
+            }
+            if (!source.empty()) report_init_time(name, t_start);
+        };
+        init_face_property("mag_Ms", m_mag_Ms_s, m_mag_Ms, m_mag_Ms_mf, m_mag_Ms_parser, mat_mag_Ms);
+        init_face_property("mag_alpha", m_mag_alpha_s, m_mag_alpha, m_mag_alpha_mf, m_mag_alpha_parser, mat_mag_alpha);
+        init_face_property("mag_gamma", m_mag_gamma_s, m_mag_gamma, m_mag_gamma_mf, m_mag_gamma_parser, mat_mag_gamma);
+        init_face_property("mag_exchange", m_mag_exchange_s, m_mag_exchange, m_mag_exchange_mf,
+                           m_mag_exchange_parser, mat_mag_exchange);
+        init_face_property("mag_anisotropy", m_mag_anisotropy_s, m_mag_anisotropy, m_mag_anisotropy_mf,
+                           m_mag_anisotropy_parser, mat_mag_anisotropy);
+        // zero where the DMI coupling is off, such that its coefficient is defined
+        if (m_mag_DMI_s.empty()) for (int i=0; i<3; ++i) m_mag_DMI_mf[i]->setVal(0.);
+        init_face_property("mag_DMI", m_mag_DMI_s, m_mag_DMI, m_mag_DMI_mf, m_mag_DMI_parser, mat_mag_DMI);
+        if (!parsed_mf.empty()) {
+            t_start = amrex::second();
+            InitializeFaceMultiFabsUsingParser(parsed_mf, parsed_exe, lev);
+            report_init_time(parsed_names, t_start);
         }
-    }
 
-    // mag_gamma - defined at faces
-    if (m_mag_gamma_s == "constant") {
-        m_mag_gamma_mf[0]->setVal(m_mag_gamma);
-        m_mag_gamma_mf[1]->setVal(m_mag_gamma);
-        m_mag_gamma_mf[2]->setVal(m_mag_gamma);
-    }
-    else if (m_mag_gamma_s == "parse_mag_gamma_function"){
-        InitializeMacroMultiFabUsingParser(m_mag_gamma_mf[0].get(), m_mag_gamma_parser->compile<3>(), lev);
-        InitializeMacroMultiFabUsingParser(m_mag_gamma_mf[1].get(), m_mag_gamma_parser->compile<3>(), lev);
-        InitializeMacroMultiFabUsingParser(m_mag_gamma_mf[2].get(), m_mag_gamma_parser->compile<3>(), lev);
-    }
-    for (int i=0; i<3; ++i) {
-        if (m_mag_gamma_mf[i]->min(0,m_mag_gamma_mf[i]->nGrow()) > 0._rt) {
-            amrex::Abort("gamma should be negative, but the user input has positive values");
+        // Ms must be non-negative, alpha non-negative and gamma non-positive: the minima of the faces
+        // of the local boxes are reduced over the ranks together
+        amrex::Vector<amrex::Real> face_min(9);
+        for (int i=0; i<3; ++i) {
+            face_min[i]   = m_mag_Ms_mf[i]->min(0, m_mag_Ms_mf[i]->nGrow(), true);
+            face_min[3+i] = m_mag_alpha_mf[i]->min(0, m_mag_alpha_mf[i]->nGrow(), true);
+            face_min[6+i] = -m_mag_gamma_mf[i]->max(0, m_mag_gamma_mf[i]->nGrow(), true);
         }
-    }
+        amrex::ParallelDescriptor::ReduceRealMin(face_min.data(), static_cast<int>(face_min.size()));
+        for (int i=0; i<3; ++i) {
+            if (face_min[i] < 0._rt){
+                amrex::Abort("Ms must be non-negative values");
+            }
+        }
+        // if there are regions with Ms=0, the user must provide mur value there
+        for (int i=0; i<3; ++i) {
+            if (face_min[i] == 0._rt){
+                if (m_mu_s != "constant" && m_mu_s != "parse_mu_function" && m_mu_s != "parse_mu_function_t"
+                    && m_mu_s != "material_id"){
+                    amrex::Abort("permeability must be specified since part of the simulation domain is non-magnetic !");
+                }
+            }
+        }
+        for (int i=0; i<3; ++i) {
+            if (face_min[3+i] < 0._rt) {
+                amrex::Abort("alpha should be positive, but the user input has negative values");
+            }
+        }
+        for (int i=0; i<3; ++i) {
+            if (face_min[6+i] < 0._rt) {
+                amrex::Abort("gamma should be negative, but the user input has positive values");
+            }
+        }
+        // flag the boxes with magnetic material, the LLG M-updates skip the other boxes
+        FlagMagneticBoxes();
 
-    // mag_exchange - defined at faces
-    if (m_mag_exchange_s == "constant") {
-        m_mag_exchange_mf[0]->setVal(m_mag_exchange);
-        m_mag_exchange_mf[1]->setVal(m_mag_exchange);
-        m_mag_exchange_mf[2]->setVal(m_mag_exchange);
-    }
-    else if (m_mag_exchange_s == "parse_mag_exchange_function"){
-        InitializeMacroMultiFabUsingParser(m_mag_exchange_mf[0].get(), m_mag_exchange_parser->compile<3>(), lev);
-        InitializeMacroMultiFabUsingParser(m_mag_exchange_mf[1].get(), m_mag_exchange_parser->compile<3>(), lev);
-        InitializeMacroMultiFabUsingParser(m_mag_exchange_mf[2].get(), m_mag_exchange_parser->compile<3>(), lev);
-    }
+        CheckMagCouplingProperties();
+        ComputeMagCoefs();
 
-    // mag_anisotropy - defined at faces
-    if (m_mag_anisotropy_s == "constant") {
-        m_mag_anisotropy_mf[0]->setVal(m_mag_anisotropy);
-        m_mag_anisotropy_mf[1]->setVal(m_mag_anisotropy);
-        m_mag_anisotropy_mf[2]->setVal(m_mag_anisotropy);
-    }
-    else if (m_mag_anisotropy_s == "parse_mag_anisotropy_function"){
-        InitializeMacroMultiFabUsingParser(m_mag_anisotropy_mf[0].get(), m_mag_anisotropy_parser->compile<3>(), lev);
-        InitializeMacroMultiFabUsingParser(m_mag_anisotropy_mf[1].get(), m_mag_anisotropy_parser->compile<3>(), lev);
-        InitializeMacroMultiFabUsingParser(m_mag_anisotropy_mf[2].get(), m_mag_anisotropy_parser->compile<3>(), lev);
+        if (MagInterlayerCoupling::InInput()) {
+#ifdef WARPX_DIM_3D
+            WARPX_ALWAYS_ASSERT_WITH_MESSAGE(lev == 0 && warpx.maxLevel() == 0,
+                "mag_interlayer.J requires amr.max_level = 0");
+            WARPX_ALWAYS_ASSERT_WITH_MESSAGE(warpx.getmag_time_scheme_order() == 2,
+                "mag_interlayer.J requires warpx.mag_time_scheme_order = 2");
+            m_mag_interlayer = std::make_unique<MagInterlayerCoupling>(warpx.Geom(0), ba, dmap);
+#else
+            amrex::Abort(Utils::TextMsg::Err("mag_interlayer.J is only implemented in 3D"));
+#endif
+        }
     }
 #endif
 
@@ -344,12 +766,15 @@ MacroscopicProperties::InitData ()
     IntVect By_stag = warpx.getBfield_fp(0,1).ixType().toIntVect();
     IntVect Bz_stag = warpx.getBfield_fp(0,2).ixType().toIntVect();
 #ifdef WARPX_MAG_LLG
-    IntVect Hx_stag = warpx.getHfield_fp(0,0).ixType().toIntVect();
-    IntVect Hy_stag = warpx.getHfield_fp(0,1).ixType().toIntVect();
-    IntVect Hz_stag = warpx.getHfield_fp(0,2).ixType().toIntVect();
-    IntVect Mx_stag = warpx.getMfield_fp(0,0).ixType().toIntVect();
-    IntVect My_stag = warpx.getMfield_fp(0,1).ixType().toIntVect();
-    IntVect Mz_stag = warpx.getMfield_fp(0,2).ixType().toIntVect();
+    IntVect Hx_stag, Hy_stag, Hz_stag, Mx_stag, My_stag, Mz_stag;
+    if (WarpX::mag_LLG) {
+        Hx_stag = warpx.getHfield_fp(0,0).ixType().toIntVect();
+        Hy_stag = warpx.getHfield_fp(0,1).ixType().toIntVect();
+        Hz_stag = warpx.getHfield_fp(0,2).ixType().toIntVect();
+        Mx_stag = warpx.getMfield_fp(0,0).ixType().toIntVect();
+        My_stag = warpx.getMfield_fp(0,1).ixType().toIntVect();
+        Mz_stag = warpx.getMfield_fp(0,2).ixType().toIntVect();
+    }
 #endif
 
 
@@ -393,8 +818,510 @@ MacroscopicProperties::InitData ()
         Mz_IndexType[2]              = 0;
 #endif
 #endif
+
+    // the polarization starts from zero, also when InitData is called again
+    for (auto& P : m_dispersion_P_mf) P.reset();
+    DefineDispersion(ba, dmap);
+}
+
+bool
+MacroscopicProperties::ReadFromCheckpoint (amrex::MultiFab& mf, const std::string& name) const
+{
+    if (m_restart_chkfile.empty()) return false;
+    const std::string prefix = amrex::MultiFabFileFullPrefix(m_lev, m_restart_chkfile, "Level_", name);
+    int found = 0;
+    if (amrex::ParallelDescriptor::IOProcessor()) found = amrex::FileExists(prefix + "_H");
+    amrex::ParallelDescriptor::Bcast(&found, 1, amrex::ParallelDescriptor::IOProcessorNumber());
+    if (!found) return false;
+
+    // The checkpoint may have other boxes than the current ones (amr.restart_regrid)
+    amrex::MultiFab mf_chk;
+    amrex::VisMF::Read(mf_chk, prefix);
+    const amrex::IntVect ng = mf.nGrowVect();
+    // the guard cells first, then the valid cells, which take precedence where they overlap
+    mf.ParallelCopy(mf_chk, 0, 0, 1, ng, ng);
+    mf.ParallelCopy(mf_chk, 0, 0, 1, amrex::IntVect(0), ng);
+    amrex::Print() << Utils::TextMsg::Info("read " + name + " from checkpoint " + m_restart_chkfile);
+    return true;
+}
+
+bool
+MacroscopicProperties::ReadFromCheckpoint (std::array<std::unique_ptr<amrex::MultiFab>, 3> const& mf,
+                                           const std::string& name) const
+{
+    const std::array<std::string, 3> faces = {"xface", "yface", "zface"};
+    bool found = true;
+    for (int i = 0; i < 3 && found; ++i) found = ReadFromCheckpoint(*mf[i], name + "_" + faces[i]);
+    return found;
+}
+
+void
+MacroscopicProperties::RemakeLevel (const amrex::BoxArray& ba, const amrex::DistributionMapping& dm)
+{
+    // at restart, the level may be remade before the properties are initialized on it
+    if (m_sigma_mf == nullptr) return;
+    const int lev = m_lev;
+    RemakeProperty(m_sigma_mf, ba, dm);
+    RemakeProperty(m_eps_mf, ba, dm);
+    RemakeProperty(m_mu_mf, ba, dm);
+    RemakeProperty(m_material_id_mf, ba, dm);
+    DefineDispersion(ba, dm);
+
+    // the time-dependent properties now point to the new multifabs, whose boxes are flagged again
+    for (auto& prop : m_time_dependent_props) {
+        if (prop.name == "sigma") prop.mf = m_sigma_mf.get();
+        else if (prop.name == "epsilon") prop.mf = m_eps_mf.get();
+        else if (prop.name == "mu") prop.mf = m_mu_mf.get();
+        prop.box_is_time_dependent = FlagTimeDependentBoxes(prop.mf, prop.parser->compile<4>(), lev);
+    }
+
+#ifdef WARPX_MAG_LLG
+    if (WarpX::mag_LLG) {
+        for (int i=0; i<3; ++i) {
+            RemakeProperty(m_mag_Ms_mf[i], ba, dm);
+            RemakeProperty(m_mag_alpha_mf[i], ba, dm);
+            RemakeProperty(m_mag_gamma_mf[i], ba, dm);
+            RemakeProperty(m_mag_exchange_mf[i], ba, dm);
+            RemakeProperty(m_mag_anisotropy_mf[i], ba, dm);
+            RemakeProperty(m_mag_DMI_mf[i], ba, dm);
+            RemakeProperty(m_mag_coefs_mf[i], ba, dm);
+            RemakeProperty(m_mag_grain_mf[i], ba, dm);
+        }
+        FlagMagneticBoxes();
+#ifdef WARPX_DIM_3D
+        if (m_mag_interlayer) m_mag_interlayer->RemakeLevel(ba, dm);
+#endif
+    }
+#endif
+
+    // the quantities derived from the properties are recomputed on the new boxes
+    ++m_properties_version;
+}
+
+void
+MacroscopicProperties::DefineDispersion (const amrex::BoxArray& ba, const amrex::DistributionMapping& dm)
+{
+    if (!m_has_dispersion) return;
+
+    // flag the boxes with dispersive material in a cell or in the guard cells read by their E locations
+    const int nboxes = ba.size();
+    amrex::Vector<int> box_has_dispersion(nboxes, 0);
+    const int nmat = m_material_names.size();
+    amrex::Real const * const AMREX_RESTRICT table = m_material_table.dataPtr();
+    for ( amrex::MFIter mfi(*m_material_id_mf); mfi.isValid(); ++mfi ) {
+        const amrex::Box bx = mfi.fabbox();
+        amrex::Array4<int const> const& id_arr = m_material_id_mf->const_array(mfi);
+        amrex::ReduceOps<amrex::ReduceOpMax> reduce_op;
+        amrex::ReduceData<int> reduce_data(reduce_op);
+        using ReduceTuple = typename decltype(reduce_data)::Type;
+        reduce_op.eval(bx, reduce_data,
+            [=] AMREX_GPU_DEVICE (int i, int j, int k) -> ReduceTuple {
+                return (table[mat_disp_b0 * nmat + id_arr(i,j,k)] != 0._rt) ? 1 : 0;
+        });
+        if (amrex::get<0>(reduce_data.value()) > 0) box_has_dispersion[mfi.index()] = 1;
+    }
+    amrex::ParallelDescriptor::ReduceIntMax(box_has_dispersion.data(), nboxes);
+
+    // the boxes of the polarization keep their owner, so that the E update accesses them locally
+    m_dispersion_index.assign(nboxes, -1);
+    m_dispersion_box_index.clear();
+    amrex::BoxList bl;
+    amrex::Vector<int> pmap;
+    for (int ibox = 0; ibox < nboxes; ++ibox) {
+        if (box_has_dispersion[ibox] == 0) continue;
+        m_dispersion_index[ibox] = static_cast<int>(m_dispersion_box_index.size());
+        m_dispersion_box_index.push_back(ibox);
+        bl.push_back(ba[ibox]);
+        pmap.push_back(dm[ibox]);
+    }
+    amrex::Print() << Utils::TextMsg::Info(
+        std::to_string(m_dispersion_box_index.size()) + " of " + std::to_string(nboxes)
+        + " boxes contain dispersive material");
+
+    std::array<std::unique_ptr<amrex::MultiFab>, 3> P_old;
+    std::swap(P_old, m_dispersion_P_mf);
+    if (m_dispersion_box_index.empty()) return;
+
+    auto & warpx = WarpX::GetInstance();
+    const amrex::BoxArray ba_disp(std::move(bl));
+    const amrex::DistributionMapping dm_disp(pmap);
+    for (int idim = 0; idim < 3; ++idim) {
+        const amrex::MultiFab& E = warpx.getEfield_fp(m_lev, idim);
+        const amrex::IntVect ng = E.nGrowVect();
+        m_dispersion_P_mf[idim] = std::make_unique<amrex::MultiFab>(
+            amrex::convert(ba_disp, E.ixType()), dm_disp, 2, ng);
+        m_dispersion_P_mf[idim]->setVal(0._rt);
+        if (P_old[idim]) {
+            // the guard cells first, then the valid cells, which take precedence where they overlap
+            m_dispersion_P_mf[idim]->ParallelCopy(*P_old[idim], 0, 0, 2, ng, ng);
+            m_dispersion_P_mf[idim]->ParallelCopy(*P_old[idim], 0, 0, 2, amrex::IntVect(0), ng);
+        }
+    }
+}
+
+void
+MacroscopicProperties::PropertiesModified ()
+{
+    auto & warpx = WarpX::GetInstance();
+    const amrex::Periodicity& period = warpx.Geom(m_lev).periodicity();
+    m_sigma_mf->FillBoundary(period);
+    m_eps_mf->FillBoundary(period);
+    m_mu_mf->FillBoundary(period);
+    // the material indices may have been modified too
+    if (use_material_id()) DefineDispersion(warpx.boxArray(m_lev), warpx.DistributionMap(m_lev));
+#ifdef WARPX_MAG_LLG
+    if (WarpX::mag_LLG) {
+        for (int i=0; i<3; ++i) {
+            m_mag_Ms_mf[i]->FillBoundary(period);
+            m_mag_alpha_mf[i]->FillBoundary(period);
+            m_mag_gamma_mf[i]->FillBoundary(period);
+            m_mag_exchange_mf[i]->FillBoundary(period);
+            m_mag_anisotropy_mf[i]->FillBoundary(period);
+            m_mag_DMI_mf[i]->FillBoundary(period);
+        }
+        FlagMagneticBoxes();
+        CheckMagCouplingProperties();
+        ComputeMagCoefs();
+    }
+#endif
+    m_properties_modified = true;
+    // the coefficients of the field updates are recomputed from the new values
+    ++m_properties_version;
+}
+
+template <int N, typename... Ts>
+void
+MacroscopicProperties::FillShiftedSlabUsingParser (
+                       amrex::MultiFab *macro_mf,
+                       amrex::ParserExecutor<N> const& macro_parser,
+                       const int num_shift, const int dir, Ts... t) const
+{
+    WarpX& warpx = WarpX::GetInstance();
+    const MeshCoordinates coords = warpx.GetMeshCoordinates(m_lev);
+    amrex::IntVect iv = macro_mf->ixType().toIntVect();
+    // cells moved into by the window, including the guard cells, with one more layer
+    // towards the interior for the nodal points on the former boundary
+    const amrex::Box domain = amrex::convert(warpx.Geom(m_lev).Domain(), macro_mf->ixType());
+    amrex::Box slab = amrex::grow(domain, macro_mf->nGrowVect());
+    if (num_shift > 0) {
+        slab.setSmall(dir, domain.bigEnd(dir) - num_shift);
+    } else {
+        slab.setBig(dir, domain.smallEnd(dir) - num_shift);
+    }
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#endif
+    for ( amrex::MFIter mfi(*macro_mf); mfi.isValid(); ++mfi ) {
+        const amrex::Box tb = mfi.fabbox() & slab;
+        if (!tb.ok()) continue;
+        amrex::Array4<amrex::Real> const& macro_fab =  macro_mf->array(mfi);
+        amrex::ParallelFor (tb,
+            [=] AMREX_GPU_DEVICE (int i, int j, int k) {
+                macro_fab(i,j,k) = EvalParserAtIndex(macro_parser, i, j, k, iv, coords, t...);
+        });
+    }
+}
+
+void
+MacroscopicProperties::ShiftProperties (const int num_shift, const int dir)
+{
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(!use_material_id(),
+        "The moving window does not support the material indices (macroscopic.material_names)");
+    auto & warpx = WarpX::GetInstance();
+    const amrex::Geometry& geom = warpx.Geom(m_lev);
+    const amrex::Periodicity& period = geom.periodicity();
+
+    // the constant properties are not changed by the shift
+    auto shift_property = [&] (amrex::MultiFab* mf, std::string const& name,
+                               std::string const& source, amrex::Parser* parser) -> bool
+    {
+        if (source.empty() || source == "constant") return false;
+        WarpX::shiftMF(*mf, geom, num_shift, dir, m_lev);
+        if (source == "parse_" + name + "_function") {
+            FillShiftedSlabUsingParser(mf, parser->compile<3>(), num_shift, dir);
+        } else if (source == "parse_" + name + "_function_t") {
+            FillShiftedSlabUsingParser(mf, parser->compile<4>(), num_shift, dir, m_properties_time);
+        }
+        mf->FillBoundary(period);
+        return true;
+    };
+    bool shifted = shift_property(m_sigma_mf.get(), "sigma", m_sigma_s, m_sigma_parser.get());
+    shifted = shift_property(m_eps_mf.get(), "epsilon", m_epsilon_s, m_epsilon_parser.get()) || shifted;
+    shifted = shift_property(m_mu_mf.get(), "mu", m_mu_s, m_mu_parser.get()) || shifted;
+    // the parts of the properties that vary in time moved to other boxes
+    for (auto& prop : m_time_dependent_props) {
+        prop.box_is_time_dependent = FlagTimeDependentBoxes(prop.mf, prop.parser->compile<4>(), m_lev);
+    }
+#ifdef WARPX_MAG_LLG
+    if (WarpX::mag_LLG) {
+        bool mag_shifted = false;
+        auto shift_face_property = [&] (std::array<std::unique_ptr<amrex::MultiFab>, 3> const& mf,
+                                        std::string const& name, std::string const& source,
+                                        std::unique_ptr<amrex::Parser> const& parser)
+        {
+            for (int i=0; i<3; ++i) {
+                mag_shifted = shift_property(mf[i].get(), name, source, parser.get()) || mag_shifted;
+            }
+        };
+        shift_face_property(m_mag_Ms_mf, "mag_Ms", m_mag_Ms_s, m_mag_Ms_parser);
+        shift_face_property(m_mag_alpha_mf, "mag_alpha", m_mag_alpha_s, m_mag_alpha_parser);
+        shift_face_property(m_mag_gamma_mf, "mag_gamma", m_mag_gamma_s, m_mag_gamma_parser);
+        shift_face_property(m_mag_exchange_mf, "mag_exchange", m_mag_exchange_s, m_mag_exchange_parser);
+        shift_face_property(m_mag_anisotropy_mf, "mag_anisotropy", m_mag_anisotropy_s,
+                            m_mag_anisotropy_parser);
+        shift_face_property(m_mag_DMI_mf, "mag_DMI", m_mag_DMI_s, m_mag_DMI_parser);
+        if (mag_shifted) {
+            FlagMagneticBoxes();
+            CheckMagCouplingProperties();
+            ComputeMagCoefs();
+            shifted = true;
+        }
+    }
+#endif
+    // the coefficients of the field updates are recomputed from the shifted values
+    if (shifted) ++m_properties_version;
+}
+
+double
+MacroscopicProperties::PropertiesBytes () const
+{
+    return LocalMemoryBytes(m_sigma_mf.get()) + LocalMemoryBytes(m_eps_mf.get())
+         + LocalMemoryBytes(m_mu_mf.get()) + LocalMemoryBytes(m_material_id_mf.get())
+         + LocalMemoryBytes(m_dispersion_P_mf);
+}
+
+#ifdef WARPX_MAG_LLG
+double
+MacroscopicProperties::MagPropertiesBytes () const
+{
+    return LocalMemoryBytes(m_mag_Ms_mf) + LocalMemoryBytes(m_mag_alpha_mf)
+         + LocalMemoryBytes(m_mag_gamma_mf) + LocalMemoryBytes(m_mag_exchange_mf)
+         + LocalMemoryBytes(m_mag_anisotropy_mf) + LocalMemoryBytes(m_mag_DMI_mf)
+         + LocalMemoryBytes(m_mag_coefs_mf) + LocalMemoryBytes(m_mag_grain_mf);
+}
+#endif
+
+#ifdef WARPX_MAG_LLG
+void
+MacroscopicProperties::ComputeMagCoefs ()
+{
+    bool const cubic = (m_mag_anisotropy_type == 1);
+    for (int i=0; i<3; ++i) {
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#endif
+        for ( amrex::MFIter mfi(*m_mag_coefs_mf[i], amrex::TilingIfNotGPU()); mfi.isValid(); ++mfi ) {
+            // the coefficients are also needed in the guard cells, like the properties
+            const amrex::Box& bx = mfi.growntilebox();
+            amrex::Array4<amrex::Real const> const& Ms_arr = m_mag_Ms_mf[i]->const_array(mfi);
+            amrex::Array4<amrex::Real const> const& alpha_arr = m_mag_alpha_mf[i]->const_array(mfi);
+            amrex::Array4<amrex::Real const> const& gamma_arr = m_mag_gamma_mf[i]->const_array(mfi);
+            amrex::Array4<amrex::Real const> const& exchange_arr = m_mag_exchange_mf[i]->const_array(mfi);
+            amrex::Array4<amrex::Real const> const& anisotropy_arr = m_mag_anisotropy_mf[i]->const_array(mfi);
+            amrex::Array4<amrex::Real const> const& DMI_arr = m_mag_DMI_mf[i]->const_array(mfi);
+            amrex::Array4<MagCoefReal> const& coefs_arr = m_mag_coefs_mf[i]->array(mfi);
+
+            amrex::ParallelFor(bx,
+                [=] AMREX_GPU_DEVICE (int ii, int jj, int kk) {
+                    amrex::Real const Ms = Ms_arr(ii,jj,kk);
+                    // the coefficients are zero on the non-magnetic faces
+                    if (Ms <= 0._rt) {
+                        for (int n = 0; n < mag_ncoefs; ++n) coefs_arr(ii,jj,kk,n) = MagCoefReal(0.);
+                        return;
+                    }
+                    amrex::Real const inv_mu0_Ms2 = 1._rt / (PhysConst::mu0 * Ms * Ms);
+                    // the cubic anisotropy field is cubic in M
+                    amrex::Real const inv_Ms2_cubic = cubic ? 1._rt / (Ms * Ms) : 1._rt;
+                    // computed in amrex::Real, and rounded once to the storage precision
+                    coefs_arr(ii,jj,kk,mag_coef_gamma) = static_cast<MagCoefReal>(PhysConst::mu0 * amrex::Math::abs(gamma_arr(ii,jj,kk)) / 2._rt);
+                    coefs_arr(ii,jj,kk,mag_coef_exchange) = static_cast<MagCoefReal>(2._rt * exchange_arr(ii,jj,kk) * inv_mu0_Ms2);
+                    coefs_arr(ii,jj,kk,mag_coef_anisotropy) = static_cast<MagCoefReal>(- 2._rt * anisotropy_arr(ii,jj,kk) * inv_mu0_Ms2 * inv_Ms2_cubic);
+                    coefs_arr(ii,jj,kk,mag_coef_gammaL) = static_cast<MagCoefReal>(gamma_arr(ii,jj,kk) / (1._rt + alpha_arr(ii,jj,kk) * alpha_arr(ii,jj,kk)));
+                    coefs_arr(ii,jj,kk,mag_coef_DMI) = static_cast<MagCoefReal>(2._rt * DMI_arr(ii,jj,kk) * inv_mu0_Ms2);
+            });
+
+            if (m_mag_grain_mf[i]) {
+                // the grain of a face is the material of the cell above it if magnetic, of the cell
+                // below it otherwise, as the properties of InitializeMacroMultiFabUsingMaterialID
+                const int nmat = nmaterials();
+                amrex::Real const * const AMREX_RESTRICT table = m_material_table.dataPtr();
+                amrex::IntVect const iv = m_mag_grain_mf[i]->ixType().toIntVect();
+                amrex::Array4<int const> const& id_arr = m_material_id_mf->const_array(mfi);
+                amrex::Array4<int> const& grain_arr = m_mag_grain_mf[i]->array(mfi);
+                amrex::ParallelFor(bx,
+                    [=] AMREX_GPU_DEVICE (int ii, int jj, int kk) {
+#if defined(WARPX_DIM_XZ) || defined(WARPX_DIM_RZ)
+                        int const id_lo = id_arr(ii-iv[0], jj-iv[1], kk);
+#else
+                        int const id_lo = id_arr(ii-iv[0], jj-iv[1], kk-iv[2]);
+#endif
+                        int const id_hi = id_arr(ii, jj, kk);
+                        grain_arr(ii,jj,kk) = (table[mat_mag_Ms * nmat + id_hi] > 0._rt) ? id_hi : id_lo;
+                });
+            }
+        }
+    }
+}
+
+void
+MacroscopicProperties::CheckMagCouplingProperties ()
+{
+    auto &warpx = WarpX::GetInstance();
+    // returns whether the property mf is zero on any valid face with magnetic material
+    auto zero_on_magnetic_faces = [&] (std::array<std::unique_ptr<amrex::MultiFab>, 3> const& mf) -> bool {
+        amrex::ReduceOps<amrex::ReduceOpMax> reduce_op;
+        amrex::ReduceData<int> reduce_data(reduce_op);
+        using ReduceTuple = typename decltype(reduce_data)::Type;
+        for (int i=0; i<3; ++i) {
+            for ( amrex::MFIter mfi(*mf[i]); mfi.isValid(); ++mfi ) {
+                const amrex::Box& bx = mfi.validbox();
+                amrex::Array4<amrex::Real const> const& Ms_arr = m_mag_Ms_mf[i]->const_array(mfi);
+                amrex::Array4<amrex::Real const> const& prop_arr = mf[i]->const_array(mfi);
+                reduce_op.eval(bx, reduce_data,
+                    [=] AMREX_GPU_DEVICE (int ii, int jj, int kk) -> ReduceTuple {
+                        return (Ms_arr(ii,jj,kk) > 0._rt && prop_arr(ii,jj,kk) == 0._rt) ? 1 : 0;
+                });
+            }
+        }
+        int zero_found = amrex::get<0>(reduce_data.value());
+        amrex::ParallelDescriptor::ReduceIntMax(zero_found);
+        return zero_found > 0;
+    };
+
+    if (warpx.mag_LLG_exchange_coupling == 1 && zero_on_magnetic_faces(m_mag_exchange_mf)) {
+        amrex::Abort("mag_exchange is 0.0 in a magnetic region while including the exchange coupling term H_exchange for H_eff");
+    }
+    if (warpx.mag_LLG_anisotropy_coupling == 1 && zero_on_magnetic_faces(m_mag_anisotropy_mf)) {
+        amrex::Abort("mag_anisotropy is 0.0 in a magnetic region while including the anisotropy coupling term H_anisotropy for H_eff");
+    }
+}
+
+void
+MacroscopicProperties::CheckMagNormalizationFlag (int local_flag) const
+{
+    int flag = local_flag;
+    amrex::ParallelDescriptor::ReduceIntMax(flag);
+    if (flag == mag_norm_exceeded) {
+        amrex::Abort("Exceed the normalized error of the M field, mag_normalized_error = "
+                     + std::to_string(m_mag_normalized_error));
+    }
+    else if (flag == mag_norm_unsaturated_exceeded) {
+        amrex::Abort("Caution: Unsaturated material has M exceeding the saturation magnetization, mag_normalized_error = "
+                     + std::to_string(m_mag_normalized_error));
+    }
+}
+
+void
+MacroscopicProperties::FlagMagneticBoxes ()
+{
+    const int nboxes = m_mag_Ms_mf[0]->size();
+    m_mag_box_has_material.assign(nboxes, 0);
+
+    for (int i=0; i<3; ++i) {
+        for ( amrex::MFIter mfi(*m_mag_Ms_mf[i]); mfi.isValid(); ++mfi ) {
+            // only the valid faces are updated by the LLG solver
+            const amrex::Box& bx = mfi.validbox();
+            amrex::Array4<amrex::Real const> const& Ms_arr = m_mag_Ms_mf[i]->const_array(mfi);
+
+            amrex::ReduceOps<amrex::ReduceOpMax> reduce_op;
+            amrex::ReduceData<int> reduce_data(reduce_op);
+            using ReduceTuple = typename decltype(reduce_data)::Type;
+            reduce_op.eval(bx, reduce_data,
+                [=] AMREX_GPU_DEVICE (int ii, int jj, int kk) -> ReduceTuple {
+                    return (Ms_arr(ii,jj,kk) > 0._rt) ? 1 : 0;
+            });
+            if (amrex::get<0>(reduce_data.value()) > 0) m_mag_box_has_material[mfi.index()] = 1;
+        }
+    }
+
+    // make the flags of all boxes known on all ranks
+    amrex::ParallelDescriptor::ReduceIntMax(m_mag_box_has_material.data(), nboxes);
+
+    int nmagnetic = 0;
+    for (int ibox = 0; ibox < nboxes; ++ibox) nmagnetic += m_mag_box_has_material[ibox];
+    amrex::Print() << Utils::TextMsg::Info(
+        "LLG: " + std::to_string(nmagnetic) + " of " + std::to_string(nboxes)
+        + " boxes contain magnetic material");
+}
+
+MagSpinTorque
+MacroscopicProperties::GetSpinTorque (amrex::MFIter const& mfi, int lev, amrex::Real t) const
+{
+    auto & warpx = WarpX::GetInstance();
+    MagSpinTorque spin_torque;
+    spin_torque.coef = m_mag_spin_torque_coef;
+    spin_torque.field_like_ratio = m_mag_spin_torque_field_like_ratio;
+    spin_torque.polarization = m_mag_spin_torque_polarization;
+    spin_torque.J_from_parser = (m_mag_spin_torque_J_parser != nullptr);
+    if (spin_torque.J_from_parser) {
+        spin_torque.J_parser = m_mag_spin_torque_J_exe;
+        spin_torque.coords = warpx.GetMeshCoordinates(lev);
+        spin_torque.time = t;
+    } else {
+        spin_torque.J_direction = m_mag_spin_torque_J_direction;
+        spin_torque.Jx = warpx.get_pointer_current_fp(lev, 0)->array(mfi);
+        spin_torque.Jy = warpx.get_pointer_current_fp(lev, 1)->array(mfi);
+        spin_torque.Jz = warpx.get_pointer_current_fp(lev, 2)->array(mfi);
+        spin_torque.Jx_stag = warpx.get_pointer_current_fp(lev, 0)->ixType().toIntVect();
+        spin_torque.Jy_stag = warpx.get_pointer_current_fp(lev, 1)->ixType().toIntVect();
+        spin_torque.Jz_stag = warpx.get_pointer_current_fp(lev, 2)->ixType().toIntVect();
+    }
+    return spin_torque;
+}
+
+void
+MacroscopicProperties::UpdateInterlayerCoupling (std::array<std::unique_ptr<amrex::MultiFab>, 3> const& Mfield)
+{
+#ifdef WARPX_DIM_3D
+    if (!m_mag_interlayer) return;
+    m_mag_interlayer->Update(Mfield, {m_mag_Ms_mf[0].get(), m_mag_Ms_mf[1].get(), m_mag_Ms_mf[2].get()});
+#else
+    amrex::ignore_unused(Mfield);
+#endif
+}
+
+MagInterlayerField
+MacroscopicProperties::GetInterlayerField (int dir, amrex::MFIter const& mfi) const
+{
+#ifdef WARPX_DIM_3D
+    if (m_mag_interlayer) return m_mag_interlayer->GetField(dir, mfi.index());
+#else
+    amrex::ignore_unused(dir, mfi);
+#endif
+    return MagInterlayerField{};
 }
 
+void
+MacroscopicProperties::AdvanceThermalField (int lev)
+{
+    // the index of the update is derived from the step of the level and from the number of
+    // updates of the level already done during this step, and not counted since the start of
+    // the run, so that a restarted run draws the same random numbers as the uninterrupted run
+    const amrex::Long step = WarpX::GetInstance().getistep(lev);
+    if (step != m_mag_LLG_thermal_step) {
+        m_mag_LLG_thermal_step = step;
+        m_mag_LLG_thermal_substep = 0;
+    } else {
+        ++m_mag_LLG_thermal_substep;
+    }
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(m_mag_LLG_thermal_substep < MaxThermalUpdatesPerStep,
+        "Too many LLG updates with a thermal field during one step");
+    m_mag_LLG_thermal_update = MaxThermalUpdatesPerStep * step + m_mag_LLG_thermal_substep;
+}
+
+MagThermalField
+MacroscopicProperties::GetThermalField (int lev, amrex::Real dt_M) const
+{
+    MagThermalField thermal;
+    thermal.kT_over_dt = PhysConst::kb * m_mag_LLG_temperature / dt_M;
+    thermal.seed = static_cast<std::uint32_t>(m_mag_LLG_thermal_seed);
+    thermal.lev = static_cast<std::uint32_t>(lev);
+    thermal.update = static_cast<std::uint32_t>(m_mag_LLG_thermal_update);
+    thermal.coords = WarpX::GetInstance().GetMeshCoordinates(lev);
+    return thermal;
+}
+#endif
+
 void
 MacroscopicProperties::InitializeMacroMultiFabUsingParser (
                        amrex::MultiFab *macro_mf,
@@ -402,9 +1329,11 @@ MacroscopicProperties::InitializeMacroMultiFabUsingParser (
                        const int lev)
 {
     WarpX& warpx = WarpX::GetInstance();
-    const amrex::GpuArray<amrex::Real, AMREX_SPACEDIM> dx_lev = warpx.Geom(lev).CellSizeArray();
-    const amrex::RealBox& real_box = warpx.Geom(lev).ProbDomain();
+    const MeshCoordinates coords = warpx.GetMeshCoordinates(lev);
     amrex::IntVect iv = macro_mf->ixType().toIntVect();
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#endif
     for ( amrex::MFIter mfi(*macro_mf, TilingIfNotGPU()); mfi.isValid(); ++mfi ) {
         // Initialize ghost cells in addition to valid cells
 
@@ -412,22 +1341,319 @@ MacroscopicProperties::InitializeMacroMultiFabUsingParser (
         amrex::Array4<amrex::Real> const& macro_fab =  macro_mf->array(mfi);
         amrex::ParallelFor (tb,
             [=] AMREX_GPU_DEVICE (int i, int j, int k) {
-                // Shift x, y, z position based on index type
-                amrex::Real fac_x = (1._rt - iv[0]) * dx_lev[0] * 0.5_rt;
-                amrex::Real x = i * dx_lev[0] + real_box.lo(0) + fac_x;
+                // initialize the macroparameter
+                macro_fab(i,j,k) = EvalParserAtIndex(macro_parser, i, j, k, iv, coords);
+        });
+
+    }
+}
+
+void
+MacroscopicProperties::InitializeMacroMultiFabUsingParser (
+                       amrex::MultiFab *macro_mf,
+                       amrex::ParserExecutor<4> const& macro_parser,
+                       const amrex::Real time, const int lev,
+                       amrex::Vector<int> const* box_flags)
+{
+    WarpX& warpx = WarpX::GetInstance();
+    const MeshCoordinates coords = warpx.GetMeshCoordinates(lev);
+    amrex::IntVect iv = macro_mf->ixType().toIntVect();
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#endif
+    for ( amrex::MFIter mfi(*macro_mf, TilingIfNotGPU()); mfi.isValid(); ++mfi ) {
+        if (box_flags && (*box_flags)[mfi.index()] == 0) continue;
+        // Initialize ghost cells in addition to valid cells
+        const amrex::Box& tb = mfi.tilebox( iv, macro_mf->nGrowVect());
+        amrex::Array4<amrex::Real> const& macro_fab =  macro_mf->array(mfi);
+        amrex::ParallelFor (tb,
+            [=] AMREX_GPU_DEVICE (int i, int j, int k) {
+                macro_fab(i,j,k) = EvalParserAtIndex(macro_parser, i, j, k, iv, coords, time);
+        });
+    }
+}
+
+amrex::Vector<int>
+MacroscopicProperties::FlagTimeDependentBoxes (
+                       amrex::MultiFab const* macro_mf,
+                       amrex::ParserExecutor<4> const& macro_parser,
+                       const int lev) const
+{
+    WarpX& warpx = WarpX::GetInstance();
+    const MeshCoordinates coords = warpx.GetMeshCoordinates(lev);
+    amrex::IntVect iv = macro_mf->ixType().toIntVect();
+
+    // probe times spanning the remainder of the simulation
+    const amrex::Real t_begin = m_properties_time;
+    const amrex::Real t_end = std::min(warpx.stopTime(),
+        t_begin + (warpx.maxStep() - warpx.getistep(lev)) * warpx.getdt(lev));
+    const int nprobes = m_properties_time_probes;
+    const amrex::Real dt_probe = (t_end - t_begin) / nprobes;
+
+    amrex::Vector<int> box_flags(macro_mf->size(), 0);
+    for ( amrex::MFIter mfi(*macro_mf); mfi.isValid(); ++mfi ) {
+        // the guard cells are updated as well
+        const amrex::Box& bx = mfi.fabbox();
+
+        amrex::ReduceOps<amrex::ReduceOpMax> reduce_op;
+        amrex::ReduceData<int> reduce_data(reduce_op);
+        using ReduceTuple = typename decltype(reduce_data)::Type;
+        reduce_op.eval(bx, reduce_data,
+            [=] AMREX_GPU_DEVICE (int i, int j, int k) -> ReduceTuple {
+                const amrex::Real val0 = EvalParserAtIndex(macro_parser, i, j, k, iv, coords, t_begin);
+                for (int n = 1; n <= nprobes; ++n) {
+                    const amrex::Real val = EvalParserAtIndex(macro_parser, i, j, k, iv, coords,
+                                                              t_begin + n * dt_probe);
+                    if (val != val0) return 1;
+                }
+                return 0;
+        });
+        box_flags[mfi.index()] = amrex::get<0>(reduce_data.value());
+    }
+    return box_flags;
+}
+
+void
+MacroscopicProperties::UpdateTimeDependentProperties (const int step, const amrex::Real time)
+{
+    if (m_time_dependent_props.empty()) return;
+    if (step % m_properties_update_interval != 0 || time == m_properties_time) return;
+
+    const int lev = m_lev;
+    for (auto const& prop : m_time_dependent_props) {
+        InitializeMacroMultiFabUsingParser(prop.mf, prop.parser->compile<4>(), time, lev,
+                                           &prop.box_is_time_dependent);
+    }
+    m_properties_time = time;
+    ++m_properties_version;
+}
+
+#ifdef WARPX_MAG_LLG
+void
+MacroscopicProperties::InitializeFaceMultiFabsUsingParser (
+                       amrex::Vector<std::array<std::unique_ptr<amrex::MultiFab>, 3> const*> const& macro_mf,
+                       amrex::Vector<amrex::ParserExecutor<3>> const& macro_parser,
+                       const int lev)
+{
+    WarpX& warpx = WarpX::GetInstance();
+    const MeshCoordinates coords = warpx.GetMeshCoordinates(lev);
+    // all the properties have the same face MultiFabs layout
+    MultiFab const& mf_ref = *(*macro_mf[0])[0];
+    amrex::IntVect ivx = (*macro_mf[0])[0]->ixType().toIntVect();
+    amrex::IntVect ivy = (*macro_mf[0])[1]->ixType().toIntVect();
+    amrex::IntVect ivz = (*macro_mf[0])[2]->ixType().toIntVect();
+    const int nprops = static_cast<int>(macro_mf.size());
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#endif
+    for ( amrex::MFIter mfi(mf_ref, TilingIfNotGPU()); mfi.isValid(); ++mfi ) {
+        // Initialize ghost cells in addition to valid cells
+        const amrex::Box& tbx = mfi.tilebox( ivx, (*macro_mf[0])[0]->nGrowVect());
+        const amrex::Box& tby = mfi.tilebox( ivy, (*macro_mf[0])[1]->nGrowVect());
+        const amrex::Box& tbz = mfi.tilebox( ivz, (*macro_mf[0])[2]->nGrowVect());
+        for (int n = 0; n < nprops; ++n) {
+            amrex::ParserExecutor<3> const parser = macro_parser[n];
+            amrex::Array4<amrex::Real> const& macro_x = (*macro_mf[n])[0]->array(mfi);
+            amrex::Array4<amrex::Real> const& macro_y = (*macro_mf[n])[1]->array(mfi);
+            amrex::Array4<amrex::Real> const& macro_z = (*macro_mf[n])[2]->array(mfi);
+            amrex::ParallelFor (tbx, tby, tbz,
+                [=] AMREX_GPU_DEVICE (int i, int j, int k) {
+                    macro_x(i,j,k) = EvalParserAtIndex(parser, i, j, k, ivx, coords);
+                },
+                [=] AMREX_GPU_DEVICE (int i, int j, int k) {
+                    macro_y(i,j,k) = EvalParserAtIndex(parser, i, j, k, ivy, coords);
+                },
+                [=] AMREX_GPU_DEVICE (int i, int j, int k) {
+                    macro_z(i,j,k) = EvalParserAtIndex(parser, i, j, k, ivz, coords);
+            });
+        }
+    }
+}
+#endif
+
+void
+MacroscopicProperties::InitializeMaterialID (const int lev)
+{
+    WarpX& warpx = WarpX::GetInstance();
+    // the faces of the guard cells of the properties need the material of the cells on both sides
+    m_material_id_mf = std::make_unique<amrex::iMultiFab>(warpx.boxArray(lev), warpx.DistributionMap(lev), 1,
+                                                          warpx.getngEB() + amrex::IntVect(1));
+
+    const int nmat = m_material_names.size();
+    if (!m_material_id_file.empty() && lev > 0) {
+        // the voxels of the file are the cells of level 0: the indices are injected from the
+        // coarser level, whose indices are copied on the coarsened boxes of this level first
+        const amrex::IntVect rr = warpx.refRatio(lev-1);
+        amrex::iMultiFab const& crse_id = warpx.GetMacroscopicProperties(lev-1).getmaterial_id_mf();
+        amrex::BoxArray cba = m_material_id_mf->boxArray();
+        cba.coarsen(rr);
+        const amrex::IntVect ng_c = m_material_id_mf->nGrowVect() / rr + amrex::IntVect(1);
+        amrex::iMultiFab crse_tmp(cba, m_material_id_mf->DistributionMap(), 1, ng_c);
+        crse_tmp.ParallelCopy(crse_id, 0, 0, 1, crse_id.nGrowVect(), ng_c, warpx.Geom(lev-1).periodicity());
+        for ( amrex::MFIter mfi(*m_material_id_mf, TilingIfNotGPU()); mfi.isValid(); ++mfi ) {
+            const amrex::Box& tb = mfi.growntilebox();
+            amrex::Array4<int> const& id_arr = m_material_id_mf->array(mfi);
+            amrex::Array4<int const> const& crse_arr = crse_tmp.const_array(mfi);
+            amrex::ParallelFor(tb,
+                [=] AMREX_GPU_DEVICE (int i, int j, int k) {
 #if defined(WARPX_DIM_XZ) || defined(WARPX_DIM_RZ)
-                amrex::Real y = 0._rt;
-                amrex::Real fac_z = (1._rt - iv[1]) * dx_lev[1] * 0.5_rt;
-                amrex::Real z = j * dx_lev[1] + real_box.lo(1) + fac_z;
+                    id_arr(i,j,k) = crse_arr(amrex::coarsen(i,rr[0]), amrex::coarsen(j,rr[1]), k);
 #else
-                amrex::Real fac_y = (1._rt - iv[1]) * dx_lev[1] * 0.5_rt;
-                amrex::Real y = j * dx_lev[1] + real_box.lo(1) + fac_y;
-                amrex::Real fac_z = (1._rt - iv[2]) * dx_lev[2] * 0.5_rt;
-                amrex::Real z = k * dx_lev[2] + real_box.lo(2) + fac_z;
+                    id_arr(i,j,k) = crse_arr(amrex::coarsen(i,rr[0]), amrex::coarsen(j,rr[1]),
+                                             amrex::coarsen(k,rr[2]));
 #endif
-                // initialize the macroparameter
-                macro_fab(i,j,k) = macro_parser(x,y,z);
+            });
+        }
+        return;
+    }
+    if (!m_material_id_file.empty()) {
+        ReadMaterialIDFile(lev);
+        // the voxels are unsigned bytes, so that only the upper bound has to be checked
+        if (m_material_id_mf->max(0, m_material_id_mf->nGrow()) >= nmat) {
+            amrex::Abort(Utils::TextMsg::Err(
+                "macroscopic.material_id_file contains an index larger than "
+                + std::to_string(nmat - 1) + ", the number of macroscopic.material_names minus one"));
+        }
+        return;
+    }
+
+    const MeshCoordinates coords = warpx.GetMeshCoordinates(lev);
+    auto const material_id_parser = m_material_id_parser->compile<3>();
+
+    amrex::ReduceOps<amrex::ReduceOpMax> reduce_op;
+    amrex::ReduceData<int> reduce_data(reduce_op);
+    using ReduceTuple = typename decltype(reduce_data)::Type;
+    for ( amrex::MFIter mfi(*m_material_id_mf, TilingIfNotGPU()); mfi.isValid(); ++mfi ) {
+        // Initialize ghost cells in addition to valid cells
+        const amrex::Box& tb = mfi.growntilebox();
+        amrex::Array4<int> const& id_arr = m_material_id_mf->array(mfi);
+        reduce_op.eval(tb, reduce_data,
+            [=] AMREX_GPU_DEVICE (int i, int j, int k) -> ReduceTuple {
+                // the material indices are evaluated at the cell centers
+                int const id = static_cast<int>(std::round(EvalParserAtIndex(
+                    material_id_parser, i, j, k, amrex::IntVect(0), coords)));
+                int const out_of_table = (id < 0 || id >= nmat) ? 1 : 0;
+                id_arr(i,j,k) = out_of_table ? 0 : id;
+                return {out_of_table};
         });
+    }
+    int out_of_table = amrex::get<0>(reduce_data.value());
+    amrex::ParallelDescriptor::ReduceIntMax(out_of_table);
+    if (out_of_table > 0) {
+        amrex::Abort(Utils::TextMsg::Err(
+            "macroscopic.material_id_function must return an index between 0 and "
+            + std::to_string(nmat - 1) + ", the number of macroscopic.material_names minus one"));
+    }
+}
+
+void
+MacroscopicProperties::ReadMaterialIDFile (const int lev)
+{
+    WarpX& warpx = WarpX::GetInstance();
+    const amrex::Box& domain = warpx.Geom(lev).Domain();
+    const amrex::IntVect domain_lo = domain.smallEnd();
+    const amrex::IntVect n_voxels = domain.length();
+    const amrex::Long nx = n_voxels[0];
+    const amrex::Long ny = n_voxels[1];
+
+    std::ifstream file(m_material_id_file, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        amrex::Abort(Utils::TextMsg::Err("could not open macroscopic.material_id_file " + m_material_id_file));
+    }
+    const amrex::Long file_size = static_cast<amrex::Long>(file.tellg());
+    if (file_size != domain.numPts()) {
+        amrex::Abort(Utils::TextMsg::Err(
+            "macroscopic.material_id_file " + m_material_id_file + " has " + std::to_string(file_size)
+            + " bytes, while it must have one byte per cell of the domain, " + std::to_string(domain.numPts())));
+    }
+
+    // voxel index of a cell: periodic image, or the closest boundary voxel for non-periodic directions
+    auto voxel_index = [&] (int i, int idim) -> amrex::Long {
+        const int n = n_voxels[idim];
+        int iv = i - domain_lo[idim];
+        if (warpx.Geom(lev).isPeriodic(idim)) {
+            iv = ((iv % n) + n) % n;
+        } else {
+            iv = amrex::min(amrex::max(iv, 0), n - 1);
+        }
+        return iv;
+    };
+
+    std::vector<unsigned char> run;
+    for ( amrex::MFIter mfi(*m_material_id_mf); mfi.isValid(); ++mfi ) {
+        const amrex::Box& bx = mfi.fabbox();
+        // the voxels are read on the host, and then copied to the (possibly device) iMultiFab
+        amrex::IArrayBox host_fab(bx, 1, amrex::The_Pinned_Arena());
+        amrex::Array4<int> const& host_arr = host_fab.array();
+        const amrex::Dim3 lo = amrex::lbound(bx);
+        const amrex::Dim3 hi = amrex::ubound(bx);
+
+        // the cells of the box inside the domain along x, read in one contiguous run per (j,k)
+        const int i_in_lo = amrex::max(lo.x, domain.smallEnd(0));
+        const int i_in_hi = amrex::min(hi.x, domain.bigEnd(0));
+        run.resize(amrex::max(i_in_hi - i_in_lo + 1, 1));
+        unsigned char voxel;
+        for (int k = lo.z; k <= hi.z; ++k) {
+            for (int j = lo.y; j <= hi.y; ++j) {
+#if defined(WARPX_DIM_XZ) || defined(WARPX_DIM_RZ)
+                const amrex::Long row = voxel_index(j, 1) * nx;
+                amrex::ignore_unused(ny);
+#else
+                const amrex::Long row = (voxel_index(k, 2) * ny + voxel_index(j, 1)) * nx;
+#endif
+                if (i_in_hi >= i_in_lo) {
+                    file.seekg(row + voxel_index(i_in_lo, 0));
+                    file.read(reinterpret_cast<char*>(run.data()), i_in_hi - i_in_lo + 1);
+                    for (int i = i_in_lo; i <= i_in_hi; ++i) host_arr(i,j,k) = run[i - i_in_lo];
+                }
+                // guard cells outside of the domain along x
+                for (int i = lo.x; i <= hi.x; ++i) {
+                    if (i >= i_in_lo && i <= i_in_hi) continue;
+                    file.seekg(row + voxel_index(i, 0));
+                    file.read(reinterpret_cast<char*>(&voxel), 1);
+                    host_arr(i,j,k) = voxel;
+                }
+            }
+        }
+        if (!file) {
+            amrex::Abort(Utils::TextMsg::Err("error while reading macroscopic.material_id_file " + m_material_id_file));
+        }
+        (*m_material_id_mf)[mfi].copy<amrex::RunOn::Device>(host_fab, bx);
+        amrex::Gpu::streamSynchronize();
+    }
+}
 
+void
+MacroscopicProperties::InitializeMacroMultiFabUsingMaterialID (
+                       amrex::MultiFab *macro_mf,
+                       const int prop)
+{
+    const int nmat = m_material_names.size();
+    amrex::Real const * const AMREX_RESTRICT table = m_material_table.dataPtr();
+    amrex::IntVect iv = macro_mf->ixType().toIntVect();
+    for ( amrex::MFIter mfi(*macro_mf, TilingIfNotGPU()); mfi.isValid(); ++mfi ) {
+        // Initialize ghost cells in addition to valid cells
+        const amrex::Box& tb = mfi.tilebox( iv, macro_mf->nGrowVect());
+        amrex::Array4<amrex::Real> const& macro_fab =  macro_mf->array(mfi);
+        amrex::Array4<int const> const& id_arr = m_material_id_mf->const_array(mfi);
+        amrex::ParallelFor (tb,
+            [=] AMREX_GPU_DEVICE (int i, int j, int k) {
+                // materials of the cells on the lower and upper side of the location (the same cell if cell-centered)
+#if defined(WARPX_DIM_XZ) || defined(WARPX_DIM_RZ)
+                int const id_lo = id_arr(i-iv[0], j-iv[1], k);
+#else
+                int const id_lo = id_arr(i-iv[0], j-iv[1], k-iv[2]);
+#endif
+                int const id_hi = id_arr(i, j, k);
+                amrex::Real const Ms_lo = table[mat_mag_Ms * nmat + id_lo];
+                amrex::Real const Ms_hi = table[mat_mag_Ms * nmat + id_hi];
+                amrex::Real const prop_lo = table[prop * nmat + id_lo];
+                amrex::Real const prop_hi = table[prop * nmat + id_hi];
+                if (Ms_lo > 0._rt && Ms_hi > 0._rt) {
+                    macro_fab(i,j,k) = 0.5_rt * (prop_lo + prop_hi);
+                } else {
+                    macro_fab(i,j,k) = (Ms_lo > 0._rt) ? prop_hi : prop_lo;
+                }
+        });
     }
 }
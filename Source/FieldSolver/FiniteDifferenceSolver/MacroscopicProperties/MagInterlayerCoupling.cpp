@@ -0,0 +1,169 @@
+/* This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+#include "MagInterlayerCoupling.H"
+
+#include "Utils/TextMsg.H"
+#include "Utils/WarpXConst.H"
+#include "Utils/WarpXUtil.H"
+#include "WarpX.H"
+
+#include <AMReX.H>
+#include <AMReX_Box.H>
+#include <AMReX_BoxList.H>
+#include <AMReX_GpuLaunch.H>
+#include <AMReX_IndexType.H>
+#include <AMReX_IntVect.H>
+#include <AMReX_MFIter.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Print.H>
+
+#include <cmath>
+#include <string>
+#include <utility>
+
+using namespace amrex;
+
+#ifdef WARPX_MAG_LLG
+bool
+MagInterlayerCoupling::InInput ()
+{
+    ParmParse pp_interlayer("mag_interlayer");
+    return pp_interlayer.contains("J");
+}
+
+#ifdef WARPX_DIM_3D
+MagInterlayerCoupling::MagInterlayerCoupling (Geometry const& geom, BoxArray const& ba,
+                                              DistributionMapping const& dm)
+    : m_geom(geom)
+{
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(!WarpX::GetInstance().GetGradedMesh().IsGraded(),
+        "mag_interlayer.J is not implemented with a graded mesh");
+
+    ParmParse pp_interlayer("mag_interlayer");
+    getWithParser(pp_interlayer, "J", m_J);
+    Real z_lo = 0._rt, z_hi = 0._rt;
+    getWithParser(pp_interlayer, "z_lo", z_lo);
+    getWithParser(pp_interlayer, "z_hi", z_hi);
+    Real const dz = geom.CellSize(2);
+    m_k_lo = static_cast<int>(std::floor((z_lo - geom.ProbLo(2)) / dz));
+    m_k_hi = static_cast<int>(std::floor((z_hi - geom.ProbLo(2)) / dz));
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(m_k_lo >= geom.Domain().smallEnd(2) && m_k_hi <= geom.Domain().bigEnd(2),
+        "mag_interlayer.z_lo and mag_interlayer.z_hi must be inside the domain");
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(m_k_hi >= m_k_lo + 2,
+        "mag_interlayer.z_hi must be at least two cells above mag_interlayer.z_lo, "
+        "with a spacer of at least one cell, otherwise the layers are coupled by mag_exchange");
+
+    DefineLayout(ba, dm);
+}
+
+void
+MagInterlayerCoupling::DefineLayout (BoxArray const& ba, DistributionMapping const& dm)
+{
+    // the planes keep the owner of their box, so that the M updates access them locally, and
+    // only the planes are exchanged between the ranks of the two layers
+    int const nboxes = ba.size();
+    int nplanes = 0;
+    for (int dir = 0; dir < 3; ++dir) {
+        IndexType const face_type(IntVect::TheDimensionVector(dir));
+        for (int s = 0; s < 2; ++s) {
+            int const k = PlaneK(dir, s);
+            // the planes of the other side are sent to the k of this side
+            int const k_send = PlaneK(dir, 1 - s);
+            m_plane_index[dir][s].assign(nboxes, -1);
+            m_plane_box[dir][s].clear();
+            BoxList plane_bl(face_type), send_bl(face_type);
+            Vector<int> pmap;
+            for (int ibox = 0; ibox < nboxes; ++ibox) {
+                Box b = amrex::convert(ba[ibox], face_type);
+                if (k < b.smallEnd(2) || k > b.bigEnd(2)) continue;
+                b.setSmall(2, k);
+                b.setBig(2, k);
+                m_plane_index[dir][s][ibox] = static_cast<int>(m_plane_box[dir][s].size());
+                m_plane_box[dir][s].push_back(ibox);
+                plane_bl.push_back(b);
+                send_bl.push_back(amrex::shift(b, 2, k_send - k));
+                pmap.push_back(dm[ibox]);
+            }
+            nplanes += static_cast<int>(pmap.size());
+            DistributionMapping const plane_dm(pmap);
+            // M (or H_interlayer) and Ms
+            m_H[dir][s] = std::make_unique<MultiFab>(BoxArray(std::move(plane_bl)), plane_dm, 4, 0);
+            m_send[dir][s] = std::make_unique<MultiFab>(BoxArray(std::move(send_bl)), plane_dm, 4, 0);
+        }
+    }
+    amrex::Print() << Utils::TextMsg::Info(
+        "Interlayer coupling of the cells k = " + std::to_string(m_k_lo) + " and k = "
+        + std::to_string(m_k_hi) + " on " + std::to_string(nplanes) + " face planes");
+}
+
+void
+MagInterlayerCoupling::RemakeLevel (BoxArray const& ba, DistributionMapping const& dm)
+{
+    // H_interlayer is computed again from M by the next Update
+    DefineLayout(ba, dm);
+}
+
+void
+MagInterlayerCoupling::Update (std::array<std::unique_ptr<MultiFab>, 3> const& Mfield,
+                               std::array<MultiFab const*, 3> const& Ms_mf)
+{
+    // H = J M' / (mu0 Ms Ms' dz), zero where one of the faces is not magnetic
+    Real const coef = m_J / (PhysConst::mu0 * m_geom.CellSize(2));
+
+    for (int dir = 0; dir < 3; ++dir) {
+        for (int s = 0; s < 2; ++s) {
+            // M and Ms of the plane of side s, at the k of the plane of the other side
+            int const shift = PlaneK(dir, 1 - s) - PlaneK(dir, s);
+            MultiFab& send = *m_send[dir][s];
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+            for (MFIter mfi(send); mfi.isValid(); ++mfi) {
+                int const ibox = m_plane_box[dir][s][mfi.index()];
+                Array4<Real> const& S = send.array(mfi);
+                Array4<Real const> const& M = Mfield[dir]->const_array(ibox);
+                Array4<Real const> const& Ms = Ms_mf[dir]->const_array(ibox);
+                amrex::ParallelFor(mfi.validbox(), [=] AMREX_GPU_DEVICE (int i, int j, int k) {
+                    for (int comp = 0; comp < 3; ++comp) S(i, j, k, comp) = M(i, j, k - shift, comp);
+                    S(i, j, k, 3) = Ms(i, j, k - shift);
+                });
+            }
+        }
+        for (int s = 0; s < 2; ++s) {
+            MultiFab& H = *m_H[dir][s];
+            H.setVal(0._rt);
+            H.ParallelCopy(*m_send[dir][1 - s], 0, 0, 4);
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+            for (MFIter mfi(H); mfi.isValid(); ++mfi) {
+                int const ibox = m_plane_box[dir][s][mfi.index()];
+                Array4<Real> const& H_arr = H.array(mfi);
+                Array4<Real const> const& Ms = Ms_mf[dir]->const_array(ibox);
+                amrex::ParallelFor(mfi.validbox(), [=] AMREX_GPU_DEVICE (int i, int j, int k) {
+                    Real const Ms_self = Ms(i, j, k);
+                    Real const Ms_other = H_arr(i, j, k, 3);
+                    Real const scale = (Ms_self > 0._rt && Ms_other > 0._rt)
+                        ? coef / (Ms_self * Ms_other) : 0._rt;
+                    for (int comp = 0; comp < 3; ++comp) H_arr(i, j, k, comp) *= scale;
+                });
+            }
+        }
+    }
+}
+
+MagInterlayerField
+MagInterlayerCoupling::GetField (int dir, int ibox) const
+{
+    MagInterlayerField field;
+    int const ilo = m_plane_index[dir][0][ibox];
+    int const ihi = m_plane_index[dir][1][ibox];
+    if (ilo >= 0) field.lo = m_H[dir][0]->const_array(ilo);
+    if (ihi >= 0) field.hi = m_H[dir][1]->const_array(ihi);
+    return field;
+}
+
+#endif // WARPX_DIM_3D
+#endif // WARPX_MAG_LLG
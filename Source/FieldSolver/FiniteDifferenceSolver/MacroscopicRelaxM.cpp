@@ -0,0 +1,179 @@
+/* This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+
+#include "WarpX.H"
+#include "Utils/WarpXAlgorithmSelection.H"
+#include "FiniteDifferenceSolver.H"
+#include "LLGCompileTimeOptions.H"
+#ifndef WARPX_DIM_RZ
+#include "FiniteDifferenceAlgorithms/CartesianYeeAlgorithm.H"
+#endif
+#include "FieldSolver/FiniteDifferenceSolver/MacroscopicProperties/MacroscopicProperties.H"
+#include "FieldSolver/FiniteDifferenceSolver/MacroscopicProperties/MagInterlayerCoupling.H"
+
+#include <AMReX_Gpu.H>
+#include <AMReX_MFIter.H>
+#include <AMReX_MultiFab.H>
+
+#include <array>
+#include <memory>
+
+using namespace amrex;
+
+#ifndef WARPX_DIM_RZ
+#ifdef WARPX_MAG_LLG
+
+void FiniteDifferenceSolver::MacroscopicRelaxGradient (
+    int lev,
+    std::array<std::unique_ptr<amrex::MultiFab>, 3> const &Mfield,
+    std::array<std::unique_ptr<amrex::MultiFab>, 3> const &Hfield,
+    std::array<std::unique_ptr<amrex::MultiFab>, 3> const &H_biasfield,
+    std::array<std::unique_ptr<amrex::MultiFab>, 3> &gradient,
+    std::unique_ptr<MacroscopicProperties> const &macroscopic_properties) {
+
+    if (m_fdtd_algo == MaxwellSolverAlgo::Yee || m_fdtd_algo == MaxwellSolverAlgo::ECT){
+        // the terms of H_eff are selected at compile time, as in the LLG updates; the spin torques
+        // do not derive from an energy and are not included
+        auto &warpx = WarpX::GetInstance();
+        LLGOptions::Dispatch<0,1>(warpx.mag_LLG_coupling, "warpx.mag_LLG_coupling", [&] (auto c) {
+        LLGOptions::Dispatch<0,1>(warpx.mag_LLG_exchange_coupling, "warpx.mag_LLG_exchange_coupling", [&] (auto e) {
+        LLGOptions::Dispatch<0,1>(warpx.mag_LLG_anisotropy_coupling, "warpx.mag_LLG_anisotropy_coupling", [&] (auto a) {
+            MacroscopicRelaxGradientCartesian<CartesianYeeAlgorithm, decltype(c)::value, decltype(e)::value, decltype(a)::value>(
+                lev, Mfield, Hfield, H_biasfield, gradient, macroscopic_properties);
+        });
+        });
+        });
+    } else {
+        amrex::Abort("Only yee algorithm is compatible for M updates.");
+    }
+}
+
+template <typename T_Algo, int T_coupling, int T_exchange_coupling, int T_anisotropy_coupling>
+void FiniteDifferenceSolver::MacroscopicRelaxGradientCartesian (
+    int lev,
+    std::array<std::unique_ptr<amrex::MultiFab>, 3> const &Mfield,
+    std::array<std::unique_ptr<amrex::MultiFab>, 3> const &Hfield,
+    std::array<std::unique_ptr<amrex::MultiFab>, 3> const &H_biasfield,
+    std::array<std::unique_ptr<amrex::MultiFab>, 3> &gradient,
+    std::unique_ptr<MacroscopicProperties> const &macroscopic_properties) {
+
+    constexpr int coupling = T_coupling;
+    constexpr int mag_exchange_coupling = T_exchange_coupling;
+    constexpr int mag_anisotropy_coupling = T_anisotropy_coupling;
+
+    auto &warpx = WarpX::GetInstance();
+    // anisotropy axes of the grains, and type of the anisotropy
+    amrex::Real const* const anisotropy_axes = macroscopic_properties->getmag_anisotropy_axes();
+    int const anisotropy_type = macroscopic_properties->getmag_anisotropy_type();
+    int const DMI_type = macroscopic_properties->getmag_DMI_type();
+    bool const H_bias_uniform = (H_biasfield[0] == nullptr);
+    amrex::GpuArray<amrex::Real, 3> const H_bias_value = H_bias_uniform
+        ? warpx.getH_bias_uniform(lev) : amrex::GpuArray<amrex::Real, 3>{0._rt, 0._rt, 0._rt};
+
+    amrex::IntVect const Hx_stag = Hfield[0]->ixType().toIntVect();
+    amrex::IntVect const Hy_stag = Hfield[1]->ixType().toIntVect();
+    amrex::IntVect const Hz_stag = Hfield[2]->ixType().toIntVect();
+
+    // Extract stencil coefficients for calculating the exchange field H_exchange
+    amrex::Real const *const AMREX_RESTRICT coefs_x = m_stencil_coefs_x.dataPtr();
+    int const n_coefs_x = m_stencil_coefs_x.size();
+    amrex::Real const *const AMREX_RESTRICT coefs_y = m_stencil_coefs_y.dataPtr();
+    int const n_coefs_y = m_stencil_coefs_y.size();
+    amrex::Real const *const AMREX_RESTRICT coefs_z = m_stencil_coefs_z.dataPtr();
+    int const n_coefs_z = m_stencil_coefs_z.size();
+
+    // interlayer exchange field of the current M
+    macroscopic_properties->UpdateInterlayerCoupling(Mfield);
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi(*Mfield[0], TilingIfNotGPU()); mfi.isValid(); ++mfi) {
+        bool const has_material = macroscopic_properties->has_magnetic_material(mfi.index());
+
+        Array4<Real> const &Hx = Hfield[0]->array(mfi);
+        Array4<Real> const &Hy = Hfield[1]->array(mfi);
+        Array4<Real> const &Hz = Hfield[2]->array(mfi);
+        Array4<Real> const Hx_bias = H_bias_uniform ? Array4<Real>{} : H_biasfield[0]->array(mfi);
+        Array4<Real> const Hy_bias = H_bias_uniform ? Array4<Real>{} : H_biasfield[1]->array(mfi);
+        Array4<Real> const Hz_bias = H_bias_uniform ? Array4<Real>{} : H_biasfield[2]->array(mfi);
+
+        // M on the faces of each direction, with its x, y and z components
+        for (int face = 0; face < 3; ++face) {
+            amrex::IntVect const M_stag = Mfield[face]->ixType().toIntVect();
+            Box const &tb = mfi.tilebox(M_stag);
+            Array4<Real> const &M = Mfield[face]->array(mfi);
+            Array4<Real> const &G = gradient[face]->array(mfi);
+            if (!has_material) {
+                amrex::ParallelFor(tb, 3, [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) {
+                    G(i, j, k, n) = 0._rt;
+                });
+                continue;
+            }
+            Array4<Real> const &mag_Ms_arr = macroscopic_properties->getmag_Ms_mf(face).array(mfi);
+            Array4<MacroscopicProperties::MagCoefReal const> const &mag_coefs_arr = macroscopic_properties->getmag_coefs_mf(face).const_array(mfi);
+            Array4<int const> const grain_arr = macroscopic_properties->getmag_grain_array(face, mfi);
+            MagInterlayerField const interlayer = macroscopic_properties->GetInterlayerField(face, mfi);
+
+            amrex::ParallelFor(tb, [=] AMREX_GPU_DEVICE (int i, int j, int k) {
+
+                amrex::Real const Ms = mag_Ms_arr(i, j, k);
+                if (Ms <= 0._rt) {
+                    for (int comp = 0; comp < 3; ++comp) G(i, j, k, comp) = 0._rt;
+                    return;
+                }
+
+                // H_eff = H_maxwell + H_bias + H_exchange + H_DMI + H_anisotropy + H_interlayer, as in the LLG updates
+                amrex::Real Hx_eff = MacroscopicProperties::getH_bias(i, j, k, Hx_stag, M_stag, Hx_bias, H_bias_uniform, H_bias_value[0]);
+                amrex::Real Hy_eff = MacroscopicProperties::getH_bias(i, j, k, Hy_stag, M_stag, Hy_bias, H_bias_uniform, H_bias_value[1]);
+                amrex::Real Hz_eff = MacroscopicProperties::getH_bias(i, j, k, Hz_stag, M_stag, Hz_bias, H_bias_uniform, H_bias_value[2]);
+
+                if (coupling == 1){
+                    Hx_eff += MacroscopicProperties::face_avg_to_face(i, j, k, 0, Hx_stag, M_stag, Hx);
+                    Hy_eff += MacroscopicProperties::face_avg_to_face(i, j, k, 0, Hy_stag, M_stag, Hy);
+                    Hz_eff += MacroscopicProperties::face_avg_to_face(i, j, k, 0, Hz_stag, M_stag, Hz);
+                }
+
+                if (mag_exchange_coupling == 1){
+                    amrex::Real const H_exchange_coeff = mag_coefs_arr(i, j, k, MacroscopicProperties::mag_coef_exchange);
+                    amrex::Real const Ms_lo_x = mag_Ms_arr(i-1, j, k);
+                    amrex::Real const Ms_hi_x = mag_Ms_arr(i+1, j, k);
+                    amrex::Real const Ms_lo_y = mag_Ms_arr(i, j-1, k);
+                    amrex::Real const Ms_hi_y = mag_Ms_arr(i, j+1, k);
+                    amrex::Real const Ms_lo_z = mag_Ms_arr(i, j, k-1);
+                    amrex::Real const Ms_hi_z = mag_Ms_arr(i, j, k+1);
+                    Hx_eff += H_exchange_coeff * T_Algo::Laplacian_Mag(M, coefs_x, coefs_y, coefs_z, n_coefs_x, n_coefs_y, n_coefs_z, Ms_lo_x, Ms_hi_x, Ms_lo_y, Ms_hi_y, Ms_lo_z, Ms_hi_z, i, j, k, 0, face);
+                    Hy_eff += H_exchange_coeff * T_Algo::Laplacian_Mag(M, coefs_x, coefs_y, coefs_z, n_coefs_x, n_coefs_y, n_coefs_z, Ms_lo_x, Ms_hi_x, Ms_lo_y, Ms_hi_y, Ms_lo_z, Ms_hi_z, i, j, k, 1, face);
+                    Hz_eff += H_exchange_coeff * T_Algo::Laplacian_Mag(M, coefs_x, coefs_y, coefs_z, n_coefs_x, n_coefs_y, n_coefs_z, Ms_lo_x, Ms_hi_x, Ms_lo_y, Ms_hi_y, Ms_lo_z, Ms_hi_z, i, j, k, 2, face);
+                    if (DMI_type != 0){
+                        T_Algo::AddDMIField_Mag(M, coefs_x, coefs_y, coefs_z, n_coefs_x, n_coefs_y, n_coefs_z, Ms_lo_x, Ms_hi_x, Ms_lo_y, Ms_hi_y, Ms_lo_z, Ms_hi_z, i, j, k, face, DMI_type,
+                                                mag_coefs_arr(i, j, k, MacroscopicProperties::mag_coef_DMI), Hx_eff, Hy_eff, Hz_eff);
+                    }
+                }
+
+                if (mag_anisotropy_coupling == 1){
+                    amrex::Real const H_anisotropy_coeff = mag_coefs_arr(i, j, k, MacroscopicProperties::mag_coef_anisotropy);
+                    MacroscopicProperties::addH_anisotropy(i, j, k, grain_arr, anisotropy_axes, anisotropy_type, H_anisotropy_coeff,
+                                                           M(i, j, k, 0), M(i, j, k, 1), M(i, j, k, 2), Hx_eff, Hy_eff, Hz_eff);
+                }
+
+                interlayer.AddEffectiveField(i, j, k, Hx_eff, Hy_eff, Hz_eff);
+
+                // gradient of the energy on the unit sphere, m x (m x H_eff) = (m.H_eff) m - H_eff,
+                // with m = M / Ms
+                amrex::Real const mx = M(i, j, k, 0) / Ms;
+                amrex::Real const my = M(i, j, k, 1) / Ms;
+                amrex::Real const mz = M(i, j, k, 2) / Ms;
+                amrex::Real const m_dot_H = mx * Hx_eff + my * Hy_eff + mz * Hz_eff;
+                G(i, j, k, 0) = m_dot_H * mx - Hx_eff;
+                G(i, j, k, 1) = m_dot_H * my - Hy_eff;
+                G(i, j, k, 2) = m_dot_H * mz - Hz_eff;
+            });
+        }
+    }
+}
+
+#endif // ifdef WARPX_MAG_LLG
+#endif // ifndef WARPX_DIM_RZ
@@ -0,0 +1,125 @@
+/* This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+#include "LumpedElements.H"
+
+#include "Utils/TextMsg.H"
+#include "Utils/WarpXUtil.H"
+#include "WarpX.H"
+
+#include <AMReX.H>
+#include <AMReX_Array4.H>
+#include <AMReX_Box.H>
+#include <AMReX_GpuLaunch.H>
+#include <AMReX_GpuQualifiers.H>
+#include <AMReX_IndexType.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_ParmParse.H>
+
+#include <cmath>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace amrex;
+
+namespace
+{
+    /** Direction (0, 1 or 2 for x, y, z) of the index dimension idim */
+    int PhysicalDim (int idim)
+    {
+#if defined(WARPX_DIM_3D)
+        return idim;
+#elif defined(WARPX_DIM_XZ) || defined(WARPX_DIM_RZ)
+        return (idim == 0) ? 0 : 2;
+#else
+        amrex::ignore_unused(idim);
+        return 2;
+#endif
+    }
+}
+
+bool
+LumpedElements::InInput ()
+{
+    ParmParse pp_lumped("lumped_elements");
+    return pp_lumped.contains("names");
+}
+
+LumpedElements::LumpedElements (Geometry const& geom)
+{
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(!WarpX::GetInstance().GetGradedMesh().IsGraded(),
+        "The lumped elements are not implemented with a graded mesh");
+
+    ParmParse pp_lumped("lumped_elements");
+    std::vector<std::string> names;
+    pp_lumped.getarr("names", names);
+
+    for (auto const& name : names) {
+        ParmParse pp_element(name);
+        Element e;
+        e.name = name;
+
+        std::string direction;
+        pp_element.get("direction", direction);
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(direction.size() == 1
+            && std::string("xyz").find(direction[0]) != std::string::npos,
+            name + ".direction must be x, y or z");
+        e.dir = static_cast<int>(std::string("xyz").find(direction[0]));
+
+        // the edge of the element: the cell along its direction, and the nearest nodes across it
+        std::vector<Real> position;
+        getArrWithParser(pp_element, "position", position, 0, 3);
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+            int const d = PhysicalDim(idim);
+            Real const s = (position[d] - geom.ProbLo(idim)) / geom.CellSize(idim);
+            e.iv[idim] = (d == e.dir) ? static_cast<int>(std::floor(s)) : static_cast<int>(std::round(s));
+        }
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(amrex::surroundingNodes(geom.Domain()).contains(e.iv),
+            name + ".position must be inside the domain");
+
+        queryWithParser(pp_element, "resistance", e.R);
+        queryWithParser(pp_element, "inductance", e.L);
+        queryWithParser(pp_element, "capacitance", e.C);
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(e.R >= 0._rt && e.L >= 0._rt && e.C >= 0._rt,
+            name + ".resistance, inductance and capacitance must be non-negative");
+        std::string voltage_str;
+        if (pp_element.contains("voltage_function(t)")) {
+            WARPX_ALWAYS_ASSERT_WITH_MESSAGE(e.R > 0._rt,
+                name + ".voltage_function(t) requires a positive " + name + ".resistance");
+            Store_parserString(pp_element, "voltage_function(t)", voltage_str);
+            e.voltage_parser = std::make_unique<Parser>(makeParser(voltage_str, {"t"}));
+        }
+        m_elements.push_back(std::move(e));
+    }
+    amrex::Print() << Utils::TextMsg::Info(std::to_string(m_elements.size()) + " lumped elements");
+}
+
+int
+LumpedElements::OwnerBox (BoxArray const& ba, Element const& e)
+{
+    std::vector<std::pair<int, Box>> const isects = ba.intersections(Box(e.iv, e.iv, ba.ixType()));
+    int owner = -1;
+    for (auto const& isect : isects) {
+        if (owner < 0 || isect.first < owner) owner = isect.first;
+    }
+    return owner;
+}
+
+void
+LumpedElements::WriteE (std::array<std::unique_ptr<MultiFab>, 3>& Efield) const
+{
+    for (auto const& e : m_elements) {
+        MultiFab& E = *Efield[e.dir];
+        std::vector<std::pair<int, Box>> const isects = E.boxArray().intersections(Box(e.iv, e.iv, E.ixType()));
+        for (auto const& isect : isects) {
+            if (E.DistributionMap()[isect.first] != ParallelDescriptor::MyProc()) continue;
+            Array4<Real> const& E_arr = E.array(isect.first);
+            Real const E_new = e.E_new;
+            amrex::ParallelFor(isect.second, [=] AMREX_GPU_DEVICE (int i, int j, int k) {
+                E_arr(i, j, k) = E_new;
+            });
+        }
+    }
+}
@@ -0,0 +1,180 @@
+/* This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+#include "WarpX.H"
+
+#include "FieldSolver/FiniteDifferenceSolver/FiniteDifferenceSolver.H"
+#include "FieldSolver/FiniteDifferenceSolver/MacroscopicProperties/MacroscopicProperties.H"
+#include "Parallelization/GuardCellManager.H"
+#include "Utils/TextMsg.H"
+#include "Utils/WarpXProfilerWrapper.H"
+
+#include <AMReX_Array4.H>
+#include <AMReX_GpuLaunch.H>
+#include <AMReX_MFIter.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_Print.H>
+#include <AMReX_REAL.H>
+#include <AMReX_Reduce.H>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <memory>
+#include <string>
+
+using namespace amrex;
+
+#ifdef WARPX_MAG_LLG
+namespace
+{
+    using FaceMultiFabs = std::array<std::unique_ptr<amrex::MultiFab>, 3>;
+
+    /** Sums over the magnetic points of s.s, s.y and y.y, with s = (M - M_old)/Ms and
+     *  y = G - G_old, and maximum of |G| */
+    struct RelaxNorms
+    {
+        amrex::Real ss = 0.;
+        amrex::Real sy = 0.;
+        amrex::Real yy = 0.;
+        amrex::Real G_max = 0.;
+    };
+
+    RelaxNorms ComputeRelaxNorms (FaceMultiFabs const& M, FaceMultiFabs const& M_old,
+                                  FaceMultiFabs const& G, FaceMultiFabs const& G_old,
+                                  MacroscopicProperties& properties, bool with_steps)
+    {
+        amrex::ReduceOps<amrex::ReduceOpSum, amrex::ReduceOpSum, amrex::ReduceOpSum, amrex::ReduceOpMax> reduce_op;
+        amrex::ReduceData<amrex::Real, amrex::Real, amrex::Real, amrex::Real> reduce_data(reduce_op);
+        using ReduceTuple = typename decltype(reduce_data)::Type;
+        for (int face = 0; face < 3; ++face) {
+            for (MFIter mfi(*M[face]); mfi.isValid(); ++mfi) {
+                Box const& bx = mfi.validbox();
+                Array4<Real const> const& M_arr = M[face]->const_array(mfi);
+                Array4<Real const> const& M_old_arr = M_old[face]->const_array(mfi);
+                Array4<Real const> const& G_arr = G[face]->const_array(mfi);
+                Array4<Real const> const& G_old_arr = G_old[face]->const_array(mfi);
+                Array4<Real const> const& Ms_arr = properties.getmag_Ms_mf(face).const_array(mfi);
+                reduce_op.eval(bx, reduce_data,
+                    [=] AMREX_GPU_DEVICE (int i, int j, int k) -> ReduceTuple {
+                        amrex::Real const Ms = Ms_arr(i, j, k);
+                        if (Ms <= 0._rt) return {0._rt, 0._rt, 0._rt, 0._rt};
+                        amrex::Real ss = 0._rt, sy = 0._rt, yy = 0._rt, GG = 0._rt;
+                        for (int comp = 0; comp < 3; ++comp) {
+                            GG += G_arr(i, j, k, comp) * G_arr(i, j, k, comp);
+                            if (with_steps) {
+                                amrex::Real const s = (M_arr(i, j, k, comp) - M_old_arr(i, j, k, comp)) / Ms;
+                                amrex::Real const y = G_arr(i, j, k, comp) - G_old_arr(i, j, k, comp);
+                                ss += s * s;
+                                sy += s * y;
+                                yy += y * y;
+                            }
+                        }
+                        return {ss, sy, yy, std::sqrt(GG)};
+                });
+            }
+        }
+        auto const hv = reduce_data.value();
+        RelaxNorms norms;
+        amrex::Real sums[3] = {amrex::get<0>(hv), amrex::get<1>(hv), amrex::get<2>(hv)};
+        ParallelDescriptor::ReduceRealSum(sums, 3);
+        norms.ss = sums[0];
+        norms.sy = sums[1];
+        norms.yy = sums[2];
+        norms.G_max = amrex::get<3>(hv);
+        ParallelDescriptor::ReduceRealMax(norms.G_max);
+        return norms;
+    }
+}
+
+void
+WarpX::RelaxMagnetization ()
+{
+    WARPX_PROFILE("WarpX::RelaxMagnetization");
+
+    // the LLG solver, and hence the relaxation, is only implemented on level 0
+    int const lev = 0;
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(finest_level == 0,
+        "warpx.mag_relax = 1 is only implemented without mesh refinement");
+
+    MacroscopicProperties& properties = *m_macroscopic_properties[lev];
+    FaceMultiFabs& M = Mfield_fp[lev];
+    FaceMultiFabs G, G_old, M_old;
+    for (int face = 0; face < 3; ++face) {
+        G[face] = std::make_unique<MultiFab>(M[face]->boxArray(), M[face]->DistributionMap(), 3, 0);
+        G_old[face] = std::make_unique<MultiFab>(M[face]->boxArray(), M[face]->DistributionMap(), 3, 0);
+        M_old[face] = std::make_unique<MultiFab>(M[face]->boxArray(), M[face]->DistributionMap(), 3, 0);
+    }
+    bool const update_H = (mag_magnetostatic == 1 || m_init_static_H == 1);
+
+    // largest rotation of m in one iteration, in radians
+    amrex::Real constexpr max_rotation = 0.5_rt;
+    // rotation of the first iteration, and of the iterations where the Barzilai-Borwein step is undefined
+    amrex::Real constexpr default_rotation = 0.01_rt;
+
+    int iter = 0;
+    RelaxNorms norms;
+    for (; ; ++iter) {
+        m_fdtd_solver_fp[lev]->MacroscopicRelaxGradient(lev, M, Hfield_fp[lev], H_biasfield_fp[lev], G, m_macroscopic_properties[lev]);
+        norms = ComputeRelaxNorms(M, M_old, G, G_old, properties, iter > 0);
+        if (norms.G_max < m_mag_relax_tolerance || iter == m_mag_relax_max_iter) break;
+
+        // Barzilai-Borwein steps, alternating between the long and the short one
+        amrex::Real tau = default_rotation / norms.G_max;
+        if (iter > 0 && norms.sy > 0._rt) {
+            tau = (iter % 2 == 1) ? norms.ss / norms.sy : norms.sy / norms.yy;
+        }
+        tau = std::min(tau, max_rotation / norms.G_max);
+
+        // M = Ms (m - tau G) / |m - tau G|
+        for (int face = 0; face < 3; ++face) {
+            MultiFab::Copy(*M_old[face], *M[face], 0, 0, 3, 0);
+            MultiFab::Copy(*G_old[face], *G[face], 0, 0, 3, 0);
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+            for (MFIter mfi(*M[face], TilingIfNotGPU()); mfi.isValid(); ++mfi) {
+                Box const& tb = mfi.tilebox();
+                Array4<Real> const& M_arr = M[face]->array(mfi);
+                Array4<Real const> const& G_arr = G[face]->const_array(mfi);
+                Array4<Real const> const& Ms_arr = properties.getmag_Ms_mf(face).const_array(mfi);
+                amrex::ParallelFor(tb, [=] AMREX_GPU_DEVICE (int i, int j, int k) {
+                    amrex::Real const Ms = Ms_arr(i, j, k);
+                    if (Ms <= 0._rt) return;
+                    amrex::Real m[3];
+                    amrex::Real m_norm = 0._rt;
+                    for (int comp = 0; comp < 3; ++comp) {
+                        m[comp] = M_arr(i, j, k, comp) / Ms - tau * G_arr(i, j, k, comp);
+                        m_norm += m[comp] * m[comp];
+                    }
+                    m_norm = std::sqrt(m_norm);
+                    for (int comp = 0; comp < 3; ++comp) {
+                        M_arr(i, j, k, comp) = Ms * m[comp] / m_norm;
+                    }
+                });
+            }
+        }
+        FillBoundaryM(guard_cells.ng_alloc_EB);
+
+        // demagnetizing field of the new M
+        if (update_H) ComputeMagnetostaticField();
+    }
+
+    // B is computed from H and M when it is read, see ComputeBfieldFromHM
+    MarkFieldModified(tracked_M);
+    m_Bfield_outdated = true;
+
+    if (verbose) {
+        amrex::Print() << Utils::TextMsg::Info(
+            "Relaxation of M: " + std::to_string(iter) + " iterations, largest torque |M x H_eff|/Ms = "
+            + std::to_string(norms.G_max) + " A/m");
+    }
+    if (norms.G_max >= m_mag_relax_tolerance) {
+        RecordWarning("LLG",
+            "The relaxation of M did not reach warpx.mag_relax_tolerance in warpx.mag_relax_max_iter iterations",
+            WarnPriority::medium);
+    }
+}
+#endif
@@ -0,0 +1,338 @@
+/* This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+#include "MagThinFilm.H"
+
+#include "Utils/TextMsg.H"
+#include "Utils/WarpXConst.H"
+#include "Utils/WarpXUtil.H"
+#include "WarpX.H"
+
+#include <AMReX.H>
+#include <AMReX_Array4.H>
+#include <AMReX_Box.H>
+#include <AMReX_BoxList.H>
+#include <AMReX_GpuLaunch.H>
+#include <AMReX_GpuQualifiers.H>
+#include <AMReX_MFIter.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Parser.H>
+#include <AMReX_Print.H>
+
+#include <cmath>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace amrex;
+
+#ifdef WARPX_MAG_LLG
+bool
+MagThinFilm::InInput ()
+{
+    ParmParse pp_film("mag_thin_film");
+    return pp_film.contains("z");
+}
+
+#ifdef WARPX_DIM_3D
+MagThinFilm::MagThinFilm (Geometry const& geom, BoxArray const& ba, DistributionMapping const& dm)
+    : m_geom(geom)
+{
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(!WarpX::GetInstance().GetGradedMesh().IsGraded(),
+        "The magnetic thin film is not implemented with a graded mesh");
+
+    ParmParse pp_film("mag_thin_film");
+    Real const dz = geom.CellSize(2);
+    getWithParser(pp_film, "z", m_z);
+    m_thickness = dz;
+    queryWithParser(pp_film, "thickness", m_thickness);
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(m_thickness > 0._rt && m_thickness <= dz,
+        "mag_thin_film.thickness must be positive and at most the cell size along z");
+    m_kf = static_cast<int>(std::floor((m_z - geom.ProbLo(2)) / dz));
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(m_kf >= geom.Domain().smallEnd(2) && m_kf <= geom.Domain().bigEnd(2),
+        "mag_thin_film.z must be inside the domain");
+    m_fraction = m_thickness / dz;
+
+    Store_parserString(pp_film, "Ms_function(x,y)", m_str_Ms_function);
+    getWithParser(pp_film, "alpha", m_alpha);
+    getWithParser(pp_film, "gamma", m_gamma);
+    queryWithParser(pp_film, "exchange", m_exchange);
+    queryWithParser(pp_film, "anisotropy", m_anisotropy);
+    std::vector<Real> axis;
+    if (queryArrWithParser(pp_film, "anisotropy_axis", axis, 0, 3)) {
+        for (int comp = 0; comp < 3; ++comp) m_anisotropy_axis[comp] = axis[comp];
+    }
+    std::vector<Real> direction;
+    getArrWithParser(pp_film, "M_direction", direction, 0, 3);
+    Real const norm = std::sqrt(direction[0]*direction[0] + direction[1]*direction[1] + direction[2]*direction[2]);
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(norm > 0._rt, "mag_thin_film.M_direction must be non-zero");
+    for (int comp = 0; comp < 3; ++comp) m_M_direction[comp] = direction[comp] / norm;
+
+    DefineLayout(ba, dm);
+
+    // the properties of the film cells, and zero Ms outside of the domain, so that the
+    // exchange field has no gradient across the edges of the film
+    Parser Ms_parser = makeParser(m_str_Ms_function, {"x", "y"});
+    auto const Ms_func = Ms_parser.compile<2>();
+    GpuArray<Real, 3> const dx = geom.CellSizeArray();
+    GpuArray<Real, 3> const problo = geom.ProbLoArray();
+    Real const alpha = m_alpha;
+    Real const gammaL = m_gamma / (1._rt + m_alpha * m_alpha);
+    Real const exchange = m_exchange;
+    Real const anisotropy = m_anisotropy;
+    GpuArray<Real, 3> const M_direction = m_M_direction;
+    m_props->setVal(0._rt);
+    m_M->setVal(0._rt);
+    for (MFIter mfi(*m_props); mfi.isValid(); ++mfi) {
+        Array4<Real> const& props = m_props->array(mfi);
+        Array4<Real> const& M = m_M->array(mfi);
+        amrex::ParallelFor(mfi.validbox(), [=] AMREX_GPU_DEVICE (int i, int j, int k) {
+            Real const x = problo[0] + (i + 0.5_rt) * dx[0];
+            Real const y = problo[1] + (j + 0.5_rt) * dx[1];
+            Real const Ms = Ms_func(x, y);
+            if (Ms <= 0._rt) return;
+            Real const inv_mu0_Ms2 = 1._rt / (PhysConst::mu0 * Ms * Ms);
+            props(i, j, k, film_Ms) = Ms;
+            props(i, j, k, film_alpha) = alpha;
+            props(i, j, k, film_gammaL) = gammaL;
+            props(i, j, k, film_exchange) = 2._rt * exchange * inv_mu0_Ms2;
+            props(i, j, k, film_anisotropy) = - 2._rt * anisotropy * inv_mu0_Ms2;
+            for (int comp = 0; comp < 3; ++comp) M(i, j, k, comp) = Ms * M_direction[comp];
+        });
+    }
+    // the parser is released at the end of the constructor
+    Gpu::streamSynchronize();
+    m_props->FillBoundary(geom.periodicity());
+    m_M->FillBoundary(geom.periodicity());
+    m_dM->setVal(0._rt);
+}
+
+void
+MagThinFilm::DefineLayout (BoxArray const& ba, DistributionMapping const& dm)
+{
+    // the boxes of the film keep their owner, so that the film accesses the fields of the grid locally
+    int const nboxes = ba.size();
+    m_film_index.assign(nboxes, -1);
+    m_face_index.assign(nboxes, -1);
+    m_film_box.clear();
+    m_face_box.clear();
+    BoxList film_bl, face_bl;
+    Vector<int> film_pmap, face_pmap;
+    for (int ibox = 0; ibox < nboxes; ++ibox) {
+        Box b = ba[ibox];
+        int const klo = b.smallEnd(2);
+        int const khi = b.bigEnd(2);
+        b.setSmall(2, m_kf);
+        b.setBig(2, m_kf);
+        if (klo <= m_kf && m_kf <= khi) {
+            m_film_index[ibox] = static_cast<int>(m_film_box.size());
+            m_film_box.push_back(ibox);
+            film_bl.push_back(b);
+            film_pmap.push_back(dm[ibox]);
+        }
+        // the z faces k_f and k_f+1 of the film cells may also be the first or last z faces of a box
+        if (klo <= m_kf + 1 && m_kf <= khi + 1) {
+            m_face_index[ibox] = static_cast<int>(m_face_box.size());
+            m_face_box.push_back(ibox);
+            face_bl.push_back(b);
+            face_pmap.push_back(dm[ibox]);
+        }
+    }
+    amrex::Print() << Utils::TextMsg::Info(
+        "Magnetic thin film in the cells k = " + std::to_string(m_kf) + " of "
+        + std::to_string(m_film_box.size()) + " of " + std::to_string(nboxes) + " boxes");
+
+    // in-plane guard cells for the exchange field and the moment on the faces of the edge cells
+    IntVect const ng(1, 1, 0);
+    BoxArray const film_ba(std::move(film_bl));
+    DistributionMapping const film_dm(film_pmap);
+    m_M = std::make_unique<MultiFab>(film_ba, film_dm, 3, ng);
+    m_dM = std::make_unique<MultiFab>(film_ba, film_dm, 3, ng);
+    m_props = std::make_unique<MultiFab>(film_ba, film_dm, film_nprops, ng);
+    m_face_M = std::make_unique<MultiFab>(BoxArray(std::move(face_bl)), DistributionMapping(face_pmap), 3, ng);
+}
+
+void
+MagThinFilm::RemakeLevel (BoxArray const& ba, DistributionMapping const& dm)
+{
+    std::unique_ptr<MultiFab> M_old = std::move(m_M);
+    std::unique_ptr<MultiFab> props_old = std::move(m_props);
+    DefineLayout(ba, dm);
+    m_M->setVal(0._rt);
+    m_props->setVal(0._rt);
+    m_dM->setVal(0._rt);
+    m_M->ParallelCopy(*M_old, 0, 0, 3);
+    m_props->ParallelCopy(*props_old, 0, 0, film_nprops);
+    m_M->FillBoundary(m_geom.periodicity());
+    m_props->FillBoundary(m_geom.periodicity());
+}
+
+void
+MagThinFilm::EvolveM (std::array<std::unique_ptr<MultiFab>, 3> const& Hfield,
+                      std::array<std::unique_ptr<MultiFab>, 3> const& H_biasfield,
+                      Real dt_M)
+{
+    auto& warpx = WarpX::GetInstance();
+    int const coupling = warpx.mag_LLG_coupling;
+    int const exchange_coupling = warpx.mag_LLG_exchange_coupling;
+    int const anisotropy_coupling = warpx.mag_LLG_anisotropy_coupling;
+    bool const H_bias_uniform = (H_biasfield[0] == nullptr);
+    GpuArray<Real, 3> const H_bias_value = H_bias_uniform
+        ? warpx.getH_bias_uniform(0) : GpuArray<Real, 3>{0._rt, 0._rt, 0._rt};
+    GpuArray<Real, 3> const anisotropy_axis = m_anisotropy_axis;
+    Real const inv_dx2 = 1._rt / (m_geom.CellSize(0) * m_geom.CellSize(0));
+    Real const inv_dy2 = 1._rt / (m_geom.CellSize(1) * m_geom.CellSize(1));
+    // out-of-plane demagnetizing field of the film, -M_z, less the part -f/2 M_z that the
+    // H of the grid already holds at the film cells with the coupling
+    Real const demag = (coupling == 1) ? 1._rt - 0.5_rt * m_fraction : 1._rt;
+
+    // M^n, with the guard cells read by the exchange field
+    MultiFab::Copy(*m_dM, *m_M, 0, 0, 3, m_M->nGrowVect());
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi(*m_M, TilingIfNotGPU()); mfi.isValid(); ++mfi) {
+        int const ibox = m_film_box[mfi.index()];
+        Box const& tb = mfi.tilebox();
+        Array4<Real> const& M = m_M->array(mfi);
+        Array4<Real const> const& M_old = m_dM->const_array(mfi);
+        Array4<Real const> const& props = m_props->const_array(mfi);
+        Array4<Real const> const& Hx = Hfield[0]->const_array(ibox);
+        Array4<Real const> const& Hy = Hfield[1]->const_array(ibox);
+        Array4<Real const> const& Hz = Hfield[2]->const_array(ibox);
+        Array4<Real const> const Hx_bias = H_bias_uniform ? Array4<Real const>{} : H_biasfield[0]->const_array(ibox);
+        Array4<Real const> const Hy_bias = H_bias_uniform ? Array4<Real const>{} : H_biasfield[1]->const_array(ibox);
+        Array4<Real const> const Hz_bias = H_bias_uniform ? Array4<Real const>{} : H_biasfield[2]->const_array(ibox);
+
+        amrex::ParallelFor(tb, [=] AMREX_GPU_DEVICE (int i, int j, int k) {
+            Real const Ms = props(i, j, k, film_Ms);
+            if (Ms <= 0._rt) return;
+
+            // H_eff at the center of the film cell, from the faces of the cell
+            Real H_eff[3];
+            H_eff[0] = H_bias_uniform ? H_bias_value[0] : 0.5_rt * (Hx_bias(i, j, k) + Hx_bias(i+1, j, k));
+            H_eff[1] = H_bias_uniform ? H_bias_value[1] : 0.5_rt * (Hy_bias(i, j, k) + Hy_bias(i, j+1, k));
+            H_eff[2] = H_bias_uniform ? H_bias_value[2] : 0.5_rt * (Hz_bias(i, j, k) + Hz_bias(i, j, k+1));
+            if (coupling == 1) {
+                H_eff[0] += 0.5_rt * (Hx(i, j, k) + Hx(i+1, j, k));
+                H_eff[1] += 0.5_rt * (Hy(i, j, k) + Hy(i, j+1, k));
+                H_eff[2] += 0.5_rt * (Hz(i, j, k) + Hz(i, j, k+1));
+            }
+            H_eff[2] -= demag * M_old(i, j, k, 2);
+
+            if (exchange_coupling == 1) {
+                // in-plane Laplacian, without gradient towards the nonmagnetic neighbors
+                Real const coef = props(i, j, k, film_exchange);
+                bool const xlo = props(i-1, j, k, film_Ms) > 0._rt;
+                bool const xhi = props(i+1, j, k, film_Ms) > 0._rt;
+                bool const ylo = props(i, j-1, k, film_Ms) > 0._rt;
+                bool const yhi = props(i, j+1, k, film_Ms) > 0._rt;
+                for (int comp = 0; comp < 3; ++comp) {
+                    Real const Mc = M_old(i, j, k, comp);
+                    Real lap = 0._rt;
+                    if (xlo) lap += (M_old(i-1, j, k, comp) - Mc) * inv_dx2;
+                    if (xhi) lap += (M_old(i+1, j, k, comp) - Mc) * inv_dx2;
+                    if (ylo) lap += (M_old(i, j-1, k, comp) - Mc) * inv_dy2;
+                    if (yhi) lap += (M_old(i, j+1, k, comp) - Mc) * inv_dy2;
+                    H_eff[comp] += coef * lap;
+                }
+            }
+
+            if (anisotropy_coupling == 1) {
+                Real M_dot_axis = 0._rt;
+                for (int comp = 0; comp < 3; ++comp) M_dot_axis += M_old(i, j, k, comp) * anisotropy_axis[comp];
+                Real const coef = props(i, j, k, film_anisotropy);
+                for (int comp = 0; comp < 3; ++comp) H_eff[comp] += coef * M_dot_axis * anisotropy_axis[comp];
+            }
+
+            // forward Euler: M += dt_M [mu0 gammaL (M x H_eff) + Gil_damp M x (M x H_eff)], then |M| = Ms
+            Real const Mx = M_old(i, j, k, 0);
+            Real const My = M_old(i, j, k, 1);
+            Real const Mz = M_old(i, j, k, 2);
+            Real const gammaL = props(i, j, k, film_gammaL);
+            Real const Gil_damp = PhysConst::mu0 * gammaL * props(i, j, k, film_alpha) / Ms;
+            Real const MxH_x = My * H_eff[2] - Mz * H_eff[1];
+            Real const MxH_y = Mz * H_eff[0] - Mx * H_eff[2];
+            Real const MxH_z = Mx * H_eff[1] - My * H_eff[0];
+            Real M_new[3];
+            M_new[0] = Mx + dt_M * ((PhysConst::mu0 * gammaL) * MxH_x + Gil_damp * (My * MxH_z - Mz * MxH_y));
+            M_new[1] = My + dt_M * ((PhysConst::mu0 * gammaL) * MxH_y + Gil_damp * (Mz * MxH_x - Mx * MxH_z));
+            M_new[2] = Mz + dt_M * ((PhysConst::mu0 * gammaL) * MxH_z + Gil_damp * (Mx * MxH_y - My * MxH_x));
+            Real const scale = Ms / std::sqrt(M_new[0]*M_new[0] + M_new[1]*M_new[1] + M_new[2]*M_new[2]);
+            for (int comp = 0; comp < 3; ++comp) M(i, j, k, comp) = scale * M_new[comp];
+        });
+    }
+
+    // dM = M^{n+1} - M^n on the valid cells
+    MultiFab::LinComb(*m_dM, 1._rt, *m_M, 0, -1._rt, *m_dM, 0, 0, 3, 0);
+    m_M->FillBoundary(m_geom.periodicity());
+}
+
+void
+MagThinFilm::CorrectH (std::array<std::unique_ptr<MultiFab>, 3>& Hfield)
+{
+    // the H of the grid only sees the film through the coupling, as the magnetic regions
+    if (WarpX::GetInstance().mag_LLG_coupling != 1) return;
+    AddFaceMoment(Hfield, *m_dM, -1._rt);
+}
+
+void
+MagThinFilm::AddToB (std::array<std::unique_ptr<MultiFab>, 3>& Bfield)
+{
+    AddFaceMoment(Bfield, *m_M, PhysConst::mu0);
+}
+
+void
+MagThinFilm::AddFaceMoment (std::array<std::unique_ptr<MultiFab>, 3>& fields,
+                            MultiFab const& src, Real scale)
+{
+    // the moment of the film on the face boxes, with zero outside of the domain
+    m_face_M->setVal(0._rt);
+    m_face_M->ParallelCopy(src, 0, 0, 3, IntVect(0), m_face_M->nGrowVect(), m_geom.periodicity());
+
+    // t/dz of the moment on the x and y faces of a film cell, shared with the neighbor cell,
+    // and t/(2 dz) on each of its two z faces
+    Real const w = 0.5_rt * m_fraction * scale;
+    int const kf = m_kf;
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi(*fields[0]); mfi.isValid(); ++mfi) {
+        int const iface = m_face_index[mfi.index()];
+        if (iface < 0) continue;
+        Array4<Real const> const& Mf = m_face_M->const_array(iface);
+        Array4<Real> const& Fx = fields[0]->array(mfi);
+        Array4<Real> const& Fy = fields[1]->array(mfi);
+        Array4<Real> const& Fz = fields[2]->array(mfi);
+
+        Box const bx = mfi.validbox();
+        if (bx.smallEnd(2) <= kf && kf <= bx.bigEnd(2)) {
+            Box tbx = mfi.tilebox(fields[0]->ixType().toIntVect());
+            Box tby = mfi.tilebox(fields[1]->ixType().toIntVect());
+            tbx.setSmall(2, kf); tbx.setBig(2, kf);
+            tby.setSmall(2, kf); tby.setBig(2, kf);
+            amrex::ParallelFor(tbx, tby,
+                [=] AMREX_GPU_DEVICE (int i, int j, int k) {
+                    Fx(i, j, k) += w * (Mf(i-1, j, k, 0) + Mf(i, j, k, 0));
+                },
+                [=] AMREX_GPU_DEVICE (int i, int j, int k) {
+                    Fy(i, j, k) += w * (Mf(i, j-1, k, 1) + Mf(i, j, k, 1));
+                });
+        }
+        Box const tbz = mfi.tilebox(fields[2]->ixType().toIntVect());
+        for (int kz = kf; kz <= kf + 1; ++kz) {
+            if (kz < tbz.smallEnd(2) || kz > tbz.bigEnd(2)) continue;
+            Box bz = tbz;
+            bz.setSmall(2, kz); bz.setBig(2, kz);
+            amrex::ParallelFor(bz, [=] AMREX_GPU_DEVICE (int i, int j, int k) {
+                Fz(i, j, k) += w * Mf(i, j, kf, 2);
+            });
+        }
+    }
+}
+
+#endif // WARPX_DIM_3D
+#endif // WARPX_MAG_LLG
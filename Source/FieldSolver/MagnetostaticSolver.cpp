@@ -0,0 +1,183 @@
+/* This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+#include "WarpX.H"
+
+#include "FieldSolver/FiniteDifferenceSolver/MacroscopicProperties/MacroscopicProperties.H"
+#include "Parallelization/GuardCellManager.H"
+#ifdef WARPX_USE_PSATD
+#   include "FieldSolver/SpectralSolver/SpectralMagnetostaticSolver.H"
+#endif
+#include "Utils/CoarsenIO.H"
+#include "Utils/TextMsg.H"
+#include "Utils/WarpXConst.H"
+#include "Utils/WarpXProfilerWrapper.H"
+
+#include <AMReX_Array.H>
+#include <AMReX_Array4.H>
+#include <AMReX_BoxArray.H>
+#include <AMReX_Config.H>
+#include <AMReX_Geometry.H>
+#include <AMReX_GpuLaunch.H>
+#include <AMReX_LO_BCTYPES.H>
+#include <AMReX_MFIter.H>
+#include <AMReX_MLABecLaplacian.H>
+#include <AMReX_MLMG.H>
+#include <AMReX_MLPoisson.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_REAL.H>
+#include <AMReX_RealVect.H>
+
+#include <array>
+#include <memory>
+#include <utility>
+
+using namespace amrex;
+
+#ifdef WARPX_MAG_LLG
+void
+WarpX::ComputeMagnetostaticField ()
+{
+    WARPX_PROFILE("WarpX::ComputeMagnetostaticField");
+    MarkFieldModified(tracked_H);
+
+#if defined(WARPX_DIM_3D)
+    // the LLG solver, and hence this mode, is only implemented on level 0
+    int const lev = 0;
+
+    // permeability of the non-magnetic regions
+    MacroscopicProperties& macroscopic_properties = *m_macroscopic_properties[lev];
+    bool const vacuum_mu = macroscopic_properties.is_mu_uniform()
+                           && macroscopic_properties.getmu() == PhysConst::mu0;
+
+    if (mag_magnetostatic_fft == 1) {
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(vacuum_mu,
+            "warpx.mag_magnetostatic_fft = 1 requires mu = mu0 outside of the magnetic materials");
+#ifdef WARPX_USE_PSATD
+        if (!m_spectral_magnetostatic_solver) {
+            WARPX_ALWAYS_ASSERT_WITH_MESSAGE(Geom(lev).isAllPeriodic(),
+                "warpx.mag_magnetostatic_fft = 1 requires a periodic domain");
+            WARPX_ALWAYS_ASSERT_WITH_MESSAGE(boxArray(lev).size() == 1,
+                "warpx.mag_magnetostatic_fft = 1 requires the domain to be covered by a single box "
+                "(amr.max_grid_size must be at least the number of cells)");
+            m_spectral_magnetostatic_solver = std::make_unique<SpectralMagnetostaticSolver>(
+                lev, boxArray(lev), DistributionMap(lev), RealVect(CellSize(lev)[0], CellSize(lev)[1], CellSize(lev)[2]));
+        }
+        m_spectral_magnetostatic_solver->ComputeDemagField(lev, Mfield_fp[lev], Hfield_fp[lev]);
+#endif
+    } else {
+        // With B = mu0 (H + M) in the magnetic materials, B = mu H elsewhere, and div(B) = 0, the
+        // demagnetizing field H = -grad(phi_M) is given by div(mu_r grad(phi_M)) = div(M), with mu_r = 1 on
+        // the magnetic faces and mu/mu0 elsewhere, i.e. laplacian(phi_M) = div(M) if mu = mu0. M and H are
+        // face-centered (Yee grid), so that phi_M and div(M) are cell-centered and H is directly obtained on
+        // the faces from the gradient of phi_M.
+        MultiFab div_M(boxArray(lev), DistributionMap(lev), 1, 0);
+        MultiFab phi_M(boxArray(lev), DistributionMap(lev), 1, 1);
+        phi_M.setVal(0._rt);
+
+        GpuArray<Real, 3> const dxi = Geom(lev).InvCellSizeArray();
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+        for (MFIter mfi(div_M, TilingIfNotGPU()); mfi.isValid(); ++mfi)
+        {
+            Box const& bx = mfi.tilebox();
+            Array4<Real> const& div_M_arr = div_M.array(mfi);
+            // note M_xface include x,y,z components at |_x faces, the x component is the normal one
+            Array4<Real const> const& M_xface = Mfield_fp[lev][0]->const_array(mfi);
+            Array4<Real const> const& M_yface = Mfield_fp[lev][1]->const_array(mfi);
+            Array4<Real const> const& M_zface = Mfield_fp[lev][2]->const_array(mfi);
+
+            amrex::ParallelFor(bx,
+                [=] AMREX_GPU_DEVICE (int i, int j, int k) {
+                    div_M_arr(i, j, k) = dxi[0] * (M_xface(i+1, j, k, 0) - M_xface(i, j, k, 0))
+                                       + dxi[1] * (M_yface(i, j+1, k, 1) - M_yface(i, j, k, 1))
+                                       + dxi[2] * (M_zface(i, j, k+1, 2) - M_zface(i, j, k, 2));
+            });
+        }
+
+        // phi_M = 0 on the non-periodic boundaries of the domain, which must thus be padded
+        // with enough vacuum for the stray field to have decayed there
+        Array<LinOpBCType, AMREX_SPACEDIM> lobc, hibc;
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+            lobc[idim] = Geom(lev).isPeriodic(idim) ? LinOpBCType::Periodic : LinOpBCType::Dirichlet;
+            hibc[idim] = lobc[idim];
+        }
+
+        std::unique_ptr<MLCellLinOp> linop;
+        if (vacuum_mu) {
+            linop = std::make_unique<MLPoisson>(Vector<Geometry>{Geom(lev)}, Vector<BoxArray>{boxArray(lev)},
+                                                Vector<DistributionMapping>{DistributionMap(lev)});
+        } else {
+            // relative permeability on the faces, as in FiniteDifferenceSolver::ComputeBfromHM
+            GpuArray<int, 3> const& mu_stag = macroscopic_properties.mu_IndexType;
+            GpuArray<int, 3> const& macro_cr = macroscopic_properties.macro_cr_ratio;
+            std::array<GpuArray<int, 3>, 3> const face_stag = {macroscopic_properties.Bx_IndexType,
+                macroscopic_properties.By_IndexType, macroscopic_properties.Bz_IndexType};
+            MultiFab const& mu_mf = macroscopic_properties.getmu_mf();
+            Array<MultiFab, 3> mu_r;
+            for (int idim = 0; idim < 3; ++idim) {
+                mu_r[idim].define(amrex::convert(boxArray(lev), IntVect::TheDimensionVector(idim)),
+                                  DistributionMap(lev), 1, 0);
+                CoarsenIO::InterpStencil const mu_stencil(mu_stag, face_stag[idim], macro_cr);
+                MultiFab const& Ms_mf = macroscopic_properties.getmag_Ms_mf(idim);
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+                for (MFIter mfi(mu_r[idim], TilingIfNotGPU()); mfi.isValid(); ++mfi)
+                {
+                    Box const& bx = mfi.tilebox();
+                    Array4<Real> const& mu_r_arr = mu_r[idim].array(mfi);
+                    Array4<Real const> const& mu_arr = mu_mf.const_array(mfi);
+                    Array4<Real const> const& Ms_arr = Ms_mf.const_array(mfi);
+                    amrex::ParallelFor(bx,
+                        [=] AMREX_GPU_DEVICE (int i, int j, int k) {
+                            mu_r_arr(i, j, k) = (Ms_arr(i, j, k) > 0._rt) ? 1._rt
+                                              : mu_stencil(mu_arr, i, j, k, 0) / PhysConst::mu0;
+                    });
+                }
+            }
+            auto abec = std::make_unique<MLABecLaplacian>(Vector<Geometry>{Geom(lev)},
+                Vector<BoxArray>{boxArray(lev)}, Vector<DistributionMapping>{DistributionMap(lev)});
+            // -div(mu_r grad(phi_M)) = -div(M)
+            abec->setScalars(0._rt, 1._rt);
+            abec->setBCoeffs(0, amrex::GetArrOfConstPtrs(mu_r));
+            div_M.mult(-1._rt);
+            linop = std::move(abec);
+        }
+        linop->setDomainBC(lobc, hibc);
+        linop->setLevelBC(0, &phi_M);
+
+        // divergence-free M (e.g. uniform in a periodic domain) has no demagnetizing field
+        bool const always_use_bnorm = (div_M.norm0() > 0._rt);
+        Real absolute_tolerance = self_fields_absolute_tolerance;
+        if (!always_use_bnorm && absolute_tolerance == 0._rt) absolute_tolerance = Real(1e-6);
+
+        MLMG mlmg(*linop);
+        mlmg.setVerbose(self_fields_verbosity);
+        mlmg.setMaxIter(self_fields_max_iters);
+        mlmg.setAlwaysUseBNorm(always_use_bnorm);
+        mlmg.solve({&phi_M}, {&div_M}, self_fields_required_precision, absolute_tolerance);
+
+        // H = -grad(phi_M) on the faces
+        mlmg.getGradSolution(
+            {amrex::Array<amrex::MultiFab*,3>{
+                get_pointer_Hfield_fp(lev, 0), get_pointer_Hfield_fp(lev, 1), get_pointer_Hfield_fp(lev, 2)
+                }}
+        );
+        for (int i = 0; i < 3; ++i) {
+            Hfield_fp[lev][i]->mult(-1._rt);
+        }
+
+    }
+
+    FillBoundaryH(guard_cells.ng_alloc_EB);
+    // B is computed from the new H by ComputeBfieldFromHM before it is next read
+    m_Bfield_outdated = true;
+#else
+    amrex::Abort(Utils::TextMsg::Err("warpx.mag_magnetostatic = 1 is only implemented in 3D"));
+#endif
+}
+#endif
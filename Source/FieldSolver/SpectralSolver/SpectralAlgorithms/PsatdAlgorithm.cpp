@@ -7,7 +7,6 @@
 #include "PsatdAlgorithm.H"
 
 #include "Utils/TextMsg.H"
-#include "Utils/WarpXConst.H"
 #include "Utils/WarpX_Complex.H"
 
 #include <AMReX_Array4.H>
@@ -41,7 +40,9 @@ PsatdAlgorithm::PsatdAlgorithm(
     const bool update_with_rho,
     const bool time_averaging,
     const bool dive_cleaning,
-    const bool divb_cleaning)
+    const bool divb_cleaning,
+    const amrex::Real c_medium,
+    const amrex::Real eps_medium)
     // Initializer list
     : SpectralBaseAlgorithm(spectral_kspace, dm, spectral_index, norder_x, norder_y, norder_z, nodal, fill_guards),
     m_spectral_index(spectral_index),
@@ -60,7 +61,9 @@ PsatdAlgorithm::PsatdAlgorithm(
     m_update_with_rho(update_with_rho),
     m_time_averaging(time_averaging),
     m_dive_cleaning(dive_cleaning),
-    m_divb_cleaning(divb_cleaning)
+    m_divb_cleaning(divb_cleaning),
+    m_c_medium(c_medium),
+    m_eps_medium(eps_medium)
 {
     const amrex::BoxArray& ba = spectral_kspace.spectralspace_ba;
 
@@ -120,6 +123,8 @@ PsatdAlgorithm::pushSpectralFields (SpectralFieldData& f) const
     const bool is_galilean     = m_is_galilean;
 
     const amrex::Real dt = m_dt;
+    const amrex::Real c2 = m_c_medium * m_c_medium;
+    const amrex::Real inv_ep0 = 1._rt / m_eps_medium;
 
     const SpectralFieldIndex& Idx = m_spectral_index;
 
@@ -210,9 +215,7 @@ PsatdAlgorithm::pushSpectralFields (SpectralFieldData& f) const
             constexpr amrex::Real ky = 0._rt;
             const     amrex::Real kz = modified_kz_arr[j];
 #endif
-            // Physical constants and imaginary unit
-            constexpr Real c2 = PhysConst::c * PhysConst::c;
-            constexpr Real inv_ep0 = 1._rt / PhysConst::ep0;
+            // Imaginary unit (c2 and inv_ep0 are those of the medium)
             constexpr Complex I = Complex{0._rt, 1._rt};
 
             // These coefficients are initialized in the function InitializeSpectralCoefficients
@@ -221,7 +224,7 @@ PsatdAlgorithm::pushSpectralFields (SpectralFieldData& f) const
             const Complex X1 = X1_arr(i,j,k);
             const Complex X2 = X2_arr(i,j,k);
             const Complex X3 = X3_arr(i,j,k);
-            const Complex X4 = (is_galilean) ? X4_arr(i,j,k) : - S_ck / PhysConst::ep0;
+            const Complex X4 = (is_galilean) ? X4_arr(i,j,k) : - S_ck * inv_ep0;
             const Complex T2 = (is_galilean) ? T2_arr(i,j,k) : 1.0_rt;
 
             // Update equations for E in the formulation with rho
@@ -348,6 +351,8 @@ void PsatdAlgorithm::InitializeSpectralCoefficients (
 {
     const bool update_with_rho = m_update_with_rho;
     const bool is_galilean     = m_is_galilean;
+    const amrex::Real c_medium = m_c_medium;
+    const amrex::Real eps_medium = m_eps_medium;
 
     const amrex::BoxArray& ba = spectral_kspace.spectralspace_ba;
 
@@ -400,8 +405,9 @@ void PsatdAlgorithm::InitializeSpectralCoefficients (
                 std::pow(kz_s[j], 2));
 #endif
             // Physical constants and imaginary unit
-            constexpr amrex::Real c = PhysConst::c;
-            constexpr amrex::Real ep0 = PhysConst::ep0;
+            // speed of light and permittivity of the medium
+            const amrex::Real c = c_medium;
+            const amrex::Real ep0 = eps_medium;
             constexpr Complex I = Complex{0._rt, 1._rt};
 
             const amrex::Real c2 = std::pow(c, 2);
@@ -548,6 +554,9 @@ void PsatdAlgorithm::InitializeSpectralCoefficientsAveraging (
     const amrex::DistributionMapping& dm,
     const amrex::Real dt)
 {
+    const amrex::Real c_medium = m_c_medium;
+    const amrex::Real eps_medium = m_eps_medium;
+
     const amrex::BoxArray& ba = spectral_kspace.spectralspace_ba;
 
     // Loop over boxes and allocate the corresponding coefficients for each box
@@ -592,8 +601,9 @@ void PsatdAlgorithm::InitializeSpectralCoefficientsAveraging (
                 std::pow(kz_s[j], 2));
 #endif
             // Physical constants and imaginary unit
-            constexpr amrex::Real c = PhysConst::c;
-            constexpr amrex::Real ep0 = PhysConst::ep0;
+            // speed of light and permittivity of the medium
+            const amrex::Real c = c_medium;
+            const amrex::Real ep0 = eps_medium;
             constexpr Complex I = Complex{0._rt, 1._rt};
 
             const amrex::Real c2 = std::pow(c, 2);
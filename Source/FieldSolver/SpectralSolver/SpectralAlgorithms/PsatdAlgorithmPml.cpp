@@ -8,7 +8,6 @@
 
 #include "FieldSolver/SpectralSolver/SpectralFieldData.H"
 #include "FieldSolver/SpectralSolver/SpectralKSpace.H"
-#include "Utils/WarpXConst.H"
 #include "Utils/WarpX_Complex.H"
 
 #include <AMReX.H>
@@ -35,13 +34,15 @@ PsatdAlgorithmPml::PsatdAlgorithmPml(const SpectralKSpace& spectral_kspace,
                                      const int norder_x, const int norder_y,
                                      const int norder_z, const bool nodal,
                                      const amrex::IntVect& fill_guards, const Real dt,
-                                     const bool dive_cleaning, const bool divb_cleaning)
+                                     const bool dive_cleaning, const bool divb_cleaning,
+                                     const amrex::Real c_medium)
      // Initialize members of base class
      : SpectralBaseAlgorithm(spectral_kspace, dm, spectral_index, norder_x, norder_y, norder_z, nodal, fill_guards),
        m_spectral_index(spectral_index),
        m_dt(dt),
        m_dive_cleaning(dive_cleaning),
-       m_divb_cleaning(divb_cleaning)
+       m_divb_cleaning(divb_cleaning),
+       m_c_medium(c_medium)
 {
     const BoxArray& ba = spectral_kspace.spectralspace_ba;
 
@@ -60,6 +61,7 @@ PsatdAlgorithmPml::pushSpectralFields(SpectralFieldData& f) const {
 
     const bool dive_cleaning = m_dive_cleaning;
     const bool divb_cleaning = m_divb_cleaning;
+    const Real c_medium = m_c_medium;
 
     const SpectralFieldIndex& Idx = m_spectral_index;
 
@@ -162,7 +164,7 @@ PsatdAlgorithmPml::pushSpectralFields(SpectralFieldData& f) const {
             constexpr Real ky = 0._rt;
             const Real kz = modified_kz_arr[j];
 #endif
-            constexpr Real c2 = PhysConst::c * PhysConst::c;
+            const Real c2 = c_medium * c_medium;
 
             const Complex I = Complex{0._rt, 1._rt};
 
@@ -351,6 +353,7 @@ void PsatdAlgorithmPml::InitializeSpectralCoefficients (
     const amrex::DistributionMapping& dm,
     const amrex::Real dt)
 {
+    const Real c_medium = m_c_medium;
     const BoxArray& ba = spectral_kspace.spectralspace_ba;
 
     // Fill them with the right values:
@@ -389,7 +392,7 @@ void PsatdAlgorithmPml::InitializeSpectralCoefficients (
             const Real k2 = k_norm * k_norm;
 
             // Calculate coefficients
-            constexpr Real c  = PhysConst::c;
+            const Real c = c_medium;
 
             // Coefficients for k_norm = 0 do not need to be set
             if (k_norm != 0._rt) {
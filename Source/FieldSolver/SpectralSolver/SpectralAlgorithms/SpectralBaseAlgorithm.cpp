@@ -61,10 +61,9 @@ SpectralBaseAlgorithm::ComputeSpectralDivE (
 {
     const SpectralFieldIndex& Idx = m_spectral_index;
 
-    // Forward Fourier transform of E
-    field_data.ForwardTransform(lev, *Efield[0], Idx.Ex, 0 );
-    field_data.ForwardTransform(lev, *Efield[1], Idx.Ey, 0 );
-    field_data.ForwardTransform(lev, *Efield[2], Idx.Ez, 0 );
+    // Forward Fourier transform of E (one batched FFT per box)
+    field_data.ForwardTransform(lev, {Efield[0].get(), Efield[1].get(), Efield[2].get()},
+                                {Idx.Ex, Idx.Ey, Idx.Ez}, {0, 0, 0});
 
     const amrex::IntVect& fill_guards = m_fill_guards;
 
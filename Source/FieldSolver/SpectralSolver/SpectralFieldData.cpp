@@ -7,6 +7,7 @@
  */
 #include "SpectralFieldData.H"
 
+#include "Utils/TextMsg.H"
 #include "Utils/WarpXAlgorithmSelection.H"
 #include "Utils/WarpXUtil.H"
 #include "WarpX.H"
@@ -25,14 +26,37 @@
 #include <AMReX_IntVect.H>
 #include <AMReX_LayoutData.H>
 #include <AMReX_MFIter.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_Periodicity.H>
 #include <AMReX_PODVector.H>
 #include <AMReX_REAL.H>
 #include <AMReX_Utility.H>
 
+#include <array>
+#include <complex>
+
 #if WARPX_USE_PSATD
 
 using namespace amrex;
 
+#ifdef WARPX_USE_HEFFTE
+namespace
+{
+    /** Box of heFFTe with the points of bx, with indices relative to lo
+     *  (the directions missing in 2D have a single point) */
+    heffte::box3d<> HeffteBox (const Box& bx, const IntVect& lo)
+    {
+        const IntVect small = bx.smallEnd() - lo;
+        const IntVect big = bx.bigEnd() - lo;
+#   if defined(WARPX_DIM_3D)
+        return heffte::box3d<>({small[0], small[1], small[2]}, {big[0], big[1], big[2]});
+#   else
+        return heffte::box3d<>({small[0], small[1], 0}, {big[0], big[1], 0});
+#   endif
+    }
+}
+#endif
+
 SpectralFieldIndex::SpectralFieldIndex (const bool update_with_rho,
                                         const bool time_averaging,
                                         const bool do_multi_J,
@@ -110,12 +134,14 @@ SpectralFieldData::SpectralFieldData( const int lev,
                                       const SpectralKSpace& k_space,
                                       const amrex::DistributionMapping& dm,
                                       const int n_field_required,
-                                      const bool periodic_single_box)
+                                      const bool periodic_single_box,
+                                      const bool global_fft)
 {
     amrex::LayoutData<amrex::Real>* cost = WarpX::getCosts(lev);
     bool do_costs = WarpXUtilLoadBalance::doCosts(cost, realspace_ba, dm);
 
     m_periodic_single_box = periodic_single_box;
+    m_global_fft = global_fft;
 
     const BoxArray& spectralspace_ba = k_space.spectralspace_ba;
 
@@ -125,8 +151,10 @@ SpectralFieldData::SpectralFieldData( const int lev,
 
     // Allocate temporary arrays - in real space and spectral space
     // These arrays will store the data just before/after the FFT
-    tmpRealField = MultiFab(realspace_ba, dm, 1, 0);
-    tmpSpectralField = SpectralField(spectralspace_ba, dm, 1, 0);
+    // (one component per field of a batched transform)
+    const int n_tmp = (global_fft) ? 1 : n_batch;
+    tmpRealField = MultiFab(realspace_ba, dm, n_tmp, 0);
+    tmpSpectralField = SpectralField(spectralspace_ba, dm, n_tmp, 0);
 
     // By default, we assume the FFT is done from/to a nodal grid in real space
     // It the FFT is performed from/to a cell-centered grid in real space,
@@ -151,10 +179,38 @@ SpectralFieldData::SpectralFieldData( const int lev,
                                     ShiftType::TransformToCellCentered);
 #endif
 
-    // Allocate and initialize the FFT plans
+    if (m_global_fft) {
+#ifdef WARPX_USE_HEFFTE
+        // One distributed FFT plan over the slabs of the domain: heFFTe expects one box
+        // per rank (empty on the ranks that own no slab), and transposes the data to
+        // pencils internally. The spectral slabs hold the same points as the real-space
+        // slabs, with only the positive k along the first direction.
+        m_global_domain = realspace_ba.minimalBox();
+        const IntVect domain_lo = m_global_domain.smallEnd();
+        heffte::box3d<> inbox({0, 0, 0}, {-1, -1, -1});
+        heffte::box3d<> outbox({0, 0, 0}, {-1, -1, -1});
+        for ( MFIter mfi(spectralspace_ba, dm); mfi.isValid(); ++mfi ){
+            const Box& realspace_bx = realspace_ba[mfi];
+            inbox = HeffteBox(realspace_bx, domain_lo);
+            outbox = HeffteBox(spectralspace_ba[mfi], domain_lo - realspace_bx.smallEnd());
+        }
+        m_global_plan = std::make_unique<heffte::fft3d_r2c<GlobalFFTBackend>>(
+            inbox, outbox, 0, ParallelDescriptor::Communicator());
+#else
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(false,
+            "SpectralFieldData: global FFTs require a WarpX build with heFFTe");
+#endif
+        return;
+    }
+
+    // Allocate and initialize the FFT plans, for one field and for n_batch fields.
+    // The plans are shared by the boxes of the same size (they are executed on the
+    // arrays of each box), so that only a few plans are created
     forward_plan = AnyFFT::FFTplans(spectralspace_ba, dm);
     backward_plan = AnyFFT::FFTplans(spectralspace_ba, dm);
-    // Loop over boxes and allocate the corresponding plan
+    forward_plan_batch = AnyFFT::FFTplans(spectralspace_ba, dm);
+    backward_plan_batch = AnyFFT::FFTplans(spectralspace_ba, dm);
+    // Loop over boxes and look up (or create) the corresponding plans
     // for each box owned by the local MPI proc
     for ( MFIter mfi(spectralspace_ba, dm); mfi.isValid(); ++mfi ){
         if (do_costs)
@@ -167,16 +223,18 @@ SpectralFieldData::SpectralFieldData( const int lev,
         // differ when using real-to-complex FFT. When initializing
         // the FFT plan, the valid dimensions are those of the real-space box.
         IntVect fft_size = realspace_ba[mfi].length();
-
-        forward_plan[mfi] = AnyFFT::CreatePlan(
-            fft_size, tmpRealField[mfi].dataPtr(),
-            reinterpret_cast<AnyFFT::Complex*>( tmpSpectralField[mfi].dataPtr()),
-            AnyFFT::direction::R2C, AMREX_SPACEDIM);
-
-        backward_plan[mfi] = AnyFFT::CreatePlan(
-            fft_size, tmpRealField[mfi].dataPtr(),
-            reinterpret_cast<AnyFFT::Complex*>( tmpSpectralField[mfi].dataPtr()),
-            AnyFFT::direction::C2R, AMREX_SPACEDIM);
+        Real* real_ptr = tmpRealField[mfi].dataPtr();
+        AnyFFT::Complex* complex_ptr =
+            reinterpret_cast<AnyFFT::Complex*>( tmpSpectralField[mfi].dataPtr());
+
+        forward_plan[mfi] = GetPlan(fft_size, real_ptr, complex_ptr,
+                                    AnyFFT::direction::R2C, 1);
+        backward_plan[mfi] = GetPlan(fft_size, real_ptr, complex_ptr,
+                                     AnyFFT::direction::C2R, 1);
+        forward_plan_batch[mfi] = GetPlan(fft_size, real_ptr, complex_ptr,
+                                          AnyFFT::direction::R2C, n_batch);
+        backward_plan_batch[mfi] = GetPlan(fft_size, real_ptr, complex_ptr,
+                                           AnyFFT::direction::C2R, n_batch);
 
         if (do_costs)
         {
@@ -190,12 +248,25 @@ SpectralFieldData::SpectralFieldData( const int lev,
 
 SpectralFieldData::~SpectralFieldData()
 {
-    if (!tmpRealField.empty()){
-        for ( MFIter mfi(tmpRealField); mfi.isValid(); ++mfi ){
-            AnyFFT::DestroyPlan(forward_plan[mfi]);
-            AnyFFT::DestroyPlan(backward_plan[mfi]);
+    // The plans of the boxes are copies of the cached plans
+    for (auto& plan : m_plan_cache) {
+        AnyFFT::DestroyPlan(plan);
+    }
+}
+
+AnyFFT::FFTplan
+SpectralFieldData::GetPlan (const IntVect& fft_size, Real* const real_array,
+                            AnyFFT::Complex* const complex_array,
+                            const AnyFFT::direction dir, const int howmany)
+{
+    for (const auto& plan : m_plan_cache) {
+        if (plan.m_real_size == fft_size && plan.m_dir == dir && plan.m_howmany == howmany) {
+            return plan;
         }
     }
+    m_plan_cache.push_back(AnyFFT::CreatePlan(fft_size, real_array, complex_array,
+                                              dir, AMREX_SPACEDIM, howmany));
+    return m_plan_cache.back();
 }
 
 /* \brief Transform the component `i_comp` of MultiFab `mf`
@@ -209,17 +280,21 @@ SpectralFieldData::ForwardTransform (const int lev,
     amrex::LayoutData<amrex::Real>* cost = WarpX::getCosts(lev);
     bool do_costs = WarpXUtilLoadBalance::doCosts(cost, mf.boxArray(), mf.DistributionMap());
 
-    // Check field index type, in order to apply proper shift in spectral space
-#if (AMREX_SPACEDIM >= 2)
-    const bool is_nodal_x = mf.is_nodal(0);
-#endif
-#if defined(WARPX_DIM_3D)
-    const bool is_nodal_y = mf.is_nodal(1);
-    const bool is_nodal_z = mf.is_nodal(2);
-#elif defined(WARPX_DIM_XZ) || defined(WARPX_DIM_RZ)
-    const bool is_nodal_z = mf.is_nodal(1);
-#elif defined(WARPX_DIM_1D_Z)
-    const bool is_nodal_z = mf.is_nodal(0);
+#ifdef WARPX_USE_HEFFTE
+    if (m_global_fft) {
+        // Copy the valid points of `mf` to the slabs of the global FFT; the guard cells
+        // are not needed, the FFT being periodic over the whole domain
+        MultiFab global_mf = GlobalRealFieldAlias(mf.ixType());
+        global_mf.ParallelCopy(mf, i_comp, 0, 1, IntVect(0), IntVect(0),
+                               Periodicity(m_global_domain.length()));
+
+        ExecuteGlobalFFT(AnyFFT::direction::R2C);
+
+        for ( MFIter mfi(tmpSpectralField); mfi.isValid(); ++mfi ){
+            StoreSpectralField(mfi, mf.ixType(), field_index, 0);
+        }
+        return;
+    }
 #endif
 
     // Loop over boxes
@@ -233,66 +308,15 @@ SpectralFieldData::ForwardTransform (const int lev,
         Real wt = amrex::second();
 
         // Copy the real-space field `mf` to the temporary field `tmpRealField`
-        // This ensures that all fields have the same number of points
-        // before the Fourier transform.
-        // As a consequence, the copy discards the *last* point of `mf`
-        // in any direction that has *nodal* index type.
-        {
-            Box realspace_bx;
-            if (m_periodic_single_box) {
-                realspace_bx = mfi.validbox(); // Discard guard cells
-            } else {
-                realspace_bx = mf[mfi].box(); // Keep guard cells
-            }
-            realspace_bx.enclosedCells(); // Discard last point in nodal direction
-            AMREX_ALWAYS_ASSERT( realspace_bx.contains(tmpRealField[mfi].box()) );
-            Array4<const Real> mf_arr = mf[mfi].array();
-            Array4<Real> tmp_arr = tmpRealField[mfi].array();
-            ParallelFor( tmpRealField[mfi].box(),
-            [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept {
-                tmp_arr(i,j,k) = mf_arr(i,j,k,i_comp);
-            });
-        }
+        CopyToRealField(mfi, mf, i_comp, 0);
 
         // Perform Fourier transform from `tmpRealField` to `tmpSpectralField`
-        AnyFFT::Execute(forward_plan[mfi]);
+        AnyFFT::Execute(forward_plan[mfi], tmpRealField[mfi].dataPtr(),
+            reinterpret_cast<AnyFFT::Complex*>(tmpSpectralField[mfi].dataPtr()));
 
         // Copy the spectral-space field `tmpSpectralField` to the appropriate
         // index of the FabArray `fields` (specified by `field_index`)
-        // and apply correcting shift factor if the real space data comes
-        // from a cell-centered grid in real space instead of a nodal grid.
-        {
-            Array4<Complex> fields_arr = SpectralFieldData::fields[mfi].array();
-            Array4<const Complex> tmp_arr = tmpSpectralField[mfi].array();
-#if (AMREX_SPACEDIM >= 2)
-            const Complex* xshift_arr = xshift_FFTfromCell[mfi].dataPtr();
-#endif
-#if defined(WARPX_DIM_3D)
-            const Complex* yshift_arr = yshift_FFTfromCell[mfi].dataPtr();
-#endif
-            const Complex* zshift_arr = zshift_FFTfromCell[mfi].dataPtr();
-            // Loop over indices within one box
-            const Box spectralspace_bx = tmpSpectralField[mfi].box();
-
-            ParallelFor( spectralspace_bx,
-            [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept {
-                Complex spectral_field_value = tmp_arr(i,j,k);
-                // Apply proper shift in each dimension
-#if (AMREX_SPACEDIM >= 2)
-                if (is_nodal_x==false) spectral_field_value *= xshift_arr[i];
-#endif
-#if defined(WARPX_DIM_3D)
-                if (is_nodal_y==false) spectral_field_value *= yshift_arr[j];
-                if (is_nodal_z==false) spectral_field_value *= zshift_arr[k];
-#elif defined(WARPX_DIM_XZ) || defined(WARPX_DIM_RZ)
-                if (is_nodal_z==false) spectral_field_value *= zshift_arr[j];
-#elif defined(WARPX_DIM_1D_Z)
-                if (is_nodal_z==false) spectral_field_value *= zshift_arr[i];
-#endif
-                // Copy field into the right index
-                fields_arr(i,j,k,field_index) = spectral_field_value;
-            });
-        }
+        StoreSpectralField(mfi, mf.ixType(), field_index, 0);
 
         if (do_costs)
         {
@@ -316,7 +340,187 @@ SpectralFieldData::BackwardTransform (const int lev,
     amrex::LayoutData<amrex::Real>* cost = WarpX::getCosts(lev);
     bool do_costs = WarpXUtilLoadBalance::doCosts(cost, mf.boxArray(), mf.DistributionMap());
 
-    // Check field index type, in order to apply proper shift in spectral space
+#ifdef WARPX_USE_HEFFTE
+    if (m_global_fft) {
+        for ( MFIter mfi(tmpSpectralField); mfi.isValid(); ++mfi ){
+            LoadSpectralField(mfi, mf.ixType(), field_index, 0);
+        }
+
+        ExecuteGlobalFFT(AnyFFT::direction::C2R);
+
+        // Copy the slabs back to the valid points of `mf` and, if requested, to its guard
+        // cells (the periodic images of the slabs give the last point along the nodal
+        // directions and the guard cells)
+        MultiFab global_mf = GlobalRealFieldAlias(mf.ixType());
+        const amrex::IntVect& mf_ng = mf.nGrowVect();
+        IntVect ng_fill = IntVect(0);
+        for (int dir = 0; dir < AMREX_SPACEDIM; dir++) {
+            if (static_cast<bool>(fill_guards[dir])) ng_fill[dir] = mf_ng[dir];
+        }
+        mf.ParallelCopy(global_mf, 0, i_comp, 1, IntVect(0), ng_fill,
+                        Periodicity(m_global_domain.length()));
+        return;
+    }
+#endif
+
+    // Loop over boxes
+    // Note: we do NOT OpenMP parallelize here, since we use OpenMP threads for
+    //       the iFFTs on each box!
+    for ( MFIter mfi(mf); mfi.isValid(); ++mfi ){
+        if (do_costs)
+        {
+            amrex::Gpu::synchronize();
+        }
+        Real wt = amrex::second();
+
+        // Copy the spectral field specified by the input argument field_index
+        // to the temporary field `tmpSpectralField`
+        LoadSpectralField(mfi, mf.ixType(), field_index, 0);
+
+        // Perform Fourier transform from `tmpSpectralField` to `tmpRealField`
+        AnyFFT::Execute(backward_plan[mfi], tmpRealField[mfi].dataPtr(),
+            reinterpret_cast<AnyFFT::Complex*>(tmpSpectralField[mfi].dataPtr()));
+
+        // Copy the temporary field tmpRealField to the real-space field mf and
+        // normalize, dividing by N, since (FFT + inverse FFT) results in a factor N
+        CopyFromRealField(mfi, mf, i_comp, 0, fill_guards);
+
+        if (do_costs)
+        {
+            amrex::Gpu::synchronize();
+            wt = amrex::second() - wt;
+            amrex::HostDevice::Atomic::Add( &(*cost)[mfi.index()], wt);
+        }
+    }
+}
+
+/* \brief Transform the components `i_comp` of the n_batch MultiFabs `mf` (e.g. the
+ *  components of a vector field) to spectral space with one batched FFT per box, and
+ *  store the results internally (in the spectral fields specified by `field_index`) */
+void
+SpectralFieldData::ForwardTransform (const int lev,
+                                     const std::array<const MultiFab*, n_batch>& mf,
+                                     const std::array<int, n_batch>& field_index,
+                                     const std::array<int, n_batch>& i_comp)
+{
+    // The global FFTs transform one field at a time
+    if (m_global_fft) {
+        for (int n = 0; n < n_batch; n++) {
+            ForwardTransform(lev, *mf[n], field_index[n], i_comp[n]);
+        }
+        return;
+    }
+
+    amrex::LayoutData<amrex::Real>* cost = WarpX::getCosts(lev);
+    bool do_costs = WarpXUtilLoadBalance::doCosts(cost, mf[0]->boxArray(),
+                                                  mf[0]->DistributionMap());
+
+    // Loop over boxes (no OpenMP, as in the single-field transform)
+    for ( MFIter mfi(*mf[0]); mfi.isValid(); ++mfi ){
+        if (do_costs)
+        {
+            amrex::Gpu::synchronize();
+        }
+        Real wt = amrex::second();
+
+        for (int n = 0; n < n_batch; n++) {
+            CopyToRealField(mfi, *mf[n], i_comp[n], n);
+        }
+
+        // One FFT of the n_batch components of `tmpRealField`
+        AnyFFT::Execute(forward_plan_batch[mfi], tmpRealField[mfi].dataPtr(),
+            reinterpret_cast<AnyFFT::Complex*>(tmpSpectralField[mfi].dataPtr()));
+
+        for (int n = 0; n < n_batch; n++) {
+            StoreSpectralField(mfi, mf[n]->ixType(), field_index[n], n);
+        }
+
+        if (do_costs)
+        {
+            amrex::Gpu::synchronize();
+            wt = amrex::second() - wt;
+            amrex::HostDevice::Atomic::Add( &(*cost)[mfi.index()], wt);
+        }
+    }
+}
+
+/* \brief Transform the n_batch spectral fields specified by `field_index` back to
+ *  real space with one batched FFT per box, and store them in the components `i_comp`
+ *  of the MultiFabs `mf` */
+void
+SpectralFieldData::BackwardTransform (const int lev,
+                                      const std::array<MultiFab*, n_batch>& mf,
+                                      const std::array<int, n_batch>& field_index,
+                                      const std::array<int, n_batch>& i_comp,
+                                      const amrex::IntVect& fill_guards)
+{
+    if (m_global_fft) {
+        for (int n = 0; n < n_batch; n++) {
+            BackwardTransform(lev, *mf[n], field_index[n], i_comp[n], fill_guards);
+        }
+        return;
+    }
+
+    amrex::LayoutData<amrex::Real>* cost = WarpX::getCosts(lev);
+    bool do_costs = WarpXUtilLoadBalance::doCosts(cost, mf[0]->boxArray(),
+                                                  mf[0]->DistributionMap());
+
+    for ( MFIter mfi(*mf[0]); mfi.isValid(); ++mfi ){
+        if (do_costs)
+        {
+            amrex::Gpu::synchronize();
+        }
+        Real wt = amrex::second();
+
+        for (int n = 0; n < n_batch; n++) {
+            LoadSpectralField(mfi, mf[n]->ixType(), field_index[n], n);
+        }
+
+        AnyFFT::Execute(backward_plan_batch[mfi], tmpRealField[mfi].dataPtr(),
+            reinterpret_cast<AnyFFT::Complex*>(tmpSpectralField[mfi].dataPtr()));
+
+        for (int n = 0; n < n_batch; n++) {
+            CopyFromRealField(mfi, *mf[n], i_comp[n], n, fill_guards);
+        }
+
+        if (do_costs)
+        {
+            amrex::Gpu::synchronize();
+            wt = amrex::second() - wt;
+            amrex::HostDevice::Atomic::Add( &(*cost)[mfi.index()], wt);
+        }
+    }
+}
+
+void
+SpectralFieldData::CopyToRealField (const MFIter& mfi, const MultiFab& mf, const int i_comp,
+                                    const int tmp_comp)
+{
+    // This ensures that all fields have the same number of points
+    // before the Fourier transform.
+    // As a consequence, the copy discards the *last* point of `mf`
+    // in any direction that has *nodal* index type.
+    Box realspace_bx;
+    if (m_periodic_single_box) {
+        realspace_bx = mfi.validbox(); // Discard guard cells
+    } else {
+        realspace_bx = mf[mfi].box(); // Keep guard cells
+    }
+    realspace_bx.enclosedCells(); // Discard last point in nodal direction
+    AMREX_ALWAYS_ASSERT( realspace_bx.contains(tmpRealField[mfi].box()) );
+    Array4<const Real> mf_arr = mf[mfi].array();
+    Array4<Real> tmp_arr = tmpRealField[mfi].array();
+    ParallelFor( tmpRealField[mfi].box(),
+    [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept {
+        tmp_arr(i,j,k,tmp_comp) = mf_arr(i,j,k,i_comp);
+    });
+}
+
+void
+SpectralFieldData::CopyFromRealField (const MFIter& mfi, MultiFab& mf, const int i_comp,
+                                      const int tmp_comp, const amrex::IntVect& fill_guards)
+{
+    // Check field index type, in order to set the last point along the nodal directions
 #if (AMREX_SPACEDIM >= 2)
     const bool is_nodal_x = mf.is_nodal(0);
 #endif
@@ -347,121 +551,201 @@ SpectralFieldData::BackwardTransform (const int lev,
     // Numbers of guard cells
     const amrex::IntVect& mf_ng = mf.nGrowVect();
 
-    // Loop over boxes
-    // Note: we do NOT OpenMP parallelize here, since we use OpenMP threads for
-    //       the iFFTs on each box!
-    for ( MFIter mfi(mf); mfi.isValid(); ++mfi ){
-        if (do_costs)
+    amrex::Box mf_box = (m_periodic_single_box) ? mfi.validbox() : mfi.fabbox();
+    amrex::Array4<amrex::Real> mf_arr = mf[mfi].array();
+    amrex::Array4<const amrex::Real> tmp_arr = tmpRealField[mfi].array();
+
+    const amrex::Real inv_N = 1._rt / tmpRealField[mfi].box().numPts();
+
+    // Total number of cells, including ghost cells (nj represents ny in 3D and nz in 2D)
+    const int ni = mf_box.length(0);
+#if   defined(WARPX_DIM_1D_Z)
+    constexpr int nj = 1;
+    constexpr int nk = 1;
+#elif defined(WARPX_DIM_XZ) || defined(WARPX_DIM_RZ)
+    const int nj = mf_box.length(1);
+    constexpr int nk = 1;
+#elif defined(WARPX_DIM_3D)
+    const int nj = mf_box.length(1);
+    const int nk = mf_box.length(2);
+#endif
+    // Lower bound of the box (lo_j represents lo_y in 3D and lo_z in 2D)
+    const int lo_i = amrex::lbound(mf_box).x;
+#if   defined(WARPX_DIM_1D_Z)
+    constexpr int lo_j = 0;
+    constexpr int lo_k = 0;
+#elif defined(WARPX_DIM_XZ) || defined(WARPX_DIM_RZ)
+    const int lo_j = amrex::lbound(mf_box).y;
+    constexpr int lo_k = 0;
+#elif defined(WARPX_DIM_3D)
+    const int lo_j = amrex::lbound(mf_box).y;
+    const int lo_k = amrex::lbound(mf_box).z;
+#endif
+    // If necessary, do not fill the guard cells
+    // (shrink box by passing negative number of cells)
+    if (m_periodic_single_box == false)
+    {
+        for (int dir = 0; dir < AMREX_SPACEDIM; dir++)
         {
-            amrex::Gpu::synchronize();
+            if (static_cast<bool>(fill_guards[dir]) == false) mf_box.grow(dir, -mf_ng[dir]);
         }
-        Real wt = amrex::second();
+    }
 
-        // Copy the spectral-space field `tmpSpectralField` to the appropriate
-        // field (specified by the input argument field_index)
-        // and apply correcting shift factor if the field is to be transformed
-        // to a cell-centered grid in real space instead of a nodal grid.
-        {
-            Array4<const Complex> field_arr = SpectralFieldData::fields[mfi].array();
-            Array4<Complex> tmp_arr = tmpSpectralField[mfi].array();
+    // Loop over cells within full box, including ghost cells
+    ParallelFor(mf_box, [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept
+    {
+        // Assume periodicity and set the last outer guard cell equal to the first one:
+        // this is necessary in order to get the correct value along a nodal direction,
+        // because the last point along a nodal direction is always discarded when FFTs
+        // are computed, as the real-space box is always cell-centered.
+        const int ii = (i == lo_i + ni - si) ? lo_i : i;
+        const int jj = (j == lo_j + nj - sj) ? lo_j : j;
+        const int kk = (k == lo_k + nk - sk) ? lo_k : k;
+        // Copy and normalize field
+        mf_arr(i,j,k,i_comp) = inv_N * tmp_arr(ii,jj,kk,tmp_comp);
+    });
+}
+
+void
+SpectralFieldData::StoreSpectralField (const MFIter& mfi, const IndexType ixtype,
+                                       const int field_index, const int tmp_comp)
+{
+    // Check field index type, in order to apply proper shift in spectral space
+#if (AMREX_SPACEDIM >= 2)
+    const bool is_nodal_x = ixtype.nodeCentered(0);
+#endif
+#if defined(WARPX_DIM_3D)
+    const bool is_nodal_y = ixtype.nodeCentered(1);
+    const bool is_nodal_z = ixtype.nodeCentered(2);
+#elif defined(WARPX_DIM_XZ) || defined(WARPX_DIM_RZ)
+    const bool is_nodal_z = ixtype.nodeCentered(1);
+#elif defined(WARPX_DIM_1D_Z)
+    const bool is_nodal_z = ixtype.nodeCentered(0);
+#endif
+
+    // Apply correcting shift factor if the real space data comes
+    // from a cell-centered grid in real space instead of a nodal grid.
+    Array4<Complex> fields_arr = SpectralFieldData::fields[mfi].array();
+    Array4<const Complex> tmp_arr = tmpSpectralField[mfi].array();
 #if (AMREX_SPACEDIM >= 2)
-            const Complex* xshift_arr = xshift_FFTtoCell[mfi].dataPtr();
+    const Complex* xshift_arr = xshift_FFTfromCell[mfi].dataPtr();
 #endif
 #if defined(WARPX_DIM_3D)
-            const Complex* yshift_arr = yshift_FFTtoCell[mfi].dataPtr();
+    const Complex* yshift_arr = yshift_FFTfromCell[mfi].dataPtr();
 #endif
-            const Complex* zshift_arr = zshift_FFTtoCell[mfi].dataPtr();
-            // Loop over indices within one box
-            const Box spectralspace_bx = tmpSpectralField[mfi].box();
-
-            ParallelFor( spectralspace_bx,
-            [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept {
-                Complex spectral_field_value = field_arr(i,j,k,field_index);
-                // Apply proper shift in each dimension
+    const Complex* zshift_arr = zshift_FFTfromCell[mfi].dataPtr();
+    // Loop over indices within one box
+    const Box spectralspace_bx = tmpSpectralField[mfi].box();
+
+    ParallelFor( spectralspace_bx,
+    [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept {
+        Complex spectral_field_value = tmp_arr(i,j,k,tmp_comp);
+        // Apply proper shift in each dimension
 #if (AMREX_SPACEDIM >= 2)
-                if (is_nodal_x==false) spectral_field_value *= xshift_arr[i];
+        if (is_nodal_x==false) spectral_field_value *= xshift_arr[i];
 #endif
 #if defined(WARPX_DIM_3D)
-                if (is_nodal_y==false) spectral_field_value *= yshift_arr[j];
-                if (is_nodal_z==false) spectral_field_value *= zshift_arr[k];
+        if (is_nodal_y==false) spectral_field_value *= yshift_arr[j];
+        if (is_nodal_z==false) spectral_field_value *= zshift_arr[k];
 #elif defined(WARPX_DIM_XZ) || defined(WARPX_DIM_RZ)
-                if (is_nodal_z==false) spectral_field_value *= zshift_arr[j];
+        if (is_nodal_z==false) spectral_field_value *= zshift_arr[j];
 #elif defined(WARPX_DIM_1D_Z)
-                if (is_nodal_z==false) spectral_field_value *= zshift_arr[i];
+        if (is_nodal_z==false) spectral_field_value *= zshift_arr[i];
 #endif
-                // Copy field into temporary array
-                tmp_arr(i,j,k) = spectral_field_value;
-            });
-        }
-
-        // Perform Fourier transform from `tmpSpectralField` to `tmpRealField`
-        AnyFFT::Execute(backward_plan[mfi]);
-
-        // Copy the temporary field tmpRealField to the real-space field mf and
-        // normalize, dividing by N, since (FFT + inverse FFT) results in a factor N
-        {
-            amrex::Box mf_box = (m_periodic_single_box) ? mfi.validbox() : mfi.fabbox();
-            amrex::Array4<amrex::Real> mf_arr = mf[mfi].array();
-            amrex::Array4<const amrex::Real> tmp_arr = tmpRealField[mfi].array();
-
-            const amrex::Real inv_N = 1._rt / tmpRealField[mfi].box().numPts();
+        // Copy field into the right index
+        fields_arr(i,j,k,field_index) = spectral_field_value;
+    });
+}
 
-            // Total number of cells, including ghost cells (nj represents ny in 3D and nz in 2D)
-            const int ni = mf_box.length(0);
-#if   defined(WARPX_DIM_1D_Z)
-            constexpr int nj = 1;
-            constexpr int nk = 1;
+void
+SpectralFieldData::LoadSpectralField (const MFIter& mfi, const IndexType ixtype,
+                                      const int field_index, const int tmp_comp)
+{
+    // Check field index type, in order to apply proper shift in spectral space
+#if (AMREX_SPACEDIM >= 2)
+    const bool is_nodal_x = ixtype.nodeCentered(0);
+#endif
+#if defined(WARPX_DIM_3D)
+    const bool is_nodal_y = ixtype.nodeCentered(1);
+    const bool is_nodal_z = ixtype.nodeCentered(2);
 #elif defined(WARPX_DIM_XZ) || defined(WARPX_DIM_RZ)
-            const int nj = mf_box.length(1);
-            constexpr int nk = 1;
-#elif defined(WARPX_DIM_3D)
-            const int nj = mf_box.length(1);
-            const int nk = mf_box.length(2);
+    const bool is_nodal_z = ixtype.nodeCentered(1);
+#elif defined(WARPX_DIM_1D_Z)
+    const bool is_nodal_z = ixtype.nodeCentered(0);
 #endif
-            // Lower bound of the box (lo_j represents lo_y in 3D and lo_z in 2D)
-            const int lo_i = amrex::lbound(mf_box).x;
-#if   defined(WARPX_DIM_1D_Z)
-            constexpr int lo_j = 0;
-            constexpr int lo_k = 0;
+
+    // Apply correcting shift factor if the field is to be transformed
+    // to a cell-centered grid in real space instead of a nodal grid.
+    Array4<const Complex> field_arr = SpectralFieldData::fields[mfi].array();
+    Array4<Complex> tmp_arr = tmpSpectralField[mfi].array();
+#if (AMREX_SPACEDIM >= 2)
+    const Complex* xshift_arr = xshift_FFTtoCell[mfi].dataPtr();
+#endif
+#if defined(WARPX_DIM_3D)
+    const Complex* yshift_arr = yshift_FFTtoCell[mfi].dataPtr();
+#endif
+    const Complex* zshift_arr = zshift_FFTtoCell[mfi].dataPtr();
+    // Loop over indices within one box
+    const Box spectralspace_bx = tmpSpectralField[mfi].box();
+
+    ParallelFor( spectralspace_bx,
+    [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept {
+        Complex spectral_field_value = field_arr(i,j,k,field_index);
+        // Apply proper shift in each dimension
+#if (AMREX_SPACEDIM >= 2)
+        if (is_nodal_x==false) spectral_field_value *= xshift_arr[i];
+#endif
+#if defined(WARPX_DIM_3D)
+        if (is_nodal_y==false) spectral_field_value *= yshift_arr[j];
+        if (is_nodal_z==false) spectral_field_value *= zshift_arr[k];
 #elif defined(WARPX_DIM_XZ) || defined(WARPX_DIM_RZ)
-            const int lo_j = amrex::lbound(mf_box).y;
-            constexpr int lo_k = 0;
-#elif defined(WARPX_DIM_3D)
-            const int lo_j = amrex::lbound(mf_box).y;
-            const int lo_k = amrex::lbound(mf_box).z;
+        if (is_nodal_z==false) spectral_field_value *= zshift_arr[j];
+#elif defined(WARPX_DIM_1D_Z)
+        if (is_nodal_z==false) spectral_field_value *= zshift_arr[i];
 #endif
-            // If necessary, do not fill the guard cells
-            // (shrink box by passing negative number of cells)
-            if (m_periodic_single_box == false)
-            {
-                for (int dir = 0; dir < AMREX_SPACEDIM; dir++)
-                {
-                    if (static_cast<bool>(fill_guards[dir]) == false) mf_box.grow(dir, -mf_ng[dir]);
-                }
-            }
-
-            // Loop over cells within full box, including ghost cells
-            ParallelFor(mf_box, [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept
-            {
-                // Assume periodicity and set the last outer guard cell equal to the first one:
-                // this is necessary in order to get the correct value along a nodal direction,
-                // because the last point along a nodal direction is always discarded when FFTs
-                // are computed, as the real-space box is always cell-centered.
-                const int ii = (i == lo_i + ni - si) ? lo_i : i;
-                const int jj = (j == lo_j + nj - sj) ? lo_j : j;
-                const int kk = (k == lo_k + nk - sk) ? lo_k : k;
-                // Copy and normalize field
-                mf_arr(i,j,k,i_comp) = inv_N * tmp_arr(ii,jj,kk);
-            });
-        }
+        // Copy field into temporary array
+        tmp_arr(i,j,k,tmp_comp) = spectral_field_value;
+    });
+}
 
-        if (do_costs)
-        {
-            amrex::Gpu::synchronize();
-            wt = amrex::second() - wt;
-            amrex::HostDevice::Atomic::Add( &(*cost)[mfi.index()], wt);
-        }
+#ifdef WARPX_USE_HEFFTE
+MultiFab
+SpectralFieldData::GlobalRealFieldAlias (const IndexType ixtype)
+{
+    // The boxes have the same points as the cell-centered slabs, so that the data
+    // of tmpRealField can be used as is
+    BoxArray ba = amrex::convert(tmpRealField.boxArray(), ixtype);
+    for (int dir = 0; dir < AMREX_SPACEDIM; dir++) {
+        if (ixtype.nodeCentered(dir)) ba.growHi(dir, -1);
+    }
+    MultiFab alias(ba, tmpRealField.DistributionMap(), 1, 0, MFInfo().SetAlloc(false));
+    for ( MFIter mfi(alias); mfi.isValid(); ++mfi ){
+        alias.setFab(mfi, FArrayBox(alias.box(mfi.index()), 1, tmpRealField[mfi].dataPtr()));
     }
+    return alias;
 }
 
+void
+SpectralFieldData::ExecuteGlobalFFT (const AnyFFT::direction dir)
+{
+    // The ranks that own no slab take part in the FFT with empty boxes
+    Real* real_ptr = nullptr;
+    std::complex<Real>* complex_ptr = nullptr;
+    for ( MFIter mfi(tmpRealField); mfi.isValid(); ++mfi ){
+        real_ptr = tmpRealField[mfi].dataPtr();
+        complex_ptr = reinterpret_cast<std::complex<Real>*>(tmpSpectralField[mfi].dataPtr());
+    }
+    // heFFTe does not run on the AMReX stream
+    amrex::Gpu::streamSynchronize();
+    if (dir == AnyFFT::direction::R2C) {
+        m_global_plan->forward(real_ptr, complex_ptr);
+    } else {
+        // Normalize, dividing by the number of points of the domain, since
+        // (FFT + inverse FFT) results in a factor N
+        m_global_plan->backward(complex_ptr, real_ptr, heffte::scale::full);
+    }
+    amrex::Gpu::streamSynchronize();
+}
+#endif
+
 #endif // WARPX_USE_PSATD
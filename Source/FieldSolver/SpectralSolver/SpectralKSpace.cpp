@@ -34,16 +34,32 @@ using namespace amrex;
  * of the fields in real space (cell-centered ; includes guard cells)
  * \param dm Indicates which MPI proc owns which box, in realspace_ba.
  * \param realspace_dx Cell size of the grid in real space
+ * \param global_domain Domain of the global FFT if the boxes of realspace_ba
+ * are slabs of a global FFT, empty box for local FFTs
  */
 SpectralKSpace::SpectralKSpace( const BoxArray& realspace_ba,
                                 const DistributionMapping& dm,
-                                const RealVect realspace_dx )
+                                const RealVect realspace_dx,
+                                const Box& global_domain )
     : dx(realspace_dx)  // Store the cell size as member `dx`
 {
     WARPX_ALWAYS_ASSERT_WITH_MESSAGE(
         realspace_ba.ixType()==IndexType::TheCellType(),
         "SpectralKSpace expects a cell-centered box.");
 
+    // With global FFTs, the k values of each box are those of its points
+    // in the spectral space of the whole domain
+    m_k_offset.resize(realspace_ba.size(), IntVect::TheZeroVector());
+    if (global_domain.ok()) {
+        m_global_fft_size = global_domain.length();
+        for (int i=0; i < realspace_ba.size(); i++ ) {
+            WARPX_ALWAYS_ASSERT_WITH_MESSAGE(
+                realspace_ba[i].length(0) == m_global_fft_size[0],
+                "SpectralKSpace: the slabs of a global FFT must span the first direction");
+            m_k_offset[i] = realspace_ba[i].smallEnd() - global_domain.smallEnd();
+        }
+    }
+
     // Create the box array that corresponds to spectral space
     BoxList spectral_bl; // Create empty box list
     // Loop over boxes and fill the box list
@@ -104,8 +120,12 @@ SpectralKSpace::getKComponent( const DistributionMapping& dm,
         Real* pk = k.data();
 
         // Fill the k vector
+        // (with global FFTs, the box holds the points off, ..., off+N-1 of the
+        // n_fft points of the global FFT)
         IntVect fft_size = realspace_ba[mfi].length();
-        const Real dk = 2*MathConst::pi/(fft_size[i_dim]*dx[i_dim]);
+        const int n_fft = (m_global_fft_size[i_dim] > 0) ? m_global_fft_size[i_dim] : fft_size[i_dim];
+        const int off = m_k_offset[mfi.index()][i_dim];
+        const Real dk = 2*MathConst::pi/(n_fft*dx[i_dim]);
         WARPX_ALWAYS_ASSERT_WITH_MESSAGE( bx.smallEnd(i_dim) == 0,
             "Expected box to start at 0, in spectral space.");
         WARPX_ALWAYS_ASSERT_WITH_MESSAGE( bx.bigEnd(i_dim) == N-1,
@@ -115,20 +135,21 @@ SpectralKSpace::getKComponent( const DistributionMapping& dm,
             // (typically: first axis, in a real-to-complex FFT)
             amrex::ParallelFor(N, [=] AMREX_GPU_DEVICE (int i) noexcept
             {
-                pk[i] = i*dk;
+                pk[i] = (i+off)*dk;
             });
         } else {
-            const int mid_point = (N+1)/2;
+            const int mid_point = (n_fft+1)/2;
             amrex::ParallelFor(N, [=] AMREX_GPU_DEVICE (int i) noexcept
             {
-                if (i < mid_point) {
+                const int ig = i + off;
+                if (ig < mid_point) {
                     // Fill positive values of k
                     // (FFT conventions: first half is positive)
-                    pk[i] = i*dk;
+                    pk[i] = ig*dk;
                 } else {
                     // Fill negative values of k
                     // (FFT conventions: second half is negative)
-                    pk[i] = (i-N)*dk;
+                    pk[i] = (ig-n_fft)*dk;
                 }
             });
         }
@@ -237,6 +258,10 @@ SpectralKSpace::getModifiedKComponent( const DistributionMapping& dm,
             modified_k.resize(N);
             Real const* p_k = k.data();
             Real * p_modified_k = modified_k.data();
+            // Number of points of the FFT and index of the first point of the box
+            // (differ from N and 0 along the directions split by global FFTs)
+            const int n_fft = (m_global_fft_size[i_dim] > 0) ? m_global_fft_size[i_dim] : N;
+            const int off = m_k_offset[mfi.index()][i_dim];
 
             // Fill the modified k vector
             amrex::ParallelFor(N, [=] AMREX_GPU_DEVICE (int i) noexcept
@@ -268,7 +293,7 @@ SpectralKSpace::getModifiedKComponent( const DistributionMapping& dm,
                     } else {
                         // The other axes contains both positive and negative k ;
                         // the Nyquist frequency is in the middle of the array.
-                        if ( (N%2==0) && (i == N/2) ){
+                        if ( (n_fft%2==0) && (i+off == n_fft/2) ){
                             p_modified_k[i] = 0.0_rt;
                         }
                     }
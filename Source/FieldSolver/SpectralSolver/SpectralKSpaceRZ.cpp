@@ -45,6 +45,9 @@ SpectralKSpaceRZ::SpectralKSpaceRZ (const amrex::BoxArray& realspace_ba,
     }
     spectralspace_ba.define(spectral_bl);
 
+    // The FFTs are local to each box
+    m_k_offset.resize(realspace_ba.size(), amrex::IntVect::TheZeroVector());
+
     // Allocate the components of the kz vector
     const int i_dim = 1;
     const bool only_positive_k = false;
@@ -0,0 +1,110 @@
+/* This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+#include "SpectralMagnetostaticSolver.H"
+
+#include "SpectralKSpace.H"
+#include "Utils/WarpXProfilerWrapper.H"
+
+#include <AMReX_Array4.H>
+#include <AMReX_Box.H>
+#include <AMReX_GpuComplex.H>
+#include <AMReX_GpuDevice.H>
+#include <AMReX_GpuLaunch.H>
+#include <AMReX_IntVect.H>
+#include <AMReX_MFIter.H>
+#include <AMReX_REAL.H>
+
+#if WARPX_USE_PSATD
+
+using namespace amrex;
+
+SpectralMagnetostaticSolver::SpectralMagnetostaticSolver (const int lev,
+                                                          const BoxArray& realspace_ba,
+                                                          const DistributionMapping& dm,
+                                                          const RealVect dx)
+{
+    const SpectralKSpace k_space = SpectralKSpace(realspace_ba, dm, dx);
+
+    // The domain is periodic and is covered by a single box, so that the FFTs
+    // are done on the valid cells only
+    m_field_data = SpectralFieldData(lev, realspace_ba, k_space, dm, n_demag_fields, true);
+
+    // Modified k of the second-order staggered stencil, 2/dx sin(k dx/2),
+    // consistent with the finite-difference divergence and gradient on the Yee grid
+    const KVectorComponent modified_kx_vec = k_space.getModifiedKComponent(dm, 0, 2, false);
+    const KVectorComponent modified_ky_vec = k_space.getModifiedKComponent(dm, 1, 2, false);
+    const KVectorComponent modified_kz_vec = k_space.getModifiedKComponent(dm, 2, 2, false);
+
+    const BoxArray& spectralspace_ba = k_space.spectralspace_ba;
+    m_demag_tensor = MultiFab(spectralspace_ba, dm, n_demag_tensor, 0);
+
+    for (MFIter mfi(spectralspace_ba, dm); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = spectralspace_ba[mfi];
+        Array4<Real> const& N = m_demag_tensor.array(mfi);
+        const Real* modified_kx_arr = modified_kx_vec[mfi].dataPtr();
+        const Real* modified_ky_arr = modified_ky_vec[mfi].dataPtr();
+        const Real* modified_kz_arr = modified_kz_vec[mfi].dataPtr();
+
+        ParallelFor(bx, [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept
+        {
+            const Real kx = modified_kx_arr[i];
+            const Real ky = modified_ky_arr[j];
+            const Real kz = modified_kz_arr[k];
+            const Real k_norm2 = kx*kx + ky*ky + kz*kz;
+            // the k = 0 mode (uniform M) has no demagnetizing field in a periodic domain
+            const Real inv_k_norm2 = (k_norm2 > 0._rt) ? 1._rt / k_norm2 : 0._rt;
+
+            N(i,j,k,Nxx) = kx * kx * inv_k_norm2;
+            N(i,j,k,Nxy) = kx * ky * inv_k_norm2;
+            N(i,j,k,Nxz) = kx * kz * inv_k_norm2;
+            N(i,j,k,Nyy) = ky * ky * inv_k_norm2;
+            N(i,j,k,Nyz) = ky * kz * inv_k_norm2;
+            N(i,j,k,Nzz) = kz * kz * inv_k_norm2;
+        });
+    }
+    // the modified k vectors are released at the end of the constructor
+    Gpu::synchronize();
+}
+
+void
+SpectralMagnetostaticSolver::ComputeDemagField (
+    const int lev,
+    const std::array<std::unique_ptr<MultiFab>, 3>& Mfield,
+    std::array<std::unique_ptr<MultiFab>, 3>& Hfield)
+{
+    WARPX_PROFILE("SpectralMagnetostaticSolver::ComputeDemagField");
+
+    // Forward Fourier transform of the normal component of M on each face;
+    // the staggering is accounted for by the shift factors of SpectralFieldData
+    m_field_data.ForwardTransform(lev, {Mfield[0].get(), Mfield[1].get(), Mfield[2].get()},
+                                  {Mx, My, Mz}, {0, 1, 2});
+
+    // H(k) = -N(k) M(k), stored in place of M(k)
+    for (MFIter mfi(m_field_data.fields); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = m_field_data.fields[mfi].box();
+        Array4<Complex> const& fields = m_field_data.fields[mfi].array();
+        Array4<Real const> const& N = m_demag_tensor.const_array(mfi);
+
+        ParallelFor(bx, [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept
+        {
+            const Complex mx = fields(i,j,k,Mx);
+            const Complex my = fields(i,j,k,My);
+            const Complex mz = fields(i,j,k,Mz);
+
+            fields(i,j,k,Mx) = -(N(i,j,k,Nxx) * mx + N(i,j,k,Nxy) * my + N(i,j,k,Nxz) * mz);
+            fields(i,j,k,My) = -(N(i,j,k,Nxy) * mx + N(i,j,k,Nyy) * my + N(i,j,k,Nyz) * mz);
+            fields(i,j,k,Mz) = -(N(i,j,k,Nxz) * mx + N(i,j,k,Nyz) * my + N(i,j,k,Nzz) * mz);
+        });
+    }
+
+    // Backward Fourier transform of H; the guard cells are filled by the caller
+    const IntVect fill_guards = IntVect::TheZeroVector();
+    m_field_data.BackwardTransform(lev, {Hfield[0].get(), Hfield[1].get(), Hfield[2].get()},
+                                   {Mx, My, Mz}, {0, 0, 0}, fill_guards);
+}
+
+#endif // WARPX_USE_PSATD
@@ -12,12 +12,41 @@
 #include "SpectralAlgorithms/PsatdAlgorithmJLinearInTime.H"
 #include "SpectralKSpace.H"
 #include "SpectralSolver.H"
+#include "Utils/TextMsg.H"
+#include "Utils/WarpXConst.H"
 #include "Utils/WarpXProfilerWrapper.H"
 
+#include <AMReX_BoxList.H>
+#include <AMReX_DistributionMapping.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_Vector.H>
+
+#include <algorithm>
 #include <memory>
+#include <numeric>
 
 #if WARPX_USE_PSATD
 
+namespace
+{
+    /** \brief Slabs of the domain along the last direction, at most one per MPI rank,
+     *  for the distributed global FFTs */
+    amrex::BoxArray GlobalFFTSlabs (const amrex::Box& domain)
+    {
+        constexpr int dir = AMREX_SPACEDIM-1;
+        const int n = domain.length(dir);
+        const int n_slabs = std::min(n, amrex::ParallelDescriptor::NProcs());
+        amrex::BoxList bl;
+        for (int s = 0; s < n_slabs; ++s) {
+            amrex::Box slab = domain;
+            slab.setSmall(dir, domain.smallEnd(dir) + (s*n)/n_slabs);
+            slab.setBig(dir, domain.smallEnd(dir) + ((s+1)*n)/n_slabs - 1);
+            bl.push_back(slab);
+        }
+        return amrex::BoxArray(std::move(bl));
+    }
+}
+
 SpectralSolver::SpectralSolver(
                 const int lev,
                 const amrex::BoxArray& realspace_ba,
@@ -29,18 +58,38 @@ SpectralSolver::SpectralSolver(
                 const amrex::Vector<amrex::Real>& v_comoving,
                 const amrex::RealVect dx, const amrex::Real dt,
                 const bool pml, const bool periodic_single_box,
+                const bool global_fft,
                 const bool update_with_rho,
                 const bool fft_do_time_averaging,
                 const bool do_multi_J,
                 const bool dive_cleaning,
-                const bool divb_cleaning)
+                const bool divb_cleaning,
+                const amrex::Real c_medium,
+                const amrex::Real eps_medium)
 {
-    // Initialize all structures using the same distribution mapping dm
+    // With global FFTs, the spectral solver works on slabs of the domain, slab s
+    // on rank s, instead of the boxes of the fields
+    amrex::Box global_domain;
+    amrex::BoxArray solver_ba = realspace_ba;
+    amrex::DistributionMapping solver_dm = dm;
+    if (global_fft) {
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(!pml,
+            "SpectralSolver: global FFTs are not implemented in the PML");
+        global_domain = realspace_ba.minimalBox();
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(realspace_ba.numPts() == global_domain.numPts(),
+            "SpectralSolver: global FFTs require boxes that cover the domain without guard cells");
+        solver_ba = GlobalFFTSlabs(global_domain);
+        amrex::Vector<int> pmap(solver_ba.size());
+        std::iota(pmap.begin(), pmap.end(), 0);
+        solver_dm = amrex::DistributionMapping(pmap);
+    }
+
+    // Initialize all structures using the same distribution mapping solver_dm
 
     // - Initialize k space object (Contains info about the size of
-    // the spectral space corresponding to each box in `realspace_ba`,
+    // the spectral space corresponding to each box in `solver_ba`,
     // as well as the value of the corresponding k coordinates)
-    const SpectralKSpace k_space= SpectralKSpace(realspace_ba, dm, dx);
+    const SpectralKSpace k_space= SpectralKSpace(solver_ba, solver_dm, dx, global_domain);
 
     m_spectral_index = SpectralFieldIndex(update_with_rho, fft_do_time_averaging,
                                           do_multi_J, dive_cleaning, divb_cleaning, pml);
@@ -51,39 +100,43 @@ SpectralSolver::SpectralSolver(
     if (pml) // PSATD equations in the PML grids
     {
         algorithm = std::make_unique<PsatdAlgorithmPml>(
-            k_space, dm, m_spectral_index, norder_x, norder_y, norder_z, nodal,
-            fill_guards, dt, dive_cleaning, divb_cleaning);
+            k_space, solver_dm, m_spectral_index, norder_x, norder_y, norder_z, nodal,
+            fill_guards, dt, dive_cleaning, divb_cleaning, c_medium);
     }
     else // PSATD equations in the regulard grids
     {
         // Comoving PSATD algorithm
         if (v_comoving[0] != 0. || v_comoving[1] != 0. || v_comoving[2] != 0.)
         {
+            WARPX_ALWAYS_ASSERT_WITH_MESSAGE(c_medium == PhysConst::c && eps_medium == PhysConst::ep0,
+                "The comoving PSATD algorithm is only implemented in vacuum");
             algorithm = std::make_unique<PsatdAlgorithmComoving>(
-                k_space, dm, m_spectral_index, norder_x, norder_y, norder_z, nodal,
+                k_space, solver_dm, m_spectral_index, norder_x, norder_y, norder_z, nodal,
                 fill_guards, v_comoving, dt, update_with_rho);
         }
         else // PSATD algorithms: standard, Galilean, averaged Galilean, multi-J
         {
             if (do_multi_J)
             {
+                WARPX_ALWAYS_ASSERT_WITH_MESSAGE(c_medium == PhysConst::c && eps_medium == PhysConst::ep0,
+                    "The multi-J PSATD algorithm is only implemented in vacuum");
                 algorithm = std::make_unique<PsatdAlgorithmJLinearInTime>(
-                    k_space, dm, m_spectral_index, norder_x, norder_y, norder_z, nodal,
+                    k_space, solver_dm, m_spectral_index, norder_x, norder_y, norder_z, nodal,
                     fill_guards, dt, fft_do_time_averaging, dive_cleaning, divb_cleaning);
             }
             else // standard, Galilean, averaged Galilean
             {
                 algorithm = std::make_unique<PsatdAlgorithm>(
-                    k_space, dm, m_spectral_index, norder_x, norder_y, norder_z, nodal,
+                    k_space, solver_dm, m_spectral_index, norder_x, norder_y, norder_z, nodal,
                     fill_guards, v_galilean, dt, update_with_rho, fft_do_time_averaging,
-                    dive_cleaning, divb_cleaning);
+                    dive_cleaning, divb_cleaning, c_medium, eps_medium);
             }
         }
     }
 
     // - Initialize arrays for fields in spectral space + FFT plans
-    field_data = SpectralFieldData(lev, realspace_ba, k_space, dm,
-                                   m_spectral_index.n_fields, periodic_single_box);
+    field_data = SpectralFieldData(lev, solver_ba, k_space, solver_dm,
+                                   m_spectral_index.n_fields, periodic_single_box, global_fft);
 
     m_fill_guards = fill_guards;
 }
@@ -108,6 +161,28 @@ SpectralSolver::BackwardTransform( const int lev,
     field_data.BackwardTransform(lev, mf, field_index, i_comp, m_fill_guards);
 }
 
+void
+SpectralSolver::ForwardTransform (const int lev,
+                                  const std::array<std::unique_ptr<amrex::MultiFab>,3>& vector_field,
+                                  const std::array<int,3>& field_index)
+{
+    WARPX_PROFILE("SpectralSolver::ForwardTransform");
+    field_data.ForwardTransform(lev,
+        {vector_field[0].get(), vector_field[1].get(), vector_field[2].get()},
+        field_index, {0, 0, 0});
+}
+
+void
+SpectralSolver::BackwardTransform (const int lev,
+                                   const std::array<std::unique_ptr<amrex::MultiFab>,3>& vector_field,
+                                   const std::array<int,3>& field_index)
+{
+    WARPX_PROFILE("SpectralSolver::BackwardTransform");
+    field_data.BackwardTransform(lev,
+        {vector_field[0].get(), vector_field[1].get(), vector_field[2].get()},
+        field_index, {0, 0, 0}, m_fill_guards);
+}
+
 void
 SpectralSolver::pushSpectralFields(){
     WARPX_PROFILE("SpectralSolver::pushSpectralFields");
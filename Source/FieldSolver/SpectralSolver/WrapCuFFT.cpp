@@ -23,34 +23,27 @@ namespace AnyFFT
     std::string cufftErrorToString (const cufftResult& err);
 
     FFTplan CreatePlan(const amrex::IntVect& real_size, amrex::Real * const real_array,
-                       Complex * const complex_array, const direction dir, const int dim)
+                       Complex * const complex_array, const direction dir, const int dim,
+                       const int howmany)
     {
         FFTplan fft_plan;
 
-        // Initialize fft_plan.m_plan with the vendor fft plan.
-        cufftResult result;
-        if (dir == direction::R2C){
-            if (dim == 3) {
-                result = cufftPlan3d(
-                    &(fft_plan.m_plan), real_size[2], real_size[1], real_size[0], VendorR2C);
-            } else if (dim == 2) {
-                result = cufftPlan2d(
-                    &(fft_plan.m_plan), real_size[1], real_size[0], VendorR2C);
-            } else {
-                amrex::Abort(Utils::TextMsg::Err("only dim=2 and dim=3 have been implemented"));
-            }
-        } else {
-            if (dim == 3) {
-                result = cufftPlan3d(
-                    &(fft_plan.m_plan), real_size[2], real_size[1], real_size[0], VendorC2R);
-            } else if (dim == 2) {
-                result = cufftPlan2d(
-                    &(fft_plan.m_plan), real_size[1], real_size[0], VendorC2R);
-            } else {
-                amrex::Abort(Utils::TextMsg::Err("only dim=2 and dim=3 have been implemented"));
-            }
+        if (dim != 2 && dim != 3) {
+            amrex::Abort(Utils::TextMsg::Err("only dim=2 and dim=3 have been implemented"));
+        }
+
+        // Swap dimensions: AMReX FAB are Fortran-order but cuFFT is C-order
+        int n[3];
+        for (int d = 0; d < dim; d++) {
+            n[d] = real_size[dim-1-d];
         }
 
+        // Initialize fft_plan.m_plan with the vendor fft plan.
+        // (null embedding arrays: the arrays of the howmany transforms are contiguous)
+        cufftResult result = cufftPlanMany(
+            &(fft_plan.m_plan), dim, n, nullptr, 1, 0, nullptr, 1, 0,
+            (dir == direction::R2C) ? VendorR2C : VendorC2R, howmany);
+
         if ( result != CUFFT_SUCCESS ) {
             amrex::Print() << Utils::TextMsg::Err(
                     "cufftplan failed! Error: "
@@ -62,6 +55,8 @@ namespace AnyFFT
         fft_plan.m_complex_array = complex_array;
         fft_plan.m_dir = dir;
         fft_plan.m_dim = dim;
+        fft_plan.m_real_size = real_size;
+        fft_plan.m_howmany = howmany;
 
         return fft_plan;
     }
@@ -72,21 +67,27 @@ namespace AnyFFT
     }
 
     void Execute(FFTplan& fft_plan){
+        Execute(fft_plan, fft_plan.m_real_array, fft_plan.m_complex_array);
+    }
+
+    void Execute(FFTplan& fft_plan, amrex::Real * const real_array,
+                 Complex * const complex_array)
+    {
         // make sure that this is done on the same GPU stream as the above copy
         cudaStream_t stream = amrex::Gpu::Device::cudaStream();
         cufftSetStream ( fft_plan.m_plan, stream);
         cufftResult result;
         if (fft_plan.m_dir == direction::R2C){
 #ifdef AMREX_USE_FLOAT
-            result = cufftExecR2C(fft_plan.m_plan, fft_plan.m_real_array, fft_plan.m_complex_array);
+            result = cufftExecR2C(fft_plan.m_plan, real_array, complex_array);
 #else
-            result = cufftExecD2Z(fft_plan.m_plan, fft_plan.m_real_array, fft_plan.m_complex_array);
+            result = cufftExecD2Z(fft_plan.m_plan, real_array, complex_array);
 #endif
         } else if (fft_plan.m_dir == direction::C2R){
 #ifdef AMREX_USE_FLOAT
-            result = cufftExecC2R(fft_plan.m_plan, fft_plan.m_complex_array, fft_plan.m_real_array);
+            result = cufftExecC2R(fft_plan.m_plan, complex_array, real_array);
 #else
-            result = cufftExecZ2D(fft_plan.m_plan, fft_plan.m_complex_array, fft_plan.m_real_array);
+            result = cufftExecZ2D(fft_plan.m_plan, complex_array, real_array);
 #endif
         } else {
             amrex::Abort(Utils::TextMsg::Err(
@@ -18,19 +18,22 @@
 namespace AnyFFT
 {
 #ifdef AMREX_USE_FLOAT
-    const auto VendorCreatePlanR2C3D = fftwf_plan_dft_r2c_3d;
-    const auto VendorCreatePlanC2R3D = fftwf_plan_dft_c2r_3d;
-    const auto VendorCreatePlanR2C2D = fftwf_plan_dft_r2c_2d;
-    const auto VendorCreatePlanC2R2D = fftwf_plan_dft_c2r_2d;
+    const auto VendorCreatePlanManyR2C = fftwf_plan_many_dft_r2c;
+    const auto VendorCreatePlanManyC2R = fftwf_plan_many_dft_c2r;
+    const auto VendorExecuteR2C = fftwf_execute_dft_r2c;
+    const auto VendorExecuteC2R = fftwf_execute_dft_c2r;
+    const auto VendorAlignmentOf = fftwf_alignment_of;
 #else
-    const auto VendorCreatePlanR2C3D = fftw_plan_dft_r2c_3d;
-    const auto VendorCreatePlanC2R3D = fftw_plan_dft_c2r_3d;
-    const auto VendorCreatePlanR2C2D = fftw_plan_dft_r2c_2d;
-    const auto VendorCreatePlanC2R2D = fftw_plan_dft_c2r_2d;
+    const auto VendorCreatePlanManyR2C = fftw_plan_many_dft_r2c;
+    const auto VendorCreatePlanManyC2R = fftw_plan_many_dft_c2r;
+    const auto VendorExecuteR2C = fftw_execute_dft_r2c;
+    const auto VendorExecuteC2R = fftw_execute_dft_c2r;
+    const auto VendorAlignmentOf = fftw_alignment_of;
 #endif
 
     FFTplan CreatePlan(const amrex::IntVect& real_size, amrex::Real * const real_array,
-                       Complex * const complex_array, const direction dir, const int dim)
+                       Complex * const complex_array, const direction dir, const int dim,
+                       const int howmany)
     {
         FFTplan fft_plan;
 
@@ -44,30 +47,31 @@ namespace AnyFFT
 #   endif
 #endif
 
-        // Initialize fft_plan.m_plan with the vendor fft plan.
+        if (dim != 2 && dim != 3) {
+            amrex::Abort(Utils::TextMsg::Err(
+                "only dim=2 and dim=3 have been implemented. Should be easy to add dim=1."));
+        }
+
         // Swap dimensions: AMReX FAB are Fortran-order but FFTW is C-order
+        int n[3];
+        // Distance between the arrays of two successive transforms
+        int real_dist = 1;
+        int complex_dist = 1;
+        for (int d = 0; d < dim; d++) {
+            n[d] = real_size[dim-1-d];
+            real_dist *= real_size[d];
+            complex_dist *= (d == 0) ? real_size[0]/2 + 1 : real_size[d];
+        }
+
+        // Initialize fft_plan.m_plan with the vendor fft plan.
         if (dir == direction::R2C){
-            if (dim == 3) {
-                fft_plan.m_plan = VendorCreatePlanR2C3D(
-                    real_size[2], real_size[1], real_size[0], real_array, complex_array, FFTW_ESTIMATE);
-            } else if (dim == 2) {
-                fft_plan.m_plan = VendorCreatePlanR2C2D(
-                    real_size[1], real_size[0], real_array, complex_array, FFTW_ESTIMATE);
-            } else {
-                amrex::Abort(Utils::TextMsg::Err(
-                    "only dim=2 and dim=3 have been implemented"));
-            }
+            fft_plan.m_plan = VendorCreatePlanManyR2C(
+                dim, n, howmany, real_array, nullptr, 1, real_dist,
+                complex_array, nullptr, 1, complex_dist, FFTW_ESTIMATE);
         } else if (dir == direction::C2R){
-            if (dim == 3) {
-                fft_plan.m_plan = VendorCreatePlanC2R3D(
-                    real_size[2], real_size[1], real_size[0], complex_array, real_array, FFTW_ESTIMATE);
-            } else if (dim == 2) {
-                fft_plan.m_plan = VendorCreatePlanC2R2D(
-                    real_size[1], real_size[0], complex_array, real_array, FFTW_ESTIMATE);
-            } else {
-                amrex::Abort(Utils::TextMsg::Err(
-                    "only dim=2 and dim=3 have been implemented. Should be easy to add dim=1."));
-            }
+            fft_plan.m_plan = VendorCreatePlanManyC2R(
+                dim, n, howmany, complex_array, nullptr, 1, complex_dist,
+                real_array, nullptr, 1, real_dist, FFTW_ESTIMATE);
         }
 
         // Store meta-data in fft_plan
@@ -75,6 +79,8 @@ namespace AnyFFT
         fft_plan.m_complex_array = complex_array;
         fft_plan.m_dir = dir;
         fft_plan.m_dim = dim;
+        fft_plan.m_real_size = real_size;
+        fft_plan.m_howmany = howmany;
 
         return fft_plan;
     }
@@ -95,4 +101,27 @@ namespace AnyFFT
         fftw_execute( fft_plan.m_plan );
 #  endif
     }
+
+    void Execute(FFTplan& fft_plan, amrex::Real * const real_array,
+                 Complex * const complex_array)
+    {
+        // The new-array execute functions of FFTW require arrays with the same alignment
+        // as those of the plan (always the case for the arrays of the AMReX arenas)
+        const bool same_alignment =
+            VendorAlignmentOf(real_array) == VendorAlignmentOf(fft_plan.m_real_array) &&
+            VendorAlignmentOf(reinterpret_cast<amrex::Real*>(complex_array)) ==
+            VendorAlignmentOf(reinterpret_cast<amrex::Real*>(fft_plan.m_complex_array));
+        if (!same_alignment) {
+            FFTplan tmp_plan = CreatePlan(fft_plan.m_real_size, real_array, complex_array,
+                                          fft_plan.m_dir, fft_plan.m_dim, fft_plan.m_howmany);
+            Execute(tmp_plan);
+            DestroyPlan(tmp_plan);
+            return;
+        }
+        if (fft_plan.m_dir == direction::R2C) {
+            VendorExecuteR2C(fft_plan.m_plan, real_array, complex_array);
+        } else {
+            VendorExecuteC2R(fft_plan.m_plan, complex_array, real_array);
+        }
+    }
 }
@@ -25,7 +25,8 @@ namespace AnyFFT
     }
 
     FFTplan CreatePlan (const amrex::IntVect& real_size, amrex::Real * const real_array,
-                        Complex * const complex_array, const direction dir, const int dim)
+                        Complex * const complex_array, const direction dir, const int dim,
+                        const int howmany)
     {
         FFTplan fft_plan;
 
@@ -34,6 +35,7 @@ namespace AnyFFT
                                                     std::size_t(real_size[2]))};
 
         // Initialize fft_plan.m_plan with the vendor fft plan.
+        // (default description: the arrays of the howmany transforms are contiguous)
         rocfft_status result = rocfft_plan_create(&(fft_plan.m_plan),
                                                   rocfft_placement_notinplace,
                                                   (dir == direction::R2C)
@@ -45,15 +47,33 @@ namespace AnyFFT
                                                   rocfft_precision_double,
 #endif
                                                   dim, lengths,
-                                                  1, // number of transforms,
+                                                  howmany, // number of transforms,
                                                   nullptr);
         assert_rocfft_status("rocfft_plan_create", result);
 
+        // The work buffer is allocated once with the plan, and reused by all its executions
+        result = rocfft_execution_info_create(&(fft_plan.m_execinfo));
+        assert_rocfft_status("rocfft_execution_info_create", result);
+
+        std::size_t buffersize = 0;
+        result = rocfft_plan_get_work_buffer_size(fft_plan.m_plan, &buffersize);
+        assert_rocfft_status("rocfft_plan_get_work_buffer_size", result);
+
+        fft_plan.m_work_buffer = nullptr;
+        if (buffersize > 0) {
+            fft_plan.m_work_buffer = amrex::The_Arena()->alloc(buffersize);
+            result = rocfft_execution_info_set_work_buffer(fft_plan.m_execinfo,
+                                                           fft_plan.m_work_buffer, buffersize);
+            assert_rocfft_status("rocfft_execution_info_set_work_buffer", result);
+        }
+
         // Store meta-data in fft_plan
         fft_plan.m_real_array = real_array;
         fft_plan.m_complex_array = complex_array;
         fft_plan.m_dir = dir;
         fft_plan.m_dim = dim;
+        fft_plan.m_real_size = real_size;
+        fft_plan.m_howmany = howmany;
 
         return fft_plan;
     }
@@ -61,48 +81,40 @@ namespace AnyFFT
     void DestroyPlan (FFTplan& fft_plan)
     {
         rocfft_plan_destroy( fft_plan.m_plan );
+        rocfft_execution_info_destroy( fft_plan.m_execinfo );
+        if (fft_plan.m_work_buffer) amrex::The_Arena()->free(fft_plan.m_work_buffer);
     }
 
     void Execute (FFTplan& fft_plan)
     {
-        rocfft_execution_info execinfo = NULL;
-        rocfft_status result = rocfft_execution_info_create(&execinfo);
-        assert_rocfft_status("rocfft_execution_info_create", result);
-
-        std::size_t buffersize = 0;
-        result = rocfft_plan_get_work_buffer_size(fft_plan.m_plan, &buffersize);
-        assert_rocfft_status("rocfft_plan_get_work_buffer_size", result);
-
-        void* buffer = amrex::The_Arena()->alloc(buffersize);
-        result = rocfft_execution_info_set_work_buffer(execinfo, buffer, buffersize);
-        assert_rocfft_status("rocfft_execution_info_set_work_buffer", result);
+        Execute(fft_plan, fft_plan.m_real_array, fft_plan.m_complex_array);
+    }
 
-        result = rocfft_execution_info_set_stream(execinfo, amrex::Gpu::gpuStream());
+    void Execute (FFTplan& fft_plan, amrex::Real * const real_array,
+                  Complex * const complex_array)
+    {
+        rocfft_status result = rocfft_execution_info_set_stream(fft_plan.m_execinfo,
+                                                                amrex::Gpu::gpuStream());
         assert_rocfft_status("rocfft_execution_info_set_stream", result);
 
+        amrex::Real* real_ptr = real_array;
+        Complex* complex_ptr = complex_array;
         if (fft_plan.m_dir == direction::R2C) {
             result = rocfft_execute(fft_plan.m_plan,
-                                    (void**)&(fft_plan.m_real_array), // in
-                                    (void**)&(fft_plan.m_complex_array), // out
-                                    execinfo);
+                                    (void**)&real_ptr, // in
+                                    (void**)&complex_ptr, // out
+                                    fft_plan.m_execinfo);
         } else if (fft_plan.m_dir == direction::C2R) {
             result = rocfft_execute(fft_plan.m_plan,
-                                    (void**)&(fft_plan.m_complex_array), // in
-                                    (void**)&(fft_plan.m_real_array), // out
-                                    execinfo);
+                                    (void**)&complex_ptr, // in
+                                    (void**)&real_ptr, // out
+                                    fft_plan.m_execinfo);
         } else {
             amrex::Abort(Utils::TextMsg::Err(
                 "direction must be AnyFFT::direction::R2C or AnyFFT::direction::C2R"));
         }
 
         assert_rocfft_status("rocfft_execute", result);
-
-        amrex::Gpu::streamSynchronize();
-
-        amrex::The_Arena()->free(buffer);
-
-        result = rocfft_execution_info_destroy(execinfo);
-        assert_rocfft_status("rocfft_execution_info_destroy", result);
     }
 
     /** \brief This method converts a rocfftResult
@@ -0,0 +1,258 @@
+/* This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+#include "TFSFSource.H"
+
+#include "Utils/TextMsg.H"
+#include "Utils/WarpXConst.H"
+#include "Utils/WarpXUtil.H"
+#include "WarpX.H"
+
+#include <AMReX.H>
+#include <AMReX_Array4.H>
+#include <AMReX_Box.H>
+#include <AMReX_GpuLaunch.H>
+#include <AMReX_GpuQualifiers.H>
+#include <AMReX_IndexType.H>
+#include <AMReX_IntVect.H>
+#include <AMReX_MFIter.H>
+#include <AMReX_ParmParse.H>
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+using namespace amrex;
+
+TFSFSource::TFSFSource (Geometry const& geom, Real t_start)
+    : m_t(t_start)
+{
+#ifndef WARPX_DIM_3D
+    amrex::ignore_unused(geom);
+    amrex::Abort(Utils::TextMsg::Err("The TFSF source is only implemented in 3D"));
+#else
+    ParmParse pp_tfsf("tfsf");
+
+    std::vector<Real> lo, hi;
+    getArrWithParser(pp_tfsf, "lo", lo, 0, 3);
+    getArrWithParser(pp_tfsf, "hi", hi, 0, 3);
+
+    std::string direction;
+    pp_tfsf.get("direction", direction);
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(direction.size() == 2
+        && (direction[0] == '+' || direction[0] == '-')
+        && std::string("xyz").find(direction[1]) != std::string::npos,
+        "tfsf.direction must be one of +x, -x, +y, -y, +z, -z");
+    m_dir_sign = (direction[0] == '+') ? 1 : -1;
+    m_dir = static_cast<int>(std::string("xyz").find(direction[1]));
+
+    std::string polarization;
+    pp_tfsf.get("polarization", polarization);
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(polarization.size() == 1
+        && std::string("xyz").find(polarization[0]) != std::string::npos,
+        "tfsf.polarization must be x, y or z");
+    m_E_dir = static_cast<int>(std::string("xyz").find(polarization[0]));
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(m_E_dir != m_dir,
+        "tfsf.polarization must be normal to tfsf.direction");
+    // H is along k x e_E
+    m_H_dir = 3 - m_dir - m_E_dir;
+    m_H_sign = m_dir_sign * ((m_E_dir == (m_dir+1)%3) ? 1 : -1);
+
+    Real epsilon_r = 1._rt;
+    Real mu_r = 1._rt;
+    queryWithParser(pp_tfsf, "epsilon_r", epsilon_r);
+    queryWithParser(pp_tfsf, "mu_r", mu_r);
+    m_eps = epsilon_r * PhysConst::ep0;
+    m_mu = mu_r * PhysConst::mu0;
+    queryWithParser(pp_tfsf, "n_absorber", m_n_absorber);
+
+    std::string waveform_str;
+    Store_parserString(pp_tfsf, "waveform_function(t)", waveform_str);
+    m_waveform_parser = std::make_unique<Parser>(makeParser(waveform_str, {"t"}));
+    m_waveform = m_waveform_parser->compileHost<1>();
+
+    // the total-field box, snapped to the nodes of the grid
+    constexpr int big = 1 << 28;
+    amrex::GpuArray<int, 3> lo_node, hi_node;
+    for (int idim = 0; idim < 3; ++idim) {
+        m_dx[idim] = geom.CellSize(idim);
+        lo_node[idim] = static_cast<int>(std::round((lo[idim] - geom.ProbLo(idim)) / m_dx[idim]));
+        hi_node[idim] = static_cast<int>(std::round((hi[idim] - geom.ProbLo(idim)) / m_dx[idim]));
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(hi_node[idim] - lo_node[idim] >= 2,
+            "The TFSF box must be at least two cells wide in each direction");
+        m_lo_active[idim] = lo_node[idim] > geom.Domain().smallEnd(idim);
+        m_hi_active[idim] = hi_node[idim] < geom.Domain().bigEnd(idim) + 1;
+        m_lo2[idim] = m_lo_active[idim] ? 2*lo_node[idim] : -big;
+        m_hi2[idim] = m_hi_active[idim] ? 2*hi_node[idim] : big;
+    }
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(
+        (m_dir_sign > 0) ? m_lo_active[m_dir] : m_hi_active[m_dir],
+        "The face of the TFSF box through which the wave enters must be inside the domain");
+
+    // the 1D grid starts two cells before the entrance face and extends two cells beyond
+    // the exit face, followed by the absorbing layer
+    m_origin = (m_dir_sign > 0) ? lo_node[m_dir] - 2 : hi_node[m_dir] + 2;
+    const int n_cells = hi_node[m_dir] - lo_node[m_dir] + 4 + m_n_absorber;
+    m_e_inc.resize(n_cells + 1, 0._rt);
+    m_h_inc.resize(n_cells, 0._rt);
+    m_loss_e.resize(n_cells + 1, 0._rt);
+    m_loss_h.resize(n_cells, 0._rt);
+
+    // graded (cubic) absorbing layer, for a normal reflection of 1e-6
+    const Real ds = m_dx[m_dir];
+    const Real eta = std::sqrt(m_mu / m_eps);
+    const Real sigma_max = -4._rt * std::log(1.e-6_rt) / (2._rt * eta * m_n_absorber * ds);
+    const int m_abs = n_cells - m_n_absorber;
+    auto loss_rate = [=] (Real m) {
+        const Real x = std::max(m - m_abs, 0._rt) / m_n_absorber;
+        return sigma_max / m_eps * x * x * x;
+    };
+    for (int m = 0; m <= n_cells; ++m) m_loss_e[m] = loss_rate(static_cast<Real>(m));
+    for (int m = 0; m < n_cells; ++m) m_loss_h[m] = loss_rate(m + 0.5_rt);
+
+    m_e_inc_d.resize(m_e_inc.size());
+    m_h_inc_d.resize(m_h_inc.size());
+    CopyIncidentToDevice();
+#endif
+}
+
+void
+TFSFSource::CopyIncidentToDevice ()
+{
+    Gpu::copyAsync(Gpu::hostToDevice, m_e_inc.begin(), m_e_inc.end(), m_e_inc_d.begin());
+    Gpu::copyAsync(Gpu::hostToDevice, m_h_inc.begin(), m_h_inc.end(), m_h_inc_d.begin());
+    Gpu::streamSynchronize();
+}
+
+void
+TFSFSource::CorrectHAndEvolveIncidentH (std::array<std::unique_ptr<MultiFab>, 3>& Hfield,
+                                        Real dt_half)
+{
+    // H -= dt/mu curl E (B -= dt curl E without LLG)
+    CorrectField(Hfield, m_e_inc_d, true, WarpX::mag_LLG ? -dt_half / m_mu : -dt_half);
+
+    const int n_cells = static_cast<int>(m_h_inc.size());
+    const Real ds = m_dx[m_dir];
+    for (int m = 0; m < n_cells; ++m) {
+        const Real loss = 0.5_rt * m_loss_h[m] * dt_half;
+        m_h_inc[m] = ((1._rt - loss) * m_h_inc[m]
+                      - dt_half / (m_mu * ds) * (m_e_inc[m+1] - m_e_inc[m])) / (1._rt + loss);
+    }
+    CopyIncidentToDevice();
+}
+
+void
+TFSFSource::CorrectEAndEvolveIncidentE (std::array<std::unique_ptr<MultiFab>, 3>& Efield,
+                                        Real dt)
+{
+    // E += dt/eps curl H
+    CorrectField(Efield, m_h_inc_d, false, dt / m_eps);
+
+    m_t += dt;
+    const int n_cells = static_cast<int>(m_h_inc.size());
+    const Real ds = m_dx[m_dir];
+    for (int m = 1; m < n_cells; ++m) {
+        const Real loss = 0.5_rt * m_loss_e[m] * dt;
+        m_e_inc[m] = ((1._rt - loss) * m_e_inc[m]
+                      - dt / (m_eps * ds) * (m_h_inc[m] - m_h_inc[m-1])) / (1._rt + loss);
+    }
+    // hard source at the first node, conductor behind the absorbing layer
+    m_e_inc[0] = m_waveform(m_t);
+    m_e_inc[n_cells] = 0._rt;
+    CopyIncidentToDevice();
+}
+
+void
+TFSFSource::CorrectField (std::array<std::unique_ptr<MultiFab>, 3>& field,
+                          Gpu::DeviceVector<Real> const& inc1d, bool inc_is_E, Real coef)
+{
+    constexpr int big = 1 << 28;
+    const int inc_dir = inc_is_E ? m_E_dir : m_H_dir;
+    const int inc_sign = inc_is_E ? 1 : m_H_sign;
+    const int n_inc = static_cast<int>(inc1d.size());
+    Real const* const AMREX_RESTRICT inc = inc1d.dataPtr();
+    const int dir = m_dir;
+    const int dir_sign = m_dir_sign;
+    const int origin = m_origin;
+    const auto lo2 = m_lo2;
+    const auto hi2 = m_hi2;
+
+    for (int a = 0; a < 3; ++a) {
+        // the curl of component a is d_b F_c - d_c F_b; only the incident component contributes
+        const int b = (a+1)%3;
+        const int c = (a+2)%3;
+        if (inc_dir == a) continue;
+        const int sdir = (inc_dir == c) ? b : c;
+        const Real w = ((inc_dir == c) ? 1._rt : -1._rt) / m_dx[sdir];
+
+        const IndexType ixtype = field[a]->ixType();
+        const GpuArray<int, 3> cc = {ixtype.nodeCentered(0) ? 0 : 1,
+                                     ixtype.nodeCentered(1) ? 0 : 1,
+                                     ixtype.nodeCentered(2) ? 0 : 1};
+
+        // The corrected points are within one half cell of the faces of the box. They are
+        // split in slabs along each face: the slab normal to idim is restricted to the
+        // interior of the box in the directions before idim, so that no point is corrected twice.
+        Vector<Box> slabs;
+        for (int idim = 0; idim < 3; ++idim) {
+            for (int side = 0; side < 2; ++side) {
+                if ((side == 0 && !m_lo_active[idim]) || (side == 1 && !m_hi_active[idim])) continue;
+                IntVect slab_lo, slab_hi;
+                for (int jdim = 0; jdim < 3; ++jdim) {
+                    const int lo_node = lo2[jdim] / 2;
+                    const int hi_node = hi2[jdim] / 2;
+                    const int full_lo = m_lo_active[jdim] ? lo_node - 1 : -big;
+                    const int full_hi = m_hi_active[jdim] ? hi_node + 1 - cc[jdim] : big;
+                    if (jdim == idim) {
+                        slab_lo[jdim] = (side == 0) ? lo_node - 1 : hi_node - cc[jdim];
+                        slab_hi[jdim] = (side == 0) ? lo_node : hi_node + 1 - cc[jdim];
+                    } else if (jdim < idim) {
+                        slab_lo[jdim] = m_lo_active[jdim] ? lo_node + 1 : full_lo;
+                        slab_hi[jdim] = m_hi_active[jdim] ? hi_node - 1 - cc[jdim] : full_hi;
+                    } else {
+                        slab_lo[jdim] = full_lo;
+                        slab_hi[jdim] = full_hi;
+                    }
+                }
+                slabs.push_back(Box(slab_lo, slab_hi, ixtype));
+            }
+        }
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+        for (MFIter mfi(*field[a], TilingIfNotGPU()); mfi.isValid(); ++mfi) {
+            Array4<Real> const& F = field[a]->array(mfi);
+            const Box& tbx = mfi.tilebox();
+            for (Box const& slab : slabs) {
+                const Box bx = tbx & slab;
+                if (!bx.ok()) continue;
+                ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) {
+                    const int p2[3] = {2*i + cc[0], 2*j + cc[1], 2*k + cc[2]};
+                    const bool in_self = p2[0] >= lo2[0] && p2[0] <= hi2[0]
+                                      && p2[1] >= lo2[1] && p2[1] <= hi2[1]
+                                      && p2[2] >= lo2[2] && p2[2] <= hi2[2];
+                    Real corr = 0._rt;
+                    for (int side = -1; side <= 1; side += 2) {
+                        int q2[3] = {p2[0], p2[1], p2[2]};
+                        q2[sdir] += side;
+                        const bool in_nb = q2[0] >= lo2[0] && q2[0] <= hi2[0]
+                                        && q2[1] >= lo2[1] && q2[1] <= hi2[1]
+                                        && q2[2] >= lo2[2] && q2[2] <= hi2[2];
+                        if (in_nb == in_self) continue;
+                        // incident field at the neighbor: E on the nodes, H half a cell further
+                        const int s2 = dir_sign * (q2[dir] - 2*origin);
+                        const int m = inc_is_E ? s2/2 : (s2-1)/2;
+                        if (s2 < 0 || m >= n_inc) continue;
+                        // the update used the neighbor in the other region: add (total point)
+                        // or remove (scattered point) its incident part
+                        corr += side * w * inc_sign * inc[m] * (in_self ? 1._rt : -1._rt);
+                    }
+                    F(i, j, k) += coef * corr;
+                });
+            }
+        }
+    }
+}
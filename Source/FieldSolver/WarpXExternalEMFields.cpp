@@ -1,13 +1,89 @@
 #include "WarpX.H"
 #include "BoundaryConditions/PML.H"
 #include "Evolve/WarpXDtType.H"
+#include "FieldSolver/FiniteDifferenceSolver/MacroscopicProperties/MacroscopicProperties.H"
+#include "FieldSolver/WaveguidePortMode.H"
+#include "Parallelization/CostsBreakdown.H"
+#include "Utils/TextMsg.H"
+#include "Utils/WarpXAlgorithmSelection.H"
 #include "Utils/WarpXConst.H"
 #include "Utils/WarpXUtil.H"
+#include <AMReX_GpuDevice.H>
+#include <AMReX_iMultiFab.H>
+#include <AMReX_LayoutData.H>
 #include <AMReX_MultiFab.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_ParmParse.H>
 #include <AMReX_Parser.H>
+#include <AMReX_Reduce.H>
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <utility>
 
 using namespace amrex;
 
+namespace {
+    /** compile the space-time parser of an excitation, which is not defined for a separable excitation */
+    ParserExecutor<4> compile_xt_parser (std::unique_ptr<amrex::Parser> const& xt_parser)
+    {
+        return xt_parser ? xt_parser->compile<4>() : ParserExecutor<4>{};
+    }
+
+    /** Uniform lattice of the flags of a component in an excitation flag file, and offset of
+     *  its flags in the file */
+    struct FlagLattice {
+        amrex::GpuArray<int, 3> n;
+        amrex::GpuArray<amrex::Real, 3> origin;
+        amrex::GpuArray<amrex::Real, 3> spacing;
+        amrex::Long offset = 0;
+    };
+
+    /** Read the lattices of the three components of an excitation flag file, written by
+     *  Tools/ExcitationFlagGenerator: the magic string WXFLAG01, then for each component the
+     *  numbers of points (3 int64), the origin and the spacing (3 float64 each), then the flags
+     *  of the three components (uint8, x fastest), in the byte order of the machine */
+    std::array<FlagLattice, 3> ReadFlagFileHeader (std::ifstream& ifs, std::string const& filename)
+    {
+        char magic[8];
+        ifs.read(magic, 8);
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(ifs.good() && std::string(magic, 8) == "WXFLAG01",
+            filename + " is not an excitation flag file");
+        std::array<FlagLattice, 3> lattice;
+        amrex::Long offset = 8 + 3 * (3 * sizeof(std::int64_t) + 6 * sizeof(double));
+        for (auto& lat : lattice) {
+            std::int64_t n[3];
+            double origin[3], spacing[3];
+            ifs.read(reinterpret_cast<char*>(n), sizeof(n));
+            ifs.read(reinterpret_cast<char*>(origin), sizeof(origin));
+            ifs.read(reinterpret_cast<char*>(spacing), sizeof(spacing));
+            WARPX_ALWAYS_ASSERT_WITH_MESSAGE(ifs.good(), "cannot read the header of " + filename);
+            for (int idim = 0; idim < 3; ++idim) {
+                WARPX_ALWAYS_ASSERT_WITH_MESSAGE(n[idim] > 0 && spacing[idim] > 0.,
+                    "invalid lattice in the excitation flag file " + filename);
+                lat.n[idim] = static_cast<int>(n[idim]);
+                lat.origin[idim] = static_cast<amrex::Real>(origin[idim]);
+                lat.spacing[idim] = static_cast<amrex::Real>(spacing[idim]);
+            }
+            lat.offset = offset;
+            offset += amrex::Long(lat.n[0]) * lat.n[1] * lat.n[2];
+        }
+        return lattice;
+    }
+
+    /** index of the closest point of the lattice along idim to the coordinate pos */
+    AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
+    int LatticeIndex (amrex::GpuArray<amrex::Real, 3> const& origin,
+                      amrex::GpuArray<amrex::Real, 3> const& spacing,
+                      int idim, amrex::Real pos)
+    {
+        return static_cast<int>(std::floor((pos - origin[idim]) / spacing[idim] + 0.5_rt));
+    }
+}
+
 /**
  * \brief externalfieldtype determines which field component the external excitation is applied on
  * externalfieldtype == ExternalFieldType::AllExternal : external field excitation applied to all three field components, E, B and H
@@ -17,21 +93,26 @@ using namespace amrex;
  */
 
 void
-WarpX::ApplyExternalFieldExcitationOnGrid (int const externalfieldtype, DtType a_dt_type)
+WarpX::ApplyExternalFieldExcitationOnGrid (int const externalfieldtype, DtType a_dt_type, int a_lev)
 {
-    for (int lev = 0; lev <= finest_level; ++lev) {
+    CostPhaseTimer cost_phase(CostPhase::Excitation);
+    MarkAllFieldsModified();
+    // a single level is excited with the multirate steps of the levels, see OneStep_mag_multirate
+    const int lev_min = (a_lev < 0) ? 0 : a_lev;
+    const int lev_max = (a_lev < 0) ? finest_level : a_lev;
+    for (int lev = lev_min; lev <= lev_max; ++lev) {
         if (externalfieldtype == ExternalFieldType::AllExternal || externalfieldtype == ExternalFieldType::EfieldExternal) {
             if (E_excitation_grid_s == "parse_e_excitation_grid_function") {
                 ApplyExternalFieldExcitationOnGrid(Efield_fp[lev][0].get(),
                                                    Efield_fp[lev][1].get(),
                                                    Efield_fp[lev][2].get(),
-                                                   Exfield_xt_grid_parser->compile<4>(),
-                                                   Eyfield_xt_grid_parser->compile<4>(),
-                                                   Ezfield_xt_grid_parser->compile<4>(),
+                                                   compile_xt_parser(Exfield_xt_grid_parser),
+                                                   compile_xt_parser(Eyfield_xt_grid_parser),
+                                                   compile_xt_parser(Ezfield_xt_grid_parser),
                                                    Exfield_flag_parser->compile<3>(),
                                                    Eyfield_flag_parser->compile<3>(),
                                                    Ezfield_flag_parser->compile<3>(),
-                                                   lev, a_dt_type );
+                                                   ExternalFieldType::EfieldExternal, lev, a_dt_type );
             }
         }
         // The excitation, especially when used to set an internal PEC, will be extended
@@ -42,13 +123,13 @@ WarpX::ApplyExternalFieldExcitationOnGrid (int const externalfieldtype, DtType a
                     ApplyExternalFieldExcitationOnGrid(pml[lev]->GetE_fp(0),
                                                        pml[lev]->GetE_fp(1),
                                                        pml[lev]->GetE_fp(2),
-                                                       Exfield_xt_grid_parser->compile<4>(),
-                                                       Eyfield_xt_grid_parser->compile<4>(),
-                                                       Ezfield_xt_grid_parser->compile<4>(),
+                                                       compile_xt_parser(Exfield_xt_grid_parser),
+                                                       compile_xt_parser(Eyfield_xt_grid_parser),
+                                                       compile_xt_parser(Ezfield_xt_grid_parser),
                                                        Exfield_flag_parser->compile<3>(),
                                                        Eyfield_flag_parser->compile<3>(),
                                                        Ezfield_flag_parser->compile<3>(),
-                                                       lev, a_dt_type );
+                                                       ExternalFieldType::EfieldExternalPML, lev, a_dt_type );
             }
         }
         if (externalfieldtype == ExternalFieldType::AllExternal || externalfieldtype == ExternalFieldType::BfieldExternal) {
@@ -56,13 +137,13 @@ WarpX::ApplyExternalFieldExcitationOnGrid (int const externalfieldtype, DtType a
                 ApplyExternalFieldExcitationOnGrid(Bfield_fp[lev][0].get(),
                                                    Bfield_fp[lev][1].get(),
                                                    Bfield_fp[lev][2].get(),
-                                                   Bxfield_xt_grid_parser->compile<4>(),
-                                                   Byfield_xt_grid_parser->compile<4>(),
-                                                   Bzfield_xt_grid_parser->compile<4>(),
+                                                   compile_xt_parser(Bxfield_xt_grid_parser),
+                                                   compile_xt_parser(Byfield_xt_grid_parser),
+                                                   compile_xt_parser(Bzfield_xt_grid_parser),
                                                    Bxfield_flag_parser->compile<3>(),
                                                    Byfield_flag_parser->compile<3>(),
                                                    Bzfield_flag_parser->compile<3>(),
-                                                   lev, a_dt_type );
+                                                   ExternalFieldType::BfieldExternal, lev, a_dt_type );
             }
         }
 #ifdef WARPX_MAG_LLG
@@ -71,13 +152,13 @@ WarpX::ApplyExternalFieldExcitationOnGrid (int const externalfieldtype, DtType a
             ApplyExternalFieldExcitationOnGrid(Hfield_fp[lev][0].get(),
                                                Hfield_fp[lev][1].get(),
                                                Hfield_fp[lev][2].get(),
-                                               Hxfield_xt_grid_parser->compile<4>(),
-                                               Hyfield_xt_grid_parser->compile<4>(),
-                                               Hzfield_xt_grid_parser->compile<4>(),
+                                               compile_xt_parser(Hxfield_xt_grid_parser),
+                                               compile_xt_parser(Hyfield_xt_grid_parser),
+                                               compile_xt_parser(Hzfield_xt_grid_parser),
                                                Hxfield_flag_parser->compile<3>(),
                                                Hyfield_flag_parser->compile<3>(),
                                                Hzfield_flag_parser->compile<3>(),
-                                               lev, a_dt_type );
+                                               ExternalFieldType::HfieldExternal, lev, a_dt_type );
             }
         }
         if (externalfieldtype == ExternalFieldType::AllExternal || externalfieldtype == ExternalFieldType::HbiasfieldExternal) {
@@ -85,19 +166,31 @@ WarpX::ApplyExternalFieldExcitationOnGrid (int const externalfieldtype, DtType a
             ApplyExternalFieldExcitationOnGrid(H_biasfield_fp[lev][0].get(),
                                                H_biasfield_fp[lev][1].get(),
                                                H_biasfield_fp[lev][2].get(),
-                                               Hx_biasfield_xt_grid_parser->compile<4>(),
-                                               Hy_biasfield_xt_grid_parser->compile<4>(),
-                                               Hz_biasfield_xt_grid_parser->compile<4>(),
+                                               compile_xt_parser(Hx_biasfield_xt_grid_parser),
+                                               compile_xt_parser(Hy_biasfield_xt_grid_parser),
+                                               compile_xt_parser(Hz_biasfield_xt_grid_parser),
                                                Hx_biasfield_flag_parser->compile<3>(),
                                                Hy_biasfield_flag_parser->compile<3>(),
                                                Hz_biasfield_flag_parser->compile<3>(),
-                                               lev, a_dt_type );
+                                               ExternalFieldType::HbiasfieldExternal, lev, a_dt_type );
             }
         }
 #endif
     } // for loop over level
 }
 
+#ifdef WARPX_MAG_LLG
+amrex::GpuArray<amrex::Real, 3>
+WarpX::getH_bias_uniform (int lev) const
+{
+    // the envelope is evaluated once, on the host, like that of a separable excitation
+    const amrex::Real envelope = H_bias_uniform_envelope_parser->compileHost<1>()(gett_new(lev));
+    return {H_bias_external_grid[0] * envelope,
+            H_bias_external_grid[1] * envelope,
+            H_bias_external_grid[2] * envelope};
+}
+#endif
+
 void
 WarpX::ApplyExternalFieldExcitationOnGrid (
        amrex::MultiFab *mfx, amrex::MultiFab *mfy, amrex::MultiFab *mfz,
@@ -106,7 +199,8 @@ WarpX::ApplyExternalFieldExcitationOnGrid (
        ParserExecutor<4> const& zfield_parser,
        ParserExecutor<3> const& xflag_parser,
        ParserExecutor<3> const& yflag_parser,
-       ParserExecutor<3> const& zflag_parser, const int lev, DtType a_dt_type )
+       ParserExecutor<3> const& zflag_parser, const int excitation_type,
+       const int lev, DtType a_dt_type )
 {
     // This function adds the contribution from an external excitation to the fields.
     // A flag is used to determine the type of excitation.
@@ -114,6 +208,28 @@ WarpX::ApplyExternalFieldExcitationOnGrid (
     // If flag == 2, if is a soft source and the field += excitation
     // If flag == 0, the excitation parser is not computed and the field is unchanged.
     // If flag is not 0, or 1, or 2, the code will Abort!
+    // The flags do not depend on time: they are evaluated once, and only the boxes
+    // that contain an excited cell are visited afterwards.
+    // For a separable excitation f(x,y,z) g(t), the profiles f are evaluated with the flags,
+    // and the excitation is g(t) times the stored profile.
+    const int source_type = (excitation_type == ExternalFieldType::EfieldExternalPML)
+                          ? static_cast<int>(ExternalFieldType::EfieldExternal) : excitation_type;
+    auto const sep_it = m_separable_excitation.find(source_type);
+    SeparableExcitation const* separable = (sep_it != m_separable_excitation.end()) ? &(sep_it->second) : nullptr;
+    // the waveguide mode of the port is computed once, on the materials of level 0
+    if (separable && separable->port_mode && !separable->port_mode->IsSolved()) {
+        amrex::MultiFab const* sigma = (em_solver_medium == MediumForEM::Macroscopic)
+            ? &(m_macroscopic_properties[0]->getsigma_mf()) : nullptr;
+        sep_it->second.port_mode->Solve(Geom(0), sigma);
+    }
+    auto const file_it = m_excitation_flag_file.find(source_type);
+    std::string const flag_file = (file_it != m_excitation_flag_file.end()) ? file_it->second : std::string{};
+    ExcitationFlags& flags = m_excitation_flags[std::make_pair(excitation_type, lev)];
+    if (!flags.flag[0] || flags.flag[0]->boxArray() != mfx->boxArray()
+        || flags.flag[0]->DistributionMap() != mfx->DistributionMap()) {
+        BuildExcitationFlags(flags, {mfx, mfy, mfz}, {&xflag_parser, &yflag_parser, &zflag_parser},
+                             flag_file, separable, lev);
+    }
 
     // Gpu vector to store Ex-Bz staggering (Hx-Hz for LLG)
     GpuArray<int,3> mfx_stag, mfy_stag, mfz_stag;
@@ -123,8 +239,10 @@ WarpX::ApplyExternalFieldExcitationOnGrid (
         mfz_stag[idim] = mfz->ixType()[idim];
     }
     amrex::Real t = gett_new(lev);
-    const auto problo = Geom(lev).ProbLoArray();
-    const auto dx = Geom(lev).CellSizeArray();
+    // the envelope of a separable excitation is evaluated once, on the host
+    const bool is_separable = (separable != nullptr);
+    const amrex::Real envelope = is_separable ? separable->envelope(t) : 0._rt;
+    const MeshCoordinates coords = GetMeshCoordinates(lev);
     amrex::IntVect x_nodal_flag = mfx->ixType().toIntVect();
     amrex::IntVect y_nodal_flag = mfy->ixType().toIntVect();
     amrex::IntVect z_nodal_flag = mfz->ixType().toIntVect();
@@ -140,15 +258,30 @@ WarpX::ApplyExternalFieldExcitationOnGrid (
     if (a_dt_type == DtType::FirstHalf or a_dt_type == DtType::SecondHalf ) {
         dt_type_flag = 1;
     }
+    // the boxes of the PML fields are not the boxes of the level, whose costs are updated
+    amrex::LayoutData<amrex::Real>* cost = (excitation_type == ExternalFieldType::EfieldExternalPML)
+                                         ? nullptr : WarpX::getCosts(lev);
 #ifdef AMREX_USE_OMP
 #pragma omp parallel if (Gpu::notInLaunchRegion())
 #endif
     for ( MFIter mfi(*mfx, TilingIfNotGPU()); mfi.isValid(); ++mfi)
     {
+        if (flags.box_is_excited[mfi.index()] == 0) continue;
+        CostBoxTimer cost_box(cost, mfi.index());
+
         // Extract field data for this grid/tile
         amrex::Array4<amrex::Real> const& Fx = mfx->array(mfi);
         amrex::Array4<amrex::Real> const& Fy = mfy->array(mfi);
         amrex::Array4<amrex::Real> const& Fz = mfz->array(mfi);
+        amrex::Array4<int const> const& flag_x = flags.flag[0]->const_array(mfi);
+        amrex::Array4<int const> const& flag_y = flags.flag[1]->const_array(mfi);
+        amrex::Array4<int const> const& flag_z = flags.flag[2]->const_array(mfi);
+        amrex::Array4<amrex::Real const> profile_x, profile_y, profile_z;
+        if (is_separable) {
+            profile_x = flags.profile[0]->const_array(mfi);
+            profile_y = flags.profile[1]->const_array(mfi);
+            profile_z = flags.profile[2]->const_array(mfi);
+        }
 
         const amrex::Box& tbx = mfi.tilebox( x_nodal_flag, mfx->nGrowVect() );
         const amrex::Box& tby = mfi.tilebox( y_nodal_flag, mfy->nGrowVect() );
@@ -157,65 +290,230 @@ WarpX::ApplyExternalFieldExcitationOnGrid (
         // Loop over the cells and update the fields
         amrex::ParallelFor(tbx, nComp_x,
             [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) {
-                amrex::Real x, y, z;
-                WarpXUtilAlgo::getCellCoordinates(i, j, k, mfx_stag,
-                                                  problo, dx, x, y, z);
-                auto flag_type = xflag_parser(x,y,z);
+                int const flag_type = flag_x(i, j, k);
+                if (flag_type == 0) return;
+                amrex::Real excitation;
+                if (is_separable) {
+                    excitation = envelope * profile_x(i, j, k);
+                } else {
+                    amrex::Real x, y, z;
+                    WarpXUtilAlgo::getCellCoordinates(i, j, k, mfx_stag,
+                                                      coords, x, y, z);
+                    excitation = xfield_parser(x,y,z,t);
+                }
                 amrex::Real dt_type_factor = 1._rt;
                 // For soft source and FirstHalf/SecondHalf evolve
                 // the excitation is split with a prefector of 0.5
-                if (flag_type == 2._rt and dt_type_flag == 1) {
+                if (flag_type == 2 and dt_type_flag == 1) {
                     dt_type_factor = 0.5_rt;
                 }
-                if (flag_type != 0._rt && flag_type != 1._rt && flag_type != 2._rt) {
-                    amrex::Abort("flag type for excitation must be 0, or 1, or 2!");
-                } else if ( flag_type > 0._rt ) {
-                    Fx(i, j, k, n) = Fx(i,j,k,n)*(flag_type-1.0_rt)
-                                   + dt_type_factor * xfield_parser(x,y,z,t);
-                }
+                Fx(i, j, k, n) = Fx(i,j,k,n)*(flag_type-1.0_rt)
+                               + dt_type_factor * excitation;
             },
             tby, nComp_y,
             [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) {
-                amrex::Real x, y, z;
-                WarpXUtilAlgo::getCellCoordinates(i, j, k, mfy_stag,
-                                                  problo, dx, x, y, z);
-                auto flag_type = yflag_parser(x,y,z);
+                int const flag_type = flag_y(i, j, k);
+                if (flag_type == 0) return;
+                amrex::Real excitation;
+                if (is_separable) {
+                    excitation = envelope * profile_y(i, j, k);
+                } else {
+                    amrex::Real x, y, z;
+                    WarpXUtilAlgo::getCellCoordinates(i, j, k, mfy_stag,
+                                                      coords, x, y, z);
+                    excitation = yfield_parser(x,y,z,t);
+                }
                 amrex::Real dt_type_factor = 1._rt;
                 // For soft source and FirstHalf/SecondHalf evolve
                 // the excitation is split with a prefector of 0.5
-                if (flag_type == 2._rt and dt_type_flag == 1) {
+                if (flag_type == 2 and dt_type_flag == 1) {
                     dt_type_factor = 0.5_rt;
                 }
-                if (flag_type != 0._rt && flag_type != 1._rt && flag_type != 2._rt) {
-                    amrex::Abort("flag type for excitation must be 0, or 1, or 2!");
-                } else if ( flag_type > 0._rt ) {
-                    Fy(i, j, k, n) = Fy(i,j,k,n)*(flag_type-1.0_rt)
-                                   + dt_type_factor * yfield_parser(x,y,z,t);
-                }
+                Fy(i, j, k, n) = Fy(i,j,k,n)*(flag_type-1.0_rt)
+                               + dt_type_factor * excitation;
             },
             tbz, nComp_z,
             [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) {
-                amrex::Real x, y, z;
-                WarpXUtilAlgo::getCellCoordinates(i, j, k, mfz_stag,
-                                                  problo, dx, x, y, z);
-                auto flag_type = zflag_parser(x,y,z);
+                int const flag_type = flag_z(i, j, k);
+                if (flag_type == 0) return;
+                amrex::Real excitation;
+                if (is_separable) {
+                    excitation = envelope * profile_z(i, j, k);
+                } else {
+                    amrex::Real x, y, z;
+                    WarpXUtilAlgo::getCellCoordinates(i, j, k, mfz_stag,
+                                                      coords, x, y, z);
+                    excitation = zfield_parser(x,y,z,t);
+                }
                 amrex::Real dt_type_factor = 1._rt;
                 // For soft source and FirstHalf/SecondHalf evolve
                 // the excitation is split with a prefector of 0.5
-                if (flag_type == 2._rt and dt_type_flag == 1) {
+                if (flag_type == 2 and dt_type_flag == 1) {
                     dt_type_factor = 0.5_rt;
                 }
-                if (flag_type != 0._rt && flag_type != 1._rt && flag_type != 2._rt) {
-                    amrex::Abort("flag type for excitation must be 0, or 1, or 2!");
-                } else if ( flag_type > 0._rt ) {
-                    Fz(i, j, k,n) = Fz(i,j,k,n)*(flag_type-1.0_rt)
-                                  + dt_type_factor * zfield_parser(x,y,z,t);
-                }
+                Fz(i, j, k,n) = Fz(i,j,k,n)*(flag_type-1.0_rt)
+                              + dt_type_factor * excitation;
             }
         );
     }
 }
 
+void
+WarpX::BuildExcitationFlags (ExcitationFlags& flags,
+                             std::array<amrex::MultiFab const*, 3> const& mf,
+                             std::array<ParserExecutor<3> const*, 3> const& flag_parser,
+                             std::string const& flag_file,
+                             SeparableExcitation const* separable,
+                             const int lev)
+{
+    const MeshCoordinates coords = GetMeshCoordinates(lev);
+    flags.box_is_excited.assign(mf[0]->size(), 0);
+    int invalid_flag = 0;
+
+    // the flags of a file are read by each rank on the lattice points of its boxes only
+    const bool from_file = !flag_file.empty();
+    std::ifstream flag_ifs;
+    std::array<FlagLattice, 3> flag_lattice;
+    if (from_file) {
+        flag_ifs.open(flag_file, std::ios::binary);
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(flag_ifs.is_open(),
+            "cannot open the excitation flag file " + flag_file);
+        flag_lattice = ReadFlagFileHeader(flag_ifs, flag_file);
+    }
+
+    for (int icomp = 0; icomp < 3; ++icomp) {
+        flags.flag[icomp] = std::make_unique<amrex::iMultiFab>(mf[icomp]->boxArray(),
+            mf[icomp]->DistributionMap(), 1, mf[icomp]->nGrowVect());
+        GpuArray<int,3> mf_stag;
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+            mf_stag[idim] = mf[icomp]->ixType()[idim];
+        }
+        ParserExecutor<3> const flag_fn = *flag_parser[icomp];
+        const bool has_profile = (separable != nullptr);
+        const bool has_port_mode = has_profile && separable->port_mode;
+        ParserExecutor<3> profile_fn;
+        PortModeProfile port_mode_profile;
+        if (has_profile) {
+            flags.profile[icomp] = std::make_unique<amrex::MultiFab>(mf[icomp]->boxArray(),
+                mf[icomp]->DistributionMap(), 1, mf[icomp]->nGrowVect());
+            if (has_port_mode) {
+                port_mode_profile = separable->port_mode->GetProfile(separable->magnetic);
+            } else {
+                profile_fn = separable->profile_parser[icomp]->compile<3>();
+            }
+        } else {
+            flags.profile[icomp].reset();
+        }
+
+        for ( MFIter mfi(*flags.flag[icomp]); mfi.isValid(); ++mfi) {
+            // the excitation is also applied in the guard cells
+            const amrex::Box& bx = mfi.fabbox();
+            amrex::Array4<int> const& flag_arr = flags.flag[icomp]->array(mfi);
+            amrex::Array4<amrex::Real> profile_arr;
+            if (has_profile) profile_arr = flags.profile[icomp]->array(mfi);
+
+            // flags of the lattice points closest to the points of the box, read from the file
+            amrex::GpuArray<amrex::Real, 3> lat_origin{}, lat_spacing{};
+            amrex::GpuArray<int, 3> lat_lo{}, lat_n{};
+            amrex::Gpu::DeviceVector<unsigned char> file_flags;
+            unsigned char const* file_flags_ptr = nullptr;
+            if (from_file) {
+                FlagLattice const& lat = flag_lattice[icomp];
+                lat_origin = lat.origin;
+                lat_spacing = lat.spacing;
+                amrex::ReduceOps<amrex::ReduceOpMin, amrex::ReduceOpMin, amrex::ReduceOpMin,
+                                 amrex::ReduceOpMax, amrex::ReduceOpMax, amrex::ReduceOpMax> range_op;
+                amrex::ReduceData<int, int, int, int, int, int> range_data(range_op);
+                using RangeTuple = typename decltype(range_data)::Type;
+                range_op.eval(bx, range_data,
+                    [=] AMREX_GPU_DEVICE (int i, int j, int k) -> RangeTuple {
+                        amrex::Real x, y, z;
+                        WarpXUtilAlgo::getCellCoordinates(i, j, k, mf_stag,
+                                                          coords, x, y, z);
+                        const int li = LatticeIndex(lat_origin, lat_spacing, 0, x);
+                        const int lj = LatticeIndex(lat_origin, lat_spacing, 1, y);
+                        const int lk = LatticeIndex(lat_origin, lat_spacing, 2, z);
+                        return {li, lj, lk, li, lj, lk};
+                });
+                auto const range = range_data.value();
+                const int lo[3] = {std::max(amrex::get<0>(range), 0),
+                                   std::max(amrex::get<1>(range), 0),
+                                   std::max(amrex::get<2>(range), 0)};
+                const int hi[3] = {std::min(amrex::get<3>(range), lat.n[0] - 1),
+                                   std::min(amrex::get<4>(range), lat.n[1] - 1),
+                                   std::min(amrex::get<5>(range), lat.n[2] - 1)};
+                if (lo[0] <= hi[0] && lo[1] <= hi[1] && lo[2] <= hi[2]) {
+                    for (int idim = 0; idim < 3; ++idim) {
+                        lat_lo[idim] = lo[idim];
+                        lat_n[idim] = hi[idim] - lo[idim] + 1;
+                    }
+                    // one contiguous row of flags along x per (j, k)
+                    amrex::Vector<unsigned char> host_flags(
+                        static_cast<std::size_t>(lat_n[0]) * lat_n[1] * lat_n[2]);
+                    for (int k = lo[2]; k <= hi[2]; ++k) {
+                        for (int j = lo[1]; j <= hi[1]; ++j) {
+                            flag_ifs.seekg(lat.offset
+                                + (amrex::Long(k) * lat.n[1] + j) * lat.n[0] + lo[0]);
+                            flag_ifs.read(reinterpret_cast<char*>(host_flags.data()
+                                + (static_cast<std::size_t>(k - lo[2]) * lat_n[1] + (j - lo[1])) * lat_n[0]),
+                                lat_n[0]);
+                        }
+                    }
+                    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(flag_ifs.good(),
+                        "cannot read the flags of the excitation flag file " + flag_file);
+                    file_flags.resize(host_flags.size());
+                    amrex::Gpu::copyAsync(amrex::Gpu::hostToDevice, host_flags.begin(), host_flags.end(),
+                                          file_flags.begin());
+                    amrex::Gpu::streamSynchronize();
+                    file_flags_ptr = file_flags.data();
+                }
+            }
+
+            // store the flag (and the profile) of each cell, and reduce whether the box is excited
+            // and has invalid flags
+            amrex::ReduceOps<amrex::ReduceOpMax, amrex::ReduceOpMax> reduce_op;
+            amrex::ReduceData<int, int> reduce_data(reduce_op);
+            using ReduceTuple = typename decltype(reduce_data)::Type;
+            reduce_op.eval(bx, reduce_data,
+                [=] AMREX_GPU_DEVICE (int i, int j, int k) -> ReduceTuple {
+                    amrex::Real x, y, z;
+                    WarpXUtilAlgo::getCellCoordinates(i, j, k, mf_stag,
+                                                      coords, x, y, z);
+                    amrex::Real flag_type = 0._rt;
+                    if (!from_file) {
+                        flag_type = flag_fn(x,y,z);
+                    } else if (file_flags_ptr) {
+                        const int li = LatticeIndex(lat_origin, lat_spacing, 0, x) - lat_lo[0];
+                        const int lj = LatticeIndex(lat_origin, lat_spacing, 1, y) - lat_lo[1];
+                        const int lk = LatticeIndex(lat_origin, lat_spacing, 2, z) - lat_lo[2];
+                        if (li >= 0 && li < lat_n[0] && lj >= 0 && lj < lat_n[1]
+                            && lk >= 0 && lk < lat_n[2]) {
+                            flag_type = file_flags_ptr[(lk * lat_n[1] + lj) * lat_n[0] + li];
+                        }
+                    }
+                    if (has_profile) {
+                        profile_arr(i, j, k) = (flag_type <= 0._rt) ? 0._rt
+                            : (has_port_mode ? port_mode_profile(x,y,z,icomp) : profile_fn(x,y,z));
+                    }
+                    if (flag_type != 0._rt && flag_type != 1._rt && flag_type != 2._rt) {
+                        flag_arr(i, j, k) = 0;
+                        return {0, 1};
+                    }
+                    flag_arr(i, j, k) = static_cast<int>(flag_type);
+                    return {flag_type > 0._rt ? 1 : 0, 0};
+            });
+            auto const hv = reduce_data.value();
+            if (amrex::get<0>(hv) > 0) flags.box_is_excited[mfi.index()] = 1;
+            invalid_flag = std::max(invalid_flag, amrex::get<1>(hv));
+        }
+    }
+
+    amrex::ParallelDescriptor::ReduceIntMax(invalid_flag);
+    if (invalid_flag) {
+        amrex::Abort(Utils::TextMsg::Err("flag type for excitation must be 0, or 1, or 2!"));
+    }
+}
+
 void
 WarpX::ReadExcitationParser ()
 {
@@ -230,7 +528,7 @@ WarpX::ReadExcitationParser ()
                ::tolower);
 
 #ifdef WARPX_MAG_LLG
-    if (pp_warpx.query("B_excitation_on_grid_style", B_excitation_grid_s)) {
+    if (mag_LLG && pp_warpx.query("B_excitation_on_grid_style", B_excitation_grid_s)) {
         amrex::Abort("ERROR: Excitation of B field is not allowed in the LLG simulation! \nThe excited magnetic field must be H field! \n");
     }
 #endif
@@ -242,16 +540,35 @@ WarpX::ReadExcitationParser ()
                    ::tolower);
 
 #ifdef WARPX_MAG_LLG
-    pp_warpx.query("H_excitation_on_grid_style", H_excitation_grid_s);
-    std::transform(H_excitation_grid_s.begin(),
-                   H_excitation_grid_s.end(),
-                   H_excitation_grid_s.begin(),
-                   ::tolower);
-    pp_warpx.query("H_bias_excitation_on_grid_style", H_bias_excitation_grid_s);
-    std::transform(H_bias_excitation_grid_s.begin(),
-                   H_bias_excitation_grid_s.end(),
-                   H_bias_excitation_grid_s.begin(),
-                   ::tolower);
+    if (mag_LLG) {
+        pp_warpx.query("H_excitation_on_grid_style", H_excitation_grid_s);
+        std::transform(H_excitation_grid_s.begin(),
+                       H_excitation_grid_s.end(),
+                       H_excitation_grid_s.begin(),
+                       ::tolower);
+        pp_warpx.query("H_bias_excitation_on_grid_style", H_bias_excitation_grid_s);
+        std::transform(H_bias_excitation_grid_s.begin(),
+                       H_bias_excitation_grid_s.end(),
+                       H_bias_excitation_grid_s.begin(),
+                       ::tolower);
+    }
+#endif
+
+    // separable excitations f(x,y,z) g(t)
+    if (E_excitation_grid_s == "parse_e_excitation_grid_function") {
+        ReadSeparableExcitation(pp_warpx, "E", {"Ex", "Ey", "Ez"}, ExternalFieldType::EfieldExternal);
+    }
+    if (B_excitation_grid_s == "parse_b_excitation_grid_function") {
+        ReadSeparableExcitation(pp_warpx, "B", {"Bx", "By", "Bz"}, ExternalFieldType::BfieldExternal);
+    }
+#ifdef WARPX_MAG_LLG
+    if (H_excitation_grid_s == "parse_h_excitation_grid_function") {
+        ReadSeparableExcitation(pp_warpx, "H", {"Hx", "Hy", "Hz"}, ExternalFieldType::HfieldExternal);
+    }
+    if (H_bias_excitation_grid_s == "parse_h_bias_excitation_grid_function") {
+        ReadSeparableExcitation(pp_warpx, "H_bias", {"Hx_bias", "Hy_bias", "Hz_bias"},
+                                ExternalFieldType::HbiasfieldExternal);
+    }
 #endif
 
     if (E_excitation_grid_s == "parse_e_excitation_grid_function") {
@@ -259,12 +576,19 @@ WarpX::ReadExcitationParser ()
         // source type (hard=1, soft=2) must be specified for all components
         // using the flag function. Note that a flag value of 0 will not update
         // the field with the excitation.
-        Store_parserString(pp_warpx, "Ex_excitation_flag_function(x,y,z)",
-                                str_Ex_excitation_flag_function);
-        Store_parserString(pp_warpx, "Ey_excitation_flag_function(x,y,z)",
-                                str_Ey_excitation_flag_function);
-        Store_parserString(pp_warpx, "Ez_excitation_flag_function(x,y,z)",
-                                str_Ez_excitation_flag_function);
+        if (ReadExcitationFlagFile(pp_warpx, "E", ExternalFieldType::EfieldExternal)) {
+            // the flags are read from the file, and the flag functions are not used
+            str_Ex_excitation_flag_function = "0";
+            str_Ey_excitation_flag_function = "0";
+            str_Ez_excitation_flag_function = "0";
+        } else {
+            Store_parserString(pp_warpx, "Ex_excitation_flag_function(x,y,z)",
+                                    str_Ex_excitation_flag_function);
+            Store_parserString(pp_warpx, "Ey_excitation_flag_function(x,y,z)",
+                                    str_Ey_excitation_flag_function);
+            Store_parserString(pp_warpx, "Ez_excitation_flag_function(x,y,z)",
+                                    str_Ez_excitation_flag_function);
+        }
         Exfield_flag_parser = std::make_unique<amrex::Parser>(
                    makeParser(str_Ex_excitation_flag_function,{"x","y","z"}));
         Eyfield_flag_parser = std::make_unique<amrex::Parser>(
@@ -279,12 +603,19 @@ WarpX::ReadExcitationParser ()
         // source type (hard=1, soft=2) must be specified for all components
         // using the flag function. Note that a flag value of 0 will not update
         // the field with the excitation.
-        Store_parserString(pp_warpx, "Bx_excitation_flag_function(x,y,z)",
-                                str_Bx_excitation_flag_function);
-        Store_parserString(pp_warpx, "By_excitation_flag_function(x,y,z)",
-                                str_By_excitation_flag_function);
-        Store_parserString(pp_warpx, "Bz_excitation_flag_function(x,y,z)",
-                                str_Bz_excitation_flag_function);
+        if (ReadExcitationFlagFile(pp_warpx, "B", ExternalFieldType::BfieldExternal)) {
+            // the flags are read from the file, and the flag functions are not used
+            str_Bx_excitation_flag_function = "0";
+            str_By_excitation_flag_function = "0";
+            str_Bz_excitation_flag_function = "0";
+        } else {
+            Store_parserString(pp_warpx, "Bx_excitation_flag_function(x,y,z)",
+                                    str_Bx_excitation_flag_function);
+            Store_parserString(pp_warpx, "By_excitation_flag_function(x,y,z)",
+                                    str_By_excitation_flag_function);
+            Store_parserString(pp_warpx, "Bz_excitation_flag_function(x,y,z)",
+                                    str_Bz_excitation_flag_function);
+        }
         Bxfield_flag_parser = std::make_unique<amrex::Parser>(
                    makeParser(str_Bx_excitation_flag_function,{"x","y","z"}));
         Byfield_flag_parser = std::make_unique<amrex::Parser>(
@@ -300,12 +631,19 @@ WarpX::ReadExcitationParser ()
         // source type (hard=1, soft=2) must be specified for all components
         // using the flag function. Note that a flag value of 0 will not update
         // the field with the excitation.
-        Store_parserString(pp_warpx, "Hx_excitation_flag_function(x,y,z)",
-                                str_Hx_excitation_flag_function);
-        Store_parserString(pp_warpx, "Hy_excitation_flag_function(x,y,z)",
-                                str_Hy_excitation_flag_function);
-        Store_parserString(pp_warpx, "Hz_excitation_flag_function(x,y,z)",
-                                str_Hz_excitation_flag_function);
+        if (ReadExcitationFlagFile(pp_warpx, "H", ExternalFieldType::HfieldExternal)) {
+            // the flags are read from the file, and the flag functions are not used
+            str_Hx_excitation_flag_function = "0";
+            str_Hy_excitation_flag_function = "0";
+            str_Hz_excitation_flag_function = "0";
+        } else {
+            Store_parserString(pp_warpx, "Hx_excitation_flag_function(x,y,z)",
+                                    str_Hx_excitation_flag_function);
+            Store_parserString(pp_warpx, "Hy_excitation_flag_function(x,y,z)",
+                                    str_Hy_excitation_flag_function);
+            Store_parserString(pp_warpx, "Hz_excitation_flag_function(x,y,z)",
+                                    str_Hz_excitation_flag_function);
+        }
         Hxfield_flag_parser = std::make_unique<amrex::Parser>(
                    makeParser(str_Hx_excitation_flag_function,{"x","y","z"}));
         Hyfield_flag_parser = std::make_unique<amrex::Parser>(
@@ -318,12 +656,19 @@ WarpX::ReadExcitationParser ()
         // source type (hard=1, soft=2) must be specified for all components
         // using the flag function. Note that a flag value of 0 will not update
         // the field with the excitation.
-        Store_parserString(pp_warpx, "Hx_bias_excitation_flag_function(x,y,z)",
-                                str_Hx_bias_excitation_flag_function);
-        Store_parserString(pp_warpx, "Hy_bias_excitation_flag_function(x,y,z)",
-                                str_Hy_bias_excitation_flag_function);
-        Store_parserString(pp_warpx, "Hz_bias_excitation_flag_function(x,y,z)",
-                                str_Hz_bias_excitation_flag_function);
+        if (ReadExcitationFlagFile(pp_warpx, "H_bias", ExternalFieldType::HbiasfieldExternal)) {
+            // the flags are read from the file, and the flag functions are not used
+            str_Hx_bias_excitation_flag_function = "0";
+            str_Hy_bias_excitation_flag_function = "0";
+            str_Hz_bias_excitation_flag_function = "0";
+        } else {
+            Store_parserString(pp_warpx, "Hx_bias_excitation_flag_function(x,y,z)",
+                                    str_Hx_bias_excitation_flag_function);
+            Store_parserString(pp_warpx, "Hy_bias_excitation_flag_function(x,y,z)",
+                                    str_Hy_bias_excitation_flag_function);
+            Store_parserString(pp_warpx, "Hz_bias_excitation_flag_function(x,y,z)",
+                                    str_Hz_bias_excitation_flag_function);
+        }
         Hx_biasfield_flag_parser = std::make_unique<amrex::Parser>(
                    makeParser(str_Hx_bias_excitation_flag_function,{"x","y","z"}));
         Hy_biasfield_flag_parser = std::make_unique<amrex::Parser>(
@@ -333,8 +678,9 @@ WarpX::ReadExcitationParser ()
     }
 #endif
 
-    // make parser for the external B-excitation in space-time
-    if (B_excitation_grid_s == "parse_b_excitation_grid_function") {
+    // make parser for the external B-excitation in space-time, unless the excitation is separable
+    if (B_excitation_grid_s == "parse_b_excitation_grid_function"
+        && m_separable_excitation.count(ExternalFieldType::BfieldExternal) == 0) {
 #ifdef WARPX_DIM_RZ
        amrex::Abort("E and B parser for external fields does not work with RZ -- TO DO");
 #endif
@@ -352,8 +698,9 @@ WarpX::ReadExcitationParser ()
                    makeParser(str_Bz_excitation_grid_function,{"x","y","z","t"}));
     }
 
-    // make parser for the external E-excitation in space-time
-    if (E_excitation_grid_s == "parse_e_excitation_grid_function") {
+    // make parser for the external E-excitation in space-time, unless the excitation is separable
+    if (E_excitation_grid_s == "parse_e_excitation_grid_function"
+        && m_separable_excitation.count(ExternalFieldType::EfieldExternal) == 0) {
 #ifdef WARPX_DIM_RZ
        amrex::Abort("E and B parser for external fields does not work with RZ -- TO DO");
 #endif
@@ -372,8 +719,9 @@ WarpX::ReadExcitationParser ()
     }
 
 #ifdef WARPX_MAG_LLG
-    // make parser for the external H-excitation in space-time
-    if (H_excitation_grid_s == "parse_h_excitation_grid_function") {
+    // make parser for the external H-excitation in space-time, unless the excitation is separable
+    if (H_excitation_grid_s == "parse_h_excitation_grid_function"
+        && m_separable_excitation.count(ExternalFieldType::HfieldExternal) == 0) {
 #ifdef WARPX_DIM_RZ
        amrex::Abort("H parser for external fields does not work with RZ -- TO DO");
 #endif
@@ -390,8 +738,9 @@ WarpX::ReadExcitationParser ()
        Hzfield_xt_grid_parser = std::make_unique<amrex::Parser>(
                    makeParser(str_Hz_excitation_grid_function,{"x","y","z","t"}));
     }
-    // make parser for the external H-biasexcitation in space-time
-    if (H_bias_excitation_grid_s == "parse_h_bias_excitation_grid_function") {
+    // make parser for the external H-biasexcitation in space-time, unless the excitation is separable
+    if (H_bias_excitation_grid_s == "parse_h_bias_excitation_grid_function"
+        && m_separable_excitation.count(ExternalFieldType::HbiasfieldExternal) == 0) {
 #ifdef WARPX_DIM_RZ
        amrex::Abort("H parser for external fields does not work with RZ -- TO DO");
 #endif
@@ -410,3 +759,82 @@ WarpX::ReadExcitationParser ()
     }
 #endif
 }
+
+bool
+WarpX::ReadExcitationFlagFile (amrex::ParmParse const& pp_warpx, std::string const& field,
+                               const int excitation_type)
+{
+    std::string flag_file;
+    pp_warpx.query((field + "_excitation_flag_file").c_str(), flag_file);
+    if (flag_file.empty()) return false;
+    m_excitation_flag_file[excitation_type] = flag_file;
+    return true;
+}
+
+void
+WarpX::ReadSeparableExcitation (amrex::ParmParse const& pp_warpx, std::string const& field,
+                                std::array<std::string, 3> const& components, const int excitation_type)
+{
+    int separable = 0;
+    pp_warpx.query((field + "_excitation_separable").c_str(), separable);
+    if (separable == 0) return;
+
+    SeparableExcitation& excitation = m_separable_excitation[excitation_type];
+    // spatial profiles f of the three components, or the transverse profile of a waveguide mode
+    int port_mode = 0;
+    pp_warpx.query((field + "_excitation_port_mode").c_str(), port_mode);
+    if (port_mode) {
+        excitation.port_mode = std::make_unique<WaveguidePortMode>();
+        excitation.magnetic = (field != "E");
+    }
+    for (int icomp = 0; icomp < 3 && !port_mode; ++icomp) {
+        std::string str_profile_function;
+        Store_parserString(pp_warpx, (components[icomp] + "_excitation_profile_function(x,y,z)"),
+                           str_profile_function);
+        excitation.profile_parser[icomp] = std::make_unique<amrex::Parser>(
+                   makeParser(str_profile_function,{"x","y","z"}));
+    }
+
+    // temporal envelope g, given by a function or tabulated in a file
+    std::string envelope_file;
+    pp_warpx.query((field + "_excitation_envelope_file").c_str(), envelope_file);
+    if (envelope_file.empty()) {
+        std::string str_envelope_function;
+        Store_parserString(pp_warpx, (field + "_excitation_envelope_function(t)"),
+                           str_envelope_function);
+        excitation.envelope_parser = std::make_unique<amrex::Parser>(
+                   makeParser(str_envelope_function,{"t"}));
+    } else {
+        // two columns, t and g(t), with increasing t; the lines starting with # are ignored
+        amrex::Vector<char> file_data;
+        amrex::ParallelDescriptor::ReadAndBcastFile(envelope_file, file_data);
+        std::istringstream is(file_data.dataPtr());
+        std::string line;
+        while (std::getline(is, line)) {
+            if (line.empty() || line[0] == '#') continue;
+            std::istringstream ls(line);
+            amrex::Real t, g;
+            if (!(ls >> t >> g)) continue;
+            WARPX_ALWAYS_ASSERT_WITH_MESSAGE(excitation.envelope_t.empty() || t > excitation.envelope_t.back(),
+                "the times of " + envelope_file + " must be increasing");
+            excitation.envelope_t.push_back(t);
+            excitation.envelope_g.push_back(g);
+        }
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(!excitation.envelope_t.empty(),
+            envelope_file + " does not contain any envelope value");
+    }
+}
+
+amrex::Real
+WarpX::SeparableExcitation::envelope (amrex::Real t) const
+{
+    if (envelope_parser) return envelope_parser->compileHost<1>()(t);
+
+    // linear interpolation in the table, and constant beyond its ends
+    if (t <= envelope_t.front()) return envelope_g.front();
+    if (t >= envelope_t.back()) return envelope_g.back();
+    const auto i1 = std::upper_bound(envelope_t.begin(), envelope_t.end(), t) - envelope_t.begin();
+    const auto i0 = i1 - 1;
+    const amrex::Real w = (t - envelope_t[i0]) / (envelope_t[i1] - envelope_t[i0]);
+    return (1._rt - w) * envelope_g[i0] + w * envelope_g[i1];
+}
@@ -11,6 +11,8 @@
 #include "BoundaryConditions/PML.H"
 #include "Evolve/WarpXDtType.H"
 #include "FieldSolver/FiniteDifferenceSolver/FiniteDifferenceSolver.H"
+#include "FieldSolver/LumpedElements.H"
+#include "FieldSolver/MagThinFilm.H"
 #if defined(WARPX_USE_PSATD)
 #   include "FieldSolver/SpectralSolver/SpectralFieldData.H"
 #   ifdef WARPX_DIM_RZ
@@ -20,6 +22,10 @@
 #       include "FieldSolver/SpectralSolver/SpectralSolver.H"
 #   endif
 #endif
+#include "Parallelization/CostsBreakdown.H"
+#include "Parallelization/KernelGraph.H"
+#include "Parallelization/OmpTasks.H"
+#include "Parallelization/WarpXCommUtil.H"
 #include "Utils/TextMsg.H"
 #include "Utils/WarpXAlgorithmSelection.H"
 #include "Utils/WarpXConst.H"
@@ -38,21 +44,93 @@
 #include <AMReX_FArrayBox.H>
 #include <AMReX_FabArray.H>
 #include <AMReX_Geometry.H>
+#include <AMReX_GpuDevice.H>
 #include <AMReX_GpuLaunch.H>
 #include <AMReX_GpuQualifiers.H>
 #include <AMReX_IndexType.H>
+#include <AMReX_LayoutData.H>
 #include <AMReX_MFIter.H>
 #include <AMReX_Math.H>
 #include <AMReX_MultiFab.H>
 #include <AMReX_REAL.H>
+#include <AMReX_Utility.H>
 #include <AMReX_Vector.H>
 
+#include <algorithm>
 #include <array>
 #include <cmath>
 #include <memory>
 
 using namespace amrex;
 
+namespace {
+
+    /** Run the update of the fine-patch PML fields update_pml and, when the costs are updated
+     *  with the Timers algorithm, add the time it took to the costs of the level */
+    template <typename F>
+    void TimePMLUpdate (int lev, PML const& pml, F&& update_pml)
+    {
+        amrex::LayoutData<amrex::Real>* cost = WarpX::getCosts(lev);
+        const bool do_timing = cost
+            && WarpX::load_balance_costs_update_algo == LoadBalanceCostsUpdateAlgo::Timers;
+        if (do_timing) amrex::Gpu::synchronize();
+        amrex::Real wt = amrex::second();
+
+        update_pml();
+
+        if (do_timing) {
+            amrex::Gpu::synchronize();
+            wt = amrex::second() - wt;
+            pml.AddCosts(*cost, wt);
+        }
+    }
+
+    /** Number of cells of the local boxes of mf */
+    amrex::Real LocalNumPts (amrex::MultiFab const& mf)
+    {
+        amrex::Real npts = 0._rt;
+        for (int ibox : mf.IndexArray()) {
+            npts += static_cast<amrex::Real>(mf.boxArray()[ibox].numPts());
+        }
+        return npts;
+    }
+
+    /** Run the update of the fields in the regular cells update_interior, then the update of
+     *  the fine-patch PML fields update_pml timed as in TimePMLUpdate. With overlap
+     *  (warpx.omp_overlap_tasks), the PML update runs in an OpenMP task concurrently with the
+     *  update of the regular cells, with a share of the threads proportional to the cells of
+     *  pml_field among those of pml_field and grid_field */
+    template <typename F, typename G>
+    void UpdateInteriorAndPML (int lev, PML const& pml, bool overlap,
+                               amrex::MultiFab const& grid_field, amrex::MultiFab const& pml_field,
+                               F&& update_interior, G&& update_pml)
+    {
+        if (!overlap) {
+            update_interior();
+            TimePMLUpdate(lev, pml, update_pml);
+            return;
+        }
+
+        const amrex::Real pml_npts = LocalNumPts(pml_field);
+        const amrex::Real total_npts = pml_npts + LocalNumPts(grid_field);
+        const amrex::Real pml_fraction = (total_npts > 0._rt) ? pml_npts / total_npts : 0._rt;
+
+        // the costs of the PML are added once the task is finished, since the costs of the
+        // boxes are also updated by the update of the regular cells
+        amrex::Real wt_pml = 0._rt;
+        OmpTasks::RunConcurrently(update_interior, [&] () {
+            const amrex::Real wt = amrex::second();
+            update_pml();
+            wt_pml = amrex::second() - wt;
+        }, pml_fraction);
+
+        amrex::LayoutData<amrex::Real>* cost = WarpX::getCosts(lev);
+        if (cost && WarpX::load_balance_costs_update_algo == LoadBalanceCostsUpdateAlgo::Timers) {
+            pml.AddCosts(*cost, wt_pml);
+        }
+    }
+}
+
 #ifdef WARPX_USE_PSATD
 namespace {
 
@@ -70,9 +148,7 @@ namespace {
         solver.ForwardTransform(lev, *vector_field[0], compx, *vector_field[1], compy);
         solver.ForwardTransform(lev, *vector_field[2], compz);
 #else
-        solver.ForwardTransform(lev, *vector_field[0], compx);
-        solver.ForwardTransform(lev, *vector_field[1], compy);
-        solver.ForwardTransform(lev, *vector_field[2], compz);
+        solver.ForwardTransform(lev, vector_field, {compx, compy, compz});
 #endif
     }
 
@@ -88,11 +164,10 @@ namespace {
     {
 #ifdef WARPX_DIM_RZ
         solver.BackwardTransform(lev, *vector_field[0], compx, *vector_field[1], compy);
+        solver.BackwardTransform(lev, *vector_field[2], compz);
 #else
-        solver.BackwardTransform(lev, *vector_field[0], compx);
-        solver.BackwardTransform(lev, *vector_field[1], compy);
+        solver.BackwardTransform(lev, vector_field, {compx, compy, compz});
 #endif
-        solver.BackwardTransform(lev, *vector_field[2], compz);
     }
 }
 
@@ -486,6 +561,7 @@ WarpX::PSATDScaleAverageFields (const amrex::Real scale_factor)
 void
 WarpX::PushPSATD ()
 {
+    CostPhaseTimer cost_phase(CostPhase::EBUpdate);
 #ifndef WARPX_USE_PSATD
     amrex::Abort(Utils::TextMsg::Err(
         "PushFieldsEM: PSATD solver selected but not built"));
@@ -573,26 +649,37 @@ WarpX::EvolveB (int lev, amrex::Real a_dt, DtType a_dt_type)
 void
 WarpX::EvolveB (int lev, PatchType patch_type, amrex::Real a_dt, DtType a_dt_type)
 {
+    CostPhaseTimer cost_phase(CostPhase::EBUpdate);
+    // guard cells in which B is also updated, in the deep-halo mode
+    const int ng_update = (patch_type == PatchType::fine) ?
+        DeepHaloUpdateDepth(lev, tracked_B, tracked_E) : 0;
+
+    MarkFieldModified(tracked_B);
 
     // Evolve B field in regular cells
     if (patch_type == PatchType::fine) {
         m_fdtd_solver_fp[lev]->EvolveB(Bfield_fp[lev], Efield_fp[lev], G_fp[lev],
                                        m_face_areas[lev], m_area_mod[lev], ECTRhofield[lev], Venl[lev],
-                                       m_flag_info_face[lev], m_borrowing[lev], lev, a_dt);
+                                       m_flag_info_face[lev], m_borrowing[lev], lev, a_dt, ng_update);
     } else {
         m_fdtd_solver_cp[lev]->EvolveB(Bfield_cp[lev], Efield_cp[lev], G_cp[lev],
                                        m_face_areas[lev], m_area_mod[lev], ECTRhofield[lev], Venl[lev],
                                        m_flag_info_face[lev], m_borrowing[lev], lev, a_dt);
     }
 
-    // Evolve B field in PML cells
+    // Evolve B field in PML cells, damping it at the end of the step in the fused mode
     if (do_pml && pml[lev]->ok()) {
+        const bool damp_pml = do_pml_fused_damping && a_dt_type == DtType::SecondHalf;
         if (patch_type == PatchType::fine) {
-            m_fdtd_solver_fp[lev]->EvolveBPML(
-                pml[lev]->GetB_fp(), pml[lev]->GetE_fp(), a_dt, WarpX::do_dive_cleaning);
+            TimePMLUpdate(lev, *pml[lev], [&] () {
+                m_fdtd_solver_fp[lev]->EvolveBPML(
+                    pml[lev]->GetB_fp(), pml[lev]->GetE_fp(), a_dt, WarpX::do_dive_cleaning,
+                    damp_pml ? &pml[lev]->GetMultiSigmaBox_fp() : nullptr);
+            });
         } else {
             m_fdtd_solver_cp[lev]->EvolveBPML(
-                pml[lev]->GetB_cp(), pml[lev]->GetE_cp(), a_dt, WarpX::do_dive_cleaning);
+                pml[lev]->GetB_cp(), pml[lev]->GetE_cp(), a_dt, WarpX::do_dive_cleaning,
+                damp_pml ? &pml[lev]->GetMultiSigmaBox_cp() : nullptr);
         }
     }
 
@@ -623,12 +710,19 @@ WarpX::EvolveE (int lev, amrex::Real a_dt)
 void
 WarpX::EvolveE (int lev, PatchType patch_type, amrex::Real a_dt)
 {
+    CostPhaseTimer cost_phase(CostPhase::EBUpdate);
+    // guard cells in which E is also updated, in the deep-halo mode
+    const int ng_update = (patch_type == PatchType::fine) ?
+        DeepHaloUpdateDepth(lev, tracked_E, tracked_B) : 0;
+
+    MarkFieldModified(tracked_E);
+
     // Evolve E field in regular cells
     if (patch_type == PatchType::fine) {
         m_fdtd_solver_fp[lev]->EvolveE(Efield_fp[lev], Bfield_fp[lev],
                                        current_fp[lev], m_edge_lengths[lev],
                                        m_face_areas[lev], ECTRhofield[lev],
-                                       F_fp[lev], lev, a_dt );
+                                       F_fp[lev], lev, a_dt, ng_update );
     } else {
         m_fdtd_solver_cp[lev]->EvolveE(Efield_cp[lev], Bfield_cp[lev],
                                        current_cp[lev], m_edge_lengths[lev],
@@ -636,32 +730,32 @@ WarpX::EvolveE (int lev, PatchType patch_type, amrex::Real a_dt)
                                        F_cp[lev], lev, a_dt );
     }
 
-    // Evolve E field in PML cells
+    // Evolve E field in PML cells, and damp it in the same kernel in the fused mode
     if (do_pml && pml[lev]->ok()) {
         if (patch_type == PatchType::fine) {
-            m_fdtd_solver_fp[lev]->EvolveEPML(
-                pml[lev]->GetE_fp(),
+            TimePMLUpdate(lev, *pml[lev], [&] () {
+                m_fdtd_solver_fp[lev]->EvolveEPML(
+                    pml[lev]->GetE_fp(),
 #ifdef WARPX_MAG_LLG
-                pml[lev]->GetH_fp(),
-#else
-                pml[lev]->GetB_fp(),
+                    (mag_LLG) ? pml[lev]->GetH_fp() :
 #endif
-                pml[lev]->Getj_fp(), pml[lev]->Get_edge_lengths(),
-                pml[lev]->GetF_fp(),
-                pml[lev]->GetMultiSigmaBox_fp(),
-                a_dt, pml_has_particles );
+                    pml[lev]->GetB_fp(),
+                    pml[lev]->Getj_fp(), pml[lev]->Get_edge_lengths(),
+                    pml[lev]->GetF_fp(),
+                    pml[lev]->GetMultiSigmaBox_fp(),
+                    a_dt, pml_has_particles, do_pml_fused_damping );
+            });
         } else {
             m_fdtd_solver_cp[lev]->EvolveEPML(
                 pml[lev]->GetE_cp(),
 #ifdef WARPX_MAG_LLG
-                pml[lev]->GetH_cp(),
-#else
-                pml[lev]->GetB_cp(),
+                (mag_LLG) ? pml[lev]->GetH_cp() :
 #endif
+                pml[lev]->GetB_cp(),
                 pml[lev]->Getj_cp(), pml[lev]->Get_edge_lengths(),
                 pml[lev]->GetF_cp(),
                 pml[lev]->GetMultiSigmaBox_cp(),
-                a_dt, pml_has_particles );
+                a_dt, pml_has_particles, do_pml_fused_damping );
         }
     }
 
@@ -683,6 +777,40 @@ WarpX::EvolveE (int lev, PatchType patch_type, amrex::Real a_dt)
 }
 
 
+#ifndef WARPX_DIM_RZ
+void
+WarpX::EvolveEBTemporalBlocking (amrex::Real a_dt)
+{
+    WARPX_PROFILE("WarpX::EvolveEBTemporalBlocking()");
+    CostPhaseTimer cost_phase(CostPhase::EBUpdate);
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(
+        E_excitation_grid_s != "parse_e_excitation_grid_function"
+        && B_excitation_grid_s != "parse_b_excitation_grid_function",
+        "warpx.temporal_blocking = 1 is not implemented with a field excitation on the grid");
+
+    int const lev = 0;
+    // The three updates use the guard cells of E and B as EvolveB, EvolveE and EvolveB do:
+    // exchange them first if they would be exhausted before the last update
+    DeepHaloCovers(lev, tracked_E, amrex::IntVect(0)); // allocate the depths
+    auto const& depth = m_deep_halo_depth[lev];
+    int const depth_B1 = std::min(depth[tracked_E] - 1, depth[tracked_B]);
+    int const depth_E = std::min(depth_B1 - 1, depth[tracked_E]);
+    int const depth_B2 = std::min(depth_E - 1, depth_B1);
+    if (depth_B1 < 0 || depth_E < 0 || depth_B2 < 0) FillBoundaryDeepHalo(lev);
+    int const ng_B1 = DeepHaloUpdateDepth(lev, tracked_B, tracked_E);
+    int const ng_E = DeepHaloUpdateDepth(lev, tracked_E, tracked_B);
+    int const ng_B2 = DeepHaloUpdateDepth(lev, tracked_B, tracked_E);
+
+    MarkFieldModified(tracked_B);
+    MarkFieldModified(tracked_E);
+
+    m_fdtd_solver_fp[lev]->EvolveEBTemporalBlocking(Efield_fp[lev], Bfield_fp[lev], current_fp[lev],
+                                                     lev, a_dt, ng_B1, ng_E, ng_B2,
+                                                     temporal_blocking_interleaved);
+}
+#endif
+
+
 void
 WarpX::EvolveF (amrex::Real a_dt, DtType a_dt_type)
 {
@@ -706,6 +834,7 @@ WarpX::EvolveF (int lev, amrex::Real a_dt, DtType a_dt_type)
 void
 WarpX::EvolveF (int lev, PatchType patch_type, amrex::Real a_dt, DtType a_dt_type)
 {
+    CostPhaseTimer cost_phase(CostPhase::EBUpdate);
     if (!do_dive_cleaning) return;
 
     WARPX_PROFILE("WarpX::EvolveF()");
@@ -724,8 +853,10 @@ WarpX::EvolveF (int lev, PatchType patch_type, amrex::Real a_dt, DtType a_dt_typ
     // Evolve F field in PML cells
     if (do_pml && pml[lev]->ok()) {
         if (patch_type == PatchType::fine) {
-            m_fdtd_solver_fp[lev]->EvolveFPML(
-                pml[lev]->GetF_fp(), pml[lev]->GetE_fp(), a_dt );
+            TimePMLUpdate(lev, *pml[lev], [&] () {
+                m_fdtd_solver_fp[lev]->EvolveFPML(
+                    pml[lev]->GetF_fp(), pml[lev]->GetE_fp(), a_dt );
+            });
         } else {
             m_fdtd_solver_cp[lev]->EvolveFPML(
                 pml[lev]->GetF_cp(), pml[lev]->GetE_cp(), a_dt );
@@ -760,6 +891,7 @@ WarpX::EvolveG (int lev, amrex::Real a_dt, DtType a_dt_type)
 void
 WarpX::EvolveG (int lev, PatchType patch_type, amrex::Real a_dt, DtType /*a_dt_type*/)
 {
+    CostPhaseTimer cost_phase(CostPhase::EBUpdate);
     if (!do_divb_cleaning) return;
 
     WARPX_PROFILE("WarpX::EvolveG()");
@@ -777,12 +909,38 @@ WarpX::EvolveG (int lev, PatchType patch_type, amrex::Real a_dt, DtType /*a_dt_t
     // TODO Evolution in PML cells will go here
 }
 
+KernelGraph*
+WarpX::GetKernelGraph (amrex::Vector<std::unique_ptr<KernelGraph>>& graphs, int lev)
+{
+    // the host timers of the costs would not be replayed
+    if (!gpu_graphs || (getCosts(lev)
+        && WarpX::load_balance_costs_update_algo == LoadBalanceCostsUpdateAlgo::Timers)) {
+        return nullptr;
+    }
+    if (static_cast<int>(graphs.size()) <= lev) graphs.resize(lev+1);
+    if (!graphs[lev]) graphs[lev] = std::make_unique<KernelGraph>();
+    return graphs[lev].get();
+}
+
+void
+WarpX::ClearKernelGraphs ()
+{
+    m_E_update_graphs.clear();
+    m_H_pml_graphs.clear();
+}
+
 void
 WarpX::MacroscopicEvolveE (amrex::Real a_dt)
 {
     for (int lev = 0; lev <= finest_level; ++lev ) {
         MacroscopicEvolveE(lev, a_dt);
     }
+#ifdef WARPX_MAG_LLG
+    // the covered cells of the coarser levels take the values of the finer levels
+    if (mag_mr_lockstep) {
+        for (int lev = finest_level; lev > 0; --lev) AverageDownField(Efield_fp, lev);
+    }
+#endif
 }
 
 void
@@ -790,8 +948,10 @@ WarpX::MacroscopicEvolveE (int lev, amrex::Real a_dt) {
 
     WARPX_PROFILE("WarpX::MacroscopicEvolveE()");
 
+    // with mesh refinement, only the levels of the LLG solver advanced in lockstep are
+    // implemented, without coarse patch
     WARPX_ALWAYS_ASSERT_WITH_MESSAGE(
-        lev == 0,
+        lev == 0 || MRLockstep(),
         "Macroscopic EvolveE is not implemented for lev>0, yet."
     );
 
@@ -800,149 +960,348 @@ WarpX::MacroscopicEvolveE (int lev, amrex::Real a_dt) {
 
 void
 WarpX::MacroscopicEvolveE (int lev, PatchType patch_type, amrex::Real a_dt) {
+    CostPhaseTimer cost_phase(CostPhase::EBUpdate);
+
+    // guard cells in which E is also updated, in the deep-halo mode
+    const int ng_update = (patch_type == PatchType::fine) ?
+        DeepHaloUpdateDepth(lev, tracked_E, tracked_B) : 0;
+
+    MarkFieldModified(tracked_E);
 
     // Evolve E field in regular cells
     WARPX_ALWAYS_ASSERT_WITH_MESSAGE(
         patch_type == PatchType::fine,
-        "Macroscopic EvolveE is not implemented for lev>0, yet."
+        "Macroscopic EvolveE is not implemented for the coarse patch, yet."
     );
-    m_fdtd_solver_fp[lev]->MacroscopicEvolveE( Efield_fp[lev],
-#ifndef WARPX_MAG_LLG
-                                               Bfield_fp[lev],
-#else
-                                               Hfield_fp[lev],
-#endif
-                                               current_fp[lev], m_edge_lengths[lev], a_dt,
-                                               m_macroscopic_properties);
-    // Evolve E field in PML cells
-    if (do_pml && pml[lev]->ok()) {
-        if (patch_type == PatchType::fine) {
-            m_fdtd_solver_fp[lev]->MacroscopicEvolveEPML(
-                pml[lev]->GetE_fp(),
-#ifndef WARPX_MAG_LLG
-                pml[lev]->GetB_fp(),
-#else
-                pml[lev]->GetH_fp(),
+    // the kernels of the update are replayed from a graph with warpx.gpu_graphs
+    auto const update_E = [&] () {
+        auto const evolve_E_interior = [&] () {
+            m_fdtd_solver_fp[lev]->MacroscopicEvolveE( lev, Efield_fp[lev],
+#ifdef WARPX_MAG_LLG
+                                                       (mag_LLG) ? Hfield_fp[lev] :
 #endif
-                pml[lev]->Getj_fp(), pml[lev]->GetF_fp(),
-                pml[lev]->GetMultiSigmaBox_fp(),
-                a_dt, pml_has_particles,
-                m_macroscopic_properties,
-                pml[lev]->Geteps_fp(),
-                pml[lev]->Getmu_fp(),
-                pml[lev]->Getsigma_fp() );
+                                                       Bfield_fp[lev],
+                                                       current_fp[lev], m_edge_lengths[lev], a_dt,
+                                                       m_macroscopic_properties[lev], ng_update);
+        };
+        // Evolve E field in PML cells, and damp it in the same kernel in the fused mode
+        if (!(do_pml && pml[lev]->ok())) {
+            evolve_E_interior();
         } else {
-            m_fdtd_solver_cp[lev]->MacroscopicEvolveEPML(
-                pml[lev]->GetE_cp(),
-#ifndef WARPX_MAG_LLG
-                pml[lev]->GetB_cp(),
-#else
-                pml[lev]->GetH_cp(),
+            if (patch_type == PatchType::fine) {
+                UpdateInteriorAndPML(lev, *pml[lev], omp_overlap_tasks, *Efield_fp[lev][0],
+                                     *pml[lev]->GetE_fp()[0], evolve_E_interior, [&] () {
+                    m_fdtd_solver_fp[lev]->MacroscopicEvolveEPML(
+                        pml[lev]->GetE_fp(),
+#ifdef WARPX_MAG_LLG
+                        (mag_LLG) ? pml[lev]->GetH_fp() :
 #endif
-                pml[lev]->Getj_cp(), pml[lev]->GetF_cp(),
-                pml[lev]->GetMultiSigmaBox_cp(),
-                a_dt, pml_has_particles,
-                m_macroscopic_properties,
-                pml[lev]->Geteps_cp(),
-                pml[lev]->Getmu_cp(),
-                pml[lev]->Getsigma_cp() );
+                        pml[lev]->GetB_fp(),
+                        pml[lev]->Getj_fp(), pml[lev]->GetF_fp(),
+                        pml[lev]->GetMultiSigmaBox_fp(),
+                        a_dt, pml_has_particles,
+                        m_macroscopic_properties[lev],
+                        pml[lev]->Geteps_fp(),
+                        pml[lev]->Getmu_fp(),
+                        pml[lev]->Getsigma_fp(),
+                        pml[lev]->GetCPMLPsiE_fp(), do_pml_fused_damping );
+                });
+            } else {
+                evolve_E_interior();
+                m_fdtd_solver_cp[lev]->MacroscopicEvolveEPML(
+                    pml[lev]->GetE_cp(),
+#ifdef WARPX_MAG_LLG
+                    (mag_LLG) ? pml[lev]->GetH_cp() :
+#endif
+                    pml[lev]->GetB_cp(),
+                    pml[lev]->Getj_cp(), pml[lev]->GetF_cp(),
+                    pml[lev]->GetMultiSigmaBox_cp(),
+                    a_dt, pml_has_particles,
+                    m_macroscopic_properties[lev],
+                    pml[lev]->Geteps_cp(),
+                    pml[lev]->Getmu_cp(),
+                    pml[lev]->Getsigma_cp(), nullptr, do_pml_fused_damping );
+            }
         }
+
+        ApplyEfieldBoundary(lev, patch_type);
+    };
+    // the lumped elements are advanced from E^n, outside of the graph since their sources are
+    // evaluated and their values exchanged on the host, and then overwrite the updated E
+    bool const lumped_elements = (m_lumped_elements && lev == 0);
+    if (lumped_elements) {
+        m_fdtd_solver_fp[lev]->MacroscopicLumpedElements(Efield_fp[lev],
+#ifdef WARPX_MAG_LLG
+                                                         (mag_LLG) ? Hfield_fp[lev] :
+#endif
+                                                         Bfield_fp[lev],
+                                                         current_fp[lev], a_dt, gett_new(lev),
+                                                         m_macroscopic_properties[lev], *m_lumped_elements);
     }
 
-    ApplyEfieldBoundary(lev, patch_type);
+    KernelGraph* graph = GetKernelGraph(m_E_update_graphs, lev);
+    if (graph) {
+        graph->Run({a_dt, amrex::Real(ng_update),
+                    amrex::Real(m_macroscopic_properties[lev]->getproperties_version())}, update_E);
+    } else {
+        update_E();
+    }
+    if (lumped_elements) m_lumped_elements->WriteE(Efield_fp[lev]);
+
+    // ECTRhofield must be recomputed at the very end of the Efield update to ensure
+    // that ECTRhofield is consistent with Efield
+#ifdef AMREX_USE_EB
+    if (WarpX::maxwell_solver_id == MaxwellSolverAlgo::ECT) {
+        m_fdtd_solver_fp[lev]->EvolveECTRho(Efield_fp[lev], m_edge_lengths[lev],
+                                            m_face_areas[lev], ECTRhofield[lev], lev);
+    }
+#endif
 }
 
 #ifndef WARPX_DIM_RZ
 #ifdef WARPX_MAG_LLG
 // define WarpX::MacroscopicEvolveHM
 void
-WarpX::MacroscopicEvolveHM (amrex::Real a_dt)
+WarpX::MacroscopicEvolveHM (amrex::Real a_dt, DtType a_dt_type)
 {
+    amrex::Real const dt_M = LLGSubcycleTimestep(a_dt);
     for (int lev = 0; lev <= finest_level; ++lev ) {
-        MacroscopicEvolveHM(lev, a_dt);
+        MacroscopicEvolveHM(lev, a_dt, dt_M, a_dt_type);
     }
+    // the covered cells of the coarser levels take the values of the finer levels
+    for (int lev = finest_level; lev > 0; --lev) {
+        AverageDownField(Hfield_fp, lev);
+        AverageDownField(Mfield_fp, lev, (mag_M_collocated == 1) ? 1 : 3);
+    }
+    if (dt_M > 0._rt) UpdateLLGSubcycle(a_dt);
 }
 
 void
-WarpX::MacroscopicEvolveHM (int lev, amrex::Real a_dt) {
+WarpX::MacroscopicEvolveHM (int lev, amrex::Real a_dt, amrex::Real a_dt_M, DtType a_dt_type) {
 
     WARPX_PROFILE("WarpX::MacroscopicEvolveHM()");
-    MacroscopicEvolveHM(lev, PatchType::fine, a_dt);
-    if (lev > 0) {
-        amrex::Abort("Macroscopic EvolveHM is not implemented for lev>0, yet.");
-    }
+    // with mesh refinement, the levels are advanced in lockstep without coarse patch
+    MacroscopicEvolveHM(lev, PatchType::fine, a_dt, a_dt_M, a_dt_type);
 }
 
 void
-WarpX::MacroscopicEvolveHM (int lev, PatchType patch_type, amrex::Real a_dt) {
+WarpX::MacroscopicEvolveHM (int lev, PatchType patch_type, amrex::Real a_dt, amrex::Real a_dt_M,
+                            DtType a_dt_type) {
+    CostPhaseTimer cost_phase(CostPhase::HMUpdate);
+
+    // B is computed from H and M when it is read, see ComputeBfieldFromHM
+    MarkFieldModified(tracked_H);
+    MarkFieldModified(tracked_M);
+    m_Bfield_outdated = true;
 
     // Evolve H field in regular cells
-    if (patch_type == PatchType::fine) {
-        m_fdtd_solver_fp[lev]->MacroscopicEvolveHM(Mfield_fp[lev], Hfield_fp[lev], Bfield_fp[lev], H_biasfield_fp[lev], Efield_fp[lev],
-                                                   a_dt, m_macroscopic_properties);
-    }
-    else {
-        amrex::Abort("Macroscopic EvolveHM is not implemented for lev > 0 yet");
+    if (patch_type != PatchType::fine) {
+        amrex::Abort("Macroscopic EvolveHM is not implemented for the coarse patch");
     }
+    // the thin film is advanced with H^n, and its change of moment is added to the H update of the grid
+#ifdef WARPX_DIM_3D
+    bool const thin_film = (m_mag_thin_film && lev == 0 && a_dt_M > 0._rt);
+#else
+    bool const thin_film = false;
+#endif
+    auto const evolve_HM_interior = [&] () {
+        ComputeECTMinusCurlE(lev);
+#ifdef WARPX_DIM_3D
+        if (thin_film) m_mag_thin_film->EvolveM(Hfield_fp[lev], H_biasfield_fp[lev], a_dt_M);
+#endif
+        m_fdtd_solver_fp[lev]->MacroscopicEvolveHM(lev, Mfield_fp[lev], Hfield_fp[lev], H_biasfield_fp[lev], Efield_fp[lev],
+                                                       m_face_areas[lev], m_ect_minus_curlE[lev],
+                                                       a_dt, a_dt_M, m_macroscopic_properties[lev]);
+#ifdef WARPX_DIM_3D
+        if (thin_film) m_mag_thin_film->CorrectH(Hfield_fp[lev]);
+#endif
+    };
 
-    // Evolve H field in PML cells
+    // Evolve H field in PML cells, damping it at the end of the step in the fused mode
     if (do_pml && pml[lev]->ok()) {
-        if (patch_type == PatchType::fine) {
+        const bool damp_pml = do_pml_fused_damping && a_dt_type == DtType::SecondHalf;
+        auto const evolve_H_pml = [&] () {
             m_fdtd_solver_fp[lev]->EvolveHPML(
-                pml[lev]->GetH_fp(), pml[lev]->GetE_fp(), a_dt, WarpX::do_dive_cleaning);
-        } else {
-            m_fdtd_solver_cp[lev]->EvolveHPML(
-                pml[lev]->GetH_cp(), pml[lev]->GetE_cp(), a_dt, WarpX::do_dive_cleaning );
-        }
+                pml[lev]->GetH_fp(), pml[lev]->GetE_fp(), a_dt, WarpX::do_dive_cleaning,
+                pml[lev]->GetMultiSigmaBox_fp(), pml[lev]->GetCPMLPsiH_fp(), damp_pml);
+        };
+        KernelGraph* graph = GetKernelGraph(m_H_pml_graphs, lev);
+        UpdateInteriorAndPML(lev, *pml[lev], omp_overlap_tasks, *Hfield_fp[lev][0],
+                             *pml[lev]->GetH_fp()[0], evolve_HM_interior, [&] () {
+            if (graph) {
+                graph->Run({a_dt, amrex::Real(damp_pml)}, evolve_H_pml);
+            } else {
+                evolve_H_pml();
+            }
+        });
+    } else {
+        evolve_HM_interior();
     }
+
+    ApplyHfieldBoundary(lev, patch_type, a_dt_type);
 }
 
 // define WarpX::MacroscopicEvolveHM_2nd
 void
-WarpX::MacroscopicEvolveHM_2nd (amrex::Real a_dt)
+WarpX::MacroscopicEvolveHM_2nd (amrex::Real a_dt, DtType a_dt_type)
 {
+    amrex::Real const dt_M = LLGSubcycleTimestep(a_dt);
     for (int lev = 0; lev <= finest_level; ++lev ) {
-        MacroscopicEvolveHM_2nd(lev, a_dt);
+        MacroscopicEvolveHM_2nd(lev, a_dt, dt_M, a_dt_type);
+    }
+    // the covered cells of the coarser levels take the values of the finer levels
+    for (int lev = finest_level; lev > 0; --lev) {
+        AverageDownField(Hfield_fp, lev);
+        AverageDownField(Mfield_fp, lev, (mag_M_collocated == 1) ? 1 : 3);
     }
+    if (dt_M > 0._rt) UpdateLLGSubcycle(a_dt);
 }
 
 void
-WarpX::MacroscopicEvolveHM_2nd (int lev, amrex::Real a_dt) {
+WarpX::MacroscopicEvolveHM_2nd (int lev, amrex::Real a_dt, amrex::Real a_dt_M, DtType a_dt_type) {
 
     WARPX_PROFILE("WarpX::MacroscopicEvolveHM_2nd()");
-    MacroscopicEvolveHM_2nd(lev, PatchType::fine, a_dt);
-    if (lev > 0) {
-        amrex::Abort("Macroscopic EvolveHM_2nd is not implemented for lev>0, yet.");
-    }
+    // with mesh refinement, the levels are advanced in lockstep without coarse patch
+    MacroscopicEvolveHM_2nd(lev, PatchType::fine, a_dt, a_dt_M, a_dt_type);
 }
 
 void
-WarpX::MacroscopicEvolveHM_2nd (int lev, PatchType patch_type, amrex::Real a_dt) {
+WarpX::MacroscopicEvolveHM_2nd (int lev, PatchType patch_type, amrex::Real a_dt, amrex::Real a_dt_M,
+                                DtType a_dt_type) {
+    CostPhaseTimer cost_phase(CostPhase::HMUpdate);
+
+    // B is computed from H and M when it is read, see ComputeBfieldFromHM
+    MarkFieldModified(tracked_H);
+    MarkFieldModified(tracked_M);
+    m_Bfield_outdated = true;
 
     // Evolve H field in regular cells
     if (patch_type == PatchType::fine) {
-        m_fdtd_solver_fp[lev]->MacroscopicEvolveHM_2nd(lev, Mfield_fp[lev], Hfield_fp[lev], Bfield_fp[lev], H_biasfield_fp[lev],  Efield_fp[lev],
-                                                       a_dt, m_macroscopic_properties);
+        ComputeECTMinusCurlE(lev);
+        m_fdtd_solver_fp[lev]->MacroscopicEvolveHM_2nd(lev, Mfield_fp[lev], Hfield_fp[lev], H_biasfield_fp[lev],  Efield_fp[lev],
+                                                       m_face_areas[lev], m_ect_minus_curlE[lev],
+                                                       a_dt, a_dt_M, m_macroscopic_properties[lev]);
     }
     else {
-        amrex::Abort("Macroscopic EvolveHM_2nd is not implemented for lev > 0 yet");
+        amrex::Abort("Macroscopic EvolveHM_2nd is not implemented for the coarse patch");
     }
 
-    // Evolve H field in PML cells
+    // Evolve H field in PML cells, damping it at the end of the step in the fused mode
     if (do_pml && pml[lev]->ok()) {
+        const bool damp_pml = do_pml_fused_damping && a_dt_type == DtType::SecondHalf;
         if (patch_type == PatchType::fine) {
-            m_fdtd_solver_fp[lev]->EvolveHPML(
-                pml[lev]->GetH_fp(), pml[lev]->GetE_fp(), a_dt, WarpX::do_dive_cleaning );
+            TimePMLUpdate(lev, *pml[lev], [&] () {
+                m_fdtd_solver_fp[lev]->EvolveHPML(
+                    pml[lev]->GetH_fp(), pml[lev]->GetE_fp(), a_dt, WarpX::do_dive_cleaning,
+                    pml[lev]->GetMultiSigmaBox_fp(), pml[lev]->GetCPMLPsiH_fp(), damp_pml );
+            });
         } else {
             m_fdtd_solver_cp[lev]->EvolveHPML(
-                pml[lev]->GetH_cp(), pml[lev]->GetE_cp(), a_dt, WarpX::do_dive_cleaning );
+                pml[lev]->GetH_cp(), pml[lev]->GetE_cp(), a_dt, WarpX::do_dive_cleaning,
+                pml[lev]->GetMultiSigmaBox_cp(), nullptr, damp_pml );
         }
     }
+
+    ApplyHfieldBoundary(lev, patch_type, a_dt_type);
+}
+
+void
+WarpX::ComputeECTMinusCurlE (int lev)
+{
+#ifdef AMREX_USE_EB
+    if (WarpX::maxwell_solver_id != MaxwellSolverAlgo::ECT || !m_ect_minus_curlE[lev][0]) return;
+
+    // The B update of ECT over a unit timestep, starting from zero, gives -curl(E)
+    // including the borrowing of the extended faces, and leaves the covered faces at zero
+    for (int idim = 0; idim < 3; ++idim) {
+        m_ect_minus_curlE[lev][idim]->setVal(0.);
+    }
+    m_fdtd_solver_fp[lev]->EvolveB(m_ect_minus_curlE[lev], Efield_fp[lev], G_fp[lev],
+                                   m_face_areas[lev], m_area_mod[lev], ECTRhofield[lev], Venl[lev],
+                                   m_flag_info_face[lev], m_borrowing[lev], lev, 1._rt);
+#else
+    amrex::ignore_unused(lev);
+#endif
+}
+
+amrex::Real
+WarpX::LLGSubcycleTimestep (amrex::Real a_dt)
+{
+    if (m_macroscopic_properties[0]->getmag_LLG_subcycle() == 0) return a_dt;
+
+    // M is advanced once every m_llg_subcycle_n H updates, over the accumulated time
+    m_llg_subcycle_count++;
+    m_llg_subcycle_dt += a_dt;
+    if (m_llg_subcycle_count < m_llg_subcycle_n) return 0._rt;
+
+    amrex::Real const dt_M = m_llg_subcycle_dt;
+    m_llg_subcycle_count = 0;
+    m_llg_subcycle_dt = 0._rt;
+    return dt_M;
+}
+
+void
+WarpX::UpdateLLGSubcycle (amrex::Real a_dt)
+{
+    if (m_macroscopic_properties[0]->getmag_LLG_subcycle() == 0) return;
+
+    // the levels share the number of sub-cycles, set by the fastest precession of all levels
+    amrex::Real rate = 0._rt;
+    for (int lev = 0; lev <= finest_level; ++lev) {
+        rate = amrex::max(rate, m_fdtd_solver_fp[lev]->MaxLLGPrecessionRate(
+            lev, Hfield_fp[lev], H_biasfield_fp[lev], m_macroscopic_properties[lev]));
+    }
+    int const n_max = m_macroscopic_properties[0]->getmag_LLG_subcycle_max();
+    amrex::Real const max_angle = m_macroscopic_properties[0]->getmag_LLG_subcycle_max_angle();
+
+    int n = n_max;
+    if (rate * a_dt * n_max > max_angle) {
+        n = amrex::max(1, static_cast<int>(max_angle / (rate * a_dt)));
+    }
+    if (verbose && n != m_llg_subcycle_n) {
+        amrex::Print() << "LLG sub-cycling: " << n << " H updates per LLG step" << std::endl;
+    }
+    m_llg_subcycle_n = n;
 }
 
 #endif
 #endif // ifndef WARPX_DIM_RZ
 
+#ifdef WARPX_MAG_LLG
+void
+WarpX::ComputeBfieldFromHM ()
+{
+    if (!m_Bfield_outdated) return;
+
+#ifndef WARPX_DIM_RZ
+    WARPX_PROFILE("WarpX::ComputeBfieldFromHM()");
+    CostPhaseTimer cost_phase(CostPhase::HMUpdate);
+
+    MarkFieldModified(tracked_B);
+    for (int lev = 0; lev <= finest_level; ++lev) {
+        m_fdtd_solver_fp[lev]->ComputeBfromHM(lev, Bfield_fp[lev], Hfield_fp[lev], Mfield_fp[lev],
+                                              m_macroscopic_properties[lev]);
+#ifdef WARPX_DIM_3D
+        if (m_mag_thin_film && lev == 0) m_mag_thin_film->AddToB(Bfield_fp[lev]);
+#endif
+
+        // the field gather and the cell-centered diagnostics read B in the guard cells
+        amrex::Vector<amrex::MultiFab*> mf;
+        amrex::Vector<amrex::IntVect> ng;
+        for (int i = 0; i < 3; ++i) {
+            mf.push_back(Bfield_fp[lev][i].get());
+            ng.push_back(Bfield_fp[lev][i]->nGrowVect());
+        }
+        GuardCellsNeedFill(lev, tracked_B, ng[0]); // record the exchange
+        if (lev > 0) FillCoarseFineBoundary(Bfield_fp, lev);
+        WarpXCommUtil::FillBoundary(mf, ng, Geom(lev).periodicity());
+    }
+#endif
+
+    m_Bfield_outdated = false;
+}
+#endif
+
 void
 WarpX::DampFieldsInGuards(const int lev,
                           const std::array<std::unique_ptr<amrex::MultiFab>,3>& Efield,
@@ -0,0 +1,309 @@
+/* This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+#include "WaveguidePortMode.H"
+
+#include "Utils/TextMsg.H"
+#include "Utils/WarpXConst.H"
+#include "Utils/WarpXUtil.H"
+
+#include <AMReX.H>
+#include <AMReX_Arena.H>
+#include <AMReX_Box.H>
+#include <AMReX_BoxArray.H>
+#include <AMReX_DistributionMapping.H>
+#include <AMReX_FabArray.H>
+#include <AMReX_GpuDevice.H>
+#include <AMReX_IntVect.H>
+#include <AMReX_Loop.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Print.H>
+#include <AMReX_Vector.H>
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <string>
+
+using namespace amrex;
+
+namespace
+{
+    /** -Laplacian on the guide cells of a cross-section of n_a x n_b cells, with homogeneous
+     *  Neumann or Dirichlet conditions on the faces between the guide and the walls */
+    struct CrossSectionLaplacian
+    {
+        int n_a, n_b;
+        Real inv_dx2_a, inv_dx2_b;
+        Vector<int> const& guide;
+        bool dirichlet;
+
+        int Index (int ia, int ib) const { return ib * n_a + ia; }
+
+        bool IsGuide (int ia, int ib) const {
+            return ia >= 0 && ia < n_a && ib >= 0 && ib < n_b && guide[Index(ia, ib)];
+        }
+
+        /** y = (-Laplacian + shift) x */
+        void Apply (Vector<Real> const& x, Vector<Real>& y, Real shift) const
+        {
+            for (int ib = 0; ib < n_b; ++ib) {
+                for (int ia = 0; ia < n_a; ++ia) {
+                    const int n = Index(ia, ib);
+                    if (!guide[n]) { y[n] = 0._rt; continue; }
+                    Real r = shift * x[n];
+                    const int da[4] = {-1, 1, 0, 0};
+                    const int db[4] = {0, 0, -1, 1};
+                    for (int s = 0; s < 4; ++s) {
+                        const Real inv_dx2 = (da[s] != 0) ? inv_dx2_a : inv_dx2_b;
+                        if (IsGuide(ia + da[s], ib + db[s])) {
+                            r += inv_dx2 * (x[n] - x[Index(ia + da[s], ib + db[s])]);
+                        } else if (dirichlet) {
+                            // psi = 0 on the wall face: the ghost value is -psi
+                            r += 2._rt * inv_dx2 * x[n];
+                        }
+                    }
+                    y[n] = r;
+                }
+            }
+        }
+    };
+
+    Real Dot (Vector<Real> const& x, Vector<Real> const& y)
+    {
+        Real d = 0._rt;
+        for (int n = 0; n < static_cast<int>(x.size()); ++n) d += x[n] * y[n];
+        return d;
+    }
+
+    /** Remove from x its components along the orthonormal vectors of basis, and normalize it */
+    void Orthonormalize (Vector<Real>& x, Vector<Vector<Real>> const& basis)
+    {
+        for (auto const& v : basis) {
+            const Real p = Dot(x, v);
+            for (int n = 0; n < static_cast<int>(x.size()); ++n) x[n] -= p * v[n];
+        }
+        const Real norm = std::sqrt(Dot(x, x));
+        if (norm > 0._rt) {
+            for (auto& xn : x) xn /= norm;
+        }
+    }
+
+    /** Solve (A + shift) x = rhs by conjugate gradients, from x = 0 */
+    void SolveCG (CrossSectionLaplacian const& A, Real shift, Vector<Real> const& rhs,
+                  Vector<Real>& x, Vector<Vector<Real>> const& basis)
+    {
+        const int n = rhs.size();
+        x.assign(n, 0._rt);
+        Vector<Real> r = rhs, p = rhs, Ap(n);
+        Real rr = Dot(r, r);
+        const Real tol2 = 1.e-24_rt * rr;
+        for (int it = 0; it < 10 * n && rr > tol2; ++it) {
+            A.Apply(p, Ap, shift);
+            const Real alpha = rr / Dot(p, Ap);
+            for (int m = 0; m < n; ++m) {
+                x[m] += alpha * p[m];
+                r[m] -= alpha * Ap[m];
+            }
+            // keep the residual orthogonal to the lower modes, against the rounding errors
+            for (auto const& v : basis) {
+                const Real pv = Dot(r, v);
+                for (int m = 0; m < n; ++m) r[m] -= pv * v[m];
+            }
+            const Real rr_new = Dot(r, r);
+            for (int m = 0; m < n; ++m) p[m] = r[m] + (rr_new / rr) * p[m];
+            rr = rr_new;
+        }
+    }
+}
+
+WaveguidePortMode::WaveguidePortMode ()
+{
+#ifndef WARPX_DIM_3D
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(false,
+        "warpx.<F>_excitation_port_mode is only implemented in 3D");
+#endif
+    ParmParse pp_port("port_mode");
+    std::string normal;
+    pp_port.get("normal", normal);
+    if (normal == "x" || normal == "X") {
+        m_normal = 0;
+    } else if (normal == "y" || normal == "Y") {
+        m_normal = 1;
+    } else if (normal == "z" || normal == "Z") {
+        m_normal = 2;
+    } else {
+        amrex::Abort(Utils::TextMsg::Err("port_mode.normal must be x, y or z"));
+    }
+    getWithParser(pp_port, "position", m_position);
+    Vector<Real> lo, hi;
+    getArrWithParser(pp_port, "lo", lo, 0, 3);
+    getArrWithParser(pp_port, "hi", hi, 0, 3);
+    for (int idim = 0; idim < 3; ++idim) {
+        m_lo[idim] = lo[idim];
+        m_hi[idim] = hi[idim];
+    }
+    std::string type = "TE";
+    pp_port.query("type", type);
+    if (type == "TE" || type == "te") {
+        m_type = 0;
+    } else if (type == "TM" || type == "tm") {
+        m_type = 1;
+    } else {
+        amrex::Abort(Utils::TextMsg::Err("port_mode.type must be TE or TM"));
+    }
+    pp_port.query("index", m_index);
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(m_index >= 0, "port_mode.index must be non-negative");
+    queryWithParser(pp_port, "conductor_sigma", m_conductor_sigma);
+}
+
+void
+WaveguidePortMode::Solve (Geometry const& geom, MultiFab const* sigma)
+{
+    const int d = m_normal;
+    const int a = (d + 1) % 3;
+    const int b = (d + 2) % 3;
+
+    // the cells of the cross-section, in the layer of cells that contains the plane
+    Box plane = geom.Domain();
+    const int i_normal = static_cast<int>(std::floor((m_position - geom.ProbLo(d)) / geom.CellSize(d)));
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(i_normal >= plane.smallEnd(d) && i_normal <= plane.bigEnd(d),
+        "port_mode.position must be inside the domain");
+    plane.setSmall(d, i_normal);
+    plane.setBig(d, i_normal);
+    for (int t : {a, b}) {
+        const int i_lo = static_cast<int>(std::round((m_lo[t] - geom.ProbLo(t)) / geom.CellSize(t)));
+        const int i_hi = static_cast<int>(std::round((m_hi[t] - geom.ProbLo(t)) / geom.CellSize(t))) - 1;
+        plane.setSmall(t, std::max(i_lo, plane.smallEnd(t)));
+        plane.setBig(t, std::min(i_hi, plane.bigEnd(t)));
+    }
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(plane.ok() && plane.length(a) >= 2 && plane.length(b) >= 2,
+        "port_mode.lo and port_mode.hi must span at least two cells across the guide");
+    m_n_a = plane.length(a);
+    m_n_b = plane.length(b);
+    m_dx_a = geom.CellSize(a);
+    m_dx_b = geom.CellSize(b);
+    m_x0_a = geom.ProbLo(a) + (plane.smallEnd(a) + 0.5_rt) * m_dx_a;
+    m_x0_b = geom.ProbLo(b) + (plane.smallEnd(b) + 0.5_rt) * m_dx_b;
+    const int ncells = m_n_a * m_n_b;
+
+    // gather the conductivity of the cross-section on the I/O processor
+    const int root = ParallelDescriptor::IOProcessorNumber();
+    MultiFab plane_sigma(BoxArray(plane), DistributionMapping(Vector<int>{root}), 1, 0,
+                         MFInfo().SetArena(The_Pinned_Arena()));
+    plane_sigma.setVal(0._rt);
+    if (sigma) plane_sigma.ParallelCopy(*sigma, 0, 0, 1);
+
+    Vector<Real> Et(2 * ncells, 0._rt);
+    Real kc2 = 0._rt;
+    if (ParallelDescriptor::IOProcessor()) {
+        Gpu::streamSynchronize();
+        Array4<Real const> const& sigma_arr = plane_sigma.const_array(0);
+        Vector<int> guide(ncells, 0);
+        int nguide = 0;
+        amrex::LoopOnCpu(plane, [&] (int i, int j, int k) {
+            const IntVect iv(AMREX_D_DECL(i, j, k));
+            const int n = (iv[b] - plane.smallEnd(b)) * m_n_a + (iv[a] - plane.smallEnd(a));
+            guide[n] = (sigma_arr(i, j, k) < m_conductor_sigma) ? 1 : 0;
+            nguide += guide[n];
+        });
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(nguide > 0, "the cross-section of port_mode has no guide cell");
+
+        const bool dirichlet = (m_type == 1);
+        CrossSectionLaplacian const A{m_n_a, m_n_b, 1._rt / (m_dx_a * m_dx_a), 1._rt / (m_dx_b * m_dx_b),
+                                      guide, dirichlet};
+        // the shift makes the Neumann operator definite, the constant being deflated
+        const Real shift = 1.e-8_rt * (A.inv_dx2_a + A.inv_dx2_b);
+        Vector<Vector<Real>> basis;
+        if (!dirichlet) {
+            Vector<Real> constant(ncells);
+            for (int n = 0; n < ncells; ++n) constant[n] = guide[n];
+            Orthonormalize(constant, basis);
+            basis.push_back(constant);
+        }
+
+        // inverse iteration for the modes 0 to m_index, each deflated against the lower ones
+        Vector<Real> psi(ncells), x(ncells), Ax(ncells);
+        for (int m = 0; m <= m_index; ++m) {
+            for (int n = 0; n < ncells; ++n) {
+                // a deterministic start with components on all the modes
+                psi[n] = guide[n] * (1._rt + 0.5_rt * std::sin(0.7_rt * n + m) + 0.1_rt * (n % 7));
+            }
+            Orthonormalize(psi, basis);
+            Real kc2_old = 0._rt;
+            for (int it = 0; it < 1000; ++it) {
+                SolveCG(A, shift, psi, x, basis);
+                Orthonormalize(x, basis);
+                psi = x;
+                A.Apply(psi, Ax, 0._rt);
+                kc2 = Dot(psi, Ax);
+                if (it > 0 && std::abs(kc2 - kc2_old) <= 1.e-12_rt * kc2) break;
+                kc2_old = kc2;
+            }
+            basis.push_back(psi);
+        }
+
+        // transverse E at the cell centers from grad psi, with the ghost values of the walls
+        const Real wall_sign = dirichlet ? -1._rt : 1._rt;
+        auto psi_at = [&] (int ia, int ib, int n_self) {
+            return A.IsGuide(ia, ib) ? psi[A.Index(ia, ib)] : wall_sign * psi[n_self];
+        };
+        Real Et_max = 0._rt;
+        for (int ib = 0; ib < m_n_b; ++ib) {
+            for (int ia = 0; ia < m_n_a; ++ia) {
+                const int n = A.Index(ia, ib);
+                if (!guide[n]) continue;
+                const Real dpsi_a = (psi_at(ia + 1, ib, n) - psi_at(ia - 1, ib, n)) / (2._rt * m_dx_a);
+                const Real dpsi_b = (psi_at(ia, ib + 1, n) - psi_at(ia, ib - 1, n)) / (2._rt * m_dx_b);
+                // TE: E_t = normal x grad psi, TM: E_t = grad psi
+                Et[2 * n] = dirichlet ? dpsi_a : -dpsi_b;
+                Et[2 * n + 1] = dirichlet ? dpsi_b : dpsi_a;
+                Et_max = std::max(Et_max, std::sqrt(Et[2 * n] * Et[2 * n] + Et[2 * n + 1] * Et[2 * n + 1]));
+            }
+        }
+        // normalize to a maximum of 1, with the larger component of positive sum
+        Real sum[2] = {0._rt, 0._rt};
+        for (int n = 0; n < ncells; ++n) {
+            sum[0] += Et[2 * n];
+            sum[1] += Et[2 * n + 1];
+        }
+        const Real dominant = (std::abs(sum[0]) >= std::abs(sum[1])) ? sum[0] : sum[1];
+        const Real scale = (Et_max > 0._rt) ? ((dominant < 0._rt) ? -1._rt : 1._rt) / Et_max : 0._rt;
+        for (auto& e : Et) e *= scale;
+    }
+    ParallelDescriptor::Bcast(Et.data(), Et.size(), root);
+    ParallelDescriptor::Bcast(&kc2, 1, root);
+
+    m_Et.resize(Et.size());
+    Gpu::copyAsync(Gpu::hostToDevice, Et.begin(), Et.end(), m_Et.begin());
+    Gpu::streamSynchronize();
+    m_solved = true;
+
+    const Real kc = std::sqrt(kc2);
+    std::stringstream ss;
+    ss << "Port mode " << (m_type == 0 ? "TE" : "TM") << " " << m_index << " on "
+       << m_n_a << " x " << m_n_b << " cells: cutoff wavenumber " << kc
+       << " 1/m, cutoff frequency " << PhysConst::c * kc / (2._rt * MathConst::pi)
+       << " Hz in vacuum (divided by sqrt(eps_r mu_r) in the filling)";
+    amrex::Print() << Utils::TextMsg::Info(ss.str());
+}
+
+PortModeProfile
+WaveguidePortMode::GetProfile (bool magnetic) const
+{
+    PortModeProfile profile;
+    profile.Et = m_Et.dataPtr();
+    profile.normal = m_normal;
+    profile.a = (m_normal + 1) % 3;
+    profile.b = (m_normal + 2) % 3;
+    profile.n_a = m_n_a;
+    profile.n_b = m_n_b;
+    profile.x0_a = m_x0_a;
+    profile.x0_b = m_x0_b;
+    profile.dx_a = m_dx_a;
+    profile.dx_b = m_dx_b;
+    profile.magnetic = magnetic;
+    return profile;
+}
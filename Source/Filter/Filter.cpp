@@ -15,6 +15,9 @@
 #include <AMReX_Extension.H>
 #include <AMReX_FArrayBox.H>
 #include <AMReX_FabArray.H>
+#include <AMReX_GpuDevice.H>
+#include <AMReX_GpuLaunch.H>
+#include <AMReX_GpuMemory.H>
 #include <AMReX_MFIter.H>
 #include <AMReX_MultiFab.H>
 
@@ -22,8 +25,297 @@
 
 using namespace amrex;
 
+/* The stencil is the tensor product of the 1D stencils of each direction, so it is applied
+ * as one 1D pass per direction (separable filter): on CPU, the passes of a tile (MFIter
+ * tiling) are done in small buffers that stay in cache; on GPU (CUDA/HIP), each block loads
+ * a tile of the source and its halo to shared memory once and does the passes there, so
+ * that each point is read and written once in global memory. */
+
+/* \brief Stencils along the three directions of the arrays (i,j,k), i.e. with the
+ *  z stencil along j in 2D and along i in 1D; nullptr along the directions without filter */
+GpuArray<Real const*,3>
+Filter::ArrayStencils () const
+{
+#if defined(WARPX_DIM_3D)
+    return {stencil_x.data(), stencil_y.data(), stencil_z.data()};
+#elif defined(WARPX_DIM_XZ) || defined(WARPX_DIM_RZ)
+    return {stencil_x.data(), stencil_z.data(), nullptr};
+#else
+    return {stencil_z.data(), nullptr, nullptr};
+#endif
+}
+
 #ifdef AMREX_USE_GPU
 
+namespace
+{
+    /* Direct application of the full stencil, one thread per cell and per component (with
+     * SYCL, and if the halo of the tiles of the shared-memory kernel is too large) */
+    void DoFilterDirect (const Box& tbx,
+                         Array4<Real const> const& src,
+                         Array4<Real      > const& dst,
+                         int scomp, int dcomp, int ncomp,
+                         GpuArray<Real const*,3> const& s, Dim3 const slen_local)
+    {
+#if (AMREX_SPACEDIM >= 2)
+        amrex::Real const* AMREX_RESTRICT sx = s[0];
+#endif
+#if defined(WARPX_DIM_3D)
+        amrex::Real const* AMREX_RESTRICT sy = s[1];
+        amrex::Real const* AMREX_RESTRICT sz = s[2];
+#elif defined(WARPX_DIM_XZ) || defined(WARPX_DIM_RZ)
+        amrex::Real const* AMREX_RESTRICT sz = s[1];
+#else
+        amrex::Real const* AMREX_RESTRICT sz = s[0];
+#endif
+
+#if defined(WARPX_DIM_3D)
+        AMREX_PARALLEL_FOR_4D ( tbx, ncomp, i, j, k, n,
+        {
+            Real d = 0.0;
+
+            // Pad source array with zeros beyond ghost cells
+            // for out-of-bound accesses due to large-stencil operations
+            const auto src_zeropad = [src] (const int jj, const int kk, const int ll, const int nn) noexcept
+            {
+                return src.contains(jj,kk,ll) ? src(jj,kk,ll,nn) : 0.0_rt;
+            };
+
+            for         (int iz=0; iz < slen_local.z; ++iz){
+                for     (int iy=0; iy < slen_local.y; ++iy){
+                    for (int ix=0; ix < slen_local.x; ++ix){
+                        Real sss = sx[ix]*sy[iy]*sz[iz];
+                        d += sss*( src_zeropad(i-ix,j-iy,k-iz,scomp+n)
+                                  +src_zeropad(i+ix,j-iy,k-iz,scomp+n)
+                                  +src_zeropad(i-ix,j+iy,k-iz,scomp+n)
+                                  +src_zeropad(i+ix,j+iy,k-iz,scomp+n)
+                                  +src_zeropad(i-ix,j-iy,k+iz,scomp+n)
+                                  +src_zeropad(i+ix,j-iy,k+iz,scomp+n)
+                                  +src_zeropad(i-ix,j+iy,k+iz,scomp+n)
+                                  +src_zeropad(i+ix,j+iy,k+iz,scomp+n));
+                    }
+                }
+            }
+
+            dst(i,j,k,dcomp+n) = d;
+        });
+#elif defined(WARPX_DIM_XZ) || defined(WARPX_DIM_RZ)
+        AMREX_PARALLEL_FOR_4D ( tbx, ncomp, i, j, k, n,
+        {
+            Real d = 0.0;
+
+            // Pad source array with zeros beyond ghost cells
+            // for out-of-bound accesses due to large-stencil operations
+            const auto src_zeropad = [src] (const int jj, const int kk, const int ll, const int nn) noexcept
+            {
+                return src.contains(jj,kk,ll) ? src(jj,kk,ll,nn) : 0.0_rt;
+            };
+
+            for         (int iz=0; iz < slen_local.z; ++iz){
+                for     (int iy=0; iy < slen_local.y; ++iy){
+                    for (int ix=0; ix < slen_local.x; ++ix){
+                        Real sss = sx[ix]*sz[iy];
+                        d += sss*( src_zeropad(i-ix,j-iy,k,scomp+n)
+                                  +src_zeropad(i+ix,j-iy,k,scomp+n)
+                                  +src_zeropad(i-ix,j+iy,k,scomp+n)
+                                  +src_zeropad(i+ix,j+iy,k,scomp+n));
+                    }
+                }
+            }
+
+            dst(i,j,k,dcomp+n) = d;
+        });
+#elif defined(WARPX_DIM_1D_Z)
+        AMREX_PARALLEL_FOR_4D ( tbx, ncomp, i, j, k, n,
+        {
+            Real d = 0.0;
+
+            // Pad source array with zeros beyond ghost cells
+            // for out-of-bound accesses due to large-stencil operations
+            const auto src_zeropad = [src] (const int jj, const int kk, const int ll, const int nn) noexcept
+            {
+                return src.contains(jj,kk,ll) ? src(jj,kk,ll,nn) : 0.0_rt;
+            };
+
+            for (int ix=0; ix < slen_local.x; ++ix){
+                Real sss = sz[ix];
+                d += sss*( src_zeropad(i-ix,j,k,scomp+n)
+                          +src_zeropad(i+ix,j,k,scomp+n));
+            }
+
+            dst(i,j,k,dcomp+n) = d;
+        });
+#else
+        amrex::Abort("Filter not implemented for the current geometry!");
+#endif
+    }
+
+#if defined(AMREX_USE_CUDA) || defined(AMREX_USE_HIP)
+    // Output cells of the tile of one block of the shared-memory kernel
+#   if defined(WARPX_DIM_3D)
+    constexpr int tile_x = 16, tile_y = 8, tile_z = 4;
+#   elif defined(WARPX_DIM_XZ) || defined(WARPX_DIM_RZ)
+    constexpr int tile_x = 32, tile_y = 16, tile_z = 1;
+#   else
+    constexpr int tile_x = 512, tile_y = 1, tile_z = 1;
+#   endif
+    constexpr int filter_nthreads = 256;
+
+    /** Fab filtered by the shared-memory kernel: one block per tile and per component */
+    struct FilterTask
+    {
+        Array4<Real const> src;
+        Array4<Real> dst;
+        Box bx;
+        int scomp, dcomp;
+        Dim3 ntiles;  //!< number of tiles of bx along each direction
+        int nblocks;  //!< number of tiles times number of components
+    };
+
+    FilterTask MakeFilterTask (const Box& tbx, Array4<Real const> const& src,
+                               Array4<Real> const& dst, int scomp, int dcomp, int ncomp)
+    {
+        FilterTask task;
+        task.src = src;
+        task.dst = dst;
+        task.bx = tbx;
+        task.scomp = scomp;
+        task.dcomp = dcomp;
+        const IntVect len = tbx.length();
+        task.ntiles.x = (len[0] + tile_x - 1) / tile_x;
+#   if (AMREX_SPACEDIM >= 2)
+        task.ntiles.y = (len[1] + tile_y - 1) / tile_y;
+#   else
+        task.ntiles.y = 1;
+#   endif
+#   if defined(WARPX_DIM_3D)
+        task.ntiles.z = (len[2] + tile_z - 1) / tile_z;
+#   else
+        task.ntiles.z = 1;
+#   endif
+        task.nblocks = (tbx.ok()) ? task.ntiles.x*task.ntiles.y*task.ntiles.z*ncomp : 0;
+        return task;
+    }
+
+    /* Apply the separable stencil to the (at most 3) tasks in one launch. Return false,
+     * without launching, if the tile and its halo do not fit in the shared memory. */
+    bool LaunchTiledFilter (const FilterTask* tasks, const int ntasks,
+                            GpuArray<Real const*,3> const& s, Dim3 const& slen)
+    {
+        AMREX_ALWAYS_ASSERT(ntasks <= 3);
+        // Halo of the tiles; the first pass is done on the halo of the other directions,
+        // the second pass is stored in place of the input
+        const Dim3 h = {slen.x-1, slen.y-1, slen.z-1};
+        const int na_max = (tile_x+2*h.x)*(tile_y+2*h.y)*(tile_z+2*h.z);
+        const int nb_max = tile_x*(tile_y+2*h.y)*(tile_z+2*h.z);
+        const std::size_t shared_bytes = (na_max + nb_max)*sizeof(Real);
+        if (shared_bytes > Gpu::Device::sharedMemPerBlock()) return false;
+
+        GpuArray<FilterTask,3> task_arr;
+        int nblocks = 0;
+        for (int it = 0; it < ntasks; ++it) {
+            task_arr[it] = tasks[it];
+            nblocks += tasks[it].nblocks;
+        }
+        if (nblocks == 0) return true;
+        const Dim3 tile = {tile_x, tile_y, tile_z};
+
+        amrex::launch(nblocks, filter_nthreads, shared_bytes, Gpu::gpuStream(),
+        [=] AMREX_GPU_DEVICE () noexcept
+        {
+            Gpu::SharedMemory<Real> gsm;
+            Real* const sa = gsm.dataPtr();
+            Real* const sb = sa + na_max;
+
+            const int tid = threadIdx.x;
+            const int nthreads = blockDim.x;
+
+            // Task, component and tile of the block
+            int ib = blockIdx.x;
+            int it = 0;
+            while (ib >= task_arr[it].nblocks) {
+                ib -= task_arr[it].nblocks;
+                ++it;
+            }
+            FilterTask const& task = task_arr[it];
+            const int ntiles = task.ntiles.x*task.ntiles.y*task.ntiles.z;
+            const int n = ib / ntiles;
+            const Dim3 blo = amrex::lbound(task.bx);
+            const Dim3 bhi = amrex::ubound(task.bx);
+            const int itile = ib - n*ntiles;
+            const int lo_i = blo.x + tile.x*(itile % task.ntiles.x);
+            const int lo_j = blo.y + tile.y*((itile / task.ntiles.x) % task.ntiles.y);
+            const int lo_k = blo.z + tile.z*(itile / (task.ntiles.x*task.ntiles.y));
+            const int nx = amrex::min(tile.x, bhi.x - lo_i + 1);
+            const int ny = amrex::min(tile.y, bhi.y - lo_j + 1);
+            const int nz = amrex::min(tile.z, bhi.z - lo_k + 1);
+            const int ax = nx + 2*h.x;
+            const int ay = ny + 2*h.y;
+            const int az = nz + 2*h.z;
+
+            // Load the tile and its halo; pad the source array with zeros beyond its box
+            Array4<Real const> const& src = task.src;
+            const int scomp = task.scomp + n;
+            for (int m = tid; m < ax*ay*az; m += nthreads) {
+                const int i = lo_i - h.x + m % ax;
+                const int j = lo_j - h.y + (m / ax) % ay;
+                const int k = lo_k - h.z + m / (ax*ay);
+                sa[m] = src.contains(i,j,k) ? src(i,j,k,scomp) : 0.0_rt;
+            }
+            __syncthreads();
+
+            // First direction, from sa to sb, on the halo of the other directions
+            Real const* AMREX_RESTRICT s0 = s[0];
+            for (int m = tid; m < nx*ay*az; m += nthreads) {
+                const int a = m % nx;
+                const int bc = m / nx; // (b,c) index of the row
+                Real const* p = sa + bc*ax + a + h.x;
+                Real d = 0.0;
+                for (int t = 0; t < slen.x; ++t) d += s0[t]*(p[-t] + p[t]);
+                sb[m] = d;
+            }
+            __syncthreads();
+
+            // Second direction, from sb to sa, on the halo of the third direction
+            Real const* AMREX_RESTRICT s1 = s[1];
+            for (int m = tid; m < nx*ny*az; m += nthreads) {
+                const int a = m % nx;
+                const int b = (m / nx) % ny;
+                const int c = m / (nx*ny);
+                Real const* p = sb + (c*ay + b + h.y)*nx + a;
+                Real d = 0.0;
+                if (s1) {
+                    for (int t = 0; t < slen.y; ++t) d += s1[t]*(p[-t*nx] + p[t*nx]);
+                } else {
+                    d = p[0];
+                }
+                sa[m] = d;
+            }
+            __syncthreads();
+
+            // Third direction, from sa to the destination
+            Real const* AMREX_RESTRICT s2 = s[2];
+            Array4<Real> const& dst = task.dst;
+            const int dcomp = task.dcomp + n;
+            for (int m = tid; m < nx*ny*nz; m += nthreads) {
+                const int a = m % nx;
+                const int b = (m / nx) % ny;
+                const int c = m / (nx*ny);
+                Real const* p = sa + ((c + h.z)*ny + b)*nx + a;
+                Real d = 0.0;
+                if (s2) {
+                    for (int t = 0; t < slen.z; ++t) d += s2[t]*(p[-t*nx*ny] + p[t*nx*ny]);
+                } else {
+                    d = p[0];
+                }
+                dst(lo_i+a, lo_j+b, lo_k+c, dcomp) = d;
+            }
+        });
+        return true;
+    }
+#endif
+}
+
 /* \brief Apply stencil on MultiFab (GPU version, 2D/3D).
  * \param dstmf Destination MultiFab
  * \param srcmf source MultiFab
@@ -64,6 +356,53 @@ Filter::ApplyStencil (MultiFab& dstmf, const MultiFab& srcmf, const int lev, int
     }
 }
 
+/* \brief Apply stencil on the three MultiFabs of a vector field (GPU version, 2D/3D),
+ *  with one kernel launch per box for the three MultiFabs and all their components.
+ * \param dstmf Destination MultiFabs
+ * \param srcmf source MultiFabs
+ * \param[in] lev mesh refinement level
+ */
+void
+Filter::ApplyStencil (const std::array<MultiFab*,3>& dstmf,
+                      const std::array<const MultiFab*,3>& srcmf, const int lev)
+{
+    WARPX_PROFILE("Filter::ApplyStencil(vector MultiFab)");
+
+    amrex::LayoutData<amrex::Real>* cost = WarpX::getCosts(lev);
+
+    for (MFIter mfi(*dstmf[0]); mfi.isValid(); ++mfi)
+    {
+        if (cost && WarpX::load_balance_costs_update_algo == LoadBalanceCostsUpdateAlgo::Timers)
+        {
+            amrex::Gpu::synchronize();
+        }
+        amrex::Real wt = amrex::second();
+
+#if defined(AMREX_USE_CUDA) || defined(AMREX_USE_HIP)
+        FilterTask tasks[3];
+        for (int idim = 0; idim < 3; ++idim) {
+            tasks[idim] = MakeFilterTask((*dstmf[idim])[mfi].box(), srcmf[idim]->const_array(mfi),
+                                         dstmf[idim]->array(mfi), 0, 0, srcmf[idim]->nComp());
+        }
+        if (!LaunchTiledFilter(tasks, 3, ArrayStencils(), slen))
+#endif
+        {
+            for (int idim = 0; idim < 3; ++idim) {
+                DoFilterDirect((*dstmf[idim])[mfi].box(), srcmf[idim]->const_array(mfi),
+                               dstmf[idim]->array(mfi), 0, 0, srcmf[idim]->nComp(),
+                               ArrayStencils(), slen);
+            }
+        }
+
+        if (cost && WarpX::load_balance_costs_update_algo == LoadBalanceCostsUpdateAlgo::Timers)
+        {
+            amrex::Gpu::synchronize();
+            wt = amrex::second() - wt;
+            amrex::HostDevice::Atomic::Add( &(*cost)[mfi.index()], wt);
+        }
+    }
+}
+
 /* \brief Apply stencil on FArrayBox (GPU version, 2D/3D).
  * \param dstfab Destination FArrayBox
  * \param srcmf source FArrayBox
@@ -92,102 +431,46 @@ void Filter::DoFilter (const Box& tbx,
                        Array4<Real      > const& dst,
                        int scomp, int dcomp, int ncomp)
 {
-#if (AMREX_SPACEDIM >= 2)
-    amrex::Real const* AMREX_RESTRICT sx = stencil_x.data();
-#endif
-#if defined(WARPX_DIM_3D)
-    amrex::Real const* AMREX_RESTRICT sy = stencil_y.data();
+#if defined(AMREX_USE_CUDA) || defined(AMREX_USE_HIP)
+    const FilterTask task = MakeFilterTask(tbx, src, dst, scomp, dcomp, ncomp);
+    if (LaunchTiledFilter(&task, 1, ArrayStencils(), slen)) return;
 #endif
-    amrex::Real const* AMREX_RESTRICT sz = stencil_z.data();
-    Dim3 slen_local = slen;
-
-#if defined(WARPX_DIM_3D)
-    AMREX_PARALLEL_FOR_4D ( tbx, ncomp, i, j, k, n,
-    {
-        Real d = 0.0;
+    DoFilterDirect(tbx, src, dst, scomp, dcomp, ncomp, ArrayStencils(), slen);
+}
 
-        // Pad source array with zeros beyond ghost cells
-        // for out-of-bound accesses due to large-stencil operations
-        const auto src_zeropad = [src] (const int jj, const int kk, const int ll, const int nn) noexcept
-        {
-            return src.contains(jj,kk,ll) ? src(jj,kk,ll,nn) : 0.0_rt;
-        };
-
-        for         (int iz=0; iz < slen_local.z; ++iz){
-            for     (int iy=0; iy < slen_local.y; ++iy){
-                for (int ix=0; ix < slen_local.x; ++ix){
-                    Real sss = sx[ix]*sy[iy]*sz[iz];
-                    d += sss*( src_zeropad(i-ix,j-iy,k-iz,scomp+n)
-                              +src_zeropad(i+ix,j-iy,k-iz,scomp+n)
-                              +src_zeropad(i-ix,j+iy,k-iz,scomp+n)
-                              +src_zeropad(i+ix,j+iy,k-iz,scomp+n)
-                              +src_zeropad(i-ix,j-iy,k+iz,scomp+n)
-                              +src_zeropad(i+ix,j-iy,k+iz,scomp+n)
-                              +src_zeropad(i-ix,j+iy,k+iz,scomp+n)
-                              +src_zeropad(i+ix,j+iy,k+iz,scomp+n));
-                }
-            }
-        }
+#else
 
-        dst(i,j,k,dcomp+n) = d;
-    });
-#elif defined(WARPX_DIM_XZ) || defined(WARPX_DIM_RZ)
-    AMREX_PARALLEL_FOR_4D ( tbx, ncomp, i, j, k, n,
+namespace
+{
+    /* One pass of the separable filter along the direction dir of the arrays: component
+     * ocomp of out on bx = sum_t s[t] (in(x-t) + in(x+t)), with in the component icomp */
+    void FilterPass (const Box& bx, Array4<Real const> const& in, const int icomp,
+                     Array4<Real> const& out, const int ocomp,
+                     amrex::Real const* AMREX_RESTRICT s, const int len, const int dir)
     {
-        Real d = 0.0;
-
-        // Pad source array with zeros beyond ghost cells
-        // for out-of-bound accesses due to large-stencil operations
-        const auto src_zeropad = [src] (const int jj, const int kk, const int ll, const int nn) noexcept
-        {
-            return src.contains(jj,kk,ll) ? src(jj,kk,ll,nn) : 0.0_rt;
-        };
-
-        for         (int iz=0; iz < slen_local.z; ++iz){
-            for     (int iy=0; iy < slen_local.y; ++iy){
-                for (int ix=0; ix < slen_local.x; ++ix){
-                    Real sss = sx[ix]*sz[iy];
-                    d += sss*( src_zeropad(i-ix,j-iy,k,scomp+n)
-                              +src_zeropad(i+ix,j-iy,k,scomp+n)
-                              +src_zeropad(i-ix,j+iy,k,scomp+n)
-                              +src_zeropad(i+ix,j+iy,k,scomp+n));
+        const auto lo = amrex::lbound(bx);
+        const auto hi = amrex::ubound(bx);
+        const int di = (dir == 0) ? 1 : 0;
+        const int dj = (dir == 1) ? 1 : 0;
+        const int dk = (dir == 2) ? 1 : 0;
+        for     (int k = lo.z; k <= hi.z; ++k) {
+            for (int j = lo.y; j <= hi.y; ++j) {
+                AMREX_PRAGMA_SIMD
+                for (int i = lo.x; i <= hi.x; ++i) {
+                    out(i,j,k,ocomp) = 0.0;
                 }
-            }
-        }
-
-        dst(i,j,k,dcomp+n) = d;
-    });
-#elif defined(WARPX_DIM_1D_Z)
-    AMREX_PARALLEL_FOR_4D ( tbx, ncomp, i, j, k, n,
-    {
-        Real d = 0.0;
-
-        // Pad source array with zeros beyond ghost cells
-        // for out-of-bound accesses due to large-stencil operations
-        const auto src_zeropad = [src] (const int jj, const int kk, const int ll, const int nn) noexcept
-        {
-            return src.contains(jj,kk,ll) ? src(jj,kk,ll,nn) : 0.0_rt;
-        };
-
-        for         (int iz=0; iz < slen_local.z; ++iz){
-            for     (int iy=0; iy < slen_local.y; ++iy){
-                for (int ix=0; ix < slen_local.x; ++ix){
-                    Real sss = sz[iy];
-                    d += sss*( src_zeropad(i-ix,j,k,scomp+n)
-                              +src_zeropad(i+ix,j,k,scomp+n));
+                for (int t = 0; t < len; ++t) {
+                    AMREX_PRAGMA_SIMD
+                    for (int i = lo.x; i <= hi.x; ++i) {
+                        out(i,j,k,ocomp) += s[t]*(in(i-t*di,j-t*dj,k-t*dk,icomp)
+                                                 +in(i+t*di,j+t*dj,k+t*dk,icomp));
+                    }
                 }
             }
         }
-
-        dst(i,j,k,dcomp+n) = d;
-    });
-#else
-    amrex::Abort("Filter not implemented for the current geometry!");
-#endif
+    }
 }
 
-#else
-
 /* \brief Apply stencil on MultiFab (CPU version, 2D/3D).
  * \param dstmf Destination MultiFab
  * \param srcmf source MultiFab
@@ -209,7 +492,7 @@ Filter::ApplyStencil (amrex::MultiFab& dstmf, const amrex::MultiFab& srcmf, cons
 #pragma omp parallel
 #endif
     {
-        FArrayBox tmpfab;
+        FArrayBox tmpfab, buf1, buf2;
         for (MFIter mfi(dstmf,true); mfi.isValid(); ++mfi){
 
             if (cost && WarpX::load_balance_costs_update_algo == LoadBalanceCostsUpdateAlgo::Timers)
@@ -229,7 +512,7 @@ Filter::ApplyStencil (amrex::MultiFab& dstmf, const amrex::MultiFab& srcmf, cons
             const Box& ibx = gbx & srcfab.box();
             tmpfab.copy(srcfab, ibx, scomp, ibx, 0, ncomp);
             // Apply filter
-            DoFilter(tbx, tmpfab.array(), dstfab.array(), 0, dcomp, ncomp);
+            DoSeparableFilter(tbx, tmpfab.array(), dstfab.array(), 0, dcomp, ncomp, buf1, buf2);
 
             if (cost && WarpX::load_balance_costs_update_algo == LoadBalanceCostsUpdateAlgo::Timers)
             {
@@ -241,6 +524,20 @@ Filter::ApplyStencil (amrex::MultiFab& dstmf, const amrex::MultiFab& srcmf, cons
     }
 }
 
+/* \brief Apply stencil on the three MultiFabs of a vector field (CPU version, 2D/3D).
+ * \param dstmf Destination MultiFabs
+ * \param srcmf source MultiFabs
+ * \param[in] lev mesh refinement level
+ */
+void
+Filter::ApplyStencil (const std::array<MultiFab*,3>& dstmf,
+                      const std::array<const MultiFab*,3>& srcmf, const int lev)
+{
+    for (int idim = 0; idim < 3; ++idim) {
+        ApplyStencil(*dstmf[idim], *srcmf[idim], lev);
+    }
+}
+
 /* \brief Apply stencil on FArrayBox (CPU version, 2D/3D).
  * \param dstfab Destination FArrayBox
  * \param srcmf source FArrayBox
@@ -272,67 +569,44 @@ void Filter::DoFilter (const Box& tbx,
                        Array4<Real      > const& dst,
                        int scomp, int dcomp, int ncomp)
 {
-    const auto lo = amrex::lbound(tbx);
-    const auto hi = amrex::ubound(tbx);
-    // tmp and dst are of type Array4 (Fortran ordering)
+    FArrayBox buf1, buf2;
+    DoSeparableFilter(tbx, tmp, dst, scomp, dcomp, ncomp, buf1, buf2);
+}
+
+void Filter::DoSeparableFilter (const Box& tbx,
+                                Array4<Real const> const& tmp,
+                                Array4<Real      > const& dst,
+                                int scomp, int dcomp, int ncomp,
+                                FArrayBox& buf1, FArrayBox& buf2)
+{
+    // tmp and dst are of type Array4 (Fortran ordering); tmp covers tbx and the halo
+    // of the stencil. The first passes are done on tbx grown by the halo of the
+    // directions of the next passes.
+    const GpuArray<Real const*,3> s = ArrayStencils();
 #if (AMREX_SPACEDIM >= 2)
-    amrex::Real const* AMREX_RESTRICT sx = stencil_x.data();
+    const Box bx1 = amrex::grow(tbx, IntVect(AMREX_D_DECL(0, slen.y-1, slen.z-1)));
+    buf1.resize(bx1, 1);
 #endif
 #if defined(WARPX_DIM_3D)
-    amrex::Real const* AMREX_RESTRICT sy = stencil_y.data();
-#endif
-    amrex::Real const* AMREX_RESTRICT sz = stencil_z.data();
-    for (int n = 0; n < ncomp; ++n) {
-        // Set dst value to 0.
-        for         (int k = lo.z; k <= hi.z; ++k) {
-            for     (int j = lo.y; j <= hi.y; ++j) {
-                for (int i = lo.x; i <= hi.x; ++i) {
-                    dst(i,j,k,dcomp+n) = 0.0;
-                }
-            }
-        }
-        // 3 nested loop on 3D stencil
-        for         (int iz=0; iz < slen.z; ++iz){
-            for     (int iy=0; iy < slen.y; ++iy){
-                for (int ix=0; ix < slen.x; ++ix){
-#if defined(WARPX_DIM_3D)
-                    Real sss = sx[ix]*sy[iy]*sz[iz];
-#elif defined(WARPX_DIM_XZ) || defined(WARPX_DIM_RZ)
-                    Real sss = sx[ix]*sz[iy];
+    const Box bx2 = amrex::grow(tbx, IntVect(AMREX_D_DECL(0, 0, slen.z-1)));
+    buf2.resize(bx2, 1);
 #else
-                    Real sss = sz[ix];
+    amrex::ignore_unused(buf2);
 #endif
-                    // 3 nested loop on 3D array
-                    for         (int k = lo.z; k <= hi.z; ++k) {
-                        for     (int j = lo.y; j <= hi.y; ++j) {
-                            AMREX_PRAGMA_SIMD
-                            for (int i = lo.x; i <= hi.x; ++i) {
+    for (int n = 0; n < ncomp; ++n) {
 #if defined(WARPX_DIM_3D)
-                                dst(i,j,k,dcomp+n) += sss*(tmp(i-ix,j-iy,k-iz,scomp+n)
-                                                          +tmp(i+ix,j-iy,k-iz,scomp+n)
-                                                          +tmp(i-ix,j+iy,k-iz,scomp+n)
-                                                          +tmp(i+ix,j+iy,k-iz,scomp+n)
-                                                          +tmp(i-ix,j-iy,k+iz,scomp+n)
-                                                          +tmp(i+ix,j-iy,k+iz,scomp+n)
-                                                          +tmp(i-ix,j+iy,k+iz,scomp+n)
-                                                          +tmp(i+ix,j+iy,k+iz,scomp+n));
+        FilterPass(bx1, tmp, scomp+n, buf1.array(), 0, s[0], slen.x, 0);
+        FilterPass(bx2, buf1.const_array(), 0, buf2.array(), 0, s[1], slen.y, 1);
+        FilterPass(tbx, buf2.const_array(), 0, dst, dcomp+n, s[2], slen.z, 2);
 #elif defined(WARPX_DIM_XZ) || defined(WARPX_DIM_RZ)
-                                dst(i,j,k,dcomp+n) += sss*(tmp(i-ix,j-iy,k,scomp+n)
-                                                          +tmp(i+ix,j-iy,k,scomp+n)
-                                                          +tmp(i-ix,j+iy,k,scomp+n)
-                                                          +tmp(i+ix,j+iy,k,scomp+n));
+        FilterPass(bx1, tmp, scomp+n, buf1.array(), 0, s[0], slen.x, 0);
+        FilterPass(tbx, buf1.const_array(), 0, dst, dcomp+n, s[1], slen.y, 1);
 #elif defined(WARPX_DIM_1D_Z)
-                                dst(i,j,k,dcomp+n) += sss*(tmp(i-ix,j,k,scomp+n)
-                                                          +tmp(i+ix,j,k,scomp+n));
+        amrex::ignore_unused(buf1);
+        FilterPass(tbx, tmp, scomp+n, dst, dcomp+n, s[0], slen.x, 0);
 #else
-    amrex::Abort("Filter not implemented for the current geometry!");
+        amrex::Abort("Filter not implemented for the current geometry!");
 #endif
-                            }
-                        }
-                    }
-                }
-            }
-        }
     }
 }
 
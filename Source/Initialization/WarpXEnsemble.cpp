@@ -0,0 +1,144 @@
+/* This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+#include "Initialization/WarpXEnsemble.H"
+
+#include "Utils/TextMsg.H"
+
+#include <AMReX_BLassert.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Print.H>
+
+#include <algorithm>
+
+namespace
+{
+    //! Prefixes of the parameters that are read once, before the first member, and thus
+    //! cannot be varied by the members
+    const std::vector<std::string> fixed_prefixes = {"geometry.", "boundary.", "amrex."};
+    const std::vector<std::string> fixed_parameters = {"warpx.gamma_boost",
+                                                       "warpx.boost_direction"};
+}
+
+int
+WarpXEnsemble::NumGroups ()
+{
+    amrex::ParmParse pp_ensemble("ensemble");
+    int num_groups = 1;
+    pp_ensemble.query("num_concurrent", num_groups);
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(num_groups >= 1,
+        "ensemble.num_concurrent must be at least 1");
+    return num_groups;
+}
+
+WarpXEnsemble::WarpXEnsemble (int group)
+    : m_num_groups(NumGroups()), m_group(group)
+{
+    AMREX_ALWAYS_ASSERT(m_group >= 0 && m_group < m_num_groups);
+    amrex::ParmParse pp_ensemble("ensemble");
+    if (!pp_ensemble.queryarr("parameters", m_parameters)) {
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(m_num_groups == 1,
+            "ensemble.num_concurrent requires ensemble.parameters");
+        return;
+    }
+    pp_ensemble.get("num_members", m_num_members);
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(m_num_members >= 1,
+        "ensemble.num_members must be at least 1");
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(m_num_groups <= m_num_members,
+        "ensemble.num_concurrent must not exceed ensemble.num_members");
+
+    for (const auto& key : m_parameters) {
+        const bool fixed =
+            std::any_of(fixed_prefixes.begin(), fixed_prefixes.end(),
+                        [&key](const std::string& prefix){ return key.rfind(prefix, 0) == 0; })
+            || std::find(fixed_parameters.begin(), fixed_parameters.end(), key)
+               != fixed_parameters.end();
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(!fixed,
+            "ensemble.parameters: " + key + " is the same for all the members of the ensemble");
+        for (int member = 0; member < m_num_members; ++member) {
+            amrex::ParmParse pp_member("ensemble.member" + std::to_string(member));
+            WARPX_ALWAYS_ASSERT_WITH_MESSAGE(pp_member.contains(key.c_str()),
+                "ensemble.member" + std::to_string(member) + "." + key + " is not defined");
+        }
+    }
+}
+
+std::vector<int>
+WarpXEnsemble::GroupMembers () const
+{
+    std::vector<int> members;
+    for (int member = m_group; member < m_num_members; member += m_num_groups) {
+        members.push_back(member);
+    }
+    return members;
+}
+
+void
+WarpXEnsemble::SetMember (int member)
+{
+    if (!IsEnsemble()) return;
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(member >= 0 && member < m_num_members,
+        "Member " + std::to_string(member) + " is not in the ensemble");
+
+    amrex::Print() << Utils::TextMsg::Info(
+        "Ensemble: running member " + std::to_string(member) + " of " + std::to_string(m_num_members)
+        + (m_num_groups > 1 ? " in group " + std::to_string(m_group) : ""));
+
+    // Replace the varied parameters by the values of the member
+    amrex::ParmParse pp;
+    amrex::ParmParse pp_member("ensemble.member" + std::to_string(member));
+    for (const auto& key : m_parameters) {
+        std::vector<std::string> values;
+        pp_member.getarr(key.c_str(), values);
+        pp.remove(key.c_str());
+        pp.addarr(key.c_str(), values);
+    }
+
+    // Per-member outputs of the diagnostics (after the parameters, which may change them)
+    amrex::ParmParse pp_diagnostics("diagnostics");
+    std::vector<std::string> diags_names;
+    pp_diagnostics.queryarr("diags_names", diags_names);
+    for (const auto& diag : diags_names) {
+        SetOutputPath(diag + ".file_prefix", "diags/" + diag, false, member);
+        // Output windows with their own prefixes (the others derive it from the diagnostics)
+        amrex::ParmParse pp_diag(diag);
+        std::vector<std::string> windows;
+        pp_diag.queryarr("windows", windows);
+        for (const auto& window : windows) {
+            const std::string key = diag + "." + window + ".file_prefix";
+            if (pp.contains(key.c_str()) || m_output_paths.count(key) > 0) {
+                SetOutputPath(key, "", false, member);
+            }
+        }
+    }
+    amrex::ParmParse pp_warpx("warpx");
+    std::vector<std::string> rd_names;
+    pp_warpx.queryarr("reduced_diags_names", rd_names);
+    for (const auto& rd : rd_names) {
+        SetOutputPath(rd + ".path", "./diags/reducedfiles/", true, member);
+    }
+}
+
+void
+WarpXEnsemble::SetOutputPath (const std::string& key, const std::string& default_path,
+                              bool is_directory, int member)
+{
+    if (std::find(m_parameters.begin(), m_parameters.end(), key) != m_parameters.end()) return;
+
+    amrex::ParmParse pp;
+    if (m_output_paths.count(key) == 0) {
+        std::string path = default_path;
+        pp.query(key.c_str(), path);
+        m_output_paths[key] = path;
+    }
+    std::string path = m_output_paths[key];
+    if (is_directory) {
+        if (!path.empty() && path.back() != '/') path += '/';
+        path += "member" + std::to_string(member) + "/";
+    } else {
+        path += "_member" + std::to_string(member);
+    }
+    pp.remove(key.c_str());
+    pp.add(key.c_str(), path);
+}
@@ -18,6 +18,9 @@
 #include "Diagnostics/MultiDiagnostics.H"
 #include "Diagnostics/ReducedDiags/MultiReducedDiags.H"
 #include "FieldSolver/FiniteDifferenceSolver/MacroscopicProperties/MacroscopicProperties.H"
+#include "FieldSolver/LumpedElements.H"
+#include "FieldSolver/MagThinFilm.H"
+#include "FieldSolver/TFSFSource.H"
 #include "Filter/BilinearFilter.H"
 #include "Filter/NCIGodfreyFilter.H"
 #include "Particles/MultiParticleContainer.H"
@@ -57,12 +60,15 @@
 #include <AMReX_REAL.H>
 #include <AMReX_RealBox.H>
 #include <AMReX_SPACE.H>
+#include <AMReX_Utility.H>
 #include <AMReX_Vector.H>
 
 #include <algorithm>
 #include <array>
 #include <cctype>
+#include <iomanip>
 #include <iostream>
+#include <limits>
 #include <memory>
 #include <string>
 #include <utility>
@@ -354,6 +360,7 @@ WarpX::InitData ()
         InitFromCheckpoint();
         WarpX::PrintDtDxDyDz();
         PostRestart();
+        StartupPhaseEnd("checkpoint");
     }
 
     ComputeMaxStep();
@@ -369,12 +376,50 @@ WarpX::InitData ()
     }
 
     BuildBufferMasks();
+    StartupPhaseEnd("PML factors, filters, masks");
 
     if (WarpX::em_solver_medium==1) {
-        m_macroscopic_properties->InitData();
+        for (int lev = 0; lev <= finest_level; ++lev) {
+            m_macroscopic_properties[lev]->InitData(lev);
+        }
+        StartupPhaseEnd("macroscopic properties");
+    }
+
+#ifdef WARPX_MAG_LLG
+    InitGatherBfromHM();
+#endif
+
+    if (do_tfsf) {
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(maxwell_solver_id == MaxwellSolverAlgo::Yee,
+            "warpx.do_tfsf = 1 requires algo.maxwell_solver = yee");
+        m_tfsf = std::make_unique<TFSFSource>(Geom(0), gett_new(0));
     }
 
+    if (LumpedElements::InInput()) {
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(em_solver_medium == MediumForEM::Macroscopic && max_level == 0
+            && deep_halo_steps <= 1,
+            "lumped_elements.names requires algo.em_solver_medium = macroscopic, without mesh refinement "
+            "and warpx.deep_halo_steps");
+        m_lumped_elements = std::make_unique<LumpedElements>(Geom(0));
+    }
+
+#ifdef WARPX_MAG_LLG
+    if (MagThinFilm::InInput()) {
+#ifdef WARPX_DIM_3D
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(mag_LLG && max_level == 0,
+            "mag_thin_film.z requires warpx.mag_LLG = 1 without mesh refinement");
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(mag_time_scheme_order != 2 && mag_magnetostatic == 0 && m_mag_relax == 0,
+            "mag_thin_film.z is not compatible with warpx.mag_time_scheme_order = 2, warpx.mag_magnetostatic "
+            "and warpx.mag_relax");
+        m_mag_thin_film = std::make_unique<MagThinFilm>(Geom(0), boxArray(0), DistributionMap(0));
+#else
+        amrex::Abort(Utils::TextMsg::Err("mag_thin_film.z is only implemented in 3D"));
+#endif
+    }
+#endif
+
     InitDiagnostics();
+    StartupPhaseEnd("sources, diagnostics");
 
     if (ParallelDescriptor::IOProcessor()) {
         std::cout << "\nGrids Summary:\n";
@@ -389,9 +434,23 @@ WarpX::InitData ()
 
     if (restart_chkfile.empty())
     {
+        // static field of the boundary potentials and of the charges in the dielectric medium
+        if (m_init_static_E == 1) ComputeDielectricStaticField();
+
         // Loop through species and calculate their space-charge field
         bool const reset_fields = false; // Do not erase previous user-specified values on the grid
         ComputeSpaceChargeField(reset_fields);
+#ifdef WARPX_MAG_LLG
+        // demagnetizing field of the initial M
+        if (m_init_static_H == 1) {
+            WARPX_ALWAYS_ASSERT_WITH_MESSAGE(finest_level == 0,
+                "warpx.init_static_H = 1 is only implemented on a single level");
+        }
+        if (mag_magnetostatic == 1 || m_init_static_H == 1) ComputeMagnetostaticField();
+        // ground state of M, written by the diagnostics below
+        if (m_mag_relax == 1) RelaxMagnetization();
+#endif
+        StartupPhaseEnd("initial fields");
 
         // Write full diagnostics before the first iteration.
         multi_diags->FilterComputePackFlush( -1 );
@@ -402,11 +461,133 @@ WarpX::InitData ()
             reduced_diags->ComputeDiags(-1);
             reduced_diags->WriteToFile(-1);
         }
+        StartupPhaseEnd("initial diagnostics output");
     }
 
+    PrintStartupReport();
+    if (m_memory_report) PrintMemoryReport();
+
     PerformanceHints();
 }
 
+void
+WarpX::RewindFields (bool init_values)
+{
+    WARPX_PROFILE("WarpX::RewindFields()");
+
+    auto zero = [] (auto const& mfs) {
+        for (auto const& mf : mfs) { if (mf) mf->setVal(0.0); }
+    };
+    auto zero_scalar = [] (std::unique_ptr<amrex::MultiFab> const& mf) {
+        if (mf) mf->setVal(0.0);
+    };
+
+    for (int lev = 0; lev <= finest_level; ++lev)
+    {
+        zero(Efield_fp[lev]); zero(Efield_cp[lev]); zero(Efield_aux[lev]);
+        zero(Bfield_fp[lev]); zero(Bfield_cp[lev]); zero(Bfield_aux[lev]);
+        zero(Efield_avg_fp[lev]); zero(Efield_avg_cp[lev]);
+        zero(Bfield_avg_fp[lev]); zero(Bfield_avg_cp[lev]);
+        zero(current_fp[lev]); zero(current_cp[lev]); zero(current_store[lev]);
+        zero(current_buf[lev]); zero(current_fp_nodal[lev]); zero(current_fp_vay[lev]);
+        zero_scalar(rho_fp[lev]); zero_scalar(rho_cp[lev]); zero_scalar(charge_buf[lev]);
+        zero_scalar(phi_fp[lev]);
+        zero_scalar(F_fp[lev]); zero_scalar(F_cp[lev]);
+        zero_scalar(G_fp[lev]); zero_scalar(G_cp[lev]);
+#ifdef WARPX_MAG_LLG
+        zero(Hfield_fp[lev]); zero(Hfield_cp[lev]); zero(Hfield_aux[lev]);
+        zero(Mfield_fp[lev]); zero(Mfield_cp[lev]); zero(Mfield_aux[lev]);
+        zero(H_biasfield_fp[lev]); zero(H_biasfield_cp[lev]); zero(H_biasfield_aux[lev]);
+#endif
+        if (pml[lev]) pml[lev]->ResetFields();
+
+        istep[lev] = 0;
+        t_new[lev] = 0.0;
+        t_old[lev] = std::numeric_limits<Real>::lowest();
+
+        if (init_values) InitLevelData(lev, t_new[lev]);
+    }
+
+    if (WarpX::em_solver_medium == MediumForEM::Macroscopic) {
+        for (int lev = 0; lev <= finest_level; ++lev) {
+            m_macroscopic_properties[lev]->UpdateTimeDependentProperties(0, t_new[lev]);
+        }
+    }
+    if (do_tfsf) m_tfsf = std::make_unique<TFSFSource>(Geom(0), gett_new(0));
+    if (LumpedElements::InInput()) m_lumped_elements = std::make_unique<LumpedElements>(Geom(0));
+#if defined(WARPX_MAG_LLG) && defined(WARPX_DIM_3D)
+    if (MagThinFilm::InInput()) {
+        m_mag_thin_film = std::make_unique<MagThinFilm>(Geom(0), boxArray(0), DistributionMap(0));
+    }
+#endif
+
+    if (init_values)
+    {
+        if (m_init_static_E == 1) ComputeDielectricStaticField();
+#ifdef WARPX_MAG_LLG
+        if (mag_magnetostatic == 1 || m_init_static_H == 1) ComputeMagnetostaticField();
+#endif
+    }
+}
+
+void
+WarpX::StartupPhaseEnd (std::string const& name)
+{
+    if (m_startup_report < 1) return;
+
+    amrex::Gpu::synchronize();
+    amrex::Real const t = amrex::second();
+    m_startup_phase_names.push_back(name);
+    m_startup_phase_times.push_back(t - m_startup_phase_start_time);
+    m_startup_phase_start_time = t;
+}
+
+void
+WarpX::StartupPhaseDetail (std::string const& name, amrex::Real t_start)
+{
+    if (m_startup_report < 2) return;
+
+    amrex::Gpu::synchronize();
+    m_startup_phase_names.push_back("  " + name);
+    m_startup_phase_times.push_back(amrex::second() - t_start);
+}
+
+void
+WarpX::PrintStartupReport ()
+{
+    if (m_startup_report < 1) return;
+
+    // maximum and mean over the ranks: a large ratio points to a phase waiting on some ranks
+    int const nphases = static_cast<int>(m_startup_phase_times.size());
+    amrex::Vector<amrex::Real> t_max = m_startup_phase_times;
+    amrex::Vector<amrex::Real> t_mean = m_startup_phase_times;
+    amrex::Real t_total = amrex::second() - m_startup_start_time;
+    int const io_proc = ParallelDescriptor::IOProcessorNumber();
+    ParallelDescriptor::ReduceRealMax(t_max.data(), nphases, io_proc);
+    ParallelDescriptor::ReduceRealSum(t_mean.data(), nphases, io_proc);
+    ParallelDescriptor::ReduceRealMax(t_total, io_proc);
+    for (auto& t : t_mean) t /= ParallelDescriptor::NProcs();
+
+    // the phases of level 2 are details of the next phase of level 1, and are indented
+    std::stringstream ss;
+    ss << "\nStartup report (wall-clock time, s):\n"
+       << "  " << std::left << std::setw(32) << "phase" << std::right
+       << std::setw(12) << "max" << std::setw(12) << "mean" << std::setw(10) << "max/mean" << "\n";
+    for (int i = 0; i < nphases; ++i) {
+        ss << "  " << std::left << std::setw(32) << m_startup_phase_names[i] << std::right
+           << std::scientific << std::setprecision(3)
+           << std::setw(12) << t_max[i] << std::setw(12) << t_mean[i]
+           << std::fixed << std::setprecision(2)
+           << std::setw(10) << ((t_mean[i] > 0._rt) ? t_max[i] / t_mean[i] : 1._rt) << "\n";
+    }
+    ss << "  " << std::left << std::setw(32) << "total (since the parameters were read)"
+       << std::right << std::scientific << std::setprecision(3) << std::setw(12) << t_total << "\n\n";
+    amrex::Print() << ss.str();
+
+    m_startup_phase_names.clear();
+    m_startup_phase_times.clear();
+}
+
 void
 WarpX::InitDiagnostics () {
     multi_diags->InitData();
@@ -441,11 +622,14 @@ WarpX::InitFromScratch ()
     const Real time = 0.0;
 
     AmrCore::InitFromScratch(time);  // This will call MakeNewLevelFromScratch
+    StartupPhaseEnd("grids and fields");
 
     mypc->AllocData();
     mypc->InitData();
+    StartupPhaseEnd("particles");
 
     InitPML();
+    StartupPhaseEnd("PML");
 }
 
 void
@@ -481,36 +665,43 @@ WarpX::InitPML ()
 
         for (int lev = 1; lev <= finest_level; ++lev)
         {
-            do_pml_Lo[lev] = amrex::IntVect::TheUnitVector();
-            do_pml_Hi[lev] = amrex::IntVect::TheUnitVector();
-            // check if fine patch edges co-incide with domain boundary
-            amrex::Box levelBox = boxArray(lev).minimalBox();
-            // Domain box at level, lev
-            amrex::Box DomainBox = Geom(lev).Domain();
-            for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
-                if (levelBox.smallEnd(idim) == DomainBox.smallEnd(idim))
-                    do_pml_Lo[lev][idim] = do_pml_Lo[0][idim];
-                if (levelBox.bigEnd(idim) == DomainBox.bigEnd(idim))
-                    do_pml_Hi[lev][idim] = do_pml_Hi[0][idim];
-            }
+            InitPMLLevel(lev);
+        }
+    }
+}
+
+void
+WarpX::InitPMLLevel (int lev)
+{
+    // the levels advanced in lockstep have no PML at the coarse/fine boundary
+    do_pml_Lo[lev] = MRLockstep() ? amrex::IntVect(0) : amrex::IntVect::TheUnitVector();
+    do_pml_Hi[lev] = MRLockstep() ? amrex::IntVect(0) : amrex::IntVect::TheUnitVector();
+    // check if fine patch edges co-incide with domain boundary
+    amrex::Box levelBox = boxArray(lev).minimalBox();
+    // Domain box at level, lev
+    amrex::Box DomainBox = Geom(lev).Domain();
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        if (levelBox.smallEnd(idim) == DomainBox.smallEnd(idim))
+            do_pml_Lo[lev][idim] = do_pml_Lo[0][idim];
+        if (levelBox.bigEnd(idim) == DomainBox.bigEnd(idim))
+            do_pml_Hi[lev][idim] = do_pml_Hi[0][idim];
+    }
 
 #ifdef WARPX_DIM_RZ
-            //In cylindrical geometry, if the edge of the patch is at r=0, do not add PML
-            if ((max_level > 0) && (fine_tag_lo[0]==0.)) {
-                do_pml_Lo[lev][0] = 0;
-            }
-#endif
-            pml[lev] = std::make_unique<PML>(lev, boxArray(lev), DistributionMap(lev),
-                                   &Geom(lev), &Geom(lev-1),
-                                   pml_ncell, pml_delta, refRatio(lev-1),
-                                   dt[lev], nox_fft, noy_fft, noz_fft, do_nodal,
-                                   do_moving_window, pml_has_particles, do_pml_in_domain,
-                                   do_multi_J, do_pml_dive_cleaning, do_pml_divb_cleaning,
-                                   guard_cells.ng_FieldSolver.max(),
-                                   v_particle_pml,
-                                   do_pml_Lo[lev], do_pml_Hi[lev]);
-        }
+    //In cylindrical geometry, if the edge of the patch is at r=0, do not add PML
+    if ((max_level > 0) && (fine_tag_lo[0]==0.)) {
+        do_pml_Lo[lev][0] = 0;
     }
+#endif
+    pml[lev] = std::make_unique<PML>(lev, boxArray(lev), DistributionMap(lev),
+                           &Geom(lev), &Geom(lev-1),
+                           pml_ncell, pml_delta, refRatio(lev-1),
+                           dt[lev], nox_fft, noy_fft, noz_fft, do_nodal,
+                           do_moving_window, pml_has_particles, do_pml_in_domain,
+                           do_multi_J, do_pml_dive_cleaning, do_pml_divb_cleaning,
+                           guard_cells.ng_FieldSolver.max(),
+                           v_particle_pml,
+                           do_pml_Lo[lev], do_pml_Hi[lev]);
 }
 
 void
@@ -638,6 +829,54 @@ WarpX::InitFilter (){
     }
 }
 
+#ifdef WARPX_MAG_LLG
+void
+WarpX::InitGatherBfromHM ()
+{
+    m_gather_B_from_HM = false;
+#ifndef WARPX_DIM_RZ
+    if (!mag_LLG || mypc->nSpecies() == 0) return;
+
+    int gather_B_from_HM = 1;
+    const ParmParse pp_warpx("warpx");
+    pp_warpx.query("mag_gather_B_from_HM", gather_B_from_HM);
+    if (gather_B_from_HM == 0) return;
+
+    // B = mu0*(H + M) also outside of the magnetic materials only if mu = mu0 there, see
+    // FiniteDifferenceSolver::ComputeBfromHM
+    auto const& macroscopic_properties = *m_macroscopic_properties[0];
+    const bool vacuum_mu = macroscopic_properties.is_mu_uniform()
+                           && macroscopic_properties.getmu() == PhysConst::mu0;
+    // with cell-centered M, B on a face reads M in the next guard cell
+    const amrex::IntVect ng_M = Mfield_fp[0][0]->nGrowVect();
+    const bool enough_M_guards = (mag_M_collocated == 0) || ng_M.allGT(guard_cells.ng_FieldGather);
+    // the gather buffers, the NCI filter, the QED processes, the photons and the rigid-injected
+    // species read the stored B
+#ifdef WARPX_QED
+    const bool no_qed = false;
+#else
+    const bool no_qed = true;
+#endif
+    // the moment of a thin film is only added to the stored B, see MagThinFilm::AddToB. The
+    // momentum-conserving gather reads B at the nodes, and not at the faces where H and M are
+    const bool staggered_gather = (field_gathering_algo != GatheringAlgo::MomentumConserving);
+    m_gather_B_from_HM = vacuum_mu && enough_M_guards && no_qed && (max_level == 0) && staggered_gather
+                         && !use_fdtd_nci_corr && mypc->HasOnlyPhysicalSpecies() && !MagThinFilm::InInput();
+
+    if (m_gather_B_from_HM) {
+        amrex::Print() << Utils::TextMsg::Info(
+            "the particles gather B = mu0*(H + M) directly from H and M");
+    } else {
+        amrex::Print() << Utils::TextMsg::Info(
+            "the particles gather the stored B, computed from H and M every step: "
+            "warpx.mag_gather_B_from_HM requires mu = mu0 outside of the magnetic materials, "
+            "amr.max_level = 0, the energy-conserving gather, only plain species without NCI filter or QED, "
+            "and no mag_thin_film");
+    }
+#endif
+}
+#endif
+
 void
 WarpX::PostRestart ()
 {
@@ -661,7 +900,7 @@ WarpX::InitLevelData (int lev, Real /*time*/)
                    ::tolower);
 
 #ifdef WARPX_MAG_LLG
-    if (pp_warpx.query("B_ext_grid_init_style", B_ext_grid_s) ) {
+    if (mag_LLG && pp_warpx.query("B_ext_grid_init_style", B_ext_grid_s) ) {
         amrex::Abort("ERROR: Initialization of B field is not allowed in the LLG simulation! \nThe initial magnetic field must be H and M! \n");
     }
 #endif
@@ -775,41 +1014,43 @@ WarpX::InitLevelData (int lev, Real /*time*/)
         }
 
 #ifdef WARPX_MAG_LLG
-        if (M_ext_grid_s == "constant" || M_ext_grid_s == "default"){
-            // this if condition finds out if the user-input is constant
-            // if not, set initial value to default, default = 0.0
-
-            // Set the value of num_comp components in the valid region of
-            // each FAB in the FabArray, starting at component comp to val.
-            // Also set the value of nghost boundary cells.
-            // template <class F=FAB, class = typename std::enable_if<IsBaseFab<F>::value>::type >
-            // void setVal (value_type val,
-            //              int        comp,
-            //              int        num_comp,
-            //              int        nghost = 0);
-
-            int nghost = 1;
-            for (int icomp = 0; icomp < 3; ++icomp){ // icomp is the index of components at each i face
-                Mfield_fp[lev][i]->setVal(M_external_grid[icomp], icomp, 1, nghost);
+        if (mag_LLG) {
+            if (M_ext_grid_s == "constant" || M_ext_grid_s == "default"){
+                // this if condition finds out if the user-input is constant
+                // if not, set initial value to default, default = 0.0
+
+                // Set the value of num_comp components in the valid region of
+                // each FAB in the FabArray, starting at component comp to val.
+                // Also set the value of nghost boundary cells.
+                // template <class F=FAB, class = typename std::enable_if<IsBaseFab<F>::value>::type >
+                // void setVal (value_type val,
+                //              int        comp,
+                //              int        num_comp,
+                //              int        nghost = 0);
+
+                int nghost = 1;
+                for (int icomp = 0; icomp < 3; ++icomp){ // icomp is the index of components at each i face
+                    Mfield_fp[lev][i]->setVal(M_external_grid[icomp], icomp, 1, nghost);
+                }
             }
-        }
 
-        if (H_ext_grid_s == "constant" || H_ext_grid_s == "default") {
-           Hfield_fp[lev][i]->setVal(H_external_grid[i]);
-           if (lev > 0) {
-              Hfield_aux[lev][i]->setVal(H_external_grid[i]);
-              Hfield_cp[lev][i]->setVal(H_external_grid[i]);
-           }
-        }
+            if (H_ext_grid_s == "constant" || H_ext_grid_s == "default") {
+               Hfield_fp[lev][i]->setVal(H_external_grid[i]);
+               if (lev > 0) {
+                  Hfield_aux[lev][i]->setVal(H_external_grid[i]);
+                  Hfield_cp[lev][i]->setVal(H_external_grid[i]);
+               }
+            }
 
-        if (H_bias_ext_grid_s == "constant" || H_bias_ext_grid_s == "default") {
-           H_biasfield_fp[lev][i]->setVal(H_bias_external_grid[i]);
-           if (lev > 0) {
-              H_biasfield_aux[lev][i]->setVal(H_bias_external_grid[i]);
-              H_biasfield_cp[lev][i]->setVal(H_bias_external_grid[i]);
-           }
+            // a uniform H_bias (warpx.mag_H_bias_uniform = 1) is not stored on the grid
+            if ((H_bias_ext_grid_s == "constant" || H_bias_ext_grid_s == "default") && H_biasfield_fp[lev][i]) {
+               H_biasfield_fp[lev][i]->setVal(H_bias_external_grid[i]);
+               if (lev > 0) {
+                  H_biasfield_aux[lev][i]->setVal(H_bias_external_grid[i]);
+                  H_biasfield_cp[lev][i]->setVal(H_bias_external_grid[i]);
+               }
+            }
         }
-
 #endif
    }
 
@@ -951,173 +1192,174 @@ WarpX::InitLevelData (int lev, Real /*time*/)
     }
 
 #ifdef WARPX_MAG_LLG
-    // if the input string for the Hbias-field is "parse_h_bias_ext_grid_function",
-    // then the analytical expression or function must be
-    // provided in the input file.
-    if (H_bias_ext_grid_s == "parse_h_bias_ext_grid_function") {
+    if (mag_LLG) {
+        // if the input string for the Hbias-field is "parse_h_bias_ext_grid_function",
+        // then the analytical expression or function must be
+        // provided in the input file.
+        if (H_bias_ext_grid_s == "parse_h_bias_ext_grid_function") {
 
 #ifdef WARPX_DIM_RZ
-       amrex::Abort("H bias parser for external fields does not work with RZ -- TO DO");
+           amrex::Abort("H bias parser for external fields does not work with RZ -- TO DO");
 #endif
-       Store_parserString(pp_warpx, "Hx_bias_external_grid_function(x,y,z)",
-                                                    str_Hx_bias_ext_grid_function);
-       Store_parserString(pp_warpx, "Hy_bias_external_grid_function(x,y,z)",
-                                                    str_Hy_bias_ext_grid_function);
-       Store_parserString(pp_warpx, "Hz_bias_external_grid_function(x,y,z)",
-                                                    str_Hz_bias_ext_grid_function);
-
-       Hx_biasfield_parser = std::make_unique<amrex::Parser>(
-                                makeParser(str_Hx_bias_ext_grid_function,{"x","y","z"}));
-       Hy_biasfield_parser = std::make_unique<amrex::Parser>(
-                                makeParser(str_Hy_bias_ext_grid_function,{"x","y","z"}));
-       Hz_biasfield_parser = std::make_unique<amrex::Parser>(
-                                makeParser(str_Hz_bias_ext_grid_function,{"x","y","z"}));
-
-       // Initialize Efield_fp with external function
-       InitializeExternalFieldsOnGridUsingParser(H_biasfield_fp[lev][0].get(),
-                                                 H_biasfield_fp[lev][1].get(),
-                                                 H_biasfield_fp[lev][2].get(),
-                                                 Hx_biasfield_parser->compile<3>(),
-                                                 Hy_biasfield_parser->compile<3>(),
-                                                 Hz_biasfield_parser->compile<3>(),
-                                                 m_edge_lengths[lev],
-                                                 m_face_areas[lev],
-                                                 'H',
-                                                 lev);
-       if (lev > 0) {
-          InitializeExternalFieldsOnGridUsingParser(H_biasfield_aux[lev][0].get(),
-                                                    H_biasfield_aux[lev][1].get(),
-                                                    H_biasfield_aux[lev][2].get(),
-                                                    Hx_biasfield_parser->compile<3>(),
-                                                    Hy_biasfield_parser->compile<3>(),
-                                                    Hz_biasfield_parser->compile<3>(),
-                                                    m_edge_lengths[lev],
-                                                    m_face_areas[lev],
-                                                    'H',
-                                                    lev);
-
-          InitializeExternalFieldsOnGridUsingParser(H_biasfield_cp[lev][0].get(),
-                                                    H_biasfield_cp[lev][1].get(),
-                                                    H_biasfield_cp[lev][2].get(),
-                                                    Hx_biasfield_parser->compile<3>(),
-                                                    Hy_biasfield_parser->compile<3>(),
-                                                    Hz_biasfield_parser->compile<3>(),
-                                                    m_edge_lengths[lev],
-                                                    m_face_areas[lev],
-                                                    'H',
-                                                    lev);
-       }
-    }
+           Store_parserString(pp_warpx, "Hx_bias_external_grid_function(x,y,z)",
+                                                        str_Hx_bias_ext_grid_function);
+           Store_parserString(pp_warpx, "Hy_bias_external_grid_function(x,y,z)",
+                                                        str_Hy_bias_ext_grid_function);
+           Store_parserString(pp_warpx, "Hz_bias_external_grid_function(x,y,z)",
+                                                        str_Hz_bias_ext_grid_function);
+
+           Hx_biasfield_parser = std::make_unique<amrex::Parser>(
+                                    makeParser(str_Hx_bias_ext_grid_function,{"x","y","z"}));
+           Hy_biasfield_parser = std::make_unique<amrex::Parser>(
+                                    makeParser(str_Hy_bias_ext_grid_function,{"x","y","z"}));
+           Hz_biasfield_parser = std::make_unique<amrex::Parser>(
+                                    makeParser(str_Hz_bias_ext_grid_function,{"x","y","z"}));
+
+           // Initialize Efield_fp with external function
+           InitializeExternalFieldsOnGridUsingParser(H_biasfield_fp[lev][0].get(),
+                                                     H_biasfield_fp[lev][1].get(),
+                                                     H_biasfield_fp[lev][2].get(),
+                                                     Hx_biasfield_parser->compile<3>(),
+                                                     Hy_biasfield_parser->compile<3>(),
+                                                     Hz_biasfield_parser->compile<3>(),
+                                                     m_edge_lengths[lev],
+                                                     m_face_areas[lev],
+                                                     'H',
+                                                     lev);
+           if (lev > 0) {
+              InitializeExternalFieldsOnGridUsingParser(H_biasfield_aux[lev][0].get(),
+                                                        H_biasfield_aux[lev][1].get(),
+                                                        H_biasfield_aux[lev][2].get(),
+                                                        Hx_biasfield_parser->compile<3>(),
+                                                        Hy_biasfield_parser->compile<3>(),
+                                                        Hz_biasfield_parser->compile<3>(),
+                                                        m_edge_lengths[lev],
+                                                        m_face_areas[lev],
+                                                        'H',
+                                                        lev);
+
+              InitializeExternalFieldsOnGridUsingParser(H_biasfield_cp[lev][0].get(),
+                                                        H_biasfield_cp[lev][1].get(),
+                                                        H_biasfield_cp[lev][2].get(),
+                                                        Hx_biasfield_parser->compile<3>(),
+                                                        Hy_biasfield_parser->compile<3>(),
+                                                        Hz_biasfield_parser->compile<3>(),
+                                                        m_edge_lengths[lev],
+                                                        m_face_areas[lev],
+                                                        'H',
+                                                        lev);
+           }
+        }
 
-    if (H_ext_grid_s == "parse_h_ext_grid_function") {
+        if (H_ext_grid_s == "parse_h_ext_grid_function") {
 
 #ifdef WARPX_DIM_RZ
-       amrex::Abort("H parser for external fields does not work with RZ -- TO DO");
+           amrex::Abort("H parser for external fields does not work with RZ -- TO DO");
 #endif
-       Store_parserString(pp_warpx, "Hx_external_grid_function(x,y,z)",
-                                                    str_Hx_ext_grid_function);
-       Store_parserString(pp_warpx, "Hy_external_grid_function(x,y,z)",
-                                                    str_Hy_ext_grid_function);
-       Store_parserString(pp_warpx, "Hz_external_grid_function(x,y,z)",
-                                                    str_Hz_ext_grid_function);
-
-       Hxfield_parser = std::make_unique<amrex::Parser>(
-                                makeParser(str_Hx_ext_grid_function,{"x","y","z"}));
-       Hyfield_parser = std::make_unique<amrex::Parser>(
-                                makeParser(str_Hy_ext_grid_function,{"x","y","z"}));
-       Hzfield_parser = std::make_unique<amrex::Parser>(
-                                makeParser(str_Hz_ext_grid_function,{"x","y","z"}));
-
-       // Initialize Hfield_fp with external function
-       InitializeExternalFieldsOnGridUsingParser(Hfield_fp[lev][0].get(),
-                                                 Hfield_fp[lev][1].get(),
-                                                 Hfield_fp[lev][2].get(),
-                                                 Hxfield_parser->compile<3>(),
-                                                 Hyfield_parser->compile<3>(),
-                                                 Hzfield_parser->compile<3>(),
-                                                 m_edge_lengths[lev],
-                                                 m_face_areas[lev],
-                                                 'H',
-                                                 lev);
-       if (lev > 0) {
-          InitializeExternalFieldsOnGridUsingParser(Hfield_aux[lev][0].get(),
-                                                    Hfield_aux[lev][1].get(),
-                                                    Hfield_aux[lev][2].get(),
-                                                    Hxfield_parser->compile<3>(),
-                                                    Hyfield_parser->compile<3>(),
-                                                    Hzfield_parser->compile<3>(),
-                                                    m_edge_lengths[lev],
-                                                    m_face_areas[lev],
-                                                    'H',
-                                                    lev);
-
-          InitializeExternalFieldsOnGridUsingParser(Hfield_cp[lev][0].get(),
-                                                    Hfield_cp[lev][1].get(),
-                                                    Hfield_cp[lev][2].get(),
-                                                    Hxfield_parser->compile<3>(),
-                                                    Hyfield_parser->compile<3>(),
-                                                    Hzfield_parser->compile<3>(),
-                                                    m_edge_lengths[lev],
-                                                    m_face_areas[lev],
-                                                    'H',
-                                                    lev);
-       }
-    }
+           Store_parserString(pp_warpx, "Hx_external_grid_function(x,y,z)",
+                                                        str_Hx_ext_grid_function);
+           Store_parserString(pp_warpx, "Hy_external_grid_function(x,y,z)",
+                                                        str_Hy_ext_grid_function);
+           Store_parserString(pp_warpx, "Hz_external_grid_function(x,y,z)",
+                                                        str_Hz_ext_grid_function);
+
+           Hxfield_parser = std::make_unique<amrex::Parser>(
+                                    makeParser(str_Hx_ext_grid_function,{"x","y","z"}));
+           Hyfield_parser = std::make_unique<amrex::Parser>(
+                                    makeParser(str_Hy_ext_grid_function,{"x","y","z"}));
+           Hzfield_parser = std::make_unique<amrex::Parser>(
+                                    makeParser(str_Hz_ext_grid_function,{"x","y","z"}));
+
+           // Initialize Hfield_fp with external function
+           InitializeExternalFieldsOnGridUsingParser(Hfield_fp[lev][0].get(),
+                                                     Hfield_fp[lev][1].get(),
+                                                     Hfield_fp[lev][2].get(),
+                                                     Hxfield_parser->compile<3>(),
+                                                     Hyfield_parser->compile<3>(),
+                                                     Hzfield_parser->compile<3>(),
+                                                     m_edge_lengths[lev],
+                                                     m_face_areas[lev],
+                                                     'H',
+                                                     lev);
+           if (lev > 0) {
+              InitializeExternalFieldsOnGridUsingParser(Hfield_aux[lev][0].get(),
+                                                        Hfield_aux[lev][1].get(),
+                                                        Hfield_aux[lev][2].get(),
+                                                        Hxfield_parser->compile<3>(),
+                                                        Hyfield_parser->compile<3>(),
+                                                        Hzfield_parser->compile<3>(),
+                                                        m_edge_lengths[lev],
+                                                        m_face_areas[lev],
+                                                        'H',
+                                                        lev);
+
+              InitializeExternalFieldsOnGridUsingParser(Hfield_cp[lev][0].get(),
+                                                        Hfield_cp[lev][1].get(),
+                                                        Hfield_cp[lev][2].get(),
+                                                        Hxfield_parser->compile<3>(),
+                                                        Hyfield_parser->compile<3>(),
+                                                        Hzfield_parser->compile<3>(),
+                                                        m_edge_lengths[lev],
+                                                        m_face_areas[lev],
+                                                        'H',
+                                                        lev);
+           }
+        }
 
-    if (M_ext_grid_s == "parse_m_ext_grid_function") {
+        if (M_ext_grid_s == "parse_m_ext_grid_function") {
 #ifdef WARPX_DIM_RZ
-        amrex::Abort("M-field parser for external fields does not work with RZ");
+            amrex::Abort("M-field parser for external fields does not work with RZ");
 #endif
-        Store_parserString(pp_warpx, "Mx_external_grid_function(x,y,z)",
-                                                    str_Mx_ext_grid_function);
-        Store_parserString(pp_warpx, "My_external_grid_function(x,y,z)",
-                                                    str_My_ext_grid_function);
-        Store_parserString(pp_warpx, "Mz_external_grid_function(x,y,z)",
-                                                    str_Mz_ext_grid_function);
-
-        Mxfield_parser = std::make_unique<amrex::Parser>(
-                                 makeParser(str_Mx_ext_grid_function,{"x","y","z"}));
-        Myfield_parser = std::make_unique<amrex::Parser>(
-                                 makeParser(str_My_ext_grid_function,{"x","y","z"}));
-        Mzfield_parser = std::make_unique<amrex::Parser>(
-                                 makeParser(str_Mz_ext_grid_function,{"x","y","z"}));
-
-       // Initialize Mfield_fp with external function directly on the faces
-       InitializeExternalFieldsOnGridUsingParser(Mfield_fp[lev][0].get(),
-                                                 Mfield_fp[lev][1].get(),
-                                                 Mfield_fp[lev][2].get(),
-                                                 Mxfield_parser->compile<3>(),
-                                                 Myfield_parser->compile<3>(),
-                                                 Mzfield_parser->compile<3>(),
-                                                 m_edge_lengths[lev],
-                                                 m_face_areas[lev],
-                                                 'M',
-                                                 lev);
-       if (lev > 0) {
-          InitializeExternalFieldsOnGridUsingParser(Mfield_aux[lev][0].get(),
-                                                    Mfield_aux[lev][1].get(),
-                                                    Mfield_aux[lev][2].get(),
-                                                    Mxfield_parser->compile<3>(),
-                                                    Myfield_parser->compile<3>(),
-                                                    Mzfield_parser->compile<3>(),
-                                                    m_edge_lengths[lev],
-                                                    m_face_areas[lev],
-                                                    'M',
-                                                    lev);
-
-          InitializeExternalFieldsOnGridUsingParser(Mfield_cp[lev][0].get(),
-                                                    Mfield_cp[lev][1].get(),
-                                                    Mfield_cp[lev][2].get(),
-                                                    Mxfield_parser->compile<3>(),
-                                                    Myfield_parser->compile<3>(),
-                                                    Mzfield_parser->compile<3>(),
-                                                    m_edge_lengths[lev],
-                                                    m_face_areas[lev],
-                                                    'M',
-                                                    lev);
-       }
+            Store_parserString(pp_warpx, "Mx_external_grid_function(x,y,z)",
+                                                        str_Mx_ext_grid_function);
+            Store_parserString(pp_warpx, "My_external_grid_function(x,y,z)",
+                                                        str_My_ext_grid_function);
+            Store_parserString(pp_warpx, "Mz_external_grid_function(x,y,z)",
+                                                        str_Mz_ext_grid_function);
+
+            Mxfield_parser = std::make_unique<amrex::Parser>(
+                                     makeParser(str_Mx_ext_grid_function,{"x","y","z"}));
+            Myfield_parser = std::make_unique<amrex::Parser>(
+                                     makeParser(str_My_ext_grid_function,{"x","y","z"}));
+            Mzfield_parser = std::make_unique<amrex::Parser>(
+                                     makeParser(str_Mz_ext_grid_function,{"x","y","z"}));
+
+           // Initialize Mfield_fp with external function directly on the faces
+           InitializeExternalFieldsOnGridUsingParser(Mfield_fp[lev][0].get(),
+                                                     Mfield_fp[lev][1].get(),
+                                                     Mfield_fp[lev][2].get(),
+                                                     Mxfield_parser->compile<3>(),
+                                                     Myfield_parser->compile<3>(),
+                                                     Mzfield_parser->compile<3>(),
+                                                     m_edge_lengths[lev],
+                                                     m_face_areas[lev],
+                                                     'M',
+                                                     lev);
+           if (lev > 0) {
+              InitializeExternalFieldsOnGridUsingParser(Mfield_aux[lev][0].get(),
+                                                        Mfield_aux[lev][1].get(),
+                                                        Mfield_aux[lev][2].get(),
+                                                        Mxfield_parser->compile<3>(),
+                                                        Myfield_parser->compile<3>(),
+                                                        Mzfield_parser->compile<3>(),
+                                                        m_edge_lengths[lev],
+                                                        m_face_areas[lev],
+                                                        'M',
+                                                        lev);
+
+              InitializeExternalFieldsOnGridUsingParser(Mfield_cp[lev][0].get(),
+                                                        Mfield_cp[lev][1].get(),
+                                                        Mfield_cp[lev][2].get(),
+                                                        Mxfield_parser->compile<3>(),
+                                                        Myfield_parser->compile<3>(),
+                                                        Mzfield_parser->compile<3>(),
+                                                        m_edge_lengths[lev],
+                                                        m_face_areas[lev],
+                                                        'M',
+                                                        lev);
+           }
+        }
     }
-
 #endif //closes #ifdef WARPX_MAG_LLG
 
     if (F_fp[lev]) {
@@ -1153,51 +1395,6 @@ WarpX::InitLevelData (int lev, Real /*time*/)
     }
 }
 
-#ifdef WARPX_MAG_LLG
-void WarpX::AverageParsedMtoFaces(MultiFab& Mx_cc,
-                                  MultiFab& My_cc,
-                                  MultiFab& Mz_cc,
-                                  MultiFab& Mx_face,
-                                  MultiFab& My_face,
-                                  MultiFab& Mz_face)
-{
-    // average Mx, My, Mz to faces
-    for (MFIter mfi(Mx_face, TilingIfNotGPU()); mfi.isValid(); ++mfi) {
-        amrex::IntVect x_nodal_flag = Mx_face.ixType().toIntVect();
-        amrex::IntVect y_nodal_flag = My_face.ixType().toIntVect();
-        amrex::IntVect z_nodal_flag = Mz_face.ixType().toIntVect();
-        const amrex::Box& tbx = mfi.tilebox( x_nodal_flag, Mx_face.nGrowVect() );
-        const amrex::Box& tby = mfi.tilebox( y_nodal_flag, My_face.nGrowVect() );
-        const amrex::Box& tbz = mfi.tilebox( z_nodal_flag, Mz_face.nGrowVect() );
-
-        auto const& mx_cc = Mx_cc.array(mfi);
-        auto const& my_cc = My_cc.array(mfi);
-        auto const& mz_cc = Mz_cc.array(mfi);
-
-        auto const& mx_face = Mx_face.array(mfi);
-        auto const& my_face = My_face.array(mfi);
-        auto const& mz_face = Mz_face.array(mfi);
-
-        amrex::ParallelFor (tbx, tby, tbz,
-        [=] AMREX_GPU_DEVICE (int i, int j, int k) {
-            mx_face(i,j,k,0) = 0.5*(mx_cc(i-1,j,k) + mx_cc(i,j,k));
-            mx_face(i,j,k,1) = 0.5*(my_cc(i-1,j,k) + my_cc(i,j,k));
-            mx_face(i,j,k,2) = 0.5*(mz_cc(i-1,j,k) + mz_cc(i,j,k));
-        },
-        [=] AMREX_GPU_DEVICE (int i, int j, int k) {
-            my_face(i,j,k,0) = 0.5*(mx_cc(i,j-1,k) + mx_cc(i,j,k));
-            my_face(i,j,k,1) = 0.5*(my_cc(i,j-1,k) + my_cc(i,j,k));
-            my_face(i,j,k,2) = 0.5*(mz_cc(i,j-1,k) + mz_cc(i,j,k));
-        },
-        [=] AMREX_GPU_DEVICE (int i, int j, int k) {
-            mz_face(i,j,k,0) = 0.5*(mx_cc(i,j,k-1) + mx_cc(i,j,k));
-            mz_face(i,j,k,1) = 0.5*(my_cc(i,j,k-1) + my_cc(i,j,k));
-            mz_face(i,j,k,2) = 0.5*(mz_cc(i,j,k-1) + mz_cc(i,j,k));
-        });
-    }
-}
-#endif
-
 void
 WarpX::InitializeExternalFieldsOnGridUsingParser (
        MultiFab *mfx, MultiFab *mfy, MultiFab *mfz,
@@ -1208,8 +1405,12 @@ WarpX::InitializeExternalFieldsOnGridUsingParser (
        const char field,
        const int lev)
 {
+#if defined(WARPX_DIM_1D_Z)
     const auto dx_lev = geom[lev].CellSizeArray();
     const RealBox& real_box = geom[lev].ProbDomain();
+#else
+    const MeshCoordinates coords = GetMeshCoordinates(lev);
+#endif
     amrex::IntVect x_nodal_flag = mfx->ixType().toIntVect();
     amrex::IntVect y_nodal_flag = mfy->ixType().toIntVect();
     amrex::IntVect z_nodal_flag = mfz->ixType().toIntVect();
@@ -1267,18 +1468,13 @@ WarpX::InitializeExternalFieldsOnGridUsingParser (
                 amrex::Real fac_z = (1._rt - x_nodal_flag[1]) * dx_lev[1] * 0.5_rt;
                 amrex::Real z = j*dx_lev[1] + real_box.lo(1) + fac_z;
 #elif defined(WARPX_DIM_XZ) || defined(WARPX_DIM_RZ)
-                amrex::Real fac_x = (1._rt - x_nodal_flag[0]) * dx_lev[0] * 0.5_rt;
-                amrex::Real x = i*dx_lev[0] + real_box.lo(0) + fac_x;
+                amrex::Real x = coords(0, i, x_nodal_flag[0]);
                 amrex::Real y = 0._rt;
-                amrex::Real fac_z = (1._rt - x_nodal_flag[1]) * dx_lev[1] * 0.5_rt;
-                amrex::Real z = j*dx_lev[1] + real_box.lo(1) + fac_z;
+                amrex::Real z = coords(1, j, x_nodal_flag[1]);
 #else
-                amrex::Real fac_x = (1._rt - x_nodal_flag[0]) * dx_lev[0] * 0.5_rt;
-                amrex::Real x = i*dx_lev[0] + real_box.lo(0) + fac_x;
-                amrex::Real fac_y = (1._rt - x_nodal_flag[1]) * dx_lev[1] * 0.5_rt;
-                amrex::Real y = j*dx_lev[1] + real_box.lo(1) + fac_y;
-                amrex::Real fac_z = (1._rt - x_nodal_flag[2]) * dx_lev[2] * 0.5_rt;
-                amrex::Real z = k*dx_lev[2] + real_box.lo(2) + fac_z;
+                amrex::Real x = coords(0, i, x_nodal_flag[0]);
+                amrex::Real y = coords(1, j, x_nodal_flag[1]);
+                amrex::Real z = coords(2, k, x_nodal_flag[2]);
 #endif
 #ifdef WARPX_MAG_LLG
                 if (ncomp > 1) {
@@ -1309,18 +1505,13 @@ WarpX::InitializeExternalFieldsOnGridUsingParser (
                 amrex::Real fac_z = (1._rt - y_nodal_flag[1]) * dx_lev[1] * 0.5_rt;
                 amrex::Real z = j*dx_lev[1] + real_box.lo(1) + fac_z;
 #elif defined(WARPX_DIM_XZ) || defined(WARPX_DIM_RZ)
-                amrex::Real fac_x = (1._rt - y_nodal_flag[0]) * dx_lev[0] * 0.5_rt;
-                amrex::Real x = i*dx_lev[0] + real_box.lo(0) + fac_x;
+                amrex::Real x = coords(0, i, y_nodal_flag[0]);
                 amrex::Real y = 0._rt;
-                amrex::Real fac_z = (1._rt - y_nodal_flag[1]) * dx_lev[1] * 0.5_rt;
-                amrex::Real z = j*dx_lev[1] + real_box.lo(1) + fac_z;
+                amrex::Real z = coords(1, j, y_nodal_flag[1]);
 #elif defined(WARPX_DIM_3D)
-                amrex::Real fac_x = (1._rt - y_nodal_flag[0]) * dx_lev[0] * 0.5_rt;
-                amrex::Real x = i*dx_lev[0] + real_box.lo(0) + fac_x;
-                amrex::Real fac_y = (1._rt - y_nodal_flag[1]) * dx_lev[1] * 0.5_rt;
-                amrex::Real y = j*dx_lev[1] + real_box.lo(1) + fac_y;
-                amrex::Real fac_z = (1._rt - y_nodal_flag[2]) * dx_lev[2] * 0.5_rt;
-                amrex::Real z = k*dx_lev[2] + real_box.lo(2) + fac_z;
+                amrex::Real x = coords(0, i, y_nodal_flag[0]);
+                amrex::Real y = coords(1, j, y_nodal_flag[1]);
+                amrex::Real z = coords(2, k, y_nodal_flag[2]);
 #endif
 #ifdef WARPX_MAG_LLG
                 if (ncomp > 1) {
@@ -1350,18 +1541,13 @@ WarpX::InitializeExternalFieldsOnGridUsingParser (
                 amrex::Real fac_z = (1._rt - z_nodal_flag[1]) * dx_lev[1] * 0.5_rt;
                 amrex::Real z = j*dx_lev[1] + real_box.lo(1) + fac_z;
 #elif defined(WARPX_DIM_XZ) || defined(WARPX_DIM_RZ)
-                amrex::Real fac_x = (1._rt - z_nodal_flag[0]) * dx_lev[0] * 0.5_rt;
-                amrex::Real x = i*dx_lev[0] + real_box.lo(0) + fac_x;
+                amrex::Real x = coords(0, i, z_nodal_flag[0]);
                 amrex::Real y = 0._rt;
-                amrex::Real fac_z = (1._rt - z_nodal_flag[1]) * dx_lev[1] * 0.5_rt;
-                amrex::Real z = j*dx_lev[1] + real_box.lo(1) + fac_z;
+                amrex::Real z = coords(1, j, z_nodal_flag[1]);
 #elif defined(WARPX_DIM_3D)
-                amrex::Real fac_x = (1._rt - z_nodal_flag[0]) * dx_lev[0] * 0.5_rt;
-                amrex::Real x = i*dx_lev[0] + real_box.lo(0) + fac_x;
-                amrex::Real fac_y = (1._rt - z_nodal_flag[1]) * dx_lev[1] * 0.5_rt;
-                amrex::Real y = j*dx_lev[1] + real_box.lo(1) + fac_y;
-                amrex::Real fac_z = (1._rt - z_nodal_flag[2]) * dx_lev[2] * 0.5_rt;
-                amrex::Real z = k*dx_lev[2] + real_box.lo(2) + fac_z;
+                amrex::Real x = coords(0, i, z_nodal_flag[0]);
+                amrex::Real y = coords(1, j, z_nodal_flag[1]);
+                amrex::Real z = coords(2, k, z_nodal_flag[2]);
 #endif
 #ifdef WARPX_MAG_LLG
                 if (ncomp > 1) {
@@ -1496,7 +1682,7 @@ void WarpX::CheckGuardCells(amrex::MultiFab const& mf)
     }
 }
 
-void WarpX::InitializeEBGridData (int lev)
+void WarpX::InitializeEBGridData (int lev, bool data_redistributed)
 {
 #ifdef AMREX_USE_EB
     if (lev == maxLevel()) {
@@ -1511,9 +1697,10 @@ void WarpX::InitializeEBGridData (int lev)
                                 "particles are close to embedded boundaries");
         }
 
-        if (WarpX::maxwell_solver_id == MaxwellSolverAlgo::Yee ||
+        // the EB grid data only depends on the boxes and on the static EB geometry
+        if (!data_redistributed && (WarpX::maxwell_solver_id == MaxwellSolverAlgo::Yee ||
             WarpX::maxwell_solver_id == MaxwellSolverAlgo::CKC ||
-            WarpX::maxwell_solver_id == MaxwellSolverAlgo::ECT) {
+            WarpX::maxwell_solver_id == MaxwellSolverAlgo::ECT)) {
 
             auto const eb_fact = fieldEBFactory(lev);
 
@@ -1532,6 +1719,6 @@ void WarpX::InitializeEBGridData (int lev)
 
     }
 #else
-    amrex::ignore_unused(lev);
+    amrex::ignore_unused(lev, data_redistributed);
 #endif
 }
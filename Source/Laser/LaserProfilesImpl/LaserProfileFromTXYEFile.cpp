@@ -26,10 +26,20 @@
 #include <AMReX_REAL.H>
 #include <AMReX_Vector.H>
 
+#if defined(__unix__) || defined(__APPLE__)
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#   define WARPX_TXYE_USE_MMAP
+#endif
+
 #include <algorithm>
 #include <cmath>
 #include <cstdint>
+#include <cstring>
 #include <fstream>
+#include <future>
 #include <iterator>
 #include <limits>
 #include <string>
@@ -75,13 +85,28 @@ WarpXLaserProfiles::FromTXYEFileLaserProfile::init (
     //Reads the (optional) delay
     queryWithParser(ppl, "delay", m_params.t_delay);
 
+    //Prefetch of the next chunk and memory-mapped reads
+    ppl.query("txye_prefetch", m_prefetch.enabled);
+    ppl.query("txye_use_mmap", m_params.use_mmap);
+#ifndef WARPX_TXYE_USE_MMAP
+    if (m_params.use_mmap) {
+        WarpX::GetInstance().RecordWarning("Laser",
+            "txye_use_mmap is not supported on this platform: the file is read with streams");
+        m_params.use_mmap = false;
+    }
+#endif
+
     //Allocate memory for E_data Vector
     const int data_size = m_params.time_chunk_size*
             m_params.nx*m_params.ny;
     m_params.E_data.resize(data_size);
+    if (m_prefetch.enabled && m_params.time_chunk_size < m_params.nt) {
+        m_prefetch.h_E_data.resize(data_size);
+    }
 
     //Read first time chunck
     read_data_t_chuck(0, m_params.time_chunk_size);
+    start_prefetch();
 
     //Copy common params
     m_common_params = params;
@@ -99,10 +124,30 @@ WarpXLaserProfiles::FromTXYEFileLaserProfile::update (amrex::Real t)
     const auto idx_t_left = idx_times.first;
     const auto idx_t_right = idx_times.second;
 
+    //Broadcast the prefetched chunk once half of the chunk in memory was used,
+    //so that it is received before it is needed
+    if(m_prefetch.first_time_index >= 0 && !m_prefetch.bcast_posted &&
+       2*idx_t_right > m_params.first_time_index + m_params.last_time_index){
+        broadcast_prefetch();
+    }
+
     //Load data chunck if needed
     if(idx_t_right >  m_params.last_time_index){
-        read_data_t_chuck(idx_t_left, idx_t_left+m_params.time_chunk_size);
+        if(!swap_prefetch(idx_t_left)){
+            read_data_t_chuck(idx_t_left, idx_t_left+m_params.time_chunk_size);
+        }
+        start_prefetch();
+    }
+}
+
+WarpXLaserProfiles::FromTXYEFileLaserProfile::~FromTXYEFileLaserProfile ()
+{
+    if(m_prefetch.read_done.valid()) m_prefetch.read_done.wait();
+#ifdef AMREX_USE_MPI
+    if(m_prefetch.bcast_posted){
+        MPI_Wait(&m_prefetch.bcast_request, MPI_STATUS_IGNORE);
     }
+#endif
 }
 
 void
@@ -289,26 +334,7 @@ WarpXLaserProfiles::FromTXYEFileLaserProfile::read_data_t_chuck(int t_begin, int
     Vector<Real> h_E_data(m_params.E_data.size());
 
     if(ParallelDescriptor::IOProcessor()){
-        //Read data chunk
-        std::ifstream inp(m_params.txye_file_name, std::ios::binary);
-        if(!inp) Abort("Failed to open txye file");
-        inp.exceptions(std::ios_base::failbit | std::ios_base::badbit);
-
-        auto skip_amount = 1 +
-            3*sizeof(uint32_t) +
-            m_params.t_coords.size()*sizeof(double) +
-            m_params.h_x_coords.size()*sizeof(double) +
-            m_params.h_y_coords.size()*sizeof(double) +
-            sizeof(double)*t_begin*m_params.nx*m_params.ny;
-        inp.seekg(skip_amount);
-        if(!inp) Abort("Failed to read field data from txye file");
-        const int read_size = (i_last - i_first + 1)*
-            m_params.nx*m_params.ny;
-        Vector<double> buf_e(read_size);
-        inp.read(reinterpret_cast<char*>(buf_e.dataPtr()), read_size*sizeof(double));
-        if(!inp) Abort("Failed to read field data from txye file");
-        std::transform(buf_e.begin(), buf_e.end(), h_E_data.begin(),
-            [](auto x) {return static_cast<amrex::Real>(x);} );
+        read_file_data(i_first, i_last, h_E_data.dataPtr());
     }
 
     //Broadcast E_data
@@ -323,6 +349,132 @@ WarpXLaserProfiles::FromTXYEFileLaserProfile::read_data_t_chuck(int t_begin, int
     m_params.last_time_index = i_last;
 }
 
+void
+WarpXLaserProfiles::FromTXYEFileLaserProfile::read_file_data(
+    int i_first, int i_last, amrex::Real* h_E_data) const
+{
+    const auto data_offset = 1 +
+        3*sizeof(uint32_t) +
+        m_params.t_coords.size()*sizeof(double) +
+        m_params.h_x_coords.size()*sizeof(double) +
+        m_params.h_y_coords.size()*sizeof(double) +
+        sizeof(double)*i_first*m_params.nx*m_params.ny;
+    const int read_size = (i_last - i_first + 1)*
+        m_params.nx*m_params.ny;
+
+#ifdef WARPX_TXYE_USE_MMAP
+    if(m_params.use_mmap){
+        //Map the whole file: only the pages of the chunk are read from disk
+        const int fd = open(m_params.txye_file_name.c_str(), O_RDONLY);
+        if(fd < 0) Abort("Failed to open txye file");
+        struct stat file_stat;
+        if(fstat(fd, &file_stat) != 0 ||
+           static_cast<std::size_t>(file_stat.st_size) < data_offset + read_size*sizeof(double))
+            Abort("Failed to read field data from txye file");
+        void* const map = mmap(nullptr, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if(map == MAP_FAILED) Abort("Failed to map txye file");
+        const auto* const p_data = reinterpret_cast<const char*>(map) + data_offset;
+        for(int i = 0; i < read_size; ++i){
+            //The data may not be aligned in the file
+            double e;
+            std::memcpy(&e, p_data + i*sizeof(double), sizeof(double));
+            h_E_data[i] = static_cast<amrex::Real>(e);
+        }
+        munmap(map, file_stat.st_size);
+        return;
+    }
+#endif
+
+    std::ifstream inp(m_params.txye_file_name, std::ios::binary);
+    if(!inp) Abort("Failed to open txye file");
+    inp.exceptions(std::ios_base::failbit | std::ios_base::badbit);
+
+    inp.seekg(data_offset);
+    if(!inp) Abort("Failed to read field data from txye file");
+    Vector<double> buf_e(read_size);
+    inp.read(reinterpret_cast<char*>(buf_e.dataPtr()), read_size*sizeof(double));
+    if(!inp) Abort("Failed to read field data from txye file");
+    std::transform(buf_e.begin(), buf_e.end(), h_E_data,
+        [](auto x) {return static_cast<amrex::Real>(x);} );
+}
+
+void
+WarpXLaserProfiles::FromTXYEFileLaserProfile::start_prefetch()
+{
+    //The next chunk starts at the last timestep of the chunk in memory,
+    //which is the left timestep when the chunk in memory is exhausted
+    if(!m_prefetch.enabled || m_prefetch.h_E_data.empty() ||
+       m_params.last_time_index >= m_params.nt-1) return;
+
+    m_prefetch.first_time_index = m_params.last_time_index;
+    m_prefetch.last_time_index = min(
+        m_prefetch.first_time_index + m_params.time_chunk_size - 1, m_params.nt-1);
+    m_prefetch.bcast_posted = false;
+
+    if(ParallelDescriptor::IOProcessor()){
+        const int i_first = m_prefetch.first_time_index;
+        const int i_last = m_prefetch.last_time_index;
+        amrex::Real* const h_E_data = m_prefetch.h_E_data.dataPtr();
+        m_prefetch.read_done = std::async(std::launch::async,
+            [this, i_first, i_last, h_E_data](){ read_file_data(i_first, i_last, h_E_data); });
+    }
+}
+
+void
+WarpXLaserProfiles::FromTXYEFileLaserProfile::broadcast_prefetch()
+{
+    if(m_prefetch.read_done.valid()) m_prefetch.read_done.get();
+#ifdef AMREX_USE_MPI
+    const int read_size = (m_prefetch.last_time_index - m_prefetch.first_time_index + 1)*
+        m_params.nx*m_params.ny;
+    BL_MPI_REQUIRE(MPI_Ibcast(m_prefetch.h_E_data.dataPtr(), read_size,
+                              ParallelDescriptor::Mpi_typemap<Real>::type(),
+                              ParallelDescriptor::IOProcessorNumber(),
+                              ParallelDescriptor::Communicator(), &m_prefetch.bcast_request));
+#endif
+    m_prefetch.bcast_posted = true;
+}
+
+bool
+WarpXLaserProfiles::FromTXYEFileLaserProfile::swap_prefetch(int t_begin)
+{
+    if(m_prefetch.first_time_index < 0) return false;
+    const int first_time_index = m_prefetch.first_time_index;
+    m_prefetch.first_time_index = -1;
+    //All the ranks take the same decision, since they have the same time
+    const bool use_prefetch = (first_time_index == max(0, t_begin));
+
+    //Complete the read and the broadcast, which is only posted if the chunk is used
+    if(!m_prefetch.bcast_posted){
+        if(!use_prefetch){
+            if(m_prefetch.read_done.valid()) m_prefetch.read_done.get();
+            return false;
+        }
+        broadcast_prefetch();
+    }
+#ifdef AMREX_USE_MPI
+    BL_MPI_REQUIRE(MPI_Wait(&m_prefetch.bcast_request, MPI_STATUS_IGNORE));
+#endif
+    m_prefetch.bcast_posted = false;
+    if(!use_prefetch) return false;
+
+    amrex::Print() << Utils::TextMsg::Info(
+        "Using the prefetched [" + std::to_string(first_time_index) + ", " +
+        std::to_string(m_prefetch.last_time_index+1) + ") data chunk from " +
+        m_params.txye_file_name);
+
+    const auto read_size = static_cast<std::size_t>(
+        (m_prefetch.last_time_index - first_time_index + 1)*m_params.nx*m_params.ny);
+    Gpu::copyAsync(Gpu::hostToDevice, m_prefetch.h_E_data.begin(),
+                   m_prefetch.h_E_data.begin() + read_size, m_params.E_data.begin());
+    Gpu::synchronize();
+
+    m_params.first_time_index = first_time_index;
+    m_params.last_time_index = m_prefetch.last_time_index;
+    return true;
+}
+
 void
 WarpXLaserProfiles::FromTXYEFileLaserProfile::internal_fill_amplitude_uniform(
     const int idx_t_left,
@@ -19,6 +19,7 @@
 #include "Utils/WarpXAlgorithmSelection.H"
 #include "Utils/WarpXConst.H"
 #include "Utils/WarpXUtil.H"
+#include "WarpX.H"
 
 #include <AMReX_Config.H>
 #include <AMReX_INT.H>
@@ -53,11 +54,11 @@ guardCellManager::Init (
     const bool do_pml,
     const int do_pml_in_domain,
     const int pml_ncell,
-    const amrex::Vector<amrex::IntVect>& ref_ratios)
+    const amrex::Vector<amrex::IntVect>& ref_ratios,
+    const int deep_halo_steps,
+    const bool minimal_guard_cells,
+    const bool has_particles)
 {
-#ifdef WARPX_MAG_LLG
-    amrex::ignore_unused(do_multi_J, fft_do_time_averaging);
-#endif
     // When using subcycling, the particles on the fine level perform two pushes
     // before being redistributed ; therefore, we need one extra guard cell
     // (the particles may move by 2*c*dt)
@@ -65,6 +66,14 @@ guardCellManager::Init (
     int ngy_tmp = (max_level > 0 && do_subcycling == 1) ? nox+1 : nox;
     int ngz_tmp = (max_level > 0 && do_subcycling == 1) ? nox+1 : nox;
 
+    // With minimal guard cells and without particles, the guard cells of the fields are only
+    // read by the stencils of the solvers, which are accounted for below
+    if (minimal_guard_cells && !has_particles) {
+        ngx_tmp = 0;
+        ngy_tmp = 0;
+        ngz_tmp = 0;
+    }
+
     const bool galilean = (v_galilean[0] != 0. || v_galilean[1] != 0. || v_galilean[2] != 0.);
     const bool comoving = (v_comoving[0] != 0. || v_comoving[1] != 0. || v_comoving[2] != 0.);
 
@@ -82,13 +91,15 @@ guardCellManager::Init (
     // but different number of ghost cells in z-direction if NCI filter is used.
     // The number of cells should be even, in order to easily perform the
     // interpolation from coarse grid to fine grid.
-    int ngx = (ngx_tmp % 2) ? ngx_tmp+1 : ngx_tmp;  // Always even number
-    int ngy = (ngy_tmp % 2) ? ngy_tmp+1 : ngy_tmp;  // Always even number
-    int ngz_nonci = (ngz_tmp % 2) ? ngz_tmp+1 : ngz_tmp;  // Always even number
+    // With minimal guard cells, this is only done with mesh refinement.
+    const bool make_even = !minimal_guard_cells || max_level > 0;
+    int ngx = (make_even && ngx_tmp % 2) ? ngx_tmp+1 : ngx_tmp;  // Always even number
+    int ngy = (make_even && ngy_tmp % 2) ? ngy_tmp+1 : ngy_tmp;  // Always even number
+    int ngz_nonci = (make_even && ngz_tmp % 2) ? ngz_tmp+1 : ngz_tmp;  // Always even number
     int ngz;
     if (do_fdtd_nci_corr) {
         int ng = ngz_tmp + nci_corr_stencil;
-        ngz = (ng % 2) ? ng+1 : ng;
+        ngz = (make_even && ng % 2) ? ng+1 : ng;
     } else {
         ngz = ngz_nonci;
     }
@@ -98,6 +109,13 @@ guardCellManager::Init (
     int ngJx = ngx_tmp;
     int ngJy = ngy_tmp;
     int ngJz = ngz_tmp;
+    // Without particles, J is not deposited but its guard cells are still summed and
+    // exchanged by the current synchronization and filter
+    if (minimal_guard_cells && !has_particles) {
+        ngJx = 1;
+        ngJy = 1;
+        ngJz = 1;
+    }
 
     // When calling the moving window (with one level of refinement), we shift
     // the fine grid by a number of cells equal to the ref_ratio in the moving
@@ -136,8 +154,8 @@ guardCellManager::Init (
     // Electromagnetic simulations: account for change in particle positions within half a time step
     // for current deposition and within one time step for charge deposition (since rho is needed
     // both at the beginning and at the end of the PIC iteration)
-#ifndef WARPX_MAG_LLG
-    if (do_electrostatic == ElectrostaticSolverAlgo::None)
+    // (not with the LLG solver, warpx.mag_LLG)
+    if (do_electrostatic == ElectrostaticSolverAlgo::None && !WarpX::mag_LLG)
     {
         for (int i = 0; i < AMREX_SPACEDIM; i++)
         {
@@ -159,9 +177,6 @@ guardCellManager::Init (
             ng_alloc_J[i]   += static_cast<int>(std::ceil(PhysConst::c * dt_J / dx[i]));
         }
     }
-#else
-    amrex::ignore_unused(do_electrostatic, dt, dx);
-#endif
     // Number of guard cells for local deposition of J and rho
     ng_depos_J   = ng_alloc_J;
     ng_depos_rho = ng_alloc_Rho;
@@ -200,6 +215,15 @@ guardCellManager::Init (
         int ngFFt_z = (do_nodal || galilean) ? noz_fft : noz_fft / 2;
 
         ParmParse pp_psatd("psatd");
+        // With global FFTs (psatd.global_fft), the FFTs are not truncated at the box boundaries,
+        // so that the guard cells are not needed by the spectral solver
+        bool global_fft = false;
+        pp_psatd.query("global_fft", global_fft);
+        if (global_fft) {
+            ngFFt_x = 0;
+            ngFFt_y = 0;
+            ngFFt_z = 0;
+        }
         queryWithParser(pp_psatd, "nx_guard", ngFFt_x);
         queryWithParser(pp_psatd, "ny_guard", ngFFt_y);
         queryWithParser(pp_psatd, "nz_guard", ngFFt_z);
@@ -280,6 +304,14 @@ guardCellManager::Init (
     ng_alloc_F.max( ng_FieldSolverF );
     ng_alloc_G.max( ng_FieldSolverG );
 
+    // In the deep-halo mode, E and B are also updated in their guard cells, each update
+    // invalidating one more layer (two per step, after the first one), and only exchanged
+    // when no valid layer is left. J is read wherever E is updated.
+    if (deep_halo_steps > 1) {
+        ng_alloc_EB.max( IntVect(2*deep_halo_steps+1) );
+        ng_alloc_J.max( ng_alloc_EB );
+    }
+
     if (do_moving_window && maxwell_solver_id == MaxwellSolverAlgo::PSATD) {
         ng_afterPushPSATD = ng_alloc_EB;
     }
@@ -293,6 +325,7 @@ guardCellManager::Init (
         ng_FieldGather = ng_alloc_EB;
         ng_UpdateAux = ng_alloc_EB;
         ng_afterPushPSATD = ng_alloc_EB;
+        ng_LLG = ng_alloc_EB;
         if (do_moving_window){
             ng_MovingWindow = ng_alloc_EB;
         }
@@ -321,6 +354,12 @@ guardCellManager::Init (
         // for the field solve too.
         ng_FieldGather = ng_FieldGather.max(ng_FieldSolver);
 
+        // The LLG solver reads H and M one cell away from each face, in the
+        // interpolation of H to the M locations (face_avg_to_face) and in the
+        // Laplacian of the exchange coupling.
+        ng_LLG = IntVect(AMREX_D_DECL(1,1,1));
+        ng_LLG = ng_LLG.min(ng_alloc_EB);
+
         if (do_moving_window){
             ng_MovingWindow[moving_window_dir] = 1;
         }
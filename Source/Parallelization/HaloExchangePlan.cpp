@@ -0,0 +1,413 @@
+/* This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+#include "HaloExchangePlan.H"
+
+#include "Utils/TextMsg.H"
+
+#include <AMReX.H>
+#include <AMReX_Arena.H>
+#include <AMReX_Array4.H>
+#include <AMReX_Box.H>
+#include <AMReX_GpuContainers.H>
+#include <AMReX_GpuDevice.H>
+#include <AMReX_GpuLaunch.H>
+#include <AMReX_GpuQualifiers.H>
+#include <AMReX_ParallelDescriptor.H>
+
+#include <climits>
+#include <memory>
+
+using namespace amrex;
+
+namespace
+{
+    /** Append the tags of a map of tags per rank, and record for each rank the offset and size
+     *  (in number of Real) of its message, and for each tag its offset in the buffer */
+    std::size_t
+    FlattenTags (FabArrayBase::MapOfCopyComTagContainers const& tags_per_rank, int ncomp,
+                 Vector<FabArrayBase::CopyComTag>& tags, Vector<std::size_t>& tag_offsets,
+                 Vector<int>& ranks, Vector<std::size_t>& msg_offsets, Vector<std::size_t>& msg_sizes,
+                 bool use_sbox)
+    {
+        std::size_t size = 0;
+        for (auto const& kv : tags_per_rank) {
+            ranks.push_back(kv.first);
+            msg_offsets.push_back(size);
+            for (auto const& tag : kv.second) {
+                tags.push_back(tag);
+                tag_offsets.push_back(size);
+                size += static_cast<std::size_t>((use_sbox ? tag.sbox : tag.dbox).numPts()) * ncomp;
+            }
+            msg_sizes.push_back(size - msg_offsets.back());
+        }
+        return size;
+    }
+
+    /** Plans cached per BoxArray, DistributionMapping, number of components, number of guard
+     *  cells and periodicity, and not per MultiFab: the address of a temporary MultiFab may be
+     *  reused on some ranks only, which would build a plan (and draw a sequence number) on
+     *  these ranks only. The MultiFabs of the same layout share their plan. */
+    Vector<std::unique_ptr<HaloExchangePlan>> halo_exchange_plans;
+    bool clear_on_finalize_registered = false;
+
+#ifdef AMREX_USE_MPI
+    /** Communicator of the ranks of this node, and rank in it of each rank of the
+     *  communicator of AMReX (MPI_UNDEFINED for the ranks of the other nodes) */
+    MPI_Comm node_comm = MPI_COMM_NULL;
+    Vector<int> node_ranks;
+
+    void InitNodeCommunicator ()
+    {
+        if (node_comm != MPI_COMM_NULL) return;
+        MPI_Comm const comm = ParallelDescriptor::Communicator();
+        MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, ParallelDescriptor::MyProc(),
+                            MPI_INFO_NULL, &node_comm);
+        MPI_Group group, node_group;
+        MPI_Comm_group(comm, &group);
+        MPI_Comm_group(node_comm, &node_group);
+        const int nprocs = ParallelDescriptor::NProcs();
+        Vector<int> ranks(nprocs);
+        for (int r = 0; r < nprocs; ++r) ranks[r] = r;
+        node_ranks.resize(nprocs);
+        MPI_Group_translate_ranks(group, nprocs, ranks.data(), node_group, node_ranks.data());
+        MPI_Group_free(&group);
+        MPI_Group_free(&node_group);
+    }
+#endif
+}
+
+HaloExchangePlan::HaloExchangePlan (MultiFab const& mf, IntVect const& ng,
+                                    Periodicity const& period, bool shared_memory)
+    : m_ba(mf.boxArray()), m_dm(mf.DistributionMap()), m_ncomp(mf.nComp()), m_ng(ng),
+      m_period(period)
+{
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(ng.allLE(mf.nGrowVect()),
+        "HaloExchangePlan: more guard cells requested than allocated");
+
+    // The send tags of a rank to another one, and the receive tags of the other from the
+    // first, are sorted in the same order by AMReX, so the messages unpack consistently.
+    FabArrayBase::FB const& fb = mf.getFB(ng, period);
+
+    for (auto const& tag : *fb.m_LocTags) m_loc_tags.push_back(tag);
+
+    // the messages to and from the ranks of this node are set apart with shared memory
+    FabArrayBase::MapOfCopyComTagContainers snd_tags_mpi, rcv_tags_mpi, snd_tags_shm, rcv_tags_shm;
+#if defined(AMREX_USE_MPI) && !defined(AMREX_USE_GPU)
+    if (shared_memory) {
+        InitNodeCommunicator();
+        int node_size = 1;
+        MPI_Comm_size(node_comm, &node_size);
+        m_use_shm = (node_size > 1);
+    }
+#else
+    amrex::ignore_unused(shared_memory);
+#endif
+    for (auto const& kv : *fb.m_SndTags) {
+#ifdef AMREX_USE_MPI
+        if (m_use_shm && node_ranks[kv.first] != MPI_UNDEFINED) {
+            snd_tags_shm.insert(kv);
+            continue;
+        }
+#endif
+        snd_tags_mpi.insert(kv);
+    }
+    for (auto const& kv : *fb.m_RcvTags) {
+#ifdef AMREX_USE_MPI
+        if (m_use_shm && node_ranks[kv.first] != MPI_UNDEFINED) {
+            rcv_tags_shm.insert(kv);
+            continue;
+        }
+#endif
+        rcv_tags_mpi.insert(kv);
+    }
+
+    Vector<int> snd_ranks, rcv_ranks;
+    Vector<std::size_t> snd_offsets, rcv_offsets, snd_sizes, rcv_sizes;
+    m_snd_size = FlattenTags(snd_tags_mpi, m_ncomp, m_snd_tags, m_snd_tag_offsets,
+                             snd_ranks, snd_offsets, snd_sizes, true);
+    m_rcv_size = FlattenTags(rcv_tags_mpi, m_ncomp, m_rcv_tags, m_rcv_tag_offsets,
+                             rcv_ranks, rcv_offsets, rcv_sizes, false);
+
+#ifdef AMREX_USE_GPU
+    m_stage_on_host = !ParallelDescriptor::UseGpuAwareMpi();
+#endif
+    if (m_snd_size > 0) {
+        m_snd_buf = static_cast<Real*>(The_Arena()->alloc(m_snd_size*sizeof(Real)));
+        if (m_stage_on_host) {
+            m_snd_buf_host = static_cast<Real*>(The_Pinned_Arena()->alloc(m_snd_size*sizeof(Real)));
+        }
+    }
+    if (m_rcv_size > 0) {
+        m_rcv_buf = static_cast<Real*>(The_Arena()->alloc(m_rcv_size*sizeof(Real)));
+        if (m_stage_on_host) {
+            m_rcv_buf_host = static_cast<Real*>(The_Pinned_Arena()->alloc(m_rcv_size*sizeof(Real)));
+        }
+    }
+
+    // The tag must be drawn on all the ranks, including those without messages,
+    // to keep the sequence numbers consistent
+    const int mpi_tag = ParallelDescriptor::SeqNum();
+
+#ifdef AMREX_USE_MPI
+    MPI_Comm comm = ParallelDescriptor::Communicator();
+    MPI_Datatype const mpi_real = ParallelDescriptor::Mpi_typemap<Real>::type();
+    Real* const snd_base = m_stage_on_host ? m_snd_buf_host : m_snd_buf;
+    Real* const rcv_base = m_stage_on_host ? m_rcv_buf_host : m_rcv_buf;
+
+    m_snd_reqs.resize(snd_ranks.size());
+    for (int i = 0; i < snd_ranks.size(); ++i) {
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(snd_sizes[i] <= static_cast<std::size_t>(INT_MAX),
+            "HaloExchangePlan: message too large");
+        MPI_Send_init(snd_base + snd_offsets[i], static_cast<int>(snd_sizes[i]), mpi_real,
+                      snd_ranks[i], mpi_tag, comm, &m_snd_reqs[i]);
+    }
+    m_rcv_reqs.resize(rcv_ranks.size());
+    for (int i = 0; i < rcv_ranks.size(); ++i) {
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(rcv_sizes[i] <= static_cast<std::size_t>(INT_MAX),
+            "HaloExchangePlan: message too large");
+        MPI_Recv_init(rcv_base + rcv_offsets[i], static_cast<int>(rcv_sizes[i]), mpi_real,
+                      rcv_ranks[i], mpi_tag, comm, &m_rcv_reqs[i]);
+    }
+
+    if (m_use_shm) {
+        // segment of this rank, in two halves, and the offsets of the messages in it
+        Vector<int> shm_snd_ranks, shm_rcv_ranks;
+        Vector<std::size_t> shm_snd_offsets, shm_snd_sizes;
+        m_shm_size = FlattenTags(snd_tags_shm, m_ncomp, m_shm_snd_tags, m_shm_snd_tag_offsets,
+                                 shm_snd_ranks, shm_snd_offsets, shm_snd_sizes, true);
+        // the window is allocated by all the ranks of the node, even without messages
+        MPI_Win_allocate_shared(static_cast<MPI_Aint>(2*m_shm_size*sizeof(Real)), sizeof(Real),
+                                MPI_INFO_NULL, node_comm, &m_shm_buf, &m_shm_win);
+        MPI_Win_lock_all(MPI_MODE_NOCHECK, m_shm_win);
+
+        // each sender tells its receivers where their message starts in its segment
+        Vector<unsigned long long> snd_msg_offsets(shm_snd_offsets.begin(), shm_snd_offsets.end());
+        Vector<unsigned long long> rcv_msg_offsets(rcv_tags_shm.size());
+        Vector<MPI_Request> reqs;
+        for (auto const& kv : rcv_tags_shm) shm_rcv_ranks.push_back(kv.first);
+        for (int i = 0; i < shm_rcv_ranks.size(); ++i) {
+            reqs.emplace_back();
+            MPI_Irecv(&rcv_msg_offsets[i], 1, MPI_UNSIGNED_LONG_LONG, shm_rcv_ranks[i],
+                      mpi_tag, comm, &reqs.back());
+        }
+        for (int i = 0; i < shm_snd_ranks.size(); ++i) {
+            reqs.emplace_back();
+            MPI_Isend(&snd_msg_offsets[i], 1, MPI_UNSIGNED_LONG_LONG, shm_snd_ranks[i],
+                      mpi_tag, comm, &reqs.back());
+        }
+        MPI_Waitall(static_cast<int>(reqs.size()), reqs.data(), MPI_STATUSES_IGNORE);
+
+        // the tags of a message follow each other in the segment of the sender, as in FlattenTags
+        int i = 0;
+        for (auto const& kv : rcv_tags_shm) {
+            MPI_Aint seg_bytes;
+            int disp_unit;
+            Real* seg = nullptr;
+            MPI_Win_shared_query(m_shm_win, node_ranks[kv.first], &seg_bytes, &disp_unit, &seg);
+            std::size_t offset = rcv_msg_offsets[i++];
+            for (auto const& tag : kv.second) {
+                m_shm_rcv_tags.push_back(tag);
+                m_shm_rcv_tag_ptrs.push_back(seg + offset);
+                m_shm_rcv_half_sizes.push_back(static_cast<std::size_t>(seg_bytes) / (2*sizeof(Real)));
+                offset += static_cast<std::size_t>(tag.dbox.numPts()) * m_ncomp;
+            }
+        }
+    }
+#else
+    amrex::ignore_unused(mpi_tag);
+#endif
+}
+
+HaloExchangePlan::~HaloExchangePlan ()
+{
+#ifdef AMREX_USE_MPI
+    for (auto& req : m_snd_reqs) MPI_Request_free(&req);
+    for (auto& req : m_rcv_reqs) MPI_Request_free(&req);
+    if (m_shm_win != MPI_WIN_NULL) {
+        // collective over the node, as the construction
+        MPI_Win_unlock_all(m_shm_win);
+        MPI_Win_free(&m_shm_win);
+    }
+#endif
+    if (m_snd_buf) The_Arena()->free(m_snd_buf);
+    if (m_rcv_buf) The_Arena()->free(m_rcv_buf);
+    if (m_snd_buf_host) The_Pinned_Arena()->free(m_snd_buf_host);
+    if (m_rcv_buf_host) The_Pinned_Arena()->free(m_rcv_buf_host);
+}
+
+bool
+HaloExchangePlan::HasShape (IntVect const& ng, Periodicity const& period) const
+{
+    return ng == m_ng && period == m_period;
+}
+
+bool
+HaloExchangePlan::IsValidFor (MultiFab const& mf) const
+{
+    return mf.nComp() == m_ncomp && mf.boxArray() == m_ba && mf.DistributionMap() == m_dm;
+}
+
+void
+HaloExchangePlan::FillBoundary (MultiFab& mf)
+{
+    BL_PROFILE("HaloExchangePlan::FillBoundary");
+
+    const int ncomp = m_ncomp;
+
+#ifdef AMREX_USE_MPI
+    if (!m_rcv_reqs.empty()) {
+        MPI_Startall(static_cast<int>(m_rcv_reqs.size()), m_rcv_reqs.data());
+    }
+
+    // pack the send buffers, cells in the order of the boxes
+    for (int t = 0; t < m_snd_tags.size(); ++t) {
+        auto const& tag = m_snd_tags[t];
+        Array4<Real const> const src = mf.const_array(tag.srcIndex);
+        Real* const AMREX_RESTRICT buf = m_snd_buf + m_snd_tag_offsets[t];
+        const Dim3 lo = lbound(tag.sbox);
+        const Dim3 len = length(tag.sbox);
+        amrex::ParallelFor(tag.sbox, ncomp,
+            [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) noexcept
+            {
+                buf[((n*len.z + (k-lo.z))*len.y + (j-lo.y))*len.x + (i-lo.x)] = src(i,j,k,n);
+            });
+    }
+    if (!m_snd_reqs.empty()) {
+        if (m_stage_on_host) {
+            Gpu::dtoh_memcpy_async(m_snd_buf_host, m_snd_buf, m_snd_size*sizeof(Real));
+        }
+        Gpu::streamSynchronize();
+        MPI_Startall(static_cast<int>(m_snd_reqs.size()), m_snd_reqs.data());
+    }
+
+    // pack the intra-node messages into the current half of the segment of this rank
+    if (m_use_shm) {
+        Real* const half = m_shm_buf + m_shm_parity*m_shm_size;
+        for (int t = 0; t < m_shm_snd_tags.size(); ++t) {
+            auto const& tag = m_shm_snd_tags[t];
+            Array4<Real const> const src = mf.const_array(tag.srcIndex);
+            Real* const AMREX_RESTRICT buf = half + m_shm_snd_tag_offsets[t];
+            const Dim3 lo = lbound(tag.sbox);
+            const Dim3 len = length(tag.sbox);
+            amrex::ParallelFor(tag.sbox, ncomp,
+                [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) noexcept
+                {
+                    buf[((n*len.z + (k-lo.z))*len.y + (j-lo.y))*len.x + (i-lo.x)] = src(i,j,k,n);
+                });
+        }
+    }
+#endif
+
+    // local copies, overlapping the messages
+    for (auto const& tag : m_loc_tags) {
+        Array4<Real const> const src = mf.const_array(tag.srcIndex);
+        Array4<Real> const dst = mf.array(tag.dstIndex);
+        const IntVect shift = tag.sbox.smallEnd() - tag.dbox.smallEnd();
+#if defined(WARPX_DIM_3D)
+        const int si = shift[0], sj = shift[1], sk = shift[2];
+#elif defined(WARPX_DIM_XZ) || defined(WARPX_DIM_RZ)
+        const int si = shift[0], sj = shift[1], sk = 0;
+#else
+        const int si = shift[0], sj = 0, sk = 0;
+#endif
+        amrex::ParallelFor(tag.dbox, ncomp,
+            [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) noexcept
+            {
+                dst(i,j,k,n) = src(i+si,j+sj,k+sk,n);
+            });
+    }
+
+#ifdef AMREX_USE_MPI
+    // unpack the intra-node messages from the segments of their senders, once all the ranks of
+    // the node have packed theirs; the other half of the segments is packed by the next exchange,
+    // which the receivers of this one can only start after the next barrier
+    if (m_use_shm) {
+        MPI_Win_sync(m_shm_win);
+        MPI_Barrier(node_comm);
+        MPI_Win_sync(m_shm_win);
+        for (int t = 0; t < m_shm_rcv_tags.size(); ++t) {
+            auto const& tag = m_shm_rcv_tags[t];
+            Array4<Real> const dst = mf.array(tag.dstIndex);
+            Real const* const AMREX_RESTRICT buf = m_shm_rcv_tag_ptrs[t]
+                + m_shm_parity*m_shm_rcv_half_sizes[t];
+            const Dim3 lo = lbound(tag.dbox);
+            const Dim3 len = length(tag.dbox);
+            amrex::ParallelFor(tag.dbox, ncomp,
+                [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) noexcept
+                {
+                    dst(i,j,k,n) = buf[((n*len.z + (k-lo.z))*len.y + (j-lo.y))*len.x + (i-lo.x)];
+                });
+        }
+        m_shm_parity = 1 - m_shm_parity;
+    }
+
+    if (!m_rcv_reqs.empty()) {
+        MPI_Waitall(static_cast<int>(m_rcv_reqs.size()), m_rcv_reqs.data(), MPI_STATUSES_IGNORE);
+        if (m_stage_on_host) {
+            Gpu::htod_memcpy_async(m_rcv_buf, m_rcv_buf_host, m_rcv_size*sizeof(Real));
+        }
+    }
+
+    // unpack the receive buffers
+    for (int t = 0; t < m_rcv_tags.size(); ++t) {
+        auto const& tag = m_rcv_tags[t];
+        Array4<Real> const dst = mf.array(tag.dstIndex);
+        Real const* const AMREX_RESTRICT buf = m_rcv_buf + m_rcv_tag_offsets[t];
+        const Dim3 lo = lbound(tag.dbox);
+        const Dim3 len = length(tag.dbox);
+        amrex::ParallelFor(tag.dbox, ncomp,
+            [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) noexcept
+            {
+                dst(i,j,k,n) = buf[((n*len.z + (k-lo.z))*len.y + (j-lo.y))*len.x + (i-lo.x)];
+            });
+    }
+
+    if (!m_snd_reqs.empty()) {
+        MPI_Waitall(static_cast<int>(m_snd_reqs.size()), m_snd_reqs.data(), MPI_STATUSES_IGNORE);
+    }
+#endif
+
+    Gpu::streamSynchronize();
+}
+
+namespace WarpXCommUtil
+{
+
+void
+PersistentFillBoundary (MultiFab& mf, IntVect const& ng, Periodicity const& period,
+                        bool shared_memory)
+{
+    if (!clear_on_finalize_registered) {
+        // the MPI requests must be freed before MPI is finalized
+        amrex::ExecOnFinalize(ClearHaloExchangePlans);
+        clear_on_finalize_registered = true;
+    }
+
+    HaloExchangePlan* plan = nullptr;
+    for (auto const& p : halo_exchange_plans) {
+        if (p->HasShape(ng, period) && p->IsValidFor(mf)) {
+            plan = p.get();
+            break;
+        }
+    }
+    if (plan == nullptr) {
+        halo_exchange_plans.push_back(std::make_unique<HaloExchangePlan>(mf, ng, period, shared_memory));
+        plan = halo_exchange_plans.back().get();
+    }
+
+    plan->FillBoundary(mf);
+}
+
+void
+ClearHaloExchangePlans ()
+{
+    halo_exchange_plans.clear();
+#ifdef AMREX_USE_MPI
+    if (node_comm != MPI_COMM_NULL) MPI_Comm_free(&node_comm);
+    node_ranks.clear();
+#endif
+}
+
+}
@@ -0,0 +1,78 @@
+/* This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+#include "KernelGraph.H"
+
+#include <AMReX.H>
+#include <AMReX_GpuError.H>
+
+KernelGraph::~KernelGraph ()
+{
+    Clear();
+}
+
+bool
+KernelGraph::Supported ()
+{
+#if defined(AMREX_USE_CUDA) || defined(AMREX_USE_HIP)
+    return true;
+#else
+    return false;
+#endif
+}
+
+void
+KernelGraph::Clear ()
+{
+#if defined(AMREX_USE_CUDA)
+    if (m_exec) AMREX_CUDA_SAFE_CALL(cudaGraphExecDestroy(m_exec));
+#elif defined(AMREX_USE_HIP)
+    if (m_exec) AMREX_HIP_SAFE_CALL(hipGraphExecDestroy(m_exec));
+#endif
+#if defined(AMREX_USE_CUDA) || defined(AMREX_USE_HIP)
+    m_exec = nullptr;
+#endif
+    m_key.clear();
+    m_captured = false;
+}
+
+void
+KernelGraph::BeginCapture ()
+{
+    // the kernels launched before on the stream are not part of the graph
+#if defined(AMREX_USE_CUDA)
+    AMREX_CUDA_SAFE_CALL(cudaStreamBeginCapture(amrex::Gpu::gpuStream(),
+                                                cudaStreamCaptureModeRelaxed));
+#elif defined(AMREX_USE_HIP)
+    AMREX_HIP_SAFE_CALL(hipStreamBeginCapture(amrex::Gpu::gpuStream(),
+                                              hipStreamCaptureModeRelaxed));
+#endif
+}
+
+void
+KernelGraph::EndCapture ()
+{
+#if defined(AMREX_USE_CUDA)
+    cudaGraph_t graph;
+    AMREX_CUDA_SAFE_CALL(cudaStreamEndCapture(amrex::Gpu::gpuStream(), &graph));
+    AMREX_CUDA_SAFE_CALL(cudaGraphInstantiateWithFlags(&m_exec, graph, 0));
+    AMREX_CUDA_SAFE_CALL(cudaGraphDestroy(graph));
+#elif defined(AMREX_USE_HIP)
+    hipGraph_t graph;
+    AMREX_HIP_SAFE_CALL(hipStreamEndCapture(amrex::Gpu::gpuStream(), &graph));
+    AMREX_HIP_SAFE_CALL(hipGraphInstantiate(&m_exec, graph, nullptr, nullptr, 0));
+    AMREX_HIP_SAFE_CALL(hipGraphDestroy(graph));
+#endif
+    m_captured = true;
+}
+
+void
+KernelGraph::Launch ()
+{
+#if defined(AMREX_USE_CUDA)
+    AMREX_CUDA_SAFE_CALL(cudaGraphLaunch(m_exec, amrex::Gpu::gpuStream()));
+#elif defined(AMREX_USE_HIP)
+    AMREX_HIP_SAFE_CALL(hipGraphLaunch(m_exec, amrex::Gpu::gpuStream()));
+#endif
+}
@@ -0,0 +1,230 @@
+/* This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+#include "WarpX.H"
+
+#include "Diagnostics/ReducedDiags/MultiReducedDiags.H"
+#include "Particles/MultiParticleContainer.H"
+#include "Particles/ParticleBoundaryBuffer.H"
+#include "Utils/TextMsg.H"
+#include "Utils/WarpXProfilerWrapper.H"
+#include "CostsBreakdown.H"
+
+#include <AMReX_BoxArray.H>
+#include <AMReX_DistributionMapping.H>
+#include <AMReX_FabArrayBase.H>
+#include <AMReX_OpenMP.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_Print.H>
+#include <AMReX_REAL.H>
+#include <AMReX_Utility.H>
+#include <AMReX_Vector.H>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+using namespace amrex;
+
+namespace
+{
+    /** The sizes of an IntVect separated by spaces, as in the inputs */
+    std::string SizesString (IntVect const& iv)
+    {
+        std::string str;
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+            str += (idim > 0 ? " " : "") + std::to_string(iv[idim]);
+        }
+        return str;
+    }
+
+    /** The IntVect of the sizes read from str, false if str does not have AMREX_SPACEDIM sizes */
+    bool ReadSizes (std::string const& str, IntVect& iv)
+    {
+        std::istringstream is(str);
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+            if (!(is >> iv[idim])) return false;
+        }
+        return true;
+    }
+}
+
+void
+WarpX::AutoTune (int step)
+{
+    if (!m_autotune) return;
+    WARPX_PROFILE("WarpX::AutoTune()");
+
+    // the first step is the warm-up of the layout given in the inputs, the first candidate
+    if (m_autotune_candidates.empty()) {
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(finest_level == 0,
+            "warpx.autotune_max_grid_size and warpx.autotune_tile_size require amr.max_level = 0");
+        if (AutoTuneReadFile()) {
+            m_autotune = false;
+            return;
+        }
+        Vector<IntVect> mgs_candidates {maxGridSize(0)};
+        for (int mgs : m_autotune_max_grid_size) {
+            for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+                WARPX_ALWAYS_ASSERT_WITH_MESSAGE(mgs > 0 && mgs % blockingFactor(0)[idim] == 0,
+                    "warpx.autotune_max_grid_size: the sizes must be multiples of amr.blocking_factor");
+            }
+            mgs_candidates.push_back(IntVect(mgs));
+        }
+        Vector<IntVect> tile_candidates {FabArrayBase::mfiter_tile_size};
+#ifdef AMREX_USE_GPU
+        // the loops over the boxes are not tiled on GPU
+        if (!m_autotune_tile_size.empty()) {
+            this->RecordWarning("AutoTune",
+                "warpx.autotune_tile_size is ignored on GPU, where the boxes are not tiled");
+        }
+#else
+        for (int tile : m_autotune_tile_size) {
+            WARPX_ALWAYS_ASSERT_WITH_MESSAGE(tile > 0, "warpx.autotune_tile_size: the sizes must be positive");
+            // the first direction is not tiled, like the default of AMReX (1024000 8 8)
+            IntVect tile_size(tile);
+            tile_size[0] = FabArrayBase::mfiter_tile_size[0];
+            tile_candidates.push_back(tile_size);
+        }
+#endif
+        for (IntVect const& mgs : mgs_candidates) {
+            for (IntVect const& tile : tile_candidates) {
+                const bool known = std::any_of(m_autotune_candidates.begin(), m_autotune_candidates.end(),
+                    [&] (AutoTuneCandidate const& c) { return c.max_grid_size == mgs && c.tile_size == tile; });
+                if (!known) m_autotune_candidates.push_back(AutoTuneCandidate{mgs, tile});
+            }
+        }
+        m_autotune_current = 0;
+        amrex::Print() << Utils::TextMsg::Info(
+            "AutoTune: measuring " + std::to_string(m_autotune_candidates.size()) + " layouts over "
+            + std::to_string(m_autotune_steps) + " steps each, from step " + std::to_string(step+2));
+        return;
+    }
+
+    // the first step after a change of layout, with the allocations and the first use of the
+    // new communication plans, is not measured
+    if (m_autotune_warmup) {
+        m_autotune_warmup = false;
+        return;
+    }
+
+    // the time of the step without the diagnostics, on the slowest rank
+    Real step_time = m_step_time_last;
+    if (m_step_phase_timers) step_time -= m_step_phase_times_last[CostPhase::Diagnostics];
+    ParallelDescriptor::ReduceRealMax(step_time);
+
+    AutoTuneCandidate& candidate = m_autotune_candidates[m_autotune_current];
+    candidate.time += step_time;
+    ++candidate.nsteps;
+    if (candidate.nsteps < m_autotune_steps) return;
+
+    // next candidate
+    ++m_autotune_current;
+    if (m_autotune_current < static_cast<int>(m_autotune_candidates.size())) {
+        AutoTuneSetLayout(m_autotune_candidates[m_autotune_current].max_grid_size,
+                          m_autotune_candidates[m_autotune_current].tile_size);
+        m_autotune_warmup = true;
+        return;
+    }
+
+    // all measured: the simulation continues with the fastest layout
+    int best = 0;
+    amrex::Print() << Utils::TextMsg::Info("AutoTune: time per step (s) of the layouts");
+    for (int i = 0; i < static_cast<int>(m_autotune_candidates.size()); ++i) {
+        AutoTuneCandidate const& c = m_autotune_candidates[i];
+        amrex::Print() << "    max_grid_size " << SizesString(c.max_grid_size)
+                       << "  tile_size " << SizesString(c.tile_size)
+                       << "  " << c.time / c.nsteps << "\n";
+        if (c.time / c.nsteps < m_autotune_candidates[best].time / m_autotune_candidates[best].nsteps) best = i;
+    }
+    AutoTuneCandidate const& chosen = m_autotune_candidates[best];
+    AutoTuneSetLayout(chosen.max_grid_size, chosen.tile_size);
+    amrex::Print() << Utils::TextMsg::Info(
+        "AutoTune: continuing with amr.max_grid_size = " + SizesString(chosen.max_grid_size)
+        + " and fabarray.mfiter_tile_size = " + SizesString(chosen.tile_size));
+    AutoTuneWriteFile(chosen.max_grid_size, chosen.tile_size);
+    m_autotune = false;
+}
+
+void
+WarpX::AutoTuneSetLayout (IntVect const& max_grid_size, IntVect const& tile_size)
+{
+    FabArrayBase::mfiter_tile_size = tile_size;
+
+    // the boxes of level 0 are made as at the initialization, and the fields and particles are
+    // moved to them as after a load balance that chops the boxes
+    SetMaxGridSize(max_grid_size);
+    const BoxArray ba = MakeBaseGrids();
+    if (ba == boxArray(0)) return;
+    const DistributionMapping dm(ba);
+    RemakeLevel(0, t_new[0], ba, dm);
+
+    mypc->Redistribute();
+    mypc->defineAllParticleTiles();
+    m_particle_boundary_buffer->redistribute();
+    reduced_diags->LoadBalance();
+}
+
+std::string
+WarpX::AutoTuneLayoutKey () const
+{
+    // the layout depends on the domain and on the ranks and threads that share it
+    std::ostringstream key;
+    key << Geom(0).Domain() << " nprocs " << ParallelDescriptor::NProcs()
+        << " nthreads " << OpenMP::get_max_threads();
+    return key.str();
+}
+
+bool
+WarpX::AutoTuneReadFile ()
+{
+    if (m_autotune_file.empty() || !amrex::FileExists(m_autotune_file)) return false;
+
+    Vector<char> file_chars;
+    ParallelDescriptor::ReadAndBcastFile(m_autotune_file, file_chars);
+    std::istringstream is(file_chars.dataPtr());
+
+    // lines "name = value"
+    std::string line, key;
+    IntVect max_grid_size(0), tile_size(0);
+    bool has_mgs = false, has_tile = false;
+    while (std::getline(is, line)) {
+        const auto eq = line.find(" = ");
+        if (eq == std::string::npos) continue;
+        const std::string name = line.substr(0, eq);
+        const std::string value = line.substr(eq + 3);
+        if (name == "layout") {
+            key = value;
+        } else if (name == "amr.max_grid_size") {
+            has_mgs = ReadSizes(value, max_grid_size);
+        } else if (name == "fabarray.mfiter_tile_size") {
+            has_tile = ReadSizes(value, tile_size);
+        }
+    }
+    if (key != AutoTuneLayoutKey() || !has_mgs || !has_tile) {
+        amrex::Print() << Utils::TextMsg::Info(
+            "AutoTune: " + m_autotune_file + " is for another domain or parallelization, tuning again");
+        return false;
+    }
+
+    AutoTuneSetLayout(max_grid_size, tile_size);
+    amrex::Print() << Utils::TextMsg::Info(
+        "AutoTune: amr.max_grid_size = " + SizesString(max_grid_size)
+        + " and fabarray.mfiter_tile_size = " + SizesString(tile_size) + " read from " + m_autotune_file);
+    return true;
+}
+
+void
+WarpX::AutoTuneWriteFile (IntVect const& max_grid_size, IntVect const& tile_size) const
+{
+    if (m_autotune_file.empty() || !ParallelDescriptor::IOProcessor()) return;
+
+    std::ofstream file(m_autotune_file, std::ofstream::out | std::ofstream::trunc);
+    if (!file.good()) amrex::FileOpenFailed(m_autotune_file);
+    file << "# layout chosen by the auto-tuning, used again by warpx.autotune_file for the same layout\n"
+         << "layout = " << AutoTuneLayoutKey() << "\n"
+         << "amr.max_grid_size = " << SizesString(max_grid_size) << "\n"
+         << "fabarray.mfiter_tile_size = " << SizesString(tile_size) << "\n";
+}
@@ -18,6 +18,7 @@
 #include "Utils/TextMsg.H"
 #include "Utils/WarpXAlgorithmSelection.H"
 #include "Utils/WarpXProfilerWrapper.H"
+#include "CostsBreakdown.H"
 #include "WarpXComm_K.H"
 #include "WarpXCommUtil.H"
 #include "WarpXSumGuardCells.H"
@@ -45,6 +46,7 @@
 #include <algorithm>
 #include <array>
 #include <memory>
+#include <string>
 #include <vector>
 
 using namespace amrex;
@@ -54,6 +56,32 @@ WarpX::UpdateAuxilaryData ()
 {
     WARPX_PROFILE("WarpX::UpdateAuxilaryData()");
 
+    // the guard cells of the fine patches of the levels advanced in lockstep are already filled
+    // from the coarser level, see FillCoarseFineBoundary
+    if (MRLockstep()) {
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(Bfield_aux[0][0]->ixType() == Bfield_fp[0][0]->ixType(),
+            "mesh refinement with the LLG solver is not implemented with the momentum-conserving "
+            "field gathering");
+        const amrex::IntVect& ng_src = guard_cells.ng_FieldGather;
+        for (int lev = 1; lev <= finest_level; ++lev) {
+            const amrex::Periodicity& crse_period = Geom(lev-1).periodicity();
+            for (int i = 0; i < 3; ++i) {
+                const amrex::IntVect ng_B = amrex::min(Bfield_aux[lev][i]->nGrowVect(), Bfield_fp[lev][i]->nGrowVect());
+                const amrex::IntVect ng_E = amrex::min(Efield_aux[lev][i]->nGrowVect(), Efield_fp[lev][i]->nGrowVect());
+                MultiFab::Copy(*Bfield_aux[lev][i], *Bfield_fp[lev][i], 0, 0, Bfield_fp[lev][i]->nComp(), ng_B);
+                MultiFab::Copy(*Efield_aux[lev][i], *Efield_fp[lev][i], 0, 0, Efield_fp[lev][i]->nComp(), ng_E);
+                // coarse fields of the particles in the gather buffers
+                if (Bfield_cax[lev][i]) {
+                    WarpXCommUtil::ParallelCopy(*Bfield_cax[lev][i], *Bfield_aux[lev-1][i], 0, 0,
+                        Bfield_aux[lev-1][i]->nComp(), ng_src, Bfield_cax[lev][i]->nGrowVect(), crse_period);
+                    WarpXCommUtil::ParallelCopy(*Efield_cax[lev][i], *Efield_aux[lev-1][i], 0, 0,
+                        Efield_aux[lev-1][i]->nComp(), ng_src, Efield_cax[lev][i]->nGrowVect(), crse_period);
+                }
+            }
+        }
+        return;
+    }
+
     if (Bfield_aux[0][0]->ixType() == Bfield_fp[0][0]->ixType()) {
         UpdateAuxilaryDataSameType();
     } else {
@@ -279,9 +307,9 @@ WarpX::UpdateAuxilaryDataSameType ()
 
         // B field
         {
-            MultiFab dBx(Bfield_cp[lev][0]->boxArray(), dm, Bfield_cp[lev][0]->nComp(), ng);
-            MultiFab dBy(Bfield_cp[lev][1]->boxArray(), dm, Bfield_cp[lev][1]->nComp(), ng);
-            MultiFab dBz(Bfield_cp[lev][2]->boxArray(), dm, Bfield_cp[lev][2]->nComp(), ng);
+            MultiFab& dBx = m_scratch_mfs.Get("dBx_aux", lev, Bfield_cp[lev][0]->boxArray(), dm, Bfield_cp[lev][0]->nComp(), ng);
+            MultiFab& dBy = m_scratch_mfs.Get("dBy_aux", lev, Bfield_cp[lev][1]->boxArray(), dm, Bfield_cp[lev][1]->nComp(), ng);
+            MultiFab& dBz = m_scratch_mfs.Get("dBz_aux", lev, Bfield_cp[lev][2]->boxArray(), dm, Bfield_cp[lev][2]->nComp(), ng);
             dBx.setVal(0.0);
             dBy.setVal(0.0);
             dBz.setVal(0.0);
@@ -344,9 +372,9 @@ WarpX::UpdateAuxilaryDataSameType ()
 
         // E field
         {
-            MultiFab dEx(Efield_cp[lev][0]->boxArray(), dm, Efield_cp[lev][0]->nComp(), ng);
-            MultiFab dEy(Efield_cp[lev][1]->boxArray(), dm, Efield_cp[lev][1]->nComp(), ng);
-            MultiFab dEz(Efield_cp[lev][2]->boxArray(), dm, Efield_cp[lev][2]->nComp(), ng);
+            MultiFab& dEx = m_scratch_mfs.Get("dEx_aux", lev, Efield_cp[lev][0]->boxArray(), dm, Efield_cp[lev][0]->nComp(), ng);
+            MultiFab& dEy = m_scratch_mfs.Get("dEy_aux", lev, Efield_cp[lev][1]->boxArray(), dm, Efield_cp[lev][1]->nComp(), ng);
+            MultiFab& dEz = m_scratch_mfs.Get("dEz_aux", lev, Efield_cp[lev][2]->boxArray(), dm, Efield_cp[lev][2]->nComp(), ng);
             dEx.setVal(0.0);
             dEy.setVal(0.0);
             dEz.setVal(0.0);
@@ -455,6 +483,109 @@ void WarpX::UpdateCurrentNodalToStag (amrex::MultiFab& dst, amrex::MultiFab cons
     }
 }
 
+void
+WarpX::MarkFieldModified (TrackedField field)
+{
+    for (auto& filled : m_filled_guard_cells)
+    {
+        filled[field] = amrex::IntVect(-1);
+    }
+}
+
+void
+WarpX::MarkAllFieldsModified ()
+{
+    for (int field = 0; field < tracked_nfields; ++field)
+    {
+        MarkFieldModified(static_cast<TrackedField>(field));
+    }
+}
+
+bool
+WarpX::GuardCellsNeedFill (int lev, TrackedField field, amrex::IntVect const& nghost)
+{
+    if (!skip_clean_fill_boundary) return true;
+
+    if (static_cast<int>(m_filled_guard_cells.size()) <= lev)
+    {
+        std::array<amrex::IntVect, tracked_nfields> not_filled;
+        not_filled.fill(amrex::IntVect(-1));
+        m_filled_guard_cells.resize(lev+1, not_filled);
+    }
+
+    amrex::IntVect& filled = m_filled_guard_cells[lev][field];
+    if (nghost.allLE(filled)) return false;
+
+    // the guard cells filled by a previous exchange remain up to date
+    filled = amrex::elemwiseMax(filled, nghost);
+    return true;
+}
+
+void
+WarpX::InvalidateDeepHalo ()
+{
+    for (auto& depth : m_deep_halo_depth)
+    {
+        depth.fill(0);
+    }
+    // so that the next exchange is not skipped either
+    MarkAllFieldsModified();
+}
+
+bool
+WarpX::DeepHaloCovers (int lev, TrackedField field, amrex::IntVect const& nghost)
+{
+    if (deep_halo_steps <= 1) return false;
+
+    if (static_cast<int>(m_deep_halo_depth.size()) <= lev)
+    {
+        std::array<int, tracked_nfields> no_depth;
+        no_depth.fill(0);
+        m_deep_halo_depth.resize(lev+1, no_depth);
+    }
+    return nghost.allLE(amrex::IntVect(m_deep_halo_depth[lev][field]));
+}
+
+void
+WarpX::FillBoundaryDeepHalo (int lev)
+{
+    WARPX_PROFILE("WarpX::FillBoundaryDeepHalo()");
+
+    // E and B are exchanged together, such that their valid guard cells are exhausted
+    // at the same time, in a single exchange of all their allocated guard cells
+    amrex::Vector<amrex::MultiFab*> mf;
+    amrex::Vector<amrex::IntVect> ng;
+    for (int i = 0; i < 3; ++i)
+    {
+        mf.push_back(Efield_fp[lev][i].get());
+        ng.push_back(Efield_fp[lev][i]->nGrowVect());
+        mf.push_back(Bfield_fp[lev][i].get());
+        ng.push_back(Bfield_fp[lev][i]->nGrowVect());
+    }
+    WarpXCommUtil::FillBoundary(mf, ng, Geom(lev).periodicity());
+
+    DeepHaloCovers(lev, tracked_E, amrex::IntVect(0)); // allocate the depths
+    m_deep_halo_depth[lev][tracked_E] = Efield_fp[lev][0]->nGrowVect().min();
+    m_deep_halo_depth[lev][tracked_B] = Bfield_fp[lev][0]->nGrowVect().min();
+}
+
+int
+WarpX::DeepHaloUpdateDepth (int lev, TrackedField field, TrackedField source)
+{
+    if (deep_halo_steps <= 1) return 0;
+
+    DeepHaloCovers(lev, field, amrex::IntVect(0)); // allocate the depths
+    auto& depth = m_deep_halo_depth[lev];
+    // the field is updated from its own value at the same point and from the source
+    // on the neighbor points
+    if (std::min(depth[source] - 1, depth[field]) < 0) FillBoundaryDeepHalo(lev);
+    const int ng_update = std::min(depth[source] - 1, depth[field]);
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(ng_update >= 0,
+        "DeepHaloUpdateDepth: the guard cells of E and B are not deep enough");
+    depth[field] = ng_update;
+    return ng_update;
+}
+
 void
 WarpX::FillBoundaryB (IntVect ng)
 {
@@ -514,19 +645,33 @@ void
 WarpX::FillBoundaryE(int lev, IntVect ng)
 {
     FillBoundaryE(lev, PatchType::fine, ng);
-    if (lev > 0) FillBoundaryE(lev, PatchType::coarse, ng);
+    // the levels advanced in lockstep have no coarse patch
+    if (lev > 0 && !MRLockstep()) FillBoundaryE(lev, PatchType::coarse, ng);
 }
 
 void
 WarpX::FillBoundaryE (const int lev, const PatchType patch_type, const amrex::IntVect ng)
 {
+    CostPhaseTimer cost_phase(CostPhase::Exchange);
     std::array<amrex::MultiFab*,3> mf;
     amrex::Periodicity period;
 
     if (patch_type == PatchType::fine)
     {
+        if (deep_halo_steps > 1)
+        {
+            if (!DeepHaloCovers(lev, tracked_E, ng)) FillBoundaryDeepHalo(lev);
+            return;
+        }
+        const amrex::IntVect nghost = (safe_guard_cells) ? Efield_fp[lev][0]->nGrowVect() : ng;
+        if (!GuardCellsNeedFill(lev, tracked_E, nghost)) return;
+
         mf     = {Efield_fp[lev][0].get(), Efield_fp[lev][1].get(), Efield_fp[lev][2].get()};
         period = Geom(lev).periodicity();
+#ifdef WARPX_MAG_LLG
+        // the guard cells at the coarse/fine boundary are interpolated from the coarser level
+        if (lev > 0 && mag_mr_lockstep) FillCoarseFineBoundary(Efield_fp, lev);
+#endif
     }
     else // coarse patch
     {
@@ -571,19 +716,33 @@ void
 WarpX::FillBoundaryB (int lev, IntVect ng)
 {
     FillBoundaryB(lev, PatchType::fine, ng);
-    if (lev > 0) FillBoundaryB(lev, PatchType::coarse, ng);
+    // the levels advanced in lockstep have no coarse patch
+    if (lev > 0 && !MRLockstep()) FillBoundaryB(lev, PatchType::coarse, ng);
 }
 
 void
 WarpX::FillBoundaryB (const int lev, const PatchType patch_type, const amrex::IntVect ng)
 {
+    CostPhaseTimer cost_phase(CostPhase::Exchange);
     std::array<amrex::MultiFab*,3> mf;
     amrex::Periodicity period;
 
     if (patch_type == PatchType::fine)
     {
+        if (deep_halo_steps > 1)
+        {
+            if (!DeepHaloCovers(lev, tracked_B, ng)) FillBoundaryDeepHalo(lev);
+            return;
+        }
+        const amrex::IntVect nghost = (safe_guard_cells) ? Bfield_fp[lev][0]->nGrowVect() : ng;
+        if (!GuardCellsNeedFill(lev, tracked_B, nghost)) return;
+
         mf     = {Bfield_fp[lev][0].get(), Bfield_fp[lev][1].get(), Bfield_fp[lev][2].get()};
         period = Geom(lev).periodicity();
+#ifdef WARPX_MAG_LLG
+        // the guard cells at the coarse/fine boundary are interpolated from the coarser level
+        if (lev > 0 && mag_mr_lockstep) FillCoarseFineBoundary(Bfield_fp, lev);
+#endif
     }
     else // coarse patch
     {
@@ -637,24 +796,30 @@ WarpX::FillBoundaryM (IntVect ng)
 void
 WarpX::FillBoundaryM (int lev, IntVect ng)
 {
+    // the LLG solver has no coarse patch, the levels are advanced in lockstep
     FillBoundaryM(lev, PatchType::fine, ng);
-    if (lev > 0) FillBoundaryM(lev, PatchType::coarse, ng);
 }
 
 void
 WarpX::FillBoundaryM (int lev, PatchType patch_type, IntVect ng)
 {
+    CostPhaseTimer cost_phase(CostPhase::Exchange);
     std::array<amrex::MultiFab*,3> mf;
     amrex::Periodicity period;
 
     if (patch_type == PatchType::fine)
     {
+        const amrex::IntVect nghost = (safe_guard_cells) ? Mfield_fp[lev][0]->nGrowVect() : ng;
+        if (!GuardCellsNeedFill(lev, tracked_M, nghost)) return;
+
         mf     = {Mfield_fp[lev][0].get(), Mfield_fp[lev][1].get(), Mfield_fp[lev][2].get()};
         period = Geom(lev).periodicity();
+        // the guard cells at the coarse/fine boundary are interpolated from the coarser level
+        if (lev > 0) FillCoarseFineBoundary(Mfield_fp, lev, (mag_M_collocated == 1) ? 1 : 3);
     }
     else if (patch_type == PatchType::coarse)
     {
-        amrex::Abort("EvolveHM does not come with coarse patch yet");
+        amrex::Abort("EvolveHM does not come with coarse patch");
     }
 
     if (do_pml)
@@ -662,8 +827,9 @@ WarpX::FillBoundaryM (int lev, PatchType patch_type, IntVect ng)
         // ExchangeM not needed for PML algorithm
     }
 
-    // Fill guard cells in valid domain
-    for (int i = 0; i < 3; ++i)
+    // Fill guard cells in valid domain; with collocated M, the three MultiFabs alias the same data
+    int const nmf = (mag_M_collocated == 1) ? 1 : 3;
+    for (int i = 0; i < nmf; ++i)
     {
         AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
             ng <= mf[i]->nGrowVect(),
@@ -687,24 +853,30 @@ WarpX::FillBoundaryH (IntVect ng)
 void
 WarpX::FillBoundaryH (int lev, IntVect ng)
 {
+    // the LLG solver has no coarse patch, the levels are advanced in lockstep
     FillBoundaryH(lev, PatchType::fine, ng);
-    if (lev > 0) FillBoundaryH(lev, PatchType::coarse, ng);
 }
 
 void
 WarpX::FillBoundaryH (int lev, PatchType patch_type, IntVect ng)
 {
+    CostPhaseTimer cost_phase(CostPhase::Exchange);
     std::array<amrex::MultiFab*,3> mf;
     amrex::Periodicity period;
 
     if (patch_type == PatchType::fine)
     {
+        const amrex::IntVect nghost = (safe_guard_cells) ? Hfield_fp[lev][0]->nGrowVect() : ng;
+        if (!GuardCellsNeedFill(lev, tracked_H, nghost)) return;
+
         mf     = {Hfield_fp[lev][0].get(), Hfield_fp[lev][1].get(), Hfield_fp[lev][2].get()};
         period = Geom(lev).periodicity();
+        // the guard cells at the coarse/fine boundary are interpolated from the coarser level
+        if (lev > 0) FillCoarseFineBoundary(Hfield_fp, lev);
     }
     else if (patch_type == PatchType::coarse)
     {
-        amrex::Abort("EvolveHM does not come with coarse patch yet");
+        amrex::Abort("EvolveHM does not come with coarse patch");
     }
 
     // Exchange data between valid domain and PML
@@ -733,6 +905,221 @@ WarpX::FillBoundaryH (int lev, PatchType patch_type, IntVect ng)
     }
 
 }
+
+void
+WarpX::FillBoundaryEHM (IntVect ng)
+{
+    for (int lev = 0; lev <= finest_level; ++lev)
+    {
+        FillBoundaryEHM(lev, ng, true);
+    }
+}
+
+void
+WarpX::FillBoundaryHM (IntVect ng)
+{
+    for (int lev = 0; lev <= finest_level; ++lev)
+    {
+        FillBoundaryEHM(lev, ng, false);
+    }
+}
+
+void
+WarpX::FillBoundaryEHM (int lev, IntVect ng, bool include_E)
+{
+    CostPhaseTimer cost_phase(CostPhase::Exchange);
+    std::array<amrex::MultiFab*,3> E = {Efield_fp[lev][0].get(), Efield_fp[lev][1].get(), Efield_fp[lev][2].get()};
+    std::array<amrex::MultiFab*,3> H = {Hfield_fp[lev][0].get(), Hfield_fp[lev][1].get(), Hfield_fp[lev][2].get()};
+
+    // the fields whose guard cells are already up to date are left out
+    auto need_fill = [&] (TrackedField field, amrex::MultiFab const& mf0) {
+        return GuardCellsNeedFill(lev, field, (safe_guard_cells) ? mf0.nGrowVect() : ng);
+    };
+    const bool fill_E = include_E && need_fill(tracked_E, *E[0]);
+    const bool fill_H = need_fill(tracked_H, *H[0]);
+    const bool fill_M = need_fill(tracked_M, *Mfield_fp[lev][0]);
+    int const nmf_M = (mag_M_collocated == 1) ? 1 : 3;
+
+    // the guard cells at the coarse/fine boundary are interpolated from the coarser level
+    if (lev > 0)
+    {
+        if (fill_E) FillCoarseFineBoundary(Efield_fp, lev);
+        if (fill_H) FillCoarseFineBoundary(Hfield_fp, lev);
+        if (fill_M) FillCoarseFineBoundary(Mfield_fp, lev, nmf_M);
+    }
+
+    // Exchange data between valid domain and PML
+    // Fill guard cells in PML (ExchangeM not needed for PML algorithm)
+    if (do_pml && pml[lev] && pml[lev]->ok())
+    {
+        if (fill_E)
+        {
+            pml[lev]->Exchange(pml[lev]->GetE_fp(), E, PatchType::fine, do_pml_in_domain);
+            pml[lev]->FillBoundaryE(PatchType::fine);
+        }
+        if (fill_H)
+        {
+            pml[lev]->Exchange(pml[lev]->GetH_fp(), H, PatchType::fine, do_pml_in_domain);
+            pml[lev]->FillBoundaryH(PatchType::fine);
+        }
+    }
+
+    // Fill guard cells in valid domain, the fields sharing the same distribution mapping, all
+    // their components go in one message per neighbor rank; with collocated M, the three
+    // MultiFabs of M alias the same data
+    amrex::Vector<amrex::MultiFab*> mf;
+    if (fill_E) mf.insert(mf.end(), E.begin(), E.end());
+    if (fill_H) mf.insert(mf.end(), H.begin(), H.end());
+    if (fill_M) {
+        for (int i = 0; i < nmf_M; ++i) mf.push_back(Mfield_fp[lev][i].get());
+    }
+
+    amrex::Vector<amrex::IntVect> nghost;
+    for (amrex::MultiFab* x : mf)
+    {
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(
+            ng <= x->nGrowVect(),
+            "Error: in FillBoundaryEHM, requested more guard cells than allocated");
+
+        nghost.push_back((safe_guard_cells) ? x->nGrowVect() : ng);
+    }
+    if (!mf.empty()) WarpXCommUtil::FillBoundary(mf, nghost, Geom(lev).periodicity());
+}
+
+void
+WarpX::FillBoundaryH_nowait (int lev, IntVect ng)
+{
+    CostPhaseTimer cost_phase(CostPhase::Exchange);
+    // the single precision exchange needs temporary MultiFabs, it is done at once
+    if (do_single_precision_comms || lev > 0) {
+        FillBoundaryH(lev, ng);
+        return;
+    }
+
+    std::array<amrex::MultiFab*,3> mf = {Hfield_fp[lev][0].get(), Hfield_fp[lev][1].get(), Hfield_fp[lev][2].get()};
+    const amrex::Periodicity& period = Geom(lev).periodicity();
+
+    // Exchange data between valid domain and PML
+    // Fill guard cells in PML
+    if (do_pml && pml[lev] && pml[lev]->ok())
+    {
+        pml[lev]->Exchange(pml[lev]->GetH_fp(), mf, PatchType::fine, do_pml_in_domain);
+        pml[lev]->FillBoundaryH(PatchType::fine);
+    }
+
+    // Start filling guard cells in valid domain
+    for (int i = 0; i < 3; ++i)
+    {
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
+            ng <= mf[i]->nGrowVect(),
+            "Error: in FillBoundaryH_nowait, requested more guard cells than allocated");
+
+        const amrex::IntVect nghost = (safe_guard_cells) ? mf[i]->nGrowVect() : ng;
+        mf[i]->FillBoundary_nowait(0, mf[i]->nComp(), nghost, period);
+    }
+}
+
+void
+WarpX::FillBoundaryH_finish (int lev)
+{
+    CostPhaseTimer cost_phase(CostPhase::Exchange);
+    if (do_single_precision_comms || lev > 0) return;
+
+    for (int i = 0; i < 3; ++i)
+    {
+        Hfield_fp[lev][i]->FillBoundary_finish();
+    }
+}
+
+void
+WarpX::FillCoarseFineBoundary (
+    const amrex::Vector<std::array<std::unique_ptr<amrex::MultiFab>,3>>& field, int lev, int nmf,
+    bool fill_valid)
+{
+    WARPX_PROFILE("WarpX::FillCoarseFineBoundary()");
+
+    const amrex::IntVect& refinement_ratio = refRatio(lev-1);
+    const amrex::Periodicity& crse_period = Geom(lev-1).periodicity();
+
+    // with the multirate steps of the levels, level lev-1 is interpolated in time between the
+    // beginning and the end of its step, see OneStep_mag_multirate
+    const amrex::Real alpha = (lev < static_cast<int>(m_mr_time_fraction.size())) ?
+        m_mr_time_fraction[lev] : 1._rt;
+    const std::array<std::unique_ptr<amrex::MultiFab>,3>* old_field = nullptr;
+    if (alpha < 1._rt) {
+        if (&field == &Efield_fp) old_field = &Efield_mr_old[lev-1];
+        if (&field == &Hfield_fp) old_field = &Hfield_mr_old[lev-1];
+        if (&field == &Mfield_fp) old_field = &Mfield_mr_old[lev-1];
+    }
+
+    for (int i = 0; i < nmf; ++i)
+    {
+        MultiFab& fine = *field[lev][i];
+        MultiFab const& crse = *field[lev-1][i];
+        const int ncomp = fine.nComp();
+        const amrex::IntVect stag = fine.ixType().toIntVect();
+
+        // values of level lev-1, including its guard cells, on the coarsened boxes of level lev,
+        // with enough guard cells for the interpolation in all the guard cells of level lev
+        BoxArray cba = fine.boxArray();
+        cba.coarsen(refinement_ratio);
+        const amrex::IntVect ng_c = fine.nGrowVect() / refinement_ratio + amrex::IntVect(1);
+        MultiFab fine_c(cba, fine.DistributionMap(), ncomp, ng_c);
+        fine_c.setVal(0.0);
+        WarpXCommUtil::ParallelCopy(fine_c, crse, 0, 0, ncomp, crse.nGrowVect(), ng_c, crse_period);
+        if (old_field)
+        {
+            MultiFab const& crse_old = *(*old_field)[i];
+            MultiFab old_c(cba, fine.DistributionMap(), ncomp, ng_c);
+            old_c.setVal(0.0);
+            WarpXCommUtil::ParallelCopy(old_c, crse_old, 0, 0, ncomp, crse_old.nGrowVect(), ng_c, crse_period);
+            MultiFab::LinComb(fine_c, 1._rt - alpha, old_c, 0, alpha, fine_c, 0, 0, ncomp, ng_c);
+        }
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+        for (MFIter mfi(fine); mfi.isValid(); ++mfi)
+        {
+            const Box valid_box = mfi.validbox();
+            Array4<Real> const& arr_fine = fine.array(mfi);
+            Array4<Real const> const& arr_c = fine_c.const_array(mfi);
+
+            // the valid values are kept, unless the level is filled on new boxes
+            amrex::ParallelFor(Box(arr_fine), ncomp,
+            [=] AMREX_GPU_DEVICE (int j, int k, int l, int n) noexcept
+            {
+                if (!fill_valid && valid_box.contains(j,k,l)) return;
+                arr_fine(j,k,l,n) = warpx_interp_coarse(j, k, l, n, arr_c, stag, refinement_ratio);
+            });
+        }
+    }
+}
+
+void
+WarpX::AverageDownField (
+    const amrex::Vector<std::array<std::unique_ptr<amrex::MultiFab>,3>>& field, int lev, int nmf)
+{
+    WARPX_PROFILE("WarpX::AverageDownField()");
+
+    const amrex::IntVect& refinement_ratio = refRatio(lev-1);
+
+    for (int i = 0; i < nmf; ++i)
+    {
+        MultiFab const& fine = *field[lev][i];
+        MultiFab& crse = *field[lev-1][i];
+
+        // the fine values are averaged on the coarsened boxes of level lev first, without guard
+        // cells, so that only the valid points of level lev-1 covered by level lev are replaced
+        BoxArray cba = fine.boxArray();
+        cba.coarsen(refinement_ratio);
+        MultiFab fine_c(cba, fine.DistributionMap(), fine.nComp(), 0);
+        fine_c.setVal(0.0);
+        CoarsenMR::Coarsen(fine_c, fine, refinement_ratio);
+        WarpXCommUtil::ParallelCopy(crse, fine_c, 0, 0, fine.nComp(), amrex::IntVect(0),
+                                    amrex::IntVect(0), Geom(lev-1).periodicity());
+    }
+}
 #endif
 
 void
@@ -745,6 +1132,7 @@ WarpX::FillBoundaryE_avg(int lev, IntVect ng)
 void
 WarpX::FillBoundaryE_avg (int lev, PatchType patch_type, IntVect ng)
 {
+    CostPhaseTimer cost_phase(CostPhase::Exchange);
     if (patch_type == PatchType::fine)
     {
         if (do_pml && pml[lev]->ok())
@@ -799,6 +1187,7 @@ WarpX::FillBoundaryB_avg (int lev, IntVect ng)
 void
 WarpX::FillBoundaryB_avg (int lev, PatchType patch_type, IntVect ng)
 {
+    CostPhaseTimer cost_phase(CostPhase::Exchange);
     if (patch_type == PatchType::fine)
     {
         if (do_pml && pml[lev]->ok())
@@ -850,6 +1239,7 @@ WarpX::FillBoundaryF (int lev, IntVect ng)
 void
 WarpX::FillBoundaryF (int lev, PatchType patch_type, IntVect ng)
 {
+    CostPhaseTimer cost_phase(CostPhase::Exchange);
     if (patch_type == PatchType::fine)
     {
         if (do_pml && pml[lev] && pml[lev]->ok())
@@ -894,6 +1284,7 @@ void WarpX::FillBoundaryG (int lev, IntVect ng)
 
 void WarpX::FillBoundaryG (int lev, PatchType patch_type, IntVect ng)
 {
+    CostPhaseTimer cost_phase(CostPhase::Exchange);
     if (patch_type == PatchType::fine)
     {
         if (do_pml && pml[lev] && pml[lev]->ok())
@@ -938,6 +1329,7 @@ WarpX::FillBoundaryAux (IntVect ng)
 void
 WarpX::FillBoundaryAux (int lev, IntVect ng)
 {
+    CostPhaseTimer cost_phase(CostPhase::Exchange);
     const amrex::Periodicity& period = Geom(lev).periodicity();
     WarpXCommUtil::FillBoundary(*Efield_aux[lev][0], ng, period);
     WarpXCommUtil::FillBoundary(*Efield_aux[lev][1], ng, period);
@@ -946,9 +1338,11 @@ WarpX::FillBoundaryAux (int lev, IntVect ng)
     WarpXCommUtil::FillBoundary(*Bfield_aux[lev][1], ng, period);
     WarpXCommUtil::FillBoundary(*Bfield_aux[lev][2], ng, period);
 #ifdef WARPX_MAG_LLG
-    WarpXCommUtil::FillBoundary(*Mfield_aux[lev][0], ng, period);
-    WarpXCommUtil::FillBoundary(*Mfield_aux[lev][1], ng, period);
-    WarpXCommUtil::FillBoundary(*Mfield_aux[lev][2], ng, period);
+    if (mag_LLG) {
+        WarpXCommUtil::FillBoundary(*Mfield_aux[lev][0], ng, period);
+        WarpXCommUtil::FillBoundary(*Mfield_aux[lev][1], ng, period);
+        WarpXCommUtil::FillBoundary(*Mfield_aux[lev][2], ng, period);
+    }
 #endif
 }
 
@@ -1062,32 +1456,43 @@ void WarpX::ApplyFilterandSumBoundaryJ (
     const amrex::Periodicity& period = Geom(glev).periodicity();
     const std::array<std::unique_ptr<amrex::MultiFab>,3>& j = (patch_type == PatchType::fine) ?
                                                               J_fp[lev] : J_cp[lev];
+    // The three components are filtered together (one kernel launch per box on GPU)
+    std::array<MultiFab*,3> jf = {nullptr, nullptr, nullptr};
+    std::array<IntVect,3> ng_depos_J;
     for (int idim = 0; idim < 3; ++idim) {
         IntVect ng = j[idim]->nGrowVect();
-        IntVect ng_depos_J = get_ng_depos_J();
+        ng_depos_J[idim] = get_ng_depos_J();
         if (WarpX::do_current_centering)
         {
 #if   defined(WARPX_DIM_1D_Z)
-            ng_depos_J[0] += WarpX::current_centering_noz / 2;
+            ng_depos_J[idim][0] += WarpX::current_centering_noz / 2;
 #elif defined(WARPX_DIM_XZ) || defined(WARPX_DIM_RZ)
-            ng_depos_J[0] += WarpX::current_centering_nox / 2;
-            ng_depos_J[1] += WarpX::current_centering_noz / 2;
+            ng_depos_J[idim][0] += WarpX::current_centering_nox / 2;
+            ng_depos_J[idim][1] += WarpX::current_centering_noz / 2;
 #elif defined(WARPX_DIM_3D)
-            ng_depos_J[0] += WarpX::current_centering_nox / 2;
-            ng_depos_J[1] += WarpX::current_centering_noy / 2;
-            ng_depos_J[2] += WarpX::current_centering_noz / 2;
+            ng_depos_J[idim][0] += WarpX::current_centering_nox / 2;
+            ng_depos_J[idim][1] += WarpX::current_centering_noy / 2;
+            ng_depos_J[idim][2] += WarpX::current_centering_noz / 2;
 #endif
         }
         if (use_filter) {
             ng += bilinear_filter.stencil_length_each_dir-1;
-            ng_depos_J += bilinear_filter.stencil_length_each_dir-1;
-            ng_depos_J.min(ng);
-            MultiFab jf(j[idim]->boxArray(), j[idim]->DistributionMap(), j[idim]->nComp(), ng);
-            bilinear_filter.ApplyStencil(jf, *j[idim], lev);
-            WarpXSumGuardCells(*(j[idim]), jf, period, ng_depos_J, 0, (j[idim])->nComp());
+            ng_depos_J[idim] += bilinear_filter.stencil_length_each_dir-1;
+            jf[idim] = &m_scratch_mfs.Get("J_filtered_" + std::to_string(idim), lev,
+                                          j[idim]->boxArray(), j[idim]->DistributionMap(),
+                                          j[idim]->nComp(), ng);
+        }
+        ng_depos_J[idim].min(ng);
+    }
+    if (use_filter) {
+        bilinear_filter.ApplyStencil({jf[0], jf[1], jf[2]},
+                                     {j[0].get(), j[1].get(), j[2].get()}, lev);
+    }
+    for (int idim = 0; idim < 3; ++idim) {
+        if (use_filter) {
+            WarpXSumGuardCells(*(j[idim]), *jf[idim], period, ng_depos_J[idim], 0, (j[idim])->nComp());
         } else {
-            ng_depos_J.min(ng);
-            WarpXSumGuardCells(*(j[idim]), period, ng_depos_J, 0, (j[idim])->nComp());
+            WarpXSumGuardCells(*(j[idim]), period, ng_depos_J[idim], 0, (j[idim])->nComp());
         }
     }
 }
@@ -1118,8 +1523,9 @@ void WarpX::AddCurrentFromFineLevelandSumBoundary (
 
         const amrex::Periodicity& period = Geom(lev).periodicity();
         for (int idim = 0; idim < 3; ++idim) {
-            MultiFab mf(J_fp[lev][idim]->boxArray(),
-                        J_fp[lev][idim]->DistributionMap(), J_fp[lev][idim]->nComp(), 0);
+            MultiFab& mf = m_scratch_mfs.Get("J_from_fine_" + std::to_string(idim), lev,
+                                             J_fp[lev][idim]->boxArray(), J_fp[lev][idim]->DistributionMap(),
+                                             J_fp[lev][idim]->nComp(), IntVect(0));
             mf.setVal(0.0);
             IntVect ng = J_cp[lev+1][idim]->nGrowVect();
             IntVect ng_depos_J = get_ng_depos_J();
@@ -1140,13 +1546,15 @@ void WarpX::AddCurrentFromFineLevelandSumBoundary (
                 ng += bilinear_filter.stencil_length_each_dir-1;
                 ng_depos_J += bilinear_filter.stencil_length_each_dir-1;
                 ng_depos_J.min(ng);
-                MultiFab jfc(J_cp[lev+1][idim]->boxArray(),
-                             J_cp[lev+1][idim]->DistributionMap(), J_cp[lev+1][idim]->nComp(), ng);
+                MultiFab& jfc = m_scratch_mfs.Get("J_filtered_" + std::to_string(idim), lev+1,
+                                                  J_cp[lev+1][idim]->boxArray(), J_cp[lev+1][idim]->DistributionMap(),
+                                                  J_cp[lev+1][idim]->nComp(), ng);
                 bilinear_filter.ApplyStencil(jfc, *J_cp[lev+1][idim], lev+1);
 
                 // buffer patch of fine level
-                MultiFab jfb(current_buf[lev+1][idim]->boxArray(),
-                             current_buf[lev+1][idim]->DistributionMap(), current_buf[lev+1][idim]->nComp(), ng);
+                MultiFab& jfb = m_scratch_mfs.Get("J_buf_filtered_" + std::to_string(idim), lev+1,
+                                                  current_buf[lev+1][idim]->boxArray(), current_buf[lev+1][idim]->DistributionMap(),
+                                                  current_buf[lev+1][idim]->nComp(), ng);
                 bilinear_filter.ApplyStencil(jfb, *current_buf[lev+1][idim], lev+1);
 
                 MultiFab::Add(jfb, jfc, 0, 0, current_buf[lev+1][idim]->nComp(), ng);
@@ -1160,8 +1568,9 @@ void WarpX::AddCurrentFromFineLevelandSumBoundary (
                 ng += bilinear_filter.stencil_length_each_dir-1;
                 ng_depos_J += bilinear_filter.stencil_length_each_dir-1;
                 ng_depos_J.min(ng);
-                MultiFab jf(J_cp[lev+1][idim]->boxArray(),
-                            J_cp[lev+1][idim]->DistributionMap(), J_cp[lev+1][idim]->nComp(), ng);
+                MultiFab& jf = m_scratch_mfs.Get("J_filtered_" + std::to_string(idim), lev+1,
+                                                 J_cp[lev+1][idim]->boxArray(), J_cp[lev+1][idim]->DistributionMap(),
+                                                 J_cp[lev+1][idim]->nComp(), ng);
                 bilinear_filter.ApplyStencil(jf, *J_cp[lev+1][idim], lev+1);
 
                 WarpXCommUtil::ParallelAdd(mf, jf, 0, 0, J_cp[lev+1][idim]->nComp(), ng, IntVect::TheZeroVector(), period);
@@ -1218,7 +1627,7 @@ void WarpX::ApplyFilterandSumBoundaryRho (
     ApplyFilterandSumBoundaryRho(lev, glev, *rho, icomp, ncomp);
 }
 
-void WarpX::ApplyFilterandSumBoundaryRho (int /*lev*/, int glev, amrex::MultiFab& rho, int icomp, int ncomp)
+void WarpX::ApplyFilterandSumBoundaryRho (int lev, int glev, amrex::MultiFab& rho, int icomp, int ncomp)
 {
     const amrex::Periodicity& period = Geom(glev).periodicity();
     IntVect ng = rho.nGrowVect();
@@ -1227,7 +1636,7 @@ void WarpX::ApplyFilterandSumBoundaryRho (int /*lev*/, int glev, amrex::MultiFab
         ng += bilinear_filter.stencil_length_each_dir-1;
         ng_depos_rho += bilinear_filter.stencil_length_each_dir-1;
         ng_depos_rho.min(ng);
-        MultiFab rf(rho.boxArray(), rho.DistributionMap(), ncomp, ng);
+        MultiFab& rf = m_scratch_mfs.Get("rho_filtered", lev, rho.boxArray(), rho.DistributionMap(), ncomp, ng);
         bilinear_filter.ApplyStencil(rf, rho, glev, icomp, 0, ncomp);
         WarpXSumGuardCells(rho, rf, period, ng_depos_rho, icomp, ncomp );
     } else {
@@ -1263,9 +1672,8 @@ void WarpX::AddRhoFromFineLevelandSumBoundary (
     if (lev < finest_level){
 
         const amrex::Periodicity& period = Geom(lev).periodicity();
-        MultiFab mf(charge_fp[lev]->boxArray(),
-                    charge_fp[lev]->DistributionMap(),
-                    ncomp, 0);
+        MultiFab& mf = m_scratch_mfs.Get("rho_from_fine", lev, charge_fp[lev]->boxArray(),
+                                         charge_fp[lev]->DistributionMap(), ncomp, IntVect(0));
         mf.setVal(0.0);
         IntVect ng = charge_cp[lev+1]->nGrowVect();
         IntVect ng_depos_rho = get_ng_depos_rho();
@@ -1275,13 +1683,13 @@ void WarpX::AddRhoFromFineLevelandSumBoundary (
             ng += bilinear_filter.stencil_length_each_dir-1;
             ng_depos_rho += bilinear_filter.stencil_length_each_dir-1;
             ng_depos_rho.min(ng);
-            MultiFab rhofc(charge_cp[lev+1]->boxArray(),
-                           charge_cp[lev+1]->DistributionMap(), ncomp, ng);
+            MultiFab& rhofc = m_scratch_mfs.Get("rho_filtered", lev+1, charge_cp[lev+1]->boxArray(),
+                                                charge_cp[lev+1]->DistributionMap(), ncomp, ng);
             bilinear_filter.ApplyStencil(rhofc, *charge_cp[lev+1], lev+1, icomp, 0, ncomp);
 
             // buffer patch of fine level
-            MultiFab rhofb(charge_buf[lev+1]->boxArray(),
-                           charge_buf[lev+1]->DistributionMap(), ncomp, ng);
+            MultiFab& rhofb = m_scratch_mfs.Get("rho_buf_filtered", lev+1, charge_buf[lev+1]->boxArray(),
+                                                charge_buf[lev+1]->DistributionMap(), ncomp, ng);
             bilinear_filter.ApplyStencil(rhofb, *charge_buf[lev+1], lev+1, icomp, 0, ncomp);
 
             MultiFab::Add(rhofb, rhofc, 0, 0, ncomp, ng);
@@ -1294,7 +1702,8 @@ void WarpX::AddRhoFromFineLevelandSumBoundary (
             ng += bilinear_filter.stencil_length_each_dir-1;
             ng_depos_rho += bilinear_filter.stencil_length_each_dir-1;
             ng_depos_rho.min(ng);
-            MultiFab rf(charge_cp[lev+1]->boxArray(), charge_cp[lev+1]->DistributionMap(), ncomp, ng);
+            MultiFab& rf = m_scratch_mfs.Get("rho_filtered", lev+1, charge_cp[lev+1]->boxArray(),
+                                             charge_cp[lev+1]->DistributionMap(), ncomp, ng);
             bilinear_filter.ApplyStencil(rf, *charge_cp[lev+1], lev+1, icomp, 0, ncomp);
 
             WarpXCommUtil::ParallelAdd(mf, rf, 0, 0, ncomp, ng, IntVect::TheZeroVector(), period);
@@ -1375,6 +1784,7 @@ void WarpX::NodalSyncRho (
 
 void WarpX::NodalSyncPML ()
 {
+    MarkAllFieldsModified();
     for (int lev = 0; lev <= finest_level; lev++) {
         NodalSyncPML(lev);
     }
@@ -1437,6 +1847,8 @@ void WarpX::NodalSync (amrex::Vector<std::array<std::unique_ptr<amrex::MultiFab>
 {
     if (!override_sync_intervals.contains(istep[0]) && !do_pml) return;
 
+    MarkAllFieldsModified();
+
     for (int lev = 0; lev <= WarpX::finest_level; lev++)
     {
         const amrex::Periodicity& period = Geom(lev).periodicity();
@@ -1459,6 +1871,8 @@ void WarpX::NodalSync (amrex::Vector<std::unique_ptr<amrex::MultiFab>>& mf_fp,
 {
     if (!override_sync_intervals.contains(istep[0]) && !do_pml) return;
 
+    MarkAllFieldsModified();
+
     for (int lev = 0; lev <= WarpX::finest_level; lev++)
     {
         const amrex::Periodicity& period = Geom(lev).periodicity();
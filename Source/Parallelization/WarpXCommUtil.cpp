@@ -6,6 +6,8 @@
  */
 #include "WarpXCommUtil.H"
 
+#include "HaloExchangePlan.H"
+
 #include <AMReX.H>
 #include <AMReX_BaseFab.H>
 #include <AMReX_IntVect.H>
@@ -85,6 +87,11 @@ void FillBoundary (amrex::MultiFab& mf, const amrex::Periodicity& period)
 
         mixedCopy(mf, mf_tmp, 0, 0, mf.nComp(), mf.nGrowVect());
     }
+    else if (WarpX::use_persistent_comm)
+    {
+        WarpXCommUtil::PersistentFillBoundary(mf, mf.nGrowVect(), period,
+                                              WarpX::use_shared_memory_comm);
+    }
     else
     {
         mf.FillBoundary(period);
@@ -110,6 +117,10 @@ void FillBoundary (amrex::MultiFab&          mf,
 
         mixedCopy(mf, mf_tmp, 0, 0, mf.nComp(), mf.nGrowVect());
     }
+    else if (WarpX::use_persistent_comm)
+    {
+        WarpXCommUtil::PersistentFillBoundary(mf, ng, period, WarpX::use_shared_memory_comm);
+    }
     else
     {
         mf.FillBoundary(ng, period);
@@ -139,6 +150,51 @@ FillBoundary (amrex::Vector<amrex::MultiFab*> const& mf, const amrex::Periodicit
     }
 }
 
+void
+FillBoundary (amrex::Vector<amrex::MultiFab*> const& mf,
+              amrex::Vector<amrex::IntVect> const& ng,
+              const amrex::Periodicity& period)
+{
+    BL_PROFILE("WarpXCommUtil::FillBoundary");
+
+    const int nmf = static_cast<int>(mf.size());
+    const amrex::Vector<int> scomp(nmf, 0);
+    amrex::Vector<int> ncomp(nmf);
+    for (int i = 0; i < nmf; ++i) ncomp[i] = mf[i]->nComp();
+    const amrex::Vector<amrex::Periodicity> periods(nmf, period);
+
+    if (WarpX::do_single_precision_comms)
+    {
+        amrex::Vector<amrex::FabArray<amrex::BaseFab<comm_float_type> > > mf_tmp(nmf);
+        amrex::Vector<amrex::FabArray<amrex::BaseFab<comm_float_type> >*> mf_tmp_ptr(nmf);
+        for (int i = 0; i < nmf; ++i)
+        {
+            mf_tmp[i].define(mf[i]->boxArray(), mf[i]->DistributionMap(), ncomp[i], mf[i]->nGrowVect());
+            mixedCopy(mf_tmp[i], *mf[i], 0, 0, ncomp[i], mf[i]->nGrowVect());
+            mf_tmp_ptr[i] = &mf_tmp[i];
+        }
+
+        amrex::FillBoundary(mf_tmp_ptr, scomp, ncomp, ng, periods);
+
+        for (int i = 0; i < nmf; ++i)
+        {
+            mixedCopy(*mf[i], mf_tmp[i], 0, 0, ncomp[i], mf[i]->nGrowVect());
+        }
+    }
+    else if (WarpX::use_persistent_comm)
+    {
+        // the persistent plans are per MultiFab
+        for (int i = 0; i < nmf; ++i) {
+            WarpXCommUtil::PersistentFillBoundary(*mf[i], ng[i], period, WarpX::use_shared_memory_comm);
+        }
+    }
+    else
+    {
+        amrex::Vector<amrex::FabArray<amrex::FArrayBox>*> mf_fab(mf.begin(), mf.end());
+        amrex::FillBoundary(mf_fab, scomp, ncomp, ng, periods);
+    }
+}
+
 void SumBoundary (amrex::MultiFab& mf, const amrex::Periodicity& period)
 {
     BL_PROFILE("WarpXCommUtil::SumBoundary");
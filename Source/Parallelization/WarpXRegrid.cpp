@@ -8,13 +8,21 @@
  */
 #include "WarpX.H"
 
+#include "BoundaryConditions/PML.H"
 #include "Diagnostics/MultiDiagnostics.H"
 #include "Diagnostics/ReducedDiags/MultiReducedDiags.H"
+#include "FieldSolver/FiniteDifferenceSolver/FiniteDifferenceSolver.H"
+#include "FieldSolver/FiniteDifferenceSolver/MacroscopicProperties/MacroscopicProperties.H"
+#include "FieldSolver/MagThinFilm.H"
 #include "Particles/MultiParticleContainer.H"
 #include "Particles/ParticleBoundaryBuffer.H"
 #include "Particles/WarpXParticleContainer.H"
+#include "Utils/TextMsg.H"
 #include "Utils/WarpXAlgorithmSelection.H"
+#include "Utils/WarpXConst.H"
 #include "Utils/WarpXProfilerWrapper.H"
+#include "CostsBreakdown.H"
+#include "HaloExchangePlan.H"
 
 #include <AMReX.H>
 #include <AMReX_BLassert.H>
@@ -23,6 +31,7 @@
 #include <AMReX_Config.H>
 #include <AMReX_DistributionMapping.H>
 #include <AMReX_FabFactory.H>
+#include <AMReX_GpuDevice.H>
 #include <AMReX_IArrayBox.H>
 #include <AMReX_IndexType.H>
 #include <AMReX_LayoutData.H>
@@ -32,6 +41,9 @@
 #include <AMReX_ParIter.H>
 #include <AMReX_ParallelContext.H>
 #include <AMReX_ParallelDescriptor.H>
+#include <AMReX_Print.H>
+#include <AMReX_Reduce.H>
+#include <AMReX_Utility.H>
 #include <AMReX_REAL.H>
 #include <AMReX_Vector.H>
 #include <AMReX_iMultiFab.H>
@@ -40,12 +52,235 @@
 #include <array>
 #include <cmath>
 #include <cstddef>
+#include <cstdint>
+#include <limits>
 #include <memory>
+#include <numeric>
+#include <string>
 #include <utility>
 #include <vector>
 
 using namespace amrex;
 
+namespace
+{
+    /** Number of points of the valid box of mfi where predicate(mf value) is true */
+    template <typename F>
+    amrex::Long CountPoints (MultiFab const& mf, MFIter const& mfi, F const& predicate)
+    {
+        amrex::Array4<amrex::Real const> const& arr = mf.const_array(mfi);
+        amrex::ReduceOps<amrex::ReduceOpSum> reduce_op;
+        amrex::ReduceData<amrex::Long> reduce_data(reduce_op);
+        using ReduceTuple = typename decltype(reduce_data)::Type;
+        reduce_op.eval(mfi.validbox(), reduce_data,
+            [=] AMREX_GPU_DEVICE (int i, int j, int k) -> ReduceTuple {
+                return predicate(arr(i,j,k)) ? 1 : 0;
+        });
+        return amrex::get<0>(reduce_data.value());
+    }
+
+    /** Position of the point iv along a Morton (Z-order) space filling curve */
+    std::uint64_t MortonKey (amrex::IntVect const& iv)
+    {
+        std::uint64_t key = 0;
+        for (int bit = 0; bit < 21; ++bit) {
+            for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+                key |= ((static_cast<std::uint64_t>(iv[idim]) >> bit) & 1u) << (bit*AMREX_SPACEDIM + idim);
+            }
+        }
+        return key;
+    }
+
+    /** Load balance efficiency of the map pmap for several constraints: the minimum over the
+     *  constraints of the average weight per rank divided by the maximum weight of a rank */
+    amrex::Real MultiConstraintEfficiency (amrex::Vector<int> const& pmap,
+                                           amrex::Vector<amrex::Vector<amrex::Real>> const& weights,
+                                           int nprocs)
+    {
+        amrex::Real efficiency = 1.0;
+        for (auto const& w : weights) {
+            amrex::Vector<amrex::Real> rank_weight(nprocs, 0.0);
+            for (int ibox = 0; ibox < static_cast<int>(pmap.size()); ++ibox) rank_weight[pmap[ibox]] += w[ibox];
+            const amrex::Real max_weight = *std::max_element(rank_weight.begin(), rank_weight.end());
+            if (max_weight <= 0.) continue;
+            const amrex::Real total = std::accumulate(rank_weight.begin(), rank_weight.end(), amrex::Real(0));
+            efficiency = std::min(efficiency, total / (nprocs * max_weight));
+        }
+        return efficiency;
+    }
+
+    /** Distribute the boxes of ba over nprocs ranks, by cutting a Morton curve through the boxes
+     *  in nprocs contiguous pieces, so that each rank gets about the same share of each of the
+     *  constraints, whose per-box weights are weights[c][ibox]. The cut between two ranks is put
+     *  where the cumulated shares of the constraints are the closest, in the L1 norm, to their
+     *  target, so that a constraint whose work is concentrated in a few boxes (e.g. a magnetic
+     *  slab or the PML shell) is spread over the ranks while halo neighbors stay together. */
+    amrex::Vector<int> MultiConstraintSFC (amrex::BoxArray const& ba,
+                                           amrex::Vector<amrex::Vector<amrex::Real>> const& weights,
+                                           int nprocs)
+    {
+        const int nboxes = static_cast<int>(ba.size());
+        const amrex::IntVect domain_lo = ba.minimalBox().smallEnd();
+        amrex::Vector<std::pair<std::uint64_t, int>> curve(nboxes);
+        for (int ibox = 0; ibox < nboxes; ++ibox) {
+            curve[ibox] = std::make_pair(MortonKey(ba[ibox].smallEnd() - domain_lo), ibox);
+        }
+        std::sort(curve.begin(), curve.end());
+
+        // shares of the constraints with some work, the number of boxes if none has
+        amrex::Vector<amrex::Vector<amrex::Real>> share;
+        for (auto const& w : weights) {
+            const amrex::Real total = std::accumulate(w.begin(), w.end(), amrex::Real(0));
+            if (total <= 0.) continue;
+            share.emplace_back(nboxes);
+            for (int ibox = 0; ibox < nboxes; ++ibox) share.back()[ibox] = w[ibox] / total;
+        }
+        if (share.empty()) share.emplace_back(nboxes, amrex::Real(1) / nboxes);
+
+        amrex::Vector<int> pmap(nboxes, 0);
+        amrex::Vector<amrex::Real> cumulated(share.size(), 0.0);
+        int rank = 0;
+        int nboxes_rank = 0;
+        for (auto const& point : curve) {
+            const int ibox = point.second;
+            if (rank < nprocs - 1 && nboxes_rank > 0) {
+                // move to the next rank if adding the box takes the current one further from its target
+                const amrex::Real target = static_cast<amrex::Real>(rank + 1) / nprocs;
+                amrex::Real deviation_without = 0.;
+                amrex::Real deviation_with = 0.;
+                for (std::size_t c = 0; c < share.size(); ++c) {
+                    deviation_without += std::abs(cumulated[c] - target);
+                    deviation_with += std::abs(cumulated[c] + share[c][ibox] - target);
+                }
+                if (deviation_with > deviation_without) {
+                    ++rank;
+                    nboxes_rank = 0;
+                }
+            }
+            pmap[ibox] = rank;
+            ++nboxes_rank;
+            for (std::size_t c = 0; c < share.size(); ++c) cumulated[c] += share[c][ibox];
+        }
+        return pmap;
+    }
+
+    /** Ranks of the two groups of the partitioned load balance (algo.load_balance_mag_ranks):
+     *  the ranks mag_first to mag_last for the boxes with magnetic material, the other ranks for
+     *  the other boxes, or all the ranks for a group if the other group is empty */
+    std::pair<amrex::Vector<int>, amrex::Vector<int>>
+    PartitionRanks (bool has_magnetic_boxes, int mag_first, int mag_last, int nprocs)
+    {
+        amrex::Vector<int> mag_ranks;
+        amrex::Vector<int> other_ranks;
+        for (int rank = 0; rank < nprocs; ++rank) {
+            if (rank >= mag_first && rank <= mag_last) mag_ranks.push_back(rank);
+            else other_ranks.push_back(rank);
+        }
+        if (!has_magnetic_boxes || other_ranks.empty()) {
+            other_ranks.resize(nprocs);
+            std::iota(other_ranks.begin(), other_ranks.end(), 0);
+        }
+        return std::make_pair(mag_ranks, other_ranks);
+    }
+
+    /** Distribute the boxes of ba in two groups balanced independently, each with
+     *  MultiConstraintSFC: the boxes flagged in magnetic on the ranks mag_first to mag_last, and
+     *  the other boxes on the other ranks, see PartitionRanks. The two groups only communicate
+     *  through the guard cells of the fields at the boundary of the magnetic sub-domain. */
+    amrex::Vector<int> PartitionedSFC (amrex::BoxArray const& ba,
+                                       amrex::Vector<amrex::Vector<amrex::Real>> const& weights,
+                                       amrex::Vector<int> const& magnetic,
+                                       int mag_first, int mag_last, int nprocs)
+    {
+        const int nboxes = static_cast<int>(ba.size());
+        const bool has_magnetic_boxes = std::any_of(magnetic.begin(), magnetic.end(), [] (int m) { return m != 0; });
+        auto const ranks = PartitionRanks(has_magnetic_boxes, mag_first, mag_last, nprocs);
+
+        amrex::Vector<int> pmap(nboxes, 0);
+        for (int group = 0; group < 2; ++group) {
+            amrex::Vector<int> const& group_ranks = (group == 0) ? ranks.first : ranks.second;
+            amrex::BoxList bl(ba.ixType());
+            amrex::Vector<int> group_boxes;
+            amrex::Vector<amrex::Vector<amrex::Real>> group_weights(weights.size());
+            for (int ibox = 0; ibox < nboxes; ++ibox) {
+                if ((magnetic[ibox] != 0) != (group == 0)) continue;
+                bl.push_back(ba[ibox]);
+                group_boxes.push_back(ibox);
+                for (std::size_t c = 0; c < weights.size(); ++c) group_weights[c].push_back(weights[c][ibox]);
+            }
+            if (group_boxes.empty()) continue;
+            const amrex::Vector<int> group_pmap = MultiConstraintSFC(
+                amrex::BoxArray(std::move(bl)), group_weights, static_cast<int>(group_ranks.size()));
+            for (std::size_t i = 0; i < group_boxes.size(); ++i) pmap[group_boxes[i]] = group_ranks[group_pmap[i]];
+        }
+        return pmap;
+    }
+
+    /** Whether each box of pmap is on a rank of its group of the partitioned load balance */
+    bool IsPartitioned (amrex::Vector<int> const& pmap, amrex::Vector<int> const& magnetic,
+                        int mag_first, int mag_last, int nprocs)
+    {
+        const bool has_magnetic_boxes = std::any_of(magnetic.begin(), magnetic.end(), [] (int m) { return m != 0; });
+        auto const ranks = PartitionRanks(has_magnetic_boxes, mag_first, mag_last, nprocs);
+        for (std::size_t ibox = 0; ibox < pmap.size(); ++ibox) {
+            amrex::Vector<int> const& group_ranks = (magnetic[ibox] != 0) ? ranks.first : ranks.second;
+            if (std::find(group_ranks.begin(), group_ranks.end(), pmap[ibox]) == group_ranks.end()) return false;
+        }
+        return true;
+    }
+
+    /** Chop in halves, recursively, the boxes of ba whose weight weights[0][ibox] exceeds
+     *  split_factor times the mean weight of the boxes, along their longest direction that can
+     *  be halved in multiples of blocking_factor, until the pieces are light enough or too small
+     *  to be halved. The pieces are smaller than the boxes, hence than max_grid_size, and the
+     *  weights of a box are shared by its pieces in proportion to their number of cells.
+     *  Returns whether a box was chopped. */
+    bool SplitOverloadedBoxes (amrex::BoxArray& ba,
+                               amrex::Vector<amrex::Vector<amrex::Real>>& weights,
+                               amrex::Real split_factor, amrex::IntVect const& blocking_factor)
+    {
+        const int nboxes = static_cast<int>(ba.size());
+        const amrex::Real mean_weight = std::accumulate(weights[0].begin(), weights[0].end(),
+                                                        amrex::Real(0)) / nboxes;
+        if (mean_weight <= 0.) return false;
+
+        amrex::BoxList new_boxes(ba.ixType());
+        amrex::Vector<amrex::Vector<amrex::Real>> new_weights(weights.size());
+        bool split = false;
+        for (int ibox = 0; ibox < nboxes; ++ibox) {
+            const amrex::Box& box = ba[ibox];
+            amrex::Vector<amrex::Box> pieces{box};
+            for (std::size_t ipiece = 0; ipiece < pieces.size(); ) {
+                const amrex::Box piece = pieces[ipiece];
+                const amrex::Real piece_weight = weights[0][ibox] * piece.d_numPts() / box.d_numPts();
+                int dir = -1;
+                for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+                    if (piece.length(idim) >= 2*blocking_factor[idim]
+                        && (dir < 0 || piece.length(idim) > piece.length(dir))) dir = idim;
+                }
+                if (piece_weight <= split_factor * mean_weight || dir < 0) {
+                    ++ipiece;
+                    continue;
+                }
+                const int half = (piece.length(dir) / (2*blocking_factor[dir])) * blocking_factor[dir];
+                pieces.push_back(pieces[ipiece].chop(dir, piece.smallEnd(dir) + half));
+                split = true;
+            }
+            for (amrex::Box const& piece : pieces) {
+                new_boxes.push_back(piece);
+                for (std::size_t c = 0; c < weights.size(); ++c) {
+                    new_weights[c].push_back(weights[c][ibox] * piece.d_numPts() / box.d_numPts());
+                }
+            }
+        }
+        if (split) {
+            ba = amrex::BoxArray(std::move(new_boxes));
+            weights = std::move(new_weights);
+        }
+        return split;
+    }
+}
+
 void
 WarpX::LoadBalance ()
 {
@@ -61,6 +296,16 @@ WarpX::LoadBalance ()
         ComputeCostsHeuristic(costs);
     }
 
+    // With algo.load_balance_predictive, the wall-clock time per step since the previous load
+    // balance, from which the time saved by a new distribution mapping is predicted
+    amrex::Real step_time = -1.0;
+    if (load_balance_predictive && m_load_balance_prev_step >= 0 && istep[0] > m_load_balance_prev_step)
+    {
+        step_time = (amrex::second() - m_load_balance_prev_time) / (istep[0] - m_load_balance_prev_step);
+    }
+    // time spent in remaking the levels and redistributing the particles
+    amrex::Real migration_time = 0.0;
+
     // By default, do not do a redistribute; this toggles to true if RemakeLevel
     // is called for any level
     int loadBalancedAnyLevel = false;
@@ -72,24 +317,78 @@ WarpX::LoadBalance ()
 
         // Compute the new distribution mapping
         DistributionMapping newdm;
-        const amrex::Real nboxes = costs[lev]->size();
+        BoxArray newba = boxArray(lev);
+        amrex::Real nboxes = costs[lev]->size();
         const amrex::Real nprocs = ParallelContext::NProcsSub();
-        const int nmax = static_cast<int>(std::ceil(nboxes/nprocs*load_balance_knapsack_factor));
         // These store efficiency (meaning, the  average 'cost' over all ranks,
         // normalized to max cost) for current and proposed distribution mappings
         amrex::Real currentEfficiency = 0.0;
         amrex::Real proposedEfficiency = 0.0;
 
-        newdm = (load_balance_with_sfc)
-            ? DistributionMapping::makeSFC(*costs[lev],
-                                           currentEfficiency, proposedEfficiency,
-                                           false,
-                                           ParallelDescriptor::IOProcessorNumber())
-            : DistributionMapping::makeKnapSack(*costs[lev],
-                                                currentEfficiency, proposedEfficiency,
-                                                nmax,
-                                                false,
-                                                ParallelDescriptor::IOProcessorNumber());
+        // The boxes of level 0 whose costs are too large are chopped before being distributed,
+        // which changes the BoxArray, and is only done without mesh refinement
+        const bool do_split = (load_balance_split_factor > 0.) && (lev == 0) && (finest_level == 0);
+        // the boxes of level 0 with magnetic material are balanced on their own ranks
+        const bool do_partition = (lev == 0) && !load_balance_mag_ranks.empty();
+        bool split_boxes = false;
+        bool force_partition = false;
+        Vector<Vector<Real>> weights;
+        Vector<Vector<Real>> current_weights;
+        if (load_balance_multi_constraint || do_split || do_partition) {
+            weights = LoadBalanceConstraints(lev);
+            // with the partition, the magnetic boxes are flagged from the LLG faces, weights[1], first
+            if (!load_balance_multi_constraint && !do_partition) weights.resize(1);
+            current_weights = weights;
+        }
+        if (do_split) {
+            split_boxes = SplitOverloadedBoxes(newba, weights, load_balance_split_factor, blockingFactor(lev));
+            nboxes = newba.size();
+        }
+        Vector<int> magnetic_boxes;
+        if (do_partition) {
+            for (int ibox = 0; ibox < static_cast<int>(nboxes); ++ibox) {
+                magnetic_boxes.push_back(weights[1][ibox] > 0. ? 1 : 0);
+            }
+            // only the costs are balanced by the single-constraint algorithms
+            if (!load_balance_multi_constraint) {
+                weights.resize(1);
+                current_weights.resize(1);
+            }
+        }
+        const int nmax = static_cast<int>(std::ceil(nboxes/nprocs*load_balance_knapsack_factor));
+
+        if (load_balance_multi_constraint || split_boxes || do_partition) {
+            // the weights are known on all ranks, which all compute the same map
+            const int nranks = ParallelDescriptor::NProcs();
+            Vector<int> pmap;
+            if (do_partition) {
+                pmap = PartitionedSFC(newba, weights, magnetic_boxes,
+                                      load_balance_mag_ranks[0], load_balance_mag_ranks[1], nranks);
+                // a map that does not keep the magnetic boxes on their ranks is replaced, whatever its efficiency
+                force_partition = !split_boxes && !IsPartitioned(DistributionMap(lev).ProcessorMap(), magnetic_boxes,
+                                                                 load_balance_mag_ranks[0], load_balance_mag_ranks[1], nranks);
+            } else if (load_balance_multi_constraint) {
+                pmap = MultiConstraintSFC(newba, weights, nranks);
+            } else if (load_balance_with_sfc) {
+                pmap = DistributionMapping::makeSFC(weights[0], newba, proposedEfficiency).ProcessorMap();
+            } else {
+                pmap = DistributionMapping::makeKnapSack(weights[0], proposedEfficiency, nmax).ProcessorMap();
+            }
+            currentEfficiency = MultiConstraintEfficiency(DistributionMap(lev).ProcessorMap(), current_weights, nranks);
+            proposedEfficiency = MultiConstraintEfficiency(pmap, weights, nranks);
+            newdm = DistributionMapping(pmap);
+        } else {
+            newdm = (load_balance_with_sfc)
+                ? DistributionMapping::makeSFC(*costs[lev],
+                                               currentEfficiency, proposedEfficiency,
+                                               false,
+                                               ParallelDescriptor::IOProcessorNumber())
+                : DistributionMapping::makeKnapSack(*costs[lev],
+                                                    currentEfficiency, proposedEfficiency,
+                                                    nmax,
+                                                    false,
+                                                    ParallelDescriptor::IOProcessorNumber());
+        }
         // As specified in the above calls to makeSFC and makeKnapSack, the new
         // distribution mapping is NOT communicated to all ranks; the loadbalanced
         // dm is up-to-date only on root, and we can decide whether to broadcast
@@ -97,8 +396,26 @@ WarpX::LoadBalance ()
             && (ParallelDescriptor::MyProc() == ParallelDescriptor::IOProcessorNumber()))
         {
             doLoadBalance = (proposedEfficiency > load_balance_efficiency_ratio_threshold*currentEfficiency);
+
+            // only migrate if the time saved over the next interval, the time per step scaling as
+            // the inverse of the efficiency, pays back the time spent in the previous migration
+            if (doLoadBalance && step_time > 0.0 && m_load_balance_migration_time >= 0.0)
+            {
+                const amrex::Real predicted_saving = step_time * (1.0 - currentEfficiency/proposedEfficiency)
+                    * load_balance_intervals.localPeriod(istep[0]+1);
+                doLoadBalance = (predicted_saving > m_load_balance_migration_time);
+                if (!doLoadBalance && verbose)
+                {
+                    amrex::Print() << Utils::TextMsg::Info(
+                        "LoadBalance: level " + std::to_string(lev) + " not remade, the predicted saving of "
+                        + std::to_string(predicted_saving) + " s is lower than the migration time of "
+                        + std::to_string(m_load_balance_migration_time) + " s");
+                }
+            }
         }
 
+        if (force_partition) doLoadBalance = true;
+
         ParallelDescriptor::Bcast(&doLoadBalance, 1,
                                   ParallelDescriptor::IOProcessorNumber());
 
@@ -119,7 +436,11 @@ WarpX::LoadBalance ()
                 newdm = DistributionMapping(pmap);
             }
 
-            RemakeLevel(lev, t_new[lev], boxArray(lev), newdm);
+            amrex::Gpu::synchronize();
+            const amrex::Real remake_start = amrex::second();
+            RemakeLevel(lev, t_new[lev], newba, newdm);
+            amrex::Gpu::synchronize();
+            migration_time += amrex::second() - remake_start;
 
             // Record the load balance efficiency
             setLoadBalanceEfficiency(lev, proposedEfficiency);
@@ -129,80 +450,157 @@ WarpX::LoadBalance ()
     }
     if (loadBalancedAnyLevel)
     {
+        const amrex::Real redistribute_start = amrex::second();
         mypc->Redistribute();
         mypc->defineAllParticleTiles();
 
         // redistribute particle boundary buffer
         m_particle_boundary_buffer->redistribute();
+        amrex::Gpu::synchronize();
+        migration_time += amrex::second() - redistribute_start;
 
         // diagnostics & reduced diagnostics
         // not yet needed:
         //multi_diags->LoadBalance();
         reduced_diags->LoadBalance();
     }
+
+    if (load_balance_predictive)
+    {
+        // the migration is as slow as the slowest rank
+        if (loadBalancedAnyLevel)
+        {
+            ParallelDescriptor::ReduceRealMax(migration_time);
+            m_load_balance_migration_time = migration_time;
+        }
+        m_load_balance_prev_time = amrex::second();
+        m_load_balance_prev_step = istep[0];
+    }
 #endif
 }
 
 
 template <typename MultiFabType> void
-RemakeMultiFab (std::unique_ptr<MultiFabType>& mf, const DistributionMapping& dm,
+RemakeMultiFab (std::unique_ptr<MultiFabType>& mf, const BoxArray& ba, const DistributionMapping& dm,
                 const bool redistribute)
 {
     if (mf == nullptr) return;
     const IntVect& ng = mf->nGrowVect();
-    auto pmf = std::make_unique<MultiFabType>(mf->boxArray(), dm, mf->nComp(), ng);
-    if (redistribute) pmf->Redistribute(*mf, 0, 0, mf->nComp(), ng);
+    const BoxArray new_ba = amrex::convert(ba, mf->ixType());
+    // the new MultiFab is allocated in the same arena (e.g. warpx.static_data_memory)
+    auto pmf = std::make_unique<MultiFabType>(new_ba, dm, mf->nComp(), ng,
+                                              MFInfo().SetArena(mf->arena()));
+    if (redistribute) {
+        if (new_ba == mf->boxArray()) {
+            pmf->Redistribute(*mf, 0, 0, mf->nComp(), ng);
+        } else {
+            // the guard cells first, then the valid cells, which take precedence where they overlap
+            pmf->ParallelCopy(*mf, 0, 0, mf->nComp(), ng, ng);
+            pmf->ParallelCopy(*mf, 0, 0, mf->nComp(), IntVect(0), ng);
+        }
+    }
     mf = std::move(pmf);
 }
 
+template <typename MultiFabType> void
+RemakeMultiFab (std::unique_ptr<MultiFabType>& mf, const DistributionMapping& dm,
+                const bool redistribute)
+{
+    if (mf == nullptr) return;
+    const BoxArray ba = mf->boxArray();
+    RemakeMultiFab(mf, ba, dm, redistribute);
+}
+
 void
-WarpX::RemakeLevel (int lev, Real /*time*/, const BoxArray& ba, const DistributionMapping& dm)
+WarpX::RemakeLevel (int lev, Real time, const BoxArray& ba, const DistributionMapping& dm)
 {
-    if (ba == boxArray(lev))
+    // the BoxArray is only changed by a load balance that chops the overloaded boxes
+    // (algo.load_balance_split_factor) and at restart (amr.restart_regrid),
+    // which are done without mesh refinement, and by the regrid of the levels advanced in
+    // lockstep (warpx.regrid_int)
+    if (ba == boxArray(lev) || (lev == 0 && finest_level == 0))
     {
-        if (ParallelDescriptor::NProcs() == 1) return;
+        if (ba == boxArray(lev) && ParallelDescriptor::NProcs() == 1) return;
+
+        // the Poisson solvers of the electrostatic solver are rebuilt on the new grids
+        ClearPoissonSolvers();
+
+#ifdef AMREX_USE_EB
+        // the EB grid data only depends on the boxes, so it is moved with them when they are
+        // unchanged, rather than recomputed (the face extensions involve global reductions)
+        const bool redistribute_eb_data = (ba == boxArray(lev));
+#endif
 
         // Fine patch
         for (int idim=0; idim < 3; ++idim)
         {
-            RemakeMultiFab(Bfield_fp[lev][idim], dm, true);
-            RemakeMultiFab(Efield_fp[lev][idim], dm, true);
-            RemakeMultiFab(current_fp[lev][idim], dm, false);
-            RemakeMultiFab(current_store[lev][idim], dm, false);
+            RemakeMultiFab(Bfield_fp[lev][idim], ba, dm, true);
+            RemakeMultiFab(Efield_fp[lev][idim], ba, dm, true);
+            RemakeMultiFab(current_fp[lev][idim], ba, dm, false);
+            RemakeMultiFab(current_store[lev][idim], ba, dm, false);
 
 #ifdef AMREX_USE_EB
             if (WarpX::maxwell_solver_id == MaxwellSolverAlgo::Yee ||
                 WarpX::maxwell_solver_id == MaxwellSolverAlgo::ECT ||
                 WarpX::maxwell_solver_id == MaxwellSolverAlgo::CKC){
-                RemakeMultiFab(m_edge_lengths[lev][idim], dm, false);
-                RemakeMultiFab(m_face_areas[lev][idim], dm, false);
+                RemakeMultiFab(m_edge_lengths[lev][idim], ba, dm, redistribute_eb_data);
+                RemakeMultiFab(m_face_areas[lev][idim], ba, dm, redistribute_eb_data);
                 if(WarpX::maxwell_solver_id == MaxwellSolverAlgo::ECT){
-                    RemakeMultiFab(Venl[lev][idim], dm, false);
-                    RemakeMultiFab(m_flag_info_face[lev][idim], dm, false);
-                    RemakeMultiFab(m_flag_ext_face[lev][idim], dm, false);
-                    RemakeMultiFab(m_area_mod[lev][idim], dm, false);
-                    RemakeMultiFab(ECTRhofield[lev][idim], dm, false);
-                    m_borrowing[lev][idim] = std::make_unique<amrex::LayoutData<FaceInfoBox>>(amrex::convert(ba, Bfield_fp[lev][idim]->ixType().toIntVect()), dm);
+                    RemakeMultiFab(Venl[lev][idim], ba, dm, false);
+                    RemakeMultiFab(m_flag_info_face[lev][idim], ba, dm, redistribute_eb_data);
+                    RemakeMultiFab(m_flag_ext_face[lev][idim], ba, dm, redistribute_eb_data);
+                    RemakeMultiFab(m_area_mod[lev][idim], ba, dm, redistribute_eb_data);
+                    RemakeMultiFab(ECTRhofield[lev][idim], ba, dm, false);
+#ifdef WARPX_MAG_LLG
+                    RemakeMultiFab(m_ect_minus_curlE[lev][idim], ba, dm, false);
+#endif
+                    if (!(redistribute_eb_data && lev == maxLevel())) {
+                        m_borrowing[lev][idim] = std::make_unique<amrex::LayoutData<FaceInfoBox>>(amrex::convert(ba, Bfield_fp[lev][idim]->ixType().toIntVect()), dm);
+                    }
                 }
             }
 #endif
         }
 
-        RemakeMultiFab(F_fp[lev], dm, true);
-        RemakeMultiFab(rho_fp[lev], dm, false);
+        RemakeMultiFab(F_fp[lev], ba, dm, true);
+        RemakeMultiFab(rho_fp[lev], ba, dm, false);
         // phi_fp should be redistributed since we use the solution from
         // the last step as the initial guess for the next solve
-        RemakeMultiFab(phi_fp[lev], dm, true);
+        RemakeMultiFab(phi_fp[lev], ba, dm, true);
+
+#ifdef WARPX_MAG_LLG
+        if (mag_LLG) {
+            for (int idim=0; idim < 3; ++idim)
+            {
+                RemakeMultiFab(Hfield_fp[lev][idim], ba, dm, true);
+                RemakeMultiFab(H_biasfield_fp[lev][idim], ba, dm, true);
+            }
+            if (mag_M_collocated == 1) {
+                // Mfield_fp[lev][1] and [2] alias the single cell-centered Mfield_fp[lev][0]
+                RemakeMultiFab(Mfield_fp[lev][0], ba, dm, true);
+                Mfield_fp[lev][1] = std::make_unique<MultiFab>(*Mfield_fp[lev][0], amrex::make_alias, 0, 3);
+                Mfield_fp[lev][2] = std::make_unique<MultiFab>(*Mfield_fp[lev][0], amrex::make_alias, 0, 3);
+            } else {
+                for (int idim=0; idim < 3; ++idim) {
+                    RemakeMultiFab(Mfield_fp[lev][idim], ba, dm, true);
+                }
+            }
+        }
+#endif
 
 #ifdef AMREX_USE_EB
-        RemakeMultiFab(m_distance_to_eb[lev], dm, false);
+        RemakeMultiFab(m_distance_to_eb[lev], ba, dm, false);
 
         int max_guard = guard_cells.ng_FieldSolver.max();
         m_field_factory[lev] = amrex::makeEBFabFactory(Geom(lev), ba, dm,
                                                        {max_guard, max_guard, max_guard},
                                                        amrex::EBSupport::full);
 
-        InitializeEBGridData(lev);
+        if (redistribute_eb_data && lev == maxLevel() &&
+            WarpX::maxwell_solver_id == MaxwellSolverAlgo::ECT) {
+            RedistributeBorrowing(lev, dm);
+        }
+        InitializeEBGridData(lev, redistribute_eb_data);
 #else
         m_field_factory[lev] = std::make_unique<FArrayBoxFactory>();
 #endif
@@ -226,7 +624,7 @@ WarpX::RemakeLevel (int lev, Real /*time*/, const BoxArray& ba, const Distributi
                                            dm,
                                            dx);
 #   else
-                if ( fft_periodic_single_box == false ) {
+                if ( fft_periodic_single_box == false && fft_global_distributed == false ) {
                     realspace_ba.grow(ngEB);   // add guard cells
                 }
                 bool const pml_flag_false = false;
@@ -251,10 +649,28 @@ WarpX::RemakeLevel (int lev, Real /*time*/, const BoxArray& ba, const Distributi
         } else {
             for (int idim=0; idim < 3; ++idim)
             {
-                RemakeMultiFab(Bfield_aux[lev][idim], dm, false);
-                RemakeMultiFab(Efield_aux[lev][idim], dm, false);
+                RemakeMultiFab(Bfield_aux[lev][idim], ba, dm, false);
+                RemakeMultiFab(Efield_aux[lev][idim], ba, dm, false);
             }
         }
+#ifdef WARPX_MAG_LLG
+        if (mag_LLG) {
+            // the aux fields of H, M and H_bias of level 0 are always aliases of the fp fields
+            for (int idim = 0; idim < 3; ++idim) {
+                if (lev == 0) {
+                    Hfield_aux[lev][idim] = std::make_unique<MultiFab>(*Hfield_fp[lev][idim], amrex::make_alias, 0, Hfield_aux[lev][idim]->nComp());
+                    if (H_biasfield_fp[lev][idim]) {
+                        H_biasfield_aux[lev][idim] = std::make_unique<MultiFab>(*H_biasfield_fp[lev][idim], amrex::make_alias, 0, H_biasfield_aux[lev][idim]->nComp());
+                    }
+                    Mfield_aux[lev][idim] = std::make_unique<MultiFab>(*Mfield_fp[lev][idim], amrex::make_alias, 0, 3);
+                } else {
+                    RemakeMultiFab(Hfield_aux[lev][idim], ba, dm, false);
+                    RemakeMultiFab(H_biasfield_aux[lev][idim], ba, dm, false);
+                    RemakeMultiFab(Mfield_aux[lev][idim], ba, dm, false);
+                }
+            }
+        }
+#endif
 
         // Coarse patch
         if (lev > 0) {
@@ -263,6 +679,11 @@ WarpX::RemakeLevel (int lev, Real /*time*/, const BoxArray& ba, const Distributi
                 RemakeMultiFab(Bfield_cp[lev][idim], dm, true);
                 RemakeMultiFab(Efield_cp[lev][idim], dm, true);
                 RemakeMultiFab(current_cp[lev][idim], dm, false);
+#ifdef WARPX_MAG_LLG
+                RemakeMultiFab(Hfield_cp[lev][idim], dm, true);
+                RemakeMultiFab(H_biasfield_cp[lev][idim], dm, true);
+                RemakeMultiFab(Mfield_cp[lev][idim], dm, true);
+#endif
             }
             RemakeMultiFab(F_cp[lev], dm, true);
             RemakeMultiFab(rho_cp[lev], dm, false);
@@ -329,13 +750,39 @@ WarpX::RemakeLevel (int lev, Real /*time*/, const BoxArray& ba, const Distributi
             }
         }
 
+#if defined(WARPX_MAG_LLG) && !defined(WARPX_DIM_RZ)
+        // the work arrays of the 2nd-order LLG solver are re-allocated on the new layout at the next push
+        if (m_fdtd_solver_fp[lev]) m_fdtd_solver_fp[lev]->ClearLLGScratch();
+#endif
+#if defined(WARPX_MAG_LLG) && defined(WARPX_DIM_3D)
+        if (m_mag_thin_film && lev == 0) m_mag_thin_film->RemakeLevel(ba, dm);
+#endif
+
+        if (WarpX::em_solver_medium == MediumForEM::Macroscopic) {
+            m_macroscopic_properties[lev]->RemakeLevel(ba, dm);
+        }
+
+        if (ba != boxArray(lev)) {
+            // the PML boxes are kept, only their costs are attributed to the new boxes
+            if (do_pml && pml[lev]) pml[lev]->RemakeGridBoxMap(ba);
+            SetBoxArray(lev, ba);
+        }
         SetDistributionMap(lev, dm);
 
+    } else if (lev > 0 && MRLockstep())
+    {
+        RegridLockstepLevel(lev, time, ba, dm);
     } else
     {
         amrex::Abort("RemakeLevel: to be implemented");
     }
 
+    InvalidateDeepHalo();
+    // the communication plans, the kernel graphs and the temporaries of the reallocated fields are stale
+    WarpXCommUtil::ClearHaloExchangePlans();
+    ClearKernelGraphs();
+    m_scratch_mfs.Clear(lev);
+
     // Re-initialize diagnostic functors that stores pointers to the user-requested fields at level, lev.
     multi_diags->InitializeFieldFunctors( lev );
 
@@ -343,6 +790,81 @@ WarpX::RemakeLevel (int lev, Real /*time*/, const BoxArray& ba, const Distributi
     // not needed yet
 }
 
+void
+WarpX::RegridLevels (Real time)
+{
+    WARPX_PROFILE("WarpX::RegridLevels()");
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(MRLockstep(),
+        "warpx.regrid_int > 0 is only implemented with the mesh refinement of the LLG solver");
+
+    const int old_finest_level = finest_level;
+    regrid(0, time);
+    // the levels that are not tagged anymore are removed
+    for (int lev = finest_level+1; lev <= old_finest_level; ++lev) {
+        if (do_pml) pml[lev].reset();
+    }
+    mypc->Redistribute();
+}
+
+void
+WarpX::RegridLockstepLevel (int lev, Real time, const BoxArray& ba, const DistributionMapping& dm)
+{
+    WARPX_PROFILE("WarpX::RegridLockstepLevel()");
+#ifdef WARPX_MAG_LLG
+    // the fields on the old boxes, if the level existed
+    std::array<std::unique_ptr<MultiFab>, 3> E_old, B_old, H_old, M_old, H_bias_old;
+    const bool level_exists = (lev <= finest_level && Efield_fp[lev][0] != nullptr);
+    if (level_exists) {
+        E_old = std::move(Efield_fp[lev]);
+        B_old = std::move(Bfield_fp[lev]);
+        H_old = std::move(Hfield_fp[lev]);
+        M_old = std::move(Mfield_fp[lev]);
+        H_bias_old = std::move(H_biasfield_fp[lev]);
+        ClearLevel(lev);
+    }
+
+    AllocLevelData(lev, ba, dm);
+    SetBoxArray(lev, ba);
+    SetDistributionMap(lev, dm);
+    t_new[lev] = t_new[lev-1];
+    t_old[lev] = t_old[lev-1];
+    istep[lev] = istep[lev-1];
+
+    // the fields are interpolated from level lev-1 on the new boxes, and copied from the old
+    // boxes where they overlap, so that the refined values are kept where the level stays
+    auto const refill = [&] (amrex::Vector<std::array<std::unique_ptr<MultiFab>, 3>>& field,
+                             std::array<std::unique_ptr<MultiFab>, 3> const& old, int nmf) {
+        if (field[lev][0] == nullptr) return;
+        FillCoarseFineBoundary(field, lev, nmf, true);
+        if (!level_exists) return;
+        for (int i = 0; i < nmf; ++i) {
+            field[lev][i]->ParallelCopy(*old[i], 0, 0, field[lev][i]->nComp(), IntVect(0), IntVect(0),
+                                        Geom(lev).periodicity());
+        }
+    };
+    refill(Efield_fp, E_old, 3);
+    refill(Bfield_fp, B_old, 3);
+    refill(Hfield_fp, H_old, 3);
+    refill(Mfield_fp, M_old, (mag_M_collocated == 1) ? 1 : 3);
+    refill(H_biasfield_fp, H_bias_old, 3);
+    // B is computed again from H and M where it is read
+    m_Bfield_outdated = true;
+
+    // the properties are evaluated again from their inputs on the new boxes
+    m_macroscopic_properties[lev]->InitData(lev);
+    m_macroscopic_properties[lev]->UpdateTimeDependentProperties(istep[lev], time);
+
+    // the PML of the level, where it meets the PML of the domain, starts again from zero
+    if (do_pml) {
+        InitPMLLevel(lev);
+        pml[lev]->ComputePMLFactors(dt[lev]);
+    }
+#else
+    amrex::ignore_unused(lev, time, ba, dm);
+    amrex::Abort(Utils::TextMsg::Err("RegridLockstepLevel requires the LLG solver"));
+#endif
+}
+
 void
 WarpX::ComputeCostsHeuristic (amrex::Vector<std::unique_ptr<amrex::LayoutData<amrex::Real> > >& a_costs)
 {
@@ -370,6 +892,182 @@ WarpX::ComputeCostsHeuristic (amrex::Vector<std::unique_ptr<amrex::LayoutData<am
             const Box& gbx = mfi.growntilebox();
             (*a_costs[lev])[mfi.index()] += costs_heuristic_cells_wt*gbx.numPts();
         }
+
+        // Material loop
+        if (WarpX::em_solver_medium == MediumForEM::Macroscopic) {
+            MacroscopicProperties& macroscopic = GetMacroscopicProperties(lev);
+
+#ifdef WARPX_MAG_LLG
+            if (mag_LLG && costs_heuristic_mag_wt > 0.) {
+                // number of evaluations of the LLG right-hand side per step
+                amrex::Real n_eval = amrex::Real(1);
+                if (mag_time_scheme_order == 2) {
+                    n_eval = std::max(amrex::Real(1), m_fdtd_solver_fp[lev]->GetLLGAverageIterations());
+                } else if (mag_time_scheme_order == 5) {
+                    n_eval = amrex::Real(6);
+                }
+                for (int idim = 0; idim < 3; ++idim) {
+                    MultiFab const& Ms = macroscopic.getmag_Ms_mf(idim);
+                    for (MFIter mfi(Ms, false); mfi.isValid(); ++mfi) {
+                        if (!macroscopic.has_magnetic_material(mfi.index())) continue;
+                        const amrex::Long n_mag = CountPoints(Ms, mfi,
+                            [] AMREX_GPU_DEVICE (amrex::Real Ms_val) { return Ms_val > amrex::Real(0); });
+                        (*a_costs[lev])[mfi.index()] += costs_heuristic_mag_wt*n_eval*n_mag;
+                    }
+                }
+            }
+#endif
+            if (costs_heuristic_sigma_wt > 0.) {
+                MultiFab const& sigma = *macroscopic.get_pointer_sigma();
+                for (MFIter mfi(sigma, false); mfi.isValid(); ++mfi) {
+                    const amrex::Long n_sigma = CountPoints(sigma, mfi,
+                        [] AMREX_GPU_DEVICE (amrex::Real sigma_val) { return sigma_val > amrex::Real(0); });
+                    (*a_costs[lev])[mfi.index()] += costs_heuristic_sigma_wt*n_sigma;
+                }
+            }
+            if (costs_heuristic_eps_wt > 0.) {
+                MultiFab const& eps = *macroscopic.get_pointer_eps();
+                for (MFIter mfi(eps, false); mfi.isValid(); ++mfi) {
+                    const amrex::Long n_eps = CountPoints(eps, mfi,
+                        [] AMREX_GPU_DEVICE (amrex::Real eps_val) {
+                            return std::abs(eps_val - PhysConst::ep0) > amrex::Real(1.e-6)*PhysConst::ep0; });
+                    (*a_costs[lev])[mfi.index()] += costs_heuristic_eps_wt*n_eps;
+                }
+            }
+        }
+    }
+}
+
+amrex::Vector<amrex::Vector<amrex::Real>>
+WarpX::LoadBalanceConstraints (int lev)
+{
+    const int nboxes = static_cast<int>(costs[lev]->size());
+    amrex::Vector<amrex::Vector<amrex::Real>> weights(3, amrex::Vector<amrex::Real>(nboxes, 0.0));
+
+    // total costs
+    for (int ibox : costs[lev]->IndexArray()) weights[0][ibox] = (*costs[lev])[ibox];
+
+    // faces updated by the LLG solver
+    weights[1] = MagneticFacesPerBox(lev);
+    ParallelDescriptor::ReduceRealSum(weights[0].data(), nboxes);
+    ParallelDescriptor::ReduceRealSum(weights[1].data(), nboxes);
+
+    // PML cells, attributed to the boxes of the level next to them
+    if (do_pml && pml[lev] && pml[lev]->ok()) weights[2] = pml[lev]->CellsPerGridBox(nboxes);
+
+    return weights;
+}
+
+amrex::Vector<amrex::Real>
+WarpX::MagneticFacesPerBox (int lev)
+{
+    amrex::Vector<amrex::Real> n_mag(costs[lev]->size(), 0.0);
+
+#ifdef WARPX_MAG_LLG
+    if (mag_LLG) {
+        MacroscopicProperties& macroscopic = GetMacroscopicProperties(lev);
+        for (int idim = 0; idim < 3; ++idim) {
+            MultiFab const& Ms = macroscopic.getmag_Ms_mf(idim);
+            for (MFIter mfi(Ms, false); mfi.isValid(); ++mfi) {
+                if (!macroscopic.has_magnetic_material(mfi.index())) continue;
+                n_mag[mfi.index()] += static_cast<amrex::Real>(CountPoints(Ms, mfi,
+                    [] AMREX_GPU_DEVICE (amrex::Real Ms_val) { return Ms_val > amrex::Real(0); }));
+            }
+        }
+    }
+#else
+    amrex::ignore_unused(lev);
+#endif
+    return n_mag;
+}
+
+bool
+WarpX::StepPhaseBegin (int phase)
+{
+    if (!m_step_phase_timers || m_step_phase >= 0) return false;
+
+    m_step_phase = phase;
+    ablastr::profiler::device_synchronize(WarpX::do_device_synchronize);
+    m_step_phase_start_time = amrex::second();
+    return true;
+}
+
+void
+WarpX::StepPhaseEnd ()
+{
+    ablastr::profiler::device_synchronize(WarpX::do_device_synchronize);
+    m_step_phase_times[m_step_phase] += amrex::second() - m_step_phase_start_time;
+    m_step_phase = -1;
+}
+
+void
+WarpX::StepPhaseStart ()
+{
+    std::fill(m_step_phase_times.begin(), m_step_phase_times.end(), 0.0);
+}
+
+void
+WarpX::StepPhaseRecord (amrex::Real step_time)
+{
+    m_step_phase_times_last = m_step_phase_times;
+    m_step_time_last = step_time;
+
+    double num_cells = 0.;
+    for (int lev = 0; lev <= finest_level; ++lev) num_cells += boxArray(lev).d_numPts();
+    long llg_iterations = 0;
+#if !(defined WARPX_DIM_RZ) && (defined WARPX_MAG_LLG)
+    llg_iterations = m_fdtd_solver_fp[0]->GetLLGTotalIterations();
+#endif
+    m_step_cost_model.Record(step_time, m_step_phase_times, num_cells, llg_iterations);
+}
+
+long
+WarpX::RemainingSteps () const
+{
+    long remaining = static_cast<long>(max_step) - istep[0];
+    if (stop_time < std::numeric_limits<amrex::Real>::max() && dt[0] > 0.) {
+        const amrex::Real steps_to_stop = std::ceil((stop_time - t_new[0]) / dt[0]);
+        if (steps_to_stop < static_cast<amrex::Real>(remaining)) remaining = static_cast<long>(steps_to_stop);
+    }
+    return std::max(remaining, 0L);
+}
+
+void
+WarpX::PrintThroughputReport (int step) const
+{
+    const StepCostModel::Summary s = getThroughput();
+    if (s.num_steps == 0) return;
+    amrex::Print() << "STEP " << step+1 << " throughput over the last " << s.num_steps << " steps: "
+                   << s.steps_per_second << " steps/s, "
+                   << s.cell_updates_per_second << " cells*steps/s";
+#ifdef WARPX_MAG_LLG
+    if (mag_LLG) amrex::Print() << ", " << s.llg_iterations_per_second << " LLG iterations/s";
+#endif
+    amrex::Print() << "\n"
+                   << "STEP " << step+1 << " projected wall-clock time to the end of the run: "
+                   << s.projected_time << " s (" << s.remaining_steps << " steps of "
+                   << s.step_time << " s)\n";
+}
+
+amrex::LayoutData<amrex::Real> const*
+WarpX::getCostsBreakdown (int lev, int phase) const
+{
+    if (lev >= static_cast<int>(m_costs_breakdown.size()) || m_costs_breakdown[lev].empty()) return nullptr;
+    // the breakdown of grids that have changed is out of date
+    if (!costs[lev] || m_costs_breakdown[lev][phase]->boxArray() != costs[lev]->boxArray() ||
+        m_costs_breakdown[lev][phase]->DistributionMap() != costs[lev]->DistributionMap()) return nullptr;
+    return m_costs_breakdown[lev][phase].get();
+}
+
+void
+WarpX::ResetCostsBreakdown ()
+{
+    for (auto& breakdown : m_costs_breakdown)
+    {
+        for (auto& bd : breakdown)
+        {
+            for (int i : bd->IndexArray()) (*bd)[i] = 0.0;
+        }
     }
 }
 
@@ -18,7 +18,10 @@
 #include <AMReX_REAL.H>
 #include <AMReX_Vector.H>
 
+#include <algorithm>
+#include <cmath>
 #include <string>
+#include <vector>
 
 BackgroundMCCCollision::BackgroundMCCCollision (std::string const collision_name)
     : CollisionBase(collision_name)
@@ -149,35 +152,64 @@ BackgroundMCCCollision::BackgroundMCCCollision (std::string const collision_name
 #endif
 }
 
-/** Calculate the maximum collision frequency using a fixed energy grid that
- *  ranges from 1e-4 to 5000 eV in 0.2 eV increments
+/** Calculate the maximum collision frequency for energies from 1e-4 to 5000 eV.
+ *  The total cross-section is linear between the energies of the cross-section
+ *  tables, so the maximum of sigma(E)*sqrt(E) is found exactly by evaluating it
+ *  at these energies and where its derivative vanishes between them.
  */
 amrex::Real
 BackgroundMCCCollision::get_nu_max(amrex::Vector<MCCProcess> const& mcc_processes)
 {
     using namespace amrex::literals;
-    amrex::Real nu, nu_max = 0.0;
+    const amrex::Real E_min = 1e-4_rt;
+    const amrex::Real E_max = 5000._rt;
 
-    for (amrex::Real E = 1e-4_rt; E < 5000._rt; E+=0.2_rt) {
+    // total collision cross-section
+    auto sigma_total = [&mcc_processes] (amrex::Real E) {
         amrex::Real sigma_E = 0.0;
-
         // loop through all collision pathways
         for (const auto &scattering_process : mcc_processes) {
             // get collision cross-section
             sigma_E += scattering_process.getCrossSection(E);
         }
-
-        // calculate collision frequency
-        nu = (
-              m_max_background_density
-              * std::sqrt(2.0_rt / m_mass1 * PhysConst::q_e)
-              * sigma_E * std::sqrt(E)
-              );
-        if (nu > nu_max) {
-            nu_max = nu;
+        return sigma_E;
+    };
+
+    // energies at which the slope of the total cross-section can change
+    std::vector<amrex::Real> E_nodes{E_min, E_max};
+    for (const auto &scattering_process : mcc_processes) {
+        for (const amrex::Real E : scattering_process.energies()) {
+            if (E > E_min && E < E_max) E_nodes.push_back(E);
         }
     }
-    return nu_max;
+    std::sort(E_nodes.begin(), E_nodes.end());
+    E_nodes.erase(std::unique(E_nodes.begin(), E_nodes.end()), E_nodes.end());
+
+    amrex::Real sigma_0 = sigma_total(E_nodes[0]);
+    amrex::Real sigma_sqrtE_max = sigma_0 * std::sqrt(E_nodes[0]);
+    for (std::size_t i = 1; i < E_nodes.size(); i++) {
+        const amrex::Real E_0 = E_nodes[i-1];
+        const amrex::Real E_1 = E_nodes[i];
+        const amrex::Real sigma_1 = sigma_total(E_1);
+        sigma_sqrtE_max = std::max(sigma_sqrtE_max, sigma_1 * std::sqrt(E_1));
+        // with sigma = a + b*E, the derivative of sigma*sqrt(E) vanishes at E = -a/(3*b)
+        const amrex::Real b = (sigma_1 - sigma_0)/(E_1 - E_0);
+        if (b < 0._rt) {
+            const amrex::Real a = sigma_0 - b*E_0;
+            const amrex::Real E_star = -a/(3._rt*b);
+            if (E_star > E_0 && E_star < E_1) {
+                sigma_sqrtE_max = std::max(sigma_sqrtE_max, (a + b*E_star) * std::sqrt(E_star));
+            }
+        }
+        sigma_0 = sigma_1;
+    }
+
+    // calculate collision frequency
+    return (
+            m_max_background_density
+            * std::sqrt(2.0_rt / m_mass1 * PhysConst::q_e)
+            * sigma_sqrtE_max
+            );
 }
 
 void
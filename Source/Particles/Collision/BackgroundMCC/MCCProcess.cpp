@@ -9,6 +9,9 @@
 #include "Utils/TextMsg.H"
 #include "WarpX.H"
 
+#include <algorithm>
+#include <cmath>
+
 MCCProcess::MCCProcess (
                         const std::string& scattering_process,
                         const std::string& cross_section_file,
@@ -41,6 +44,20 @@ void
 MCCProcess::init (const std::string& scattering_process, const amrex::Real energy)
 {
     using namespace amrex::literals;
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(m_energies.size() >= 2 && m_energies.size() == m_sigmas_h.size(),
+                                     "The cross-section data must have at least 2 energies.");
+
+    // cross-sections given with unequal energy steps are interpolated onto
+    // a uniform energy grid, so that they are looked up with a direct index
+    const amrex::Real dE_input = (m_energies.back() - m_energies.front())/(m_energies.size() - 1._rt);
+    if (!isEnergyGridUniform(m_energies, dE_input)) {
+        resampleOnUniformEnergyGrid(m_energies, m_sigmas_h);
+        amrex::Print() << Utils::TextMsg::Info(
+            "The " + scattering_process + " cross-section energies are not evenly spaced:"
+            + " the cross-section is interpolated onto " + std::to_string(m_energies.size())
+            + " evenly spaced energies.");
+    }
+
     m_exe_h.m_sigmas_data = m_sigmas_h.data();
 
     // save energy grid parameters for easy use
@@ -120,10 +137,56 @@ MCCProcess::sanityCheckEnergyGrid (
 {
     // confirm that the input data for the cross-section was provided with
     // equal energy steps, otherwise the linear interpolation will fail
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(isEnergyGridUniform(energies, dE),
+                                     "Energy grid not evenly spaced.");
+}
+
+bool
+MCCProcess::isEnergyGridUniform (
+                                 const amrex::Vector<amrex::Real>& energies,
+                                 amrex::Real dE
+                                 )
+{
     for (unsigned i = 1; i < energies.size(); i++) {
-        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(
-                                         (std::abs(energies[i] - energies[i-1] - dE) < dE / 100.0),
-                                         "Energy grid not evenly spaced."
-                                         );
+        if (std::abs(energies[i] - energies[i-1] - dE) >= dE / 100.0) return false;
+    }
+    return true;
+}
+
+void
+MCCProcess::resampleOnUniformEnergyGrid (
+                                         amrex::Vector<amrex::Real>& energies,
+                                         amrex::Gpu::HostVector<amrex::Real>& sigmas
+                                         )
+{
+    using namespace amrex::literals;
+
+    // smallest energy step of the input data
+    amrex::Real dE_min = energies.back() - energies.front();
+    for (unsigned i = 1; i < energies.size(); i++) {
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(energies[i] > energies[i-1],
+                                         "The cross-section energies must be increasing.");
+        dE_min = std::min(dE_min, energies[i] - energies[i-1]);
+    }
+
+    const amrex::Real energy_lo = energies.front();
+    const amrex::Real energy_hi = energies.back();
+    const int grid_size = static_cast<int>(std::min(
+        std::ceil((energy_hi - energy_lo)/dE_min) + 1._rt,
+        static_cast<amrex::Real>(max_resampled_grid_size)));
+    const amrex::Real dE = (energy_hi - energy_lo)/(grid_size - 1._rt);
+
+    amrex::Vector<amrex::Real> new_energies(grid_size);
+    amrex::Gpu::HostVector<amrex::Real> new_sigmas(grid_size);
+    for (int i = 0; i < grid_size; i++) {
+        const amrex::Real E = (i == grid_size - 1) ? energy_hi : energy_lo + i*dE;
+        // first input energy strictly larger than E, within [1, size-1]
+        const auto it = std::upper_bound(energies.begin() + 1, energies.end() - 1, E);
+        const auto k = static_cast<std::size_t>(it - energies.begin());
+        const amrex::Real w = (E - energies[k-1])/(energies[k] - energies[k-1]);
+        new_energies[i] = E;
+        new_sigmas[i] = sigmas[k-1] + (sigmas[k] - sigmas[k-1])*w;
     }
+    energies = std::move(new_energies);
+    sigmas = std::move(new_sigmas);
 }
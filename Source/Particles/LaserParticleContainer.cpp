@@ -34,8 +34,11 @@
 #include <AMReX_GpuDevice.H>
 #include <AMReX_GpuLaunch.H>
 #include <AMReX_GpuQualifiers.H>
+#include <AMReX_IndexType.H>
 #include <AMReX_IntVect.H>
 #include <AMReX_LayoutData.H>
+#include <AMReX_MFIter.H>
+#include <AMReX_MultiFab.H>
 #include <AMReX_PODVector.H>
 #include <AMReX_ParIter.H>
 #include <AMReX_ParallelDescriptor.H>
@@ -224,6 +227,34 @@ LaserParticleContainer::LaserParticleContainer (AmrCore* amr_core, int ispecies,
         }
     }
 
+    pp_laser_name.query("direct_current_injection", m_direct_current);
+    if (m_direct_current) {
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(!do_continuous_injection && WarpX::gamma_boost <= 1._rt,
+            "direct_current_injection requires an antenna at rest: no continuous injection "
+            "and no boosted frame");
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(WarpX::maxwell_solver_id != MaxwellSolverAlgo::PSATD,
+            "direct_current_injection does not deposit the charge, required by the PSATD solver");
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(maxLevel() == 0,
+            "direct_current_injection is not implemented with mesh refinement");
+#if defined(WARPX_DIM_RZ)
+        amrex::Abort(Utils::TextMsg::Err("direct_current_injection is not implemented in RZ"));
+#endif
+        // The normal must be along one of the axes of the grid
+        int normal_comp = -1;
+        for (int comp = 0; comp < 3; ++comp) {
+            if (std::abs(std::abs(m_nvec[comp]) - 1._rt) < 1.e-12_rt) normal_comp = comp;
+        }
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(normal_comp >= 0,
+            "direct_current_injection requires a laser direction along x, y or z");
+#if defined(WARPX_DIM_3D)
+        m_direct_current_dir = normal_comp;
+#elif defined(WARPX_DIM_XZ)
+        m_direct_current_dir = (normal_comp == 2) ? 1 : 0;
+#else
+        m_direct_current_dir = 0;
+#endif
+    }
+
     //Init laser profile
 
     AMREX_ALWAYS_ASSERT_WITH_MESSAGE(m_e_max >= 0.,
@@ -323,6 +354,21 @@ LaserParticleContainer::InitData ()
 {
     if (!m_enabled) return;
 
+    if (m_direct_current) {
+        // No particles: the antenna only has to be in the domain
+        const int normal_comp = AMREX_SPACEDIM == 3 ? m_direct_current_dir :
+                                (m_direct_current_dir == AMREX_SPACEDIM-1 ? 2 : 0);
+        const Real z0 = m_position[normal_comp];
+        if (z0 < m_laser_injection_box.lo(m_direct_current_dir) ||
+            z0 > m_laser_injection_box.hi(m_direct_current_dir)) {
+            WarpX::GetInstance().RecordWarning("Laser",
+                "The antenna is completely out of the simulation box for laser " + m_laser_name,
+                WarnPriority::high);
+            m_enabled = false;
+        }
+        return;
+    }
+
     // Call InitData on max level to inject one laser particle per
     // finest cell.
     InitData(maxLevel());
@@ -545,6 +591,11 @@ LaserParticleContainer::Evolve (int lev,
     // Update laser profile
     m_up_laser_profile->update(t);
 
+    if (m_direct_current) {
+        if (!skip_deposition) DepositDirectCurrent(lev, jx, jy, jz, t_lab);
+        return;
+    }
+
     BL_ASSERT(OnSameGrids(lev,jx));
 
     amrex::LayoutData<amrex::Real>* cost = WarpX::getCosts(lev);
@@ -660,6 +711,113 @@ LaserParticleContainer::Evolve (int lev,
     }
 }
 
+void
+LaserParticleContainer::DepositDirectCurrent (int lev, MultiFab& jx, MultiFab& jy, MultiFab& jz,
+                                              Real t_lab)
+{
+    WARPX_PROFILE("LaserParticleContainer::DepositDirectCurrent()");
+
+    const auto plo = Geom(lev).ProbLoArray();
+    const auto dx = Geom(lev).CellSizeArray();
+    const int dir = m_direct_current_dir;
+    const int normal_comp = AMREX_SPACEDIM == 3 ? dir : (dir == AMREX_SPACEDIM-1 ? 2 : 0);
+    const Real z0 = m_position[normal_comp];
+
+    const Real tmp_position_0 = m_position[0];
+    const Real tmp_position_1 = m_position[1];
+    const Real tmp_position_2 = m_position[2];
+    const Real tmp_u_X_0 = m_u_X[0];
+    const Real tmp_u_X_1 = m_u_X[1];
+    const Real tmp_u_X_2 = m_u_X[2];
+    const Real tmp_u_Y_0 = m_u_Y[0];
+    const Real tmp_u_Y_1 = m_u_Y[1];
+    const Real tmp_u_Y_2 = m_u_Y[2];
+
+    std::array<MultiFab*,3> const j_fields = {&jx, &jy, &jz};
+    Gpu::DeviceVector<Real> plane_Xp, plane_Yp, amplitude_E;
+
+    for (int comp = 0; comp < 3; ++comp)
+    {
+        if (m_p_X[comp] == 0._rt) continue;
+        // Surface current 2 epsilon_0 c E p_X, as a current density over one cell
+        const Real factor = 2._rt * PhysConst::ep0 * PhysConst::c * m_p_X[comp] / dx[dir];
+
+        const IndexType ixtype = j_fields[comp]->ixType();
+        const Real s_plane = (z0 - plo[dir])/dx[dir] - (ixtype.nodeCentered(dir) ? 0._rt : 0.5_rt);
+        const int k0 = static_cast<int>(std::floor(s_plane));
+        const Real frac = s_plane - static_cast<Real>(k0);
+        const amrex::GpuArray<Real,AMREX_SPACEDIM> shift {AMREX_D_DECL(
+            ixtype.nodeCentered(0) ? 0._rt : 0.5_rt,
+            ixtype.nodeCentered(1) ? 0._rt : 0.5_rt,
+            ixtype.nodeCentered(2) ? 0._rt : 0.5_rt)};
+
+        for (MFIter mfi(*j_fields[comp], TilingIfNotGPU()); mfi.isValid(); ++mfi)
+        {
+            const Box& tb = mfi.tilebox();
+            if (k0+1 < tb.smallEnd(dir) || k0 > tb.bigEnd(dir)) continue;
+
+            // Points of the tile in the antenna plane
+            Box sb = tb;
+            sb.setSmall(dir, k0);
+            sb.setBig(dir, k0);
+            const int np = static_cast<int>(sb.numPts());
+            plane_Xp.resize(np);
+            plane_Yp.resize(np);
+            amplitude_E.resize(np);
+            Real* const AMREX_RESTRICT pplane_Xp = plane_Xp.dataPtr();
+            Real* const AMREX_RESTRICT pplane_Yp = plane_Yp.dataPtr();
+
+            amrex::ParallelFor(np, [=] AMREX_GPU_DEVICE (int ip)
+            {
+                const IntVect iv = sb.atOffset(ip);
+                amrex::GpuArray<Real,AMREX_SPACEDIM> r;
+                for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+                    r[idim] = plo[idim] + (static_cast<Real>(iv[idim]) + shift[idim])*dx[idim];
+                }
+#if defined(WARPX_DIM_3D)
+                const Real x = r[0] - tmp_position_0;
+                const Real y = r[1] - tmp_position_1;
+                const Real z = r[2] - tmp_position_2;
+#elif defined(WARPX_DIM_XZ) || defined(WARPX_DIM_RZ)
+                const Real x = r[0] - tmp_position_0;
+                const Real y = 0._rt;
+                const Real z = r[1] - tmp_position_2;
+                amrex::ignore_unused(tmp_position_1);
+#else
+                const Real x = 0._rt;
+                const Real y = 0._rt;
+                const Real z = r[0] - tmp_position_2;
+                amrex::ignore_unused(tmp_position_0, tmp_position_1);
+#endif
+                pplane_Xp[ip] = tmp_u_X_0*x + tmp_u_X_1*y + tmp_u_X_2*z;
+                pplane_Yp[ip] = tmp_u_Y_0*x + tmp_u_Y_1*y + tmp_u_Y_2*z;
+            });
+
+            m_up_laser_profile->fill_amplitude(
+                np, plane_Xp.dataPtr(), plane_Yp.dataPtr(), t_lab, amplitude_E.dataPtr());
+
+            // Linear weights of the two grid planes around the antenna
+            const Real* const AMREX_RESTRICT pamplitude = amplitude_E.dataPtr();
+            auto const& j_arr = j_fields[comp]->array(mfi);
+            const int klo = tb.smallEnd(dir);
+            const int khi = tb.bigEnd(dir);
+            amrex::ParallelFor(np, [=] AMREX_GPU_DEVICE (int ip)
+            {
+                IntVect iv = sb.atOffset(ip);
+                for (int kk = 0; kk < 2; ++kk) {
+                    iv[dir] = k0 + kk;
+                    if (iv[dir] < klo || iv[dir] > khi) continue;
+                    const Real w = (kk == 0) ? 1._rt - frac : frac;
+                    j_arr(iv) += factor * w * pamplitude[ip];
+                }
+            });
+
+            // This is necessary because of plane_Xp, plane_Yp and amplitude_E
+            amrex::Gpu::synchronize();
+        }
+    }
+}
+
 void
 LaserParticleContainer::PostRestart ()
 {
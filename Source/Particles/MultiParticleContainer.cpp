@@ -32,6 +32,7 @@
 #include "Particles/RigidInjectedParticleContainer.H"
 #include "Particles/WarpXParticleContainer.H"
 #include "SpeciesPhysicalProperties.H"
+#include "Utils/TextMsg.H"
 #include "Utils/WarpXAlgorithmSelection.H"
 #include "Utils/WarpXProfilerWrapper.H"
 #ifdef AMREX_USE_EB
@@ -66,9 +67,14 @@
 #include <AMReX_Vector.H>
 
 #include <algorithm>
+#include <array>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
 #include <limits>
 #include <map>
+#include <sstream>
 #include <string>
 #include <utility>
 #include <vector>
@@ -82,6 +88,156 @@ namespace
     {
         Array4< amrex::Real const > const Ex, Ey, Ez, Bx, By, Bz;
     };
+
+#ifdef WARPX_QED
+    /** Parameters of the Quantum Synchrotron lookup tables, to identify a saved table */
+    std::string QuantumSyncTableKey (PicsarQuantumSyncCtrl const& ctrl)
+    {
+        std::stringstream key;
+        key.precision(17);
+        key << "quantum_sync " << sizeof(amrex::Real)
+            << " " << ctrl.dndt_params.chi_part_min << " " << ctrl.dndt_params.chi_part_max
+            << " " << ctrl.dndt_params.chi_part_how_many
+            << " " << ctrl.phot_em_params.chi_part_min << " " << ctrl.phot_em_params.chi_part_max
+            << " " << ctrl.phot_em_params.chi_part_how_many
+            << " " << ctrl.phot_em_params.frac_min << " " << ctrl.phot_em_params.frac_how_many;
+        return key.str();
+    }
+
+    /** Parameters of the Breit-Wheeler lookup tables, to identify a saved table */
+    std::string BreitWheelerTableKey (PicsarBreitWheelerCtrl const& ctrl)
+    {
+        std::stringstream key;
+        key.precision(17);
+        key << "breit_wheeler " << sizeof(amrex::Real)
+            << " " << ctrl.dndt_params.chi_phot_min << " " << ctrl.dndt_params.chi_phot_max
+            << " " << ctrl.dndt_params.chi_phot_how_many
+            << " " << ctrl.pair_prod_params.chi_phot_min << " " << ctrl.pair_prod_params.chi_phot_max
+            << " " << ctrl.pair_prod_params.chi_phot_how_many
+            << " " << ctrl.pair_prod_params.frac_how_many;
+        return key.str();
+    }
+
+    /** Whether the lookup table file \p table_name exists and was saved with the
+     *  parameters \p key, recorded in the file <table_name>.key */
+    bool IsSavedTableUpToDate (std::string const& table_name, std::string const& key)
+    {
+        bool is_up_to_date = false;
+        if (ParallelDescriptor::IOProcessor()) {
+            std::ifstream table_file(table_name, std::ios::binary);
+            std::ifstream key_file(table_name + ".key");
+            if (table_file.good() && key_file.good()) {
+                std::stringstream saved_key;
+                saved_key << key_file.rdbuf();
+                is_up_to_date = (saved_key.str() == key);
+            }
+        }
+        ParallelDescriptor::ReduceBoolOr(is_up_to_date);
+        return is_up_to_date;
+    }
+
+    /** Record the parameters \p key of the lookup table saved in \p table_name */
+    void SaveTableKey (std::string const& table_name, std::string const& key)
+    {
+        std::ofstream key_file(table_name + ".key");
+        key_file << key;
+    }
+
+    /** \brief Pack the lookup tables \p data exported by a QED engine with their values in single
+     *  precision. The data are the size of the first table (uint64), and the two serialized
+     *  tables, each ending with its \p nvals values in amrex::Real, which are the logarithms of
+     *  the tabulated functions. Returns the largest relative error of these functions. */
+    amrex::Real PackTableSinglePrecision (std::vector<char> const& data,
+                                          std::array<std::size_t, 2> const& nvals,
+                                          Vector<char>& packed)
+    {
+        constexpr std::size_t shrink = sizeof(amrex::Real) - sizeof(float);
+        std::uint64_t size_first = 0;
+        std::memcpy(&size_first, data.data(), sizeof(size_first));
+        const std::array<std::size_t, 3> bounds = {sizeof(size_first), sizeof(size_first) + size_first, data.size()};
+
+        const std::uint64_t packed_size_first = size_first - nvals[0]*shrink;
+        packed.resize(sizeof(packed_size_first));
+        std::memcpy(packed.data(), &packed_size_first, sizeof(packed_size_first));
+
+        amrex::Real max_error = 0._rt;
+        for (int t = 0; t < 2; ++t) {
+            WARPX_ALWAYS_ASSERT_WITH_MESSAGE(bounds[t+1] - bounds[t] >= nvals[t]*sizeof(amrex::Real),
+                "Unexpected layout of the QED lookup table data");
+            const std::size_t vals_begin = bounds[t+1] - nvals[t]*sizeof(amrex::Real);
+            packed.insert(packed.end(), data.begin() + bounds[t], data.begin() + vals_begin);
+            for (std::size_t i = 0; i < nvals[t]; ++i) {
+                amrex::Real val;
+                std::memcpy(&val, data.data() + vals_begin + i*sizeof(amrex::Real), sizeof(val));
+                // the logarithm of a zero value is the lowest Real, which is out of the range of float
+                constexpr auto lowest = static_cast<amrex::Real>(std::numeric_limits<float>::lowest());
+                const auto val_single = static_cast<float>(std::max(val, lowest));
+                if (val > lowest) {
+                    max_error = std::max(max_error,
+                        std::abs(std::exp(static_cast<amrex::Real>(val_single) - val) - 1._rt));
+                }
+                char bytes[sizeof(float)];
+                std::memcpy(bytes, &val_single, sizeof(float));
+                packed.insert(packed.end(), bytes, bytes + sizeof(float));
+            }
+        }
+        return max_error;
+    }
+
+    /** \brief Unpack the lookup tables \p packed by PackTableSinglePrecision, with their values
+     *  promoted back to amrex::Real, in the format of the data exported by the QED engines */
+    Vector<char> UnpackTableSinglePrecision (Vector<char> const& packed,
+                                             std::array<std::size_t, 2> const& nvals)
+    {
+        constexpr std::size_t shrink = sizeof(amrex::Real) - sizeof(float);
+        std::uint64_t packed_size_first = 0;
+        std::memcpy(&packed_size_first, packed.data(), sizeof(packed_size_first));
+        const std::array<std::size_t, 3> bounds = {sizeof(packed_size_first),
+            sizeof(packed_size_first) + packed_size_first, packed.size()};
+
+        const std::uint64_t size_first = packed_size_first + nvals[0]*shrink;
+        Vector<char> data(sizeof(size_first));
+        std::memcpy(data.data(), &size_first, sizeof(size_first));
+
+        for (int t = 0; t < 2; ++t) {
+            WARPX_ALWAYS_ASSERT_WITH_MESSAGE(bounds[t+1] - bounds[t] >= nvals[t]*sizeof(float),
+                "The single-precision QED lookup table does not match its parameters");
+            const std::size_t vals_begin = bounds[t+1] - nvals[t]*sizeof(float);
+            data.insert(data.end(), packed.begin() + bounds[t], packed.begin() + vals_begin);
+            for (std::size_t i = 0; i < nvals[t]; ++i) {
+                float val_single;
+                std::memcpy(&val_single, packed.data() + vals_begin + i*sizeof(float), sizeof(float));
+                const auto val = static_cast<amrex::Real>(val_single);
+                char bytes[sizeof(amrex::Real)];
+                std::memcpy(bytes, &val, sizeof(amrex::Real));
+                data.insert(data.end(), bytes, bytes + sizeof(amrex::Real));
+            }
+        }
+        return data;
+    }
+
+    /** \brief Write the lookup tables \p data exported by a QED engine to \p table_name, with their
+     *  \p nvals values in single precision if \p single_precision, in which case the largest relative
+     *  error of the tabulated functions must not exceed \p tolerance. Called by the I/O rank. */
+    void WriteTableFile (std::string const& table_name, std::vector<char> const& data,
+                         bool single_precision, std::array<std::size_t, 2> const& nvals,
+                         amrex::Real tolerance)
+    {
+        if (!single_precision) {
+            WarpXUtilIO::WriteBinaryDataOnFile(table_name, Vector<char>{data.begin(), data.end()});
+            return;
+        }
+        Vector<char> packed;
+        const amrex::Real error = PackTableSinglePrecision(data, nvals, packed);
+        amrex::Print() << Utils::TextMsg::Info(
+            "The lookup table " + table_name + " is saved in single precision, with a relative error of "
+            + std::to_string(error));
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(error <= tolerance,
+            "The relative error of the single-precision lookup table " + table_name
+            + " exceeds table_tolerance");
+        WarpXUtilIO::WriteBinaryDataOnFile(table_name, packed);
+    }
+#endif
 }
 
 MultiParticleContainer::MultiParticleContainer (AmrCore* amr_core)
@@ -590,6 +746,40 @@ MultiParticleContainer::RedistributeLocal (const int num_ghost)
     }
 }
 
+void
+MultiParticleContainer::RedistributeNeighbors ()
+{
+    WARPX_PROFILE("MultiParticleContainer::RedistributeNeighbors()");
+
+    if (allcontainers.empty()) return;
+
+    const amrex::BoxArray& ba = allcontainers[0]->ParticleBoxArray(0);
+    int num_ghost = std::numeric_limits<int>::max();
+    for (int i = 0; i < static_cast<int>(ba.size()); ++i) {
+        num_ghost = std::min(num_ghost, ba[i].shortside());
+    }
+
+    // Whether all the particles are within num_ghost cells of their tile
+    bool is_local = true;
+    for (auto& pc : allcontainers) {
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion()) reduction(&&:is_local)
+#endif
+        for (WarpXParIter pti(*pc, 0); pti.isValid(); ++pti) {
+            if (amrex::numParticlesOutOfRange(pti, amrex::IntVect(num_ghost)) > 0) {
+                is_local = false;
+            }
+        }
+    }
+    amrex::ParallelDescriptor::ReduceBoolAnd(is_local);
+
+    if (is_local) {
+        RedistributeLocal(num_ghost);
+    } else {
+        Redistribute();
+    }
+}
+
 void
 MultiParticleContainer::ApplyBoundaryConditions ()
 {
@@ -1046,11 +1236,7 @@ void MultiParticleContainer::InitQuantumSync ()
         WarpX::GetInstance().RecordWarning("QED",
             "A new Quantum Synchrotron table will be generated.",
             WarnPriority::low);
-#ifndef WARPX_QED_TABLE_GEN
-        amrex::Error("Error: Compile with QED_TABLE_GEN=TRUE to enable table generation!\n");
-#else
         QuantumSyncGenerateTable();
-#endif
     }
     else if(lookup_table_mode == "load"){
         std::string load_table_name;
@@ -1104,11 +1290,7 @@ void MultiParticleContainer::InitBreitWheeler ()
         WarpX::GetInstance().RecordWarning("QED",
             "A new Breit Wheeler table will be generated.",
             WarnPriority::low);
-#ifndef WARPX_QED_TABLE_GEN
-        amrex::Error("Error: Compile with QED_TABLE_GEN=TRUE to enable table generation!\n");
-#else
         BreitWheelerGenerateTable();
-#endif
     }
     else if(lookup_table_mode == "load"){
         std::string load_table_name;
@@ -1156,67 +1338,90 @@ MultiParticleContainer::QuantumSyncGenerateTable ()
     amrex::Real qs_minimum_chi_part;
     getWithParser(pp_qed_qs, "chi_min", qs_minimum_chi_part);
 
-    if(ParallelDescriptor::IOProcessor()){
-        PicsarQuantumSyncCtrl ctrl;
-
-        //==Table parameters==
-
-        //--- sub-table 1 (1D)
-        //These parameters are used to pre-compute a function
-        //which appears in the evolution of the optical depth
-
-        //Minimun chi for the table. If a lepton has chi < tab_dndt_chi_min,
-        //chi is considered as if it were equal to tab_dndt_chi_min
-        getWithParser(pp_qed_qs, "tab_dndt_chi_min", ctrl.dndt_params.chi_part_min);
-
-        //Maximum chi for the table. If a lepton has chi > tab_dndt_chi_max,
-        //chi is considered as if it were equal to tab_dndt_chi_max
-        getWithParser(pp_qed_qs, "tab_dndt_chi_max", ctrl.dndt_params.chi_part_max);
-
-        //How many points should be used for chi in the table
-        getWithParser(pp_qed_qs, "tab_dndt_how_many", ctrl.dndt_params.chi_part_how_many);
-        //------
-
-        //--- sub-table 2 (2D)
-        //These parameters are used to pre-compute a function
-        //which is used to extract the properties of the generated
-        //photons.
-
-        //Minimun chi for the table. If a lepton has chi < tab_em_chi_min,
-        //chi is considered as if it were equal to tab_em_chi_min
-        getWithParser(pp_qed_qs, "tab_em_chi_min", ctrl.phot_em_params.chi_part_min);
-
-        //Maximum chi for the table. If a lepton has chi > tab_em_chi_max,
-        //chi is considered as if it were equal to tab_em_chi_max
-        getWithParser(pp_qed_qs, "tab_em_chi_max", ctrl.phot_em_params.chi_part_max);
-
-        //How many points should be used for chi in the table
-        getWithParser(pp_qed_qs, "tab_em_chi_how_many", ctrl.phot_em_params.chi_part_how_many);
-
-        //The other axis of the table is the ratio between the quantum
-        //parameter of the emitted photon and the quantum parameter of the
-        //lepton. This parameter is the minimum ratio to consider for the table.
-        getWithParser(pp_qed_qs, "tab_em_frac_min", ctrl.phot_em_params.frac_min);
-
-        //This parameter is the number of different points to consider for the second
-        //axis
-        getWithParser(pp_qed_qs, "tab_em_frac_how_many", ctrl.phot_em_params.frac_how_many);
-        //====================
-
-        m_shr_p_qs_engine->compute_lookup_tables(ctrl, qs_minimum_chi_part);
-        const auto data = m_shr_p_qs_engine->export_lookup_tables_data();
-        WarpXUtilIO::WriteBinaryDataOnFile(table_name,
-            Vector<char>{data.begin(), data.end()});
+    PicsarQuantumSyncCtrl ctrl;
+
+    //==Table parameters==
+
+    //--- sub-table 1 (1D)
+    //These parameters are used to pre-compute a function
+    //which appears in the evolution of the optical depth
+
+    //Minimun chi for the table. If a lepton has chi < tab_dndt_chi_min,
+    //chi is considered as if it were equal to tab_dndt_chi_min
+    getWithParser(pp_qed_qs, "tab_dndt_chi_min", ctrl.dndt_params.chi_part_min);
+
+    //Maximum chi for the table. If a lepton has chi > tab_dndt_chi_max,
+    //chi is considered as if it were equal to tab_dndt_chi_max
+    getWithParser(pp_qed_qs, "tab_dndt_chi_max", ctrl.dndt_params.chi_part_max);
+
+    //How many points should be used for chi in the table
+    getWithParser(pp_qed_qs, "tab_dndt_how_many", ctrl.dndt_params.chi_part_how_many);
+    //------
+
+    //--- sub-table 2 (2D)
+    //These parameters are used to pre-compute a function
+    //which is used to extract the properties of the generated
+    //photons.
+
+    //Minimun chi for the table. If a lepton has chi < tab_em_chi_min,
+    //chi is considered as if it were equal to tab_em_chi_min
+    getWithParser(pp_qed_qs, "tab_em_chi_min", ctrl.phot_em_params.chi_part_min);
+
+    //Maximum chi for the table. If a lepton has chi > tab_em_chi_max,
+    //chi is considered as if it were equal to tab_em_chi_max
+    getWithParser(pp_qed_qs, "tab_em_chi_max", ctrl.phot_em_params.chi_part_max);
+
+    //How many points should be used for chi in the table
+    getWithParser(pp_qed_qs, "tab_em_chi_how_many", ctrl.phot_em_params.chi_part_how_many);
+
+    //The other axis of the table is the ratio between the quantum
+    //parameter of the emitted photon and the quantum parameter of the
+    //lepton. This parameter is the minimum ratio to consider for the table.
+    getWithParser(pp_qed_qs, "tab_em_frac_min", ctrl.phot_em_params.frac_min);
+
+    //This parameter is the number of different points to consider for the second
+    //axis
+    getWithParser(pp_qed_qs, "tab_em_frac_how_many", ctrl.phot_em_params.frac_how_many);
+    //====================
+
+    // The table can be saved with its values in single precision, within a relative
+    // error table_tolerance of the full precision table
+    bool single_precision = false;
+    pp_qed_qs.query("table_single_precision", single_precision);
+    amrex::Real table_tolerance = 1.e-5_rt;
+    queryWithParser(pp_qed_qs, "table_tolerance", table_tolerance);
+    const std::array<std::size_t, 2> nvals = {
+        static_cast<std::size_t>(ctrl.dndt_params.chi_part_how_many),
+        static_cast<std::size_t>(ctrl.phot_em_params.chi_part_how_many)
+        * static_cast<std::size_t>(ctrl.phot_em_params.frac_how_many)};
+
+    // A table saved by a previous run with the same parameters is reused
+    bool reuse_saved_table = false;
+    pp_qed_qs.query("reuse_saved_table", reuse_saved_table);
+    const std::string table_key = QuantumSyncTableKey(ctrl) + (single_precision ? " single" : "");
+    const bool is_saved_table = reuse_saved_table && IsSavedTableUpToDate(table_name, table_key);
+
+    if(!is_saved_table){
+#ifndef WARPX_QED_TABLE_GEN
+        amrex::Error("Error: Compile with QED_TABLE_GEN=TRUE to enable table generation!\n");
+#endif
+        if(ParallelDescriptor::IOProcessor()){
+            m_shr_p_qs_engine->compute_lookup_tables(ctrl, qs_minimum_chi_part);
+            const auto data = m_shr_p_qs_engine->export_lookup_tables_data();
+            WriteTableFile(table_name, data, single_precision, nvals, table_tolerance);
+            SaveTableKey(table_name, table_key);
+        }
     }
 
     ParallelDescriptor::Barrier();
     Vector<char> table_data;
     ParallelDescriptor::ReadAndBcastFile(table_name, table_data);
     ParallelDescriptor::Barrier();
+    if (single_precision) table_data = UnpackTableSinglePrecision(table_data, nvals);
 
     //No need to initialize from raw data for the processor that
-    //has just generated the table
-    if(!ParallelDescriptor::IOProcessor()){
+    //has just generated the table, unless it was rounded to single precision
+    if(is_saved_table || single_precision || !ParallelDescriptor::IOProcessor()){
         m_shr_p_qs_engine->init_lookup_tables_from_raw_data(
             table_data, qs_minimum_chi_part);
     }
@@ -1237,63 +1442,86 @@ MultiParticleContainer::BreitWheelerGenerateTable ()
     amrex::Real bw_minimum_chi_part;
     getWithParser(pp_qed_bw, "chi_min", bw_minimum_chi_part);
 
-    if(ParallelDescriptor::IOProcessor()){
-        PicsarBreitWheelerCtrl ctrl;
-
-        //==Table parameters==
-
-        //--- sub-table 1 (1D)
-        //These parameters are used to pre-compute a function
-        //which appears in the evolution of the optical depth
-
-        //Minimun chi for the table. If a photon has chi < tab_dndt_chi_min,
-        //an analytical approximation is used.
-        getWithParser(pp_qed_bw, "tab_dndt_chi_min", ctrl.dndt_params.chi_phot_min);
-
-        //Maximum chi for the table. If a photon has chi > tab_dndt_chi_max,
-        //an analytical approximation is used.
-        getWithParser(pp_qed_bw, "tab_dndt_chi_max", ctrl.dndt_params.chi_phot_max);
-
-        //How many points should be used for chi in the table
-        getWithParser(pp_qed_bw, "tab_dndt_how_many", ctrl.dndt_params.chi_phot_how_many);
-        //------
-
-        //--- sub-table 2 (2D)
-        //These parameters are used to pre-compute a function
-        //which is used to extract the properties of the generated
-        //particles.
-
-        //Minimun chi for the table. If a photon has chi < tab_pair_chi_min
-        //chi is considered as it were equal to chi_phot_tpair_min
-        getWithParser(pp_qed_bw, "tab_pair_chi_min", ctrl.pair_prod_params.chi_phot_min);
-
-        //Maximum chi for the table. If a photon has chi > tab_pair_chi_max
-        //chi is considered as it were equal to chi_phot_tpair_max
-        getWithParser(pp_qed_bw, "tab_pair_chi_max", ctrl.pair_prod_params.chi_phot_max);
-
-        //How many points should be used for chi in the table
-        getWithParser(pp_qed_bw, "tab_pair_chi_how_many", ctrl.pair_prod_params.chi_phot_how_many);
-
-        //The other axis of the table is the fraction of the initial energy
-        //'taken away' by the most energetic particle of the pair.
-        //This parameter is the number of different fractions to consider
-        getWithParser(pp_qed_bw, "tab_pair_frac_how_many", ctrl.pair_prod_params.frac_how_many);
-        //====================
-
-        m_shr_p_bw_engine->compute_lookup_tables(ctrl, bw_minimum_chi_part);
-        const auto data = m_shr_p_bw_engine->export_lookup_tables_data();
-        WarpXUtilIO::WriteBinaryDataOnFile(table_name,
-            Vector<char>{data.begin(), data.end()});
+    PicsarBreitWheelerCtrl ctrl;
+
+    //==Table parameters==
+
+    //--- sub-table 1 (1D)
+    //These parameters are used to pre-compute a function
+    //which appears in the evolution of the optical depth
+
+    //Minimun chi for the table. If a photon has chi < tab_dndt_chi_min,
+    //an analytical approximation is used.
+    getWithParser(pp_qed_bw, "tab_dndt_chi_min", ctrl.dndt_params.chi_phot_min);
+
+    //Maximum chi for the table. If a photon has chi > tab_dndt_chi_max,
+    //an analytical approximation is used.
+    getWithParser(pp_qed_bw, "tab_dndt_chi_max", ctrl.dndt_params.chi_phot_max);
+
+    //How many points should be used for chi in the table
+    getWithParser(pp_qed_bw, "tab_dndt_how_many", ctrl.dndt_params.chi_phot_how_many);
+    //------
+
+    //--- sub-table 2 (2D)
+    //These parameters are used to pre-compute a function
+    //which is used to extract the properties of the generated
+    //particles.
+
+    //Minimun chi for the table. If a photon has chi < tab_pair_chi_min
+    //chi is considered as it were equal to chi_phot_tpair_min
+    getWithParser(pp_qed_bw, "tab_pair_chi_min", ctrl.pair_prod_params.chi_phot_min);
+
+    //Maximum chi for the table. If a photon has chi > tab_pair_chi_max
+    //chi is considered as it were equal to chi_phot_tpair_max
+    getWithParser(pp_qed_bw, "tab_pair_chi_max", ctrl.pair_prod_params.chi_phot_max);
+
+    //How many points should be used for chi in the table
+    getWithParser(pp_qed_bw, "tab_pair_chi_how_many", ctrl.pair_prod_params.chi_phot_how_many);
+
+    //The other axis of the table is the fraction of the initial energy
+    //'taken away' by the most energetic particle of the pair.
+    //This parameter is the number of different fractions to consider
+    getWithParser(pp_qed_bw, "tab_pair_frac_how_many", ctrl.pair_prod_params.frac_how_many);
+    //====================
+
+    // The table can be saved with its values in single precision, within a relative
+    // error table_tolerance of the full precision table
+    bool single_precision = false;
+    pp_qed_bw.query("table_single_precision", single_precision);
+    amrex::Real table_tolerance = 1.e-5_rt;
+    queryWithParser(pp_qed_bw, "table_tolerance", table_tolerance);
+    const std::array<std::size_t, 2> nvals = {
+        static_cast<std::size_t>(ctrl.dndt_params.chi_phot_how_many),
+        static_cast<std::size_t>(ctrl.pair_prod_params.chi_phot_how_many)
+        * static_cast<std::size_t>(ctrl.pair_prod_params.frac_how_many)};
+
+    // A table saved by a previous run with the same parameters is reused
+    bool reuse_saved_table = false;
+    pp_qed_bw.query("reuse_saved_table", reuse_saved_table);
+    const std::string table_key = BreitWheelerTableKey(ctrl) + (single_precision ? " single" : "");
+    const bool is_saved_table = reuse_saved_table && IsSavedTableUpToDate(table_name, table_key);
+
+    if(!is_saved_table){
+#ifndef WARPX_QED_TABLE_GEN
+        amrex::Error("Error: Compile with QED_TABLE_GEN=TRUE to enable table generation!\n");
+#endif
+        if(ParallelDescriptor::IOProcessor()){
+            m_shr_p_bw_engine->compute_lookup_tables(ctrl, bw_minimum_chi_part);
+            const auto data = m_shr_p_bw_engine->export_lookup_tables_data();
+            WriteTableFile(table_name, data, single_precision, nvals, table_tolerance);
+            SaveTableKey(table_name, table_key);
+        }
     }
 
     ParallelDescriptor::Barrier();
     Vector<char> table_data;
     ParallelDescriptor::ReadAndBcastFile(table_name, table_data);
     ParallelDescriptor::Barrier();
+    if (single_precision) table_data = UnpackTableSinglePrecision(table_data, nvals);
 
     //No need to initialize from raw data for the processor that
-    //has just generated the table
-    if(!ParallelDescriptor::IOProcessor()){
+    //has just generated the table, unless it was rounded to single precision
+    if(is_saved_table || single_precision || !ParallelDescriptor::IOProcessor()){
         m_shr_p_bw_engine->init_lookup_tables_from_raw_data(
             table_data, bw_minimum_chi_part);
     }
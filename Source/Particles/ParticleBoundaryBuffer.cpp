@@ -10,6 +10,7 @@
 #include "Particles/ParticleBoundaryBuffer.H"
 #include "Particles/MultiParticleContainer.H"
 #include "Particles/Gather/ScalarFieldGather.H"
+#include "Utils/ParticleUtils.H"
 #include "Utils/TextMsg.H"
 #include "Utils/WarpXProfilerWrapper.H"
 
@@ -31,6 +32,8 @@ struct IsOutsideDomainBoundary {
                     int ip, const amrex::RandomEngine& /*engine*/) const noexcept
     {
         const auto& p = src.getSuperParticle(ip);
+        // Invalid particles (e.g. left by the in-place flux injection) are not gathered
+        if (p.id() < 0) { return 0; }
         if (m_iside == 0) {
             if (p.pos(m_idim) < m_plo[m_idim]) { return 1; }
         } else {
@@ -147,7 +150,17 @@ void ParticleBoundaryBuffer::clearParticles () {
         for (int ispecies = 0; ispecies < numSpecies(); ++ispecies)
         {
             auto& species_buffer = buffer[ispecies];
-            if (species_buffer.isDefined()) species_buffer.clearParticles();
+            if (!species_buffer.isDefined()) continue;
+            if (WarpX::particle_slab_size > 0) {
+                // Keep the memory of the tiles, to be reused by the next particles
+                for (int lev = 0; lev < species_buffer.numLevels(); ++lev) {
+                    for (auto& kv : species_buffer.GetParticles(lev)) {
+                        kv.second.resize(0);
+                    }
+                }
+            } else {
+                species_buffer.clearParticles();
+            }
         }
     }
 }
@@ -209,7 +222,9 @@ void ParticleBoundaryBuffer::gatherParticles (MultiParticleContainer& mypc,
                         auto dst_index = ptile_buffer.numParticles();
                         {
                           WARPX_PROFILE("ParticleBoundaryBuffer::gatherParticles::resize");
-                          ptile_buffer.resize(dst_index + amrex::get<0>(reduce_data.value()));
+                          ParticleUtils::resizeWithSlabs(
+                              ptile_buffer, dst_index + amrex::get<0>(reduce_data.value()),
+                              WarpX::particle_slab_size);
                         }
                         {
                           WARPX_PROFILE("ParticleBoundaryBuffer::gatherParticles::filterAndTransform");
@@ -258,9 +273,10 @@ void ParticleBoundaryBuffer::gatherParticles (MultiParticleContainer& mypc,
                 if (np == 0) continue;
 
                 using SrcData = WarpXParticleContainer::ParticleTileType::ConstParticleTileDataType;
-                auto predicate = [=] AMREX_GPU_HOST_DEVICE (const SrcData& /*src*/, const int ip)
+                auto predicate = [=] AMREX_GPU_HOST_DEVICE (const SrcData& src, const int ip)
                 /* NVCC 11.3.109 chokes in C++17 on this: noexcept */
                   {
+                    if (src.m_aos[ip].id() < 0) return 0;
                     amrex::ParticleReal xp, yp, zp;
                     getPosition(ip, xp, yp, zp);
 
@@ -283,7 +299,9 @@ void ParticleBoundaryBuffer::gatherParticles (MultiParticleContainer& mypc,
                 auto dst_index = ptile_buffer.numParticles();
                 {
                   WARPX_PROFILE("ParticleBoundaryBuffer::gatherParticles::resize_eb");
-                  ptile_buffer.resize(dst_index + amrex::get<0>(reduce_data.value()));
+                  ParticleUtils::resizeWithSlabs(
+                      ptile_buffer, dst_index + amrex::get<0>(reduce_data.value()),
+                      WarpX::particle_slab_size);
                 }
 
                 int timestamp_index = ptile_buffer.NumRuntimeIntComps()-1;
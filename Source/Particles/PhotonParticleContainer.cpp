@@ -47,6 +47,9 @@ PhotonParticleContainer::PhotonParticleContainer (AmrCore* amr_core, int ispecie
                                                   const std::string& name)
     : PhysicalParticleContainer(amr_core, ispecies, name)
 {
+    // Photons are pushed by PhotonParticleContainer::PushPX and do not deposit
+    m_fused_push_deposit = false;
+
     ParmParse pp_species_name(species_name);
 
 #ifdef WARPX_QED
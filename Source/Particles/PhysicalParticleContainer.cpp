@@ -15,6 +15,7 @@
 #include "Initialization/InjectorMomentum.H"
 #include "Initialization/InjectorPosition.H"
 #include "MultiParticleContainer.H"
+#include "Particles/Deposition/CurrentDeposition.H"
 #ifdef WARPX_QED
 #   include "Particles/ElementaryProcess/QEDInternals/BreitWheelerEngineWrapper.H"
 #   include "Particles/ElementaryProcess/QEDInternals/QuantumSyncEngineWrapper.H"
@@ -23,15 +24,18 @@
 #include "Particles/Gather/GetExternalFields.H"
 #include "Particles/Pusher/CopyParticleAttribs.H"
 #include "Particles/Pusher/GetAndSetPosition.H"
+#include "Particles/Pusher/PushKernelTable.H"
 #include "Particles/Pusher/PushSelector.H"
 #include "Particles/Pusher/UpdateMomentumBoris.H"
 #include "Particles/Pusher/UpdateMomentumBorisWithRadiationReaction.H"
 #include "Particles/Pusher/UpdateMomentumHigueraCary.H"
 #include "Particles/Pusher/UpdateMomentumVay.H"
 #include "Particles/Pusher/UpdatePosition.H"
+#include "Particles/Sorting/SortingUtils.H"
 #include "Particles/SpeciesPhysicalProperties.H"
 #include "Particles/WarpXParticleContainer.H"
 #include "Utils/IonizationEnergiesTable.H"
+#include "Utils/ParticleUtils.H"
 #include "Utils/TextMsg.H"
 #include "Utils/WarpXAlgorithmSelection.H"
 #include "Utils/WarpXConst.H"
@@ -77,6 +81,7 @@
 #include <AMReX_ParticleTile.H>
 #include <AMReX_Print.H>
 #include <AMReX_Random.H>
+#include <AMReX_Reduce.H>
 #include <AMReX_SPACE.H>
 #include <AMReX_Scan.H>
 #include <AMReX_StructOfArrays.H>
@@ -99,6 +104,7 @@
 #include <cstdlib>
 #include <limits>
 #include <map>
+#include <memory>
 #include <random>
 #include <string>
 #include <utility>
@@ -212,6 +218,63 @@ namespace
 
         p.id() = -1;
     }
+
+    //! No-op epilogue of PhysicalParticleContainer::PushPXWithEpilogue
+    struct NoPushEpilogue
+    {
+        AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
+        void operator() (long /*ip*/) const noexcept {}
+    };
+
+    /**
+     * \brief Bin of warpx.sort_bin_size cells of the particles of a tile after their push, for
+     * the incremental sorting (particles beyond the tile are binned at its edge)
+     */
+    struct SortBinner
+    {
+        ParticleType const* particles = nullptr;
+        int* bin = nullptr;
+        GpuArray<Real,AMREX_SPACEDIM> plo;
+        GpuArray<Real,AMREX_SPACEDIM> dxi;
+        Box cell_box;
+        IntVect bin_size;
+        Box bin_box;
+
+        AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
+        void operator() (long ip) const noexcept
+        {
+            if (bin == nullptr) return;
+            IntVect iv;
+            for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+                const int i = static_cast<int>(
+                    std::floor((particles[ip].pos(idim) - plo[idim])*dxi[idim]));
+                iv[idim] = (amrex::min(amrex::max(i, cell_box.smallEnd(idim)), cell_box.bigEnd(idim))
+                            - cell_box.smallEnd(idim)) / bin_size[idim];
+            }
+            bin[ip] = static_cast<int>(bin_box.index(iv));
+        }
+    };
+
+    /**
+     * \brief Epilogue of the fused push and deposition: deposits the current of the particle
+     * with a DirectDepositionKernel or EsirkepovDepositionKernel, and bins it
+     */
+    template <typename DepositionKernel>
+    struct FusedDeposition
+    {
+        DepositionKernel deposit;
+        GlobalCurrentAdd jx_add;
+        GlobalCurrentAdd jy_add;
+        GlobalCurrentAdd jz_add;
+        SortBinner binner;
+
+        AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
+        void operator() (long ip) const
+        {
+            deposit(ip, jx_add, jy_add, jz_add);
+            binner(ip);
+        }
+    };
 }
 
 PhysicalParticleContainer::PhysicalParticleContainer (AmrCore* amr_core, int ispecies,
@@ -238,6 +301,7 @@ PhysicalParticleContainer::PhysicalParticleContainer (AmrCore* amr_core, int isp
     pp_species_name.query("do_not_deposit", do_not_deposit);
     pp_species_name.query("do_not_gather", do_not_gather);
     pp_species_name.query("do_not_push", do_not_push);
+    m_fused_push_deposit = WarpX::do_fused_push_deposit;
 
     pp_species_name.query("do_continuous_injection", do_continuous_injection);
     pp_species_name.query("initialize_self_fields", initialize_self_fields);
@@ -1243,13 +1307,24 @@ PhysicalParticleContainer::AddPlasmaFlux (amrex::Real dt)
 
     amrex::LayoutData<amrex::Real>* cost = WarpX::getCosts(0);
 
+    const int slab_size = WarpX::particle_slab_size;
+    const bool in_place = WarpX::flux_injection_in_place;
+
     // Create temporary particle container to which particles will be added;
     // we will then call Redistribute on this new container and finally
     // add the new particles to the original container.
-    PhysicalParticleContainer tmp_pc(&WarpX::GetInstance());
-    for (int ic = 0; ic < NumRuntimeRealComps(); ++ic) { tmp_pc.AddRealComp(false); }
-    for (int ic = 0; ic < NumRuntimeIntComps(); ++ic) { tmp_pc.AddIntComp(false); }
-    tmp_pc.defineAllParticleTiles();
+    // With flux_injection_in_place, the particles are directly added to the tiles
+    // of this container, and the invalid ones are removed by the Redistribute
+    // that follows the injection in the PIC loop.
+    std::unique_ptr<PhysicalParticleContainer> tmp_pc;
+    if (in_place) {
+        defineAllParticleTiles();
+    } else {
+        tmp_pc = std::make_unique<PhysicalParticleContainer>(&WarpX::GetInstance());
+        for (int ic = 0; ic < NumRuntimeRealComps(); ++ic) { tmp_pc->AddRealComp(false); }
+        for (int ic = 0; ic < NumRuntimeIntComps(); ++ic) { tmp_pc->AddIntComp(false); }
+        tmp_pc->defineAllParticleTiles();
+    }
 
     const int nlevs = numLevels();
     static bool refine_injection = false;
@@ -1422,11 +1497,12 @@ PhysicalParticleContainer::AddPlasmaFlux (amrex::Real dt)
 
         const int cpuid = ParallelDescriptor::MyProc();
 
-        auto& particle_tile = tmp_pc.DefineAndReturnParticleTile(0, grid_id, tile_id);
+        auto& particle_tile = in_place ? DefineAndReturnParticleTile(0, grid_id, tile_id)
+                                       : tmp_pc->DefineAndReturnParticleTile(0, grid_id, tile_id);
 
         auto old_size = particle_tile.GetArrayOfStructs().size();
         auto new_size = old_size + max_new_particles;
-        particle_tile.resize(new_size);
+        ParticleUtils::resizeWithSlabs(particle_tile, new_size, slab_size);
 
         ParticleType* pp = particle_tile.GetArrayOfStructs()().data() + old_size;
         auto& soa = particle_tile.GetStructOfArrays();
@@ -1635,6 +1711,37 @@ PhysicalParticleContainer::AddPlasmaFlux (amrex::Real dt)
             }
         });
 
+        // With flux_injection_in_place, the invalid particles are left in the tile as holes,
+        // unless they are too many: they are then removed right away, so that the tile
+        // does not keep growing when most of the injected particles are invalid.
+        if (in_place && max_new_particles > 0) {
+            Gpu::DeviceVector<int> is_valid(max_new_particles);
+            int* const AMREX_RESTRICT p_is_valid = is_valid.dataPtr();
+            const ParticleType* const AMREX_RESTRICT p_new = pp;
+            ReduceOps<ReduceOpSum> reduce_op;
+            ReduceData<int> reduce_data(reduce_op);
+            using ReduceTuple = typename decltype(reduce_data)::Type;
+            reduce_op.eval(max_new_particles, reduce_data,
+            [=] AMREX_GPU_DEVICE (int ip) -> ReduceTuple
+            {
+                p_is_valid[ip] = (p_new[ip].id() >= 0) ? 1 : 0;
+                return {1 - p_is_valid[ip]};
+            });
+            const int n_holes = amrex::get<0>(reduce_data.value());
+
+            if (n_holes > WarpX::hole_compaction_threshold*max_new_particles) {
+                ParticleTileType tmp_tile;
+                tmp_tile.define(NumRuntimeRealComps(), NumRuntimeIntComps());
+                tmp_tile.resize(max_new_particles);
+                const int n_valid = amrex::filterParticles(
+                    tmp_tile, particle_tile, p_is_valid, static_cast<int>(old_size), 0,
+                    max_new_particles);
+                amrex::copyParticles(particle_tile, tmp_tile, 0, old_size, n_valid);
+                particle_tile.resize(old_size + n_valid);
+            }
+            amrex::Gpu::streamSynchronize();
+        }
+
         amrex::Gpu::synchronize();
 
         if (cost && WarpX::load_balance_costs_update_algo == LoadBalanceCostsUpdateAlgo::Timers)
@@ -1644,10 +1751,12 @@ PhysicalParticleContainer::AddPlasmaFlux (amrex::Real dt)
         }
     }
 
+    if (in_place) return;
+
     // Redistribute the new particles that were added to the temporary container.
     // (This eliminates invalid particles, and makes sure that particles
     // are in the right tile.)
-    tmp_pc.Redistribute();
+    tmp_pc->Redistribute();
 
     // Add the particles to the current container, tile by tile
     for (int lev=0; lev<numLevels(); lev++) {
@@ -1659,13 +1768,13 @@ PhysicalParticleContainer::AddPlasmaFlux (amrex::Real dt)
             // Extract tiles
             const int grid_id = mfi.index();
             const int tile_id = mfi.LocalTileIndex();
-            auto& src_tile = tmp_pc.DefineAndReturnParticleTile(lev, grid_id, tile_id);
+            auto& src_tile = tmp_pc->DefineAndReturnParticleTile(lev, grid_id, tile_id);
             auto& dst_tile = DefineAndReturnParticleTile(lev, grid_id, tile_id);
 
             // Resize container and copy particles
             auto old_size = dst_tile.numParticles();
             auto n_new = src_tile.numParticles();
-            dst_tile.resize( old_size+n_new );
+            ParticleUtils::resizeWithSlabs(dst_tile, old_size+n_new, slab_size);
             amrex::copyParticles(dst_tile, src_tile, 0, old_size, n_new);
         }
     }
@@ -1695,6 +1804,16 @@ PhysicalParticleContainer::Evolve (int lev,
 
     bool has_buffer = cEx || cjx;
 
+    // Gather, push and current deposition in one pass over the particles, see PushPXAndDepositCurrent
+    const bool fused_push_deposit = m_fused_push_deposit && !do_not_push && !do_not_deposit
+        && !skip_deposition && !has_buffer
+        && (WarpX::current_deposition_algo != CurrentDepositionAlgo::Vay);
+    // The particles are then sorted at each step, moving only the particles out of order
+    // (not with the back-transformed diagnostics, whose data follow the particle indices)
+    const bool sort_incremental = fused_push_deposit && WarpX::sort_incremental
+        && !(WarpX::do_back_transformed_diagnostics && do_back_transformed_diagnostics)
+        && !m_do_back_transformed_particles;
+
     if ( (WarpX::do_back_transformed_diagnostics && do_back_transformed_diagnostics) ||
          (m_do_back_transformed_particles) )
     {
@@ -1721,6 +1840,7 @@ PhysicalParticleContainer::Evolve (int lev,
 
         FArrayBox filtered_Ex, filtered_Ey, filtered_Ez;
         FArrayBox filtered_Bx, filtered_By, filtered_Bz;
+        amrex::Gpu::DeviceVector<int> sort_bin;
 
         for (WarpXParIter pti(*this, lev); pti.isValid(); ++pti)
         {
@@ -1799,7 +1919,22 @@ PhysicalParticleContainer::Evolve (int lev,
                 }
             }
 
-            if (! do_not_push)
+            if (fused_push_deposit)
+            {
+                WARPX_PROFILE_VAR_START(blp_fg);
+                if (sort_incremental) sort_bin.resize(np);
+                PushPXAndDepositCurrent(pti, exfab, eyfab, ezfab, bxfab, byfab, bzfab,
+                                        Ex.nGrowVect(), &jx, &jy, &jz, thread_num, lev, dt,
+                                        a_dt_type, sort_incremental ? &sort_bin : nullptr);
+                WARPX_PROFILE_VAR_STOP(blp_fg);
+
+                if (sort_incremental) {
+                    const int nbins = static_cast<int>(
+                        getSortBinBox(pti.tilebox(), WarpX::sort_bin_size).numPts());
+                    SortParticlesIncrementally(pti, sort_bin, nbins);
+                }
+            }
+            else if (! do_not_push)
             {
                 const long np_gather = (cEx) ? nfine_gather : np;
 
@@ -2539,6 +2674,33 @@ PhysicalParticleContainer::PushPX (WarpXParIter& pti,
                                    int lev, int gather_lev,
                                    amrex::Real dt, ScaleFields scaleFields,
                                    DtType a_dt_type)
+{
+    PushKernelTable::dispatch(WarpX::nox, WarpX::galerkin_interpolation,
+                              WarpX::particle_pusher_algo, do_classical_radiation_reaction,
+                              [&] (auto spec)
+    {
+        PushPXWithEpilogue<decltype(spec)>(pti, exfab, eyfab, ezfab, bxfab, byfab, bzfab, ngEB,
+                                           offset, np_to_push, lev, gather_lev, dt, scaleFields,
+                                           a_dt_type, NoPushEpilogue{});
+    });
+}
+
+template <typename PushSpec, typename PushEpilogue>
+void
+PhysicalParticleContainer::PushPXWithEpilogue (WarpXParIter& pti,
+                                               amrex::FArrayBox const * exfab,
+                                               amrex::FArrayBox const * eyfab,
+                                               amrex::FArrayBox const * ezfab,
+                                               amrex::FArrayBox const * bxfab,
+                                               amrex::FArrayBox const * byfab,
+                                               amrex::FArrayBox const * bzfab,
+                                               const amrex::IntVect ngEB,
+                                               const long offset,
+                                               const long np_to_push,
+                                               int lev, int gather_lev,
+                                               amrex::Real dt, ScaleFields scaleFields,
+                                               DtType a_dt_type,
+                                               PushEpilogue const& epilogue)
 {
     WARPX_ALWAYS_ASSERT_WITH_MESSAGE((gather_lev==(lev-1)) ||
                                      (gather_lev==(lev  )),
@@ -2572,8 +2734,6 @@ PhysicalParticleContainer::PushPX (WarpXParIter& pti,
 
     const Dim3 lo = lbound(box);
 
-    bool galerkin_interpolation = WarpX::galerkin_interpolation;
-    int nox = WarpX::nox;
     int n_rz_azimuthal_modes = WarpX::n_rz_azimuthal_modes;
 
     amrex::GpuArray<amrex::Real, 3> dx_arr = {dx[0], dx[1], dx[2]};
@@ -2593,6 +2753,42 @@ PhysicalParticleContainer::PushPX (WarpXParIter& pti,
     amrex::IndexType const by_type = byfab->box().ixType();
     amrex::IndexType const bz_type = bzfab->box().ixType();
 
+#ifdef WARPX_MAG_LLG
+    // B = mu0*(H + M) is evaluated from H and M in the field gather, instead of being stored
+    // every step, see WarpX::GatherBfromHM
+    auto& warpx = WarpX::GetInstance();
+    const bool gather_B_from_HM = warpx.GatherBfromHM() && (lev == gather_lev);
+    BfromHMArray hm_x, hm_y, hm_z;
+    if (gather_B_from_HM) {
+        // H and M are gathered with the index types of B on the faces, see WarpX::InitGatherBfromHM
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(WarpX::field_gathering_algo != GatheringAlgo::MomentumConserving,
+            "B = mu0*(H + M) cannot be gathered from H and M with the momentum-conserving gather");
+        const bool collocated = (warpx.mag_M_collocated == 1);
+        std::array<BfromHMArray*, 3> hm = {&hm_x, &hm_y, &hm_z};
+        for (int i = 0; i < 3; ++i) {
+            hm[i]->h = warpx.getHfield_fp(lev, i)[pti].const_array();
+            hm[i]->m = warpx.getMfield_fp(lev, i)[pti].const_array();
+            hm[i]->mcomp = i;
+        }
+        if (collocated) {
+#if (AMREX_SPACEDIM >= 2)
+            hm_x.shift.x = 1;
+#endif
+#if defined(WARPX_DIM_3D)
+            hm_y.shift.y = 1;
+#endif
+            // the last index of the grid is z
+#if defined(WARPX_DIM_1D_Z)
+            hm_z.shift.x = 1;
+#elif defined(WARPX_DIM_XZ) || defined(WARPX_DIM_RZ)
+            hm_z.shift.y = 1;
+#else
+            hm_z.shift.z = 1;
+#endif
+        }
+    }
+#endif
+
     auto& attribs = pti.GetAttribs();
     ParticleReal* const AMREX_RESTRICT ux = attribs[PIdx::ux].dataPtr() + offset;
     ParticleReal* const AMREX_RESTRICT uy = attribs[PIdx::uy].dataPtr() + offset;
@@ -2634,8 +2830,6 @@ PhysicalParticleContainer::PushPX (WarpXParIter& pti,
     const amrex::Real q = this->charge;
     const amrex::Real m = this-> mass;
 
-    const auto pusher_algo = WarpX::particle_pusher_algo;
-    const auto do_crr = do_classical_radiation_reaction;
 #ifdef WARPX_QED
     const auto do_sync = m_do_qed_quantum_sync;
     amrex::Real t_chi_max = 0.0;
@@ -2670,24 +2864,35 @@ PhysicalParticleContainer::PushPX (WarpXParIter& pti,
         amrex::ParticleReal Exp = 0._rt, Eyp = 0._rt, Ezp = 0._rt;
         amrex::ParticleReal Bxp = 0._rt, Byp = 0._rt, Bzp = 0._rt;
 
+#ifdef WARPX_MAG_LLG
+        if (!t_do_not_gather && gather_B_from_HM) {
+            // first gather E and B to the particle positions, B from H and M
+            doGatherShapeN<PushSpec::shape_order, PushSpec::galerkin_interpolation>(
+                xp, yp, zp, Exp, Eyp, Ezp, Bxp, Byp, Bzp,
+                ex_arr, ey_arr, ez_arr, hm_x, hm_y, hm_z,
+                ex_type, ey_type, ez_type, bx_type, by_type, bz_type,
+                dx_arr, xyzmin_arr, lo, n_rz_azimuthal_modes);
+        } else
+#endif
         if(!t_do_not_gather){
             // first gather E and B to the particle positions
-            doGatherShapeN(xp, yp, zp, Exp, Eyp, Ezp, Bxp, Byp, Bzp,
-                           ex_arr, ey_arr, ez_arr, bx_arr, by_arr, bz_arr,
-                           ex_type, ey_type, ez_type, bx_type, by_type, bz_type,
-                           dx_arr, xyzmin_arr, lo, n_rz_azimuthal_modes,
-                           nox, galerkin_interpolation);
+            doGatherShapeN<PushSpec::shape_order, PushSpec::galerkin_interpolation>(
+                xp, yp, zp, Exp, Eyp, Ezp, Bxp, Byp, Bzp,
+                ex_arr, ey_arr, ez_arr, bx_arr, by_arr, bz_arr,
+                ex_type, ey_type, ez_type, bx_type, by_type, bz_type,
+                dx_arr, xyzmin_arr, lo, n_rz_azimuthal_modes);
         }
         // Externally applied E and B-field in Cartesian co-ordinates
         getExternalEB(ip, Exp, Eyp, Ezp, Bxp, Byp, Bzp);
 
         scaleFields(xp, yp, zp, Exp, Eyp, Ezp, Bxp, Byp, Bzp);
 
-        doParticlePush(getPosition, setPosition, copyAttribs, ip,
+        doParticlePush<PushSpec::pusher_algo, PushSpec::do_crr>(
+                       getPosition, setPosition, copyAttribs, ip,
                        ux[ip], uy[ip], uz[ip],
                        Exp, Eyp, Ezp, Bxp, Byp, Bzp,
                        ion_lev ? ion_lev[ip] : 0,
-                       m, q, pusher_algo, do_crr, do_copy,
+                       m, q, do_copy,
 #ifdef WARPX_QED
                        do_sync,
                        t_chi_max,
@@ -2702,9 +2907,168 @@ PhysicalParticleContainer::PushPX (WarpXParIter& pti,
         }
 #endif
 
+        epilogue(ip);
     });
 }
 
+/* \brief Gather, push and deposit the current of all the particles of a tile in one kernel
+ *
+ * Each particle deposits its current right after its push, while its data are still in
+ * registers, instead of being read again by a separate deposition kernel. The current is
+ * deposited at t_{n+1/2}, as in Evolve, with the direct or Esirkepov deposition of order
+ * WarpX::nox (the gather uses the same shape).
+ */
+void
+PhysicalParticleContainer::PushPXAndDepositCurrent (WarpXParIter& pti,
+                                                    amrex::FArrayBox const * exfab,
+                                                    amrex::FArrayBox const * eyfab,
+                                                    amrex::FArrayBox const * ezfab,
+                                                    amrex::FArrayBox const * bxfab,
+                                                    amrex::FArrayBox const * byfab,
+                                                    amrex::FArrayBox const * bzfab,
+                                                    const amrex::IntVect ngEB,
+                                                    amrex::MultiFab * const jx,
+                                                    amrex::MultiFab * const jy,
+                                                    amrex::MultiFab * const jz,
+                                                    int const thread_num, int const lev,
+                                                    amrex::Real const dt, DtType a_dt_type,
+                                                    amrex::Gpu::DeviceVector<int>* bin)
+{
+    WARPX_PROFILE("PhysicalParticleContainer::PushPXAndDepositCurrent()");
+
+    const long np = pti.numParticles();
+    if (np == 0) return;
+
+    WarpX& warpx = WarpX::GetInstance();
+    const amrex::IntVect& ng_J = warpx.get_ng_depos_J();
+    const std::array<Real,3>& dx = WarpX::CellSize(lev);
+
+    // Tile box where the current is deposited, see DepositCurrent
+    Box tilebox = pti.tilebox();
+#ifndef AMREX_USE_GPU
+    Box tbx = convert( tilebox, jx->ixType().toIntVect() );
+    Box tby = convert( tilebox, jy->ixType().toIntVect() );
+    Box tbz = convert( tilebox, jz->ixType().toIntVect() );
+#endif
+
+    tilebox.grow(ng_J);
+
+#ifdef AMREX_USE_GPU
+    amrex::ignore_unused(thread_num);
+    // GPU, no tiling: j<xyz>_arr point to the full j<xyz> arrays
+    Array4<Real> const& jx_arr = jx->array(pti);
+    Array4<Real> const& jy_arr = jy->array(pti);
+    Array4<Real> const& jz_arr = jz->array(pti);
+#else
+    tbx.grow(ng_J);
+    tby.grow(ng_J);
+    tbz.grow(ng_J);
+
+    // CPU, tiling: j<xyz>_arr point to the local_j<xyz>[thread_num] arrays
+    local_jx[thread_num].resize(tbx, jx->nComp());
+    local_jy[thread_num].resize(tby, jy->nComp());
+    local_jz[thread_num].resize(tbz, jz->nComp());
+
+    local_jx[thread_num].setVal(0.0);
+    local_jy[thread_num].setVal(0.0);
+    local_jz[thread_num].setVal(0.0);
+
+    Array4<Real> const& jx_arr = local_jx[thread_num].array();
+    Array4<Real> const& jy_arr = local_jy[thread_num].array();
+    Array4<Real> const& jz_arr = local_jz[thread_num].array();
+#endif
+
+    // Lower corner of tile box physical domain, including guard cells
+    const Dim3 lo = lbound(tilebox);
+    // Take into account Galilean shift
+    const std::array<amrex::Real, 3>& xyzmin = WarpX::LowerCorner(tilebox, lev, 0.5_rt*dt);
+
+    auto& attribs = pti.GetAttribs();
+    const ParticleReal* const wp = attribs[PIdx::w].dataPtr();
+    const ParticleReal* const uxp = attribs[PIdx::ux].dataPtr();
+    const ParticleReal* const uyp = attribs[PIdx::uy].dataPtr();
+    const ParticleReal* const uzp = attribs[PIdx::uz].dataPtr();
+    const int* ion_lev = nullptr;
+    if (do_field_ionization) {
+        ion_lev = pti.GetiAttribs(particle_icomps["ionizationLevel"]).dataPtr();
+    }
+    const auto GetPosition = GetParticlePosition(pti);
+
+    // Deposit at t_{n+1/2}
+    const amrex::Real relative_time = -0.5_rt * dt;
+    const amrex::Real q = this->charge;
+    const int n_rz_azimuthal_modes = WarpX::n_rz_azimuthal_modes;
+
+    SortBinner binner;
+    if (bin) {
+        binner.particles = pti.GetArrayOfStructs()().dataPtr();
+        binner.bin = bin->dataPtr();
+        binner.plo = Geom(lev).ProbLoArray();
+        binner.dxi = Geom(lev).InvCellSizeArray();
+        binner.cell_box = pti.tilebox();
+        binner.bin_size = WarpX::sort_bin_size;
+        binner.bin_box = getSortBinBox(binner.cell_box, binner.bin_size);
+    }
+
+    GlobalCurrentAdd const jx_add{jx_arr};
+    GlobalCurrentAdd const jy_add{jy_arr};
+    GlobalCurrentAdd const jz_add{jz_arr};
+
+    const bool is_esirkepov = (WarpX::current_deposition_algo == CurrentDepositionAlgo::Esirkepov);
+    if (is_esirkepov && WarpX::do_nodal==1) {
+        amrex::Abort("The Esirkepov algorithm cannot be used with a nodal grid.");
+    }
+    const IntVect jx_type = jx->ixType().toIntVect();
+    const IntVect jy_type = jy->ixType().toIntVect();
+    const IntVect jz_type = jz->ixType().toIntVect();
+
+    // The deposition has the shape order of the specialized push kernel
+    PushKernelTable::dispatch(WarpX::nox, WarpX::galerkin_interpolation,
+                              WarpX::particle_pusher_algo, do_classical_radiation_reaction,
+                              [&] (auto spec)
+    {
+        using Spec = decltype(spec);
+        constexpr int depos_order = Spec::shape_order;
+        if (is_esirkepov) {
+            using Kernel = EsirkepovDepositionKernel<depos_order>;
+            PushPXWithEpilogue<Spec>(pti, exfab, eyfab, ezfab, bxfab, byfab, bzfab, ngEB, 0, np,
+                lev, lev, dt, ScaleFields(false), a_dt_type,
+                FusedDeposition<Kernel>{
+                    Kernel(GetPosition, wp, uxp, uyp, uzp, ion_lev, dt, relative_time, dx,
+                           xyzmin, lo, q, n_rz_azimuthal_modes),
+                    jx_add, jy_add, jz_add, binner});
+        } else {
+            using Kernel = DirectDepositionKernel<depos_order>;
+            PushPXWithEpilogue<Spec>(pti, exfab, eyfab, ezfab, bxfab, byfab, bzfab, ngEB, 0, np,
+                lev, lev, dt, ScaleFields(false), a_dt_type,
+                FusedDeposition<Kernel>{
+                    Kernel(GetPosition, wp, uxp, uyp, uzp, ion_lev, jx_type, jy_type, jz_type,
+                           relative_time, dx, xyzmin, lo, q, n_rz_azimuthal_modes),
+                    jx_add, jy_add, jz_add, binner});
+        }
+    });
+
+    // The particles must fit in the tile (CPU) or the guard cells (GPU) after their push,
+    // as in DepositCurrent
+    const amrex::IntVect shape_extent = amrex::IntVect(static_cast<int>(WarpX::nox/2));
+#ifndef AMREX_USE_GPU
+    const amrex::IntVect range = ng_J - shape_extent;
+#else
+    const amrex::IntVect range = jx->nGrowVect() - shape_extent;
+#endif
+    amrex::ignore_unused(range); // for release builds
+    AMREX_ASSERT_WITH_MESSAGE(
+        amrex::numParticlesOutOfRange(pti, range) == 0,
+        "Particles shape does not fit within tile (CPU) or guard cells (GPU) used for current deposition");
+
+#ifndef AMREX_USE_GPU
+    // CPU, tiling: atomicAdd local_j<xyz> into j<xyz>
+    (*jx)[pti].atomicAdd(local_jx[thread_num], tbx, tbx, 0, 0, jx->nComp());
+    (*jy)[pti].atomicAdd(local_jy[thread_num], tby, tby, 0, 0, jy->nComp());
+    (*jz)[pti].atomicAdd(local_jz[thread_num], tbz, tbz, 0, 0, jz->nComp());
+#endif
+}
+
 void
 PhysicalParticleContainer::InitIonizationModule ()
 {
@@ -2809,14 +3173,40 @@ void PhysicalParticleContainer::resample (const int timestep)
     WARPX_PROFILE_VAR_STOP(blp_resample_synchronization);
 
     WARPX_PROFILE_VAR_START(blp_resample_actual);
-    if (m_resampler.triggered(timestep, global_numparts))
+    const bool global_trigger = m_resampler.triggered(timestep, global_numparts);
+    if (global_trigger || m_resampler.hasTileTrigger())
     {
-        amrex::Print() << Utils::TextMsg::Info("Resampling " + species_name);
+        if (global_trigger) {
+            amrex::Print() << Utils::TextMsg::Info("Resampling " + species_name);
+        }
+        // Number of particles of a tile that are not flagged for removal
+        const auto count_valid = [] (WarpXParIter& pti) -> amrex::Long
+        {
+            const ParticleType* const AMREX_RESTRICT pp = pti.GetArrayOfStructs()().data();
+            ReduceOps<ReduceOpSum> reduce_op;
+            ReduceData<amrex::Long> reduce_data(reduce_op);
+            using ReduceTuple = typename decltype(reduce_data)::Type;
+            reduce_op.eval(pti.numParticles(), reduce_data,
+            [=] AMREX_GPU_DEVICE (long ip) -> ReduceTuple
+            {
+                return {(pp[ip].id() >= 0) ? 1L : 0L};
+            });
+            return amrex::get<0>(reduce_data.value());
+        };
         for (int lev = 0; lev <= maxLevel(); lev++)
         {
             for (WarpXParIter pti(*this, lev); pti.isValid(); ++pti)
             {
+                // Without a global trigger, only the tiles with too many particles per cell
+                // are resampled
+                if (!global_trigger &&
+                    !m_resampler.tileTriggered(pti.numParticles(), pti.tilebox().numPts())) {
+                    continue;
+                }
+                const amrex::Long np_before = count_valid(pti);
                 m_resampler(pti, lev, this);
+                m_resampling_num_tiles++;
+                m_resampling_num_removed += np_before - count_valid(pti);
             }
         }
     }
@@ -23,6 +23,7 @@ ResamplingTrigger::ResamplingTrigger (const std::string species_name)
     m_resampling_intervals = IntervalsParser(resampling_trigger_int_string_vec);
 
     queryWithParser(pp_species_name, "resampling_trigger_max_avg_ppc", m_max_avg_ppc);
+    queryWithParser(pp_species_name, "resampling_trigger_max_tile_ppc", m_max_tile_ppc);
 }
 
 bool ResamplingTrigger::triggered (const int timestep, const amrex::Real global_numparts) const
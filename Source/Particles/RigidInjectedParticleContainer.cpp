@@ -66,6 +66,8 @@ RigidInjectedParticleContainer::RigidInjectedParticleContainer (AmrCore* amr_cor
     getWithParser(pp_species_name, "zinject_plane", zinject_plane);
     pp_species_name.query("rigid_advance", rigid_advance);
 
+    // The particles are pushed by RigidInjectedParticleContainer::PushPX
+    m_fused_push_deposit = false;
 }
 
 void RigidInjectedParticleContainer::InitData()
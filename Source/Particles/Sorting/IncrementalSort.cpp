@@ -0,0 +1,167 @@
+/* This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+#include "Particles/PhysicalParticleContainer.H"
+#include "Particles/WarpXParticleContainer.H"
+#include "SortingUtils.H"
+#include "Utils/WarpXProfilerWrapper.H"
+
+#include <AMReX_BLassert.H>
+#include <AMReX_DenseBins.H>
+#include <AMReX_GpuContainers.H>
+#include <AMReX_GpuDevice.H>
+#include <AMReX_GpuLaunch.H>
+#include <AMReX_ParticleTransformation.H>
+#include <AMReX_Particles.H>
+#include <AMReX_Reduce.H>
+
+using namespace amrex;
+
+namespace
+{
+    //! Number of passes that remove the particles out of order before all the particles
+    //! of the tile are sorted instead
+    constexpr int max_incremental_sort_passes = 4;
+}
+
+/* \brief Sort the particles of a tile by bin, moving only the particles that are out of order
+ *
+ * The particles that are out of order with their neighbors (typically the particles that
+ * crossed a bin since the tile was last sorted) are set aside, until the remaining particles
+ * are sorted. If they are still not sorted after `max_incremental_sort_passes` passes, all the
+ * particles are set aside. The particles set aside are sorted by bin, then merged with the
+ * remaining particles, after those of the same bin. Only the particles between the first and
+ * the last particles whose index changes are copied.
+ *
+ * \param pti object that holds the particle information for this tile
+ * \param bin bin of each particle of the tile, from 0 to nbins-1
+ * \param nbins number of bins of the tile
+ */
+void
+PhysicalParticleContainer::SortParticlesIncrementally (
+    WarpXParIter& pti, Gpu::DeviceVector<int> const& bin, int const nbins)
+{
+    WARPX_PROFILE("PhysicalParticleContainer::SortParticlesIncrementally");
+
+    long const np = pti.numParticles();
+    if (np < 2) return;
+    AMREX_ASSERT(static_cast<long>(bin.size()) >= np);
+    int const* const AMREX_RESTRICT bin_ptr = bin.dataPtr();
+
+    // `pid` holds the indices of the particles that stay in order (the first `n_keep`),
+    // followed by the indices of the particles to move
+    Gpu::DeviceVector<long> pid(np);
+    fillWithConsecutiveIntegers(pid);
+    Gpu::DeviceVector<int> keep(np);
+    int* const AMREX_RESTRICT keep_ptr = keep.dataPtr();
+
+    long n_keep = np;
+    int pass = 0;
+    for (; pass < max_incremental_sort_passes; ++pass) {
+        long const* const AMREX_RESTRICT pid_ptr = pid.dataPtr();
+        long const n = n_keep;
+
+        // Flag the particles that are out of order with the particles kept before and after them
+        ReduceOps<ReduceOpSum> reduce_op;
+        ReduceData<long> reduce_data(reduce_op);
+        using ReduceTuple = typename decltype(reduce_data)::Type;
+        reduce_op.eval(n, reduce_data,
+        [=] AMREX_GPU_DEVICE (long k) -> ReduceTuple
+        {
+            int const b = bin_ptr[pid_ptr[k]];
+            bool const out_of_order = (k > 0 && b < bin_ptr[pid_ptr[k-1]])
+                                   || (k < n-1 && b > bin_ptr[pid_ptr[k+1]]);
+            keep_ptr[pid_ptr[k]] = out_of_order ? 0 : 1;
+            return {out_of_order ? 1L : 0L};
+        });
+        long const n_out_of_order = amrex::get<0>(reduce_data.value());
+        if (n_out_of_order == 0) break;
+
+        stablePartition(pid.begin(), pid.begin() + n_keep, keep);
+        n_keep -= n_out_of_order;
+    }
+    // The particles were already sorted
+    if (n_keep == np) return;
+    // Too many particles out of order: sort all of them
+    if (pass == max_incremental_sort_passes) n_keep = 0;
+
+    // Sort the particles to move by bin
+    long const n_move = np - n_keep;
+    DenseBins<long> move_bins;
+    move_bins.build(n_move, pid.dataPtr() + n_keep, nbins,
+        [=] AMREX_GPU_DEVICE (long const& i) noexcept -> unsigned int
+        {
+            return static_cast<unsigned int>(bin_ptr[i]);
+        });
+
+    // Merge the particles kept in order and the particles to move: `new_pid[i]` is the
+    // index of the particle that goes to index `i`
+    Gpu::DeviceVector<long> new_pid(np);
+    long* const AMREX_RESTRICT new_pid_ptr = new_pid.dataPtr();
+    long const* const AMREX_RESTRICT pid_ptr = pid.dataPtr();
+    auto const* const AMREX_RESTRICT move_perm = move_bins.permutationPtr();
+    auto const* const AMREX_RESTRICT move_offsets = move_bins.offsetsPtr();
+    // A kept particle goes after the moved particles of the lower bins
+    amrex::ParallelFor(n_keep, [=] AMREX_GPU_DEVICE (long k)
+    {
+        new_pid_ptr[k + move_offsets[bin_ptr[pid_ptr[k]]]] = pid_ptr[k];
+    });
+    // A moved particle goes after the kept particles of the lower and same bins
+    amrex::ParallelFor(n_move, [=] AMREX_GPU_DEVICE (long j)
+    {
+        long const i = pid_ptr[n_keep + move_perm[j]];
+        int const b = bin_ptr[i];
+        // Binary search of the number of kept particles with a bin <= b
+        long lo = 0;
+        long hi = n_keep;
+        while (lo < hi) {
+            long const mid = (lo + hi) / 2;
+            if (bin_ptr[pid_ptr[mid]] <= b) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        new_pid_ptr[j + lo] = i;
+    });
+
+    // Range of the particles whose index changes
+    ReduceOps<ReduceOpMin, ReduceOpMax> reduce_op;
+    ReduceData<long, long> reduce_data(reduce_op);
+    using ReduceTuple = typename decltype(reduce_data)::Type;
+    reduce_op.eval(np, reduce_data,
+    [=] AMREX_GPU_DEVICE (long i) -> ReduceTuple
+    {
+        bool const moved = (new_pid_ptr[i] != i);
+        return {moved ? i : np, moved ? i : -1L};
+    });
+    auto const range = reduce_data.value();
+    long const i_first = amrex::get<0>(range);
+    long const n_copy = amrex::get<1>(range) + 1 - i_first;
+    if (n_copy <= 0) return;
+
+    // Copy the particles of the range to a temporary tile in their new order, and back
+    ParticleTileType& ptile = pti.GetParticleTile();
+    ParticleTileType ptile_tmp;
+    ptile_tmp.define(NumRuntimeRealComps(), NumRuntimeIntComps());
+    ptile_tmp.resize(n_copy);
+
+    auto const src_data = ptile.getConstParticleTileData();
+    auto const tmp_data = ptile_tmp.getParticleTileData();
+    amrex::ParallelFor(n_copy, [=] AMREX_GPU_DEVICE (long i)
+    {
+        copyParticle(tmp_data, src_data, static_cast<int>(new_pid_ptr[i_first + i]),
+                     static_cast<int>(i));
+    });
+    auto const tmp_src_data = ptile_tmp.getConstParticleTileData();
+    auto const dst_data = ptile.getParticleTileData();
+    amrex::ParallelFor(n_copy, [=] AMREX_GPU_DEVICE (long i)
+    {
+        copyParticle(dst_data, tmp_src_data, static_cast<int>(i), static_cast<int>(i_first + i));
+    });
+
+    // Make sure that the temporary arrays are not destroyed before
+    // the GPU kernels finish running
+    Gpu::streamSynchronize();
+}
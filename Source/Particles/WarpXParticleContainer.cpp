@@ -30,6 +30,7 @@
 #include <AMReX_Box.H>
 #include <AMReX_BoxArray.H>
 #include <AMReX_Config.H>
+#include <AMReX_DenseBins.H>
 #include <AMReX_Dim3.H>
 #include <AMReX_Extension.H>
 #include <AMReX_FabArray.H>
@@ -426,6 +427,99 @@ WarpXParticleContainer::DepositCurrent (WarpXParIter& pti,
     amrex::LayoutData<amrex::Real> * const costs = WarpX::getCosts(lev);
     amrex::Real * const cost = costs ? &((*costs)[pti.index()]) : nullptr;
 
+#if defined(AMREX_USE_CUDA) || defined(AMREX_USE_HIP)
+    // Shared-memory deposition, in the tiles of WarpX::shared_tilesize cells of the box
+    // (not in the deposition buffers, whose particles are binned on the finer level)
+    bool const is_esirkepov = (WarpX::current_deposition_algo == CurrentDepositionAlgo::Esirkepov);
+    bool const shared_deposition = WarpX::do_shared_mem_current_deposition
+        && (WarpX::current_deposition_algo != CurrentDepositionAlgo::Vay)
+        && (lev == depos_lev)
+        && (sharedDepositionBytes(WarpX::shared_tilesize,
+                                  sharedDepositionHalo(WarpX::nox, is_esirkepov), jx->nComp(),
+                                  jx->ixType().toIntVect(), jy->ixType().toIntVect(),
+                                  jz->ixType().toIntVect())
+            <= amrex::Gpu::Device::sharedMemPerBlock());
+
+    if (shared_deposition) {
+        // Bin the particles [offset,offset+np_to_depose) by tile of cells (particles
+        // beyond the box are binned in the tiles at its edge)
+        WARPX_PROFILE_VAR_NS("WarpXParticleContainer::DepositCurrent::SharedMemBinning", blp_binning);
+        WARPX_PROFILE_VAR_START(blp_binning);
+        const Box cell_box = pti.tilebox();
+        const IntVect tile_size = WarpX::shared_tilesize;
+        const Box bin_box(IntVect(0), (cell_box.length() + tile_size - 1) / tile_size - 1);
+        const IntVect cell_lo = cell_box.smallEnd();
+        const IntVect cell_hi = cell_box.bigEnd();
+        const auto plo = Geom(lev).ProbLoArray();
+        const auto dxi = Geom(lev).InvCellSizeArray();
+        ParticleType const* const pstruct_ptr =
+            ParticlesAt(lev, pti).GetArrayOfStructs()().dataPtr() + offset;
+        amrex::DenseBins<ParticleType> bins;
+        bins.build(static_cast<int>(np_to_depose), pstruct_ptr, bin_box,
+            [=] AMREX_GPU_DEVICE (const ParticleType& p) noexcept -> IntVect
+            {
+                IntVect iv;
+                for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+                    const int i = static_cast<int>(std::floor((p.pos(idim) - plo[idim])*dxi[idim]));
+                    iv[idim] = (amrex::min(amrex::max(i, cell_lo[idim]), cell_hi[idim])
+                                - cell_lo[idim]) / tile_size[idim];
+                }
+                return iv;
+            });
+        WARPX_PROFILE_VAR_STOP(blp_binning);
+
+        if (is_esirkepov) {
+            if        (WarpX::nox == 1){
+                doEsirkepovDepositionSharedShapeN<1>(
+                    GetPosition, wp.dataPtr() + offset, uxp.dataPtr() + offset,
+                    uyp.dataPtr() + offset, uzp.dataPtr() + offset, ion_lev,
+                    jx_arr, jy_arr, jz_arr, jx_fab.box().type(), jy_fab.box().type(),
+                    jz_fab.box().type(), dt, relative_time, dx, xyzmin, lo, q,
+                    WarpX::n_rz_azimuthal_modes, cost,
+                    WarpX::load_balance_costs_update_algo, bins, cell_box, tile_size);
+            } else if (WarpX::nox == 2){
+                doEsirkepovDepositionSharedShapeN<2>(
+                    GetPosition, wp.dataPtr() + offset, uxp.dataPtr() + offset,
+                    uyp.dataPtr() + offset, uzp.dataPtr() + offset, ion_lev,
+                    jx_arr, jy_arr, jz_arr, jx_fab.box().type(), jy_fab.box().type(),
+                    jz_fab.box().type(), dt, relative_time, dx, xyzmin, lo, q,
+                    WarpX::n_rz_azimuthal_modes, cost,
+                    WarpX::load_balance_costs_update_algo, bins, cell_box, tile_size);
+            } else if (WarpX::nox == 3){
+                doEsirkepovDepositionSharedShapeN<3>(
+                    GetPosition, wp.dataPtr() + offset, uxp.dataPtr() + offset,
+                    uyp.dataPtr() + offset, uzp.dataPtr() + offset, ion_lev,
+                    jx_arr, jy_arr, jz_arr, jx_fab.box().type(), jy_fab.box().type(),
+                    jz_fab.box().type(), dt, relative_time, dx, xyzmin, lo, q,
+                    WarpX::n_rz_azimuthal_modes, cost,
+                    WarpX::load_balance_costs_update_algo, bins, cell_box, tile_size);
+            }
+        } else {
+            if        (WarpX::nox == 1){
+                doDepositionSharedShapeN<1>(
+                    GetPosition, wp.dataPtr() + offset, uxp.dataPtr() + offset,
+                    uyp.dataPtr() + offset, uzp.dataPtr() + offset, ion_lev,
+                    jx_fab, jy_fab, jz_fab, relative_time, dx,
+                    xyzmin, lo, q, WarpX::n_rz_azimuthal_modes, cost,
+                    WarpX::load_balance_costs_update_algo, bins, cell_box, tile_size);
+            } else if (WarpX::nox == 2){
+                doDepositionSharedShapeN<2>(
+                    GetPosition, wp.dataPtr() + offset, uxp.dataPtr() + offset,
+                    uyp.dataPtr() + offset, uzp.dataPtr() + offset, ion_lev,
+                    jx_fab, jy_fab, jz_fab, relative_time, dx,
+                    xyzmin, lo, q, WarpX::n_rz_azimuthal_modes, cost,
+                    WarpX::load_balance_costs_update_algo, bins, cell_box, tile_size);
+            } else if (WarpX::nox == 3){
+                doDepositionSharedShapeN<3>(
+                    GetPosition, wp.dataPtr() + offset, uxp.dataPtr() + offset,
+                    uyp.dataPtr() + offset, uzp.dataPtr() + offset, ion_lev,
+                    jx_fab, jy_fab, jz_fab, relative_time, dx,
+                    xyzmin, lo, q, WarpX::n_rz_azimuthal_modes, cost,
+                    WarpX::load_balance_costs_update_algo, bins, cell_box, tile_size);
+            }
+        }
+    } else
+#endif
     if (WarpX::current_deposition_algo == CurrentDepositionAlgo::Esirkepov) {
         if        (WarpX::nox == 1){
             doEsirkepovDepositionShapeN<1>(
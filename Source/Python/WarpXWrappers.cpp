@@ -7,10 +7,15 @@
  * License: BSD-3-Clause-LBNL
  */
 #include "BoundaryConditions/PML.H"
+#include "FieldSolver/FiniteDifferenceSolver/MacroscopicProperties/MacroscopicProperties.H"
 #include "Initialization/WarpXAMReXInit.H"
+#include "Parallelization/CostsBreakdown.H"
 #include "Particles/MultiParticleContainer.H"
 #include "Particles/ParticleBoundaryBuffer.H"
 #include "Particles/WarpXParticleContainer.H"
+#include "Utils/MemoryFootprint.H"
+#include "Utils/TextMsg.H"
+#include "Utils/WarpXAlgorithmSelection.H"
 #include "Utils/WarpXUtil.H"
 #include "Utils/WarpXProfilerWrapper.H"
 #include "WarpX.H"
@@ -99,6 +104,53 @@ namespace
         }
         return nodal_flag_data;
     }
+
+    // Material properties of a level, nullptr without the macroscopic medium
+    MacroscopicProperties* getMacroscopicProperties (int lev)
+    {
+        auto & warpx = WarpX::GetInstance();
+        if (WarpX::em_solver_medium != MediumForEM::Macroscopic) return nullptr;
+        return &warpx.GetMacroscopicProperties(lev);
+    }
+    amrex::MultiFab* getSigma (int lev)
+    {
+        auto * macro = getMacroscopicProperties(lev);
+        return macro ? macro->get_pointer_sigma() : nullptr;
+    }
+    amrex::MultiFab* getEpsilon (int lev)
+    {
+        auto * macro = getMacroscopicProperties(lev);
+        return macro ? macro->get_pointer_eps() : nullptr;
+    }
+    amrex::MultiFab* getMu (int lev)
+    {
+        auto * macro = getMacroscopicProperties(lev);
+        return macro ? macro->get_pointer_mu() : nullptr;
+    }
+
+    // Getters of the MultiFabs of the magnetization solver (H, M, H_bias and the magnetic
+    // properties of the materials), which return nullptr when WarpX is built without it
+#ifdef WARPX_MAG_LLG
+#   define WARPX_MAG_GETTER(NAME, EXPR) \
+    amrex::MultiFab* NAME (int lev, int direction) { return EXPR; }
+#else
+#   define WARPX_MAG_GETTER(NAME, EXPR) \
+    amrex::MultiFab* NAME (int /*lev*/, int /*direction*/) { return nullptr; }
+#endif
+    WARPX_MAG_GETTER(getHfieldFP, WarpX::GetInstance().get_pointer_Hfield_fp(lev, direction))
+    WARPX_MAG_GETTER(getMfieldFP, WarpX::GetInstance().get_pointer_Mfield_fp(lev, direction))
+    WARPX_MAG_GETTER(getH_biasfieldFP, WarpX::GetInstance().get_pointer_H_biasfield_fp(lev, direction))
+    WARPX_MAG_GETTER(getMagMs, getMacroscopicProperties(lev) ?
+        getMacroscopicProperties(lev)->getmag_pointer_Ms(direction) : nullptr)
+    WARPX_MAG_GETTER(getMagAlpha, getMacroscopicProperties(lev) ?
+        getMacroscopicProperties(lev)->getmag_pointer_alpha(direction) : nullptr)
+    WARPX_MAG_GETTER(getMagGamma, getMacroscopicProperties(lev) ?
+        getMacroscopicProperties(lev)->getmag_pointer_gamma(direction) : nullptr)
+    WARPX_MAG_GETTER(getMagExchange, getMacroscopicProperties(lev) ?
+        getMacroscopicProperties(lev)->getmag_pointer_exchange(direction) : nullptr)
+    WARPX_MAG_GETTER(getMagAnisotropy, getMacroscopicProperties(lev) ?
+        getMacroscopicProperties(lev)->getmag_pointer_anisotropy(direction) : nullptr)
+#undef WARPX_MAG_GETTER
 }
 
     int warpx_Real_size()
@@ -186,6 +238,21 @@ namespace
         warpx_callback_py_map.erase(callback_name);
     }
 
+    void warpx_set_callback_py_intervals (const char* char_callback_name,
+                                          const char* char_intervals)
+    {
+        const std::string callback_name(char_callback_name);
+        const std::string intervals(char_intervals);
+        // the external Poisson solver replaces the solve, which must be done at every step
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(callback_name != "poissonsolver",
+            "The poissonsolver callback cannot be called at intervals");
+        if (intervals.empty()) {
+            warpx_callback_py_intervals.erase(callback_name);
+        } else {
+            warpx_callback_py_intervals[callback_name] = IntervalsParser({intervals});
+        }
+    }
+
     void warpx_evolve (int numsteps)
     {
         WarpX& warpx = WarpX::GetInstance();
@@ -300,6 +367,24 @@ namespace
     WARPX_GET_LOVECTS(warpx_getEdgeLengthsLoVects, WarpX::GetInstance().get_pointer_edge_lengths)
     WARPX_GET_LOVECTS(warpx_getFaceAreasLoVects, WarpX::GetInstance().get_pointer_face_areas)
 
+    WARPX_GET_FIELD(warpx_getHfieldFP, getHfieldFP)
+    WARPX_GET_FIELD(warpx_getMfieldFP, getMfieldFP)
+    WARPX_GET_FIELD(warpx_getH_biasfieldFP, getH_biasfieldFP)
+    WARPX_GET_FIELD(warpx_getMagMs, getMagMs)
+    WARPX_GET_FIELD(warpx_getMagAlpha, getMagAlpha)
+    WARPX_GET_FIELD(warpx_getMagGamma, getMagGamma)
+    WARPX_GET_FIELD(warpx_getMagExchange, getMagExchange)
+    WARPX_GET_FIELD(warpx_getMagAnisotropy, getMagAnisotropy)
+
+    WARPX_GET_LOVECTS(warpx_getHfieldFPLoVects, getHfieldFP)
+    WARPX_GET_LOVECTS(warpx_getMfieldFPLoVects, getMfieldFP)
+    WARPX_GET_LOVECTS(warpx_getH_biasfieldFPLoVects, getH_biasfieldFP)
+    WARPX_GET_LOVECTS(warpx_getMagMsLoVects, getMagMs)
+    WARPX_GET_LOVECTS(warpx_getMagAlphaLoVects, getMagAlpha)
+    WARPX_GET_LOVECTS(warpx_getMagGammaLoVects, getMagGamma)
+    WARPX_GET_LOVECTS(warpx_getMagExchangeLoVects, getMagExchange)
+    WARPX_GET_LOVECTS(warpx_getMagAnisotropyLoVects, getMagAnisotropy)
+
     int* warpx_getEx_nodal_flag() {return getFieldNodalFlagData( WarpX::GetInstance().get_pointer_Efield_aux(0,0) );}
     int* warpx_getEy_nodal_flag() {return getFieldNodalFlagData( WarpX::GetInstance().get_pointer_Efield_aux(0,1) );}
     int* warpx_getEz_nodal_flag() {return getFieldNodalFlagData( WarpX::GetInstance().get_pointer_Efield_aux(0,2) );}
@@ -319,6 +404,12 @@ namespace
     int* warpx_get_face_areas_x_nodal_flag() {return getFieldNodalFlagData( WarpX::GetInstance().get_pointer_face_areas(0, 0) );}
     int* warpx_get_face_areas_y_nodal_flag() {return getFieldNodalFlagData( WarpX::GetInstance().get_pointer_face_areas(0, 1) );}
     int* warpx_get_face_areas_z_nodal_flag() {return getFieldNodalFlagData( WarpX::GetInstance().get_pointer_face_areas(0, 2) );}
+    int* warpx_getHx_nodal_flag() {return getFieldNodalFlagData( getHfieldFP(0, 0) );}
+    int* warpx_getHy_nodal_flag() {return getFieldNodalFlagData( getHfieldFP(0, 1) );}
+    int* warpx_getHz_nodal_flag() {return getFieldNodalFlagData( getHfieldFP(0, 2) );}
+    int* warpx_getMx_nodal_flag() {return getFieldNodalFlagData( getMfieldFP(0, 0) );}
+    int* warpx_getMy_nodal_flag() {return getFieldNodalFlagData( getMfieldFP(0, 1) );}
+    int* warpx_getMz_nodal_flag() {return getFieldNodalFlagData( getMfieldFP(0, 2) );}
 
 #define WARPX_GET_SCALAR(SCALAR, GETTER) \
     amrex::Real** SCALAR(int lev, \
@@ -360,6 +451,38 @@ namespace
     WARPX_GET_SCALAR(warpx_getGfieldCP, WarpX::GetInstance().get_pointer_G_cp)
     WARPX_GET_SCALAR(warpx_getGfieldFP, WarpX::GetInstance().get_pointer_G_fp)
     WARPX_GET_LOVECTS_SCALAR(warpx_getGfieldCPLoVects, WarpX::GetInstance().get_pointer_G_cp)
+
+    WARPX_GET_SCALAR(warpx_getSigma, getSigma)
+    WARPX_GET_SCALAR(warpx_getEpsilon, getEpsilon)
+    WARPX_GET_SCALAR(warpx_getMu, getMu)
+    WARPX_GET_LOVECTS_SCALAR(warpx_getSigmaLoVects, getSigma)
+    WARPX_GET_LOVECTS_SCALAR(warpx_getEpsilonLoVects, getEpsilon)
+    WARPX_GET_LOVECTS_SCALAR(warpx_getMuLoVects, getMu)
+
+    int* warpx_getSigma_nodal_flag() {return getFieldNodalFlagData( getSigma(0) );}
+    int* warpx_getEpsilon_nodal_flag() {return getFieldNodalFlagData( getEpsilon(0) );}
+    int* warpx_getMu_nodal_flag() {return getFieldNodalFlagData( getMu(0) );}
+
+    void warpx_materialPropertiesModified (int lev)
+    {
+        auto * macro = getMacroscopicProperties(lev);
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(macro != nullptr,
+            "The material properties require algo.em_solver_medium = macroscopic");
+        macro->PropertiesModified();
+    }
+
+    void warpx_resetMaterialProperties (int lev)
+    {
+        auto * macro = getMacroscopicProperties(lev);
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(macro != nullptr,
+            "The material properties require algo.em_solver_medium = macroscopic");
+        macro->InitData(lev);
+    }
+
+    void warpx_rewindFields (int init_values)
+    {
+        WarpX::GetInstance().RewindFields(init_values != 0);
+    }
     WARPX_GET_LOVECTS_SCALAR(warpx_getGfieldFPLoVects, WarpX::GetInstance().get_pointer_G_fp)
 
 #define WARPX_GET_FIELD_PML(FIELD, GETTER) \
@@ -668,6 +791,45 @@ namespace
         WarpX& warpx = WarpX::GetInstance();
         warpx.FillBoundaryB(warpx.getngEB());
     }
+    void warpx_MacroscopicEvolveE (amrex::Real dt) {
+        WarpX& warpx = WarpX::GetInstance();
+        warpx.MacroscopicEvolveE(dt);
+    }
+#ifdef WARPX_MAG_LLG
+    void warpx_MacroscopicEvolveHM (amrex::Real dt, DtType a_dt_type) {
+        WarpX& warpx = WarpX::GetInstance();
+        warpx.MacroscopicEvolveHM(dt, a_dt_type);
+    }
+    void warpx_MacroscopicEvolveHM_2nd (amrex::Real dt, DtType a_dt_type) {
+        WarpX& warpx = WarpX::GetInstance();
+        warpx.MacroscopicEvolveHM_2nd(dt, a_dt_type);
+    }
+    void warpx_FillBoundaryH () {
+        WarpX& warpx = WarpX::GetInstance();
+        warpx.FillBoundaryH(warpx.getngEB());
+    }
+    void warpx_FillBoundaryM () {
+        WarpX& warpx = WarpX::GetInstance();
+        warpx.FillBoundaryM(warpx.getngEB());
+    }
+#else
+    void warpx_MacroscopicEvolveHM (amrex::Real, DtType) {
+        amrex::Abort(Utils::TextMsg::Err("warpx_MacroscopicEvolveHM requires WarpX_MAG_LLG"));
+    }
+    void warpx_MacroscopicEvolveHM_2nd (amrex::Real, DtType) {
+        amrex::Abort(Utils::TextMsg::Err("warpx_MacroscopicEvolveHM_2nd requires WarpX_MAG_LLG"));
+    }
+    void warpx_FillBoundaryH () {
+        amrex::Abort(Utils::TextMsg::Err("warpx_FillBoundaryH requires WarpX_MAG_LLG"));
+    }
+    void warpx_FillBoundaryM () {
+        amrex::Abort(Utils::TextMsg::Err("warpx_FillBoundaryM requires WarpX_MAG_LLG"));
+    }
+#endif
+    void warpx_ApplyExternalFieldExcitation (int field_type, DtType a_dt_type) {
+        WarpX& warpx = WarpX::GetInstance();
+        warpx.ApplyExternalFieldExcitationOnGrid(field_type, a_dt_type);
+    }
     void warpx_SyncRho () {
         WarpX& warpx = WarpX::GetInstance();
         warpx.SyncRho();
@@ -728,6 +890,36 @@ namespace
         return amrex::ParallelDescriptor::NProcs();
     }
 
+    int warpx_getNumStepPhases () {
+        return CostPhase::NumStepPhases;
+    }
+    const char* warpx_getStepPhaseName (int phase) {
+        return CostPhaseName(phase);
+    }
+    amrex::Real warpx_getStepPhaseTime (int phase) {
+        WarpX& warpx = WarpX::GetInstance();
+        return warpx.getStepPhaseTimes()[phase];
+    }
+    amrex::Real warpx_getStepWallTime () {
+        WarpX& warpx = WarpX::GetInstance();
+        return warpx.getStepWallTime();
+    }
+
+    int warpx_getNumMemoryFamilies () {
+        return MemoryFamily::NumFamilies;
+    }
+    const char* warpx_getMemoryFamilyName (int family) {
+        return MemoryFamilyName(family);
+    }
+    double warpx_getMemoryBytes (int lev, int family) {
+        WarpX& warpx = WarpX::GetInstance();
+        return warpx.MemoryFootprint(lev)[family];
+    }
+    void warpx_printMemoryReport () {
+        WarpX& warpx = WarpX::GetInstance();
+        warpx.PrintMemoryReport();
+    }
+
     void mypc_Redistribute () {
         auto & mypc = WarpX::GetInstance().GetPartContainer();
         mypc.Redistribute();
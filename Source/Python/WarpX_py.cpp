@@ -7,7 +7,10 @@
  */
 #include "WarpX_py.H"
 
+#include "WarpX.H"
+
 std::map< std::string, WARPX_CALLBACK_PY_FUNC_0 > warpx_callback_py_map;
+std::map< std::string, IntervalsParser > warpx_callback_py_intervals;
 
 bool IsPythonCallBackInstalled ( std::string name )
 {
@@ -18,7 +21,12 @@ bool IsPythonCallBackInstalled ( std::string name )
 void ExecutePythonCallback ( std::string name )
 {
     if ( IsPythonCallBackInstalled(name) ) {
+        const auto intervals = warpx_callback_py_intervals.find(name);
+        if (intervals != warpx_callback_py_intervals.end()
+            && !intervals->second.contains(WarpX::GetInstance().getistep(0))) return;
         WARPX_PROFILE("warpx_py_"+name);
         warpx_callback_py_map[name]();
+        // the callback may have modified the fields
+        WarpX::GetInstance().InvalidateDeepHalo();
     }
 }
@@ -78,6 +78,8 @@ CoarsenIO::Loop ( MultiFab& mf_dst,
     cr[2] = crse_ratio[2];
 #endif
 
+    const InterpStencil stencil(sf, sc, cr);
+
 #ifdef AMREX_USE_OMP
 #pragma omp parallel if (Gpu::notInLaunchRegion())
 #endif
@@ -91,8 +93,7 @@ CoarsenIO::Loop ( MultiFab& mf_dst,
         ParallelFor( bx, ncomp,
                      [=] AMREX_GPU_DEVICE( int i, int j, int k, int n )
                      {
-                         arr_dst(i,j,k,n+dcomp) = CoarsenIO::Interp(
-                             arr_src, sf, sc, cr, i, j, k, n+scomp );
+                         arr_dst(i,j,k,n+dcomp) = stencil( arr_src, i, j, k, n+scomp );
                      } );
     }
 }
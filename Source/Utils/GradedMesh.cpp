@@ -0,0 +1,133 @@
+/* This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+#include "GradedMesh.H"
+
+#include "Utils/TextMsg.H"
+#include "Utils/WarpXUtil.H"
+
+#include <AMReX.H>
+#include <AMReX_GpuDevice.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Parser.H>
+#include <AMReX_Print.H>
+
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+#if defined(WARPX_DIM_1D_Z)
+    const std::array<std::string, AMREX_SPACEDIM> axis_names{"z"};
+#elif defined(WARPX_DIM_XZ) || defined(WARPX_DIM_RZ)
+    const std::array<std::string, AMREX_SPACEDIM> axis_names{"x", "z"};
+#else
+    const std::array<std::string, AMREX_SPACEDIM> axis_names{"x", "y", "z"};
+#endif
+}
+
+void
+GradedMesh::ReadParameters (amrex::Geometry const& geom)
+{
+    amrex::ParmParse const pp_warpx("warpx");
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        m_min_dx[idim] = geom.CellSize(idim);
+        std::string const name = "graded_mesh_" + axis_names[idim] + "(" + axis_names[idim] + ")";
+        m_graded[idim] = pp_warpx.contains(name.c_str());
+        if (!m_graded[idim]) continue;
+        Store_parserString(pp_warpx, name, m_str_mapping[idim]);
+
+        // the time step is computed before the guard cells, hence before Define
+        amrex::Vector<amrex::Real> const nodes = ComputeNodes(geom, idim, 0);
+        int const n = geom.Domain().length(idim);
+        amrex::Real min_dx = std::numeric_limits<amrex::Real>::max();
+        for (int i = 0; i < n; ++i) min_dx = std::min(min_dx, nodes[i+2] - nodes[i+1]);
+        m_min_dx[idim] = min_dx;
+
+        amrex::Print() << Utils::TextMsg::Info(
+            "graded mesh along " + axis_names[idim] + ": smallest cell size " + std::to_string(min_dx)
+            + " m, domain from " + std::to_string(nodes[1]) + " to " + std::to_string(nodes[n+1]) + " m");
+    }
+}
+
+amrex::Vector<amrex::Real>
+GradedMesh::ComputeNodes (amrex::Geometry const& geom, int idim, int pad) const
+{
+    auto parser = makeParser(m_str_mapping[idim], {axis_names[idim]});
+    auto const mapping = parser.compileHost<1>();
+
+    int const n = geom.Domain().length(idim);
+    amrex::Real const lo = geom.ProbLo(idim);
+    amrex::Real const dx = geom.CellSize(idim);
+    // along a periodic direction, the guard cells repeat the cells of the other side
+    amrex::Real const period = mapping(lo + n*dx) - mapping(lo);
+    auto const node = [&] (int i) {
+        if (!geom.isPeriodic(idim)) return mapping(lo + i*dx);
+        int const shift = (i >= 0) ? i/n : -((n - 1 - i)/n);
+        return mapping(lo + (i - shift*n)*dx) + shift*period;
+    };
+
+    amrex::Vector<amrex::Real> nodes(n + 2*pad + 3);
+    for (int i = -pad-1; i <= n+pad+1; ++i) nodes[i+pad+1] = node(i);
+    for (int i = -pad-1; i <= n+pad; ++i) {
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(nodes[i+pad+2] > nodes[i+pad+1],
+            "warpx.graded_mesh_" + axis_names[idim] + " must be an increasing function");
+    }
+    return nodes;
+}
+
+bool
+GradedMesh::IsGraded () const
+{
+    return std::any_of(m_graded.begin(), m_graded.end(), [] (bool g) { return g; });
+}
+
+MeshCoordinates
+GradedMesh::UniformCoordinates (amrex::Geometry const& geom)
+{
+    MeshCoordinates coords;
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        coords.lo[idim] = geom.ProbLo(idim);
+        coords.dx[idim] = geom.CellSize(idim);
+        coords.nodes[idim] = nullptr;
+        coords.n[idim] = geom.Domain().length(idim);
+    }
+    return coords;
+}
+
+void
+GradedMesh::Define (amrex::Geometry const& geom, int pad)
+{
+    m_pad = pad;
+    m_coordinates = UniformCoordinates(geom);
+    m_coordinates.pad = pad;
+
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        if (!m_graded[idim]) continue;
+        m_h_nodes[idim] = ComputeNodes(geom, idim, pad);
+
+        int const n = geom.Domain().length(idim);
+        m_nodes[idim].resize(n + 2*pad + 1);
+        amrex::Gpu::copyAsync(amrex::Gpu::hostToDevice, m_h_nodes[idim].begin() + 1,
+                              m_h_nodes[idim].end() - 1, m_nodes[idim].begin());
+        m_coordinates.nodes[idim] = m_nodes[idim].dataPtr();
+    }
+    amrex::Gpu::synchronize();
+}
+
+void
+GradedMesh::AppendStencilCoefficients (int idim, amrex::Vector<amrex::Real>& coefs) const
+{
+    using namespace amrex::literals;
+    if (!m_graded[idim]) return;
+
+    amrex::Vector<amrex::Real> const& nodes = m_h_nodes[idim];
+    // index of the node i in nodes
+    auto const x = [&] (int i) { return nodes[i+m_pad+1]; };
+    int const n = static_cast<int>(nodes.size()) - 2*m_pad - 3;
+
+    coefs.push_back(static_cast<amrex::Real>(m_pad));
+    for (int i = -m_pad; i <= n+m_pad; ++i) coefs.push_back(1._rt/(x(i+1) - x(i)));
+    for (int i = -m_pad; i <= n+m_pad; ++i) coefs.push_back(2._rt/(x(i+1) - x(i-1)));
+}
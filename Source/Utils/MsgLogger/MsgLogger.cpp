@@ -218,6 +218,11 @@ void Logger::record_msg(Msg msg)
     m_messages[msg]++;
 }
 
+void Logger::record_msg(Msg msg, std::int64_t count)
+{
+    m_messages[msg] += count;
+}
+
 std::vector<Msg> Logger::get_msgs() const
 {
     auto res = std::vector<Msg>{};
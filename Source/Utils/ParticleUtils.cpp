@@ -20,6 +20,7 @@
 #include <AMReX_PODVector.H>
 #include <AMReX_ParticleTile.H>
 #include <AMReX_REAL.H>
+#include <AMReX_Reduce.H>
 #include <AMReX_SPACE.H>
 
 namespace ParticleUtils {
@@ -64,4 +65,91 @@ namespace ParticleUtils {
         return bins;
     }
 
+    CellBins
+    findParticlesInEachCell( int const lev, MFIter const& mfi,
+                             ParticleTileType const& ptile, bool const may_be_sorted) {
+
+        CellBins bins;
+        if (!may_be_sorted) {
+            bins.m_bins = findParticlesInEachCell(lev, mfi, ptile);
+            return bins;
+        }
+
+        // Extract particle structures for this tile
+        int const np = ptile.numParticles();
+        ParticleType const* particle_ptr = ptile.GetArrayOfStructs()().data();
+
+        // Extract box properties
+        Geometry const& geom = WarpX::GetInstance().Geom(lev);
+        Box const& cbx = mfi.tilebox(IntVect::TheZeroVector()); //Cell-centered box
+        const auto lo = lbound(cbx);
+        const auto hi = ubound(cbx);
+        const auto dxi = geom.InvCellSizeArray();
+        const auto plo = geom.ProbLoArray();
+        int const n_cells = static_cast<int>(cbx.numPts());
+
+        // Cell of each particle, in the same order as amrex::DenseBins
+        Gpu::DeviceVector<index_type> cell(np);
+        index_type* const AMREX_RESTRICT p_cell = cell.dataPtr();
+        amrex::ParallelFor(np, [=] AMREX_GPU_DEVICE (int ip) noexcept
+        {
+            const ParticleType& p = particle_ptr[ip];
+            const IntVect iv = IntVect(AMREX_D_DECL(
+                                   static_cast<int>((p.pos(0)-plo[0])*dxi[0] - lo.x),
+                                   static_cast<int>((p.pos(1)-plo[1])*dxi[1] - lo.y),
+                                   static_cast<int>((p.pos(2)-plo[2])*dxi[2] - lo.z)));
+            const auto iv3 = iv.dim3();
+            const int nx = hi.x-lo.x+1;
+            const int ny = hi.y-lo.y+1;
+            const int nz = hi.z-lo.z+1;
+            const index_type uix = amrex::min(nx-1, amrex::max(0, iv3.x));
+            const index_type uiy = amrex::min(ny-1, amrex::max(0, iv3.y));
+            const index_type uiz = amrex::min(nz-1, amrex::max(0, iv3.z));
+            p_cell[ip] = (uix * ny + uiy) * nz + uiz;
+        });
+
+        // Number of particles in a lower cell than the previous particle
+        ReduceOps<ReduceOpSum> reduce_op;
+        ReduceData<int> reduce_data(reduce_op);
+        using ReduceTuple = typename decltype(reduce_data)::Type;
+        reduce_op.eval(np, reduce_data,
+        [=] AMREX_GPU_DEVICE (int ip) -> ReduceTuple
+        {
+            return {(ip > 0 && p_cell[ip] < p_cell[ip-1]) ? 1 : 0};
+        });
+        if (amrex::get<0>(reduce_data.value()) > 0) {
+            bins.m_bins = findParticlesInEachCell(lev, mfi, ptile);
+            return bins;
+        }
+
+        bins.m_is_sorted = true;
+        bins.m_perm.resize(np);
+        bins.m_offsets.resize(n_cells+1);
+        index_type* const AMREX_RESTRICT p_perm = bins.m_perm.dataPtr();
+        index_type* const AMREX_RESTRICT p_offsets = bins.m_offsets.dataPtr();
+        amrex::ParallelFor(np, [=] AMREX_GPU_DEVICE (int ip) noexcept
+        {
+            p_perm[ip] = ip;
+        });
+        // Offset of a cell: number of particles in the lower cells
+        amrex::ParallelFor(n_cells+1, [=] AMREX_GPU_DEVICE (int i_cell) noexcept
+        {
+            int low = 0;
+            int high = np;
+            while (low < high) {
+                const int mid = (low + high) / 2;
+                if (p_cell[mid] < static_cast<index_type>(i_cell)) {
+                    low = mid + 1;
+                } else {
+                    high = mid;
+                }
+            }
+            p_offsets[i_cell] = low;
+        });
+        // Make sure that `cell` is not destroyed before the GPU kernels finish running
+        Gpu::streamSynchronize();
+
+        return bins;
+    }
+
 }
@@ -0,0 +1,52 @@
+/* This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+#include "ScratchMultiFabs.H"
+
+#include "Utils/MemoryFootprint.H"
+
+#include <algorithm>
+
+amrex::MultiFab&
+ScratchMultiFabs::Get (std::string const& name, int lev, amrex::BoxArray const& ba,
+                       amrex::DistributionMapping const& dm, int ncomp,
+                       amrex::IntVect const& ngrow)
+{
+    for (auto& entry : m_entries) {
+        amrex::MultiFab& mf = *entry.mf;
+        if (entry.name == name && entry.lev == lev && mf.nComp() == ncomp
+            && mf.nGrowVect() == ngrow && mf.DistributionMap() == dm && mf.boxArray() == ba) {
+            return mf;
+        }
+    }
+
+    m_entries.push_back({name, lev, std::make_unique<amrex::MultiFab>(ba, dm, ncomp, ngrow)});
+
+    double bytes = 0.;
+    for (auto const& entry : m_entries) {
+        if (entry.name == name) bytes += LocalMemoryBytes(entry.mf.get());
+    }
+    double& high_water = m_high_water_bytes[name];
+    high_water = std::max(high_water, bytes);
+
+    return *m_entries.back().mf;
+}
+
+void
+ScratchMultiFabs::Clear (int lev)
+{
+    m_entries.erase(std::remove_if(m_entries.begin(), m_entries.end(),
+                                   [lev] (Entry const& entry) { return entry.lev == lev; }),
+                    m_entries.end());
+}
+
+double
+ScratchMultiFabs::Bytes (int lev) const
+{
+    double bytes = 0.;
+    for (auto const& entry : m_entries) {
+        if (entry.lev == lev) bytes += LocalMemoryBytes(entry.mf.get());
+    }
+    return bytes;
+}
@@ -0,0 +1,58 @@
+/* This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+#include "StaticDataMemory.H"
+
+#include "WarpX.H"
+
+#include <AMReX_Arena.H>
+#include <AMReX_GpuDevice.H>
+
+amrex::MFInfo
+StaticDataMFInfo ()
+{
+    amrex::MFInfo info;
+    if (WarpX::static_data_memory == "managed") {
+        info.SetArena(amrex::The_Managed_Arena());
+    } else if (WarpX::static_data_memory == "pinned") {
+        info.SetArena(amrex::The_Pinned_Arena());
+    }
+    return info;
+}
+
+void
+StaticDataPrefetcher::Next (amrex::MFIter const& mfi)
+{
+    if (m_chunks.empty()) return;
+    const int l = mfi.LocalIndex();
+    if (l == 0) Prefetch(0);
+    if (l + 1 < static_cast<int>(m_chunks.size())) {
+        const int stream_index = amrex::Gpu::Device::streamIndex();
+        amrex::Gpu::Device::setStreamIndex(l + 1);
+        Prefetch(l + 1);
+        amrex::Gpu::Device::setStreamIndex(stream_index);
+    }
+}
+
+void
+StaticDataPrefetcher::Prefetch (int l) const
+{
+#ifdef AMREX_USE_GPU
+    for (Chunk const& chunk : m_chunks[l]) {
+#   if defined(AMREX_USE_CUDA)
+        AMREX_CUDA_SAFE_CALL(cudaMemPrefetchAsync(chunk.p, chunk.nbytes,
+                                                  amrex::Gpu::Device::deviceId(),
+                                                  amrex::Gpu::gpuStream()));
+#   elif defined(AMREX_USE_HIP)
+        AMREX_HIP_SAFE_CALL(hipMemPrefetchAsync(chunk.p, chunk.nbytes,
+                                                amrex::Gpu::Device::deviceId(),
+                                                amrex::Gpu::gpuStream()));
+#   elif defined(AMREX_USE_DPCPP)
+        amrex::Gpu::Device::streamQueue().prefetch(chunk.p, chunk.nbytes);
+#   endif
+    }
+#else
+    amrex::ignore_unused(l);
+#endif
+}
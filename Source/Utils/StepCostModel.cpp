@@ -0,0 +1,51 @@
+/* This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+#include "StepCostModel.H"
+
+#include <AMReX_ParallelDescriptor.H>
+
+#include <algorithm>
+
+void
+StepCostModel::Record (amrex::Real step_time, amrex::Vector<amrex::Real> const& phase_times,
+                       double num_cells, long llg_iterations)
+{
+    m_samples.push_back({step_time, phase_times, num_cells, llg_iterations - m_llg_iterations_last});
+    m_llg_iterations_last = llg_iterations;
+    while (static_cast<int>(m_samples.size()) > std::max(m_window, 1)) m_samples.pop_front();
+}
+
+StepCostModel::Summary
+StepCostModel::Summarize (long remaining_steps) const
+{
+    Summary s;
+    s.num_steps = static_cast<int>(m_samples.size());
+    s.remaining_steps = remaining_steps;
+
+    // total wall-clock time of the window, followed by that of each phase
+    const int nphases = m_samples.empty() ? 0 : static_cast<int>(m_samples.front().phase_times.size());
+    amrex::Vector<amrex::Real> times(nphases + 1, 0.);
+    double cell_updates = 0.;
+    double llg_iterations = 0.;
+    for (Sample const& sample : m_samples) {
+        times[0] += sample.step_time;
+        for (int phase = 0; phase < nphases; ++phase) times[phase + 1] += sample.phase_times[phase];
+        cell_updates += sample.num_cells;
+        llg_iterations += static_cast<double>(sample.llg_iterations);
+    }
+    // the slowest rank determines the time of the steps; the number of cells and of LLG
+    // iterations are the same on all the ranks
+    amrex::ParallelDescriptor::ReduceRealMax(times.data(), static_cast<int>(times.size()));
+
+    if (s.num_steps == 0 || times[0] <= 0.) return s;
+    s.step_time = times[0] / s.num_steps;
+    s.phase_times.resize(nphases);
+    for (int phase = 0; phase < nphases; ++phase) s.phase_times[phase] = times[phase + 1] / s.num_steps;
+    s.steps_per_second = s.num_steps / times[0];
+    s.cell_updates_per_second = static_cast<amrex::Real>(cell_updates / times[0]);
+    s.llg_iterations_per_second = static_cast<amrex::Real>(llg_iterations / times[0]);
+    s.projected_time = s.step_time * static_cast<amrex::Real>(remaining_steps);
+    return s;
+}
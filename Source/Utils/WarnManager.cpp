@@ -14,8 +14,13 @@
 
 #include <AMReX_ParallelDescriptor.H>
 
+#ifdef AMREX_USE_OMP
+#   include <omp.h>
+#endif
+
 #include <algorithm>
 #include <sstream>
+#include <utility>
 
 using namespace Utils;
 using namespace Utils::MsgLogger;
@@ -23,18 +28,47 @@ using namespace Utils::MsgLogger;
 WarnManager::WarnManager():
     m_rank{amrex::ParallelDescriptor::MyProc()},
     m_p_logger{std::make_unique<Logger>()}
-{}
+{
+#ifdef AMREX_USE_OMP
+    m_thread_warnings.resize(omp_get_max_threads());
+#endif
+}
 
 void WarnManager::record_warning(
             std::string topic,
             std::string text,
             Priority priority)
 {
-    m_p_logger->record_msg(Msg{topic, text, priority});
+#ifdef AMREX_USE_OMP
+    if (omp_in_parallel()) {
+        // the thread numbers are only unique in the outermost parallel region: in nested
+        // regions (active or not), threads of different teams share the same numbers
+        const auto thread = static_cast<std::size_t>(omp_get_thread_num());
+        if (omp_get_level() == 1 && thread < m_thread_warnings.size()) {
+            m_thread_warnings[thread].msgs[Msg{std::move(topic), std::move(text), priority}]++;
+        } else {
+            #pragma omp critical (warpx_warn_manager)
+            m_p_logger->record_msg(Msg{std::move(topic), std::move(text), priority});
+        }
+        return;
+    }
+#endif
+    m_p_logger->record_msg(Msg{std::move(topic), std::move(text), priority});
+}
+
+void WarnManager::flush_thread_warnings()
+{
+    for (auto& thread_warnings : m_thread_warnings) {
+        for (const auto& msg_with_counter : thread_warnings.msgs) {
+            m_p_logger->record_msg(msg_with_counter.first, msg_with_counter.second);
+        }
+        thread_warnings.msgs.clear();
+    }
 }
 
-std::string WarnManager::print_local_warnings(const std::string& when) const
+std::string WarnManager::print_local_warnings(const std::string& when)
 {
+    flush_thread_warnings();
     auto all_warnings = m_p_logger->get_msgs_with_counter();
     std::sort(all_warnings.begin(), all_warnings.end(),
         [](const auto& a, const auto& b){return a.msg < b.msg;});
@@ -58,8 +92,9 @@ std::string WarnManager::print_local_warnings(const std::string& when) const
     return ss.str();
 }
 
-std::string WarnManager::print_global_warnings(const std::string& when) const
+std::string WarnManager::print_global_warnings(const std::string& when)
 {
+    flush_thread_warnings();
     auto all_warnings =
         m_p_logger->collective_gather_msgs_with_counter_and_ranks();
 
@@ -9,6 +9,7 @@
 #include "WarpX.H"
 
 #include "BoundaryConditions/PML.H"
+#include "FieldSolver/FiniteDifferenceSolver/MacroscopicProperties/MacroscopicProperties.H"
 #if (defined WARPX_DIM_RZ) && (defined WARPX_USE_PSATD)
 #   include "BoundaryConditions/PML_RZ.H"
 #endif
@@ -90,6 +91,9 @@ WarpX::MoveWindow (const int step, bool move_j)
     }
     if (moving_window_active(step) == false) return 0;
 
+    // the fields may be shifted
+    InvalidateDeepHalo();
+
     // Update the continuous position of the moving window,
     // and of the plasma injection
     moving_window_x += (moving_window_v - WarpX::beta_boost * PhysConst::c)/(1 - moving_window_v * WarpX::beta_boost / PhysConst::c) * dt[0];
@@ -221,6 +225,71 @@ WarpX::MoveWindow (const int step, bool move_j)
             }
         }
 
+#ifdef WARPX_MAG_LLG
+        if (mag_LLG) {
+            // Shift the LLG fields: H and H_bias are vector fields like E and B, while each face
+            // MultiFab of M holds the three components of M
+            for (int dim = 0; dim < 3; ++dim) {
+                amrex::ParserExecutor<3> Hfield_parser;
+                amrex::ParserExecutor<3> H_biasfield_parser;
+                bool use_Hparser = false;
+                bool use_H_biasparser = false;
+                if (H_ext_grid_s == "parse_h_ext_grid_function") {
+                    use_Hparser = true;
+                    if (dim == 0) Hfield_parser = Hxfield_parser->compile<3>();
+                    if (dim == 1) Hfield_parser = Hyfield_parser->compile<3>();
+                    if (dim == 2) Hfield_parser = Hzfield_parser->compile<3>();
+                }
+                if (H_bias_ext_grid_s == "parse_h_bias_ext_grid_function") {
+                    use_H_biasparser = true;
+                    if (dim == 0) H_biasfield_parser = Hx_biasfield_parser->compile<3>();
+                    if (dim == 1) H_biasfield_parser = Hy_biasfield_parser->compile<3>();
+                    if (dim == 2) H_biasfield_parser = Hz_biasfield_parser->compile<3>();
+                }
+                amrex::Vector<amrex::ParserExecutor<3>> Mfield_parser;
+                bool use_Mparser = false;
+                if (M_ext_grid_s == "parse_m_ext_grid_function") {
+                    use_Mparser = true;
+                    Mfield_parser = {Mxfield_parser->compile<3>(), Myfield_parser->compile<3>(),
+                                     Mzfield_parser->compile<3>()};
+                }
+                const amrex::Vector<amrex::Real> M_external(M_external_grid.begin(),
+                                                            M_external_grid.begin() + 3);
+
+                shiftMF(*Hfield_fp[lev][dim], geom[lev], num_shift, dir, lev, H_external_grid[dim], use_Hparser, Hfield_parser);
+                if (H_biasfield_fp[lev][dim]) {
+                    shiftMF(*H_biasfield_fp[lev][dim], geom[lev], num_shift, dir, lev, H_bias_external_grid[dim], use_H_biasparser, H_biasfield_parser);
+                }
+                shiftMF(*Mfield_fp[lev][dim], geom[lev], num_shift, dir, lev, M_external, use_Mparser, Mfield_parser);
+                if (pml[lev] && pml[lev]->ok()) {
+                    const std::array<amrex::MultiFab*, 3>& pml_H = pml[lev]->GetH_fp();
+                    shiftMF(*pml_H[dim], geom[lev], num_shift, dir, lev);
+                }
+                if (lev > 0) {
+                    // coarse grid
+                    shiftMF(*Hfield_cp[lev][dim], geom[lev-1], num_shift_crse, dir, lev, H_external_grid[dim], use_Hparser, Hfield_parser);
+                    if (H_biasfield_cp[lev][dim]) {
+                        shiftMF(*H_biasfield_cp[lev][dim], geom[lev-1], num_shift_crse, dir, lev, H_bias_external_grid[dim], use_H_biasparser, H_biasfield_parser);
+                    }
+                    shiftMF(*Mfield_cp[lev][dim], geom[lev-1], num_shift_crse, dir, lev, M_external, use_Mparser, Mfield_parser);
+                    shiftMF(*Hfield_aux[lev][dim], geom[lev], num_shift, dir, lev);
+                    if (H_biasfield_aux[lev][dim]) shiftMF(*H_biasfield_aux[lev][dim], geom[lev], num_shift, dir, lev);
+                    shiftMF(*Mfield_aux[lev][dim], geom[lev], num_shift, dir, lev);
+                    if (do_pml && pml[lev]->ok()) {
+                        const std::array<amrex::MultiFab*, 3>& pml_H = pml[lev]->GetH_cp();
+                        shiftMF(*pml_H[dim], geom[lev-1], num_shift_crse, dir, lev);
+                    }
+                }
+            }
+        }
+#endif
+
+        // The material properties are shifted with the fields, and evaluated on the cells
+        // that the window moved into
+        if (WarpX::em_solver_medium == MediumForEM::Macroscopic && m_macroscopic_properties[lev]) {
+            m_macroscopic_properties[lev]->ShiftProperties(num_shift, dir);
+        }
+
         // Shift scalar component F for dive cleaning
         if (do_dive_cleaning) {
             // Fine grid
@@ -298,6 +367,17 @@ WarpX::shiftMF (amrex::MultiFab& mf, const amrex::Geometry& geom,
                 int num_shift, int dir, const int lev,
                 amrex::Real external_field, bool useparser,
                 amrex::ParserExecutor<3> const& field_parser)
+{
+    const int nc = mf.nComp();
+    shiftMF(mf, geom, num_shift, dir, lev, amrex::Vector<amrex::Real>(nc, external_field),
+            useparser, amrex::Vector<amrex::ParserExecutor<3>>(nc, field_parser));
+}
+
+void
+WarpX::shiftMF (amrex::MultiFab& mf, const amrex::Geometry& geom,
+                int num_shift, int dir, const int lev,
+                amrex::Vector<amrex::Real> const& external_field, bool useparser,
+                amrex::Vector<amrex::ParserExecutor<3>> const& field_parser)
 {
     using namespace amrex::literals;
     WARPX_PROFILE("WarpX::shiftMF()");
@@ -307,13 +387,14 @@ WarpX::shiftMF (amrex::MultiFab& mf, const amrex::Geometry& geom,
     const amrex::IntVect& ng = mf.nGrowVect();
 
     AMREX_ALWAYS_ASSERT(ng[dir] >= num_shift);
+    AMREX_ALWAYS_ASSERT(static_cast<int>(external_field.size()) == nc);
+    AMREX_ALWAYS_ASSERT(!useparser || static_cast<int>(field_parser.size()) == nc);
 
-    amrex::MultiFab tmpmf(ba, dm, nc, ng);
-    amrex::MultiFab::Copy(tmpmf, mf, 0, 0, nc, ng);
-
+    // The data is shifted in place: only the guard cells, from which the data is shifted
+    // into the valid cells, are communicated
     if ( WarpX::safe_guard_cells ) {
         // Fill guard cells.
-        WarpXCommUtil::FillBoundary(tmpmf, geom.periodicity());
+        WarpXCommUtil::FillBoundary(mf, geom.periodicity());
     } else {
         amrex::IntVect ng_mw = amrex::IntVect::TheUnitVector();
         // Enough guard cells in the MW direction
@@ -321,7 +402,7 @@ WarpX::shiftMF (amrex::MultiFab& mf, const amrex::Geometry& geom,
         // Make sure we don't exceed number of guard cells allocated
         ng_mw = ng_mw.min(ng);
         // Fill guard cells.
-        WarpXCommUtil::FillBoundary(tmpmf, ng_mw, geom.periodicity());
+        WarpXCommUtil::FillBoundary(mf, ng_mw, geom.periodicity());
     }
 
     // Make a box that covers the region that the window moved into
@@ -351,16 +432,23 @@ WarpX::shiftMF (amrex::MultiFab& mf, const amrex::Geometry& geom,
     amrex::IntVect shiftiv(0);
     shiftiv[dir] = num_shift;
     amrex::Dim3 shift = shiftiv.dim3();
+    amrex::Dim3 step = amrex::IntVect::TheDimensionVector(dir).dim3();
 
     const amrex::RealBox& real_box = geom.ProbDomain();
     const auto dx = geom.CellSizeArray();
 
+    // index type of the mf
+    amrex::IntVect mf_type(AMREX_D_DECL(0,0,0));
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        mf_type[idim] = typ.nodeCentered(idim);
+    }
+
     amrex::LayoutData<amrex::Real>* cost = WarpX::getCosts(lev);
 #ifdef AMREX_USE_OMP
 #pragma omp parallel if (Gpu::notInLaunchRegion())
 #endif
 
-    for (amrex::MFIter mfi(tmpmf); mfi.isValid(); ++mfi )
+    for (amrex::MFIter mfi(mf); mfi.isValid(); ++mfi )
     {
         if (cost && WarpX::load_balance_costs_update_algo == LoadBalanceCostsUpdateAlgo::Timers)
         {
@@ -368,52 +456,48 @@ WarpX::shiftMF (amrex::MultiFab& mf, const amrex::Geometry& geom,
         }
         amrex::Real wt = amrex::second();
 
-        auto const& dstfab = mf.array(mfi);
-        auto const& srcfab = tmpmf.array(mfi);
+        auto const& fab = mf.array(mfi);
 
         const amrex::Box& outbox = mfi.fabbox() & adjBox;
 
         if (outbox.ok()) {
-            if (useparser == false) {
-                AMREX_PARALLEL_FOR_4D ( outbox, nc, i, j, k, n,
-                {
-                    srcfab(i,j,k,n) = external_field;
-                })
-            } else if (useparser == true) {
-                // index type of the src mf
-                auto const& mf_IndexType = (tmpmf).ixType();
-                amrex::IntVect mf_type(AMREX_D_DECL(0,0,0));
-                for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
-                    mf_type[idim] = mf_IndexType.nodeCentered(idim);
-                }
-
-                amrex::ParallelFor (outbox, nc,
-                      [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) noexcept
-                {
-                      // Compute x,y,z co-ordinates based on index type of mf
+            for (int n = 0; n < nc; ++n) {
+                if (useparser == false) {
+                    const amrex::Real value = external_field[n];
+                    amrex::ParallelFor (outbox,
+                          [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+                    {
+                          fab(i,j,k,n) = value;
+                    });
+                } else if (useparser == true) {
+                    amrex::ParserExecutor<3> const component_parser = field_parser[n];
+                    amrex::ParallelFor (outbox,
+                          [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+                    {
+                          // Compute x,y,z co-ordinates based on index type of mf
 #if defined(WARPX_DIM_1D_Z)
-                      amrex::Real x = 0.0_rt;
-                      amrex::Real y = 0.0_rt;
-                      amrex::Real fac_z = (1.0_rt - mf_type[0]) * dx[0]*0.5_rt;
-                      amrex::Real z = i*dx[0] + real_box.lo(0) + fac_z;
+                          amrex::Real x = 0.0_rt;
+                          amrex::Real y = 0.0_rt;
+                          amrex::Real fac_z = (1.0_rt - mf_type[0]) * dx[0]*0.5_rt;
+                          amrex::Real z = i*dx[0] + real_box.lo(0) + fac_z;
 #elif defined(WARPX_DIM_XZ) || defined(WARPX_DIM_RZ)
-                      amrex::Real fac_x = (1.0_rt - mf_type[0]) * dx[0]*0.5_rt;
-                      amrex::Real x = i*dx[0] + real_box.lo(0) + fac_x;
-                      amrex::Real y = 0.0;
-                      amrex::Real fac_z = (1.0_rt - mf_type[1]) * dx[1]*0.5_rt;
-                      amrex::Real z = j*dx[1] + real_box.lo(1) + fac_z;
+                          amrex::Real fac_x = (1.0_rt - mf_type[0]) * dx[0]*0.5_rt;
+                          amrex::Real x = i*dx[0] + real_box.lo(0) + fac_x;
+                          amrex::Real y = 0.0;
+                          amrex::Real fac_z = (1.0_rt - mf_type[1]) * dx[1]*0.5_rt;
+                          amrex::Real z = j*dx[1] + real_box.lo(1) + fac_z;
 #else
-                      amrex::Real fac_x = (1.0_rt - mf_type[0]) * dx[0]*0.5_rt;
-                      amrex::Real x = i*dx[0] + real_box.lo(0) + fac_x;
-                      amrex::Real fac_y = (1.0_rt - mf_type[1]) * dx[1]*0.5_rt;
-                      amrex::Real y = j*dx[1] + real_box.lo(1) + fac_y;
-                      amrex::Real fac_z = (1.0_rt - mf_type[2]) * dx[2]*0.5_rt;
-                      amrex::Real z = k*dx[2] + real_box.lo(2) + fac_z;
+                          amrex::Real fac_x = (1.0_rt - mf_type[0]) * dx[0]*0.5_rt;
+                          amrex::Real x = i*dx[0] + real_box.lo(0) + fac_x;
+                          amrex::Real fac_y = (1.0_rt - mf_type[1]) * dx[1]*0.5_rt;
+                          amrex::Real y = j*dx[1] + real_box.lo(1) + fac_y;
+                          amrex::Real fac_z = (1.0_rt - mf_type[2]) * dx[2]*0.5_rt;
+                          amrex::Real z = k*dx[2] + real_box.lo(2) + fac_z;
 #endif
-                      srcfab(i,j,k,n) = field_parser(x,y,z);
-                });
+                          fab(i,j,k,n) = component_parser(x,y,z);
+                    });
+                }
             }
-
         }
 
         amrex::Box dstBox = mf[mfi].box();
@@ -422,9 +506,20 @@ WarpX::shiftMF (amrex::MultiFab& mf, const amrex::Geometry& geom,
         } else {
             dstBox.growLo(dir,  num_shift);
         }
-        AMREX_PARALLEL_FOR_4D ( dstBox, nc, i, j, k, n,
+        // Each thread shifts a line of cells along dir, starting from the end towards which
+        // the data moves, so that each cell is read before it is overwritten
+        amrex::Box lineBox = dstBox;
+        lineBox.setBig(dir, dstBox.smallEnd(dir));
+        const int len = dstBox.length(dir);
+        AMREX_PARALLEL_FOR_4D ( lineBox, nc, i, j, k, n,
         {
-            dstfab(i,j,k,n) = srcfab(i+shift.x,j+shift.y,k+shift.z,n);
+            for (int m = 0; m < len; ++m) {
+                const int l = (num_shift > 0) ? m : len - 1 - m;
+                const int id = i + l*step.x;
+                const int jd = j + l*step.y;
+                const int kd = k + l*step.z;
+                fab(id,jd,kd,n) = fab(id+shift.x,jd+shift.y,kd+shift.z,n);
+            }
         })
 
         if (cost && WarpX::load_balance_costs_update_algo == LoadBalanceCostsUpdateAlgo::Timers)
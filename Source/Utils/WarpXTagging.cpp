@@ -8,6 +8,10 @@
 
 #include <WarpX.H>
 
+#ifdef WARPX_MAG_LLG
+#   include "FieldSolver/FiniteDifferenceSolver/MacroscopicProperties/MacroscopicProperties.H"
+#endif
+
 #include <AMReX_BaseFab.H>
 #include <AMReX_Config.H>
 #include <AMReX_FabArray.H>
@@ -22,6 +26,8 @@
 
 #include <AMReX_BaseFwd.H>
 
+#include <cmath>
+
 using namespace amrex;
 
 void
@@ -50,4 +56,89 @@ WarpX::ErrorEst (int lev, TagBoxArray& tags, Real /*time*/, int /*ngrow*/)
             }
         });
     }
+
+#ifdef WARPX_MAG_LLG
+    // the cells of the domain walls and vortices, where M rotates, and of the large currents
+    const bool tag_angle = (tag_mag_grad_angle > 0._rt);
+    const bool tag_curl = (tag_curl_H > 0._rt);
+    if (!tag_angle && !tag_curl) return;
+
+    // the neighbors of the points next to the box boundaries are read in the guard cells
+    const amrex::Periodicity& period = Geom(lev).periodicity();
+    const int nmf_M = (mag_M_collocated == 1) ? 1 : 3;
+    for (int i = 0; i < nmf_M; ++i) Mfield_fp[lev][i]->FillBoundary(period);
+    for (int i = 0; i < 3; ++i) Hfield_fp[lev][i]->FillBoundary(period);
+
+    const Real cos_angle = std::cos(tag_mag_grad_angle);
+    const Real curl_H_max = tag_curl_H;
+    const MeshCoordinates coords = GetMeshCoordinates(lev);
+    const IntVect Hx_stag = Hfield_fp[lev][0]->ixType().toIntVect();
+    const IntVect Hy_stag = Hfield_fp[lev][1]->ixType().toIntVect();
+    const IntVect Hz_stag = Hfield_fp[lev][2]->ixType().toIntVect();
+    const IntVect cc = IntVect::TheCellVector();
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi(tags); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.validbox();
+        const auto& fab = tags.array(mfi);
+        // M is compared with its neighbors on the x-faces (or at the cell centers if collocated)
+        Array4<Real> const& M = Mfield_fp[lev][0]->array(mfi);
+        Array4<Real> const& Hx = Hfield_fp[lev][0]->array(mfi);
+        Array4<Real> const& Hy = Hfield_fp[lev][1]->array(mfi);
+        Array4<Real> const& Hz = Hfield_fp[lev][2]->array(mfi);
+        ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+        {
+            if (tag_angle) {
+                const Real Mx = M(i,j,k,0);
+                const Real My = M(i,j,k,1);
+                const Real Mz = M(i,j,k,2);
+                const Real M_norm = std::sqrt(Mx*Mx + My*My + Mz*Mz);
+                for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+                    for (int s = -1; s <= 1; s += 2) {
+                        const int ii = i + ((idim == 0) ? s : 0);
+                        const int jj = j + ((idim == 1) ? s : 0);
+                        const int kk = k + ((idim == 2) ? s : 0);
+                        const Real Nx = M(ii,jj,kk,0);
+                        const Real Ny = M(ii,jj,kk,1);
+                        const Real Nz = M(ii,jj,kk,2);
+                        const Real N_norm = std::sqrt(Nx*Nx + Ny*Ny + Nz*Nz);
+                        // the interfaces with the non-magnetic material are not tagged
+                        if (M_norm > 0._rt && N_norm > 0._rt
+                            && Mx*Nx + My*Ny + Mz*Nz < cos_angle * M_norm * N_norm) {
+                            fab(i,j,k) = TagBox::SET;
+                        }
+                    }
+                }
+            }
+            if (tag_curl) {
+                // central differences of H averaged to the cell centers
+                auto const d_cc = [=] (Array4<Real> const& H, IntVect const& stag, int idim) {
+                    const int di = (idim == 0) ? 1 : 0;
+                    const int dj = (idim == 1) ? 1 : 0;
+                    const int dk = (idim == 2) ? 1 : 0;
+                    const int index = (idim == 0) ? i : ((idim == 1) ? j : k);
+                    const Real h = coords(idim, index+1, 0) - coords(idim, index-1, 0);
+                    return (MacroscopicProperties::face_avg_to_face(i+di, j+dj, k+dk, 0, stag, cc, H)
+                          - MacroscopicProperties::face_avg_to_face(i-di, j-dj, k-dk, 0, stag, cc, H)) / h;
+                };
+#if defined(WARPX_DIM_3D)
+                const Real curl_x = d_cc(Hz, Hz_stag, 1) - d_cc(Hy, Hy_stag, 2);
+                const Real curl_y = d_cc(Hx, Hx_stag, 2) - d_cc(Hz, Hz_stag, 0);
+                const Real curl_z = d_cc(Hy, Hy_stag, 0) - d_cc(Hx, Hx_stag, 1);
+#else
+                // x and z are the directions 0 and 1, and the fields do not vary along y
+                const Real curl_x = - d_cc(Hy, Hy_stag, 1);
+                const Real curl_y = d_cc(Hx, Hx_stag, 1) - d_cc(Hz, Hz_stag, 0);
+                const Real curl_z = d_cc(Hy, Hy_stag, 0);
+#endif
+                if (curl_x*curl_x + curl_y*curl_y + curl_z*curl_z > curl_H_max*curl_H_max) {
+                    fab(i,j,k) = TagBox::SET;
+                }
+            }
+        });
+    }
+#endif
 }
@@ -12,11 +12,16 @@
 #include "WarpX.H"
 
 #include "BoundaryConditions/PML.H"
+#include "BoundaryConditions/WarpX_PEC.H"
 #include "Diagnostics/BackTransformedDiagnostic.H"
 #include "Diagnostics/MultiDiagnostics.H"
 #include "Diagnostics/ReducedDiags/MultiReducedDiags.H"
 #include "FieldSolver/FiniteDifferenceSolver/FiniteDifferenceSolver.H"
 #include "FieldSolver/FiniteDifferenceSolver/MacroscopicProperties/MacroscopicProperties.H"
+#include "FieldSolver/LumpedElements.H"
+#include "FieldSolver/MagThinFilm.H"
+#include "FieldSolver/TFSFSource.H"
+#include "FieldSolver/WaveguidePortMode.H"
 #ifdef WARPX_USE_PSATD
 #   include "FieldSolver/SpectralSolver/SpectralKSpace.H"
 #   ifdef WARPX_DIM_RZ
@@ -25,11 +30,18 @@
 #   else
 #       include "FieldSolver/SpectralSolver/SpectralSolver.H"
 #   endif // RZ ifdef
+#   ifdef WARPX_MAG_LLG
+#       include "FieldSolver/SpectralSolver/SpectralMagnetostaticSolver.H"
+#   endif
 #endif // use PSATD ifdef
 #include "FieldSolver/WarpX_FDTD.H"
 #include "Filter/NCIGodfreyFilter.H"
+#include "Parallelization/CostsBreakdown.H"
+#include "Parallelization/HaloExchangePlan.H"
 #include "Particles/MultiParticleContainer.H"
 #include "Particles/ParticleBoundaryBuffer.H"
+#include "Utils/MemoryFootprint.H"
+#include "Utils/StaticDataMemory.H"
 #include "Utils/TextMsg.H"
 #include "Utils/MsgLogger/MsgLogger.H"
 #include "Utils/WarnManager.H"
@@ -66,6 +78,7 @@
 #include <AMReX_MakeType.H>
 #include <AMReX_MultiFab.H>
 #include <AMReX_ParallelDescriptor.H>
+#include <AMReX_ParallelReduce.H>
 #include <AMReX_ParmParse.H>
 #include <AMReX_Print.H>
 #include <AMReX_Random.H>
@@ -74,8 +87,11 @@
 
 #include <algorithm>
 #include <cmath>
+#include <iomanip>
 #include <limits>
+#include <map>
 #include <random>
+#include <sstream>
 #include <string>
 #include <utility>
 
@@ -84,6 +100,8 @@ using namespace amrex;
 Vector<Real> WarpX::E_external_grid(3, 0.0); // this is fill constructor
 Vector<Real> WarpX::B_external_grid(3, 0.0);
 
+int WarpX::mag_LLG = 0;
+
 #ifdef WARPX_MAG_LLG
 Vector<Real> WarpX::M_external_grid(3, 0.0);
 Vector<Real> WarpX::H_external_grid(3, 0.0);
@@ -196,6 +214,9 @@ bool WarpX::do_divb_cleaning = false;
 int WarpX::em_solver_medium;
 int WarpX::macroscopic_solver_algo;
 bool WarpX::do_single_precision_comms = false;
+int WarpX::use_persistent_comm = 0;
+int WarpX::use_shared_memory_comm = 0;
+std::string WarpX::static_data_memory = "device";
 amrex::Vector<int> WarpX::field_boundary_lo(AMREX_SPACEDIM,0);
 amrex::Vector<int> WarpX::field_boundary_hi(AMREX_SPACEDIM,0);
 amrex::Vector<ParticleBoundaryType> WarpX::particle_boundary_lo(AMREX_SPACEDIM,ParticleBoundaryType::Absorbing);
@@ -235,6 +256,14 @@ int WarpX::num_mirrors = 0;
 
 IntervalsParser WarpX::sort_intervals;
 amrex::IntVect WarpX::sort_bin_size(AMREX_D_DECL(1,1,1));
+bool WarpX::sort_incremental = false;
+bool WarpX::redistribute_neighbors_only = false;
+int WarpX::particle_slab_size = 0;
+bool WarpX::flux_injection_in_place = false;
+amrex::Real WarpX::hole_compaction_threshold = 0.5_rt;
+bool WarpX::do_fused_push_deposit = false;
+bool WarpX::do_shared_mem_current_deposition = false;
+amrex::IntVect WarpX::shared_tilesize(AMREX_D_PICK(64,16,4));
 
 bool WarpX::do_back_transformed_diagnostics = false;
 std::string WarpX::lab_data_directory = "lab_frame_data";
@@ -254,11 +283,18 @@ Real WarpX::self_fields_required_precision = 1.e-11_rt;
 Real WarpX::self_fields_absolute_tolerance = 0.0_rt;
 int WarpX::self_fields_max_iters = 200;
 int WarpX::self_fields_verbosity = 2;
+int WarpX::self_fields_warm_start = 0;
 
 bool WarpX::do_subcycling = false;
 bool WarpX::do_multi_J = false;
 int WarpX::do_multi_J_n_depositions;
 bool WarpX::safe_guard_cells = 0;
+int WarpX::minimal_guard_cells = 0;
+int WarpX::skip_clean_fill_boundary = 0;
+int WarpX::deep_halo_steps = 1;
+int WarpX::temporal_blocking = 0;
+int WarpX::temporal_blocking_interleaved = 0;
+int WarpX::do_tfsf = 0;
 
 IntVect WarpX::filter_npass_each_dir(1);
 
@@ -269,6 +305,9 @@ bool WarpX::do_nodal = false;
 amrex::IntVect m_rho_nodal_flag;
 
 int WarpX::do_similar_dm_pml = 1;
+int WarpX::do_cpml = 0;
+int WarpX::do_pml_slabs = 0;
+int WarpX::pml_slab_max_size = 64;
 
 #ifdef AMREX_USE_GPU
 bool WarpX::do_device_synchronize = true;
@@ -301,10 +340,15 @@ WarpX::WarpX ()
     m_p_warn_manager = std::make_unique<Utils::WarnManager>();
 
     ReadParameters();
+    m_startup_start_time = amrex::second();
+    m_startup_phase_start_time = m_startup_start_time;
 
     BackwardCompatibility();
 
     InitEB();
+#ifdef AMREX_USE_EB
+    StartupPhaseEnd("embedded boundaries");
+#endif
 
     ablastr::utils::SignalHandling::InitSignalHandling();
 
@@ -329,6 +373,56 @@ WarpX::WarpX ()
 
     // Particle Container
     mypc = std::make_unique<MultiParticleContainer>(this);
+
+    if (deep_halo_steps > 1) {
+        // The redundant updates in the guard cells are only implemented for the source-free
+        // Cartesian Yee updates of E and B, on a single level and without PML
+#if defined(WARPX_DIM_RZ)
+        amrex::Abort(Utils::TextMsg::Err(
+            "warpx.deep_halo_steps > 1 is not implemented with LLG or in RZ geometry"));
+#endif
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(!mag_LLG,
+            "warpx.deep_halo_steps > 1 is not implemented with LLG or in RZ geometry");
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(
+            maxwell_solver_id == MaxwellSolverAlgo::Yee && !do_nodal
+            && do_electrostatic == ElectrostaticSolverAlgo::None,
+            "warpx.deep_halo_steps > 1 requires the staggered Yee solver");
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(max_level == 0 && !isAnyBoundaryPML(),
+            "warpx.deep_halo_steps > 1 is not implemented with mesh refinement or PML");
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(
+            mypc->nSpecies() == 0 && mypc->GetLasersNames().empty(),
+            "warpx.deep_halo_steps > 1 is only implemented without particles and lasers");
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(!do_dive_cleaning && !do_divb_cleaning && !do_tfsf,
+            "warpx.deep_halo_steps > 1 is not implemented with divergence cleaning or TFSF");
+    }
+    if (temporal_blocking) {
+#ifdef AMREX_USE_GPU
+        // the fused tiles are sized for the CPU caches
+        this->RecordWarning("Performance",
+            "warpx.temporal_blocking is only implemented on CPU and is disabled.",
+            WarnPriority::low);
+        temporal_blocking = 0;
+#else
+        // The fused updates are the vacuum Yee updates of the deep-halo mode, without
+        // boundary conditions or embedded boundaries between the half steps
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(deep_halo_steps > 1,
+            "warpx.temporal_blocking = 1 requires warpx.deep_halo_steps > 1");
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(em_solver_medium == MediumForEM::Vacuum,
+            "warpx.temporal_blocking = 1 requires algo.em_solver_medium = vacuum");
+        bool silver_mueller = false;
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+            silver_mueller = silver_mueller
+                || field_boundary_lo[idim] == FieldBoundaryType::Absorbing_SilverMueller
+                || field_boundary_hi[idim] == FieldBoundaryType::Absorbing_SilverMueller;
+        }
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(!PEC::isAnyBoundaryPEC() && !silver_mueller,
+            "warpx.temporal_blocking = 1 is not implemented with PEC or Silver-Mueller boundaries");
+#ifdef AMREX_USE_EB
+        amrex::Abort(Utils::TextMsg::Err(
+            "warpx.temporal_blocking = 1 is not implemented with embedded boundaries"));
+#endif
+#endif
+    }
     warpx_do_continuous_injection = mypc->doContinuousInjection();
     if (warpx_do_continuous_injection){
         if (moving_window_v >= 0){
@@ -383,6 +477,9 @@ WarpX::WarpX ()
 
     ECTRhofield.resize(nlevs_max);
     Venl.resize(nlevs_max);
+#ifdef WARPX_MAG_LLG
+    m_ect_minus_curlE.resize(nlevs_max);
+#endif
 
     current_store.resize(nlevs_max);
 
@@ -436,10 +533,31 @@ WarpX::WarpX ()
     m_field_factory.resize(nlevs_max);
 
     if (em_solver_medium == MediumForEM::Macroscopic) {
-        // create object for macroscopic solver
-        m_macroscopic_properties = std::make_unique<MacroscopicProperties>();
+        // create object for macroscopic solver, on each level
+        m_macroscopic_properties.resize(nlevs_max);
+        for (int lev = 0; lev < nlevs_max; ++lev) {
+            m_macroscopic_properties[lev] = std::make_unique<MacroscopicProperties>();
+        }
     }
 
+#if defined(WARPX_MAG_LLG) && !defined(WARPX_DIM_RZ)
+    // The LLG solver has no coarse patch: with mesh refinement, the levels are advanced in lockstep
+    if (mag_LLG && max_level > 0) {
+        mag_mr_lockstep = true;
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(!do_subcycling || mypc->nSpecies() == 0,
+            "warpx.do_subcycling = 1 with the LLG solver is not implemented with particles");
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(deep_halo_steps <= 1,
+            "mesh refinement with the LLG solver is not implemented with warpx.deep_halo_steps > 1");
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(!do_tfsf,
+            "mesh refinement with the LLG solver is not implemented with warpx.do_tfsf = 1");
+    }
+#endif
+#ifdef WARPX_MAG_LLG
+    // the multirate steps of the LLG solver, see OneStep_mag_multirate, support any number of levels
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(do_subcycling != 1 || max_level <= 1 || MRLockstep(),
+                                     "Subcycling method 1 only works for 2 levels.");
+#endif
+
 
     // Set default values for particle and cell weights for costs update;
     // Default values listed here for the case AMREX_USE_GPU are determined
@@ -486,6 +604,8 @@ WarpX::WarpX ()
         costs_heuristic_particles_wt = 0.9_rt;
 #endif // AMREX_USE_GPU
     }
+    // The LLG update of one face costs about as much as the update of a vacuum cell
+    if (costs_heuristic_mag_wt < 0.) costs_heuristic_mag_wt = costs_heuristic_cells_wt;
 
     // Allocate field solver objects
 #ifdef WARPX_USE_PSATD
@@ -525,6 +645,8 @@ WarpX::~WarpX ()
     for (int lev = 0; lev < nlevs_max; ++lev) {
         ClearLevel(lev);
     }
+    WarpXCommUtil::ClearHaloExchangePlans();
+    if (m_instance == this) m_instance = nullptr;
 }
 
 void
@@ -553,12 +675,9 @@ WarpX::RecordWarning(
                 + text));
     }
 
-#ifdef AMREX_USE_OMP
-    #pragma omp critical
-#endif
-    {
-        m_p_warn_manager->record_warning(topic, text, msg_priority);
-    }
+    // recorded locally, and without lock inside OpenMP parallel regions: the ranks only
+    // exchange their warnings in PrintGlobalWarnings
+    m_p_warn_manager->record_warning(topic, text, msg_priority);
 
     if(m_abort_on_warning_threshold){
 
@@ -610,11 +729,29 @@ WarpX::ReadParameters ()
         ParmParse pp_amr("amr");
 
         pp_amr.query("restart", restart_chkfile);
+        pp_amr.query("restart_local_path", restart_local_path);
+        pp_amr.query("restart_regrid", restart_regrid);
     }
 
     {
         ParmParse pp_algo("algo");
         maxwell_solver_id = GetAlgorithmInteger(pp_algo, "maxwell_solver");
+
+        // the LLG solver is selected at run time, by default in macroscopic media, which it requires
+        bool const macroscopic =
+            GetAlgorithmInteger(pp_algo, "em_solver_medium") == MediumForEM::Macroscopic;
+        ParmParse pp_warpx("warpx");
+#if defined(WARPX_MAG_LLG) && !defined(WARPX_DIM_RZ)
+        mag_LLG = macroscopic ? 1 : 0;
+#endif
+        pp_warpx.query("mag_LLG", mag_LLG);
+#if defined(WARPX_MAG_LLG) && !defined(WARPX_DIM_RZ)
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(mag_LLG == 0 || macroscopic,
+            "warpx.mag_LLG = 1 requires algo.em_solver_medium = macroscopic");
+#else
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(mag_LLG == 0,
+            "warpx.mag_LLG = 1 requires compiling with USE_LLG=TRUE, in Cartesian geometry");
+#endif
     }
 
     {
@@ -627,6 +764,11 @@ WarpX::ReadParameters ()
         // Set the flag to control if WarpX has to emit a warning message as soon as a warning is recorded
         pp_warpx.query("always_warn_immediately", m_always_warn_immediately);
 
+        // Set the steps after which the warnings of all the ranks are gathered and printed
+        std::vector<std::string> print_warnings_intervals_string_vec = {"0"};
+        pp_warpx.queryarr("print_warnings_intervals", print_warnings_intervals_string_vec);
+        m_print_warnings_intervals = IntervalsParser(print_warnings_intervals_string_vec);
+
         // Set the WarnPriority threshold to decide if WarpX has to abort when a warning is recorded
         if(std::string str_abort_on_warning_threshold = "";
             pp_warpx.query("abort_on_warning_threshold", str_abort_on_warning_threshold)){
@@ -732,17 +874,62 @@ WarpX::ReadParameters ()
         }
         pp_warpx.query("use_hybrid_QED", use_hybrid_QED);
         pp_warpx.query("safe_guard_cells", safe_guard_cells);
+        pp_warpx.query("minimal_guard_cells", minimal_guard_cells);
+        pp_warpx.query("skip_clean_fill_boundary", skip_clean_fill_boundary);
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(
+            !skip_clean_fill_boundary || maxwell_solver_id != MaxwellSolverAlgo::PSATD,
+            "warpx.skip_clean_fill_boundary is only implemented for the finite-difference solvers");
+        pp_warpx.query("deep_halo_steps", deep_halo_steps);
+        pp_warpx.query("temporal_blocking", temporal_blocking);
+        std::string temporal_blocking_layout = "planar";
+        pp_warpx.query("temporal_blocking_layout", temporal_blocking_layout);
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(
+            temporal_blocking_layout == "planar" || temporal_blocking_layout == "interleaved",
+            "warpx.temporal_blocking_layout must be planar or interleaved");
+        temporal_blocking_interleaved = (temporal_blocking_layout == "interleaved");
+        pp_warpx.query("do_tfsf", do_tfsf);
         std::vector<std::string> override_sync_intervals_string_vec = {"1"};
         pp_warpx.queryarr("override_sync_intervals", override_sync_intervals_string_vec);
         override_sync_intervals = IntervalsParser(override_sync_intervals_string_vec);
 
+#ifndef WARPX_MAG_LLG
+        // checked in the constructor with the LLG solver, whose medium is not read yet
         WARPX_ALWAYS_ASSERT_WITH_MESSAGE(do_subcycling != 1 || max_level <= 1,
                                          "Subcycling method 1 only works for 2 levels.");
+#endif
 
         ReadBoostedFrameParameters(gamma_boost, beta_boost, boost_direction);
 
         pp_warpx.query("do_device_synchronize", do_device_synchronize);
 
+        // wall-clock time of each phase of the step, for the StepPhaseTimes reduced diagnostics
+        pp_warpx.query("step_phase_timers", m_step_phase_timers);
+        m_step_phase_times.resize(CostPhase::NumStepPhases, 0.0_rt);
+        m_step_phase_times_last.resize(CostPhase::NumStepPhases, 0.0_rt);
+
+        // throughput over a rolling window of steps, printed and in the Throughput reduced diagnostics
+        int throughput_window = 20;
+        queryWithParser(pp_warpx, "throughput_window", throughput_window);
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(throughput_window > 0,
+            "warpx.throughput_window must be positive");
+        m_step_cost_model.SetWindow(throughput_window);
+        std::vector<std::string> throughput_report_intervals_string_vec = {"0"};
+        pp_warpx.queryarr("throughput_report_intervals", throughput_report_intervals_string_vec);
+        m_throughput_report_intervals = IntervalsParser(throughput_report_intervals_string_vec);
+
+        // layouts of level 0 timed over the first steps, see WarpX::AutoTune
+        pp_warpx.queryarr("autotune_max_grid_size", m_autotune_max_grid_size);
+        pp_warpx.queryarr("autotune_tile_size", m_autotune_tile_size);
+        queryWithParser(pp_warpx, "autotune_steps", m_autotune_steps);
+        pp_warpx.query("autotune_file", m_autotune_file);
+        m_autotune = !m_autotune_max_grid_size.empty() || !m_autotune_tile_size.empty();
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(!m_autotune || m_autotune_steps > 0,
+            "warpx.autotune_steps must be positive");
+
+        // wall-clock time of each phase of the initialization, printed at the end of InitData
+        pp_warpx.query("startup_report", m_startup_report);
+        pp_warpx.query("memory_report", m_memory_report);
+
         // queryWithParser returns 1 if argument zmax_plasma_to_compute_max_step is
         // specified by the user, 0 otherwise.
         do_compute_max_step_from_zmax =
@@ -783,6 +970,13 @@ WarpX::ReadParameters ()
         pp_warpx.query("do_back_transformed_diagnostics", do_back_transformed_diagnostics);
         if (do_back_transformed_diagnostics) {
 
+            this->RecordWarning(
+                "diagnostics",
+                "warpx.do_back_transformed_diagnostics is deprecated: use a diagnostics of "
+                "<diag_name>.diag_type = BackTransformed instead, which back-transforms the "
+                "fields of all its snapshots in one pass per step.",
+                WarnPriority::medium);
+
             WARPX_ALWAYS_ASSERT_WITH_MESSAGE(gamma_boost > 1.0,
                    "gamma_boost must be > 1 to use the boosted frame diagnostic.");
 
@@ -832,6 +1026,32 @@ WarpX::ReadParameters ()
             queryWithParser(pp_warpx, "self_fields_absolute_tolerance", self_fields_absolute_tolerance);
             queryWithParser(pp_warpx, "self_fields_max_iters", self_fields_max_iters);
             pp_warpx.query("self_fields_verbosity", self_fields_verbosity);
+            pp_warpx.query("self_fields_warm_start", self_fields_warm_start);
+        }
+        pp_warpx.query("init_static_E", m_init_static_E);
+        if (m_init_static_E == 1) {
+            WARPX_ALWAYS_ASSERT_WITH_MESSAGE(do_electrostatic == ElectrostaticSolverAlgo::None,
+                "warpx.init_static_E = 1 is not compatible with warpx.do_electrostatic");
+            // electrodes inside the domain, at fixed potentials
+            if (pp_warpx.contains("static_E_electrode_function(x,y,z)")) {
+                std::string str_electrode_function;
+                std::string str_potential_function = "0";
+                Store_parserString(pp_warpx, "static_E_electrode_function(x,y,z)",
+                                   str_electrode_function);
+                if (pp_warpx.contains("static_E_potential_function(x,y,z)")) {
+                    Store_parserString(pp_warpx, "static_E_potential_function(x,y,z)",
+                                       str_potential_function);
+                }
+                m_static_E_electrode_parser = std::make_unique<amrex::Parser>(
+                    makeParser(str_electrode_function, {"x","y","z"}));
+                m_static_E_potential_parser = std::make_unique<amrex::Parser>(
+                    makeParser(str_potential_function, {"x","y","z"}));
+            }
+            // the Poisson solve uses the same MLMG parameters as the electrostatic solver
+            queryWithParser(pp_warpx, "self_fields_required_precision", self_fields_required_precision);
+            queryWithParser(pp_warpx, "self_fields_absolute_tolerance", self_fields_absolute_tolerance);
+            queryWithParser(pp_warpx, "self_fields_max_iters", self_fields_max_iters);
+            pp_warpx.query("self_fields_verbosity", self_fields_verbosity);
         }
         // Parse the input file for domain boundary potentials
         ParmParse pp_boundary("boundary");
@@ -903,6 +1123,13 @@ WarpX::ReadParameters ()
                 WarnPriority::low);
         }
 #endif
+        pp_warpx.query("use_persistent_comm", use_persistent_comm);
+        pp_warpx.query("use_shared_memory_comm", use_shared_memory_comm);
+        pp_warpx.query("static_data_memory", static_data_memory);
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(
+            static_data_memory == "device" || static_data_memory == "managed"
+            || static_data_memory == "pinned",
+            "warpx.static_data_memory must be device, managed or pinned");
 
         pp_warpx.query("serialize_initial_conditions", serialize_initial_conditions);
         pp_warpx.query("refine_plasma", refine_plasma);
@@ -943,8 +1170,16 @@ WarpX::ReadParameters ()
         queryWithParser(pp_warpx, "pml_delta", pml_delta);
         pp_warpx.query("pml_has_particles", pml_has_particles);
         pp_warpx.query("do_pml_j_damping", do_pml_j_damping);
+        pp_warpx.query("do_pml_fused_damping", do_pml_fused_damping);
         pp_warpx.query("do_pml_in_domain", do_pml_in_domain);
         pp_warpx.query("do_similar_dm_pml", do_similar_dm_pml);
+        pp_warpx.query("do_cpml", do_cpml);
+        pp_warpx.query("do_pml_slabs", do_pml_slabs);
+        queryWithParser(pp_warpx, "pml_slab_max_size", pml_slab_max_size);
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(pml_slab_max_size > 0,
+            "warpx.pml_slab_max_size must be positive");
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(!do_cpml || mag_LLG,
+            "warpx.do_cpml = 1 is only implemented with LLG (USE_LLG=TRUE, warpx.mag_LLG = 1)");
         // Read `v_particle_pml` in units of the speed of light
         v_particle_pml = 1._rt;
         queryWithParser(pp_warpx, "v_particle_pml", v_particle_pml);
@@ -1002,21 +1237,147 @@ WarpX::ReadParameters ()
             );
         }
 
+        // The fused damping relies on E being last updated by the PML E kernel
+        if (do_pml_fused_damping)
+        {
+            WARPX_ALWAYS_ASSERT_WITH_MESSAGE(
+                maxwell_solver_id != MaxwellSolverAlgo::PSATD && !do_subcycling,
+                "warpx.do_pml_fused_damping = 1 is only implemented for the FDTD solvers"
+                " without subcycling");
+            WARPX_ALWAYS_ASSERT_WITH_MESSAGE(
+                !do_pml_dive_cleaning && !pml_has_particles,
+                "warpx.do_pml_fused_damping = 1 is not implemented with divergence cleaning"
+                " or particles in the PML");
+        }
+
 #ifdef WARPX_MAG_LLG
-        // Read the value of the time advancement scheme of M field
-        pp_warpx.query("mag_time_scheme_order", mag_time_scheme_order);
-        // turn on LLG + Maxwell coupling
-        pp_warpx.query("mag_LLG_coupling",mag_LLG_coupling);
-        // magnetization M magnitude normalization strategy
-        pp_warpx.get("mag_M_normalization", mag_M_normalization);
-        if (mag_M_normalization < 0){
-            printf("mag_M_normalization = %d \n", mag_M_normalization);
-            amrex::Abort("Caution: mag_M_normalization must be a non-negative number !");
-        }
-        // turn on the exchange coupling term H_exchange for H_eff in the LLG equation
-        pp_warpx.query("mag_LLG_exchange_coupling",mag_LLG_exchange_coupling);
-        // turn on the anisotropy coupling term H_anisotropy for H_eff in the LLG equation
-        pp_warpx.query("mag_LLG_anisotropy_coupling",mag_LLG_anisotropy_coupling);
+        if (mag_LLG) {
+            // Read the value of the time advancement scheme of M field
+            pp_warpx.query("mag_time_scheme_order", mag_time_scheme_order);
+            WARPX_ALWAYS_ASSERT_WITH_MESSAGE(mag_time_scheme_order == 1 || mag_time_scheme_order == 2 || mag_time_scheme_order == 5,
+                "warpx.mag_time_scheme_order must be 1, 2 or 5");
+            if (mag_time_scheme_order == 5) {
+                // adaptive sub-stepping of the Dormand-Prince Runge-Kutta scheme
+                queryWithParser(pp_warpx, "mag_LLG_rk_tolerance", mag_LLG_rk_tolerance);
+                pp_warpx.query("mag_LLG_rk_max_substeps", mag_LLG_rk_max_substeps);
+                WARPX_ALWAYS_ASSERT_WITH_MESSAGE(mag_LLG_rk_tolerance >= 0._rt && mag_LLG_rk_max_substeps > 0,
+                    "warpx.mag_LLG_rk_tolerance must be non-negative and warpx.mag_LLG_rk_max_substeps positive");
+            }
+            // implicit midpoint update of M, solved by Newton-Krylov, instead of forward Euler
+            pp_warpx.query("mag_LLG_implicit", mag_LLG_implicit);
+            if (mag_LLG_implicit == 1) {
+                WARPX_ALWAYS_ASSERT_WITH_MESSAGE(mag_time_scheme_order == 1,
+                    "warpx.mag_LLG_implicit = 1 is only implemented with warpx.mag_time_scheme_order = 1");
+                queryWithParser(pp_warpx, "mag_LLG_implicit_tolerance", mag_LLG_implicit_tolerance);
+                pp_warpx.query("mag_LLG_implicit_max_iter", mag_LLG_implicit_max_iter);
+                pp_warpx.query("mag_LLG_implicit_krylov_dim", mag_LLG_implicit_krylov_dim);
+                WARPX_ALWAYS_ASSERT_WITH_MESSAGE(mag_LLG_implicit_tolerance > 0._rt && mag_LLG_implicit_max_iter > 0
+                    && mag_LLG_implicit_krylov_dim > 0,
+                    "warpx.mag_LLG_implicit_tolerance, warpx.mag_LLG_implicit_max_iter and "
+                    "warpx.mag_LLG_implicit_krylov_dim must be positive");
+            }
+            // turn on LLG + Maxwell coupling
+            pp_warpx.query("mag_LLG_coupling",mag_LLG_coupling);
+            // magnetization M magnitude normalization strategy
+            pp_warpx.get("mag_M_normalization", mag_M_normalization);
+            if (mag_M_normalization < 0){
+                printf("mag_M_normalization = %d \n", mag_M_normalization);
+                amrex::Abort("Caution: mag_M_normalization must be a non-negative number !");
+            }
+            // turn on the exchange coupling term H_exchange for H_eff in the LLG equation
+            pp_warpx.query("mag_LLG_exchange_coupling",mag_LLG_exchange_coupling);
+            // turn on the anisotropy coupling term H_anisotropy for H_eff in the LLG equation
+            pp_warpx.query("mag_LLG_anisotropy_coupling",mag_LLG_anisotropy_coupling);
+            // turn on the Dzyaloshinskii-Moriya coupling term H_DMI for H_eff in the LLG equation
+            pp_warpx.query("mag_LLG_DMI_coupling",mag_LLG_DMI_coupling);
+            if (mag_LLG_DMI_coupling == 1) {
+                WARPX_ALWAYS_ASSERT_WITH_MESSAGE(mag_time_scheme_order == 2,
+                    "warpx.mag_LLG_DMI_coupling = 1 is only implemented with warpx.mag_time_scheme_order = 2");
+                WARPX_ALWAYS_ASSERT_WITH_MESSAGE(mag_LLG_exchange_coupling == 1,
+                    "warpx.mag_LLG_DMI_coupling = 1 requires warpx.mag_LLG_exchange_coupling = 1");
+                WARPX_ALWAYS_ASSERT_WITH_MESSAGE(AMREX_SPACEDIM == 3,
+                    "warpx.mag_LLG_DMI_coupling = 1 is only implemented in 3D");
+            }
+            // turn on the spin-transfer and spin-orbit torques, see MagSpinTorque
+            pp_warpx.query("mag_LLG_spin_torque_coupling",mag_LLG_spin_torque_coupling);
+            WARPX_ALWAYS_ASSERT_WITH_MESSAGE(mag_LLG_spin_torque_coupling == 0 || mag_LLG_spin_torque_coupling == 1,
+                "warpx.mag_LLG_spin_torque_coupling must be 0 or 1");
+            // store M at the cell centers, and interpolate it to the faces only where it couples to H and B
+            pp_warpx.query("mag_M_collocated", mag_M_collocated);
+            if (mag_M_collocated == 1) {
+                WARPX_ALWAYS_ASSERT_WITH_MESSAGE(mag_time_scheme_order == 1,
+                    "warpx.mag_M_collocated = 1 is only implemented with warpx.mag_time_scheme_order = 1");
+                WARPX_ALWAYS_ASSERT_WITH_MESSAGE(mag_LLG_implicit == 0,
+                    "warpx.mag_M_collocated = 1 is not compatible with warpx.mag_LLG_implicit = 1");
+                WARPX_ALWAYS_ASSERT_WITH_MESSAGE(max_level == 0,
+                    "warpx.mag_M_collocated = 1 is only implemented without mesh refinement");
+            }
+            // uniform H_bias, given by a vector and an envelope in time instead of MultiFabs
+            pp_warpx.query("mag_H_bias_uniform", mag_H_bias_uniform);
+            if (mag_H_bias_uniform == 1) {
+                std::string init_style = "default";
+                std::string excitation_style = "default";
+                pp_warpx.query("H_bias_ext_grid_init_style", init_style);
+                pp_warpx.query("H_bias_excitation_on_grid_style", excitation_style);
+                std::transform(init_style.begin(), init_style.end(), init_style.begin(), ::tolower);
+                std::transform(excitation_style.begin(), excitation_style.end(), excitation_style.begin(), ::tolower);
+                WARPX_ALWAYS_ASSERT_WITH_MESSAGE(init_style == "default" || init_style == "constant",
+                    "warpx.mag_H_bias_uniform = 1 requires warpx.H_bias_ext_grid_init_style = constant");
+                WARPX_ALWAYS_ASSERT_WITH_MESSAGE(excitation_style == "default",
+                    "warpx.mag_H_bias_uniform = 1 is not compatible with warpx.H_bias_excitation_on_grid_style;"
+                    " use warpx.H_bias_uniform_envelope_function(t) for a time-dependent bias");
+                std::string str_envelope_function = "1";
+                if (pp_warpx.contains("H_bias_uniform_envelope_function(t)")) {
+                    Store_parserString(pp_warpx, "H_bias_uniform_envelope_function(t)", str_envelope_function);
+                }
+                H_bias_uniform_envelope_parser = std::make_unique<amrex::Parser>(
+                    makeParser(str_envelope_function, {"t"}));
+            }
+            // compute H from the magnetostatic Poisson equation instead of the Maxwell equations
+            pp_warpx.query("mag_magnetostatic", mag_magnetostatic);
+            pp_warpx.query("init_static_H", m_init_static_H);
+            if (m_init_static_H == 1) {
+                WARPX_ALWAYS_ASSERT_WITH_MESSAGE(max_level == 0,
+                    "warpx.init_static_H = 1 is only implemented without mesh refinement");
+                WARPX_ALWAYS_ASSERT_WITH_MESSAGE(mag_M_collocated == 0,
+                    "warpx.init_static_H = 1 is not compatible with warpx.mag_M_collocated = 1");
+                queryWithParser(pp_warpx, "self_fields_required_precision", self_fields_required_precision);
+                queryWithParser(pp_warpx, "self_fields_absolute_tolerance", self_fields_absolute_tolerance);
+                queryWithParser(pp_warpx, "self_fields_max_iters", self_fields_max_iters);
+                pp_warpx.query("self_fields_verbosity", self_fields_verbosity);
+            }
+            if (mag_magnetostatic == 1) {
+                WARPX_ALWAYS_ASSERT_WITH_MESSAGE(do_electrostatic == ElectrostaticSolverAlgo::None,
+                    "warpx.mag_magnetostatic = 1 is not compatible with warpx.do_electrostatic");
+                WARPX_ALWAYS_ASSERT_WITH_MESSAGE(max_level == 0,
+                    "warpx.mag_magnetostatic = 1 is only implemented without mesh refinement");
+                WARPX_ALWAYS_ASSERT_WITH_MESSAGE(mag_M_collocated == 0,
+                    "warpx.mag_magnetostatic = 1 is not compatible with warpx.mag_M_collocated = 1");
+                // the Poisson solve uses the same MLMG parameters as the electrostatic solver
+                queryWithParser(pp_warpx, "self_fields_required_precision", self_fields_required_precision);
+                queryWithParser(pp_warpx, "self_fields_absolute_tolerance", self_fields_absolute_tolerance);
+                queryWithParser(pp_warpx, "self_fields_max_iters", self_fields_max_iters);
+                pp_warpx.query("self_fields_verbosity", self_fields_verbosity);
+                // use the FFT demagnetizing tensor instead of MLMG (periodic domain covered by a single box)
+                pp_warpx.query("mag_magnetostatic_fft", mag_magnetostatic_fft);
+#ifndef WARPX_USE_PSATD
+                WARPX_ALWAYS_ASSERT_WITH_MESSAGE(mag_magnetostatic_fft == 0,
+                    "warpx.mag_magnetostatic_fft = 1 requires compiling with USE_PSATD=TRUE");
+#endif
+            }
+            // relax M to a minimum of the magnetic energy before the first step, see RelaxMagnetization
+            pp_warpx.query("mag_relax", m_mag_relax);
+            if (m_mag_relax == 1) {
+                WARPX_ALWAYS_ASSERT_WITH_MESSAGE(max_level == 0,
+                    "warpx.mag_relax = 1 is only implemented without mesh refinement");
+                WARPX_ALWAYS_ASSERT_WITH_MESSAGE(mag_M_collocated == 0,
+                    "warpx.mag_relax = 1 is not compatible with warpx.mag_M_collocated = 1");
+                WARPX_ALWAYS_ASSERT_WITH_MESSAGE(mag_M_normalization != 0,
+                    "warpx.mag_relax = 1 requires a saturated material (warpx.mag_M_normalization = 1 or 2)");
+                queryWithParser(pp_warpx, "mag_relax_tolerance", m_mag_relax_tolerance);
+                pp_warpx.query("mag_relax_max_iter", m_mag_relax_max_iter);
+            }
+        }
 #endif
 
 #ifdef WARPX_DIM_RZ
@@ -1055,15 +1416,43 @@ WarpX::ReadParameters ()
         }
 
         if (maxLevel() > 0) {
+            // the cells are tagged from the gradients of M and H, and/or in a fixed box, which
+            // is then optional
+            queryWithParser(pp_warpx, "tag_mag_grad_angle", tag_mag_grad_angle);
+            queryWithParser(pp_warpx, "tag_curl_H", tag_curl_H);
+            const bool tag_fields = (tag_mag_grad_angle > 0._rt || tag_curl_H > 0._rt);
             Vector<Real> lo, hi;
-            getArrWithParser(pp_warpx, "fine_tag_lo", lo);
-            getArrWithParser(pp_warpx, "fine_tag_hi", hi);
-            fine_tag_lo = RealVect{lo};
-            fine_tag_hi = RealVect{hi};
+            if (!tag_fields || pp_warpx.contains("fine_tag_lo")) {
+                getArrWithParser(pp_warpx, "fine_tag_lo", lo);
+                getArrWithParser(pp_warpx, "fine_tag_hi", hi);
+                fine_tag_lo = RealVect{lo};
+                fine_tag_hi = RealVect{hi};
+            }
+#ifdef WARPX_MAG_LLG
+            WARPX_ALWAYS_ASSERT_WITH_MESSAGE(!tag_fields || mag_LLG,
+                "warpx.tag_mag_grad_angle and warpx.tag_curl_H require warpx.mag_LLG = 1");
+#else
+            WARPX_ALWAYS_ASSERT_WITH_MESSAGE(!tag_fields,
+                "warpx.tag_mag_grad_angle and warpx.tag_curl_H require the LLG solver (USE_LLG=TRUE)");
+#endif
         }
 
         pp_warpx.query("do_dynamic_scheduling", do_dynamic_scheduling);
 
+        // the MFIter loops of the PML update run in nested parallel regions, concurrently with
+        // those of the regular cells
+        pp_warpx.query("omp_overlap_tasks", omp_overlap_tasks);
+        if (omp_overlap_tasks) amrex::MFIter::allow_multiple(true);
+
+        // the fixed sequences of kernels of the field updates are replayed from graphs
+        pp_warpx.query("gpu_graphs", gpu_graphs);
+        if (gpu_graphs) {
+            WARPX_ALWAYS_ASSERT_WITH_MESSAGE(KernelGraph::Supported(),
+                "warpx.gpu_graphs = 1 requires a CUDA or HIP build");
+            WARPX_ALWAYS_ASSERT_WITH_MESSAGE(amrex::Gpu::numGpuStreams() == 1,
+                "warpx.gpu_graphs = 1 requires amrex.max_gpu_streams = 1");
+        }
+
         pp_warpx.query("do_nodal", do_nodal);
         // Use same shape factors in all directions, for gathering
         if (do_nodal) galerkin_interpolation = false;
@@ -1088,6 +1477,20 @@ WarpX::ReadParameters ()
             maxLevel() == 0 || !do_current_centering,
             "Finite-order centering of currents is not implemented with mesh refinement"
         );
+
+        m_graded_mesh.ReadParameters(Geom(0));
+        if (m_graded_mesh.IsGraded()) {
+#ifdef WARPX_DIM_RZ
+            amrex::Abort(Utils::TextMsg::Err("warpx.graded_mesh_* is not implemented in RZ geometry"));
+#endif
+            WARPX_ALWAYS_ASSERT_WITH_MESSAGE(
+                maxwell_solver_id == MaxwellSolverAlgo::Yee && !do_nodal,
+                "warpx.graded_mesh_* is only implemented with algo.maxwell_solver = yee on a staggered grid");
+            WARPX_ALWAYS_ASSERT_WITH_MESSAGE(maxLevel() == 0,
+                "warpx.graded_mesh_* is not implemented with mesh refinement");
+            WARPX_ALWAYS_ASSERT_WITH_MESSAGE(!do_moving_window,
+                "warpx.graded_mesh_* is not implemented with a moving window");
+        }
     }
 
     {
@@ -1153,6 +1556,17 @@ WarpX::ReadParameters ()
         if (em_solver_medium == MediumForEM::Macroscopic ) {
             macroscopic_solver_algo = GetAlgorithmInteger(pp_algo,"macroscopic_sigma_method");
         }
+        // the spectral solver of macroscopic media is the Cartesian PSATD of B, see PSATDLightSpeed
+#ifdef WARPX_DIM_RZ
+        bool const macroscopic_psatd_implemented = false;
+#else
+        bool const macroscopic_psatd_implemented = !mag_LLG;
+#endif
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(macroscopic_psatd_implemented
+                                         || em_solver_medium != MediumForEM::Macroscopic
+                                         || maxwell_solver_id != MaxwellSolverAlgo::PSATD,
+            "algo.em_solver_medium = macroscopic with algo.maxwell_solver = psatd is not implemented "
+            "in RZ geometry nor with LLG");
         // Read field excitation flags and parsers
         ReadExcitationParser();
 
@@ -1161,12 +1575,24 @@ WarpX::ReadParameters ()
         pp_algo.queryarr("load_balance_intervals", load_balance_intervals_string_vec);
         load_balance_intervals = IntervalsParser(load_balance_intervals_string_vec);
         pp_algo.query("load_balance_with_sfc", load_balance_with_sfc);
+        pp_algo.query("load_balance_multi_constraint", load_balance_multi_constraint);
+        pp_algo.queryarr("load_balance_mag_ranks", load_balance_mag_ranks);
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(load_balance_mag_ranks.empty() ||
+            (load_balance_mag_ranks.size() == 2 && load_balance_mag_ranks[0] >= 0
+             && load_balance_mag_ranks[0] <= load_balance_mag_ranks[1]
+             && load_balance_mag_ranks[1] < amrex::ParallelDescriptor::NProcs()),
+            "algo.load_balance_mag_ranks must be two ranks, first <= last < the number of MPI ranks");
+        queryWithParser(pp_algo, "load_balance_split_factor", load_balance_split_factor);
+        pp_algo.query("load_balance_predictive", load_balance_predictive);
         pp_algo.query("load_balance_knapsack_factor", load_balance_knapsack_factor);
         queryWithParser(pp_algo, "load_balance_efficiency_ratio_threshold",
                         load_balance_efficiency_ratio_threshold);
         load_balance_costs_update_algo = GetAlgorithmInteger(pp_algo, "load_balance_costs_update");
         queryWithParser(pp_algo, "costs_heuristic_cells_wt", costs_heuristic_cells_wt);
         queryWithParser(pp_algo, "costs_heuristic_particles_wt", costs_heuristic_particles_wt);
+        queryWithParser(pp_algo, "costs_heuristic_mag_wt", costs_heuristic_mag_wt);
+        queryWithParser(pp_algo, "costs_heuristic_sigma_wt", costs_heuristic_sigma_wt);
+        queryWithParser(pp_algo, "costs_heuristic_eps_wt", costs_heuristic_eps_wt);
 
         // Parse algo.particle_shape and check that input is acceptable
         // (do this only if there is at least one particle or laser species)
@@ -1174,6 +1600,10 @@ WarpX::ReadParameters ()
         std::vector<std::string> species_names;
         pp_particles.queryarr("species_names", species_names);
 
+        queryWithParser(pp_particles, "slab_size", particle_slab_size);
+        pp_particles.query("flux_injection_in_place", flux_injection_in_place);
+        queryWithParser(pp_particles, "hole_compaction_threshold", hole_compaction_threshold);
+
         ParmParse pp_lasers("lasers");
         std::vector<std::string> lasers_names;
         pp_lasers.queryarr("names", lasers_names);
@@ -1225,6 +1655,33 @@ WarpX::ReadParameters ()
             for (int i=0; i<AMREX_SPACEDIM; i++)
                 sort_bin_size[i] = vect_sort_bin_size[i];
         }
+
+        pp_warpx.query("redistribute_neighbors_only", redistribute_neighbors_only);
+
+        pp_warpx.query("do_fused_push_deposit", do_fused_push_deposit);
+        pp_warpx.query("sort_incremental", sort_incremental);
+        if (sort_incremental && !do_fused_push_deposit) {
+            this->RecordWarning("Particles",
+                "warpx.sort_incremental requires warpx.do_fused_push_deposit = 1 and is ignored");
+        }
+
+        pp_warpx.query("do_shared_mem_current_deposition", do_shared_mem_current_deposition);
+        Vector<int> vect_shared_tilesize(AMREX_SPACEDIM,1);
+        bool shared_tilesize_is_specified = queryArrWithParser(pp_warpx, "shared_tilesize",
+                                                              vect_shared_tilesize, 0, AMREX_SPACEDIM);
+        if (shared_tilesize_is_specified){
+            for (int i=0; i<AMREX_SPACEDIM; i++)
+                shared_tilesize[i] = vect_shared_tilesize[i];
+        }
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(shared_tilesize.allGT(0),
+            "warpx.shared_tilesize must be positive");
+#if !defined(AMREX_USE_CUDA) && !defined(AMREX_USE_HIP)
+        if (do_shared_mem_current_deposition) {
+            this->RecordWarning("Particles",
+                "warpx.do_shared_mem_current_deposition is only implemented with CUDA and HIP,"
+                " the current is deposited with global atomics");
+        }
+#endif
     }
 
     {
@@ -1288,6 +1745,20 @@ WarpX::ReadParameters ()
     {
         ParmParse pp_psatd("psatd");
         pp_psatd.query("periodic_single_box_fft", fft_periodic_single_box);
+        pp_psatd.query("global_fft", fft_global_distributed);
+        if (fft_global_distributed) {
+#if !defined(WARPX_USE_HEFFTE)
+            WARPX_ALWAYS_ASSERT_WITH_MESSAGE(false,
+                "psatd.global_fft = 1 requires a WarpX build with heFFTe (WarpX_HEFFTE=ON or USE_HEFFTE=TRUE)");
+#elif defined(WARPX_DIM_RZ) || defined(WARPX_DIM_1D_Z)
+            WARPX_ALWAYS_ASSERT_WITH_MESSAGE(false,
+                "psatd.global_fft = 1 is not implemented in RZ and 1D geometry");
+#endif
+            WARPX_ALWAYS_ASSERT_WITH_MESSAGE(!fft_periodic_single_box,
+                "psatd.global_fft and psatd.periodic_single_box_fft cannot be used together");
+            WARPX_ALWAYS_ASSERT_WITH_MESSAGE(max_level == 0,
+                "psatd.global_fft = 1 is not implemented with mesh refinement (amr.max_level > 0)");
+        }
 
         std::string nox_str;
         std::string noy_str;
@@ -1314,10 +1785,10 @@ WarpX::ReadParameters ()
         }
 
 
-        if (!fft_periodic_single_box) {
-            WARPX_ALWAYS_ASSERT_WITH_MESSAGE(nox_fft > 0, "PSATD order must be finite unless psatd.periodic_single_box_fft is used");
-            WARPX_ALWAYS_ASSERT_WITH_MESSAGE(noy_fft > 0, "PSATD order must be finite unless psatd.periodic_single_box_fft is used");
-            WARPX_ALWAYS_ASSERT_WITH_MESSAGE(noz_fft > 0, "PSATD order must be finite unless psatd.periodic_single_box_fft is used");
+        if (!fft_periodic_single_box && !fft_global_distributed) {
+            WARPX_ALWAYS_ASSERT_WITH_MESSAGE(nox_fft > 0, "PSATD order must be finite unless psatd.periodic_single_box_fft or psatd.global_fft is used");
+            WARPX_ALWAYS_ASSERT_WITH_MESSAGE(noy_fft > 0, "PSATD order must be finite unless psatd.periodic_single_box_fft or psatd.global_fft is used");
+            WARPX_ALWAYS_ASSERT_WITH_MESSAGE(noz_fft > 0, "PSATD order must be finite unless psatd.periodic_single_box_fft or psatd.global_fft is used");
         }
 
         pp_psatd.query("current_correction", current_correction);
@@ -1326,15 +1797,15 @@ WarpX::ReadParameters ()
         if (WarpX::current_correction == true)
         {
             WARPX_ALWAYS_ASSERT_WITH_MESSAGE(
-                fft_periodic_single_box == true,
-                "Option psatd.current_correction=1 must be used with psatd.periodic_single_box_fft=1.");
+                fft_periodic_single_box == true || fft_global_distributed == true,
+                "Option psatd.current_correction=1 must be used with psatd.periodic_single_box_fft=1 or psatd.global_fft=1.");
         }
 
         if (WarpX::current_deposition_algo == CurrentDepositionAlgo::Vay)
         {
             WARPX_ALWAYS_ASSERT_WITH_MESSAGE(
-                fft_periodic_single_box == false,
-                "Option algo.current_deposition=vay must be used with psatd.periodic_single_box_fft=0.");
+                fft_periodic_single_box == false && fft_global_distributed == false,
+                "Option algo.current_deposition=vay must be used with psatd.periodic_single_box_fft=0 and psatd.global_fft=0.");
         }
 
         // Auxiliary: boosted_frame = true if warpx.gamma_boost is set in the inputs
@@ -1687,15 +2158,26 @@ WarpX::MakeNewLevelFromScratch (int lev, Real time, const BoxArray& new_grids,
 
 // This is a virtual function.
 void
-WarpX::MakeNewLevelFromCoarse (int /*lev*/, amrex::Real /*time*/, const amrex::BoxArray& /*ba*/,
-                                         const amrex::DistributionMapping& /*dm*/)
+WarpX::MakeNewLevelFromCoarse (int lev, amrex::Real time, const amrex::BoxArray& ba,
+                                         const amrex::DistributionMapping& dm)
 {
-    amrex::Abort(Utils::TextMsg::Err("MakeNewLevelFromCoarse: To be implemented"));
+    // only the levels advanced in lockstep can be created by the regrid, see RegridLevels
+    if (!MRLockstep()) {
+        amrex::Abort(Utils::TextMsg::Err("MakeNewLevelFromCoarse: To be implemented"));
+    }
+    RegridLockstepLevel(lev, time, ba, dm);
+
+    InvalidateDeepHalo();
+    WarpXCommUtil::ClearHaloExchangePlans();
+    ClearKernelGraphs();
+    multi_diags->InitializeFieldFunctors(lev);
 }
 
 void
 WarpX::ClearLevel (int lev)
 {
+    ClearPoissonSolvers();
+
     for (int i = 0; i < 3; ++i) {
         Efield_aux[lev][i].reset();
         Bfield_aux[lev][i].reset();
@@ -1747,6 +2229,8 @@ WarpX::ClearLevel (int lev)
     current_buffer_masks[lev].reset();
     gather_buffer_masks[lev].reset();
 
+    m_scratch_mfs.Clear(lev);
+
     F_fp  [lev].reset();
     G_fp  [lev].reset();
     rho_fp[lev].reset();
@@ -1779,30 +2263,44 @@ WarpX::AllocLevelData (int lev, const BoxArray& ba, const DistributionMapping& d
     amrex::RealVect dx = {WarpX::CellSize(lev)[0], WarpX::CellSize(lev)[1], WarpX::CellSize(lev)[2]};
 #endif
 
-    guard_cells.Init(
-        dt[lev],
-        dx,
-        do_subcycling,
-        WarpX::use_fdtd_nci_corr,
-        do_nodal,
-        do_moving_window,
-        moving_window_dir,
-        WarpX::nox,
-        nox_fft, noy_fft, noz_fft,
-        NCIGodfreyFilter::m_stencil_width,
-        maxwell_solver_id,
-        maxLevel(),
-        WarpX::m_v_galilean,
-        WarpX::m_v_comoving,
-        safe_guard_cells,
-        WarpX::do_electrostatic,
-        WarpX::do_multi_J,
-        WarpX::fft_do_time_averaging,
-        WarpX::isAnyBoundaryPML(),
-        WarpX::do_pml_in_domain,
-        WarpX::pml_ncell,
-        this->refRatio());
+    const bool has_particles = mypc->nSpecies() > 0 || !mypc->GetLasersNames().empty();
+    auto init_guard_cells = [&] (guardCellManager& gcm, const bool minimal) {
+        gcm.Init(
+            dt[lev],
+            dx,
+            do_subcycling,
+            WarpX::use_fdtd_nci_corr,
+            do_nodal,
+            do_moving_window,
+            moving_window_dir,
+            WarpX::nox,
+            nox_fft, noy_fft, noz_fft,
+            NCIGodfreyFilter::m_stencil_width,
+            maxwell_solver_id,
+            maxLevel(),
+            WarpX::m_v_galilean,
+            WarpX::m_v_comoving,
+            safe_guard_cells,
+            WarpX::do_electrostatic,
+            WarpX::do_multi_J,
+            WarpX::fft_do_time_averaging,
+            WarpX::isAnyBoundaryPML(),
+            WarpX::do_pml_in_domain,
+            WarpX::pml_ncell,
+            this->refRatio(),
+            WarpX::deep_halo_steps,
+            minimal,
+            has_particles);
+    };
+    init_guard_cells(guard_cells, WarpX::minimal_guard_cells);
 
+    if (lev == 0 && m_graded_mesh.IsGraded()) {
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(!has_particles,
+            "warpx.graded_mesh_* is not implemented with particles or lasers");
+        // the stencils are applied up to the guard cells of the PML, and the one-sided
+        // stencils of the exchange field read two points beyond
+        m_graded_mesh.Define(Geom(0), guard_cells.ng_alloc_EB.max() + pml_ncell + 2);
+    }
 
 #ifdef AMREX_USE_EB
         int max_guard = guard_cells.ng_FieldSolver.max();
@@ -1832,6 +2330,199 @@ WarpX::AllocLevelData (int lev, const BoxArray& ba, const DistributionMapping& d
 
     AllocLevelMFs(lev, ba, dm, guard_cells.ng_alloc_EB, guard_cells.ng_alloc_J,
                   guard_cells.ng_alloc_Rho, guard_cells.ng_alloc_F, guard_cells.ng_alloc_G, aux_is_nodal);
+
+    if (WarpX::minimal_guard_cells && verbose) {
+        guardCellManager default_guard_cells;
+        init_guard_cells(default_guard_cells, false);
+        PrintGuardCellSavings(lev, default_guard_cells);
+    }
+}
+
+void
+WarpX::PrintGuardCellSavings (int lev, guardCellManager const& default_guard_cells) const
+{
+    // Memory of the guard cells of mf beyond ng_min, up to ng_max
+    auto saved_bytes = [] (MultiFab const* mf, IntVect const& ng_max, IntVect const& ng_min) {
+        if (mf == nullptr || mf->nGrowVect() != ng_min) return 0.;
+        const BoxArray& mf_ba = mf->boxArray();
+        double npts = 0.;
+        for (int i = 0; i < static_cast<int>(mf_ba.size()); ++i) {
+            const Box& bx = mf_ba[i];
+            npts += static_cast<double>(amrex::grow(bx, ng_max).numPts())
+                  - static_cast<double>(amrex::grow(bx, ng_min).numPts());
+        }
+        return npts * mf->nComp() * sizeof(Real);
+    };
+
+    // Same, summed over the components of a vector field
+    auto saved_bytes_vec = [&] (std::array<std::unique_ptr<MultiFab>, 3> const& mf,
+                                IntVect const& ng_max, IntVect const& ng_min) {
+        return saved_bytes(mf[0].get(), ng_max, ng_min) + saved_bytes(mf[1].get(), ng_max, ng_min)
+             + saved_bytes(mf[2].get(), ng_max, ng_min);
+    };
+
+    const IntVect& ngEB = guard_cells.ng_alloc_EB;
+    const IntVect& ngEB_default = default_guard_cells.ng_alloc_EB;
+    double bytes = 0.;
+    bytes += saved_bytes_vec(Efield_fp[lev], ngEB_default, ngEB);
+    bytes += saved_bytes_vec(Bfield_fp[lev], ngEB_default, ngEB);
+    bytes += saved_bytes_vec(Efield_avg_fp[lev], ngEB_default, ngEB);
+    bytes += saved_bytes_vec(Bfield_avg_fp[lev], ngEB_default, ngEB);
+#ifdef WARPX_MAG_LLG
+    bytes += saved_bytes_vec(Mfield_fp[lev], ngEB_default, ngEB);
+    bytes += saved_bytes_vec(Hfield_fp[lev], ngEB_default, ngEB);
+    bytes += saved_bytes_vec(H_biasfield_fp[lev], ngEB_default, ngEB);
+#endif
+    bytes += saved_bytes_vec(current_fp[lev], default_guard_cells.ng_alloc_J, guard_cells.ng_alloc_J);
+    bytes += saved_bytes(rho_fp[lev].get(), default_guard_cells.ng_alloc_Rho, guard_cells.ng_alloc_Rho);
+
+    amrex::Print() << "Minimal guard cells on level " << lev << ": ng_alloc_EB = " << ngEB
+                   << " (instead of " << ngEB_default << "), ng_alloc_J = " << guard_cells.ng_alloc_J
+                   << " (instead of " << default_guard_cells.ng_alloc_J << "), saving "
+                   << bytes/(1024.*1024.) << " MB in the fine-patch fields\n";
+}
+
+amrex::Vector<double>
+WarpX::MemoryFootprint (int lev) const
+{
+    amrex::Vector<double> bytes(MemoryFamily::NumFamilies, 0.);
+
+    bytes[MemoryFamily::E_fp] = LocalMemoryBytes(Efield_fp[lev]);
+    bytes[MemoryFamily::E_cp] = LocalMemoryBytes(Efield_cp[lev]);
+    bytes[MemoryFamily::E_aux] = LocalMemoryBytes(Efield_aux[lev]);
+    bytes[MemoryFamily::B_fp] = LocalMemoryBytes(Bfield_fp[lev]);
+    bytes[MemoryFamily::B_cp] = LocalMemoryBytes(Bfield_cp[lev]);
+    bytes[MemoryFamily::B_aux] = LocalMemoryBytes(Bfield_aux[lev]);
+#ifdef WARPX_MAG_LLG
+    bytes[MemoryFamily::H_fp] = LocalMemoryBytes(Hfield_fp[lev]);
+    bytes[MemoryFamily::H_cp] = LocalMemoryBytes(Hfield_cp[lev]);
+    bytes[MemoryFamily::H_aux] = LocalMemoryBytes(Hfield_aux[lev]);
+    bytes[MemoryFamily::M_fp] = LocalMemoryBytes(Mfield_fp[lev]);
+    bytes[MemoryFamily::M_cp] = LocalMemoryBytes(Mfield_cp[lev]);
+    bytes[MemoryFamily::M_aux] = LocalMemoryBytes(Mfield_aux[lev]);
+    bytes[MemoryFamily::H_bias] = LocalMemoryBytes(H_biasfield_fp[lev]) + LocalMemoryBytes(H_biasfield_cp[lev])
+                                + LocalMemoryBytes(H_biasfield_aux[lev]);
+#endif
+
+    bytes[MemoryFamily::Sources] =
+        LocalMemoryBytes(current_fp[lev]) + LocalMemoryBytes(current_cp[lev])
+        + LocalMemoryBytes(current_fp_vay[lev]) + LocalMemoryBytes(current_fp_nodal[lev])
+        + LocalMemoryBytes(current_store[lev]) + LocalMemoryBytes(current_buf[lev])
+        + LocalMemoryBytes(rho_fp[lev].get()) + LocalMemoryBytes(rho_cp[lev].get())
+        + LocalMemoryBytes(charge_buf[lev].get()) + LocalMemoryBytes(phi_fp[lev].get())
+        + LocalMemoryBytes(F_fp[lev].get()) + LocalMemoryBytes(F_cp[lev].get())
+        + LocalMemoryBytes(G_fp[lev].get()) + LocalMemoryBytes(G_cp[lev].get());
+
+    if (lev < static_cast<int>(m_macroscopic_properties.size()) && m_macroscopic_properties[lev]) {
+        bytes[MemoryFamily::Properties] = m_macroscopic_properties[lev]->PropertiesBytes();
+#ifdef WARPX_MAG_LLG
+        bytes[MemoryFamily::MagProperties] = m_macroscopic_properties[lev]->MagPropertiesBytes();
+#endif
+    }
+#if !(defined WARPX_DIM_RZ) && (defined WARPX_MAG_LLG)
+    if (m_fdtd_solver_fp[lev]) bytes[MemoryFamily::LLGScratch] = m_fdtd_solver_fp[lev]->LLGScratchBytes();
+#endif
+    bytes[MemoryFamily::Scratch] = m_scratch_mfs.Bytes(lev);
+    if (pml[lev]) bytes[MemoryFamily::PML] = pml[lev]->MemoryBytes();
+
+    bytes[MemoryFamily::EB] =
+        LocalMemoryBytes(m_edge_lengths[lev]) + LocalMemoryBytes(m_face_areas[lev])
+        + LocalMemoryBytes(m_flag_info_face[lev]) + LocalMemoryBytes(m_flag_ext_face[lev])
+        + LocalMemoryBytes(m_area_mod[lev]) + LocalMemoryBytes(ECTRhofield[lev])
+        + LocalMemoryBytes(Venl[lev]) + LocalMemoryBytes(m_distance_to_eb[lev].get());
+#ifdef WARPX_MAG_LLG
+    bytes[MemoryFamily::EB] += LocalMemoryBytes(m_ect_minus_curlE[lev]);
+#endif
+
+    bytes[MemoryFamily::Other] =
+        LocalMemoryBytes(Efield_avg_fp[lev]) + LocalMemoryBytes(Bfield_avg_fp[lev])
+        + LocalMemoryBytes(Efield_avg_cp[lev]) + LocalMemoryBytes(Bfield_avg_cp[lev])
+        + LocalMemoryBytes(Efield_cax[lev]) + LocalMemoryBytes(Bfield_cax[lev])
+        + LocalMemoryBytes(current_buffer_masks[lev].get()) + LocalMemoryBytes(gather_buffer_masks[lev].get());
+#ifdef WARPX_MAG_LLG
+    bytes[MemoryFamily::Other] += LocalMemoryBytes(Mfield_cax[lev]) + LocalMemoryBytes(Hfield_cax[lev])
+                                + LocalMemoryBytes(H_biasfield_cax[lev]);
+#endif
+
+    for (int ispec = 0; ispec < mypc->nSpecies(); ++ispec) {
+        auto const& pc = mypc->GetParticleContainer(ispec);
+        if (lev >= pc.numLevels()) continue;
+        for (auto const& kv : pc.GetParticles(lev)) {
+            auto const& soa = kv.second.GetStructOfArrays();
+            double particle_bytes = sizeof(WarpXParticleContainer::ParticleType)
+                                  + soa.NumRealComps() * sizeof(amrex::ParticleReal)
+                                  + soa.NumIntComps() * sizeof(int);
+            bytes[MemoryFamily::Particles] += particle_bytes * kv.second.numParticles();
+        }
+    }
+    return bytes;
+}
+
+void
+WarpX::PrintMemoryReport () const
+{
+    // maximum and mean over the ranks of the bytes of each family, on each level
+    int const nfam = MemoryFamily::NumFamilies;
+    int const nlev = finest_level + 1;
+    amrex::Vector<double> bytes_max, bytes_mean;
+    for (int lev = 0; lev < nlev; ++lev) {
+        amrex::Vector<double> const bytes = MemoryFootprint(lev);
+        bytes_max.insert(bytes_max.end(), bytes.begin(), bytes.end());
+    }
+    // the total of each level on each rank
+    for (int lev = 0; lev < nlev; ++lev) {
+        double total = 0.;
+        for (int f = 0; f < nfam; ++f) total += bytes_max[lev*nfam + f];
+        bytes_max.push_back(total);
+    }
+    bytes_mean = bytes_max;
+    int const io_proc = ParallelDescriptor::IOProcessorNumber();
+    amrex::ParallelReduce::Max(bytes_max.data(), static_cast<int>(bytes_max.size()), io_proc,
+                               ParallelDescriptor::Communicator());
+    amrex::ParallelReduce::Sum(bytes_mean.data(), static_cast<int>(bytes_mean.size()), io_proc,
+                               ParallelDescriptor::Communicator());
+    for (auto& b : bytes_mean) b /= ParallelDescriptor::NProcs();
+
+    constexpr double MB = 1024.*1024.;
+    std::stringstream ss;
+    ss << "\nMemory footprint per rank (MB), maximum and mean over the ranks:\n";
+    for (int lev = 0; lev < nlev; ++lev) {
+        ss << "  level " << lev << std::right << std::setw(12) << "max" << std::setw(12) << "mean" << "\n";
+        for (int f = 0; f < nfam; ++f) {
+            int const i = lev*nfam + f;
+            // the families without any array are omitted
+            if (bytes_max[i] == 0.) continue;
+            ss << "    " << std::left << std::setw(16) << MemoryFamilyName(f) << std::right
+               << std::fixed << std::setprecision(1)
+               << std::setw(12) << bytes_max[i] / MB << std::setw(12) << bytes_mean[i] / MB << "\n";
+        }
+        int const itot = nlev*nfam + lev;
+        ss << "    " << std::left << std::setw(16) << "total" << std::right
+           << std::setw(12) << bytes_max[itot] / MB << std::setw(12) << bytes_mean[itot] / MB << "\n";
+    }
+    ss << "  (the totals are maxima of the totals of the ranks, not sums of the maxima)\n";
+
+    // high-water marks of the temporaries of the time step, which are requested by all the ranks
+    std::map<std::string, double> const& high_water = m_scratch_mfs.HighWaterBytes();
+    if (!high_water.empty()) {
+        amrex::Vector<double> hw_max;
+        for (auto const& kv : high_water) hw_max.push_back(kv.second);
+        amrex::Vector<double> hw_mean = hw_max;
+        amrex::ParallelReduce::Max(hw_max.data(), static_cast<int>(hw_max.size()), io_proc,
+                                   ParallelDescriptor::Communicator());
+        amrex::ParallelReduce::Sum(hw_mean.data(), static_cast<int>(hw_mean.size()), io_proc,
+                                   ParallelDescriptor::Communicator());
+        ss << "  high-water marks of the temporaries, all levels\n";
+        int i = 0;
+        for (auto const& kv : high_water) {
+            ss << "    " << std::left << std::setw(16) << kv.first << std::right
+               << std::setw(12) << hw_max[i] / MB
+               << std::setw(12) << hw_mean[i] / ParallelDescriptor::NProcs() / MB << "\n";
+            ++i;
+        }
+    }
+    ss << "\n";
+    amrex::Print() << ss.str();
 }
 
 void
@@ -1985,18 +2676,30 @@ WarpX::AllocLevelMFs (int lev, const BoxArray& ba, const DistributionMapping& dm
     Bfield_fp[lev][2] = std::make_unique<MultiFab>(amrex::convert(ba,Bz_nodal_flag),dm,ncomps,ngEB,tag("Bfield_fp[z]"));
 
 #ifdef WARPX_MAG_LLG
-    // each Mfield[] is three components
-    Mfield_fp[lev][0] = std::make_unique<MultiFab>(amrex::convert(ba,Mx_nodal_flag),dm,3     ,ngEB);
-    Mfield_fp[lev][1] = std::make_unique<MultiFab>(amrex::convert(ba,My_nodal_flag),dm,3     ,ngEB);
-    Mfield_fp[lev][2] = std::make_unique<MultiFab>(amrex::convert(ba,Mz_nodal_flag),dm,3     ,ngEB);
+    if (mag_LLG) {
+        // each Mfield[] is three components
+        if (mag_M_collocated == 1) {
+            // a single cell-centered MultiFab, that Mfield_fp[lev][1] and [2] alias
+            Mfield_fp[lev][0] = std::make_unique<MultiFab>(ba,dm,3     ,ngEB);
+            Mfield_fp[lev][1] = std::make_unique<MultiFab>(*Mfield_fp[lev][0], amrex::make_alias, 0, 3);
+            Mfield_fp[lev][2] = std::make_unique<MultiFab>(*Mfield_fp[lev][0], amrex::make_alias, 0, 3);
+        } else {
+            Mfield_fp[lev][0] = std::make_unique<MultiFab>(amrex::convert(ba,Mx_nodal_flag),dm,3     ,ngEB);
+            Mfield_fp[lev][1] = std::make_unique<MultiFab>(amrex::convert(ba,My_nodal_flag),dm,3     ,ngEB);
+            Mfield_fp[lev][2] = std::make_unique<MultiFab>(amrex::convert(ba,Mz_nodal_flag),dm,3     ,ngEB);
+        }
 
-    Hfield_fp[lev][0] = std::make_unique<MultiFab>(amrex::convert(ba,Hx_nodal_flag),dm,ncomps,ngEB);
-    Hfield_fp[lev][1] = std::make_unique<MultiFab>(amrex::convert(ba,Hy_nodal_flag),dm,ncomps,ngEB);
-    Hfield_fp[lev][2] = std::make_unique<MultiFab>(amrex::convert(ba,Hz_nodal_flag),dm,ncomps,ngEB);
+        Hfield_fp[lev][0] = std::make_unique<MultiFab>(amrex::convert(ba,Hx_nodal_flag),dm,ncomps,ngEB);
+        Hfield_fp[lev][1] = std::make_unique<MultiFab>(amrex::convert(ba,Hy_nodal_flag),dm,ncomps,ngEB);
+        Hfield_fp[lev][2] = std::make_unique<MultiFab>(amrex::convert(ba,Hz_nodal_flag),dm,ncomps,ngEB);
 
-    H_biasfield_fp[lev][0] = std::make_unique<MultiFab>(amrex::convert(ba,Hx_bias_nodal_flag),dm,ncomps,ngEB);
-    H_biasfield_fp[lev][1] = std::make_unique<MultiFab>(amrex::convert(ba,Hy_bias_nodal_flag),dm,ncomps,ngEB);
-    H_biasfield_fp[lev][2] = std::make_unique<MultiFab>(amrex::convert(ba,Hz_bias_nodal_flag),dm,ncomps,ngEB);
+        // a uniform H_bias is not stored on the grid; H_bias is static data (warpx.static_data_memory)
+        if (mag_H_bias_uniform == 0) {
+            H_biasfield_fp[lev][0] = std::make_unique<MultiFab>(amrex::convert(ba,Hx_bias_nodal_flag),dm,ncomps,ngEB,StaticDataMFInfo());
+            H_biasfield_fp[lev][1] = std::make_unique<MultiFab>(amrex::convert(ba,Hy_bias_nodal_flag),dm,ncomps,ngEB,StaticDataMFInfo());
+            H_biasfield_fp[lev][2] = std::make_unique<MultiFab>(amrex::convert(ba,Hz_bias_nodal_flag),dm,ncomps,ngEB,StaticDataMFInfo());
+        }
+    }
 #endif
 
     Efield_fp[lev][0] = std::make_unique<MultiFab>(amrex::convert(ba,Ex_nodal_flag),dm,ncomps,ngEB,tag("Efield_fp[x]"));
@@ -2080,6 +2783,13 @@ WarpX::AllocLevelMFs (int lev, const BoxArray& ba, const DistributionMapping& dm
             ECTRhofield[lev][0]->setVal(0.);
             ECTRhofield[lev][1]->setVal(0.);
             ECTRhofield[lev][2]->setVal(0.);
+#ifdef WARPX_MAG_LLG
+            if (mag_LLG) {
+                m_ect_minus_curlE[lev][0] = std::make_unique<MultiFab>(amrex::convert(ba, Bx_nodal_flag), dm, ncomps, guard_cells.ng_FieldSolver, tag("m_ect_minus_curlE[x]"));
+                m_ect_minus_curlE[lev][1] = std::make_unique<MultiFab>(amrex::convert(ba, By_nodal_flag), dm, ncomps, guard_cells.ng_FieldSolver, tag("m_ect_minus_curlE[y]"));
+                m_ect_minus_curlE[lev][2] = std::make_unique<MultiFab>(amrex::convert(ba, Bz_nodal_flag), dm, ncomps, guard_cells.ng_FieldSolver, tag("m_ect_minus_curlE[z]"));
+            }
+#endif
         }
     }
 #endif
@@ -2141,6 +2851,11 @@ WarpX::AllocLevelMFs (int lev, const BoxArray& ba, const DistributionMapping& dm
                 "The option `psatd.periodic_single_box_fft` can only be used for a periodic domain, decomposed in a single box");
 #   endif
         }
+        if (fft_global_distributed) {
+            WARPX_ALWAYS_ASSERT_WITH_MESSAGE(
+                geom[0].isAllPeriodic() && lev == 0,
+                "The option `psatd.global_fft` can only be used for a periodic domain, without mesh refinement");
+        }
         // Get the cell-centered box
         BoxArray realspace_ba = ba;  // Copy box
         realspace_ba.enclosedCells(); // Make it cell-centered
@@ -2160,7 +2875,7 @@ WarpX::AllocLevelMFs (int lev, const BoxArray& ba, const DistributionMapping& dm
                                    dm,
                                    dx);
 #   else
-        if ( fft_periodic_single_box == false ) {
+        if ( fft_periodic_single_box == false && fft_global_distributed == false ) {
             realspace_ba.grow(ngEB);   // add guard cells
         }
         bool const pml_flag_false = false;
@@ -2174,7 +2889,8 @@ WarpX::AllocLevelMFs (int lev, const BoxArray& ba, const DistributionMapping& dm
 #endif
     } // MaxwellSolverAlgo::PSATD
     else {
-        m_fdtd_solver_fp[lev] = std::make_unique<FiniteDifferenceSolver>(maxwell_solver_id, dx, do_nodal);
+        m_fdtd_solver_fp[lev] = std::make_unique<FiniteDifferenceSolver>(maxwell_solver_id, dx, do_nodal,
+            (lev == 0 && m_graded_mesh.IsGraded()) ? &m_graded_mesh : nullptr);
     }
 
     //
@@ -2185,19 +2901,6 @@ WarpX::AllocLevelMFs (int lev, const BoxArray& ba, const DistributionMapping& dm
         // Create aux multifabs on Nodal Box Array
         BoxArray const nba = amrex::convert(ba,IntVect::TheNodeVector());
 
-#ifdef WARPX_MAG_LLG
-        Mfield_aux[lev][0] = std::make_unique<MultiFab>(nba,dm,3     ,ngEB);
-        Mfield_aux[lev][1] = std::make_unique<MultiFab>(nba,dm,3     ,ngEB);
-        Mfield_aux[lev][2] = std::make_unique<MultiFab>(nba,dm,3     ,ngEB);
-
-        Hfield_aux[lev][0] = std::make_unique<MultiFab>(nba,dm,ncomps,ngEB);
-        Hfield_aux[lev][1] = std::make_unique<MultiFab>(nba,dm,ncomps,ngEB);
-        Hfield_aux[lev][2] = std::make_unique<MultiFab>(nba,dm,ncomps,ngEB);
-
-        H_biasfield_aux[lev][0] = std::make_unique<MultiFab>(nba,dm,ncomps,ngEB);
-        H_biasfield_aux[lev][1] = std::make_unique<MultiFab>(nba,dm,ncomps,ngEB);
-        H_biasfield_aux[lev][2] = std::make_unique<MultiFab>(nba,dm,ncomps,ngEB);
-#endif
         Bfield_aux[lev][0] = std::make_unique<MultiFab>(nba,dm,ncomps,ngEB,tag("Bfield_aux[x]"));
         Bfield_aux[lev][1] = std::make_unique<MultiFab>(nba,dm,ncomps,ngEB,tag("Bfield_aux[y]"));
         Bfield_aux[lev][2] = std::make_unique<MultiFab>(nba,dm,ncomps,ngEB,tag("Bfield_aux[z]"));
@@ -2215,20 +2918,6 @@ WarpX::AllocLevelMFs (int lev, const BoxArray& ba, const DistributionMapping& dm
             Bfield_aux[lev][0] = std::make_unique<MultiFab>(*Bfield_fp[lev][0], amrex::make_alias, 0, ncomps);
             Bfield_aux[lev][1] = std::make_unique<MultiFab>(*Bfield_fp[lev][1], amrex::make_alias, 0, ncomps);
             Bfield_aux[lev][2] = std::make_unique<MultiFab>(*Bfield_fp[lev][2], amrex::make_alias, 0, ncomps);
-
-#ifdef WARPX_MAG_LLG
-            H_biasfield_aux[lev][0] = std::make_unique<MultiFab>(*H_biasfield_fp[lev][0], amrex::make_alias, 0, ncomps);
-            H_biasfield_aux[lev][1] = std::make_unique<MultiFab>(*H_biasfield_fp[lev][1], amrex::make_alias, 0, ncomps);
-            H_biasfield_aux[lev][2] = std::make_unique<MultiFab>(*H_biasfield_fp[lev][2], amrex::make_alias, 0, ncomps);
-
-            Hfield_aux[lev][0] = std::make_unique<MultiFab>(*Hfield_fp[lev][0], amrex::make_alias, 0, ncomps);
-            Hfield_aux[lev][1] = std::make_unique<MultiFab>(*Hfield_fp[lev][1], amrex::make_alias, 0, ncomps);
-            Hfield_aux[lev][2] = std::make_unique<MultiFab>(*Hfield_fp[lev][2], amrex::make_alias, 0, ncomps);
-
-            Mfield_aux[lev][0] = std::make_unique<MultiFab>(*Mfield_fp[lev][0], amrex::make_alias, 0, 3);
-            Mfield_aux[lev][1] = std::make_unique<MultiFab>(*Mfield_fp[lev][1], amrex::make_alias, 0, 3);
-            Mfield_aux[lev][2] = std::make_unique<MultiFab>(*Mfield_fp[lev][2], amrex::make_alias, 0, 3);
-#endif
         } else {
             Efield_aux[lev][0] = std::make_unique<MultiFab>(*Efield_avg_fp[lev][0], amrex::make_alias, 0, ncomps);
             Efield_aux[lev][1] = std::make_unique<MultiFab>(*Efield_avg_fp[lev][1], amrex::make_alias, 0, ncomps);
@@ -2246,21 +2935,45 @@ WarpX::AllocLevelMFs (int lev, const BoxArray& ba, const DistributionMapping& dm
         Efield_aux[lev][0] = std::make_unique<MultiFab>(amrex::convert(ba,Ex_nodal_flag),dm,ncomps,ngEB,tag("Efield_aux[x]"));
         Efield_aux[lev][1] = std::make_unique<MultiFab>(amrex::convert(ba,Ey_nodal_flag),dm,ncomps,ngEB,tag("Efield_aux[y]"));
         Efield_aux[lev][2] = std::make_unique<MultiFab>(amrex::convert(ba,Ez_nodal_flag),dm,ncomps,ngEB,tag("Efield_aux[z]"));
+    }
 
 #ifdef WARPX_MAG_LLG
-        Mfield_aux[lev][0] = std::make_unique<MultiFab>(amrex::convert(ba,Mx_nodal_flag),dm,3     ,ngEB);
-        Mfield_aux[lev][1] = std::make_unique<MultiFab>(amrex::convert(ba,My_nodal_flag),dm,3     ,ngEB);
-        Mfield_aux[lev][2] = std::make_unique<MultiFab>(amrex::convert(ba,Mz_nodal_flag),dm,3     ,ngEB);
-
-        Hfield_aux[lev][0] = std::make_unique<MultiFab>(amrex::convert(ba,Hx_nodal_flag),dm,ncomps,ngEB);
-        Hfield_aux[lev][1] = std::make_unique<MultiFab>(amrex::convert(ba,Hy_nodal_flag),dm,ncomps,ngEB);
-        Hfield_aux[lev][2] = std::make_unique<MultiFab>(amrex::convert(ba,Hz_nodal_flag),dm,ncomps,ngEB);
-
-        H_biasfield_aux[lev][0] = std::make_unique<MultiFab>(amrex::convert(ba,Hx_bias_nodal_flag),dm,ncomps,ngEB);
-        H_biasfield_aux[lev][1] = std::make_unique<MultiFab>(amrex::convert(ba,Hy_bias_nodal_flag),dm,ncomps,ngEB);
-        H_biasfield_aux[lev][2] = std::make_unique<MultiFab>(amrex::convert(ba,Hz_bias_nodal_flag),dm,ncomps,ngEB);
-#endif
+    if (mag_LLG) {
+        // H, M and H_bias are only evolved on level 0 and are not gathered by the particles, so their aux
+        // fields of level 0 are aliases of the fp fields, also with a nodal gather or time averaging
+        if (lev == 0)
+        {
+            for (int i = 0; i < 3; ++i) {
+                Mfield_aux[lev][i] = std::make_unique<MultiFab>(*Mfield_fp[lev][i], amrex::make_alias, 0, 3);
+                Hfield_aux[lev][i] = std::make_unique<MultiFab>(*Hfield_fp[lev][i], amrex::make_alias, 0, ncomps);
+                if (H_biasfield_fp[lev][i]) {
+                    H_biasfield_aux[lev][i] = std::make_unique<MultiFab>(*H_biasfield_fp[lev][i], amrex::make_alias, 0, ncomps);
+                }
+            }
+        } else if (aux_is_nodal and !do_nodal) {
+            BoxArray const nba = amrex::convert(ba,IntVect::TheNodeVector());
+            for (int i = 0; i < 3; ++i) {
+                Mfield_aux[lev][i] = std::make_unique<MultiFab>(nba,dm,3     ,ngEB);
+                Hfield_aux[lev][i] = std::make_unique<MultiFab>(nba,dm,ncomps,ngEB);
+                if (mag_H_bias_uniform == 0) H_biasfield_aux[lev][i] = std::make_unique<MultiFab>(nba,dm,ncomps,ngEB);
+            }
+        } else {
+            Mfield_aux[lev][0] = std::make_unique<MultiFab>(amrex::convert(ba,Mx_nodal_flag),dm,3     ,ngEB);
+            Mfield_aux[lev][1] = std::make_unique<MultiFab>(amrex::convert(ba,My_nodal_flag),dm,3     ,ngEB);
+            Mfield_aux[lev][2] = std::make_unique<MultiFab>(amrex::convert(ba,Mz_nodal_flag),dm,3     ,ngEB);
+
+            Hfield_aux[lev][0] = std::make_unique<MultiFab>(amrex::convert(ba,Hx_nodal_flag),dm,ncomps,ngEB);
+            Hfield_aux[lev][1] = std::make_unique<MultiFab>(amrex::convert(ba,Hy_nodal_flag),dm,ncomps,ngEB);
+            Hfield_aux[lev][2] = std::make_unique<MultiFab>(amrex::convert(ba,Hz_nodal_flag),dm,ncomps,ngEB);
+
+            if (mag_H_bias_uniform == 0) {
+                H_biasfield_aux[lev][0] = std::make_unique<MultiFab>(amrex::convert(ba,Hx_bias_nodal_flag),dm,ncomps,ngEB);
+                H_biasfield_aux[lev][1] = std::make_unique<MultiFab>(amrex::convert(ba,Hy_bias_nodal_flag),dm,ncomps,ngEB);
+                H_biasfield_aux[lev][2] = std::make_unique<MultiFab>(amrex::convert(ba,Hz_bias_nodal_flag),dm,ncomps,ngEB);
+            }
+        }
     }
+#endif
 
     //
     // The coarse patch
@@ -2272,21 +2985,24 @@ WarpX::AllocLevelMFs (int lev, const BoxArray& ba, const DistributionMapping& dm
         std::array<Real,3> cdx = CellSize(lev-1);
 
 #ifdef WARPX_MAG_LLG
-    // Create the MultiFabs for M
-        Mfield_cp[lev][0] = std::make_unique<MultiFab>(amrex::convert(cba,Mx_nodal_flag),dm,3     ,ngEB);
-        Mfield_cp[lev][1] = std::make_unique<MultiFab>(amrex::convert(cba,My_nodal_flag),dm,3     ,ngEB);
-        Mfield_cp[lev][2] = std::make_unique<MultiFab>(amrex::convert(cba,Mz_nodal_flag),dm,3     ,ngEB);
-
-        // Create the MultiFabs for H
-        Hfield_cp[lev][0] = std::make_unique<MultiFab>(amrex::convert(cba,Hx_nodal_flag),dm,ncomps,ngEB);
-        Hfield_cp[lev][1] = std::make_unique<MultiFab>(amrex::convert(cba,Hy_nodal_flag),dm,ncomps,ngEB);
-        Hfield_cp[lev][2] = std::make_unique<MultiFab>(amrex::convert(cba,Hz_nodal_flag),dm,ncomps,ngEB);
-
-        // Create the MultiFabs for H_bias
-        H_biasfield_cp[lev][0] = std::make_unique<MultiFab>(amrex::convert(cba,Hx_bias_nodal_flag),dm,ncomps,ngEB);
-        H_biasfield_cp[lev][1] = std::make_unique<MultiFab>(amrex::convert(cba,Hy_bias_nodal_flag),dm,ncomps,ngEB);
-        H_biasfield_cp[lev][2] = std::make_unique<MultiFab>(amrex::convert(cba,Hz_bias_nodal_flag),dm,ncomps,ngEB);
-
+        if (mag_LLG) {
+            // Create the MultiFabs for M
+            Mfield_cp[lev][0] = std::make_unique<MultiFab>(amrex::convert(cba,Mx_nodal_flag),dm,3     ,ngEB);
+            Mfield_cp[lev][1] = std::make_unique<MultiFab>(amrex::convert(cba,My_nodal_flag),dm,3     ,ngEB);
+            Mfield_cp[lev][2] = std::make_unique<MultiFab>(amrex::convert(cba,Mz_nodal_flag),dm,3     ,ngEB);
+
+            // Create the MultiFabs for H
+            Hfield_cp[lev][0] = std::make_unique<MultiFab>(amrex::convert(cba,Hx_nodal_flag),dm,ncomps,ngEB);
+            Hfield_cp[lev][1] = std::make_unique<MultiFab>(amrex::convert(cba,Hy_nodal_flag),dm,ncomps,ngEB);
+            Hfield_cp[lev][2] = std::make_unique<MultiFab>(amrex::convert(cba,Hz_nodal_flag),dm,ncomps,ngEB);
+
+            // Create the MultiFabs for H_bias
+            if (mag_H_bias_uniform == 0) {
+                H_biasfield_cp[lev][0] = std::make_unique<MultiFab>(amrex::convert(cba,Hx_bias_nodal_flag),dm,ncomps,ngEB);
+                H_biasfield_cp[lev][1] = std::make_unique<MultiFab>(amrex::convert(cba,Hy_bias_nodal_flag),dm,ncomps,ngEB);
+                H_biasfield_cp[lev][2] = std::make_unique<MultiFab>(amrex::convert(cba,Hz_bias_nodal_flag),dm,ncomps,ngEB);
+            }
+        }
 #endif
 
         // Create the MultiFabs for B
@@ -2394,15 +3110,19 @@ WarpX::AllocLevelMFs (int lev, const BoxArray& ba, const DistributionMapping& dm
             if (aux_is_nodal) {
                 BoxArray const& cnba = amrex::convert(cba,IntVect::TheNodeVector());
 #ifdef WARPX_MAG_LLG
-                Mfield_cax[lev][0] = std::make_unique<MultiFab>(cnba,dm,3     ,ngEB);
-                Mfield_cax[lev][1] = std::make_unique<MultiFab>(cnba,dm,3     ,ngEB);
-                Mfield_cax[lev][2] = std::make_unique<MultiFab>(cnba,dm,3     ,ngEB);
-                Hfield_cax[lev][0] = std::make_unique<MultiFab>(cnba,dm,ncomps,ngEB);
-                Hfield_cax[lev][1] = std::make_unique<MultiFab>(cnba,dm,ncomps,ngEB);
-                Hfield_cax[lev][2] = std::make_unique<MultiFab>(cnba,dm,ncomps,ngEB);
-                H_biasfield_cax[lev][0] = std::make_unique<MultiFab>(cnba,dm,ncomps,ngEB);
-                H_biasfield_cax[lev][1] = std::make_unique<MultiFab>(cnba,dm,ncomps,ngEB);
-                H_biasfield_cax[lev][2] = std::make_unique<MultiFab>(cnba,dm,ncomps,ngEB);
+                if (mag_LLG) {
+                    Mfield_cax[lev][0] = std::make_unique<MultiFab>(cnba,dm,3     ,ngEB);
+                    Mfield_cax[lev][1] = std::make_unique<MultiFab>(cnba,dm,3     ,ngEB);
+                    Mfield_cax[lev][2] = std::make_unique<MultiFab>(cnba,dm,3     ,ngEB);
+                    Hfield_cax[lev][0] = std::make_unique<MultiFab>(cnba,dm,ncomps,ngEB);
+                    Hfield_cax[lev][1] = std::make_unique<MultiFab>(cnba,dm,ncomps,ngEB);
+                    Hfield_cax[lev][2] = std::make_unique<MultiFab>(cnba,dm,ncomps,ngEB);
+                    if (mag_H_bias_uniform == 0) {
+                        H_biasfield_cax[lev][0] = std::make_unique<MultiFab>(cnba,dm,ncomps,ngEB);
+                        H_biasfield_cax[lev][1] = std::make_unique<MultiFab>(cnba,dm,ncomps,ngEB);
+                        H_biasfield_cax[lev][2] = std::make_unique<MultiFab>(cnba,dm,ncomps,ngEB);
+                    }
+                }
 #endif
                 Bfield_cax[lev][0] = std::make_unique<MultiFab>(cnba,dm,ncomps,ngEB,tag("Bfield_cax[x]"));
                 Bfield_cax[lev][1] = std::make_unique<MultiFab>(cnba,dm,ncomps,ngEB,tag("Bfield_cax[y]"));
@@ -2417,20 +3137,24 @@ WarpX::AllocLevelMFs (int lev, const BoxArray& ba, const DistributionMapping& dm
                 Bfield_cax[lev][2] = std::make_unique<MultiFab>(amrex::convert(cba,Bz_nodal_flag),dm,ncomps,ngEB,tag("Bfield_cax[z]"));
 
 #ifdef WARPX_MAG_LLG
-                // Create the MultiFabs for M
-                Mfield_cax[lev][0] = std::make_unique<MultiFab>(amrex::convert(cba,Mx_nodal_flag),dm,3     ,ngEB);
-                Mfield_cax[lev][1] = std::make_unique<MultiFab>(amrex::convert(cba,My_nodal_flag),dm,3     ,ngEB);
-                Mfield_cax[lev][2] = std::make_unique<MultiFab>(amrex::convert(cba,Mz_nodal_flag),dm,3     ,ngEB);
-
-                // Create the MultiFabs for H
-                Hfield_cax[lev][0] = std::make_unique<MultiFab>(amrex::convert(cba,Hx_nodal_flag),dm,ncomps,ngEB);
-                Hfield_cax[lev][1] = std::make_unique<MultiFab>(amrex::convert(cba,Hy_nodal_flag),dm,ncomps,ngEB);
-                Hfield_cax[lev][2] = std::make_unique<MultiFab>(amrex::convert(cba,Hz_nodal_flag),dm,ncomps,ngEB);
-
-                // Create the MultiFabs for H_bias
-                H_biasfield_cax[lev][0] = std::make_unique<MultiFab>(amrex::convert(cba,Hx_bias_nodal_flag),dm,ncomps,ngEB);
-                H_biasfield_cax[lev][1] = std::make_unique<MultiFab>(amrex::convert(cba,Hy_bias_nodal_flag),dm,ncomps,ngEB);
-                H_biasfield_cax[lev][2] = std::make_unique<MultiFab>(amrex::convert(cba,Hz_bias_nodal_flag),dm,ncomps,ngEB);
+                if (mag_LLG) {
+                    // Create the MultiFabs for M
+                    Mfield_cax[lev][0] = std::make_unique<MultiFab>(amrex::convert(cba,Mx_nodal_flag),dm,3     ,ngEB);
+                    Mfield_cax[lev][1] = std::make_unique<MultiFab>(amrex::convert(cba,My_nodal_flag),dm,3     ,ngEB);
+                    Mfield_cax[lev][2] = std::make_unique<MultiFab>(amrex::convert(cba,Mz_nodal_flag),dm,3     ,ngEB);
+
+                    // Create the MultiFabs for H
+                    Hfield_cax[lev][0] = std::make_unique<MultiFab>(amrex::convert(cba,Hx_nodal_flag),dm,ncomps,ngEB);
+                    Hfield_cax[lev][1] = std::make_unique<MultiFab>(amrex::convert(cba,Hy_nodal_flag),dm,ncomps,ngEB);
+                    Hfield_cax[lev][2] = std::make_unique<MultiFab>(amrex::convert(cba,Hz_nodal_flag),dm,ncomps,ngEB);
+
+                    // Create the MultiFabs for H_bias
+                    if (mag_H_bias_uniform == 0) {
+                        H_biasfield_cax[lev][0] = std::make_unique<MultiFab>(amrex::convert(cba,Hx_bias_nodal_flag),dm,ncomps,ngEB);
+                        H_biasfield_cax[lev][1] = std::make_unique<MultiFab>(amrex::convert(cba,Hy_bias_nodal_flag),dm,ncomps,ngEB);
+                        H_biasfield_cax[lev][2] = std::make_unique<MultiFab>(amrex::convert(cba,Hz_bias_nodal_flag),dm,ncomps,ngEB);
+                    }
+                }
 #endif
                 // Create the MultiFabs for E
                 Efield_cax[lev][0] = std::make_unique<MultiFab>(amrex::convert(cba,Ex_nodal_flag),dm,ncomps,ngEB,tag("Efield_cax[x]"));
@@ -2552,16 +3276,38 @@ void WarpX::AllocLevelSpectralSolver (amrex::Vector<std::unique_ptr<SpectralSolv
                                                 solver_dt,
                                                 pml_flag,
                                                 fft_periodic_single_box,
+                                                fft_global_distributed,
                                                 update_with_rho,
                                                 fft_do_time_averaging,
                                                 do_multi_J,
                                                 do_dive_cleaning,
-                                                do_divb_cleaning);
+                                                do_divb_cleaning,
+                                                PSATDLightSpeed(),
+                                                PSATDPermittivity());
     spectral_solver[lev] = std::move(pss);
 }
 #   endif
 #endif
 
+Real
+WarpX::PSATDLightSpeed () const
+{
+    if (em_solver_medium != MediumForEM::Macroscopic) return PhysConst::c;
+    return 1._rt / std::sqrt(PSATDPermittivity() * m_macroscopic_properties[0]->getmu());
+}
+
+Real
+WarpX::PSATDPermittivity () const
+{
+    if (em_solver_medium != MediumForEM::Macroscopic) return PhysConst::ep0;
+    // the PSATD equations are integrated analytically in a uniform, lossless medium only
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(
+        m_macroscopic_properties[0]->is_uniform() && m_macroscopic_properties[0]->getsigma() == 0._rt,
+        "algo.maxwell_solver = psatd with algo.em_solver_medium = macroscopic requires constant "
+        "macroscopic.epsilon and macroscopic.mu, and macroscopic.sigma = 0");
+    return m_macroscopic_properties[0]->getepsilon();
+}
+
 std::array<Real,3>
 WarpX::CellSize (int lev)
 {
@@ -9,7 +9,9 @@
 #include "WarpX.H"
 
 #include "Initialization/WarpXAMReXInit.H"
+#include "Initialization/WarpXEnsemble.H"
 #include "Utils/MPIInitHelpers.H"
+#include "Utils/TextMsg.H"
 #include "Utils/WarpXUtil.H"
 #include "Utils/WarpXProfilerWrapper.H"
 
@@ -40,6 +42,26 @@ int main(int argc, char* argv[])
 
     warpx_amrex_init(argc, argv);
 
+    // Members of an ensemble run concurrently: AMReX is initialized again for each group of
+    // MPI ranks, on its own communicator
+    int ensemble_group = 0;
+#if defined(AMREX_USE_MPI)
+    MPI_Comm ensemble_comm = MPI_COMM_NULL;
+    const int ensemble_num_groups = WarpXEnsemble::NumGroups();
+    if (ensemble_num_groups > 1) {
+        const int rank = ParallelDescriptor::MyProc();
+        WARPX_ALWAYS_ASSERT_WITH_MESSAGE(ParallelDescriptor::NProcs() % ensemble_num_groups == 0,
+            "The number of MPI ranks must be a multiple of ensemble.num_concurrent");
+        ensemble_group = rank % ensemble_num_groups;
+        MPI_Comm_split(MPI_COMM_WORLD, ensemble_group, rank, &ensemble_comm);
+        Finalize();
+        warpx_amrex_init(argc, argv, true, ensemble_comm);
+    }
+#else
+    WARPX_ALWAYS_ASSERT_WITH_MESSAGE(WarpXEnsemble::NumGroups() == 1,
+        "ensemble.num_concurrent requires WarpX built with MPI");
+#endif
+
 #if defined(AMREX_USE_HIP) && defined(WARPX_USE_PSATD)
     rocfft_setup();
 #endif
@@ -58,15 +80,25 @@ int main(int argc, char* argv[])
 
         const auto strt_total = static_cast<Real>(amrex::second());
 
-        WarpX warpx;
+        // The members of an ensemble are run one after the other, with a new WarpX
+        // object each, but the initialization above is done once
+        WarpXEnsemble ensemble(ensemble_group);
+        int verbose = 0;
+        for (const int member : ensemble.GroupMembers()) {
+            ensemble.SetMember(member);
 
-        warpx.InitData();
+            WarpX warpx;
 
-        warpx.Evolve();
+            warpx.InitData();
 
-        warpx.PrintGlobalWarnings("THE END"); //Print warning messages at the end of the simulation
+            warpx.Evolve();
+
+            warpx.PrintGlobalWarnings("THE END"); //Print warning messages at the end of the simulation
+
+            verbose = warpx.Verbose();
+        }
 
-        if (warpx.Verbose()) {
+        if (verbose) {
             auto end_total = static_cast<Real>(amrex::second()) - strt_total;
             ParallelDescriptor::ReduceRealMax(end_total, ParallelDescriptor::IOProcessorNumber());
             Print() << "Total Time                     : " << end_total << '\n';
@@ -81,6 +113,7 @@ int main(int argc, char* argv[])
 
     Finalize();
 #if defined(AMREX_USE_MPI)
+    if (ensemble_comm != MPI_COMM_NULL) MPI_Comm_free(&ensemble_comm);
     MPI_Finalize();
 #endif
 }
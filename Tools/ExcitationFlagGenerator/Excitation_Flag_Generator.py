@@ -8,16 +8,99 @@
 
 ##### function to create string for input file #####
 
+import argparse
+import math
+import struct
 import sys
+
+
 def listToString(finalstring):
     str1 = ""
     for ele in finalstring:
         str1 += ele
     return str1
 
+##### function to write a binary flag file #####
+# The file is read with warpx.<F>_excitation_flag_file: the magic string WXFLAG01,
+# then for each of the x, y, z components the number of points (3 int64), the origin
+# and the spacing (3 float64 each) of its lattice, which are the Yee points of the grid,
+# then the flags of the three components (uint8, x fastest), in the byte order of the machine.
+
+def writeFlagFile(filename, planes, d, prob_lo, prob_hi, n_cell, field, flag):
+    dcell = [(prob_hi[i] - prob_lo[i]) / n_cell[i] if n_cell[i] > 0 else 1. for i in range(3)]
+    with open(filename, 'wb') as f:
+        f.write(b'WXFLAG01')
+        lattices = []
+        for comp in range(3):
+            # E is cell-centered along its component and nodal in the other directions,
+            # B and H are nodal along their component and cell-centered in the other directions
+            cell_centered = [(i == comp) == (field == 'E') for i in range(3)]
+            n = []
+            origin = []
+            for i in range(3):
+                if n_cell[i] == 0:
+                    # direction absent in 2D: a single point at 0
+                    n.append(1)
+                    origin.append(0.)
+                elif cell_centered[i]:
+                    n.append(n_cell[i])
+                    origin.append(prob_lo[i] + 0.5 * dcell[i])
+                else:
+                    n.append(n_cell[i] + 1)
+                    origin.append(prob_lo[i])
+            f.write(struct.pack('=3q', *n))
+            f.write(struct.pack('=3d', *origin))
+            f.write(struct.pack('=3d', *dcell))
+            lattices.append((n, origin))
+        for comp in range(3):
+            n, origin = lattices[comp]
+            mask = bytearray(n[0] * n[1] * n[2])
+            for (lo, hi, tangential) in planes:
+                if not tangential[comp]:
+                    continue
+                # range of the lattice points within half a cell of the plane
+                ilo = []
+                ihi = []
+                for i in range(3):
+                    if n_cell[i] == 0:
+                        ilo.append(0)
+                        ihi.append(0)
+                        continue
+                    ilo.append(max(math.ceil((lo[i] - d[i] / 2 - origin[i]) / dcell[i] - 1.e-9), 0))
+                    ihi.append(min(math.floor((hi[i] + d[i] / 2 - origin[i]) / dcell[i] + 1.e-9), n[i] - 1))
+                if ilo[0] > ihi[0]:
+                    continue
+                row = bytes([flag]) * (ihi[0] - ilo[0] + 1)
+                for k in range(ilo[2], ihi[2] + 1):
+                    for j in range(ilo[1], ihi[1] + 1):
+                        start = (k * n[1] + j) * n[0]
+                        mask[start + ilo[0]:start + ihi[0] + 1] = row
+            f.write(mask)
+
+##### command line options #####
+
+parser = argparse.ArgumentParser(description='Excitation flag functions, or a binary flag file, '
+                                             'from the planes of a data text file')
+parser.add_argument('datafile', nargs='?', default='exampledata_Excitation_Flag_Generator.txt')
+parser.add_argument('--flag_file', help='write the flags to this binary file instead of printing the functions')
+# the triplets are given as in the inputs file, in quotes, e.g. --prob_lo "-8e-6 -20e-6 -8e-6"
+parser.add_argument('--prob_lo', type=lambda v: [float(c) for c in v.split()], help='geometry.prob_lo ("x y z")')
+parser.add_argument('--prob_hi', type=lambda v: [float(c) for c in v.split()], help='geometry.prob_hi ("x y z")')
+parser.add_argument('--n_cell', type=lambda v: [int(c) for c in v.split()],
+                    help='amr.n_cell ("x y z"), with 0 along y in 2D')
+parser.add_argument('--field', default='E', choices=['E', 'B', 'H', 'H_bias'], help='excited field')
+parser.add_argument('--flag', type=int, default=1, choices=[1, 2], help='1: hard source, 2: soft source')
+args = parser.parse_args()
+if args.flag_file and (args.prob_lo is None or args.prob_hi is None or args.n_cell is None):
+    print("Error: --flag_file requires --prob_lo, --prob_hi and --n_cell")
+    sys.exit()
+if args.flag_file and (len(args.prob_lo) != 3 or len(args.prob_hi) != 3 or len(args.n_cell) != 3):
+    print("Error: --prob_lo, --prob_hi and --n_cell must have 3 values")
+    sys.exit()
+
 ##### open text file and read data #####
 print()
-with open('exampledata_Excitation_Flag_Generator.txt') as myfile:
+with open(args.datafile) as myfile:
 
 ##### formatting text file for extracting data #####
 
@@ -41,6 +124,7 @@ with open('exampledata_Excitation_Flag_Generator.txt') as myfile:
     ExString = []
     EyString = []
     EzString = []
+    planes = []
 
 ##### testing coordinates to find a normal #####
 
@@ -54,14 +138,17 @@ with open('exampledata_Excitation_Flag_Generator.txt') as myfile:
         datastring = f"(x >= {x_lo} - ({dx1})) * (x <= {x_hi} + ({dx1})) * (y >= {y_lo} - ({dy1})) * (y <= {y_hi} + ({dy1})) * (z >= {z_lo} - ({dz1})) * (z <= {z_hi} + ({dz1})) + "
         if x_lo == x_hi and y_lo < y_hi and z_lo < z_hi:
             print("normal in x")
+            planes.append(([float(x_lo), float(y_lo), float(z_lo)], [float(x_hi), float(y_hi), float(z_hi)], (False, True, True)))
             EyString.append(datastring)
             EzString.append(datastring)
         if y_lo == y_hi and x_lo < x_hi and z_lo < z_hi:
             print("normal in y")
+            planes.append(([float(x_lo), float(y_lo), float(z_lo)], [float(x_hi), float(y_hi), float(z_hi)], (True, False, True)))
             ExString.append(datastring)
             EzString.append(datastring)
         if z_lo == z_hi and x_lo < x_hi and y_lo < y_hi:
             print("normal in z")
+            planes.append(([float(x_lo), float(y_lo), float(z_lo)], [float(x_hi), float(y_hi), float(z_hi)], (True, True, False)))
             ExString.append(datastring)
             EyString.append(datastring)
         if x_lo != x_hi and y_lo != y_hi and z_lo != z_hi:
@@ -70,6 +157,15 @@ with open('exampledata_Excitation_Flag_Generator.txt') as myfile:
         if x_lo > x_hi or y_lo > y_hi or z_lo > z_hi:
             print("Error: low coordinate is greater than high coordinate")
             sys.exit()
+##### Writes the binary flag file #####
+
+    if args.flag_file:
+        writeFlagFile(args.flag_file, planes, [dx, dy, dz], args.prob_lo, args.prob_hi,
+                      args.n_cell, args.field[0], args.flag)
+        print()
+        print("warpx." + args.field + "_excitation_flag_file = " + args.flag_file)
+        sys.exit()
+
 ##### Formats datastring to remove "+" at the end of the string #####
 
     x = listToString(ExString)[:-3]
@@ -18,10 +18,14 @@ import pandas as pd
 # import summit
 
 # Each instance of this class contains information for a single test.
+# scaling is 'weak' (the number of cells is doubled with the number of nodes)
+# or 'strong' (the number of cells is kept). If cell_size is given, the domain
+# is resized on the command line so that the cell size is kept (e.g. to keep
+# the size of an object in cells while the domain grows).
 class test_element():
     def __init__(self, input_file=None, n_node=None, n_mpi_per_node=None,
                  n_omp=None, n_cell=None, n_step=None, max_grid_size=None,
-                 blocking_factor=None):
+                 blocking_factor=None, scaling='weak', cell_size=None):
         self.input_file = input_file
         self.n_node = n_node
         self.n_mpi_per_node = n_mpi_per_node
@@ -30,8 +34,12 @@ class test_element():
         self.n_step = n_step
         self.max_grid_size = max_grid_size
         self.blocking_factor = blocking_factor
+        self.scaling = scaling
+        self.cell_size = cell_size
 
     def scale_n_cell(self, n_node=0):
+        if self.scaling == 'strong':
+            return
         n_cell_scaled = copy.deepcopy(self.n_cell)
         index_dim = 0
         while n_node > 1:
@@ -40,6 +48,14 @@ class test_element():
             index_dim = (index_dim+1) % 3
         self.n_cell = n_cell_scaled
 
+    def domain_string(self):
+        # runtime parameters of the domain, centered on 0, if the cell size is kept
+        if self.cell_size is None:
+            return ''
+        half_size = [0.5*n*d for n, d in zip(self.n_cell, self.cell_size)]
+        return ' geometry.prob_lo=' + ' '.join(str(-h) for h in half_size) + \
+               ' geometry.prob_hi=' + ' '.join(str(h) for h in half_size)
+
 def scale_n_cell(ncell, n_node):
      ncell_scaled = ncell[:]
      index_dim = 0
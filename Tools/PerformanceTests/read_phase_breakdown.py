@@ -0,0 +1,89 @@
+# This file is part of WarpX.
+#
+# License: BSD-3-Clause-LBNL
+
+# Report the time per step broken down by phase of the step, from the output of a
+# LoadBalanceCosts reduced diagnostics with <reduced_diags_name>.breakdown = 1
+# (e.g. the costs_*.txt files kept by run_automated.py for the LLG tests).
+#
+# typical use: python read_phase_breakdown.py $SCRATCH/performance_warpx/<run>/costs_*.txt
+#
+# The first output also covers the initialization, so it is only used if it is the only one.
+
+import argparse
+import math
+import re
+
+phases = ['EB_update', 'HM_update', 'PML', 'excitation', 'particles', 'exchange']
+
+def read_costs(filename):
+    with open(filename) as file_handler:
+        header = file_handler.readline()
+        lines = [line for line in file_handler if line.strip()]
+    sep = ',' if ',' in header else None
+    # column names without the column numbers, e.g. cost_HM_update_box_3(s)
+    names = [re.sub(r'^#?\[\d+\]', '', c) for c in header.split(sep)]
+    rows = [line.split(sep) for line in lines]
+    n_box = sum(1 for name in names if name.startswith('proc_box_'))
+    if not any(name.startswith('cost_HM_update_box_') for name in names):
+        raise ValueError(filename + ' has no breakdown (set <reduced_diags_name>.breakdown = 1)')
+    index = {name: i for i, name in enumerate(names)}
+
+    def column(row, name):
+        value = row[index[name]]
+        return math.nan if value == 'NaN' else float(value)
+
+    outputs = []
+    for row in rows:
+        output = {'step': float(row[0]), 'rank': [], 'llg_iterations': 0., 'mag_faces': 0.}
+        for p in phases:
+            output[p] = []
+        for b in range(n_box):
+            rank = column(row, 'proc_box_%d()' % b)
+            if math.isnan(rank):
+                continue
+            output['rank'].append(int(rank))
+            for p in phases:
+                output[p].append(column(row, 'cost_%s_box_%d(s)' % (p, b)))
+            output['llg_iterations'] = max(output['llg_iterations'],
+                                           column(row, 'llg_iterations_%d()' % b))
+            output['mag_faces'] += column(row, 'num_mag_faces_%d()' % b)
+        outputs.append(output)
+    return outputs
+
+def report(filename):
+    outputs = read_costs(filename)
+    if len(outputs) == 0:
+        print(filename + ': no output')
+        return
+    used = outputs[1:] if len(outputs) > 1 else outputs
+    step_start = outputs[0]['step'] if len(outputs) > 1 else 0.
+    n_steps = used[-1]['step'] - step_start
+    ranks = sorted(set(r for o in used for r in o['rank']))
+
+    # time of each phase on each rank, summed over the outputs
+    time_rank = {p: [0.] * len(ranks) for p in phases}
+    for o in used:
+        for p in phases:
+            for r, t in zip(o['rank'], o[p]):
+                time_rank[p][ranks.index(r)] += t
+    llg_iterations = sum(o['llg_iterations'] for o in used)
+
+    print(filename)
+    print('  steps %d to %d, %d ranks, %d magnetic faces, %.2f LLG iterations per step'
+          % (step_start + 1, used[-1]['step'], len(ranks), used[-1]['mag_faces'],
+             llg_iterations / n_steps))
+    print('  %-12s %16s %16s %10s' % ('phase', 'mean (s/step)', 'max (s/step)', 'max/mean'))
+    time_rank['total'] = [sum(time_rank[p][i] for p in phases) for i in range(len(ranks))]
+    for p in phases + ['total']:
+        mean = sum(time_rank[p]) / len(ranks) / n_steps
+        maxi = max(time_rank[p]) / n_steps
+        print('  %-12s %16.6e %16.6e %10.3f' % (p, mean, maxi, maxi / mean if mean > 0 else 0.))
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description='Report the time per step broken down by phase')
+    parser.add_argument('files', nargs='+',
+                        help='outputs of LoadBalanceCosts reduced diagnostics with breakdown = 1')
+    args = parser.parse_args()
+    for filename in args.files:
+        report(filename)
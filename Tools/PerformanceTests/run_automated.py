@@ -236,9 +236,13 @@ if args.mode == 'run':
             runtime_param_string += ' amr.max_grid_size=' + str(current_run.max_grid_size)
             runtime_param_string += ' amr.blocking_factor=' + str(current_run.blocking_factor)
             runtime_param_string += ' max_step=' + str( current_run.n_step )
+            runtime_param_string += current_run.domain_string()
             # runtime_param_list.append( runtime_param_string )
             run_string = get_run_string(current_run, architecture, n_node, count, bin_name, runtime_param_string)
             batch_string += run_string
+            # keep the costs broken down by phase (LLG tests), see read_phase_breakdown.py
+            costs_filename = 'costs_' + '_'.join([current_run.input_file, str(n_node), str(current_run.n_mpi_per_node), str(current_run.n_omp), str(count)]) + '.txt'
+            batch_string += 'if [ -f diags/reducedfiles/costs_breakdown.txt ]; then mv diags/reducedfiles/costs_breakdown.txt ' + costs_filename + '; fi\n'
             batch_string += 'rm -rf plotfiles lab_frame_data diags\n'
 
         submit_job_command = get_submit_job_command()
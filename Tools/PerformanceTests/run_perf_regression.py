@@ -0,0 +1,197 @@
+# This file is part of WarpX.
+#
+# License: BSD-3-Clause-LBNL
+
+# Performance regression harness: run a set of representative inputs for a fixed
+# number of steps, and compare the wall-clock time per step of each phase
+# (StepPhaseTimes reduced diagnostics) to the baselines stored for the machine.
+#
+# typical use, from a directory where the runs can be written:
+#   python run_perf_regression.py --machine summit-olcf --executable <path>/warpx.3d.MPI.CUDA.DP.LLG \
+#       --launcher "jsrun -n 1 -a 1 -g 1"
+# and, to record new baselines (e.g. after an intended change of performance):
+#   python run_perf_regression.py ... --update-baselines
+#
+# The script returns 1 if a phase of a case is slower than its baseline by more than
+# the threshold.
+
+import argparse
+import json
+import os
+import shlex
+import statistics
+import subprocess
+import sys
+
+warpx_dir = os.path.abspath(os.path.join(os.path.dirname(__file__), '..', '..'))
+baseline_dir = os.path.join(os.path.dirname(os.path.abspath(__file__)), 'perf_baselines')
+
+# Representative inputs: base inputs file (relative to the WarpX directory) and the
+# parameters that overwrite it (the last definition of a parameter is the one used)
+cases = {
+    'yee_vacuum': {
+        'inputs': 'Examples/Tests/macroscopic/inputs.3d',
+        'params': ['amr.n_cell = 128 128 128', 'amr.max_grid_size = 64',
+                   'amr.blocking_factor = 32', 'algo.em_solver_medium = vacuum'],
+    },
+    'macroscopic_sigma_epsilon': {
+        'inputs': 'Examples/Tests/Macroscopic_Maxwell/inputs_3d_LLG_noMs',
+        'params': ['amr.n_cell = 64 64 256', 'amr.max_grid_size = 64',
+                   'amr.blocking_factor = 16', 'macroscopic.sigma_function(x,y,z) = "1.e3"'],
+    },
+    'llg_1st_order': {
+        'inputs': 'Examples/Tests/Macroscopic_Maxwell/inputs_3d_LLG_original',
+        'params': ['amr.n_cell = 64 64 64', 'amr.max_grid_size = 32',
+                   'amr.blocking_factor = 8', 'warpx.mag_time_scheme_order = 1'],
+    },
+    'llg_2nd_order': {
+        'inputs': 'Examples/Tests/Macroscopic_Maxwell/inputs_3d_LLG_original',
+        'params': ['amr.n_cell = 64 64 64', 'amr.max_grid_size = 32',
+                   'amr.blocking_factor = 8', 'warpx.mag_time_scheme_order = 2'],
+    },
+    'pml_heavy': {
+        'inputs': 'Examples/Tests/Macroscopic_Maxwell/inputs_3d_LLG_noMs',
+        'params': ['amr.n_cell = 32 32 128', 'amr.max_grid_size = 32',
+                   'amr.blocking_factor = 16', 'warpx.pml_ncell = 32',
+                   'boundary.field_lo = pml pml pml', 'boundary.field_hi = pml pml pml'],
+    },
+}
+
+rd_name = 'perf_phases'
+
+def read_parameter(inputs, name):
+    '''Last value of a parameter in an inputs file, as a list of strings (None if absent)'''
+    value = None
+    with open(inputs) as f:
+        for line in f:
+            line = line.split('#')[0]
+            if '=' in line and line.split('=')[0].strip() == name:
+                value = line.split('=', 1)[1].split()
+    return value
+
+def write_inputs(case, steps, filename):
+    '''Inputs of a case: base inputs, overwritten parameters, no plotfile/checkpoint
+    output and the StepPhaseTimes reduced diagnostics only'''
+    base = os.path.join(warpx_dir, cases[case]['inputs'])
+    with open(base) as f:
+        content = f.read()
+    params = ['max_step = %d' % steps] + cases[case]['params']
+    for diag in read_parameter(base, 'diagnostics.diags_names') or []:
+        params += ['%s.intervals = 0' % diag, '%s.dump_last_timestep = 0' % diag]
+    params += ['warpx.step_phase_timers = 1',
+               'warpx.reduced_diags_names = ' + rd_name,
+               rd_name + '.type = StepPhaseTimes',
+               rd_name + '.intervals = 1']
+    with open(filename, 'w') as f:
+        f.write(content + '\n# performance regression harness\n' + '\n'.join(params) + '\n')
+
+def read_phase_times(filename, skip):
+    '''Median over the steps of the time of each phase in the output of StepPhaseTimes,
+    after the first skip outputs'''
+    with open(filename) as f:
+        header = f.readline()
+        rows = [line.split() for line in f if line.strip()]
+    # column names without the column numbers and units, e.g. HM_update
+    names = [c.split(']')[1].split('(')[0] for c in header.lstrip('#').split()]
+    rows = rows[skip:] if len(rows) > skip else rows[-1:]
+    return {name: statistics.median(float(row[i]) for row in rows)
+            for i, name in enumerate(names) if i >= 2}
+
+def run_case(case, args):
+    run_dir = os.path.abspath(os.path.join(args.run_dir, case))
+    os.makedirs(run_dir, exist_ok=True)
+    write_inputs(case, args.steps, os.path.join(run_dir, 'inputs'))
+    command = shlex.split(args.launcher) + [os.path.abspath(args.executable), 'inputs']
+    with open(os.path.join(run_dir, 'output.txt'), 'w') as log:
+        status = subprocess.call(command, cwd=run_dir, stdout=log, stderr=subprocess.STDOUT)
+    if status != 0:
+        print('%s: the run failed, see %s' % (case, os.path.join(run_dir, 'output.txt')))
+        return None
+    return read_phase_times(os.path.join(run_dir, 'diags', 'reducedfiles', rd_name + '.txt'),
+                            args.skip)
+
+def compare(case, times, baseline, args):
+    '''Print the times of a case against its baseline, and return the slower phases'''
+    slower = []
+    print('%s' % case)
+    print('  %-12s %14s %14s %9s' % ('phase', 'baseline (s)', 'this run (s)', 'change'))
+    for phase, t in times.items():
+        base = baseline.get(phase)
+        if base is None:
+            print('  %-12s %14s %14.6e' % (phase, '-', t))
+            continue
+        change = (t - base) / base if base > 0. else 0.
+        flag = change > args.threshold and t - base > args.min_time
+        if flag:
+            slower.append(phase)
+        print('  %-12s %14.6e %14.6e %8.1f%% %s' % (phase, base, t, 100. * change,
+                                                    '<-- SLOWER' if flag else ''))
+    return slower
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description='Compare the time per phase of the step '
+                                                 'of representative inputs to stored baselines')
+    parser.add_argument('--machine', required=True,
+                        help='machine profile, one of the directories of Tools/machines')
+    parser.add_argument('--executable', required=True, help='WarpX executable (3D, LLG)')
+    parser.add_argument('--launcher', default='mpirun -np 1',
+                        help='command that launches the executable, e.g. "srun -n 4"')
+    parser.add_argument('--cases', default=','.join(cases),
+                        help='comma-separated list of cases (default: all of %s)' % ', '.join(cases))
+    parser.add_argument('--steps', type=int, default=50, help='number of steps of each run')
+    parser.add_argument('--skip', type=int, default=5,
+                        help='number of first steps excluded from the timings')
+    parser.add_argument('--threshold', type=float, default=0.1,
+                        help='relative slowdown of a phase that is flagged (default 0.1)')
+    parser.add_argument('--min_time', type=float, default=1.e-4,
+                        help='absolute slowdown per step (s) below which a phase is not flagged')
+    parser.add_argument('--run_dir', default='perf_regression', help='directory of the runs')
+    parser.add_argument('--update-baselines', dest='update', action='store_true',
+                        help='store the timings of this run as the baselines of the machine')
+    args = parser.parse_args()
+
+    machines = os.listdir(os.path.join(warpx_dir, 'Tools', 'machines'))
+    if args.machine not in machines:
+        sys.exit('unknown machine profile %s, expected one of: %s'
+                 % (args.machine, ', '.join(sorted(machines))))
+    for case in args.cases.split(','):
+        if case not in cases:
+            sys.exit('unknown case %s, expected one of: %s' % (case, ', '.join(cases)))
+
+    baseline_file = os.path.join(baseline_dir, args.machine + '.json')
+    baselines = {}
+    if os.path.isfile(baseline_file):
+        with open(baseline_file) as f:
+            baselines = json.load(f)
+
+    failed = []
+    slower = {}
+    for case in args.cases.split(','):
+        times = run_case(case, args)
+        if times is None:
+            failed.append(case)
+            continue
+        if args.update:
+            baselines[case] = {'launcher': args.launcher, 'steps': args.steps, 'phases': times}
+        elif case in baselines:
+            if baselines[case]['launcher'] != args.launcher or baselines[case]['steps'] != args.steps:
+                print('%s: warning, the baseline was run with "%s" for %d steps'
+                      % (case, baselines[case]['launcher'], baselines[case]['steps']))
+            phases = compare(case, times, baselines[case]['phases'], args)
+            if phases:
+                slower[case] = phases
+        else:
+            print('%s: no baseline for %s, run with --update-baselines to store one'
+                  % (case, args.machine))
+
+    if args.update:
+        os.makedirs(baseline_dir, exist_ok=True)
+        with open(baseline_file, 'w') as f:
+            json.dump(baselines, f, indent=2, sort_keys=True)
+        print('baselines stored in ' + baseline_file)
+
+    for case, phases in slower.items():
+        print('SLOWDOWN: %s (%s) beyond %.0f%%' % (case, ', '.join(phases), 100. * args.threshold))
+    if failed:
+        print('FAILED: ' + ', '.join(failed))
+    sys.exit(1 if slower or failed else 0)
@@ -15,7 +15,7 @@ from functions_perftest import test_element
 
 
 def executable_name(compiler,architecture):
-    return 'perf_tests3d.' + compiler + '.TPROF.MTMPI.CUDA.QED.GPUCLOCK.ex'
+    return 'perf_tests3d.' + compiler + '.TPROF.MTMPI.CUDA.QED.GPUCLOCK.LLG.ex'
 
 def get_config_command(compiler, architecture):
     config_command = ''
@@ -142,5 +142,44 @@ def get_test_list(n_repeat):
                                        max_grid_size=256,
                                        blocking_factor=64,
                                        n_step=1) )
+    # LLG and macroscopic solver tests (the costs broken down by phase are read by read_phase_breakdown.py)
+    test_list_unq.append( test_element(input_file='automated_test_7_llg_waveguide',
+                                       n_mpi_per_node=6,
+                                       n_omp=1,
+                                       n_cell=[128, 64, 512],
+                                       max_grid_size=64,
+                                       blocking_factor=32,
+                                       n_step=10) )
+    test_list_unq.append( test_element(input_file='automated_test_7_llg_waveguide',
+                                       n_mpi_per_node=6,
+                                       n_omp=1,
+                                       n_cell=[256, 128, 1024],
+                                       max_grid_size=64,
+                                       blocking_factor=32,
+                                       n_step=10,
+                                       scaling='strong') )
+    test_list_unq.append( test_element(input_file='automated_test_8_magnon_photon',
+                                       n_mpi_per_node=6,
+                                       n_omp=1,
+                                       n_cell=[64, 512, 64],
+                                       max_grid_size=64,
+                                       blocking_factor=32,
+                                       n_step=10) )
+    test_list_unq.append( test_element(input_file='automated_test_8_magnon_photon',
+                                       n_mpi_per_node=6,
+                                       n_omp=1,
+                                       n_cell=[128, 1024, 128],
+                                       max_grid_size=64,
+                                       blocking_factor=32,
+                                       n_step=10,
+                                       scaling='strong') )
+    test_list_unq.append( test_element(input_file='automated_test_9_llg_slab',
+                                       n_mpi_per_node=6,
+                                       n_omp=1,
+                                       n_cell=[128, 128, 128],
+                                       max_grid_size=32,
+                                       blocking_factor=32,
+                                       n_step=10,
+                                       cell_size=[1.e-6, 1.e-6, 1.e-6]) )
     test_list = [copy.deepcopy(item) for item in test_list_unq for _ in range(n_repeat) ]
     return test_list
@@ -128,7 +128,35 @@ def get_particle_field(snapshot, species, field):
 
 def _get_field_names(raw_file):
     header_files = glob(raw_file + "*_H")
-    return [hf.split("/")[-1][:-2] for hf in header_files]
+    field_names = [hf.split("/")[-1][:-2] for hf in header_files]
+    # with <diag>.sparse_output, a field can be entirely constant and have no data file
+    sparse_files = glob(raw_file + "*_sparse")
+    for sf in sparse_files:
+        field_name = sf.split("/")[-1][:-len("_sparse")]
+        if field_name not in field_names:
+            field_names.append(field_name)
+    return field_names
+
+
+def _read_sparse(sparse_file):
+    '''
+    Read the list of constant boxes of a raw field written with <diag>.sparse_output.
+    Returns the number of components and a list of (lo, hi, node_type, values),
+    where lo and hi include the guard cells.
+    '''
+    sparse_boxes = []
+    with open(sparse_file, "r") as f:
+        s = f.readline().split()
+        ncomp = int(s[0])
+        nghost = np.fromstring(s[1].replace('(', '').replace(')', ''), dtype = int, sep = ',')
+        for line in f:
+            clean_line = line.strip().split()
+            if not clean_line:
+                continue
+            lo_corner, hi_corner, node_type = _line_to_numpy_arrays(clean_line[:3])
+            values = np.array([float(v) for v in clean_line[3:3+ncomp]])
+            sparse_boxes.append((lo_corner - nghost, hi_corner + nghost, node_type, values))
+    return ncomp, sparse_boxes
 
 
 def _string_to_numpy_array(s):
@@ -260,15 +288,31 @@ def _combine_boxes(boxes):
 def _read_field(raw_file, field_name):
 
     header_file = raw_file + field_name + "_H"
-    boxes, file_names, offsets, header = _read_header(header_file)
-
-    ng = header.nghost
-    dom_lo, dom_hi = _combine_boxes(boxes)
+    sparse_file = raw_file + field_name + "_sparse"
+    boxes, file_names, offsets = [], [], []
+    if os.path.isfile(header_file):
+        boxes, file_names, offsets, header = _read_header(header_file)
+        ncomp = header.ncomp
+    # boxes where the field is constant, written by <diag>.sparse_output
+    sparse_boxes = []
+    if os.path.isfile(sparse_file):
+        ncomp, sparse_boxes = _read_sparse(sparse_file)
+
+    dom_lo, dom_hi = _combine_boxes(boxes + sparse_boxes)
     data_shape = dom_hi - dom_lo + 1
-    if header.ncomp > 1:
-        data_shape = np.append(data_shape, header.ncomp)
+    if ncomp > 1:
+        data_shape = np.append(data_shape, ncomp)
     data = np.zeros(data_shape)
 
+    for box in sparse_boxes:
+        lo = box[0] - dom_lo
+        hi = box[1] - dom_lo
+        box_shape = tuple([slice(l,h+1) for l, h in zip(lo, hi)])
+        if ncomp > 1:
+            data[box_shape] = box[3]
+        else:
+            data[box_shape] = box[3][0]
+
     for box, fn, offset in zip(boxes, file_names, offsets):
         lo = box[0] - dom_lo
         hi = box[1] - dom_lo
@@ -0,0 +1,59 @@
+# This file is part of WarpX.
+#
+# License: BSD-3-Clause-LBNL
+
+import numpy as np
+import openpmd_api as io
+
+
+def read_field(series_path, iteration, record, component=io.Mesh_Record_Component.SCALAR):
+    '''
+
+    This function reads a field component from an openPMD series written by
+    WarpX, filling in the chunks that were not stored as data because the
+    field is constant there (<diag>.sparse_output = 1).
+
+    Arguments:
+
+        series_path : Path of the openPMD series, e.g. "diags/diag1/openpmd_%T.bp".
+
+        iteration : Index of the iteration to read.
+
+        record : Name of the mesh record, e.g. "E" or "Mx_xface".
+
+        component : Name of the record component, e.g. "x" (default: scalar record).
+
+    Returns:
+
+        A numpy array with the data of the record component, in C order.
+
+    Example:
+
+        >>> Mx = read_field("diags/diag1/openpmd_%T.bp", 100, "Mx_xface")
+
+    '''
+    series = io.Series(series_path, io.Access.read_only)
+    mesh_comp = series.iterations[iteration].meshes[record][component]
+
+    data = np.zeros(mesh_comp.shape, dtype=mesh_comp.dtype)
+
+    # chunks stored as data
+    chunks = []
+    for chunk in mesh_comp.available_chunks():
+        chunks.append((chunk.offset, chunk.extent, mesh_comp.load_chunk(chunk.offset, chunk.extent)))
+    series.flush()
+    for offset, extent, chunk_data in chunks:
+        data[tuple(slice(o, o + e) for o, e in zip(offset, extent))] = chunk_data
+
+    # chunks where the field is constant
+    attributes = mesh_comp.attributes
+    if "sparseChunkValues" in attributes:
+        ndim = len(mesh_comp.shape)
+        values = mesh_comp.get_attribute("sparseChunkValues")
+        offsets = np.reshape(mesh_comp.get_attribute("sparseChunkOffsets"), (-1, ndim))
+        extents = np.reshape(mesh_comp.get_attribute("sparseChunkExtents"), (-1, ndim))
+        for offset, extent, value in zip(offsets, extents, np.atleast_1d(values)):
+            data[tuple(slice(o, o + e) for o, e in zip(offset, extent))] = value
+
+    del series
+    return data
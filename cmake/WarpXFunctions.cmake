@@ -186,8 +186,19 @@ function(set_warpx_binary_name)
     if(WarpX_LIB)
         list(APPEND warpx_bin_names shared)
     endif()
+    if(WarpX_BENCHMARKS)
+        list(APPEND warpx_bin_names bench_field_kernels bench_warnings bench_comm)
+    endif()
     foreach(tgt IN LISTS warpx_bin_names)
-        set_target_properties(${tgt} PROPERTIES OUTPUT_NAME "warpx")
+        if(tgt STREQUAL bench_field_kernels)
+            set_target_properties(${tgt} PROPERTIES OUTPUT_NAME "warpx_bench_field_kernels")
+        elseif(tgt STREQUAL bench_warnings)
+            set_target_properties(${tgt} PROPERTIES OUTPUT_NAME "warpx_bench_warnings")
+        elseif(tgt STREQUAL bench_comm)
+            set_target_properties(${tgt} PROPERTIES OUTPUT_NAME "warpx_bench_comm")
+        else()
+            set_target_properties(${tgt} PROPERTIES OUTPUT_NAME "warpx")
+        endif()
         if(WarpX_DIMS STREQUAL RZ)
             set_property(TARGET ${tgt} APPEND_STRING PROPERTY OUTPUT_NAME ".RZ")
         else()
@@ -370,6 +381,7 @@ function(warpx_print_summary)
     message("    DIMS: ${WarpX_DIMS}")
     message("    Embedded Boundary: ${WarpX_EB}")
     message("    GPU clock timers: ${WarpX_GPUCLOCK}")
+    message("    heFFTe: ${WarpX_HEFFTE}")
     message("    IPO/LTO: ${WarpX_IPO}")
     message("    LIB: ${WarpX_LIB}${LIB_TYPE}")
     message("    MPI: ${WarpX_MPI}")
@@ -381,6 +393,7 @@ function(warpx_print_summary)
     message("    OPENPMD: ${WarpX_OPENPMD}")
     message("    QED: ${WarpX_QED}")
     message("    LLG: ${WarpX_MAG_LLG}")
+    message("    LLG mixed precision: ${WarpX_MAG_LLG_MIXED_PRECISION}")
     message("    QED table generation: ${WarpX_QED_TABLE_GEN}")
     message("    SENSEI: ${WarpX_SENSEI}")
     message("")